@@ -18,6 +18,7 @@
 #include "storage/version.h"
 #include "vlog.h"
 
+#include <seastar/core/coroutine.hh>
 #include <seastar/core/shared_ptr.hh>
 
 namespace archival {
@@ -167,19 +168,20 @@ static upload_candidate create_upload_candidate(
       .content_length = clen};
 }
 
-upload_candidate archival_policy::get_next_candidate(
+ss::future<upload_candidate> archival_policy::get_next_candidate(
   model::offset last_offset, storage::log_manager& lm) {
     auto [segment, ntp_conf] = find_segment(last_offset, lm);
     if (segment.get() == nullptr || ntp_conf == nullptr) {
-        return {};
+        co_return upload_candidate{};
     }
     // Invariant: segment is not compacted (segment->is_compacted_segment() ==
     // false)
     auto end = segment->offsets().committed_offset;
     if (end > last_offset) {
-        return create_upload_candidate(last_offset, segment, ntp_conf);
+        co_await segment->hydrate_index();
+        co_return create_upload_candidate(last_offset, segment, ntp_conf);
     }
-    return {};
+    co_return upload_candidate{};
 }
 
 } // namespace archival
@@ -45,8 +45,9 @@ public:
     /// \note returned upload candidate can have offset which is smaller than
     ///       last_offset because index is sparse and don't have all possible
     ///       offsets. If index is not materialized we will upload log starting
-    ///       from the begining.
-    upload_candidate
+    ///       from the begining. The index of the segment is loaded first if
+    ///       the log was recovered lazily.
+    ss::future<upload_candidate>
     get_next_candidate(model::offset last_offset, storage::log_manager& lm);
 
 private:
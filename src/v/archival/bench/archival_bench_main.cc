@@ -0,0 +1,475 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#include "archival/ntp_archiver_service.h"
+#include "archival/upload_scheduler.h"
+#include "model/fundamental.h"
+#include "model/namespace.h"
+#include "model/record_batch_reader.h"
+#include "resource_mgmt/token_bucket.h"
+#include "s3/client.h"
+#include "s3/client_pool.h"
+#include "seastarx.h"
+#include "storage/api.h"
+#include "storage/disk_log_impl.h"
+#include "storage/log_manager.h"
+#include "storage/ntp_config.h"
+#include "storage/tests/utils/random_batch.h"
+#include "syschecks/syschecks.h"
+#include "units.h"
+#include "utils/hdr_hist.h"
+#include "vlog.h"
+
+#include <seastar/core/app-template.hh>
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/loop.hh>
+#include <seastar/core/reactor.hh>
+#include <seastar/core/semaphore.hh>
+#include <seastar/core/sleep.hh>
+#include <seastar/core/thread.hh>
+#include <seastar/http/httpd.hh>
+#include <seastar/net/inet_address.hh>
+#include <seastar/util/tmp_file.hh>
+
+#include <fmt/format.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+/*
+ * Archival throughput benchmark. Writes synthetic data into a number of
+ * partitions, uploads all closed segments with the archivers and the
+ * upload scheduler the way scheduler_service does, and reports the upload
+ * throughput, the time it took to archive every partition, the manifest
+ * overhead and the reactor CPU time per uploaded GiB.
+ *
+ * Without --s3-endpoint the uploads go to an in-process S3 emulator with
+ * configurable latency and bandwidth. Everything runs on shard 0.
+ */
+
+static ss::logger bench_log{"archival_bench"};
+
+using namespace std::chrono_literals;
+
+void cli_opts(boost::program_options::options_description_easy_init opt) {
+    namespace po = boost::program_options;
+
+    opt(
+      "partitions",
+      po::value<int>()->default_value(16),
+      "number of partitions");
+    opt(
+      "segments",
+      po::value<int>()->default_value(4),
+      "number of closed segments per partition");
+    opt(
+      "segment-size",
+      po::value<size_t>()->default_value(16_MiB),
+      "segment size in bytes");
+    opt(
+      "connections",
+      po::value<size_t>()->default_value(20),
+      "number of connections to S3");
+    opt(
+      "upload-bandwidth",
+      po::value<size_t>()->default_value(0),
+      "max upload bytes per second, zero disables the limit");
+    opt(
+      "incremental-manifest",
+      po::value<bool>()->default_value(false),
+      "upload manifest deltas instead of the json manifest");
+    opt(
+      "s3-endpoint",
+      po::value<std::string>()->default_value(""),
+      "host of an S3 compatible endpoint, the emulator is used if empty");
+    opt(
+      "s3-port", po::value<uint16_t>()->default_value(9000), "S3 port");
+    opt(
+      "bucket",
+      po::value<std::string>()->default_value("archival-bench"),
+      "s3 bucket");
+    opt(
+      "accesskey",
+      po::value<std::string>()->default_value("access-key"),
+      "aws access key");
+    opt(
+      "secretkey",
+      po::value<std::string>()->default_value("secret-key"),
+      "aws secret key");
+    opt(
+      "region",
+      po::value<std::string>()->default_value("us-east-1"),
+      "aws region");
+    opt(
+      "emulator-port",
+      po::value<uint16_t>()->default_value(4430),
+      "port of the S3 emulator");
+    opt(
+      "emulator-latency-ms",
+      po::value<int>()->default_value(20),
+      "latency of every request to the S3 emulator");
+    opt(
+      "emulator-bandwidth",
+      po::value<size_t>()->default_value(0),
+      "bytes per second the S3 emulator accepts, zero for unlimited");
+}
+
+/// Emulates the S3 calls of the archiver. Manifests are kept in memory,
+/// segment data is dropped. Every request waits for the latency and for
+/// its share of the bandwidth, which models a single link to the object
+/// store. Multipart uploads aren't supported.
+class s3_emulator {
+public:
+    s3_emulator(std::chrono::milliseconds latency, size_t bandwidth)
+      : _latency(latency)
+      , _server("s3_emulator") {
+        if (bandwidth > 0) {
+            _link.emplace(
+              static_cast<double>(bandwidth), token_bucket::clock::now());
+        }
+        _server._routes.add_default_handler(new handler(*this));
+    }
+
+    ss::future<> start(ss::socket_address addr) {
+        return _server.listen(addr);
+    }
+    ss::future<> stop() { return _server.stop(); }
+
+    uint64_t requests() const { return _requests; }
+    uint64_t segment_bytes() const { return _segment_bytes; }
+    uint64_t manifest_bytes() const { return _manifest_bytes; }
+    uint64_t manifest_requests() const { return _manifest_requests; }
+
+private:
+    struct handler final : ss::httpd::handler_base {
+        explicit handler(s3_emulator& e)
+          : emulator(e) {}
+
+        ss::future<std::unique_ptr<ss::httpd::reply>> handle(
+          const ss::sstring&,
+          std::unique_ptr<ss::httpd::request> req,
+          std::unique_ptr<ss::httpd::reply> rep) final {
+            return emulator.handle(std::move(req), std::move(rep));
+        }
+
+        s3_emulator& emulator;
+    };
+
+    ss::future<std::unique_ptr<ss::httpd::reply>> handle(
+      std::unique_ptr<ss::httpd::request> req,
+      std::unique_ptr<ss::httpd::reply> rep) {
+        static const ss::sstring no_such_key
+          = R"xml(<?xml version="1.0" encoding="UTF-8"?>
+                  <Error>
+                      <Code>NoSuchKey</Code>
+                      <Message>Object not found</Message>
+                      <Resource>resource</Resource>
+                      <RequestId>requestid</RequestId>
+                  </Error>)xml";
+        using status = ss::httpd::reply::status_type;
+        ++_requests;
+        auto key = req->_url.substr(1);
+        bool manifest = key.find("/meta/") != ss::sstring::npos;
+        if (manifest) {
+            ++_manifest_requests;
+        }
+        co_await delay(req->content.size());
+        if (req->_method == "PUT") {
+            if (manifest) {
+                _manifest_bytes += req->content.size();
+                _objects[key] = std::move(req->content);
+            } else {
+                _segment_bytes += req->content.size();
+            }
+            rep->set_status(status::ok).done("txt");
+        } else if (req->_method == "GET" && key.empty()) {
+            rep->write_body(
+              "xml",
+              list_objects(
+                req->get_header("prefix"), req->get_header("start-after")));
+        } else if (req->_method == "GET") {
+            auto it = _objects.find(key);
+            if (it == _objects.end()) {
+                rep->set_status(status::not_found);
+                rep->write_body("xml", ss::sstring(no_such_key));
+            } else {
+                auto body = it->second;
+                co_await delay(body.size());
+                rep->write_body("bin", std::move(body));
+            }
+        } else if (req->_method == "DELETE") {
+            _objects.erase(key);
+            rep->set_status(status::no_content).done("txt");
+        } else {
+            rep->set_status(status::bad_request).done("txt");
+        }
+        co_return std::move(rep);
+    }
+
+    ss::sstring list_objects(
+      const ss::sstring& prefix, const ss::sstring& start_after) const {
+        auto body = fmt::format(
+          "<?xml version=\"1.0\" encoding=\"UTF-8\"?><ListBucketResult>"
+          "<IsTruncated>false</IsTruncated><Prefix>{}</Prefix>",
+          prefix);
+        for (auto it = _objects.upper_bound(start_after); it != _objects.end();
+             ++it) {
+            if (!it->first.starts_with(prefix)) {
+                continue;
+            }
+            body += fmt::format(
+              "<Contents><Key>{}</Key><Size>{}</Size>"
+              "<LastModified>2021-01-01T00:00:00.000Z</LastModified>"
+              "</Contents>",
+              it->first,
+              it->second.size());
+        }
+        body += "</ListBucketResult>";
+        return ss::sstring(body);
+    }
+
+    ss::future<> delay(size_t bytes) {
+        auto d = std::chrono::duration_cast<ss::lowres_clock::duration>(
+          _latency);
+        if (_link && bytes > 0) {
+            auto now = token_bucket::clock::now();
+            _link->consume(static_cast<double>(bytes), now);
+            d += _link->delay(now);
+        }
+        return ss::sleep(d);
+    }
+
+    std::chrono::milliseconds _latency;
+    std::optional<token_bucket> _link;
+    ss::httpd::http_server _server;
+    std::map<ss::sstring, ss::sstring> _objects;
+    uint64_t _requests{0};
+    uint64_t _segment_bytes{0};
+    uint64_t _manifest_bytes{0};
+    uint64_t _manifest_requests{0};
+};
+
+/// Bytes of the closed segments, the active one isn't uploaded
+static size_t closed_bytes(storage::log log) {
+    auto impl = dynamic_cast<storage::disk_log_impl*>(log.get_impl());
+    auto& set = impl->segments();
+    size_t bytes = 0;
+    for (size_t i = 0; i + 1 < set.size(); i++) {
+        bytes += set[i]->size_bytes();
+    }
+    return bytes;
+}
+
+/// Append random batches until the log has \p segments closed segments
+static ss::future<> write_partition(storage::log log, size_t segments) {
+    storage::log_append_config cfg{
+      .should_fsync = storage::log_append_config::fsync::no,
+      .io_priority = ss::default_priority_class(),
+      .timeout = model::no_timeout};
+    while (log.segment_count() <= segments) {
+        auto reader = model::make_memory_record_batch_reader(
+          storage::test::make_random_batches(model::offset(0), 10));
+        co_await std::move(reader).for_each_ref(
+          log.make_appender(cfg), cfg.timeout);
+    }
+    co_await log.flush();
+}
+
+static s3::configuration
+client_config(const boost::program_options::variables_map& m) {
+    auto endpoint = m["s3-endpoint"].as<std::string>();
+    auto port = endpoint.empty() ? m["emulator-port"].as<uint16_t>()
+                                 : m["s3-port"].as<uint16_t>();
+    if (endpoint.empty()) {
+        endpoint = "127.0.0.1";
+    }
+    s3::configuration conf{
+      .uri = s3::access_point_uri(endpoint),
+      .access_key = s3::public_key_str(m["accesskey"].as<std::string>()),
+      .secret_key = s3::private_key_str(m["secretkey"].as<std::string>()),
+      .region = s3::aws_region_name(m["region"].as<std::string>()),
+    };
+    conf.server_addr = ss::socket_address(ss::ipv4_addr(endpoint, port));
+    conf.disable_metrics = rpc::metrics_disabled::yes;
+    return conf;
+}
+
+static void run(const boost::program_options::variables_map& m) {
+    auto partitions = m["partitions"].as<int>();
+    auto segments = static_cast<size_t>(m["segments"].as<int>());
+    auto connections = m["connections"].as<size_t>();
+
+    auto dir = ss::make_tmp_dir("/tmp/archival_bench_XXXXXX").get0();
+    auto data_dir = ss::sstring(dir.get_path().string());
+    storage::api storage(
+      storage::kvstore_config(
+        1_MiB, 10ms, data_dir, storage::debug_sanitize_files::no),
+      storage::log_config(
+        storage::log_config::storage_type::disk,
+        data_dir,
+        m["segment-size"].as<size_t>(),
+        storage::debug_sanitize_files::no));
+    storage.start().get();
+
+    std::vector<storage::ntp_config> ntps;
+    for (int i = 0; i < partitions; i++) {
+        ntps.emplace_back(
+          model::ntp(
+            model::kafka_namespace,
+            model::topic("archival-bench"),
+            model::partition_id(i)),
+          data_dir);
+    }
+    vlog(bench_log.info, "Writing {} partitions", partitions);
+    ss::parallel_for_each(
+      ntps,
+      [&storage, segments](const storage::ntp_config& ntp) {
+          return storage.log_mgr()
+            .manage(storage::ntp_config(ntp.ntp(), ntp.base_directory()))
+            .then([segments](storage::log log) {
+                return write_partition(log, segments);
+            });
+      })
+      .get();
+    size_t segment_bytes = 0;
+    for (const auto& ntp : ntps) {
+        segment_bytes += closed_bytes(*storage.log_mgr().get(ntp.ntp()));
+    }
+
+    std::optional<s3_emulator> emulator;
+    if (m["s3-endpoint"].as<std::string>().empty()) {
+        emulator.emplace(
+          std::chrono::milliseconds(m["emulator-latency-ms"].as<int>()),
+          m["emulator-bandwidth"].as<size_t>());
+        emulator
+          ->start(ss::socket_address(
+            ss::ipv4_addr("127.0.0.1", m["emulator-port"].as<uint16_t>())))
+          .get();
+    }
+
+    archival::configuration conf;
+    conf.client_config = client_config(m);
+    conf.bucket_name = s3::bucket_name(m["bucket"].as<std::string>());
+    conf.connection_limit = archival::s3_connection_limit(connections);
+    conf.upload_bandwidth = m["upload-bandwidth"].as<size_t>();
+    conf.incremental_manifest = m["incremental-manifest"].as<bool>();
+
+    s3::client_pool pool(conf.client_config, connections);
+    archival::upload_scheduler sched(conf.upload_bandwidth);
+    ss::semaphore req_limit(connections);
+    std::map<model::ntp, std::unique_ptr<archival::ntp_archiver>> archivers;
+    for (const auto& ntp : ntps) {
+        archivers.emplace(
+          ntp.ntp(),
+          std::make_unique<archival::ntp_archiver>(ntp, conf, pool));
+    }
+
+    vlog(bench_log.info, "Uploading");
+    hdr_hist lag;
+    size_t uploaded = 0;
+    size_t failed = 0;
+    auto start = ss::lowres_clock::now();
+    auto busy_start = ss::engine().total_busy_time();
+    while (!archivers.empty()) {
+        std::vector<archival::upload_scheduler::pending_partition> pending;
+        for (const auto& [ntp, archiver] : archivers) {
+            pending.push_back(
+              {.ntp = ntp, .oldest_pending = archiver->get_oldest_pending()});
+        }
+        size_t round_uploads = 0;
+        std::vector<model::ntp> drained;
+        ss::parallel_for_each(
+          sched.schedule(pending),
+          [&](const model::ntp& ntp) {
+              return archivers[ntp]
+                ->upload_next_candidates(req_limit, storage.log_mgr(), sched)
+                .then([&, ntp](archival::ntp_archiver::batch_result r) {
+                    round_uploads += r.num_succeded;
+                    failed += r.num_failed;
+                    if (r.num_succeded == 0 && r.num_failed == 0) {
+                        drained.push_back(ntp);
+                    }
+                });
+          })
+          .get();
+        uploaded += round_uploads;
+        for (const auto& ntp : drained) {
+            // the partition is archived up to its active segment
+            lag.record(
+              std::chrono::duration_cast<std::chrono::microseconds>(
+                ss::lowres_clock::now() - start)
+                .count());
+            archivers[ntp]->stop().get();
+            archivers.erase(ntp);
+        }
+        if (round_uploads == 0 && drained.empty()) {
+            vlog(bench_log.error, "No progress, {} uploads failed", failed);
+            break;
+        }
+    }
+    auto elapsed = std::chrono::duration<double>(
+      ss::lowres_clock::now() - start);
+    auto busy = std::chrono::duration<double>(
+      ss::engine().total_busy_time() - busy_start);
+    for (auto& [ntp, archiver] : archivers) {
+        archiver->stop().get();
+    }
+    pool.stop().get();
+
+    fmt::print(
+      "segments uploaded: {} ({} bytes), failed uploads: {}\n"
+      "elapsed: {:.3f}s, throughput: {:.2f} MiB/s\n"
+      "per partition lag (ms): p50 {}, p90 {}, p99 {}, max {}\n"
+      "reactor busy time: {:.3f}s, {:.3f}s per uploaded GiB\n",
+      uploaded,
+      segment_bytes,
+      failed,
+      elapsed.count(),
+      segment_bytes / elapsed.count() / 1_MiB,
+      lag.get_value_at(50) / 1000,
+      lag.get_value_at(90) / 1000,
+      lag.get_value_at(99) / 1000,
+      lag.get_value_at(100) / 1000,
+      busy.count(),
+      segment_bytes > 0 ? busy.count() * 1_GiB / segment_bytes : 0.0);
+    if (emulator) {
+        // the reactor time includes the emulator
+        fmt::print(
+          "received segment bytes: {}, manifest bytes: {} ({:.3f}%), "
+          "requests: {}, manifest requests: {}\n",
+          emulator->segment_bytes(),
+          emulator->manifest_bytes(),
+          emulator->segment_bytes() > 0 ? 100.0 * emulator->manifest_bytes()
+                                            / emulator->segment_bytes()
+                                        : 0.0,
+          emulator->requests(),
+          emulator->manifest_requests());
+        emulator->stop().get();
+    } else {
+        fmt::print("manifest overhead is only measured by the emulator\n");
+    }
+    storage.stop().get();
+    dir.remove().get();
+}
+
+int main(int args, char** argv, char** env) {
+    syschecks::initialize_intrinsics();
+    std::setvbuf(stdout, nullptr, _IOLBF, 1024);
+    ss::app_template app;
+    cli_opts(app.add_options());
+    return app.run(args, argv, [&] {
+        auto& cfg = app.configuration();
+        return ss::async([&] { run(cfg); });
+    });
+}
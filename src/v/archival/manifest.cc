@@ -12,13 +12,15 @@
 
 #include "archival/logger.h"
 #include "bytes/iobuf.h"
-#include "bytes/iobuf_istreambuf.h"
 #include "bytes/iobuf_ostreambuf.h"
 #include "cluster/types.h"
 #include "hashing/xx.h"
+#include "json/parse.h"
 #include "model/fundamental.h"
 #include "model/metadata.h"
+#include "model/adl_serde.h"
 #include "model/timestamp.h"
+#include "reflection/adl.h"
 #include "ssx/sformat.h"
 #include "storage/ntp_config.h"
 #include "vlog.h"
@@ -28,7 +30,6 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
 #include <rapidjson/document.h>
-#include <rapidjson/istreamwrapper.h>
 #include <rapidjson/ostreamwrapper.h>
 #include <rapidjson/rapidjson.h>
 #include <rapidjson/writer.h>
@@ -59,8 +60,8 @@ manifest::manifest(model::ntp ntp, model::revision_id rev)
 // We're using eight because it's free and because AWS S3 is not the only
 // backend and other S3 API implementations might benefit from that.
 
-static remote_manifest_path generate_partition_manifest_path(
-  const model::ntp& ntp, model::revision_id rev) {
+static ss::sstring
+partition_manifest_prefix(const model::ntp& ntp, model::revision_id rev) {
     // NOTE: the idea here is to split all possible hash values into
     // 16 bins. Every bin should have lowest 28-bits set to 0.
     // As result, for segment names all prefixes are possible, but
@@ -70,14 +71,36 @@ static remote_manifest_path generate_partition_manifest_path(
     constexpr uint32_t bitmask = 0xF0000000;
     auto path = ssx::sformat("{}_{}", ntp.path(), rev());
     uint32_t hash = bitmask & xxhash_32(path.data(), path.size());
-    return remote_manifest_path(
-      fmt::format("{:08x}/meta/{}_{}/manifest.json", hash, ntp.path(), rev()));
+    return fmt::format("{:08x}/meta/{}_{}", hash, ntp.path(), rev());
+}
+
+static remote_manifest_path generate_partition_manifest_path(
+  const model::ntp& ntp, model::revision_id rev) {
+    return remote_manifest_path(fmt::format(
+      "{}/manifest.json", partition_manifest_prefix(ntp, rev)));
 }
 
 remote_manifest_path manifest::get_manifest_path() const {
     return generate_partition_manifest_path(_ntp, _rev);
 }
 
+remote_manifest_path manifest::get_binary_manifest_path() const {
+    return remote_manifest_path(
+      fmt::format("{}/manifest.bin", partition_manifest_prefix(_ntp, _rev)));
+}
+
+remote_manifest_path manifest::get_delta_prefix() const {
+    return remote_manifest_path(
+      fmt::format("{}/deltas/", partition_manifest_prefix(_ntp, _rev)));
+}
+
+remote_manifest_path manifest::get_delta_path(uint64_t seq) const {
+    // zero padding makes the lexicographic order of the listing match the
+    // order of the sequence numbers
+    return remote_manifest_path(
+      fmt::format("{}{:020}.bin", get_delta_prefix()().string(), seq));
+}
+
 remote_segment_path
 manifest::get_remote_segment_path(const segment_name& name) const {
     auto path = ssx::sformat("{}_{}/{}", _ntp.path(), _rev(), name());
@@ -85,12 +108,23 @@ manifest::get_remote_segment_path(const segment_name& name) const {
     return remote_segment_path(fmt::format("{:08x}/{}", hash, path));
 }
 
+remote_segment_path
+manifest::get_remote_index_path(const segment_name& name) const {
+    auto path = get_remote_segment_path(name)();
+    path += ".index";
+    return remote_segment_path(std::move(path));
+}
+
 const model::ntp& manifest::get_ntp() const { return _ntp; }
 
 const model::offset manifest::get_last_offset() const { return _last_offset; }
 
 model::revision_id manifest::get_revision_id() const { return _rev; }
 
+uint64_t manifest::get_last_delta() const { return _last_delta; }
+
+void manifest::set_last_delta(uint64_t seq) { _last_delta = seq; }
+
 manifest::const_iterator manifest::begin() const { return _segments.begin(); }
 
 manifest::const_iterator manifest::end() const { return _segments.end(); }
@@ -103,6 +137,9 @@ bool manifest::contains(const segment_name& obj) const {
 
 bool manifest::add(const segment_name& key, const segment_meta& meta) {
     auto [it, ok] = _segments.insert(std::make_pair(key, meta));
+    if (ok) {
+        _offsets.emplace(meta.committed_offset, key);
+    }
     _last_offset = std::max(meta.committed_offset, _last_offset);
     return ok;
 }
@@ -115,8 +152,36 @@ const manifest::segment_meta* manifest::get(const segment_name& key) const {
     return &it->second;
 }
 
-std::insert_iterator<manifest::segment_map> manifest::get_insert_iterator() {
-    return std::inserter(_segments, _segments.begin());
+manifest::const_iterator manifest::find_by_offset(model::offset o) const {
+    auto it = _offsets.lower_bound(o);
+    if (it == _offsets.end()) {
+        return _segments.end();
+    }
+    return _segments.find(it->second);
+}
+
+void manifest::apply_delta(const manifest& delta) {
+    if (_ntp != delta._ntp || _rev != delta._rev) {
+        throw std::logic_error(fmt_with_ctx(
+          fmt::format,
+          "delta {}-{} doesn't match {}-{}",
+          delta._ntp,
+          delta._rev,
+          _ntp,
+          _rev));
+    }
+    for (const auto& [name, meta] : delta) {
+        add(name, meta);
+    }
+    _last_offset = std::max(_last_offset, delta._last_offset);
+    _last_delta = std::max(_last_delta, delta._last_delta);
+}
+
+void manifest::rebuild_offset_index() {
+    _offsets.clear();
+    for (const auto& [name, meta] : _segments) {
+        _offsets.emplace(meta.committed_offset, name);
+    }
 }
 
 manifest manifest::difference(const manifest& remote_set) const {
@@ -130,12 +195,12 @@ manifest manifest::difference(const manifest& remote_set) const {
           remote_set._rev));
     }
     manifest result(_ntp, _rev);
-    std::set_difference(
-      begin(),
-      end(),
-      remote_set.begin(),
-      remote_set.end(),
-      result.get_insert_iterator());
+    for (const auto& [name, meta] : _segments) {
+        const auto* remote = remote_set.get(name);
+        if (remote == nullptr || *remote != meta) {
+            result.add(name, meta);
+        }
+    }
     return result;
 }
 
@@ -144,15 +209,55 @@ ss::future<> manifest::update(ss::input_stream<char>&& is) {
     iobuf result;
     auto os = make_iobuf_ref_output_stream(result);
     co_await ss::copy(is, os);
-    iobuf_istreambuf ibuf(result);
-    std::istream stream(&ibuf);
+    if (
+      !result.empty()
+      && (*result.begin()->get() == static_cast<char>(manifest_version::v2)
+          || *result.begin()->get()
+               == static_cast<char>(manifest_version::v3))) {
+        update(std::move(result));
+        co_return;
+    }
     Document m;
-    IStreamWrapper wrapper(stream);
-    m.ParseStream(wrapper);
+    auto res = co_await json::parse(result, m);
+    if (res.IsError()) {
+        throw std::runtime_error(fmt_with_ctx(
+          fmt::format, "manifest parse error at {}", res.Offset()));
+    }
     update(m);
     co_return;
 }
 
+void manifest::update(iobuf buf) {
+    iobuf_parser in(std::move(buf));
+    auto ver = reflection::adl<int8_t>{}.from(in);
+    if (
+      ver != static_cast<int8_t>(manifest_version::v2)
+      && ver != static_cast<int8_t>(manifest_version::v3)) {
+        throw std::runtime_error("manifest version not supported");
+    }
+    _ntp = reflection::adl<model::ntp>{}.from(in);
+    _rev = reflection::adl<model::revision_id>{}.from(in);
+    _last_offset = reflection::adl<model::offset>{}.from(in);
+    _last_delta = reflection::adl<uint64_t>{}.from(in);
+    auto n = reflection::adl<uint64_t>{}.from(in);
+    segment_map tmp;
+    while (n-- > 0) {
+        auto name = reflection::adl<segment_name>{}.from(in);
+        segment_meta meta{
+          .is_compacted = reflection::adl<bool>{}.from(in),
+          .size_bytes = reflection::adl<uint64_t>{}.from(in),
+          .base_offset = reflection::adl<model::offset>{}.from(in),
+          .committed_offset = reflection::adl<model::offset>{}.from(in),
+        };
+        if (ver == static_cast<int8_t>(manifest_version::v3)) {
+            meta.has_index = reflection::adl<bool>{}.from(in);
+        }
+        tmp.insert(std::make_pair(std::move(name), meta));
+    }
+    std::swap(tmp, _segments);
+    rebuild_offset_index();
+}
+
 void manifest::update(const rapidjson::Document& m) {
     using namespace rapidjson;
     auto ver = model::partition_id(m["version"].GetInt());
@@ -179,10 +284,15 @@ void manifest::update(const rapidjson::Document& m) {
               .base_offset = model::offset(boffs),
               .committed_offset = model::offset(coffs),
             };
+            if (it->value.HasMember("has_index")) {
+                meta.has_index = it->value["has_index"].GetBool();
+            }
             tmp.insert(std::make_pair(name, meta));
         }
     }
     std::swap(tmp, _segments);
+    _last_delta = 0;
+    rebuild_offset_index();
 }
 
 serialized_json_stream manifest::serialize() const {
@@ -227,6 +337,10 @@ void manifest::serialize(std::ostream& out) const {
             w.Int64(meta.committed_offset());
             w.Key("base_offset");
             w.Int64(meta.base_offset());
+            if (meta.has_index) {
+                w.Key("has_index");
+                w.Bool(meta.has_index);
+            }
             w.EndObject();
         }
         w.EndObject();
@@ -234,9 +348,41 @@ void manifest::serialize(std::ostream& out) const {
     w.EndObject();
 }
 
+iobuf manifest::to_iobuf() const {
+    // Fixed width fields in the order of the json keys, segments are sorted
+    // by name. Version 2 has no segment index flag
+    iobuf out;
+    reflection::serialize(
+      out,
+      static_cast<int8_t>(manifest_version::v3),
+      _ntp,
+      _rev,
+      _last_offset,
+      _last_delta,
+      static_cast<uint64_t>(_segments.size()));
+    for (const auto& [name, meta] : _segments) {
+        reflection::serialize(
+          out,
+          name,
+          meta.is_compacted,
+          static_cast<uint64_t>(meta.size_bytes),
+          meta.base_offset,
+          meta.committed_offset,
+          meta.has_index);
+    }
+    return out;
+}
+
 bool manifest::delete_permanently(const segment_name& name) {
     auto it = _segments.find(name);
     if (it != _segments.end()) {
+        auto [first, last] = _offsets.equal_range(it->second.committed_offset);
+        for (auto o = first; o != last; ++o) {
+            if (o->second == name) {
+                _offsets.erase(o);
+                break;
+            }
+        }
         _segments.erase(it);
         return true;
     }
@@ -256,11 +402,12 @@ ss::future<> topic_manifest::update(ss::input_stream<char>&& is) {
     iobuf result;
     auto os = make_iobuf_ref_output_stream(result);
     co_await ss::copy(is, os);
-    iobuf_istreambuf ibuf(result);
-    std::istream stream(&ibuf);
     Document m;
-    IStreamWrapper wrapper(stream);
-    m.ParseStream(wrapper);
+    auto res = co_await json::parse(result, m);
+    if (res.IsError()) {
+        throw std::runtime_error(fmt_with_ctx(
+          fmt::format, "topic manifest parse error at {}", res.Offset()));
+    }
     update(m);
     co_return;
 }
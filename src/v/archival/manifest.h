@@ -43,6 +43,9 @@ public:
         size_t size_bytes;
         model::offset base_offset;
         model::offset committed_offset;
+        /// the index of the segment is uploaded next to it, see
+        /// get_remote_index_path
+        bool has_index{false};
 
         // bool operator==(const segment_meta& other) const = default;
         // bool operator<(const segment_meta& other) const = default;
@@ -62,9 +65,21 @@ public:
     /// Manifest object name in S3
     remote_manifest_path get_manifest_path() const;
 
+    /// Name of the manifest object in the binary format in S3
+    remote_manifest_path get_binary_manifest_path() const;
+
+    /// Name of the delta object with sequence number \p seq in S3
+    remote_manifest_path get_delta_path(uint64_t seq) const;
+
+    /// Common prefix of the delta objects of the partition in S3
+    remote_manifest_path get_delta_prefix() const;
+
     /// Segment file name in S3
     remote_segment_path get_remote_segment_path(const segment_name& name) const;
 
+    /// Name of the index of the segment, see remote_segment_index
+    remote_segment_path get_remote_index_path(const segment_name& name) const;
+
     /// Get NTP
     const model::ntp& get_ntp() const;
 
@@ -74,6 +89,12 @@ public:
     /// Get revision
     model::revision_id get_revision_id() const;
 
+    /// Sequence number of the last delta included in the manifest, zero if
+    /// there is none. A delta is a manifest with the segments added since
+    /// the previous delta.
+    uint64_t get_last_delta() const;
+    void set_last_delta(uint64_t seq);
+
     /// Return iterator to the begining(end) of the segments list
     const_iterator begin() const;
     const_iterator end() const;
@@ -88,8 +109,14 @@ public:
     /// Get segment if available or nullopt
     const segment_meta* get(const segment_name& key) const;
 
-    /// Get insert iterator for segments set
-    std::insert_iterator<segment_map> get_insert_iterator();
+    /// Find the segment with the lowest committed offset not below \p o,
+    /// which is the segment that contains \p o or the first one after a gap
+    ///
+    /// \return iterator to the segment or end()
+    const_iterator find_by_offset(model::offset o) const;
+
+    /// Add the segments of a delta and take over its sequence number
+    void apply_delta(const manifest& delta);
 
     /// Return new manifest that contains only those segments that present
     /// in local manifest and not found in 'remote_set'.
@@ -98,7 +125,8 @@ public:
     /// \return manifest with segments that doesn't present in 'remote_set'
     manifest difference(const manifest& remote_set) const;
 
-    /// Update manifest file from input_stream (remote set)
+    /// Update manifest file from input_stream (remote set), the stream can
+    /// contain either the json or the binary format
     ss::future<> update(ss::input_stream<char>&& is);
 
     /// Serialize manifest object
@@ -111,6 +139,10 @@ public:
     /// \param out output stream that should be used to output the json
     void serialize(std::ostream& out) const;
 
+    /// Serialize manifest object in the binary format, which is a fraction
+    /// of the size of the json and doesn't need a parser
+    iobuf to_iobuf() const;
+
     /// Compare two manifests for equality
     bool operator==(const manifest& other) const = default;
 
@@ -125,10 +157,18 @@ private:
     /// from manifest.json file
     void update(const rapidjson::Document& m);
 
+    /// Update manifest content from the binary format
+    void update(iobuf buf);
+
+    void rebuild_offset_index();
+
     model::ntp _ntp;
     model::revision_id _rev;
     segment_map _segments;
+    /// Segment names by committed offset
+    absl::btree_multimap<model::offset, segment_name> _offsets;
     model::offset _last_offset;
+    uint64_t _last_delta{0};
 };
 
 class topic_manifest {
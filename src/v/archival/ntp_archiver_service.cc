@@ -11,9 +11,14 @@
 #include "archival/ntp_archiver_service.h"
 
 #include "archival/logger.h"
+#include "archival/remote_segment_index.h"
+#include "config/configuration.h"
 #include "model/metadata.h"
+#include "prometheus/prometheus_sanitize.h"
 #include "s3/client.h"
+#include "s3/client_pool.h"
 #include "s3/error.h"
+#include "s3/multipart_upload.h"
 #include "storage/disk_log_impl.h"
 #include "storage/fs_utils.h"
 #include "utils/gate_guard.h"
@@ -22,11 +27,13 @@
 #include <seastar/core/file.hh>
 #include <seastar/core/loop.hh>
 #include <seastar/core/lowres_clock.hh>
+#include <seastar/core/metrics.hh>
 #include <seastar/core/semaphore.hh>
 #include <seastar/core/shared_ptr.hh>
 #include <seastar/core/when_all.hh>
 #include <seastar/util/noncopyable_function.hh>
 
+#include <boost/range/irange.hpp>
 #include <fmt/format.h>
 
 #include <exception>
@@ -38,23 +45,33 @@ std::ostream& operator<<(std::ostream& o, const configuration& cfg) {
     fmt::print(
       o,
       "{{bucket_name: {}, interval: {}, client_config: {}, connection_limit: "
-      "{}}}",
+      "{}, cache_directory: {}, cache_size: {}, cache_prefetch: {}, "
+      "upload_part_size: {}}}",
       cfg.bucket_name,
       cfg.interval.count(),
       cfg.client_config,
-      cfg.connection_limit);
+      cfg.connection_limit,
+      cfg.cache_directory.string(),
+      cfg.cache_size,
+      cfg.cache_prefetch,
+      cfg.upload_part_size);
     return o;
 }
 
 ntp_archiver::ntp_archiver(
-  const storage::ntp_config& ntp, const configuration& conf)
+  const storage::ntp_config& ntp,
+  const configuration& conf,
+  s3::client_pool& pool)
   : _ntp(ntp.ntp())
   , _rev(ntp.get_revision())
-  , _client_conf(conf.client_config)
+  , _pool(pool)
   , _policy(_ntp)
   , _bucket(conf.bucket_name)
   , _remote(_ntp, _rev)
-  , _gate() {
+  , _incremental_manifest(conf.incremental_manifest)
+  , _delta(_ntp, _rev)
+  , _gate()
+  , _upload_part_size(conf.upload_part_size) {
     vlog(archival_log.trace, "Create ntp_archiver {}", _ntp.path());
 }
 
@@ -73,15 +90,41 @@ const ss::lowres_clock::time_point ntp_archiver::get_last_upload_time() const {
 
 ss::future<download_manifest_result> ntp_archiver::download_manifest() {
     gate_guard guard{_gate};
-    auto key = _remote.get_manifest_path();
+    if (!_incremental_manifest) {
+        co_return co_await download_manifest_object(
+          _remote.get_manifest_path(), _remote);
+    }
+    // The json manifest is there if the partition was archived before the
+    // deltas were enabled
+    auto result = co_await download_manifest_object(
+      _remote.get_binary_manifest_path(), _remote);
+    if (result == download_manifest_result::notfound) {
+        result = co_await download_manifest_object(
+          _remote.get_manifest_path(), _remote);
+    }
+    if (result == download_manifest_result::backoff) {
+        co_return result;
+    }
+    _snapshot_delta = _remote.get_last_delta();
+    auto deltas = co_await download_manifest_deltas();
+    if (deltas != download_manifest_result::notfound) {
+        result = deltas;
+    }
+    co_return result;
+}
+
+ss::future<download_manifest_result> ntp_archiver::download_manifest_object(
+  const remote_manifest_path& key, manifest& target) {
     vlog(archival_log.debug, "Download manifest {}", key());
     auto path = s3::object_key(key().string());
-    s3::client client(_client_conf, _as);
     auto result = download_manifest_result::success;
     try {
-        auto resp = co_await client.get_object(_bucket, path);
-        vlog(archival_log.debug, "Receive OK response from {}", path);
-        co_await _remote.update(resp->as_input_stream());
+        co_await _pool.with_client(
+          _as, [this, &path, &target](s3::client& client) -> ss::future<> {
+              auto resp = co_await client.get_object(_bucket, path);
+              vlog(archival_log.debug, "Receive OK response from {}", path);
+              co_await target.update(resp->as_input_stream());
+          });
     } catch (const s3::rest_error_response& err) {
         if (err.code() == s3::s3_error_code::no_such_key) {
             // This can happen when we're dealing with new partition for which
@@ -100,27 +143,155 @@ ss::future<download_manifest_result> ntp_archiver::download_manifest() {
             throw;
         }
     }
-    co_await client.shutdown();
     co_return result;
 }
 
+ss::future<download_manifest_result> ntp_archiver::download_manifest_deltas() {
+    auto prefix = s3::object_key(_remote.get_delta_prefix()().string());
+    // deltas up to the last one are in the snapshot, a leftover of a failed
+    // cleanup is skipped
+    auto start_after = s3::object_key(
+      _remote.get_delta_path(_remote.get_last_delta())().string());
+    auto result = download_manifest_result::notfound;
+    bool truncated = true;
+    while (truncated) {
+        std::vector<ss::sstring> keys;
+        try {
+            auto listing = co_await _pool.with_client(
+              _as, [this, &prefix, &start_after](s3::client& client) {
+                  return client.list_objects_v2(_bucket, prefix, start_after);
+              });
+            truncated = listing.is_truncated;
+            for (auto& item : listing.contents) {
+                keys.push_back(std::move(item.key));
+            }
+        } catch (const s3::rest_error_response& err) {
+            if (err.code() == s3::s3_error_code::slow_down) {
+                vlog(
+                  archival_log.debug, "SlowDown response received {}", prefix);
+                co_return download_manifest_result::backoff;
+            }
+            throw;
+        }
+        if (keys.empty()) {
+            break;
+        }
+        for (const auto& key : keys) {
+            manifest delta(_ntp, _rev);
+            auto res = co_await download_manifest_object(
+              remote_manifest_path(std::filesystem::path(key)), delta);
+            if (res == download_manifest_result::backoff) {
+                co_return res;
+            }
+            if (res == download_manifest_result::success) {
+                _remote.apply_delta(delta);
+                result = res;
+            }
+        }
+        start_after = s3::object_key(keys.back());
+    }
+    co_return result;
+}
+
+static serialized_json_stream make_manifest_stream(iobuf buf) {
+    size_t size_bytes = buf.size_bytes();
+    return {
+      .stream = make_iobuf_input_stream(std::move(buf)),
+      .size_bytes = size_bytes};
+}
+
 ss::future<> ntp_archiver::upload_manifest() {
     gate_guard guard{_gate};
+    if (_incremental_manifest) {
+        co_await upload_manifest_delta();
+        co_return;
+    }
     vlog(archival_log.debug, "Uploading manifest for {}", _ntp);
+    co_await upload_manifest_object(
+      _remote.get_manifest_path(),
+      {{"rp-type", "partition-manifest"}},
+      [this] { return _remote.serialize(); });
+}
+
+ss::future<> ntp_archiver::upload_manifest_delta() {
+    if (_delta.size() > 0) {
+        // a delta that failed to upload is retried with the same sequence
+        // number and the segments added since
+        auto seq = _remote.get_last_delta() + 1;
+        _delta.set_last_delta(seq);
+        vlog(
+          archival_log.debug, "Uploading manifest delta {} for {}", seq, _ntp);
+        bool uploaded = co_await upload_manifest_object(
+          _remote.get_delta_path(seq),
+          {{"rp-type", "partition-manifest-delta"}},
+          [this] { return make_manifest_stream(_delta.to_iobuf()); });
+        if (!uploaded) {
+            co_return;
+        }
+        _remote.set_last_delta(seq);
+        _delta = manifest(_ntp, _rev);
+    }
+    if (_remote.get_last_delta() - _snapshot_delta >= deltas_per_snapshot) {
+        co_await compact_manifest_deltas();
+    }
+}
+
+ss::future<> ntp_archiver::compact_manifest_deltas() {
+    auto first = _snapshot_delta + 1;
+    auto last = _remote.get_last_delta();
+    vlog(
+      archival_log.debug,
+      "Uploading manifest snapshot for {}, deltas {}-{}",
+      _ntp,
+      first,
+      last);
+    bool uploaded = co_await upload_manifest_object(
+      _remote.get_binary_manifest_path(),
+      {{"rp-type", "partition-manifest"}},
+      [this] { return make_manifest_stream(_remote.to_iobuf()); });
+    if (!uploaded) {
+        co_return;
+    }
+    _snapshot_delta = last;
+    co_await ss::parallel_for_each(
+      boost::irange<uint64_t>(first, last + 1), [this](uint64_t seq) {
+          auto key = s3::object_key(_remote.get_delta_path(seq)().string());
+          return _pool
+            .with_client(
+              _as,
+              [this, key](s3::client& client) {
+                  return client.delete_object(_bucket, key);
+              })
+            .handle_exception([this, seq](const std::exception_ptr& e) {
+                // readers of the snapshot skip the delta
+                vlog(
+                  archival_log.warn,
+                  "Failed to remove manifest delta {} of {}: {}",
+                  seq,
+                  _ntp,
+                  e);
+            });
+      });
+}
+
+ss::future<bool> ntp_archiver::upload_manifest_object(
+  const remote_manifest_path& key,
+  std::vector<s3::object_tag> tags,
+  ss::noncopyable_function<serialized_json_stream()> serialize) {
     ss::lowres_clock::duration backoff = 4ms;
     int backoff_quota = 8; // max backoff time should be close to 10s
-    auto key = _remote.get_manifest_path();
     vlog(archival_log.trace, "Upload manifest {}", key());
     auto path = s3::object_key(key().string());
-    std::vector<s3::object_tag> tags = {{"rp-type", "partition-manifest"}};
     while (!_gate.is_closed() && backoff_quota-- > 0) {
         bool slowdown = false;
-        s3::client client(_client_conf, _as);
         try {
-            auto [is, size] = _remote.serialize();
-            co_await client.put_object(
-              _bucket, path, size, std::move(is), tags);
-            co_await client.shutdown();
+            co_await _pool.with_client(
+              _as, [this, &path, &tags, &serialize](s3::client& client) {
+                  auto [is, size] = serialize();
+                  return client.put_object(
+                    _bucket, path, size, std::move(is), tags);
+              });
+            co_return true;
         } catch (const s3::rest_error_response& err) {
             vlog(
               archival_log.error,
@@ -167,13 +338,15 @@ ss::future<> ntp_archiver::upload_manifest() {
           _ntp,
           path);
     }
-    co_return;
+    co_return false;
 }
 
 const manifest& ntp_archiver::get_remote_manifest() const { return _remote; }
 
 ss::future<bool> ntp_archiver::upload_segment(
-  ss::semaphore& req_limit, upload_candidate candidate) {
+  ss::semaphore& req_limit,
+  upload_scheduler& sched,
+  upload_candidate candidate) {
     gate_guard guard{_gate};
     vlog(
       archival_log.debug,
@@ -187,11 +360,12 @@ ss::future<bool> ntp_archiver::upload_segment(
     auto s3path = _remote.get_remote_segment_path(
       segment_name(candidate.exposed_name));
     std::vector<s3::object_tag> tags = {{"rp-type", "segment"}};
+    co_await sched.throttle(candidate.content_length, _as);
+    if (_upload_part_size > 0 && candidate.content_length > _upload_part_size) {
+        co_return co_await upload_segment_multipart(candidate, s3path, tags);
+    }
     while (!_gate.is_closed() && backoff_quota-- > 0) {
         auto units = co_await ss::get_units(req_limit, 1);
-        s3::client client(_client_conf, _as);
-        auto stream = candidate.source->reader().data_stream(
-          candidate.file_offset, ss::default_priority_class());
         bool slowdown = false;
         vlog(
           archival_log.debug,
@@ -200,13 +374,16 @@ ss::future<bool> ntp_archiver::upload_segment(
           s3path);
         try {
             // Segment upload attempt
-            co_await client.put_object(
-              _bucket,
-              s3::object_key(s3path().string()),
-              candidate.content_length,
-              std::move(stream),
-              tags);
-            co_await client.shutdown();
+            co_await _pool.with_client(
+              _as, [this, &candidate, &s3path, &tags](s3::client& client) {
+                  return client.put_object(
+                    _bucket,
+                    s3::object_key(s3path().string()),
+                    candidate.content_length,
+                    candidate.source->reader().data_stream(
+                      candidate.file_offset, ss::default_priority_class()),
+                    tags);
+              });
         } catch (const s3::rest_error_response& err) {
             vlog(
               archival_log.error,
@@ -249,8 +426,118 @@ ss::future<bool> ntp_archiver::upload_segment(
     co_return true;
 }
 
+ss::future<bool> ntp_archiver::upload_segment_multipart(
+  const upload_candidate& candidate,
+  const remote_segment_path& path,
+  const std::vector<s3::object_tag>& tags) {
+    const auto& name = candidate.exposed_name();
+    std::optional<ss::sstring> resume;
+    if (auto it = _resumable_uploads.find(name);
+        it != _resumable_uploads.end()) {
+        resume = it->second;
+    }
+    s3::multipart_upload upload(
+      _pool,
+      _as,
+      _bucket,
+      s3::object_key(path().string()),
+      candidate.content_length,
+      s3::multipart_upload::options{.part_size = _upload_part_size},
+      resume);
+    vlog(
+      archival_log.debug,
+      "Uploading segment for {}, path {}, in {} parts{}",
+      _ntp,
+      path,
+      upload.parts_count(),
+      resume ? ", resumed" : "");
+    try {
+        co_await upload.upload(
+          [&candidate](size_t offset, size_t length) {
+              return candidate.source->reader().data_stream(
+                candidate.file_offset + offset,
+                length,
+                ss::default_priority_class());
+          },
+          tags);
+    } catch (const s3::rest_error_response& err) {
+        vlog(
+          archival_log.error,
+          "Uploading segment for {}, path {}, {} error detected, code: {}, "
+          "request_id: {}, resource: {}",
+          _ntp,
+          path,
+          err.message(),
+          err.code_string(),
+          err.request_id(),
+          err.resource());
+        if (err.code() == s3::s3_error_code::no_such_upload) {
+            // expired or aborted, the next attempt starts over
+            _resumable_uploads.erase(name);
+        } else if (upload.upload_id()) {
+            _resumable_uploads.insert_or_assign(name, *upload.upload_id());
+        }
+        co_return false;
+    } catch (...) {
+        vlog(
+          archival_log.error,
+          "Failed to upload segment for {}, path {}, {}/{} parts uploaded. "
+          "Reason: {}",
+          _ntp,
+          path,
+          upload.uploaded_parts(),
+          upload.parts_count(),
+          std::current_exception());
+        if (upload.upload_id()) {
+            _resumable_uploads.insert_or_assign(name, *upload.upload_id());
+        }
+        co_return false;
+    }
+    _resumable_uploads.erase(name);
+    co_return true;
+}
+
+ss::future<bool> ntp_archiver::upload_segment_index(
+  ss::semaphore& req_limit, upload_candidate candidate) {
+    gate_guard guard{_gate};
+    auto path = _remote.get_remote_index_path(
+      segment_name(candidate.exposed_name));
+    std::vector<s3::object_tag> tags = {{"rp-type", "segment-index"}};
+    try {
+        co_await candidate.source->hydrate_index();
+        auto index = remote_segment_index::from_segment(
+          candidate.source->index().state(),
+          candidate.starting_offset,
+          candidate.file_offset);
+        auto buf = index.to_iobuf();
+        auto units = co_await ss::get_units(req_limit, 1);
+        co_await _pool.with_client(
+          _as, [this, &path, &tags, &buf](s3::client& client) {
+              auto size = buf.size_bytes();
+              return client.put_object(
+                _bucket,
+                s3::object_key(path().string()),
+                size,
+                make_iobuf_input_stream(buf.copy()),
+                tags);
+          });
+    } catch (...) {
+        // the segment is still readable without its index
+        vlog(
+          archival_log.warn,
+          "Failed to upload segment index for {}, path {}. Reason: {}",
+          _ntp,
+          path,
+          std::current_exception());
+        co_return false;
+    }
+    co_return true;
+}
+
 ss::future<ntp_archiver::batch_result> ntp_archiver::upload_next_candidates(
-  ss::semaphore& req_limit, storage::log_manager& lm) {
+  ss::semaphore& req_limit,
+  storage::log_manager& lm,
+  upload_scheduler& sched) {
     vlog(archival_log.debug, "Uploading next candidates called for {}", _ntp);
     gate_guard guard{_gate};
     auto mlock = co_await ss::get_units(_mutex, 1);
@@ -263,15 +550,18 @@ ss::future<ntp_archiver::batch_result> ntp_archiver::upload_next_candidates(
     auto offset = _remote.size() ? _remote.get_last_offset() + model::offset(1)
                                  : model::offset(0);
     std::vector<ss::future<bool>> flist;
+    std::vector<ss::future<bool>> ilist;
     std::vector<manifest::segment_meta> meta;
     std::vector<ss::sstring> names;
+    size_t scheduled_bytes = 0;
+    _oldest_pending = model::timestamp::missing();
     for (size_t i = 0; i < _concurrency; i++) {
         vlog(
           archival_log.debug,
           "Uploading next candidates for {}, trying offset {}",
           _ntp,
           offset);
-        auto upload = _policy.get_next_candidate(offset, lm);
+        auto upload = co_await _policy.get_next_candidate(offset, lm);
         if (upload.source.get() == nullptr) {
             vlog(
               archival_log.debug,
@@ -292,8 +582,20 @@ ss::future<ntp_archiver::batch_result> ntp_archiver::upload_next_candidates(
             offset = meta->committed_offset + model::offset(1);
             continue;
         }
+        if (_oldest_pending == model::timestamp::missing()) {
+            _oldest_pending = upload.source->index().base_timestamp();
+        }
+        if (
+          scheduled_bytes > 0
+          && scheduled_bytes + upload.content_length > sched.quantum()) {
+            // The rest of the budget goes to other partitions
+            break;
+        }
+        scheduled_bytes += upload.content_length;
+        sched.charge(_ntp, upload.content_length);
         offset = upload.source->offsets().committed_offset + model::offset(1);
-        flist.emplace_back(upload_segment(req_limit, upload));
+        flist.emplace_back(upload_segment(req_limit, sched, upload));
+        ilist.emplace_back(upload_segment_index(req_limit, upload));
         manifest::segment_meta m{
           .is_compacted = upload.source->is_compacted_segment(),
           .size_bytes
@@ -310,16 +612,23 @@ ss::future<ntp_archiver::batch_result> ntp_archiver::upload_next_candidates(
           archival_log.debug,
           "Uploading next candidates for {}, no uploads started ...skip",
           _ntp);
+        update_pending_offsets(lm);
         co_return total;
     }
     auto results = co_await ss::when_all_succeed(begin(flist), end(flist));
+    auto indexed = co_await ss::when_all_succeed(begin(ilist), end(ilist));
     total.num_succeded = std::count(begin(results), end(results), true);
     total.num_failed = std::count(begin(results), end(results), false);
     for (size_t i = 0; i < results.size(); i++) {
         if (!results[i]) {
             break;
         }
+        meta[i].has_index = indexed[i];
         _remote.add(segment_name(names[i]), meta[i]);
+        if (_incremental_manifest) {
+            _delta.add(segment_name(names[i]), meta[i]);
+        }
+        _uploaded_bytes += meta[i].size_bytes;
     }
     if (total.num_succeded != 0) {
         vlog(
@@ -329,7 +638,62 @@ ss::future<ntp_archiver::batch_result> ntp_archiver::upload_next_candidates(
         co_await upload_manifest();
         _last_upload_time = ss::lowres_clock::now();
     }
+    update_pending_offsets(lm);
     co_return total;
 }
 
+void ntp_archiver::update_pending_offsets(storage::log_manager& lm) {
+    auto log = lm.get(_ntp);
+    if (!log) {
+        return;
+    }
+    auto uploaded = _remote.size() ? _remote.get_last_offset()
+                                   : model::offset(-1);
+    // the archived segments go first under disk space pressure
+    log->set_archived_offset(uploaded);
+    _pending_offsets = std::max<int64_t>(
+      0, log->offsets().committed_offset() - uploaded());
+}
+
+void ntp_archiver::setup_metrics() {
+    if (config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+    namespace sm = ss::metrics;
+    auto ns_label = sm::label("namespace");
+    auto topic_label = sm::label("topic");
+    auto partition_label = sm::label("partition");
+    const std::vector<sm::label_instance> labels = {
+      ns_label(_ntp.ns()),
+      topic_label(_ntp.tp.topic()),
+      partition_label(_ntp.tp.partition()),
+    };
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("archival:upload"),
+      {
+        sm::make_gauge(
+          "lag_ms",
+          [this] {
+              if (_oldest_pending == model::timestamp::missing()) {
+                  return int64_t(0);
+              }
+              return std::max<int64_t>(
+                0, model::timestamp::now().value() - _oldest_pending.value());
+          },
+          sm::description(
+            "Age of the oldest data of the partition that is not uploaded"),
+          labels),
+        sm::make_gauge(
+          "pending_offsets",
+          [this] { return _pending_offsets; },
+          sm::description("Number of offsets that are not uploaded"),
+          labels),
+        sm::make_derive(
+          "uploaded_bytes",
+          [this] { return _uploaded_bytes; },
+          sm::description("Number of bytes of uploaded segments"),
+          labels),
+      });
+}
+
 } // namespace archival
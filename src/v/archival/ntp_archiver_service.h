@@ -12,15 +12,20 @@
 #include "archival/archival_policy.h"
 #include "archival/manifest.h"
 #include "archival/types.h"
+#include "archival/upload_scheduler.h"
 #include "model/fundamental.h"
 #include "model/metadata.h"
+#include "model/timestamp.h"
 #include "s3/client.h"
+#include "s3/client_pool.h"
 #include "storage/fwd.h"
 #include "storage/segment.h"
 
 #include <seastar/core/abort_source.hh>
 #include <seastar/core/lowres_clock.hh>
+#include <seastar/core/metrics_registration.hh>
 #include <seastar/core/semaphore.hh>
+#include <seastar/util/noncopyable_function.hh>
 
 #include <map>
 
@@ -40,6 +45,20 @@ struct configuration {
     ss::lowres_clock::duration gc_interval;
     /// Number of simultaneous S3 uploads
     s3_connection_limit connection_limit;
+    /// Directory of the cache for segments downloaded from S3
+    std::filesystem::path cache_directory;
+    /// Max size of the per shard segment cache, zero disables remote reads
+    size_t cache_size{0};
+    /// Number of the following segments downloaded in the background while
+    /// a segment is read
+    size_t cache_prefetch{0};
+    /// Part size of multipart segment uploads, zero disables them
+    size_t upload_part_size{0};
+    /// Max bytes per second uploaded by the node, zero disables the limit
+    size_t upload_bandwidth{0};
+    /// Upload the segments added to a manifest as a binary delta instead of
+    /// the whole json manifest
+    bool incremental_manifest{false};
 };
 
 std::ostream& operator<<(std::ostream& o, const configuration& cfg);
@@ -63,7 +82,12 @@ public:
     /// \param ntp is an ntp that archiver is responsible for
     /// \param conf is an S3 client configuration
     /// \param bucket is an S3 bucket that should be used to store the data
-    ntp_archiver(const storage::ntp_config& ntp, const configuration& conf);
+    /// \param pool provides the connections to S3, it has to outlive the
+    ///        archiver
+    ntp_archiver(
+      const storage::ntp_config& ntp,
+      const configuration& conf,
+      s3::client_pool& pool);
 
     /// Stop archiver.
     ///
@@ -82,14 +106,27 @@ public:
 
     /// Download manifest from pre-defined S3 locatnewion
     ///
+    /// With incremental manifests the last snapshot, or the json manifest if
+    /// there is none, is updated with the deltas uploaded after it.
     /// \return future that returns true if the manifest was found in S3
     ss::future<download_manifest_result> download_manifest();
 
     /// Upload manifest to the pre-defined S3 location
+    ///
+    /// With incremental manifests only the segments added since the previous
+    /// call are uploaded, as a delta. Every deltas_per_snapshot deltas the
+    /// whole manifest is uploaded as a snapshot and the deltas are removed.
     ss::future<> upload_manifest();
 
     const manifest& get_remote_manifest() const;
 
+    /// Timestamp of the oldest data that wasn't uploaded as of the last
+    /// upload round, missing if there was nothing to upload
+    model::timestamp get_oldest_pending() const { return _oldest_pending; }
+
+    /// Register the archival lag metrics of the partition
+    void setup_metrics();
+
     struct batch_result {
         size_t num_succeded;
         size_t num_failed;
@@ -97,36 +134,98 @@ public:
 
     /// \brief Upload next set of segments to S3 (if any)
     /// The semaphore is used to track number of parallel uploads. The method
-    /// will pick not more than '_concurrency' candidates and start
-    /// uploading them.
+    /// will pick not more than '_concurrency' candidates, and not more than
+    /// a quantum of the scheduler beyond the first one, and start uploading
+    /// them.
     ///
     /// \param req_limit is used to limit number of parallel uploads
     /// \param lm is a log manager instance
+    /// \param sched is charged with the uploaded bytes and throttles them
     /// \return future that returns number of uploaded/failed segments
-    ss::future<batch_result>
-    upload_next_candidates(ss::semaphore& req_limit, storage::log_manager& lm);
+    ss::future<batch_result> upload_next_candidates(
+      ss::semaphore& req_limit,
+      storage::log_manager& lm,
+      upload_scheduler& sched);
 
 private:
+    static constexpr uint64_t deltas_per_snapshot = 64;
+
+    /// Download a manifest or a delta and update \p target with it
+    ss::future<download_manifest_result>
+    download_manifest_object(const remote_manifest_path& key, manifest& target);
+
+    /// Apply the deltas uploaded after the last one in the remote manifest
+    ///
+    /// \return notfound if there are none
+    ss::future<download_manifest_result> download_manifest_deltas();
+
+    /// Upload a manifest object, retrying while S3 asks to slow down
+    ///
+    /// \param serialize is called for every attempt
+    /// \return true if the object was uploaded
+    ss::future<bool> upload_manifest_object(
+      const remote_manifest_path& key,
+      std::vector<s3::object_tag> tags,
+      ss::noncopyable_function<serialized_json_stream()> serialize);
+
+    ss::future<> upload_manifest_delta();
+
+    /// Upload the snapshot of the remote manifest and remove the deltas
+    /// it includes
+    ss::future<> compact_manifest_deltas();
+
     /// Upload individual segment to S3.
     ///
     /// \return true on success and false otherwise
+    ss::future<bool> upload_segment(
+      ss::semaphore& req_limit,
+      upload_scheduler& sched,
+      upload_candidate candidate);
+
+    /// Upload a segment larger than a part in parallel parts, every part
+    /// takes a connection of the pool. A failed upload is resumed by the
+    /// next upload of the same segment.
+    ss::future<bool> upload_segment_multipart(
+      const upload_candidate& candidate,
+      const remote_segment_path& path,
+      const std::vector<s3::object_tag>& tags);
+
+    /// Upload the index of the uploaded part of the segment next to it.
+    ///
+    /// \return true on success and false otherwise
     ss::future<bool>
-    upload_segment(ss::semaphore& req_limit, upload_candidate candidate);
+    upload_segment_index(ss::semaphore& req_limit, upload_candidate candidate);
+
+    /// Refresh the number of offsets that are not uploaded yet
+    void update_pending_offsets(storage::log_manager& lm);
 
     model::ntp _ntp;
     model::revision_id _rev;
-    s3::configuration _client_conf;
+    s3::client_pool& _pool;
     archival_policy _policy;
     s3::bucket_name _bucket;
     /// Remote manifest contains representation of the data stored in S3 (it
     /// gets uploaded to the remote location)
     manifest _remote;
+    bool _incremental_manifest;
+    /// Segments added to _remote after the last uploaded delta
+    manifest _delta;
+    /// Last delta included in the uploaded snapshot
+    uint64_t _snapshot_delta{0};
     ss::gate _gate;
     ss::abort_source _as;
     ss::semaphore _mutex{1};
     simple_time_jitter<ss::lowres_clock> _backoff{100ms};
     size_t _concurrency{4};
     ss::lowres_clock::time_point _last_upload_time;
+    size_t _upload_part_size;
+    /// Ids of the multipart uploads that failed by exposed segment name
+    std::map<ss::sstring, ss::sstring> _resumable_uploads;
+    model::timestamp _oldest_pending;
+    /// Offsets of the log that are not uploaded yet
+    int64_t _pending_offsets{0};
+    uint64_t _uploaded_bytes{0};
+    ss::metrics::metric_groups _metrics;
 };
 
 } // namespace archival
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#include "archival/remote_partition.h"
+
+#include "archival/logger.h"
+#include "s3/error.h"
+#include "storage/lock_manager.h"
+#include "storage/log_reader.h"
+#include "storage/segment_set.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/file.hh>
+#include <seastar/core/fstream.hh>
+#include <seastar/core/iostream.hh>
+#include <seastar/core/seastar.hh>
+
+#include <exception>
+#include <optional>
+
+namespace archival {
+
+remote_partition::remote_partition(
+  const manifest& m,
+  s3::client_pool& pool,
+  const s3::bucket_name& bucket,
+  segment_cache& cache,
+  ss::abort_source& as,
+  size_t prefetch,
+  model::offset local_start)
+  : _manifest(m)
+  , _pool(pool)
+  , _bucket(bucket)
+  , _cache(cache)
+  , _as(as)
+  , _prefetch(prefetch)
+  , _local_start(local_start) {}
+
+std::optional<model::offset> remote_partition::start_offset() const {
+    auto it = _manifest.find_by_offset(model::offset::min());
+    if (it == _manifest.end()) {
+        return std::nullopt;
+    }
+    return it->second.base_offset;
+}
+
+std::optional<remote_partition::segment_ref>
+remote_partition::find_segment(model::offset o) const {
+    // uploaded segments don't overlap, the one with the lowest committed
+    // offset not below o has the lowest base offset too
+    auto it = _manifest.find_by_offset(o);
+    if (it == _manifest.end()) {
+        return std::nullopt;
+    }
+    return segment_ref{.name = it->first, .meta = it->second};
+}
+
+ss::future<std::optional<model::record_batch_reader>>
+remote_partition::make_reader(storage::log_reader_config config) {
+    auto ref = find_segment(config.start_offset);
+    if (!ref || ref->meta.base_offset > config.max_offset) {
+        vlog(
+          archival_log.debug,
+          "No archived segment of {} covers offset {}",
+          _manifest.get_ntp(),
+          config.start_offset);
+        co_return std::nullopt;
+    }
+    auto path = _manifest.get_remote_segment_path(ref->name);
+    vlog(
+      archival_log.debug,
+      "Reading offset {} of {} from archived segment {}",
+      config.start_offset,
+      _manifest.get_ntp(),
+      path);
+    auto segment = co_await _cache.get(path, download(path));
+    prefetch_after(*ref);
+
+    storage::segment_set::underlying_t segments;
+    segments.push_back(segment);
+    auto lease = std::make_unique<storage::lock_manager::lease>(
+      storage::segment_set(std::move(segments)));
+    lease->locks.push_back(co_await segment->read_lock());
+    co_return model::make_record_batch_reader<storage::log_reader>(
+      std::move(lease), config, _cache.reader_probe());
+}
+
+/// A download that fails midway resumes where it stopped with a ranged
+/// request, at most this many times
+static constexpr int max_download_attempts = 3;
+
+static ss::future<> download_segment(
+  s3::client_pool& pool,
+  s3::bucket_name bucket,
+  ss::abort_source& as,
+  remote_segment_path path,
+  std::filesystem::path dest) {
+    auto f = co_await ss::open_file_dma(
+      dest.string(),
+      ss::open_flags::create | ss::open_flags::truncate | ss::open_flags::wo);
+    auto out = co_await ss::make_file_output_stream(std::move(f));
+    size_t written = 0;
+    std::exception_ptr e;
+    for (int attempt = 1; !e; ++attempt) {
+        try {
+            co_await pool.with_client(
+              as, [&](s3::client& client) -> ss::future<> {
+                  std::optional<s3::byte_range> range;
+                  if (written > 0) {
+                      range = s3::byte_range{.first = written};
+                  }
+                  auto resp = co_await client.get_object(
+                    bucket, s3::object_key(path()), range);
+                  auto in = resp->as_input_stream();
+                  while (true) {
+                      auto buf = co_await in.read();
+                      if (buf.empty()) {
+                          break;
+                      }
+                      const auto size = buf.size();
+                      co_await out.write(std::move(buf));
+                      written += size;
+                  }
+              });
+            break;
+        } catch (const s3::rest_error_response& err) {
+            vlog(
+              archival_log.error,
+              "Downloading segment {}, {} error detected, code: {}, "
+              "request_id: {}, resource: {}",
+              path,
+              err.message(),
+              err.code_string(),
+              err.request_id(),
+              err.resource());
+            e = std::current_exception();
+        } catch (const ss::abort_requested_exception&) {
+            e = std::current_exception();
+        } catch (...) {
+            if (attempt == max_download_attempts) {
+                e = std::current_exception();
+            } else {
+                vlog(
+                  archival_log.info,
+                  "Resuming download of segment {} at byte {} after error: {}",
+                  path,
+                  written,
+                  std::current_exception());
+            }
+        }
+    }
+    try {
+        co_await out.flush();
+        co_await out.close();
+    } catch (...) {
+        if (!e) {
+            e = std::current_exception();
+        }
+    }
+    if (e) {
+        std::rethrow_exception(e);
+    }
+}
+
+segment_cache::download_fn
+remote_partition::download(remote_segment_path path) const {
+    return [&pool = _pool, bucket = _bucket, &as = _as, path = std::move(path)](
+             std::filesystem::path dest) {
+        return download_segment(pool, bucket, as, path, std::move(dest));
+    };
+}
+
+void remote_partition::prefetch_after(const segment_ref& ref) {
+    auto next = ref.meta.committed_offset + model::offset(1);
+    for (size_t i = 0; i < _prefetch; ++i) {
+        auto next_ref = find_segment(next);
+        if (!next_ref || next_ref->meta.base_offset >= _local_start) {
+            break;
+        }
+        auto path = _manifest.get_remote_segment_path(next_ref->name);
+        _cache.prefetch(path, download(path));
+        next = next_ref->meta.committed_offset + model::offset(1);
+    }
+}
+
+} // namespace archival
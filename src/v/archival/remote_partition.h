@@ -0,0 +1,100 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#pragma once
+
+#include "archival/manifest.h"
+#include "archival/segment_cache.h"
+#include "model/fundamental.h"
+#include "model/record_batch_reader.h"
+#include "s3/client.h"
+#include "s3/client_pool.h"
+#include "seastarx.h"
+#include "storage/types.h"
+
+#include <seastar/core/abort_source.hh>
+#include <seastar/core/future.hh>
+
+#include <filesystem>
+#include <optional>
+
+namespace archival {
+
+/// Read path for the data of a partition that was archived to S3.
+///
+/// The segment that covers the requested offset is looked up in the
+/// partition manifest, downloaded into the shard's segment cache and read
+/// through the regular storage log reader. Every reader covers at most one
+/// segment, consumers continue from the next offset to move on to the next
+/// segment. This is used to serve offsets below the local start offset of the
+/// log once local retention removed them.
+///
+/// A reader prefetches the segments that follow the one it reads into the
+/// cache so that a consumer replaying the archived data does not wait for a
+/// download at every segment.
+class remote_partition {
+public:
+    /// \param m is a manifest of the partition, it has to outlive the
+    ///        make_reader call but not the reader
+    /// \param pool provides the connections to S3
+    /// \param bucket is the bucket that stores the segments
+    /// \param cache is a segment cache that has to outlive the readers
+    /// \param as is an abort source for the downloads
+    /// \param prefetch is a number of the following segments to prefetch,
+    ///        the pool, bucket and abort source have to outlive the cache
+    ///        when it is not zero
+    /// \param local_start is the start offset of the local log, the
+    ///        segments from there on are read locally and not prefetched
+    remote_partition(
+      const manifest& m,
+      s3::client_pool& pool,
+      const s3::bucket_name& bucket,
+      segment_cache& cache,
+      ss::abort_source& as,
+      size_t prefetch = 0,
+      model::offset local_start = model::offset::max());
+
+    /// First offset available in S3 or nullopt if the manifest is empty
+    std::optional<model::offset> start_offset() const;
+
+    /// \brief Create reader for the archived data
+    ///
+    /// \param config is a reader config, the start offset is used to find
+    ///        the segment
+    /// \return reader for the segment holding the start offset or nullopt if
+    ///         the manifest has no segment that covers it
+    ss::future<std::optional<model::record_batch_reader>>
+    make_reader(storage::log_reader_config config);
+
+private:
+    struct segment_ref {
+        segment_name name;
+        manifest::segment_meta meta;
+    };
+
+    /// Find segment that contains offset 'o' or that follows a gap at 'o'
+    std::optional<segment_ref> find_segment(model::offset o) const;
+
+    /// Download of the segment, it does not depend on the partition
+    segment_cache::download_fn download(remote_segment_path path) const;
+
+    /// Prefetch the segments that follow the segment
+    void prefetch_after(const segment_ref&);
+
+    const manifest& _manifest;
+    s3::client_pool& _pool;
+    const s3::bucket_name& _bucket;
+    segment_cache& _cache;
+    ss::abort_source& _as;
+    size_t _prefetch;
+    model::offset _local_start;
+};
+
+} // namespace archival
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#include "archival/remote_segment_index.h"
+
+#include "bytes/iobuf_parser.h"
+#include "model/adl_serde.h"
+#include "reflection/adl.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace archival {
+
+remote_segment_index remote_segment_index::from_segment(
+  const storage::index_state& state,
+  model::offset starting_offset,
+  size_t file_offset) {
+    remote_segment_index index;
+    index._base_offset = starting_offset;
+    index._base_timestamp = state.base_timestamp;
+    const auto n = state.relative_offset_index.size();
+    index._offsets.reserve(n);
+    index._times.reserve(n);
+    index._positions.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        const auto o = state.base_offset
+                       + model::offset(state.relative_offset_index[i]);
+        const size_t pos = state.position_index[i];
+        // the batches before the uploaded object start
+        if (o < starting_offset || pos < file_offset) {
+            continue;
+        }
+        index._offsets.push_back(o() - starting_offset());
+        index._times.push_back(state.relative_time_index[i]);
+        index._positions.push_back(pos - file_offset);
+    }
+    return index;
+}
+
+iobuf remote_segment_index::to_iobuf() const {
+    iobuf out;
+    reflection::serialize(
+      out,
+      version,
+      _base_offset,
+      _base_timestamp,
+      _offsets,
+      _times,
+      _positions);
+    return out;
+}
+
+remote_segment_index remote_segment_index::from_iobuf(iobuf buf) {
+    iobuf_parser in(std::move(buf));
+    auto ver = reflection::adl<int8_t>{}.from(in);
+    if (ver != version) {
+        throw std::runtime_error(
+          fmt::format("segment index version {} not supported", ver));
+    }
+    remote_segment_index index;
+    index._base_offset = reflection::adl<model::offset>{}.from(in);
+    index._base_timestamp = reflection::adl<model::timestamp>{}.from(in);
+    index._offsets = reflection::adl<std::vector<uint32_t>>{}.from(in);
+    index._times = reflection::adl<std::vector<uint32_t>>{}.from(in);
+    index._positions = reflection::adl<std::vector<uint32_t>>{}.from(in);
+    if (
+      index._times.size() != index._offsets.size()
+      || index._positions.size() != index._offsets.size()) {
+        throw std::runtime_error("segment index arrays of different sizes");
+    }
+    return index;
+}
+
+remote_segment_index::entry remote_segment_index::get_entry(size_t i) const {
+    return entry{
+      .offset = _base_offset + model::offset(_offsets[i]),
+      .timestamp = model::timestamp(_base_timestamp() + _times[i]),
+      .position = _positions[i]};
+}
+
+std::optional<remote_segment_index::entry>
+remote_segment_index::find_nearest(model::offset o) const {
+    if (o < _base_offset || _offsets.empty()) {
+        return std::nullopt;
+    }
+    const uint32_t needle = o() - _base_offset();
+    auto it = std::upper_bound(_offsets.begin(), _offsets.end(), needle);
+    if (it == _offsets.begin()) {
+        return std::nullopt;
+    }
+    return get_entry(std::distance(_offsets.begin(), it) - 1);
+}
+
+std::optional<remote_segment_index::entry>
+remote_segment_index::find_nearest(model::timestamp t) const {
+    if (_times.empty()) {
+        return std::nullopt;
+    }
+    if (t < _base_timestamp) {
+        return get_entry(0);
+    }
+    const uint32_t needle = t() - _base_timestamp();
+    auto it = std::lower_bound(_times.begin(), _times.end(), needle);
+    if (it == _times.end()) {
+        return std::nullopt;
+    }
+    return get_entry(std::distance(_times.begin(), it));
+}
+
+} // namespace archival
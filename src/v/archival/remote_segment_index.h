@@ -0,0 +1,78 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#pragma once
+
+#include "bytes/iobuf.h"
+#include "model/fundamental.h"
+#include "model/timestamp.h"
+#include "storage/index_state.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace archival {
+
+/// Offset, time and position index of an archived segment, uploaded next to
+/// the segment object.
+///
+/// The positions are relative to the start of the object, which may start in
+/// the middle of the local segment, so that a remote reader can start a
+/// ranged download of the object at the batch that holds an offset or a
+/// timestamp instead of downloading the object from its start.
+///
+/// Format: version, base offset, base timestamp and the relative offsets,
+/// times and positions of the entries as arrays of little endian uint32.
+class remote_segment_index {
+public:
+    static constexpr int8_t version = 1;
+
+    struct entry {
+        model::offset offset;
+        model::timestamp timestamp;
+        /// position of the batch in the object
+        size_t position;
+    };
+
+    remote_segment_index() = default;
+
+    /// \brief Index of the object uploaded from a segment
+    ///
+    /// \param state is a hydrated index of the segment
+    /// \param starting_offset is the offset of the first uploaded batch
+    /// \param file_offset is the position of that batch in the segment
+    static remote_segment_index from_segment(
+      const storage::index_state& state,
+      model::offset starting_offset,
+      size_t file_offset);
+
+    iobuf to_iobuf() const;
+    static remote_segment_index from_iobuf(iobuf);
+
+    /// Entry of the batch with the largest offset not above \p o
+    std::optional<entry> find_nearest(model::offset o) const;
+    /// Entry of the first batch with a timestamp not below \p t
+    std::optional<entry> find_nearest(model::timestamp t) const;
+
+    size_t size() const { return _offsets.size(); }
+    bool empty() const { return _offsets.empty(); }
+
+private:
+    entry get_entry(size_t i) const;
+
+    model::offset _base_offset;
+    model::timestamp _base_timestamp;
+    std::vector<uint32_t> _offsets;
+    std::vector<uint32_t> _times;
+    std::vector<uint32_t> _positions;
+};
+
+} // namespace archival
@@ -0,0 +1,303 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#include "archival/segment_cache.h"
+
+#include "archival/logger.h"
+#include "config/configuration.h"
+#include "prometheus/prometheus_sanitize.h"
+#include "storage/log_replayer.h"
+#include "utils/directory_walker.h"
+#include "utils/gate_guard.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/metrics.hh>
+#include <seastar/core/seastar.hh>
+#include <seastar/core/thread.hh>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+#include <vector>
+
+namespace archival {
+
+segment_cache::segment_cache(std::filesystem::path dir, size_t max_bytes)
+  : _dir(std::move(dir))
+  , _max_bytes(max_bytes) {}
+
+/// Remove all regular files in 'dir' and the directories below it
+static ss::future<> remove_directory_content(std::filesystem::path dir) {
+    std::vector<ss::directory_entry> entries;
+    co_await directory_walker::walk(
+      dir.string(), [&entries](ss::directory_entry de) {
+          entries.push_back(std::move(de));
+          return ss::now();
+      });
+    for (auto& de : entries) {
+        auto path = dir / de.name.c_str();
+        if (de.type && *de.type == ss::directory_entry_type::directory) {
+            co_await remove_directory_content(path);
+        }
+        co_await ss::remove_file(path.string());
+    }
+}
+
+ss::future<> segment_cache::start() {
+    co_await ss::recursive_touch_directory(_dir.string());
+    // segments left behind by a previous run are not accounted for
+    co_await remove_directory_content(_dir);
+}
+
+ss::future<> segment_cache::stop() {
+    co_await _gate.close();
+    for (auto& [key, e] : _entries) {
+        co_await e.segment->close();
+    }
+    _entries.clear();
+}
+
+void segment_cache::setup_metrics() {
+    if (config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+    namespace sm = ss::metrics;
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("archival:segment_cache"),
+      {
+        sm::make_derive(
+          "hits",
+          [this] { return _hits; },
+          sm::description("Number of reads of segments found in the cache")),
+        sm::make_derive(
+          "misses",
+          [this] { return _misses; },
+          sm::description("Number of reads that downloaded their segment")),
+        sm::make_derive(
+          "prefetches",
+          [this] { return _prefetches; },
+          sm::description("Number of segments downloaded ahead of the reads")),
+        sm::make_derive(
+          "prefetch_hits",
+          [this] { return _prefetch_hits; },
+          sm::description("Number of reads of prefetched segments")),
+        sm::make_derive(
+          "bytes_downloaded",
+          [this] { return _bytes_downloaded; },
+          sm::description("Number of bytes of the downloaded segments")),
+        sm::make_gauge(
+          "size_bytes",
+          [this] { return _size_bytes; },
+          sm::description("Total size of the cached segments")),
+      });
+}
+
+ss::future<ss::lw_shared_ptr<storage::segment>>
+segment_cache::get(const remote_segment_path& path, download_fn download) {
+    gate_guard guard{_gate};
+    auto key = ss::sstring(path().string());
+    while (true) {
+        if (auto it = _entries.find(key); it != _entries.end()) {
+            ++_hits;
+            if (std::exchange(it->second.prefetched, false)) {
+                ++_prefetch_hits;
+            }
+            it->second.last_access = ss::lowres_clock::now();
+            co_return it->second.segment;
+        }
+        auto it = _downloads.find(key);
+        if (it == _downloads.end()) {
+            break;
+        }
+        // wait for the download that is in progress and look again, a
+        // failed prefetch is retried by the read
+        auto d = it->second;
+        ++d->waiters;
+        try {
+            co_await d->done.get_shared_future();
+        } catch (...) {
+        }
+        --d->waiters;
+    }
+    ++_misses;
+    co_return co_await fetch(key, std::move(download), false);
+}
+
+void segment_cache::prefetch(
+  const remote_segment_path& path, download_fn download) {
+    auto key = ss::sstring(path().string());
+    if (
+      _gate.is_closed() || _entries.contains(key) || _downloads.contains(key)) {
+        return;
+    }
+    ++_prefetches;
+    (void)ss::with_gate(
+      _gate, [this, key, download = std::move(download)]() mutable {
+          return fetch(key, std::move(download), true)
+            .discard_result()
+            .handle_exception([key](const std::exception_ptr& e) {
+                vlog(
+                  archival_log.info,
+                  "Failed to prefetch segment {}: {}",
+                  key,
+                  e);
+            });
+      });
+}
+
+ss::future<ss::lw_shared_ptr<storage::segment>> segment_cache::fetch(
+  ss::sstring key, download_fn download, bool prefetched) {
+    auto d = ss::make_lw_shared<download>();
+    _downloads.emplace(key, d);
+    std::exception_ptr e;
+    ss::lw_shared_ptr<storage::segment> seg;
+    try {
+        seg = co_await download_and_open(key, std::move(download), prefetched);
+    } catch (...) {
+        e = std::current_exception();
+    }
+    _downloads.erase(key);
+    if (e) {
+        // nobody would consume the failure of a prefetch nobody waits for
+        if (d->waiters > 0) {
+            d->done.set_exception(e);
+        } else {
+            d->done.set_value();
+        }
+        std::rethrow_exception(e);
+    }
+    d->done.set_value();
+    co_await evict();
+    co_return seg;
+}
+
+ss::future<ss::lw_shared_ptr<storage::segment>>
+segment_cache::download_and_open(
+  const ss::sstring& key, download_fn download, bool prefetched) {
+    // every segment gets its own directory so that the file name stays a
+    // valid segment name
+    auto name = std::filesystem::path(key.c_str()).filename();
+    auto dir = _dir / fmt::format("{}", _next_id++);
+    auto path = dir / name;
+    auto tmp = path;
+    tmp += ".part";
+    co_await ss::recursive_touch_directory(dir.string());
+    vlog(
+      archival_log.debug, "Downloading segment {} to {}", key, path.string());
+    std::exception_ptr e;
+    try {
+        co_await download(tmp);
+        co_await ss::rename_file(tmp.string(), path.string());
+    } catch (...) {
+        e = std::current_exception();
+    }
+    if (e) {
+        co_await remove_directory_content(dir);
+        co_await ss::remove_file(dir.string());
+        std::rethrow_exception(e);
+    }
+
+    auto seg = co_await storage::open_segment(
+      path, storage::debug_sanitize_files::no, std::nullopt);
+    try {
+        // the index is not uploaded, rebuild it from the segment data
+        co_await ss::async([seg] {
+            auto replayer = storage::log_replayer(*seg);
+            auto recovered = replayer.recover_in_thread(
+              ss::default_priority_class());
+            if (!recovered) {
+                throw std::runtime_error(fmt::format(
+                  "Unable to recover downloaded segment {}",
+                  seg->reader().filename()));
+            }
+            seg->truncate(
+                 recovered.last_offset.value(),
+                 recovered.truncate_file_pos.value())
+              .get();
+        });
+    } catch (...) {
+        e = std::current_exception();
+    }
+    if (e) {
+        co_await seg->close();
+        std::rethrow_exception(e);
+    }
+    const auto size = seg->size_bytes();
+    _entries.emplace(
+      key,
+      entry{
+        .segment = seg,
+        .size_bytes = size,
+        .last_access = ss::lowres_clock::now(),
+        .prefetched = prefetched,
+      });
+    _size_bytes += size;
+    _bytes_downloaded += size;
+    vlog(
+      archival_log.debug,
+      "Cached segment {}, size: {}, cache size: {}",
+      key,
+      size,
+      _size_bytes);
+    co_return seg;
+}
+
+ss::future<> segment_cache::evict() {
+    if (_size_bytes <= _max_bytes) {
+        co_return;
+    }
+    // segments referenced outside of the cache are being read
+    std::vector<std::pair<ss::lowres_clock::time_point, ss::sstring>> unused;
+    for (const auto& [key, e] : _entries) {
+        if (e.segment.use_count() == 1) {
+            unused.emplace_back(e.last_access, key);
+        }
+    }
+    std::sort(unused.begin(), unused.end());
+    for (auto& [_, key] : unused) {
+        if (_size_bytes <= _max_bytes) {
+            break;
+        }
+        auto it = _entries.find(key);
+        if (it == _entries.end() || it->second.segment.use_count() != 1) {
+            continue;
+        }
+        auto e = std::move(it->second);
+        _entries.erase(it);
+        _size_bytes -= e.size_bytes;
+        try {
+            co_await remove(std::move(e));
+        } catch (...) {
+            vlog(
+              archival_log.warn,
+              "Failed to remove segment {} from cache: {}",
+              key,
+              std::current_exception());
+        }
+    }
+}
+
+ss::future<> segment_cache::remove(entry e) {
+    vlog(
+      archival_log.debug,
+      "Evicting segment {} from cache",
+      e.segment->reader().filename());
+    auto path = std::filesystem::path(e.segment->reader().filename().c_str());
+    auto index = e.segment->index().filename();
+    co_await e.segment->close();
+    co_await ss::remove_file(path.string());
+    co_await ss::remove_file(index);
+    co_await ss::remove_file(path.parent_path().string());
+}
+
+} // namespace archival
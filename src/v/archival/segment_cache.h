@@ -0,0 +1,133 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#pragma once
+
+#include "archival/types.h"
+#include "seastarx.h"
+#include "storage/probe.h"
+#include "storage/segment.h"
+
+#include <seastar/core/future.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/core/shared_future.hh>
+#include <seastar/core/shared_ptr.hh>
+#include <seastar/util/noncopyable_function.hh>
+
+#include <absl/container/flat_hash_map.h>
+
+#include <filesystem>
+
+namespace archival {
+
+/// Shard-local cache of segments downloaded from S3.
+///
+/// Downloaded segments are stored in the cache directory under their remote
+/// path and opened as regular read-only segments, so they can be read through
+/// the normal storage readers. The total size of the cached segments is
+/// bounded; the least recently used segments that are not being read are
+/// removed once the bound is exceeded.
+///
+/// Sequential readers prefetch the segments that follow the one they read,
+/// the prefetched segments are downloaded in the background and counted as
+/// hits once they are read.
+class segment_cache {
+public:
+    /// Function that writes the object to the file at the given path
+    using download_fn
+      = ss::noncopyable_function<ss::future<>(std::filesystem::path)>;
+
+    /// \param dir is a directory that the cache owns
+    /// \param max_bytes is the total size of segments to keep
+    segment_cache(std::filesystem::path dir, size_t max_bytes);
+
+    /// Create the cache directory and remove the files left in it
+    ss::future<> start();
+
+    /// Close all cached segments, waits for the prefetches
+    ss::future<> stop();
+
+    void setup_metrics();
+
+    /// \brief Get segment stored at 'path' in S3
+    ///
+    /// On a cache miss 'download' is invoked to fetch the object. Concurrent
+    /// requests for the same segment share one download.
+    ///
+    /// \param path is a remote segment path
+    /// \param download is used to fetch the segment on cache miss
+    /// \return opened segment
+    ss::future<ss::lw_shared_ptr<storage::segment>>
+    get(const remote_segment_path& path, download_fn download);
+
+    /// \brief Download segment stored at 'path' in the background unless it
+    /// is cached or being downloaded already
+    ///
+    /// \param path is a remote segment path
+    /// \param download is used to fetch the segment
+    void prefetch(const remote_segment_path& path, download_fn download);
+
+    /// Total size of cached segments
+    size_t size_bytes() const { return _size_bytes; }
+    size_t hits() const { return _hits; }
+    size_t misses() const { return _misses; }
+    size_t prefetches() const { return _prefetches; }
+    /// Hits of segments that were prefetched and not read before
+    size_t prefetch_hits() const { return _prefetch_hits; }
+    size_t bytes_downloaded() const { return _bytes_downloaded; }
+
+    /// Probe shared by the readers of cached segments
+    storage::probe& reader_probe() { return _probe; }
+
+private:
+    struct entry {
+        ss::lw_shared_ptr<storage::segment> segment;
+        size_t size_bytes;
+        ss::lowres_clock::time_point last_access;
+        /// prefetched and not read yet
+        bool prefetched{false};
+    };
+
+    /// Download the segment unless another download of it is in progress
+    ss::future<ss::lw_shared_ptr<storage::segment>>
+    fetch(ss::sstring key, download_fn download, bool prefetched);
+    ss::future<ss::lw_shared_ptr<storage::segment>> download_and_open(
+      const ss::sstring& key, download_fn download, bool prefetched);
+
+    /// Remove least recently used segments while over budget
+    ss::future<> evict();
+    ss::future<> remove(entry);
+
+    std::filesystem::path _dir;
+    size_t _max_bytes;
+    size_t _size_bytes{0};
+    size_t _hits{0};
+    size_t _misses{0};
+    size_t _prefetches{0};
+    size_t _prefetch_hits{0};
+    size_t _bytes_downloaded{0};
+    size_t _next_id{0};
+    absl::flat_hash_map<ss::sstring, entry> _entries;
+    struct download {
+        ss::shared_promise<> done;
+        /// reads waiting for the download, a failure is only reported to
+        /// them
+        size_t waiters{0};
+    };
+
+    absl::flat_hash_map<ss::sstring, ss::lw_shared_ptr<download>> _downloads;
+    storage::probe _probe;
+    ss::gate _gate;
+    ss::metrics::metric_groups _metrics;
+};
+
+} // namespace archival
@@ -12,6 +12,7 @@
 
 #include "archival/logger.h"
 #include "archival/ntp_archiver_service.h"
+#include "archival/remote_partition.h"
 #include "cluster/partition_manager.h"
 #include "cluster/topic_table.h"
 #include "config/configuration.h"
@@ -37,8 +38,6 @@
 #include <seastar/core/smp.hh>
 #include <seastar/core/when_all.hh>
 
-#include <boost/iterator/counting_iterator.hpp>
-
 #include <algorithm>
 #include <exception>
 #include <stdexcept>
@@ -141,7 +140,18 @@ scheduler_service_impl::get_archival_service_config() {
       .interval
       = config::shard_local_cfg().cloud_storage_reconciliation_ms.value(),
       .connection_limit = s3_connection_limit(
-        config::shard_local_cfg().cloud_storage_max_connections.value())};
+        config::shard_local_cfg().cloud_storage_max_connections.value()),
+      .cache_directory = config::shard_local_cfg().data_directory().path
+                         / "cloud_storage_cache",
+      .cache_size = config::shard_local_cfg().cloud_storage_cache_size(),
+      .cache_prefetch
+      = config::shard_local_cfg().cloud_storage_cache_prefetch_segments(),
+      .upload_part_size
+      = config::shard_local_cfg().cloud_storage_upload_part_size(),
+      .upload_bandwidth
+      = config::shard_local_cfg().cloud_storage_upload_bandwidth(),
+      .incremental_manifest
+      = config::shard_local_cfg().cloud_storage_incremental_manifest()};
     vlog(archival_log.debug, "Archival configuration generated: {}", cfg);
     co_return cfg;
 }
@@ -158,7 +168,9 @@ scheduler_service_impl::scheduler_service_impl(
   , _jitter(conf.interval, 1ms)
   , _gc_jitter(conf.gc_interval, 1ms)
   , _conn_limit(conf.connection_limit())
-  , _stop_limit(conf.connection_limit()) {}
+  , _stop_limit(conf.connection_limit())
+  , _pool(conf.client_config, conf.connection_limit())
+  , _scheduler(conf.upload_bandwidth) {}
 
 scheduler_service_impl::scheduler_service_impl(
   ss::sharded<storage::api>& api,
@@ -181,15 +193,35 @@ void scheduler_service_impl::rearm_timer() {
           });
     });
 }
+ss::future<> scheduler_service_impl::start_remote_reads() {
+    if (_conf.cache_size == 0) {
+        co_return;
+    }
+    _cache = std::make_unique<segment_cache>(
+      _conf.cache_directory / fmt::format("{}", ss::this_shard_id()),
+      _conf.cache_size);
+    co_await _cache->start();
+    _cache->setup_metrics();
+    // fetches below the local start offset fall back to the archived data
+    _partition_manager.local().register_remote_reader(
+      [this](const model::ntp& ntp, storage::log_reader_config cfg) {
+          return make_remote_reader(ntp, cfg);
+      });
+}
+
 ss::future<> scheduler_service_impl::start() {
+    co_await start_remote_reads();
+    _pool.setup_metrics();
     _timer.set_callback([this] { rearm_timer(); });
     _timer.rearm(_jitter());
     (void)run_uploads();
-    return ss::now();
 }
 
 ss::future<> scheduler_service_impl::stop() {
     vlog(archival_log.info, "Scheduler service stop");
+    if (_cache) {
+        _partition_manager.local().unregister_remote_reader();
+    }
     _timer.cancel();
     _as.request_abort();
     std::vector<ss::future<>> outstanding;
@@ -201,10 +233,39 @@ ss::future<> scheduler_service_impl::stop() {
     return ss::do_with(
       std::move(outstanding), [this](std::vector<ss::future<>>& outstanding) {
           return ss::when_all_succeed(outstanding.begin(), outstanding.end())
-            .then([this] { return _gate.close(); });
+            .then([this] { return _gate.close(); })
+            // the prefetches of the cache use the pool
+            .then([this] { return _cache ? _cache->stop() : ss::now(); })
+            .then([this] { return _pool.stop(); });
       });
 }
 
+ss::future<std::optional<model::record_batch_reader>>
+scheduler_service_impl::make_remote_reader(
+  const model::ntp& ntp, storage::log_reader_config config) {
+    if (!_cache || !_queue.contains(ntp)) {
+        co_return std::nullopt;
+    }
+    gate_guard gg(_gate);
+    // keeps the manifest alive while the reader is created
+    auto archiver = _queue[ntp];
+    // consumers catching up move on to the local log, whose segments aren't
+    // worth downloading
+    auto local_start = model::offset::max();
+    if (auto p = _partition_manager.local().get(ntp); p) {
+        local_start = p->start_offset();
+    }
+    remote_partition partition(
+      archiver->get_remote_manifest(),
+      _pool,
+      _conf.bucket_name,
+      *_cache,
+      _as,
+      _conf.cache_prefetch,
+      local_start);
+    co_return co_await partition.make_reader(std::move(config));
+}
+
 ss::lw_shared_ptr<ntp_archiver> scheduler_service_impl::get_upload_candidate() {
     return _queue.get_upload_candidate();
 }
@@ -217,19 +278,20 @@ ss::future<> scheduler_service_impl::upload_topic_manifest(
         try {
             auto units = co_await ss::get_units(_conn_limit, 1);
             vlog(archival_log.info, "Uploading topic manifest {}", view);
-            s3::client client(_conf.client_config, _as);
             topic_manifest tm(*cfg, rev);
-            auto [istr, size_bytes] = tm.serialize();
+            auto serialized = tm.serialize();
             auto key = tm.get_manifest_path();
             vlog(archival_log.debug, "Topic manifest object key is '{}'", key);
             std::vector<s3::object_tag> tags = {{"rp-type", "topic-manifest"}};
-            co_await client.put_object(
-              _conf.bucket_name,
-              s3::object_key(key),
-              size_bytes,
-              std::move(istr),
-              tags);
-            co_await client.shutdown();
+            co_await _pool.with_client(
+              _as, [this, &key, &serialized, &tags](s3::client& client) {
+                  return client.put_object(
+                    _conf.bucket_name,
+                    s3::object_key(key),
+                    serialized.size_bytes,
+                    std::move(serialized.stream),
+                    tags);
+              });
         } catch (const s3::rest_error_response& err) {
             vlog(
               archival_log.error,
@@ -262,7 +324,7 @@ scheduler_service_impl::create_archivers(std::vector<model::ntp> to_create) {
                     return ss::now();
                 }
                 auto svc = ss::make_lw_shared<ntp_archiver>(
-                  log->config(), _conf);
+                  log->config(), _conf, _pool);
                 return ss::repeat([this, svc, ntp] {
                     return svc->download_manifest()
                       .then(
@@ -271,6 +333,7 @@ scheduler_service_impl::create_archivers(std::vector<model::ntp> to_create) {
                             switch (result) {
                             case download_manifest_result::success:
                                 _queue.insert(svc);
+                                svc->setup_metrics();
                                 vlog(
                                   archival_log.info,
                                   "Found manifest for partition {}",
@@ -279,6 +342,7 @@ scheduler_service_impl::create_archivers(std::vector<model::ntp> to_create) {
                                   ss::stop_iteration>(ss::stop_iteration::yes);
                             case download_manifest_result::notfound:
                                 _queue.insert(svc);
+                                svc->setup_metrics();
                                 vlog(
                                   archival_log.info,
                                   "Start archiving new partition {}",
@@ -353,6 +417,7 @@ scheduler_service_impl::remove_archivers(std::vector<model::ntp> to_remove) {
             .finally([this, ntp] {
                 vlog(archival_log.info, "archiver stopped {}", ntp.path());
                 _queue.erase(ntp);
+                _scheduler.remove(ntp);
             });
       });
 }
@@ -410,23 +475,27 @@ ss::future<> scheduler_service_impl::run_uploads() {
         const ss::lowres_clock::duration max_backoff = 5s;
         ss::lowres_clock::duration backoff = initial_backoff;
         while (!_gate.is_closed()) {
-            int quota = _queue.size();
+            std::vector<upload_scheduler::pending_partition> pending;
+            pending.reserve(_queue.size());
+            for (const auto& [ntp, it] : _queue) {
+                pending.push_back(
+                  {.ntp = ntp,
+                   .oldest_pending = it.archiver->get_oldest_pending()});
+            }
+            // Archivers are started in the order of the round, the
+            // connections and bandwidth are handed out in the same order
             std::vector<ss::future<ntp_archiver::batch_result>> flist;
-
-            std::transform(
-              boost::make_counting_iterator(0),
-              boost::make_counting_iterator(quota),
-              std::back_inserter(flist),
-              [this](int) {
-                  auto archiver = _queue.get_upload_candidate();
-                  storage::api& api = _storage_api.local();
-                  storage::log_manager& lm = api.log_mgr();
-                  vlog(
-                    archival_log.debug,
-                    "Checking {} for S3 upload candidates",
-                    archiver->get_ntp());
-                  return archiver->upload_next_candidates(_conn_limit, lm);
-              });
+            for (const auto& ntp : _scheduler.schedule(pending)) {
+                auto archiver = _queue[ntp];
+                storage::api& api = _storage_api.local();
+                storage::log_manager& lm = api.log_mgr();
+                vlog(
+                  archival_log.debug,
+                  "Checking {} for S3 upload candidates",
+                  archiver->get_ntp());
+                flist.emplace_back(archiver->upload_next_candidates(
+                  _conn_limit, lm, _scheduler));
+            }
 
             auto results = co_await ss::when_all_succeed(
               flist.begin(), flist.end());
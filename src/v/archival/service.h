@@ -11,9 +11,12 @@
 #pragma once
 #include "archival/manifest.h"
 #include "archival/ntp_archiver_service.h"
+#include "archival/remote_partition.h"
+#include "archival/upload_scheduler.h"
 #include "cluster/partition_manager.h"
 #include "model/fundamental.h"
 #include "s3/client.h"
+#include "s3/client_pool.h"
 #include "storage/api.h"
 #include "storage/log_manager.h"
 #include "storage/ntp_config.h"
@@ -87,8 +90,8 @@ void ntp_upload_queue::copy_if(FwdIt out, const Func& pred) const {
 /// archivers gets removed and new are added. The service runs a simple
 /// workflow on its working set:
 /// - Reconcile working set
-/// - Choose next candidate(s) archiver(s)
-/// - Start configured number of uploads
+/// - Choose next candidate(s) archiver(s), fairly by uploaded bytes
+/// - Start configured number of uploads within the bandwidth cap
 /// - Re-upload manifest(s)
 /// - Reset timer
 class scheduler_service_impl {
@@ -146,6 +149,23 @@ public:
     /// Return range with all available ntps
     bool contains(const model::ntp& ntp) const { return _queue.contains(ntp); }
 
+    /// \brief Create reader for data of 'ntp' that was archived to S3
+    ///
+    /// Used to serve offsets below the local start offset of the log.
+    ///
+    /// \param ntp is an ntp of the log
+    /// \param config is a reader config
+    /// \return reader or nullopt if remote reads are disabled or no archived
+    ///         segment covers the start offset
+    ss::future<std::optional<model::record_batch_reader>>
+    make_remote_reader(const model::ntp& ntp, storage::log_reader_config config);
+
+    /// \brief Open the segment cache and serve the fetches below the local
+    /// start offset of the partitions from S3
+    ///
+    /// Part of start(), it does nothing when the cache is disabled.
+    ss::future<> start_remote_reads();
+
 private:
     /// Remove archivers from the workingset
     ss::future<> remove_archivers(std::vector<model::ntp> to_remove);
@@ -165,8 +185,12 @@ private:
     ss::abort_source _as;
     ss::semaphore _conn_limit;
     ss::semaphore _stop_limit;
+    /// Connections to S3 shared by the archivers and the remote reads
+    s3::client_pool _pool;
     ntp_upload_queue _queue;
+    upload_scheduler _scheduler;
     simple_time_jitter<ss::lowres_clock> _backoff{100ms};
+    std::unique_ptr<segment_cache> _cache;
 };
 
 } // namespace internal
@@ -196,6 +220,9 @@ public:
 
     /// Generate configuration
     using internal::scheduler_service_impl::get_archival_service_config;
+
+    /// Read archived data
+    using internal::scheduler_service_impl::make_remote_reader;
 };
 
 } // namespace archival
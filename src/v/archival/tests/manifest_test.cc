@@ -9,6 +9,7 @@
  */
 
 #include "archival/manifest.h"
+#include "archival/remote_segment_index.h"
 #include "bytes/iobuf.h"
 #include "bytes/iobuf_parser.h"
 #include "model/metadata.h"
@@ -27,6 +28,7 @@
 
 #include <chrono>
 #include <exception>
+#include <vector>
 
 using namespace archival;
 
@@ -169,3 +171,138 @@ SEASTAR_THREAD_TEST_CASE(test_manifest_difference) {
         BOOST_REQUIRE(c.size() == 0);
     }
 }
+
+static manifest make_manifest(std::vector<std::pair<int64_t, int64_t>> ranges) {
+    manifest m(manifest_ntp, model::revision_id(0));
+    for (auto [base, committed] : ranges) {
+        m.add(
+          segment_name(fmt::format("{}-1-v1.log", base)),
+          {
+            .is_compacted = false,
+            .size_bytes = 1024,
+            .base_offset = model::offset(base),
+            .committed_offset = model::offset(committed),
+          });
+    }
+    return m;
+}
+
+SEASTAR_THREAD_TEST_CASE(test_manifest_delta_path) {
+    manifest m(manifest_ntp, model::revision_id(0));
+    BOOST_REQUIRE_EQUAL(
+      m.get_binary_manifest_path(),
+      "20000000/meta/test-ns/test-topic/42_0/manifest.bin");
+    BOOST_REQUIRE_EQUAL(
+      m.get_delta_path(12),
+      "20000000/meta/test-ns/test-topic/42_0/deltas/00000000000000000012.bin");
+    // the listing of the deltas is ordered by sequence number
+    BOOST_REQUIRE(
+      m.get_delta_path(9)().string() < m.get_delta_path(10)().string());
+}
+
+SEASTAR_THREAD_TEST_CASE(test_manifest_binary_serialization) {
+    auto m = make_manifest({{10, 19}, {20, 29}, {30, 39}});
+    m.set_last_delta(7);
+    auto buf = m.to_iobuf();
+    BOOST_REQUIRE_LT(buf.size_bytes(), m.serialize().size_bytes);
+
+    manifest restored;
+    restored.update(make_iobuf_input_stream(std::move(buf))).get0();
+    BOOST_REQUIRE(m == restored);
+    BOOST_REQUIRE_EQUAL(restored.get_last_delta(), 7);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_manifest_apply_delta) {
+    auto m = make_manifest({{10, 19}, {20, 29}});
+    auto delta = make_manifest({{30, 39}});
+    delta.set_last_delta(3);
+    m.apply_delta(delta);
+    BOOST_REQUIRE_EQUAL(m.size(), 3);
+    BOOST_REQUIRE_EQUAL(m.get_last_offset(), model::offset(39));
+    BOOST_REQUIRE_EQUAL(m.get_last_delta(), 3);
+    auto expected = make_manifest({{10, 19}, {20, 29}, {30, 39}});
+    expected.set_last_delta(3);
+    BOOST_REQUIRE(m == expected);
+
+    manifest other(
+      model::ntp(
+        model::ns("test-ns"), model::topic("other"), model::partition_id(42)),
+      model::revision_id(0));
+    BOOST_REQUIRE_THROW(m.apply_delta(other), std::logic_error);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_manifest_find_by_offset) {
+    // names sort differently than offsets
+    auto m = make_manifest({{5, 9}, {10, 49}, {100, 199}});
+    BOOST_REQUIRE(m.find_by_offset(model::offset(10))->first == "10-1-v1.log");
+    BOOST_REQUIRE(m.find_by_offset(model::offset(49))->first == "10-1-v1.log");
+    BOOST_REQUIRE(m.find_by_offset(model::offset(0))->first == "5-1-v1.log");
+    // the first segment after a gap
+    BOOST_REQUIRE(m.find_by_offset(model::offset(60))->first == "100-1-v1.log");
+    BOOST_REQUIRE(m.find_by_offset(model::offset(200)) == m.end());
+
+    m.delete_permanently(segment_name("10-1-v1.log"));
+    BOOST_REQUIRE(m.find_by_offset(model::offset(10))->first == "100-1-v1.log");
+}
+
+SEASTAR_THREAD_TEST_CASE(test_manifest_segment_index_flag) {
+    auto m = make_manifest({{10, 19}, {20, 29}});
+    m.add(
+      segment_name("30-1-v1.log"),
+      {
+        .is_compacted = false,
+        .size_bytes = 1024,
+        .base_offset = model::offset(30),
+        .committed_offset = model::offset(39),
+        .has_index = true,
+      });
+    BOOST_REQUIRE_EQUAL(
+      m.get_remote_index_path(segment_name("30-1-v1.log"))().string(),
+      m.get_remote_segment_path(segment_name("30-1-v1.log"))().string()
+        + ".index");
+
+    auto [is, size] = m.serialize();
+    iobuf json;
+    auto os = make_iobuf_ref_output_stream(json);
+    ss::copy(is, os).get();
+    manifest from_json;
+    from_json.update(make_iobuf_input_stream(std::move(json))).get0();
+    BOOST_REQUIRE(m == from_json);
+    BOOST_REQUIRE(from_json.get(segment_name("30-1-v1.log"))->has_index);
+    BOOST_REQUIRE(!from_json.get(segment_name("20-1-v1.log"))->has_index);
+
+    manifest from_binary;
+    from_binary.update(make_iobuf_input_stream(m.to_iobuf())).get0();
+    BOOST_REQUIRE(m == from_binary);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_remote_segment_index) {
+    storage::index_state state;
+    state.base_offset = model::offset(100);
+    state.base_timestamp = model::timestamp(1000);
+    // offset, time and position relative to the segment
+    state.add_entry(0, 0, 0);
+    state.add_entry(10, 5, 4096);
+    state.add_entry(20, 10, 8192);
+    state.add_entry(30, 15, 12288);
+
+    // the object starts at the second batch
+    auto index = remote_segment_index::from_segment(
+      state, model::offset(110), 4096);
+    BOOST_REQUIRE_EQUAL(index.size(), 3);
+
+    auto restored = remote_segment_index::from_iobuf(index.to_iobuf());
+    BOOST_REQUIRE_EQUAL(restored.size(), 3);
+
+    auto e = restored.find_nearest(model::offset(125));
+    BOOST_REQUIRE(e.has_value());
+    BOOST_REQUIRE_EQUAL(e->offset, model::offset(120));
+    BOOST_REQUIRE_EQUAL(e->position, 4096);
+    BOOST_REQUIRE(!restored.find_nearest(model::offset(105)).has_value());
+
+    e = restored.find_nearest(model::timestamp(1012));
+    BOOST_REQUIRE(e.has_value());
+    BOOST_REQUIRE_EQUAL(e->timestamp, model::timestamp(1015));
+    BOOST_REQUIRE_EQUAL(e->position, 8192);
+    BOOST_REQUIRE(!restored.find_nearest(model::timestamp(1016)).has_value());
+}
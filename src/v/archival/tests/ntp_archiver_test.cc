@@ -10,11 +10,15 @@
 
 #include "archival/archival_policy.h"
 #include "archival/ntp_archiver_service.h"
+#include "archival/remote_partition.h"
+#include "archival/segment_cache.h"
 #include "archival/tests/service_fixture.h"
 #include "cluster/types.h"
 #include "model/metadata.h"
+#include "s3/client_pool.h"
 #include "storage/disk_log_impl.h"
 #include "test_utils/fixture.h"
+#include "units.h"
 #include "utils/unresolved_address.h"
 
 #include <seastar/core/future-util.hh>
@@ -123,9 +127,21 @@ compare_json_objects(const std::string_view& lhs, const std::string_view& rhs) {
     return lhsd == rhsd;
 }
 
+/// Connections to the imposter, closed at the end of the test
+struct test_client_pool : s3::client_pool {
+    test_client_pool()
+      : s3::client_pool(get_configuration().client_config, 2) {}
+    test_client_pool(const test_client_pool&) = delete;
+    test_client_pool& operator=(const test_client_pool&) = delete;
+    test_client_pool(test_client_pool&&) = delete;
+    test_client_pool& operator=(test_client_pool&&) = delete;
+    ~test_client_pool() { stop().get(); }
+};
+
 FIXTURE_TEST(test_download_manifest, s3_imposter_fixture) { // NOLINT
     set_expectations_and_listen(default_expectations);
-    archival::ntp_archiver archiver(get_ntp_conf(), get_configuration());
+    test_client_pool pool;
+    archival::ntp_archiver archiver(get_ntp_conf(), get_configuration(), pool);
     auto action = ss::defer([&archiver] { archiver.stop().get(); });
     archiver.download_manifest().get();
     auto expected = load_manifest(manifest_payload);
@@ -134,7 +150,8 @@ FIXTURE_TEST(test_download_manifest, s3_imposter_fixture) { // NOLINT
 
 FIXTURE_TEST(test_upload_manifest, s3_imposter_fixture) { // NOLINT
     set_expectations_and_listen(default_expectations);
-    archival::ntp_archiver archiver(get_ntp_conf(), get_configuration());
+    test_client_pool pool;
+    archival::ntp_archiver archiver(get_ntp_conf(), get_configuration(), pool);
     auto action = ss::defer([&archiver] { archiver.stop().get(); });
     auto pm = const_cast<manifest*>( // NOLINT
       &archiver.get_remote_manifest());
@@ -163,7 +180,8 @@ FIXTURE_TEST(test_upload_manifest, s3_imposter_fixture) { // NOLINT
 // NOLINTNEXTLINE
 FIXTURE_TEST(test_upload_segments, archiver_fixture) {
     set_expectations_and_listen(default_expectations);
-    archival::ntp_archiver archiver(get_ntp_conf(), get_configuration());
+    test_client_pool pool;
+    archival::ntp_archiver archiver(get_ntp_conf(), get_configuration(), pool);
     auto action = ss::defer([&archiver] { archiver.stop().get(); });
 
     std::vector<segment_desc> segments = {
@@ -173,9 +191,10 @@ FIXTURE_TEST(test_upload_segments, archiver_fixture) {
     init_storage_api_local(segments);
 
     ss::semaphore limit(2);
+    archival::upload_scheduler sched;
     auto res = archiver
                  .upload_next_candidates(
-                   limit, get_local_storage_api().log_mgr())
+                   limit, get_local_storage_api().log_mgr(), sched)
                  .get0();
     BOOST_REQUIRE_EQUAL(res.num_succeded, 2);
     BOOST_REQUIRE_EQUAL(res.num_failed, 0);
@@ -256,13 +275,17 @@ FIXTURE_TEST(test_archiver_policy, archiver_fixture) {
     };
     log_segment_set(lm);
     // Starting offset is lower than offset1
-    auto upload1 = policy.get_next_candidate(model::offset(0), lm);
+    auto upload1 = policy.get_next_candidate(model::offset(0), lm).get0();
     log_upload_candidate(upload1);
     BOOST_REQUIRE(upload1.source.get() != nullptr);
     BOOST_REQUIRE(upload1.starting_offset == offset1);
 
-    auto upload2 = policy.get_next_candidate(
-      upload1.source->offsets().committed_offset + model::offset(1), lm);
+    auto upload2 = policy
+                     .get_next_candidate(
+                       upload1.source->offsets().committed_offset
+                         + model::offset(1),
+                       lm)
+                     .get0();
     log_upload_candidate(upload2);
     BOOST_REQUIRE(upload2.source.get() != nullptr);
     BOOST_REQUIRE(upload2.starting_offset() == offset2);
@@ -270,8 +293,12 @@ FIXTURE_TEST(test_archiver_policy, archiver_fixture) {
     BOOST_REQUIRE(upload2.source != upload1.source);
     BOOST_REQUIRE(upload2.source->offsets().base_offset == offset2);
 
-    auto upload3 = policy.get_next_candidate(
-      upload2.source->offsets().committed_offset + model::offset(1), lm);
+    auto upload3 = policy
+                     .get_next_candidate(
+                       upload2.source->offsets().committed_offset
+                         + model::offset(1),
+                       lm)
+                     .get0();
     log_upload_candidate(upload3);
     BOOST_REQUIRE(upload3.source.get() != nullptr);
     BOOST_REQUIRE(upload3.starting_offset() == offset3);
@@ -279,7 +306,145 @@ FIXTURE_TEST(test_archiver_policy, archiver_fixture) {
     BOOST_REQUIRE(upload3.source != upload2.source);
     BOOST_REQUIRE(upload3.source->offsets().base_offset == offset3);
 
-    auto upload4 = policy.get_next_candidate(
-      upload3.source->offsets().committed_offset + model::offset(1), lm);
+    auto upload4 = policy
+                     .get_next_candidate(
+                       upload3.source->offsets().committed_offset
+                         + model::offset(1),
+                       lm)
+                     .get0();
     BOOST_REQUIRE(upload4.source.get() == nullptr);
 }
+
+// NOLINTNEXTLINE
+FIXTURE_TEST(test_remote_partition_read, archiver_fixture) {
+    set_expectations_and_listen(default_expectations);
+    auto conf = get_configuration();
+    test_client_pool pool;
+    archival::ntp_archiver archiver(get_ntp_conf(), conf, pool);
+    auto action = ss::defer([&archiver] { archiver.stop().get(); });
+
+    std::vector<segment_desc> segments = {
+      {manifest_ntp, model::offset(1), model::term_id(2)},
+      {manifest_ntp, model::offset(1000), model::term_id(4)},
+    };
+    init_storage_api_local(segments);
+
+    ss::semaphore limit(2);
+    archival::upload_scheduler sched;
+    auto res = archiver
+                 .upload_next_candidates(
+                   limit, get_local_storage_api().log_mgr(), sched)
+                 .get0();
+    BOOST_REQUIRE_EQUAL(res.num_succeded, 2);
+
+    archival::segment_cache cache(data_dir / "remote_cache", 1_GiB);
+    cache.start().get();
+    auto stop_cache = ss::defer([&cache] { cache.stop().get(); });
+    ss::abort_source as;
+    archival::remote_partition partition(
+      archiver.get_remote_manifest(),
+      pool,
+      conf.bucket_name,
+      cache,
+      as);
+    BOOST_REQUIRE(partition.start_offset() == model::offset(1));
+
+    auto log = get_local_storage_api().log_mgr().get(manifest_ntp);
+    auto read_segment = [&](const char* name) {
+        const auto* meta = archiver.get_remote_manifest().get(
+          segment_name(name));
+        BOOST_REQUIRE(meta != nullptr);
+        storage::log_reader_config cfg(
+          meta->base_offset,
+          model::model_limits<model::offset>::max(),
+          ss::default_priority_class());
+        auto reader = partition.make_reader(cfg).get0();
+        BOOST_REQUIRE(reader);
+        auto remote = model::consume_reader_to_memory(
+                        std::move(*reader), model::no_timeout)
+                        .get0();
+        cfg.max_offset = meta->committed_offset;
+        auto local = model::consume_reader_to_memory(
+                       log->make_reader(cfg).get0(), model::no_timeout)
+                       .get0();
+        BOOST_REQUIRE(!remote.empty());
+        BOOST_REQUIRE_EQUAL(remote.size(), local.size());
+        for (size_t i = 0; i < remote.size(); ++i) {
+            BOOST_REQUIRE_EQUAL(remote[i], local[i]);
+        }
+    };
+
+    read_segment("1-2-v1.log");
+    read_segment("1000-4-v1.log");
+    BOOST_REQUIRE_EQUAL(cache.misses(), 2);
+    BOOST_REQUIRE_EQUAL(cache.hits(), 0);
+
+    // served from the cache the second time
+    read_segment("1-2-v1.log");
+    BOOST_REQUIRE_EQUAL(cache.misses(), 2);
+    BOOST_REQUIRE_EQUAL(cache.hits(), 1);
+
+    // nothing past the last archived offset
+    storage::log_reader_config cfg(
+      archiver.get_remote_manifest().get_last_offset() + model::offset(1),
+      model::model_limits<model::offset>::max(),
+      ss::default_priority_class());
+    BOOST_REQUIRE(!partition.make_reader(cfg).get0());
+}
+
+// NOLINTNEXTLINE
+FIXTURE_TEST(test_remote_partition_prefetch, archiver_fixture) {
+    set_expectations_and_listen(default_expectations);
+    auto conf = get_configuration();
+    test_client_pool pool;
+    archival::ntp_archiver archiver(get_ntp_conf(), conf, pool);
+    auto action = ss::defer([&archiver] { archiver.stop().get(); });
+
+    std::vector<segment_desc> segments = {
+      {manifest_ntp, model::offset(1), model::term_id(2)},
+      {manifest_ntp, model::offset(1000), model::term_id(4)},
+    };
+    init_storage_api_local(segments);
+
+    ss::semaphore limit(2);
+    archival::upload_scheduler sched;
+    auto res = archiver
+                 .upload_next_candidates(
+                   limit, get_local_storage_api().log_mgr(), sched)
+                 .get0();
+    BOOST_REQUIRE_EQUAL(res.num_succeded, 2);
+
+    archival::segment_cache cache(data_dir / "remote_cache", 1_GiB);
+    cache.start().get();
+    auto stop_cache = ss::defer([&cache] { cache.stop().get(); });
+    ss::abort_source as;
+    archival::remote_partition partition(
+      archiver.get_remote_manifest(), pool, conf.bucket_name, cache, as, 1);
+
+    auto read_segment = [&](const char* name) {
+        const auto* meta = archiver.get_remote_manifest().get(
+          segment_name(name));
+        BOOST_REQUIRE(meta != nullptr);
+        storage::log_reader_config cfg(
+          meta->base_offset,
+          model::model_limits<model::offset>::max(),
+          ss::default_priority_class());
+        auto reader = partition.make_reader(cfg).get0();
+        BOOST_REQUIRE(reader);
+        auto batches = model::consume_reader_to_memory(
+                         std::move(*reader), model::no_timeout)
+                         .get0();
+        BOOST_REQUIRE(!batches.empty());
+    };
+
+    // reading the first segment prefetches the second one, whose read waits
+    // for the prefetch if it is still in progress
+    read_segment("1-2-v1.log");
+    BOOST_REQUIRE_EQUAL(cache.misses(), 1);
+    BOOST_REQUIRE_EQUAL(cache.prefetches(), 1);
+    read_segment("1000-4-v1.log");
+    BOOST_REQUIRE_EQUAL(cache.misses(), 1);
+    BOOST_REQUIRE_EQUAL(cache.hits(), 1);
+    BOOST_REQUIRE_EQUAL(cache.prefetch_hits(), 1);
+    BOOST_REQUIRE_EQUAL(cache.bytes_downloaded(), cache.size_bytes());
+}
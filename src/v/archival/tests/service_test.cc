@@ -12,8 +12,10 @@
 #include "archival/service.h"
 #include "archival/tests/service_fixture.h"
 #include "cluster/commands.h"
+#include "kafka/protocol/fetch.h"
 #include "storage/types.h"
 #include "test_utils/async.h"
+#include "units.h"
 #include "utils/unresolved_address.h"
 
 #include <seastar/core/deleter.hh>
@@ -22,13 +24,17 @@
 #include <seastar/core/lowres_clock.hh>
 #include <seastar/core/metrics.hh>
 #include <seastar/core/smp.hh>
+#include <seastar/core/sleep.hh>
 #include <seastar/core/sstring.hh>
 #include <seastar/http/request.hh>
 #include <seastar/testing/thread_test_case.hh>
+#include <seastar/util/defer.hh>
 #include <seastar/util/log.hh>
 
 #include <boost/algorithm/string.hpp>
 
+#include <algorithm>
+#include <limits>
 #include <type_traits>
 
 inline seastar::logger arch_svc_log("SVC-TEST");
@@ -199,3 +205,105 @@ FIXTURE_TEST(test_segment_upload, archiver_fixture) {
       ntp, archival::segment_name("100-0-v1.log"), put_seg100->second.content);
     service.stop().get();
 }
+
+FIXTURE_TEST(test_fetch_from_archived_segment, archiver_fixture) {
+    wait_for_controller_leadership().get();
+
+    // the layout of test_segment_upload, the archived segments have the same
+    // names
+    auto topic = model::topic("topic_3");
+    auto ntp = model::ntp(test_ns, topic, model::partition_id(0));
+
+    const char* manifest_url
+      = "/c0000000/meta/test-namespace/topic_3/0_2/manifest.json";
+    const char* topic_url
+      = "/00000000/meta/test-namespace/topic_3/topic_manifest.json";
+    const char* seg000 = "/e34f82da/test-namespace/topic_3/0_2/0-0-v1.log";
+    const char* seg100 = "/dd2813e1/test-namespace/topic_3/0_2/100-0-v1.log";
+    set_expectations_and_listen({
+      {.url = manifest_url, .body = std::nullopt},
+      {.url = topic_url, .body = std::nullopt},
+      {.url = seg000, .body = std::nullopt},
+      {.url = seg100, .body = std::nullopt},
+    });
+
+    auto builder = get_started_log_builder(ntp, model::revision_id(2));
+    using namespace storage; // NOLINT
+    (*builder) | add_segment(model::offset(0))
+      | add_random_batch(model::offset(0), 100, maybe_compress_batches::no)
+      | add_segment(model::offset(100))
+      | add_random_batch(model::offset(100), 100, maybe_compress_batches::no)
+      | stop();
+    builder.reset();
+    add_topic(model::topic_namespace_view(ntp)).get();
+
+    wait_for_partition_leadership(ntp);
+    auto& pm = app.partition_manager;
+    tests::cooperative_spin_wait_with_timeout(10s, [&pm, ntp] {
+        return pm.local().get(ntp)->high_watermark() >= model::offset(199);
+    }).get();
+
+    auto config = get_configuration();
+    config.cache_directory = data_dir / "cloud_storage_cache";
+    config.cache_size = 1_GiB;
+    config.cache_prefetch = 1;
+    auto& api = app.storage;
+    auto& topics = app.controller->get_topics_state();
+    archival::internal::scheduler_service_impl service(config, api, pm, topics);
+    auto stop_service = ss::defer([&service] { service.stop().get(); });
+    service.start_remote_reads().get();
+
+    service.reconcile_archivers().get();
+    BOOST_REQUIRE(service.contains(ntp));
+    (void)service.run_uploads();
+    tests::cooperative_spin_wait_with_timeout(10s, [this, seg000, seg100] {
+        return get_targets().count(seg000) == 1
+               && get_targets().count(seg100) == 1;
+    }).get();
+
+    // the first segment is only in S3 once local retention removed it
+    auto log = api.local().log_mgr().get(ntp);
+    BOOST_REQUIRE(log);
+    log
+      ->truncate_prefix(storage::truncate_prefix_config(
+        model::offset(100), ss::default_priority_class()))
+      .get();
+    BOOST_REQUIRE_EQUAL(
+      pm.local().get(ntp)->start_offset(), model::offset(100));
+
+    kafka::fetch_config fetch_cfg{
+      .start_offset = model::offset(0),
+      .max_bytes = std::numeric_limits<size_t>::max(),
+      .timeout = model::no_timeout,
+    };
+    auto res = kafka::read_from_ntp(
+                 pm.local(),
+                 model::materialized_ntp(ntp),
+                 fetch_cfg,
+                 false,
+                 model::no_timeout)
+                 .get0();
+    BOOST_REQUIRE_EQUAL(res.error, kafka::error_code::none);
+    BOOST_REQUIRE(res.reader);
+    auto batches = model::consume_reader_to_memory(
+                     std::move(*res.reader), model::no_timeout)
+                     .get0();
+    BOOST_REQUIRE(!batches.empty());
+    BOOST_REQUIRE_EQUAL(batches.front().base_offset(), model::offset(0));
+    BOOST_REQUIRE(batches.back().last_offset() < model::offset(100));
+    // downloaded from S3
+    BOOST_REQUIRE(std::any_of(
+      get_requests().begin(),
+      get_requests().end(),
+      [seg000](const ss::httpd::request& r) {
+          return r._url == seg000 && r._method == "GET";
+      }));
+    // the next segment is still in the local log and isn't prefetched
+    ss::sleep(100ms).get();
+    BOOST_REQUIRE(std::none_of(
+      get_requests().begin(),
+      get_requests().end(),
+      [seg100](const ss::httpd::request& r) {
+          return r._url == seg100 && r._method == "GET";
+      }));
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#include "archival/upload_scheduler.h"
+#include "cluster/tests/ntp_utils.h"
+#include "model/fundamental.h"
+#include "model/timestamp.h"
+#include "seastarx.h"
+#include "units.h"
+
+#include <seastar/core/abort_source.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/testing/thread_test_case.hh>
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <vector>
+
+using namespace archival;
+using namespace std::chrono_literals;
+
+static upload_scheduler::pending_partition
+pending(int partition, int64_t oldest) {
+    return {
+      .ntp = make_ntp(partition), .oldest_pending = model::timestamp(oldest)};
+}
+
+SEASTAR_THREAD_TEST_CASE(test_oldest_pending_data_goes_first) {
+    upload_scheduler sched(0, 100);
+    auto order = sched.schedule(
+      {pending(0, 30), pending(1, 10), pending(2, -1), pending(3, 20)});
+    std::vector<model::ntp> expected = {
+      make_ntp(1), make_ntp(3), make_ntp(0), make_ntp(2)};
+    BOOST_REQUIRE(order == expected);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_busy_partition_sits_out) {
+    upload_scheduler sched(0, 100);
+    std::vector<upload_scheduler::pending_partition> partitions = {
+      pending(0, 10), pending(1, 20)};
+    BOOST_REQUIRE_EQUAL(sched.schedule(partitions).size(), 2);
+
+    // partition 0 is a quantum ahead of partition 1
+    sched.charge(make_ntp(0), 100);
+    auto order = sched.schedule(partitions);
+    BOOST_REQUIRE_EQUAL(order.size(), 1);
+    BOOST_REQUIRE_EQUAL(order.front(), make_ntp(1));
+
+    sched.charge(make_ntp(1), 50);
+    BOOST_REQUIRE_EQUAL(sched.schedule(partitions).size(), 2);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_idle_partition_gets_no_credit) {
+    upload_scheduler sched(0, 100);
+    sched.schedule({pending(0, 10), pending(1, -1)});
+    sched.charge(make_ntp(0), 1000);
+    // partition 1 had nothing to upload while partition 0 was busy
+    sched.schedule({pending(0, 10), pending(1, -1)});
+    auto order = sched.schedule({pending(0, 10), pending(1, 20)});
+    std::vector<model::ntp> expected = {make_ntp(0), make_ntp(1)};
+    BOOST_REQUIRE(order == expected);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_removed_partition_starts_over) {
+    upload_scheduler sched(0, 100);
+    sched.schedule({pending(0, 10), pending(1, 20)});
+    sched.charge(make_ntp(0), 1000);
+    sched.remove(make_ntp(0));
+    auto order = sched.schedule({pending(0, 10), pending(1, 20)});
+    BOOST_REQUIRE_EQUAL(order.size(), 2);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_bandwidth_cap) {
+    ss::abort_source as;
+    // the test runs on a single shard
+    upload_scheduler sched(1000, 100);
+    auto start = ss::lowres_clock::now();
+    // the first upload isn't delayed by itself
+    sched.throttle(1500, as).get();
+    BOOST_REQUIRE(ss::lowres_clock::now() - start < 400ms);
+    // the second one waits for the debt of the first one
+    sched.throttle(10, as).get();
+    BOOST_REQUIRE(ss::lowres_clock::now() - start >= 400ms);
+
+    upload_scheduler unlimited;
+    start = ss::lowres_clock::now();
+    unlimited.throttle(1_GiB, as).get();
+    unlimited.throttle(1_GiB, as).get();
+    BOOST_REQUIRE(ss::lowres_clock::now() - start < 400ms);
+}
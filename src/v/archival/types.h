@@ -42,7 +42,12 @@ enum class download_manifest_result : int32_t {
 };
 
 enum class manifest_version : int32_t {
+    /// json
     v1 = 1,
+    /// binary, the version is the first byte of the object
+    v2 = 2,
+    /// binary with the segment index flag
+    v3 = 3,
 };
 
 enum class topic_manifest_version : int32_t {
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#include "archival/upload_scheduler.h"
+
+#include <seastar/core/sleep.hh>
+#include <seastar/core/smp.hh>
+
+#include <algorithm>
+
+namespace archival {
+
+upload_scheduler::upload_scheduler(size_t node_bandwidth, size_t quantum)
+  : _quantum(std::max<size_t>(quantum, 1)) {
+    if (node_bandwidth > 0) {
+        _bandwidth.emplace(
+          static_cast<double>(node_bandwidth) / ss::smp::count,
+          token_bucket::clock::now());
+    }
+}
+
+std::vector<model::ntp> upload_scheduler::schedule(
+  const std::vector<pending_partition>& partitions) {
+    // The round starts at the least served partition with pending data
+    std::optional<uint64_t> start;
+    for (const auto& p : partitions) {
+        auto it = _served.find(p.ntp);
+        if (
+          it == _served.end()
+          || p.oldest_pending == model::timestamp::missing()) {
+            continue;
+        }
+        start = std::min(start.value_or(it->second), it->second);
+    }
+    if (!start) {
+        for (const auto& p : partitions) {
+            if (auto it = _served.find(p.ntp); it != _served.end()) {
+                start = std::min(start.value_or(it->second), it->second);
+            }
+        }
+    }
+    auto round_start = start.value_or(0);
+
+    std::vector<const pending_partition*> round;
+    for (const auto& p : partitions) {
+        auto [it, _] = _served.try_emplace(p.ntp, round_start);
+        if (p.oldest_pending == model::timestamp::missing()) {
+            // no credit for the time the partition had nothing to upload
+            it->second = std::max(it->second, round_start);
+        }
+        if (it->second - round_start < _quantum) {
+            round.push_back(&p);
+        }
+    }
+
+    auto age = [](const pending_partition* p) {
+        return p->oldest_pending == model::timestamp::missing()
+                 ? model::timestamp::max()
+                 : p->oldest_pending;
+    };
+    std::stable_sort(
+      round.begin(),
+      round.end(),
+      [&age](const pending_partition* lhs, const pending_partition* rhs) {
+          return age(lhs) < age(rhs);
+      });
+
+    std::vector<model::ntp> ntps;
+    ntps.reserve(round.size());
+    for (const auto* p : round) {
+        ntps.push_back(p->ntp);
+    }
+    return ntps;
+}
+
+void upload_scheduler::charge(const model::ntp& ntp, size_t bytes) {
+    _served[ntp] += bytes;
+}
+
+ss::future<> upload_scheduler::throttle(size_t bytes, ss::abort_source& as) {
+    if (!_bandwidth) {
+        return ss::now();
+    }
+    // Uploads wait for the bytes reserved before them, which keeps the
+    // order of the round, and a single upload is never delayed by itself
+    auto now = token_bucket::clock::now();
+    auto delay = _bandwidth->delay(now);
+    _bandwidth->consume(static_cast<double>(bytes), now);
+    if (delay == token_bucket::clock::duration(0)) {
+        return ss::now();
+    }
+    return ss::sleep_abortable(delay, as);
+}
+
+void upload_scheduler::remove(const model::ntp& ntp) { _served.erase(ntp); }
+
+} // namespace archival
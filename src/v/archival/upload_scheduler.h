@@ -0,0 +1,78 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#pragma once
+#include "model/fundamental.h"
+#include "model/timestamp.h"
+#include "resource_mgmt/token_bucket.h"
+#include "seastarx.h"
+#include "units.h"
+
+#include <seastar/core/abort_source.hh>
+#include <seastar/core/future.hh>
+
+#include <absl/container/flat_hash_map.h>
+
+#include <optional>
+#include <vector>
+
+namespace archival {
+
+/// Shard-local scheduler of segment uploads.
+///
+/// Partitions are served by the number of bytes they uploaded: a partition
+/// that is more than a quantum ahead of the least served partition with
+/// pending data sits out the upload round, so a busy partition can't starve
+/// the others. Idle partitions don't build up credit. Within a round the
+/// partitions with the oldest pending data go first, and every upload of the
+/// shard takes its share of the node-wide bandwidth cap in that order.
+class upload_scheduler {
+public:
+    static constexpr size_t default_quantum = 64_MiB;
+
+    struct pending_partition {
+        model::ntp ntp;
+        /// Timestamp of the oldest data that is not uploaded yet,
+        /// missing if nothing is pending
+        model::timestamp oldest_pending;
+    };
+
+    /// \param node_bandwidth is a max number of bytes per second uploaded by
+    ///        all shards of the node, zero disables the limit
+    /// \param quantum is a number of bytes by which the partitions are
+    ///        allowed to drift apart, also the upload budget of a round
+    explicit upload_scheduler(
+      size_t node_bandwidth = 0, size_t quantum = default_quantum);
+
+    /// Choose partitions of the next upload round, in the upload order
+    std::vector<model::ntp>
+    schedule(const std::vector<pending_partition>& partitions);
+
+    /// Account bytes uploaded by the partition
+    void charge(const model::ntp& ntp, size_t bytes);
+
+    /// Wait until the upload of \p bytes fits into the bandwidth cap
+    ss::future<> throttle(size_t bytes, ss::abort_source& as);
+
+    /// Forget the partition
+    void remove(const model::ntp& ntp);
+
+    /// Number of bytes a partition can start uploading in a round, at least
+    /// one segment is uploaded regardless
+    size_t quantum() const { return _quantum; }
+
+private:
+    size_t _quantum;
+    /// Bytes uploaded by every known partition
+    absl::flat_hash_map<model::ntp, uint64_t> _served;
+    std::optional<token_bucket> _bandwidth;
+};
+
+} // namespace archival
@@ -20,6 +20,7 @@
 #include <seastar/core/future-util.hh>
 
 #include <algorithm>
+#include <cstring>
 
 /*
  * It is common for an io_iterator_consumer to be initialized with the begin and
@@ -62,6 +63,10 @@ public:
         }
     }
     void skip(size_t n) {
+        if (likely(n < segment_bytes_left())) {
+            advance_in_segment(n);
+            return;
+        }
         size_t c = consume(n, [](const char*, size_t /*max*/) {
             return ss::stop_iteration::no;
         });
@@ -72,6 +77,11 @@ public:
     }
     template<typename Output>
     [[gnu::always_inline]] void consume_to(size_t n, Output out) {
+        if (likely(n < segment_bytes_left())) {
+            std::copy_n(_frag_index, n, out);
+            advance_in_segment(n);
+            return;
+        }
         size_t c = consume(n, [&out](const char* src, size_t max) {
             std::copy_n(src, max, out);
             out += max;
@@ -89,6 +99,12 @@ public:
     T consume_type() {
         constexpr size_t sz = sizeof(T);
         T obj;
+        if (likely(sz < segment_bytes_left())) {
+            // a fixed size load, the common case of a value in the fragment
+            std::memcpy(&obj, _frag_index, sz);
+            advance_in_segment(sz);
+            return obj;
+        }
         char* dst = reinterpret_cast<char*>(&obj); // NOLINT
         consume_to(sz, dst);
         return obj;
@@ -165,7 +181,13 @@ public:
     size_t bytes_consumed() const { return _bytes_consumed; }
     // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
     size_t segment_bytes_left() const { return _frag_index_end - _frag_index; }
+    /// \brief the bytes left in the current fragment, there are
+    /// segment_bytes_left() of them
+    const char* segment_data() const { return _frag_index; }
     bool is_finished() const { return _frag == _frag_end; }
+    /// \brief the fragment of segment_data(), the consumer must not be
+    /// finished
+    const io_fragment& segment() const { return *_frag; }
 
     /// starts a new iterator byte-for-byte starting at *this* index
     /// useful for varint decoding that need to peek ahead
@@ -177,6 +199,14 @@ public:
     }
 
 private:
+    /// the fast paths stay strictly within the current fragment, consume()
+    /// moves to the next one when the fragment is exhausted
+    void advance_in_segment(size_t n) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        _frag_index += n;
+        _bytes_consumed += n;
+    }
+
     io_const_iterator _frag;
     io_const_iterator _frag_end;
     const char* _frag_index = nullptr;
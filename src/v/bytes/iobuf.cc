@@ -201,6 +201,38 @@ bool iobuf::operator==(const iobuf& o) const {
     return true;
 }
 
+void iobuf::coalesce(size_t threshold) {
+    static constexpr size_t max_run_bytes
+      = details::io_allocation_size::max_chunk_size;
+    auto it = _frags.begin();
+    while (it != _frags.end()) {
+        auto run_end = it;
+        size_t run_bytes = 0;
+        size_t run_fragments = 0;
+        while (run_end != _frags.end() && run_end->size() < threshold
+               && run_bytes + run_end->size() <= max_run_bytes) {
+            run_bytes += run_end->size();
+            ++run_fragments;
+            ++run_end;
+        }
+        if (run_fragments < 2) {
+            it = run_fragments == 0 ? std::next(it) : run_end;
+            continue;
+        }
+        ss::temporary_buffer<char> buf(run_bytes);
+        char* dst = buf.get_write();
+        for (auto f = it; f != run_end; ++f) {
+            dst = std::copy_n(f->get(), f->size(), dst);
+        }
+        auto merged = new fragment(std::move(buf), fragment::full{});
+        _frags.insert(it, *merged);
+        _frags.erase_and_dispose(it, run_end, [](fragment* f) {
+            delete f; // NOLINT
+        });
+        it = run_end;
+    }
+}
+
 bool iobuf::operator==(std::string_view o) const {
     if (_size != o.size()) {
         return false;
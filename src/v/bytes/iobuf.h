@@ -150,6 +150,12 @@ public:
     void trim_front(size_t n);
     void pop_back();
     void trim_back(size_t n);
+    /// \brief copies every run of adjacent fragments smaller than the
+    /// threshold into a single fragment, so a long chain of tiny appends can
+    /// be iterated and sent as few buffers. the content does not change but
+    /// outstanding placeholders and iterators are invalidated
+    void coalesce(
+      size_t threshold = details::io_allocation_size::default_chunk_size);
     void clear();
     size_t size_bytes() const;
     bool empty() const;
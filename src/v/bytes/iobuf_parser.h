@@ -46,6 +46,15 @@ public:
     size_t bytes_consumed() const { return _in.bytes_consumed(); }
 
     std::pair<int64_t, uint8_t> read_varlong() {
+        if (_in.segment_bytes_left() >= vint::max_length) {
+            // the whole varint is in this fragment
+            auto [val, length_size] = vint::deserialize(
+              // NOLINTNEXTLINE
+              reinterpret_cast<const uint8_t*>(_in.segment_data()),
+              _in.segment_bytes_left());
+            _in.skip(length_size);
+            return {val, length_size};
+        }
         auto [val, length_size] = vint::deserialize(_in);
         _in.skip(length_size);
         return {val, length_size};
@@ -66,6 +75,8 @@ public:
 
     bool read_bool() { return bool(consume_type<int8_t>()); }
 
+    void consume_to(size_t n, char* dst) { _in.consume_to(n, dst); }
+
     template<typename T>
     T consume_type() {
         return _in.consume_type<T>();
@@ -90,9 +101,33 @@ public:
 
     iobuf copy(size_t len) { return iobuf_copy(_in, len); }
 
+    /// \brief the next byte to parse, valid as long as the iobuf is not
+    /// modified
+    const iobuf::iterator_consumer& position() const { return _in; }
+
 protected:
     iobuf& ref() { return *std::get<owned_buf>(_buf); }
 
+    /// \brief the next \p len bytes as shares of their fragments, starting
+    /// from the current one. The parser must own its iobuf
+    iobuf share_owned(size_t len) {
+        iobuf ret;
+        size_t c = _in.consume(len, [this, &ret](const char* src, size_t n) {
+            // the fragments belong to the iobuf owned by the parser
+            auto& frag = const_cast<iobuf::fragment&>( // NOLINT
+              _in.segment());
+            ret.append_take_ownership(new iobuf::fragment( // NOLINT
+              frag.share(src - frag.get(), n),
+              iobuf::fragment::full{}));
+            return ss::stop_iteration::no;
+        });
+        if (unlikely(c != len)) {
+            details::throw_out_of_range(
+              "Invalid share(n), expected:{}, but shared:{}", len, c);
+        }
+        return ret;
+    }
+
 private:
     using const_ref = const iobuf*;
     using owned_buf = std::unique_ptr<iobuf>;
@@ -119,11 +154,8 @@ public:
     explicit iobuf_parser(iobuf buf)
       : iobuf_parser_base(std::move(buf), tag_owned_buf{}) {}
 
-    iobuf share(size_t len) {
-        auto ret = ref().share(bytes_consumed(), len);
-        skip(len);
-        return ret;
-    }
+    /// \brief the next \p len bytes without copying them
+    iobuf share(size_t len) { return share_owned(len); }
 };
 
 inline std::ostream& operator<<(std::ostream& o, const iobuf_parser& p) {
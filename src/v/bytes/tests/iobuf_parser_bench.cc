@@ -0,0 +1,140 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "bytes/iobuf.h"
+#include "bytes/iobuf_parser.h"
+#include "units.h"
+
+#include <seastar/testing/perf_tests.hh>
+
+#include <cstdint>
+
+static constexpr size_t values = 64_KiB / sizeof(int64_t);
+
+/// values to decode, in fragments of \p frag_size
+static iobuf make_values(size_t frag_size) {
+    iobuf buf;
+    iobuf frag;
+    for (size_t i = 0; i < values; ++i) {
+        auto v = static_cast<int64_t>(i);
+        frag.append(reinterpret_cast<const char*>(&v), sizeof(v)); // NOLINT
+        if (frag.size_bytes() >= frag_size) {
+            buf.append_fragments(std::move(frag));
+            frag = iobuf();
+        }
+    }
+    buf.append_fragments(std::move(frag));
+    return buf;
+}
+
+// before: every value read through the generic fragment callbacks
+static int64_t decode_generic(iobuf_parser& p) {
+    int64_t sum = 0;
+    for (size_t i = 0; i < values; ++i) {
+        int64_t v;
+        char* dst = reinterpret_cast<char*>(&v); // NOLINT
+        p.consume(sizeof(v), [&dst](const char* src, size_t n) {
+            std::copy_n(src, n, dst);
+            dst += n; // NOLINT
+            return ss::stop_iteration::no;
+        });
+        sum += v;
+    }
+    return sum;
+}
+
+// after: fixed size loads within the fragment
+static int64_t decode(iobuf_parser& p) {
+    int64_t sum = 0;
+    for (size_t i = 0; i < values; ++i) {
+        sum += p.consume_type<int64_t>();
+    }
+    return sum;
+}
+
+template<typename Decode>
+static size_t run_decode(size_t frag_size, Decode d) {
+    iobuf_parser p(make_values(frag_size));
+    perf_tests::start_measuring_time();
+    auto sum = d(p);
+    perf_tests::do_not_optimize(sum);
+    perf_tests::stop_measuring_time();
+    return values;
+}
+
+PERF_TEST(iobuf_parser_int64, generic_one_fragment) {
+    return run_decode(128_KiB, decode_generic);
+}
+
+PERF_TEST(iobuf_parser_int64, fast_one_fragment) {
+    return run_decode(128_KiB, decode);
+}
+
+PERF_TEST(iobuf_parser_int64, generic_4k_fragments) {
+    return run_decode(4_KiB, decode_generic);
+}
+
+PERF_TEST(iobuf_parser_int64, fast_4k_fragments) {
+    return run_decode(4_KiB, decode);
+}
+
+static constexpr size_t share_chunk = 512;
+
+// before: every share looked its range up from the start of the iobuf
+static size_t share_from_start(iobuf& buf, iobuf_const_parser& p) {
+    size_t shared = 0;
+    while (p.bytes_left() >= share_chunk) {
+        auto r = buf.share(p.bytes_consumed(), share_chunk);
+        p.skip(share_chunk);
+        perf_tests::do_not_optimize(r);
+        ++shared;
+    }
+    return shared;
+}
+
+// after: shared from the fragment the parser is at
+static size_t share_from_parser(iobuf_parser& p) {
+    size_t shared = 0;
+    while (p.bytes_left() >= share_chunk) {
+        auto r = p.share(share_chunk);
+        perf_tests::do_not_optimize(r);
+        ++shared;
+    }
+    return shared;
+}
+
+PERF_TEST(iobuf_parser_share, from_start) {
+    auto buf = make_values(4_KiB);
+    iobuf_const_parser p(buf);
+    perf_tests::start_measuring_time();
+    auto n = share_from_start(buf, p);
+    perf_tests::stop_measuring_time();
+    return n;
+}
+
+PERF_TEST(iobuf_parser_share, from_parser) {
+    iobuf_parser p(make_values(4_KiB));
+    perf_tests::start_measuring_time();
+    auto n = share_from_parser(p);
+    perf_tests::stop_measuring_time();
+    return n;
+}
+
+PERF_TEST(iobuf_parser_share, copy) {
+    iobuf_parser p(make_values(4_KiB));
+    size_t n = 0;
+    perf_tests::start_measuring_time();
+    while (p.bytes_left() >= share_chunk) {
+        auto r = p.copy(share_chunk);
+        perf_tests::do_not_optimize(r);
+        ++n;
+    }
+    perf_tests::stop_measuring_time();
+    return n;
+}
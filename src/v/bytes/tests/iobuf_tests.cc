@@ -12,6 +12,7 @@
 #include "bytes/iobuf.h"
 #include "bytes/iobuf_istreambuf.h"
 #include "bytes/iobuf_ostreambuf.h"
+#include "bytes/iobuf_parser.h"
 #include "bytes/tests/utils.h"
 
 #include <seastar/core/temporary_buffer.hh>
@@ -632,3 +633,63 @@ SEASTAR_THREAD_TEST_CASE(iobuf_string_view_cmp) {
         BOOST_REQUIRE_EQUAL(buf, std::string_view(str));
     }
 }
+
+SEASTAR_THREAD_TEST_CASE(iobuf_coalesce_small_fragments) {
+    auto make_fragment = [](size_t size, char c) {
+        auto data = ss::sstring(size, c);
+        iobuf f;
+        f.append(ss::temporary_buffer<char>(data.c_str(), size));
+        return f;
+    };
+    iobuf buf;
+    for (int i = 0; i < 50; ++i) {
+        buf.append_fragments(make_fragment(32, 'a' + i % 26));
+    }
+    buf.append_fragments(make_fragment(4096, 'x'));
+    for (int i = 0; i < 50; ++i) {
+        buf.append_fragments(make_fragment(32, 'A' + i % 26));
+    }
+    BOOST_REQUIRE_EQUAL(std::distance(buf.begin(), buf.end()), 101);
+    auto expected = buf.copy();
+
+    buf.coalesce(512);
+
+    BOOST_REQUIRE_EQUAL(std::distance(buf.begin(), buf.end()), 3);
+    BOOST_REQUIRE_EQUAL(buf.begin()->size(), 50 * 32);
+    BOOST_REQUIRE_EQUAL(std::next(buf.begin())->size(), 4096);
+    BOOST_REQUIRE_EQUAL(buf.size_bytes(), expected.size_bytes());
+    BOOST_REQUIRE_EQUAL(buf, expected);
+
+    // nothing left to merge
+    buf.coalesce(512);
+    BOOST_REQUIRE_EQUAL(std::distance(buf.begin(), buf.end()), 3);
+}
+
+SEASTAR_THREAD_TEST_CASE(iobuf_parser_reads_across_fragments) {
+    iobuf buf;
+    for (int i = 0; i < 8; ++i) {
+        iobuf f;
+        auto data = ss::sstring(6, 'a' + i);
+        f.append(ss::temporary_buffer<char>(data.c_str(), 6));
+        buf.append_fragments(std::move(f));
+    }
+    BOOST_REQUIRE_EQUAL(std::distance(buf.begin(), buf.end()), 8);
+    auto expected = buf.copy();
+
+    iobuf_parser p(std::move(buf));
+    // within the first fragment, then straddling the second
+    BOOST_REQUIRE_EQUAL(p.consume_type<int16_t>(), int16_t(0x6161));
+    p.skip(3);
+    auto straddling = p.consume_type<int32_t>();
+    BOOST_REQUIRE_EQUAL(p.bytes_consumed(), 9);
+    iobuf_const_parser generic(expected);
+    generic.skip(5);
+    BOOST_REQUIRE_EQUAL(straddling, generic.consume_type<int32_t>());
+
+    // a share past the end of a fragment keeps every byte
+    auto shared = p.share(20);
+    BOOST_REQUIRE_EQUAL(shared.size_bytes(), 20);
+    BOOST_REQUIRE_EQUAL(shared, expected.share(9, 20));
+    BOOST_REQUIRE_EQUAL(p.bytes_left(), 19);
+    BOOST_REQUIRE_THROW(p.share(20), std::out_of_range);
+}
@@ -14,10 +14,15 @@
 #include "cluster/simple_batch_builder.h"
 #include "cluster/types.h"
 #include "config/configuration.h"
+#include "raft/configuration_manager.h"
+#include "raft/consensus_utils.h"
 #include "rpc/backoff_policy.h"
 #include "rpc/types.h"
+#include "storage/api.h"
+#include "storage/segment_utils.h"
 #include "vlog.h"
 
+#include <seastar/core/coroutine.hh>
 #include <seastar/core/future.hh>
 
 #include <chrono>
@@ -79,6 +84,14 @@ ss::future<> remove_broker_client(
       });
 }
 
+static rpc::connection_cache::connection_options connection_options() {
+    const auto& cfg = config::shard_local_cfg();
+    return rpc::connection_cache::connection_options{
+      .control_connection = cfg.rpc_client_control_connection(),
+      .bulk_connections = cfg.rpc_client_bulk_connections(),
+    };
+}
+
 ss::future<> maybe_create_tcp_client(
   rpc::connection_cache& cache,
   model::node_id node,
@@ -114,8 +127,13 @@ ss::future<> maybe_create_tcp_client(
                           .credentials = cert,
                           .disable_metrics = rpc::metrics_disabled(
                             config::shard_local_cfg().disable_metrics)},
-                        rpc::make_exponential_backoff_policy<rpc::clock_type>(
-                          std::chrono::seconds(1), std::chrono::seconds(60)));
+                        [] {
+                            return rpc::make_exponential_backoff_policy<
+                              rpc::clock_type>(
+                              std::chrono::seconds(1),
+                              std::chrono::seconds(60));
+                        },
+                        connection_options());
                   });
           });
       });
@@ -212,14 +230,93 @@ void log_certificate_reload_event(
 }
 
 bool has_local_replicas(
-  model::node_id self, const std::vector<model::broker_shard>& replicas) {
+  model::node_id self,
+  const std::vector<model::broker_shard>& replicas,
+  std::optional<ss::shard_id> shard_override) {
     return std::find_if(
              std::cbegin(replicas),
              std::cend(replicas),
-             [self](const model::broker_shard& bs) {
-                 return bs.node_id == self && bs.shard == ss::this_shard_id();
+             [self, shard_override](const model::broker_shard& bs) {
+                 return bs.node_id == self
+                        && shard_override.value_or(bs.shard)
+                             == ss::this_shard_id();
              })
            != replicas.cend();
 }
 
+using persistent_key = std::pair<storage::kvstore::key_space, bytes>;
+
+static std::vector<persistent_key>
+partition_state_keys(const model::ntp& ntp, raft::group_id group) {
+    std::vector<persistent_key> keys;
+    for (auto& k : raft::details::persistent_state_keys(group)) {
+        keys.emplace_back(storage::kvstore::key_space::consensus, std::move(k));
+    }
+    keys.emplace_back(
+      storage::kvstore::key_space::storage,
+      storage::internal::start_offset_key(ntp));
+    return keys;
+}
+
+ss::future<> copy_persistent_state(
+  const model::ntp& ntp,
+  raft::group_id group,
+  ss::shard_id source,
+  ss::shard_id target,
+  ss::sharded<storage::api>& api) {
+    using values_t = std::vector<std::pair<persistent_key, bytes>>;
+    // values are copied to bytes so that they can cross shards
+    auto values = co_await api.invoke_on(
+      source,
+      [group, keys = partition_state_keys(ntp, group)](storage::api& api) {
+          values_t values;
+          auto add_value = [&api, &values](const persistent_key& k) {
+              if (auto v = api.kvs().get(k.first, k.second); v) {
+                  values.emplace_back(k, iobuf_to_bytes(*v));
+              }
+          };
+          for (const auto& k : keys) {
+              add_value(k);
+          }
+          for (auto& k : raft::configuration_manager::
+                 persistent_configuration_keys(api.kvs(), group)) {
+              add_value(persistent_key(
+                storage::kvstore::key_space::consensus, std::move(k)));
+          }
+          return values;
+      });
+    co_await api.invoke_on(
+      target, [values = std::move(values)](storage::api& api) mutable {
+          return ss::do_with(std::move(values), [&api](values_t& values) {
+              return ss::parallel_for_each(values, [&api](auto& v) {
+                  return api.kvs().put(
+                    v.first.first, v.first.second, bytes_to_iobuf(v.second));
+              });
+          });
+      });
+}
+
+ss::future<> remove_persistent_state(
+  const model::ntp& ntp,
+  raft::group_id group,
+  ss::shard_id shard,
+  ss::sharded<storage::api>& api) {
+    return api.invoke_on(
+      shard,
+      [group,
+       keys = partition_state_keys(ntp, group)](storage::api& api) mutable {
+          for (auto& k : raft::configuration_manager::
+                 persistent_configuration_keys(api.kvs(), group)) {
+              keys.emplace_back(
+                storage::kvstore::key_space::consensus, std::move(k));
+          }
+          return ss::do_with(
+            std::move(keys), [&api](std::vector<persistent_key>& keys) {
+                return ss::parallel_for_each(keys, [&api](persistent_key& k) {
+                    return api.kvs().remove(k.first, k.second);
+                });
+            });
+      });
+}
+
 } // namespace cluster
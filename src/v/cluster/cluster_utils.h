@@ -18,9 +18,11 @@
 #include "rpc/connection_cache.h"
 #include "rpc/dns.h"
 #include "rpc/types.h"
+#include "storage/fwd.h"
 
 #include <seastar/core/sharded.hh>
 
+#include <optional>
 #include <utility>
 
 namespace config {
@@ -169,8 +171,31 @@ auto do_with_client_one_shot(
 
 /**
  * checks if current node/shard is part of the partition replica set replica set
+ *
+ * shard_override places the replica of this node on the given shard instead
+ * of the one from the replica set
  */
 bool has_local_replicas(
-  model::node_id, const std::vector<model::broker_shard>&);
+  model::node_id,
+  const std::vector<model::broker_shard>&,
+  std::optional<ss::shard_id> shard_override = std::nullopt);
+
+/**
+ * copies the state of the partition persisted in the key value store of the
+ * source shard, both raft and storage state, to the target shard
+ */
+ss::future<> copy_persistent_state(
+  const model::ntp&,
+  raft::group_id,
+  ss::shard_id source,
+  ss::shard_id target,
+  ss::sharded<storage::api>&);
+
+/**
+ * removes the state of the partition persisted in the key value store of the
+ * shard
+ */
+ss::future<> remove_persistent_state(
+  const model::ntp&, raft::group_id, ss::shard_id, ss::sharded<storage::api>&);
 
 } // namespace cluster
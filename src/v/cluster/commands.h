@@ -76,6 +76,7 @@ static constexpr int8_t delete_user_cmd_type = 6;
 static constexpr int8_t update_user_cmd_type = 7;
 static constexpr int8_t create_acls_cmd_type = 8;
 static constexpr int8_t delete_acls_cmd_type = 9;
+static constexpr int8_t create_topics_cmd_type = 10;
 
 using create_topic_cmd = controller_command<
   model::topic_namespace,
@@ -107,6 +108,13 @@ using update_topic_properties_cmd = controller_command<
   update_topic_properties_cmd_type,
   topic_batch_type()>;
 
+// creates all the topics or none of them
+using create_topics_cmd = controller_command<
+  std::vector<topic_configuration_assignment>,
+  int8_t, // unused
+  create_topics_cmd_type,
+  topic_batch_type()>;
+
 using create_user_cmd = controller_command<
   security::credential_user,
   security::scram_credential,
@@ -159,6 +167,15 @@ template<typename... Commands>
 CONCEPT(requires(ControllerCommand<Commands>, ...))
 using make_commands_list = commands_type_list<Commands...>;
 
+/// the variant of the commands of a list, as they are deserialized
+template<typename List>
+struct commands_variant;
+
+template<typename... Commands>
+struct commands_variant<commands_type_list<Commands...>> {
+    using type = std::variant<Commands...>;
+};
+
 /// Commands are serialized as a batch with single record. Command key is
 /// serialized as a record key. Key is independent from command type so it can
 /// leverage the log compactions (i.e only last command for given key is enough
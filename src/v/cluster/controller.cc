@@ -12,14 +12,18 @@
 #include "cluster/cluster_utils.h"
 #include "cluster/controller_backend.h"
 #include "cluster/controller_service.h"
+#include "cluster/health_table.h"
 #include "cluster/logger.h"
 #include "cluster/members_manager.h"
 #include "cluster/members_table.h"
 #include "cluster/metadata_dissemination_service.h"
+#include "cluster/node_load_reporter.h"
+#include "cluster/partition_balancer.h"
 #include "cluster/partition_leaders_table.h"
 #include "cluster/partition_manager.h"
 #include "cluster/raft0_utils.h"
 #include "cluster/security_frontend.h"
+#include "cluster/shard_balancer.h"
 #include "cluster/shard_table.h"
 #include "cluster/topic_table.h"
 #include "cluster/topics_frontend.h"
@@ -53,6 +57,7 @@ ss::future<> controller::wire_up() {
       .then([this] { return _partition_leaders.start(); })
       .then(
         [this] { return _partition_allocator.start_single(raft::group_id(0)); })
+      .then([this] { return _health_table.start_single(); })
       .then([this] { return _credentials.start(); })
       .then([this] { return _authorizer.start(); })
       .then([this] { return _tp_state.start(); });
@@ -76,6 +81,7 @@ ss::future<> controller::start() {
             std::ref(_members_table),
             std::ref(_connections),
             std::ref(_partition_allocator),
+            std::ref(_health_table),
             std::ref(_storage),
             std::ref(_as));
       })
@@ -117,6 +123,7 @@ ss::future<> controller::start() {
             std::ref(_members_table),
             std::ref(_partition_leaders),
             std::ref(_tp_frontend),
+            std::ref(_storage),
             std::ref(_as));
       })
       .then([this] {
@@ -142,7 +149,39 @@ ss::future<> controller::start() {
           });
       })
       .then(
-        [this] { return _backend.invoke_on_all(&controller_backend::start); });
+        [this] { return _backend.invoke_on_all(&controller_backend::start); })
+      .then([this] {
+          return _shard_balancer.start_single(
+            std::ref(_partition_manager), std::ref(_backend));
+      })
+      .then([this] {
+          return _shard_balancer.invoke_on(
+            shard_balancer::shard, &shard_balancer::start);
+      })
+      .then([this] {
+          return _load_reporter.start_single(
+            std::ref(_partition_manager), std::ref(_members_manager));
+      })
+      .then([this] {
+          return _load_reporter.invoke_on(
+            node_load_reporter::shard, &node_load_reporter::start);
+      })
+      .then([this] {
+          return _balancer.start_single(
+            _raft0,
+            std::ref(_tp_state),
+            std::ref(_partition_leaders),
+            std::ref(_members_table),
+            std::ref(_partition_allocator),
+            std::ref(_tp_frontend),
+            std::ref(_partition_manager),
+            std::ref(_shard_table),
+            std::ref(_connections));
+      })
+      .then([this] {
+          return _balancer.invoke_on(
+            partition_balancer::shard, &partition_balancer::start);
+      });
 }
 
 ss::future<> controller::shutdown_input() {
@@ -161,7 +200,10 @@ ss::future<> controller::stop() {
     }
 
     return f.then([this] {
-        return _backend.stop()
+        return _balancer.stop()
+          .then([this] { return _load_reporter.stop(); })
+          .then([this] { return _shard_balancer.stop(); })
+          .then([this] { return _backend.stop(); })
           .then([this] { return _tp_frontend.stop(); })
           .then([this] { return _security_frontend.stop(); })
           .then([this] { return _stm.stop(); })
@@ -169,6 +211,7 @@ ss::future<> controller::stop() {
           .then([this] { return _credentials.stop(); })
           .then([this] { return _tp_state.stop(); })
           .then([this] { return _members_manager.stop(); })
+          .then([this] { return _health_table.stop(); })
           .then([this] { return _partition_allocator.stop(); })
           .then([this] { return _partition_leaders.stop(); })
           .then([this] { return _members_table.stop(); })
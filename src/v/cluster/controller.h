@@ -55,6 +55,8 @@ public:
 
     ss::sharded<security::authorizer>& get_authorizer() { return _authorizer; }
 
+    ss::sharded<health_table>& get_health_table() { return _health_table; }
+
     ss::future<> wire_up();
 
     ss::future<> start();
@@ -65,15 +67,19 @@ public:
 private:
     ss::sharded<ss::abort_source> _as;                     // instance per core
     ss::sharded<partition_allocator> _partition_allocator; // single instance
+    ss::sharded<health_table> _health_table;               // single instance
     ss::sharded<topic_table> _tp_state;                    // instance per core
     ss::sharded<members_table> _members_table;             // instance per core
     ss::sharded<partition_leaders_table>
-      _partition_leaders;                          // instance per core
-    ss::sharded<members_manager> _members_manager; // single instance
-    ss::sharded<topics_frontend> _tp_frontend;     // instance per core
-    ss::sharded<controller_backend> _backend;      // instance per core
-    ss::sharded<controller_stm> _stm;              // single instance
-    ss::sharded<controller_service> _service;      // instance per core
+      _partition_leaders;                           // instance per core
+    ss::sharded<members_manager> _members_manager;  // single instance
+    ss::sharded<topics_frontend> _tp_frontend;      // instance per core
+    ss::sharded<controller_backend> _backend;       // instance per core
+    ss::sharded<shard_balancer> _shard_balancer;    // single instance
+    ss::sharded<node_load_reporter> _load_reporter; // single instance
+    ss::sharded<partition_balancer> _balancer;      // single instance
+    ss::sharded<controller_stm> _stm;               // single instance
+    ss::sharded<controller_service> _service;       // instance per core
     ss::sharded<rpc::connection_cache>& _connections;
     ss::sharded<partition_manager>& _partition_manager;
     ss::sharded<shard_table>& _shard_table;
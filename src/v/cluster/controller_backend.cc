@@ -25,7 +25,9 @@
 #include "outcome.h"
 #include "raft/group_configuration.h"
 #include "raft/types.h"
+#include "reflection/adl.h"
 #include "ssx/future-util.h"
+#include "storage/api.h"
 
 #include <seastar/core/abort_source.hh>
 #include <seastar/core/coroutine.hh>
@@ -131,6 +133,7 @@ controller_backend::controller_backend(
   ss::sharded<members_table>& members,
   ss::sharded<partition_leaders_table>& leaders,
   ss::sharded<topics_frontend>& frontend,
+  ss::sharded<storage::api>& storage,
   ss::sharded<ss::abort_source>& as)
   : _topics(tp_state)
   , _shard_table(st)
@@ -138,11 +141,16 @@ controller_backend::controller_backend(
   , _members_table(members)
   , _partition_leaders_table(leaders)
   , _topics_frontend(frontend)
+  , _storage(storage)
   , _self(model::node_id(config::shard_local_cfg().node_id))
   , _data_directory(config::shard_local_cfg().data_directory().as_sstring())
   , _housekeeping_timer_interval(
       config::shard_local_cfg().controller_backend_housekeeping_interval_ms())
-  , _as(as) {}
+  , _as(as)
+  , _reconciliation_sem(std::max<size_t>(
+      config::shard_local_cfg()
+        .controller_backend_reconciliation_concurrency(),
+      1)) {}
 
 ss::future<> controller_backend::stop() {
     _housekeeping_timer.cancel();
@@ -150,7 +158,9 @@ ss::future<> controller_backend::stop() {
 }
 
 ss::future<> controller_backend::start() {
-    return bootstrap_controller_backend().then([this] {
+    return load_shard_overrides()
+      .then([this] { return bootstrap_controller_backend(); })
+      .then([this] {
         start_topics_reconciliation_loop();
         _housekeeping_timer.set_callback([this] { housekeeping(); });
         _housekeeping_timer.arm(_housekeeping_timer_interval);
@@ -174,12 +184,17 @@ ss::future<> controller_backend::do_bootstrap() {
       _topic_deltas.begin(),
       _topic_deltas.end(),
       [this](underlying_t::value_type& ntp_deltas) {
-          return bootstrap_ntp(ntp_deltas.first, ntp_deltas.second);
+          return ss::with_semaphore(
+            _reconciliation_sem, 1, [this, &ntp_deltas] {
+                return bootstrap_ntp(ntp_deltas.first, ntp_deltas.second);
+            });
       });
 }
 
 std::vector<topic_table::delta> calculate_bootstrap_deltas(
-  model::node_id self, std::vector<topic_table::delta>&& deltas) {
+  model::node_id self,
+  std::vector<topic_table::delta>&& deltas,
+  std::optional<ss::shard_id> shard_override) {
     std::vector<topic_table::delta> result_delta;
     // no deltas, do nothing
     if (deltas.empty()) {
@@ -194,7 +209,7 @@ std::vector<topic_table::delta> calculate_bootstrap_deltas(
         // replicas, just stop
         if (
           it->type == op_t::update_finished
-          && !has_local_replicas(self, it->p_as.replicas)) {
+          && !has_local_replicas(self, it->p_as.replicas, shard_override)) {
             break;
         }
         // if next operation doesn't contain local replicas we terminate lookup,
@@ -203,7 +218,8 @@ std::vector<topic_table::delta> calculate_bootstrap_deltas(
         if (auto next = std::next(it); next != deltas.rend()) {
             if (
               next->type == op_t::update_finished
-              && !has_local_replicas(self, next->p_as.replicas)) {
+              && !has_local_replicas(
+                self, next->p_as.replicas, shard_override)) {
                 break;
             }
         }
@@ -226,12 +242,33 @@ std::vector<topic_table::delta> calculate_bootstrap_deltas(
     return result_delta;
 }
 
+void coalesce_deltas(std::vector<topic_table::delta>& deltas) {
+    using op_t = topic_table::delta::op_type;
+    auto last_del = std::find_if(
+      deltas.rbegin(), deltas.rend(), [](const topic_table::delta& d) {
+          return d.type == op_t::del;
+      });
+    if (last_del == deltas.rend()) {
+        return;
+    }
+    // the partition created by a pending addition was never created locally,
+    // if it is deleted later on the addition and the updates in between are
+    // superseded. the deletion is kept as it removes the partition of an
+    // earlier revision, if there is one
+    auto del = std::prev(last_del.base());
+    auto first_add = std::find_if(
+      deltas.begin(), del, [](const topic_table::delta& d) {
+          return d.type == op_t::add;
+      });
+    deltas.erase(first_add, del);
+}
+
 ss::future<>
 controller_backend::bootstrap_ntp(const model::ntp& ntp, deltas_t& deltas) {
     vlog(clusterlog.trace, "bootstrapping {}", ntp);
     // find last delta that has to be applied
     auto bootstrap_deltas = calculate_bootstrap_deltas(
-      _self, std::move(deltas));
+      _self, std::move(deltas), shard_override(ntp));
 
     // apply all deltas follwing the one found previously
     deltas = std::move(bootstrap_deltas);
@@ -244,9 +281,14 @@ ss::future<> controller_backend::fetch_deltas() {
       .then([this](deltas_t deltas) {
           return ss::with_semaphore(
             _topics_sem, 1, [this, deltas = std::move(deltas)]() mutable {
+                absl::flat_hash_set<model::ntp> updated;
                 for (auto& d : deltas) {
                     auto ntp = d.ntp;
                     _topic_deltas[ntp].push_back(std::move(d));
+                    updated.insert(std::move(ntp));
+                }
+                for (const auto& ntp : updated) {
+                    coalesce_deltas(_topic_deltas[ntp]);
                 }
             });
       });
@@ -324,7 +366,10 @@ ss::future<> controller_backend::reconcile_topics() {
                  _topic_deltas.begin(),
                  _topic_deltas.end(),
                  [this](underlying_t::value_type& ntp_deltas) {
-                     return reconcile_ntp(ntp_deltas.second);
+                     return ss::with_semaphore(
+                       _reconciliation_sem, 1, [this, &ntp_deltas] {
+                           return reconcile_ntp(ntp_deltas.second);
+                       });
                  })
           .then([this] {
               // cleanup empty NTP keys
@@ -377,7 +422,8 @@ controller_backend::execute_partitition_op(const topic_table::delta& delta) {
     // partitions created on current shard at this node
     switch (delta.type) {
     case op_t::add:
-        if (!has_local_replicas(_self, delta.p_as.replicas)) {
+        if (!has_local_replicas(
+              _self, delta.p_as.replicas, shard_override(delta.ntp))) {
             return ss::make_ready_future<std::error_code>(errc::success);
         }
         return create_partition(
@@ -429,7 +475,7 @@ ss::future<std::error_code> controller_backend::process_partition_update(
      * update is finished on other nodes
      */
 
-    if (!has_local_replicas(_self, current.replicas)) {
+    if (!has_local_replicas(_self, current.replicas, shard_override(ntp))) {
         /**
          * if no replicas are expected on current node/shard and partition
          * doesn't exists, the update is finished
@@ -505,7 +551,8 @@ controller_backend::process_partition_properties_update(
     /**
      * No core local replicas are expected to exists, do nothing
      */
-    if (!has_local_replicas(_self, assignment.replicas)) {
+    if (!has_local_replicas(
+          _self, assignment.replicas, shard_override(ntp))) {
         co_return errc::success;
     }
 
@@ -557,7 +604,7 @@ ss::future<std::error_code> controller_backend::finish_partition_update(
     // partition with requested ntp exists on this broker core
     // it has to be removed after new configuration is stable
 
-    if (has_local_replicas(_self, current.replicas)) {
+    if (has_local_replicas(_self, current.replicas, shard_override(ntp))) {
         return ss::make_ready_future<std::error_code>(errc::success);
     }
 
@@ -640,6 +687,13 @@ ss::future<> controller_backend::add_to_shard_table(
       });
 }
 
+ss::future<storage::ntp_config>
+controller_backend::place_log(storage::ntp_config cfg) {
+    auto dir = co_await _storage.local().log_mgr().select_data_directory(cfg);
+    cfg.base_directory() = std::move(dir);
+    co_return cfg;
+}
+
 ss::future<std::error_code> controller_backend::create_partition(
   model::ntp ntp,
   raft::group_id group_id,
@@ -659,12 +713,14 @@ ss::future<std::error_code> controller_backend::create_partition(
     if (likely(!partition)) {
         // we use offset as an rev as it is always increasing and it
         // increases while ntp is being created again
-        f = _partition_manager.local()
-              .manage(
-                cfg->make_ntp_config(_data_directory, ntp.tp.partition, rev),
-                group_id,
-                std::move(members))
-              .discard_result();
+        f = place_log(
+              cfg->make_ntp_config(_data_directory, ntp.tp.partition, rev))
+              .then([this, group_id, members = std::move(members)](
+                      storage::ntp_config ntp_cfg) mutable {
+                  return _partition_manager.local()
+                    .manage(std::move(ntp_cfg), group_id, std::move(members))
+                    .discard_result();
+              });
     } else {
         // old partition still exists, wait for it to be removed
         if (partition->get_revision_id() < rev) {
@@ -713,4 +769,128 @@ controller_backend::delete_partition(model::ntp ntp, model::revision_id rev) {
       .then([] { return make_error_code(errc::success); });
 }
 
+std::optional<ss::shard_id>
+controller_backend::shard_override(const model::ntp& ntp) const {
+    if (auto it = _shard_overrides.find(ntp); it != _shard_overrides.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+static const bytes shard_overrides_key("shard_placement_overrides");
+
+// overrides of all the shards are persisted in the kvstore of shard 0
+static constexpr ss::shard_id shard_overrides_shard = 0;
+
+ss::future<> controller_backend::load_shard_overrides() {
+    auto overrides = co_await _storage.invoke_on(
+      shard_overrides_shard, [](storage::api& api) {
+          std::vector<shard_placement_override> overrides;
+          auto buf = api.kvs().get(
+            storage::kvstore::key_space::controller, shard_overrides_key);
+          if (buf) {
+              overrides = reflection::from_iobuf<
+                std::vector<shard_placement_override>>(std::move(*buf));
+          }
+          return overrides;
+      });
+    for (auto& o : overrides) {
+        _shard_overrides.insert_or_assign(std::move(o.ntp), o.shard);
+    }
+}
+
+ss::future<> controller_backend::store_shard_overrides() {
+    std::vector<shard_placement_override> overrides;
+    overrides.reserve(_shard_overrides.size());
+    for (const auto& [ntp, shard] : _shard_overrides) {
+        overrides.push_back(
+          shard_placement_override{.ntp = ntp, .shard = shard});
+    }
+    return _storage.invoke_on(
+      shard_overrides_shard,
+      [overrides = std::move(overrides)](storage::api& api) mutable {
+          return api.kvs().put(
+            storage::kvstore::key_space::controller,
+            shard_overrides_key,
+            reflection::to_iobuf(std::move(overrides)));
+      });
+}
+
+ss::future<std::error_code> controller_backend::move_partition_to_shard(
+  model::ntp ntp, ss::shard_id target) {
+    auto holder = _gate.hold();
+    auto units = co_await ss::get_units(_topics_sem, 1);
+    auto partition = _partition_manager.local().get(ntp);
+    if (!partition) {
+        co_return errc::partition_not_exists;
+    }
+    // wait for the pending updates of the partition to be reconciled
+    if (_topic_deltas.contains(ntp) || target == ss::this_shard_id()) {
+        co_return errc::update_in_progress;
+    }
+    auto group = partition->group();
+    auto rev = partition->log_config().get_revision();
+    partition = nullptr;
+    vlog(
+      clusterlog.info,
+      "moving partition {} from shard {} to shard {}",
+      ntp,
+      ss::this_shard_id(),
+      target);
+
+    co_await _partition_manager.local().shutdown(ntp);
+    std::exception_ptr e;
+    try {
+        co_await copy_persistent_state(
+          ntp, group, ss::this_shard_id(), target, _storage);
+        co_await container().invoke_on_all(
+          [ntp, target](controller_backend& b) {
+              b._shard_overrides.insert_or_assign(ntp, target);
+          });
+        co_await store_shard_overrides();
+    } catch (...) {
+        e = std::current_exception();
+    }
+    if (e) {
+        vlog(
+          clusterlog.warn,
+          "moving partition {} to shard {} failed, restarting it on current "
+          "shard - {}",
+          ntp,
+          target,
+          e);
+        co_await container().invoke_on_all([ntp](controller_backend& b) {
+            b._shard_overrides.erase(ntp);
+        });
+        co_await store_shard_overrides();
+        co_return co_await adopt_moved_partition(ntp, group, rev);
+    }
+    // target shard owns the partition now, the state left here is stale
+    co_await remove_persistent_state(ntp, group, ss::this_shard_id(), _storage);
+    co_return co_await container().invoke_on(
+      target, [ntp, group, rev](controller_backend& b) {
+          return ss::with_semaphore(b._topics_sem, 1, [&b, ntp, group, rev] {
+              return b.adopt_moved_partition(ntp, group, rev);
+          });
+      });
+}
+
+// caller must hold _topics_sem lock
+ss::future<std::error_code> controller_backend::adopt_moved_partition(
+  model::ntp ntp, raft::group_id group, model::revision_id rev) {
+    auto cfg = _topics.local().get_topic_cfg(model::topic_namespace_view(ntp));
+    if (!cfg) {
+        // topic was removed while moving, the deletion is reconciled by the
+        // shard the partition is assigned to
+        co_return errc::topic_not_exists;
+    }
+    // initial brokers are not needed, raft reads its configuration from the
+    // persisted state
+    auto ntp_cfg = co_await place_log(
+      cfg->make_ntp_config(_data_directory, ntp.tp.partition, rev));
+    co_await _partition_manager.local().manage(std::move(ntp_cfg), group, {});
+    co_await add_to_shard_table(ntp, group, ss::this_shard_id(), rev);
+    co_return errc::success;
+}
+
 } // namespace cluster
@@ -16,6 +16,7 @@
 #include "cluster/types.h"
 #include "model/fundamental.h"
 #include "outcome.h"
+#include "storage/fwd.h"
 
 #include <seastar/core/abort_source.hh>
 #include <seastar/core/gate.hh>
@@ -25,7 +26,8 @@ namespace cluster {
 
 /// on every core, sharded
 
-class controller_backend {
+class controller_backend
+  : public ss::peering_sharded_service<controller_backend> {
 public:
     using results_t = std::vector<std::error_code>;
     controller_backend(
@@ -35,11 +37,24 @@ public:
       ss::sharded<members_table>&,
       ss::sharded<cluster::partition_leaders_table>&,
       ss::sharded<topics_frontend>&,
+      ss::sharded<storage::api>&,
       ss::sharded<seastar::abort_source>&);
 
     ss::future<> stop();
     ss::future<> start();
 
+    /**
+     * Moves the partition replica of this shard to other shard of this node.
+     * The partition is stopped, its persisted state is handed over to the
+     * target shard and it is started again there from the same data. The
+     * placement survives restarts, it is persisted as a node local override
+     * of the shard from the partition assignment.
+     */
+    ss::future<std::error_code>
+    move_partition_to_shard(model::ntp, ss::shard_id);
+
+    std::optional<ss::shard_id> shard_override(const model::ntp&) const;
+
 private:
     using deltas_t = std::vector<topic_table::delta>;
     using underlying_t = absl::flat_hash_map<model::ntp, deltas_t>;
@@ -71,6 +86,9 @@ private:
       std::vector<model::broker>);
     ss::future<> add_to_shard_table(
       model::ntp, raft::group_id, ss::shard_id, model::revision_id);
+    /// \brief moves the log of a partition to the data directory selected
+    /// for it by the log manager
+    ss::future<storage::ntp_config> place_log(storage::ntp_config);
     ss::future<std::error_code>
       delete_partition(model::ntp, model::revision_id);
     ss::future<std::error_code> update_partition_replica_set(
@@ -81,6 +99,11 @@ private:
     ss::future<std::error_code>
       dispatch_update_finished(model::ntp, partition_assignment);
 
+    ss::future<std::error_code>
+      adopt_moved_partition(model::ntp, raft::group_id, model::revision_id);
+    ss::future<> load_shard_overrides();
+    ss::future<> store_shard_overrides();
+
     ss::future<> do_bootstrap();
     ss::future<> bootstrap_ntp(const model::ntp&, deltas_t&);
 
@@ -92,6 +115,7 @@ private:
     ss::sharded<members_table>& _members_table;
     ss::sharded<partition_leaders_table>& _partition_leaders_table;
     ss::sharded<topics_frontend>& _topics_frontend;
+    ss::sharded<storage::api>& _storage;
     model::node_id _self;
     ss::sstring _data_directory;
     std::chrono::milliseconds _housekeeping_timer_interval;
@@ -99,9 +123,19 @@ private:
     underlying_t _topic_deltas;
     ss::timer<> _housekeeping_timer;
     ss::semaphore _topics_sem{1};
+    // bounds the partitions reconciled at a time, creating thousands of
+    // partitions at once would exhaust the memory of the core
+    ss::semaphore _reconciliation_sem;
     ss::gate _gate;
+    // partitions placed on other shard than the one in their assignment
+    absl::flat_hash_map<model::ntp, ss::shard_id> _shard_overrides;
 };
 
 std::vector<topic_table::delta> calculate_bootstrap_deltas(
-  model::node_id self, std::vector<topic_table::delta>&&);
+  model::node_id self,
+  std::vector<topic_table::delta>&&,
+  std::optional<ss::shard_id> shard_override = std::nullopt);
+
+/// drops the pending deltas of a partition superseded by a later deletion
+void coalesce_deltas(std::vector<topic_table::delta>&);
 } // namespace cluster
@@ -0,0 +1,198 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "cluster/controller_log_compactor.h"
+
+#include "bytes/iobuf_parser.h"
+#include "cluster/commands.h"
+#include "cluster/simple_batch_builder.h"
+#include "reflection/adl.h"
+#include "vassert.h"
+
+#include <absl/container/flat_hash_set.h>
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace cluster {
+
+namespace {
+
+struct command_header {
+    iobuf key;
+    command_type type;
+};
+
+command_header read_command_header(const model::record_batch& b) {
+    vassert(
+      b.record_count() == 1,
+      "Currently we expect single command in single batch");
+    auto records = b.copy_records();
+    iobuf_parser v_parser(records.begin()->release_value());
+    auto type = reflection::adl<command_type>{}.from(v_parser);
+    return command_header{
+      .key = records.begin()->release_key(), .type = type};
+}
+
+// the commands of a topic are kept separately, a topic created with others
+// is kept as if it was created alone by a command at the same offset
+model::record_batch
+make_create_topic_batch(model::offset o, topic_configuration_assignment t) {
+    iobuf key;
+    iobuf value;
+    reflection::serialize(key, model::topic_namespace(t.cfg.tp_ns));
+    reflection::serialize(
+      value, command_type(create_topic_cmd_type), std::move(t));
+    simple_batch_builder builder(topic_batch_type, o);
+    builder.add_raw_kv(std::move(key), std::move(value));
+    return std::move(builder).build();
+}
+
+} // namespace
+
+void controller_log_compactor::add(model::record_batch b) {
+    const auto type = b.header().type;
+    if (type == topic_batch_type) {
+        add_topic_command(std::move(b));
+    } else if (type == user_batch_type) {
+        add_user_command(std::move(b));
+    } else if (type == acl_batch_type) {
+        // acl bindings are not keyed by a single name, deletes are filters
+        _acls.push_back(std::move(b));
+    }
+    // raft configurations are part of the snapshot metadata
+}
+
+void controller_log_compactor::add_topic_command(model::record_batch b) {
+    auto hdr = read_command_header(b);
+    iobuf_parser k_parser(std::move(hdr.key));
+    if (hdr.type == create_topics_cmd_type) {
+        add_create_topics(
+          b.base_offset(),
+          reflection::adl<std::vector<topic_configuration_assignment>>{}.from(
+            k_parser));
+        return;
+    }
+    auto key = [&k_parser, &hdr] {
+        if (
+          hdr.type == move_partition_replicas_cmd_type
+          || hdr.type == finish_moving_partition_replicas_cmd_type) {
+            auto ntp = reflection::adl<model::ntp>{}.from(k_parser);
+            return model::topic_namespace(
+              std::move(ntp.ns), std::move(ntp.tp.topic));
+        }
+        return reflection::adl<model::topic_namespace>{}.from(k_parser);
+    }();
+
+    auto kind = command_kind::update;
+    if (hdr.type == create_topic_cmd_type) {
+        kind = command_kind::create;
+    } else if (hdr.type == delete_topic_cmd_type) {
+        kind = command_kind::remove;
+    }
+    add_command(_topics[std::move(key)], kind, std::move(b));
+}
+
+void controller_log_compactor::add_create_topics(
+  model::offset o, std::vector<topic_configuration_assignment> topics) {
+    // the command creates all the topics or none of them
+    absl::flat_hash_set<
+      model::topic_namespace,
+      model::topic_namespace_hash,
+      model::topic_namespace_eq>
+      names;
+    for (const auto& t : topics) {
+        auto it = _topics.find(t.cfg.tp_ns);
+        if (
+          (it != _topics.end() && it->second.exists)
+          || !names.insert(t.cfg.tp_ns).second) {
+            return;
+        }
+    }
+    for (auto& t : topics) {
+        auto& h = _topics[t.cfg.tp_ns];
+        add_command(
+          h, command_kind::create, make_create_topic_batch(o, std::move(t)));
+    }
+}
+
+void controller_log_compactor::add_user_command(model::record_batch b) {
+    auto hdr = read_command_header(b);
+    iobuf_parser k_parser(std::move(hdr.key));
+    auto key = reflection::adl<security::credential_user>{}.from(k_parser);
+
+    auto kind = command_kind::replace;
+    if (hdr.type == create_user_cmd_type) {
+        kind = command_kind::create;
+    } else if (hdr.type == delete_user_cmd_type) {
+        kind = command_kind::remove;
+    }
+    add_command(_users[std::move(key)], kind, std::move(b));
+}
+
+void controller_log_compactor::add_command(
+  key_history& h, command_kind kind, model::record_batch b) {
+    switch (kind) {
+    case command_kind::create:
+        if (!h.exists) {
+            h.batches.push_back(std::move(b));
+            h.exists = true;
+            h.ends_with_replace = false;
+        }
+        return;
+    case command_kind::remove:
+        // a delete is kept when it is the first command seen for the key, as
+        // it may come from a previously compacted log
+        if (h.exists || h.batches.empty()) {
+            h.batches.clear();
+            h.batches.push_back(std::move(b));
+            h.exists = false;
+            h.ends_with_replace = false;
+        }
+        return;
+    case command_kind::update:
+        if (h.exists) {
+            h.batches.push_back(std::move(b));
+        }
+        return;
+    case command_kind::replace:
+        if (!h.exists) {
+            return;
+        }
+        if (h.ends_with_replace) {
+            h.batches.back() = std::move(b);
+        } else {
+            h.batches.push_back(std::move(b));
+            h.ends_with_replace = true;
+        }
+        return;
+    }
+}
+
+std::vector<model::record_batch> controller_log_compactor::release() && {
+    std::vector<model::record_batch> ret = std::move(_acls);
+    auto append = [&ret](auto& histories) {
+        for (auto& [_, h] : histories) {
+            std::move(
+              h.batches.begin(), h.batches.end(), std::back_inserter(ret));
+        }
+    };
+    append(_topics);
+    append(_users);
+    std::stable_sort(
+      ret.begin(),
+      ret.end(),
+      [](const model::record_batch& a, const model::record_batch& b) {
+          return a.base_offset() < b.base_offset();
+      });
+    return ret;
+}
+
+} // namespace cluster
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "cluster/types.h"
+#include "model/metadata.h"
+#include "model/record.h"
+#include "security/credential_store.h"
+
+#include <absl/container/node_hash_map.h>
+
+#include <vector>
+
+namespace cluster {
+
+/// \brief reduces the controller log to the commands needed to rebuild the
+/// controller state by applying them in order.
+///
+/// the commands of a topic or a user that was deleted are replaced with the
+/// delete command, which fails harmlessly on a state that never had the key
+/// but still removes it from a state that was applied up to an offset in
+/// between. only the latest update of a user credential is kept and the
+/// commands that fail when applied, like creating a topic that exists, are
+/// dropped. acl commands are kept as they are. batches keep their offsets, as
+/// the offset of a command is the revision of the partitions it creates
+class controller_log_compactor {
+public:
+    /// batches have to be added in offset order, batches of other types than
+    /// the controller commands are dropped
+    void add(model::record_batch);
+
+    /// the remaining batches in offset order
+    std::vector<model::record_batch> release() &&;
+
+private:
+    enum class command_kind {
+        create,
+        remove,
+        // applied on top of the previous updates
+        update,
+        // replaces the previous update
+        replace,
+    };
+
+    struct key_history {
+        std::vector<model::record_batch> batches;
+        bool exists{false};
+        bool ends_with_replace{false};
+    };
+
+    static void add_command(key_history&, command_kind, model::record_batch);
+    void add_topic_command(model::record_batch);
+    void add_create_topics(
+      model::offset, std::vector<topic_configuration_assignment>);
+    void add_user_command(model::record_batch);
+
+    absl::node_hash_map<
+      model::topic_namespace,
+      key_history,
+      model::topic_namespace_hash,
+      model::topic_namespace_eq>
+      _topics;
+    absl::node_hash_map<security::credential_user, key_history> _users;
+    std::vector<model::record_batch> _acls;
+};
+
+} // namespace cluster
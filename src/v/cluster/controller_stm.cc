@@ -0,0 +1,186 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "cluster/controller_stm.h"
+
+#include "bytes/iobuf_parser.h"
+#include "cluster/controller_log_compactor.h"
+#include "cluster/logger.h"
+#include "config/configuration.h"
+#include "model/adl_serde.h"
+#include "raft/consensus.h"
+#include "raft/types.h"
+#include "reflection/adl.h"
+#include "storage/types.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+
+#include <exception>
+#include <stdexcept>
+
+namespace cluster {
+
+namespace {
+
+struct compacting_consumer {
+    ss::future<ss::stop_iteration> operator()(model::record_batch b) {
+        compactor->add(std::move(b));
+        return ss::make_ready_future<ss::stop_iteration>(
+          ss::stop_iteration::no);
+    }
+    void end_of_stream() {}
+
+    controller_log_compactor* compactor;
+};
+
+} // namespace
+
+controller_stm::controller_stm(
+  ss::logger& logger,
+  raft::consensus* c,
+  raft::persistent_last_applied persist,
+  topic_updates_dispatcher& dispatcher,
+  security_manager& security)
+  : mux_state_machine(logger, c, persist, dispatcher, security)
+  , _raft(c)
+  , _snapshot_interval(
+      config::shard_local_cfg().controller_snapshot_interval_ms()) {
+    _snapshot_timer.set_callback([this] {
+        (void)ss::with_gate(_gate, [this] {
+            return maybe_write_snapshot().handle_exception(
+              [](std::exception_ptr e) {
+                  vlog(clusterlog.warn, "controller snapshot failed - {}", e);
+              });
+        }).finally([this] {
+            if (!_gate.is_closed()) {
+                _snapshot_timer.arm(_snapshot_interval);
+            }
+        });
+    });
+}
+
+ss::future<> controller_stm::start() {
+    if (config::shard_local_cfg().enable_controller_log_snapshots()) {
+        _snapshot_timer.arm(_snapshot_interval);
+    }
+    return mux_state_machine::start();
+}
+
+ss::future<> controller_stm::stop() {
+    _snapshot_timer.cancel();
+    return mux_state_machine::stop();
+}
+
+ss::future<std::optional<controller_stm::snapshot>>
+controller_stm::read_snapshot() {
+    auto reader = co_await _raft->open_snapshot();
+    if (!reader) {
+        co_return std::nullopt;
+    }
+    std::exception_ptr ex;
+    std::optional<snapshot> ret;
+    try {
+        iobuf_parser md_parser(co_await reader->read_metadata());
+        auto md = reflection::adl<raft::snapshot_metadata>{}.from(md_parser);
+        auto size = co_await reader->get_snapshot_size();
+        auto buf = co_await read_iobuf_exactly(reader->input(), size);
+        snapshot snap{.last_included = md.last_included_index};
+        // a snapshot taken before the controller wrote any content
+        if (!buf.empty()) {
+            iobuf_parser parser(std::move(buf));
+            auto version = reflection::adl<int8_t>{}.from(parser);
+            if (version != snapshot_version) {
+                throw std::runtime_error(fmt::format(
+                  "Unsupported controller snapshot version {}", version));
+            }
+            snap.batches
+              = reflection::adl<std::vector<model::record_batch>>{}.from(
+                parser);
+        }
+        ret = std::move(snap);
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    co_await reader->close();
+    if (ex) {
+        std::rethrow_exception(ex);
+    }
+    co_return ret;
+}
+
+ss::future<> controller_stm::apply_raft_snapshot(model::offset last_included) {
+    auto snap = co_await read_snapshot();
+    if (!snap) {
+        throw std::runtime_error(fmt::format(
+          "Controller snapshot at offset {} not found", last_included));
+    }
+    // commands up to the last applied offset are already part of the state
+    const auto next = last_applied_offset() + model::offset(1);
+    size_t applied = 0;
+    for (auto& b : snap->batches) {
+        if (b.base_offset() < next) {
+            continue;
+        }
+        co_await apply(std::move(b));
+        ++applied;
+    }
+    vlog(
+      clusterlog.info,
+      "Applied {} commands of controller snapshot at offset {}",
+      applied,
+      snap->last_included);
+}
+
+ss::future<> controller_stm::maybe_write_snapshot() {
+    const auto last_applied = last_applied_offset();
+    const auto last_snapshot = _raft->last_snapshot_index();
+    const auto min_entries = static_cast<int64_t>(
+      config::shard_local_cfg().controller_snapshot_min_entries());
+    if (last_applied() - last_snapshot() < min_entries) {
+        co_return;
+    }
+
+    // the new snapshot is the previous one followed by the log up to the
+    // last applied offset, compacted together
+    controller_log_compactor compactor;
+    auto start = model::offset(0);
+    auto prev = co_await read_snapshot();
+    if (prev) {
+        if (prev->last_included != last_snapshot) {
+            co_return;
+        }
+        for (auto& b : prev->batches) {
+            compactor.add(std::move(b));
+        }
+        start = prev->last_included + model::offset(1);
+    }
+    auto reader = co_await _raft->make_reader(storage::log_reader_config(
+      start, last_applied, ss::default_priority_class()));
+    co_await std::move(reader).consume(
+      compacting_consumer{.compactor = &compactor}, model::no_timeout);
+    if (_raft->last_snapshot_index() != last_snapshot) {
+        // the leader installed a snapshot in the meantime
+        co_return;
+    }
+
+    auto batches = std::move(compactor).release();
+    const auto commands = batches.size();
+    iobuf data;
+    reflection::serialize(data, snapshot_version, std::move(batches));
+    co_await _raft->write_snapshot(
+      raft::write_snapshot_cfg(last_applied, std::move(data)));
+    vlog(
+      clusterlog.info,
+      "Wrote controller snapshot at offset {} with {} commands",
+      last_applied,
+      commands);
+}
+
+} // namespace cluster
@@ -13,14 +13,56 @@
 
 #include "cluster/security_manager.h"
 #include "cluster/topic_updates_dispatcher.h"
+#include "model/record.h"
 #include "raft/mux_state_machine.h"
 
+#include <seastar/core/timer.hh>
+
+#include <chrono>
+#include <optional>
+#include <vector>
+
 namespace cluster {
 
-// single instance
-using controller_stm
-  = raft::mux_state_machine<topic_updates_dispatcher, security_manager>;
+/**
+ * Controller state machine. When controller log snapshots are enabled the
+ * applied prefix of the log is periodically replaced with a raft snapshot
+ * holding the compacted commands of the prefix, see controller_log_compactor.
+ * A starting broker, or a follower the snapshot was installed on, applies the
+ * commands of the snapshot with their original offsets before the tail of the
+ * log, so the revisions of the partitions do not change.
+ */
+class controller_stm final
+  : public raft::mux_state_machine<topic_updates_dispatcher, security_manager> {
+public:
+    static constexpr int8_t snapshot_version = 0;
+
+    controller_stm(
+      ss::logger&,
+      raft::consensus*,
+      raft::persistent_last_applied,
+      topic_updates_dispatcher&,
+      security_manager&);
+
+    ss::future<> start();
+    ss::future<> stop();
+
+private:
+    struct snapshot {
+        // offset of the last command included in the snapshot
+        model::offset last_included;
+        std::vector<model::record_batch> batches;
+    };
+
+    ss::future<> apply_raft_snapshot(model::offset) final;
+    ss::future<std::optional<snapshot>> read_snapshot();
+    ss::future<> maybe_write_snapshot();
+
+    raft::consensus* _raft;
+    std::chrono::milliseconds _snapshot_interval;
+    ss::timer<> _snapshot_timer;
+};
 
 static constexpr ss::shard_id controller_stm_shard = 0;
 
-} // namespace cluster
\ No newline at end of file
+} // namespace cluster
@@ -29,5 +29,9 @@ class members_table;
 class metadata_cache;
 class metadata_dissemination_service;
 class security_frontend;
+class shard_balancer;
+class node_load_reporter;
+class partition_balancer;
+class health_table;
 
 } // namespace cluster
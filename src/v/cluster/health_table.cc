@@ -0,0 +1,89 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "cluster/health_table.h"
+
+#include <algorithm>
+
+namespace cluster {
+
+void health_table::update(
+  node_load_report report, ss::lowres_clock::time_point expires) {
+    node_entry entry{.report = std::move(report), .expires = expires};
+    auto& topics = entry.report.topics;
+    entry.topics.reserve(topics.size());
+    for (size_t i = 0; i < topics.size(); ++i) {
+        // sorted to look the partitions up by id
+        std::sort(
+          topics[i].partitions.begin(),
+          topics[i].partitions.end(),
+          [](const partition_status& l, const partition_status& r) {
+              return l.id < r.id;
+          });
+        entry.topics.emplace(topics[i].tp_ns, i);
+    }
+    auto id = entry.report.node;
+    _nodes.insert_or_assign(id, std::move(entry));
+}
+
+const health_table::node_entry* health_table::find(model::node_id id) const {
+    auto it = _nodes.find(id);
+    if (it == _nodes.end() || it->second.expires < ss::lowres_clock::now()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+const node_load_report* health_table::get_node(model::node_id id) const {
+    if (auto entry = find(id); entry) {
+        return &entry->report;
+    }
+    return nullptr;
+}
+
+std::vector<health_table::replica_status>
+health_table::get_partition(const model::ntp& ntp) const {
+    std::vector<replica_status> ret;
+    const auto now = ss::lowres_clock::now();
+    for (const auto& [id, entry] : _nodes) {
+        if (entry.expires < now) {
+            continue;
+        }
+        auto it = entry.topics.find(model::topic_namespace_view(ntp));
+        if (it == entry.topics.end()) {
+            continue;
+        }
+        const auto& partitions = entry.report.topics[it->second].partitions;
+        auto p_it = std::lower_bound(
+          partitions.begin(),
+          partitions.end(),
+          ntp.tp.partition,
+          [](const partition_status& p, model::partition_id pid) {
+              return p.id < pid;
+          });
+        if (p_it != partitions.end() && p_it->id == ntp.tp.partition) {
+            ret.push_back(replica_status{.node = id, .status = *p_it});
+        }
+    }
+    return ret;
+}
+
+std::vector<node_load_report> health_table::all_reports() const {
+    std::vector<node_load_report> ret;
+    ret.reserve(_nodes.size());
+    const auto now = ss::lowres_clock::now();
+    for (const auto& [_, entry] : _nodes) {
+        if (entry.expires >= now) {
+            ret.push_back(entry.report);
+        }
+    }
+    return ret;
+}
+
+} // namespace cluster
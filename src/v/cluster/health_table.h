@@ -0,0 +1,75 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "cluster/types.h"
+#include "model/fundamental.h"
+#include "model/metadata.h"
+#include "seastarx.h"
+
+#include <seastar/core/future.hh>
+#include <seastar/core/lowres_clock.hh>
+
+#include <absl/container/flat_hash_map.h>
+
+#include <vector>
+
+namespace cluster {
+
+/**
+ * Latest load report of every node, kept by the controller leader. Reports
+ * are indexed when they arrive so that the state of a node or of the
+ * replicas of a partition is found without asking the nodes. A report that
+ * was not refreshed before it expires is ignored. Single instance, runs on
+ * shard 0.
+ */
+class health_table {
+public:
+    static constexpr ss::shard_id shard = 0;
+
+    struct replica_status {
+        model::node_id node;
+        partition_status status;
+    };
+
+    ss::future<> stop() { return ss::now(); }
+
+    void update(node_load_report, ss::lowres_clock::time_point expires);
+
+    /// Returns nullptr if the node did not report or its report expired
+    const node_load_report* get_node(model::node_id) const;
+
+    /// Returns the replicas of the partition reported by the nodes
+    std::vector<replica_status> get_partition(const model::ntp&) const;
+
+    /// Returns reports of all nodes that did not expire
+    std::vector<node_load_report> all_reports() const;
+
+private:
+    struct node_entry {
+        node_load_report report;
+        ss::lowres_clock::time_point expires;
+        // position of every topic in the report
+        absl::flat_hash_map<
+          model::topic_namespace,
+          size_t,
+          model::topic_namespace_hash,
+          model::topic_namespace_eq>
+          topics;
+    };
+
+    const node_entry* find(model::node_id) const;
+
+    absl::flat_hash_map<model::node_id, node_entry> _nodes;
+};
+
+} // namespace cluster
@@ -28,7 +28,17 @@ id_allocator::id_allocator(
 
 ss::future<allocate_id_reply>
 id_allocator::allocate_id(allocate_id_request&& req, rpc::streaming_context&) {
-    return _id_allocator_frontend.local().do_allocate_id(req.timeout);
+    return _id_allocator_frontend.local()
+      .do_allocate_ids(1, req.timeout)
+      .then([](allocate_id_range_reply r) {
+          return allocate_id_reply{r.id, r.ec};
+      });
+}
+
+ss::future<allocate_id_range_reply> id_allocator::allocate_id_range(
+  allocate_id_range_request&& req, rpc::streaming_context&) {
+    return _id_allocator_frontend.local().do_allocate_ids(
+      req.count, req.timeout);
 }
 
 } // namespace cluster
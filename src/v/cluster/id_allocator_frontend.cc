@@ -47,8 +47,89 @@ id_allocator_frontend::id_allocator_frontend(
   , _leaders(leaders)
   , _controller(controller) {}
 
+ss::future<> id_allocator_frontend::stop() { return _gate.close(); }
+
 ss::future<allocate_id_reply>
 id_allocator_frontend::allocate_id(model::timeout_clock::duration timeout) {
+    int64_t prefetch
+      = config::shard_local_cfg().id_allocator_prefetch_size.value();
+
+    if (prefetch <= 1) {
+        auto r = co_await allocate_ids(1, timeout);
+        co_return allocate_id_reply{r.id, r.ec};
+    }
+
+    while (_prefetched.empty()) {
+        auto ec = co_await _refill_mutex.with([this, prefetch, timeout] {
+            if (!_prefetched.empty()) {
+                // refilled while we were waiting for the mutex
+                return ss::make_ready_future<errc>(errc::success);
+            }
+            return refill(prefetch, timeout);
+        });
+        if (ec != errc::success) {
+            co_return allocate_id_reply{0, ec};
+        }
+    }
+
+    auto id = take_prefetched_id();
+    maybe_schedule_refill(prefetch, timeout);
+    co_return allocate_id_reply{id, errc::success};
+}
+
+int64_t id_allocator_frontend::take_prefetched_id() {
+    auto& range = _prefetched.front();
+    auto id = range.next++;
+    --_prefetched_ids;
+    if (range.next == range.end) {
+        _prefetched.pop_front();
+    }
+    return id;
+}
+
+void id_allocator_frontend::maybe_schedule_refill(
+  int64_t prefetch, model::timeout_clock::duration timeout) {
+    if (
+      _refill_scheduled || _gate.is_closed()
+      || _prefetched_ids > prefetch / 2) {
+        return;
+    }
+    _refill_scheduled = true;
+    (void)ss::with_gate(_gate, [this, prefetch, timeout] {
+        return _refill_mutex
+          .with([this, prefetch, timeout] {
+              if (_prefetched_ids > prefetch / 2) {
+                  return ss::make_ready_future<errc>(errc::success);
+              }
+              return refill(prefetch, timeout);
+          })
+          .then([](errc ec) {
+              if (ec != errc::success) {
+                  vlog(
+                    clusterlog.debug,
+                    "can't prefetch ids: {}",
+                    make_error_code(ec).message());
+              }
+          })
+          .handle_exception([](std::exception_ptr e) {
+              vlog(clusterlog.debug, "can't prefetch ids: {}", e);
+          })
+          .finally([this] { _refill_scheduled = false; });
+    });
+}
+
+ss::future<errc> id_allocator_frontend::refill(
+  int64_t count, model::timeout_clock::duration timeout) {
+    auto r = co_await allocate_ids(count, timeout);
+    if (r.ec == errc::success && r.count > 0) {
+        _prefetched.push_back(id_range{r.id, r.id + r.count});
+        _prefetched_ids += r.count;
+    }
+    co_return r.ec;
+}
+
+ss::future<allocate_id_range_reply> id_allocator_frontend::allocate_ids(
+  int64_t count, model::timeout_clock::duration timeout) {
     auto nt = model::topic_namespace(
       model::kafka_internal_namespace, model::id_allocator_topic);
 
@@ -58,10 +139,10 @@ id_allocator_frontend::allocate_id(model::timeout_clock::duration timeout) {
         has_topic = try_create_id_allocator_topic();
     }
 
-    return has_topic.then([this, timeout](bool does_topic_exist) {
+    return has_topic.then([this, count, timeout](bool does_topic_exist) {
         if (!does_topic_exist) {
-            return ss::make_ready_future<allocate_id_reply>(
-              allocate_id_reply{0, errc::topic_not_exists});
+            return ss::make_ready_future<allocate_id_range_reply>(
+              allocate_id_range_reply{0, 0, errc::topic_not_exists});
         }
 
         auto leader = _leaders.local().get_leader(model::id_allocator_ntp);
@@ -71,23 +152,24 @@ id_allocator_frontend::allocate_id(model::timeout_clock::duration timeout) {
               clusterlog.warn,
               "can't find a leader for {}",
               model::id_allocator_ntp);
-            return ss::make_ready_future<allocate_id_reply>(
-              allocate_id_reply{0, errc::no_leader_controller});
+            return ss::make_ready_future<allocate_id_range_reply>(
+              allocate_id_range_reply{0, 0, errc::no_leader_controller});
         }
 
         auto _self = _controller->self();
 
         if (leader == _self) {
-            return do_allocate_id(timeout);
+            return do_allocate_ids(count, timeout);
         }
 
         vlog(
           clusterlog.trace,
-          "dispatching allocate id to {} from {}",
+          "dispatching allocate {} ids to {} from {}",
+          count,
           leader,
           _self);
 
-        return dispatch_allocate_id_to_leader(leader.value(), timeout);
+        return dispatch_allocate_ids_to_leader(leader.value(), count, timeout);
     });
 }
 
@@ -119,8 +201,45 @@ id_allocator_frontend::dispatch_allocate_id_to_leader(
       });
 }
 
-ss::future<allocate_id_reply>
-id_allocator_frontend::do_allocate_id(model::timeout_clock::duration timeout) {
+ss::future<allocate_id_range_reply>
+id_allocator_frontend::dispatch_allocate_ids_to_leader(
+  model::node_id leader,
+  int64_t count,
+  model::timeout_clock::duration timeout) {
+    auto r = co_await _connection_cache.local()
+               .with_node_client<cluster::id_allocator_client_protocol>(
+                 _controller->self(),
+                 ss::this_shard_id(),
+                 leader,
+                 timeout,
+                 [timeout, count](id_allocator_client_protocol cp) {
+                     return cp.allocate_id_range(
+                       allocate_id_range_request{timeout, count},
+                       rpc::client_opts(
+                         model::timeout_clock::now() + timeout));
+                 })
+               .then(&rpc::get_ctx_data<allocate_id_range_reply>);
+
+    if (r.has_error() && r.error() == rpc::errc::method_not_found) {
+        // the leader doesn't serve ranges yet, fall back to a single id
+        auto single = co_await dispatch_allocate_id_to_leader(leader, timeout);
+        co_return allocate_id_range_reply{
+          single.id, single.ec == errc::success ? 1 : 0, single.ec};
+    }
+
+    if (r.has_error()) {
+        vlog(
+          clusterlog.warn,
+          "got error {} on remote allocate id range",
+          r.error());
+        co_return allocate_id_range_reply{0, 0, errc::timeout};
+    }
+
+    co_return r.value();
+}
+
+ss::future<allocate_id_range_reply> id_allocator_frontend::do_allocate_ids(
+  int64_t count, model::timeout_clock::duration timeout) {
     auto shard = _shard_table.local().shard_for(model::id_allocator_ntp);
 
     if (unlikely(!shard)) {
@@ -138,25 +257,28 @@ id_allocator_frontend::do_allocate_id(model::timeout_clock::duration timeout) {
               clusterlog.warn,
               "can't find a shard for {}",
               model::id_allocator_ntp);
-            co_return allocate_id_reply{0, errc::no_leader_controller};
+            co_return allocate_id_range_reply{
+              0, 0, errc::no_leader_controller};
         }
     }
 
-    co_return co_await do_allocate_id(*shard, timeout);
+    co_return co_await do_allocate_ids(*shard, count, timeout);
 }
 
-ss::future<allocate_id_reply> id_allocator_frontend::do_allocate_id(
-  ss::shard_id shard, model::timeout_clock::duration timeout) {
+ss::future<allocate_id_range_reply> id_allocator_frontend::do_allocate_ids(
+  ss::shard_id shard, int64_t count, model::timeout_clock::duration timeout) {
     return _partition_manager.invoke_on(
-      shard, _ssg, [timeout](cluster::partition_manager& mgr) mutable {
+      shard,
+      _ssg,
+      [count, timeout](cluster::partition_manager& mgr) mutable {
           auto partition = mgr.get(model::id_allocator_ntp);
           if (!partition) {
               vlog(
                 clusterlog.warn,
                 "can't get partition by {} ntp",
                 model::id_allocator_ntp);
-              return ss::make_ready_future<allocate_id_reply>(
-                allocate_id_reply{0, errc::topic_not_exists});
+              return ss::make_ready_future<allocate_id_range_reply>(
+                allocate_id_range_reply{0, 0, errc::topic_not_exists});
           }
           auto& stm = partition->id_allocator_stm();
           if (!stm) {
@@ -164,20 +286,23 @@ ss::future<allocate_id_reply> id_allocator_frontend::do_allocate_id(
                 clusterlog.warn,
                 "can't get id allocator stm of the {}' partition",
                 model::id_allocator_ntp);
-              return ss::make_ready_future<allocate_id_reply>(
-                allocate_id_reply{0, errc::topic_not_exists});
+              return ss::make_ready_future<allocate_id_range_reply>(
+                allocate_id_range_reply{0, 0, errc::topic_not_exists});
           }
           return stm
-            ->allocate_id_and_wait(model::timeout_clock::now() + timeout)
-            .then([](id_allocator_stm::stm_allocation_result r) {
+            ->allocate_id_and_wait(
+              model::timeout_clock::now() + timeout, count)
+            .then([count](id_allocator_stm::stm_allocation_result r) {
                 if (r.raft_status == raft::errc::success) {
-                    return allocate_id_reply{r.id, errc::success};
+                    return allocate_id_range_reply{
+                      r.id, count, errc::success};
                 } else {
                     vlog(
                       clusterlog.trace,
                       "allocate id stm call failed with {}",
                       r.raft_status);
-                    return allocate_id_reply{r.id, errc::replication_error};
+                    return allocate_id_range_reply{
+                      r.id, 0, errc::replication_error};
                 }
             });
       });
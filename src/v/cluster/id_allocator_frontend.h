@@ -12,9 +12,12 @@
 #pragma once
 #include "cluster/types.h"
 #include "rpc/connection_cache.h"
+#include "utils/mutex.h"
 
+#include <seastar/core/gate.hh>
 #include <seastar/core/sharded.hh>
 
+#include <deque>
 #include <vector>
 
 namespace cluster {
@@ -34,6 +37,11 @@ class id_allocator;
 //
 // when the service recieves a call it triggers id_allocator_frontend
 // which in its own turn pass the request to the id_allocator_stm
+//
+// every shard keeps a range of pre-fetched ids (see
+// id_allocator_prefetch_size) so allocate_id is usually answered
+// locally; once half of the range is used the frontend fetches the next
+// range in the background.
 class id_allocator_frontend {
 public:
     id_allocator_frontend(
@@ -48,7 +56,14 @@ public:
     ss::future<allocate_id_reply>
     allocate_id(model::timeout_clock::duration timeout);
 
+    ss::future<> stop();
+
 private:
+    struct id_range {
+        int64_t next;
+        int64_t end;
+    };
+
     ss::smp_service_group _ssg;
     ss::sharded<cluster::partition_manager>& _partition_manager;
     ss::sharded<cluster::shard_table>& _shard_table;
@@ -57,14 +72,30 @@ private:
     ss::sharded<partition_leaders_table>& _leaders;
     std::unique_ptr<cluster::controller>& _controller;
 
+    std::deque<id_range> _prefetched;
+    int64_t _prefetched_ids{0};
+    mutex _refill_mutex;
+    bool _refill_scheduled{false};
+    ss::gate _gate;
+
+    int64_t take_prefetched_id();
+    void maybe_schedule_refill(int64_t, model::timeout_clock::duration);
+    ss::future<errc> refill(int64_t, model::timeout_clock::duration);
+
+    ss::future<allocate_id_range_reply>
+      allocate_ids(int64_t, model::timeout_clock::duration);
+
     ss::future<allocate_id_reply> dispatch_allocate_id_to_leader(
       model::node_id, model::timeout_clock::duration);
 
-    ss::future<allocate_id_reply>
-      do_allocate_id(model::timeout_clock::duration);
+    ss::future<allocate_id_range_reply> dispatch_allocate_ids_to_leader(
+      model::node_id, int64_t, model::timeout_clock::duration);
 
-    ss::future<allocate_id_reply>
-      do_allocate_id(ss::shard_id, model::timeout_clock::duration);
+    ss::future<allocate_id_range_reply>
+      do_allocate_ids(int64_t, model::timeout_clock::duration);
+
+    ss::future<allocate_id_range_reply>
+      do_allocate_ids(ss::shard_id, int64_t, model::timeout_clock::duration);
 
     ss::future<bool> try_create_id_allocator_topic();
 
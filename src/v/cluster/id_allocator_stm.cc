@@ -41,14 +41,15 @@ id_allocator_stm::id_allocator_stm(
 
 ss::future<id_allocator_stm::stm_allocation_result>
 id_allocator_stm::allocate_id_and_wait(
-  model::timeout_clock::time_point timeout) {
+  model::timeout_clock::time_point timeout, int64_t count) {
     auto prelude = ss::now();
-    auto range = _config.id_allocator_batch_size.value();
+    auto range = std::max<int64_t>(
+      _config.id_allocator_batch_size.value(), count);
 
-    if (_last_allocated_range > 0) {
+    if (_last_allocated_range >= count) {
         auto allocated_id = _last_allocated_base;
-        _last_allocated_range -= 1;
-        _last_allocated_base += 1;
+        _last_allocated_range -= count;
+        _last_allocated_base += count;
 
         return ss::make_ready_future<stm_allocation_result>(
           stm_allocation_result{allocated_id, raft::errc::success});
@@ -87,14 +88,16 @@ id_allocator_stm::allocate_id_and_wait(
         }
     }
 
-    return prelude.then([this, timeout, range] {
+    return prelude.then([this, timeout, range, count] {
         sequence_id seq = sequence_id{
           _run_id.value(), _c->self(), ++_last_seq_tick};
 
+        // a tail of the previous batch shorter than count is skipped,
+        // ids only have to be unique
         return replicate_and_wait(allocation_cmd{seq, range}, timeout, seq)
-          .then([this](log_allocation_result r) {
-              _last_allocated_base = r.base + 1;
-              _last_allocated_range = r.range - 1;
+          .then([this, count](log_allocation_result r) {
+              _last_allocated_base = r.base + count;
+              _last_allocated_range = r.range - count;
               return stm_allocation_result{r.base, r.raft_status};
           });
     });
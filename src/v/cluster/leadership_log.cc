@@ -0,0 +1,57 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "cluster/leadership_log.h"
+
+#include "random/generators.h"
+
+#include <absl/container/flat_hash_map.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace cluster {
+
+leadership_log::leadership_log(size_t max_entries)
+  : _max_entries(std::max<size_t>(max_entries, 1))
+  // zero is never an incarnation, peers that did not see the log yet ask
+  // for it
+  , _incarnation(random_generators::get_int<uint64_t>(
+      1, std::numeric_limits<uint64_t>::max())) {}
+
+void leadership_log::append(ntp_leader l) {
+    _entries.push_back(std::move(l));
+    ++_version;
+    while (_entries.size() > _max_entries) {
+        _entries.pop_front();
+    }
+}
+
+std::optional<ntp_leaders>
+leadership_log::changes_since(uint64_t incarnation, uint64_t version) const {
+    const uint64_t base = _version - _entries.size();
+    if (incarnation != _incarnation || version < base || version > _version) {
+        return std::nullopt;
+    }
+    // only the latest change of a partition is interesting to peers
+    absl::flat_hash_map<model::ntp, size_t> latest;
+    for (auto i = version - base; i < _entries.size(); ++i) {
+        latest.insert_or_assign(_entries[i].ntp, i);
+    }
+    ntp_leaders ret;
+    ret.reserve(latest.size());
+    for (auto i = version - base; i < _entries.size(); ++i) {
+        if (latest[_entries[i].ntp] == i) {
+            ret.push_back(_entries[i]);
+        }
+    }
+    return ret;
+}
+
+} // namespace cluster
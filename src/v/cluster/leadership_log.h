@@ -0,0 +1,53 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "cluster/metadata_dissemination_types.h"
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+namespace cluster {
+
+/// \brief versioned log of the leadership changes of the partitions led by
+/// the current node.
+///
+/// every change appended to the log bumps its version, peers remember the
+/// version they have seen and ask for the changes after it. the log keeps
+/// the latest max_entries changes only, a peer that fell further behind, or
+/// that saw a previous incarnation of the log, catches up from a snapshot
+class leadership_log {
+public:
+    explicit leadership_log(size_t max_entries);
+
+    void append(ntp_leader);
+
+    /// \brief the latest change of every partition changed after `version`,
+    /// in the order of the changes. nullopt if the log no longer contains
+    /// all of them
+    std::optional<ntp_leaders>
+    changes_since(uint64_t incarnation, uint64_t version) const;
+
+    /// \brief random, changes when the node restarts
+    uint64_t incarnation() const { return _incarnation; }
+    uint64_t version() const { return _version; }
+    size_t size() const { return _entries.size(); }
+
+private:
+    size_t _max_entries;
+    uint64_t _incarnation;
+    uint64_t _version{0};
+    std::deque<ntp_leader> _entries;
+};
+
+} // namespace cluster
@@ -10,6 +10,7 @@
 #include "cluster/members_manager.h"
 
 #include "cluster/cluster_utils.h"
+#include "cluster/health_table.h"
 #include "cluster/logger.h"
 #include "cluster/members_table.h"
 #include "cluster/partition_allocator.h"
@@ -22,6 +23,7 @@
 #include "reflection/adl.h"
 #include "storage/api.h"
 
+#include <seastar/core/coroutine.hh>
 #include <seastar/core/do_with.hh>
 #include <seastar/core/future-util.hh>
 #include <seastar/core/future.hh>
@@ -39,6 +41,7 @@ members_manager::members_manager(
   ss::sharded<members_table>& members_table,
   ss::sharded<rpc::connection_cache>& connections,
   ss::sharded<partition_allocator>& allocator,
+  ss::sharded<health_table>& health,
   ss::sharded<storage::api>& storage,
   ss::sharded<ss::abort_source>& as)
   : _seed_servers(config::shard_local_cfg().seed_servers())
@@ -49,6 +52,7 @@ members_manager::members_manager(
   , _members_table(members_table)
   , _connection_cache(connections)
   , _allocator(allocator)
+  , _health_table(health)
   , _storage(storage)
   , _as(as)
   , _rpc_tls_config(config::shard_local_cfg().rpc_server_tls()) {}
@@ -346,6 +350,55 @@ members_manager::handle_join_request(model::broker broker) {
       });
 }
 
+ss::future<result<node_load_report_reply>>
+members_manager::handle_node_load_report(node_load_report report) {
+    using ret_t = result<node_load_report_reply>;
+    if (!_raft0->is_leader()) {
+        co_return ret_t(errc::not_leader_controller);
+    }
+    // a report that was not refreshed for a few intervals is stale, the
+    // allocator falls back to partition counts for that node
+    auto expires
+      = ss::lowres_clock::now()
+        + 3 * config::shard_local_cfg().node_load_report_interval_ms();
+    co_await _allocator.invoke_on(
+      partition_allocator::shard,
+      [&report, expires](partition_allocator& pa) {
+          pa.update_node_load(report, expires);
+      });
+    co_await _health_table.invoke_on(
+      health_table::shard, [&report, expires](health_table& ht) {
+          ht.update(std::move(report), expires);
+      });
+    co_return ret_t(node_load_report_reply{errc::success});
+}
+
+ss::future<result<node_load_report_reply>>
+members_manager::dispatch_node_load_report(node_load_report report) {
+    using ret_t = result<node_load_report_reply>;
+    if (_raft0->is_leader()) {
+        return handle_node_load_report(std::move(report));
+    }
+    return dispatch_rpc_to_leader(
+             _join_timeout,
+             [report = std::move(report),
+              tout = rpc::clock_type::now()
+                     + _join_timeout](controller_client_protocol c) mutable {
+                 return c
+                   .report_node_load(
+                     std::move(report), rpc::client_opts(tout))
+                   .then(&rpc::get_ctx_data<node_load_report_reply>);
+             })
+      .handle_exception([](const std::exception_ptr& e) {
+          vlog(
+            clusterlog.debug,
+            "Error while dispatching node load report to leader - {}",
+            e);
+          return ss::make_ready_future<ret_t>(
+            errc::join_request_dispatch_error);
+      });
+}
+
 ss::future<> members_manager::validate_configuration_invariants() {
     static const bytes invariants_key("configuration_invariants");
     auto invariants_buf = _storage.local().kvs().get(
@@ -39,6 +39,7 @@ public:
       ss::sharded<members_table>&,
       ss::sharded<rpc::connection_cache>&,
       ss::sharded<partition_allocator>&,
+      ss::sharded<health_table>&,
       ss::sharded<storage::api>&,
       ss::sharded<ss::abort_source>&);
 
@@ -51,6 +52,15 @@ public:
     ss::future<result<configuration_update_reply>>
       handle_configuration_update_request(configuration_update_request);
 
+    /// \brief applies a node load report to the partition allocator, only the
+    /// controller leader allocates partitions
+    ss::future<result<node_load_report_reply>>
+      handle_node_load_report(node_load_report);
+
+    /// \brief sends the report of the current node to the controller leader
+    ss::future<result<node_load_report_reply>>
+      dispatch_node_load_report(node_load_report);
+
     bool is_batch_applicable(const model::record_batch& b) {
         return b.header().type == raft::configuration_batch_type;
     }
@@ -92,6 +102,7 @@ private:
     ss::sharded<members_table>& _members_table;
     ss::sharded<rpc::connection_cache>& _connection_cache;
     ss::sharded<partition_allocator>& _allocator;
+    ss::sharded<health_table>& _health_table;
     ss::sharded<storage::api>& _storage;
     ss::sharded<ss::abort_source>& _as;
     config::tls_config _rpc_tls_config;
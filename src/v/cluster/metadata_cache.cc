@@ -35,7 +35,8 @@ metadata_cache::metadata_cache(
   ss::sharded<partition_leaders_table>& leaders)
   : _topics_state(tp)
   , _members_table(m)
-  , _leaders(leaders) {}
+  , _leaders(leaders)
+  , _view(tp.local(), leaders.local()) {}
 
 std::vector<model::topic_namespace> metadata_cache::all_topics() const {
     return _topics_state.local().all_topics();
@@ -76,6 +77,20 @@ std::vector<model::topic_metadata> metadata_cache::all_topics_metadata() const {
     return all_md;
 }
 
+topic_view_ptr
+metadata_cache::find_topic_view(model::topic_namespace_view tp_ns) {
+    return _view.find(tp_ns);
+}
+
+topic_view_ptr metadata_cache::get_topic_view(topic_id id) {
+    return _view.get(id);
+}
+
+uint64_t metadata_cache::metadata_epoch() const {
+    // both epochs only grow so the sum changes whenever either of them does
+    return _topics_state.local().epoch() + _leaders.local().epoch();
+}
+
 std::optional<broker_ptr> metadata_cache::get_broker(model::node_id nid) const {
     return _members_table.local().get_broker(nid);
 }
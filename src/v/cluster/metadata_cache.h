@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include "cluster/metadata_view.h"
 #include "cluster/types.h"
 #include "model/metadata.h"
 #include "model/timestamp.h"
@@ -29,7 +30,8 @@ namespace cluster {
 /// cluster state distributed in separate components. The metadata cache
 /// core-affinity is independent from the actual state location as the Metadata
 /// cache facade, for simplicity, is instantiated on every core.
-/// MetadaCache itself does not hold any state
+/// MetadaCache itself only holds shard local views of the topics built from
+/// the underlying tables
 ///```plain
 ///
 ///   Kafka API                  Kafka Proxy
@@ -80,6 +82,21 @@ public:
     /// Returns metadata of all topics.
     std::vector<model::topic_metadata> all_topics_metadata() const;
 
+    ///\brief Returns immutable view of a single topic including the leaders
+    /// of its partitions.
+    ///
+    /// Cheaper than get_topic_metadata as nothing is copied, the view stays
+    /// valid after the topic changes. Returns nullptr if topic does not
+    /// exists
+    topic_view_ptr find_topic_view(model::topic_namespace_view);
+
+    /// Returns nullptr if there is no topic with given id anymore
+    topic_view_ptr get_topic_view(topic_id);
+
+    /// Changes every time the metadata of any topic, including the leaders
+    /// of its partitions, changes
+    uint64_t metadata_epoch() const;
+
     /// Returns all brokers, returns copy as the content of broker can change
     std::vector<broker_ptr> all_brokers() const;
 
@@ -124,5 +141,6 @@ private:
     ss::sharded<topic_table>& _topics_state;
     ss::sharded<members_table>& _members_table;
     ss::sharded<partition_leaders_table>& _leaders;
+    metadata_view _view;
 };
 } // namespace cluster
@@ -12,6 +12,7 @@
 #include "cluster/cluster_utils.h"
 #include "cluster/logger.h"
 #include "cluster/metadata_cache.h"
+#include "cluster/metadata_dissemination_service.h"
 #include "cluster/metadata_dissemination_types.h"
 #include "cluster/partition_leaders_table.h"
 #include "likely.h"
@@ -24,9 +25,11 @@ namespace cluster {
 metadata_dissemination_handler::metadata_dissemination_handler(
   ss::scheduling_group sg,
   ss::smp_service_group ssg,
-  ss::sharded<partition_leaders_table>& leaders)
+  ss::sharded<partition_leaders_table>& leaders,
+  ss::sharded<metadata_dissemination_service>& dissemination)
   : metadata_dissemination_rpc_service(sg, ssg)
-  , _leaders(leaders) {}
+  , _leaders(leaders)
+  , _dissemination(dissemination) {}
 
 ss::future<update_leadership_reply>
 metadata_dissemination_handler::update_leadership(
@@ -77,4 +80,19 @@ ss::future<get_leadership_reply> metadata_dissemination_handler::get_leadership(
       });
 }
 
+ss::future<get_leadership_changes_reply>
+metadata_dissemination_handler::get_leadership_changes(
+  get_leadership_changes_request&& req, rpc::streaming_context&) {
+    return ss::with_scheduling_group(
+      get_scheduling_group(), [this, req]() mutable {
+          // the log is kept on the core leadership notifications go to
+          return _dissemination.invoke_on(
+            metadata_dissemination_service::shard,
+            get_smp_service_group(),
+            [req](metadata_dissemination_service& s) {
+                return s.leadership_changes(req);
+            });
+      });
+}
+
 } // namespace cluster
@@ -30,6 +30,10 @@ namespace cluster {
 /// 2. get_leadership - send to any node that already belong to cluster
 ///                     after controller recovery to get the up to date
 ///                     leadership metadata
+///
+/// 3. get_leadership_changes - polled from every node to get the leadership
+///                             changes of the partitions it leads since the
+///                             previous poll
 
 class metadata_dissemination_handler
   : public metadata_dissemination_rpc_service {
@@ -37,7 +41,8 @@ public:
     metadata_dissemination_handler(
       ss::scheduling_group,
       ss::smp_service_group,
-      ss::sharded<partition_leaders_table>&);
+      ss::sharded<partition_leaders_table>&,
+      ss::sharded<metadata_dissemination_service>&);
 
     ss::future<update_leadership_reply> update_leadership(
       update_leadership_request&&, rpc::streaming_context&) final;
@@ -45,11 +50,15 @@ public:
     ss::future<get_leadership_reply>
     get_leadership(get_leadership_request&&, rpc::streaming_context&) final;
 
+    ss::future<get_leadership_changes_reply> get_leadership_changes(
+      get_leadership_changes_request&&, rpc::streaming_context&) final;
+
 private:
     ss::future<update_leadership_reply>
     do_update_leadership(update_leadership_request&&);
 
     ss::sharded<partition_leaders_table>& _leaders;
+    ss::sharded<metadata_dissemination_service>& _dissemination;
 }; // namespace cluster
 
 } // namespace cluster
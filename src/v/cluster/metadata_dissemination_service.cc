@@ -15,7 +15,6 @@
 #include "cluster/metadata_cache.h"
 #include "cluster/metadata_dissemination_rpc_service.h"
 #include "cluster/metadata_dissemination_types.h"
-#include "cluster/metadata_dissemination_utils.h"
 #include "cluster/partition_leaders_table.h"
 #include "cluster/partition_manager.h"
 #include "cluster/topic_table.h"
@@ -39,6 +38,7 @@
 
 #include <absl/container/flat_hash_set.h>
 
+#include <algorithm>
 #include <chrono>
 #include <exception>
 #include <optional>
@@ -60,12 +60,11 @@ metadata_dissemination_service::metadata_dissemination_service(
   , _self(make_self_broker(config::shard_local_cfg()))
   , _dissemination_interval(
       config::shard_local_cfg().metadata_dissemination_interval_ms)
-  , _rpc_tls_config(config::shard_local_cfg().rpc_server_tls()) {
+  , _rpc_tls_config(config::shard_local_cfg().rpc_server_tls())
+  , _log(leadership_log_capacity) {
     _dispatch_timer.set_callback([this] {
-        (void)ss::with_gate(
-          _bg, [this] { return dispatch_disseminate_leadership(); });
+        (void)ss::with_gate(_bg, [this] { return poll_leadership_changes(); });
     });
-    _dispatch_timer.arm(_dissemination_interval);
 
     for (auto& seed : config::shard_local_cfg().seed_servers()) {
         _seed_servers.push_back(seed.addr);
@@ -82,7 +81,33 @@ void metadata_dissemination_service::disseminate_leadership(
       ntp,
       leader_id.value());
 
-    _requests.push_back(ntp_leader{std::move(ntp), term, leader_id});
+    _log.append(ntp_leader{std::move(ntp), term, leader_id});
+}
+
+get_leadership_changes_reply metadata_dissemination_service::leadership_changes(
+  const get_leadership_changes_request& req) const {
+    get_leadership_changes_reply reply{
+      .incarnation = _log.incarnation(), .version = _log.version()};
+    if (auto changes = _log.changes_since(req.incarnation, req.version);
+        changes) {
+        reply.leaders = std::move(*changes);
+        return reply;
+    }
+    // the peer fell behind the log, send all the partitions led by this node
+    reply.snapshot = true;
+    _leaders.local().for_each_leader([this, &reply](
+                                       model::topic_namespace_view tp_ns,
+                                       model::partition_id pid,
+                                       std::optional<model::node_id> leader,
+                                       model::term_id term) {
+        if (leader == _self.id()) {
+            reply.leaders.push_back(ntp_leader{
+              .ntp = model::ntp(tp_ns.ns, tp_ns.tp, pid),
+              .term = term,
+              .leader_id = leader});
+        }
+    });
+    return reply;
 }
 
 ss::future<> metadata_dissemination_service::start() {
@@ -101,9 +126,10 @@ ss::future<> metadata_dissemination_service::start() {
               std::move(ntp), term, std::move(leader_id));
         });
 
-    if (ss::this_shard_id() != 0) {
+    if (ss::this_shard_id() != shard) {
         return ss::make_ready_future<>();
     }
+    _dispatch_timer.arm(_dissemination_interval);
     // poll either seed servers or configuration
     auto all_brokers = _members_table.local().all_brokers();
     // use hash set to deduplicate ids
@@ -260,88 +286,88 @@ metadata_dissemination_service::dispatch_get_metadata_update(
       });
 }
 
-void metadata_dissemination_service::collect_pending_updates() {
+ss::future<> metadata_dissemination_service::poll_leadership_changes() {
     auto brokers = _members_table.local().all_broker_ids();
-    for (auto& ntp_leader : _requests) {
-        auto tp_md = _topics.local().get_topic_metadata(
-          model::topic_namespace_view(ntp_leader.ntp));
-
-        if (!tp_md) {
-            // Topic metadata is not there anymore, partition was removed
-            continue;
-        }
-        auto non_overlapping = calculate_non_overlapping_nodes(
-          get_partition_members(ntp_leader.ntp.tp.partition, *tp_md), brokers);
-        for (auto& id : non_overlapping) {
-            if (!_pending_updates.contains(id)) {
-                _pending_updates.emplace(id, update_retry_meta{ntp_leaders{}});
-            }
-            _pending_updates[id].updates.push_back(ntp_leader);
+    // forget the logs of the nodes that left the cluster
+    std::vector<model::node_id> to_remove;
+    for (auto& [id, _] : _cursors) {
+        if (std::find(brokers.begin(), brokers.end(), id) == brokers.end()) {
+            to_remove.push_back(id);
         }
     }
-    _requests.clear();
-}
-
-void metadata_dissemination_service::cleanup_finished_updates() {
-    std::vector<model::node_id> _to_remove;
-    _to_remove.reserve(_pending_updates.size());
-    for (auto& [node_id, meta] : _pending_updates) {
-        if (meta.finished) {
-            _to_remove.push_back(node_id);
-        }
+    for (auto id : to_remove) {
+        _cursors.erase(id);
     }
-    for (auto id : _to_remove) {
-        _pending_updates.erase(id);
+    for (auto id : brokers) {
+        if (id != _self.id()) {
+            _cursors.try_emplace(id);
+        }
     }
-}
-
-ss::future<> metadata_dissemination_service::dispatch_disseminate_leadership() {
-    collect_pending_updates();
     return ss::parallel_for_each(
-             _pending_updates.begin(),
-             _pending_updates.end(),
-             [this](broker_updates_t::value_type& br_update) {
-                 return dispatch_one_update(br_update.first, br_update.second);
+             _cursors.begin(),
+             _cursors.end(),
+             [this](auto& cursor) {
+                 return poll_one(cursor.first, cursor.second);
              })
-      .then([this] { cleanup_finished_updates(); })
-      .finally([this] { _dispatch_timer.arm(_dissemination_interval); });
+      .finally([this] {
+          if (!_bg.is_closed()) {
+              _dispatch_timer.arm(_dissemination_interval);
+          }
+      });
 }
 
-ss::future<> metadata_dissemination_service::dispatch_one_update(
-  model::node_id target_id, update_retry_meta& meta) {
+ss::future<> metadata_dissemination_service::poll_one(
+  model::node_id target_id, log_cursor& cursor) {
     return _clients.local()
       .with_node_client<metadata_dissemination_rpc_client_protocol>(
         _self.id(),
         ss::this_shard_id(),
         target_id,
         _dissemination_interval,
-        [this, &meta, target_id](
-          metadata_dissemination_rpc_client_protocol proto) mutable {
-            vlog(
-              clusterlog.trace,
-              "Sending {} metadata updates to {}",
-              meta.updates.size(),
-              target_id);
+        [this, cursor](metadata_dissemination_rpc_client_protocol proto) {
             return proto
-              .update_leadership(
-                update_leadership_request{meta.updates},
+              .get_leadership_changes(
+                get_leadership_changes_request{
+                  .incarnation = cursor.incarnation,
+                  .version = cursor.version},
                 rpc::client_opts(
                   _dissemination_interval + rpc::clock_type::now()))
-              .then(&rpc::get_ctx_data<update_leadership_reply>);
+              .then(&rpc::get_ctx_data<get_leadership_changes_reply>);
         })
-      .then([target_id, &meta](result<update_leadership_reply> r) {
-          if (r) {
-              meta.finished = true;
-              return;
+      .then([this, target_id, &cursor](
+              result<get_leadership_changes_reply> r) {
+          if (!r) {
+              vlog(
+                clusterlog.debug,
+                "Error polling leadership changes of {} - {}",
+                target_id,
+                r.error().message());
+              return ss::now();
           }
+          auto& reply = r.value();
           vlog(
-            clusterlog.warn,
-            "Error sending metadata update {} to {}",
-            r.error().message(),
+            clusterlog.trace,
+            "Received {} leadership {} from {}",
+            reply.leaders.size(),
+            reply.snapshot ? "snapshot entries" : "changes",
             target_id);
+          log_cursor next{
+            .incarnation = reply.incarnation, .version = reply.version};
+          return _leaders
+            .invoke_on_all([leaders = std::move(reply.leaders)](
+                             partition_leaders_table& table) {
+                for (auto& l : leaders) {
+                    table.update_partition_leader(l.ntp, l.term, l.leader_id);
+                }
+            })
+            .then([&cursor, next] { cursor = next; });
       })
-      .handle_exception([](std::exception_ptr e) {
-          vlog(clusterlog.warn, "Error when sending metadata update {}", e);
+      .handle_exception([target_id](std::exception_ptr e) {
+          vlog(
+            clusterlog.warn,
+            "Error polling leadership changes of {} - {}",
+            target_id,
+            e);
       });
 }
 
@@ -12,6 +12,7 @@
 #pragma once
 
 #include "cluster/fwd.h"
+#include "cluster/leadership_log.h"
 #include "cluster/metadata_dissemination_types.h"
 #include "config/tls_config.h"
 #include "model/fundamental.h"
@@ -35,10 +36,13 @@ namespace cluster {
 /// instances of raft group that current node have. Instace of raft group
 /// triggers leadership notification and by that mean updates leadership in
 /// metadata cache.
-/// The service caches all leadership updates and sends them as
-/// batch per node, every configurable period of time. This service is also
-/// responsible for querying one of the cluster nodes for current leadership
-/// metadata when node has started.
+/// The service appends the leadership updates of the partitions led by the
+/// current node to a versioned leadership log. Every configurable period of
+/// time each node asks every other node for the changes since the version of
+/// its log it saw last, and gets the latest change of every partition that
+/// changed, or all the partitions the node leads when it fell behind the
+/// log. This service is also responsible for querying one of the cluster
+/// nodes for current leadership metadata when node has started.
 ///
 /// Used acronymes:
 /// RG<num> - raft group with <num> id
@@ -53,8 +57,9 @@ namespace cluster {
 ///   instance
 /// - Nodes without RG1 instance (non overlapping nodes) [4,5]
 /// - Dissemination service will distribute metadata information to nodes 4 & 5
+///   when they poll node 2 for the changes of its leadership log
 ///
-///                    Dissemination requests <RG1 leader = 2>
+///                    Leadership log changes <RG1 leader = 2>
 ///                    +--------------------------------------+
 ///                    |                                      |
 ///                    +-------------------------+            |
@@ -71,6 +76,12 @@ namespace cluster {
 class metadata_dissemination_service final
   : public ss::peering_sharded_service<metadata_dissemination_service> {
 public:
+    /// core the leadership log is kept on
+    static constexpr ss::shard_id shard = 0;
+    /// changes kept in the leadership log, peers that fell further behind
+    /// get a snapshot
+    static constexpr size_t leadership_log_capacity = 20'000;
+
     metadata_dissemination_service(
       ss::sharded<raft::group_manager>&,
       ss::sharded<cluster::partition_manager>&,
@@ -84,16 +95,17 @@ public:
 
     void initialize_leadership_metadata();
 
+    get_leadership_changes_reply
+    leadership_changes(const get_leadership_changes_request&) const;
+
     ss::future<> start();
     ss::future<> stop();
 
 private:
-    // Used to store pending updates
-    // When update was delivered successfully the finished flag is set to true
-    // and object is removed from pending updates map
-    struct update_retry_meta {
-        ntp_leaders updates;
-        bool finished = false;
+    // Position in the leadership log of a peer
+    struct log_cursor {
+        uint64_t incarnation{0};
+        uint64_t version{0};
     };
     // Used to track the process of requesting update when redpanda starts
     // when update using a node from ids will fail we will try the next one
@@ -106,18 +118,13 @@ private:
         exp_backoff_policy backoff_policy;
     };
 
-    using broker_updates_t
-      = absl::flat_hash_map<model::node_id, update_retry_meta>;
-
     void handle_leadership_notification(
       model::ntp, model::term_id, std::optional<model::node_id>);
     ss::future<> apply_leadership_notification(
       model::ntp, model::term_id, std::optional<model::node_id>);
 
-    void collect_pending_updates();
-    void cleanup_finished_updates();
-    ss::future<> dispatch_disseminate_leadership();
-    ss::future<> dispatch_one_update(model::node_id, update_retry_meta&);
+    ss::future<> poll_leadership_changes();
+    ss::future<> poll_one(model::node_id, log_cursor&);
     ss::future<result<get_leadership_reply>>
       dispatch_get_metadata_update(unresolved_address);
     ss::future<> do_request_metadata_update(request_retry_meta&);
@@ -135,9 +142,9 @@ private:
     model::broker _self;
     std::chrono::milliseconds _dissemination_interval;
     config::tls_config _rpc_tls_config;
-    std::vector<ntp_leader> _requests;
+    leadership_log _log;
     std::vector<unresolved_address> _seed_servers;
-    broker_updates_t _pending_updates;
+    absl::flat_hash_map<model::node_id, log_cursor> _cursors;
     mutex _lock;
     ss::timer<> _dispatch_timer;
     ss::abort_source _as;
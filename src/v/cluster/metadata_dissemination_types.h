@@ -37,6 +37,22 @@ struct get_leadership_reply {
     ntp_leaders leaders;
 };
 
+/// position in the leadership log of the node the request is sent to, see
+/// cluster::leadership_log. zero when the log was never read
+struct get_leadership_changes_request {
+    uint64_t incarnation{0};
+    uint64_t version{0};
+};
+
+struct get_leadership_changes_reply {
+    uint64_t incarnation{0};
+    uint64_t version{0};
+    /// leaders of every partition led by the node instead of the changes,
+    /// sent when the requested position is no longer in the log
+    bool snapshot{false};
+    ntp_leaders leaders;
+};
+
 inline std::ostream& operator<<(std::ostream& o, const ntp_leader& l) {
     o << "{ " << l.ntp << ", term: " << l.term
       << ", leader_id: " << (l.leader_id ? l.leader_id.value()() : -1) << " }";
@@ -0,0 +1,203 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "cluster/metadata_view.h"
+
+#include "cluster/partition_leaders_table.h"
+#include "cluster/topic_table.h"
+
+#include <algorithm>
+
+namespace cluster {
+
+topic_view::topic_view(topic_id id, uint64_t version, model::topic_metadata md)
+  : id(id)
+  , version(version)
+  , metadata(std::move(md)) {
+    auto& partitions = metadata.partitions;
+    std::sort(
+      partitions.begin(),
+      partitions.end(),
+      [](const model::partition_metadata& l,
+         const model::partition_metadata& r) { return l.id < r.id; });
+    for (size_t i = 0; i < partitions.size(); ++i) {
+        if (partitions[i].id != model::partition_id(i)) {
+            _dense = false;
+            break;
+        }
+    }
+}
+
+const model::partition_metadata*
+topic_view::partition(model::partition_id pid) const {
+    const auto& partitions = metadata.partitions;
+    if (_dense) {
+        if (
+          pid < model::partition_id(0)
+          || static_cast<size_t>(pid()) >= partitions.size()) {
+            return nullptr;
+        }
+        return &partitions[pid()];
+    }
+    auto it = std::lower_bound(
+      partitions.begin(),
+      partitions.end(),
+      pid,
+      [](const model::partition_metadata& p, model::partition_id id) {
+          return p.id < id;
+      });
+    if (it == partitions.end() || it->id != pid) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+namespace {
+bool same_replicas(
+  const std::vector<model::broker_shard>& l,
+  const std::vector<model::broker_shard>& r) {
+    return std::equal(
+      l.begin(),
+      l.end(),
+      r.begin(),
+      r.end(),
+      [](const model::broker_shard& a, const model::broker_shard& b) {
+          return a.node_id == b.node_id && a.shard == b.shard;
+      });
+}
+
+/// expects partitions of both to be sorted by id
+bool same_partitions(
+  const model::topic_metadata& l, const model::topic_metadata& r) {
+    return std::equal(
+      l.partitions.begin(),
+      l.partitions.end(),
+      r.partitions.begin(),
+      r.partitions.end(),
+      [](const model::partition_metadata& a,
+         const model::partition_metadata& b) {
+          return a.id == b.id && a.leader_node == b.leader_node
+                 && same_replicas(a.replicas, b.replicas);
+      });
+}
+} // namespace
+
+metadata_view::metadata_view(
+  topic_table& topics, partition_leaders_table& leaders)
+  : _topics(topics)
+  , _leaders(leaders) {
+    _leadership_notification = _leaders.register_leadership_change_notification(
+      [this](
+        model::topic_namespace_view tp_ns,
+        model::partition_id pid,
+        std::optional<model::node_id> leader) {
+          on_leadership_change(tp_ns, pid, leader);
+      });
+}
+
+metadata_view::~metadata_view() noexcept {
+    _leaders.unregister_leadership_change_notification(
+      _leadership_notification);
+}
+
+topic_view_ptr metadata_view::find(model::topic_namespace_view tp_ns) {
+    maybe_rebuild();
+    if (auto it = _views.find(tp_ns); it != _views.end()) {
+        return it->second;
+    }
+    return nullptr;
+}
+
+topic_view_ptr metadata_view::get(topic_id id) {
+    maybe_rebuild();
+    if (id() >= _by_id.size()) {
+        return nullptr;
+    }
+    return _by_id[id()];
+}
+
+topic_id metadata_view::allocate_id() {
+    if (!_free_ids.empty()) {
+        auto id = _free_ids.back();
+        _free_ids.pop_back();
+        return id;
+    }
+    _by_id.emplace_back();
+    return topic_id(_by_id.size() - 1);
+}
+
+topic_view_ptr
+metadata_view::make_view(topic_id id, model::topic_metadata md) const {
+    for (auto& p : md.partitions) {
+        p.leader_node = _leaders.get_leader(md.tp_ns, p.id);
+    }
+    auto ts_type = _topics.get_topic_timestamp_type(md.tp_ns);
+    auto view = ss::make_lw_shared<topic_view>(id, _version, std::move(md));
+    view->timestamp_type = ts_type;
+    return view;
+}
+
+void metadata_view::maybe_rebuild() {
+    if (_topics_epoch == _topics.epoch()) {
+        return;
+    }
+    _topics_epoch = _topics.epoch();
+    ++_version;
+
+    auto all_md = _topics.all_topics_metadata();
+    decltype(_views) views;
+    views.reserve(all_md.size());
+    for (auto& md : all_md) {
+        auto it = _views.find(md.tp_ns);
+        auto id = it == _views.end() ? allocate_id() : it->second->id;
+        auto view = make_view(id, std::move(md));
+        if (
+          it != _views.end()
+          && it->second->timestamp_type == view->timestamp_type
+          && same_partitions(it->second->metadata, view->metadata)) {
+            // nothing changed, readers keep seeing the same version
+            view = it->second;
+        }
+        _by_id[id()] = view;
+        views.emplace(view->metadata.tp_ns, std::move(view));
+    }
+    for (auto& [tp_ns, view] : _views) {
+        if (!views.contains(tp_ns)) {
+            _by_id[view->id()] = nullptr;
+            _free_ids.push_back(view->id);
+        }
+    }
+    _views = std::move(views);
+}
+
+void metadata_view::on_leadership_change(
+  model::topic_namespace_view tp_ns,
+  model::partition_id pid,
+  std::optional<model::node_id> leader) {
+    auto it = _views.find(tp_ns);
+    if (it == _views.end()) {
+        // not indexed yet, the leader is read when the topic is
+        return;
+    }
+    auto* p = it->second->partition(pid);
+    if (!p || p->leader_node == leader) {
+        return;
+    }
+    // copy on write, readers holding the old view are not affected
+    auto md = it->second->metadata;
+    md.partitions[p - it->second->metadata.partitions.data()].leader_node
+      = leader;
+    auto view = ss::make_lw_shared<topic_view>(
+      it->second->id, ++_version, std::move(md));
+    view->timestamp_type = it->second->timestamp_type;
+    _by_id[view->id()] = view;
+    it->second = std::move(view);
+}
+
+} // namespace cluster
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "cluster/fwd.h"
+#include "cluster/types.h"
+#include "model/metadata.h"
+#include "model/timestamp.h"
+#include "seastarx.h"
+#include "utils/named_type.h"
+
+#include <seastar/core/shared_ptr.hh>
+
+#include <absl/container/flat_hash_map.h>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace cluster {
+
+/// Small integer standing for a topic for as long as the topic exists
+using topic_id = named_type<uint32_t, struct topic_id_tag>;
+
+/// Immutable snapshot of a single topic, its partitions and their leaders.
+/// A view is never modified once published, any change to the topic
+/// publishes a new view with a greater version, so request handlers may
+/// keep the pointer for the duration of the request.
+struct topic_view {
+    topic_view(topic_id, uint64_t, model::topic_metadata);
+
+    topic_id id;
+    uint64_t version;
+    /// partitions are sorted by id, leaders are filled in
+    model::topic_metadata metadata;
+    std::optional<model::timestamp_type> timestamp_type;
+
+    /// nullptr when the topic has no such partition
+    const model::partition_metadata* partition(model::partition_id) const;
+
+private:
+    /// partition ids are usually dense, in which case the id is the index
+    bool _dense{true};
+};
+
+using topic_view_ptr = ss::lw_shared_ptr<const topic_view>;
+
+/// \brief Shard local copy on write index of topic views.
+///
+/// Topic table updates are picked up lazily, by the first lookup after the
+/// topics epoch changed, only the views of topics that changed are
+/// replaced. Leadership changes replace the view of the affected topic as
+/// soon as they are applied to the leaders table.
+class metadata_view {
+public:
+    metadata_view(topic_table&, partition_leaders_table&);
+    metadata_view(const metadata_view&) = delete;
+    metadata_view& operator=(const metadata_view&) = delete;
+    metadata_view(metadata_view&&) = delete;
+    metadata_view& operator=(metadata_view&&) = delete;
+    ~metadata_view() noexcept;
+
+    /// Returns nullptr if topic does not exists
+    topic_view_ptr find(model::topic_namespace_view);
+
+    /// Returns nullptr if there is no topic with given id anymore
+    topic_view_ptr get(topic_id);
+
+private:
+    void maybe_rebuild();
+    void on_leadership_change(
+      model::topic_namespace_view,
+      model::partition_id,
+      std::optional<model::node_id>);
+    topic_view_ptr make_view(topic_id, model::topic_metadata) const;
+    topic_id allocate_id();
+
+    topic_table& _topics;
+    partition_leaders_table& _leaders;
+    notification_id_type _leadership_notification;
+    std::optional<uint64_t> _topics_epoch;
+    uint64_t _version{0};
+
+    absl::flat_hash_map<
+      model::topic_namespace,
+      topic_view_ptr,
+      model::topic_namespace_hash,
+      model::topic_namespace_eq>
+      _views;
+    /// indexed by topic id
+    std::vector<topic_view_ptr> _by_id;
+    std::vector<topic_id> _free_ids;
+};
+
+} // namespace cluster
@@ -0,0 +1,168 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "cluster/node_load_reporter.h"
+
+#include "cluster/logger.h"
+#include "cluster/members_manager.h"
+#include "cluster/partition.h"
+#include "cluster/partition_manager.h"
+#include "config/configuration.h"
+#include "syschecks/syschecks.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/smp.hh>
+
+namespace cluster {
+
+node_load_reporter::node_load_reporter(
+  ss::sharded<partition_manager>& pm, ss::sharded<members_manager>& mm)
+  : _partition_manager(pm)
+  , _members_manager(mm)
+  , _interval(config::shard_local_cfg().node_load_report_interval_ms()) {
+    _timer.set_callback([this] {
+        (void)ss::with_gate(_gate, [this] {
+            return report().handle_exception([](std::exception_ptr e) {
+                vlog(clusterlog.debug, "node load report failed - {}", e);
+            });
+        }).finally([this] {
+            if (!_gate.is_closed()) {
+                _timer.arm(_interval);
+            }
+        });
+    });
+}
+
+ss::future<> node_load_reporter::start() {
+    if (
+      !config::shard_local_cfg().enable_load_aware_partition_allocation()
+      && !config::shard_local_cfg().enable_node_health_report()) {
+        return ss::now();
+    }
+    _last_report = ss::lowres_clock::now();
+    _timer.arm(_interval);
+    return ss::now();
+}
+
+ss::future<> node_load_reporter::stop() {
+    _timer.cancel();
+    return _gate.close();
+}
+
+ss::future<node_load_report> node_load_reporter::collect() {
+    const bool with_partitions
+      = config::shard_local_cfg().enable_node_health_report();
+    auto totals = co_await _partition_manager.map(
+      [with_partitions](partition_manager& pm) {
+          core_totals ret;
+          if (with_partitions) {
+              ret.partitions.reserve(pm.partitions().size());
+          }
+          for (const auto& [ntp, p] : pm.partitions()) {
+              ret.produced += p->probe().bytes_produced();
+              ret.fetched += p->probe().bytes_fetched();
+              ret.leaders += p->is_leader() ? 1 : 0;
+              if (with_partitions) {
+                  ret.partitions.push_back(partition_totals{
+                    .ntp = ntp,
+                    .leader = p->is_leader(),
+                    .size_bytes = p->size_bytes(),
+                    .produced = p->probe().bytes_produced(),
+                    .fetched = p->probe().bytes_fetched(),
+                    .replication_backlog = p->replication_backlog()});
+              }
+          }
+          return ret;
+      });
+    const auto now = ss::lowres_clock::now();
+    const auto elapsed = std::max<int64_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(now - _last_report)
+        .count(),
+      1);
+    // counters start from zero when a partition is recreated, a core that
+    // moved backwards reports no traffic for this interval
+    auto rate = [elapsed](uint64_t current, uint64_t last) -> uint64_t {
+        return current < last ? 0 : (current - last) * 1000 / elapsed;
+    };
+
+    node_load_report ret{
+      .node = model::node_id(config::shard_local_cfg().node_id())};
+    ret.cores.reserve(totals.size());
+    for (size_t i = 0; i < totals.size(); ++i) {
+        core_load load{.leaders = totals[i].leaders};
+        if (i < _last_totals.size()) {
+            load.produce_bytes_rate = rate(
+              totals[i].produced, _last_totals[i].produced);
+            load.fetch_bytes_rate = rate(
+              totals[i].fetched, _last_totals[i].fetched);
+        }
+        ret.cores.push_back(load);
+    }
+
+    // partitions are grouped by topic to send every name once
+    absl::flat_hash_map<model::topic_namespace, size_t> topic_idx;
+    absl::flat_hash_map<model::ntp, traffic> partition_totals;
+    for (auto& core : totals) {
+        for (auto& p : core.partitions) {
+            partition_status status{
+              .id = p.ntp.tp.partition,
+              .leader = p.leader,
+              .size_bytes = p.size_bytes,
+              .replication_backlog = p.replication_backlog};
+            if (auto it = _last_partition_totals.find(p.ntp);
+                it != _last_partition_totals.end()) {
+                status.produce_bytes_rate = rate(
+                  p.produced, it->second.produced);
+                status.fetch_bytes_rate = rate(p.fetched, it->second.fetched);
+            }
+            auto [it, inserted] = topic_idx.emplace(
+              model::topic_namespace(p.ntp.ns, p.ntp.tp.topic),
+              ret.topics.size());
+            if (inserted) {
+                ret.topics.push_back(topic_status{.tp_ns = it->first});
+            }
+            ret.topics[it->second].partitions.push_back(status);
+            partition_totals.emplace(
+              std::move(p.ntp), traffic{p.produced, p.fetched});
+        }
+        core.partitions.clear();
+    }
+    _last_partition_totals = std::move(partition_totals);
+    _last_totals = std::move(totals);
+    _last_report = now;
+
+    auto space = co_await syschecks::disk_space(
+      config::shard_local_cfg().data_directory().as_sstring());
+    ret.disk_free_bytes = space.free_bytes;
+    ret.disk_total_bytes = space.total_bytes;
+    co_return ret;
+}
+
+ss::future<> node_load_reporter::report() {
+    auto load = co_await collect();
+    auto r = co_await _members_manager.invoke_on(
+      members_manager::shard,
+      [load = std::move(load)](members_manager& mm) mutable {
+          return mm.dispatch_node_load_report(std::move(load));
+      });
+    if (!r) {
+        vlog(
+          clusterlog.debug,
+          "unable to report node load - {}",
+          r.error().message());
+    } else if (r.value().error != errc::success) {
+        vlog(
+          clusterlog.debug,
+          "node load report rejected - {}",
+          make_error_code(r.value().error).message());
+    }
+}
+
+} // namespace cluster
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "cluster/fwd.h"
+#include "cluster/types.h"
+#include "model/fundamental.h"
+#include "seastarx.h"
+
+#include <seastar/core/gate.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/core/sharded.hh>
+#include <seastar/core/timer.hh>
+
+#include <absl/container/flat_hash_map.h>
+
+#include <chrono>
+#include <vector>
+
+namespace cluster {
+
+/**
+ * Periodically reports the produce and fetch rates and the number of leaders
+ * of every core of this node, together with the disk usage of the data
+ * directory, to the controller leader. The leader uses the reports to place
+ * new partitions on the least loaded nodes and cores. With the node health
+ * report enabled the state of every hosted replica is included as well, the
+ * leader keeps it in the health_table. Single instance, runs on shard 0.
+ */
+class node_load_reporter {
+public:
+    static constexpr ss::shard_id shard = 0;
+
+    node_load_reporter(
+      ss::sharded<partition_manager>&, ss::sharded<members_manager>&);
+
+    ss::future<> start();
+    ss::future<> stop();
+
+private:
+    struct partition_totals {
+        model::ntp ntp;
+        bool leader{false};
+        uint64_t size_bytes{0};
+        uint64_t produced{0};
+        uint64_t fetched{0};
+        int64_t replication_backlog{0};
+    };
+
+    struct core_totals {
+        uint64_t produced{0};
+        uint64_t fetched{0};
+        uint32_t leaders{0};
+        std::vector<partition_totals> partitions;
+    };
+
+    struct traffic {
+        uint64_t produced{0};
+        uint64_t fetched{0};
+    };
+
+    ss::future<> report();
+    ss::future<node_load_report> collect();
+
+    ss::sharded<partition_manager>& _partition_manager;
+    ss::sharded<members_manager>& _members_manager;
+    std::chrono::milliseconds _interval;
+    ss::timer<> _timer;
+    ss::gate _gate;
+    // bytes transferred by the cores at the previous report
+    std::vector<core_totals> _last_totals;
+    absl::flat_hash_map<model::ntp, traffic> _last_partition_totals;
+    ss::lowres_clock::time_point _last_report;
+};
+
+} // namespace cluster
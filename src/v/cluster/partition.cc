@@ -13,6 +13,11 @@
 #include "config/configuration.h"
 #include "model/namespace.h"
 #include "prometheus/prometheus_sanitize.h"
+#include "raft/errc.h"
+
+#include <seastar/core/coroutine.hh>
+
+#include <algorithm>
 
 namespace cluster {
 
@@ -117,11 +122,111 @@ partition::timequery(model::timestamp t, ss::io_priority_class p) {
     return _raft->timequery(cfg);
 }
 
+ss::future<std::optional<storage::key_lookup_result>>
+partition::lookup_key(bytes key, ss::io_priority_class p) {
+    return storage::lookup_key(
+      _raft->log(),
+      storage::key_lookup_config{
+        .key = std::move(key),
+        .max_offset = _raft->last_visible_index(),
+        .prio = p,
+        .type_filter = raft::data_batch_type});
+}
+
 ss::future<> partition::update_configuration(topic_properties properties) {
     return _raft->log().update_configuration(
       properties.get_ntp_cfg_overrides());
 }
 
+bool partition::can_serve_follower_reads(
+  raft::clock_type::duration max_staleness) const {
+    if (_raft->is_leader()) {
+        return true;
+    }
+    if (!_raft->get_leader_id()) {
+        return false;
+    }
+    return raft::clock_type::now() - _raft->last_heartbeat() <= max_staleness;
+}
+
+std::optional<model::node_id>
+partition::preferred_read_replica(std::string_view rack) const {
+    auto cfg = _raft->config();
+    std::vector<model::node_id> candidates;
+    auto in_rack = [&cfg, rack](const raft::vnode& n) {
+        auto broker = cfg.find_broker(n.id());
+        return broker && broker->rack() && *broker->rack() == rack;
+    };
+    for (const auto& voter : cfg.current_config().voters) {
+        if (!in_rack(voter)) {
+            continue;
+        }
+        if (voter == _raft->self()) {
+            // reading from this node does not cost the consumer a redirect
+            return voter.id();
+        }
+        candidates.push_back(voter.id());
+    }
+    // learners, e.g. the replicas added by a move, serve reads once they
+    // caught up without waiting for their promotion
+    for (const auto& learner : cfg.current_config().learners) {
+        if (in_rack(learner) && _raft->is_caught_up(learner)) {
+            candidates.push_back(learner.id());
+        }
+    }
+    if (candidates.empty()) {
+        return std::nullopt;
+    }
+    std::sort(candidates.begin(), candidates.end());
+    return candidates[_raft->ntp().tp.partition() % candidates.size()];
+}
+
+ss::future<checked<model::offset, kafka::error_code>>
+partition::prefix_truncate(
+  model::offset offset, model::timeout_clock::time_point deadline) {
+    if (!_nop_stm) {
+        // compacted topics keep their prefix
+        co_return kafka::error_code::policy_violation;
+    }
+    if (!_raft->is_leader()) {
+        co_return kafka::error_code::not_leader_for_partition;
+    }
+    const auto hwm = high_watermark();
+    if (offset == model::offset(-1)) {
+        offset = hwm;
+    }
+    if (offset < model::offset(0) || offset > hwm) {
+        co_return kafka::error_code::offset_out_of_range;
+    }
+    if (offset < hwm) {
+        // the log starts at a batch boundary, for the recovery of the
+        // followers to send whole batches. Records before the offset in its
+        // batch stay readable
+        storage::log_reader_config cfg(
+          offset, offset, ss::default_priority_class());
+        auto reader = co_await _raft->make_reader(cfg);
+        auto batches = co_await model::consume_reader_to_memory(
+          std::move(reader), deadline);
+        if (!batches.empty()) {
+            offset = std::min(offset, batches.front().base_offset());
+        }
+    }
+    if (offset <= start_offset()) {
+        co_return start_offset();
+    }
+    auto r = co_await _nop_stm->prefix_truncate(offset, deadline);
+    if (r) {
+        co_return r.value();
+    }
+    if (r.error() == raft::errc::not_leader) {
+        co_return kafka::error_code::not_leader_for_partition;
+    }
+    if (r.error() == raft::errc::timeout) {
+        co_return kafka::error_code::request_timed_out;
+    }
+    co_return kafka::error_code::unknown_server_error;
+}
+
 std::ostream& operator<<(std::ostream& o, const partition& x) {
     return o << x._raft;
 }
@@ -23,8 +23,12 @@
 #include "raft/group_configuration.h"
 #include "raft/log_eviction_stm.h"
 #include "raft/types.h"
+#include "storage/key_lookup.h"
 #include "storage/types.h"
 
+#include <optional>
+#include <string_view>
+
 namespace cluster {
 class partition_manager;
 
@@ -99,17 +103,67 @@ public:
         return raft::details::next_offset(_raft->last_visible_index());
     }
 
+    /**
+     * Resolves once the high watermark moves past the given offset. The wait
+     * is aborted with an exception when the timeout passes or the partition
+     * stops.
+     */
+    ss::future<> wait_for_high_watermark_above(
+      model::offset o, model::timeout_clock::time_point timeout) {
+        return _raft->wait_for_visible_offset(o, timeout);
+    }
+
     model::offset dirty_offset() const {
         return _raft->log().offsets().dirty_offset;
     }
 
     const model::ntp& ntp() const { return _raft->ntp(); }
 
+    /// the kafka leader epoch, the term of the latest batch of the log
+    model::term_id leader_epoch() const {
+        return _raft->log().offsets().dirty_offset_term;
+    }
+
+    /// the latest term up to the given one and where it ends in the log
+    std::optional<storage::term_end> find_term_end(model::term_id t) const {
+        return _raft->log().find_term_end(t);
+    }
+
+    /**
+     * Moves the start of the log up to the given offset, -1 being the high
+     * watermark, through a prefix truncation replicated to all the replicas.
+     * The start is aligned down to the batch containing the offset. Returns
+     * the start offset of the log once truncated.
+     */
+    ss::future<checked<model::offset, kafka::error_code>>
+      prefix_truncate(model::offset, model::timeout_clock::time_point);
+
     ss::future<std::optional<storage::timequery_result>>
       timequery(model::timestamp, ss::io_priority_class);
 
+    /// latest visible data record of the key, for compacted topics
+    ss::future<std::optional<storage::key_lookup_result>>
+      lookup_key(bytes, ss::io_priority_class);
+
     bool is_leader() const { return _raft->is_leader(); }
 
+    /**
+     * Followers serve reads up to the last visible offset the leader sent
+     * them. That offset is only as fresh as the last request received from
+     * the leader, reads are refused when it is older than max_staleness.
+     */
+    bool
+    can_serve_follower_reads(raft::clock_type::duration max_staleness) const;
+
+    /**
+     * Replica a consumer from the given rack should fetch from. Replicas in
+     * the same rack as the consumer are preferred, the consumers of a rack
+     * are spread over its replicas by partition. Returns nullopt when none of
+     * the replicas is in the rack.
+     */
+    std::optional<model::node_id>
+    preferred_read_replica(std::string_view rack) const;
+
     ss::future<std::error_code>
     transfer_leadership(std::optional<model::node_id> target) {
         return _raft->transfer_leadership(target);
@@ -142,6 +196,14 @@ public:
     ss::shared_ptr<cluster::rm_stm>& rm_stm() { return _rm_stm; }
 
     size_t size_bytes() const { return _raft->log().size_bytes(); }
+
+    int64_t replication_backlog() const {
+        return _raft->replication_backlog();
+    }
+
+    const storage::ntp_config& log_config() const {
+        return _raft->log_config();
+    }
     ss::future<> update_configuration(topic_properties);
 
 private:
@@ -22,6 +22,86 @@
 
 namespace cluster {
 
+void allocation_node::update_load(
+  const node_load_report& r, ss::lowres_clock::time_point expires) {
+    reported_load load{.expires = expires};
+    load.cores = r.cores;
+    // a node that restarted with a different number of cores reports them
+    // before the allocator learns about it
+    load.cores.resize(_weights.size());
+    if (r.disk_total_bytes > 0) {
+        const auto free = std::min(r.disk_free_bytes, r.disk_total_bytes);
+        load.disk_used = 1.0
+                         - static_cast<double>(free) / r.disk_total_bytes;
+    }
+    _load = std::move(load);
+    _pending_bytes_rate.assign(_weights.size(), 0);
+}
+
+uint64_t allocation_node::core_bytes_rate(uint32_t core) const {
+    uint64_t ret = core < _pending_bytes_rate.size() ? _pending_bytes_rate[core]
+                                                     : 0;
+    if (_load) {
+        const auto& c = _load->cores[core];
+        ret += c.produce_bytes_rate + c.fetch_bytes_rate;
+    }
+    return ret;
+}
+
+uint64_t allocation_node::bytes_rate() const {
+    uint64_t ret = 0;
+    for (uint32_t i = 0; i < _weights.size(); ++i) {
+        ret += core_bytes_rate(i);
+    }
+    return ret;
+}
+
+uint32_t allocation_node::leaders() const {
+    if (!_load) {
+        return 0;
+    }
+    return std::accumulate(
+      _load->cores.begin(),
+      _load->cores.end(),
+      uint32_t(0),
+      [](uint32_t acc, const core_load& c) { return acc + c.leaders; });
+}
+
+uint32_t allocation_node::allocate_by_load(uint64_t per_partition) {
+    if (!_load) {
+        return allocate();
+    }
+    uint32_t max_weight = 1;
+    uint64_t max_bytes = 1;
+    uint32_t max_leaders = 1;
+    for (uint32_t i = 0; i < _weights.size(); ++i) {
+        max_weight = std::max(max_weight, _weights[i]);
+        max_bytes = std::max(max_bytes, core_bytes_rate(i));
+        max_leaders = std::max(max_leaders, _load->cores[i].leaders);
+    }
+    std::optional<uint32_t> best;
+    double best_score = 0;
+    for (uint32_t i = 0; i < _weights.size(); ++i) {
+        if (_weights[i] >= max_allocations_per_core) {
+            continue;
+        }
+        const double score
+          = static_cast<double>(_weights[i]) / max_weight
+            + static_cast<double>(core_bytes_rate(i)) / max_bytes
+            + static_cast<double>(_load->cores[i].leaders) / max_leaders;
+        if (!best || score < best_score) {
+            best = i;
+            best_score = score;
+        }
+    }
+    if (!best) {
+        return allocate();
+    }
+    allocate(*best);
+    _pending_bytes_rate[*best] += per_partition;
+    return *best;
+}
+
 void partition_allocator::rollback(const std::vector<partition_assignment>& v) {
     for (auto& as : v) {
         rollback(as.replicas);
@@ -94,6 +174,125 @@ partition_allocator::allocate_replicas(int16_t replication_factor) {
     return replicas;
 }
 
+bool partition_allocator::has_fresh_load() const {
+    if (_available_machines.empty()) {
+        return false;
+    }
+    const auto now = ss::lowres_clock::now();
+    return std::all_of(
+      _available_machines.begin(),
+      _available_machines.end(),
+      [now](const allocation_node& n) { return n.has_fresh_load(now); });
+}
+
+std::optional<std::vector<model::broker_shard>>
+partition_allocator::allocate_replicas_by_load(int16_t replication_factor) {
+    // nodes are compared by partition count, traffic and leaders relative to
+    // the busiest node, so that none of them dominates the others
+    uint32_t max_partitions = 1;
+    uint64_t max_bytes = 1;
+    uint32_t max_leaders = 1;
+    uint64_t total_bytes = 0;
+    uint64_t total_partitions = 0;
+    for (const auto& n : _available_machines) {
+        const auto partitions = n.allocated_partitions();
+        const auto bytes = n.bytes_rate();
+        max_partitions = std::max(max_partitions, partitions);
+        max_bytes = std::max(max_bytes, bytes);
+        max_leaders = std::max(max_leaders, n.leaders());
+        total_bytes += bytes;
+        total_partitions += partitions;
+    }
+    // a new partition is expected to be as busy as an average one
+    const uint64_t per_partition = total_bytes
+                                   / std::max<uint64_t>(total_partitions, 1);
+    auto score = [&](const allocation_node& n) {
+        static constexpr double full_disk_ratio = 0.9;
+        static constexpr double full_disk_penalty = 4;
+        const double disk = n._load->disk_used;
+        return static_cast<double>(n.allocated_partitions()) / max_partitions
+               + static_cast<double>(n.bytes_rate()) / max_bytes
+               + static_cast<double>(n.leaders()) / max_leaders + disk
+               + (disk >= full_disk_ratio ? full_disk_penalty : 0);
+    };
+
+    std::vector<model::broker_shard> replicas;
+    replicas.reserve(replication_factor);
+    while (replicas.size() < (size_t)replication_factor) {
+        const uint16_t replicas_left = replication_factor - replicas.size();
+        if (_available_machines.size() < replicas_left) {
+            rollback(replicas);
+            return std::nullopt;
+        }
+        // start from the round robin pointer so that ties rotate between
+        // the nodes
+        auto it = round_robin_ptr();
+        allocation_node* best = nullptr;
+        double best_score = 0;
+        for (size_t i = 0; i < _available_machines.size(); ++i) {
+            if (it == _available_machines.end()) {
+                it = _available_machines.begin();
+            }
+            auto& machine = *it++;
+            if (is_machine_in_replicas(machine, replicas)) {
+                continue;
+            }
+            const double s = score(machine);
+            if (!best || s < best_score) {
+                best = &machine;
+                best_score = s;
+            }
+        }
+        if (!best) {
+            rollback(replicas);
+            return std::nullopt;
+        }
+        _rr = std::next(_available_machines.iterator_to(*best));
+        const uint32_t cpu = best->allocate_by_load(per_partition);
+        replicas.push_back(
+          model::broker_shard{.node_id = best->id(), .shard = cpu});
+        if (best->is_full()) {
+            _available_machines.erase(_available_machines.iterator_to(*best));
+        }
+    }
+    return replicas;
+}
+
+void partition_allocator::update_node_load(
+  const node_load_report& r, ss::lowres_clock::time_point expires) {
+    auto it = find_node(r.node);
+    if (it == _machines.end()) {
+        vlog(clusterlog.debug, "ignoring load of unknown node {}", r.node);
+        return;
+    }
+    it->second->update_load(r, expires);
+}
+
+std::optional<uint32_t>
+partition_allocator::least_allocated_core(model::node_id id) const {
+    auto it = _machines.find(id);
+    if (it == _machines.end()) {
+        return std::nullopt;
+    }
+    const auto& weights = it->second->_weights;
+    auto min = std::min_element(weights.begin(), weights.end());
+    if (*min >= allocation_node::max_allocations_per_core) {
+        return std::nullopt;
+    }
+    return std::distance(weights.begin(), min);
+}
+
+std::optional<uint64_t>
+partition_allocator::node_bytes_rate(model::node_id id) const {
+    auto it = _machines.find(id);
+    if (
+      it == _machines.end()
+      || !it->second->has_fresh_load(ss::lowres_clock::now())) {
+        return std::nullopt;
+    }
+    return it->second->bytes_rate();
+}
+
 // FIXME: take into account broker.rack diversity & other constraints
 std::optional<partition_allocator::allocation_units>
 partition_allocator::allocate(const topic_configuration& cfg) {
@@ -120,7 +319,10 @@ partition_allocator::allocate(const topic_configuration& cfg) {
     for (int32_t i = 0; i < cfg.partition_count; ++i) {
         // all replicas must belong to the same raft group
         raft::group_id partition_group = raft::group_id(_highest_group() + 1);
-        auto replicas_assignment = allocate_replicas(cfg.replication_factor);
+        auto replicas_assignment
+          = has_fresh_load()
+              ? allocate_replicas_by_load(cfg.replication_factor)
+              : allocate_replicas(cfg.replication_factor);
         if (replicas_assignment == std::nullopt) {
             rollback(ret);
             return std::nullopt;
@@ -16,8 +16,12 @@
 #include "utils/intrusive_list_helpers.h"
 #include "vassert.h"
 
+#include <seastar/core/lowres_clock.hh>
+
 #include <boost/container/flat_map.hpp>
 
+#include <numeric>
+#include <optional>
 #include <vector>
 
 namespace cluster {
@@ -46,7 +50,9 @@ public:
       : _id(o._id)
       , _weights(std::move(o._weights))
       , _partition_capacity(o._partition_capacity)
-      , _machine_labels(std::move(o._machine_labels)) {
+      , _machine_labels(std::move(o._machine_labels))
+      , _load(std::move(o._load))
+      , _pending_bytes_rate(std::move(o._pending_bytes_rate)) {
         _hook.swap_nodes(o._hook);
     }
 
@@ -97,12 +103,41 @@ private:
         return _machine_labels;
     }
 
+    /// load reported by the node, see node_load_reporter
+    struct reported_load {
+        std::vector<core_load> cores;
+        /// used fraction of the data directory disk, in [0, 1]
+        double disk_used{0};
+        ss::lowres_clock::time_point expires;
+    };
+
+    bool has_fresh_load(ss::lowres_clock::time_point now) const {
+        return _load && _load->expires > now;
+    }
+    void update_load(const node_load_report&, ss::lowres_clock::time_point);
+    /// reported bytes rate of the core plus the estimated rate of the
+    /// partitions allocated to it since the report
+    uint64_t core_bytes_rate(uint32_t core) const;
+    uint64_t bytes_rate() const;
+    uint32_t leaders() const;
+    uint32_t allocated_partitions() const {
+        return std::accumulate(_weights.begin(), _weights.end(), uint32_t(0))
+               - core0_extra_weight;
+    }
+    /// allocates on the core with the fewest partitions, traffic and leaders
+    /// relative to the other cores, counting the partition as per_partition
+    /// bytes per second until the next report
+    uint32_t allocate_by_load(uint64_t per_partition);
+
     model::node_id _id;
     /// each index is a CPU. A weight is roughly the number of assigments
     std::vector<uint32_t> _weights;
     uint32_t _partition_capacity{0};
     /// generated by `rpk` usually in /etc/redpanda/machine_labels.json
     std::unordered_map<ss::sstring, ss::sstring> _machine_labels;
+    std::optional<reported_load> _load;
+    /// per core, reset by every report
+    std::vector<uint64_t> _pending_bytes_rate;
 
     // for partition_allocator
     safe_intrusive_list_hook _hook;
@@ -170,6 +205,18 @@ public:
     /// how to use a nullopt value
     std::optional<allocation_units> allocate(const topic_configuration&);
 
+    /// \brief replaces the load of the node, the allocator places partitions
+    /// by load while every available node has a report that did not expire
+    void update_node_load(
+      const node_load_report&, ss::lowres_clock::time_point expires);
+
+    /// \brief core of the node with the fewest partitions, used to place a
+    /// replica that is moved to the node
+    std::optional<uint32_t> least_allocated_core(model::node_id) const;
+
+    /// \brief bytes per second the node reported, if the report is fresh
+    std::optional<uint64_t> node_bytes_rate(model::node_id) const;
+
     /// best effort. Does not throw if we cannot find the old partition
     void deallocate(const model::broker_shard&);
 
@@ -197,6 +244,9 @@ private:
 
     std::optional<std::vector<model::broker_shard>>
     allocate_replicas(int16_t replication_factor);
+    std::optional<std::vector<model::broker_shard>>
+    allocate_replicas_by_load(int16_t replication_factor);
+    bool has_fresh_load() const;
     iterator find_node(model::node_id id);
 
     [[gnu::always_inline]] inline cil_t::iterator& round_robin_ptr() {
@@ -0,0 +1,393 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "cluster/partition_balancer.h"
+
+#include "cluster/controller_service.h"
+#include "cluster/logger.h"
+#include "cluster/members_table.h"
+#include "cluster/partition.h"
+#include "cluster/partition_allocator.h"
+#include "cluster/partition_leaders_table.h"
+#include "cluster/partition_manager.h"
+#include "cluster/shard_table.h"
+#include "cluster/topic_table.h"
+#include "cluster/topics_frontend.h"
+#include "config/configuration.h"
+#include "model/timeout_clock.h"
+#include "raft/consensus.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace cluster {
+
+using counts_t = absl::flat_hash_map<model::node_id, size_t>;
+
+static counts_t init_counts(const std::vector<balancer_node>& nodes) {
+    counts_t ret;
+    for (const auto& n : nodes) {
+        ret.emplace(n.id, 0);
+    }
+    return ret;
+}
+
+static bool has_replica(const balancer_partition& p, model::node_id id) {
+    return std::any_of(
+      p.replicas.begin(),
+      p.replicas.end(),
+      [id](const model::broker_shard& bs) { return bs.node_id == id; });
+}
+
+std::vector<leadership_transfer> plan_leadership_transfers(
+  const std::vector<balancer_partition>& partitions,
+  const std::vector<balancer_node>& nodes,
+  size_t max_transfers) {
+    std::vector<leadership_transfer> ret;
+    if (nodes.size() < 2) {
+        return ret;
+    }
+    auto counts = init_counts(nodes);
+    absl::flat_hash_map<model::node_id, std::vector<const balancer_partition*>>
+      led;
+    size_t total = 0;
+    for (const auto& p : partitions) {
+        if (!p.leader || !counts.contains(*p.leader)) {
+            continue;
+        }
+        ++counts[*p.leader];
+        led[*p.leader].push_back(&p);
+        ++total;
+    }
+    const auto share = (total + nodes.size() - 1) / nodes.size();
+    // nodes none of which partitions can be handed over to a less busy node
+    absl::flat_hash_set<model::node_id> exhausted;
+
+    while (ret.size() < max_transfers) {
+        std::optional<model::node_id> source;
+        for (const auto& [id, count] : counts) {
+            if (
+              !exhausted.contains(id) && count > share
+              && (!source || count > counts[*source])) {
+                source = id;
+            }
+        }
+        if (!source) {
+            break;
+        }
+        auto& candidates = led[*source];
+        auto best_partition = candidates.end();
+        std::optional<model::node_id> target;
+        for (auto it = candidates.begin(); it != candidates.end(); ++it) {
+            for (const auto& bs : (*it)->replicas) {
+                auto c = counts.find(bs.node_id);
+                if (
+                  bs.node_id == *source || c == counts.end()
+                  || c->second + 1 >= counts[*source]) {
+                    continue;
+                }
+                if (!target || c->second < counts[*target]) {
+                    target = bs.node_id;
+                    best_partition = it;
+                }
+            }
+        }
+        if (!target) {
+            exhausted.insert(*source);
+            continue;
+        }
+        ret.push_back(leadership_transfer{
+          .ntp = (*best_partition)->ntp, .from = *source, .to = *target});
+        --counts[*source];
+        ++counts[*target];
+        candidates.erase(best_partition);
+    }
+    return ret;
+}
+
+/// prefers a partition the source node is not the leader of, the move of the
+/// leader replica interrupts its clients
+static std::optional<replica_move> pick_replica(
+  const std::vector<balancer_partition>& partitions,
+  model::node_id from,
+  model::node_id to) {
+    const balancer_partition* candidate = nullptr;
+    for (const auto& p : partitions) {
+        if (!has_replica(p, from) || has_replica(p, to)) {
+            continue;
+        }
+        if (p.leader != from) {
+            candidate = &p;
+            break;
+        }
+        if (!candidate) {
+            candidate = &p;
+        }
+    }
+    if (!candidate) {
+        return std::nullopt;
+    }
+    return replica_move{.ntp = candidate->ntp, .from = from, .to = to};
+}
+
+std::optional<replica_move> plan_replica_move(
+  const std::vector<balancer_partition>& partitions,
+  const std::vector<balancer_node>& nodes) {
+    if (nodes.size() < 2) {
+        return std::nullopt;
+    }
+    auto counts = init_counts(nodes);
+    size_t total = 0;
+    for (const auto& p : partitions) {
+        for (const auto& bs : p.replicas) {
+            if (auto it = counts.find(bs.node_id); it != counts.end()) {
+                ++it->second;
+                ++total;
+            }
+        }
+    }
+    const double avg = static_cast<double>(total) / nodes.size();
+    const double limit = avg * partition_balancer::imbalance_threshold;
+
+    auto by_count = [&counts](const balancer_node& a, const balancer_node& b) {
+        return counts[a.id] < counts[b.id];
+    };
+    auto [min_it, max_it] = std::minmax_element(
+      nodes.begin(), nodes.end(), by_count);
+    const auto max = counts[max_it->id];
+    const auto min = counts[min_it->id];
+    if (max > min + 1 && max > limit) {
+        if (auto m = pick_replica(partitions, max_it->id, min_it->id); m) {
+            return m;
+        }
+    }
+
+    const bool reported = std::all_of(
+      nodes.begin(), nodes.end(), [](const balancer_node& n) {
+          return n.bytes_rate.has_value();
+      });
+    if (!reported) {
+        return std::nullopt;
+    }
+    auto by_rate = [](const balancer_node& a, const balancer_node& b) {
+        return *a.bytes_rate < *b.bytes_rate;
+    };
+    auto [cold, hot] = std::minmax_element(nodes.begin(), nodes.end(), by_rate);
+    uint64_t total_rate = 0;
+    for (const auto& n : nodes) {
+        total_rate += *n.bytes_rate;
+    }
+    const double avg_rate = static_cast<double>(total_rate) / nodes.size();
+    if (
+      *hot->bytes_rate == 0
+      || *hot->bytes_rate <= avg_rate * partition_balancer::imbalance_threshold
+      || static_cast<double>(counts[cold->id] + 1) > std::ceil(limit)) {
+        return std::nullopt;
+    }
+    return pick_replica(partitions, hot->id, cold->id);
+}
+
+partition_balancer::partition_balancer(
+  consensus_ptr raft0,
+  ss::sharded<topic_table>& topics,
+  ss::sharded<partition_leaders_table>& leaders,
+  ss::sharded<members_table>& members,
+  ss::sharded<partition_allocator>& allocator,
+  ss::sharded<topics_frontend>& topics_frontend,
+  ss::sharded<partition_manager>& pm,
+  ss::sharded<shard_table>& st,
+  ss::sharded<rpc::connection_cache>& connections)
+  : _raft0(std::move(raft0))
+  , _topics(topics)
+  , _leaders(leaders)
+  , _members(members)
+  , _allocator(allocator)
+  , _topics_frontend(topics_frontend)
+  , _partition_manager(pm)
+  , _shard_table(st)
+  , _connections(connections)
+  , _interval(config::shard_local_cfg().partition_balancer_interval_ms()) {
+    _timer.set_callback([this] {
+        (void)ss::with_gate(_gate, [this] {
+            return balance().handle_exception([](std::exception_ptr e) {
+                vlog(clusterlog.warn, "partition balancing failed - {}", e);
+            });
+        }).finally([this] {
+            if (!_gate.is_closed()) {
+                _timer.arm(_interval);
+            }
+        });
+    });
+}
+
+ss::future<> partition_balancer::start() {
+    if (!config::shard_local_cfg().enable_partition_balancer()) {
+        return ss::now();
+    }
+    _timer.arm(_interval);
+    return ss::now();
+}
+
+ss::future<> partition_balancer::stop() {
+    _timer.cancel();
+    return _gate.close();
+}
+
+std::vector<balancer_partition>
+partition_balancer::collect_partitions() const {
+    std::vector<balancer_partition> ret;
+    auto& topics = _topics.local();
+    for (auto& md : topics.all_topics_metadata()) {
+        for (auto& p : md.partitions) {
+            model::ntp ntp(md.tp_ns.ns, md.tp_ns.tp, p.id);
+            // replica sets that are being changed are left alone
+            if (topics.is_update_in_progress(ntp)) {
+                continue;
+            }
+            auto leader = _leaders.local().get_leader(ntp);
+            ret.push_back(balancer_partition{
+              .ntp = std::move(ntp),
+              .replicas = std::move(p.replicas),
+              .leader = leader});
+        }
+    }
+    return ret;
+}
+
+std::vector<balancer_node> partition_balancer::collect_nodes() const {
+    std::vector<balancer_node> ret;
+    for (auto id : _members.local().all_broker_ids()) {
+        ret.push_back(balancer_node{
+          .id = id, .bytes_rate = _allocator.local().node_bytes_rate(id)});
+    }
+    return ret;
+}
+
+ss::future<> partition_balancer::balance() {
+    if (!_raft0->is_leader()) {
+        co_return;
+    }
+    auto partitions = collect_partitions();
+    auto nodes = collect_nodes();
+
+    auto transfers = plan_leadership_transfers(
+      partitions,
+      nodes,
+      config::shard_local_cfg().partition_balancer_max_leadership_transfers());
+    co_await ss::parallel_for_each(
+      transfers, [this](leadership_transfer& t) {
+          return transfer_leadership(std::move(t));
+      });
+
+    const auto max_moves
+      = config::shard_local_cfg().partition_balancer_max_concurrent_moves();
+    if (_topics.local().updates_in_progress() >= max_moves) {
+        co_return;
+    }
+    auto move = plan_replica_move(partitions, nodes);
+    if (!move) {
+        co_return;
+    }
+    auto it = std::find_if(
+      partitions.begin(),
+      partitions.end(),
+      [&move](const balancer_partition& p) { return p.ntp == move->ntp; });
+    co_await move_replica(*it, *move);
+}
+
+ss::future<> partition_balancer::transfer_leadership(leadership_transfer t) {
+    vlog(
+      clusterlog.info,
+      "partition balancer moving leadership of {} from node {} to node {}",
+      t.ntp,
+      t.from,
+      t.to);
+    const auto self = _raft0->self().id();
+    std::error_code ec = errc::success;
+    if (t.from == self) {
+        auto shard = _shard_table.local().shard_for(t.ntp);
+        if (!shard) {
+            co_return;
+        }
+        ec = co_await _partition_manager.invoke_on(
+          *shard, [t](partition_manager& pm) {
+              auto p = pm.get(t.ntp);
+              if (!p) {
+                  return ss::make_ready_future<std::error_code>(
+                    errc::partition_not_exists);
+              }
+              return p->transfer_leadership(t.to);
+          });
+    } else {
+        const auto timeout = rpc::clock_type::now() + request_timeout;
+        auto r = co_await _connections.local()
+                   .with_node_client<controller_client_protocol>(
+                     self,
+                     ss::this_shard_id(),
+                     t.from,
+                     timeout,
+                     [t, timeout](controller_client_protocol c) mutable {
+                         return c
+                           .transfer_leadership(
+                             transfer_leadership_request{
+                               .ntp = t.ntp, .target = t.to},
+                             rpc::client_opts(timeout))
+                           .then(&rpc::get_ctx_data<transfer_leadership_reply>);
+                     });
+        ec = r ? make_error_code(r.value().error) : r.error();
+    }
+    if (ec) {
+        vlog(
+          clusterlog.info,
+          "unable to move leadership of {} to node {} - {}",
+          t.ntp,
+          t.to,
+          ec.message());
+    }
+}
+
+ss::future<> partition_balancer::move_replica(
+  const balancer_partition& p, replica_move m) {
+    auto core = _allocator.local().least_allocated_core(m.to);
+    if (!core) {
+        co_return;
+    }
+    std::vector<model::broker_shard> replicas = p.replicas;
+    for (auto& bs : replicas) {
+        if (bs.node_id == m.from) {
+            bs = model::broker_shard{.node_id = m.to, .shard = *core};
+        }
+    }
+    vlog(
+      clusterlog.info,
+      "partition balancer moving replica of {} from node {} to node {}",
+      m.ntp,
+      m.from,
+      m.to);
+    auto ec = co_await _topics_frontend.local().move_partition_replicas(
+      m.ntp,
+      std::move(replicas),
+      model::timeout_clock::now() + request_timeout);
+    if (ec) {
+        vlog(
+          clusterlog.info,
+          "unable to move replica of {} to node {} - {}",
+          m.ntp,
+          m.to,
+          ec.message());
+    }
+}
+
+} // namespace cluster
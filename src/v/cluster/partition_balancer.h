@@ -0,0 +1,125 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "cluster/fwd.h"
+#include "cluster/types.h"
+#include "model/fundamental.h"
+#include "model/metadata.h"
+#include "rpc/connection_cache.h"
+#include "seastarx.h"
+
+#include <seastar/core/gate.hh>
+#include <seastar/core/sharded.hh>
+#include <seastar/core/timer.hh>
+
+#include <chrono>
+#include <optional>
+#include <vector>
+
+namespace cluster {
+
+struct balancer_partition {
+    model::ntp ntp;
+    std::vector<model::broker_shard> replicas;
+    std::optional<model::node_id> leader;
+};
+
+struct balancer_node {
+    model::node_id id;
+    // bytes per second reported by the node, see node_load_reporter
+    std::optional<uint64_t> bytes_rate;
+};
+
+struct leadership_transfer {
+    model::ntp ntp;
+    model::node_id from;
+    model::node_id to;
+};
+
+struct replica_move {
+    model::ntp ntp;
+    model::node_id from;
+    model::node_id to;
+};
+
+/**
+ * Chooses up to max_transfers leadership transfers from the nodes leading
+ * more than their share of the partitions to the followers leading the
+ * fewest. A transfer is only planned when it leaves the target with fewer
+ * leaders than the source had before.
+ */
+std::vector<leadership_transfer> plan_leadership_transfers(
+  const std::vector<balancer_partition>&,
+  const std::vector<balancer_node>&,
+  size_t max_transfers);
+
+/**
+ * Chooses a replica to move from the node with the most replicas to the one
+ * with the fewest, when the busiest has more than imbalance_threshold times
+ * the average. When the replica counts are even and every node reported its
+ * traffic, a replica is moved from the node with the most traffic to the one
+ * with the least under the same threshold, unless that makes the counts
+ * uneven again. Followers are moved before leaders.
+ */
+std::optional<replica_move> plan_replica_move(
+  const std::vector<balancer_partition>&, const std::vector<balancer_node>&);
+
+/**
+ * Balances partition leaders and replicas across the nodes of the cluster.
+ * Runs only on the controller leader, leaders are moved with raft leadership
+ * transfers and replicas with the same replica set updates operators use,
+ * never exceeding partition_balancer_max_concurrent_moves updates in
+ * progress. Single instance, runs on shard 0.
+ */
+class partition_balancer {
+public:
+    static constexpr ss::shard_id shard = 0;
+    static constexpr double imbalance_threshold = 1.2;
+    static constexpr std::chrono::seconds request_timeout{5};
+
+    partition_balancer(
+      consensus_ptr,
+      ss::sharded<topic_table>&,
+      ss::sharded<partition_leaders_table>&,
+      ss::sharded<members_table>&,
+      ss::sharded<partition_allocator>&,
+      ss::sharded<topics_frontend>&,
+      ss::sharded<partition_manager>&,
+      ss::sharded<shard_table>&,
+      ss::sharded<rpc::connection_cache>&);
+
+    ss::future<> start();
+    ss::future<> stop();
+
+private:
+    ss::future<> balance();
+    std::vector<balancer_partition> collect_partitions() const;
+    std::vector<balancer_node> collect_nodes() const;
+    ss::future<> transfer_leadership(leadership_transfer);
+    ss::future<> move_replica(const balancer_partition&, replica_move);
+
+    consensus_ptr _raft0;
+    ss::sharded<topic_table>& _topics;
+    ss::sharded<partition_leaders_table>& _leaders;
+    ss::sharded<members_table>& _members;
+    ss::sharded<partition_allocator>& _allocator;
+    ss::sharded<topics_frontend>& _topics_frontend;
+    ss::sharded<partition_manager>& _partition_manager;
+    ss::sharded<shard_table>& _shard_table;
+    ss::sharded<rpc::connection_cache>& _connections;
+    std::chrono::milliseconds _interval;
+    ss::timer<> _timer;
+    ss::gate _gate;
+};
+
+} // namespace cluster
@@ -45,6 +45,16 @@ partition_leaders_table::get_leader(const model::ntp& ntp) const {
     return get_leader(model::topic_namespace_view(ntp), ntp.tp.partition);
 }
 
+std::optional<model::term_id>
+partition_leaders_table::get_leader_term(const model::ntp& ntp) const {
+    if (auto it = _leaders.find(leader_key_view{
+          model::topic_namespace_view(ntp), ntp.tp.partition});
+        it != _leaders.end()) {
+        return it->second.update_term;
+    }
+    return std::nullopt;
+}
+
 void partition_leaders_table::update_partition_leader(
   const model::ntp& ntp,
   model::term_id term,
@@ -52,12 +62,15 @@ void partition_leaders_table::update_partition_leader(
     auto key = leader_key_view{
       model::topic_namespace_view(ntp), ntp.tp.partition};
     auto it = _leaders.find(key);
+    bool leader_changed = false;
     if (it == _leaders.end()) {
         auto [new_it, _] = _leaders.emplace(
           leader_key{
             model::topic_namespace(ntp.ns, ntp.tp.topic), ntp.tp.partition},
           leader_meta{leader_id, term});
         it = new_it;
+        ++_epoch;
+        leader_changed = true;
     }
 
     if (it->second.update_term > term) {
@@ -65,8 +78,16 @@ void partition_leaders_table::update_partition_leader(
         return;
     }
     // existing partition
+    if (it->second.id != leader_id || it->second.update_term != term) {
+        ++_epoch;
+    }
+    leader_changed = leader_changed || it->second.id != leader_id;
     it->second.id = leader_id;
     it->second.update_term = term;
+    if (leader_changed) {
+        notify_leadership_change(
+          model::topic_namespace_view(ntp), ntp.tp.partition, leader_id);
+    }
 
     // notify waiters if update is setting the leader
     if (!leader_id) {
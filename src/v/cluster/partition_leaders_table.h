@@ -11,12 +11,15 @@
 
 #pragma once
 
+#include "cluster/types.h"
 #include "model/fundamental.h"
 #include "model/metadata.h"
 #include "utils/concepts-enabled.h"
 #include "utils/expiring_promise.h"
 
 #include <absl/container/flat_hash_map.h>
+#include <seastar/util/noncopyable_function.hh>
+
 #include <absl/container/node_hash_map.h>
 
 namespace cluster {
@@ -37,6 +40,9 @@ public:
     std::optional<model::node_id>
       get_leader(model::topic_namespace_view, model::partition_id) const;
 
+    /// term in which the current leader of the partition was elected
+    std::optional<model::term_id> get_leader_term(const model::ntp&) const;
+
     ss::future<model::node_id> wait_for_leader(
       const model::ntp&,
       ss::lowres_clock::time_point,
@@ -62,12 +68,47 @@ public:
     void remove_leader(const model::ntp& ntp) {
         _leaders.erase(
           leader_key_view{model::topic_namespace_view(ntp), ntp.tp.partition});
+        ++_epoch;
+        notify_leadership_change(
+          model::topic_namespace_view(ntp), ntp.tp.partition, std::nullopt);
     }
 
+    /// Changes every time leader of any partition changes
+    uint64_t epoch() const { return _epoch; }
+
     void update_partition_leader(
       const model::ntp&, model::term_id, std::optional<model::node_id>);
 
+    /// called whenever the leader of a partition changes or is removed
+    using leadership_change_cb_t = ss::noncopyable_function<void(
+      model::topic_namespace_view,
+      model::partition_id,
+      std::optional<model::node_id>)>;
+
+    notification_id_type
+    register_leadership_change_notification(leadership_change_cb_t cb) {
+        auto id = _notification_id++;
+        _notifications.emplace_back(id, std::move(cb));
+        return id;
+    }
+
+    void unregister_leadership_change_notification(notification_id_type id) {
+        std::erase_if(
+          _notifications,
+          [id](const std::pair<notification_id_type, leadership_change_cb_t>&
+                 n) { return n.first == id; });
+    }
+
 private:
+    void notify_leadership_change(
+      model::topic_namespace_view tp_ns,
+      model::partition_id pid,
+      std::optional<model::node_id> leader) {
+        for (auto& [_, cb] : _notifications) {
+            cb(tp_ns, pid, leader);
+        }
+    }
+
     // optimized to reduce number of ntp copies
     struct leader_key {
         model::topic_namespace tp_ns;
@@ -131,6 +172,10 @@ private:
 
     absl::flat_hash_map<leader_key, leader_meta, leader_key_hash, leader_key_eq>
       _leaders;
+    uint64_t _epoch{0};
+    notification_id_type _notification_id{0};
+    std::vector<std::pair<notification_id_type, leadership_change_cb_t>>
+      _notifications;
 
     // per-ntp notifications for leadership election. note that the
     // namespace is currently ignored pending an update to the metadata
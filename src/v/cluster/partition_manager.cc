@@ -19,10 +19,15 @@
 #include "resource_mgmt/io_priority.h"
 #include "vlog.h"
 
+#include <seastar/core/coroutine.hh>
 #include <seastar/core/reactor.hh>
+#include <seastar/core/semaphore.hh>
 #include <seastar/core/shared_ptr.hh>
 #include <seastar/core/smp.hh>
 
+#include <algorithm>
+#include <vector>
+
 namespace cluster {
 
 partition_manager::partition_manager(
@@ -51,10 +56,50 @@ ss::future<consensus_ptr> partition_manager::manage(
 }
 
 ss::future<> partition_manager::stop() {
+    _metrics_rollup.stop();
     return ss::parallel_for_each(
       _ntp_table, [](auto& p) { return p.second->stop(); });
 }
 
+ss::future<size_t>
+partition_manager::drain_leadership(size_t max_concurrent) {
+    std::vector<ss::lw_shared_ptr<partition>> leaders;
+    for (auto& [_, p] : _ntp_table) {
+        if (p->is_leader()) {
+            leaders.push_back(p);
+        }
+    }
+    vlog(
+      clusterlog.info, "Draining the leadership of {} groups", leaders.size());
+    ss::semaphore in_flight(std::max<size_t>(max_concurrent, 1));
+    co_await ss::parallel_for_each(
+      leaders, [&in_flight](ss::lw_shared_ptr<partition> p) {
+          return ss::with_semaphore(in_flight, 1, [p] {
+              return p->transfer_leadership(std::nullopt)
+                .then([p](std::error_code ec) {
+                    if (ec) {
+                        vlog(
+                          clusterlog.info,
+                          "Cannot transfer the leadership of {}: {}",
+                          p->ntp(),
+                          ec.message());
+                    }
+                })
+                .handle_exception([p](const std::exception_ptr& e) {
+                    vlog(
+                      clusterlog.info,
+                      "Cannot transfer the leadership of {}: {}",
+                      p->ntp(),
+                      e);
+                });
+          });
+      });
+    co_return std::count_if(
+      leaders.begin(), leaders.end(), [](const auto& p) {
+          return p->is_leader();
+      });
+}
+
 ss::future<> partition_manager::remove(const model::ntp& ntp) {
     auto partition = get(ntp);
 
@@ -77,6 +122,27 @@ ss::future<> partition_manager::remove(const model::ntp& ntp) {
       .finally([partition] {}); // in the end remove partition
 }
 
+ss::future<> partition_manager::shutdown(const model::ntp& ntp) {
+    auto partition = get(ntp);
+
+    if (!partition) {
+        return ss::make_exception_future<>(std::invalid_argument(fmt::format(
+          "Can not shutdown partition. NTP {} is not present in partition "
+          "manager",
+          ntp)));
+    }
+    auto group_id = partition->group();
+
+    _ntp_table.erase(ntp);
+    _raft_table.erase(group_id);
+
+    return _raft_manager.local()
+      .shutdown(partition->raft())
+      .then([partition] { return partition->stop(); })
+      .then([this, ntp] { return _storage.log_mgr().shutdown(ntp); })
+      .finally([partition] {});
+}
+
 std::ostream& operator<<(std::ostream& o, const partition_manager& pm) {
     return o << "{shard:" << ss::this_shard_id() << ", mngr:{}"
              << pm._storage.log_mgr()
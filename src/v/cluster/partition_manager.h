@@ -13,7 +13,9 @@
 
 #include "cluster/ntp_callbacks.h"
 #include "cluster/partition.h"
+#include "cluster/partition_metrics_rollup.h"
 #include "model/metadata.h"
+#include "model/record_batch_reader.h"
 #include "raft/consensus_client_protocol.h"
 #include "raft/group_manager.h"
 #include "raft/heartbeat_manager.h"
@@ -22,6 +24,8 @@
 
 #include <absl/container/flat_hash_map.h>
 
+#include <optional>
+
 namespace cluster {
 class partition_manager {
 public:
@@ -34,6 +38,12 @@ public:
     using manage_cb_t
       = ss::noncopyable_function<void(ss::lw_shared_ptr<partition>)>;
 
+    /// Reader of the data of a partition that is no longer in the local log,
+    /// or nullopt if the offset isn't available remotely either
+    using remote_reader_fn = ss::noncopyable_function<
+      ss::future<std::optional<model::record_batch_reader>>(
+        const model::ntp&, storage::log_reader_config)>;
+
     inline ss::lw_shared_ptr<partition> get(const model::ntp& ntp) const {
         if (auto it = _ntp_table.find(ntp); it != _ntp_table.end()) {
             return it->second;
@@ -57,13 +67,28 @@ public:
         return nullptr;
     }
 
-    ss::future<> start() { return ss::now(); }
+    ss::future<> start() {
+        _metrics_rollup.start();
+        return ss::now();
+    }
     ss::future<> stop();
     ss::future<consensus_ptr>
       manage(storage::ntp_config, raft::group_id, std::vector<model::broker>);
 
     ss::future<> remove(const model::ntp& ntp);
 
+    /// \brief stops the partition keeping its data and persisted state, the
+    /// partition can be managed again on other shard of this node
+    ss::future<> shutdown(const model::ntp& ntp);
+
+    /**
+     * \brief transfers the leadership of the groups led on this shard to
+     * their most up to date followers, with at most max_concurrent
+     * transfers in flight. Resolves to the number of groups still led once
+     * every transfer has completed or failed.
+     */
+    ss::future<size_t> drain_leadership(size_t max_concurrent);
+
     std::optional<storage::log> log(const model::ntp& ntp) {
         return _storage.log_mgr().get(ntp);
     }
@@ -109,6 +134,25 @@ public:
      */
     const ntp_table_container& partitions() const { return _ntp_table; }
 
+    /// Serve the offsets below the local start offset of the logs with the
+    /// reader, e.g. from the segments archived to S3. Its owner unregisters
+    /// it before stopping
+    void register_remote_reader(remote_reader_fn fn) {
+        _remote_reader = std::move(fn);
+    }
+    void unregister_remote_reader() { _remote_reader = nullptr; }
+
+    /// Reader of the offsets below the local start offset of the partition,
+    /// nullopt when no remote reader is registered or it has no data there
+    ss::future<std::optional<model::record_batch_reader>>
+    make_remote_reader(const model::ntp& ntp, storage::log_reader_config cfg) {
+        if (!_remote_reader) {
+            return ss::make_ready_future<
+              std::optional<model::record_batch_reader>>(std::nullopt);
+        }
+        return _remote_reader(ntp, cfg);
+    }
+
 private:
     storage::api& _storage;
     /// used to wait for concurrent recoveries
@@ -119,6 +163,8 @@ private:
     ntp_table_container _ntp_table;
     absl::flat_hash_map<raft::group_id, ss::lw_shared_ptr<partition>>
       _raft_table;
+    partition_metrics_rollup _metrics_rollup{_ntp_table};
+    remote_reader_fn _remote_reader;
 
     friend std::ostream& operator<<(std::ostream&, const partition_manager&);
 };
@@ -0,0 +1,170 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "cluster/partition_metrics_rollup.h"
+
+#include "config/configuration.h"
+#include "prometheus/prometheus_sanitize.h"
+
+#include <seastar/core/metrics.hh>
+
+#include <algorithm>
+#include <tuple>
+
+namespace cluster {
+
+void partition_metrics_rollup::start() {
+    if (
+      config::shard_local_cfg().disable_metrics()
+      || !config::shard_local_cfg().aggregate_partition_metrics()) {
+        return;
+    }
+    _top_partitions
+      = config::shard_local_cfg().aggregate_metrics_top_partitions();
+    _timer.set_callback([this] { refresh(); });
+    _timer.arm_periodic(refresh_interval);
+    refresh();
+}
+
+void partition_metrics_rollup::stop() {
+    _timer.cancel();
+    _metrics.clear();
+}
+
+void partition_metrics_rollup::refresh() {
+    select_detailed_partitions();
+
+    std::vector<model::topic_namespace> topics;
+    for (const auto& [ntp, _] : _partitions) {
+        topics.emplace_back(ntp.ns, ntp.tp.topic);
+    }
+    std::sort(
+      topics.begin(),
+      topics.end(),
+      [](const model::topic_namespace& a, const model::topic_namespace& b) {
+          return std::tie(a.ns, a.tp) < std::tie(b.ns, b.tp);
+      });
+    topics.erase(std::unique(topics.begin(), topics.end()), topics.end());
+    if (topics != _topics) {
+        register_topics(std::move(topics));
+    }
+}
+
+void partition_metrics_rollup::select_detailed_partitions() {
+    struct traffic {
+        uint64_t bytes;
+        const ss::lw_shared_ptr<partition>* p;
+    };
+    std::vector<traffic> traffics;
+    traffics.reserve(_partitions.size());
+    absl::flat_hash_map<model::ntp, uint64_t> current;
+    current.reserve(_partitions.size());
+    for (const auto& [ntp, p] : _partitions) {
+        auto bytes = p->probe().bytes_transferred();
+        uint64_t previous = 0;
+        if (auto it = _last_traffic.find(ntp); it != _last_traffic.end()) {
+            previous = std::min(it->second, bytes);
+        }
+        traffics.push_back({.bytes = bytes - previous, .p = &p});
+        current.emplace(ntp, bytes);
+    }
+    _last_traffic = std::move(current);
+
+    auto top = std::min(_top_partitions, traffics.size());
+    std::nth_element(
+      traffics.begin(),
+      traffics.begin() + top,
+      traffics.end(),
+      [](const traffic& a, const traffic& b) { return a.bytes > b.bytes; });
+
+    for (size_t i = 0; i < traffics.size(); ++i) {
+        auto& p = *traffics[i].p;
+        // idle partitions don't deserve their own series
+        bool detailed = i < top && traffics[i].bytes > 0;
+        if (detailed && !p->probe().has_detailed_metrics()) {
+            p->probe().register_detailed_metrics(p->ntp());
+        } else if (!detailed && p->probe().has_detailed_metrics()) {
+            p->probe().clear_detailed_metrics();
+        }
+    }
+}
+
+const partition_metrics_rollup::topic_totals&
+partition_metrics_rollup::totals(const model::topic_namespace& tn) {
+    auto now = clock_type::now();
+    if (now - _snapshot_at >= snapshot_max_age) {
+        _snapshot_at = now;
+        _snapshot.clear();
+        for (const auto& [ntp, p] : _partitions) {
+            auto& t = _snapshot[model::topic_namespace(ntp.ns, ntp.tp.topic)];
+            ++t.partitions;
+            t.leaders += p->is_leader() ? 1 : 0;
+            t.records_produced += p->probe().records_produced();
+            t.records_fetched += p->probe().records_fetched();
+            t.bytes_produced += p->probe().bytes_produced();
+            t.bytes_fetched += p->probe().bytes_fetched();
+        }
+    }
+    static const topic_totals empty{};
+    if (auto it = _snapshot.find(tn); it != _snapshot.end()) {
+        return it->second;
+    }
+    return empty;
+}
+
+void partition_metrics_rollup::register_topics(
+  std::vector<model::topic_namespace> topics) {
+    _topics = std::move(topics);
+    _metrics.clear();
+    namespace sm = ss::metrics;
+    auto ns_label = sm::label("namespace");
+    auto topic_label = sm::label("topic");
+    std::vector<sm::metric_definition> defs;
+    defs.reserve(_topics.size() * 6);
+    for (const auto& tn : _topics) {
+        const std::vector<sm::label_instance> labels = {
+          ns_label(tn.ns()),
+          topic_label(tn.tp()),
+        };
+        defs.push_back(sm::make_gauge(
+          "partitions",
+          [this, tn] { return totals(tn).partitions; },
+          sm::description("Number of partitions of the topic on the core"),
+          labels));
+        defs.push_back(sm::make_gauge(
+          "leaders",
+          [this, tn] { return totals(tn).leaders; },
+          sm::description("Number of partitions of the topic led by the core"),
+          labels));
+        defs.push_back(sm::make_derive(
+          "records_produced",
+          [this, tn] { return totals(tn).records_produced; },
+          sm::description("Total number of records produced to the topic"),
+          labels));
+        defs.push_back(sm::make_derive(
+          "records_fetched",
+          [this, tn] { return totals(tn).records_fetched; },
+          sm::description("Total number of records fetched from the topic"),
+          labels));
+        defs.push_back(sm::make_derive(
+          "bytes_produced",
+          [this, tn] { return totals(tn).bytes_produced; },
+          sm::description("Total number of bytes produced to the topic"),
+          labels));
+        defs.push_back(sm::make_derive(
+          "bytes_fetched",
+          [this, tn] { return totals(tn).bytes_fetched; },
+          sm::description("Total number of bytes fetched from the topic"),
+          labels));
+    }
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("cluster:topic"), defs);
+}
+
+} // namespace cluster
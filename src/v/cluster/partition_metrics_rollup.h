@@ -0,0 +1,97 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "cluster/partition.h"
+#include "model/fundamental.h"
+#include "model/metadata.h"
+#include "seastarx.h"
+
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/core/shared_ptr.hh>
+#include <seastar/core/timer.hh>
+
+#include <absl/container/flat_hash_map.h>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace cluster {
+
+/**
+ * Per topic rollup of the partition metrics of a shard.
+ *
+ * With thousands of partitions per node the per partition series make a
+ * scrape of the metrics endpoint both huge and slow. When the partition
+ * metrics are aggregated the partitions don't register their own series,
+ * the rollup exports the sums of every topic instead. The sums are computed
+ * lazily, at most once per snapshot_max_age, in a single pass over the
+ * partitions of the shard, whatever the number of series of the scrape.
+ *
+ * Every refresh_interval the top_partitions partitions with the most traffic
+ * since the previous refresh get their per partition series back, the others
+ * drop them, and the series of the rollup follow the topics of the shard.
+ */
+class partition_metrics_rollup {
+public:
+    using clock_type = ss::lowres_clock;
+    using partitions_t
+      = absl::flat_hash_map<model::ntp, ss::lw_shared_ptr<partition>>;
+    static constexpr clock_type::duration refresh_interval
+      = std::chrono::seconds(10);
+    static constexpr clock_type::duration snapshot_max_age
+      = std::chrono::seconds(1);
+
+    struct topic_totals {
+        uint64_t partitions{0};
+        uint64_t leaders{0};
+        uint64_t records_produced{0};
+        uint64_t records_fetched{0};
+        uint64_t bytes_produced{0};
+        uint64_t bytes_fetched{0};
+    };
+
+    explicit partition_metrics_rollup(const partitions_t& partitions)
+      : _partitions(partitions) {}
+
+    /// no-op unless the partition metrics are aggregated
+    void start();
+    void stop();
+
+    /// \brief picks the partitions with detailed series and the topics of
+    /// the rollup
+    void refresh();
+
+    /// \brief sums of the topic, from a snapshot at most snapshot_max_age old
+    const topic_totals& totals(const model::topic_namespace&);
+
+    size_t top_partitions() const { return _top_partitions; }
+    void set_top_partitions(size_t n) { _top_partitions = n; }
+
+private:
+    void select_detailed_partitions();
+    void register_topics(std::vector<model::topic_namespace>);
+
+    const partitions_t& _partitions;
+    size_t _top_partitions{0};
+    // traffic of the partitions at the previous refresh
+    absl::flat_hash_map<model::ntp, uint64_t> _last_traffic;
+    absl::flat_hash_map<model::topic_namespace, topic_totals> _snapshot;
+    clock_type::time_point _snapshot_at;
+    std::vector<model::topic_namespace> _topics;
+    ss::timer<clock_type> _timer;
+    ss::metrics::metric_groups _metrics;
+};
+
+} // namespace cluster
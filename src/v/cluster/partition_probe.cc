@@ -17,11 +17,25 @@
 
 namespace cluster {
 void partition_probe::setup_metrics(const model::ntp& ntp) {
-    namespace sm = ss::metrics;
+    if (
+      config::shard_local_cfg().disable_metrics()
+      || config::shard_local_cfg().aggregate_partition_metrics()) {
+        return;
+    }
+    register_detailed_metrics(ntp);
+}
+
+void partition_probe::clear_detailed_metrics() {
+    _metrics.clear();
+    _detailed = false;
+}
 
-    if (config::shard_local_cfg().disable_metrics()) {
+void partition_probe::register_detailed_metrics(const model::ntp& ntp) {
+    if (_detailed) {
         return;
     }
+    _detailed = true;
+    namespace sm = ss::metrics;
 
     auto ns_label = sm::label("namespace");
     auto topic_label = sm::label("topic");
@@ -62,6 +76,16 @@ void partition_probe::setup_metrics(const model::ntp& ntp) {
           [this] { return _records_fetched; },
           sm::description("Total number of records fetched"),
           labels),
+        sm::make_derive(
+          "bytes_produced",
+          [this] { return _bytes_produced; },
+          sm::description("Total number of bytes produced"),
+          labels),
+        sm::make_derive(
+          "bytes_fetched",
+          [this] { return _bytes_fetched; },
+          sm::description("Total number of bytes fetched"),
+          labels),
       });
 }
 } // namespace cluster
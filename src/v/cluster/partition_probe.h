@@ -11,10 +11,13 @@
 
 #pragma once
 #include "model/fundamental.h"
+#include "seastarx.h"
 
 #include <seastar/core/metrics_registration.hh>
+#include <seastar/core/smp.hh>
 
 #include <cstdint>
+#include <utility>
 
 namespace cluster {
 
@@ -27,6 +30,16 @@ public:
 
     void setup_metrics(const model::ntp&);
 
+    /// \brief per partition series, whatever the metrics configuration.
+    /// when the partition metrics are aggregated only the partitions with
+    /// the most traffic have them
+    void register_detailed_metrics(const model::ntp&);
+    void clear_detailed_metrics();
+    bool has_detailed_metrics() const { return _detailed; }
+
+    uint64_t records_produced() const { return _records_produced; }
+    uint64_t records_fetched() const { return _records_fetched; }
+
     void add_records_produced(uint64_t num_records) {
         _records_produced += num_records;
     }
@@ -35,10 +48,52 @@ public:
         _records_fetched += num_records;
     }
 
+    void add_bytes_produced(uint64_t bytes) { _bytes_produced += bytes; }
+
+    void add_bytes_fetched(uint64_t bytes) { _bytes_fetched += bytes; }
+
+    uint64_t bytes_produced() const { return _bytes_produced; }
+    uint64_t bytes_fetched() const { return _bytes_fetched; }
+
+    /// bytes produced to and fetched from the partition on this node
+    uint64_t bytes_transferred() const {
+        return _bytes_produced + _bytes_fetched;
+    }
+
+    struct request_affinity {
+        ss::shard_id shard;
+        // bytes sent from the shard above the bytes sent from all the others
+        uint64_t votes;
+    };
+
+    /**
+     * Records the shard the kafka request moving the bytes was received on.
+     * Weighted majority vote, if a single shard sent more than half of the
+     * bytes it is the candidate.
+     */
+    void add_request_bytes(ss::shard_id source, uint64_t bytes) {
+        if (source == _affinity.shard) {
+            _affinity.votes += bytes;
+        } else if (_affinity.votes >= bytes) {
+            _affinity.votes -= bytes;
+        } else {
+            _affinity = {.shard = source, .votes = bytes - _affinity.votes};
+        }
+    }
+
+    /// returns the candidate of the votes since the previous call
+    request_affinity take_request_affinity() {
+        return std::exchange(_affinity, {.shard = _affinity.shard, .votes = 0});
+    }
+
 private:
     partition& _partition;
     uint64_t _records_produced = 0;
     uint64_t _records_fetched = 0;
+    uint64_t _bytes_produced = 0;
+    uint64_t _bytes_fetched = 0;
+    request_affinity _affinity{.shard = ss::this_shard_id(), .votes = 0};
+    bool _detailed{false};
     ss::metrics::metric_groups _metrics;
 };
 } // namespace cluster
@@ -124,11 +124,11 @@ ss::future<> persisted_stm::persist_snapshot(stm_snapshot&& snapshot) {
 }
 
 ss::future<> persisted_stm::do_make_snapshot() {
-    auto snapshot = take_snapshot();
-    auto offset = snapshot.offset;
-
-    return persist_snapshot(std::move(snapshot)).then([this, offset] {
-        _last_snapshot_offset = std::max(_last_snapshot_offset, offset);
+    return take_snapshot().then([this](stm_snapshot snapshot) {
+        auto offset = snapshot.offset;
+        return persist_snapshot(std::move(snapshot)).then([this, offset] {
+            _last_snapshot_offset = std::max(_last_snapshot_offset, offset);
+        });
     });
 }
 
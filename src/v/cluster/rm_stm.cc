@@ -18,10 +18,14 @@
 #include "raft/types.h"
 #include "storage/parser_utils.h"
 #include "storage/record_batch_builder.h"
+#include "utils/vint.h"
 
 #include <seastar/core/coroutine.hh>
+#include <seastar/core/future-util.hh>
 #include <seastar/core/future.hh>
+#include <seastar/util/defer.hh>
 
+#include <array>
 #include <filesystem>
 #include <optional>
 
@@ -147,7 +151,6 @@ static inline rm_stm::producer_epoch epoch(model::producer_identity pid) {
 
 rm_stm::rm_stm(ss::logger& logger, raft::consensus* c)
   : persisted_stm("rm", logger, c)
-  , _oldest_session(model::timestamp::now())
   , _sync_timeout(config::shard_local_cfg().rm_sync_timeout_ms.value())
   , _recovery_policy(
       config::shard_local_cfg().rm_violation_recovery_policy.value())
@@ -290,11 +293,7 @@ ss::future<tx_errc> rm_stm::prepare_tx(
 
     auto batch = make_prepare_batch(
       prepare_marker{.tm_partition = tm, .tx_seq = tx_seq, .pid = pid});
-    auto reader = model::make_memory_record_batch_reader(std::move(batch));
-    auto r = co_await _c->replicate(
-      etag,
-      std::move(reader),
-      raft::replicate_options(raft::consistency_level::quorum_ack));
+    auto r = co_await replicate_marker(etag, std::move(batch));
 
     if (!r) {
         vlog(
@@ -409,11 +408,7 @@ ss::future<tx_errc> rm_stm::commit_tx(
     }
 
     auto batch = make_control_batch(pid, model::control_record_type::tx_commit);
-    auto reader = model::make_memory_record_batch_reader(std::move(batch));
-    auto r = co_await _c->replicate(
-      _insync_term,
-      std::move(reader),
-      raft::replicate_options(raft::consistency_level::quorum_ack));
+    auto r = co_await replicate_marker(_insync_term, std::move(batch));
 
     if (!r) {
         vlog(
@@ -452,11 +447,7 @@ ss::future<tx_errc> rm_stm::abort_tx(
     _mem_state.expected.erase(pid);
 
     auto batch = make_control_batch(pid, model::control_record_type::tx_abort);
-    auto reader = model::make_memory_record_batch_reader(std::move(batch));
-    auto r = co_await _c->replicate(
-      _insync_term,
-      std::move(reader),
-      raft::replicate_options(raft::consistency_level::quorum_ack));
+    auto r = co_await replicate_marker(_insync_term, std::move(batch));
 
     if (!r) {
         vlog(
@@ -472,6 +463,72 @@ ss::future<tx_errc> rm_stm::abort_tx(
     co_return tx_errc::none;
 }
 
+ss::future<result<raft::replicate_result>>
+rm_stm::replicate_marker(model::term_id term, model::record_batch batch) {
+    if (_gate.is_closed()) {
+        return ss::make_ready_future<result<raft::replicate_result>>(
+          raft::errc::shutting_down);
+    }
+    if (!_pending_markers.empty() && _pending_markers_term != term) {
+        flush_markers();
+    }
+    _pending_markers_term = term;
+    _pending_markers.push_back(pending_marker{.batch = std::move(batch)});
+    auto f = _pending_markers.back().promise.get_future();
+    if (!_markers_flush_scheduled) {
+        _markers_flush_scheduled = true;
+        // collect the markers of all transactions finishing in this poll
+        (void)ss::with_gate(_gate, [this] {
+            return ss::later().then([this] {
+                _markers_flush_scheduled = false;
+                flush_markers();
+            });
+        });
+    }
+    return f;
+}
+
+void rm_stm::flush_markers() {
+    if (_pending_markers.empty()) {
+        return;
+    }
+    auto pending = std::exchange(_pending_markers, {});
+    model::record_batch_reader::data_t batches;
+    std::vector<ss::promise<result<raft::replicate_result>>> promises;
+    batches.reserve(pending.size());
+    promises.reserve(pending.size());
+    for (auto& m : pending) {
+        batches.push_back(std::move(m.batch));
+        promises.push_back(std::move(m.promise));
+    }
+    vlog(
+      clusterlog.trace,
+      "replicating {} tx markers in term {}",
+      promises.size(),
+      _pending_markers_term);
+    // every caller waits for the last offset of the whole set, the
+    // markers are applied in order so none of them is acked early
+    (void)_c
+      ->replicate(
+        _pending_markers_term,
+        model::make_memory_record_batch_reader(std::move(batches)),
+        raft::replicate_options(raft::consistency_level::quorum_ack))
+      .then_wrapped([promises = std::move(promises)](
+                      ss::future<result<raft::replicate_result>> f) mutable {
+          if (f.failed()) {
+              auto e = f.get_exception();
+              for (auto& p : promises) {
+                  p.set_exception(e);
+              }
+              return;
+          }
+          auto r = f.get0();
+          for (auto& p : promises) {
+              p.set_value(r);
+          }
+      });
+}
+
 ss::future<checked<raft::replicate_result, kafka::error_code>>
 rm_stm::replicate(
   model::batch_identity bid,
@@ -491,29 +548,18 @@ rm_stm::replicate(
 }
 
 bool rm_stm::check_seq(model::batch_identity bid) {
-    auto pid_seq = _log_state.seq_table.find(bid.pid);
-    auto last_write_timestamp = model::timestamp::now().value();
-    if (pid_seq == _log_state.seq_table.end()) {
+    auto pid_seq = _log_state.find_seq(bid.pid);
+    if (!pid_seq) {
         if (bid.first_seq != 0) {
             return false;
         }
-        seq_entry entry{
-          .pid = bid.pid,
-          .seq = bid.last_seq,
-          .last_write_timestamp = last_write_timestamp};
-        _oldest_session = std::min(
-          _oldest_session, model::timestamp(entry.last_write_timestamp));
-        _log_state.seq_table.emplace(entry.pid, entry);
-    } else {
-        if (!is_sequence(pid_seq->second.seq, bid.first_seq)) {
-            return false;
-        }
-        pid_seq->second.seq = bid.last_seq;
-        pid_seq->second.last_write_timestamp = last_write_timestamp;
-        _oldest_session = std::min(
-          _oldest_session,
-          model::timestamp(pid_seq->second.last_write_timestamp));
+    } else if (!is_sequence(pid_seq->seq, bid.first_seq)) {
+        return false;
     }
+    _log_state.set_seq(seq_entry{
+      .pid = bid.pid,
+      .seq = bid.last_seq,
+      .last_write_timestamp = model::timestamp::now().value()});
     return true;
 }
 
@@ -655,37 +701,42 @@ model::offset rm_stm::last_stable_offset() {
 ss::future<std::vector<rm_stm::tx_range>>
 rm_stm::aborted_transactions(model::offset from, model::offset to) {
     std::vector<rm_stm::tx_range> result;
-    for (auto& range : _log_state.aborted) {
-        if (range.second.last < from) {
-            continue;
+    // a transaction ends before its abort marker, the ones aborted before
+    // `from` can't overlap the range
+    auto& index = _log_state.abort_index;
+    auto it = std::lower_bound(
+      index.begin(),
+      index.end(),
+      from,
+      [](const abort_index_entry& e, model::offset o) { return e.marker < o; });
+    for (; it != index.end(); ++it) {
+        if (it->range.last >= from && it->range.first <= to) {
+            result.push_back(it->range);
         }
-        if (range.second.first > to) {
-            continue;
+        // all the transactions started up to `to` ended once an abort moved
+        // the last stable offset past it
+        if (it->lso > to) {
+            break;
         }
-        result.push_back(range.second);
     }
     co_return result;
 }
 
 void rm_stm::compact_snapshot() {
-    auto cutoff_timestamp = model::timestamp::now().value()
-                            - _transactional_id_expiration.count();
-    if (cutoff_timestamp <= _oldest_session.value()) {
-        return;
-    }
-    auto next_oldest_session = model::timestamp::now();
-    for (auto it = _log_state.seq_table.cbegin();
-         it != _log_state.seq_table.cend();) {
-        if (it->second.last_write_timestamp < cutoff_timestamp) {
-            _log_state.seq_table.erase(it++);
-        } else {
-            next_oldest_session = std::min(
-              next_oldest_session,
-              model::timestamp(it->second.last_write_timestamp));
-            ++it;
+    _log_state.expire_seqs(
+      model::timestamp::now().value() - _transactional_id_expiration.count());
+
+    // fetches can't read the aborted transactions the log no longer has
+    auto start_offset = _c->start_offset();
+    auto& index = _log_state.abort_index;
+    while (!index.empty() && index.front().marker < start_offset) {
+        auto& range = index.front().range;
+        if (auto it = _log_state.aborted.find(range.pid);
+            it != _log_state.aborted.end() && it->second.first == range.first) {
+            _log_state.aborted.erase(it);
         }
+        index.pop_front();
     }
-    _oldest_session = next_oldest_session;
 }
 
 ss::future<> rm_stm::apply(model::record_batch b) {
@@ -704,7 +755,7 @@ ss::future<> rm_stm::apply(model::record_batch b) {
         apply_prepare(parse_prepare_batch(b));
     } else if (hdr.type == raft::data_batch_type) {
         if (hdr.attrs.is_control()) {
-            apply_control(bid.pid, parse_control_batch(b));
+            apply_control(bid.pid, parse_control_batch(b), last_offset);
         } else {
             apply_data(bid, last_offset);
         }
@@ -790,7 +841,9 @@ void rm_stm::apply_prepare(rm_stm::prepare_marker prepare) {
 }
 
 void rm_stm::apply_control(
-  model::producer_identity pid, model::control_record_type crt) {
+  model::producer_identity pid,
+  model::control_record_type crt,
+  model::offset marker) {
     auto fence_it = _log_state.fence_pid_epoch.find(id(pid));
     if (fence_it == _log_state.fence_pid_epoch.end()) {
         _log_state.fence_pid_epoch.emplace(id(pid), epoch(pid));
@@ -813,9 +866,15 @@ void rm_stm::apply_control(
         _log_state.prepared.erase(pid);
         auto offset_it = _log_state.ongoing_map.find(pid);
         if (offset_it != _log_state.ongoing_map.end()) {
-            _log_state.aborted.emplace(pid, offset_it->second);
-            _log_state.ongoing_set.erase(offset_it->second.first);
+            auto range = offset_it->second;
+            _log_state.aborted.emplace(pid, range);
+            _log_state.ongoing_set.erase(range.first);
             _log_state.ongoing_map.erase(pid);
+            auto lso = _log_state.ongoing_set.empty()
+                         ? raft::details::next_offset(marker)
+                         : *_log_state.ongoing_set.begin();
+            _log_state.abort_index.push_back(abort_index_entry{
+              .range = range, .marker = marker, .lso = lso});
         }
 
         _mem_state.forget(pid);
@@ -873,19 +932,12 @@ void rm_stm::apply_control(
 
 void rm_stm::apply_data(model::batch_identity bid, model::offset last_offset) {
     if (bid.has_idempotent()) {
-        auto pid_seq = _log_state.seq_table.find(bid.pid);
-        if (pid_seq == _log_state.seq_table.end()) {
-            seq_entry entry{
+        auto pid_seq = _log_state.find_seq(bid.pid);
+        if (!pid_seq || pid_seq->seq < bid.last_seq) {
+            _log_state.set_seq(seq_entry{
               .pid = bid.pid,
               .seq = bid.last_seq,
-              .last_write_timestamp = bid.max_timestamp.value()};
-            _log_state.seq_table.emplace(bid.pid, entry);
-            _oldest_session = std::min(
-              _oldest_session, model::timestamp(entry.last_write_timestamp));
-        } else if (pid_seq->second.seq < bid.last_seq) {
-            pid_seq->second.seq = bid.last_seq;
-            pid_seq->second.last_write_timestamp = bid.max_timestamp.value();
-            _oldest_session = std::min(_oldest_session, bid.max_timestamp);
+              .last_write_timestamp = bid.max_timestamp.value()});
         }
     }
 
@@ -938,9 +990,81 @@ void rm_stm::apply_data(model::batch_identity bid, model::offset last_offset) {
     }
 }
 
+static void write_varint(iobuf& out, int64_t v) {
+    std::array<uint8_t, vint::max_length> buf;
+    auto n = vint::serialize(v, buf.data());
+    out.append(buf.data(), n);
+}
+
+/// the entries of the range are projected to seq_entry, the range must not
+/// change while it is written
+template<typename Range, typename Projection>
+static ss::future<>
+write_seq_columns(const Range& entries, Projection proj, iobuf& out) {
+    reflection::serialize(out, static_cast<int32_t>(entries.size()));
+    // one column after the other, each varint is small once the producer
+    // ids and timestamps are replaced by the difference to the previous
+    // entry
+    auto write_column = [&out, &entries, &proj](auto value) -> ss::future<> {
+        int64_t prev = 0;
+        for (const auto& e : entries) {
+            auto [v, delta] = value(proj(e));
+            write_varint(out, delta ? v - prev : v);
+            prev = v;
+            if (ss::need_preempt()) {
+                co_await ss::later();
+            }
+        }
+    };
+    co_await write_column([](const rm_stm::seq_entry& e) {
+        return std::make_pair(e.pid.id, true);
+    });
+    co_await write_column([](const rm_stm::seq_entry& e) {
+        return std::make_pair(int64_t(e.pid.epoch), false);
+    });
+    co_await write_column([](const rm_stm::seq_entry& e) {
+        return std::make_pair(int64_t(e.seq), false);
+    });
+    co_await write_column([](const rm_stm::seq_entry& e) {
+        return std::make_pair(e.last_write_timestamp, true);
+    });
+}
+
+ss::future<>
+rm_stm::write_seq_entries(const seq_entries& entries, iobuf& out) {
+    return write_seq_columns(
+      entries, [](const seq_entry& e) -> const seq_entry& { return e; }, out);
+}
+
+rm_stm::seq_entries rm_stm::read_seq_entries(iobuf_parser& in) {
+    auto size = reflection::adl<int32_t>{}.from(in);
+    seq_entries entries;
+    for (int32_t i = 0; i < size; ++i) {
+        entries.emplace_back();
+    }
+    auto read_column = [&in, &entries](auto set, bool delta) {
+        int64_t prev = 0;
+        for (auto& e : entries) {
+            auto v = in.read_varlong().first + (delta ? prev : 0);
+            set(e, v);
+            prev = v;
+        }
+    };
+    read_column([](seq_entry& e, int64_t v) { e.pid.id = v; }, true);
+    read_column(
+      [](seq_entry& e, int64_t v) { e.pid.epoch = static_cast<int16_t>(v); },
+      false);
+    read_column(
+      [](seq_entry& e, int64_t v) { e.seq = static_cast<int32_t>(v); },
+      false);
+    read_column(
+      [](seq_entry& e, int64_t v) { e.last_write_timestamp = v; }, true);
+    return entries;
+}
+
 void rm_stm::load_snapshot(stm_snapshot_header hdr, iobuf&& tx_ss_buf) {
     vassert(
-      hdr.version == tx_snapshot_version,
+      hdr.version == tx_snapshot_version || hdr.version == 0,
       "unsupported seq_snapshot_header version {}",
       hdr.version);
     iobuf_parser data_parser(std::move(tx_ss_buf));
@@ -956,13 +1080,37 @@ void rm_stm::load_snapshot(stm_snapshot_header hdr, iobuf&& tx_ss_buf) {
     for (auto& entry : data.prepared) {
         _log_state.prepared.emplace(entry.pid, entry);
     }
+    // the aborts of older snapshots weren't indexed, they are assumed to
+    // end at their last offset and never end the search of a fetch
+    std::sort(
+      data.aborted.begin(),
+      data.aborted.end(),
+      [](const tx_range& a, const tx_range& b) { return a.last < b.last; });
     for (auto& entry : data.aborted) {
         _log_state.aborted.emplace(entry.pid, entry);
+        _log_state.abort_index.push_back(abort_index_entry{
+          .range = entry, .marker = entry.last, .lso = model::offset(-1)});
     }
+    auto load_seq = [this](const seq_entry& entry) {
+        auto prev = _log_state.find_seq(entry.pid);
+        if (!prev || prev->seq < entry.seq) {
+            _log_state.set_seq(entry);
+        }
+    };
     for (auto& entry : data.seqs) {
-        auto [seq_it, _] = _log_state.seq_table.try_emplace(entry.pid, entry);
-        if (seq_it->second.seq < entry.seq) {
-            seq_it->second = entry;
+        load_seq(entry);
+    }
+    if (hdr.version > 0) {
+        for (auto& entry : read_seq_entries(data_parser)) {
+            load_seq(entry);
+        }
+    }
+    if (hdr.version > 1) {
+        auto index = reflection::adl<std::vector<abort_index_entry>>{}.from(
+          data_parser);
+        for (auto& entry : index) {
+            _log_state.aborted.emplace(entry.range.pid, entry.range);
+            _log_state.abort_index.push_back(entry);
         }
     }
 
@@ -970,9 +1118,14 @@ void rm_stm::load_snapshot(stm_snapshot_header hdr, iobuf&& tx_ss_buf) {
     _insync_offset = data.offset;
 }
 
-stm_snapshot rm_stm::take_snapshot() {
+ss::future<stm_snapshot> rm_stm::take_snapshot() {
     tx_snapshot tx_ss;
 
+    // the state is copied before the first yield but for the seq table, it
+    // may be large so it is frozen instead and encoded in the background
+    // while the replicated and applied batches update the overlay
+    _log_state.freeze_seqs();
+    auto thaw = ss::defer([this] { _log_state.thaw_seqs(); });
     for (auto const& [k, v] : _log_state.fence_pid_epoch) {
         tx_ss.fenced.push_back(
           model::producer_identity{.id = k(), .epoch = v()});
@@ -983,16 +1136,21 @@ stm_snapshot rm_stm::take_snapshot() {
     for (auto& entry : _log_state.prepared) {
         tx_ss.prepared.push_back(entry.second);
     }
-    for (auto& entry : _log_state.aborted) {
-        tx_ss.aborted.push_back(entry.second);
-    }
-    for (auto& entry : _log_state.seq_table) {
-        tx_ss.seqs.push_back(entry.second);
-    }
+    // the aborts are stored in the abort index only
+    std::vector<abort_index_entry> index(
+      _log_state.abort_index.begin(), _log_state.abort_index.end());
     tx_ss.offset = _insync_offset;
 
     iobuf tx_ss_buf;
     reflection::adl<tx_snapshot>{}.to(tx_ss_buf, tx_ss);
+    co_await write_seq_columns(
+      _log_state.seq_table,
+      [](const auto& entry) -> const seq_entry& { return entry.second; },
+      tx_ss_buf);
+    thaw.cancel();
+    _log_state.thaw_seqs();
+    reflection::adl<std::vector<abort_index_entry>>{}.to(
+      tx_ss_buf, std::move(index));
 
     stm_snapshot_header header;
     header.version = tx_snapshot_version;
@@ -1000,9 +1158,9 @@ stm_snapshot rm_stm::take_snapshot() {
 
     stm_snapshot stx_ss;
     stx_ss.header = header;
-    stx_ss.offset = _insync_offset;
+    stx_ss.offset = tx_ss.offset;
     stx_ss.data = std::move(tx_ss_buf);
-    return stx_ss;
+    co_return stx_ss;
 }
 
 } // namespace cluster
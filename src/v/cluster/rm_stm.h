@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include "bytes/iobuf_parser.h"
 #include "cluster/persisted_stm.h"
 #include "cluster/types.h"
 #include "config/configuration.h"
@@ -25,10 +26,17 @@
 #include "storage/snapshot.h"
 #include "utils/expiring_promise.h"
 #include "utils/mutex.h"
+#include "vassert.h"
+
+#include <seastar/core/chunked_fifo.hh>
 
 #include <absl/container/btree_set.h>
 #include <absl/container/flat_hash_map.h>
 
+#include <deque>
+#include <optional>
+#include <vector>
+
 namespace cluster {
 
 /**
@@ -44,7 +52,9 @@ namespace cluster {
  */
 class rm_stm final : public persisted_stm {
 public:
-    static constexpr const int8_t tx_snapshot_version = 0;
+    // version 1 stores the seq table in columns after the tx_snapshot,
+    // version 2 the abort index after the seq table
+    static constexpr const int8_t tx_snapshot_version = 2;
     using producer_id = named_type<int64_t, struct producer_identity_id>;
     using producer_epoch = named_type<int16_t, struct producer_identity_epoch>;
 
@@ -54,6 +64,14 @@ public:
         model::offset last;
     };
 
+    struct abort_index_entry {
+        tx_range range;
+        // offset of the abort control batch
+        model::offset marker;
+        // the last stable offset once the transaction was aborted
+        model::offset lso;
+    };
+
     struct prepare_marker {
         // partition of the transaction manager
         // reposible for curent transaction
@@ -78,6 +96,13 @@ public:
         std::vector<seq_entry> seqs;
     };
 
+    using seq_entries = ss::chunked_fifo<seq_entry>;
+
+    /// Columnar encoding of the seq table in snapshots: the producer ids
+    /// and the timestamps are delta encoded, all values are varints.
+    static ss::future<> write_seq_entries(const seq_entries&, iobuf&);
+    static seq_entries read_seq_entries(iobuf_parser&);
+
     static constexpr model::control_record_version
       prepare_control_record_version{0};
     static constexpr model::control_record_version fence_control_record_version{
@@ -109,7 +134,7 @@ public:
 
 private:
     void load_snapshot(stm_snapshot_header, iobuf&&) override;
-    stm_snapshot take_snapshot() override;
+    ss::future<stm_snapshot> take_snapshot() override;
 
     bool check_seq(model::batch_identity);
 
@@ -124,9 +149,17 @@ private:
 
     void compact_snapshot();
 
+    // replicates a prepare, commit or abort marker. the markers of the
+    // transactions finishing on this partition in the same poll share a
+    // single replicate call
+    ss::future<result<raft::replicate_result>>
+      replicate_marker(model::term_id, model::record_batch);
+    void flush_markers();
+
     ss::future<> apply(model::record_batch) override;
     void apply_prepare(rm_stm::prepare_marker);
-    void apply_control(model::producer_identity, model::control_record_type);
+    void apply_control(
+      model::producer_identity, model::control_record_type, model::offset);
     void apply_data(model::batch_identity, model::offset);
 
     // The state of this state machine maybe change via two paths
@@ -155,12 +188,80 @@ private:
         absl::btree_set<model::offset> ongoing_set;
         absl::flat_hash_map<model::producer_identity, prepare_marker> prepared;
         absl::flat_hash_map<model::producer_identity, tx_range> aborted;
+        // the aborted transactions in the order of their abort markers, for
+        // a fetch to only visit the aborts overlapping the range it reads.
+        // the aborts are dropped once their markers fall off the log.
+        std::deque<abort_index_entry> abort_index;
         // the only piece of data which we update on replay and before
         // replicating the command. we use the highest seq number to resolve
         // conflicts. if the replication fails we reject a command but clients
         // by spec should be ready for thier commands being rejected so it's
         // ok by design to have false rejects
         absl::flat_hash_map<model::producer_identity, seq_entry> seq_table;
+        // the seq_table entries ordered by their last write, for the idle
+        // producers to expire without scanning the table
+        absl::btree_set<
+          std::pair<model::timestamp::type, model::producer_identity>>
+          seq_expiry;
+
+        // while a snapshot encodes the seq_table the table is frozen and
+        // the writes go to the overlay, an expired entry is kept as nullopt
+        // until the overlay is merged back
+        std::optional<absl::flat_hash_map<
+          model::producer_identity,
+          std::optional<seq_entry>>>
+          seq_overlay;
+
+        const seq_entry* find_seq(model::producer_identity pid) const {
+            if (seq_overlay) {
+                auto it = seq_overlay->find(pid);
+                if (it != seq_overlay->end()) {
+                    return it->second ? &*it->second : nullptr;
+                }
+            }
+            auto it = seq_table.find(pid);
+            return it == seq_table.end() ? nullptr : &it->second;
+        }
+
+        void set_seq(const seq_entry& entry) {
+            if (auto prev = find_seq(entry.pid); prev) {
+                seq_expiry.erase({prev->last_write_timestamp, entry.pid});
+            }
+            if (seq_overlay) {
+                seq_overlay->insert_or_assign(entry.pid, entry);
+            } else {
+                seq_table.insert_or_assign(entry.pid, entry);
+            }
+            seq_expiry.emplace(entry.last_write_timestamp, entry.pid);
+        }
+
+        void expire_seqs(model::timestamp::type cutoff) {
+            while (!seq_expiry.empty() && seq_expiry.begin()->first < cutoff) {
+                auto pid = seq_expiry.begin()->second;
+                if (seq_overlay) {
+                    seq_overlay->insert_or_assign(pid, std::nullopt);
+                } else {
+                    seq_table.erase(pid);
+                }
+                seq_expiry.erase(seq_expiry.begin());
+            }
+        }
+
+        void freeze_seqs() {
+            vassert(!seq_overlay, "the seq table is already frozen");
+            seq_overlay.emplace();
+        }
+
+        void thaw_seqs() {
+            for (auto& [pid, entry] : *seq_overlay) {
+                if (entry) {
+                    seq_table.insert_or_assign(pid, *entry);
+                } else {
+                    seq_table.erase(pid);
+                }
+            }
+            seq_overlay.reset();
+        }
     };
 
     struct mem_state {
@@ -199,9 +300,16 @@ private:
         }
     };
 
+    struct pending_marker {
+        model::record_batch batch;
+        ss::promise<result<raft::replicate_result>> promise;
+    };
+
     log_state _log_state;
     mem_state _mem_state;
-    model::timestamp _oldest_session;
+    std::vector<pending_marker> _pending_markers;
+    model::term_id _pending_markers_term;
+    bool _markers_flush_scheduled{false};
     std::chrono::milliseconds _sync_timeout;
     model::violation_recovery_policy _recovery_policy;
     std::chrono::milliseconds _transactional_id_expiration;
@@ -11,7 +11,10 @@
 
 #include "cluster/members_manager.h"
 #include "cluster/metadata_cache.h"
+#include "cluster/partition.h"
+#include "cluster/partition_manager.h"
 #include "cluster/security_frontend.h"
+#include "cluster/shard_table.h"
 #include "cluster/topics_frontend.h"
 #include "cluster/types.h"
 #include "config/configuration.h"
@@ -28,12 +31,16 @@ service::service(
   ss::sharded<topics_frontend>& tf,
   ss::sharded<members_manager>& mm,
   ss::sharded<metadata_cache>& cache,
-  ss::sharded<security_frontend>& sf)
+  ss::sharded<security_frontend>& sf,
+  ss::sharded<partition_manager>& pm,
+  ss::sharded<shard_table>& st)
   : controller_service(sg, ssg)
   , _topics_frontend(tf)
   , _members_manager(mm)
   , _md_cache(cache)
-  , _security_frontend(sf) {}
+  , _security_frontend(sf)
+  , _partition_manager(pm)
+  , _shard_table(st) {}
 
 ss::future<join_reply>
 service::join(join_request&& req, rpc::streaming_context&) {
@@ -110,6 +117,54 @@ ss::future<configuration_update_reply> service::update_node_configuration(
       });
 }
 
+ss::future<node_load_report_reply> service::report_node_load(
+  node_load_report&& req, rpc::streaming_context&) {
+    return ss::with_scheduling_group(
+      get_scheduling_group(), [this, req = std::move(req)]() mutable {
+          return _members_manager
+            .invoke_on(
+              members_manager::shard,
+              get_smp_service_group(),
+              [req = std::move(req)](members_manager& mm) mutable {
+                  return mm.handle_node_load_report(std::move(req));
+              })
+            .then([](result<node_load_report_reply> r) {
+                if (!r) {
+                    return node_load_report_reply{
+                      errc::not_leader_controller};
+                }
+                return r.value();
+            });
+      });
+}
+
+ss::future<transfer_leadership_reply> service::transfer_leadership(
+  transfer_leadership_request&& req, rpc::streaming_context&) {
+    return ss::with_scheduling_group(
+      get_scheduling_group(), [this, req = std::move(req)]() mutable {
+          auto shard = _shard_table.local().shard_for(req.ntp);
+          if (!shard) {
+              return ss::make_ready_future<transfer_leadership_reply>(
+                transfer_leadership_reply{errc::partition_not_exists});
+          }
+          return _partition_manager.invoke_on(
+            *shard,
+            get_smp_service_group(),
+            [req = std::move(req)](partition_manager& pm) {
+                auto p = pm.get(req.ntp);
+                if (!p) {
+                    return ss::make_ready_future<transfer_leadership_reply>(
+                      transfer_leadership_reply{errc::partition_not_exists});
+                }
+                return p->transfer_leadership(req.target)
+                  .then([](std::error_code ec) {
+                      return transfer_leadership_reply{
+                        ec ? errc::not_leader : errc::success};
+                  });
+            });
+      });
+}
+
 ss::future<finish_partition_update_reply> service::finish_partition_update(
   finish_partition_update_request&& req, rpc::streaming_context&) {
     return ss::with_scheduling_group(
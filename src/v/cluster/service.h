@@ -21,6 +21,8 @@ namespace cluster {
 class members_manager;
 class topics_frontend;
 class metadata_cache;
+class partition_manager;
+class shard_table;
 
 class service : public controller_service {
 public:
@@ -30,7 +32,9 @@ public:
       ss::sharded<topics_frontend>&,
       ss::sharded<members_manager>&,
       ss::sharded<metadata_cache>&,
-      ss::sharded<security_frontend>&);
+      ss::sharded<security_frontend>&,
+      ss::sharded<partition_manager>&,
+      ss::sharded<shard_table>&);
 
     virtual ss::future<join_reply>
     join(join_request&&, rpc::streaming_context&) override;
@@ -47,6 +51,12 @@ public:
     ss::future<update_topic_properties_reply> update_topic_properties(
       update_topic_properties_request&&, rpc::streaming_context&) final;
 
+    ss::future<node_load_report_reply>
+    report_node_load(node_load_report&&, rpc::streaming_context&) final;
+
+    ss::future<transfer_leadership_reply> transfer_leadership(
+      transfer_leadership_request&&, rpc::streaming_context&) final;
+
     ss::future<create_acls_reply>
     create_acls(create_acls_request&&, rpc::streaming_context&) final;
 
@@ -68,5 +78,7 @@ private:
     ss::sharded<members_manager>& _members_manager;
     ss::sharded<metadata_cache>& _md_cache;
     ss::sharded<security_frontend>& _security_frontend;
+    ss::sharded<partition_manager>& _partition_manager;
+    ss::sharded<shard_table>& _shard_table;
 };
 } // namespace cluster
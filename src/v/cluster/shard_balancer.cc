@@ -0,0 +1,209 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "cluster/shard_balancer.h"
+
+#include "cluster/controller_backend.h"
+#include "cluster/logger.h"
+#include "cluster/partition.h"
+#include "cluster/partition_manager.h"
+#include "config/configuration.h"
+#include "model/namespace.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/smp.hh>
+
+#include <algorithm>
+
+namespace cluster {
+
+uint64_t shard_load::total() const {
+    uint64_t sum = 0;
+    for (const auto& p : partitions) {
+        sum += p.load;
+    }
+    return sum;
+}
+
+std::optional<shard_move>
+plan_shard_move(const std::vector<shard_load>& shards) {
+    if (shards.size() < 2) {
+        return std::nullopt;
+    }
+    auto by_total = [](const shard_load& a, const shard_load& b) {
+        return a.total() < b.total();
+    };
+    auto [min_it, max_it] = std::minmax_element(
+      shards.begin(), shards.end(), by_total);
+    const uint64_t max = max_it->total();
+    const uint64_t min = min_it->total();
+    uint64_t sum = 0;
+    for (const auto& s : shards) {
+        sum += s.total();
+    }
+    const double avg = static_cast<double>(sum) / shards.size();
+    if (max == 0 || max <= avg * shard_balancer::imbalance_threshold) {
+        return std::nullopt;
+    }
+    // moving more than a half of the difference would just swap the shards
+    const uint64_t budget = (max - min) / 2;
+    const partition_load* candidate = nullptr;
+    for (const auto& p : max_it->partitions) {
+        if (p.load == 0 || p.load > budget) {
+            continue;
+        }
+        if (!candidate || p.load > candidate->load) {
+            candidate = &p;
+        }
+    }
+    if (!candidate) {
+        return std::nullopt;
+    }
+    return shard_move{
+      .ntp = candidate->ntp, .from = max_it->shard, .to = min_it->shard};
+}
+
+std::optional<shard_move>
+plan_affinity_move(const std::vector<shard_load>& shards) {
+    absl::flat_hash_map<ss::shard_id, uint64_t> totals;
+    uint64_t sum = 0;
+    for (const auto& s : shards) {
+        auto t = s.total();
+        totals.emplace(s.shard, t);
+        sum += t;
+    }
+    if (shards.size() < 2 || sum == 0) {
+        return std::nullopt;
+    }
+    const double limit = static_cast<double>(sum) / shards.size()
+                         * shard_balancer::imbalance_threshold;
+    std::optional<shard_move> ret;
+    uint64_t best = 0;
+    for (const auto& s : shards) {
+        for (const auto& p : s.partitions) {
+            if (
+              !p.affinity || *p.affinity == s.shard || p.load <= best
+              || p.affinity_votes * 2 < p.load) {
+                continue;
+            }
+            auto it = totals.find(*p.affinity);
+            if (it == totals.end() || it->second + p.load > limit) {
+                continue;
+            }
+            best = p.load;
+            ret = shard_move{.ntp = p.ntp, .from = s.shard, .to = *p.affinity};
+        }
+    }
+    return ret;
+}
+
+shard_balancer::shard_balancer(
+  ss::sharded<partition_manager>& pm, ss::sharded<controller_backend>& backend)
+  : _partition_manager(pm)
+  , _backend(backend)
+  , _interval(config::shard_local_cfg().shard_balancer_interval_ms()) {
+    _timer.set_callback([this] {
+        (void)ss::with_gate(_gate, [this] {
+            return rebalance().handle_exception([](std::exception_ptr e) {
+                vlog(clusterlog.warn, "shard balancing failed - {}", e);
+            });
+        }).finally([this] {
+            if (!_gate.is_closed()) {
+                _timer.arm(_interval);
+            }
+        });
+    });
+}
+
+ss::future<> shard_balancer::start() {
+    if (
+      !config::shard_local_cfg().enable_shard_balancer()
+      || ss::smp::count < 2) {
+        return ss::now();
+    }
+    _timer.arm(_interval);
+    return ss::now();
+}
+
+ss::future<> shard_balancer::stop() {
+    _timer.cancel();
+    return _gate.close();
+}
+
+static bool is_movable(const model::ntp& ntp) {
+    // internal partitions are left where the assignment places them
+    return ntp.ns == model::kafka_namespace
+           && ntp.tp.topic != model::kafka_group_topic;
+}
+
+ss::future<std::vector<shard_load>> shard_balancer::collect_load() {
+    auto totals = co_await _partition_manager.map([](partition_manager& pm) {
+        shard_load ret{.shard = ss::this_shard_id()};
+        for (const auto& [ntp, p] : pm.partitions()) {
+            if (is_movable(ntp)) {
+                auto affinity = p->probe().take_request_affinity();
+                ret.partitions.push_back(partition_load{
+                  .ntp = ntp,
+                  .load = p->probe().bytes_transferred(),
+                  .affinity = affinity.votes > 0
+                                ? std::make_optional(affinity.shard)
+                                : std::nullopt,
+                  .affinity_votes = affinity.votes,
+                });
+            }
+        }
+        return ret;
+    });
+    absl::flat_hash_map<model::ntp, uint64_t> current;
+    for (auto& s : totals) {
+        for (auto& p : s.partitions) {
+            current.emplace(p.ntp, p.load);
+            auto it = _last_bytes.find(p.ntp);
+            // counters start from zero when the partition is recreated
+            if (it != _last_bytes.end() && it->second <= p.load) {
+                p.load -= it->second;
+            }
+        }
+    }
+    _last_bytes = std::move(current);
+    co_return totals;
+}
+
+ss::future<> shard_balancer::rebalance() {
+    auto load = co_await collect_load();
+    auto move = plan_shard_move(load);
+    if (
+      !move && config::shard_local_cfg().shard_balancer_connection_affinity()) {
+        move = plan_affinity_move(load);
+    }
+    if (!move) {
+        co_return;
+    }
+    vlog(
+      clusterlog.info,
+      "shard balancer moving {} from shard {} to shard {}",
+      move->ntp,
+      move->from,
+      move->to);
+    auto ec = co_await _backend.invoke_on(
+      move->from, [move = *move](controller_backend& b) {
+          return b.move_partition_to_shard(move.ntp, move.to);
+      });
+    if (ec) {
+        vlog(
+          clusterlog.info,
+          "unable to move {} to shard {} - {}",
+          move->ntp,
+          move->to,
+          ec.message());
+    }
+}
+
+} // namespace cluster
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "cluster/fwd.h"
+#include "model/fundamental.h"
+#include "seastarx.h"
+
+#include <seastar/core/gate.hh>
+#include <seastar/core/sharded.hh>
+#include <seastar/core/timer.hh>
+
+#include <absl/container/flat_hash_map.h>
+
+#include <chrono>
+#include <optional>
+#include <vector>
+
+namespace cluster {
+
+struct partition_load {
+    model::ntp ntp;
+    uint64_t load;
+    // shard most of the kafka requests for the partition were received on
+    std::optional<ss::shard_id> affinity;
+    uint64_t affinity_votes{0};
+};
+
+struct shard_load {
+    ss::shard_id shard;
+    std::vector<partition_load> partitions;
+
+    uint64_t total() const;
+};
+
+struct shard_move {
+    model::ntp ntp;
+    ss::shard_id from;
+    ss::shard_id to;
+};
+
+/**
+ * Chooses the partition to move from the busiest shard to the least busy one.
+ * Nothing is moved unless the busiest shard has more than imbalance_threshold
+ * times the average load. The moved partition is the biggest one that does
+ * not make the target shard busier than the source is after the move.
+ */
+std::optional<shard_move> plan_shard_move(const std::vector<shard_load>&);
+
+/**
+ * Chooses the partition to move to the shard that receives most of the kafka
+ * requests for it, so that its clients are served without crossing shards.
+ * Only partitions getting more than three quarters of their bytes from that
+ * shard are considered, and only when the move does not make the target
+ * busier than imbalance_threshold times the average load.
+ */
+std::optional<shard_move> plan_affinity_move(const std::vector<shard_load>&);
+
+/**
+ * Balances the load of partitions across the shards of this node. Load of a
+ * partition is the number of bytes produced to and fetched from it since the
+ * previous check. When the shards are balanced and connection affinity is
+ * enabled, partitions follow the shard their clients are connected to.
+ * Single instance, runs on shard 0.
+ */
+class shard_balancer {
+public:
+    static constexpr ss::shard_id shard = 0;
+    static constexpr double imbalance_threshold = 1.25;
+
+    shard_balancer(
+      ss::sharded<partition_manager>&, ss::sharded<controller_backend>&);
+
+    ss::future<> start();
+    ss::future<> stop();
+
+private:
+    ss::future<> rebalance();
+    ss::future<std::vector<shard_load>> collect_load();
+
+    ss::sharded<partition_manager>& _partition_manager;
+    ss::sharded<controller_backend>& _backend;
+    std::chrono::milliseconds _interval;
+    ss::timer<> _timer;
+    ss::gate _gate;
+    // bytes transferred by the partitions at the previous check
+    absl::flat_hash_map<model::ntp, uint64_t> _last_bytes;
+};
+
+} // namespace cluster
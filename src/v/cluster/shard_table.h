@@ -12,6 +12,7 @@
 #pragma once
 
 #include "model/fundamental.h"
+#include "model/metadata.h"
 #include "raft/types.h"
 #include "seastarx.h"
 
@@ -19,6 +20,9 @@
 
 #include <absl/container/node_hash_map.h>
 
+#include <optional>
+#include <vector>
+
 namespace cluster {
 /// \brief this is populated by consensus::controller
 /// every core will have a _full_ copy of all indexes
@@ -29,6 +33,13 @@ class shard_table final {
     };
 
 public:
+    /// \brief shards of the partitions of a single topic indexed by
+    /// partition id, the topic name is hashed once to find them.
+    ///
+    /// A handle is only valid until the shard table is next updated, it must
+    /// not be kept across scheduling points
+    using topic_shards = std::vector<std::optional<shard_revision>>;
+
     bool contains(const raft::group_id& group) {
         return _group_idx.find(group) != _group_idx.end();
     }
@@ -40,16 +51,37 @@ public:
      * \brief Lookup the owning shard for an ntp.
      */
     std::optional<ss::shard_id> shard_for(const model::ntp& ntp) {
-        if (auto it = _ntp_idx.find(ntp); it != _ntp_idx.end()) {
-            return it->second.shard;
+        return shard_for(
+          find_topic(model::topic_namespace_view(ntp)), ntp.tp.partition);
+    }
+
+    /// Returns nullptr if no partition of the topic is present
+    const topic_shards* find_topic(model::topic_namespace_view tp_ns) const {
+        if (auto it = _ntp_idx.find(tp_ns); it != _ntp_idx.end()) {
+            return &it->second;
+        }
+        return nullptr;
+    }
+
+    /**
+     * \brief Lookup the owning shard of a partition of a topic found with
+     * find_topic.
+     */
+    static std::optional<ss::shard_id>
+    shard_for(const topic_shards* topic, model::partition_id pid) {
+        if (auto sr = find(topic, pid); sr) {
+            return sr->shard;
         }
         return std::nullopt;
     }
 
     bool insert(model::ntp ntp, ss::shard_id i, model::revision_id rev) {
-        auto [_, success] = _ntp_idx.insert(
-          {std::move(ntp), shard_revision{i, rev}});
-        return success;
+        auto& slot = slot_for(ntp);
+        if (slot) {
+            return false;
+        }
+        slot = shard_revision{i, rev};
+        return true;
     }
 
     bool insert(raft::group_id g, ss::shard_id i, model::revision_id rev) {
@@ -62,8 +94,8 @@ public:
       raft::group_id g,
       ss::shard_id shard,
       model::revision_id rev) {
-        if (auto it = _ntp_idx.find(ntp); it != _ntp_idx.end()) {
-            if (it->second.revision > rev) {
+        if (auto sr = find(ntp); sr) {
+            if (sr->revision > rev) {
                 return;
             }
         }
@@ -73,14 +105,14 @@ public:
             }
         }
 
-        _ntp_idx.insert_or_assign(ntp, shard_revision{shard, rev});
+        slot_for(ntp) = shard_revision{shard, rev};
         _group_idx.insert_or_assign(g, shard_revision{shard, rev});
     }
 
     void
     erase(const model::ntp& ntp, raft::group_id g, model::revision_id rev) {
-        if (auto it = _ntp_idx.find(ntp); it != _ntp_idx.end()) {
-            if (it->second.revision > rev) {
+        if (auto sr = find(ntp); sr) {
+            if (sr->revision > rev) {
                 return;
             }
         }
@@ -90,7 +122,7 @@ public:
             }
         }
 
-        _ntp_idx.erase(ntp);
+        erase_ntp(ntp);
         _group_idx.erase(g);
     }
 
@@ -110,8 +142,65 @@ private:
      * cluster::shard_table state isn't corrupted.
      */
 
-    // kafka index
-    absl::node_hash_map<model::ntp, shard_revision> _ntp_idx;
+    static const shard_revision*
+    find(const topic_shards* topic, model::partition_id pid) {
+        if (
+          !topic || pid < model::partition_id(0)
+          || static_cast<size_t>(pid()) >= topic->size()) {
+            return nullptr;
+        }
+        const auto& sr = (*topic)[pid()];
+        return sr ? &*sr : nullptr;
+    }
+
+    const shard_revision* find(const model::ntp& ntp) const {
+        return find(
+          find_topic(model::topic_namespace_view(ntp)), ntp.tp.partition);
+    }
+
+    std::optional<shard_revision>& slot_for(const model::ntp& ntp) {
+        auto it = _ntp_idx.find(model::topic_namespace_view(ntp));
+        if (it == _ntp_idx.end()) {
+            it = _ntp_idx
+                   .emplace(
+                     model::topic_namespace(ntp.ns, ntp.tp.topic),
+                     topic_shards{})
+                   .first;
+        }
+        auto& partitions = it->second;
+        const auto idx = static_cast<size_t>(ntp.tp.partition());
+        if (idx >= partitions.size()) {
+            partitions.resize(idx + 1);
+        }
+        return partitions[idx];
+    }
+
+    void erase_ntp(const model::ntp& ntp) {
+        auto it = _ntp_idx.find(model::topic_namespace_view(ntp));
+        if (it == _ntp_idx.end()) {
+            return;
+        }
+        auto& partitions = it->second;
+        const auto idx = static_cast<size_t>(ntp.tp.partition());
+        if (idx < partitions.size()) {
+            partitions[idx] = std::nullopt;
+        }
+        while (!partitions.empty() && !partitions.back()) {
+            partitions.pop_back();
+        }
+        if (partitions.empty()) {
+            _ntp_idx.erase(it);
+        }
+    }
+
+    // kafka index, partitions of a topic are dense so they are kept in a
+    // vector indexed by partition id under the topic
+    absl::node_hash_map<
+      model::topic_namespace,
+      topic_shards,
+      model::topic_namespace_hash,
+      model::topic_namespace_eq>
+      _ntp_idx;
     // raft index
     absl::node_hash_map<raft::group_id, shard_revision> _group_idx;
 };
@@ -7,6 +7,7 @@
 // the Business Source License, use of this software will be governed
 // by the Apache License, Version 2.0
 
+#include "cluster/partition_balancer.h"
 #include "cluster/tests/partition_allocator_tester.h"
 #include "raft/types.h"
 
@@ -14,6 +15,15 @@
 #include <seastar/core/sharded.hh>
 #include <seastar/testing/perf_tests.hh>
 
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <limits>
+#include <string_view>
+#include <utility>
+
 using namespace cluster; // NOLINT
 
 PERF_TEST_F(partition_allocator_tester, allocation_3) {
@@ -47,3 +57,250 @@ PERF_TEST_F(partition_allocator_tester, recovery) {
     pa.update_allocation_state(md, raft::group_id(partitions_per_topic));
     perf_tests::stop_measuring_time();
 }
+
+/**
+ * Scenarios over a realistic cluster shape: 100k partitions with three
+ * replicas over 30 nodes in 3 racks. Only the allocator and balancer work is
+ * measured, the skew of the resulting placement is printed once per
+ * scenario so that allocation strategies can be compared.
+ */
+struct cluster_shape {
+    static constexpr uint32_t nodes = 30;
+    static constexpr uint32_t racks = 3;
+    static constexpr uint32_t cpus = 16;
+    static constexpr int topics = 1000;
+    static constexpr int partitions_per_topic = 100;
+    static constexpr int16_t replication_factor = 3;
+    static constexpr size_t max_rebalance_moves = 500;
+
+    cluster_shape()
+      : pa(raft::group_id(0)) {
+        for (uint32_t i = 0; i < nodes; ++i) {
+            add_node(model::node_id(i));
+        }
+    }
+
+    void add_node(model::node_id id) {
+        pa.register_node(std::make_unique<allocation_node>(
+          id,
+          cpus,
+          std::unordered_map<ss::sstring, ss::sstring>{
+            {"rack", fmt::format("rack-{}", id() % racks)}}));
+        node_ids.push_back(id);
+    }
+
+    using units_t = std::vector<partition_allocator::allocation_units>;
+
+    /// allocates every topic the way topics_frontend does, the returned
+    /// units hold the allocations until commit()
+    units_t allocate_all() {
+        units_t units;
+        units.reserve(topics);
+        for (int t = 0; t < topics; ++t) {
+            topic_configuration cfg(
+              model::ns("test_ns"),
+              model::topic(fmt::format("topic-{}", t)),
+              partitions_per_topic,
+              replication_factor);
+            auto u = pa.allocate(cfg);
+            vassert(u, "unable to allocate topic {}", cfg.tp_ns);
+            model::topic_metadata md(cfg.tp_ns);
+            for (const auto& a : u->get_assignments()) {
+                model::partition_metadata p_md(a.id);
+                p_md.replicas = a.replicas;
+                md.partitions.push_back(std::move(p_md));
+                partitions.push_back(balancer_partition{
+                  .ntp = model::ntp(cfg.tp_ns.ns, cfg.tp_ns.tp, a.id),
+                  .replicas = a.replicas});
+                highest_group = std::max(highest_group, a.group);
+            }
+            _committed.push_back(std::move(md));
+            units.push_back(std::move(*u));
+        }
+        return units;
+    }
+
+    /// releases the allocation units and applies the placement as committed
+    /// state, as the controller does once the topics are created
+    void commit(units_t units) {
+        units.clear();
+        pa.update_allocation_state(std::move(_committed), highest_group);
+    }
+
+    void allocate_and_commit() { commit(allocate_all()); }
+
+    void move_replica(
+      balancer_partition& p, model::node_id from, model::node_id to) {
+        auto it = std::find_if(
+          p.replicas.begin(),
+          p.replicas.end(),
+          [from](const model::broker_shard& bs) { return bs.node_id == from; });
+        vassert(it != p.replicas.end(), "{} has no replica on {}", p.ntp, from);
+        auto core = pa.least_allocated_core(to);
+        vassert(core, "node {} is full", to);
+        pa.deallocate(*it);
+        *it = model::broker_shard{.node_id = to, .shard = *core};
+        pa.update_allocation_state(
+          std::vector<model::broker_shard>{*it}, highest_group);
+    }
+
+    /// moves every replica of the node to the node with the fewest replicas
+    /// that does not host the partition yet
+    size_t drain(model::node_id id) {
+        auto counts = replica_counts();
+        size_t moved = 0;
+        for (auto& p : partitions) {
+            auto on_node = [&p](model::node_id n) {
+                return std::any_of(
+                  p.replicas.begin(),
+                  p.replicas.end(),
+                  [n](const model::broker_shard& bs) {
+                      return bs.node_id == n;
+                  });
+            };
+            if (!on_node(id)) {
+                continue;
+            }
+            std::optional<model::node_id> target;
+            for (auto n : node_ids) {
+                if (n == id || on_node(n)) {
+                    continue;
+                }
+                if (!target || counts[n] < counts[*target]) {
+                    target = n;
+                }
+            }
+            vassert(target, "no target to drain {} to", p.ntp);
+            move_replica(p, id, *target);
+            --counts[id];
+            ++counts[*target];
+            ++moved;
+        }
+        node_ids.erase(std::find(node_ids.begin(), node_ids.end(), id));
+        return moved;
+    }
+
+    /// replica moves planned by the partition balancer
+    size_t rebalance() {
+        std::vector<balancer_node> bn;
+        bn.reserve(node_ids.size());
+        for (auto n : node_ids) {
+            bn.push_back(balancer_node{.id = n});
+        }
+        size_t moved = 0;
+        while (moved < max_rebalance_moves) {
+            auto move = plan_replica_move(partitions, bn);
+            if (!move) {
+                break;
+            }
+            auto it = std::find_if(
+              partitions.begin(),
+              partitions.end(),
+              [&move](const balancer_partition& p) {
+                  return p.ntp == move->ntp;
+              });
+            move_replica(*it, move->from, move->to);
+            ++moved;
+        }
+        return moved;
+    }
+
+    absl::flat_hash_map<model::node_id, size_t> replica_counts() const {
+        absl::flat_hash_map<model::node_id, size_t> counts;
+        for (auto n : node_ids) {
+            counts[n] = 0;
+        }
+        for (const auto& p : partitions) {
+            for (const auto& bs : p.replicas) {
+                ++counts[bs.node_id];
+            }
+        }
+        return counts;
+    }
+
+    void print_skew(std::string_view scenario, size_t moves) const {
+        auto counts = replica_counts();
+        size_t max = 0;
+        size_t min = std::numeric_limits<size_t>::max();
+        size_t total = 0;
+        for (const auto& [_, c] : counts) {
+            max = std::max(max, c);
+            min = std::min(min, c);
+            total += c;
+        }
+        const double avg = double(total) / counts.size();
+
+        // partitions that could span more racks than they do
+        size_t rack_collisions = 0;
+        const auto wanted_racks = std::min<size_t>(replication_factor, racks);
+        for (const auto& p : partitions) {
+            absl::flat_hash_set<int32_t> in_racks;
+            for (const auto& bs : p.replicas) {
+                in_racks.insert(bs.node_id() % racks);
+            }
+            rack_collisions += in_racks.size() < wanted_racks ? 1 : 0;
+        }
+
+        fmt::print(
+          "{}: {} nodes, replicas per node avg {:.0f} max/avg {:.3f} min/avg "
+          "{:.3f}, partitions with replicas sharing a rack {:.2f}%, replica "
+          "moves {}\n",
+          scenario,
+          counts.size(),
+          avg,
+          max / avg,
+          min / avg,
+          100.0 * rack_collisions / partitions.size(),
+          moves);
+    }
+
+    partition_allocator pa;
+    std::vector<model::node_id> node_ids;
+    std::vector<balancer_partition> partitions;
+    raft::group_id highest_group{0};
+
+private:
+    std::vector<model::topic_metadata> _committed;
+};
+
+/// prints the skew of the first run of a scenario only
+static void print_skew_once(
+  bool& printed,
+  std::string_view scenario,
+  const cluster_shape& c,
+  size_t moves = 0) {
+    if (!std::exchange(printed, true)) {
+        c.print_skew(scenario, moves);
+    }
+}
+
+PERF_TEST(allocator_scenarios, allocate_100k_partitions_30_nodes) {
+    static bool printed = false;
+    cluster_shape c;
+    perf_tests::start_measuring_time();
+    auto units = c.allocate_all();
+    perf_tests::stop_measuring_time();
+    c.commit(std::move(units));
+    print_skew_once(printed, "allocate", c);
+}
+
+PERF_TEST(allocator_scenarios, decommission_node) {
+    static bool printed = false;
+    cluster_shape c;
+    c.allocate_and_commit();
+    perf_tests::start_measuring_time();
+    auto moves = c.drain(model::node_id(0));
+    perf_tests::stop_measuring_time();
+    print_skew_once(printed, "decommission", c, moves);
+}
+
+PERF_TEST(allocator_scenarios, add_node_and_rebalance) {
+    static bool printed = false;
+    cluster_shape c;
+    c.allocate_and_commit();
+    c.add_node(model::node_id(cluster_shape::nodes));
+    perf_tests::start_measuring_time();
+    auto moves = c.rebalance();
+    perf_tests::stop_measuring_time();
+    print_skew_once(printed, "add node and rebalance", c, moves);
+}
@@ -76,3 +76,19 @@ SEASTAR_THREAD_TEST_CASE(test_has_local_replicas) {
     BOOST_REQUIRE_EQUAL(cluster::has_local_replicas(id, replicas_1), false);
     BOOST_REQUIRE_EQUAL(cluster::has_local_replicas(id, replicas_2), true);
 }
+
+SEASTAR_THREAD_TEST_CASE(test_has_local_replicas_with_shard_override) {
+    auto self = model::node_id(1);
+    auto other_shard = ss::this_shard_id() + 1;
+    std::vector<model::broker_shard> replicas{
+      model::broker_shard{.node_id = self, .shard = other_shard},
+      model::broker_shard{.node_id = model::node_id(2), .shard = 0},
+    };
+
+    BOOST_REQUIRE(!cluster::has_local_replicas(self, replicas));
+    BOOST_REQUIRE(
+      cluster::has_local_replicas(self, replicas, ss::this_shard_id()));
+    // override is only applied to the replica of this node
+    BOOST_REQUIRE(!cluster::has_local_replicas(
+      model::node_id(3), replicas, ss::this_shard_id()));
+}
@@ -146,3 +146,32 @@ FIXTURE_TEST(test_move_partition_replicass_command, cmd_test_fixture) {
         }
     });
 }
+
+FIXTURE_TEST(test_topic_configuration_storage_mode, cmd_test_fixture) {
+    cluster::topic_configuration cfg(test_ns, model::topic("tp"), 2, 3);
+    cfg.properties.storage_mode = model::storage_mode::memory;
+    auto deser = reflection::from_iobuf<cluster::topic_configuration>(
+      reflection::to_iobuf(cluster::topic_configuration(cfg)));
+    BOOST_REQUIRE_EQUAL(deser.tp_ns, cfg.tp_ns);
+    BOOST_REQUIRE(deser.properties.storage_mode == cfg.properties.storage_mode);
+
+    // the format before the version, without the storage mode
+    iobuf unversioned;
+    reflection::serialize(
+      unversioned,
+      cfg.tp_ns,
+      cfg.partition_count,
+      cfg.replication_factor,
+      cfg.properties.compression,
+      cfg.properties.cleanup_policy_bitflags,
+      cfg.properties.compaction_strategy,
+      cfg.properties.timestamp_type,
+      cfg.properties.segment_size,
+      cfg.properties.retention_bytes,
+      cfg.properties.retention_duration);
+    auto old = reflection::from_iobuf<cluster::topic_configuration>(
+      std::move(unversioned));
+    BOOST_REQUIRE_EQUAL(old.tp_ns, cfg.tp_ns);
+    BOOST_REQUIRE_EQUAL(old.partition_count, cfg.partition_count);
+    BOOST_REQUIRE(!old.properties.storage_mode);
+}
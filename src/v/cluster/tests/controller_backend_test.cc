@@ -209,3 +209,29 @@ SEASTAR_THREAD_TEST_CASE(move_back_to_current_node_not_finished) {
     BOOST_REQUIRE_EQUAL(deltas.size(), 1);
     BOOST_REQUIRE_EQUAL(deltas[0].offset, update_with_current_2.offset);
 }
+
+SEASTAR_THREAD_TEST_CASE(coalesce_drops_additions_deleted_later) {
+    deltas_t deltas{
+      delete_current,
+      recreate_current,
+      update_with_current,
+      finish_update_with_current,
+      final_delete,
+      recreate_different};
+
+    cluster::coalesce_deltas(deltas);
+
+    BOOST_REQUIRE_EQUAL(deltas.size(), 3);
+    BOOST_REQUIRE_EQUAL(deltas[0].offset, delete_current.offset);
+    BOOST_REQUIRE_EQUAL(deltas[1].offset, final_delete.offset);
+    BOOST_REQUIRE_EQUAL(deltas[2].offset, recreate_different.offset);
+}
+
+SEASTAR_THREAD_TEST_CASE(coalesce_keeps_deltas_without_deletion) {
+    deltas_t deltas{
+      add_current, update_with_current, finish_update_with_current};
+
+    cluster::coalesce_deltas(deltas);
+
+    BOOST_REQUIRE_EQUAL(deltas.size(), 3);
+}
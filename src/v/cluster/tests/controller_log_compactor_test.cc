@@ -0,0 +1,160 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "cluster/commands.h"
+#include "cluster/controller_log_compactor.h"
+#include "cluster/types.h"
+#include "model/fundamental.h"
+#include "model/metadata.h"
+#include "model/namespace.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+#include <vector>
+
+namespace {
+
+model::topic_namespace make_tp_ns(const ss::sstring& tp) {
+    return model::topic_namespace(model::kafka_namespace, model::topic(tp));
+}
+
+template<typename Cmd>
+model::record_batch at(int64_t offset, Cmd cmd) {
+    auto b = cluster::serialize_cmd(std::move(cmd)).get0();
+    b.header().base_offset = model::offset(offset);
+    return b;
+}
+
+model::record_batch create_topic(int64_t offset, const ss::sstring& tp) {
+    return at(
+      offset,
+      cluster::create_topic_cmd(
+        make_tp_ns(tp),
+        cluster::topic_configuration_assignment(
+          cluster::topic_configuration(
+            model::kafka_namespace, model::topic(tp), 1, 1),
+          {})));
+}
+
+model::record_batch
+create_topics(int64_t offset, const std::vector<ss::sstring>& names) {
+    std::vector<cluster::topic_configuration_assignment> topics;
+    for (const auto& tp : names) {
+        topics.emplace_back(
+          cluster::topic_configuration(
+            model::kafka_namespace, model::topic(tp), 1, 1),
+          std::vector<cluster::partition_assignment>{});
+    }
+    return at(offset, cluster::create_topics_cmd(std::move(topics), 0));
+}
+
+model::record_batch delete_topic(int64_t offset, const ss::sstring& tp) {
+    return at(
+      offset, cluster::delete_topic_cmd(make_tp_ns(tp), make_tp_ns(tp)));
+}
+
+model::record_batch move_partition(int64_t offset, const ss::sstring& tp) {
+    return at(
+      offset,
+      cluster::move_partition_replicas_cmd(
+        model::ntp(
+          model::kafka_namespace, model::topic(tp), model::partition_id(0)),
+        std::vector<model::broker_shard>{}));
+}
+
+template<typename Cmd>
+model::record_batch user_cmd(int64_t offset, const ss::sstring& name) {
+    return at(
+      offset,
+      Cmd(security::credential_user(name), typename Cmd::value_t{}));
+}
+
+std::vector<int64_t> offsets(std::vector<model::record_batch> batches) {
+    std::vector<int64_t> ret;
+    ret.reserve(batches.size());
+    for (const auto& b : batches) {
+        ret.push_back(b.base_offset()());
+    }
+    return ret;
+}
+
+} // namespace
+
+SEASTAR_THREAD_TEST_CASE(deleted_topic_leaves_only_its_delete) {
+    cluster::controller_log_compactor c;
+    c.add(create_topic(0, "a"));
+    c.add(create_topic(1, "b"));
+    c.add(move_partition(2, "a"));
+    c.add(delete_topic(3, "a"));
+    c.add(move_partition(4, "b"));
+    // fails when applied, the topic exists
+    c.add(create_topic(5, "b"));
+
+    BOOST_REQUIRE(
+      offsets(std::move(c).release()) == std::vector<int64_t>({1, 3, 4}));
+}
+
+SEASTAR_THREAD_TEST_CASE(recreated_topic_keeps_delete_before_create) {
+    cluster::controller_log_compactor c;
+    c.add(create_topic(0, "a"));
+    c.add(delete_topic(1, "a"));
+    c.add(create_topic(2, "a"));
+    c.add(delete_topic(3, "a"));
+    c.add(create_topic(4, "a"));
+    // updates of a topic that does not exist fail when applied
+    c.add(move_partition(5, "b"));
+
+    BOOST_REQUIRE(
+      offsets(std::move(c).release()) == std::vector<int64_t>({3, 4}));
+}
+
+SEASTAR_THREAD_TEST_CASE(keeps_latest_user_update) {
+    cluster::controller_log_compactor c;
+    c.add(user_cmd<cluster::create_user_cmd>(0, "u"));
+    c.add(user_cmd<cluster::update_user_cmd>(1, "u"));
+    c.add(user_cmd<cluster::update_user_cmd>(2, "u"));
+    c.add(user_cmd<cluster::create_user_cmd>(3, "v"));
+    c.add(user_cmd<cluster::delete_user_cmd>(4, "v"));
+    c.add(user_cmd<cluster::update_user_cmd>(5, "u"));
+
+    BOOST_REQUIRE(
+      offsets(std::move(c).release()) == std::vector<int64_t>({0, 4, 5}));
+}
+
+SEASTAR_THREAD_TEST_CASE(compacting_twice_is_stable) {
+    cluster::controller_log_compactor first;
+    first.add(create_topic(0, "a"));
+    first.add(user_cmd<cluster::create_user_cmd>(1, "u"));
+    first.add(delete_topic(2, "a"));
+    first.add(create_topic(3, "b"));
+    first.add(user_cmd<cluster::update_user_cmd>(4, "u"));
+    auto compacted = std::move(first).release();
+
+    cluster::controller_log_compactor second;
+    for (auto& b : compacted) {
+        second.add(std::move(b));
+    }
+    second.add(user_cmd<cluster::update_user_cmd>(5, "u"));
+
+    BOOST_REQUIRE(
+      offsets(std::move(second).release())
+      == std::vector<int64_t>({1, 2, 3, 5}));
+}
+
+SEASTAR_THREAD_TEST_CASE(splits_batched_topic_creation) {
+    cluster::controller_log_compactor c;
+    c.add(create_topic(0, "a"));
+    // creates none of the topics as one of them exists
+    c.add(create_topics(1, {"b", "a"}));
+    c.add(create_topics(2, {"b", "c"}));
+    c.add(delete_topic(3, "c"));
+
+    BOOST_REQUIRE(
+      offsets(std::move(c).release()) == std::vector<int64_t>({0, 2, 3}));
+}
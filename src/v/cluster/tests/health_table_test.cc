@@ -0,0 +1,68 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "cluster/health_table.h"
+#include "cluster/tests/ntp_utils.h"
+#include "model/fundamental.h"
+#include "model/namespace.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+using namespace std::chrono_literals; // NOLINT
+
+static cluster::node_load_report
+make_report(int node, std::vector<int> partitions, bool leader) {
+    cluster::node_load_report r{.node = model::node_id(node)};
+    cluster::topic_status t{
+      .tp_ns = model::topic_namespace(
+        model::kafka_namespace, model::topic("tp"))};
+    for (auto p : partitions) {
+        t.partitions.push_back(cluster::partition_status{
+          .id = model::partition_id(p),
+          .leader = leader,
+          .size_bytes = 100 * static_cast<uint64_t>(p)});
+    }
+    r.topics.push_back(std::move(t));
+    return r;
+}
+
+SEASTAR_THREAD_TEST_CASE(finds_replicas_of_partition_on_all_nodes) {
+    cluster::health_table ht;
+    const auto expires = ss::lowres_clock::now() + 1h;
+    ht.update(make_report(1, {2, 0, 1}, true), expires);
+    ht.update(make_report(2, {1, 2}, false), expires);
+
+    auto replicas = ht.get_partition(make_ntp(2));
+    BOOST_REQUIRE_EQUAL(replicas.size(), 2);
+    for (const auto& r : replicas) {
+        BOOST_REQUIRE_EQUAL(r.status.size_bytes, 200);
+        BOOST_REQUIRE_EQUAL(r.status.leader, r.node == model::node_id(1));
+    }
+    BOOST_REQUIRE_EQUAL(ht.get_partition(make_ntp(0)).size(), 1);
+    BOOST_REQUIRE(ht.get_partition(make_ntp(3)).empty());
+    BOOST_REQUIRE(ht.get_node(model::node_id(2)));
+    BOOST_REQUIRE(!ht.get_node(model::node_id(3)));
+    BOOST_REQUIRE_EQUAL(ht.all_reports().size(), 2);
+}
+
+SEASTAR_THREAD_TEST_CASE(ignores_expired_reports) {
+    cluster::health_table ht;
+    ht.update(make_report(1, {0}, true), ss::lowres_clock::now() - 1s);
+    ht.update(make_report(2, {0}, false), ss::lowres_clock::now() + 1h);
+
+    BOOST_REQUIRE(!ht.get_node(model::node_id(1)));
+    auto replicas = ht.get_partition(make_ntp(0));
+    BOOST_REQUIRE_EQUAL(replicas.size(), 1);
+    BOOST_REQUIRE_EQUAL(replicas[0].node, model::node_id(2));
+    BOOST_REQUIRE_EQUAL(ht.all_reports().size(), 1);
+
+    // a newer report replaces the expired one
+    ht.update(make_report(1, {0}, true), ss::lowres_clock::now() + 1h);
+    BOOST_REQUIRE_EQUAL(ht.get_partition(make_ntp(0)).size(), 2);
+}
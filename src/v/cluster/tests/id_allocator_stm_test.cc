@@ -102,3 +102,32 @@ FIXTURE_TEST(stm_restart_test, mux_state_machine_fixture) {
     }
     stm2.stop().get0();
 }
+
+FIXTURE_TEST(stm_range_allocation_test, mux_state_machine_fixture) {
+    start_raft();
+
+    config::configuration cfg;
+    cfg.id_allocator_batch_size.set_value(int16_t(10));
+    cfg.id_allocator_log_capacity.set_value(int16_t(100));
+
+    cluster::id_allocator_stm stm(idstmlog, _raft.get(), cfg);
+
+    stm.start().get0();
+    auto stop = ss::defer([&stm] { stm.stop().get0(); });
+
+    wait_for_leader();
+
+    // ranges never overlap, whether they fit into a batch or not
+    int64_t next_free = 0;
+    for (int64_t count : {1, 4, 25, 3, 10}) {
+        auto result = stm
+                        .allocate_id_and_wait(
+                          model::timeout_clock::now() + 1s, count)
+                        .get0();
+
+        BOOST_REQUIRE_EQUAL(raft::errc::success, result.raft_status);
+        BOOST_REQUIRE_LE(next_free, result.id);
+
+        next_free = result.id + count;
+    }
+}
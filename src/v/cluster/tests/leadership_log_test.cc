@@ -0,0 +1,60 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "cluster/leadership_log.h"
+#include "model/fundamental.h"
+#include "model/namespace.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+static cluster::ntp_leader make_leader(int p, int64_t term) {
+    return cluster::ntp_leader{
+      .ntp = model::ntp(
+        model::kafka_namespace, model::topic("tp"), model::partition_id(p)),
+      .term = model::term_id(term),
+      .leader_id = model::node_id(1)};
+}
+
+SEASTAR_THREAD_TEST_CASE(returns_latest_change_of_every_partition) {
+    cluster::leadership_log log(10);
+    log.append(make_leader(0, 1));
+    log.append(make_leader(1, 1));
+    const auto seen = log.version();
+    log.append(make_leader(0, 2));
+    log.append(make_leader(2, 1));
+    log.append(make_leader(0, 3));
+
+    auto changes = log.changes_since(log.incarnation(), seen);
+    BOOST_REQUIRE(changes);
+    BOOST_REQUIRE_EQUAL(changes->size(), 2);
+    BOOST_REQUIRE_EQUAL(changes->at(0).ntp, make_leader(2, 1).ntp);
+    BOOST_REQUIRE_EQUAL(changes->at(1).ntp, make_leader(0, 3).ntp);
+    BOOST_REQUIRE_EQUAL(changes->at(1).term, model::term_id(3));
+
+    // nothing changed since the latest version
+    auto none = log.changes_since(log.incarnation(), log.version());
+    BOOST_REQUIRE(none);
+    BOOST_REQUIRE(none->empty());
+}
+
+SEASTAR_THREAD_TEST_CASE(falls_back_to_snapshot) {
+    cluster::leadership_log log(2);
+    for (int p = 0; p < 4; ++p) {
+        log.append(make_leader(p, 1));
+    }
+    BOOST_REQUIRE_EQUAL(log.size(), 2);
+    BOOST_REQUIRE(log.changes_since(log.incarnation(), 2));
+    // the changes after version 1 were dropped
+    BOOST_REQUIRE(!log.changes_since(log.incarnation(), 1));
+    // the peer saw a previous incarnation or never read the log
+    BOOST_REQUIRE(!log.changes_since(log.incarnation() + 1, 4));
+    BOOST_REQUIRE(!log.changes_since(0, 0));
+    // versions from the future
+    BOOST_REQUIRE(!log.changes_since(log.incarnation(), 5));
+}
@@ -0,0 +1,20 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+#include "model/fundamental.h"
+#include "model/namespace.h"
+
+/// \brief partition \p p of the kafka topic the unit tests share
+inline model::ntp make_ntp(int p) {
+    return model::ntp(
+      model::kafka_namespace, model::topic("tp"), model::partition_id(p));
+}
@@ -11,8 +11,10 @@
 #include "cluster/tests/partition_allocator_tester.h"
 #include "raft/types.h"
 #include "test_utils/fixture.h"
+#include "units.h"
 
 using namespace cluster; // NOLINT
+using namespace std::chrono_literals; // NOLINT
 
 uint allocated_nodes_count(const std::vector<partition_assignment>& allocs) {
     return std::accumulate(
@@ -197,4 +199,45 @@ FIXTURE_TEST(allocation_units_test, partition_allocator_tester) {
       machines().at(model::node_id(2))->partition_capacity(), max);
     // we do not decrement the highest raft group
     BOOST_REQUIRE_EQUAL(highest_group()(), partitions);
-}
\ No newline at end of file
+}
+FIXTURE_TEST(load_aware_allocation, partition_allocator_tester) {
+    using ts = partition_allocator_tester;
+    auto existing = pa.allocate(gen_topic_configuration(30, ts::max_nodes));
+    BOOST_REQUIRE(existing);
+
+    auto report = [this](model::node_id id, uint64_t rate, uint64_t free) {
+        node_load_report r{
+          .node = id, .disk_free_bytes = free, .disk_total_bytes = 100};
+        r.cores.resize(
+          ts::cpus_per_node, core_load{.produce_bytes_rate = rate});
+        pa.update_node_load(r, ss::lowres_clock::now() + 1h);
+    };
+    // node 0 is busy and node 2 is almost out of disk space
+    report(model::node_id(0), 10_MiB, 90);
+    report(model::node_id(1), 0, 90);
+    report(model::node_id(2), 0, 5);
+
+    auto allocs = pa.allocate(gen_topic_configuration(10, 1)).value();
+    for (auto& a : allocs.get_assignments()) {
+        BOOST_REQUIRE_EQUAL(a.replicas.size(), 1);
+        BOOST_REQUIRE_EQUAL(a.replicas[0].node_id, model::node_id(1));
+    }
+}
+
+FIXTURE_TEST(expired_load_is_ignored, partition_allocator_tester) {
+    using ts = partition_allocator_tester;
+    for (uint32_t i = 0; i < ts::max_nodes; ++i) {
+        node_load_report r{.node = model::node_id(i)};
+        r.cores.resize(
+          ts::cpus_per_node, core_load{.produce_bytes_rate = i == 0 ? 1 : 0});
+        pa.update_node_load(r, ss::lowres_clock::now() - 1s);
+    }
+    auto allocs = pa.allocate(gen_topic_configuration(9, 1)).value();
+    std::map<model::node_id, int> node_assignment;
+    for (auto& a : allocs.get_assignments()) {
+        node_assignment[a.replicas[0].node_id]++;
+    }
+    for (auto& p : node_assignment) {
+        BOOST_REQUIRE_EQUAL(p.second, 3);
+    }
+}
@@ -0,0 +1,121 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "cluster/partition_balancer.h"
+#include "cluster/tests/ntp_utils.h"
+#include "model/fundamental.h"
+#include "model/namespace.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+#include <map>
+
+static cluster::balancer_partition
+make_partition(int p, std::vector<int> replicas, int leader) {
+    cluster::balancer_partition ret{
+      .ntp = make_ntp(p), .leader = model::node_id(leader)};
+    for (auto r : replicas) {
+        ret.replicas.push_back(
+          model::broker_shard{.node_id = model::node_id(r), .shard = 0});
+    }
+    return ret;
+}
+
+static std::vector<cluster::balancer_node> make_nodes(int count) {
+    std::vector<cluster::balancer_node> ret;
+    for (int i = 0; i < count; ++i) {
+        ret.push_back(cluster::balancer_node{.id = model::node_id(i)});
+    }
+    return ret;
+}
+
+SEASTAR_THREAD_TEST_CASE(balanced_leaders_are_left_alone) {
+    std::vector<cluster::balancer_partition> partitions{
+      make_partition(0, {0, 1, 2}, 0),
+      make_partition(1, {0, 1, 2}, 1),
+      make_partition(2, {0, 1, 2}, 2),
+      make_partition(3, {0, 1, 2}, 0),
+    };
+    BOOST_REQUIRE(
+      cluster::plan_leadership_transfers(partitions, make_nodes(3), 10)
+        .empty());
+}
+
+SEASTAR_THREAD_TEST_CASE(leaders_are_spread_after_restart) {
+    // every leader ended up on node 0
+    std::vector<cluster::balancer_partition> partitions;
+    for (int p = 0; p < 6; ++p) {
+        partitions.push_back(make_partition(p, {0, 1, 2}, 0));
+    }
+    auto transfers = cluster::plan_leadership_transfers(
+      partitions, make_nodes(3), 10);
+    BOOST_REQUIRE_EQUAL(transfers.size(), 4);
+    std::map<model::node_id, int> targets;
+    for (auto& t : transfers) {
+        BOOST_REQUIRE_EQUAL(t.from, model::node_id(0));
+        targets[t.to]++;
+    }
+    BOOST_REQUIRE_EQUAL(targets[model::node_id(1)], 2);
+    BOOST_REQUIRE_EQUAL(targets[model::node_id(2)], 2);
+
+    // the number of transfers is limited
+    BOOST_REQUIRE_EQUAL(
+      cluster::plan_leadership_transfers(partitions, make_nodes(3), 1).size(),
+      1);
+}
+
+SEASTAR_THREAD_TEST_CASE(leaders_move_to_replicas_only) {
+    // node 2 has no replicas of the partitions led by node 0
+    std::vector<cluster::balancer_partition> partitions{
+      make_partition(0, {0, 1}, 0),
+      make_partition(1, {0, 1}, 0),
+      make_partition(2, {0, 1}, 0),
+      make_partition(3, {2}, 2),
+    };
+    auto transfers = cluster::plan_leadership_transfers(
+      partitions, make_nodes(3), 10);
+    BOOST_REQUIRE_EQUAL(transfers.size(), 1);
+    BOOST_REQUIRE_EQUAL(transfers[0].to, model::node_id(1));
+}
+
+SEASTAR_THREAD_TEST_CASE(replicas_move_to_the_emptiest_node) {
+    // node 3 joined the cluster and has no replicas yet
+    std::vector<cluster::balancer_partition> partitions;
+    for (int p = 0; p < 4; ++p) {
+        partitions.push_back(make_partition(p, {0, 1, 2}, p % 3));
+    }
+    auto move = cluster::plan_replica_move(partitions, make_nodes(4));
+    BOOST_REQUIRE(move);
+    BOOST_REQUIRE_EQUAL(move->to, model::node_id(3));
+    // a follower replica is moved
+    auto& p = partitions[move->ntp.tp.partition()];
+    BOOST_REQUIRE(p.leader != move->from);
+}
+
+SEASTAR_THREAD_TEST_CASE(replicas_move_away_from_busy_node) {
+    std::vector<cluster::balancer_partition> partitions{
+      make_partition(0, {0}, 0),
+      make_partition(1, {1}, 1),
+      make_partition(2, {0}, 0),
+      make_partition(3, {1}, 1),
+    };
+    auto nodes = make_nodes(3);
+    // even counts without traffic reports stay where they are
+    partitions.push_back(make_partition(4, {2}, 2));
+    partitions.push_back(make_partition(5, {2}, 2));
+    BOOST_REQUIRE(!cluster::plan_replica_move(partitions, nodes));
+
+    nodes[0].bytes_rate = 1000;
+    nodes[1].bytes_rate = 100;
+    nodes[2].bytes_rate = 10;
+    auto move = cluster::plan_replica_move(partitions, nodes);
+    BOOST_REQUIRE(move);
+    BOOST_REQUIRE_EQUAL(move->from, model::node_id(0));
+    BOOST_REQUIRE_EQUAL(move->to, model::node_id(2));
+}
@@ -23,6 +23,7 @@
 #include "storage/tests/utils/random_batch.h"
 #include "test_utils/async.h"
 
+#include <seastar/core/when_all.hh>
 #include <seastar/util/defer.hh>
 
 #include <system_error>
@@ -183,6 +184,12 @@ FIXTURE_TEST(test_tx_aborted_tx_1, mux_state_machine_fixture) {
           return x.pid == pid2;
       }));
 
+    // only the fetches reading the aborted range get it
+    aborted_txs = stm.aborted_transactions(min_offset, first_offset).get0();
+    BOOST_REQUIRE_EQUAL(aborted_txs.size(), 0);
+    aborted_txs = stm.aborted_transactions(tx_offset, tx_offset).get0();
+    BOOST_REQUIRE_EQUAL(aborted_txs.size(), 1);
+
     BOOST_REQUIRE_LT(tx_offset, stm.last_stable_offset());
 }
 
@@ -381,3 +388,116 @@ FIXTURE_TEST(test_tx_post_aborted_produce, mux_state_machine_fixture) {
                  .get0();
     BOOST_REQUIRE(offset_r == invalid_producer_epoch);
 }
+
+SEASTAR_THREAD_TEST_CASE(test_seq_entries_columns) {
+    cluster::rm_stm::seq_entries entries;
+    for (int64_t i = 0; i < 1000; ++i) {
+        entries.push_back(cluster::rm_stm::seq_entry{
+          .pid = model::producer_identity{.id = 1000 + i * 3, .epoch = 2},
+          .seq = random_generators::get_int<int32_t>(),
+          .last_write_timestamp = model::timestamp::now().value() - i});
+    }
+
+    iobuf buf;
+    cluster::rm_stm::write_seq_entries(entries, buf).get();
+    // varints of small deltas instead of the fixed width entries
+    BOOST_REQUIRE_LT(buf.size_bytes(), entries.size() * 12);
+
+    iobuf_parser in(std::move(buf));
+    auto decoded = cluster::rm_stm::read_seq_entries(in);
+    BOOST_REQUIRE_EQUAL(decoded.size(), entries.size());
+    BOOST_REQUIRE_EQUAL(in.bytes_left(), 0);
+    auto it = decoded.begin();
+    for (const auto& e : entries) {
+        BOOST_REQUIRE_EQUAL(it->pid, e.pid);
+        BOOST_REQUIRE_EQUAL(it->seq, e.seq);
+        BOOST_REQUIRE_EQUAL(it->last_write_timestamp, e.last_write_timestamp);
+        ++it;
+    }
+}
+
+// tests:
+//   - the abort markers of concurrent txes share one replicate call and
+//     every tx is reflected in aborted_transactions
+FIXTURE_TEST(test_tx_concurrent_aborts, mux_state_machine_fixture) {
+    start_raft();
+
+    cluster::rm_stm stm(logger, _raft.get());
+
+    stm.start().get0();
+    auto stop = ss::defer([&stm] { stm.stop().get0(); });
+
+    wait_for_leader();
+    wait_for_meta_initialized();
+
+    auto min_offset = model::offset(0);
+    auto max_offset = model::offset(std::numeric_limits<int64_t>::max());
+
+    std::vector<model::producer_identity> pids;
+    for (int64_t id = 1; id <= 3; ++id) {
+        auto pid = model::producer_identity{.id = id, .epoch = 0};
+        BOOST_REQUIRE((bool)stm.begin_tx(pid).get0());
+        auto rreader = make_rreader(pid, 0, 5, true);
+        auto offset_r = stm
+                          .replicate(
+                            rreader.id,
+                            std::move(rreader.reader),
+                            raft::replicate_options(
+                              raft::consistency_level::quorum_ack))
+                          .get0();
+        BOOST_REQUIRE((bool)offset_r);
+        pids.push_back(pid);
+    }
+
+    std::vector<ss::future<cluster::tx_errc>> aborts;
+    for (auto pid : pids) {
+        aborts.push_back(stm.abort_tx(pid, 2'000ms));
+    }
+    for (auto& op : ss::when_all_succeed(aborts.begin(), aborts.end()).get0()) {
+        BOOST_REQUIRE_EQUAL(op, cluster::tx_errc::none);
+    }
+    BOOST_REQUIRE(
+      stm.wait_no_throw(_raft.get()->committed_offset(), 2'000ms).get0());
+
+    auto aborted_txs = stm.aborted_transactions(min_offset, max_offset).get0();
+    BOOST_REQUIRE_EQUAL(aborted_txs.size(), pids.size());
+}
+
+// tests:
+//   - the seq table keeps the writes made while a snapshot encodes it
+FIXTURE_TEST(test_seq_writes_during_snapshot, mux_state_machine_fixture) {
+    start_raft();
+
+    cluster::rm_stm stm(logger, _raft.get());
+
+    stm.start().get0();
+    auto stop = ss::defer([&stm] { stm.stop().get0(); });
+
+    wait_for_leader();
+    wait_for_meta_initialized();
+
+    auto produce = [&stm](model::producer_identity pid, int first_seq) {
+        auto rreader = make_rreader(pid, first_seq, 5, false);
+        return stm
+          .replicate(
+            rreader.id,
+            std::move(rreader.reader),
+            raft::replicate_options(raft::consistency_level::quorum_ack))
+          .get0();
+    };
+
+    auto old_pid = model::producer_identity{.id = 1, .epoch = 0};
+    BOOST_REQUIRE((bool)produce(old_pid, 0));
+
+    auto snapshot = stm.make_snapshot();
+    BOOST_REQUIRE((bool)produce(old_pid, 5));
+    auto new_pid = model::producer_identity{.id = 2, .epoch = 0};
+    BOOST_REQUIRE((bool)produce(new_pid, 0));
+    snapshot.get();
+
+    // the writes made during the snapshot are merged back into the table
+    BOOST_REQUIRE(!produce(old_pid, 5));
+    BOOST_REQUIRE((bool)produce(old_pid, 10));
+    BOOST_REQUIRE(!produce(new_pid, 0));
+    BOOST_REQUIRE((bool)produce(new_pid, 5));
+}
@@ -0,0 +1,100 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "cluster/shard_balancer.h"
+#include "cluster/tests/ntp_utils.h"
+#include "model/fundamental.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+static cluster::shard_load
+make_load(ss::shard_id shard, std::vector<std::pair<int, uint64_t>> loads) {
+    cluster::shard_load ret{.shard = shard};
+    for (auto [p, load] : loads) {
+        ret.partitions.push_back(cluster::partition_load{make_ntp(p), load});
+    }
+    return ret;
+}
+
+SEASTAR_THREAD_TEST_CASE(balanced_shards_are_left_alone) {
+    std::vector<cluster::shard_load> shards{
+      make_load(0, {{0, 100}, {1, 100}}),
+      make_load(1, {{2, 110}, {3, 100}}),
+    };
+    BOOST_REQUIRE(!cluster::plan_shard_move(shards));
+    BOOST_REQUIRE(!cluster::plan_shard_move({make_load(0, {{0, 1000}})}));
+    BOOST_REQUIRE(
+      !cluster::plan_shard_move({make_load(0, {}), make_load(1, {})}));
+}
+
+SEASTAR_THREAD_TEST_CASE(moves_biggest_fitting_partition) {
+    std::vector<cluster::shard_load> shards{
+      make_load(0, {{0, 10}}),
+      make_load(1, {{1, 500}, {2, 300}, {3, 100}, {4, 50}}),
+      make_load(2, {{5, 400}}),
+    };
+    auto move = cluster::plan_shard_move(shards);
+    BOOST_REQUIRE(move);
+    BOOST_REQUIRE_EQUAL(move->from, 1);
+    BOOST_REQUIRE_EQUAL(move->to, 0);
+    // half of the difference is 470, partition 1 would overload shard 0
+    BOOST_REQUIRE_EQUAL(move->ntp, make_ntp(2));
+}
+
+SEASTAR_THREAD_TEST_CASE(single_hot_partition_is_not_moved) {
+    // moving the only partition would just make the other shard the hot one
+    std::vector<cluster::shard_load> shards{
+      make_load(0, {{0, 1000}}),
+      make_load(1, {{1, 10}}),
+    };
+    BOOST_REQUIRE(!cluster::plan_shard_move(shards));
+}
+
+static cluster::partition_load make_affine(
+  int p, uint64_t load, ss::shard_id affinity, uint64_t affinity_votes) {
+    return cluster::partition_load{
+      .ntp = make_ntp(p),
+      .load = load,
+      .affinity = affinity,
+      .affinity_votes = affinity_votes,
+    };
+}
+
+SEASTAR_THREAD_TEST_CASE(partition_follows_its_clients) {
+    std::vector<cluster::shard_load> shards{
+      make_load(0, {{0, 100}}),
+      make_load(1, {{1, 100}}),
+      make_load(2, {{2, 60}}),
+    };
+    // nearly all the bytes of partition 3 come from connections on shard 0
+    shards[2].partitions.push_back(make_affine(3, 20, 0, 18));
+    // not a strong enough majority
+    shards[2].partitions.push_back(make_affine(4, 30, 1, 10));
+    BOOST_REQUIRE(!cluster::plan_shard_move(shards));
+
+    auto move = cluster::plan_affinity_move(shards);
+    BOOST_REQUIRE(move);
+    BOOST_REQUIRE_EQUAL(move->ntp, make_ntp(3));
+    BOOST_REQUIRE_EQUAL(move->from, 2);
+    BOOST_REQUIRE_EQUAL(move->to, 0);
+}
+
+SEASTAR_THREAD_TEST_CASE(affinity_does_not_overload_target) {
+    std::vector<cluster::shard_load> shards{
+      make_load(0, {{0, 100}}),
+      make_load(1, {}),
+    };
+    // moving it would put all the load on shard 0
+    shards[1].partitions.push_back(make_affine(1, 100, 0, 100));
+    BOOST_REQUIRE(!cluster::plan_affinity_move(shards));
+
+    // already on the shard of its clients
+    shards[1].partitions.back().affinity = 1;
+    BOOST_REQUIRE(!cluster::plan_affinity_move(shards));
+}
@@ -0,0 +1,52 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "cluster/shard_table.h"
+#include "cluster/tests/ntp_utils.h"
+#include "model/fundamental.h"
+#include "model/namespace.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+SEASTAR_THREAD_TEST_CASE(looks_up_partitions_of_topic) {
+    cluster::shard_table st;
+    BOOST_REQUIRE(st.insert(make_ntp(0), 1, model::revision_id(1)));
+    BOOST_REQUIRE(st.insert(make_ntp(3), 2, model::revision_id(1)));
+    BOOST_REQUIRE(!st.insert(make_ntp(3), 0, model::revision_id(2)));
+
+    const auto* topic = st.find_topic(
+      model::topic_namespace_view(model::kafka_namespace, model::topic("tp")));
+    BOOST_REQUIRE(topic);
+    BOOST_REQUIRE(
+      cluster::shard_table::shard_for(topic, model::partition_id(0))
+      == ss::shard_id(1));
+    BOOST_REQUIRE(
+      cluster::shard_table::shard_for(topic, model::partition_id(3))
+      == ss::shard_id(2));
+    BOOST_REQUIRE(
+      !cluster::shard_table::shard_for(topic, model::partition_id(1)));
+    BOOST_REQUIRE(
+      !cluster::shard_table::shard_for(topic, model::partition_id(4)));
+    BOOST_REQUIRE(st.shard_for(make_ntp(3)) == ss::shard_id(2));
+}
+
+SEASTAR_THREAD_TEST_CASE(ignores_stale_updates) {
+    cluster::shard_table st;
+    st.update(make_ntp(0), raft::group_id(1), 1, model::revision_id(5));
+    st.update(make_ntp(0), raft::group_id(1), 2, model::revision_id(4));
+    BOOST_REQUIRE(st.shard_for(make_ntp(0)) == ss::shard_id(1));
+
+    st.erase(make_ntp(0), raft::group_id(1), model::revision_id(4));
+    BOOST_REQUIRE(st.shard_for(make_ntp(0)) == ss::shard_id(1));
+
+    st.erase(make_ntp(0), raft::group_id(1), model::revision_id(5));
+    BOOST_REQUIRE(!st.shard_for(make_ntp(0)));
+    BOOST_REQUIRE(!st.find_topic(model::topic_namespace_view(
+      model::kafka_namespace, model::topic("tp"))));
+}
@@ -7,6 +7,8 @@
 // the Business Source License, use of this software will be governed
 // by the Apache License, Version 2.0
 
+#include "cluster/metadata_view.h"
+#include "cluster/partition_leaders_table.h"
 #include "cluster/tests/topic_table_fixture.h"
 #include "model/fundamental.h"
 
@@ -88,6 +90,37 @@ FIXTURE_TEST(test_conflicts, topic_table_fixture) {
     BOOST_REQUIRE_EQUAL(table.local().has_pending_changes(), false);
 }
 
+FIXTURE_TEST(test_create_topics_is_atomic, topic_table_fixture) {
+    create_topics();
+    // discard create delta
+    table.local().wait_for_changes(as).get0();
+
+    std::vector<cluster::topic_configuration_assignment> conflicting;
+    conflicting.push_back(make_tp_configuration("test_tp_4", 2, 1));
+    conflicting.push_back(make_tp_configuration("test_tp_1", 2, 1));
+    auto res_1 = table.local()
+                   .apply(
+                     cluster::create_topics_cmd(std::move(conflicting), 0),
+                     model::offset(1))
+                   .get0();
+    BOOST_REQUIRE_EQUAL(res_1, cluster::errc::topic_already_exists);
+    BOOST_REQUIRE_EQUAL(table.local().has_pending_changes(), false);
+
+    std::vector<cluster::topic_configuration_assignment> topics;
+    topics.push_back(make_tp_configuration("test_tp_4", 2, 1));
+    topics.push_back(make_tp_configuration("test_tp_5", 4, 1));
+    auto res_2 = table.local()
+                   .apply(
+                     cluster::create_topics_cmd(std::move(topics), 0),
+                     model::offset(2))
+                   .get0();
+    BOOST_REQUIRE_EQUAL(res_2, cluster::errc::success);
+    BOOST_REQUIRE_EQUAL(table.local().all_topics_metadata().size(), 5);
+
+    auto d = table.local().wait_for_changes(as).get0();
+    validate_delta(d, 6, 0);
+}
+
 FIXTURE_TEST(get_getting_config, topic_table_fixture) {
     create_topics();
     auto cfg = table.local().get_topic_cfg(make_tp_ns("test_tp_1"));
@@ -117,3 +150,43 @@ FIXTURE_TEST(test_wait_aborted, topic_table_fixture) {
       table.local().wait_for_changes(local_as).get0(),
       ss::abort_requested_exception);
 }
+
+FIXTURE_TEST(test_metadata_view_copy_on_write, topic_table_fixture) {
+    cluster::partition_leaders_table leaders;
+    cluster::metadata_view view(table.local(), leaders);
+    create_topics();
+
+    auto tp_1 = view.find(make_tp_ns("test_tp_1"));
+    auto tp_2 = view.find(make_tp_ns("test_tp_2"));
+    BOOST_REQUIRE(tp_1 && tp_2);
+    BOOST_REQUIRE_EQUAL(tp_2->metadata.partitions.size(), 12);
+    BOOST_REQUIRE(tp_2->partition(model::partition_id(11)));
+    BOOST_REQUIRE(!tp_2->partition(model::partition_id(12)));
+    BOOST_REQUIRE(view.get(tp_2->id) == tp_2);
+
+    // only the view of the topic whose leader changed is replaced
+    leaders.update_partition_leader(
+      model::ntp(test_ns, model::topic("test_tp_2"), model::partition_id(3)),
+      model::term_id(1),
+      model::node_id(2));
+    auto new_tp_2 = view.find(make_tp_ns("test_tp_2"));
+    BOOST_REQUIRE(new_tp_2 != tp_2);
+    BOOST_REQUIRE_GT(new_tp_2->version, tp_2->version);
+    BOOST_REQUIRE_EQUAL(new_tp_2->id, tp_2->id);
+    BOOST_REQUIRE_EQUAL(
+      new_tp_2->partition(model::partition_id(3))->leader_node,
+      model::node_id(2));
+    BOOST_REQUIRE(!tp_2->partition(model::partition_id(3))->leader_node);
+    BOOST_REQUIRE(view.find(make_tp_ns("test_tp_1")) == tp_1);
+
+    // deleting a topic keeps the views of the others
+    table.local()
+      .apply(
+        cluster::delete_topic_cmd(
+          make_tp_ns("test_tp_2"), make_tp_ns("test_tp_2")),
+        model::offset(0))
+      .get0();
+    BOOST_REQUIRE(!view.find(make_tp_ns("test_tp_2")));
+    BOOST_REQUIRE(!view.get(tp_2->id));
+    BOOST_REQUIRE(view.find(make_tp_ns("test_tp_1")) == tp_1);
+}
@@ -300,7 +300,7 @@ void tm_stm::load_snapshot(stm_snapshot_header hdr, iobuf&& tm_ss_buf) {
     _insync_offset = data.offset;
 }
 
-stm_snapshot tm_stm::take_snapshot() {
+ss::future<stm_snapshot> tm_stm::take_snapshot() {
     tm_snapshot tm_ss;
     tm_ss.offset = _insync_offset;
     for (auto& entry : _tx_table) {
@@ -318,7 +318,7 @@ stm_snapshot tm_stm::take_snapshot() {
     stm_ss.header = header;
     stm_ss.offset = _insync_offset;
     stm_ss.data = std::move(tm_ss_buf);
-    return stm_ss;
+    return ss::make_ready_future<stm_snapshot>(std::move(stm_ss));
 }
 
 ss::future<> tm_stm::apply(model::record_batch b) {
@@ -142,7 +142,7 @@ private:
     };
 
     void load_snapshot(stm_snapshot_header, iobuf&&) override;
-    stm_snapshot take_snapshot() override;
+    ss::future<stm_snapshot> take_snapshot() override;
 
     void expire_old_txs();
 
@@ -14,9 +14,12 @@
 #include "cluster/types.h"
 #include "model/fundamental.h"
 #include "model/metadata.h"
+#include "vassert.h"
 
 #include <seastar/core/coroutine.hh>
 
+#include <utility>
+
 namespace cluster {
 
 template<typename Func>
@@ -51,16 +54,46 @@ topic_table::apply(create_topic_cmd cmd, model::offset offset) {
         return ss::make_ready_future<std::error_code>(
           errc::topic_already_exists);
     }
+    add_topic(std::move(cmd.key), std::move(cmd.value), offset);
+    notify_waiters();
+    return ss::make_ready_future<std::error_code>(errc::success);
+}
+
+ss::future<std::error_code>
+topic_table::apply(create_topics_cmd cmd, model::offset offset) {
+    absl::flat_hash_set<
+      model::topic_namespace,
+      model::topic_namespace_hash,
+      model::topic_namespace_eq>
+      names;
+    names.reserve(cmd.key.size());
+    for (const auto& t : cmd.key) {
+        if (
+          _topics.contains(t.cfg.tp_ns) || !names.insert(t.cfg.tp_ns).second) {
+            return ss::make_ready_future<std::error_code>(
+              errc::topic_already_exists);
+        }
+    }
+    for (auto& t : cmd.key) {
+        auto tp_ns = t.cfg.tp_ns;
+        add_topic(std::move(tp_ns), std::move(t), offset);
+    }
+    notify_waiters();
+    return ss::make_ready_future<std::error_code>(errc::success);
+}
+
+void topic_table::add_topic(
+  model::topic_namespace tp_ns,
+  topic_configuration_assignment assignment,
+  model::offset offset) {
     // calculate delta
-    for (auto& pas : cmd.value.assignments) {
-        auto ntp = model::ntp(cmd.key.ns, cmd.key.tp, pas.id);
+    for (auto& pas : assignment.assignments) {
+        auto ntp = model::ntp(tp_ns.ns, tp_ns.tp, pas.id);
         _pending_deltas.emplace_back(
           std::move(ntp), pas, offset, delta::op_type::add);
     }
 
-    _topics.insert({cmd.key, std::move(cmd.value)});
-    notify_waiters();
-    return ss::make_ready_future<std::error_code>(errc::success);
+    _topics.insert({std::move(tp_ns), std::move(assignment)});
 }
 
 ss::future<> topic_table::stop() {
@@ -236,7 +269,25 @@ topic_table::apply(update_topic_properties_cmd cmd, model::offset o) {
     co_return make_error_code(errc::success);
 }
 
+void topic_table::resume_notifications() {
+    vassert(_suspended_notifications > 0, "Notifications were not suspended");
+    if (
+      --_suspended_notifications == 0
+      && std::exchange(_notification_pending, false)) {
+        publish_changes();
+    }
+}
+
 void topic_table::notify_waiters() {
+    ++_epoch;
+    if (_suspended_notifications > 0) {
+        _notification_pending = true;
+        return;
+    }
+    publish_changes();
+}
+
+void topic_table::publish_changes() {
     if (_waiters.empty()) {
         return;
     }
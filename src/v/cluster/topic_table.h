@@ -82,10 +82,12 @@ public:
       delete_topic_cmd,
       move_partition_replicas_cmd,
       finish_moving_partition_replicas_cmd,
-      update_topic_properties_cmd>{};
+      update_topic_properties_cmd,
+      create_topics_cmd>{};
 
     /// State machine applies
     ss::future<std::error_code> apply(create_topic_cmd, model::offset);
+    ss::future<std::error_code> apply(create_topics_cmd, model::offset);
     ss::future<std::error_code> apply(delete_topic_cmd, model::offset);
     ss::future<std::error_code>
       apply(move_partition_replicas_cmd, model::offset);
@@ -95,12 +97,26 @@ public:
       apply(update_topic_properties_cmd, model::offset);
     ss::future<> stop();
 
+    /// The delta waiters are notified once for all the commands applied
+    /// until the matching resume_notifications(), rather than after each
+    void suspend_notifications() { ++_suspended_notifications; }
+    void resume_notifications();
+
     /// Delta API
 
     ss::future<std::vector<delta>> wait_for_changes(ss::abort_source&);
 
     bool has_pending_changes() const { return !_pending_deltas.empty(); }
 
+    /// Partitions which replica set is being changed
+    bool is_update_in_progress(const model::ntp& ntp) const {
+        return _update_in_progress.contains(ntp);
+    }
+    size_t updates_in_progress() const { return _update_in_progress.size(); }
+
+    /// Changes every time any topic is created, deleted or updated
+    uint64_t epoch() const { return _epoch; }
+
     /// Query API
 
     /// Returns list of all topics that exists in the cluster.
@@ -149,8 +165,11 @@ private:
         uint64_t id;
     };
     void deallocate_topic_partitions(const std::vector<partition_assignment>&);
+    void add_topic(
+      model::topic_namespace, topic_configuration_assignment, model::offset);
 
     void notify_waiters();
+    void publish_changes();
 
     template<typename Func>
     std::vector<std::invoke_result_t<Func, topic_configuration_assignment>>
@@ -168,8 +187,11 @@ private:
     std::vector<delta> _pending_deltas;
     std::vector<std::unique_ptr<waiter>> _waiters;
     cluster::notification_id_type _notification_id{0};
+    uint64_t _epoch{0};
     std::vector<std::pair<cluster::notification_id_type, delta_cb_t>>
       _notifications;
     uint64_t _waiter_id{0};
+    uint32_t _suspended_notifications{0};
+    bool _notification_pending{false};
 };
 } // namespace cluster
@@ -13,8 +13,13 @@
 #include "model/metadata.h"
 #include "raft/types.h"
 
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/when_all.hh>
+#include <seastar/util/defer.hh>
+
 #include <iterator>
 #include <system_error>
+#include <variant>
 #include <vector>
 
 namespace cluster {
@@ -28,65 +33,157 @@ ss::future<std::error_code>
 topic_updates_dispatcher::apply_update(model::record_batch b) {
     auto base_offset = b.base_offset();
     return deserialize(std::move(b), commands)
-      .then([this, base_offset](auto cmd) {
-          return ss::visit(
-            std::move(cmd),
-            [this, base_offset](delete_topic_cmd del_cmd) {
-                // delete case - we need state copy to
-                auto tp_md = _topic_table.local().get_topic_metadata(
-                  del_cmd.value);
-                return dispatch_updates_to_cores(del_cmd, base_offset)
-                  .then([this, tp_md](std::error_code ec) {
-                      if (ec == errc::success) {
-                          vassert(
-                            tp_md.has_value(),
-                            "Topic had to exist before successful delete");
-                          deallocate_topic(*tp_md);
-                      }
-                      return ec;
-                  });
-            },
-            [this, base_offset](create_topic_cmd create_cmd) {
-                return dispatch_updates_to_cores(create_cmd, base_offset)
-                  .then([this, create_cmd](std::error_code ec) {
-                      if (ec == errc::success) {
-                          update_allocations(create_cmd);
-                      }
-                      return ec;
-                  });
-            },
-            [this, base_offset](move_partition_replicas_cmd cmd) {
-                auto tp_md = _topic_table.local().get_topic_metadata(
-                  model::topic_namespace_view(cmd.key));
-                return dispatch_updates_to_cores(cmd, base_offset)
-                  .then([this, tp_md, cmd](std::error_code ec) {
-                      if (!ec) {
-                          vassert(
-                            tp_md.has_value(),
-                            "Topic had to exist before successful partition "
-                            "reallocation");
-                          auto it = std::find_if(
-                            std::cbegin(tp_md->partitions),
-                            std::cend(tp_md->partitions),
-                            [p_id = cmd.key.tp.partition](
-                              const model::partition_metadata& pmd) {
-                                return pmd.id == p_id;
-                            });
-                          vassert(
-                            it != tp_md->partitions.cend(),
-                            "Reassigned partition must exist");
-
-                          reallocate_partition(it->replicas, cmd.value);
-                      }
-                      return ec;
-                  });
-            },
-            [this, base_offset](finish_moving_partition_replicas_cmd cmd) {
-                return dispatch_updates_to_cores(std::move(cmd), base_offset);
-            },
-            [this, base_offset](update_topic_properties_cmd cmd) {
-                return dispatch_updates_to_cores(std::move(cmd), base_offset);
+      .then([this, base_offset](command_t cmd) {
+          return apply_command(
+            std::move(cmd), base_offset, [this](auto cmd, model::offset o) {
+                return dispatch_updates_to_cores(std::move(cmd), o);
+            });
+      });
+}
+
+template<typename Commands>
+static ss::future<std::vector<std::error_code>>
+apply_commands(topic_table& table, Commands cmds) {
+    std::vector<std::error_code> results;
+    results.reserve(cmds.size());
+    table.suspend_notifications();
+    auto resume = ss::defer([&table]() noexcept {
+        table.resume_notifications();
+    });
+    for (auto& cmd : cmds) {
+        results.push_back(co_await std::visit(
+          [&table, o = cmd.second](auto& c) {
+              return table.apply(std::move(c), o);
+          },
+          cmd.first));
+    }
+    co_return results;
+}
+
+ss::future<std::vector<std::error_code>>
+topic_updates_dispatcher::apply_update(
+  std::vector<model::record_batch> batches) {
+    commands_t cmds;
+    cmds.reserve(batches.size());
+    for (auto& b : batches) {
+        auto base_offset = b.base_offset();
+        cmds.emplace_back(
+          co_await deserialize(std::move(b), commands), base_offset);
+    }
+    // the other shards apply the run as it is, copied before the local
+    // table consumes the commands
+    std::vector<ss::future<std::vector<std::error_code>>> remote;
+    remote.reserve(ss::smp::count);
+    for (ss::shard_id shard = 0; shard < ss::smp::count; ++shard) {
+        if (shard == ss::this_shard_id()) {
+            continue;
+        }
+        remote.push_back(_topic_table.invoke_on(
+          shard, [cmds](topic_table& table) mutable {
+              return apply_commands(table, std::move(cmds));
+          }));
+    }
+
+    std::vector<std::error_code> results;
+    results.reserve(cmds.size());
+    auto& local = _topic_table.local();
+    local.suspend_notifications();
+    auto resume = ss::defer([&local]() noexcept {
+        local.resume_notifications();
+    });
+    for (auto& [cmd, offset] : cmds) {
+        results.push_back(co_await apply_command(
+          std::move(cmd), offset, [&local](auto cmd, model::offset o) {
+              return local.apply(std::move(cmd), o);
+          }));
+    }
+
+    auto remote_results = co_await ss::when_all_succeed(
+      remote.begin(), remote.end());
+    for (const auto& r : remote_results) {
+        for (size_t i = 0; i < results.size(); ++i) {
+            vassert(
+              results[i] == r[i],
+              "State inconsistency across shards detected, expected "
+              "result: {}, have: {}",
+              results[i],
+              r[i]);
+        }
+    }
+    co_return results;
+}
+
+template<typename Apply>
+ss::future<std::error_code> topic_updates_dispatcher::apply_command(
+  command_t cmd, model::offset base_offset, Apply apply) {
+    return ss::visit(
+      std::move(cmd),
+      [this, base_offset, &apply](delete_topic_cmd del_cmd) {
+          // delete case - we need state copy to
+          auto tp_md = _topic_table.local().get_topic_metadata(
+            del_cmd.value);
+          return apply(del_cmd, base_offset)
+            .then([this, tp_md](std::error_code ec) {
+                if (ec == errc::success) {
+                    vassert(
+                      tp_md.has_value(),
+                      "Topic had to exist before successful delete");
+                    deallocate_topic(*tp_md);
+                }
+                return ec;
+            });
+      },
+      [this, base_offset, &apply](create_topic_cmd create_cmd) {
+          return apply(create_cmd, base_offset)
+            .then([this, create_cmd](std::error_code ec) {
+                if (ec == errc::success) {
+                    update_allocations(create_cmd.value);
+                }
+                return ec;
+            });
+      },
+      [this, base_offset, &apply](create_topics_cmd create_cmd) {
+          return apply(create_cmd, base_offset)
+            .then([this, create_cmd](std::error_code ec) {
+                if (ec == errc::success) {
+                    for (const auto& t : create_cmd.key) {
+                        update_allocations(t);
+                    }
+                }
+                return ec;
+            });
+      },
+      [this, base_offset, &apply](move_partition_replicas_cmd cmd) {
+          auto tp_md = _topic_table.local().get_topic_metadata(
+            model::topic_namespace_view(cmd.key));
+          return apply(cmd, base_offset)
+            .then([this, tp_md, cmd](std::error_code ec) {
+                if (!ec) {
+                    vassert(
+                      tp_md.has_value(),
+                      "Topic had to exist before successful partition "
+                      "reallocation");
+                    auto it = std::find_if(
+                      std::cbegin(tp_md->partitions),
+                      std::cend(tp_md->partitions),
+                      [p_id = cmd.key.tp.partition](
+                        const model::partition_metadata& pmd) {
+                          return pmd.id == p_id;
+                      });
+                    vassert(
+                      it != tp_md->partitions.cend(),
+                      "Reassigned partition must exist");
+
+                    reallocate_partition(it->replicas, cmd.value);
+                }
+                return ec;
             });
+      },
+      [this, base_offset, &apply](finish_moving_partition_replicas_cmd cmd) {
+          return apply(std::move(cmd), base_offset);
+      },
+      [this, base_offset, &apply](update_topic_properties_cmd cmd) {
+          return apply(std::move(cmd), base_offset);
       });
 }
 
@@ -153,11 +250,12 @@ void topic_updates_dispatcher::reallocate_partition(
       current, raft::group_id(0));
 }
 
-void topic_updates_dispatcher::update_allocations(const create_topic_cmd& cmd) {
+void topic_updates_dispatcher::update_allocations(
+  const topic_configuration_assignment& topic) {
     // for create topics we update allocation state
     std::vector<model::broker_shard> shards;
     raft::group_id max_group_id = raft::group_id(0);
-    for (auto& pas : cmd.value.assignments) {
+    for (auto& pas : topic.assignments) {
         max_group_id = std::max(max_group_id, pas.group);
         std::move(
           pas.replicas.begin(), pas.replicas.end(), std::back_inserter(shards));
@@ -17,6 +17,10 @@
 
 #include <seastar/core/sharded.hh>
 
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 namespace cluster {
 
 // The topic updates dispatcher is resposible for receiving update_apply upcalls
@@ -53,22 +57,34 @@ public:
 
     ss::future<std::error_code> apply_update(model::record_batch);
 
+    /// Applies a run of consecutive batches, each shard applies all of their
+    /// commands in one pass and notifies its delta waiters once
+    ss::future<std::vector<std::error_code>>
+      apply_update(std::vector<model::record_batch>);
+
     static constexpr auto commands = make_commands_list<
       create_topic_cmd,
       delete_topic_cmd,
       move_partition_replicas_cmd,
       finish_moving_partition_replicas_cmd,
-      update_topic_properties_cmd>();
+      update_topic_properties_cmd,
+      create_topics_cmd>();
 
     bool is_batch_applicable(const model::record_batch& batch) const {
         return batch.header().type == topic_batch_type;
     }
 
 private:
+    using command_t
+      = commands_variant<std::remove_const_t<decltype(commands)>>::type;
+    using commands_t = std::vector<std::pair<command_t, model::offset>>;
+
+    template<typename Apply>
+    ss::future<std::error_code> apply_command(command_t, model::offset, Apply);
     template<typename Cmd>
     ss::future<std::error_code> dispatch_updates_to_cores(Cmd, model::offset);
 
-    void update_allocations(const create_topic_cmd&);
+    void update_allocations(const topic_configuration_assignment&);
     void deallocate_topic(const model::topic_metadata&);
     void reallocate_partition(
       const std::vector<model::broker_shard>&,
@@ -17,6 +17,7 @@
 #include "cluster/partition_allocator.h"
 #include "cluster/partition_leaders_table.h"
 #include "cluster/types.h"
+#include "config/configuration.h"
 #include "model/errc.h"
 #include "model/metadata.h"
 #include "model/namespace.h"
@@ -73,6 +74,12 @@ ss::future<std::vector<topic_result>> topics_frontend::create_topics(
               return ss::make_ready_future<std::vector<topic_result>>(
                 create_topic_results(topics, errc::not_leader_controller));
           }
+          const auto batch_size
+            = config::shard_local_cfg().create_topics_batch_size();
+          if (batch_size > 1 && topics.size() > 1) {
+              return create_topics_in_batches(
+                std::move(topics), batch_size, timeout);
+          }
           std::vector<ss::future<topic_result>> futures;
           futures.reserve(topics.size());
 
@@ -257,16 +264,7 @@ ss::future<topic_result> topics_frontend::replicate_create_topic(
 
     std::vector<ntp_leader> leaders;
     leaders.reserve(cmd.value.assignments.size());
-    for (auto& p_as : cmd.value.assignments) {
-        std::shuffle(
-          p_as.replicas.begin(),
-          p_as.replicas.end(),
-          random_generators::internal::gen);
-        // guesstimate leaders
-        leaders.emplace_back(
-          model::ntp(tp_ns.ns, tp_ns.tp, p_as.id),
-          p_as.replicas.begin()->node_id);
-    }
+    shuffle_replicas(cmd.value, leaders);
 
     return replicate_and_wait(std::move(cmd), timeout)
       .then_wrapped(
@@ -297,6 +295,105 @@ ss::future<topic_result> topics_frontend::replicate_create_topic(
         });
 }
 
+void topics_frontend::shuffle_replicas(
+  topic_configuration_assignment& topic, std::vector<ntp_leader>& leaders) {
+    const auto& tp_ns = topic.cfg.tp_ns;
+    for (auto& p_as : topic.assignments) {
+        std::shuffle(
+          p_as.replicas.begin(),
+          p_as.replicas.end(),
+          random_generators::internal::gen);
+        // guesstimate leaders
+        leaders.emplace_back(
+          model::ntp(tp_ns.ns, tp_ns.tp, p_as.id),
+          p_as.replicas.begin()->node_id);
+    }
+}
+
+ss::future<std::vector<topic_result>> topics_frontend::create_topics_in_batches(
+  std::vector<topic_configuration> topics,
+  size_t batch_size,
+  model::timeout_clock::time_point timeout) {
+    struct allocated_topic {
+        // position of the topic result
+        size_t idx;
+        topic_configuration cfg;
+        partition_allocator::allocation_units units;
+    };
+
+    std::vector<topic_result> results;
+    results.reserve(topics.size());
+    std::vector<allocated_topic> allocated;
+    allocated.reserve(topics.size());
+    for (auto& t_cfg : topics) {
+        if (!validate_topic_name(t_cfg.tp_ns)) {
+            results.emplace_back(t_cfg.tp_ns, errc::invalid_topic_name);
+            continue;
+        }
+        auto units = co_await _allocator.invoke_on(
+          partition_allocator::shard,
+          [t_cfg](partition_allocator& al) { return al.allocate(t_cfg); });
+        if (!units) {
+            results.emplace_back(t_cfg.tp_ns, errc::topic_invalid_partitions);
+            continue;
+        }
+        results.emplace_back(t_cfg.tp_ns, errc::success);
+        allocated.push_back(allocated_topic{
+          .idx = results.size() - 1,
+          .cfg = std::move(t_cfg),
+          .units = std::move(*units)});
+    }
+
+    for (size_t begin = 0; begin < allocated.size(); begin += batch_size) {
+        const auto end = std::min(allocated.size(), begin + batch_size);
+        std::vector<topic_configuration_assignment> assignments;
+        assignments.reserve(end - begin);
+        std::vector<ntp_leader> leaders;
+        for (auto i = begin; i < end; ++i) {
+            assignments.emplace_back(
+              allocated[i].cfg, allocated[i].units.get_assignments());
+            shuffle_replicas(assignments.back(), leaders);
+        }
+
+        std::error_code ec;
+        try {
+            ec = co_await replicate_and_wait(
+              create_topics_cmd(std::move(assignments), 0), timeout);
+        } catch (...) {
+            vlog(
+              clusterlog.warn,
+              "Unable to create topics - {}",
+              std::current_exception());
+            ec = errc::replication_error;
+        }
+
+        if (!ec) {
+            co_await update_leaders_with_estimates(std::move(leaders));
+        } else if (ec == errc::topic_already_exists) {
+            // the command created none of the topics, create them one by one
+            // to tell which of them exist
+            std::vector<ss::future<topic_result>> futures;
+            futures.reserve(end - begin);
+            for (auto i = begin; i < end; ++i) {
+                futures.push_back(replicate_create_topic(
+                  std::move(allocated[i].cfg),
+                  std::move(allocated[i].units),
+                  timeout));
+            }
+            auto single = co_await ss::when_all_succeed(
+              futures.begin(), futures.end());
+            for (auto i = begin; i < end; ++i) {
+                results[allocated[i].idx] = std::move(single[i - begin]);
+            }
+        } else {
+            for (auto i = begin; i < end; ++i) {
+                results[allocated[i].idx].ec = map_errc(ec);
+            }
+        }
+    }
+    co_return results;
+}
+
 ss::future<> topics_frontend::update_leaders_with_estimates(
   std::vector<ntp_leader> leaders) {
     return ss::do_with(
@@ -412,6 +509,10 @@ topics_frontend::dispatch_create_to_leader(
 
 bool topics_frontend::validate_topic_name(const model::topic_namespace& topic) {
     if (topic.ns == model::kafka_namespace) {
+        /// Replicated outputs of coprocessors, both parts are validated
+        if (model::is_materialized_topic(topic.tp)) {
+            return true;
+        }
         const auto errc = model::validate_kafka_topic_name(topic.tp);
         if (static_cast<model::errc>(errc.value()) != model::errc::success) {
             vlog(clusterlog.info, "{} {}", errc.message(), topic.tp());
@@ -70,6 +70,13 @@ private:
       partition_allocator::allocation_units,
       model::timeout_clock::time_point);
 
+    /// replicates a command for every batch of topics instead of one for
+    /// every topic
+    ss::future<std::vector<topic_result>> create_topics_in_batches(
+      std::vector<topic_configuration>,
+      size_t batch_size,
+      model::timeout_clock::time_point);
+
     ss::future<topic_result>
       do_delete_topic(model::topic_namespace, model::timeout_clock::time_point);
 
@@ -84,6 +91,8 @@ private:
     ss::future<topic_result> do_update_topic_properties(
       topic_properties_update, model::timeout_clock::time_point);
     ss::future<> update_leaders_with_estimates(std::vector<ntp_leader>);
+    static void shuffle_replicas(
+      topic_configuration_assignment&, std::vector<ntp_leader>&);
 
     ss::future<result<model::offset>>
       stm_linearizable_barrier(model::timeout_clock::time_point);
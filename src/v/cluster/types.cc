@@ -36,7 +36,7 @@ bool topic_properties::has_overrides() const {
     return cleanup_policy_bitflags || compaction_strategy || segment_size
            || retention_bytes.has_value() || retention_bytes.is_disabled()
            || retention_duration.has_value()
-           || retention_duration.is_disabled();
+           || retention_duration.is_disabled() || storage_mode;
 }
 
 storage::ntp_config::default_overrides
@@ -47,6 +47,7 @@ topic_properties::get_ntp_cfg_overrides() const {
     ret.retention_bytes = retention_bytes;
     ret.retention_time = retention_duration;
     ret.segment_size = segment_size;
+    ret.storage_mode = storage_mode;
     return ret;
 }
 
@@ -73,7 +74,8 @@ storage::ntp_config topic_configuration::make_ntp_config(
             .retention_time = properties.retention_duration,
             // we disable cache for internal topics as they are read only once
             // during bootstrap.
-            .cache_enabled = storage::with_cache(!is_internal())});
+            .cache_enabled = storage::with_cache(!is_internal()),
+            .storage_mode = properties.storage_mode});
     }
     return storage::ntp_config(
       model::ntp(tp_ns.ns, tp_ns.tp, p_id),
@@ -120,14 +122,15 @@ std::ostream& operator<<(std::ostream& o, const topic_properties& properties) {
       o,
       "{{ compression: {}, cleanup_policy_bitflags: {}, compaction_strategy: "
       "{}, retention_bytes: {}, retention_duration_ms: {}, segment_size: {}, "
-      "timestamp_type: {} }}",
+      "timestamp_type: {}, storage_mode: {} }}",
       properties.compression,
       properties.cleanup_policy_bitflags,
       properties.compaction_strategy,
       properties.retention_bytes,
       properties.retention_duration,
       properties.segment_size,
-      properties.timestamp_type);
+      properties.timestamp_type,
+      properties.storage_mode);
 
     return o;
 }
@@ -163,6 +166,7 @@ void adl<cluster::topic_configuration>::to(
   iobuf& out, cluster::topic_configuration&& t) {
     reflection::serialize(
       out,
+      current_version,
       t.tp_ns,
       t.partition_count,
       t.replication_factor,
@@ -172,11 +176,23 @@ void adl<cluster::topic_configuration>::to(
       t.properties.timestamp_type,
       t.properties.segment_size,
       t.properties.retention_bytes,
-      t.properties.retention_duration);
+      t.properties.retention_duration,
+      t.properties.storage_mode);
 }
 
 cluster::topic_configuration
 adl<cluster::topic_configuration>::from(iobuf_parser& in) {
+    auto peek = in.position();
+    int32_t version = peek.consume_type<int32_t>();
+    if (version < 0) {
+        vassert(
+          version >= current_version,
+          "Unsupported topic configuration version {}",
+          version);
+        in.skip(sizeof(version));
+    } else {
+        version = 0;
+    }
     auto ns = model::ns(adl<ss::sstring>{}.from(in));
     auto topic = model::topic(adl<ss::sstring>{}.from(in));
     auto partition_count = adl<int32_t>{}.from(in);
@@ -197,6 +213,10 @@ adl<cluster::topic_configuration>::from(iobuf_parser& in) {
     cfg.properties.retention_bytes = adl<tristate<size_t>>{}.from(in);
     cfg.properties.retention_duration
       = adl<tristate<std::chrono::milliseconds>>{}.from(in);
+    if (version <= -1) {
+        cfg.properties.storage_mode
+          = adl<std::optional<model::storage_mode>>{}.from(in);
+    }
 
     return cfg;
 }
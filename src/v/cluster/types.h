@@ -45,6 +45,18 @@ struct allocate_id_reply {
     errc ec;
 };
 
+struct allocate_id_range_request {
+    model::timeout_clock::duration timeout;
+    int64_t count;
+};
+
+// ids [id, id + count) belong to the caller
+struct allocate_id_range_reply {
+    int64_t id;
+    int64_t count;
+    errc ec;
+};
+
 enum class tx_errc {
     none = 0,
     leader_not_found,
@@ -118,6 +130,55 @@ struct configuration_update_reply {
     bool success;
 };
 
+/// load of one core of a node since the previous report, rates are in bytes
+/// per second
+struct core_load {
+    uint64_t produce_bytes_rate{0};
+    uint64_t fetch_bytes_rate{0};
+    uint32_t leaders{0};
+};
+
+/// state of a replica hosted by the reporting node, rates are in bytes per
+/// second since the previous report
+struct partition_status {
+    model::partition_id id;
+    bool leader{false};
+    uint64_t size_bytes{0};
+    uint64_t produce_bytes_rate{0};
+    uint64_t fetch_bytes_rate{0};
+    /// offsets the furthest behind follower is missing, reported by leaders
+    int64_t replication_backlog{0};
+};
+
+/// replicas of a single topic, the name is sent once for all of them
+struct topic_status {
+    model::topic_namespace tp_ns;
+    std::vector<partition_status> partitions;
+};
+
+/// sent by every node to the controller leader, see node_load_reporter
+struct node_load_report {
+    model::node_id node;
+    std::vector<core_load> cores;
+    uint64_t disk_free_bytes{0};
+    uint64_t disk_total_bytes{0};
+    std::vector<topic_status> topics;
+};
+
+struct node_load_report_reply {
+    errc error{errc::success};
+};
+
+/// asks the leader of the partition to hand the leadership over to the target
+struct transfer_leadership_request {
+    model::ntp ntp;
+    model::node_id target;
+};
+
+struct transfer_leadership_reply {
+    errc error{errc::success};
+};
+
 /// Partition assignment describes an assignment of all replicas for single NTP.
 /// The replicas are hold in vector of broker_shard.
 struct partition_assignment {
@@ -146,6 +207,8 @@ struct topic_properties {
     std::optional<size_t> segment_size;
     tristate<size_t> retention_bytes;
     tristate<std::chrono::milliseconds> retention_duration;
+    // chosen when the topic is created, it can't be altered
+    std::optional<model::storage_mode> storage_mode;
 
     bool is_compacted() const;
     bool has_overrides() const;
@@ -297,6 +360,14 @@ struct configuration_invariants {
     operator<<(std::ostream&, const configuration_invariants&);
 };
 
+/// Replica of a partition on this node placed on a different shard than the
+/// one in its assignment, set when the shard balancer moves a partition
+/// between the shards of a node. Node local, persisted in the kvstore.
+struct shard_placement_override {
+    model::ntp ntp;
+    uint32_t shard;
+};
+
 class configuration_invariants_changed final : public std::exception {
 public:
     explicit configuration_invariants_changed(
@@ -366,6 +437,13 @@ struct adl<model::timeout_clock::duration> {
 
 template<>
 struct adl<cluster::topic_configuration> {
+    /*
+     * The first field of the original format is the length prefix of the
+     * namespace, which is never negative. Versioned formats start with a
+     * negative version instead.
+     */
+    static constexpr int32_t current_version = -1;
+
     void to(iobuf&, cluster::topic_configuration&&);
     cluster::topic_configuration from(iobuf_parser&);
 };
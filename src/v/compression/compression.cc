@@ -31,6 +31,22 @@ iobuf compressor::compress(const iobuf& io, type t) {
         vassert(false, "Cannot compress type {}", t);
     }
 }
+iobuf compressor::compress(const iobuf& io, type t, int level) {
+    switch (t) {
+    case type::none:
+        throw std::runtime_error("compressor: nothing to compress for 'none'");
+    case type::gzip:
+        return internal::gzip_compressor::compress(io, level);
+    case type::snappy:
+        return internal::snappy_java_compressor::compress(io);
+    case type::lz4:
+        return internal::lz4_frame_compressor::compress(io, level);
+    case type::zstd:
+        return internal::zstd_compressor::compress(io, level);
+    default:
+        vassert(false, "Cannot compress type {}", t);
+    }
+}
 iobuf compressor::uncompress(const iobuf& io, type t) {
     if (io.empty()) {
         throw std::runtime_error(
@@ -15,11 +15,13 @@
 namespace compression {
 
 using type = model::compression;
-// a very simple compressor. Exposes virtually no knobs and uses
-// the defaults for all compressors. In the future, we can make these
-// a virtual interface so we can instantiate them
+// a very simple compressor. Every codec keeps its contexts per shard and
+// reuses them across calls, and uncompress streams over the fragments of
+// the input without linearizing it
 struct compressor {
     static iobuf compress(const iobuf&, type);
+    // the level is codec specific, snappy has none and ignores it
+    static iobuf compress(const iobuf&, type, int level);
     static iobuf uncompress(const iobuf&, type);
 };
 
@@ -9,7 +9,7 @@
 
 #include "compression/internal/gzip_compressor.h"
 
-#include "bytes/bytes.h"
+#include "bytes/details/io_allocation_size.h"
 #include "vassert.h"
 
 #include <seastar/core/temporary_buffer.hh>
@@ -18,6 +18,8 @@
 
 #include <zlib.h>
 
+#include <algorithm>
+
 namespace compression::internal {
 [[noreturn]] [[gnu::cold]] static void
 throw_zstream_error(const char* fmt, int ret) {
@@ -39,18 +41,13 @@ inline z_stream default_zstream() {
     return zs;
 }
 
+// the codecs own a zlib stream for the lifetime of the shard and reset it
+// between calls, instead of paying for the window and hash table
+// allocations of deflateInit2 and inflateInit2 every time
 class gzip_compression_codec {
 public:
-    gzip_compression_codec() noexcept = default;
-    gzip_compression_codec(const gzip_compression_codec&) = delete;
-    gzip_compression_codec& operator=(const gzip_compression_codec&) = delete;
-    gzip_compression_codec(gzip_compression_codec&&) noexcept = delete;
-    gzip_compression_codec&
-    operator=(gzip_compression_codec&&) noexcept = delete;
-
-    void reset() {
-        vassert(!_init, "Double initialized gzip decompression codec");
-        _stream = default_zstream();
+    gzip_compression_codec()
+      : _stream(default_zstream()) {
         throw_if_zstream_error(
           "gzip compress deflateInit2 error: {}",
           deflateInit2(
@@ -60,115 +57,130 @@ public:
             15 + 16,
             8 /*512 byte*/,
             Z_DEFAULT_STRATEGY));
-        _init = true;
     }
-    z_stream& stream() { return _stream; }
-    ~gzip_compression_codec() {
-        if (_init) {
-            _init = false;
-            deflateEnd(&_stream);
+    gzip_compression_codec(const gzip_compression_codec&) = delete;
+    gzip_compression_codec& operator=(const gzip_compression_codec&) = delete;
+    gzip_compression_codec(gzip_compression_codec&&) noexcept = delete;
+    gzip_compression_codec&
+    operator=(gzip_compression_codec&&) noexcept = delete;
+    ~gzip_compression_codec() { deflateEnd(&_stream); }
+
+    void reset(int level) {
+        throw_if_zstream_error(
+          "gzip compress deflateReset error: {}", deflateReset(&_stream));
+        if (level != _level) {
+            // no data went through the stream yet, nothing is flushed
+            throw_if_zstream_error(
+              "gzip compress deflateParams error: {}",
+              deflateParams(&_stream, level, Z_DEFAULT_STRATEGY));
+            _level = level;
         }
     }
+    z_stream& stream() { return _stream; }
 
 private:
-    bool _init{false};
+    int _level{Z_DEFAULT_COMPRESSION};
     z_stream _stream;
 };
 class gzip_decompression_codec {
 public:
-    gzip_decompression_codec(const char* src, size_t src_size) noexcept
-      : _input(src)
-      , _input_size(src_size) {}
+    gzip_decompression_codec()
+      : _stream(default_zstream()) {
+        throw_if_zstream_error(
+          "gzip error with inflateInit2:{}", inflateInit2(&_stream, 15 + 32));
+    }
     gzip_decompression_codec(const gzip_decompression_codec&) = delete;
     gzip_decompression_codec& operator=(const gzip_decompression_codec&)
       = delete;
     gzip_decompression_codec(gzip_decompression_codec&&) noexcept = delete;
     gzip_decompression_codec&
     operator=(gzip_decompression_codec&&) noexcept = delete;
+    ~gzip_decompression_codec() { inflateEnd(&_stream); }
 
     void reset() {
-        vassert(!_init, "Double initialized gzip decompression codec");
-        _stream = default_zstream();
-        // zlib is not const-correct
-        // NOLINTNEXTLINE
-        _stream.next_in = (unsigned char*)_input;
-        _stream.avail_in = _input_size;
         throw_if_zstream_error(
-          "gzip error with inflateInit2:{}", inflateInit2(&_stream, 15 + 32));
-        // marking init must happen before gzip header
-        _init = true;
-
-        // last
+          "gzip inflateReset error:{}", inflateReset(&_stream));
         throw_if_zstream_error(
           "gzip inflateGetHeader error:{}", inflateGetHeader(&_stream, &_hdr));
     }
 
-    void inflate_to(char* output, size_t out_size);
-
-    ~gzip_decompression_codec() {
-        if (_init) {
-            _init = false;
-            inflateEnd(&_stream);
-        }
-    }
+    /// \brief inflates the whole input, fragment by fragment
+    iobuf inflate_all(const iobuf&);
 
     z_stream& stream() { return _stream; }
     gz_header& header() { return _hdr; }
 
 private:
-    bool _init{false};
-    const char* _input;
-    size_t _input_size;
     gz_header _hdr; // needed for gzip
     z_stream _stream;
 };
 
+static gzip_compression_codec& compression_codec() {
+    static thread_local gzip_compression_codec codec;
+    return codec;
+}
+
+static gzip_decompression_codec& decompression_codec() {
+    static thread_local gzip_decompression_codec codec;
+    return codec;
+}
+
 iobuf gzip_compressor::compress(const iobuf& b) {
-    ss::temporary_buffer<char> obuf;
-    {
-        gzip_compression_codec def;
-        def.reset();
-        z_stream& strm = def.stream();
-        /* Calculate maximum compressed size and
-         * allocate an output buffer accordingly, being
-         * prefixed with the Message header. */
-        const size_t output_size = deflateBound(&strm, b.size_bytes());
-        obuf = ss::temporary_buffer<char>(output_size);
+    return compress(b, default_level);
+}
+
+iobuf gzip_compressor::compress(const iobuf& b, int level) {
+    auto& def = compression_codec();
+    def.reset(level);
+    z_stream& strm = def.stream();
+    /* Calculate maximum compressed size and
+     * allocate an output buffer accordingly, being
+     * prefixed with the Message header. */
+    const size_t output_size = deflateBound(&strm, b.size_bytes());
+    ss::temporary_buffer<char> obuf(output_size);
+
+    // NOLINTNEXTLINE
+    strm.next_out = (unsigned char*)obuf.get_write();
+    strm.avail_out = output_size;
 
+    /* Iterate through each segment and compress it. */
+    for (auto& io : b) {
+        // zlib is not const correct
         // NOLINTNEXTLINE
-        strm.next_out = (unsigned char*)obuf.get_write();
-        strm.avail_out = output_size;
-
-        /* Iterate through each segment and compress it. */
-        for (auto& io : b) {
-            // zlib is not const correct
-            // NOLINTNEXTLINE
-            strm.next_in = (unsigned char*)io.get();
-            strm.avail_in = io.size();
-            throw_if_zstream_error(
-              "gzip error compressing chunk: {}", deflate(&strm, Z_NO_FLUSH));
-        }
-        /* Finish the compression */
-        if (int ret = deflate(&strm, Z_FINISH); ret != Z_STREAM_END) {
-            throw_if_zstream_error("gzip error finishing compression: {}", ret);
-        }
-        obuf.trim(def.stream().total_out);
-        // trigger deflateEnd
+        strm.next_in = (unsigned char*)io.get();
+        strm.avail_in = io.size();
+        throw_if_zstream_error(
+          "gzip error compressing chunk: {}", deflate(&strm, Z_NO_FLUSH));
     }
+    /* Finish the compression */
+    if (int ret = deflate(&strm, Z_FINISH); ret != Z_STREAM_END) {
+        throw_if_zstream_error("gzip error finishing compression: {}", ret);
+    }
+    obuf.trim(strm.total_out);
     iobuf ret;
     ret.append(std::move(obuf));
     return ret;
 }
 
-void gzip_decompression_codec::inflate_to(char* output, size_t out_size) {
-    size_t consumed_bytes = 0;
-    int code = 0;
-    // NOLINTNEXTLINE
-    auto out = reinterpret_cast<unsigned char*>(output);
-    do {
+iobuf gzip_decompression_codec::inflate_all(const iobuf& b) {
+    iobuf ret;
+    size_t step = std::clamp(
+      b.size_bytes() * 2,
+      details::io_allocation_size::default_chunk_size,
+      details::io_allocation_size::max_chunk_size);
+    ss::temporary_buffer<char> obuf(step);
+    size_t out_pos = 0;
+    int code = Z_OK;
+    auto inflate_some = [&] {
+        if (out_pos == obuf.size()) {
+            ret.append(std::move(obuf));
+            step = details::io_allocation_size::next_allocation_size(step);
+            obuf = ss::temporary_buffer<char>(step);
+            out_pos = 0;
+        }
         // NOLINTNEXTLINE
-        _stream.next_out = out + consumed_bytes;
-        _stream.avail_out = out_size - consumed_bytes;
+        _stream.next_out = (unsigned char*)obuf.get_write() + out_pos;
+        _stream.avail_out = obuf.size() - out_pos;
         code = inflate(&_stream, Z_NO_FLUSH);
         switch (code) {
         case Z_STREAM_ERROR:
@@ -178,45 +190,37 @@ void gzip_decompression_codec::inflate_to(char* output, size_t out_size) {
             throw_zstream_error("gzip uncmpress error:{}", code);
         default: /*do nothing*/;
         }
-        /* Advance output pointer (in pass 2). */
-        consumed_bytes = out_size - _stream.avail_out - consumed_bytes;
-    } while (_stream.avail_out == 0 && code != Z_STREAM_END);
-}
-
-static ss::temporary_buffer<char>
-buffer_for_input(const char* src, size_t src_size) {
-    auto codec = gzip_decompression_codec(src, src_size);
-    codec.reset();
-    std::array<char, 512> dummy_buf{};
-    // find gzip header
-    codec.inflate_to(dummy_buf.data(), dummy_buf.size());
-    return ss::temporary_buffer<char>(codec.stream().total_out);
-}
-
-static iobuf do_uncompress(const char* src, size_t src_size) {
-    ss::temporary_buffer<char> buf;
-    {
-        auto codec = gzip_decompression_codec(src, src_size);
-        codec.reset();
-        buf = buffer_for_input(src, src_size);
-        // main data decompression
-        codec.inflate_to(buf.get_write(), buf.size());
+        out_pos = obuf.size() - _stream.avail_out;
+    };
+    for (auto& frag : b) {
+        // zlib is not const correct
+        // NOLINTNEXTLINE
+        _stream.next_in = (unsigned char*)frag.get();
+        _stream.avail_in = frag.size();
+        // the output may fill up with input left, drain it before moving on
+        while (_stream.avail_in > 0 && code != Z_STREAM_END) {
+            inflate_some();
+        }
+    }
+    // output that did not fit is still held by the stream
+    _stream.avail_in = 0;
+    while (code == Z_OK && out_pos == obuf.size()) {
+        inflate_some();
+    }
+    if (unlikely(code != Z_STREAM_END)) {
+        throw std::runtime_error(fmt::format(
+          "gzip error. truncated stream of {} bytes", b.size_bytes()));
+    }
+    obuf.trim(out_pos);
+    if (!obuf.empty()) {
+        ret.append(std::move(obuf));
     }
-    iobuf ret;
-    ret.append(std::move(buf));
     return ret;
 }
 
 iobuf gzip_compressor::uncompress(const iobuf& b) {
-    if (std::distance(b.begin(), b.end()) == 1) {
-        return do_uncompress(b.begin()->get(), b.size_bytes());
-    }
-    // linearize buffer
-    // TODO: use streaming interface instead
-    auto linearized = iobuf_to_bytes(b);
-    return do_uncompress(
-      // NOLINTNEXTLINE
-      reinterpret_cast<const char*>(linearized.data()),
-      linearized.size());
+    auto& codec = decompression_codec();
+    codec.reset();
+    return codec.inflate_all(b);
 }
 } // namespace compression::internal
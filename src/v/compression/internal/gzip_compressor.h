@@ -11,10 +11,17 @@
 
 #pragma once
 #include "bytes/iobuf.h"
+
+#include <zlib.h>
+
 namespace compression::internal {
 
 struct gzip_compressor {
+    static constexpr int default_level = Z_DEFAULT_COMPRESSION;
+
     static iobuf compress(const iobuf&);
+    /// \brief level as in deflateInit2, 0 to 9
+    static iobuf compress(const iobuf&, int level);
     static iobuf uncompress(const iobuf&);
 };
 } // namespace compression::internal
@@ -10,6 +10,7 @@
 #include "compression/internal/lz4_frame_compressor.h"
 
 #include "bytes/bytes.h"
+#include "bytes/details/io_allocation_size.h"
 #include "compression/logger.h"
 #include "static_deleter_fn.h"
 #include "units.h"
@@ -21,6 +22,9 @@
 #include <lz4.h>
 #include <lz4frame.h>
 
+#include <array>
+#include <utility>
+
 namespace compression::internal {
 // from frameCompress.c
 static constexpr size_t lz4f_header_size = 19;
@@ -66,13 +70,29 @@ static lz4_decompression_ctx make_decompression_context() {
     return lz4_decompression_ctx(c);
 }
 
+// contexts are reused by every frame of the shard, a context starts a new
+// frame with every LZ4F_compressBegin and after a reset
+static LZ4F_cctx* compression_context() {
+    static thread_local lz4_compression_ctx ctx = make_compression_context();
+    return ctx.get();
+}
+
+static LZ4F_dctx* decompression_context() {
+    static thread_local lz4_decompression_ctx ctx
+      = make_decompression_context();
+    return ctx.get();
+}
+
 iobuf lz4_frame_compressor::compress(const iobuf& b) {
-    auto ctx_ptr = make_compression_context();
-    LZ4F_compressionContext_t ctx = ctx_ptr.get();
+    return compress(b, default_level);
+}
+
+iobuf lz4_frame_compressor::compress(const iobuf& b, int level) {
+    LZ4F_compressionContext_t ctx = compression_context();
     /* Required by Kafka */
     LZ4F_preferences_t prefs;
     std::memset(&prefs, 0, sizeof(prefs));
-    prefs.compressionLevel = 1; // default
+    prefs.compressionLevel = level;
     prefs.frameInfo = {
       .blockMode = LZ4F_blockIndependent, .contentSize = b.size_bytes()};
     const size_t output_buffer_size = LZ4F_compressBound(b.size_bytes(), &prefs)
@@ -120,96 +140,94 @@ compute_frame_uncompressed_size(size_t frame_size, size_t original) {
     return frame_size;
 }
 
-static iobuf do_uncompressed(const char* src, const size_t src_size) {
-    auto ctx_ptr = make_decompression_context();
-    LZ4F_decompressionContext_t ctx = ctx_ptr.get();
+/// reads the frame header, returns the number of input bytes it took and
+/// the size of the first output fragment
+static std::pair<size_t, size_t>
+read_frame_info(LZ4F_dctx* ctx, const iobuf& b) {
+    std::array<char, LZ4F_HEADER_SIZE_MAX> hdr{};
+    size_t in_sz = std::min(hdr.size(), b.size_bytes());
+    auto consumer = iobuf::iterator_consumer(b.cbegin(), b.cend());
+    consumer.consume_to(in_sz, hdr.data());
     LZ4F_frameInfo_t fi;
-    size_t in_sz = src_size;
-    LZ4F_errorCode_t code = LZ4F_getFrameInfo(ctx, &fi, src, &in_sz);
+    LZ4F_errorCode_t code = LZ4F_getFrameInfo(ctx, &fi, hdr.data(), &in_sz);
     check_lz4_error("lz4f_getframeinfo error: {}", code);
-    size_t estimated_output_size = compute_frame_uncompressed_size(
-      fi.contentSize, src_size);
-    ss::temporary_buffer<char> obuf(estimated_output_size);
-    char* out = obuf.get_write();
-    /* Decompress input buffer t o output buffer until input is exhausted. */
+    return {
+      in_sz,
+      std::min(
+        compute_frame_uncompressed_size(fi.contentSize, b.size_bytes()),
+        details::io_allocation_size::max_chunk_size)};
+}
+
+iobuf lz4_frame_compressor::uncompress(const iobuf& b) {
+    LZ4F_decompressionContext_t ctx = decompression_context();
+    // a frame that failed to decompress leaves the context mid frame
+    LZ4F_resetDecompressionContext(ctx);
+    auto [header_size, step] = read_frame_info(ctx, b);
 
-    size_t bytes_remaining = in_sz;
-    size_t consumed_bytes = 0;
-    while (bytes_remaining < src_size) {
-        size_t step_output_bytes = estimated_output_size - consumed_bytes;
-        size_t step_remaining_bytes = src_size - bytes_remaining;
+    // the input is decompressed fragment by fragment without linearizing
+    // it, output fragments are appended to the result as they fill up
+    iobuf ret;
+    ss::temporary_buffer<char> obuf(step);
+    size_t out_pos = 0;
+    size_t code = 1;
+    // returns the number of input bytes consumed and of output bytes made
+    auto decompress_some = [&](const char* src, size_t in_size) {
+        if (out_pos == obuf.size()) {
+            ret.append(std::move(obuf));
+            step = details::io_allocation_size::next_allocation_size(step);
+            obuf = ss::temporary_buffer<char>(step);
+            out_pos = 0;
+        }
+        size_t out_size = obuf.size() - out_pos;
         code = LZ4F_decompress(
           ctx,
           // NOLINTNEXTLINE
-          out + consumed_bytes,
-          &step_output_bytes,
-          // NOLINTNEXTLINE
-          src + bytes_remaining,
-          &step_remaining_bytes,
+          obuf.get_write() + out_pos,
+          &out_size,
+          src,
+          &in_size,
           nullptr);
         check_lz4_error("lz4f_decompress error: {}", code);
-        vassert(
-          consumed_bytes + step_output_bytes <= estimated_output_size,
-          "Appended more bytes that allowed. Max:{}, consumed:{}",
-          estimated_output_size,
-          consumed_bytes + step_output_bytes);
-        vassert(
-          bytes_remaining <= src_size,
-          "Consumed more bytes than input. Max:{}, consumed:{}",
-          src_size,
-          bytes_remaining);
-        consumed_bytes += step_output_bytes;
-        bytes_remaining += step_remaining_bytes;
-        if (code == 0) {
-            break;
+        out_pos += out_size;
+        return std::make_pair(in_size, out_size);
+    };
+    size_t skip = header_size;
+    for (auto& frag : b) {
+        const char* src = frag.get();
+        size_t remaining = frag.size();
+        if (skip > 0) {
+            const auto n = std::min(skip, remaining);
+            src += n; // NOLINT
+            remaining -= n;
+            skip -= n;
+        }
+        while (remaining > 0 && code != 0) {
+            const auto consumed = decompress_some(src, remaining).first;
+            src += consumed; // NOLINT
+            remaining -= consumed;
         }
-        /* Need to grow output buffer, this shouldn't happen if
-         * contentSize was properly set. Happens all of the time with the
-         * console producer 2.3.1 and below*/
-        if (consumed_bytes == estimated_output_size) {
-            // TODO: add probes for re-growth
-            const size_t next_size = 1_KiB /*slack*/
-                                     + ((estimated_output_size * 3) + 1) / 2;
-            vlog(
-              complog.trace,
-              "Consumed bytes:{} has reached preallocated size. Growing to "
-              "size:{}",
-              consumed_bytes,
-              next_size);
-            ss::temporary_buffer<char> tmpo(next_size);
-            std::copy_n(obuf.get(), consumed_bytes, tmpo.get_write());
-            obuf = std::move(tmpo);
-            // update the pointer back to the original position
-            out = obuf.get_write();
-            estimated_output_size = next_size;
+        if (remaining > 0) {
+            throw std::runtime_error(fmt::format(
+              "lz4 error. could not consume all input bytes in "
+              "decompression. Input:{}, left:{}",
+              b.size_bytes(),
+              remaining));
         }
     }
-
-    if (unlikely(bytes_remaining < src_size)) {
-        throw std::runtime_error(fmt::format(
-          "lz4 error. could not consume all input bytes in decompression. "
-          "Input:{}, consumed:{}",
-          src_size,
-          bytes_remaining));
+    // a block larger than the space left is decoded into the context and
+    // handed out over several calls
+    while (code != 0) {
+        const auto produced = decompress_some(nullptr, 0).second;
+        if (produced == 0 && out_pos != obuf.size()) {
+            throw std::runtime_error(fmt::format(
+              "lz4 error. truncated frame of {} bytes", b.size_bytes()));
+        }
     }
-
-    obuf.trim(consumed_bytes);
-    iobuf ret;
-    ret.append(std::move(obuf));
-    return ret;
-}
-
-iobuf lz4_frame_compressor::uncompress(const iobuf& b) {
-    if (std::distance(b.begin(), b.end()) == 1) {
-        return do_uncompressed(b.begin()->get(), b.size_bytes());
+    obuf.trim(out_pos);
+    if (!obuf.empty()) {
+        ret.append(std::move(obuf));
     }
-    // linearize buffer
-    // TODO: optimize iobuf
-    auto linearized = iobuf_to_bytes(b);
-    return do_uncompressed(
-      // NOLINTNEXTLINE
-      reinterpret_cast<const char*>(linearized.data()),
-      linearized.size());
+    return ret;
 }
 
 } // namespace compression::internal
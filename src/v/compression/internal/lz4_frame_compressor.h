@@ -14,7 +14,11 @@
 namespace compression::internal {
 
 struct lz4_frame_compressor {
+    static constexpr int default_level = 0;
+
     static iobuf compress(const iobuf&);
+    /// \brief level as in LZ4F_preferences_t::compressionLevel
+    static iobuf compress(const iobuf&, int level);
     static iobuf uncompress(const iobuf&);
 };
 
@@ -15,13 +15,17 @@
 namespace compression::internal {
 
 struct zstd_compressor {
-    static iobuf compress(const iobuf& b) {
-        stream_zstd fn;
-        return fn.compress(b);
+    static constexpr int default_level = stream_zstd::default_level;
+
+    static iobuf compress(const iobuf& b, int level = default_level) {
+        return local().compress(b, level);
     }
-    static iobuf uncompress(const iobuf& b) {
-        stream_zstd fn;
-        return fn.uncompress(b);
+    static iobuf uncompress(const iobuf& b) { return local().uncompress(b); }
+
+private:
+    static stream_zstd& local() {
+        static thread_local stream_zstd fn;
+        return fn;
     }
 };
 
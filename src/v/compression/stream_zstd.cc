@@ -60,9 +60,19 @@ stream_zstd::zstd_decompress_ctx& stream_zstd::decompressor() {
     return _decompress;
 }
 
-iobuf stream_zstd::do_compress(const iobuf& x) {
-    reset_compressor();
+iobuf stream_zstd::do_compress(
+  const iobuf& x, int level, const zstd_dictionary* dict) {
     ZSTD_CCtx* ctx = compressor().get();
+    // drops the state and dictionary of the last frame but keeps the
+    // context memory
+    throw_if_error(ZSTD_CCtx_reset(ctx, ZSTD_reset_session_and_parameters));
+    if (dict) {
+        // the level the dictionary was digested with applies
+        throw_if_error(ZSTD_CCtx_refCDict(ctx, dict->cdict()));
+    } else {
+        throw_if_error(
+          ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, level));
+    }
     // NOTE: always enable content size. **decompression** depends on this
     throw_if_error(ZSTD_CCtx_setPledgedSrcSize(ctx, x.size_bytes()));
     // zstd requires linearized memory
@@ -83,14 +93,20 @@ iobuf stream_zstd::do_compress(const iobuf& x) {
     return ret;
 }
 
-size_t find_zstd_size(const iobuf& x) {
+// defined in zstd.h ONLY under static allocation - sigh
+// our v::compression defines that public define
+using zstd_frame_header = std::array<char, ZSTD_FRAMEHEADERSIZE_MAX>;
+
+static zstd_frame_header read_frame_header(const iobuf& x) {
     auto consumer = iobuf::iterator_consumer(x.cbegin(), x.cend());
-    // defined in zstd.h ONLY under static allocation - sigh
-    // our v::compression defines that public define
-    std::array<char, ZSTD_FRAMEHEADERSIZE_MAX> sz_arr{};
-    consumer.consume_to(std::min(sz_arr.size(), x.size_bytes()), sz_arr.data());
+    zstd_frame_header hdr{};
+    consumer.consume_to(std::min(hdr.size(), x.size_bytes()), hdr.data());
+    return hdr;
+}
+
+static size_t find_zstd_size(const iobuf& x, const zstd_frame_header& hdr) {
     auto zstd_size = ZSTD_getFrameContentSize(
-      static_cast<const void*>(sz_arr.data()), x.size_bytes());
+      static_cast<const void*>(hdr.data()), x.size_bytes());
     if (zstd_size == ZSTD_CONTENTSIZE_ERROR) {
         throw std::runtime_error(fmt::format(
           "Cannot decompress. Not compressed by zstd. iobuf:{}", x));
@@ -101,8 +117,9 @@ size_t find_zstd_size(const iobuf& x) {
     }
     return zstd_size;
 }
-size_t decompression_step(const iobuf& x) {
-    size_t ret = find_zstd_size(x);
+static size_t
+decompression_step(const iobuf& x, const zstd_frame_header& hdr) {
+    size_t ret = find_zstd_size(x, hdr);
     if (ret == 0) {
         // Note that this is a similar algorithm that kafka uses. Turns out that
         // the library that kafka uses (JNI) to load up Zstd doesn't set the
@@ -133,10 +150,24 @@ iobuf stream_zstd::do_uncompress(const iobuf& x) {
         throw std::runtime_error(
           "Asked to stream_zstd::uncompress empty buffer");
     }
-    reset_decompressor();
     ZSTD_DCtx* dctx = decompressor().get();
+    throw_if_error(ZSTD_DCtx_reset(dctx, ZSTD_reset_session_only));
+    const auto hdr = read_frame_header(x);
+    zstd_dictionary_ptr dict;
+    const auto dict_id = ZSTD_getDictID_fromFrame(
+      hdr.data(), std::min(hdr.size(), x.size_bytes()));
+    if (dict_id != 0) {
+        dict = zstd_dictionaries::local().find(dict_id);
+        if (!dict) {
+            throw std::runtime_error(fmt::format(
+              "Cannot decompress. zstd dictionary {} is not loaded", dict_id));
+        }
+    }
+    // a null dictionary detaches the one of the previous frame
+    throw_if_error(
+      ZSTD_DCtx_refDDict(dctx, dict ? dict->ddict() : nullptr));
     iobuf ret;
-    ss::temporary_buffer<char> obuf(decompression_step(x));
+    ss::temporary_buffer<char> obuf(decompression_step(x, hdr));
     ZSTD_outBuffer out = {
       .dst = obuf.get_write(), .size = obuf.size(), .pos = 0};
     for (auto& ibuf : x) {
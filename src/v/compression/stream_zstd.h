@@ -11,6 +11,7 @@
 
 #pragma once
 #include "bytes/iobuf.h"
+#include "compression/zstd_dictionary.h"
 #include "static_deleter_fn.h"
 
 #include <memory>
@@ -28,13 +29,28 @@ public:
       // wrap ZSTD C API
       static_sized_deleter_fn<ZSTD_DCtx, &ZSTD_freeDCtx>>;
 
-    iobuf compress(const iobuf& b) { return do_compress(b); }
+    static constexpr int default_level = ZSTD_CLEVEL_DEFAULT;
+
+    /// \brief the contexts are created on first use and reused by every
+    /// later call, keep an instance around rather than one per buffer
+    iobuf compress(const iobuf& b, int level = default_level) {
+        return do_compress(b, level);
+    }
     iobuf uncompress(const iobuf& b) { return do_uncompress(b); }
-    iobuf compress(iobuf&& b) { return do_compress(b); }
+    iobuf compress(iobuf&& b, int level = default_level) {
+        return do_compress(b, level);
+    }
     iobuf uncompress(iobuf&& b) { return do_uncompress(b); }
 
+    /// \brief the frame names the dictionary, uncompress() looks it up in
+    /// zstd_dictionaries::local()
+    iobuf compress(const iobuf& b, const zstd_dictionary& d) {
+        return do_compress(b, default_level, &d);
+    }
+
 private:
-    iobuf do_compress(const iobuf&);
+    iobuf
+    do_compress(const iobuf&, int level, const zstd_dictionary* = nullptr);
     iobuf do_uncompress(const iobuf&);
 
     void reset_compressor();
@@ -0,0 +1,355 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "compression/compression.h"
+#include "compression/stream_zstd.h"
+#include "bytes/bytes.h"
+#include "compression/zstd_dictionary.h"
+#include "random/generators.h"
+#include "units.h"
+#include "vassert.h"
+
+#include <seastar/core/memory.hh>
+#include <seastar/core/temporary_buffer.hh>
+#include <seastar/testing/perf_tests.hh>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Codecs behind compression::compressor over payloads that look like what
+ * producers send:
+ *
+ *   - json: small json documents of a few fields
+ *   - binary: avro-like records, zigzag varints, length prefixed strings and
+ *     doubles
+ *   - random: incompressible bytes
+ *
+ * from 4KiB to 1MiB, in one fragment, and for 64KiB of json also in 4KiB and
+ * 128 byte fragments. The zstd codec is also run with a dictionary trained on
+ * the json documents.
+ *
+ *   compression_bench -c 1
+ *
+ * perf_tests reports the time per op. The throughput, compression ratio and
+ * allocations per op of the measured sections are printed at the end of the
+ * run.
+ */
+
+namespace {
+
+class codec_report {
+public:
+    codec_report() = default;
+    codec_report(const codec_report&) = delete;
+    codec_report& operator=(const codec_report&) = delete;
+    codec_report(codec_report&&) = delete;
+    codec_report& operator=(codec_report&&) = delete;
+
+    ~codec_report() {
+        if (_tests.empty()) {
+            return;
+        }
+        fmt::print(
+          "\n{:<40} {:>10} {:>8} {:>10}\n",
+          "test",
+          "MB/s",
+          "ratio",
+          "allocs/op");
+        for (const auto& [name, e] : _tests) {
+            auto seconds = std::chrono::duration<double>(e.elapsed).count();
+            fmt::print(
+              "{:<40} {:>10.1f} {:>8.2f} {:>10.1f}\n",
+              name,
+              double(e.uncompressed) / seconds / 1_MiB,
+              double(e.uncompressed) / double(e.compressed),
+              double(e.allocs) / double(e.ops));
+        }
+    }
+
+    void add(
+      std::string_view test,
+      std::chrono::nanoseconds elapsed,
+      uint64_t allocs,
+      size_t uncompressed,
+      size_t compressed) {
+        auto& e = _tests[std::string(test)];
+        e.elapsed += elapsed;
+        e.allocs += allocs;
+        e.uncompressed += uncompressed;
+        e.compressed += compressed;
+        ++e.ops;
+    }
+
+private:
+    struct entry {
+        std::chrono::nanoseconds elapsed{0};
+        uint64_t allocs{0};
+        uint64_t uncompressed{0};
+        uint64_t compressed{0};
+        uint64_t ops{0};
+    };
+    std::map<std::string, entry> _tests;
+};
+
+codec_report report;
+
+enum class payload { json, binary, random };
+
+std::string json_documents(size_t size) {
+    static constexpr std::array<std::string_view, 6> tags{
+      "new", "returning", "mobile", "web", "trial", "premium"};
+    std::string out;
+    out.reserve(size + 256);
+    int64_t ts = 1618000000000;
+    while (out.size() < size) {
+        auto id = random_generators::get_int(1'000'000);
+        ts += random_generators::get_int(1000);
+        fmt::format_to(
+          std::back_inserter(out),
+          R"({{"id":{},"user":"user-{}","email":"user-{}@example.com",)"
+          R"("active":{},"score":{:.2f},"tags":["{}","{}"],"ts":{}}})",
+          id,
+          id,
+          id,
+          id % 2 == 0,
+          random_generators::get_int(10000) / 100.0,
+          tags[id % tags.size()],
+          tags[(id / 7) % tags.size()],
+          ts);
+    }
+    out.resize(size);
+    return out;
+}
+
+void put_varint(std::string& out, int64_t v) {
+    auto zz = (uint64_t(v) << 1) ^ uint64_t(v >> 63);
+    while (zz >= 0x80) {
+        out.push_back(char(zz | 0x80));
+        zz >>= 7;
+    }
+    out.push_back(char(zz));
+}
+
+std::string binary_records(size_t size) {
+    static constexpr std::array<std::string_view, 4> countries{
+      "germany", "france", "brazil", "japan"};
+    std::string out;
+    out.reserve(size + 64);
+    int64_t ts = 1618000000000;
+    while (out.size() < size) {
+        auto id = random_generators::get_int(1'000'000);
+        put_varint(out, id);
+        auto name = fmt::format("user-{}", id);
+        put_varint(out, int64_t(name.size()));
+        out += name;
+        auto country = countries[id % countries.size()];
+        put_varint(out, int64_t(country.size()));
+        out += country;
+        double amount = random_generators::get_int(100000) / 100.0;
+        std::array<char, sizeof(double)> raw;
+        std::memcpy(raw.data(), &amount, raw.size());
+        out.append(raw.data(), raw.size());
+        out.push_back(char(id % 2));
+        ts += random_generators::get_int(1000);
+        put_varint(out, ts);
+    }
+    out.resize(size);
+    return out;
+}
+
+const std::string& corpus(payload p, size_t size) {
+    static std::map<std::pair<payload, size_t>, std::string> corpora;
+    auto& data = corpora[{p, size}];
+    if (data.empty()) {
+        switch (p) {
+        case payload::json:
+            data = json_documents(size);
+            break;
+        case payload::binary:
+            data = binary_records(size);
+            break;
+        case payload::random: {
+            auto b = random_generators::get_bytes(size);
+            data.assign(reinterpret_cast<const char*>(b.data()), b.size());
+            break;
+        }
+        }
+    }
+    return data;
+}
+
+/// the data in fragments of the given size
+iobuf fragmented(std::string_view data, size_t fragment) {
+    iobuf out;
+    for (size_t i = 0; i < data.size(); i += fragment) {
+        auto n = std::min(fragment, data.size() - i);
+        iobuf f;
+        f.append(ss::temporary_buffer<char>(data.data() + i, n));
+        out.append_fragments(std::move(f));
+    }
+    vassert(
+      out.size_bytes() == data.size(), "input of {} bytes", out.size_bytes());
+    return out;
+}
+
+iobuf make_input(payload p, size_t size, size_t fragment) {
+    return fragmented(corpus(p, size), fragment);
+}
+
+/// measures one op, its result is destroyed out of the measured section
+template<typename Func>
+void measure(std::string_view test, size_t input, bool compress, Func&& f) {
+    const auto mallocs = ss::memory::stats().mallocs();
+    const auto start = std::chrono::steady_clock::now();
+    perf_tests::start_measuring_time();
+    auto result = f();
+    perf_tests::do_not_optimize(result);
+    perf_tests::stop_measuring_time();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const auto allocs = ss::memory::stats().mallocs() - mallocs;
+    report.add(
+      test,
+      elapsed,
+      allocs,
+      compress ? input : result.size_bytes(),
+      compress ? result.size_bytes() : input);
+}
+
+} // namespace
+
+template<model::compression codec>
+struct codec_bench {
+    static void
+    compress(std::string_view test, payload p, size_t size, size_t fragment) {
+        auto input = make_input(p, size, fragment);
+        measure(test, size, true, [&input] {
+            return compression::compressor::compress(input, codec);
+        });
+    }
+
+    static void
+    uncompress(std::string_view test, payload p, size_t size, size_t fragment) {
+        // the compressed input is in fragments of the same size
+        auto frame = iobuf_to_bytes(compression::compressor::compress(
+          make_input(p, size, fragment), codec));
+        auto compressed = fragmented(
+          std::string_view(
+            reinterpret_cast<const char*>(frame.data()), frame.size()),
+          fragment);
+        const auto compressed_size = compressed.size_bytes();
+        measure(test, compressed_size, false, [&compressed] {
+            return compression::compressor::uncompress(compressed, codec);
+        });
+    }
+};
+
+using gzip = codec_bench<model::compression::gzip>;
+using snappy = codec_bench<model::compression::snappy>;
+using lz4 = codec_bench<model::compression::lz4>;
+using zstd = codec_bench<model::compression::zstd>;
+
+#define CODEC_CASE(codec, p, size_name, size, layout, fragment)                \
+    PERF_TEST_F(codec, p##_##size_name##_##layout##_compress) {                \
+        compress(                                                              \
+          #codec "." #p "_" #size_name "_" #layout "_compress",                \
+          payload::p,                                                          \
+          size,                                                                \
+          fragment);                                                           \
+    }                                                                          \
+    PERF_TEST_F(codec, p##_##size_name##_##layout##_uncompress) {              \
+        uncompress(                                                            \
+          #codec "." #p "_" #size_name "_" #layout "_uncompress",              \
+          payload::p,                                                          \
+          size,                                                                \
+          fragment);                                                           \
+    }
+
+#define CODEC_SIZES(codec, p)                                                  \
+    CODEC_CASE(codec, p, 4k, 4_KiB, whole, 4_KiB)                              \
+    CODEC_CASE(codec, p, 64k, 64_KiB, whole, 64_KiB)                           \
+    CODEC_CASE(codec, p, 1m, 1_MiB, whole, 1_MiB)
+
+#define CODEC_MATRIX(codec)                                                    \
+    CODEC_SIZES(codec, json)                                                   \
+    CODEC_SIZES(codec, binary)                                                 \
+    CODEC_SIZES(codec, random)                                                 \
+    CODEC_CASE(codec, json, 64k, 64_KiB, frag4k, 4_KiB)                        \
+    CODEC_CASE(codec, json, 64k, 64_KiB, frag128, 128)
+
+CODEC_MATRIX(gzip)
+CODEC_MATRIX(snappy)
+CODEC_MATRIX(lz4)
+CODEC_MATRIX(zstd)
+
+/// zstd frames of json documents with a dictionary trained on other
+/// documents, as small batches of similar records would be
+struct zstd_dict {
+    zstd_dict()
+      : dict(ss::make_lw_shared<const compression::zstd_dictionary>(train())) {
+        compression::zstd_dictionaries::local().add(dict);
+    }
+    zstd_dict(const zstd_dict&) = delete;
+    zstd_dict& operator=(const zstd_dict&) = delete;
+    zstd_dict(zstd_dict&&) = delete;
+    zstd_dict& operator=(zstd_dict&&) = delete;
+    ~zstd_dict() { compression::zstd_dictionaries::local().remove(dict->id()); }
+
+    static compression::zstd_dictionary train() {
+        std::vector<iobuf> samples;
+        for (int i = 0; i < 2000; ++i) {
+            auto doc = json_documents(200);
+            iobuf sample;
+            sample.append(doc.data(), doc.size());
+            samples.push_back(std::move(sample));
+        }
+        return compression::zstd_dictionary::train(samples);
+    }
+
+    void compress(std::string_view test, size_t size) {
+        auto input = make_input(payload::json, size, size);
+        measure(test, size, true, [this, &input] {
+            return codec.compress(input, *dict);
+        });
+    }
+
+    void uncompress(std::string_view test, size_t size) {
+        auto compressed = codec.compress(
+          make_input(payload::json, size, size), *dict);
+        const auto compressed_size = compressed.size_bytes();
+        measure(test, compressed_size, false, [this, &compressed] {
+            return codec.uncompress(compressed);
+        });
+    }
+
+    compression::zstd_dictionary_ptr dict;
+    compression::stream_zstd codec;
+};
+
+PERF_TEST_F(zstd_dict, json_1k_compress) {
+    compress("zstd_dict.json_1k_compress", 1_KiB);
+}
+PERF_TEST_F(zstd_dict, json_1k_uncompress) {
+    uncompress("zstd_dict.json_1k_uncompress", 1_KiB);
+}
+PERF_TEST_F(zstd_dict, json_4k_compress) {
+    compress("zstd_dict.json_4k_compress", 4_KiB);
+}
+PERF_TEST_F(zstd_dict, json_4k_uncompress) {
+    uncompress("zstd_dict.json_4k_uncompress", 4_KiB);
+}
@@ -7,18 +7,23 @@
 // the Business Source License, use of this software will be governed
 // by the Apache License, Version 2.0
 
+#include "bytes/bytes.h"
+#include "compression/compression.h"
 #include "compression/internal/gzip_compressor.h"
 #include "compression/internal/lz4_frame_compressor.h"
 #include "compression/internal/snappy_java_compressor.h"
 #include "compression/internal/zstd_compressor.h"
 #include "compression/snappy_standard_compressor.h"
 #include "compression/stream_zstd.h"
+#include "compression/zstd_dictionary.h"
 #include "random/generators.h"
 #include "units.h"
 #include "vassert.h"
 
 #include <seastar/testing/thread_test_case.hh>
 
+#include <cstring>
+
 static inline constexpr std::array<size_t, 12> sizes{{
   0,
   8,
@@ -65,9 +70,44 @@ SEASTAR_THREAD_TEST_CASE(stream_zstd_test) {
     }
 }
 
+// the codecs have overloads taking a level
+template<typename Codec>
+inline void roundtrip_compression() {
+    roundtrip_compression(
+      [](const iobuf& b) { return Codec::compress(b); },
+      [](const iobuf& b) { return Codec::uncompress(b); });
+}
+
+/// \brief splits the buffer in separately allocated fragments of at most
+/// `frag` bytes, so that codecs cannot treat it as contiguous memory
+static inline iobuf fragmented(const iobuf& b, size_t frag) {
+    auto linear = iobuf_to_bytes(b);
+    iobuf ret;
+    for (size_t i = 0; i < linear.size(); i += frag) {
+        const auto n = std::min(frag, linear.size() - i);
+        ss::temporary_buffer<char> tmp(n);
+        std::memcpy(tmp.get_write(), linear.data() + i, n);
+        ret.append(std::move(tmp));
+    }
+    return ret;
+}
+
+template<typename Codec>
+inline void roundtrip_fragmented() {
+    // large enough for several output chunks of the streaming decoders
+    for (size_t i : {1_KiB, 300_KiB}) {
+        iobuf buf = gen(i);
+        for (size_t frag : {1, 7, 4_KiB}) {
+            auto cbuf = fragmented(Codec::compress(buf), frag);
+            BOOST_REQUIRE_GT(std::distance(cbuf.begin(), cbuf.end()), 1);
+            BOOST_CHECK_EQUAL(Codec::uncompress(cbuf), buf);
+        }
+    }
+}
+
 SEASTAR_THREAD_TEST_CASE(lz4_block_tests) {
     using fn = compression::internal::lz4_frame_compressor;
-    roundtrip_compression(fn::compress, fn::uncompress);
+    roundtrip_compression<fn>();
 }
 SEASTAR_THREAD_TEST_CASE(snapy_java_test) {
     using fn = compression::internal::snappy_java_compressor;
@@ -79,9 +119,90 @@ SEASTAR_THREAD_TEST_CASE(snapy_std_test) {
 }
 SEASTAR_THREAD_TEST_CASE(zstd_forward_test) {
     using fn = compression::internal::zstd_compressor;
-    roundtrip_compression(fn::compress, fn::uncompress);
+    roundtrip_compression<fn>();
 }
 SEASTAR_THREAD_TEST_CASE(gzip_test) {
     using fn = compression::internal::gzip_compressor;
-    roundtrip_compression(fn::compress, fn::uncompress);
+    roundtrip_compression<fn>();
+}
+SEASTAR_THREAD_TEST_CASE(lz4_fragmented_input_test) {
+    roundtrip_fragmented<compression::internal::lz4_frame_compressor>();
+}
+SEASTAR_THREAD_TEST_CASE(gzip_fragmented_input_test) {
+    roundtrip_fragmented<compression::internal::gzip_compressor>();
+}
+SEASTAR_THREAD_TEST_CASE(zstd_fragmented_input_test) {
+    roundtrip_fragmented<compression::internal::zstd_compressor>();
+}
+SEASTAR_THREAD_TEST_CASE(compression_levels_test) {
+    using compression::compressor;
+    using compression::type;
+    iobuf buf = gen(64_KiB);
+    for (auto t : {type::gzip, type::lz4, type::zstd}) {
+        for (int level : {1, 9}) {
+            auto cbuf = compressor::compress(buf, t, level);
+            BOOST_CHECK_EQUAL(compressor::uncompress(cbuf, t), buf);
+        }
+    }
+}
+SEASTAR_THREAD_TEST_CASE(truncated_input_throws_test) {
+    using compression::compressor;
+    using compression::type;
+    iobuf buf = gen(8_KiB);
+    for (auto t : {type::gzip, type::lz4}) {
+        auto cbuf = compressor::compress(buf, t);
+        cbuf.trim_back(cbuf.size_bytes() / 2);
+        BOOST_CHECK_THROW(compressor::uncompress(cbuf, t), std::runtime_error);
+        // the per shard context recovers from the failed call
+        BOOST_CHECK_EQUAL(
+          compressor::uncompress(compressor::compress(buf, t), t), buf);
+    }
+}
+
+static inline std::vector<iobuf> json_records(size_t n) {
+    std::vector<iobuf> ret;
+    ret.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        auto json = fmt::format(
+          R"({{"user_id":{},"session":"{}","event":"page_view",)"
+          R"("path":"/products/{}","referrer":"search","ok":true}})",
+          i,
+          random_generators::gen_alphanum_string(16),
+          i % 37);
+        iobuf b;
+        b.append(json.data(), json.size());
+        ret.push_back(std::move(b));
+    }
+    return ret;
+}
+
+SEASTAR_THREAD_TEST_CASE(zstd_dictionary_test) {
+    auto samples = json_records(2000);
+    auto dict = ss::make_lw_shared<const compression::zstd_dictionary>(
+      compression::zstd_dictionary::train(samples));
+    BOOST_REQUIRE_NE(dict->id(), 0);
+    compression::zstd_dictionaries::local().add(dict);
+
+    compression::stream_zstd fn;
+    size_t plain = 0;
+    size_t with_dict = 0;
+    for (auto& r : json_records(100)) {
+        auto cbuf = fn.compress(r, *dict);
+        with_dict += cbuf.size_bytes();
+        plain += fn.compress(r).size_bytes();
+        BOOST_CHECK_EQUAL(fn.uncompress(cbuf), r);
+    }
+    BOOST_REQUIRE_LT(with_dict, plain);
+
+    // a reloaded dictionary keeps its version
+    compression::zstd_dictionary reloaded(dict->content());
+    BOOST_REQUIRE_EQUAL(reloaded.id(), dict->id());
+
+    // frames name their dictionary, which must be loaded to read them
+    auto r = json_records(1).front();
+    auto cbuf = fn.compress(r, *dict);
+    compression::zstd_dictionaries::local().remove(dict->id());
+    BOOST_CHECK_THROW(fn.uncompress(cbuf), std::runtime_error);
+    // and the context is usable for frames without one afterwards
+    BOOST_CHECK_EQUAL(fn.uncompress(fn.compress(r)), r);
 }
@@ -0,0 +1,79 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "compression/zstd_dictionary.h"
+
+#include <fmt/format.h>
+
+#include <zdict.h>
+
+#include <algorithm>
+
+namespace compression {
+
+zstd_dictionary::zstd_dictionary(bytes content, int level)
+  : _content(std::move(content))
+  , _id(ZDICT_getDictID(_content.data(), _content.size())) {
+    if (_id == 0) {
+        throw std::runtime_error(fmt::format(
+          "Not a zstd dictionary, {} bytes without a dictionary id",
+          _content.size()));
+    }
+    _cdict.reset(ZSTD_createCDict(_content.data(), _content.size(), level));
+    _ddict.reset(ZSTD_createDDict(_content.data(), _content.size()));
+    if (!_cdict || !_ddict) {
+        throw std::bad_alloc{};
+    }
+}
+
+zstd_dictionary zstd_dictionary::train(
+  const std::vector<iobuf>& samples, size_t capacity, int level) {
+    // the trainer takes the samples back to back
+    size_t total = 0;
+    std::vector<size_t> sizes;
+    sizes.reserve(samples.size());
+    for (const auto& s : samples) {
+        sizes.push_back(s.size_bytes());
+        total += s.size_bytes();
+    }
+    bytes input(bytes::initialized_later{}, total);
+    size_t pos = 0;
+    for (const auto& s : samples) {
+        for (const auto& frag : s) {
+            std::copy_n(frag.get(), frag.size(), input.data() + pos);
+            pos += frag.size();
+        }
+    }
+    bytes dict(bytes::initialized_later{}, capacity);
+    const size_t n = ZDICT_trainFromBuffer(
+      dict.data(), dict.size(), input.data(), sizes.data(), sizes.size());
+    if (ZDICT_isError(n)) {
+        throw std::runtime_error(fmt::format(
+          "zstd dictionary training on {} samples of {} bytes failed: {}",
+          samples.size(),
+          total,
+          ZDICT_getErrorName(n)));
+    }
+    dict.resize(n);
+    return zstd_dictionary(std::move(dict), level);
+}
+
+void zstd_dictionaries::add(zstd_dictionary_ptr d) {
+    const auto id = d->id();
+    _dicts.insert_or_assign(id, std::move(d));
+}
+
+zstd_dictionary_ptr zstd_dictionaries::find(uint32_t id) const {
+    if (auto it = _dicts.find(id); it != _dicts.end()) {
+        return it->second;
+    }
+    return nullptr;
+}
+
+} // namespace compression
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+#include "bytes/bytes.h"
+#include "bytes/iobuf.h"
+#include "seastarx.h"
+#include "static_deleter_fn.h"
+#include "units.h"
+
+#include <seastar/core/shared_ptr.hh>
+
+#include <absl/container/flat_hash_map.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <zstd.h>
+
+namespace compression {
+
+/// \brief a trained zstd dictionary with its digested contexts.
+///
+/// small records share most of their structure with other records but not
+/// with the records of their own batch, a dictionary trained on a sample of
+/// them gives every frame that history up front. the dictionary id is
+/// written into each frame and is the version of the dictionary: readers
+/// pick the dictionary a frame was made with from the registry, so frames of
+/// older versions stay readable for as long as their dictionary is loaded.
+///
+/// frames compressed with a dictionary can only be read by a broker that
+/// has it, never hand them to kafka clients
+class zstd_dictionary {
+public:
+    static constexpr size_t default_capacity = 16_KiB;
+    static constexpr int default_level = ZSTD_CLEVEL_DEFAULT;
+
+    /// \brief throws if the content is not a zstd dictionary
+    explicit zstd_dictionary(bytes content, int level = default_level);
+
+    /// \brief trains a dictionary of at most capacity bytes, typically one
+    /// sample per record value. throws when the samples are too few or too
+    /// small to train on
+    static zstd_dictionary train(
+      const std::vector<iobuf>& samples,
+      size_t capacity = default_capacity,
+      int level = default_level);
+
+    /// \brief never 0, frames without a dictionary have id 0
+    uint32_t id() const { return _id; }
+    /// \brief what is stored to load the dictionary again
+    const bytes& content() const { return _content; }
+
+    const ZSTD_CDict* cdict() const { return _cdict.get(); }
+    const ZSTD_DDict* ddict() const { return _ddict.get(); }
+
+private:
+    using cdict_ptr = std::unique_ptr<
+      ZSTD_CDict,
+      static_sized_deleter_fn<ZSTD_CDict, &ZSTD_freeCDict>>;
+    using ddict_ptr = std::unique_ptr<
+      ZSTD_DDict,
+      static_sized_deleter_fn<ZSTD_DDict, &ZSTD_freeDDict>>;
+
+    bytes _content;
+    uint32_t _id;
+    cdict_ptr _cdict;
+    ddict_ptr _ddict;
+};
+
+using zstd_dictionary_ptr = ss::lw_shared_ptr<const zstd_dictionary>;
+
+/// \brief the dictionaries of a shard by id, consulted by stream_zstd when
+/// a frame names a dictionary
+class zstd_dictionaries {
+public:
+    /// \brief replaces a dictionary with the same id
+    void add(zstd_dictionary_ptr);
+    void remove(uint32_t id) { _dicts.erase(id); }
+    zstd_dictionary_ptr find(uint32_t id) const;
+    size_t size() const { return _dicts.size(); }
+
+    static zstd_dictionaries& local() {
+        static thread_local zstd_dictionaries dicts;
+        return dicts;
+    }
+
+private:
+    absl::flat_hash_map<uint32_t, zstd_dictionary_ptr> _dicts;
+};
+
+} // namespace compression
@@ -20,6 +20,14 @@ configuration::configuration()
     "data_directory",
     "Place where redpanda will keep the data",
     required::yes)
+  , data_directories(
+      *this,
+      "data_directories",
+      "Additional directories for partition data, usually one per disk. New "
+      "partitions are placed on the directory with the fewest partitions of "
+      "the core among those with more than the target free space",
+      required::no,
+      {})
   , developer_mode(
       *this,
       "developer_mode",
@@ -40,6 +48,26 @@ configuration::configuration()
       "256MiB)",
       required::no,
       256_MiB)
+  , log_segment_target_lifetime_ms(
+      *this,
+      "log_segment_target_lifetime_ms",
+      "When set the segment size of every partition follows its ingest rate "
+      "so that active segments are rolled after about this long, within "
+      "log_segment_size_min and log_segment_size_max",
+      required::no,
+      std::nullopt)
+  , log_segment_size_min(
+      *this,
+      "log_segment_size_min",
+      "Smallest segment size of partitions with adaptive segment sizing",
+      required::no,
+      16_MiB)
+  , log_segment_size_max(
+      *this,
+      "log_segment_size_max",
+      "Largest segment size of partitions with adaptive segment sizing",
+      required::no,
+      4_GiB)
   , rpc_server(
       *this,
       "rpc_server",
@@ -79,12 +107,36 @@ configuration::configuration()
       "Maximum amount of bytes to read from one topic read",
       required::no,
       32_KiB)
+  , coproc_max_shared_read_bytes(
+      *this,
+      "coproc_max_shared_read_bytes",
+      "Maximum amount of bytes read from one input partition that are held "
+      "for the other coprocessors subscribed to it",
+      required::no,
+      256_KiB)
+  , coproc_max_script_bytes_per_second(
+      *this,
+      "coproc_max_script_bytes_per_second",
+      "Maximum rate of bytes one coprocessor reads from its inputs on a "
+      "shard, a script over its budget is throttled so that it does not "
+      "starve the others. 0 for no limit",
+      required::no,
+      0)
   , coproc_offset_flush_interval_ms(
       *this,
       "coproc_offset_flush_interval_ms",
       "Interval for which all coprocessor offsets are flushed to disk",
       required::no,
       300000ms) // five minutes
+  , coproc_replicate_materialized(
+      *this,
+      "coproc_replicate_materialized",
+      "Produce the outputs of coprocessors to materialized topics of the "
+      "cluster, replicated with raft and partitioned by the hash of the "
+      "record key, instead of to local logs that mirror the source "
+      "partitions. Outputs are delivered at least once",
+      required::no,
+      false)
   , node_id(
       *this,
       "node_id",
@@ -184,6 +236,63 @@ configuration::configuration()
       "Target quota byte rate (bytes per second) - 2GB default",
       required::no,
       2_GiB)
+  , client_produce_quota_byte_rate(
+      *this,
+      "client_produce_quota_byte_rate",
+      "Produce bytes per second allowed to each client id, 0 disables the "
+      "quota",
+      required::no,
+      0)
+  , client_fetch_quota_byte_rate(
+      *this,
+      "client_fetch_quota_byte_rate",
+      "Fetch response bytes per second allowed to each client id, 0 "
+      "disables the quota",
+      required::no,
+      0)
+  , client_request_quota_rate(
+      *this,
+      "client_request_quota_rate",
+      "Requests per second allowed to each client id, 0 disables the "
+      "quota",
+      required::no,
+      0)
+  , user_produce_quota_byte_rate(
+      *this,
+      "user_produce_quota_byte_rate",
+      "Produce bytes per second allowed to each SASL user, 0 disables the "
+      "quota",
+      required::no,
+      0)
+  , user_fetch_quota_byte_rate(
+      *this,
+      "user_fetch_quota_byte_rate",
+      "Fetch response bytes per second allowed to each SASL user, 0 "
+      "disables the quota",
+      required::no,
+      0)
+  , user_request_quota_rate(
+      *this,
+      "user_request_quota_rate",
+      "Requests per second allowed to each SASL user, 0 disables the "
+      "quota",
+      required::no,
+      0)
+  , quota_manager_sync_ms(
+      *this,
+      "quota_manager_sync_ms",
+      "Interval at which the cores exchange the usage of the produce, fetch "
+      "and request quotas",
+      required::no,
+      std::chrono::milliseconds(100))
+  , produce_admission_weights(
+      *this,
+      "produce_admission_weights",
+      "Weights of the SASL users or client ids, as name=weight, in the fair "
+      "sharing of the request memory of a core between produce requests. "
+      "Unlisted clients weigh 1",
+      required::no,
+      {})
   , rack(*this, "rack", "Rack identifier", required::no, std::nullopt)
   , dashboard_dir(
       *this,
@@ -197,6 +306,21 @@ configuration::configuration()
       "Disable registering metrics",
       required::no,
       false)
+  , aggregate_partition_metrics(
+      *this,
+      "aggregate_partition_metrics",
+      "Export the partition metrics of a core summed per topic instead of per "
+      "partition, only the partitions with the most traffic keep their own "
+      "series",
+      required::no,
+      false)
+  , aggregate_metrics_top_partitions(
+      *this,
+      "aggregate_metrics_top_partitions",
+      "Number of partitions of a core with the most traffic that keep their "
+      "per partition series when the partition metrics are aggregated",
+      required::no,
+      10)
   , group_min_session_timeout_ms(
       *this,
       "group_min_session_timeout_ms",
@@ -227,6 +351,28 @@ configuration::configuration()
       "Timeout for new member joins",
       required::no,
       30'000ms)
+  , group_offset_commit_batch_window_ms(
+      *this,
+      "group_offset_commit_batch_window_ms",
+      "Time offset commits of the groups of a coordinator partition are "
+      "collected for to be replicated as one batch, 0 replicates every commit "
+      "on its own",
+      required::no,
+      2ms)
+  , group_offset_commit_batch_max_bytes(
+      *this,
+      "group_offset_commit_batch_max_bytes",
+      "Size of the collected offset commits of a coordinator partition at "
+      "which they are replicated without waiting for the end of the window",
+      required::no,
+      1_MiB)
+  , group_offset_fetch_replicas(
+      *this,
+      "group_offset_fetch_replicas",
+      "Keep a copy of the committed offsets of every group on all shards, to "
+      "answer offset fetch requests without a hop to the coordinator shard",
+      required::no,
+      true)
   , metadata_dissemination_interval_ms(
       *this,
       "metadata_dissemination_interval_ms",
@@ -286,6 +432,174 @@ configuration::configuration()
       "wasn't reached",
       required::no,
       1ms)
+  , enable_fetch_long_poll(
+      *this,
+      "enable_fetch_long_poll",
+      "Park fetches that did not reach the requested min bytes until one of "
+      "their partitions gets new data instead of polling with "
+      "fetch_reads_debounce_timeout",
+      required::no,
+      true)
+  , fetch_passthrough_reads(
+      *this,
+      "fetch_passthrough_reads",
+      "Serialize fetched batches straight from the file read buffers, "
+      "without materializing them or inserting them into the batch cache",
+      required::no,
+      false)
+  , fetch_read_planning(
+      *this,
+      "fetch_read_planning",
+      "Split the byte budget of a fetch across the partitions of a core "
+      "according to the data each has past its fetch offset instead of "
+      "letting every partition read up to the whole budget",
+      required::no,
+      true)
+  , fetch_read_memory_per_shard(
+      *this,
+      "fetch_read_memory_per_shard",
+      "Memory a core may hold for the data read by fetches before it is sent "
+      "to the consumers. Concurrent fetches share it evenly and read less "
+      "per partition when it runs short. 0 disables the limit",
+      required::no,
+      128_MiB)
+  , fetch_from_followers(
+      *this,
+      "fetch_from_followers",
+      "Serve fetches on followers and redirect consumers that set their rack "
+      "to a replica in the same rack",
+      required::no,
+      false)
+  , fetch_follower_max_staleness_ms(
+      *this,
+      "fetch_follower_max_staleness_ms",
+      "Followers refuse fetches when they did not hear from the leader for "
+      "longer than this",
+      required::no,
+      5s)
+  , fetch_cold_read_offset_lag(
+      *this,
+      "fetch_cold_read_offset_lag",
+      "Fetches that start more than this number of offsets behind the high "
+      "watermark read from disk at the low share kafka_cold_read I/O class. "
+      "Zero disables the demotion",
+      required::no,
+      0)
+  , fetch_low_priority_principals(
+      *this,
+      "fetch_low_priority_principals",
+      "SASL principals whose fetches always read from disk at the low share "
+      "kafka_cold_read I/O class",
+      required::no,
+      {})
+  , enable_shard_balancer(
+      *this,
+      "enable_shard_balancer",
+      "Move the partitions with the most traffic from the busiest core of the "
+      "node to the least busy one",
+      required::no,
+      false)
+  , shard_balancer_interval_ms(
+      *this,
+      "shard_balancer_interval_ms",
+      "Interval of shard balancer load checks, at most one partition is moved "
+      "per check",
+      required::no,
+      60s)
+  , shard_balancer_connection_affinity(
+      *this,
+      "shard_balancer_connection_affinity",
+      "Once the cores are balanced, move partitions to the core that receives "
+      "most of the kafka requests for them so they are served without "
+      "crossing cores. Requires enable_shard_balancer",
+      required::no,
+      false)
+  , enable_load_aware_partition_allocation(
+      *this,
+      "enable_load_aware_partition_allocation",
+      "Place new partition replicas on the nodes and cores with the least "
+      "traffic, leaders and disk usage, as reported by every node, instead of "
+      "only spreading partition counts",
+      required::no,
+      false)
+  , node_load_report_interval_ms(
+      *this,
+      "node_load_report_interval_ms",
+      "Interval of node load reports to the controller leader, a report is "
+      "used for allocation for three intervals. Requires "
+      "enable_load_aware_partition_allocation or enable_node_health_report",
+      required::no,
+      10s)
+  , enable_node_health_report(
+      *this,
+      "enable_node_health_report",
+      "Include the size, leadership, traffic and replication backlog of "
+      "every hosted partition in the node load reports. The controller "
+      "leader keeps the latest report of every node for the admin API",
+      required::no,
+      false)
+  , enable_partition_balancer(
+      *this,
+      "enable_partition_balancer",
+      "Let the controller leader move partition leaders and replicas between "
+      "nodes to even out their counts and traffic",
+      required::no,
+      false)
+  , partition_balancer_interval_ms(
+      *this,
+      "partition_balancer_interval_ms",
+      "Interval of cluster balance checks. Requires enable_partition_balancer",
+      required::no,
+      30s)
+  , partition_balancer_max_concurrent_moves(
+      *this,
+      "partition_balancer_max_concurrent_moves",
+      "Maximum number of partition replica moves in progress at a time, "
+      "including the ones started by operators",
+      required::no,
+      2)
+  , partition_balancer_max_leadership_transfers(
+      *this,
+      "partition_balancer_max_leadership_transfers",
+      "Maximum number of leadership transfers started by a balance check",
+      required::no,
+      16)
+  , enable_controller_log_snapshots(
+      *this,
+      "enable_controller_log_snapshots",
+      "Periodically replace the applied prefix of the controller log with a "
+      "snapshot of the commands still needed to rebuild the cluster state",
+      required::no,
+      false)
+  , controller_snapshot_interval_ms(
+      *this,
+      "controller_snapshot_interval_ms",
+      "Interval of controller log snapshot checks. Requires "
+      "enable_controller_log_snapshots",
+      required::no,
+      5min)
+  , controller_snapshot_min_entries(
+      *this,
+      "controller_snapshot_min_entries",
+      "Minimum number of controller log offsets applied since the latest "
+      "snapshot to take a new one",
+      required::no,
+      10000)
+  , create_topics_batch_size(
+      *this,
+      "create_topics_batch_size",
+      "Maximum number of topics of a create topics request created with a "
+      "single controller command. Values above 1 require every broker of the "
+      "cluster to support the batched command",
+      required::no,
+      1)
+  , controller_backend_reconciliation_concurrency(
+      *this,
+      "controller_backend_reconciliation_concurrency",
+      "Maximum number of partitions every core creates, deletes or updates "
+      "concurrently when applying controller changes",
+      required::no,
+      64)
   , alter_topic_cfg_timeout_ms(
       *this,
       "alter_topic_cfg_timeout_ms",
@@ -338,6 +652,26 @@ configuration::configuration()
       "How often do we trigger background compaction",
       required::no,
       5min)
+  , compaction_max_concurrency(
+      *this,
+      "compaction_max_concurrency",
+      "Maximum number of logs compacted at the same time on each core",
+      required::no,
+      2)
+  , compaction_io_budget_bytes_per_sec(
+      *this,
+      "compaction_io_budget_bytes_per_sec",
+      "Average number of bytes per second each core may spend compacting "
+      "logs. Zero means unlimited",
+      required::no,
+      0)
+  , compaction_key_map_memory(
+      *this,
+      "compaction_key_map_memory",
+      "Memory used by a compaction to map keys to their latest offset across "
+      "all segments of a log. Zero disables cross segment deduplication",
+      required::no,
+      16_MiB)
   , retention_bytes(
       *this,
       "retention_bytes",
@@ -392,6 +726,14 @@ configuration::configuration()
       "Kafka group recovery timeout expressed in milliseconds",
       required::no,
       30'000ms)
+  , group_metadata_snapshot_interval_ms(
+      *this,
+      "group_metadata_snapshot_interval_ms",
+      "Interval at which the group metadata of the partitions of the group "
+      "topic is snapshotted, for recovery to only replay the log appended "
+      "since. 0 disables snapshots",
+      required::no,
+      10min)
   , replicate_append_timeout_ms(
       *this,
       "replicate_append_timeout_ms",
@@ -435,6 +777,21 @@ configuration::configuration()
       "Length of time above which growth is reset",
       required::no,
       10'000ms)
+  , cache_retained_tail_size(
+      *this,
+      "cache_retained_tail_size",
+      "Most recently written bytes of every partition kept in the batch cache "
+      "ahead of other cached data, so that followers are warm when they "
+      "become leaders. 0 disables",
+      required::no,
+      0)
+  , cache_max_retained_size(
+      *this,
+      "cache_max_retained_size",
+      "Maximum size of the partition tails kept in the batch cache of a core, "
+      "see cache_retained_tail_size",
+      required::no,
+      256_MiB)
   , auto_create_topics_enabled(
       *this,
       "auto_create_topics_enabled",
@@ -459,12 +816,128 @@ configuration::configuration()
       "Key-value maximum segment size (bytes)",
       required::no,
       16_MiB)
+  , storage_lazy_index_hydration(
+      *this,
+      "storage_lazy_index_hydration",
+      "Load only the index headers of older segments on startup and the "
+      "remaining index entries on the first read of each segment",
+      required::no,
+      false)
+  , storage_max_concurrent_recoveries(
+      *this,
+      "storage_max_concurrent_recoveries",
+      "Maximum number of partitions recovering their logs concurrently on "
+      "each core",
+      required::no,
+      16)
+  , storage_segment_pool_size(
+      *this,
+      "storage_segment_pool_size",
+      "Number of empty pre-allocated segment files kept ready on each core to "
+      "take file creation off the segment roll path. Zero disables the pool",
+      required::no,
+      2)
+  , storage_disk_calibration(
+      *this,
+      "storage_disk_calibration",
+      "Measure the bandwidth, IOPS and latency of the disk of the data "
+      "directory at startup, once per disk, and size the read-ahead of the "
+      "logs from it. The measure is kept as a seastar io properties file in "
+      "the data directory",
+      required::no,
+      false)
+  , storage_shared_log(
+      *this,
+      "storage_shared_log",
+      "Store the kafka partitions that are not compacted and have no segments "
+      "of their own in one log per core, with an index per partition, until "
+      "they get hot. Saves the files and fsyncs of low throughput partitions",
+      required::no,
+      false)
+  , storage_shared_log_graduation_rate(
+      *this,
+      "storage_shared_log_graduation_rate",
+      "Append rate in bytes per second over which a partition of the shared "
+      "log moves to its own log",
+      required::no,
+      64_KiB)
+  , disk_space_target_free_bytes(
+      *this,
+      "disk_space_target_free_bytes",
+      "Free space of the data directory below which the node trims the oldest "
+      "segments of its logs, archived ones first. Zero disables the trimming",
+      required::no,
+      0)
+  , disk_space_critical_free_bytes(
+      *this,
+      "disk_space_critical_free_bytes",
+      "Free space of the data directory below which compaction is paused and "
+      "the oldest segments of any deletable log are trimmed",
+      required::no,
+      0)
+  , disk_space_reclaim_priority_topics(
+      *this,
+      "disk_space_reclaim_priority_topics",
+      "Topics whose segments are trimmed first, in order, once the archived "
+      "segments are gone and the free space is still below the target",
+      required::no,
+      {})
+  , disk_space_check_interval_ms(
+      *this,
+      "disk_space_check_interval_ms",
+      "How often each core checks the free space of the data directory",
+      required::no,
+      10s)
+  , log_deletion_rate_bytes_per_sec(
+      *this,
+      "log_deletion_rate_bytes_per_sec",
+      "Rate at which each core releases the files of deleted partitions in "
+      "the background. Zero releases them as fast as the disk allows",
+      required::no,
+      256_MiB)
+  , log_deletion_truncate_step_bytes(
+      *this,
+      "log_deletion_truncate_step_bytes",
+      "Large files of deleted partitions are truncated by this many bytes at "
+      "a time before they are unlinked, to spread the release of their extents",
+      required::no,
+      64_MiB)
+  , in_memory_log_max_bytes(
+      *this,
+      "in_memory_log_max_bytes",
+      "Memory bound of a partition of a topic created with "
+      "redpanda.storage.mode=memory, the oldest batches are evicted past it",
+      required::no,
+      64_MiB)
   , max_kafka_throttle_delay_ms(
       *this,
       "max_kafka_throttle_delay_ms",
       "Fail-safe maximum throttle delay on kafka requests",
       required::no,
       60'000ms)
+  , kafka_max_inflight_requests(
+      *this,
+      "kafka_max_inflight_requests",
+      "Maximum number of requests of a single kafka connection that are "
+      "parsed and handled concurrently, responses are still sent in order. "
+      "Zero means no limit",
+      required::no,
+      32)
+  , kafka_connection_read_buffer_bytes(
+      *this,
+      "kafka_connection_read_buffer_bytes",
+      "Initial and minimum read buffer of a kafka connection, reads filling "
+      "the buffer grow it up to 128KiB. Zero keeps the seastar default of "
+      "8KiB",
+      required::no,
+      1_KiB)
+  , memory_governor_interval_ms(
+      *this,
+      "memory_governor_interval_ms",
+      "Period of the rebalancing of the request memory between the kafka and "
+      "the internal RPC servers of a shard. Zero keeps the budgets fixed",
+      required::no,
+      0ms)
   , raft_io_timeout_ms(
       *this, "raft_io_timeout_ms", "Raft I/O timeout", required::no, 10'000ms)
   , join_retry_timeout_ms(
@@ -485,6 +958,131 @@ configuration::configuration()
       "Timeout waiting for follower recovery when transferring leadership",
       required::no,
       10s)
+  , drain_leadership_on_shutdown(
+      *this,
+      "drain_leadership_on_shutdown",
+      "Transfer the leadership of the raft groups led by the node to their "
+      "followers before it stops",
+      required::no,
+      false)
+  , leadership_drain_max_concurrent(
+      *this,
+      "leadership_drain_max_concurrent",
+      "Maximum number of leadership transfers in flight per core while the "
+      "node is drained",
+      required::no,
+      64)
+  , leadership_drain_timeout_ms(
+      *this,
+      "leadership_drain_timeout_ms",
+      "Time a drain waits for the leadership transfers of the node",
+      required::no,
+      30s)
+  , raft_idle_heartbeats(
+      *this,
+      "raft_idle_heartbeats",
+      "Send only the group and term in heartbeats of groups that did not "
+      "change since the last acknowledged heartbeat. Requires all nodes to "
+      "support idle heartbeats",
+      required::no,
+      false)
+  , raft_leader_write_behind(
+      *this,
+      "raft_leader_write_behind",
+      "Flush the leader log in the background while the following batches "
+      "are appended, the leader flush only counts as one of the quorum votes",
+      required::no,
+      false)
+  , raft_relaxed_flush_interval_ms(
+      *this,
+      "raft_relaxed_flush_interval_ms",
+      "Interval at which the leader flushes the batches replicated with "
+      "acks=0 or acks=1, zero leaves them to the following quorum writes",
+      required::no,
+      0ms)
+  , raft_append_entries_multiplexing(
+      *this,
+      "raft_append_entries_multiplexing",
+      "Send append entries requests of all raft groups addressed to the same "
+      "node in one RPC. Requires all nodes to support the batched request",
+      required::no,
+      false)
+  , raft_max_multiplexed_append_entries(
+      *this,
+      "raft_max_multiplexed_append_entries",
+      "Maximum number of append entries requests sent in one RPC",
+      required::no,
+      256)
+  , raft_recovery_max_inflight_requests(
+      *this,
+      "raft_recovery_max_inflight_requests",
+      "Maximum number of append entries requests a recovering follower can "
+      "have in flight",
+      required::no,
+      8)
+  , raft_recovery_max_inflight_bytes(
+      *this,
+      "raft_recovery_max_inflight_bytes",
+      "Maximum number of bytes a recovering follower can have in flight",
+      required::no,
+      512_KiB)
+  , raft_recovery_throughput_bytes(
+      *this,
+      "raft_recovery_throughput_bytes",
+      "Maximum number of bytes per second sent by a node to all recovering "
+      "followers, 0 disables the limit",
+      required::no,
+      0)
+  , raft_recovery_segment_shipping(
+      *this,
+      "raft_recovery_segment_shipping",
+      "Send sealed segments as they are to followers that fell behind instead "
+      "of their batches, all nodes of the cluster have to support it",
+      required::no,
+      false)
+  , raft_append_entries_max_hold_us(
+      *this,
+      "raft_append_entries_max_hold_us",
+      "Upper bound of the time a follower holds append entries requests to "
+      "merge them into a single flush when its disk is slow, 0 disables it",
+      required::no,
+      500)
+  , raft_replicate_batch_max_linger_us(
+      *this,
+      "raft_replicate_batch_max_linger_us",
+      "Upper bound of the time a leader lingers on replicate requests to "
+      "merge them into a single append when its log is slow to append, 0 "
+      "disables it",
+      required::no,
+      500)
+  , raft_rpc_compression(
+      *this,
+      "raft_rpc_compression",
+      "Compression of the append entries and recovery requests sent to "
+      "other nodes: none, zstd or lz4. lz4 requires all nodes to support it",
+      required::no,
+      model::compression::none)
+  , raft_rpc_compression_min_bytes(
+      *this,
+      "raft_rpc_compression_min_bytes",
+      "Raft requests smaller than this are sent uncompressed",
+      required::no,
+      1024)
+  , rpc_client_control_connection(
+      *this,
+      "rpc_client_control_connection",
+      "Open a dedicated connection to every node for heartbeats, votes and "
+      "leadership transfers so they don't wait behind large requests",
+      required::no,
+      true)
+  , rpc_client_bulk_connections(
+      *this,
+      "rpc_client_bulk_connections",
+      "Number of connections to every node used for recovery traffic, the "
+      "raft groups are spread over them. 0 sends it over the default "
+      "connection",
+      required::no,
+      1)
   , release_cache_on_segment_roll(
       *this,
       "release_cache_on_segment_roll",
@@ -497,6 +1095,14 @@ configuration::configuration()
       "Maximum delay until buffered data is written",
       required::no,
       std::chrono::milliseconds(1s))
+  , segment_appender_flush_coalesce_ms(
+      *this,
+      "segment_appender_flush_coalesce_ms",
+      "Window during which flushes of segments on the same core are coalesced "
+      "and issued together. Zero groups flushes issued in the same reactor "
+      "poll",
+      required::no,
+      0ms)
   , fetch_session_eviction_timeout_ms(
       *this,
       "fetch_session_eviction_timeout_ms",
@@ -506,6 +1112,13 @@ configuration::configuration()
       "cache",
       required::no,
       60s)
+  , fetch_caught_up_recheck_interval_ms(
+      *this,
+      "fetch_caught_up_recheck_interval_ms",
+      "Maximum time an incremental fetch session skips reading a partition "
+      "that was caught up and did not get new data",
+      required::no,
+      5s)
   , max_compacted_log_segment_size(
       *this,
       "max_compacted_log_segment_size",
@@ -527,6 +1140,14 @@ configuration::configuration()
       "touching the log until the batch is exhausted.",
       required::no,
       1000)
+  , id_allocator_prefetch_size(
+      *this,
+      "id_allocator_prefetch_size",
+      "Number of producer ids every shard fetches from the id allocator at "
+      "once and hands out locally; the next range is fetched when half of "
+      "the current one is used. Values below 2 disable the prefetching.",
+      required::no,
+      100)
   , enable_sasl(
       *this,
       "enable_sasl",
@@ -606,6 +1227,44 @@ configuration::configuration()
       "during TLS handshake",
       required::no,
       std::nullopt)
+  , cloud_storage_cache_size(
+      *this,
+      "cloud_storage_cache_size",
+      "Max size of the per shard cache of segments downloaded from the cloud "
+      "storage to serve offsets that are no longer available locally. Zero "
+      "disables reads from the cloud storage",
+      required::no,
+      0)
+  , cloud_storage_cache_prefetch_segments(
+      *this,
+      "cloud_storage_cache_prefetch_segments",
+      "Number of the following archived segments of a partition downloaded "
+      "into the cache in the background while a segment is read from it",
+      required::no,
+      2)
+  , cloud_storage_upload_part_size(
+      *this,
+      "cloud_storage_upload_part_size",
+      "Size of the parts of a multipart segment upload, parts are uploaded in "
+      "parallel within cloud_storage_max_connections. Segments of at most one "
+      "part are uploaded with a single request. Zero disables multipart "
+      "uploads",
+      required::no,
+      64_MiB)
+  , cloud_storage_upload_bandwidth(
+      *this,
+      "cloud_storage_upload_bandwidth",
+      "Max bytes per second of segment uploads of the node, shared evenly by "
+      "the shards. Zero disables the limit",
+      required::no,
+      0)
+  , cloud_storage_incremental_manifest(
+      *this,
+      "cloud_storage_incremental_manifest",
+      "Upload binary deltas of the partition manifests instead of the whole "
+      "json manifest after every segment upload",
+      required::no,
+      false)
   , superusers(
       *this, "superusers", "List of superuser usernames", required::no, {})
   , _advertised_kafka_api(
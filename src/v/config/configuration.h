@@ -40,9 +40,14 @@ namespace config {
 struct configuration final : public config_store {
     // WAL
     property<data_directory_path> data_directory;
+    one_or_many_property<ss::sstring> data_directories;
     property<bool> developer_mode;
     property<uint64_t> log_segment_size;
     property<uint64_t> compacted_log_segment_size;
+    property<std::optional<std::chrono::milliseconds>>
+      log_segment_target_lifetime_ms;
+    property<uint64_t> log_segment_size_min;
+    property<uint64_t> log_segment_size_max;
     // Network
     property<unresolved_address> rpc_server;
     property<tls_config> rpc_server_tls;
@@ -52,7 +57,10 @@ struct configuration final : public config_store {
     property<std::size_t> coproc_max_inflight_bytes;
     property<std::size_t> coproc_max_ingest_bytes;
     property<std::size_t> coproc_max_batch_size;
+    property<std::size_t> coproc_max_shared_read_bytes;
+    property<std::size_t> coproc_max_script_bytes_per_second;
     property<std::chrono::milliseconds> coproc_offset_flush_interval_ms;
+    property<bool> coproc_replicate_materialized;
 
     // Raft
     property<int32_t> node_id;
@@ -74,13 +82,26 @@ struct configuration final : public config_store {
     property<std::chrono::milliseconds> default_window_sec;
     property<std::chrono::milliseconds> quota_manager_gc_sec;
     property<uint32_t> target_quota_byte_rate;
+    property<uint32_t> client_produce_quota_byte_rate;
+    property<uint32_t> client_fetch_quota_byte_rate;
+    property<uint32_t> client_request_quota_rate;
+    property<uint32_t> user_produce_quota_byte_rate;
+    property<uint32_t> user_fetch_quota_byte_rate;
+    property<uint32_t> user_request_quota_rate;
+    property<std::chrono::milliseconds> quota_manager_sync_ms;
+    one_or_many_property<ss::sstring> produce_admission_weights;
     property<std::optional<ss::sstring>> rack;
     property<std::optional<ss::sstring>> dashboard_dir;
     property<bool> disable_metrics;
+    property<bool> aggregate_partition_metrics;
+    property<size_t> aggregate_metrics_top_partitions;
     property<std::chrono::milliseconds> group_min_session_timeout_ms;
     property<std::chrono::milliseconds> group_max_session_timeout_ms;
     property<std::chrono::milliseconds> group_initial_rebalance_delay;
     property<std::chrono::milliseconds> group_new_member_join_timeout;
+    property<std::chrono::milliseconds> group_offset_commit_batch_window_ms;
+    property<size_t> group_offset_commit_batch_max_bytes;
+    property<bool> group_offset_fetch_replicas;
     property<std::chrono::milliseconds> metadata_dissemination_interval_ms;
     property<std::chrono::milliseconds> metadata_dissemination_retry_delay_ms;
     property<int16_t> metadata_dissemination_retries;
@@ -90,7 +111,30 @@ struct configuration final : public config_store {
     property<std::chrono::milliseconds> rm_sync_timeout_ms;
     property<model::violation_recovery_policy> rm_violation_recovery_policy;
     property<std::chrono::milliseconds> fetch_reads_debounce_timeout;
+    property<bool> enable_fetch_long_poll;
+    property<bool> fetch_passthrough_reads;
+    property<bool> fetch_read_planning;
+    property<size_t> fetch_read_memory_per_shard;
+    property<bool> fetch_from_followers;
+    property<std::chrono::milliseconds> fetch_follower_max_staleness_ms;
+    property<int64_t> fetch_cold_read_offset_lag;
+    one_or_many_property<ss::sstring> fetch_low_priority_principals;
     property<std::chrono::milliseconds> alter_topic_cfg_timeout_ms;
+    property<bool> enable_shard_balancer;
+    property<std::chrono::milliseconds> shard_balancer_interval_ms;
+    property<bool> shard_balancer_connection_affinity;
+    property<bool> enable_load_aware_partition_allocation;
+    property<std::chrono::milliseconds> node_load_report_interval_ms;
+    property<bool> enable_node_health_report;
+    property<bool> enable_partition_balancer;
+    property<std::chrono::milliseconds> partition_balancer_interval_ms;
+    property<size_t> partition_balancer_max_concurrent_moves;
+    property<size_t> partition_balancer_max_leadership_transfers;
+    property<bool> enable_controller_log_snapshots;
+    property<std::chrono::milliseconds> controller_snapshot_interval_ms;
+    property<size_t> controller_snapshot_min_entries;
+    property<size_t> create_topics_batch_size;
+    property<size_t> controller_backend_reconciliation_concurrency;
     property<model::cleanup_policy_bitflags> log_cleanup_policy;
     property<model::timestamp_type> log_message_timestamp_type;
     property<model::compression> log_compression_type;
@@ -101,6 +145,9 @@ struct configuration final : public config_store {
     // same as log.retention.ms in kafka
     property<std::chrono::milliseconds> delete_retention_ms;
     property<std::chrono::milliseconds> log_compaction_interval_ms;
+    property<size_t> compaction_max_concurrency;
+    property<size_t> compaction_io_budget_bytes_per_sec;
+    property<size_t> compaction_key_map_memory;
     // same as retention.size in kafka - TODO: size not implemented
     property<std::optional<size_t>> retention_bytes;
     property<int32_t> group_topic_partitions;
@@ -111,6 +158,7 @@ struct configuration final : public config_store {
     property<bool> disable_batch_cache;
     property<std::chrono::milliseconds> raft_election_timeout_ms;
     property<std::chrono::milliseconds> kafka_group_recovery_timeout_ms;
+    property<std::chrono::milliseconds> group_metadata_snapshot_interval_ms;
     property<std::chrono::milliseconds> replicate_append_timeout_ms;
     property<std::chrono::milliseconds> recovery_append_timeout_ms;
     property<size_t> raft_replicate_batch_window_size;
@@ -119,22 +167,61 @@ struct configuration final : public config_store {
     property<size_t> reclaim_max_size;
     property<std::chrono::milliseconds> reclaim_growth_window;
     property<std::chrono::milliseconds> reclaim_stable_window;
+    property<size_t> cache_retained_tail_size;
+    property<size_t> cache_max_retained_size;
     property<bool> auto_create_topics_enabled;
     property<bool> enable_pid_file;
     property<std::chrono::milliseconds> kvstore_flush_interval;
     property<size_t> kvstore_max_segment_size;
+    property<bool> storage_lazy_index_hydration;
+    property<size_t> storage_max_concurrent_recoveries;
+    property<size_t> storage_segment_pool_size;
+    property<bool> storage_disk_calibration;
+    property<bool> storage_shared_log;
+    property<size_t> storage_shared_log_graduation_rate;
+    property<size_t> disk_space_target_free_bytes;
+    property<size_t> disk_space_critical_free_bytes;
+    one_or_many_property<ss::sstring> disk_space_reclaim_priority_topics;
+    property<std::chrono::milliseconds> disk_space_check_interval_ms;
+    property<size_t> log_deletion_rate_bytes_per_sec;
+    property<size_t> log_deletion_truncate_step_bytes;
+    property<size_t> in_memory_log_max_bytes;
     property<std::chrono::milliseconds> max_kafka_throttle_delay_ms;
+    property<size_t> kafka_max_inflight_requests;
+    property<size_t> kafka_connection_read_buffer_bytes;
+    property<std::chrono::milliseconds> memory_governor_interval_ms;
     property<std::chrono::milliseconds> raft_io_timeout_ms;
     property<std::chrono::milliseconds> join_retry_timeout_ms;
     property<std::chrono::milliseconds> raft_timeout_now_timeout_ms;
     property<std::chrono::milliseconds>
       raft_transfer_leader_recovery_timeout_ms;
+    property<bool> drain_leadership_on_shutdown;
+    property<size_t> leadership_drain_max_concurrent;
+    property<std::chrono::milliseconds> leadership_drain_timeout_ms;
+    property<bool> raft_idle_heartbeats;
+    property<bool> raft_leader_write_behind;
+    property<std::chrono::milliseconds> raft_relaxed_flush_interval_ms;
+    property<bool> raft_append_entries_multiplexing;
+    property<size_t> raft_max_multiplexed_append_entries;
+    property<size_t> raft_recovery_max_inflight_requests;
+    property<size_t> raft_recovery_max_inflight_bytes;
+    property<size_t> raft_recovery_throughput_bytes;
+    property<bool> raft_recovery_segment_shipping;
+    property<uint32_t> raft_append_entries_max_hold_us;
+    property<uint32_t> raft_replicate_batch_max_linger_us;
+    property<model::compression> raft_rpc_compression;
+    property<size_t> raft_rpc_compression_min_bytes;
+    property<bool> rpc_client_control_connection;
+    property<size_t> rpc_client_bulk_connections;
     property<bool> release_cache_on_segment_roll;
     property<std::chrono::milliseconds> segment_appender_flush_timeout_ms;
+    property<std::chrono::milliseconds> segment_appender_flush_coalesce_ms;
     property<std::chrono::milliseconds> fetch_session_eviction_timeout_ms;
+    property<std::chrono::milliseconds> fetch_caught_up_recheck_interval_ms;
     property<size_t> max_compacted_log_segment_size;
     property<int16_t> id_allocator_log_capacity;
     property<int16_t> id_allocator_batch_size;
+    property<int16_t> id_allocator_prefetch_size;
     property<bool> enable_sasl;
     property<std::chrono::milliseconds>
       controller_backend_housekeeping_interval_ms;
@@ -151,6 +238,11 @@ struct configuration final : public config_store {
     property<bool> cloud_storage_disable_tls;
     property<int16_t> cloud_storage_api_endpoint_port;
     property<std::optional<ss::sstring>> cloud_storage_trust_file;
+    property<size_t> cloud_storage_cache_size;
+    property<size_t> cloud_storage_cache_prefetch_segments;
+    property<size_t> cloud_storage_upload_part_size;
+    property<size_t> cloud_storage_upload_bandwidth;
+    property<bool> cloud_storage_incremental_manifest;
     one_or_many_property<ss::sstring> superusers;
 
     configuration();
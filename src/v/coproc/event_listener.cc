@@ -144,8 +144,12 @@ ss::future<> event_listener::start() {
         return ss::do_until(
           [this] { return _abort_source.abort_requested(); },
           [this] {
-              return do_start().then([this] {
-                  return ss::sleep_abortable(1s, _abort_source)
+              return do_start().then([this](bool ingested) {
+                  if (ingested) {
+                      // the fetch of the events waited for them
+                      return ss::now();
+                  }
+                  return ss::sleep_abortable(idle_wait, _abort_source)
                     .handle_exception_type([](const ss::sleep_aborted&) {});
               });
           });
@@ -162,7 +166,7 @@ decompress_wasm_events(model::record_batch_reader::data_t events) {
       });
 }
 
-ss::future<> event_listener::do_start() {
+ss::future<bool> event_listener::do_start() {
     bool connected = co_await _client.is_connected();
     if (!connected) {
         try {
@@ -174,7 +178,7 @@ ss::future<> event_listener::do_start() {
               coproclog.warn,
               "Failed to connect to a broker within the retry policy: {}",
               e);
-            co_return;
+            co_return false;
         }
     }
     bool heartbeat = co_await _dispatcher.heartbeat();
@@ -194,7 +198,7 @@ ss::future<> event_listener::do_start() {
               coproclog.info, "Shutting down all coprocessor script_contexts");
             co_await remove_copro_state(_pacemaker);
         }
-        co_return;
+        co_return false;
     }
     /// If the wasm engine has awaken from restart, reset all state
     /// within the wasm engine, and set the offset to 0 to begin
@@ -203,12 +207,13 @@ ss::future<> event_listener::do_start() {
         if (co_await _dispatcher.disable_all_coprocessors()) {
             /// Unlikely to occur but if heartbeat checks pass but a request to
             /// invalidate the wasm engines state fails, do not proceed
-            co_return;
+            co_return false;
         }
         _offset = model::offset(0);
         _last_heartbeat_failed = false;
     }
     co_await do_ingest();
+    co_return true;
 }
 
 ss::future<> event_listener::do_ingest() {
@@ -216,21 +221,28 @@ ss::future<> event_listener::do_ingest() {
     /// more data to read from the topic. Normally we would be concerned about
     /// keeping all of this data in memory, however the topic is compacted, we
     /// don't expect the size of unique records to be very big.
+    ///
+    /// The first fetch waits on the broker for events to be appended, which
+    /// wakes up the listener as soon as a script is deployed or removed.
     model::record_batch_reader::data_t events;
     model::offset last_offset = _offset;
-    ss::stop_iteration stop{};
+    auto stop = co_await poll_topic(events, 1);
     while (stop == ss::stop_iteration::no) {
-        stop = co_await poll_topic(events);
+        stop = co_await poll_topic(events, 0);
     }
     auto decompressed = co_await decompress_wasm_events(std::move(events));
     auto reconciled = wasm::reconcile_events(std::move(decompressed));
     co_await persist_actions(std::move(reconciled), last_offset);
 }
 
-ss::future<ss::stop_iteration>
-event_listener::poll_topic(model::record_batch_reader::data_t& events) {
+ss::future<ss::stop_iteration> event_listener::poll_topic(
+  model::record_batch_reader::data_t& events, int32_t min_bytes) {
     auto response = co_await _client.fetch_partition(
-      model::coprocessor_internal_tp, _offset, 64_KiB, 5s);
+      model::coprocessor_internal_tp,
+      _offset,
+      64_KiB,
+      min_bytes > 0 ? idle_wait : 5s,
+      min_bytes);
     if (
       response.error != kafka::error_code::none
       || _abort_source.abort_requested()) {
@@ -47,11 +47,16 @@ public:
     ss::future<> stop();
 
 private:
-    ss::future<> do_start();
+    /// The wasm engine is sent a heartbeat at least this often, the listener
+    /// waits for new events in between
+    static constexpr auto idle_wait = std::chrono::seconds(1);
+
+    /// false when the events were not read, e.g. the wasm engine is down
+    ss::future<bool> do_start();
     ss::future<> do_ingest();
 
     ss::future<ss::stop_iteration>
-    poll_topic(model::record_batch_reader::data_t&);
+    poll_topic(model::record_batch_reader::data_t&, int32_t min_bytes);
 
     ss::future<>
       persist_actions(absl::btree_map<script_id, iobuf>, model::offset);
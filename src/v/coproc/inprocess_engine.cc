@@ -0,0 +1,116 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#include "coproc/inprocess_engine.h"
+
+#include "coproc/logger.h"
+#include "model/timeout_clock.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+
+#include <exception>
+#include <iterator>
+
+namespace coproc {
+
+void inprocess_engine::add(script_id id, std::unique_ptr<transform> t) {
+    vassert(t != nullptr, "Null transform for script id: {}", id);
+    auto [_, success] = _transforms.emplace(id, std::move(t));
+    vassert(success, "Double in process transform insert detected: {}", id);
+}
+
+bool inprocess_engine::remove(script_id id) {
+    return _transforms.erase(id) > 0;
+}
+
+static model::record_batch_reader::data_t
+copy_batches(const model::record_batch_reader::data_t& batches) {
+    model::record_batch_reader::data_t copy;
+    copy.reserve(batches.size());
+    for (const auto& b : batches) {
+        copy.push_back(b.copy());
+    }
+    return copy;
+}
+
+ss::future<process_batch_reply>
+inprocess_engine::process_batch(process_batch_request r) {
+    process_batch_reply reply;
+    for (auto& d : r.reqs) {
+        auto batches = co_await model::consume_reader_to_memory(
+          std::move(d.reader), model::no_timeout);
+        for (size_t i = 0; i < d.ids.size(); ++i) {
+            /// Only scripts sharing an input need their own copy
+            auto input = i + 1 == d.ids.size() ? std::move(batches)
+                                               : copy_batches(batches);
+            auto resps = co_await invoke(d.ids[i], d.ntp, std::move(input));
+            std::move(
+              resps.begin(), resps.end(), std::back_inserter(reply.resps));
+        }
+    }
+    co_return reply;
+}
+
+ss::future<std::vector<process_batch_reply::data>> inprocess_engine::invoke(
+  script_id id,
+  const model::ntp& ntp,
+  model::record_batch_reader::data_t batches) {
+    std::vector<process_batch_reply::data> resps;
+    auto found = _transforms.find(id);
+    if (found == _transforms.end()) {
+        vlog(coproclog.warn, "In process script id: {} not found", id);
+        co_return resps;
+    }
+    std::exception_ptr eptr;
+    transform::result result;
+    try {
+        result = co_await found->second->apply(
+          ntp.tp.topic, std::move(batches));
+    } catch (...) {
+        eptr = std::current_exception();
+    }
+    if (eptr) {
+        /// A null reader deregisters the script, as it does for a failure
+        /// within the wasm engine
+        vlog(
+          coproclog.error,
+          "In process script id: {} failed, will deregister: {}",
+          id,
+          eptr);
+        resps.push_back(
+          process_batch_reply::data{.id = id, .ntp = ntp, .reader = {}});
+        co_return resps;
+    }
+    if (result.empty()) {
+        /// An empty reader on the source ntp acks the input
+        resps.push_back(process_batch_reply::data{
+          .id = id,
+          .ntp = ntp,
+          .reader = model::make_memory_record_batch_reader(
+            model::record_batch_reader::data_t())});
+        co_return resps;
+    }
+    resps.reserve(result.size());
+    for (auto& [topic, output] : result) {
+        resps.push_back(process_batch_reply::data{
+          .id = id,
+          .ntp = model::ntp(
+            ntp.ns,
+            model::to_materialized_topic(ntp.tp.topic, topic),
+            ntp.tp.partition),
+          .reader = model::make_memory_record_batch_reader(
+            std::move(output))});
+    }
+    co_return resps;
+}
+
+} // namespace coproc
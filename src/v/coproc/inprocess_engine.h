@@ -0,0 +1,71 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "coproc/types.h"
+#include "model/fundamental.h"
+#include "model/record_batch_reader.h"
+
+#include <seastar/core/future.hh>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/node_hash_map.h>
+
+#include <memory>
+#include <vector>
+
+namespace coproc {
+
+/// A coprocessor executed inside of redpanda
+class transform {
+public:
+    using result = absl::
+      flat_hash_map<model::topic, model::record_batch_reader::data_t>;
+
+    virtual ~transform() = default;
+
+    /// Transform batches read from the input topic. The result maps output
+    /// topics to the batches to write onto their materialized logs. An empty
+    /// result acks the input without writing, an exception deregisters the
+    /// script.
+    virtual ss::future<result>
+    apply(const model::topic&, model::record_batch_reader::data_t&&) = 0;
+};
+
+/**
+ * Shard local engine that executes coprocessors in process, on the shard
+ * that owns the input ntp. It has the same contract as the 'process_batch'
+ * call of the supervisor, but the batches read from the input log are handed
+ * to the transform as they are, without serialization, a loopback socket and
+ * a hop to another process in both directions. Embedded runtimes run their
+ * modules behind the 'transform' interface.
+ */
+class inprocess_engine {
+public:
+    bool contains(script_id id) const { return _transforms.contains(id); }
+
+    /// Register the transform of a script on 'this' shard
+    void add(script_id, std::unique_ptr<transform>);
+
+    /// The script must not have a request in flight
+    bool remove(script_id);
+
+    ss::future<process_batch_reply> process_batch(process_batch_request);
+
+private:
+    ss::future<std::vector<process_batch_reply::data>>
+      invoke(script_id, const model::ntp&, model::record_batch_reader::data_t);
+
+    absl::node_hash_map<script_id, std::unique_ptr<transform>> _transforms;
+};
+
+} // namespace coproc
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#include "coproc/input_window.h"
+
+#include "model/timeout_clock.h"
+
+namespace coproc {
+
+static ss::future<model::record_batch_reader::data_t>
+read_log(storage::log log, storage::log_reader_config cfg) {
+    return log.make_reader(cfg).then([](model::record_batch_reader rbr) {
+        return model::consume_reader_to_memory(
+          std::move(rbr), model::no_timeout);
+    });
+}
+
+ss::future<model::record_batch_reader::data_t>
+input_window::read(storage::log log, storage::log_reader_config cfg) {
+    if (_subscribers.size() <= 1) {
+        /// Nothing to share
+        clear();
+        return read_log(std::move(log), cfg);
+    }
+    return _mtx.with([this, log = std::move(log), cfg]() mutable {
+        const model::offset start = cfg.start_offset;
+        if (contains(start)) {
+            return ss::make_ready_future<model::record_batch_reader::data_t>(
+              share_from(start, cfg.max_bytes));
+        }
+        if (!_batches.empty()) {
+            if (start < _batches.front().base_offset()) {
+                return read_log(std::move(log), cfg);
+            }
+            const model::offset next = _batches.back().last_offset()
+                                       + model::offset(1);
+            if (start == next && _size_bytes >= _max_bytes) {
+                /// Held back by the slowest subscriber
+                return ss::make_ready_future<
+                  model::record_batch_reader::data_t>();
+            }
+            if (start != next) {
+                clear();
+            }
+        }
+        return read_log(std::move(log), cfg)
+          .then([this](model::record_batch_reader::data_t batches) {
+              for (auto& b : batches) {
+                  _size_bytes += b.size_bytes();
+                  _batches.push_back(b.share());
+              }
+              return batches;
+          });
+    });
+}
+
+bool input_window::contains(model::offset o) const {
+    return !_batches.empty() && o >= _batches.front().base_offset()
+           && o <= _batches.back().last_offset();
+}
+
+model::record_batch_reader::data_t
+input_window::share_from(model::offset start, std::size_t max_bytes) {
+    model::record_batch_reader::data_t batches;
+    std::size_t size = 0;
+    for (auto& b : _batches) {
+        if (b.last_offset() < start) {
+            continue;
+        }
+        size += b.size_bytes();
+        batches.push_back(b.share());
+        if (size >= max_bytes) {
+            break;
+        }
+    }
+    return batches;
+}
+
+void input_window::trim(model::offset acked) {
+    while (!_batches.empty() && _batches.front().last_offset() <= acked) {
+        _size_bytes -= _batches.front().size_bytes();
+        _batches.pop_front();
+    }
+}
+
+void input_window::clear() {
+    _batches.clear();
+    _size_bytes = 0;
+}
+
+} // namespace coproc
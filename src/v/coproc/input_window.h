@@ -0,0 +1,70 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "coproc/types.h"
+#include "model/fundamental.h"
+#include "model/record_batch_reader.h"
+#include "storage/log.h"
+#include "storage/types.h"
+#include "utils/mutex.h"
+
+#include <seastar/core/future.hh>
+
+#include <absl/container/flat_hash_set.h>
+
+namespace coproc {
+
+/**
+ * Batches recently read from an input log, shared by all scripts subscribed
+ * to it so that the log is read and decompressed once per shard instead of
+ * once per script. The fastest script extends the window and the others are
+ * handed shared copies of its batches. The window is trimmed past the offset
+ * acked by the slowest script, once it holds more than 'max_bytes' the
+ * scripts ahead receive no data until the slowest one catches up.
+ */
+class input_window {
+public:
+    explicit input_window(std::size_t max_bytes)
+      : _max_bytes(max_bytes) {}
+
+    void subscribe(script_id id) { _subscribers.insert(id); }
+    void unsubscribe(script_id id) { _subscribers.erase(id); }
+    const absl::flat_hash_set<script_id>& subscribers() const {
+        return _subscribers;
+    }
+
+    /// Reads the batches at 'cfg.start_offset' from the window or the
+    /// log, reads behind the start of the window aren't shared
+    ss::future<model::record_batch_reader::data_t>
+      read(storage::log, storage::log_reader_config);
+
+    /// Drops the batches up to and including 'acked'
+    void trim(model::offset acked);
+
+    std::size_t size_bytes() const { return _size_bytes; }
+
+private:
+    bool contains(model::offset) const;
+    model::record_batch_reader::data_t
+      share_from(model::offset, std::size_t max_bytes);
+    void clear();
+
+    std::size_t _max_bytes;
+    absl::flat_hash_set<script_id> _subscribers;
+    /// Concurrent reads at the end of the window read the log once
+    mutex _mtx;
+    model::record_batch_reader::data_t _batches;
+    std::size_t _size_bytes{0};
+};
+
+} // namespace coproc
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#include "coproc/materialized_producer.h"
+
+#include "config/configuration.h"
+#include "coproc/logger.h"
+#include "kafka/client/exceptions.h"
+#include "kafka/protocol/create_topics.h"
+#include "model/record_utils.h"
+#include "raft/types.h"
+#include "ssx/future-util.h"
+#include "storage/parser_utils.h"
+#include "storage/record_batch_builder.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+
+#include <algorithm>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+
+namespace coproc {
+
+namespace {
+
+kafka::client::client make_client() {
+    kafka::client::configuration cfg;
+    cfg.brokers.set_value(std::vector<unresolved_address>{
+      config::shard_local_cfg().kafka_api()[0].address});
+    return kafka::client::client{to_yaml(cfg)};
+}
+
+} // namespace
+
+materialized_producer::materialized_producer()
+  : _client(make_client()) {}
+
+ss::future<> materialized_producer::stop() { return _client.stop(); }
+
+ss::future<> materialized_producer::connect() {
+    auto units = co_await _connect_lock.get_units();
+    if (!co_await _client.is_connected()) {
+        co_await _client.connect();
+    }
+}
+
+ss::future<> materialized_producer::create_topic(
+  const model::topic& topic, int32_t partitions) {
+    vlog(
+      coproclog.info,
+      "Creating materialized topic {} with {} partitions",
+      topic,
+      partitions);
+    auto res = co_await _client.dispatch([topic, partitions]() {
+        return kafka::create_topics_request{.data{
+          .topics = {kafka::creatable_topic{
+            .name = topic,
+            .num_partitions = partitions,
+            .replication_factor
+            = config::shard_local_cfg().default_topic_replication()}},
+          .timeout_ms = std::chrono::seconds(5),
+          .validate_only = false}};
+    });
+    for (const auto& t : res.data.topics) {
+        /// Another shard or node may have created it first
+        if (
+          t.error_code != kafka::error_code::none
+          && t.error_code != kafka::error_code::topic_already_exists) {
+            throw kafka::client::partition_error(
+              model::topic_partition(topic, model::partition_id(0)),
+              t.error_code);
+        }
+    }
+    co_await _client.update_metadata();
+}
+
+ss::future<int32_t>
+materialized_producer::partition_count(const model::topic& topic) {
+    if (auto it = _partitions.find(topic); it != _partitions.end()) {
+        co_return it->second;
+    }
+    int32_t partitions = 0;
+    try {
+        partitions = co_await _client.partition_count(topic);
+    } catch (const kafka::client::partition_error& e) {
+        if (e.error != kafka::error_code::unknown_topic_or_partition) {
+            throw;
+        }
+    }
+    if (partitions == 0) {
+        auto source = model::get_source_topic(topic);
+        co_await create_topic(
+          topic, co_await _client.partition_count(model::topic(source)));
+        partitions = co_await _client.partition_count(topic);
+    }
+    _partitions.insert_or_assign(topic, partitions);
+    co_return partitions;
+}
+
+ss::future<materialized_producer::partition_batches>
+materialized_producer::partition_records(
+  const model::topic& topic,
+  int32_t partitions,
+  model::record_batch_reader::data_t batches) {
+    auto& partitioner = _client.partitioner();
+    absl::flat_hash_map<model::partition_id, storage::record_batch_builder>
+      builders;
+    for (auto& b : batches) {
+        if (b.header().crc != model::crc_record_batch(b)) {
+            throw std::invalid_argument(fmt::format(
+              "record_batch failed to pass crc checks: {}", b.header()));
+        }
+        /// The keys of a compressed batch are only known once decompressed
+        auto batch = co_await storage::internal::decompress_batch(
+          std::move(b));
+        batch.for_each_record([&](model::record r) {
+            std::optional<iobuf> key;
+            if (r.key_size() >= 0) {
+                key = r.release_key();
+            }
+            std::optional<iobuf> value;
+            if (r.has_value()) {
+                value = r.release_value();
+            }
+            const size_t size = std::max(r.key_size(), 0)
+                                + std::max(r.value_size(), 0);
+            auto id = partitioner(topic, key, partitions, size);
+            builders.try_emplace(id, raft::data_batch_type, model::offset(0))
+              .first->second.add_raw_kw(
+                std::move(key).value_or(iobuf{}),
+                std::move(value),
+                std::move(r.headers()));
+        });
+    }
+    partition_batches out;
+    out.reserve(builders.size());
+    for (auto& [id, builder] : builders) {
+        out.emplace_back(id, std::move(builder).build());
+    }
+    co_return out;
+}
+
+ss::future<bool> materialized_producer::produce(
+  model::topic topic, model::record_batch_reader::data_t batches) {
+    using produced = kafka::produce_response::partition;
+    std::vector<produced> responses;
+    try {
+        co_await connect();
+        const int32_t partitions = co_await partition_count(topic);
+        auto records = co_await partition_records(
+          topic, partitions, std::move(batches));
+        responses = co_await ssx::parallel_transform(
+          std::move(records),
+          [this, &topic](
+            std::pair<model::partition_id, model::record_batch> p) {
+              return _client.produce_record_batch(
+                model::topic_partition(topic, p.first), std::move(p.second));
+          });
+    } catch (...) {
+        vlog(
+          coproclog.warn,
+          "Failed to produce to materialized topic {}: {}",
+          topic,
+          std::current_exception());
+        /// The topic may have been deleted or repartitioned meanwhile
+        _partitions.erase(topic);
+        co_return false;
+    }
+    for (const auto& r : responses) {
+        if (r.error != kafka::error_code::none) {
+            vlog(
+              coproclog.warn,
+              "Failed to produce to materialized partition {}/{}: {}",
+              topic,
+              r.id,
+              r.error);
+            _partitions.erase(topic);
+            co_return false;
+        }
+    }
+    co_return true;
+}
+
+} // namespace coproc
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "kafka/client/client.h"
+#include "model/fundamental.h"
+#include "model/record.h"
+#include "model/record_batch_reader.h"
+#include "seastarx.h"
+#include "utils/mutex.h"
+
+#include <seastar/core/future.hh>
+
+#include <absl/container/flat_hash_map.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace coproc {
+
+/**
+ * Produces the outputs of the scripts of a shard to materialized topics of
+ * the cluster, through the kafka api of the node.
+ *
+ * A materialized topic is created on its first output with as many
+ * partitions as its source topic. Each record goes to the partition of the
+ * hash of its key, like the java client picks, so that the outputs of all
+ * the inputs of a script are spread over the cluster and consumed with the
+ * usual parallelism. The records of one call are coalesced into one batch
+ * per output partition, and the produce requests wait for raft to replicate
+ * them.
+ */
+class materialized_producer {
+public:
+    materialized_producer();
+
+    ss::future<> stop();
+
+    /// Resolves to false if the records weren't all replicated, some of them
+    /// may have been
+    ss::future<bool>
+      produce(model::topic, model::record_batch_reader::data_t);
+
+private:
+    ss::future<> connect();
+
+    /// The partitions of the materialized topic, which is created if missing
+    ss::future<int32_t> partition_count(const model::topic&);
+
+    ss::future<> create_topic(const model::topic&, int32_t partitions);
+
+    using partition_batches
+      = std::vector<std::pair<model::partition_id, model::record_batch>>;
+
+    /// One batch per output partition of the records of 'batches'
+    ss::future<partition_batches> partition_records(
+      const model::topic&,
+      int32_t partitions,
+      model::record_batch_reader::data_t batches);
+
+    kafka::client::client _client;
+
+    /// Serializes the connection of the scripts of the shard
+    mutex _connect_lock;
+
+    absl::flat_hash_map<model::topic, int32_t> _partitions;
+};
+
+} // namespace coproc
@@ -12,6 +12,10 @@
 #pragma once
 
 #include "config/configuration.h"
+#include "coproc/inprocess_engine.h"
+#include "coproc/input_window.h"
+#include "coproc/materialized_producer.h"
+#include "coproc/probe.h"
 #include "coproc/types.h"
 #include "random/simple_time_jitter.h"
 #include "rpc/reconnect_transport.h"
@@ -23,6 +27,7 @@
 #include <seastar/core/shared_ptr.hh>
 
 #include <absl/container/btree_map.h>
+#include <absl/container/flat_hash_map.h>
 #include <absl/container/node_hash_map.h>
 
 #include <chrono>
@@ -54,12 +59,18 @@ struct ntp_context {
     struct offset_pair {
         model::offset last_read{};
         model::offset last_acked{};
+        /// Last offset written to each materialized log for the inputs up to
+        /// 'last_acked'
+        absl::flat_hash_map<model::ntp, model::offset> outputs;
+        /// Acked since the last checkpoint
+        bool dirty{false};
     };
 
     using offset_tracker = absl::btree_map<script_id, offset_pair>;
 
     explicit ntp_context(storage::log lg)
-      : log(std::move(lg)) {}
+      : log(std::move(lg))
+      , window(config::shard_local_cfg().coproc_max_shared_read_bytes()) {}
 
     const model::ntp& ntp() const { return log.config().ntp(); }
 
@@ -67,6 +78,9 @@ struct ntp_context {
     storage::log log;
     /// Interested scripts write their last read offset of the input ntp
     offset_tracker offsets;
+    /// Batches read for one of the interested scripts, trimmed past the
+    /// smallest acked offset of 'offsets'
+    input_window window;
 };
 
 using ntp_context_cache
@@ -87,6 +101,12 @@ struct shared_script_resources {
     /// Underlying transport connection to the wasm engine
     rpc::reconnect_transport transport;
 
+    /// Scripts registered here skip the transport and run on 'this' shard
+    inprocess_engine engine;
+
+    /// Stage latencies of the script_context pipelines
+    probe stages;
+
     /// Reference to the storage api, used to lookup and create
     /// storage::logs
     storage::api& api;
@@ -99,6 +119,10 @@ struct shared_script_resources {
     /// to elements within the collection are used
     absl::node_hash_map<model::ntp, mutex> log_mtx;
 
+    /// Writes the outputs to materialized topics of the cluster, with
+    /// coproc_replicate_materialized
+    materialized_producer producer;
+
     explicit shared_script_resources(
       rpc::reconnect_transport t, storage::api& a)
       : transport(std::move(t))
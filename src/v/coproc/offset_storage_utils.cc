@@ -16,6 +16,8 @@
 #include "coproc/ntp_context.h"
 #include "model/fundamental.h"
 #include "reflection/adl.h"
+#include "storage/api.h"
+#include "storage/kvstore.h"
 #include "storage/log_manager.h"
 #include "storage/snapshot.h"
 #include "vlog.h"
@@ -23,6 +25,8 @@
 #include <seastar/core/coroutine.hh>
 #include <seastar/util/defer.hh>
 
+#include <absl/container/flat_hash_set.h>
+
 #include <bits/stdint-intn.h>
 
 #include <optional>
@@ -62,6 +66,8 @@ namespace coproc {
 using iresults_map
   = absl::flat_hash_map<model::ntp, ntp_context::offset_tracker>;
 
+static constexpr int8_t checkpoint_version = 1;
+
 ss::future<iresults_map> deserialize_data_field(iobuf data) {
     return ss::do_with(
       iresults_map(),
@@ -97,6 +103,28 @@ ss::future<iobuf> serialize_data_field(const ntp_context_cache& ntp_cache) {
     });
 }
 
+/// Match the offsets map with the corresponding storage::log queried from
+/// the log_manager, building the completed ntp_context_cache
+static ntp_context_cache
+make_ntp_context_cache(iresults_map irm, storage::log_manager& log_mgr) {
+    ntp_context_cache recovered;
+    for (auto& [key, offsets] : irm) {
+        std::optional<storage::log> log = log_mgr.get(key);
+        if (!log) {
+            vlog(
+              coproclog.error,
+              "Coult not recover ntp {}, for some reason it does not exist in "
+              "the log_manager",
+              key);
+        } else {
+            auto [itr, _] = recovered.emplace(
+              key, ss::make_lw_shared<ntp_context>(std::move(*log)));
+            itr->second->offsets = std::move(offsets);
+        }
+    }
+    return recovered;
+}
+
 ss::future<ntp_context_cache> recover_offsets(
   storage::snapshot_manager& snap, storage::log_manager& log_mgr) {
     ntp_context_cache recovered;
@@ -120,23 +148,7 @@ ss::future<ntp_context_cache> recover_offsets(
     /// Deserialize the data
     iresults_map irm = co_await deserialize_data_field(std::move(data));
     vlog(coproclog.info, "Recovered {} coprocessor offsets....", irm.size());
-    /// Match the offsets map with the corresponding storage::log queried from
-    /// the log_manager, building the completed ntp_context_cache
-    for (auto& [key, offsets] : irm) {
-        std::optional<storage::log> log = log_mgr.get(key);
-        if (!log) {
-            vlog(
-              coproclog.error,
-              "Coult not recover ntp {}, for some reason it does not exist in "
-              "the log_manager",
-              key);
-        } else {
-            auto [itr, _] = recovered.emplace(
-              std::move(key), ss::make_lw_shared<ntp_context>(std::move(*log)));
-            itr->second->offsets = std::move(offsets);
-        }
-    }
-    co_return recovered;
+    co_return make_ntp_context_cache(std::move(irm), log_mgr);
 }
 
 ss::future<> save_offsets(
@@ -157,4 +169,134 @@ ss::future<> save_offsets(
     co_await snap.finish_snapshot(writer);
 }
 
+static bytes checkpoint_key(script_id id, const model::ntp& ntp) {
+    iobuf key;
+    reflection::serialize(key, id, model::ntp(ntp));
+    return iobuf_to_bytes(key);
+}
+
+static iobuf checkpoint_value(const ntp_context::offset_pair& offsets) {
+    iobuf value;
+    reflection::serialize(
+      value,
+      checkpoint_version,
+      offsets.last_acked,
+      static_cast<int32_t>(offsets.outputs.size()));
+    for (const auto& [ntp, offset] : offsets.outputs) {
+        reflection::serialize(value, model::ntp(ntp), offset);
+    }
+    return value;
+}
+
+ss::future<>
+save_checkpoints(storage::api& api, const ntp_context_cache& ntp_cache) {
+    using checkpoint = std::tuple<script_id, model::ntp, iobuf>;
+    std::vector<checkpoint> checkpoints;
+    absl::flat_hash_set<model::ntp> outputs;
+    for (const auto& [ntp, ntp_ctx] : ntp_cache) {
+        for (auto& [id, offsets] : ntp_ctx->offsets) {
+            if (!offsets.dirty) {
+                continue;
+            }
+            offsets.dirty = false;
+            for (const auto& o : offsets.outputs) {
+                outputs.insert(o.first);
+            }
+            checkpoints.emplace_back(id, ntp, checkpoint_value(offsets));
+        }
+    }
+    if (checkpoints.empty()) {
+        co_return;
+    }
+    vlog(
+      coproclog.debug,
+      "Saving {} coprocessor checkpoints, flushing {} materialized logs",
+      checkpoints.size(),
+      outputs.size());
+    std::exception_ptr eptr;
+    try {
+        co_await ss::parallel_for_each(
+          outputs, [&api](const model::ntp& ntp) {
+              auto log = api.log_mgr().get(ntp);
+              return log ? log->flush() : ss::now();
+          });
+        co_await ss::parallel_for_each(checkpoints, [&api](checkpoint& c) {
+            return api.kvs().put(
+              storage::kvstore::key_space::coproc,
+              checkpoint_key(std::get<0>(c), std::get<1>(c)),
+              std::move(std::get<2>(c)));
+        });
+    } catch (...) {
+        eptr = std::current_exception();
+    }
+    if (eptr) {
+        /// Retried with the next checkpoints
+        for (const auto& c : checkpoints) {
+            auto found = ntp_cache.find(std::get<1>(c));
+            if (found == ntp_cache.end()) {
+                continue;
+            }
+            auto offsets = found->second->offsets.find(std::get<0>(c));
+            if (offsets != found->second->offsets.end()) {
+                offsets->second.dirty = true;
+            }
+        }
+        std::rethrow_exception(eptr);
+    }
+}
+
+ss::future<ntp_context_cache> recover_checkpoints(storage::api& api) {
+    iresults_map irm;
+    /// Highest output offset covered by any checkpoint per materialized log
+    absl::flat_hash_map<model::ntp, model::offset> committed;
+    api.kvs().for_each(
+      storage::kvstore::key_space::coproc,
+      [&irm, &committed](bytes_view key, const iobuf& value) {
+          iobuf_parser kp(bytes_to_iobuf(bytes(key)));
+          auto id = reflection::adl<script_id>{}.from(kp);
+          auto ntp = reflection::adl<model::ntp>{}.from(kp);
+          iobuf_parser vp(value.copy());
+          const auto version = reflection::adl<int8_t>{}.from(vp);
+          if (version != checkpoint_version) {
+              vlog(
+                coproclog.error,
+                "Unknown checkpoint version {} of script {} for ntp {}",
+                version,
+                id,
+                ntp);
+              return;
+          }
+          const auto last_acked = reflection::adl<model::offset>{}.from(vp);
+          ntp_context::offset_pair offsets{
+            .last_read = last_acked, .last_acked = last_acked};
+          const auto n_outputs = reflection::adl<int32_t>{}.from(vp);
+          for (int32_t i = 0; i < n_outputs; ++i) {
+              auto output = reflection::adl<model::ntp>{}.from(vp);
+              auto offset = reflection::adl<model::offset>{}.from(vp);
+              auto [it, _] = committed.try_emplace(output, offset);
+              it->second = std::max(it->second, offset);
+              offsets.outputs.emplace(std::move(output), offset);
+          }
+          irm[ntp].emplace(id, std::move(offsets));
+      });
+    if (irm.empty()) {
+        co_return ntp_context_cache();
+    }
+    for (const auto& [ntp, offset] : committed) {
+        auto log = api.log_mgr().get(ntp);
+        if (!log || log->offsets().dirty_offset <= offset) {
+            continue;
+        }
+        vlog(
+          coproclog.info,
+          "Truncating uncommitted coprocessor output of {} after offset {}",
+          ntp,
+          offset);
+        co_await log->truncate(storage::truncate_config(
+          offset + model::offset(1), ss::default_priority_class()));
+    }
+    vlog(coproclog.info, "Recovered {} coprocessor checkpoints", irm.size());
+    co_return make_ntp_context_cache(std::move(irm), api.log_mgr());
+}
+
 } // namespace coproc
@@ -30,4 +30,14 @@ recover_offsets(storage::snapshot_manager&, storage::log_manager&);
 /// Writes all offsets to disk using the snapshot manager
 ss::future<> save_offsets(storage::snapshot_manager&, const ntp_context_cache&);
 
+/// Commits the offsets acked since the last call to the kvstore, one key per
+/// script and input ntp. The materialized logs are flushed first so that a
+/// checkpoint never covers outputs which could still be lost
+ss::future<> save_checkpoints(storage::api&, const ntp_context_cache&);
+
+/// Rebuilds the ntp_context_cache from the checkpoints in the kvstore. The
+/// materialized logs are truncated past the last output covered by a
+/// checkpoint, as their inputs are processed again
+ss::future<ntp_context_cache> recover_checkpoints(storage::api&);
+
 } // namespace coproc
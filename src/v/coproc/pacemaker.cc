@@ -58,15 +58,26 @@ pacemaker::pacemaker(ss::socket_address addr, ss::sharded<storage::api>& api)
 ss::future<> pacemaker::start() {
     _offs.timer.set_callback([this] {
         (void)ss::with_gate(_gate, [this] {
-            return save_offsets(_offs.snap, _ntps).then([this] {
-                if (!_offs.timer.armed()) {
-                    _offs.timer.arm(_offs.duration);
-                }
-            });
+            return save_checkpoints(_shared_res.api, _ntps)
+              .handle_exception([](std::exception_ptr e) {
+                  vlog(
+                    coproclog.warn, "Failed to save coproc checkpoints: {}", e);
+              })
+              .then([this] {
+                  if (!_offs.timer.armed()) {
+                      _offs.timer.arm(_offs.duration);
+                  }
+              });
         });
     });
-    co_await ss::recursive_touch_directory(offsets_snapshot_path().string());
-    auto ncc = co_await recover_offsets(_offs.snap, _shared_res.api.log_mgr());
+    auto ncc = co_await recover_checkpoints(_shared_res.api);
+    if (ncc.empty()) {
+        /// Offsets saved by versions which snapshotted all of them at once
+        co_await ss::recursive_touch_directory(
+          offsets_snapshot_path().string());
+        ncc = co_await recover_offsets(
+          _offs.snap, _shared_res.api.log_mgr());
+    }
     _ntps = std::move(ncc);
     _offs.timer.arm(_offs.duration);
 }
@@ -92,9 +103,19 @@ ss::future<> pacemaker::stop() {
     if (n_removed != n_active_scripts) {
         vlog(coproclog.error, "Failed to gracefully shutdown all copro fibers");
     }
+    /// Nothing is reprocessed after a clean shutdown
+    try {
+        co_await save_checkpoints(_shared_res.api, _ntps);
+    } catch (...) {
+        vlog(
+          coproclog.warn,
+          "Failed to save coproc checkpoints on shutdown: {}",
+          std::current_exception());
+    }
     /// Finally close the connection to the wasm engine
     vlog(coproclog.info, "Closing connection to coproc wasm engine");
     co_await _shared_res.transport.stop();
+    co_await _shared_res.producer.stop();
     co_await std::move(gate_closed);
 }
 
@@ -143,6 +164,19 @@ std::vector<errc> pacemaker::add_source(
     return acks;
 }
 
+std::vector<errc> pacemaker::add_inprocess_source(
+  script_id id,
+  std::vector<topic_namespace_policy> topics,
+  std::unique_ptr<transform> t) {
+    /// Registered first, the fiber started by add_source may run right away
+    _shared_res.engine.add(id, std::move(t));
+    auto acks = add_source(id, std::move(topics));
+    if (!local_script_id_exists(id)) {
+        _shared_res.engine.remove(id);
+    }
+    return acks;
+}
+
 errc check_topic_policy(const model::topic& topic, topic_ingestion_policy tip) {
     if (tip != topic_ingestion_policy::latest) {
         return errc::invalid_ingestion_policy;
@@ -181,10 +215,9 @@ void pacemaker::do_add_source(
                 ntp_ctx = ss::make_lw_shared<ntp_context>(log);
                 _ntps.emplace(ntp, ntp_ctx);
             }
-            vassert(
-              ntp_ctx->offsets.emplace(id, ntp_context::offset_pair()).second,
-              "Script id expected to not exist: {}",
-              id);
+            /// Keeps the checkpointed offsets of a script registered again,
+            /// it resumes after the inputs already processed
+            ntp_ctx->offsets.try_emplace(id);
             ctxs.emplace(ntp, ntp_ctx);
         }
         acks.push_back(errc::success);
@@ -199,6 +232,7 @@ ss::future<errc> pacemaker::remove_source(script_id id) {
     }
     std::unique_ptr<script_context> ctx = std::move(handle.mapped());
     co_await ctx->shutdown();
+    _shared_res.engine.remove(id);
     /// shutdown explicity clears out strong references to ntp
     /// contexts. It is known to remove them from the pacemakers cache
     /// when the use_count() == 1, as there are then known to be no
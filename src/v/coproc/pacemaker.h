@@ -65,6 +65,18 @@ public:
     std::vector<errc>
       add_source(script_id, std::vector<topic_namespace_policy>);
 
+    /**
+     * Registers a coproc script that is executed within redpanda, the
+     * batches read from its inputs never leave 'this' shard
+     *
+     * @param transform the script, dropped if no input matched
+     * @returns the same as \ref add_source
+     */
+    std::vector<errc> add_inprocess_source(
+      script_id,
+      std::vector<topic_namespace_policy>,
+      std::unique_ptr<transform>);
+
     /**
      * Removes a script_id from the pacemaker. Shuts down relevent fibers and
      * deregisters ntps that no longer have any registered interested scripts
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#include "coproc/probe.h"
+
+#include "config/configuration.h"
+#include "prometheus/prometheus_sanitize.h"
+
+#include <seastar/core/metrics.hh>
+
+namespace coproc {
+
+probe::probe() {
+    if (config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+    namespace sm = ss::metrics;
+    auto stage = sm::label("stage");
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("coproc:script"),
+      {sm::make_histogram(
+         "stage_latency",
+         sm::description("Latency of reading the inputs of a request"),
+         {stage("read")},
+         [this] { return _read.seastar_histogram_logform(); }),
+       sm::make_histogram(
+         "stage_latency",
+         sm::description("Latency of a request to the wasm engine"),
+         {stage("transform")},
+         [this] { return _transform.seastar_histogram_logform(); }),
+       sm::make_histogram(
+         "stage_latency",
+         sm::description("Latency of writing a reply to materialized logs"),
+         {stage("write")},
+         [this] { return _write.seastar_histogram_logform(); })});
+}
+
+void script_probe::setup_metrics(script_id id, lag_fn lag) {
+    if (config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+    _lag = std::move(lag);
+    namespace sm = ss::metrics;
+    const std::vector<sm::label_instance> labels{
+      sm::label("script_id")(id())};
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("coproc:script"),
+      {sm::make_derive(
+         "bytes_read",
+         [this] { return _bytes_read; },
+         sm::description("Bytes read from the inputs of the script"),
+         labels),
+       sm::make_derive(
+         "bytes_written",
+         [this] { return _bytes_written; },
+         sm::description("Bytes the script wrote onto materialized logs"),
+         labels),
+       sm::make_derive(
+         "requests",
+         [this] { return _requests; },
+         sm::description("Requests sent to the wasm engine for the script"),
+         labels),
+       sm::make_derive(
+         "throttle_time_ms",
+         [this] { return _throttled.count(); },
+         sm::description("Time the script waited for its bytes budget"),
+         labels),
+       sm::make_gauge(
+         "lag",
+         [this] { return _lag(); },
+         sm::description("Records of the inputs not yet processed"),
+         labels)});
+}
+
+} // namespace coproc
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "coproc/types.h"
+#include "utils/hdr_hist.h"
+
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/util/noncopyable_function.hh>
+
+#include <chrono>
+#include <cstdint>
+
+namespace coproc {
+
+/// Latencies of the stages of the script_context pipelines on 'this' shard
+class probe {
+public:
+    probe();
+    probe(const probe&) = delete;
+    probe& operator=(const probe&) = delete;
+    probe(probe&&) = delete;
+    probe& operator=(probe&&) = delete;
+    ~probe() = default;
+
+    /// Reading a request from all inputs of a script
+    hdr_hist& read_latency() { return _read; }
+    /// From sending a request until its reply is received
+    hdr_hist& transform_latency() { return _transform; }
+    /// Writing a reply onto the materialized logs
+    hdr_hist& write_latency() { return _write; }
+
+private:
+    hdr_hist _read;
+    hdr_hist _transform;
+    hdr_hist _write;
+    ss::metrics::metric_groups _metrics;
+};
+
+/// Throughput, lag and throttling of one script on 'this' shard
+class script_probe {
+public:
+    /// Records of the inputs not yet acked by the script
+    using lag_fn = ss::noncopyable_function<int64_t()>;
+
+    script_probe() = default;
+    script_probe(const script_probe&) = delete;
+    script_probe& operator=(const script_probe&) = delete;
+    script_probe(script_probe&&) = delete;
+    script_probe& operator=(script_probe&&) = delete;
+    ~script_probe() = default;
+
+    void setup_metrics(script_id, lag_fn);
+
+    void add_read(size_t bytes) {
+        _bytes_read += bytes;
+        ++_requests;
+    }
+    void add_written(size_t bytes) { _bytes_written += bytes; }
+    void add_throttled(std::chrono::milliseconds d) { _throttled += d; }
+
+private:
+    uint64_t _bytes_read{0};
+    uint64_t _bytes_written{0};
+    uint64_t _requests{0};
+    std::chrono::milliseconds _throttled{0};
+    lag_fn _lag;
+    ss::metrics::metric_groups _metrics;
+};
+
+} // namespace coproc
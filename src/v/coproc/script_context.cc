@@ -11,6 +11,7 @@
 
 #include "coproc/script_context.h"
 
+#include "config/configuration.h"
 #include "coproc/logger.h"
 #include "coproc/reference_window_consumer.hpp"
 #include "coproc/types.h"
@@ -22,10 +23,15 @@
 #include "storage/types.h"
 #include "vlog.h"
 
+#include <seastar/core/coroutine.hh>
 #include <seastar/core/sleep.hh>
 
+#include <absl/container/flat_hash_set.h>
+#include <absl/container/node_hash_map.h>
+
 #include <chrono>
 #include <exception>
+#include <iterator>
 
 namespace coproc {
 
@@ -67,6 +73,51 @@ script_context::script_context(
       !_ntp_ctxs.empty(),
       "Unallowed to create an instance of script_context without having a "
       "valid subscription list");
+    for (const auto& p : _ntp_ctxs) {
+        p.second->window.subscribe(_id);
+    }
+    _probe.setup_metrics(_id, [this] { return lag(); });
+}
+
+int64_t script_context::lag() const {
+    int64_t lag = 0;
+    for (const auto& [ntp, ntp_ctx] : _ntp_ctxs) {
+        auto found = ntp_ctx->offsets.find(_id);
+        if (found == ntp_ctx->offsets.end()) {
+            continue;
+        }
+        const auto acked = found->second.last_acked == model::offset{}
+                             ? model::offset(-1)
+                             : found->second.last_acked;
+        lag += std::max<int64_t>(
+          ntp_ctx->log.offsets().dirty_offset() - acked(), 0);
+    }
+    return lag;
+}
+
+ss::future<bool> script_context::throttle() {
+    const auto rate
+      = config::shard_local_cfg().coproc_max_script_bytes_per_second();
+    if (rate == 0) {
+        _budget.reset();
+        co_return true;
+    }
+    const auto now = token_bucket::clock::now();
+    if (!_budget || _budget->rate() != static_cast<double>(rate)) {
+        _budget.emplace(static_cast<double>(rate), now);
+    }
+    const auto delay = _budget->delay(now);
+    if (delay == token_bucket::clock::duration(0)) {
+        co_return true;
+    }
+    _probe.add_throttled(
+      std::chrono::duration_cast<std::chrono::milliseconds>(delay));
+    try {
+        co_await ss::sleep_abortable(delay, _abort_source);
+    } catch (const ss::sleep_aborted&) {
+        co_return false;
+    }
+    co_return true;
 }
 
 ss::future<> script_context::start() {
@@ -92,81 +143,180 @@ ss::future<> script_context::do_execute() {
     /// This loop executes while there is data to read from the input logs and
     /// while there is a current successful connection to the wasm engine.
     /// If both of those conditions aren't met, the loop breaks, hitting the
-    /// sleep_abortable() call in the fiber started by 'start()'
-    return ss::repeat([this] {
-        if (_abort_source.abort_requested()) {
-            return ss::make_ready_future<ss::stop_iteration>(
-              ss::stop_iteration::yes);
+    /// sleep_abortable() call in the fiber started by 'start()'.
+    ///
+    /// The stages overlap: the next request is read while the transforms in
+    /// flight hold less than coproc_max_inflight_bytes, and the replies are
+    /// queued for 'write_replies' which writes them in order. A failed request
+    /// stops the pipeline, the later replies are dropped and their inputs are
+    /// read again from the acked offsets on the next run.
+    const std::size_t max_inflight = max_inflight_bytes();
+    ss::semaphore inflight(max_inflight);
+    std::deque<pending_reply> pending;
+    ss::condition_variable cv;
+    bool done = false;
+    bool failed = false;
+    auto writes = write_replies(pending, cv, done, failed);
+    std::exception_ptr eptr;
+    try {
+        while (!_abort_source.abort_requested() && !failed
+               && !writes.available()) {
+            if (!_resources.engine.contains(_id)) {
+                auto transport = co_await _resources.transport.get_connected(
+                  model::no_timeout);
+                if (!transport) {
+                    /// Failed to connected to the wasm engine for whatever
+                    /// reason, exit to yield
+                    break;
+                }
+            }
+            if (!co_await throttle()) {
+                break;
+            }
+            input in = co_await read();
+            if (in.reqs.empty()) {
+                /// No data to read from all inputs, no need to incessently
+                /// loop, can exit to yield
+                break;
+            }
+            _probe.add_read(in.size_bytes);
+            if (_budget) {
+                _budget->consume(
+                  static_cast<double>(in.size_bytes),
+                  token_bucket::clock::now());
+            }
+            auto units = co_await ss::get_units(
+              inflight, std::min(in.size_bytes, max_inflight));
+            auto reply = transform(
+                           process_batch_request{.reqs = std::move(in.reqs)})
+                           .finally([units = std::move(units)] {});
+            pending.push_back(pending_reply{
+              .reply = std::move(reply), .last_read = std::move(in.last_read)});
+            cv.signal();
         }
-        return _resources.transport.get_connected(model::no_timeout)
-          .then([this](result<rpc::transport*> transport) {
-              if (!transport) {
-                  /// Failed to connected to the wasm engine for whatever
-                  /// reason, exit to yield
-                  return ss::make_ready_future<ss::stop_iteration>(
-                    ss::stop_iteration::yes);
-              }
-              supervisor_client_protocol client(*transport.value());
-              return read().then(
-                [this, client = std::move(client)](
-                  std::vector<process_batch_request::data> requests) mutable {
-                    if (requests.empty()) {
-                        /// No data to read from all inputs, no need to
-                        /// incessently loop, can exit to yield
-                        return ss::make_ready_future<ss::stop_iteration>(
-                          ss::stop_iteration::yes);
-                    }
-                    /// Send request to wasm engine
-                    process_batch_request req{.reqs = std::move(requests)};
-                    return send_request(std::move(client), std::move(req))
-                      .then([] { return ss::stop_iteration::no; });
-                });
-          });
-    });
+    } catch (...) {
+        eptr = std::current_exception();
+    }
+    done = true;
+    cv.signal();
+    try {
+        co_await std::move(writes);
+    } catch (...) {
+        if (!eptr) {
+            eptr = std::current_exception();
+        }
+    }
+    _next_read.clear();
+    if (eptr) {
+        std::rethrow_exception(eptr);
+    }
+}
+
+ss::future<> script_context::write_replies(
+  std::deque<pending_reply>& pending,
+  ss::condition_variable& cv,
+  const bool& done,
+  bool& failed) {
+    while (true) {
+        co_await cv.wait(
+          [&pending, &done] { return done || !pending.empty(); });
+        if (pending.empty()) {
+            co_return;
+        }
+        /// The replies which arrived while the previous group was written are
+        /// coalesced, so that a materialized log gets one append per group
+        reply_group group;
+        do {
+            pending_reply p = std::move(pending.front());
+            pending.pop_front();
+            auto reply = co_await std::move(p.reply);
+            if (failed || !reply) {
+                failed = true;
+                break;
+            }
+            group.emplace_back(std::move(*reply), std::move(p.last_read));
+        } while (!pending.empty() && pending.front().reply.available());
+        if (!group.empty()) {
+            const bool written = co_await process_replies(std::move(group));
+            failed = failed || !written;
+        }
+    }
 }
 
 ss::future<> script_context::shutdown() {
     _abort_source.request_abort();
-    return _gate.close().then([this] { _ntp_ctxs.clear(); });
+    return _gate.close().then([this] {
+        for (const auto& p : _ntp_ctxs) {
+            p.second->window.unsubscribe(_id);
+        }
+        _ntp_ctxs.clear();
+    });
+}
+
+ss::future<std::optional<process_batch_reply>>
+script_context::transform(process_batch_request r) {
+    auto m = _resources.stages.transform_latency().auto_measure();
+    return ss::with_gate(
+             _gate,
+             [this, r = std::move(r)]() mutable {
+                 if (_resources.engine.contains(_id)) {
+                     return _resources.engine.process_batch(std::move(r))
+                       .then([](process_batch_reply reply) {
+                           return std::optional<process_batch_reply>(
+                             std::move(reply));
+                       });
+                 }
+                 return _resources.transport.get_connected(model::no_timeout)
+                   .then([this, r = std::move(r)](
+                           result<rpc::transport*> transport) mutable {
+                       if (!transport) {
+                           return ss::make_ready_future<
+                             std::optional<process_batch_reply>>(std::nullopt);
+                       }
+                       supervisor_client_protocol client(*transport.value());
+                       return send_request(std::move(client), std::move(r));
+                   });
+             })
+      .handle_exception([id = _id](std::exception_ptr e) {
+          vlog(coproclog.warn, "Request of script {} failed: {}", id, e);
+          return std::optional<process_batch_reply>();
+      })
+      .finally([m = std::move(m)] {});
 }
 
-ss::future<> script_context::send_request(
+ss::future<std::optional<process_batch_reply>> script_context::send_request(
   supervisor_client_protocol client, process_batch_request r) {
     using reply_t = result<rpc::client_context<process_batch_reply>>;
     return client
       .process_batch(
         std::move(r), rpc::client_opts(rpc::clock_type::now() + 5s))
-      .then([this](reply_t reply) {
+      .then([](reply_t reply) -> std::optional<process_batch_reply> {
           if (reply) {
-              return process_reply(std::move(reply.value().data));
+              return std::move(reply.value().data);
           }
           vlog(
             coproclog.warn,
             "Error upon attempting to perform RPC to wasm engine, code: {}",
             reply.error());
-          return ss::now();
+          return std::nullopt;
       });
 }
 
-ss::future<std::vector<process_batch_request::data>> script_context::read() {
-    std::vector<process_batch_request::data> requests;
-    requests.reserve(_ntp_ctxs.size());
+ss::future<script_context::input> script_context::read() {
+    auto m = _resources.stages.read_latency().auto_measure();
+    input in;
+    in.reqs.reserve(_ntp_ctxs.size());
     return ss::do_with(
-      std::move(requests),
-      [this](std::vector<process_batch_request::data>& requests) {
-          return ss::parallel_for_each(
-                   _ntp_ctxs,
-                   [this, &requests](const ntp_context_cache::value_type& p) {
-                       return read_ntp(p.second).then(
-                         [&requests](
-                           std::optional<process_batch_request::data> r) {
-                             if (r) {
-                                 requests.push_back(std::move(*r));
-                             }
-                         });
-                   })
-            .then([&requests] { return std::move(requests); });
-      });
+             std::move(in),
+             [this](input& in) {
+                 return ss::parallel_for_each(
+                          _ntp_ctxs,
+                          [this, &in](const ntp_context_cache::value_type& p) {
+                              return read_ntp(p.second, in);
+                          })
+                   .then([&in] { return std::move(in); });
+             })
+      .finally([m = std::move(m)] {});
 }
 
 storage::log_reader_config
@@ -178,16 +328,21 @@ script_context::get_reader(const ss::lw_shared_ptr<ntp_context>& ntp_ctx) {
       _id,
       ntp_ctx->ntp());
     const ntp_context::offset_pair& cp_offsets = found->second;
-    const model::offset next_read
-      = (unlikely(cp_offsets.last_acked == model::offset{}))
-          ? model::offset(0)
-          : cp_offsets.last_acked + model::offset(1);
-    if (next_read <= cp_offsets.last_acked) {
-        vlog(
-          coproclog.info,
-          "Replaying read on ntp: {} at offset: {}",
-          ntp_ctx->ntp(),
-          cp_offsets.last_read);
+    model::offset next_read;
+    if (auto it = _next_read.find(ntp_ctx->ntp()); it != _next_read.end()) {
+        /// Read ahead of the requests in flight
+        next_read = it->second;
+    } else {
+        next_read = (unlikely(cp_offsets.last_acked == model::offset{}))
+                      ? model::offset(0)
+                      : cp_offsets.last_acked + model::offset(1);
+        if (next_read <= cp_offsets.last_acked) {
+            vlog(
+              coproclog.info,
+              "Replaying read on ntp: {} at offset: {}",
+              ntp_ctx->ntp(),
+              cp_offsets.last_read);
+        }
     }
     const storage::offset_stats os = ntp_ctx->log.offsets();
     return storage::log_reader_config(
@@ -201,92 +356,177 @@ script_context::get_reader(const ss::lw_shared_ptr<ntp_context>& ntp_ctx) {
       _abort_source);
 }
 
-ss::future<std::optional<process_batch_request::data>>
-script_context::read_ntp(ss::lw_shared_ptr<ntp_context> ntp_ctx) {
+ss::future<>
+script_context::read_ntp(ss::lw_shared_ptr<ntp_context> ntp_ctx, input& in) {
     return ss::with_semaphore(
-      _resources.read_sem, max_batch_size(), [this, ntp_ctx]() {
+      _resources.read_sem, max_batch_size(), [this, ntp_ctx, &in]() {
           storage::log_reader_config cfg = get_reader(ntp_ctx);
-          return ntp_ctx->log.make_reader(cfg)
-            .then([](model::record_batch_reader rbr) {
-                return model::consume_reader_to_memory(
-                  std::move(rbr), model::no_timeout);
-            })
+          return ntp_ctx->window.read(ntp_ctx->log, cfg)
             .then([](model::record_batch_reader::data_t data) {
                 return extract_batch_info(std::move(data));
             })
-            .then(
-              [this, ntp_ctx](std::optional<batch_info> obatch_info)
-                -> std::optional<process_batch_request::data> {
-                  if (!obatch_info) {
-                      return std::nullopt;
-                  }
-                  ntp_ctx->offsets[_id].last_read = obatch_info->last;
-                  return process_batch_request::data{
-                    .ids = std::vector<script_id>{_id},
-                    .ntp = ntp_ctx->ntp(),
-                    .reader = std::move(obatch_info->rbr)};
-              });
+            .then([this, ntp_ctx, &in](std::optional<batch_info> obatch_info) {
+                if (!obatch_info) {
+                    return;
+                }
+                const model::ntp& ntp = ntp_ctx->ntp();
+                ntp_ctx->offsets[_id].last_read = obatch_info->last;
+                _next_read[ntp] = obatch_info->last + model::offset(1);
+                in.last_read[ntp] = obatch_info->last;
+                in.size_bytes += obatch_info->total_size_bytes;
+                in.reqs.push_back(process_batch_request::data{
+                  .ids = std::vector<script_id>{_id},
+                  .ntp = ntp,
+                  .reader = std::move(obatch_info->rbr)});
+            });
       });
 }
 
-ss::future<> script_context::process_reply(process_batch_reply reply) {
-    return ss::do_with(std::move(reply), [this](process_batch_reply& reply) {
-        return ss::do_for_each(
-          reply.resps, [this](process_batch_reply::data& e) {
-              return process_one_reply(std::move(e));
-          });
-    });
+ss::future<bool> script_context::process_replies(reply_group group) {
+    auto m = _resources.stages.write_latency().auto_measure();
+    /// Outputs of the group in reply order per materialized log
+    absl::node_hash_map<model::ntp, model::record_batch_reader::data_t>
+      batches;
+    /// Materialized logs written per input, and the input offsets to ack
+    absl::flat_hash_map<model::ntp, absl::flat_hash_set<model::ntp>> sources;
+    read_offsets acked;
+    for (auto& [reply, offs] : group) {
+        for (auto& e : reply.resps) {
+            /// Ensure this 'script_context' instance is handling the correct
+            /// reply
+            if (e.id != _id) {
+                /// TODO: Maybe in the future errors of these type should mean
+                /// redpanda kill -9's the wasm engine.
+                vlog(
+                  coproclog.error,
+                  "erranous reply from wasm engine, mismatched id observed, "
+                  "expected: {} and observed {}",
+                  _id,
+                  e.id);
+                continue;
+            }
+            if (!e.reader) {
+                throw script_failed_exception(
+                  e.id,
+                  fmt::format(
+                    "script id {} will auto deregister due to an internal "
+                    "syntax error",
+                    e.id));
+            }
+            /// Use the source topic portion of the materialized topic to
+            /// perform a lookup for the relevent 'ntp_context'
+            model::materialized_ntp m_ntp(e.ntp);
+            const model::ntp& source = m_ntp.source_ntp();
+            auto read = offs.find(source);
+            if (!_ntp_ctxs.contains(source) || read == offs.end()) {
+                vlog(
+                  coproclog.warn,
+                  "script {} unknown source ntp: {}",
+                  _id,
+                  source);
+                continue;
+            }
+            acked[source] = read->second;
+            auto& outputs = sources[source];
+            if (!m_ntp.is_materialized()) {
+                /// Acks the input without output
+                continue;
+            }
+            outputs.insert(e.ntp);
+            auto data = co_await model::consume_reader_to_memory(
+              std::move(*e.reader), model::no_timeout);
+            for (const auto& b : data) {
+                _probe.add_written(b.size_bytes());
+            }
+            auto& out = batches[e.ntp];
+            std::move(data.begin(), data.end(), std::back_inserter(out));
+        }
+    }
+    if (config::shard_local_cfg().coproc_replicate_materialized()) {
+        /// Replicated outputs are repartitioned by key, the outputs of all
+        /// the inputs of a materialized topic are produced together. They
+        /// have no local offsets to checkpoint
+        absl::node_hash_map<model::topic, model::record_batch_reader::data_t>
+          topics;
+        for (auto& [ntp, data] : batches) {
+            auto& out = topics[ntp.tp.topic];
+            std::move(data.begin(), data.end(), std::back_inserter(out));
+        }
+        for (auto& [topic, data] : topics) {
+            if (!co_await _resources.producer.produce(topic, std::move(data))) {
+                co_return false;
+            }
+        }
+        written_outputs outputs;
+        for (const auto& [source, ntps] : sources) {
+            outputs[source];
+        }
+        ack(acked, std::move(outputs));
+        co_return true;
+    }
+    absl::flat_hash_map<model::ntp, model::offset> last_written;
+    for (auto& [ntp, data] : batches) {
+        auto last = co_await write_materialized(
+          model::materialized_ntp(ntp),
+          model::make_memory_record_batch_reader(std::move(data)));
+        if (!last) {
+            vlog(coproclog.warn, "record_batch failed to pass crc checks");
+            co_return false;
+        }
+        last_written.emplace(ntp, *last);
+    }
+    written_outputs outputs;
+    for (const auto& [source, ntps] : sources) {
+        auto& written = outputs[source];
+        for (const auto& ntp : ntps) {
+            auto found = last_written.find(ntp);
+            if (
+              found != last_written.end()
+              && found->second >= model::offset(0)) {
+                written.emplace(ntp, found->second);
+            }
+        }
+    }
+    ack(acked, std::move(outputs));
+    co_return true;
 }
 
-ss::future<> script_context::process_one_reply(process_batch_reply::data e) {
-    /// Ensure this 'script_context' instance is handling the correct reply
-    if (e.id != _id) {
-        /// TODO: Maybe in the future errors of these type should mean redpanda
-        /// kill -9's the wasm engine.
-        vlog(
-          coproclog.error,
-          "erranous reply from wasm engine, mismatched id observed, expected: "
-          "{} and observed {}",
-          _id,
-          e.id);
-        return ss::now();
-    }
-    if (!e.reader) {
-        return ss::make_exception_future<>(script_failed_exception(
-          e.id,
-          fmt::format(
-            "script id {} will auto deregister due to an internal syntax "
-            "error",
-            e.id)));
+/// Batches acked by all subscribers of the input are no longer shared
+static void trim_window(ntp_context& ntp_ctx) {
+    auto acked = model::offset::max();
+    for (const script_id id : ntp_ctx.window.subscribers()) {
+        auto found = ntp_ctx.offsets.find(id);
+        if (found != ntp_ctx.offsets.end()) {
+            acked = std::min(acked, found->second.last_acked);
+        }
     }
-    /// Use the source topic portion of the materialized topic to perform a
-    /// lookup for the relevent 'ntp_context'
-    auto materialized_ntp = model::materialized_ntp(e.ntp);
-    auto found = _ntp_ctxs.find(materialized_ntp.source_ntp());
-    if (found == _ntp_ctxs.end()) {
-        vlog(
-          coproclog.warn,
-          "script {} unknown source ntp: {}",
+    ntp_ctx.window.trim(acked);
+}
+
+void script_context::ack(const read_offsets& offs, written_outputs outputs) {
+    /// Applied at once so that a checkpoint never covers part of the outputs
+    /// of an input
+    for (auto& [source, written] : outputs) {
+        auto found = _ntp_ctxs.find(source);
+        auto read = offs.find(source);
+        if (found == _ntp_ctxs.end() || read == offs.end()) {
+            continue;
+        }
+        auto ntp_ctx = found->second;
+        auto ofound = ntp_ctx->offsets.find(_id);
+        vassert(
+          ofound != ntp_ctx->offsets.end(),
+          "Offset not found for script id {} for ntp owning context: {}",
           _id,
-          materialized_ntp.source_ntp());
-        return ss::now();
+          ntp_ctx->ntp());
+        /// Reset the acked offset so that progress can be made
+        ofound->second.last_acked = read->second;
+        for (auto& [ntp, offset] : written) {
+            ofound->second.outputs[ntp] = offset;
+        }
+        ofound->second.dirty = true;
+        trim_window(*ntp_ctx);
     }
-    auto ntp_ctx = found->second;
-    return write_materialized(materialized_ntp, std::move(*e.reader))
-      .then([this, ntp_ctx](bool crc_parse_failure) {
-          if (crc_parse_failure) {
-              vlog(coproclog.warn, "record_batch failed to pass crc checks");
-              return;
-          }
-          auto ofound = ntp_ctx->offsets.find(_id);
-          vassert(
-            ofound != ntp_ctx->offsets.end(),
-            "Offset not found for script id {} for ntp owning context: {}",
-            _id,
-            ntp_ctx->ntp());
-          /// Reset the acked offset so that progress can be made
-          ofound->second.last_acked = ofound->second.last_read;
-      });
 }
 
 ss::future<storage::log> get_log(storage::api& api, const model::ntp& ntp) {
@@ -299,7 +539,9 @@ ss::future<storage::log> get_log(storage::api& api, const model::ntp& ntp) {
       storage::ntp_config(ntp, api.log_mgr().config().base_dir));
 }
 
-ss::future<bool>
+/// Resolves to the last offset of the log once the batches are written, or
+/// std::nullopt if a batch failed its crc check
+ss::future<std::optional<model::offset>>
 write_checked(storage::log log, model::record_batch_reader reader) {
     const storage::log_append_config write_cfg{
       .should_fsync = storage::log_append_config::fsync::no,
@@ -310,13 +552,17 @@ write_checked(storage::log log, model::record_batch_reader reader) {
         coproc::reference_window_consumer(
           model::record_batch_crc_checker(), log.make_appender(write_cfg)),
         model::no_timeout)
-      .then([](std::tuple<bool, ss::future<storage::append_result>> t) {
+      .then([log](std::tuple<bool, ss::future<storage::append_result>> t)
+              -> std::optional<model::offset> {
           const auto& [crc_parse_success, _] = t;
-          return !crc_parse_success;
+          if (!crc_parse_success) {
+              return std::nullopt;
+          }
+          return log.offsets().dirty_offset;
       });
 }
 
-ss::future<bool> script_context::write_materialized(
+ss::future<std::optional<model::offset>> script_context::write_materialized(
   const model::materialized_ntp& m_ntp, model::record_batch_reader reader) {
     auto found = _resources.log_mtx.find(m_ntp.input_ntp());
     if (found == _resources.log_mtx.end()) {
@@ -12,15 +12,25 @@
 #pragma once
 
 #include "coproc/ntp_context.h"
+#include "coproc/probe.h"
 #include "coproc/supervisor.h"
 #include "coproc/types.h"
 #include "random/simple_time_jitter.h"
+#include "resource_mgmt/token_bucket.h"
 #include "utils/mutex.h"
 
 #include <seastar/core/abort_source.hh>
+#include <seastar/core/condition-variable.hh>
 #include <seastar/core/semaphore.hh>
 #include <seastar/core/shared_ptr.hh>
 
+#include <absl/container/flat_hash_map.h>
+
+#include <deque>
+#include <optional>
+#include <utility>
+#include <vector>
+
 namespace coproc {
 
 /**
@@ -29,13 +39,18 @@ namespace coproc {
  * representing one fiber.
  *
  * Important to note is the level of concurrency provided. Within a
- * script_context there is one fiber for which scheduled asynchronous work is
- * performed in sync, meaning that for each read -> send -> write that occurs
- * within the run loop, those actions will occur in order.
+ * script_context there is one fiber which pipelines the read -> send -> write
+ * stages of the run loop. The next request is read while previous ones are
+ * in flight, up to coproc_max_inflight_bytes, and the replies are written in
+ * the order their requests were read.
  *
  * Since each script_context has one of these fibers of its own, no one context
  * will wait for work to be finished by another in order to continue making
  * progress. They all operate independently of eachother.
+ *
+ * A script reads at most coproc_max_script_bytes_per_second from its inputs,
+ * past its budget it is throttled before reading again so that it leaves the
+ * coproc scheduling group to the other scripts of the shard.
  */
 class script_context {
 public:
@@ -69,28 +84,76 @@ public:
     ss::future<> shutdown();
 
 private:
+    /// Last offset read per input ntp, acked once the reply is written
+    using read_offsets = absl::flat_hash_map<model::ntp, model::offset>;
+
+    /// A request read from the inputs of the script
+    struct input {
+        std::vector<process_batch_request::data> reqs;
+        read_offsets last_read;
+        std::size_t size_bytes{0};
+    };
+
     ss::future<> do_execute();
 
-    ss::future<>
+    /// Resolves to std::nullopt if the request failed
+    ss::future<std::optional<process_batch_reply>>
+      transform(process_batch_request);
+
+    ss::future<std::optional<process_batch_reply>>
       send_request(supervisor_client_protocol, process_batch_request);
 
     storage::log_reader_config
     get_reader(const ss::lw_shared_ptr<ntp_context>&);
 
-    ss::future<std::vector<process_batch_request::data>> read();
-
-    ss::future<std::optional<process_batch_request::data>>
-      read_ntp(ss::lw_shared_ptr<ntp_context>);
-
-    ss::future<> process_reply(process_batch_reply);
-    ss::future<> process_one_reply(process_batch_reply::data);
-    ss::future<bool> write_materialized(
+    ss::future<input> read();
+
+    ss::future<> read_ntp(ss::lw_shared_ptr<ntp_context>, input&);
+
+    /// Last offset written to each materialized log per input ntp
+    using written_outputs = absl::
+      flat_hash_map<model::ntp, absl::flat_hash_map<model::ntp, model::offset>>;
+
+    /// A request in flight, in the order requests were read
+    struct pending_reply {
+        ss::future<std::optional<process_batch_reply>> reply;
+        read_offsets last_read;
+    };
+
+    /// Consecutive replies which are written together
+    using reply_group
+      = std::vector<std::pair<process_batch_reply, read_offsets>>;
+
+    /// Writes the replies of 'pending' in order until 'done' is set and all
+    /// of them are written, sets 'failed' if a request or write failed
+    ss::future<> write_replies(
+      std::deque<pending_reply>&,
+      ss::condition_variable&,
+      const bool& done,
+      bool& failed);
+
+    /// Resolves to false if the replies weren't written, which stops the
+    /// pipeline
+    ss::future<bool> process_replies(reply_group);
+    void ack(const read_offsets&, written_outputs);
+    ss::future<std::optional<model::offset>> write_materialized(
       const model::materialized_ntp&, model::record_batch_reader);
 
     std::size_t max_batch_size() const {
         return config::shard_local_cfg().coproc_max_batch_size.value();
     }
 
+    std::size_t max_inflight_bytes() const {
+        return config::shard_local_cfg().coproc_max_inflight_bytes.value();
+    }
+
+    /// Waits until the script is within its bytes budget, resolves to false
+    /// if the context was shut down meanwhile
+    ss::future<bool> throttle();
+
+    /// Records of the inputs read but not acked, summed over the inputs
+    int64_t lag() const;
+
 private:
     /// Killswitch for in-process reads
     ss::abort_source _abort_source;
@@ -107,5 +170,14 @@ private:
 
     /// Uniquely identifying script id. Generated by coproc engine
     script_id _id;
+
+    /// Next offset to read per input ntp while its requests are in flight,
+    /// cleared once the pipeline drains so that unacked data is read again
+    absl::flat_hash_map<model::ntp, model::offset> _next_read;
+
+    /// Bytes budget of the reads, unset without a limit
+    std::optional<token_bucket> _budget;
+
+    script_probe _probe;
 };
 } // namespace coproc
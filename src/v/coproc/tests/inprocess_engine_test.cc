@@ -0,0 +1,143 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#include "coproc/inprocess_engine.h"
+#include "coproc/types.h"
+#include "model/fundamental.h"
+#include "model/record_batch_reader.h"
+#include "model/timeout_clock.h"
+#include "storage/tests/utils/random_batch.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+
+using namespace coproc;
+
+namespace {
+
+const model::topic identity_topic("identity");
+
+/// Writes the input as is onto 'identity_topic'
+class identity final : public transform {
+public:
+    ss::future<result> apply(
+      const model::topic&, model::record_batch_reader::data_t&& b) final {
+        result r;
+        r.emplace(identity_topic, std::move(b));
+        return ss::make_ready_future<result>(std::move(r));
+    }
+};
+
+/// Acks the input without writing anything
+class drop_all final : public transform {
+public:
+    ss::future<result>
+    apply(const model::topic&, model::record_batch_reader::data_t&&) final {
+        return ss::make_ready_future<result>();
+    }
+};
+
+class throwing final : public transform {
+public:
+    ss::future<result>
+    apply(const model::topic&, model::record_batch_reader::data_t&&) final {
+        return ss::make_exception_future<result>(
+          std::runtime_error("apply failed"));
+    }
+};
+
+model::ntp input_ntp() {
+    return model::ntp(
+      model::kafka_namespace, model::topic("input"), model::partition_id(3));
+}
+
+process_batch_request
+make_request(std::vector<script_id> ids, int n_batches) {
+    process_batch_request r;
+    r.reqs.push_back(process_batch_request::data{
+      .ids = std::move(ids),
+      .ntp = input_ntp(),
+      .reader = model::make_memory_record_batch_reader(
+        storage::test::make_random_batches(model::offset(0), n_batches))});
+    return r;
+}
+
+size_t count_batches(std::optional<model::record_batch_reader>& reader) {
+    BOOST_REQUIRE(reader);
+    return model::consume_reader_to_memory(
+             std::move(*reader), model::no_timeout)
+      .get0()
+      .size();
+}
+
+} // namespace
+
+SEASTAR_THREAD_TEST_CASE(test_inprocess_identity) {
+    inprocess_engine engine;
+    engine.add(script_id(1), std::make_unique<identity>());
+    BOOST_REQUIRE(engine.contains(script_id(1)));
+    auto reply = engine.process_batch(make_request({script_id(1)}, 5)).get0();
+    BOOST_REQUIRE_EQUAL(reply.resps.size(), 1);
+    auto& resp = reply.resps.front();
+    BOOST_REQUIRE_EQUAL(resp.id, script_id(1));
+    BOOST_REQUIRE_EQUAL(
+      resp.ntp,
+      model::ntp(
+        model::kafka_namespace,
+        model::to_materialized_topic(input_ntp().tp.topic, identity_topic),
+        input_ntp().tp.partition));
+    BOOST_REQUIRE_EQUAL(count_batches(resp.reader), 5);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_inprocess_empty_result_acks_input) {
+    inprocess_engine engine;
+    engine.add(script_id(1), std::make_unique<drop_all>());
+    auto reply = engine.process_batch(make_request({script_id(1)}, 5)).get0();
+    BOOST_REQUIRE_EQUAL(reply.resps.size(), 1);
+    BOOST_REQUIRE_EQUAL(reply.resps.front().ntp, input_ntp());
+    BOOST_REQUIRE_EQUAL(count_batches(reply.resps.front().reader), 0);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_inprocess_failure_replies_null_reader) {
+    inprocess_engine engine;
+    engine.add(script_id(1), std::make_unique<throwing>());
+    auto reply = engine.process_batch(make_request({script_id(1)}, 5)).get0();
+    BOOST_REQUIRE_EQUAL(reply.resps.size(), 1);
+    BOOST_REQUIRE_EQUAL(reply.resps.front().id, script_id(1));
+    BOOST_REQUIRE(!reply.resps.front().reader);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_inprocess_scripts_share_input) {
+    inprocess_engine engine;
+    engine.add(script_id(1), std::make_unique<identity>());
+    engine.add(script_id(2), std::make_unique<identity>());
+    auto reply = engine
+                   .process_batch(
+                     make_request({script_id(1), script_id(2)}, 5))
+                   .get0();
+    BOOST_REQUIRE_EQUAL(reply.resps.size(), 2);
+    for (auto& resp : reply.resps) {
+        BOOST_REQUIRE_EQUAL(count_batches(resp.reader), 5);
+    }
+}
+
+SEASTAR_THREAD_TEST_CASE(test_inprocess_remove) {
+    inprocess_engine engine;
+    engine.add(script_id(1), std::make_unique<identity>());
+    BOOST_REQUIRE(engine.remove(script_id(1)));
+    BOOST_REQUIRE(!engine.remove(script_id(1)));
+    BOOST_REQUIRE(!engine.contains(script_id(1)));
+    /// Unknown ids are skipped
+    auto reply = engine.process_batch(make_request({script_id(1)}, 5)).get0();
+    BOOST_REQUIRE(reply.resps.empty());
+}
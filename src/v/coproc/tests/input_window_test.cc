@@ -0,0 +1,91 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#include "coproc/input_window.h"
+#include "storage/tests/utils/disk_log_builder.h"
+#include "units.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace coproc;
+
+namespace {
+
+/// Three batches of 10 records at offsets 0, 10 and 20
+void make_log(storage::disk_log_builder& b) {
+    b | storage::start() | storage::add_segment(0)
+      | storage::add_random_batch(0, 10, storage::maybe_compress_batches::no)
+      | storage::add_random_batch(10, 10, storage::maybe_compress_batches::no)
+      | storage::add_random_batch(20, 10, storage::maybe_compress_batches::no);
+}
+
+storage::log_reader_config reader_at(int64_t start, size_t max_bytes) {
+    return storage::log_reader_config(
+      model::offset(start),
+      model::offset(29),
+      0,
+      max_bytes,
+      ss::default_priority_class(),
+      std::nullopt,
+      std::nullopt,
+      std::nullopt);
+}
+
+} // namespace
+
+SEASTAR_THREAD_TEST_CASE(test_single_subscriber_isnt_cached) {
+    storage::disk_log_builder b;
+    make_log(b);
+    input_window w(1_MiB);
+    w.subscribe(script_id(1));
+    auto batches = w.read(b.get_log(), reader_at(0, 1_MiB)).get0();
+    BOOST_REQUIRE_EQUAL(batches.size(), 3);
+    BOOST_REQUIRE_EQUAL(w.size_bytes(), 0);
+    b | storage::stop();
+}
+
+SEASTAR_THREAD_TEST_CASE(test_subscribers_share_reads) {
+    storage::disk_log_builder b;
+    make_log(b);
+    input_window w(1_MiB);
+    w.subscribe(script_id(1));
+    w.subscribe(script_id(2));
+    auto first = w.read(b.get_log(), reader_at(0, 1_MiB)).get0();
+    BOOST_REQUIRE_EQUAL(first.size(), 3);
+    BOOST_REQUIRE_GT(w.size_bytes(), 0);
+    /// A read within the window doesn't go to the log
+    auto second = w.read(b.get_log(), reader_at(10, 1_MiB)).get0();
+    BOOST_REQUIRE_EQUAL(second.size(), 2);
+    BOOST_REQUIRE_EQUAL(second.front().base_offset(), model::offset(10));
+    BOOST_REQUIRE_EQUAL(second.back().last_offset(), model::offset(29));
+    /// Acked by both subscribers
+    w.trim(model::offset(29));
+    BOOST_REQUIRE_EQUAL(w.size_bytes(), 0);
+    b | storage::stop();
+}
+
+SEASTAR_THREAD_TEST_CASE(test_slowest_subscriber_holds_window) {
+    storage::disk_log_builder b;
+    make_log(b);
+    input_window w(1);
+    w.subscribe(script_id(1));
+    w.subscribe(script_id(2));
+    auto first = w.read(b.get_log(), reader_at(0, 1)).get0();
+    BOOST_REQUIRE_EQUAL(first.size(), 1);
+    /// The window is full until the first batch is trimmed
+    BOOST_REQUIRE(w.read(b.get_log(), reader_at(10, 1)).get0().empty());
+    w.trim(model::offset(9));
+    auto next = w.read(b.get_log(), reader_at(10, 1)).get0();
+    BOOST_REQUIRE_EQUAL(next.size(), 1);
+    BOOST_REQUIRE_EQUAL(next.front().base_offset(), model::offset(10));
+    b | storage::stop();
+}
@@ -14,6 +14,7 @@
 #include "model/namespace.h"
 #include "storage/api.h"
 #include "storage/snapshot.h"
+#include "storage/tests/utils/random_batch.h"
 #include "test_utils/fixture.h"
 
 #include <seastar/testing/thread_test_case.hh>
@@ -67,6 +68,21 @@ public:
         return ntpcc;
     }
 
+    /// Appends 'n' random batches, returns the last offset of the log
+    model::offset append(storage::log log, int n) {
+        storage::log_append_config cfg{
+          .should_fsync = storage::log_append_config::fsync::no,
+          .io_priority = ss::default_priority_class(),
+          .timeout = model::no_timeout};
+        auto reader = model::make_memory_record_batch_reader(
+          storage::test::make_random_batches(model::offset(0), n));
+        std::move(reader)
+          .for_each_ref(log.make_appender(cfg), cfg.timeout)
+          .get();
+        return log.offsets().dirty_offset;
+    }
+
+    storage::api& api() { return _api; }
     storage::log_manager& log_mgr() { return _api.log_mgr(); }
     storage::snapshot_manager& snapshot_mgr() { return _snap; }
 
@@ -122,3 +138,35 @@ FIXTURE_TEST(offset_keeper_saved_offsets, offset_keeper_fixture) {
     /// and for every topic 2 scripts are tracking offsets for 100 total
     BOOST_CHECK_EQUAL(total_offsets, 100);
 }
+
+FIXTURE_TEST(offset_keeper_checkpoints, offset_keeper_fixture) {
+    auto cache = create_test_cache(2);
+    auto& input = *cache.begin();
+    model::ntp output_ntp(
+      model::kafka_namespace,
+      model::to_materialized_topic(input.first.tp.topic, model::topic("out")),
+      model::partition_id(0));
+    auto output = log_mgr()
+                    .manage(storage::ntp_config(
+                      output_ntp, log_mgr().config().base_dir))
+                    .get0();
+    const auto committed = append(output, 3);
+
+    /// Only acked offsets are checkpointed
+    auto& offsets = input.second->offsets[coproc::script_id(4444)];
+    offsets.outputs[output_ntp] = committed;
+    offsets.dirty = true;
+    coproc::save_checkpoints(api(), cache).get();
+    BOOST_CHECK(!offsets.dirty);
+
+    /// Outputs written after the checkpoint are rolled back on recovery
+    BOOST_REQUIRE_GT(append(output, 3), committed);
+    auto recovered = coproc::recover_checkpoints(api()).get0();
+    BOOST_REQUIRE_EQUAL(recovered.size(), 1);
+    auto& r = recovered.at(input.first)->offsets;
+    BOOST_REQUIRE_EQUAL(r.size(), 1);
+    BOOST_CHECK_EQUAL(r.begin()->first, coproc::script_id(4444));
+    BOOST_CHECK_EQUAL(r.begin()->second.last_acked, offsets.last_acked);
+    BOOST_CHECK_EQUAL(r.begin()->second.outputs.at(output_ntp), committed);
+    BOOST_CHECK_EQUAL(output.offsets().dirty_offset, committed);
+}
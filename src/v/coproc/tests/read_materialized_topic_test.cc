@@ -8,11 +8,16 @@
  * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
  */
 
+#include "config/configuration.h"
 #include "coproc/tests/utils/coprocessor.h"
 #include "coproc/tests/utils/router_test_fixture.h"
 #include "coproc/types.h"
 #include "kafka/client/transport.h"
+#include "model/record_batch_reader.h"
 #include "storage/tests/utils/random_batch.h"
+#include "test_utils/async.h"
+
+#include <seastar/util/defer.hh>
 
 #include <boost/test/tools/old/interface.hpp>
 #include <boost/test/unit_test_log.hpp>
@@ -74,3 +79,88 @@ FIXTURE_TEST(test_read_from_materialized_topic, router_test_fixture) {
     //   std::move(*resp.partitions[0].responses[0].record_set).release(),
     //   data);
 }
+
+static void set_replicate_materialized(bool v) {
+    ss::smp::invoke_on_all([v] {
+        config::shard_local_cfg()
+          .get("coproc_replicate_materialized")
+          .set_value(v);
+    }).get();
+}
+
+static size_t fetch_record_count(
+  kafka::client::transport& client,
+  const model::topic& topic,
+  int32_t partitions) {
+    kafka::fetch_request req;
+    req.max_bytes = std::numeric_limits<int32_t>::max();
+    req.min_bytes = 1;
+    req.max_wait_time = 100ms;
+    kafka::fetch_request::topic t{.name = topic};
+    for (int32_t p = 0; p < partitions; ++p) {
+        t.partitions.push_back(
+          {.id = model::partition_id(p), .fetch_offset = model::offset(0)});
+    }
+    req.topics = {std::move(t)};
+    auto resp = client.dispatch(req, kafka::api_version(4)).get0();
+    size_t records = 0;
+    for (auto& part : resp.partitions) {
+        for (auto& r : part.responses) {
+            BOOST_REQUIRE_EQUAL(r.error, kafka::error_code::none);
+            while (r.record_set && !r.record_set->empty()) {
+                auto kba = r.record_set->consume_batch();
+                BOOST_REQUIRE(kba.batch);
+                records += kba.batch->record_count();
+            }
+        }
+    }
+    return records;
+}
+
+FIXTURE_TEST(test_replicate_materialized_topic, router_test_fixture) {
+    set_replicate_materialized(true);
+    auto reset = ss::defer([] { set_replicate_materialized(false); });
+    model::topic input_topic("bar");
+    model::topic output_topic = model::to_materialized_topic(
+      input_topic, identity_coprocessor::identity_topic);
+    setup({{input_topic, 2}}).get();
+
+    enable_coprocessors(
+      {{.id = 4321,
+        .data{
+          .tid = coproc::registry::type_identifier::identity_coprocessor,
+          .topics = {input_topic}}}})
+      .get();
+
+    /// All the inputs land on one partition, the outputs are spread by key
+    auto batches = model::consume_reader_to_memory(
+                     storage::test::make_random_memory_record_batch_reader(
+                       model::offset(0), 8, 4),
+                     model::no_timeout)
+                     .get0();
+    size_t records = 0;
+    for (const auto& b : batches) {
+        records += b.record_count();
+    }
+    push(
+      model::ntp(model::kafka_namespace, input_topic, model::partition_id(0)),
+      model::make_memory_record_batch_reader(std::move(batches)))
+      .get();
+
+    /// The materialized topic is created in the cluster with the partitions
+    /// of its source topic
+    tests::cooperative_spin_wait_with_timeout(10s, [this, &output_topic] {
+        auto md = app.metadata_cache.local().get_topic_metadata(
+          model::topic_namespace_view(model::kafka_namespace, output_topic));
+        return md && md->partitions.size() == 2;
+    }).get();
+
+    auto client = make_kafka_client().get0();
+    client.connect().get();
+    auto stop = ss::defer([&client] {
+        client.stop().then([&client] { client.shutdown(); }).get();
+    });
+    tests::cooperative_spin_wait_with_timeout(10s, [&] {
+        return fetch_record_count(client, output_topic, 2) == records;
+    }).get();
+}
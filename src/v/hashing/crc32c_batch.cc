@@ -0,0 +1,165 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "hashing/crc32c_batch.h"
+
+#include <crc32c/crc32c.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace {
+
+// streams advanced together, enough to cover the latency of the instruction
+constexpr size_t interleave = 3;
+
+struct cursor {
+    const uint8_t* data;
+    size_t left;
+};
+
+#if defined(__x86_64__)
+#define CRC32C_BATCH_HW
+__attribute__((target("sse4.2"))) inline uint32_t
+hw_crc_u64(uint32_t crc, const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return static_cast<uint32_t>(_mm_crc32_u64(crc, v));
+}
+bool hw_available() {
+    static const bool available = __builtin_cpu_supports("sse4.2");
+    return available;
+}
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define CRC32C_BATCH_HW
+inline uint32_t hw_crc_u64(uint32_t crc, const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return __crc32cd(crc, v);
+}
+constexpr bool hw_available() { return true; }
+#endif
+
+#ifdef CRC32C_BATCH_HW
+/// advances every cursor by the same number of 8 byte words. the crcs are
+/// the raw (inverted) register values
+#if defined(__x86_64__)
+__attribute__((target("sse4.2")))
+#endif
+void hw_lockstep(
+  std::array<uint32_t, interleave>& crcs,
+  std::array<cursor, interleave>& cursors,
+  size_t n,
+  size_t words) {
+    for (size_t w = 0; w < words; ++w) {
+        for (size_t i = 0; i < n; ++i) {
+            crcs[i] = hw_crc_u64(crcs[i], cursors[i].data);
+            cursors[i].data += sizeof(uint64_t);
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        cursors[i].left -= words * sizeof(uint64_t);
+    }
+}
+#endif
+
+} // namespace
+
+size_t crc32c_batch::add_stream() {
+    _streams.push_back(stream{
+      .first_fragment = _fragments.size(),
+      .end_fragment = _fragments.size(),
+    });
+    return _streams.size() - 1;
+}
+
+void crc32c_batch::extend(const uint8_t* data, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    _fragments.push_back(fragment{data, size});
+    _streams.back().end_fragment = _fragments.size();
+}
+
+void crc32c_batch::compute() {
+#ifdef CRC32C_BATCH_HW
+    if (hw_available()) {
+        for (size_t g = 0; g < _streams.size(); g += interleave) {
+            const size_t n = std::min(interleave, _streams.size() - g);
+            std::array<size_t, interleave> next{};
+            std::array<cursor, interleave> cursors{};
+            std::array<uint32_t, interleave> crcs{};
+            size_t active = 0;
+            for (size_t i = 0; i < n; ++i) {
+                next[i] = _streams[g + i].first_fragment;
+                crcs[i] = ~_streams[g + i].crc;
+            }
+            // finishes the current fragment of a stream when it has less
+            // than a word left and moves on to its next fragment
+            auto refill = [&](size_t i) {
+                while (cursors[i].left < sizeof(uint64_t)) {
+                    if (cursors[i].left > 0) {
+                        crcs[i] = ~crc32c::Extend(
+                          ~crcs[i], cursors[i].data, cursors[i].left);
+                        cursors[i].left = 0;
+                    }
+                    if (next[i] == _streams[g + i].end_fragment) {
+                        return false;
+                    }
+                    auto& f = _fragments[next[i]++];
+                    cursors[i] = cursor{f.data, f.size};
+                }
+                return true;
+            };
+            for (size_t i = 0; i < n; ++i) {
+                active += refill(i);
+            }
+            while (active == n) {
+                size_t words = cursors[0].left / sizeof(uint64_t);
+                for (size_t i = 1; i < n; ++i) {
+                    words = std::min(words, cursors[i].left / sizeof(uint64_t));
+                }
+                hw_lockstep(crcs, cursors, n, words);
+                for (size_t i = 0; i < n; ++i) {
+                    if (!refill(i)) {
+                        --active;
+                    }
+                }
+            }
+            // the rest of the streams have nothing to overlap with
+            for (size_t i = 0; i < n; ++i) {
+                auto& s = _streams[g + i];
+                s.crc = ~crcs[i];
+                if (cursors[i].left > 0) {
+                    s.crc = crc32c::Extend(
+                      s.crc, cursors[i].data, cursors[i].left);
+                }
+                for (; next[i] < s.end_fragment; ++next[i]) {
+                    auto& f = _fragments[next[i]];
+                    s.crc = crc32c::Extend(s.crc, f.data, f.size);
+                }
+            }
+        }
+        return;
+    }
+#endif
+    for (auto& s : _streams) {
+        for (size_t f = s.first_fragment; f < s.end_fragment; ++f) {
+            s.crc = crc32c::Extend(
+              s.crc, _fragments[f].data, _fragments[f].size);
+        }
+    }
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Computes the crc32c of many independent byte streams together.
+ *
+ * The hardware crc instruction has a latency of several cycles but can start
+ * one every cycle, a single stream of small fragments (a record batch header
+ * and a few records) leaves the unit mostly idle. Streams are advanced in
+ * lockstep, several at a time, so their dependency chains overlap. Without
+ * hardware support every stream falls back to crc32c::Extend.
+ *
+ *   crc32c_batch crcs;
+ *   for (auto& b : batches) {
+ *       crcs.add_stream();
+ *       for (auto& f : fragments_of(b)) {
+ *           crcs.extend(f.get(), f.size());
+ *       }
+ *   }
+ *   crcs.compute();
+ *   auto crc = crcs.value(0);
+ *
+ * The bytes passed to extend() are not copied, they have to stay alive until
+ * compute() returns.
+ */
+class crc32c_batch {
+public:
+    /// \brief starts a new checksum, returns its index
+    size_t add_stream();
+
+    /// \brief appends bytes to the last stream
+    void extend(const uint8_t* data, size_t size);
+    void extend(const char* data, size_t size) {
+        // NOLINTNEXTLINE
+        extend(reinterpret_cast<const uint8_t*>(data), size);
+    }
+
+    void compute();
+
+    uint32_t value(size_t stream) const { return _streams[stream].crc; }
+    size_t size() const { return _streams.size(); }
+
+private:
+    struct fragment {
+        const uint8_t* data;
+        size_t size;
+    };
+    struct stream {
+        size_t first_fragment;
+        size_t end_fragment;
+        uint32_t crc{0};
+    };
+
+    std::vector<stream> _streams;
+    std::vector<fragment> _fragments;
+};
@@ -0,0 +1,65 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "hashing/crc32c_shift.h"
+
+#include <crc32c/crc32c.h>
+
+#include <array>
+
+namespace {
+
+// the reflected castagnoli polynomial, the bit 31 is x^0
+constexpr uint32_t polynomial = 0x82f63b78;
+constexpr uint32_t x0 = uint32_t(1) << 31;
+
+// a * b modulo the polynomial
+constexpr uint32_t multiply(uint32_t a, uint32_t b) {
+    uint32_t product = 0;
+    for (uint32_t m = x0; m != 0; m >>= 1) {
+        if (a & m) {
+            product ^= b;
+        }
+        b = (b & 1) ? (b >> 1) ^ polynomial : b >> 1;
+    }
+    return product;
+}
+
+// x^(2^k) modulo the polynomial
+constexpr auto make_x2k() {
+    // 3 + 64 entries: the shifts are in bits of size_t byte counts
+    std::array<uint32_t, 67> x2k{};
+    uint32_t p = x0 >> 1; // x^1
+    for (auto& e : x2k) {
+        e = p;
+        p = multiply(p, p);
+    }
+    return x2k;
+}
+
+constexpr auto x2k = make_x2k();
+
+} // namespace
+
+uint32_t crc32c_raw(const uint8_t* data, size_t size) {
+    // Extend() xors the crc before and after hashing, starting from the
+    // complement of 0 hashes without the initial value nor the final xor
+    return ~crc32c::Extend(~uint32_t(0), data, size);
+}
+
+uint32_t crc32c_shift(uint32_t raw, size_t n) {
+    // x^(8n), from the bits of n: a byte is 2^3 bits
+    uint32_t xn = x0;
+    for (size_t k = 3; n != 0; n >>= 1, ++k) {
+        if (n & 1) {
+            xn = multiply(x2k[k], xn);
+        }
+    }
+    return multiply(xn, raw);
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * crc32c updates without rehashing the whole message, from the linearity of
+ * the crc: for messages of the same length crc(a) ^ crc(b) is the crc of
+ * a ^ b without the initial value nor the final xor (the raw crc). Trailing
+ * zero bytes are appended to a raw crc with a multiplication by a power of x
+ * modulo the polynomial, in O(log n) of the number of zeros.
+ */
+
+/// \brief the raw crc32c of the bytes
+uint32_t crc32c_raw(const uint8_t* data, size_t size);
+
+/// \brief the raw crc32c of a message followed by n zero bytes, from the raw
+/// crc32c of the message
+uint32_t crc32c_shift(uint32_t raw, size_t n);
+
+/// \brief the crc32c of a message once some of its bytes changed, from the
+/// crc32c of the original message. delta holds the old bytes xor the new ones
+/// from the first changed byte to the last, tail is the number of bytes of
+/// the message after the last changed one
+inline uint32_t crc32c_patch(
+  uint32_t crc, const uint8_t* delta, size_t size, size_t tail) {
+    return crc ^ crc32c_shift(crc32c_raw(delta, size), tail);
+}
@@ -0,0 +1,65 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#define BOOST_TEST_MODULE crc32c_batch
+#include "hashing/crc32c.h"
+#include "hashing/crc32c_batch.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+#include <vector>
+
+using fragments = std::vector<std::vector<uint8_t>>;
+
+static uint32_t expected_crc(const fragments& fs) {
+    crc32 crc;
+    for (const auto& f : fs) {
+        crc.extend(f.data(), f.size());
+    }
+    return crc.value();
+}
+
+BOOST_AUTO_TEST_CASE(crc32c_batch_known_value) {
+    const char* check = "123456789";
+    crc32c_batch crcs;
+    crcs.add_stream();
+    crcs.extend(check, 9);
+    crcs.compute();
+    BOOST_REQUIRE_EQUAL(crcs.value(0), 0xe3069283);
+}
+
+BOOST_AUTO_TEST_CASE(crc32c_batch_matches_single_streams) {
+    std::mt19937 rng(42);
+    for (int iteration = 0; iteration < 500; ++iteration) {
+        // streams of fragments of all sizes, empty ones included
+        std::vector<fragments> streams(rng() % 10 + 1);
+        for (auto& s : streams) {
+            s.resize(rng() % 6);
+            for (auto& f : s) {
+                f.resize(rng() % 200);
+                for (auto& byte : f) {
+                    byte = rng();
+                }
+            }
+        }
+        crc32c_batch crcs;
+        for (const auto& s : streams) {
+            crcs.add_stream();
+            for (const auto& f : s) {
+                crcs.extend(f.data(), f.size());
+            }
+        }
+        crcs.compute();
+        BOOST_REQUIRE_EQUAL(crcs.size(), streams.size());
+        for (size_t i = 0; i < streams.size(); ++i) {
+            BOOST_REQUIRE_EQUAL(crcs.value(i), expected_crc(streams[i]));
+        }
+    }
+}
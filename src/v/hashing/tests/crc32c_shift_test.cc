@@ -0,0 +1,58 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#define BOOST_TEST_MODULE crc32c_shift
+#include "hashing/crc32c.h"
+#include "hashing/crc32c_shift.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+#include <vector>
+
+static uint32_t full_crc(const std::vector<uint8_t>& data) {
+    crc32 crc;
+    crc.extend(data.data(), data.size());
+    return crc.value();
+}
+
+BOOST_AUTO_TEST_CASE(crc32c_shift_appends_zeros) {
+    std::mt19937 rng(7);
+    for (size_t zeros : {0, 1, 3, 8, 100, 4096, 100000}) {
+        std::vector<uint8_t> data(33);
+        for (auto& b : data) {
+            b = rng();
+        }
+        auto raw = crc32c_raw(data.data(), data.size());
+        data.resize(data.size() + zeros, 0);
+        BOOST_REQUIRE_EQUAL(
+          crc32c_shift(raw, zeros), crc32c_raw(data.data(), data.size()));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(crc32c_patch_matches_full_crc) {
+    std::mt19937 rng(42);
+    for (int iteration = 0; iteration < 500; ++iteration) {
+        std::vector<uint8_t> data(1 + rng() % 5000);
+        for (auto& b : data) {
+            b = rng();
+        }
+        const auto crc = full_crc(data);
+        const size_t first = rng() % data.size();
+        const size_t size = 1 + rng() % (data.size() - first);
+        std::vector<uint8_t> delta(size);
+        for (size_t i = 0; i < size; ++i) {
+            delta[i] = rng();
+            data[first + i] ^= delta[i];
+        }
+        const size_t tail = data.size() - first - size;
+        BOOST_REQUIRE_EQUAL(
+          crc32c_patch(crc, delta.data(), size, tail), full_crc(data));
+    }
+}
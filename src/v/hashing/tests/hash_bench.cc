@@ -8,6 +8,7 @@
 // by the Apache License, Version 2.0
 
 #include "hashing/crc32c.h"
+#include "hashing/crc32c_batch.h"
 #include "hashing/fnv.h"
 #include "hashing/twang.h"
 #include "hashing/xx.h"
@@ -18,6 +19,8 @@
 
 #include <boost/crc.hpp>
 
+#include <vector>
+
 static constexpr size_t step_bytes = 57;
 
 PERF_TEST(boost_crc16_fn, header_hash) {
@@ -72,3 +75,40 @@ PERF_TEST(xx64_twang_fn, header_hash) {
     perf_tests::do_not_optimize(o);
     perf_tests::stop_measuring_time();
 }
+
+// the crc of a produce request of many partitions, each a small batch
+static constexpr size_t batches_per_request = 64;
+static constexpr size_t batch_bytes = 512;
+
+static std::vector<ss::sstring> make_batches() {
+    std::vector<ss::sstring> batches;
+    batches.reserve(batches_per_request);
+    for (size_t i = 0; i < batches_per_request; ++i) {
+        batches.push_back(random_generators::gen_alphanum_string(batch_bytes));
+    }
+    return batches;
+}
+
+PERF_TEST(crc32_fn, many_batches) {
+    auto batches = make_batches();
+    perf_tests::start_measuring_time();
+    for (const auto& b : batches) {
+        crc32 crc;
+        crc.extend(b.data(), b.size());
+        perf_tests::do_not_optimize(crc.value());
+    }
+    perf_tests::stop_measuring_time();
+}
+
+PERF_TEST(crc32c_batch_fn, many_batches) {
+    auto batches = make_batches();
+    perf_tests::start_measuring_time();
+    crc32c_batch crcs;
+    for (const auto& b : batches) {
+        crcs.add_stream();
+        crcs.extend(b.data(), b.size());
+    }
+    crcs.compute();
+    perf_tests::do_not_optimize(crcs.value(0));
+    perf_tests::stop_measuring_time();
+}
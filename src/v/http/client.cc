@@ -58,7 +58,8 @@ client::make_request(client::request_header&& header) {
           std::make_tuple(req, res));
     }
     return connect()
-      .then([req, res] {
+      .then([this, req, res] {
+          _keep_alive = true;
           return ss::make_ready_future<request_response_t>(
             std::make_tuple(req, res));
       })
@@ -189,6 +190,10 @@ ss::future<iobuf> client::response_stream::recv_some() {
               _buffer.clear();
               return fail_on_error(ec);
           }
+          if (_parser.is_header_done() && !_parser.keep_alive()) {
+              // The server closes the connection after this response
+              _client->_keep_alive = false;
+          }
           auto out = _parser.get().body().consume();
           _buffer.trim_front(noctets);
           if (!_buffer.empty()) {
@@ -69,6 +69,14 @@ public:
 
     ss::future<> shutdown();
 
+    /// Close the connection without waiting for the request in flight,
+    /// which fails. shutdown() has to be called afterwards.
+    void abort_connection() noexcept { rpc::base_transport::shutdown(); }
+
+    /// True if the connection is open and the server didn't ask to close it,
+    /// the next request can reuse it once the responses are consumed
+    bool is_reusable() const { return is_valid() && _keep_alive; }
+
     // Response state machine
     class response_stream final
       : public ss::enable_shared_from_this<response_stream> {
@@ -194,6 +202,8 @@ private:
     void check() const;
 
     const ss::abort_source* _as;
+    /// Cleared by a response without keep-alive
+    bool _keep_alive{true};
 };
 
 template<class BufferSeq>
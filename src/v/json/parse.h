@@ -0,0 +1,112 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "bytes/iobuf.h"
+#include "json/json.h"
+#include "json/stream.h"
+#include "seastarx.h"
+#include "units.h"
+
+#include <seastar/core/future.hh>
+#include <seastar/core/thread.hh>
+
+#include <rapidjson/document.h>
+#include <rapidjson/error/error.h>
+#include <rapidjson/reader.h>
+
+#include <cstddef>
+#include <utility>
+
+/**
+ * Parsing of the json documents received by the services of the shard.
+ *
+ * Documents up to inline_parse_limit are parsed right away. Larger documents
+ * are parsed in a seastar thread which yields while it parses, so that a
+ * large produce body or manifest doesn't stall the reactor. The iterative
+ * parser is used there, its stack is on the heap rather than on the small
+ * stack of the thread.
+ *
+ * The buffer and the handler must outlive the returned future.
+ */
+namespace json {
+
+inline constexpr size_t inline_parse_limit = 64_KiB;
+
+namespace detail {
+
+/// Runs \p f(yield) inline or in a seastar thread, depending on \p size
+template<typename Func>
+ss::future<rapidjson::ParseResult> parse_with_yield(size_t size, Func f) {
+    if (size <= inline_parse_limit) {
+        return ss::make_ready_future<rapidjson::ParseResult>(f(false));
+    }
+    return ss::async(std::move(f), true);
+}
+
+} // namespace detail
+
+/// Parse the fragments of \p buf with the SAX \p handler
+template<
+  unsigned parse_flags = rapidjson::kParseDefaultFlags,
+  typename Handler>
+ss::future<rapidjson::ParseResult> parse(const iobuf& buf, Handler& handler) {
+    return detail::parse_with_yield(
+      buf.size_bytes(), [&buf, &handler](bool yield) {
+          iobuf_stream is(buf, yield);
+          rapidjson::Reader reader;
+          if (yield) {
+              return reader.Parse<parse_flags | rapidjson::kParseIterativeFlag>(
+                is, handler);
+          }
+          return reader.Parse<parse_flags>(is, handler);
+      });
+}
+
+/// Parse the fragments of \p buf into \p doc
+template<unsigned parse_flags = rapidjson::kParseDefaultFlags>
+ss::future<rapidjson::ParseResult>
+parse(const iobuf& buf, rapidjson::Document& doc) {
+    return detail::parse_with_yield(
+      buf.size_bytes(), [&buf, &doc](bool yield) {
+          iobuf_stream is(buf, yield);
+          if (yield) {
+              doc.ParseStream<parse_flags | rapidjson::kParseIterativeFlag>(
+                is);
+          } else {
+              doc.ParseStream<parse_flags>(is);
+          }
+          return rapidjson::ParseResult(
+            doc.GetParseError(), doc.GetErrorOffset());
+      });
+}
+
+/// Parse the null terminated \p s of \p size bytes in place with the SAX
+/// \p handler, strings are handed to it as views of \p s
+template<
+  unsigned parse_flags = rapidjson::kParseDefaultFlags,
+  typename Handler>
+ss::future<rapidjson::ParseResult>
+parse_insitu(char* s, size_t size, Handler& handler) {
+    return detail::parse_with_yield(size, [s, &handler](bool yield) {
+        insitu_stream is(s, yield);
+        rapidjson::Reader reader;
+        constexpr auto flags = parse_flags | rapidjson::kParseInsituFlag;
+        if (yield) {
+            return reader.Parse<flags | rapidjson::kParseIterativeFlag>(
+              is, handler);
+        }
+        return reader.Parse<flags>(is, handler);
+    });
+}
+
+} // namespace json
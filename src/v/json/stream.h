@@ -0,0 +1,118 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "bytes/iobuf.h"
+#include "json/json.h"
+#include "seastarx.h"
+#include "units.h"
+
+#include <seastar/core/thread.hh>
+
+#include <rapidjson/stream.h>
+
+#include <cstddef>
+
+namespace json {
+
+/// Read only rapidjson stream over the fragments of an iobuf, the document
+/// is parsed without being linearized first.
+///
+/// With \p yield the stream must be read in a seastar thread, it yields
+/// between the fragments when the reactor has other work to run.
+class iobuf_stream {
+public:
+    using Ch = char;
+
+    explicit iobuf_stream(const iobuf& buf, bool yield = false)
+      : _it(buf.begin())
+      , _end(buf.end())
+      , _yield(yield) {
+        load_fragment();
+    }
+
+    Ch Peek() const { return _pos == _stop ? '\0' : *_pos; }
+    Ch Take() {
+        if (_pos == _stop) {
+            return '\0';
+        }
+        auto c = *_pos++;
+        if (_pos == _stop) {
+            _consumed += _it->size();
+            ++_it;
+            load_fragment();
+        }
+        return c;
+    }
+    size_t Tell() const { return _consumed + (_pos - _start); }
+
+    Ch* PutBegin() {
+        RAPIDJSON_ASSERT(false);
+        return nullptr;
+    }
+    void Put(Ch) { RAPIDJSON_ASSERT(false); }
+    void Flush() { RAPIDJSON_ASSERT(false); }
+    size_t PutEnd(Ch*) {
+        RAPIDJSON_ASSERT(false);
+        return 0;
+    }
+
+private:
+    void load_fragment() {
+        while (_it != _end && _it->size() == 0) {
+            ++_it;
+        }
+        if (_it == _end) {
+            _start = _pos = _stop = nullptr;
+            return;
+        }
+        if (_yield) {
+            ss::thread::maybe_yield();
+        }
+        _start = _pos = _it->get();
+        _stop = _start + _it->size();
+    }
+
+    iobuf::const_iterator _it;
+    iobuf::const_iterator _end;
+    bool _yield;
+    const char* _start{nullptr};
+    const char* _pos{nullptr};
+    const char* _stop{nullptr};
+    size_t _consumed{0};
+};
+
+/// rapidjson::InsituStringStream which, with \p yield, yields every
+/// yield_interval bytes read when the reactor has other work to run. It must
+/// then be read in a seastar thread.
+class insitu_stream : public rapidjson::InsituStringStream {
+public:
+    static constexpr size_t yield_interval = 64_KiB;
+
+    explicit insitu_stream(Ch* src, bool yield = false)
+      : rapidjson::InsituStringStream(src)
+      , _yield(yield) {}
+
+    Ch Take() {
+        if (_yield && --_budget == 0) {
+            _budget = yield_interval;
+            ss::thread::maybe_yield();
+        }
+        return rapidjson::InsituStringStream::Take();
+    }
+
+private:
+    bool _yield;
+    size_t _budget{yield_interval};
+};
+
+} // namespace json
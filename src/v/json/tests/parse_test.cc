@@ -0,0 +1,115 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "bytes/iobuf.h"
+#include "json/parse.h"
+#include "seastarx.h"
+#include "units.h"
+
+#include <seastar/core/sstring.hh>
+#include <seastar/testing/thread_test_case.hh>
+
+#include <rapidjson/document.h>
+#include <rapidjson/reader.h>
+
+#include <string_view>
+
+namespace {
+
+struct counting_handler
+  : rapidjson::BaseReaderHandler<rapidjson::UTF8<>, counting_handler> {
+    bool Default() { return true; }
+    bool Int(int v) {
+        ++ints;
+        sum += v;
+        return true;
+    }
+    bool Uint(unsigned v) {
+        ++ints;
+        sum += v;
+        return true;
+    }
+
+    size_t ints{0};
+    int64_t sum{0};
+};
+
+/// A json array of the integers below n
+ss::sstring make_array(int n) {
+    ss::sstring s = "[";
+    for (int i = 0; i < n; ++i) {
+        if (i > 0) {
+            s += ",";
+        }
+        s += ss::to_sstring(i);
+    }
+    s += "]";
+    return s;
+}
+
+/// \p s split in fragments of \p chunk bytes
+iobuf make_fragmented(std::string_view s, size_t chunk) {
+    iobuf buf;
+    for (size_t i = 0; i < s.size(); i += chunk) {
+        auto part = s.substr(i, chunk);
+        iobuf frag;
+        frag.append(part.data(), part.size());
+        // appended as is, small appends would be coalesced
+        buf.append_fragments(std::move(frag));
+    }
+    return buf;
+}
+
+} // namespace
+
+SEASTAR_THREAD_TEST_CASE(parse_fragmented_iobuf) {
+    // small enough to be parsed inline, the numbers span the fragments
+    auto doc = make_array(100);
+    auto buf = make_fragmented(doc, 7);
+    BOOST_REQUIRE_GT(std::distance(buf.begin(), buf.end()), 1);
+
+    counting_handler h;
+    auto res = json::parse(buf, h).get0();
+    BOOST_REQUIRE(!res.IsError());
+    BOOST_REQUIRE_EQUAL(h.ints, 100);
+    BOOST_REQUIRE_EQUAL(h.sum, 4950);
+}
+
+SEASTAR_THREAD_TEST_CASE(parse_large_document) {
+    auto doc = make_array(100'000);
+    BOOST_REQUIRE_GT(doc.size(), json::inline_parse_limit);
+    auto buf = make_fragmented(doc, 16_KiB);
+
+    counting_handler h;
+    auto res = json::parse(buf, h).get0();
+    BOOST_REQUIRE(!res.IsError());
+    BOOST_REQUIRE_EQUAL(h.ints, 100'000);
+    BOOST_REQUIRE_EQUAL(h.sum, int64_t(99'999) * 100'000 / 2);
+
+    rapidjson::Document d;
+    res = json::parse(buf, d).get0();
+    BOOST_REQUIRE(!res.IsError());
+    BOOST_REQUIRE(d.IsArray());
+    BOOST_REQUIRE_EQUAL(d.Size(), 100'000);
+
+    h = counting_handler{};
+    res = json::parse_insitu(doc.data(), doc.size(), h).get0();
+    BOOST_REQUIRE(!res.IsError());
+    BOOST_REQUIRE_EQUAL(h.ints, 100'000);
+}
+
+SEASTAR_THREAD_TEST_CASE(parse_error_offset) {
+    const std::string_view doc = R"({"a": [1, 2,, 3]})";
+    auto buf = make_fragmented(doc, 4);
+
+    counting_handler h;
+    auto res = json::parse(buf, h).get0();
+    BOOST_REQUIRE(res.IsError());
+    BOOST_REQUIRE_EQUAL(res.Offset(), doc.find(",,") + 1);
+}
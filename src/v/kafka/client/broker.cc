@@ -14,8 +14,8 @@
 
 namespace kafka::client {
 
-ss::future<shared_broker_t>
-make_broker(model::node_id node_id, unresolved_address addr) {
+ss::future<shared_broker_t> make_broker(
+  model::node_id node_id, unresolved_address addr, size_t max_in_flight) {
     return rpc::resolve_dns(std::move(addr))
       .then([](ss::socket_address addr) {
           auto client = ss::make_lw_shared<transport>(
@@ -23,14 +23,16 @@ make_broker(model::node_id node_id, unresolved_address addr) {
           return client->connect().then(
             [client]() mutable { return std::move(client); });
       })
-      .then([node_id, addr](ss::lw_shared_ptr<transport> client) {
+      .then([node_id, addr, max_in_flight](
+              ss::lw_shared_ptr<transport> client) {
           vlog(
             kclog.info,
             "connected to broker:{} - {}:{}",
             node_id,
             addr.host(),
             addr.port());
-          return ss::make_lw_shared<broker>(node_id, std::move(*client));
+          return ss::make_lw_shared<broker>(
+            node_id, std::move(*client), max_in_flight);
       })
       .handle_exception_type([node_id](const std::system_error& ex) {
           if (
@@ -44,4 +46,11 @@ make_broker(model::node_id node_id, unresolved_address addr) {
       });
 }
 
+shared_broker_t make_local_broker(
+  model::node_id node_id, kafka::protocol& proto, ss::sstring listener) {
+    vlog(kclog.info, "connected to local broker:{} - {}", node_id, listener);
+    return ss::make_lw_shared<broker>(
+      node_id, local_transport(proto, std::move(listener)));
+}
+
 } // namespace kafka::client
@@ -12,54 +12,56 @@
 #pragma once
 
 #include "kafka/client/exceptions.h"
+#include "kafka/client/local_transport.h"
 #include "kafka/client/transport.h"
 #include "model/metadata.h"
-#include "utils/mutex.h"
 
 #include <seastar/core/gate.hh>
+#include <seastar/core/semaphore.hh>
 #include <seastar/core/shared_ptr.hh>
 
 #include <absl/container/flat_hash_set.h>
 
-namespace kafka::client {
-
-struct gated_mutex {
-    gated_mutex()
-      : _mutex{}
-      , _gate{} {}
-
-    template<typename Func>
-    auto with(Func&& func) noexcept {
-        return ss::try_with_gate(
-          _gate, [this, func{std::forward<Func>(func)}]() mutable {
-              return _mutex.with(
-                [this, func{std::forward<Func>(func)}]() mutable {
-                    _gate.check();
-                    return func();
-                });
-          });
-    }
+#include <algorithm>
+#include <variant>
 
-    ss::future<> close() { return _gate.close(); }
-
-    mutex _mutex;
-    ss::gate _gate;
-};
+namespace kafka::client {
 
 class broker : public ss::enable_lw_shared_from_this<broker> {
 public:
-    broker(model::node_id node_id, transport&& client)
+    /// Concurrent requests are pipelined on the connection, at most
+    /// max_in_flight of them are outstanding at a time
+    static constexpr size_t default_max_in_flight = 5;
+
+    broker(
+      model::node_id node_id,
+      transport&& client,
+      size_t max_in_flight = default_max_in_flight)
       : _node_id(node_id)
       , _client(std::move(client))
-      , _gated_mutex{} {}
+      , _in_flight(std::max<size_t>(max_in_flight, 1)) {}
+
+    broker(model::node_id node_id, local_transport&& client)
+      : _node_id(node_id)
+      , _client(std::move(client))
+      , _in_flight(default_max_in_flight) {}
 
     template<typename T, typename Ret = typename T::api_type::response_type>
     CONCEPT(requires(KafkaApi<typename T::api_type>))
     ss::future<Ret> dispatch(T r) {
-        return _gated_mutex
-          .with([this, r{std::move(r)}]() mutable {
-              return _client.dispatch(std::move(r));
-          })
+        return ss::try_with_gate(
+                 _gate,
+                 [this, r{std::move(r)}]() mutable {
+                     return ss::with_semaphore(
+                       _in_flight, 1, [this, r{std::move(r)}]() mutable {
+                           _gate.check();
+                           return std::visit(
+                             [&r](auto& client) {
+                                 return client.dispatch(std::move(r));
+                             },
+                             _client);
+                       });
+                 })
           .handle_exception_type([this](const std::bad_optional_access&) {
               // Short read
               return ss::make_exception_future<Ret>(
@@ -70,22 +72,31 @@ public:
 
     model::node_id id() const { return _node_id; }
     ss::future<> stop() {
-        return _gated_mutex.close()
-          .then([this]() { return _client.stop(); })
+        return _gate.close()
+          .then([this]() {
+              return std::visit(
+                [](auto& client) { return client.stop(); }, _client);
+          })
           .finally([b = shared_from_this()]() {});
     }
 
 private:
     model::node_id _node_id;
-    transport _client;
-    // TODO(Ben): allow overlapped requests
-    gated_mutex _gated_mutex;
+    std::variant<transport, local_transport> _client;
+    ss::semaphore _in_flight;
+    ss::gate _gate;
 };
 
 using shared_broker_t = ss::lw_shared_ptr<broker>;
 
-ss::future<shared_broker_t>
-make_broker(model::node_id node_id, unresolved_address addr);
+ss::future<shared_broker_t> make_broker(
+  model::node_id node_id,
+  unresolved_address addr,
+  size_t max_in_flight = broker::default_max_in_flight);
+
+/// \brief Broker of this process, requests don't go through a connection.
+shared_broker_t make_local_broker(
+  model::node_id node_id, kafka::protocol& proto, ss::sstring listener);
 
 struct broker_hash {
     using is_transparent = void;
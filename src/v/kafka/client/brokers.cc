@@ -12,6 +12,8 @@
 #include "kafka/protocol/metadata.h"
 #include "ssx/future-util.h"
 
+#include <algorithm>
+
 namespace kafka::client {
 
 ss::future<> brokers::stop() {
@@ -70,9 +72,8 @@ ss::future<> brokers::apply(metadata_response&& res) {
         return ssx::parallel_transform(
                  new_brokers_begin,
                  res.brokers.end(),
-                 [](const metadata_response::broker& b) {
-                     return make_broker(
-                       b.node_id, unresolved_address(b.host, b.port));
+                 [this](const metadata_response::broker& b) {
+                     return make(b.node_id, unresolved_address(b.host, b.port));
                  })
           .then([this, &res, new_brokers_begin, topics{std::move(res.topics)}](
                   std::vector<shared_broker_t> broker_endpoints) mutable {
@@ -94,7 +95,11 @@ ss::future<> brokers::apply(metadata_response&& res) {
               }
 
               leaders_t leaders;
+              partition_counts_t partition_counts;
               for (const auto& t : topics) {
+                  if (!t.partitions.empty()) {
+                      partition_counts.emplace(t.name, t.partitions.size());
+                  }
                   for (auto const& p : t.partitions) {
                       leaders.emplace(
                         model::topic_partition(t.name, p.index), p.leader);
@@ -103,12 +108,39 @@ ss::future<> brokers::apply(metadata_response&& res) {
 
               std::swap(brokers, _brokers);
               std::swap(leaders, _leaders);
+              std::swap(partition_counts, _partition_counts);
           });
     });
 }
 
+ss::future<int32_t> brokers::partition_count(const model::topic& t) const {
+    if (auto it = _partition_counts.find(t); it != _partition_counts.end()) {
+        return ss::make_ready_future<int32_t>(it->second);
+    }
+    return ss::make_exception_future<int32_t>(partition_error(
+      model::topic_partition(t, model::partition_id(0)),
+      error_code::unknown_topic_or_partition));
+}
+
 ss::future<bool> brokers::empty() const {
     return ss::make_ready_future<bool>(_brokers.empty());
 }
 
+ss::future<shared_broker_t>
+brokers::make(model::node_id id, unresolved_address addr) const {
+    if (_local && _local->node_id == id) {
+        auto it = std::find_if(
+          _local->listeners.begin(),
+          _local->listeners.end(),
+          [&addr](const model::broker_endpoint& ep) {
+              return ep.address == addr;
+          });
+        if (it != _local->listeners.end()) {
+            return ss::make_ready_future<shared_broker_t>(
+              make_local_broker(id, _local->protocol, it->name));
+        }
+    }
+    return make_broker(id, std::move(addr), _max_in_flight);
+}
+
 } // namespace kafka::client
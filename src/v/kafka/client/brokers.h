@@ -13,6 +13,7 @@
 
 #include "kafka/client/broker.h"
 #include "model/fundamental.h"
+#include "model/metadata.h"
 #include "seastarx.h"
 
 #include <seastar/core/future.hh>
@@ -20,19 +21,34 @@
 #include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
 
+#include <functional>
+#include <optional>
+#include <vector>
+
 namespace kafka::client {
 
 /// \brief during connection, the node_id isn't known.
 const model::node_id unknown_node_id{-1};
 
+/// \brief The broker of this process, reached without a connection.
+struct local_broker {
+    model::node_id node_id;
+    /// \brief Advertised kafka listeners of the broker.
+    std::vector<model::broker_endpoint> listeners;
+    std::reference_wrapper<kafka::protocol> protocol;
+};
+
 class brokers {
     using brokers_t
       = absl::flat_hash_set<shared_broker_t, broker_hash, broker_eq>;
     using leaders_t
       = absl::flat_hash_map<model::topic_partition, model::node_id>;
+    using partition_counts_t = absl::flat_hash_map<model::topic, int32_t>;
 
 public:
-    brokers() = default;
+    explicit brokers(
+      size_t max_in_flight = broker::default_max_in_flight) noexcept
+      : _max_in_flight(max_in_flight) {}
     brokers(const brokers&) = delete;
     brokers(brokers&&) = default;
     brokers& operator=(brokers const&) = delete;
@@ -53,6 +69,9 @@ public:
     /// \brief Retrieve the broker for the given topic_partition.
     ss::future<shared_broker_t> find(model::topic_partition tp);
 
+    /// \brief Retrieve the number of partitions of the given topic.
+    ss::future<int32_t> partition_count(const model::topic& t) const;
+
     /// \brief Remove a broker.
     ss::future<> erase(model::node_id id);
 
@@ -62,6 +81,18 @@ public:
     /// \brief Returns true if there are no connected brokers
     ss::future<bool> empty() const;
 
+    /// \brief Reach the broker of this process without a connection.
+    ///
+    /// Applies to the brokers created from then on.
+    void set_local(local_broker local) { _local.emplace(std::move(local)); }
+
+    /// \brief Create a broker for the given node_id and address.
+    ///
+    /// The broker of this process is matched by its node_id and advertised
+    /// address, brokers of other clusters may share the node_id.
+    ss::future<shared_broker_t>
+    make(model::node_id id, unresolved_address addr) const;
+
 private:
     /// \brief Brokers map a model::node_id to a client.
     brokers_t _brokers;
@@ -69,6 +100,12 @@ private:
     size_t _next_broker{0};
     /// \brief Leaders map a partition to a model::node_id.
     leaders_t _leaders;
+    /// \brief Partition counts map a topic to its number of partitions.
+    partition_counts_t _partition_counts;
+    /// \brief The broker of this process, if it runs one.
+    std::optional<local_broker> _local;
+    /// \brief Requests pipelined on the connection to a broker.
+    size_t _max_in_flight;
 };
 
 } // namespace kafka::client
@@ -39,17 +39,19 @@ namespace kafka::client {
 client::client(const YAML::Node& cfg)
   : _config{cfg}
   , _seeds{_config.brokers()}
-  , _brokers{}
+  , _brokers{_config.max_in_flight_per_broker()}
   , _wait_or_start_update_metadata{[this](wait_or_start::tag tag) {
       return update_metadata(tag);
   }}
   , _producer{_config, _brokers, [this](std::exception_ptr ex) {
                   return mitigate_error(std::move(ex));
-              }} {}
+              }}
+  , _partitioner{static_cast<size_t>(_config.produce_batch_size_bytes())} {}
 
 ss::future<> client::do_connect(unresolved_address addr) {
     return ss::try_with_gate(_gate, [this, addr]() {
-        return make_broker(unknown_node_id, addr)
+        return make_broker(
+                 unknown_node_id, addr, _config.max_in_flight_per_broker())
           .then([this](shared_broker_t broker) {
               return broker->dispatch(metadata_request{.list_all_topics = true})
                 .then([this, broker](metadata_response res) {
@@ -168,14 +170,21 @@ ss::future<produce_response::partition> client::produce_record_batch(
       });
 }
 
+ss::future<int32_t> client::partition_count(model::topic t) {
+    return gated_retry_with_mitigation(
+      [this, t{std::move(t)}]() { return _brokers.partition_count(t); });
+}
+
 ss::future<fetch_response> client::fetch_partition(
   model::topic_partition tp,
   model::offset offset,
   int32_t max_bytes,
-  std::chrono::milliseconds timeout) {
+  std::chrono::milliseconds timeout,
+  int32_t min_bytes) {
     auto build_request =
-      [offset, max_bytes, timeout](model::topic_partition& tp) {
-          return make_fetch_request(tp, offset, max_bytes, timeout);
+      [offset, max_bytes, timeout, min_bytes](model::topic_partition& tp) {
+          return make_fetch_request(
+            tp, offset, max_bytes, timeout, min_bytes);
       };
 
     return ss::do_with(
@@ -200,8 +209,8 @@ ss::future<member_id> client::create_consumer(const group_id& group_id) {
         return find_coordinator_request(group_id);
     };
     return dispatch(build_request)
-      .then([](find_coordinator_response res) {
-          return make_broker(
+      .then([this](find_coordinator_response res) {
+          return _brokers.make(
             res.data.node_id, unresolved_address(res.data.host, res.data.port));
       })
       .then([this, group_id](shared_broker_t coordinator) mutable {
@@ -17,6 +17,7 @@
 #include "kafka/client/configuration.h"
 #include "kafka/client/consumer.h"
 #include "kafka/client/fetcher.h"
+#include "kafka/client/partitioners.h"
 #include "kafka/client/producer.h"
 #include "kafka/client/retry_with_mitigation.h"
 #include "kafka/client/transport.h"
@@ -102,11 +103,25 @@ public:
     ss::future<produce_response::partition> produce_record_batch(
       model::topic_partition tp, model::record_batch&& batch);
 
+    /// \brief Number of partitions of the topic.
+    ss::future<int32_t> partition_count(model::topic t);
+
+    /// \brief Partitions records produced without a partition.
+    ///
+    /// Keyed records are hashed as the java client does, the others fill the
+    /// batch of a partition before moving to another one.
+    default_partitioner& partitioner() { return _partitioner; }
+
+    /// \brief Fetch from a partition.
+    ///
+    /// With min_bytes, the broker holds the fetch until that much data was
+    /// appended to the partition or the timeout expires.
     ss::future<fetch_response> fetch_partition(
       model::topic_partition tp,
       model::offset offset,
       int32_t max_bytes,
-      std::chrono::milliseconds timeout);
+      std::chrono::milliseconds timeout,
+      int32_t min_bytes = 0);
 
     ss::future<member_id> create_consumer(const group_id& g_id);
 
@@ -147,6 +162,11 @@ public:
 
     configuration& config() { return _config; }
 
+    /// \brief Reach the broker of this process without a connection.
+    void set_local_broker(local_broker local) {
+        _brokers.set_local(std::move(local));
+    }
+
 private:
     /// \brief Connect and update metdata.
     ss::future<> do_connect(unresolved_address addr);
@@ -176,6 +196,8 @@ private:
     wait_or_start _wait_or_start_update_metadata;
     /// \brief Batching producer.
     producer _producer;
+    /// \brief Partitioner of records produced without a partition.
+    default_partitioner _partitioner;
     /// \brief Consumers
     absl::node_hash_map<
       kafka::group_id,
@@ -49,6 +49,12 @@ configuration::configuration()
       "Delay (in milliseconds) for initial retry backoff",
       config::required::no,
       100ms)
+  , max_in_flight_per_broker(
+      *this,
+      "max_in_flight_per_broker",
+      "Number of requests pipelined on the connection to a broker",
+      config::required::no,
+      5)
   , produce_batch_record_count(
       *this,
       "produce_batch_record_count",
@@ -67,6 +73,13 @@ configuration::configuration()
       "Delay (in milliseconds) to wait before sending batch",
       config::required::no,
       100ms)
+  , produce_batch_merge_threshold_bytes(
+      *this,
+      "produce_batch_merge_threshold_bytes",
+      "Record batches of at least this size are sent as they are, smaller ones "
+      "are merged record by record into larger batches",
+      config::required::no,
+      16384)
   , consumer_session_timeout(
       *this,
       "consumer_session_timeout_ms",
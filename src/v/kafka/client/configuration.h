@@ -30,9 +30,11 @@ struct configuration final : public config::config_store {
     config::property<config::tls_config> broker_tls;
     config::property<size_t> retries;
     config::property<std::chrono::milliseconds> retry_base_backoff;
+    config::property<size_t> max_in_flight_per_broker;
     config::property<int32_t> produce_batch_record_count;
     config::property<int32_t> produce_batch_size_bytes;
     config::property<std::chrono::milliseconds> produce_batch_delay;
+    config::property<int32_t> produce_batch_merge_threshold_bytes;
     config::property<std::chrono::milliseconds> consumer_session_timeout;
     config::property<std::chrono::milliseconds> consumer_rebalance_timeout;
     config::property<std::chrono::milliseconds> consumer_heartbeat_interval;
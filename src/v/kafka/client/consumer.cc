@@ -34,6 +34,7 @@
 #include <seastar/core/loop.hh>
 #include <seastar/core/sleep.hh>
 
+#include <algorithm>
 #include <chrono>
 #include <exception>
 #include <iterator>
@@ -105,6 +106,7 @@ ss::future<> consumer::stop() {
     _as.request_abort();
     return _coordinator->stop()
       .then([this]() { return _gate.close(); })
+      .then([this]() { return drop_fetches(); })
       .finally([me{shared_from_this()}] {});
 }
 
@@ -266,6 +268,7 @@ ss::future<> consumer::sync() {
                     return join();
                 case error_code::none:
                     _assignment = _plan->decode(res.data.assignment);
+                    ++_assignment_version;
                     return ss::now();
                 default:
                     return ss::make_exception_future<>(consumer_error(
@@ -355,7 +358,7 @@ consumer::offset_commit(std::vector<offset_commit_request_topic> topics) {
     co_return co_await req_res(std::move(req_builder));
 }
 
-ss::future<fetch_response>
+ss::future<consumer::broker_res_t>
 consumer::dispatch_fetch(broker_reqs_t::value_type br) {
     auto& [broker, req] = br;
     kclog.trace("Consumer: {}, fetch_req: {}", *this, req);
@@ -366,12 +369,14 @@ consumer::dispatch_fetch(broker_reqs_t::value_type br) {
         throw broker_error(broker->id(), res.error);
     }
 
-    _fetch_sessions[broker].apply(res);
-    co_return res;
+    // the broker tracks the session per request, the offsets are passed once
+    // the records are consumed
+    _fetch_sessions[broker].apply_session(res);
+    co_return broker_res_t{std::move(broker), std::move(res)};
 }
 
-ss::future<fetch_response>
-consumer::fetch(std::chrono::milliseconds timeout, int32_t max_bytes) {
+ss::future<consumer::broker_reqs_t> consumer::make_fetch_requests(
+  std::chrono::milliseconds timeout, int32_t max_bytes) {
     // Split requests by broker
     broker_reqs_t broker_reqs;
     for (auto const& [t, ps] : _assignment) {
@@ -404,18 +409,81 @@ consumer::fetch(std::chrono::milliseconds timeout, int32_t max_bytes) {
               .partition_max_bytes = max_bytes});
         }
     }
+    co_return broker_reqs;
+}
+
+ss::future<> consumer::dispatch_fetches(
+  std::chrono::milliseconds timeout, int32_t max_bytes) {
+    if (_gate.is_closed()) {
+        co_return;
+    }
+    auto broker_reqs = co_await make_fetch_requests(timeout, max_bytes);
+    for (auto& [broker, req] : broker_reqs) {
+        if (_fetches_in_flight.contains(broker) || _fetched.contains(broker)) {
+            continue;
+        }
+        _fetches_in_flight.insert(broker);
+        (void)ss::try_with_gate(
+          _gate,
+          [this,
+           br = broker_reqs_t::value_type(broker, std::move(req))]() mutable {
+              return dispatch_fetch(std::move(br));
+          })
+          .then_wrapped([this, me{shared_from_this()}, broker = broker](
+                          ss::future<broker_res_t> f) {
+              _fetches_in_flight.erase(broker);
+              _fetched.emplace(broker, std::move(f));
+              _fetch_cond.broadcast();
+          });
+    }
+}
+
+ss::future<> consumer::drop_fetches() {
+    co_await _fetch_cond.wait([this] { return _fetches_in_flight.empty(); });
+    for (auto& [broker, f] : std::exchange(_fetched, {})) {
+        f.ignore_ready_future();
+    }
+}
+
+ss::future<fetch_response>
+consumer::fetch(std::chrono::milliseconds timeout, int32_t max_bytes) {
+    auto units = co_await _fetch_lock.get_units();
+    if (_fetch_version != _assignment_version) {
+        // records of partitions that may be assigned elsewhere by now, they
+        // are fetched again from the consumed offsets
+        co_await drop_fetches();
+        _fetch_version = _assignment_version;
+    }
+    co_await dispatch_fetches(timeout, max_bytes);
+    co_await _fetch_cond.wait(
+      [this] { return !_fetched.empty() || _fetches_in_flight.empty(); });
+
+    // a failed broker is reported on its own, the records of the others are
+    // returned by the next calls
+    auto failed = std::find_if(
+      _fetched.begin(), _fetched.end(), [](const auto& f) {
+          return f.second.failed();
+      });
+    if (failed != _fetched.end()) {
+        auto f = std::move(failed->second);
+        _fetched.erase(failed);
+        co_await std::move(f);
+    }
+
+    fetch_response result{
+      .throttle_time{},
+      .error = error_code::none,
+      .session_id = kafka::invalid_fetch_session_id};
+    for (auto& [broker, f] : std::exchange(_fetched, {})) {
+        auto res = f.get0().second;
+        _fetch_sessions[broker].apply_offsets(res);
+        result = detail::reduce_fetch_response(
+          std::move(result), std::move(res));
+    }
 
-    co_return co_await ss::map_reduce(
-      std::make_move_iterator(broker_reqs.begin()),
-      std::make_move_iterator(broker_reqs.end()),
-      [this](broker_reqs_t::value_type br) {
-          return dispatch_fetch(std::move(br));
-      },
-      fetch_response{
-        .throttle_time{},
-        .error = error_code::none,
-        .session_id = kafka::invalid_fetch_session_id},
-      detail::reduce_fetch_response);
+    // the next call overlaps with the round-trip of its records
+    co_await dispatch_fetches(timeout, max_bytes);
+    co_return result;
 }
 
 ss::future<shared_consumer_t> make_consumer(
@@ -21,14 +21,20 @@
 #include "kafka/protocol/offset_commit.h"
 #include "kafka/protocol/offset_fetch.h"
 #include "kafka/types.h"
+#include "utils/mutex.h"
 
+#include <seastar/core/condition-variable.hh>
 #include <seastar/core/shared_ptr.hh>
 
 #include <absl/container/node_hash_map.h>
+#include <absl/container/node_hash_set.h>
 #include <absl/hash/hash.h>
 
 #include <chrono>
 #include <iterator>
+#include <optional>
+#include <utility>
+#include <vector>
 
 namespace kafka::client {
 
@@ -36,6 +42,7 @@ namespace kafka::client {
 class consumer final : public ss::enable_lw_shared_from_this<consumer> {
     using assignment_t = client::assignment;
     using broker_reqs_t = absl::node_hash_map<shared_broker_t, fetch_request>;
+    using broker_res_t = std::pair<shared_broker_t, fetch_response>;
 
 public:
     consumer(
@@ -61,6 +68,13 @@ public:
     offset_fetch(std::vector<offset_fetch_request_topic> topics);
     ss::future<offset_commit_response>
     offset_commit(std::vector<offset_commit_request_topic> topics);
+    /// \brief Fetch the records following the previous call.
+    ///
+    /// Every broker of the assignment has one fetch in flight, each in its own
+    /// fetch session. A call returns the records of the brokers whose fetch
+    /// completed since the previous call and waits only if none did. The
+    /// fetch of a broker is sent again, with the same bounds, once its records
+    /// are returned, at most one response per broker is held back.
     ss::future<fetch_response>
     fetch(std::chrono::milliseconds timeout, int32_t max_bytes);
 
@@ -83,7 +97,13 @@ private:
 
     ss::future<describe_groups_response> describe_group();
 
-    ss::future<fetch_response> dispatch_fetch(broker_reqs_t::value_type br);
+    ss::future<broker_reqs_t>
+    make_fetch_requests(std::chrono::milliseconds timeout, int32_t max_bytes);
+    /// \brief Sends a fetch to the brokers with none in flight nor returned
+    ss::future<>
+    dispatch_fetches(std::chrono::milliseconds timeout, int32_t max_bytes);
+    ss::future<broker_res_t> dispatch_fetch(broker_reqs_t::value_type br);
+    ss::future<> drop_fetches();
 
     template<typename RequestFactory>
     ss::future<
@@ -120,6 +140,16 @@ private:
     std::unique_ptr<assignment_plan> _plan{};
     assignment_t _assignment{};
     absl::node_hash_map<shared_broker_t, fetch_session> _fetch_sessions;
+    /// \brief Serializes fetches, the sessions track one request at a time.
+    mutex _fetch_lock;
+    absl::node_hash_set<shared_broker_t> _fetches_in_flight;
+    /// \brief Records fetched for the next call to fetch, not consumed yet.
+    absl::node_hash_map<shared_broker_t, ss::future<broker_res_t>> _fetched;
+    /// \brief Signaled when a fetch completes.
+    ss::condition_variable _fetch_cond;
+    /// \brief Fetches are stale when the assignment changed since.
+    size_t _assignment_version{0};
+    size_t _fetch_version{0};
 
     friend std::ostream& operator<<(std::ostream& os, const consumer& c) {
         fmt::print(
@@ -31,12 +31,21 @@ model::offset fetch_session::offset(model::topic_partition_view tpv) const {
 }
 
 bool fetch_session::apply(fetch_response& res) {
+    apply_session(res);
+    apply_offsets(res);
+    return true;
+}
+
+void fetch_session::apply_session(const fetch_response& res) {
     if (_id == invalid_fetch_session_id) {
         _id = fetch_session_id{res.session_id};
     }
     vassert(res.session_id == _id, "session mismatch: {}", *this);
 
     ++_epoch;
+}
+
+void fetch_session::apply_offsets(fetch_response& res) {
     for (auto& part : res) {
         if (part.partition_response->has_error()) {
             continue;
@@ -53,7 +62,6 @@ bool fetch_session::apply(fetch_response& res) {
     for (auto& topic : _offsets) {
         topic.second.rehash(topic.second.size());
     }
-    return true;
 }
 
 std::vector<offset_commit_request_topic>
@@ -41,6 +41,10 @@ public:
     kafka::fetch_session_epoch epoch() const { return _epoch; }
     model::offset offset(model::topic_partition_view tpv) const;
     bool apply(fetch_response& res);
+    /// \brief Apply the session id and epoch of a response as it arrives.
+    void apply_session(const fetch_response& res);
+    /// \brief Consume the records of a response, pass their offsets.
+    void apply_offsets(fetch_response& res);
     std::vector<kafka::offset_commit_request_topic>
     make_offset_commit_request() const;
 
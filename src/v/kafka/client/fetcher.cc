@@ -23,7 +23,8 @@ fetch_request make_fetch_request(
   const model::topic_partition& tp,
   model::offset offset,
   int32_t max_bytes,
-  std::chrono::milliseconds timeout) {
+  std::chrono::milliseconds timeout,
+  int32_t min_bytes) {
     std::vector<fetch_request::partition> partitions;
     partitions.push_back(fetch_request::partition{
       .id{tp.partition},
@@ -38,7 +39,7 @@ fetch_request make_fetch_request(
     return fetch_request{
       .replica_id{consumer_replica_id},
       .max_wait_time{timeout},
-      .min_bytes = 0,
+      .min_bytes = min_bytes,
       .max_bytes = max_bytes,
       .isolation_level = 0,
       .topics{std::move(topics)}};
@@ -19,7 +19,8 @@ fetch_request make_fetch_request(
   const model::topic_partition& tp,
   model::offset offset,
   int32_t max_bytes,
-  std::chrono::milliseconds timeout);
+  std::chrono::milliseconds timeout,
+  int32_t min_bytes = 0);
 
 fetch_response
 make_fetch_response(const model::topic_partition& tp, std::exception_ptr ex);
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "kafka/client/transport.h"
+#include "kafka/server/protocol.h"
+#include "kafka/server/request_context.h"
+#include "kafka/types.h"
+#include "seastarx.h"
+
+#include <seastar/core/future.hh>
+
+#include <functional>
+
+namespace kafka::client {
+
+/**
+ * \brief Kafka client of the broker of this process.
+ *
+ * Requests are handed to the kafka protocol of the shard, without the socket
+ * and the framing of the requests and replies.
+ */
+class local_transport {
+public:
+    local_transport(kafka::protocol& proto, ss::sstring listener) noexcept
+      : _proto(proto)
+      , _listener(std::move(listener)) {}
+
+    template<typename T>
+    CONCEPT(requires(KafkaApi<typename T::api_type>))
+    ss::future<typename T::api_type::response_type> dispatch(
+      T r, api_version request_version, api_version response_version) {
+        iobuf buf;
+        response_writer wr(buf);
+        r.encode(wr, request_version);
+        request_header hdr{
+          .key = T::api_type::key,
+          .version = request_version,
+          .correlation = _correlation,
+          .client_id = std::string_view("test_client")};
+        _correlation = _correlation + correlation_id(1);
+        return _proto.get()
+          .dispatch_local(_listener, std::move(hdr), std::move(buf))
+          .then([response_version](response_ptr res) {
+              using response_type = typename T::api_type::response_type;
+              response_type r;
+              r.decode(std::move(*res).release(), response_version);
+              return r;
+          });
+    }
+
+    template<typename T>
+    CONCEPT(requires(KafkaApi<typename T::api_type>))
+    ss::future<typename T::api_type::response_type> dispatch(T r) {
+        auto ver = default_version<T>();
+        return dispatch(std::move(r), ver, ver);
+    }
+
+    ss::future<> stop() { return ss::now(); }
+
+private:
+    std::reference_wrapper<kafka::protocol> _proto;
+    ss::sstring _listener;
+    correlation_id _correlation{0};
+};
+
+} // namespace kafka::client
@@ -0,0 +1,52 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/client/partitioners.h"
+
+#include "bytes/bytes.h"
+#include "hashing/murmur.h"
+#include "random/generators.h"
+#include "vassert.h"
+
+#include <iterator>
+
+namespace kafka::client {
+
+model::partition_id murmur2_partition(const iobuf& key, int32_t partitions) {
+    vassert(partitions > 0, "a topic has at least one partition");
+    uint32_t hash{};
+    if (key.begin() != key.end() && std::next(key.begin()) == key.end()) {
+        hash = murmur2(key.begin()->get(), key.size_bytes());
+    } else {
+        auto linear = iobuf_to_bytes(key);
+        hash = murmur2(linear.data(), linear.size());
+    }
+    // the java client drops the sign bit of the hash
+    return model::partition_id((hash & 0x7fffffff) % partitions);
+}
+
+model::partition_id sticky_partitioner::operator()(
+  const model::topic& topic, int32_t partitions, size_t record_size) {
+    vassert(partitions > 0, "a topic has at least one partition");
+    auto [it, inserted] = _topics.try_emplace(topic);
+    auto& s = it->second;
+    const bool full = s.bytes > 0 && s.bytes + record_size > _batch_size;
+    if (inserted || full || s.id() >= partitions) {
+        auto id = random_generators::get_int<int32_t>(partitions - 1);
+        if (!inserted && id == s.id()) {
+            // moves on to another partition when there is one
+            id = (id + 1) % partitions;
+        }
+        s = sticky{.id = model::partition_id(id)};
+    }
+    s.bytes += record_size;
+    return s.id;
+}
+
+} // namespace kafka::client
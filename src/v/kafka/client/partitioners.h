@@ -0,0 +1,70 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "bytes/iobuf.h"
+#include "model/fundamental.h"
+
+#include <absl/container/flat_hash_map.h>
+
+#include <cstdint>
+#include <optional>
+
+namespace kafka::client {
+
+/// \brief Partition of a keyed record, the same as the default partitioner
+/// of the java client picks.
+model::partition_id murmur2_partition(const iobuf& key, int32_t partitions);
+
+/// \brief Records without a key fill the batch of a partition of the topic
+/// before moving to another partition, so that they form fewer and larger
+/// batches than when they are spread over all the partitions.
+class sticky_partitioner {
+public:
+    explicit sticky_partitioner(size_t batch_size_bytes) noexcept
+      : _batch_size(batch_size_bytes) {}
+
+    model::partition_id
+    operator()(const model::topic&, int32_t partitions, size_t record_size);
+
+private:
+    struct sticky {
+        model::partition_id id;
+        size_t bytes{0};
+    };
+
+    size_t _batch_size;
+    absl::flat_hash_map<model::topic, sticky> _topics;
+};
+
+/// \brief Keyed records are hashed, the others are sticky.
+class default_partitioner {
+public:
+    explicit default_partitioner(size_t batch_size_bytes) noexcept
+      : _sticky(batch_size_bytes) {}
+
+    model::partition_id operator()(
+      const model::topic& topic,
+      const std::optional<iobuf>& key,
+      int32_t partitions,
+      size_t record_size) {
+        if (key) {
+            return murmur2_partition(*key, partitions);
+        }
+        return _sticky(topic, partitions, record_size);
+    }
+
+private:
+    sticky_partitioner _sticky;
+};
+
+} // namespace kafka::client
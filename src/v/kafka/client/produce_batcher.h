@@ -23,6 +23,8 @@
 
 #include <absl/container/flat_hash_map.h>
 
+#include <limits>
+
 namespace kafka::client {
 
 template<typename ContainerT>
@@ -45,11 +47,17 @@ typename ContainerT::value_type consume_front(ContainerT& c) {
 /// |   c_ctx0(2)   | c_ctx1(1) |       c_ctx2(3)      | client ctx(rec_count)
 /// |           b_bat0          |        b_bat1        | broker request batches
 /// |          b_ctx0(3)        |       b_ctx1(3)      | broker ctx(rec_count)
+///
+/// Client batches of at least merge_threshold bytes are sent as they are,
+/// without decoding and re-encoding their records. The records batched before
+/// such a batch go out in a batch of their own ahead of it.
 class produce_batcher {
 public:
     using partition_response = produce_response::partition;
-    explicit produce_batcher()
-      : _builder{make_builder()}
+    explicit produce_batcher(
+      size_t merge_threshold = std::numeric_limits<size_t>::max())
+      : _merge_threshold{merge_threshold}
+      , _builder{make_builder()}
       , _client_reqs{}
       , _broker_reqs{} {}
 
@@ -71,21 +79,50 @@ public:
     };
 
     ss::future<partition_response> produce(model::record_batch&& batch) {
+        _client_reqs.emplace_back(batch.record_count());
+        auto fut = _client_reqs.back().promise.get_future();
+        _record_count += batch.record_count();
+        _size_bytes += batch.size_bytes();
+
+        if (
+          batch.size_bytes() >= _merge_threshold
+          && batch.header().type == raft::data_batch_type) {
+            seal_builder();
+            auto size_bytes = batch.size_bytes();
+            _formed.push_back(formed_batch{
+              .batch = std::move(batch), .size_bytes = size_bytes});
+            return fut;
+        }
+
+        _builder_record_count += batch.record_count();
+        _builder_size_bytes += batch.size_bytes();
         batch.for_each_record([this](model::record rec) {
             _builder.add_raw_kw(
               rec.release_key(), rec.release_value(), std::move(rec.headers()));
         });
-
-        _client_reqs.emplace_back(batch.record_count());
-        return _client_reqs.back().promise.get_future();
+        return fut;
     }
 
     model::record_batch consume() {
-        auto batch = std::exchange(_builder, make_builder()).build();
-        _broker_reqs.emplace_back(batch.record_count());
-        return batch;
+        if (_formed.empty()) {
+            seal_builder();
+        }
+        if (_formed.empty()) {
+            _broker_reqs.emplace_back(0);
+            return make_builder().build();
+        }
+        auto f = consume_front(_formed);
+        _record_count -= f.batch.record_count();
+        _size_bytes -= f.size_bytes;
+        _broker_reqs.emplace_back(f.batch.record_count());
+        return std::move(f.batch);
     }
 
+    /// records produced and not consumed yet
+    int32_t record_count() const { return _record_count; }
+    /// size of the client batches produced and not consumed yet
+    size_t size_bytes() const { return _size_bytes; }
+
     void handle_response(partition_response res) {
         auto running_offset = res.base_offset;
         const auto ctx = consume_front(_broker_reqs);
@@ -111,11 +148,34 @@ public:
     }
 
 private:
+    struct formed_batch {
+        model::record_batch batch;
+        // of the client batches the batch was built from
+        size_t size_bytes;
+    };
+
     storage::record_batch_builder make_builder() {
         return {raft::data_batch_type, model::offset(0)};
     }
 
+    void seal_builder() {
+        if (_builder_record_count == 0) {
+            return;
+        }
+        _formed.push_back(formed_batch{
+          .batch = std::exchange(_builder, make_builder()).build(),
+          .size_bytes = std::exchange(_builder_size_bytes, 0)});
+        _builder_record_count = 0;
+    }
+
+    size_t _merge_threshold;
     storage::record_batch_builder _builder;
+    int32_t _builder_record_count{0};
+    size_t _builder_size_bytes{0};
+    // batches ready to be sent, in the order of their client requests
+    ss::circular_buffer<formed_batch> _formed;
+    int32_t _record_count{0};
+    size_t _size_bytes{0};
     // TODO(Ben): Maybe these should be a queue for backpressure
     ss::circular_buffer<client_context> _client_reqs;
     ss::circular_buffer<broker_context> _broker_reqs;
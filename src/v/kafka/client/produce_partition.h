@@ -25,18 +25,29 @@
 namespace kafka::client {
 
 /// \brief Batch multiple client requests, flush them based on size or time.
+///
+/// Requests to the partition coalesce into one record batch until it reaches
+/// produce_batch_record_count or produce_batch_size_bytes, or its first
+/// request is produce_batch_delay old. The delay isn't extended by the
+/// requests that follow, nor by the wait for the batch in flight. Requests of
+/// at least produce_batch_merge_threshold_bytes are sent as they are.
 class produce_partition {
 public:
     using response = produce_batcher::partition_response;
     using consumer = ss::noncopyable_function<void(model::record_batch&&)>;
+    using clock_type = ss::timer<>::clock;
 
     produce_partition(const configuration& config, consumer&& c)
       : _config{config}
-      , _batcher{}
+      , _batcher{static_cast<size_t>(
+          config.produce_batch_merge_threshold_bytes())}
       , _timer{[this]() { try_consume(true); }}
       , _consumer{std::move(c)} {}
 
     ss::future<response> produce(model::record_batch&& batch) {
+        if (_record_count == 0) {
+            _pending_since = clock_type::now();
+        }
         _record_count += batch.record_count();
         _size_bytes += batch.size_bytes();
         auto fut = _batcher.produce(std::move(batch));
@@ -62,9 +73,11 @@ private:
         vassert(!_in_flight, "do_consume should not run concurrently");
 
         _in_flight = true;
-        _record_count = 0;
-        _size_bytes = 0;
-        return _batcher.consume();
+        auto batch = _batcher.consume();
+        // batches formed before the one in flight wait for its response
+        _record_count = _batcher.record_count();
+        _size_bytes = static_cast<int32_t>(_batcher.size_bytes());
+        return batch;
     }
 
     bool try_consume(bool timed_out) {
@@ -78,12 +91,17 @@ private:
         auto threshold_met = _record_count >= batch_record_count
                              || _size_bytes >= batch_size_bytes;
 
+        auto deadline = _pending_since + _config.produce_batch_delay();
+        timed_out = timed_out || clock_type::now() >= deadline;
+
         if (!timed_out && !threshold_met) {
-            _timer.cancel();
-            _timer.arm(_config.produce_batch_delay());
+            if (!_timer.armed()) {
+                _timer.arm(deadline);
+            }
             return false;
         }
 
+        _timer.cancel();
         _consumer(do_consume());
         return true;
     }
@@ -94,6 +112,7 @@ private:
     consumer _consumer;
     int32_t _record_count{};
     int32_t _size_bytes{};
+    clock_type::time_point _pending_since{};
     bool _in_flight{};
 };
 
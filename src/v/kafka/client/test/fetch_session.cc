@@ -132,6 +132,26 @@ SEASTAR_THREAD_TEST_CASE(test_fetch_session_empty_record_set) {
     BOOST_REQUIRE_EQUAL(s.offset(ctx.tp), ctx.expected_offset);
 }
 
+SEASTAR_THREAD_TEST_CASE(test_fetch_session_unconsumed_records) {
+    context ctx;
+    kc::fetch_session s;
+
+    // Apply some records
+    BOOST_REQUIRE(ctx.apply_fetch_response(s, 8));
+    BOOST_REQUIRE_EQUAL(s.offset(ctx.tp), ctx.expected_offset);
+
+    // Records fetched ahead keep the session going, but aren't consumed
+    auto res = make_fetch_response(
+      ctx.fetch_session_id, ctx.tp, make_record_set(ctx.expected_offset, 8));
+    s.apply_session(res);
+    BOOST_REQUIRE_EQUAL(s.epoch(), ++ctx.expected_epoch);
+    BOOST_REQUIRE_EQUAL(s.offset(ctx.tp), ctx.expected_offset);
+
+    s.apply_offsets(res);
+    BOOST_REQUIRE_EQUAL(s.epoch(), ctx.expected_epoch);
+    BOOST_REQUIRE_EQUAL(s.offset(ctx.tp), ctx.expected_offset + 8);
+}
+
 SEASTAR_THREAD_TEST_CASE(test_fetch_session_make_offset_commit_request_all) {
     context ctx;
     kc::fetch_session s;
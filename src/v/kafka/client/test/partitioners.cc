@@ -0,0 +1,102 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/client/partitioners.h"
+
+#include "bytes/iobuf.h"
+#include "model/fundamental.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace kc = kafka::client;
+
+namespace {
+
+iobuf make_key(std::string_view k) {
+    iobuf key;
+    key.append(k.data(), k.size());
+    return key;
+}
+
+/// the partition the java client picks, from the hashes the java client
+/// computes for these keys
+int32_t java_partition(int32_t hash, int32_t partitions) {
+    return (hash & 0x7fffffff) % partitions;
+}
+
+} // namespace
+
+SEASTAR_THREAD_TEST_CASE(test_murmur2_partition_matches_java_client) {
+    const std::vector<std::pair<std::string_view, int32_t>> cases{
+      {"21", -973932308},
+      {"foobar", -790332482},
+      {"a-little-bit-long-string", -985981536},
+      {"a-little-bit-longer-string", -1486304829},
+      {"lkjh234lh9fiuh90y23oiuhsafujhadof229phr9h19h89h8", -58897971},
+      {"abc", 479470107}};
+    for (const auto& [k, hash] : cases) {
+        for (int32_t partitions : {1, 3, 16, 1000}) {
+            BOOST_REQUIRE_EQUAL(
+              kc::murmur2_partition(make_key(k), partitions)(),
+              java_partition(hash, partitions));
+        }
+    }
+
+    // the key does not have to be contiguous
+    iobuf fragmented;
+    fragmented.append_fragments(make_key("a-little-bit-"));
+    fragmented.append_fragments(make_key("long-string"));
+    BOOST_REQUIRE_EQUAL(
+      std::distance(fragmented.begin(), fragmented.end()), 2);
+    BOOST_REQUIRE_EQUAL(
+      kc::murmur2_partition(fragmented, 16)(),
+      java_partition(-985981536, 16));
+}
+
+SEASTAR_THREAD_TEST_CASE(test_sticky_partitioner_fills_batches) {
+    const model::topic t{"t"};
+    kc::sticky_partitioner partitioner(1000);
+
+    auto first = partitioner(t, 8, 100);
+    for (int i = 0; i < 9; ++i) {
+        BOOST_REQUIRE_EQUAL(partitioner(t, 8, 100), first);
+    }
+    // the batch is full, the records move on to another partition
+    auto second = partitioner(t, 8, 100);
+    BOOST_REQUIRE_NE(second, first);
+    BOOST_REQUIRE_LT(second(), 8);
+    BOOST_REQUIRE_EQUAL(partitioner(t, 8, 100), second);
+
+    // a record larger than a batch has a partition of its own
+    auto large = partitioner(t, 8, 5000);
+    BOOST_REQUIRE_NE(large, second);
+    BOOST_REQUIRE_NE(partitioner(t, 8, 100), large);
+
+    // topics are independent, a single partition topic is always sticky
+    const model::topic single{"single"};
+    for (int i = 0; i < 20; ++i) {
+        BOOST_REQUIRE_EQUAL(partitioner(single, 1, 400)(), 0);
+    }
+}
+
+SEASTAR_THREAD_TEST_CASE(test_default_partitioner) {
+    const model::topic t{"t"};
+    kc::default_partitioner partitioner(1000);
+    std::optional<iobuf> key = make_key("foobar");
+    BOOST_REQUIRE_EQUAL(
+      partitioner(t, key, 16, 10)(), java_partition(-790332482, 16));
+    auto sticky = partitioner(t, std::nullopt, 16, 10);
+    BOOST_REQUIRE_EQUAL(partitioner(t, std::nullopt, 16, 10), sticky);
+}
@@ -0,0 +1,44 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/client/broker.h"
+#include "kafka/client/brokers.h"
+#include "kafka/client/test/fixture.h"
+#include "kafka/protocol/metadata.h"
+
+#include <seastar/core/future-util.hh>
+
+#include <vector>
+
+FIXTURE_TEST(pipelined_requests, kafka_client_fixture) {
+    info("Waiting for leadership");
+    wait_for_controller_leadership().get();
+    add_topic(model::topic_namespace_view(
+                make_default_ntp(model::topic("t"), model::partition_id(0))))
+      .get();
+
+    unresolved_address addr{
+      config::shard_local_cfg().kafka_api()[0].address.host(),
+      config::shard_local_cfg().kafka_api()[0].address.port()};
+    auto broker = kc::make_broker(kc::unknown_node_id, addr, 4).get0();
+
+    info("Dispatching concurrent requests");
+    std::vector<ss::future<kafka::metadata_response>> replies;
+    for (int i = 0; i < 16; ++i) {
+        replies.push_back(
+          broker->dispatch(kafka::metadata_request{.list_all_topics = true}));
+    }
+    auto res = ss::when_all_succeed(replies.begin(), replies.end()).get0();
+    for (auto& r : res) {
+        BOOST_REQUIRE_EQUAL(r.topics.size(), 1);
+        BOOST_REQUIRE_EQUAL(r.topics[0].name(), "t");
+    }
+
+    broker->stop().get();
+}
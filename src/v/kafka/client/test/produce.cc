@@ -82,3 +82,37 @@ FIXTURE_TEST(produce_reconnect, kafka_client_fixture) {
 
     client.stop().get();
 }
+
+FIXTURE_TEST(produce_local_broker, kafka_client_fixture) {
+    using namespace std::chrono_literals;
+
+    info("Waiting for leadership");
+    wait_for_controller_leadership().get();
+
+    auto tp = model::topic_partition(model::topic("t"), model::partition_id(0));
+    auto ntp = make_default_ntp(tp.topic, tp.partition);
+    add_topic(model::topic_namespace_view(ntp)).get();
+
+    auto client = make_client();
+    client.config().retry_base_backoff.set_value(10ms);
+    client.config().retries.set_value(size_t(10));
+    client.set_local_broker(kc::local_broker{
+      .node_id = config::shard_local_cfg().node_id(),
+      .listeners = config::shard_local_cfg().advertised_kafka_api(),
+      .protocol = std::ref(*proto)});
+    client.connect().get();
+
+    info("Producing to the local broker");
+    auto res = client.produce_record_batch(tp, make_batch(model::offset(0), 2))
+                 .get();
+    BOOST_REQUIRE_EQUAL(res.error, kafka::error_code::none);
+
+    info("Fetching from the local broker");
+    auto fetch{
+      client.fetch_partition(tp, model::offset(0), 1024, 1000ms).get()};
+    const auto& p = fetch.partitions[0];
+    BOOST_REQUIRE_EQUAL(p.responses.size(), 1);
+    BOOST_REQUIRE_EQUAL(p.responses[0].error, kafka::error_code::none);
+
+    client.stop().get();
+}
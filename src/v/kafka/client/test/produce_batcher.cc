@@ -21,9 +21,15 @@
 #include <seastar/core/when_all.hh>
 #include <seastar/testing/thread_test_case.hh>
 
+#include <limits>
+
 namespace kc = kafka::client;
 
 struct produce_batcher_context {
+    explicit produce_batcher_context(
+      size_t merge_threshold = std::numeric_limits<size_t>::max())
+      : batcher(merge_threshold) {}
+
     const model::partition_id partition_id{2};
     const model::offset base_offset{42};
     model::offset client_req_offset{base_offset};
@@ -39,7 +45,10 @@ struct produce_batcher_context {
       broker_batches{};
 
     void produce(int32_t count) {
-        auto batch = make_batch(client_req_offset, count);
+        produce(make_batch(client_req_offset, count));
+    }
+    void produce(model::record_batch batch) {
+        auto count = batch.record_count();
         expected_offsets.push_back(client_req_offset);
         produce_futs.push_back(batcher.produce(std::move(batch)));
         client_req_offset += count;
@@ -168,3 +177,31 @@ SEASTAR_THREAD_TEST_CASE(test_partition_producer_error) {
 
     BOOST_REQUIRE(ctx.consume() == 0);
 }
+
+SEASTAR_THREAD_TEST_CASE(test_partition_producer_large_batch_as_is) {
+    auto large = make_batch(model::offset(0), 10);
+    produce_batcher_context ctx(large.size_bytes());
+    auto large_crc = large.header().crc;
+
+    ctx.produce(2);
+    ctx.produce(std::move(large));
+    ctx.produce(2);
+    BOOST_REQUIRE_EQUAL(ctx.batcher.record_count(), 14);
+
+    // the records ahead of the large batch are sealed in their own batch
+    BOOST_REQUIRE_EQUAL(ctx.consume(), 2);
+    BOOST_REQUIRE_EQUAL(ctx.consume(), 10);
+    BOOST_REQUIRE_EQUAL(
+      ctx.broker_batches.back().second.header().crc, large_crc);
+    BOOST_REQUIRE_EQUAL(ctx.consume(), 2);
+    BOOST_REQUIRE_EQUAL(ctx.batcher.record_count(), 0);
+    BOOST_REQUIRE_EQUAL(ctx.batcher.size_bytes(), 0);
+
+    BOOST_REQUIRE_EQUAL(ctx.handle_response(), 2);
+    BOOST_REQUIRE_EQUAL(ctx.handle_response(), 10);
+    BOOST_REQUIRE_EQUAL(ctx.handle_response(), 2);
+    auto offsets = ctx.get_response_offsets().get0();
+    BOOST_REQUIRE(offsets == ctx.expected_offsets);
+
+    BOOST_REQUIRE_EQUAL(ctx.consume(), 0);
+}
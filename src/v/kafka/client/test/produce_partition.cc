@@ -17,10 +17,12 @@
 #include "model/fundamental.h"
 #include "model/record.h"
 
+#include <seastar/core/sleep.hh>
 #include <seastar/testing/thread_test_case.hh>
 
 #include <boost/test/tools/old/interface.hpp>
 
+#include <chrono>
 #include <exception>
 #include <system_error>
 
@@ -65,3 +67,48 @@ SEASTAR_THREAD_TEST_CASE(test_produce_partition_record_count) {
     auto c_res2 = c_res2_fut.get0();
     BOOST_REQUIRE_EQUAL(c_res2.base_offset, model::offset{3});
 }
+
+SEASTAR_THREAD_TEST_CASE(test_produce_partition_linger) {
+    using namespace std::chrono_literals;
+    std::vector<model::record_batch> consumed_batches;
+    auto consumer = [&consumed_batches](model::record_batch&& batch) {
+        consumed_batches.push_back(std::move(batch));
+    };
+
+    auto cfg = kc::configuration{};
+    cfg.produce_batch_size_bytes.set_value(1024 * 1024);
+    cfg.produce_batch_record_count.set_value(1000);
+    // configuration under test
+    cfg.produce_batch_delay.set_value(50ms);
+
+    kc::produce_partition producer(cfg, consumer);
+
+    // the requests that follow don't extend the delay of the first one
+    auto c_res0_fut = producer.produce(make_batch(model::offset(0), 2));
+    ss::sleep(30ms).get();
+    auto c_res1_fut = producer.produce(make_batch(model::offset(2), 1));
+    ss::sleep(30ms).get();
+    BOOST_REQUIRE_EQUAL(consumed_batches.size(), 1);
+    BOOST_REQUIRE_EQUAL(consumed_batches[0].record_count(), 3);
+
+    // requests that waited for the batch in flight go with its response
+    auto c_res2_fut = producer.produce(make_batch(model::offset(3), 3));
+    ss::sleep(60ms).get();
+    BOOST_REQUIRE_EQUAL(consumed_batches.size(), 1);
+    producer.handle_response(kafka::produce_response::partition{
+      .id{model::partition_id{42}},
+      .error = kafka::error_code::none,
+      .base_offset{model::offset{0}}});
+    BOOST_REQUIRE_EQUAL(consumed_batches.size(), 2);
+    BOOST_REQUIRE_EQUAL(consumed_batches[1].record_count(), 3);
+
+    BOOST_REQUIRE_EQUAL(c_res0_fut.get0().base_offset, model::offset{0});
+    BOOST_REQUIRE_EQUAL(c_res1_fut.get0().base_offset, model::offset{2});
+
+    producer.handle_response(kafka::produce_response::partition{
+      .id{model::partition_id{42}},
+      .error = kafka::error_code::none,
+      .base_offset{model::offset{3}}});
+    BOOST_REQUIRE_EQUAL(c_res2_fut.get0().base_offset, model::offset{3});
+    producer.stop().get();
+}
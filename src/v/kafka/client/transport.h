@@ -12,11 +12,15 @@
 #pragma once
 
 #include "kafka/protocol/fwd.h"
+#include "kafka/protocol/request_reader.h"
+#include "kafka/protocol/types.h"
 #include "kafka/server/protocol_utils.h"
 #include "kafka/types.h"
 #include "rpc/transport.h"
 #include "seastarx.h"
+#include "utils/mutex.h"
 
+#include <seastar/core/coroutine.hh>
 #include <seastar/core/future.hh>
 #include <seastar/core/iostream.hh>
 #include <seastar/core/reactor.hh>
@@ -25,23 +29,59 @@
 
 namespace kafka::client {
 
+/// Max version of the request type supported by the redpanda kafka server
+template<typename T>
+CONCEPT(requires(KafkaApi<typename T::api_type>))
+api_version default_version() {
+    using type = std::remove_reference_t<std::decay_t<T>>;
+    if constexpr (std::is_same_v<type, offset_fetch_request>) {
+        return api_version(4);
+    } else if constexpr (std::is_same_v<type, fetch_request>) {
+        return api_version(10);
+    } else if constexpr (std::is_same_v<type, produce_request>) {
+        return api_version(7);
+    } else if constexpr (std::is_same_v<type, offset_commit_request>) {
+        return api_version(7);
+    } else if constexpr (std::is_same_v<type, describe_groups_request>) {
+        return api_version(2);
+    } else if constexpr (std::is_same_v<type, heartbeat_request>) {
+        return api_version(3);
+    } else if constexpr (std::is_same_v<type, join_group_request>) {
+        return api_version(4);
+    } else if constexpr (std::is_same_v<type, sync_group_request>) {
+        return api_version(3);
+    } else if constexpr (std::is_same_v<type, leave_group_request>) {
+        return api_version(2);
+    } else if constexpr (std::is_same_v<type, metadata_request>) {
+        return api_version(7);
+    } else if constexpr (std::is_same_v<type, find_coordinator_request>) {
+        return api_version(2);
+    } else if constexpr (std::is_same_v<type, list_groups_request>) {
+        return api_version(3);
+    } else if constexpr (std::is_same_v<type, create_topics_request>) {
+        return api_version(4);
+    }
+}
+
 /**
  * \brief Kafka client.
  *
- * Restrictions:
- *  - don't dispatch concurrent requests.
+ * Requests may be dispatched concurrently, they are pipelined on the
+ * connection: a request is written as soon as the previous one is written,
+ * without waiting for its reply.
  */
 class transport : public rpc::base_transport {
 private:
     /*
-     * send a request message and process the reply. note that the kafka
-     * protocol requires that replies be sent in the same order they are
-     * received at the server. in a future version of this client we will also
-     * want to do some form of request/response correlation so that multiple
-     * requests can be in flight.
+     * send a request message and process the reply. the kafka protocol
+     * requires that replies be sent in the same order they are received at
+     * the server, so the replies are read in the order the requests were
+     * written and matched by their correlation id.
      */
     template<typename Func>
-    auto send_recv(Func&& func) {
+    ss::future<iobuf> send_recv(Func func) {
+        auto send = co_await _send_mutex.get_units();
+        check_in_sync();
         // size prefixed buffer for request
         iobuf buf;
         auto ph = buf.reserve(sizeof(int32_t));
@@ -49,6 +89,7 @@ private:
         response_writer wr(buf);
 
         // encode request
+        const auto correlation = _correlation;
         func(wr);
 
         // finalize by filling in the size prefix
@@ -57,17 +98,48 @@ private:
         auto* raw_size = reinterpret_cast<const char*>(&be_total_size);
         ph.write(raw_size, sizeof(be_total_size));
 
-        return _out.write(iobuf_as_scattered(std::move(buf))).then([this] {
-            return parse_size(_in).then([this](std::optional<size_t> sz) {
-                auto size = sz.value();
-                return _in.read_exactly(sizeof(correlation_id))
-                  .then([this, size](ss::temporary_buffer<char>) {
-                      // drops the correlation id on the floor
-                      auto remaining = size - sizeof(correlation_id);
-                      return read_iobuf_exactly(_in, remaining);
-                  });
-            });
-        });
+        try {
+            co_await _out.write(iobuf_as_scattered(std::move(buf)));
+        } catch (...) {
+            _broken = true;
+            throw;
+        }
+        // queued for the reply before the next request is written
+        auto recv_units = _recv_mutex.get_units();
+        send.return_all();
+        auto recv = co_await std::move(recv_units);
+        co_return co_await recv_reply(correlation);
+    }
+
+    void check_in_sync() const {
+        if (_broken) {
+            // a request or a reply was lost, the stream is out of sync
+            throw std::bad_optional_access();
+        }
+    }
+
+    ss::future<iobuf> recv_reply(correlation_id expected) {
+        check_in_sync();
+        try {
+            auto size = (co_await parse_size(_in)).value();
+            auto hdr = co_await _in.read_exactly(sizeof(correlation_id));
+            if (hdr.size() != sizeof(correlation_id)) {
+                throw std::bad_optional_access();
+            }
+            auto correlation = correlation_id(ss::be_to_cpu(
+              *reinterpret_cast<const correlation_id::type*>(hdr.get())));
+            if (correlation != expected) {
+                throw std::runtime_error(fmt::format(
+                  "reply correlation id {} does not match request {}",
+                  correlation(),
+                  expected()));
+            }
+            co_return co_await read_iobuf_exactly(
+              _in, size - sizeof(correlation_id));
+        } catch (...) {
+            _broken = true;
+            throw;
+        }
     }
 
 public:
@@ -81,13 +153,19 @@ public:
     CONCEPT(requires(KafkaApi<typename T::api_type>))
     ss::future<typename T::api_type::response_type> dispatch(
       T r, api_version request_version, api_version response_version) {
-        return send_recv([this, request_version, r = std::move(r)](
+        const bool flexible = is_flexible<typename T::api_type>(
+          request_version);
+        return send_recv([this, request_version, flexible, r = std::move(r)](
                            response_writer& wr) mutable {
-                   write_header(wr, T::api_type::key, request_version);
+                   write_header(
+                     wr, T::api_type::key, request_version, flexible);
                    r.encode(wr, request_version);
                })
-          .then([response_version](iobuf buf) {
+          .then([response_version, flexible](iobuf buf) {
               using response_type = typename T::api_type::response_type;
+              if (flexible) {
+                  skip_header_tags(buf);
+              }
               response_type r;
               r.decode(std::move(buf), response_version);
               return ss::make_ready_future<response_type>(std::move(r));
@@ -112,46 +190,35 @@ public:
     template<typename T>
     CONCEPT(requires(KafkaApi<typename T::api_type>))
     ss::future<typename T::api_type::response_type> dispatch(T r) {
-        using type = std::remove_reference_t<std::decay_t<T>>;
-        if constexpr (std::is_same_v<type, offset_fetch_request>) {
-            return dispatch(std::move(r), api_version(4));
-        } else if constexpr (std::is_same_v<type, fetch_request>) {
-            return dispatch(std::move(r), api_version(10));
-        } else if constexpr (std::is_same_v<type, produce_request>) {
-            return dispatch(std::move(r), api_version(7));
-        } else if constexpr (std::is_same_v<type, offset_commit_request>) {
-            return dispatch(std::move(r), api_version(7));
-        } else if constexpr (std::is_same_v<type, describe_groups_request>) {
-            return dispatch(std::move(r), api_version(2));
-        } else if constexpr (std::is_same_v<type, heartbeat_request>) {
-            return dispatch(std::move(r), api_version(3));
-        } else if constexpr (std::is_same_v<type, join_group_request>) {
-            return dispatch(std::move(r), api_version(4));
-        } else if constexpr (std::is_same_v<type, sync_group_request>) {
-            return dispatch(std::move(r), api_version(3));
-        } else if constexpr (std::is_same_v<type, leave_group_request>) {
-            return dispatch(std::move(r), api_version(2));
-        } else if constexpr (std::is_same_v<type, metadata_request>) {
-            return dispatch(std::move(r), api_version(7));
-        } else if constexpr (std::is_same_v<type, find_coordinator_request>) {
-            return dispatch(std::move(r), api_version(2));
-        } else if constexpr (std::is_same_v<type, list_groups_request>) {
-            return dispatch(std::move(r), api_version(2));
-        } else if constexpr (std::is_same_v<type, create_topics_request>) {
-            return dispatch(std::move(r), api_version(4));
-        }
+        return dispatch(std::move(r), default_version<T>());
     }
 
 private:
-    void write_header(response_writer& wr, api_key key, api_version version) {
+    void write_header(
+      response_writer& wr, api_key key, api_version version, bool flexible) {
         wr.write(int16_t(key()));
         wr.write(int16_t(version()));
         wr.write(int32_t(_correlation()));
         wr.write(std::string_view("test_client"));
+        if (flexible) {
+            // request header v2
+            wr.write_tags();
+        }
         _correlation = _correlation + correlation_id(1);
     }
 
+    /// drops the tagged fields of the response header v1 from the front of
+    /// the reply
+    static void skip_header_tags(iobuf& buf) {
+        request_reader reader(buf.share(0, buf.size_bytes()));
+        reader.skip_tags();
+        buf.trim_front(reader.bytes_consumed());
+    }
+
     correlation_id _correlation{0};
+    mutex _send_mutex;
+    mutex _recv_mutex;
+    bool _broken{false};
 };
 
 } // namespace kafka::client
@@ -17,12 +17,15 @@
 #include "model/record.h"
 #include "seastarx.h"
 
+#include <seastar/core/circular_buffer.hh>
+
 namespace kafka {
 
 /**
  * A record batch reader consumer that serializes a stream of batches to the
  * Kafka on-wire format. The primary use case for this is the fetch api which
  * returns a set of batches read from a redpanda log back to a kafka client.
+ * It consumes whole slices as well, see record_batch_reader::consume_slices.
  */
 class kafka_batch_serializer {
 public:
@@ -49,6 +52,16 @@ public:
           ss::stop_iteration::no);
     }
 
+    ss::future<ss::stop_iteration>
+    operator()(ss::circular_buffer<model::record_batch>&& slice) {
+        for (auto& batch : slice) {
+            record_count_ += batch.record_count();
+            write_batch(std::move(batch));
+        }
+        return ss::make_ready_future<ss::stop_iteration>(
+          ss::stop_iteration::no);
+    }
+
     result end_of_stream() {
         return result{
           .data = std::move(_buf),
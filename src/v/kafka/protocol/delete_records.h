@@ -0,0 +1,83 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+#pragma once
+#include "bytes/iobuf.h"
+#include "kafka/protocol/errors.h"
+#include "kafka/protocol/schemata/delete_records_request.h"
+#include "kafka/protocol/schemata/delete_records_response.h"
+#include "kafka/server/request_context.h"
+#include "kafka/server/response.h"
+#include "kafka/types.h"
+#include "model/fundamental.h"
+#include "model/metadata.h"
+
+#include <seastar/core/future.hh>
+
+namespace kafka {
+
+struct delete_records_response;
+
+class delete_records_api final {
+public:
+    using response_type = delete_records_response;
+
+    static constexpr const char* name = "delete_records";
+    static constexpr api_key key = api_key(21);
+};
+
+struct delete_records_request final {
+    using api_type = delete_records_api;
+
+    delete_records_request_data data;
+
+    void encode(response_writer& writer, api_version version) {
+        data.encode(writer, version);
+    }
+
+    void decode(request_reader& reader, api_version version) {
+        data.decode(reader, version);
+    }
+};
+
+inline std::ostream&
+operator<<(std::ostream& os, const delete_records_request& r) {
+    return os << r.data;
+}
+
+struct delete_records_response final {
+    using api_type = delete_records_api;
+
+    delete_records_response_data data;
+
+    static delete_records_partition_result
+    make_partition(model::partition_id id, error_code error) {
+        return delete_records_partition_result{
+          .partition_index = id,
+          .low_watermark = model::offset(-1),
+          .error_code = error,
+        };
+    }
+
+    void encode(const request_context& ctx, response& resp) {
+        data.encode(resp.writer(), ctx.header().version);
+    }
+
+    void decode(iobuf buf, api_version version) {
+        data.decode(std::move(buf), version);
+    }
+};
+
+inline std::ostream&
+operator<<(std::ostream& os, const delete_records_response& r) {
+    return os << r.data;
+}
+
+} // namespace kafka
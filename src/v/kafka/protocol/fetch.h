@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include "bytes/iobuf.h"
 #include "cluster/partition.h"
 #include "kafka/protocol/batch_reader.h"
 #include "kafka/server/fetch_session.h"
@@ -24,6 +25,7 @@
 #include "seastarx.h"
 
 #include <seastar/core/future.hh>
+#include <seastar/core/sharded.hh>
 
 namespace kafka {
 
@@ -68,10 +70,11 @@ struct fetch_request final {
     int32_t session_epoch = final_fetch_session_epoch;      // >= v7
     std::vector<topic> topics;
     std::vector<forgotten_topic> forgotten_topics; // >= v7
-    ss::sstring rack_id;                           // >= v11 ignored
+    ss::sstring rack_id;                           // >= v11
 
     void encode(response_writer& writer, api_version version);
     void decode(request_context& ctx);
+    void decode(request_reader&, api_version);
 
     /*
      * For max_wait_time > 0 the request may be debounced in order to collect
@@ -218,7 +221,7 @@ struct fetch_response final {
         model::offset last_stable_offset;                      // >= v4
         model::offset log_start_offset;                        // >= v5
         std::vector<aborted_transaction> aborted_transactions; // >= v4
-        model::node_id preferred_read_replica{-1};             // >= v11 ignored
+        model::node_id preferred_read_replica{-1};             // >= v11
         std::optional<batch_reader> record_set;
         /*
          * _not part of kafka protocol
@@ -440,6 +443,8 @@ struct op_context {
                     .partition = p.partition->id,
                     .max_bytes = p.partition->partition_max_bytes,
                     .fetch_offset = p.partition->fetch_offset,
+                    .current_leader_epoch
+                    = p.partition->current_leader_epoch,
                   });
               });
         } else {
@@ -484,6 +489,8 @@ public:
 
     cluster::partition_probe& probe() { return _partition->probe(); }
 
+    const model::ntp& ntp() const { return _partition->ntp(); }
+
     model::offset high_watermark() const {
         return _log ? _log->offsets().dirty_offset
                     : _partition->high_watermark();
@@ -494,6 +501,21 @@ public:
         return _log ? _log->offsets().start_offset : _partition->start_offset();
     }
 
+    /// \brief estimated size of the data from the offset to the high
+    /// watermark, assuming batches of the average size of the log
+    size_t estimate_bytes_from(model::offset o) const {
+        auto hw = high_watermark();
+        auto start = std::max(start_offset(), model::offset(0));
+        if (o > hw || hw < start) {
+            return 0;
+        }
+        auto size = _log ? _log->size_bytes() : _partition->size_bytes();
+        auto total = (hw - start)() + 1;
+        auto wanted = (hw - std::max(o, start))() + 1;
+        return static_cast<size_t>(
+          size * (static_cast<double>(wanted) / total));
+    }
+
     model::offset last_stable_offset() const {
         return _log ? _log->offsets().dirty_offset
                     : _partition->last_stable_offset();
@@ -506,9 +528,21 @@ private:
 
 struct fetch_config {
     model::offset start_offset;
+    // checked against the leader epoch of the partition, -1 when unknown
+    int32_t current_leader_epoch{-1};
     size_t max_bytes;
     model::timeout_clock::time_point timeout;
     bool strict_max_bytes{false};
+    // serialize the batches as the log reader hands them over, without
+    // materializing them, see storage::passthrough_sink
+    bool passthrough{false};
+    // rack of the consumer, set when consumers may be redirected to replicas
+    // in their rack
+    std::optional<ss::sstring> consumer_rack;
+    // read at the cold read priority, whatever the distance to the tail
+    bool low_priority{false};
+    // shard the request was received on
+    ss::shard_id request_shard{ss::this_shard_id()};
 };
 /**
  * Simple type aggregating either reader and offsets or an error
@@ -528,6 +562,17 @@ struct read_result {
       , last_stable_offset(lso)
       , error(error_code::none) {}
 
+    read_result(
+      iobuf data,
+      model::offset start_offset,
+      model::offset hw,
+      model::offset lso)
+      : data(ss::make_foreign(std::make_unique<iobuf>(std::move(data))))
+      , start_offset(start_offset)
+      , high_watermark(hw)
+      , last_stable_offset(lso)
+      , error(error_code::none) {}
+
     read_result(model::offset start_offset, model::offset hw, model::offset lso)
       : start_offset(start_offset)
       , high_watermark(hw)
@@ -535,11 +580,17 @@ struct read_result {
       , error(error_code::none) {}
 
     std::optional<model::record_batch_reader> reader;
+    // batches of a passthrough read, already in the kafka wire format
+    std::optional<ss::foreign_ptr<std::unique_ptr<iobuf>>> data;
     model::offset start_offset;
     model::offset high_watermark;
     model::offset last_stable_offset;
     error_code error;
     model::partition_id partition;
+    // replica the consumer should fetch from instead of this node
+    std::optional<model::node_id> preferred_replica;
+    // size of the batches read, held in memory until they are serialized
+    size_t size_bytes{0};
 };
 
 using ntp_fetch_config = std::pair<model::materialized_ntp, fetch_config>;
@@ -581,4 +632,12 @@ ss::future<read_result> read_from_ntp(
   bool,
   std::optional<model::timeout_clock::time_point>);
 
+/**
+ * Splits the byte budget of a fetch across partitions wanting the given
+ * number of bytes. Partitions wanting less than an even share get all they
+ * want, what they leave is shared by the others.
+ */
+std::vector<size_t>
+plan_fetch_budgets(const std::vector<size_t>& wanted, size_t budget);
+
 } // namespace kafka
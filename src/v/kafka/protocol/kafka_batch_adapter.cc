@@ -25,6 +25,14 @@
 
 namespace kafka {
 
+// bytes of the kafka batch ahead of those covered by the crc
+//   - 8 base offset
+//   - 4 batch length
+//   - 4 partition leader epoch
+//   - 1 magic
+//   - 4 exepcted crc
+static constexpr size_t crc_skip_bytes = 21;
+
 model::record_batch_header kafka_batch_adapter::read_header(iobuf_parser& in) {
     const size_t initial_bytes_consumed = in.bytes_consumed();
 
@@ -90,12 +98,7 @@ void kafka_batch_adapter::verify_crc(int32_t expected_crc, iobuf_parser in) {
     auto crc = crc32();
 
     // 1. move the cursor to correct endpoint
-    //   - 8 base offset
-    //   - 4 batch length
-    //   - 4 partition leader epoch
-    //   - 1 magic
-    //   - 4 exepcted crc
-    in.skip(21);
+    in.skip(crc_skip_bytes);
 
     // 2. consume & checksum the CRC
     in.consume(in.bytes_left(), [&crc](const char* src, size_t n) {
@@ -119,7 +122,69 @@ void kafka_batch_adapter::verify_crc(int32_t expected_crc, iobuf_parser in) {
     }
 }
 
+// bytes of the smallest kafka record after its length: attributes, timestamp
+// and offset deltas, null key and value, and no headers
+static constexpr int64_t min_record_size = 6;
+
+/**
+ * Checks that the records of an uncompressed batch are well framed: the
+ * length prefixes account for exactly the record count and the record bytes
+ * of the header. Records are skipped over without being decoded, the batch
+ * stays opaque until something needs its keys (compaction, coproc) and the
+ * CRC already covers the content of every record.
+ *
+ * A length prefix cut short by the end of the records decodes to whatever
+ * its bytes hold, which is either past the end or shorter than the smallest
+ * record.
+ */
+
+bool kafka_batch_adapter::verify_record_framing(
+  const model::record_batch_header& header, iobuf_const_parser in) {
+    int32_t records = 0;
+    while (in.bytes_left() > 0) {
+        if (unlikely(records == header.record_count)) {
+            return false;
+        }
+        auto [length, _] = in.read_varlong();
+        if (unlikely(
+              length < min_record_size || (size_t)length > in.bytes_left())) {
+            return false;
+        }
+        in.skip(length);
+        ++records;
+    }
+    return records == header.record_count;
+}
+
+/**
+ * Checks of a compressed batch that the header alone can answer. The records
+ * stay compressed from the wire to the log, their integrity is covered by
+ * the CRC and inflating them only to count them would cost more than the
+ * rest of the produce path. Compacted batches fetched from a broker may have
+ * gaps, so the offset delta only bounds the record count.
+ */
+bool kafka_batch_adapter::verify_compressed_header(
+  const model::record_batch_header& header, size_t records_size) {
+    if (unlikely(header.record_count < 0)) {
+        return false;
+    }
+    if (header.record_count == 0) {
+        return true;
+    }
+    return records_size > 0
+           && header.last_offset_delta >= header.record_count - 1;
+}
+
 iobuf kafka_batch_adapter::adapt(iobuf&& kbatch) {
+    return do_adapt(std::move(kbatch), nullptr);
+}
+
+iobuf kafka_batch_adapter::adapt(iobuf&& kbatch, batch_crc_verifier& crcs) {
+    return do_adapt(std::move(kbatch), &crcs);
+}
+
+iobuf kafka_batch_adapter::do_adapt(
+  iobuf&& kbatch, batch_crc_verifier* crcs) {
     // The batch size given in the kafka header does not include the offset
     // preceeding the length field nor the size of the length field itself.
     constexpr size_t kafka_length_diff
@@ -152,35 +217,91 @@ iobuf kafka_batch_adapter::adapt(iobuf&& kbatch) {
         return remainder;
     }
 
-    verify_crc(header.crc, std::move(crcparser));
-    if (unlikely(!valid_crc)) {
-        vlog(klog.error, "batch has invalid CRC: {}", header);
-        return remainder;
+    if (crcs) {
+        // checked with the batches of the other partitions of the request
+        crcparser.skip(crc_skip_bytes);
+        valid_crc = false;
+        crcs->add(*this, header.crc, crcparser.share(crcparser.bytes_left()));
+    } else {
+        verify_crc(header.crc, std::move(crcparser));
+        if (unlikely(!valid_crc)) {
+            vlog(klog.error, "batch has invalid CRC: {}", header);
+            return remainder;
+        }
     }
 
     auto records_size = header.size_bytes
                         - model::packed_record_batch_header_size;
+    if (unlikely(!header.attrs.is_valid_compression())) {
+        vlog(klog.error, "batch has an unknown compression: {}", header);
+        return remainder;
+    }
     auto records = parser.share(records_size);
 
     auto new_batch = model::record_batch(
       header, std::move(records), model::record_batch::tag_ctor_ng{});
 
     /**
-     * Perform some type of validation on the uncompressed input. In this case
-     * we make sure that the records can be materialized but we avoid
-     * re-encoding them using the lazy-record optimization.
+     * Perform some type of validation on the uncompressed input. The record
+     * framing is checked without materializing the records, the batch is
+     * carried to the log as the header and the bytes received.
      */
     if (!new_batch.compressed()) {
         try {
-            new_batch.for_each_record([](model::record r) { (void)r; });
+            if (!verify_record_framing(
+                  new_batch.header(), iobuf_const_parser(new_batch.data()))) {
+                vlog(
+                  klog.error,
+                  "Uncompressed records do not match the batch header: {}",
+                  new_batch.header());
+                return remainder;
+            }
         } catch (const std::exception& e) {
             vlog(klog.error, "Parsing uncompressed records: {}", e.what());
             return remainder;
         }
+    } else if (!verify_compressed_header(new_batch.header(), records_size)) {
+        vlog(
+          klog.error,
+          "Compressed records do not match the batch header: {}",
+          new_batch.header());
+        return remainder;
     }
 
     batch = std::move(new_batch);
     return remainder;
 }
 
+void batch_crc_verifier::add(
+  kafka_batch_adapter& adapter, int32_t expected_crc, iobuf crc_region) {
+    _crcs.add_stream();
+    for (const auto& f : crc_region) {
+        _crcs.extend(f.get(), f.size());
+    }
+    _entries.push_back(entry{
+      .adapter = &adapter,
+      .expected_crc = expected_crc,
+      .region = std::move(crc_region),
+    });
+}
+
+void batch_crc_verifier::verify() {
+    _crcs.compute();
+    for (size_t i = 0; i < _entries.size(); ++i) {
+        auto& e = _entries[i];
+        auto crc = _crcs.value(i);
+        e.adapter->valid_crc = (uint32_t)e.expected_crc == crc;
+        if (unlikely(!e.adapter->valid_crc)) {
+            vlog(
+              klog.error,
+              "Cannot validate Kafka record batch. Missmatching CRC. "
+              "Expected:{}, Got:{}",
+              e.expected_crc,
+              crc);
+            e.adapter->batch.reset();
+        }
+    }
+    _entries.clear();
+}
+
 } // namespace kafka
@@ -12,6 +12,7 @@
 #pragma once
 
 #include "bytes/iobuf_parser.h"
+#include "hashing/crc32c_batch.h"
 #include "model/record.h"
 #include "model/record_batch_reader.h"
 #include "utils/vint.h"
@@ -55,18 +56,52 @@ constexpr size_t kafka_header_size = sizeof(int64_t) + // base offset
  *
  * Note that the default constructed batch adapter is in an undefined state.
  */
+class batch_crc_verifier;
 class kafka_batch_adapter {
 public:
     iobuf adapt(iobuf&&);
 
+    /// \brief as adapt(), the CRC of the batch is checked by the verifier
+    /// together with the CRCs of other batches. valid_crc and batch are final
+    /// only after batch_crc_verifier::verify()
+    iobuf adapt(iobuf&&, batch_crc_verifier&);
+
     bool v2_format;
     bool valid_crc;
 
     std::optional<model::record_batch> batch;
 
 private:
+    iobuf do_adapt(iobuf&&, batch_crc_verifier*);
     void verify_crc(int32_t, iobuf_parser);
+    bool verify_record_framing(
+      const model::record_batch_header&, iobuf_const_parser);
+    bool verify_compressed_header(
+      const model::record_batch_header&, size_t records_size);
     model::record_batch_header read_header(iobuf_parser&);
 };
 
+/**
+ * Validates the CRCs of the batches of a request (one per partition of a
+ * produce request) at once, see crc32c_batch.
+ */
+class batch_crc_verifier {
+public:
+    void add(kafka_batch_adapter&, int32_t expected_crc, iobuf crc_region);
+
+    /// \brief sets valid_crc of all the adapters, batches with an invalid crc
+    /// are dropped
+    void verify();
+
+private:
+    struct entry {
+        kafka_batch_adapter* adapter;
+        int32_t expected_crc;
+        // keeps the fragments checksummed by _crcs alive
+        iobuf region;
+    };
+    std::vector<entry> _entries;
+    crc32c_batch _crcs;
+};
+
 } // namespace kafka
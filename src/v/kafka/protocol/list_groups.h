@@ -28,6 +28,7 @@ public:
 
     static constexpr const char* name = "list groups";
     static constexpr api_key key = api_key(16);
+    static constexpr api_version min_flexible = api_version(3);
 };
 
 struct list_groups_request final {
@@ -17,6 +17,7 @@
 #include "seastarx.h"
 
 #include <seastar/core/future.hh>
+#include <seastar/core/shared_ptr.hh>
 
 #include <chrono>
 
@@ -43,6 +44,7 @@ struct metadata_request {
 
     void encode(response_writer& writer, api_version version);
     void decode(request_context& ctx);
+    void decode(request_reader&, api_version);
 };
 
 std::ostream& operator<<(std::ostream&, const metadata_request&);
@@ -74,6 +76,8 @@ struct metadata_response {
         bool is_internal{false}; // version >= 1
         std::vector<partition> partitions;
         int32_t topic_authorized_operations; // version >= 8
+        // topic encoded in advance, written instead of the fields when set
+        ss::lw_shared_ptr<iobuf> encoded;
         void encode(api_version version, response_writer& rw) const;
         static topic make_from_topic_metadata(model::topic_metadata&& tp_md);
         static metadata_response::topic make_from_topic_metadata(
@@ -90,6 +94,8 @@ struct metadata_response {
 
     void encode(const request_context& ctx, response& resp);
     void decode(iobuf buf, api_version version);
+    /// the body of the response
+    void encode(api_version version, response_writer& writer) const;
 };
 
 std::ostream& operator<<(std::ostream&, const metadata_response&);
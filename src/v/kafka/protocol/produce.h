@@ -75,6 +75,7 @@ struct produce_request final {
 
     void encode(response_writer& writer, api_version version);
     void decode(request_context& ctx);
+    void decode(request_reader&, api_version);
 
     /**
      * Build a generic error response for a given request.
@@ -48,8 +48,36 @@ public:
         return i;
     }
 
+    /// the unsigned varints of the flexible versions (KIP-482) are the
+    /// zigzag varints of the numbers whose zigzag encoding they are
+    uint32_t read_unsigned_varint() {
+        return static_cast<uint32_t>(vint::encode_zigzag(read_varlong()));
+    }
+
     ss::sstring read_string() { return do_read_string(read_int16()); }
 
+    /// flexible versions: lengths are unsigned varints of length + 1, zero
+    /// for null
+    ss::sstring read_compact_string() {
+        return do_read_string(read_compact_length());
+    }
+
+    std::optional<ss::sstring> read_compact_nullable_string() {
+        auto n = read_compact_length();
+        if (n < 0) {
+            return std::nullopt;
+        }
+        return {do_read_string(n)};
+    }
+
+    bytes read_compact_bytes() {
+        auto n = read_compact_length();
+        if (unlikely(n < 0)) {
+            throw std::out_of_range("Asked to read negative compact bytes");
+        }
+        return _parser.read_bytes(n);
+    }
+
     std::optional<ss::sstring> read_nullable_string() {
         auto n = read_int16();
         if (n < 0) {
@@ -104,8 +132,60 @@ public:
         return do_read_array(len, std::forward<ElementParser>(parser));
     }
 
+    template<
+      typename ElementParser,
+      typename T = std::invoke_result_t<ElementParser, request_reader&>>
+    std::vector<T> read_compact_array(ElementParser&& parser) {
+        auto len = read_compact_length();
+        if (unlikely(len < 0)) {
+            throw std::out_of_range("Asked to read a null compact array");
+        }
+        return do_read_array(len, std::forward<ElementParser>(parser));
+    }
+
+    template<
+      typename ElementParser,
+      typename T = std::invoke_result_t<ElementParser, request_reader&>>
+    std::optional<std::vector<T>>
+    read_compact_nullable_array(ElementParser&& parser) {
+        auto len = read_compact_length();
+        if (len < 0) {
+            return std::nullopt;
+        }
+        return do_read_array(len, std::forward<ElementParser>(parser));
+    }
+
+    /**
+     * \brief reads the tagged fields which end every struct of a flexible
+     * version. The parser is handed the tag and a reader over the value of
+     * each field, unknown tags are skipped with their value.
+     */
+    // clang-format off
+    template<typename TagParser>
+    CONCEPT(requires requires(TagParser parser, request_reader& rr) {
+        { parser(uint32_t{}, rr) } -> std::same_as<void>;
+    })
+    // clang-format on
+    void read_tags(TagParser&& parser) {
+        auto n = read_unsigned_varint();
+        while (n-- > 0) {
+            auto tag = read_unsigned_varint();
+            auto size = read_unsigned_varint();
+            request_reader value(_parser.share(size));
+            parser(tag, value);
+        }
+    }
+
+    void skip_tags() {
+        read_tags([](uint32_t, request_reader&) {});
+    }
+
 private:
-    ss::sstring do_read_string(int16_t n) {
+    int32_t read_compact_length() {
+        return static_cast<int32_t>(read_unsigned_varint()) - 1;
+    }
+
+    ss::sstring do_read_string(int32_t n) {
         if (unlikely(n < 0)) {
             /// FIXME: maybe return empty string?
             throw std::out_of_range("Asked to read a negative byte string");
@@ -29,6 +29,8 @@
 
 #include <optional>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 namespace kafka {
 
@@ -40,20 +42,34 @@ class response_writer {
       // clang-format on
       uint32_t serialize_int(IntegerType val) {
         auto nval = ss::cpu_to_be(ExplicitIntegerType(val));
-        _out->append(reinterpret_cast<const char*>(&nval), sizeof(nval));
+        append(reinterpret_cast<const char*>(&nval), sizeof(nval));
         return sizeof(nval);
     }
 
     uint32_t serialize_vint(int64_t val) {
         auto x = vint::to_bytes(val);
-        _out->append(x.data(), x.size());
+        append(x.data(), x.size());
         return x.size();
     }
 
 public:
+    /// tag of a writer which only counts the bytes it is asked to write
+    struct size_only {};
+
     explicit response_writer(iobuf& out) noexcept
       : _out(&out) {}
 
+    /**
+     * \brief a writer without output, for a first pass over a response which
+     * computes its exact encoded size, see response::encode_presized().
+     * Nothing handed to it is consumed.
+     */
+    explicit response_writer(size_only) noexcept
+      : _out(nullptr) {}
+
+    /// bytes written so far, or counted by a size_only writer
+    size_t size_bytes() const { return _out ? _out->size_bytes() : _size; }
+
     uint32_t write(bool v) { return serialize_int<int8_t>(v); }
 
     uint32_t write(int8_t v) { return serialize_int<int8_t>(v); }
@@ -78,9 +94,15 @@ public:
 
     uint32_t write_varlong(int64_t v) { return serialize_vint(v); }
 
+    /// the unsigned varints of the flexible versions (KIP-482) are the
+    /// zigzag varints of the numbers whose zigzag encoding they are
+    uint32_t write_unsigned_varint(uint32_t v) {
+        return serialize_vint(vint::decode_zigzag(v));
+    }
+
     uint32_t write(std::string_view v) {
         auto size = serialize_int<int16_t>(v.size()) + v.size();
-        _out->append(v.data(), v.size());
+        append(v.data(), v.size());
         return size;
     }
 
@@ -102,7 +124,59 @@ public:
 
     uint32_t write(bytes_view bv) {
         auto size = serialize_int<int32_t>(bv.size()) + bv.size();
-        _out->append(reinterpret_cast<const char*>(bv.data()), bv.size());
+        append(reinterpret_cast<const char*>(bv.data()), bv.size());
+        return size;
+    }
+
+    /// flexible versions: lengths are unsigned varints of length + 1, zero
+    /// for null
+    uint32_t write_compact(std::string_view v) {
+        auto size = write_unsigned_varint(v.size() + 1) + v.size();
+        append(v.data(), v.size());
+        return size;
+    }
+
+    uint32_t write_compact(const ss::sstring& v) {
+        return write_compact(std::string_view(v));
+    }
+
+    uint32_t write_compact(const std::optional<ss::sstring>& v) {
+        if (!v) {
+            return write_unsigned_varint(0);
+        }
+        return write_compact(std::string_view(*v));
+    }
+
+    uint32_t write_compact(bytes_view bv) {
+        auto size = write_unsigned_varint(bv.size() + 1) + bv.size();
+        append(reinterpret_cast<const char*>(bv.data()), bv.size());
+        return size;
+    }
+
+    template<typename T, typename Tag>
+    uint32_t write_compact(const named_type<T, Tag>& t) {
+        return write_compact(t());
+    }
+
+    template<typename T, typename Tag>
+    uint32_t write_compact(const std::optional<named_type<T, Tag>>& t) {
+        if (!t) {
+            return write_unsigned_varint(0);
+        }
+        return write_compact((*t)());
+    }
+
+    /**
+     * \brief writes the tagged fields which end every struct of a flexible
+     * version, the encoded values of the fields in increasing tag order.
+     */
+    uint32_t write_tags(std::vector<std::pair<uint32_t, iobuf>> tags = {}) {
+        auto size = write_unsigned_varint(tags.size());
+        for (auto& [tag, value] : tags) {
+            size += write_unsigned_varint(tag);
+            size += write_unsigned_varint(value.size_bytes());
+            size += write_direct(std::move(value));
+        }
         return size;
     }
 
@@ -114,7 +188,7 @@ public:
         }
         auto size = serialize_int<int32_t>(data->size_bytes())
                     + data->size_bytes();
-        _out->append(std::move(*data));
+        append(std::move(*data));
         return size;
     }
 
@@ -122,13 +196,42 @@ public:
         if (!rdr) {
             return write(std::optional<iobuf>());
         }
+        if (!_out) {
+            return serialize_int<int32_t>(0) + rdr->size_bytes();
+        }
         return write(std::move(*rdr).release());
     }
 
     // write bytes directly to output without a length prefix
     uint32_t write_direct(iobuf&& f) {
         auto size = f.size_bytes();
-        _out->append(std::move(f));
+        append(std::move(f));
+        return size;
+    }
+
+    /// fragments smaller than this are cheaper to copy than to link
+    static constexpr size_t min_shared_fragment_size = 512;
+
+    /**
+     * \brief write bytes directly to output without a length prefix, sharing
+     * the underlying buffers instead of copying them.
+     *
+     * write_direct() packs fragments into the tail of the output whenever
+     * they fit, which copies every payload served from the batch cache. Here
+     * only fragments smaller than min_shared_fragment_size are copied, the
+     * rest are linked into the output and keep their buffers alive until the
+     * response is released.
+     */
+    uint32_t write_direct_shared(iobuf&& f) {
+        auto size = f.size_bytes();
+        // one walk over the fragments, each large one is shared on its own
+        for (auto& frag : f) {
+            if (frag.size() < min_shared_fragment_size) {
+                append(frag.get(), frag.size());
+            } else {
+                append_shared(frag.share());
+            }
+        }
         return size;
     }
 
@@ -151,12 +254,12 @@ public:
     })
     // clang-format on
     uint32_t write_array(const std::vector<T>& v, ElementWriter&& writer) {
-        auto start_size = uint32_t(_out->size_bytes());
+        auto start_size = uint32_t(size_bytes());
         write(int32_t(v.size()));
         for (auto& elem : v) {
             writer(elem, *this);
         }
-        return _out->size_bytes() - start_size;
+        return size_bytes() - start_size;
     }
     // clang-format off
     template<typename T, typename ElementWriter>
@@ -166,12 +269,12 @@ public:
     })
     // clang-format on
     uint32_t write_array(std::vector<T>& v, ElementWriter&& writer) {
-        auto start_size = uint32_t(_out->size_bytes());
+        auto start_size = uint32_t(size_bytes());
         write(int32_t(v.size()));
         for (auto& elem : v) {
             writer(elem, *this);
         }
-        return _out->size_bytes() - start_size;
+        return size_bytes() - start_size;
     }
 
     // clang-format off
@@ -189,6 +292,37 @@ public:
         return write_array(*v, std::forward<ElementWriter>(writer));
     }
 
+    // clang-format off
+    template<typename T, typename ElementWriter>
+    CONCEPT(
+          requires requires(ElementWriter writer, response_writer& rw, T& elem) {
+            { writer(elem, rw) } -> std::same_as<void>;
+    })
+    // clang-format on
+    uint32_t write_compact_array(std::vector<T>& v, ElementWriter&& writer) {
+        auto start_size = uint32_t(size_bytes());
+        write_unsigned_varint(v.size() + 1);
+        for (auto& elem : v) {
+            writer(elem, *this);
+        }
+        return size_bytes() - start_size;
+    }
+
+    // clang-format off
+    template<typename T, typename ElementWriter>
+    CONCEPT(
+          requires requires(ElementWriter writer, response_writer& rw, T& elem) {
+            { writer(elem, rw) } -> std::same_as<void>;
+    })
+    // clang-format on
+    uint32_t write_compact_nullable_array(
+      std::optional<std::vector<T>>& v, ElementWriter&& writer) {
+        if (!v) {
+            return write_unsigned_varint(0);
+        }
+        return write_compact_array(*v, std::forward<ElementWriter>(writer));
+    }
+
     // wrap a writer in a kafka bytes array object. the writer should return
     // true if writing no bytes should result in the encoding as nullable bytes,
     // and false otherwise.
@@ -200,10 +334,16 @@ public:
     })
     // clang-format on
     uint32_t write_bytes_wrapped(ElementWriter&& writer) {
+        if (!_out) {
+            auto size = serialize_int<int32_t>(0);
+            auto start_size = uint32_t(size_bytes());
+            writer(*this);
+            return size + size_bytes() - start_size;
+        }
         auto ph = _out->reserve(sizeof(int32_t));
-        auto start_size = uint32_t(_out->size_bytes());
+        auto start_size = uint32_t(size_bytes());
         auto zero_len_is_null = writer(*this);
-        int32_t real_size = _out->size_bytes() - start_size;
+        int32_t real_size = size_bytes() - start_size;
         // enc_size: the size prefix in the serialization
         int32_t enc_size = real_size > 0 ? real_size
                                          : (zero_len_is_null ? -1 : 0);
@@ -214,7 +354,35 @@ public:
     }
 
 private:
+    void append(const char* data, size_t size) {
+        if (likely(_out)) {
+            _out->append(data, size);
+        } else {
+            _size += size;
+        }
+    }
+
+    void append(iobuf&& b) {
+        if (likely(_out)) {
+            _out->append(std::move(b));
+        } else {
+            _size += b.size_bytes();
+        }
+    }
+
+    /// links the buffer into the output as a fragment of its own
+    void append_shared(ss::temporary_buffer<char> b) {
+        if (likely(_out)) {
+            _out->append_take_ownership(
+              new iobuf::fragment(std::move(b), iobuf::fragment::full{}));
+        } else {
+            _size += b.size();
+        }
+    }
+
     iobuf* _out;
+    // bytes counted by a size_only writer
+    size_t _size{0};
 };
 
 } // namespace kafka
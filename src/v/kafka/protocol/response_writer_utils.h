@@ -12,14 +12,16 @@
 #pragma once
 #include "kafka/protocol/kafka_batch_adapter.h"
 #include "kafka/protocol/response_writer.h"
+#include "likely.h"
 #include "model/record.h"
 
 #include <cstdint>
 
 namespace kafka {
 
-inline void
-writer_serialize_batch(response_writer& w, model::record_batch&& batch) {
+/// Serializes the batch with \p header and the \p records payload
+inline void writer_serialize_batch(
+  response_writer& w, const model::record_batch_header& header, iobuf records) {
     /*
      * calculate batch size expected by kafka client.
      *
@@ -36,24 +38,36 @@ writer_serialize_batch(response_writer& w, model::record_batch&& batch) {
      * header does not include the offset preceeding the length field nor
      * the size of the length field itself.
      */
-    auto size = batch.size_bytes() - model::packed_record_batch_header_size
+    auto size = header.size_bytes - model::packed_record_batch_header_size
                 + internal::kafka_header_size - sizeof(int64_t)
                 - sizeof(int32_t);
 
-    w.write(int64_t(batch.base_offset()));
+    w.write(int64_t(header.base_offset()));
     w.write(int32_t(size)); // batch length
     w.write(int32_t(0));    // partition leader epoch
     w.write(int8_t(2));     // magic
-    w.write(batch.header().crc);
-    w.write(int16_t(batch.header().attrs.value()));
-    w.write(int32_t(batch.header().last_offset_delta));
-    w.write(int64_t(batch.header().first_timestamp.value()));
-    w.write(int64_t(batch.header().max_timestamp.value()));
-    w.write(int64_t(batch.header().producer_id));
-    w.write(int16_t(batch.header().producer_epoch));
-    w.write(int32_t(batch.header().base_sequence));
-    w.write(int32_t(batch.record_count()));
-    w.write_direct(std::move(batch).release_data());
+    w.write(header.crc);
+    w.write(int16_t(header.attrs.value()));
+    w.write(int32_t(header.last_offset_delta));
+    w.write(int64_t(header.first_timestamp.value()));
+    w.write(int64_t(header.max_timestamp.value()));
+    w.write(int64_t(header.producer_id));
+    w.write(int16_t(header.producer_epoch));
+    w.write(int32_t(header.base_sequence));
+    w.write(int32_t(header.record_count));
+    if (likely(!header.attrs.is_control())) {
+        // data batches are passed through unchanged, link their payload
+        w.write_direct_shared(std::move(records));
+    } else {
+        // control batches were rebuilt by the fetch adapter, payloads are tiny
+        w.write_direct(std::move(records));
+    }
+}
+
+inline void
+writer_serialize_batch(response_writer& w, model::record_batch&& batch) {
+    auto header = batch.header();
+    writer_serialize_batch(w, header, std::move(batch).release_data());
 }
 
 } // namespace kafka
@@ -21,12 +21,9 @@
 #   path_type_map to override types, it would be more efficient to specify the
 #   same mapping using the field_name_type_map + a whitelist of request types.
 #
-#   - The current version does not handle flexible versions. It will be some
-#   time before we encounter clients requiring this, but in principle this
-#   generator should be extensible (see type maps below). Note that when the
-#   time comes to support flexible versions, there is a filter in the templates
-#   within this file that ignores such fields, and that filter should be
-#   removed.
+#   - Tagged fields are limited to scalar types. Every tagged field present in
+#   a version is written, the protocol allows a field holding its default to
+#   be written.
 #
 #   - Handle ignorable fields. Currently we handle nullable fields properly. The
 #   ignorable flag on a field doesn't change the wire protocol, but gives
@@ -79,6 +76,7 @@ path_type_map = {
             },
         },
         "MemberId": ("kafka::member_id", "string"),
+        "GroupInstanceId": ("kafka::group_instance_id", "string"),
     },
     "JoinGroupRequestData": {
         "MemberId": ("kafka::member_id", "string"),
@@ -155,6 +153,38 @@ path_type_map = {
             },
         },
     },
+    "OffsetForLeaderEpochRequestData": {
+        "Topics": {
+            "Partitions": {
+                "PartitionIndex": ("model::partition_id", "int32"),
+            },
+        },
+    },
+    "OffsetForLeaderEpochResponseData": {
+        "Topics": {
+            "Partitions": {
+                "PartitionIndex": ("model::partition_id", "int32"),
+                "EndOffset": ("model::offset", "int64"),
+            },
+        },
+    },
+    "DeleteRecordsRequestData": {
+        "TimeoutMs": ("std::chrono::milliseconds", "int32"),
+        "Topics": {
+            "Partitions": {
+                "PartitionIndex": ("model::partition_id", "int32"),
+                "Offset": ("model::offset", "int64"),
+            },
+        },
+    },
+    "DeleteRecordsResponseData": {
+        "Topics": {
+            "Partitions": {
+                "PartitionIndex": ("model::partition_id", "int32"),
+                "LowWatermark": ("model::offset", "int64"),
+            },
+        },
+    },
     "DescribeGroupsResponseData": {
         "Groups": {
             "ProtocolType": ("kafka::protocol_type", "string"),
@@ -207,6 +237,13 @@ basic_type_map = dict(
     int64=("int64_t", "read_int64()"),
 )
 
+# primitive types whose encoding changes in flexible versions (KIP-482). the
+# lengths of their compact encodings are unsigned varints
+compact_decoder_map = dict(
+    string=("read_compact_string()", "read_compact_nullable_string()"),
+    bytes=("read_compact_bytes()", ),
+)
+
 # apply a rename to a struct. this is useful when there is a type name conflict
 # between two request types. since we generate types in a flat namespace this
 # feature is important for resolving naming conflicts.
@@ -274,6 +311,14 @@ STRUCT_TYPES = [
     "DeleteAclsFilter",
     "DeleteAclsFilterResult",
     "DeleteAclsMatchingAcl",
+    "OffsetForLeaderTopic",
+    "OffsetForLeaderPartition",
+    "OffsetForLeaderTopicResult",
+    "OffsetForLeaderPartitionResult",
+    "DeleteRecordsTopic",
+    "DeleteRecordsPartition",
+    "DeleteRecordsTopicResult",
+    "DeleteRecordsPartitionResult",
 ]
 
 SCALAR_TYPES = list(basic_type_map.keys())
@@ -313,6 +358,16 @@ class VersionRange:
             max = int(match.group("max"))
             return min, max
 
+    def contains(self, other):
+        """
+        Whether every version of the other range is part of this one.
+        """
+        if other.min < self.min:
+            return False
+        if self.max is None:
+            return True
+        return other.max is not None and other.max <= self.max
+
     def guard(self):
         """
         Generate the C++ bounds check.
@@ -402,6 +457,15 @@ class StructType(FieldType):
     def is_struct(self):
         return True
 
+    @property
+    def regular_fields(self):
+        return [f for f in self.fields if not f.is_tagged]
+
+    @property
+    def tagged_fields(self):
+        return sorted([f for f in self.fields if f.is_tagged],
+                      key=lambda f: f.tag)
+
     @property
     def format(self):
         """Format string for output operator"""
@@ -444,6 +508,13 @@ class Field:
         self._default_value = self._field.get("default", "")
         if self._default_value == "null":
             self._default_value = ""
+        self._tag = self._field.get("tag", None)
+        if self._tag is not None:
+            # tagged fields are only ever tagged, and only scalars are
+            # supported
+            tagged_versions = VersionRange(self._field["taggedVersions"])
+            assert tagged_versions.contains(self._versions)
+            assert isinstance(self._type, ScalarType)
         assert len(self._path)
 
     @staticmethod
@@ -466,6 +537,14 @@ class Field:
     def about(self):
         return self._field.get("about", "<no description>")
 
+    @property
+    def is_tagged(self):
+        return self._tag is not None
+
+    @property
+    def tag(self):
+        return self._tag
+
     def _redpanda_path_type(self):
         """
         Resolve a redpanda field path type override.
@@ -560,6 +639,26 @@ class Field:
             return plain_decoder[2], named_type
         return plain_decoder[1], named_type
 
+    def decoder_for(self, flex):
+        """
+        The decoder of the field in a flexible version when flex is set.
+        """
+        decoder, named_type = self.decoder
+        if not flex or self._type.name not in compact_decoder_map:
+            return decoder, named_type
+        compact = compact_decoder_map[self._type.name]
+        if self.nullable() and not self.is_array:
+            return compact[1], named_type
+        return compact[0], named_type
+
+    def encoder_for(self, flex):
+        """
+        The writer method of a scalar value of the field.
+        """
+        if flex and self._type.name in compact_decoder_map:
+            return "write_compact"
+        return "write"
+
     @property
     def is_array(self):
         return isinstance(self._type, ArrayType)
@@ -664,47 +763,49 @@ if ({{ cond }}) {
 {%- endif %}
 {%- endmacro %}
 
-{% macro field_encoder(field, obj) %}
+{% macro field_encoder(field, obj, flex) %}
 {%- if obj %}
 {%- set fname = obj + "." + field.name %}
 {%- else %}
 {%- set fname = field.name %}
 {%- endif %}
 {%- if field.is_array %}
+{%- set array_writer = "write_compact_" if flex else "write_" %}
 {%- if field.nullable() %}
-writer.write_nullable_array({{ fname }}, [version]({{ field.value_type }}& v, response_writer& writer) {
+writer.{{ array_writer }}nullable_array({{ fname }}, [version]({{ field.value_type }}& v, response_writer& writer) {
 {%- else %}
-writer.write_array({{ fname }}, [version]({{ field.value_type }}& v, response_writer& writer) {
+writer.{{ array_writer }}array({{ fname }}, [version]({{ field.value_type }}& v, response_writer& writer) {
 {%- endif %}
 {%- if field.type().value_type().is_struct %}
-{{- struct_serde(field.type().value_type(), field_encoder, "v") | indent }}
+{{- struct_serde(field.type().value_type(), field_encoder, tag_encoder, "v", flex) | indent }}
 {%- else %}
-    writer.write(v);
+    writer.{{ field.encoder_for(flex) }}(v);
 {%- endif %}
 });
 {%- else %}
-writer.write({{ fname }});
+writer.{{ field.encoder_for(flex) }}({{ fname }});
 {%- endif %}
 {%- endmacro %}
 
-{% macro field_decoder(field, obj) %}
+{% macro field_decoder(field, obj, flex) %}
 {%- if obj %}
 {%- set fname = obj + "." + field.name %}
 {%- else %}
 {%- set fname = field.name %}
 {%- endif %}
 {%- if field.is_array %}
+{%- set array_reader = "read_compact_" if flex else "read_" %}
 {%- if field.nullable() %}
-{{ fname }} = reader.read_nullable_array([version](request_reader& reader) {
+{{ fname }} = reader.{{ array_reader }}nullable_array([version](request_reader& reader) {
 {%- else %}
-{{ fname }} = reader.read_array([version](request_reader& reader) {
+{{ fname }} = reader.{{ array_reader }}array([version](request_reader& reader) {
 {%- endif %}
 {%- if field.type().value_type().is_struct %}
     {{ field.type().value_type().name }} v;
-{{- struct_serde(field.type().value_type(), field_decoder, "v") | indent }}
+{{- struct_serde(field.type().value_type(), field_decoder, tag_decoder, "v", flex) | indent }}
     return v;
 {%- else %}
-{%- set decoder, named_type = field.decoder %}
+{%- set decoder, named_type = field.decoder_for(flex) %}
 {%- if named_type == None %}
     return reader.{{ decoder }};
 {%- elif field.nullable() %}
@@ -721,7 +822,7 @@ writer.write({{ fname }});
 {%- endif %}
 });
 {%- else %}
-{%- set decoder, named_type = field.decoder %}
+{%- set decoder, named_type = field.decoder_for(flex) %}
 {%- if named_type == None %}
 {{ fname }} = reader.{{ decoder }};
 {%- elif field.nullable() %}
@@ -737,30 +838,105 @@ writer.write({{ fname }});
 {%- endif %}
 {%- endmacro %}
 
-{% macro struct_serde(struct, field_serde, obj = "") %}
-{%- for field in struct.fields %}
+{% macro tag_encoder(struct, obj) %}
+{%- if struct.tagged_fields %}
+{
+    std::vector<std::pair<uint32_t, iobuf>> tags;
+{%- for field in struct.tagged_fields %}
+{%- if obj %}
+{%- set fname = obj + "." + field.name %}
+{%- else %}
+{%- set fname = field.name %}
+{%- endif %}
+{%- filter indent %}
+{%- call version_guard(field) %}
+{
+    iobuf buf;
+    response_writer tag_writer(buf);
+    tag_writer.{{ field.encoder_for(true) }}({{ fname }});
+    tags.emplace_back({{ field.tag }}, std::move(buf));
+}
+{%- endcall %}
+{%- endfilter %}
+{%- endfor %}
+    writer.write_tags(std::move(tags));
+}
+{%- else %}
+writer.write_tags();
+{%- endif %}
+{%- endmacro %}
+
+{% macro tag_decoder(struct, obj) %}
+{%- if struct.tagged_fields %}
+reader.read_tags([&](uint32_t tag, request_reader& tag_reader) {
+    switch (tag) {
+{%- for field in struct.tagged_fields %}
+{%- if obj %}
+{%- set fname = obj + "." + field.name %}
+{%- else %}
+{%- set fname = field.name %}
+{%- endif %}
+{%- set decoder, named_type = field.decoder_for(true) %}
+    case {{ field.tag }}:
+{%- if named_type == None %}
+        {{ fname }} = tag_reader.{{ decoder }};
+{%- else %}
+        {{ fname }} = {{ named_type }}(tag_reader.{{ decoder }});
+{%- endif %}
+        break;
+{%- endfor %}
+    default:
+        // unknown tags were skipped with their value
+        break;
+    }
+});
+{%- else %}
+reader.skip_tags();
+{%- endif %}
+{%- endmacro %}
+
+{#- tagged fields only exist in flexible versions, they end every struct #}
+{% macro struct_serde(struct, field_serde, tag_serde, obj = "", flex = false) %}
+{%- for field in struct.regular_fields %}
 {%- call version_guard(field) %}
-{{- field_serde(field, obj) }}
+{{- field_serde(field, obj, flex) }}
 {%- endcall %}
 {%- endfor %}
+{%- if flex %}
+{{ tag_serde(struct, obj) }}
+{%- endif %}
+{%- endmacro %}
+
+{% macro flexible_serde(struct, field_serde, tag_serde) %}
+{%- if flexible == None %}
+{{- struct_serde(struct, field_serde, tag_serde) | indent }}
+{%- elif not flexible.guard() %}
+{{- struct_serde(struct, field_serde, tag_serde, "", true) | indent }}
+{%- else %}
+    if ({{ flexible.guard() }}) {
+{{- struct_serde(struct, field_serde, tag_serde, "", true) | indent(8) }}
+    } else {
+{{- struct_serde(struct, field_serde, tag_serde) | indent(8) }}
+    }
+{%- endif %}
 {%- endmacro %}
 
 namespace kafka {
 
 {%- if struct.fields %}
 void {{ struct.name }}::encode(response_writer& writer, [[maybe_unused]] api_version version) {
-{{- struct_serde(struct, field_encoder) | indent }}
+{{- flexible_serde(struct, field_encoder, tag_encoder) }}
 }
 
 {%- if op_type == "request" %}
 void {{ struct.name }}::decode(request_reader& reader, [[maybe_unused]] api_version version) {
-{{- struct_serde(struct, field_decoder) | indent }}
+{{- flexible_serde(struct, field_decoder, tag_decoder) }}
 }
 {%- else %}
 void {{ struct.name }}::decode(iobuf buf, [[maybe_unused]] api_version version) {
     request_reader reader(std::move(buf));
 
-{{- struct_serde(struct, field_decoder) | indent }}
+{{- flexible_serde(struct, field_decoder, tag_decoder) }}
 }
 {%- endif %}
 {%- else %}
@@ -952,6 +1128,11 @@ if __name__ == "__main__":
     # request or response
     op_type = msg["type"]
 
+    # versions with the compact encodings and the tagged fields of KIP-482
+    flexible = None
+    if msg["flexibleVersions"] != "none":
+        flexible = VersionRange(msg["flexibleVersions"])
+
     with open(hdr, 'w') as f:
         f.write(
             jinja2.Template(HEADER_TEMPLATE).render(
@@ -963,4 +1144,5 @@ if __name__ == "__main__":
         f.write(
             jinja2.Template(SOURCE_TEMPLATE).render(struct=struct,
                                                     header=hdr.name,
-                                                    op_type=op_type))
+                                                    op_type=op_type,
+                                                    flexible=flexible))
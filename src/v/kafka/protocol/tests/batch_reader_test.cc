@@ -13,6 +13,7 @@
 #include "kafka/protocol/batch_reader.h"
 #include "kafka/protocol/exceptions.h"
 #include "kafka/protocol/kafka_batch_adapter.h"
+#include "kafka/protocol/response_writer_utils.h"
 #include "model/fundamental.h"
 #include "redpanda/tests/fixture.h"
 #include "storage/tests/utils/random_batch.h"
@@ -22,6 +23,7 @@
 
 #include <boost/test/tools/old/interface.hpp>
 
+#include <algorithm>
 #include <iterator>
 #include <type_traits>
 
@@ -221,3 +223,30 @@ SEASTAR_THREAD_TEST_CASE(batch_reader_record_batch_reader_impl_fail_magic) {
           return e.error == kafka::error_code::corrupt_message;
       });
 }
+
+SEASTAR_THREAD_TEST_CASE(serialize_data_batch_shares_payload) {
+    auto batch = storage::test::make_random_batch(base_offset, 100, false);
+    std::vector<const char*> large_fragments;
+    for (const auto& f : batch.data()) {
+        if (f.size() >= kafka::response_writer::min_shared_fragment_size) {
+            large_fragments.push_back(f.get());
+        }
+    }
+    BOOST_REQUIRE(!large_fragments.empty());
+
+    iobuf out;
+    kafka::response_writer wr(out);
+    kafka::writer_serialize_batch(wr, std::move(batch));
+
+    // the payload is linked into the output, not copied
+    for (const auto* p : large_fragments) {
+        BOOST_REQUIRE(std::any_of(
+          out.begin(), out.end(), [p](const auto& f) { return f.get() == p; }));
+    }
+
+    auto crs = kafka::batch_reader(std::move(out));
+    auto kba = crs.consume_batch();
+    BOOST_REQUIRE(kba.v2_format);
+    BOOST_REQUIRE(kba.valid_crc);
+    BOOST_REQUIRE(crs.empty());
+}
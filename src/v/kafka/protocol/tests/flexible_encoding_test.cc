@@ -0,0 +1,89 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "bytes/iobuf.h"
+#include "kafka/protocol/request_reader.h"
+#include "kafka/protocol/response_writer.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+#include <boost/test/unit_test.hpp>
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(unsigned_varint_encoding) {
+    iobuf buf;
+    kafka::response_writer wr(buf);
+    // one byte up to 127, as in the kafka protocol
+    BOOST_REQUIRE_EQUAL(wr.write_unsigned_varint(0), 1);
+    BOOST_REQUIRE_EQUAL(wr.write_unsigned_varint(127), 1);
+    BOOST_REQUIRE_EQUAL(wr.write_unsigned_varint(128), 2);
+    BOOST_REQUIRE_EQUAL(wr.write_unsigned_varint(300), 2);
+
+    kafka::request_reader rd(std::move(buf));
+    BOOST_REQUIRE_EQUAL(rd.read_unsigned_varint(), 0);
+    BOOST_REQUIRE_EQUAL(rd.read_unsigned_varint(), 127);
+    BOOST_REQUIRE_EQUAL(rd.read_unsigned_varint(), 128);
+    BOOST_REQUIRE_EQUAL(rd.read_unsigned_varint(), 300);
+}
+
+BOOST_AUTO_TEST_CASE(compact_strings_and_arrays_roundtrip) {
+    iobuf buf;
+    kafka::response_writer wr(buf);
+    // a length of 5 + 1, then the bytes
+    BOOST_REQUIRE_EQUAL(wr.write_compact(ss::sstring("hello")), 6);
+    wr.write_compact(std::optional<ss::sstring>());
+    wr.write_compact(std::optional<ss::sstring>("world"));
+    std::vector<int32_t> values{1, 2, 3};
+    wr.write_compact_array(
+      values, [](int32_t v, kafka::response_writer& w) { w.write(v); });
+    std::optional<std::vector<int32_t>> none;
+    wr.write_compact_nullable_array(
+      none, [](int32_t v, kafka::response_writer& w) { w.write(v); });
+
+    kafka::request_reader rd(std::move(buf));
+    BOOST_REQUIRE_EQUAL(rd.read_compact_string(), "hello");
+    BOOST_REQUIRE(!rd.read_compact_nullable_string());
+    BOOST_REQUIRE_EQUAL(*rd.read_compact_nullable_string(), "world");
+    auto read = rd.read_compact_array(
+      [](kafka::request_reader& r) { return r.read_int32(); });
+    BOOST_REQUIRE(read == values);
+    BOOST_REQUIRE(!rd.read_compact_nullable_array(
+      [](kafka::request_reader& r) { return r.read_int32(); }));
+    BOOST_REQUIRE_EQUAL(rd.bytes_left(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(tagged_fields_roundtrip) {
+    iobuf buf;
+    kafka::response_writer wr(buf);
+    std::vector<std::pair<uint32_t, iobuf>> tags;
+    for (uint32_t tag : {0, 7}) {
+        iobuf value;
+        kafka::response_writer vw(value);
+        vw.write(int16_t(tag + 10));
+        tags.emplace_back(tag, std::move(value));
+    }
+    wr.write_tags(std::move(tags));
+    wr.write_tags();
+    wr.write(int32_t(42));
+
+    kafka::request_reader rd(std::move(buf));
+    std::optional<int16_t> known;
+    rd.read_tags([&known](uint32_t tag, kafka::request_reader& r) {
+        // the value of the unknown tag 7 is skipped
+        if (tag == 0) {
+            known = r.read_int16();
+        }
+    });
+    BOOST_REQUIRE_EQUAL(known.value_or(-1), 10);
+    rd.skip_tags();
+    BOOST_REQUIRE_EQUAL(rd.read_int32(), 42);
+}
@@ -0,0 +1,203 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "bytes/iobuf.h"
+#include "hashing/crc32c.h"
+#include "kafka/protocol/kafka_batch_adapter.h"
+#include "kafka/protocol/response_writer.h"
+#include "utils/vint.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+#include <boost/test/tools/old/interface.hpp>
+
+#include <cstdint>
+
+namespace {
+
+struct batch_spec {
+    int16_t attrs{0};
+    int32_t last_offset_delta{0};
+    int32_t record_count{0};
+    iobuf records;
+};
+
+void append_vint(iobuf& buf, int64_t v) {
+    auto b = vint::to_bytes(v);
+    // NOLINTNEXTLINE
+    buf.append(reinterpret_cast<const char*>(b.data()), b.size());
+}
+
+/// a record with a null key and value and no headers, prefixed by its length
+void append_record(iobuf& buf, int32_t offset_delta) {
+    iobuf record;
+    record.append("\0", 1); // attributes
+    append_vint(record, 0); // timestamp delta
+    append_vint(record, offset_delta);
+    append_vint(record, -1); // key length
+    append_vint(record, -1); // value length
+    append_vint(record, 0);  // header count
+    append_vint(buf, int64_t(record.size_bytes()));
+    buf.append(std::move(record));
+}
+
+iobuf make_records(int32_t count) {
+    iobuf records;
+    for (int32_t i = 0; i < count; ++i) {
+        append_record(records, i);
+    }
+    return records;
+}
+
+/// a kafka v2 batch on the wire with a valid crc
+iobuf make_kafka_batch(batch_spec spec) {
+    iobuf crc_region;
+    kafka::response_writer body(crc_region);
+    body.write(spec.attrs);
+    body.write(spec.last_offset_delta);
+    body.write(int64_t(0));  // first timestamp
+    body.write(int64_t(0));  // max timestamp
+    body.write(int64_t(-1)); // producer id
+    body.write(int16_t(-1)); // producer epoch
+    body.write(int32_t(-1)); // base sequence
+    body.write(spec.record_count);
+    crc_region.append(std::move(spec.records));
+
+    crc32 crc;
+    for (const auto& f : crc_region) {
+        crc.extend(f.get(), f.size());
+    }
+
+    iobuf batch;
+    kafka::response_writer w(batch);
+    w.write(int64_t(0)); // base offset
+    // everything after the length: leader epoch, magic, crc and the rest
+    w.write(int32_t(
+      sizeof(int32_t) + sizeof(int8_t) + sizeof(int32_t)
+      + crc_region.size_bytes()));
+    w.write(int32_t(0)); // partition leader epoch
+    w.write(int8_t(2));  // magic
+    w.write(int32_t(crc.value()));
+    batch.append(std::move(crc_region));
+    return batch;
+}
+
+kafka::kafka_batch_adapter adapt(batch_spec spec) {
+    kafka::kafka_batch_adapter kba;
+    auto remainder = kba.adapt(make_kafka_batch(std::move(spec)));
+    BOOST_REQUIRE(remainder.empty());
+    BOOST_REQUIRE(kba.v2_format);
+    BOOST_REQUIRE(kba.valid_crc);
+    return kba;
+}
+
+} // namespace
+
+SEASTAR_THREAD_TEST_CASE(adapt_well_framed_records) {
+    auto kba = adapt(batch_spec{
+      .last_offset_delta = 2, .record_count = 3, .records = make_records(3)});
+    BOOST_REQUIRE(kba.batch);
+    BOOST_REQUIRE_EQUAL(kba.batch->record_count(), 3);
+    BOOST_REQUIRE(!kba.batch->compressed());
+}
+
+SEASTAR_THREAD_TEST_CASE(reject_truncated_record_length) {
+    auto records = make_records(1);
+    // a varint continuation byte with nothing after it
+    records.append("\x80", 1);
+    auto kba = adapt(batch_spec{
+      .last_offset_delta = 1,
+      .record_count = 2,
+      .records = std::move(records),
+    });
+    BOOST_REQUIRE(!kba.batch);
+}
+
+SEASTAR_THREAD_TEST_CASE(reject_overlong_record) {
+    iobuf records = make_records(1);
+    // the length runs past the end of the records
+    append_vint(records, 64);
+    records.append("\0\0\0\0\0\0", 6);
+    auto kba = adapt(batch_spec{
+      .last_offset_delta = 1,
+      .record_count = 2,
+      .records = std::move(records),
+    });
+    BOOST_REQUIRE(!kba.batch);
+}
+
+SEASTAR_THREAD_TEST_CASE(reject_more_records_than_the_count) {
+    auto kba = adapt(batch_spec{
+      .last_offset_delta = 1, .record_count = 2, .records = make_records(3)});
+    BOOST_REQUIRE(!kba.batch);
+}
+
+SEASTAR_THREAD_TEST_CASE(reject_trailing_bytes) {
+    auto records = make_records(2);
+    // not enough left for another record
+    records.append("\0\0", 2);
+    auto kba = adapt(batch_spec{
+      .last_offset_delta = 1,
+      .record_count = 2,
+      .records = std::move(records),
+    });
+    BOOST_REQUIRE(!kba.batch);
+}
+
+namespace {
+// the records of a compressed batch stay opaque to the adapter
+iobuf compressed_records() {
+    iobuf records;
+    records.append("not really gzip", 15);
+    return records;
+}
+constexpr int16_t gzip_attrs = 1;
+} // namespace
+
+SEASTAR_THREAD_TEST_CASE(adapt_compressed_batch) {
+    auto kba = adapt(batch_spec{
+      .attrs = gzip_attrs,
+      .last_offset_delta = 2,
+      .record_count = 3,
+      .records = compressed_records(),
+    });
+    BOOST_REQUIRE(kba.batch);
+    BOOST_REQUIRE(kba.batch->compressed());
+    BOOST_REQUIRE_EQUAL(kba.batch->record_count(), 3);
+}
+
+SEASTAR_THREAD_TEST_CASE(reject_compressed_negative_record_count) {
+    auto kba = adapt(batch_spec{
+      .attrs = gzip_attrs,
+      .last_offset_delta = 2,
+      .record_count = -1,
+      .records = compressed_records(),
+    });
+    BOOST_REQUIRE(!kba.batch);
+}
+
+SEASTAR_THREAD_TEST_CASE(reject_compressed_offset_delta_below_count) {
+    auto kba = adapt(batch_spec{
+      .attrs = gzip_attrs,
+      .last_offset_delta = 1,
+      .record_count = 3,
+      .records = compressed_records(),
+    });
+    BOOST_REQUIRE(!kba.batch);
+}
+
+SEASTAR_THREAD_TEST_CASE(reject_unknown_compression) {
+    auto kba = adapt(batch_spec{
+      .attrs = 5,
+      .last_offset_delta = 2,
+      .record_count = 3,
+      .records = compressed_records(),
+    });
+    BOOST_REQUIRE(!kba.batch);
+}
@@ -0,0 +1,89 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "bytes/iobuf.h"
+#include "kafka/protocol/response_writer.h"
+#include "kafka/server/response.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+#include <boost/test/unit_test.hpp>
+
+#include <iterator>
+#include <optional>
+#include <vector>
+
+namespace {
+
+struct partition {
+    int32_t id;
+    std::optional<ss::sstring> metadata;
+    iobuf records;
+};
+
+// a bit of everything the writer encodes
+void encode(std::vector<partition>& partitions, kafka::response_writer& w) {
+    w.write(int32_t(0));
+    w.write(ss::sstring("topic"));
+    w.write_array(partitions, [](partition& p, kafka::response_writer& w) {
+        w.write(p.id);
+        w.write(p.metadata);
+        w.write_compact(p.metadata);
+        w.write_varint(p.id);
+        w.write_bytes_wrapped([&p](kafka::response_writer& w) {
+            w.write_direct(p.records.share(0, p.records.size_bytes()));
+            return false;
+        });
+        w.write(std::optional<iobuf>(p.records.copy()));
+    });
+}
+
+std::vector<partition> make_partitions(int32_t count) {
+    std::vector<partition> partitions;
+    for (int32_t i = 0; i < count; ++i) {
+        partition p{.id = i * 1000};
+        if (i % 2) {
+            p.metadata = ss::sstring(i % 100, 'x');
+        }
+        p.records.append(ss::sstring(i % 13, 'r').data(), i % 13);
+        partitions.push_back(std::move(p));
+    }
+    return partitions;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(size_only_writer_counts_the_encoding) {
+    auto partitions = make_partitions(500);
+    kafka::response_writer sizer(kafka::response_writer::size_only{});
+    encode(partitions, sizer);
+
+    iobuf buf;
+    kafka::response_writer wr(buf);
+    encode(partitions, wr);
+    BOOST_REQUIRE_EQUAL(sizer.size_bytes(), buf.size_bytes());
+    BOOST_REQUIRE_EQUAL(wr.size_bytes(), buf.size_bytes());
+}
+
+BOOST_AUTO_TEST_CASE(presized_response_is_written_in_one_fragment) {
+    auto partitions = make_partitions(500);
+    iobuf expected;
+    kafka::response_writer wr(expected);
+    encode(partitions, wr);
+    BOOST_REQUIRE_LT(
+      expected.size_bytes(), details::io_allocation_size::max_chunk_size);
+    BOOST_REQUIRE_GT(std::distance(expected.begin(), expected.end()), 1);
+
+    kafka::response resp;
+    resp.encode_presized([&partitions](kafka::response_writer& w) {
+        encode(partitions, w);
+    });
+    BOOST_REQUIRE_EQUAL(std::distance(resp.buf().begin(), resp.buf().end()), 1);
+    BOOST_REQUIRE(resp.buf() == expected);
+}
@@ -14,6 +14,8 @@
 #include "model/metadata.h"
 #include "utils/concepts-enabled.h"
 
+#include <type_traits>
+
 namespace kafka {
 
 static constexpr model::node_id consumer_replica_id{-1};
@@ -28,4 +30,27 @@ concept KafkaApi = requires (T request) {
 )
 // clang-format on
 
+template<typename T, typename = void>
+struct has_min_flexible : std::false_type {};
+
+template<typename T>
+struct has_min_flexible<T, std::void_t<decltype(T::min_flexible)>>
+  : std::true_type {};
+
+/**
+ * Whether a request of the given api and version uses the flexible encoding
+ * of KIP-482, and with it the request header v2 and the response header v1,
+ * which carry tagged fields after the client id and the correlation id. An
+ * api declares its first flexible version as `min_flexible` once its handler
+ * supports it.
+ */
+template<typename Api>
+constexpr bool is_flexible(api_version version) {
+    if constexpr (has_min_flexible<Api>::value) {
+        return version >= Api::min_flexible;
+    } else {
+        return false;
+    }
+}
+
 } // namespace kafka
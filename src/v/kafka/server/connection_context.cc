@@ -11,10 +11,14 @@
 #include "kafka/server/connection_context.h"
 
 #include "config/configuration.h"
+#include "kafka/server/cpu_accounting.h"
+#include "kafka/protocol/fetch.h"
+#include "kafka/protocol/produce.h"
 #include "kafka/server/protocol.h"
 #include "kafka/server/protocol_utils.h"
 #include "kafka/server/quota_manager.h"
 #include "kafka/server/request_context.h"
+#include "utils/stage_latency.h"
 
 #include <seastar/core/scattered_message.hh>
 #include <seastar/core/sleep.hh>
@@ -49,9 +53,18 @@ bool connection_context::is_finished_parsing() const {
     return _rs.conn->input().eof() || _rs.abort_requested();
 }
 
+std::string_view connection_context::quota_principal() const {
+    if (_sasl.complete() && _sasl.has_mechanism()) {
+        return _sasl.principal();
+    }
+    return {};
+}
+
 ss::future<connection_context::session_resources>
 connection_context::throttle_request(
-  std::optional<std::string_view> client_id, size_t request_size) {
+  std::optional<std::string_view> client_id,
+  api_key key,
+  size_t request_size) {
     // update the throughput tracker for this client using the
     // size of the current request and return any computed delay
     // to apply for quota throttling.
@@ -66,24 +79,69 @@ connection_context::throttle_request(
     auto delay = _proto.quota_mgr().record_tp_and_throttle(
       client_id, request_size);
 
+    // produce, fetch and request quotas hold the request until the client is
+    // back in its budget
+    auto& qm = _proto.quota_mgr();
+    auto quota_delay = qm.record_and_throttle(
+      quota_type::requests, client_id, quota_principal(), 1);
+    if (key == produce_api::key) {
+        quota_delay = std::max(
+          quota_delay,
+          qm.record_and_throttle(
+            quota_type::produce_bytes,
+            client_id,
+            quota_principal(),
+            request_size));
+    }
+    quota_delay = std::max(quota_delay, std::exchange(_fetch_quota_delay, {}));
+
+    auto wait = delay.first_violation ? ss::lowres_clock::duration(0)
+                                      : delay.duration;
+    wait = std::max(wait, quota_delay);
+    delay.duration = std::max(delay.duration, quota_delay);
+
+    std::optional<stage_latency::clock_type::time_point> throttle_started;
+    if (key == produce_api::key || key == fetch_api::key) {
+        throttle_started = stage_latencies().start();
+    }
     auto fut = ss::now();
-    if (!delay.first_violation) {
-        fut = ss::sleep_abortable(delay.duration, _rs.abort_source());
+    if (wait.count() > 0) {
+        fut = ss::sleep_abortable(wait, _rs.abort_source());
     }
-    return fut
-      .then(
-        [this, request_size] { return reserve_request_units(request_size); })
-      .then([this, delay](ss::semaphore_units<> units) {
+    // requests of a pipelining client are read and handled concurrently up to
+    // the in flight limit, each one holding its own memory units
+    std::optional<ss::sstring> client;
+    if (client_id) {
+        client = ss::sstring(*client_id);
+    }
+    return fut.then([this] { return ss::get_units(_inflight, 1); })
+      .then([this, key, client = std::move(client), request_size](
+              ss::semaphore_units<> inflight) {
+          return reserve_request_units(key, client, request_size)
+            .then([inflight = std::move(inflight)](
+                    ss::semaphore_units<> memlocks) mutable {
+                return std::make_pair(std::move(inflight), std::move(memlocks));
+            });
+      })
+      .then([this, delay, throttle_started](auto units) {
+          stage_latencies().record(
+            request_stage::quota_throttle, throttle_started);
           return session_resources{
             .backpressure_delay = delay.duration,
-            .memlocks = std::move(units),
+            .inflight = std::move(units.first),
+            .memlocks = std::move(units.second),
             .method_latency = _rs.hist().auto_measure(),
           };
       });
 }
 
-ss::future<ss::semaphore_units<>>
-connection_context::reserve_request_units(size_t size) {
+size_t connection_context::max_inflight_requests() {
+    auto max = config::shard_local_cfg().kafka_max_inflight_requests();
+    return max == 0 ? ss::semaphore::max_counter() : max;
+}
+
+ss::future<ss::semaphore_units<>> connection_context::reserve_request_units(
+  api_key key, std::optional<std::string_view> client_id, size_t size) {
     // Allow for extra copies and bookkeeping
     auto mem_estimate = size * 2 + 8000; // NOLINT
     if (mem_estimate >= (size_t)std::numeric_limits<int32_t>::max()) {
@@ -93,8 +151,22 @@ connection_context::reserve_request_units(size_t size) {
           size,
           mem_estimate));
     }
-    auto fut = ss::get_units(_rs.memory(), mem_estimate);
-    if (_rs.memory().waiters()) {
+    // produce requests are admitted fairly between the clients, the other
+    // requests are small and first come first served
+    auto& admission = _proto.produce_admission();
+    auto fut = [&] {
+        if (key != produce_api::key) {
+            return ss::get_units(_rs.memory(), mem_estimate);
+        }
+        admission.set_weights(
+          config::shard_local_cfg().produce_admission_weights());
+        auto tenant = quota_principal();
+        if (tenant.empty() && client_id) {
+            tenant = *client_id;
+        }
+        return admission.admit(_rs.memory(), tenant, mem_estimate);
+    }();
+    if (_rs.memory().waiters() || admission.queued() > 0) {
         _rs.probe().waiting_for_available_memory();
     }
     return fut;
@@ -102,7 +174,7 @@ connection_context::reserve_request_units(size_t size) {
 
 ss::future<>
 connection_context::dispatch_method_once(request_header hdr, size_t size) {
-    return throttle_request(hdr.client_id, size)
+    return throttle_request(hdr.client_id, hdr.key, size)
       .then([this, hdr = std::move(hdr), size](session_resources sres) mutable {
           if (_rs.abort_requested()) {
               // protect against shutdown behavior
@@ -118,11 +190,15 @@ connection_context::dispatch_method_once(request_header hdr, size_t size) {
                     return;
                 }
                 auto self = shared_from_this();
+                // shared with the handler, which may need the memory for
+                // longer than the processing of the request
+                auto memory = ss::make_lw_shared(std::move(sres.memlocks));
                 auto rctx = request_context(
                   self,
                   std::move(hdr),
                   std::move(buf),
-                  sres.backpressure_delay);
+                  sres.backpressure_delay,
+                  memory);
                 // background process this one full request
                 (void)ss::with_gate(
                   _rs.conn_gate(),
@@ -134,7 +210,7 @@ connection_context::dispatch_method_once(request_header hdr, size_t size) {
                         klog.info, "Detected error processing request: {}", e);
                       self->_rs.conn->shutdown_input();
                   })
-                  .finally([s = std::move(sres), self] {});
+                  .finally([s = std::move(sres), memory, self] {});
             });
       });
 }
@@ -143,18 +219,60 @@ ss::future<> connection_context::do_process(request_context ctx) {
     const auto correlation = ctx.header().correlation;
     const sequence_id seq = _seq_idx;
     _seq_idx = _seq_idx + sequence_id(1);
-    return kafka::process_request(std::move(ctx), _proto.smp_group())
-      .then([this, seq, correlation](response_ptr r) mutable {
+    std::optional<ss::sstring> fetch_client_id;
+    const bool is_fetch = ctx.header().key == fetch_api::key;
+    if (is_fetch && ctx.header().client_id) {
+        fetch_client_id = ss::sstring(*ctx.header().client_id);
+    }
+    ss::sstring client_id = ctx.header().client_id
+                              ? ss::sstring(*ctx.header().client_id)
+                              : ss::sstring("unknown");
+    auto started = cpu_accounting::clock_type::now();
+    auto f = kafka::process_request(std::move(ctx), _proto.smp_group());
+    cpu_time().record_client(
+      client_id, cpu_accounting::clock_type::now() - started);
+    return std::move(f).then(
+      [this, seq, correlation, is_fetch, fetch_client_id](
+        response_ptr r) mutable {
+          if (is_fetch) {
+              _fetch_quota_delay = std::max(
+                _fetch_quota_delay,
+                _proto.quota_mgr().record_and_throttle(
+                  quota_type::fetch_bytes,
+                  fetch_client_id ? std::optional<std::string_view>(
+                    *fetch_client_id)
+                                  : std::nullopt,
+                  quota_principal(),
+                  r->buf().size_bytes()));
+          }
           r->set_correlation(correlation);
+          _queued_response_bytes += r->buf().size_bytes();
           _responses.insert({seq, std::move(r)});
+          account_memory();
           return process_next_response();
       });
 }
 
+void connection_context::account_memory() {
+    if (!_rs.conn) {
+        return;
+    }
+    _rs.conn->set_protocol_memory(
+      sizeof(connection_context)
+      + _responses.capacity() * sizeof(map_t::value_type)
+      + _queued_response_bytes);
+}
+
 ss::future<> connection_context::process_next_response() {
     return ss::repeat([this]() mutable {
         auto it = _responses.find(_next_response);
         if (it == _responses.end()) {
+            if (
+              _responses.empty()
+              && _responses.capacity() > idle_responses_capacity) {
+                map_t().swap(_responses);
+            }
+            account_memory();
             return ss::make_ready_future<ss::stop_iteration>(
               ss::stop_iteration::yes);
         }
@@ -163,6 +281,7 @@ ss::future<> connection_context::process_next_response() {
 
         auto r = std::move(it->second);
         _responses.erase(it);
+        _queued_response_bytes -= r->buf().size_bytes();
         _rs.probe().request_completed();
 
         if (r->is_noop()) {
@@ -173,7 +292,10 @@ ss::future<> connection_context::process_next_response() {
         auto msg = response_as_scattered(std::move(r));
         _rs.probe().add_bytes_sent(msg.size());
         try {
-            return _rs.conn->write(std::move(msg)).then([] {
+            auto write_started = stage_latencies().start();
+            return _rs.conn->write(std::move(msg)).then([write_started] {
+                stage_latencies().record(
+                  request_stage::response_write, write_started);
                 return ss::make_ready_future<ss::stop_iteration>(
                   ss::stop_iteration::no);
             });
@@ -14,6 +14,7 @@
 #include "rpc/server.h"
 #include "seastarx.h"
 #include "security/acl.h"
+#include "security/authorizer.h"
 #include "security/sasl_authentication.h"
 #include "utils/hdr_hist.h"
 #include "utils/named_type.h"
@@ -39,13 +40,19 @@ public:
       protocol& p,
       rpc::server::resources&& r,
       security::sasl_server sasl,
-      bool enable_authorizer) noexcept
+      bool enable_authorizer,
+      ss::sstring local_listener = {}) noexcept
       : _proto(p)
       , _rs(std::move(r))
       , _sasl(std::move(sasl))
       // tests may build a context without a live connection
       , _client_addr(_rs.conn ? _rs.conn->addr.addr() : ss::net::inet_address{})
-      , _enable_authorizer(enable_authorizer) {}
+      , _client_host(_client_addr)
+      , _enable_authorizer(enable_authorizer)
+      , _local_listener(std::move(local_listener))
+      , _inflight(max_inflight_requests()) {
+        account_memory();
+    }
 
     ~connection_context() noexcept = default;
     connection_context(const connection_context&) = delete;
@@ -54,7 +61,11 @@ public:
     connection_context& operator=(connection_context&&) = delete;
 
     protocol& server() { return _proto; }
-    const ss::sstring& listener() const { return _rs.conn->name(); }
+    /// clients of this process without a connection are bound to a listener
+    /// for the addresses of the brokers in the replies
+    const ss::sstring& listener() const {
+        return _rs.conn ? _rs.conn->name() : _local_listener;
+    }
     security::sasl_server& sasl() { return _sasl; }
 
     template<typename T>
@@ -65,30 +76,51 @@ public:
         auto user = sasl().principal();
         security::acl_principal principal(
           security::principal_type::user, std::move(user));
-        return _proto.authorizer().authorized(
-          name,
-          operation,
-          std::move(principal),
-          security::acl_host(_client_addr));
+        return _authorized.authorized(
+          _proto.authorizer(), name, operation, principal, _client_host);
     }
 
     ss::future<> process_one_request();
     bool is_finished_parsing() const;
 
+    /// requests are processed under this gate, as is the work they leave in
+    /// the background. the connection is closed once it is done
+    ss::gate& conn_gate() { return _rs.conn_gate(); }
+
+    /// stops reading requests, the client sees the connection closed once
+    /// the inflight requests are done
+    void shutdown_input() {
+        if (_rs.conn) {
+            _rs.conn->shutdown_input();
+        }
+    }
+
 private:
     // used to pass around some internal state
     struct session_resources {
         ss::lowres_clock::duration backpressure_delay;
+        ss::semaphore_units<> inflight;
         ss::semaphore_units<> memlocks;
         std::unique_ptr<hdr_hist::measurement> method_latency;
     };
 
+    /// bound of requests of the connection that are processed concurrently
+    static size_t max_inflight_requests();
+
     /// called by throttle_request
-    ss::future<ss::semaphore_units<>> reserve_request_units(size_t size);
+    ss::future<ss::semaphore_units<>> reserve_request_units(
+      api_key, std::optional<std::string_view> client_id, size_t size);
 
     /// apply correct backpressure sequence
     ss::future<session_resources>
-    throttle_request(std::optional<std::string_view>, size_t sz);
+    throttle_request(std::optional<std::string_view>, api_key, size_t sz);
+
+    /// principal the per user quotas are accounted to
+    std::string_view quota_principal() const;
+
+    /// the memory held for the connection while it is idle and by the
+    /// responses waiting for their turn, reported to the rpc connection
+    void account_memory();
 
     ss::future<> dispatch_method_once(request_header, size_t sz);
     ss::future<> process_next_response();
@@ -97,15 +129,25 @@ private:
 private:
     using sequence_id = named_type<uint64_t, struct kafka_protocol_sequence>;
     using map_t = absl::flat_hash_map<sequence_id, response_ptr>;
+    // a map grown by a burst of pipelined requests is released once drained
+    static constexpr size_t idle_responses_capacity = 8;
 
     protocol& _proto;
     rpc::server::resources _rs;
     sequence_id _next_response;
     sequence_id _seq_idx;
     map_t _responses;
+    size_t _queued_response_bytes{0};
     security::sasl_server _sasl;
     const ss::net::inet_address _client_addr;
+    const security::acl_host _client_host;
+    security::authorization_cache _authorized;
     const bool _enable_authorizer;
+    const ss::sstring _local_listener;
+    ss::semaphore _inflight;
+    // fetch responses are accounted once built, the next request of the
+    // connection waits for the fetch quota
+    ss::lowres_clock::duration _fetch_quota_delay{0};
 };
 
 } // namespace kafka
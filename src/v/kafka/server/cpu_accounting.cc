@@ -0,0 +1,145 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/server/cpu_accounting.h"
+
+#include "kafka/server/logger.h"
+#include "prometheus/prometheus_sanitize.h"
+#include "vlog.h"
+
+#include <seastar/core/metrics.hh>
+
+#include <algorithm>
+
+namespace kafka {
+
+void top_k_counter::add(std::string_view key, uint64_t amount) {
+    if (auto it = _counts.find(key); it != _counts.end()) {
+        it->second += amount;
+        return;
+    }
+    if (_counts.size() < _capacity) {
+        _counts.emplace(ss::sstring(key), amount);
+        return;
+    }
+    auto min = std::min_element(
+      _counts.begin(), _counts.end(), [](const auto& a, const auto& b) {
+          return a.second < b.second;
+      });
+    auto inherited = min->second;
+    _counts.erase(min);
+    _counts.emplace(ss::sstring(key), inherited + amount);
+}
+
+std::vector<top_k_counter::entry> top_k_counter::top(size_t k) const {
+    std::vector<entry> entries(_counts.begin(), _counts.end());
+    k = std::min(k, entries.size());
+    std::partial_sort(
+      entries.begin(),
+      entries.begin() + k,
+      entries.end(),
+      [](const entry& a, const entry& b) { return a.second > b.second; });
+    entries.resize(k);
+    return entries;
+}
+
+std::optional<uint64_t> top_k_counter::count(std::string_view key) const {
+    if (auto it = _counts.find(key); it != _counts.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+cpu_accounting::topic_charge::~topic_charge() noexcept {
+    cpu_time().record_topic(_topic(), clock_type::now() - _started);
+}
+
+void cpu_accounting::record_client(
+  std::string_view client_id, clock_type::duration d) {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    _clients.add(client_id, ns);
+    _total_ns += ns;
+}
+
+void cpu_accounting::record_topic(
+  std::string_view topic, clock_type::duration d) {
+    _topics.add(
+      topic, std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+}
+
+void cpu_accounting::maybe_refresh_ranking() {
+    const auto now = clock_type::now();
+    if (_last_refresh && now - *_last_refresh < refresh_interval) {
+        return;
+    }
+    _last_refresh = now;
+    _top_clients = _clients.top(exported_keys);
+    _top_topics = _topics.top(exported_keys);
+    for (size_t rank = 0; rank < _top_clients.size(); ++rank) {
+        const auto& [key, ns] = _top_clients[rank];
+        vlog(klog.debug, "Client at rank {}: {} {}us", rank, key, ns / 1000);
+    }
+    for (size_t rank = 0; rank < _top_topics.size(); ++rank) {
+        const auto& [key, ns] = _top_topics[rank];
+        vlog(klog.debug, "Topic at rank {}: {} {}us", rank, key, ns / 1000);
+    }
+}
+
+uint64_t cpu_accounting::ranked_us(
+  const top_k_counter& counter, const ranking& top, size_t rank) {
+    maybe_refresh_ranking();
+    if (rank >= top.size()) {
+        return 0;
+    }
+    // an evicted key keeps its count until the next ranking drops it
+    const auto& [key, count] = top[rank];
+    return counter.count(key).value_or(count) / 1000;
+}
+
+void cpu_accounting::setup_metrics() {
+    namespace sm = ss::metrics;
+    std::vector<sm::metric_definition> defs;
+    defs.reserve(2 * exported_keys + 1);
+    defs.push_back(sm::make_derive(
+      "handler_time_us",
+      [this] { return _total_ns / 1000; },
+      sm::description("Reactor time spent handling kafka requests")));
+
+    auto rank_label = sm::label("rank");
+    auto add_ranks = [this, &defs, &rank_label](
+                       const top_k_counter& counter,
+                       const ranking& top,
+                       const char* name,
+                       const char* description) {
+        for (size_t rank = 0; rank < exported_keys; ++rank) {
+            defs.push_back(sm::make_gauge(
+              name,
+              [this, &counter, &top, rank] {
+                  return ranked_us(counter, top, rank);
+              },
+              sm::description(description),
+              {rank_label(rank)}));
+        }
+    };
+    add_ranks(
+      _clients,
+      _top_clients,
+      "client_time_us",
+      "Reactor time spent handling the requests of the client at a rank of "
+      "the heaviest clients");
+    add_ranks(
+      _topics,
+      _top_topics,
+      "topic_time_us",
+      "Reactor time spent in the partitions of the topic at a rank of the "
+      "heaviest topics");
+    _metrics.add_group(prometheus_sanitize::metrics_name("kafka:cpu"), defs);
+}
+
+} // namespace kafka
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+#pragma once
+
+#include "model/fundamental.h"
+#include "seastarx.h"
+#include "utils/absl_sstring_hash.h"
+
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/core/sstring.hh>
+
+#include <absl/container/flat_hash_map.h>
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace kafka {
+
+/**
+ * Approximate heaviest keys of a stream, with the space saving algorithm.
+ *
+ * At most capacity keys are tracked. A new key replaces the one with the
+ * smallest count and inherits that count, so the count of a key is an upper
+ * bound which overestimates it by at most the count it inherited. Keys whose
+ * exact count is larger than the total over capacity are always tracked.
+ */
+class top_k_counter {
+public:
+    using entry = std::pair<ss::sstring, uint64_t>;
+
+    explicit top_k_counter(size_t capacity)
+      : _capacity(capacity) {}
+
+    void add(std::string_view key, uint64_t amount);
+
+    /// The k largest counts, largest first
+    std::vector<entry> top(size_t k) const;
+
+    /// The count of a tracked key
+    std::optional<uint64_t> count(std::string_view key) const;
+
+    size_t size() const { return _counts.size(); }
+
+private:
+    size_t _capacity;
+    // looked up by view, a key is only copied when it starts being tracked
+    absl::flat_hash_map<ss::sstring, uint64_t, sstring_hash, sstring_eq>
+      _counts;
+};
+
+/**
+ * Shard wide accounting of the reactor time spent on kafka requests.
+ *
+ * The time of the synchronous part of handling a request is charged to its
+ * client id, the time a produce or a fetch spends in the partitions on their
+ * home shard to the topic. Continuations which run after a disk or network
+ * wait are not measured, the accounting takes two clock reads per charge.
+ *
+ * The heaviest clients and topics are exported as a fixed set of series, one
+ * per rank from 0 to exported_keys - 1, so the series stay the same while
+ * the keys holding the ranks change. The ranking is taken again at most every
+ * refresh_interval, when a scrape reads it, and the keys holding the ranks
+ * are logged at debug level.
+ */
+class cpu_accounting {
+public:
+    using clock_type = std::chrono::steady_clock;
+    static constexpr size_t tracked_keys = 64;
+    static constexpr size_t exported_keys = 10;
+    static constexpr clock_type::duration refresh_interval
+      = std::chrono::seconds(10);
+
+    /// Charges the time from its construction to its destruction to a topic
+    class topic_charge {
+    public:
+        explicit topic_charge(const model::topic& t) noexcept
+          : _topic(t)
+          , _started(clock_type::now()) {}
+        topic_charge(const topic_charge&) = delete;
+        topic_charge& operator=(const topic_charge&) = delete;
+        topic_charge(topic_charge&&) = delete;
+        topic_charge& operator=(topic_charge&&) = delete;
+        ~topic_charge() noexcept;
+
+    private:
+        const model::topic& _topic;
+        clock_type::time_point _started;
+    };
+
+    cpu_accounting() noexcept = default;
+    cpu_accounting(cpu_accounting&&) = delete;
+    cpu_accounting& operator=(cpu_accounting&&) = delete;
+    cpu_accounting(const cpu_accounting&) = delete;
+    cpu_accounting& operator=(const cpu_accounting&) = delete;
+    ~cpu_accounting() noexcept = default;
+
+    void record_client(std::string_view client_id, clock_type::duration);
+    void record_topic(std::string_view topic, clock_type::duration);
+
+    const top_k_counter& clients() const { return _clients; }
+    const top_k_counter& topics() const { return _topics; }
+
+    /// \brief exports the total handler time and the ranks of the heaviest
+    /// clients and topics, registered once per shard by the application
+    void setup_metrics();
+    /// \brief withdraws the metrics on shutdown, the accounting goes on
+    void stop() { _metrics.clear(); }
+
+private:
+    using ranking = std::vector<top_k_counter::entry>;
+
+    /// The time charged to the key at \p rank of the current ranking
+    uint64_t ranked_us(
+      const top_k_counter&, const ranking&, size_t rank);
+    void maybe_refresh_ranking();
+
+    // nanoseconds, most charges are shorter than a microsecond
+    top_k_counter _clients{tracked_keys};
+    top_k_counter _topics{tracked_keys};
+    uint64_t _total_ns{0};
+    ranking _top_clients;
+    ranking _top_topics;
+    std::optional<clock_type::time_point> _last_refresh;
+    ss::metrics::metric_groups _metrics;
+};
+
+/// \brief the accounting of the shard
+inline cpu_accounting& cpu_time() {
+    static thread_local cpu_accounting accounting;
+    return accounting;
+}
+
+} // namespace kafka
@@ -0,0 +1,134 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/server/fair_admission.h"
+
+#include "kafka/server/logger.h"
+#include "vlog.h"
+
+#include <absl/container/flat_hash_map.h>
+
+#include <algorithm>
+#include <string>
+
+namespace kafka {
+
+// the finish times of idle tenants are dropped once there are more tenants
+static constexpr size_t max_idle_tenants = 1024;
+
+ss::future<> fair_admission::stop() {
+    for (auto& [_, w] : _queue) {
+        w.admitted.set_exception(ss::broken_semaphore());
+    }
+    _queue.clear();
+    return _gate.close();
+}
+
+ss::future<ss::semaphore_units<>> fair_admission::admit(
+  ss::semaphore& sem, std::string_view tenant, size_t units) {
+    if (_gate.is_closed()) {
+        return ss::make_exception_future<ss::semaphore_units<>>(
+          ss::broken_semaphore());
+    }
+    if (_queue.empty() && !_dispatching && sem.try_wait(units)) {
+        return ss::make_ready_future<ss::semaphore_units<>>(
+          ss::semaphore_units<>(sem, units));
+    }
+    ss::sstring name(tenant);
+    auto& finish = _finish[name];
+    const double start = std::max(_virtual_time, finish);
+    finish = start + static_cast<double>(units) / weight(tenant);
+    auto [it, _] = _queue.emplace(
+      tag{finish, _arrivals++},
+      waiter{.sem = &sem, .units = units, .start = start});
+    auto f = it->second.admitted.get_future();
+    dispatch();
+    return f;
+}
+
+void fair_admission::dispatch() {
+    if (_dispatching || _queue.empty() || _gate.is_closed()) {
+        return;
+    }
+    _dispatching = true;
+    auto head = _queue.begin();
+    // one request at a time waits for the units, so that the order of the
+    // admissions is the order of the queue
+    (void)ss::with_gate(_gate, [this, head] {
+        return ss::get_units(*head->second.sem, head->second.units)
+          .then_wrapped([this, key = head->first](
+                          ss::future<ss::semaphore_units<>> f) {
+              admitted(key, std::move(f));
+          });
+    });
+}
+
+void fair_admission::admitted(tag key, ss::future<ss::semaphore_units<>> f) {
+    auto it = _queue.find(key);
+    if (it == _queue.end()) {
+        // failed by stop(), the units go back to the semaphore
+        _dispatching = false;
+        f.ignore_ready_future();
+        return;
+    }
+    auto w = std::move(it->second);
+    _queue.erase(it);
+    _dispatching = false;
+    if (f.failed()) {
+        w.admitted.set_exception(f.get_exception());
+    } else {
+        _virtual_time = std::max(_virtual_time, w.start);
+        w.admitted.set_value(f.get0());
+    }
+    forget_idle_tenants();
+    dispatch();
+}
+
+void fair_admission::forget_idle_tenants() {
+    if (_finish.size() <= max_idle_tenants) {
+        return;
+    }
+    absl::erase_if(_finish, [this](const auto& p) {
+        return p.second <= _virtual_time;
+    });
+}
+
+void fair_admission::set_weights(const std::vector<ss::sstring>& cfg) {
+    if (cfg == _weights_cfg) {
+        return;
+    }
+    _weights_cfg = cfg;
+    _weights.clear();
+    for (const auto& entry : cfg) {
+        auto pos = entry.find_last_of('=');
+        weight_t w = 0;
+        if (pos != ss::sstring::npos && pos > 0) {
+            try {
+                w = std::stoul(std::string(entry.substr(pos + 1)));
+            } catch (...) {
+                w = 0;
+            }
+        }
+        if (w == 0) {
+            vlog(klog.warn, "ignoring malformed admission weight {}", entry);
+            continue;
+        }
+        _weights[entry.substr(0, pos)] = w;
+    }
+}
+
+fair_admission::weight_t
+fair_admission::weight(std::string_view tenant) const {
+    if (auto it = _weights.find(ss::sstring(tenant)); it != _weights.end()) {
+        return it->second;
+    }
+    return default_weight;
+}
+
+} // namespace kafka
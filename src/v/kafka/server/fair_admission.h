@@ -0,0 +1,99 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+#pragma once
+
+#include "seastarx.h"
+
+#include <seastar/core/future.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/semaphore.hh>
+#include <seastar/core/sstring.hh>
+
+#include <absl/container/btree_map.h>
+#include <absl/container/flat_hash_map.h>
+
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace kafka {
+
+/**
+ * Weighted fair admission of requests to the memory units of a shard.
+ *
+ * A request which finds enough units and nobody queued takes its units right
+ * away. Otherwise it is queued and the queued requests are admitted one at a
+ * time in the order of their virtual finish time (start-time fair queuing):
+ * the request of a tenant starts at the later of the virtual time and the
+ * finish of the previous request of the tenant, and finishes units / weight
+ * later. The virtual time is the start of the last admitted request.
+ *
+ * A tenant pipelining large requests so queues behind its own requests while
+ * the requests of the other tenants keep their place, in proportion of the
+ * weights.
+ *
+ * The kafka protocol of the shard owns it and stops it when the server
+ * stops, after the connections are closed.
+ */
+class fair_admission {
+public:
+    using weight_t = uint32_t;
+    static constexpr weight_t default_weight = 1;
+
+    fair_admission() noexcept = default;
+    fair_admission(fair_admission&&) = delete;
+    fair_admission& operator=(fair_admission&&) = delete;
+    fair_admission(const fair_admission&) = delete;
+    fair_admission& operator=(const fair_admission&) = delete;
+    ~fair_admission() noexcept = default;
+
+    /// Fails the queued requests with ss::broken_semaphore and waits for the
+    /// request waiting on the semaphore, which gives its units back
+    ss::future<> stop();
+
+    /// The units of a request of the tenant. The semaphore must be the same
+    /// for all the requests and outlive them. Fails with ss::broken_semaphore
+    /// once stopped
+    ss::future<ss::semaphore_units<>>
+    admit(ss::semaphore&, std::string_view tenant, size_t units);
+
+    /// Weights as name=weight entries, malformed entries are ignored
+    void set_weights(const std::vector<ss::sstring>&);
+    weight_t weight(std::string_view tenant) const;
+
+    size_t queued() const { return _queue.size(); }
+
+private:
+    struct waiter {
+        ss::semaphore* sem;
+        size_t units;
+        double start;
+        ss::promise<ss::semaphore_units<>> admitted;
+    };
+    // finish time, then arrival order among equal finish times
+    using tag = std::pair<double, uint64_t>;
+
+    void forget_idle_tenants();
+    void dispatch();
+    void admitted(tag, ss::future<ss::semaphore_units<>>);
+
+    absl::btree_map<tag, waiter> _queue;
+    absl::flat_hash_map<ss::sstring, double> _finish;
+    absl::flat_hash_map<ss::sstring, weight_t> _weights;
+    std::vector<ss::sstring> _weights_cfg;
+    double _virtual_time{0};
+    uint64_t _arrivals{0};
+    bool _dispatching{false};
+    ss::gate _gate;
+};
+
+} // namespace kafka
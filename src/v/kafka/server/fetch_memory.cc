@@ -0,0 +1,86 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/server/fetch_memory.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace kafka {
+
+fetch_read_memory::reservation::reservation(
+  fetch_read_memory& budget,
+  ss::semaphore_units<> units,
+  size_t granted) noexcept
+  : _budget(&budget)
+  , _units(std::move(units))
+  , _granted(granted) {
+    ++_budget->_active;
+}
+
+fetch_read_memory::reservation::reservation(reservation&& o) noexcept
+  : _budget(std::exchange(o._budget, nullptr))
+  , _units(std::move(o._units))
+  , _granted(o._granted) {}
+
+fetch_read_memory::reservation&
+fetch_read_memory::reservation::operator=(reservation&& o) noexcept {
+    if (this != &o) {
+        if (_budget) {
+            --_budget->_active;
+        }
+        _budget = std::exchange(o._budget, nullptr);
+        _units = std::move(o._units);
+        _granted = o._granted;
+    }
+    return *this;
+}
+
+fetch_read_memory::reservation::~reservation() noexcept {
+    if (_budget) {
+        --_budget->_active;
+    }
+}
+
+void fetch_read_memory::reservation::resize(size_t bytes) {
+    if (!_budget) {
+        return;
+    }
+    const auto held = _units.count();
+    if (bytes < held) {
+        _units.return_units(held - bytes);
+    } else if (bytes > held) {
+        _units.adopt(ss::consume_units(_budget->_sem, bytes - held));
+    }
+}
+
+void fetch_read_memory::set_capacity(size_t capacity) {
+    if (capacity > _capacity) {
+        _sem.signal(capacity - _capacity);
+    } else if (capacity < _capacity) {
+        // the available units go negative while the reservations held are
+        // over the new capacity
+        _sem.consume(_capacity - capacity);
+    }
+    _capacity = capacity;
+}
+
+fetch_read_memory::reservation fetch_read_memory::reserve(size_t wanted) {
+    if (_capacity == 0) {
+        return reservation(wanted);
+    }
+    // the share counts the fetch being reserved
+    const size_t share = _capacity / (_active + 1);
+    const size_t available = std::max<ssize_t>(_sem.available_units(), 0);
+    const size_t granted = std::min(
+      wanted, std::max(min_grant, std::min(share, available)));
+    return reservation(*this, ss::consume_units(_sem, granted), granted);
+}
+
+} // namespace kafka
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+#pragma once
+
+#include "seastarx.h"
+#include "units.h"
+
+#include <seastar/core/semaphore.hh>
+
+#include <cstddef>
+
+namespace kafka {
+
+/**
+ * Shard wide budget of the memory held by the data fetches read on the
+ * shard, from the read until it is serialized in the responses on the
+ * connection shard.
+ *
+ * Concurrent fetches share the budget evenly: a fetch is granted at most its
+ * share of the capacity and what other fetches left of it, and reads less
+ * per partition when that is less than it wants. A fetch is always granted
+ * min_grant so that it makes progress, the budget is only exceeded by those
+ * grants and by reads which return more than their limit to make progress.
+ *
+ * A capacity of 0 disables the budget, every fetch is granted what it wants.
+ */
+class fetch_read_memory {
+public:
+    static constexpr size_t min_grant = 64_KiB;
+
+    /// Memory held by a fetch, released on destruction. It must be destroyed
+    /// on the shard of its budget
+    class reservation {
+    public:
+        explicit reservation(size_t granted) noexcept
+          : _granted(granted) {}
+        reservation(
+          fetch_read_memory&, ss::semaphore_units<>, size_t granted) noexcept;
+        reservation(reservation&&) noexcept;
+        reservation& operator=(reservation&&) noexcept;
+        reservation(const reservation&) = delete;
+        reservation& operator=(const reservation&) = delete;
+        ~reservation() noexcept;
+
+        /// bytes the fetch may read
+        size_t granted() const { return _granted; }
+
+        /// bytes held from the budget
+        size_t held() const { return _units.count(); }
+
+        /// holds the bytes the fetch actually read, returning what it did
+        /// not use to the other fetches
+        void resize(size_t);
+
+    private:
+        fetch_read_memory* _budget{nullptr};
+        ss::semaphore_units<> _units;
+        size_t _granted;
+    };
+
+    fetch_read_memory() noexcept = default;
+    explicit fetch_read_memory(size_t capacity) { set_capacity(capacity); }
+    fetch_read_memory(fetch_read_memory&&) = delete;
+    fetch_read_memory& operator=(fetch_read_memory&&) = delete;
+    fetch_read_memory(const fetch_read_memory&) = delete;
+    fetch_read_memory& operator=(const fetch_read_memory&) = delete;
+    ~fetch_read_memory() noexcept = default;
+
+    /// follows the configured capacity, reservations held are kept
+    void set_capacity(size_t);
+
+    /// reserves up to the wanted bytes for a fetch
+    reservation reserve(size_t wanted);
+
+    size_t capacity() const { return _capacity; }
+    size_t active_fetches() const { return _active; }
+
+private:
+    size_t _capacity{0};
+    ss::semaphore _sem{0};
+    size_t _active{0};
+};
+
+inline fetch_read_memory& fetch_memory() {
+    static thread_local fetch_read_memory memory;
+    return memory;
+}
+
+} // namespace kafka
@@ -27,7 +27,14 @@ struct fetch_partition {
     model::partition_id partition;
     int32_t max_bytes;
     model::offset fetch_offset;
+    // the leader epoch the consumer knows, -1 when it doesn't
+    int32_t current_leader_epoch{-1};
     model::offset high_watermark;
+    /*
+     * set in fetch sessions once a read reached the high watermark and no new
+     * data became visible since, incremental fetches do not read the partition
+     */
+    bool caught_up = false;
 };
 /**
  * Map of partitions that is kept by fetch session. This map is using intrusive
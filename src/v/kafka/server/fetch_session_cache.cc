@@ -19,6 +19,7 @@ static fetch_partition make_fetch_partition(
       .partition = p.id,
       .max_bytes = p.partition_max_bytes,
       .fetch_offset = p.fetch_offset,
+      .current_leader_epoch = p.current_leader_epoch,
       .high_watermark = model::offset(-1),
     };
 }
@@ -27,12 +28,20 @@ void update_fetch_session(fetch_session& session, const fetch_request& req) {
     for (auto it = req.cbegin(); it != req.cend(); ++it) {
         auto& topic = *it->topic;
         auto& partition = *it->partition;
-        model::topic_partition tp(topic.name, partition.id);
+        // a view, the name is only copied for the partitions new to the
+        // session
+        model::topic_partition_view tp(topic.name, partition.id);
 
         if (auto s_it = session.partitions().find(tp);
             s_it != session.partitions().end()) {
-            s_it->second->partition.max_bytes = partition.partition_max_bytes;
-            s_it->second->partition.fetch_offset = partition.fetch_offset;
+            auto& fp = s_it->second->partition;
+            fp.max_bytes = partition.partition_max_bytes;
+            if (fp.fetch_offset != partition.fetch_offset) {
+                // consumer seeked, the partition has to be read again
+                fp.caught_up = false;
+            }
+            fp.fetch_offset = partition.fetch_offset;
+            fp.current_leader_epoch = partition.current_leader_epoch;
         } else {
             session.partitions().emplace(
               make_fetch_partition(topic.name, partition));
@@ -41,7 +50,6 @@ void update_fetch_session(fetch_session& session, const fetch_request& req) {
 
     for (auto& ft : req.forgotten_topics) {
         for (auto& fp : ft.partitions) {
-            model::topic_partition tp(ft.name, model::partition_id(fp));
             session.partitions().erase(
               model::topic_partition_view(ft.name, model::partition_id(fp)));
         }
@@ -49,8 +57,9 @@ void update_fetch_session(fetch_session& session, const fetch_request& req) {
 }
 
 fetch_session_cache::fetch_session_cache(
-  std::chrono::milliseconds eviction_timeout)
-  : _min_session_id(max_sessions_per_core() * seastar::this_shard_id())
+  std::chrono::milliseconds eviction_timeout, size_t max_mem_usage)
+  : _max_mem_usage(max_mem_usage)
+  , _min_session_id(max_sessions_per_core() * seastar::this_shard_id())
   , _max_session_id(max_sessions_per_core() + _min_session_id - 1)
   , _last_session_id(_min_session_id)
   , _session_eviction_duration(eviction_timeout) {
@@ -144,7 +153,7 @@ fetch_session_cache::maybe_get_session(const fetch_request& req) {
 // we split whole range from 1 to max int32_t betewen all shards
 std::optional<fetch_session_id> fetch_session_cache::new_session_id() {
     if (unlikely(
-          mem_usage() > max_mem_usage
+          mem_usage() > _max_mem_usage
           || _sessions.size() > max_sessions_per_core())) {
         return std::nullopt;
     }
@@ -188,6 +197,11 @@ void fetch_session_cache::register_metrics() {
          "mem_usage_bytes",
          [this] { return mem_usage(); },
          sm::description("Fetch sessions cache memory usage in bytes")),
+       sm::make_gauge(
+         "max_mem_usage_bytes",
+         [this] { return _max_mem_usage; },
+         sm::description(
+           "Memory usage above which no new fetch sessions are created")),
        sm::make_gauge(
          "sessions_count",
          [this] { return _sessions.size(); },
@@ -30,11 +30,16 @@ struct fetch_request;
  *
  * The cache evicts not used sessions after configurable period of inactivity.
  * Fetch session cache will stop adding new sessions after its max memory usage
- * is reached.
+ * is reached, the budget is a share of the core memory assigned by the
+ * application.
  **/
 class fetch_session_cache {
 public:
-    explicit fetch_session_cache(std::chrono::milliseconds);
+    static constexpr size_t default_max_mem_usage = 10_MiB;
+
+    explicit fetch_session_cache(
+      std::chrono::milliseconds,
+      size_t max_mem_usage = default_max_mem_usage);
     fetch_session_ctx maybe_get_session(const fetch_request& req);
     size_t size() const { return _sessions.size(); }
 
@@ -42,8 +47,6 @@ private:
     using underlying_t
       = absl::flat_hash_map<fetch_session_id, fetch_session_ptr>;
 
-    static constexpr size_t max_mem_usage = 10_MiB;
-
     // used to split range of possible session ids to limit memory size we use
     // max_mem_used, this is theoretical limit, the actual number of session
     // held in a cache on single core is limitted by the memory usage.
@@ -65,6 +68,7 @@ private:
     void register_metrics();
 
     underlying_t _sessions;
+    const size_t _max_mem_usage;
     const fetch_session_id _min_session_id;
     const fetch_session_id _max_session_id;
     fetch_session_id _last_session_id;
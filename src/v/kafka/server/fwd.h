@@ -18,6 +18,7 @@ class fetch_session_cache;
 class group_manager;
 class group_router;
 class request_context;
+struct request_header;
 class quota_manager;
 
 } // namespace kafka
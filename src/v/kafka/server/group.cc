@@ -50,7 +50,8 @@ group::group(
   kafka::group_id id,
   group_state s,
   config::configuration& conf,
-  ss::lw_shared_ptr<cluster::partition> partition)
+  ss::lw_shared_ptr<cluster::partition> partition,
+  ss::lw_shared_ptr<offset_commit_batcher> commits)
   : _id(std::move(id))
   , _state(s)
   , _state_timestamp(clock_type::now())
@@ -58,18 +59,21 @@ group::group(
   , _num_members_joining(0)
   , _new_member_added(false)
   , _conf(conf)
-  , _partition(std::move(partition)) {}
+  , _partition(std::move(partition))
+  , _commits(std::move(commits)) {}
 
 group::group(
   kafka::group_id id,
   group_log_group_metadata& md,
   config::configuration& conf,
-  ss::lw_shared_ptr<cluster::partition> partition)
+  ss::lw_shared_ptr<cluster::partition> partition,
+  ss::lw_shared_ptr<offset_commit_batcher> commits)
   : _id(std::move(id))
   , _num_members_joining(0)
   , _new_member_added(false)
   , _conf(conf)
-  , _partition(std::move(partition)) {
+  , _partition(std::move(partition))
+  , _commits(std::move(commits)) {
     _state = md.members.empty() ? group_state::empty : group_state::stable;
     _generation = md.generation;
     _protocol_type = md.protocol_type;
@@ -150,6 +154,10 @@ void group::add_member_no_join(member_ptr member) {
           fmt::format("group already contains member {}", member));
     }
 
+    if (member->group_instance_id()) {
+        _static_members[*member->group_instance_id()] = member->id();
+    }
+
     for (auto& p : member->protocols()) {
         _supported_protocols[p.name]++;
     }
@@ -428,6 +436,20 @@ group::join_group_unknown_member(join_group_request&& r) {
 
     auto new_member_id = group::generate_member_id(r);
 
+    // a static member rejoining, e.g. after a restart, takes over the
+    // membership and the assignment of its previous instance
+    if (r.data.group_instance_id) {
+        if (auto it = _static_members.find(*r.data.group_instance_id);
+            it != _static_members.end()) {
+            klog.trace(
+              "static member {} rejoining with new id {}",
+              *r.data.group_instance_id,
+              new_member_id);
+            return update_static_member_and_rebalance(
+              it->second, std::move(new_member_id), std::move(r));
+        }
+    }
+
     // <kafka>Only return MEMBER_ID_REQUIRED error if joinGroupRequest version
     // is >= 4 and groupInstanceId is configured to unknown.</kafka>
     if (r.version >= api_version(4) && !r.data.group_instance_id) {
@@ -457,6 +479,12 @@ group::join_group_known_member(join_group_request&& r) {
         return make_join_error(
           r.data.member_id, error_code::inconsistent_group_protocol);
 
+    } else if (is_member_fenced(r.data.member_id, r.data.group_instance_id)) {
+        klog.trace(
+          "member {} was replaced by a new instance", r.data.member_id);
+        return make_join_error(
+          r.data.member_id, error_code::fenced_instance_id);
+
     } else if (contains_pending_member(r.data.member_id)) {
         klog.trace("making pending member a regular member");
         kafka::member_id new_member_id = std::move(r.data.member_id);
@@ -610,6 +638,97 @@ group::update_member_and_rebalance(member_ptr member, join_group_request&& r) {
     return response;
 }
 
+member_ptr
+group::replace_static_member(member_ptr old_member, kafka::member_id new_id) {
+    // requests the previous instance has in flight fail, the client stepped
+    // down already
+    try_finish_joining_member(
+      old_member,
+      _make_join_error(old_member->id(), error_code::fenced_instance_id));
+    if (old_member->is_syncing()) {
+        old_member->set_sync_response(
+          sync_group_response(error_code::fenced_instance_id));
+    }
+    old_member->expire_timer().cancel();
+
+    auto state = old_member->state().copy();
+    state.id = std::move(new_id);
+    auto member = ss::make_lw_shared<group_member>(std::move(state), id());
+    _members.erase(old_member->id());
+    _members.emplace(member->id(), member);
+    _static_members[*member->group_instance_id()] = member->id();
+    if (is_leader(old_member->id())) {
+        _leader = member->id();
+    }
+    schedule_next_heartbeat_expiration(member);
+    return member;
+}
+
+ss::future<join_group_response> group::update_static_member_and_rebalance(
+  kafka::member_id old_member_id,
+  kafka::member_id new_member_id,
+  join_group_request&& r) {
+    auto old_member = get_member(old_member_id);
+    auto old_leader = leader();
+    auto member = replace_static_member(old_member, std::move(new_member_id));
+
+    if (
+      in_state(group_state::stable)
+      && r.native_member_protocols() == member->protocols()) {
+        // <kafka>Static member which joins during Stable stage and doesn't
+        // affect selectProtocol will not trigger rebalance.</kafka> the old
+        // leader id is returned so that a rejoining leader does not compute
+        // an assignment the stable group would not distribute.
+        klog.trace("static member {} rejoined without rebalance", member->id());
+
+        // persist the new member id, a recovered group would otherwise fence
+        // the member
+        assignments_type assignments;
+        for (const auto& [mid, m] : _members) {
+            assignments.emplace(mid, m->assignment());
+        }
+        auto reader = model::make_memory_record_batch_reader(
+          checkpoint(assignments));
+        return _partition
+          ->replicate(
+            std::move(reader),
+            raft::replicate_options(raft::consistency_level::quorum_ack))
+          .then([this,
+                 member,
+                 old_member_id = std::move(old_member_id),
+                 old_leader = std::move(old_leader)](
+                  result<raft::replicate_result> r) mutable {
+              if (!r) {
+                  // <kafka>Failed to persist member.id of the given static
+                  // member, revert the update of the static member in the
+                  // group.</kafka> unless another instance replaced it in
+                  // the meantime
+                  vlog(
+                    klog.info,
+                    "failed to persist static member {} of group {} - {}",
+                    member->id(),
+                    id(),
+                    r.error().message());
+                  auto it = _static_members.find(*member->group_instance_id());
+                  if (
+                    it != _static_members.end() && it->second == member->id()
+                    && contains_member(member->id())) {
+                      replace_static_member(member, std::move(old_member_id));
+                  }
+                  return _make_join_error(
+                    kafka::unknown_member_id, error_code::not_coordinator);
+              }
+              return join_group_response(
+                error_code::none,
+                generation(),
+                protocol().value_or(kafka::protocol_name()),
+                old_leader.value_or(kafka::member_id()),
+                member->id());
+          });
+    }
+    return update_member_and_rebalance(member, std::move(r));
+}
+
 void group::try_prepare_rebalance() {
     if (!valid_previous_state(group_state::preparing_rebalance)) {
         klog.trace("skipping prepare rebalance state={}", state());
@@ -867,6 +986,11 @@ void group::remove_member(member_ptr member) {
         }
         vlog(klog.trace, "removing member {}", member->id());
         _members.erase(it);
+        if (
+          auto& iid = member->group_instance_id();
+          iid && !is_member_fenced(member->id(), iid)) {
+            _static_members.erase(*iid);
+        }
     }
 
     if (is_leader(member->id())) {
@@ -911,6 +1035,10 @@ group::handle_sync_group(sync_group_request&& r) {
         klog.trace("group is dead");
         return make_sync_error(error_code::coordinator_not_available);
 
+    } else if (is_member_fenced(r.data.member_id, r.data.group_instance_id)) {
+        klog.trace("member was replaced by a new instance");
+        return make_sync_error(error_code::fenced_instance_id);
+
     } else if (!contains_member(r.data.member_id)) {
         klog.trace("member not found");
         return make_sync_error(error_code::unknown_member_id);
@@ -1078,6 +1206,10 @@ ss::future<heartbeat_response> group::handle_heartbeat(heartbeat_request&& r) {
         klog.trace("group is dead");
         return make_heartbeat_error(error_code::coordinator_not_available);
 
+    } else if (is_member_fenced(r.data.member_id, r.data.group_instance_id)) {
+        klog.trace("member was replaced by a new instance");
+        return make_heartbeat_error(error_code::fenced_instance_id);
+
     } else if (!contains_member(r.data.member_id)) {
         klog.trace("member not found");
         return make_heartbeat_error(error_code::unknown_member_id);
@@ -1176,8 +1308,7 @@ void group::fail_offset_commit(
 
 ss::future<offset_commit_response>
 group::store_offsets(offset_commit_request&& r) {
-    cluster::simple_batch_builder builder(
-      raft::data_batch_type, model::offset(0));
+    std::vector<offset_commit_batcher::record> records;
 
     std::vector<std::pair<model::topic_partition, offset_metadata>>
       offset_commits;
@@ -1197,7 +1328,9 @@ group::store_offsets(offset_commit_request&& r) {
               p.committed_leader_epoch,
               p.committed_metadata,
             };
-            builder.add_kv(std::move(key), std::move(val));
+            records.emplace_back(
+              reflection::to_iobuf(std::move(key)),
+              reflection::to_iobuf(std::move(val)));
 
             model::topic_partition tp(t.name, p.partition_index);
             offset_metadata md{
@@ -1213,15 +1346,26 @@ group::store_offsets(offset_commit_request&& r) {
         }
     }
 
-    auto batch = std::move(builder).build();
-    auto reader = model::make_memory_record_batch_reader(std::move(batch));
+    auto f = [this, &records] {
+        if (_commits && !records.empty()) {
+            // merged with the commits of the other groups of the partition
+            return _commits->replicate(std::move(records));
+        }
+        cluster::simple_batch_builder builder(
+          raft::data_batch_type, model::offset(0));
+        for (auto& rec : records) {
+            builder.add_raw_kv(std::move(rec.first), std::move(rec.second));
+        }
+        auto batch = std::move(builder).build();
+        auto reader = model::make_memory_record_batch_reader(std::move(batch));
+        return _partition->replicate(
+          std::move(reader),
+          raft::replicate_options(raft::consistency_level::quorum_ack));
+    }();
 
-    return _partition
-      ->replicate(
-        std::move(reader),
-        raft::replicate_options(raft::consistency_level::quorum_ack))
-      .then([this, req = std::move(r), commits = std::move(offset_commits)](
-              result<raft::replicate_result> r) mutable {
+    return std::move(f).then(
+      [this, req = std::move(r), commits = std::move(offset_commits)](
+        result<raft::replicate_result> r) mutable {
           error_code error = r ? error_code::none : error_code::not_coordinator;
           if (in_state(group_state::dead)) {
               return offset_commit_response(req, error);
@@ -1252,6 +1396,10 @@ group::handle_offset_commit(offset_commit_request&& r) {
         // <kafka>The group is only using Kafka to store offsets.</kafka>
         return store_offsets(std::move(r));
 
+    } else if (is_member_fenced(r.data.member_id, r.data.group_instance_id)) {
+        return ss::make_ready_future<offset_commit_response>(
+          offset_commit_response(r, error_code::fenced_instance_id));
+
     } else if (!contains_member(r.data.member_id)) {
         return ss::make_ready_future<offset_commit_response>(
           offset_commit_response(r, error_code::unknown_member_id));
@@ -1284,7 +1432,12 @@ group::handle_offset_fetch(offset_fetch_request&& r) {
         return ss::make_ready_future<offset_fetch_response>(
           offset_fetch_response(r.data.topics));
     }
+    return ss::make_ready_future<offset_fetch_response>(
+      fetch_offsets(_offsets, r));
+}
 
+offset_fetch_response group::fetch_offsets(
+  const offset_map& offsets, const offset_fetch_request& r) {
     offset_fetch_response resp;
     resp.data.error_code = error_code::none;
 
@@ -1294,7 +1447,7 @@ group::handle_offset_fetch(offset_fetch_request&& r) {
           model::topic,
           std::vector<offset_fetch_response_partition>>
           tmp;
-        for (const auto& e : _offsets) {
+        for (const auto& e : offsets) {
             offset_fetch_response_partition p = {
               .partition_index = e.first.partition,
               .committed_offset = e.second.offset,
@@ -1308,7 +1461,7 @@ group::handle_offset_fetch(offset_fetch_request&& r) {
               {.name = e.first, .partitions = std::move(e.second)});
         }
 
-        return ss::make_ready_future<offset_fetch_response>(std::move(resp));
+        return resp;
     }
 
     // retrieve for the topics specified in the request
@@ -1317,12 +1470,11 @@ group::handle_offset_fetch(offset_fetch_request&& r) {
         t.name = topic.name;
         for (auto id : topic.partition_indexes) {
             model::topic_partition tp(topic.name, id);
-            auto res = offset(tp);
-            if (res) {
+            if (auto it = offsets.find(tp); it != offsets.end()) {
                 offset_fetch_response_partition p = {
                   .partition_index = id,
-                  .committed_offset = res->offset,
-                  .metadata = res->metadata,
+                  .committed_offset = it->second.offset,
+                  .metadata = it->second.metadata,
                   .error_code = error_code::none,
                 };
                 t.partitions.push_back(std::move(p));
@@ -1339,7 +1491,7 @@ group::handle_offset_fetch(offset_fetch_request&& r) {
         resp.data.topics.push_back(std::move(t));
     }
 
-    return ss::make_ready_future<offset_fetch_response>(std::move(resp));
+    return resp;
 }
 
 kafka::member_id group::generate_member_id(const join_group_request& r) {
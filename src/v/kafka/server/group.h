@@ -15,6 +15,7 @@
 #include "kafka/protocol/fwd.h"
 #include "kafka/server/logger.h"
 #include "kafka/server/member.h"
+#include "kafka/server/offset_commit_batcher.h"
 #include "kafka/types.h"
 #include "model/fundamental.h"
 #include "model/record.h"
@@ -109,22 +110,32 @@ public:
         ss::sstring metadata;
     };
 
+    using offset_map
+      = absl::node_hash_map<model::topic_partition, offset_metadata>;
+
     group(
       kafka::group_id id,
       group_state s,
       config::configuration& conf,
-      ss::lw_shared_ptr<cluster::partition> partition);
+      ss::lw_shared_ptr<cluster::partition> partition,
+      ss::lw_shared_ptr<offset_commit_batcher> commits = nullptr);
 
     // constructor used when loading state from log
     group(
       kafka::group_id id,
       group_log_group_metadata& md,
       config::configuration& conf,
-      ss::lw_shared_ptr<cluster::partition> partition);
+      ss::lw_shared_ptr<cluster::partition> partition,
+      ss::lw_shared_ptr<offset_commit_batcher> commits = nullptr);
 
     /// Get the group id.
     const kafka::group_id& id() const { return _id; }
 
+    /// Get the partition the group metadata is stored in.
+    const ss::lw_shared_ptr<cluster::partition>& partition() const {
+        return _partition;
+    }
+
     /// Return the group state.
     group_state state() const { return _state; }
 
@@ -158,6 +169,24 @@ public:
     /// Check if the group has members.
     bool has_members() const { return !_members.empty(); }
 
+    /**
+     * \brief Check if a request of a static member comes from an instance
+     * that was replaced.
+     *
+     * A static member that rejoins takes over the membership of the previous
+     * instance with the same group instance id, requests still carrying the
+     * member id of the previous instance are fenced.
+     */
+    bool is_member_fenced(
+      const kafka::member_id& member_id,
+      const std::optional<kafka::group_instance_id>& instance_id) const {
+        if (!instance_id) {
+            return false;
+        }
+        auto it = _static_members.find(*instance_id);
+        return it != _static_members.end() && it->second != member_id;
+    }
+
     /// Check if all members have joined.
     bool all_members_joined() const {
         vassert(
@@ -343,6 +372,17 @@ public:
     ss::future<join_group_response> update_member_and_rebalance(
       member_ptr member, join_group_request&& request);
 
+    /// Replace a static member with its new instance, rebalancing only if
+    /// the group cannot keep its current assignment.
+    ss::future<join_group_response> update_static_member_and_rebalance(
+      kafka::member_id old_member_id,
+      kafka::member_id new_member_id,
+      join_group_request&& request);
+
+    /// Hand the membership of a static member over to a new member id.
+    member_ptr
+    replace_static_member(member_ptr old_member, kafka::member_id new_id);
+
     /// Transition to preparing rebalance if possible.
     void try_prepare_rebalance();
 
@@ -402,6 +442,13 @@ public:
     ss::future<offset_fetch_response>
     handle_offset_fetch(offset_fetch_request&& r);
 
+    /// Build the OffsetFetch response of a group with the given committed
+    /// offsets. Shared with the copies of the offsets on other shards.
+    static offset_fetch_response
+    fetch_offsets(const offset_map& offsets, const offset_fetch_request& r);
+
+    const offset_map& offsets() const { return _offsets; }
+
     void insert_offset(model::topic_partition tp, offset_metadata md) {
         _offsets[std::move(tp)] = std::move(md);
     }
@@ -433,6 +480,9 @@ private:
     member_map _members;
     int _num_members_joining;
     absl::node_hash_set<kafka::member_id> _pending_members;
+    // member ids of the current instances of static members
+    absl::node_hash_map<kafka::group_instance_id, kafka::member_id>
+      _static_members;
     std::optional<kafka::protocol_type> _protocol_type;
     std::optional<kafka::protocol_name> _protocol;
     std::optional<kafka::member_id> _leader;
@@ -440,9 +490,11 @@ private:
     bool _new_member_added;
     config::configuration& _conf;
     ss::lw_shared_ptr<cluster::partition> _partition;
-    absl::node_hash_map<model::topic_partition, offset_metadata> _offsets;
-    absl::node_hash_map<model::topic_partition, offset_metadata>
-      _pending_offset_commits;
+    // shared by the groups of the partition, replicates offset commits
+    // directly when not set
+    ss::lw_shared_ptr<offset_commit_batcher> _commits;
+    offset_map _offsets;
+    offset_map _pending_offset_commits;
 };
 
 using group_ptr = ss::lw_shared_ptr<group>;
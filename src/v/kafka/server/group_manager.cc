@@ -10,6 +10,7 @@
 #include "kafka/server/group_manager.h"
 
 #include "cluster/cluster_utils.h"
+#include "cluster/partition_leaders_table.h"
 #include "cluster/partition_manager.h"
 #include "cluster/simple_batch_builder.h"
 #include "cluster/topic_table.h"
@@ -18,12 +19,16 @@
 #include "kafka/protocol/describe_groups.h"
 #include "kafka/protocol/offset_commit.h"
 #include "kafka/protocol/offset_fetch.h"
+#include "kafka/server/group_metadata_snapshot.h"
 #include "model/fundamental.h"
 #include "model/namespace.h"
 #include "model/record.h"
+#include "raft/consensus_utils.h"
 #include "resource_mgmt/io_priority.h"
+#include "vlog.h"
 
 #include <seastar/core/coroutine.hh>
+#include <seastar/core/future-util.hh>
 
 namespace kafka {
 
@@ -31,10 +36,12 @@ group_manager::group_manager(
   ss::sharded<raft::group_manager>& gm,
   ss::sharded<cluster::partition_manager>& pm,
   ss::sharded<cluster::topic_table>& topic_table,
+  ss::sharded<cluster::partition_leaders_table>& leaders,
   config::configuration& conf)
   : _gm(gm)
   , _pm(pm)
   , _topic_table(topic_table)
+  , _leaders(leaders)
   , _conf(conf)
   , _self(cluster::make_self_broker(config::shard_local_cfg())) {}
 
@@ -78,6 +85,11 @@ ss::future<> group_manager::start() {
             handle_topic_delta(deltas);
         });
 
+    if (_conf.group_metadata_snapshot_interval_ms().count() > 0) {
+        _snapshot_timer.set_callback([this] { snapshot_partitions(); });
+        _snapshot_timer.arm(_conf.group_metadata_snapshot_interval_ms());
+    }
+
     return ss::make_ready_future<>();
 }
 
@@ -86,17 +98,35 @@ ss::future<> group_manager::stop() {
     _gm.local().unregister_leadership_notification(_leader_notify_handle);
     _topic_table.local().unregister_delta_notification(
       _topic_table_notify_handle);
+    _snapshot_timer.cancel();
 
     for (auto& e : _partitions) {
         e.second->as.request_abort();
     }
 
-    return _gate.close();
+    return ss::parallel_for_each(
+             _partitions,
+             [](auto& e) {
+                 return e.second->commits ? e.second->commits->stop()
+                                          : ss::now();
+             })
+      .then([this] { return _gate.close(); });
 }
 
 void group_manager::attach_partition(ss::lw_shared_ptr<cluster::partition> p) {
     klog.debug("attaching group metadata partition {}", p->ntp());
     auto attached = ss::make_lw_shared<attached_partition>(p);
+    if (auto window = _conf.group_offset_commit_batch_window_ms();
+        window.count() > 0) {
+        attached->commits = ss::make_lw_shared<offset_commit_batcher>(
+          p, window, _conf.group_offset_commit_batch_max_bytes());
+    }
+    if (_conf.group_metadata_snapshot_interval_ms().count() > 0) {
+        attached->snapshots.emplace(
+          std::filesystem::path(p->log_config().work_directory()),
+          "group_metadata.snapshot",
+          kafka_read_priority());
+    }
     auto res = _partitions.try_emplace(p->ntp(), attached);
     // TODO: this is not a forever assertion. this should just generally never
     // happen _now_ because we don't support partition migration / removal.
@@ -106,6 +136,14 @@ void group_manager::attach_partition(ss::lw_shared_ptr<cluster::partition> p) {
     _partitions.rehash(0);
 }
 
+ss::lw_shared_ptr<offset_commit_batcher>
+group_manager::commit_batcher(const model::ntp& ntp) const {
+    if (auto it = _partitions.find(ntp); it != _partitions.end()) {
+        return it->second->commits;
+    }
+    return nullptr;
+}
+
 ss::future<> group_manager::cleanup_removed_topic_partitions(
   const std::vector<model::topic_partition>& tps) {
     // operate on a light-weight copy of group pointers to avoid iterating over
@@ -119,8 +157,9 @@ ss::future<> group_manager::cleanup_removed_topic_partitions(
     return ss::do_with(
       std::move(groups), [this, &tps](std::vector<group_ptr>& groups) {
           return ss::do_for_each(groups, [this, &tps](group_ptr& group) {
-              return group->remove_topic_partitions(tps).then(
-                [this, g = group] {
+              return group->remove_topic_partitions(tps)
+                .then([this, g = group] { return retract_offsets(g->id()); })
+                .then([this, g = group] {
                     if (!g->in_state(group_state::dead)) {
                         return ss::now();
                     }
@@ -173,13 +212,20 @@ void group_manager::handle_leader_change(
   ss::lw_shared_ptr<cluster::partition> part,
   std::optional<model::node_id> leader) {
     (void)with_gate(_gate, [this, part = std::move(part), leader] {
-        if (auto it = _partitions.find(part->ntp()); it != _partitions.end()) {
-            return ss::with_semaphore(
-              it->second->sem, 1, [this, p = it->second, leader] {
-                  return handle_partition_leader_change(p, leader);
-              });
-        }
-        return ss::make_ready_future<>();
+        // whatever the new leader, the copies made in the previous term are
+        // stale. they are also checked against the term of the leader before
+        // they are used, as other shards may still answer from them until
+        // they are dropped
+        return retract_offsets(part->ntp()).then([this, part, leader] {
+            if (auto it = _partitions.find(part->ntp());
+                it != _partitions.end()) {
+                return ss::with_semaphore(
+                  it->second->sem, 1, [this, p = it->second, leader] {
+                      return handle_partition_leader_change(p, leader);
+                  });
+            }
+            return ss::make_ready_future<>();
+        });
     });
 }
 
@@ -223,34 +269,18 @@ ss::future<> group_manager::handle_partition_leader_change(
          * struct group_log_record_key{} for more details.
          */
         return inject_noop(p->partition, timeout).then([this, timeout, p] {
-            /*
-             * the full log is read and deduplicated. the dedupe processing is
-             * based on the record keys, so this code should be ready to
-             * transparently take advantage of key-based compaction in the
-             * future.
-             */
-            storage::log_reader_config reader_config(
-              p->partition->start_offset(),
-              model::model_limits<model::offset>::max(),
-              0,
-              std::numeric_limits<size_t>::max(),
-              kafka_read_priority(),
-              raft::data_batch_type,
-              std::nullopt,
-              std::nullopt);
-
-            return p->partition->make_reader(reader_config)
-              .then([this, p, timeout](model::record_batch_reader reader) {
-                  return std::move(reader)
-                    .consume(recovery_batch_consumer(p->as), timeout)
-                    .then([this, p](recovery_batch_consumer_state state) {
-                        // avoid trying to recover if we stopped the reader
-                        // because an abort was requested
-                        if (p->as.abort_requested()) {
-                            return ss::make_ready_future<>();
-                        }
-                        return recover_partition(p->partition, std::move(state))
-                          .then([p] { p->loading = false; });
+            return replay_partition(
+                     p, model::model_limits<model::offset>::max(), timeout)
+              .then([this, p](recovery_batch_consumer_state state) {
+                  // avoid trying to recover if we stopped the reader
+                  // because an abort was requested
+                  if (p->as.abort_requested()) {
+                      return ss::make_ready_future<>();
+                  }
+                  return recover_partition(p->partition, std::move(state))
+                    .then([this, p] {
+                        p->loading = false;
+                        return publish_partition_offsets(p->partition->ntp());
                     });
               });
         });
@@ -260,6 +290,98 @@ ss::future<> group_manager::handle_partition_leader_change(
     }
 }
 
+ss::future<recovery_batch_consumer_state> group_manager::replay_partition(
+  ss::lw_shared_ptr<attached_partition> p,
+  model::offset max_offset,
+  ss::lowres_clock::time_point timeout) {
+    recovery_batch_consumer_state state;
+    if (p->snapshots) {
+        auto snapshot = co_await read_group_metadata_snapshot(*p->snapshots);
+        // the snapshot is only usable if the log still has every batch
+        // appended after it, and was not truncated below it
+        if (
+          snapshot
+          && raft::next_offset(snapshot->last_offset)
+               >= p->partition->start_offset()
+          && snapshot->last_offset <= p->partition->dirty_offset()) {
+            state = std::move(*snapshot);
+        }
+    }
+    /*
+     * the log is read and deduplicated from the end of the snapshot, or from
+     * its start. the dedupe processing is based on the record keys, so this
+     * code should be ready to transparently take advantage of key-based
+     * compaction in the future.
+     */
+    auto start = std::max(
+      raft::next_offset(state.last_offset), p->partition->start_offset());
+    if (start > max_offset) {
+        co_return state;
+    }
+    storage::log_reader_config reader_config(
+      start,
+      max_offset,
+      0,
+      std::numeric_limits<size_t>::max(),
+      kafka_read_priority(),
+      raft::data_batch_type,
+      std::nullopt,
+      std::nullopt);
+
+    auto reader = co_await p->partition->make_reader(reader_config);
+    co_return co_await std::move(reader).consume(
+      recovery_batch_consumer(p->as, std::move(state)), timeout);
+}
+
+ss::future<>
+group_manager::snapshot_partition(ss::lw_shared_ptr<attached_partition> p) {
+    if (!p->snapshots) {
+        co_return;
+    }
+    // replicas that are not the leader snapshot too, the next leader recovers
+    // from its own log
+    auto last_offset = p->partition->committed_offset();
+    auto timeout = ss::lowres_clock::now()
+                   + _conf.kafka_group_recovery_timeout_ms();
+    auto state = co_await replay_partition(p, last_offset, timeout);
+    if (p->as.abort_requested() || state.last_offset == p->snapshot_offset) {
+        co_return;
+    }
+    auto snapshot_offset = state.last_offset;
+    vlog(
+      klog.debug,
+      "Writing group metadata snapshot of {} at offset {}",
+      p->partition->ntp(),
+      state.last_offset);
+    co_await write_group_metadata_snapshot(*p->snapshots, std::move(state));
+    p->snapshot_offset = snapshot_offset;
+}
+
+void group_manager::snapshot_partitions() {
+    std::vector<ss::lw_shared_ptr<attached_partition>> partitions;
+    partitions.reserve(_partitions.size());
+    for (auto& e : _partitions) {
+        partitions.push_back(e.second);
+    }
+    (void)ss::with_gate(_gate, [this, partitions = std::move(partitions)] {
+        return ss::do_for_each(partitions, [this](auto p) {
+            return ss::with_semaphore(
+                     p->sem, 1, [this, p] { return snapshot_partition(p); })
+              .handle_exception([p](std::exception_ptr e) {
+                  vlog(
+                    klog.warn,
+                    "Failed to snapshot group metadata of {}: {}",
+                    p->partition->ntp(),
+                    e);
+              });
+        });
+    }).finally([this] {
+        if (!_gate.is_closed()) {
+            _snapshot_timer.arm(_conf.group_metadata_snapshot_interval_ms());
+        }
+    });
+}
+
 /*
  * TODO: this routine can be improved from a copy vs move perspective, but is
  * rather complicated at the moment to start having to also analyze all the data
@@ -304,7 +426,8 @@ ss::future<> group_manager::recover_partition(
             continue;
         }
 
-        group = ss::make_lw_shared<kafka::group>(e.first, e.second, _conf, p);
+        group = ss::make_lw_shared<kafka::group>(
+          e.first, e.second, _conf, p, commit_batcher(p->ntp()));
 
         for (auto& e : offsets) {
             group->insert_offset(
@@ -328,7 +451,7 @@ ss::future<> group_manager::recover_partition(
         }
 
         group = ss::make_lw_shared<kafka::group>(
-          e.first, group_state::empty, _conf, p);
+          e.first, group_state::empty, _conf, p, commit_batcher(p->ntp()));
 
         for (auto& e : e.second) {
             group->insert_offset(
@@ -376,6 +499,7 @@ recovery_batch_consumer::operator()(model::record_batch batch) {
           ss::stop_iteration::yes);
     }
     batch_base_offset = batch.base_offset();
+    st.last_offset = batch.last_offset();
     return ss::do_with(
              std::move(batch),
              [this](model::record_batch& batch) {
@@ -501,7 +625,7 @@ group_manager::join_group(join_group_request&& r) {
         }
         auto p = it->second->partition;
         group = ss::make_lw_shared<kafka::group>(
-          r.data.group_id, group_state::empty, _conf, p);
+          r.data.group_id, group_state::empty, _conf, p, it->second->commits);
         _groups.emplace(r.data.group_id, group);
         _groups.rehash(0);
         klog.trace("created new group {}", group);
@@ -515,11 +639,6 @@ ss::future<sync_group_response>
 group_manager::sync_group(sync_group_request&& r) {
     klog.trace("sync request {}", r);
 
-    if (r.data.group_instance_id) {
-        klog.trace("static group membership is unsupported");
-        return make_sync_error(error_code::unsupported_version);
-    }
-
     auto error = validate_group_status(
       r.ntp, r.data.group_id, sync_group_api::key);
     if (error != error_code::none) {
@@ -549,11 +668,6 @@ group_manager::sync_group(sync_group_request&& r) {
 ss::future<heartbeat_response> group_manager::heartbeat(heartbeat_request&& r) {
     klog.trace("heartbeat request {}", r);
 
-    if (r.data.group_instance_id) {
-        klog.trace("static group membership is unsupported");
-        return make_heartbeat_error(error_code::unsupported_version);
-    }
-
     auto error = validate_group_status(
       r.ntp, r.data.group_id, heartbeat_api::key);
     if (error != error_code::none) {
@@ -609,9 +723,13 @@ group_manager::offset_commit(offset_commit_request&& r) {
         if (r.data.generation_id < 0) {
             // <kafka>the group is not relying on Kafka for group management, so
             // allow the commit</kafka>
-            auto p = _partitions.find(r.ntp)->second->partition;
+            auto& attached = _partitions.find(r.ntp)->second;
             group = ss::make_lw_shared<kafka::group>(
-              r.data.group_id, group_state::empty, _conf, p);
+              r.data.group_id,
+              group_state::empty,
+              _conf,
+              attached->partition,
+              attached->commits);
             _groups.emplace(r.data.group_id, group);
             _groups.rehash(0);
         } else {
@@ -622,7 +740,26 @@ group_manager::offset_commit(offset_commit_request&& r) {
         }
     }
 
-    return group->handle_offset_commit(std::move(r));
+    auto ntp = r.ntp;
+    return group->handle_offset_commit(std::move(r))
+      .then([this, ntp = std::move(ntp), group](
+              offset_commit_response resp) mutable {
+          std::vector<model::topic_partition> committed;
+          for (const auto& t : resp.data.topics) {
+              for (const auto& p : t.partitions) {
+                  if (p.error_code == error_code::none) {
+                      committed.emplace_back(t.name, p.partition_index);
+                  }
+              }
+          }
+          // the copies are updated before the commit is acknowledged for a
+          // fetch on any shard to observe it
+          return publish_offsets(
+                   std::move(ntp), std::move(group), std::move(committed))
+            .then([resp = std::move(resp)]() mutable {
+                return std::move(resp);
+            });
+      });
 }
 
 ss::future<offset_fetch_response>
@@ -643,6 +780,148 @@ group_manager::offset_fetch(offset_fetch_request&& r) {
     return group->handle_offset_fetch(std::move(r));
 }
 
+std::optional<offset_fetch_response> group_manager::offset_fetch_from_replica(
+  const model::ntp& ntp, const offset_fetch_request& r) const {
+    auto it = _offset_replicas.find(r.data.group_id);
+    if (it == _offset_replicas.end() || it->second.ntp != ntp) {
+        return std::nullopt;
+    }
+    auto& leaders = _leaders.local();
+    auto leader = leaders.get_leader(ntp);
+    if (leader && *leader != _self.id()) {
+        vlog(
+          klog.trace,
+          "group partition is not leader {}/{}",
+          r.data.group_id,
+          ntp);
+        return offset_fetch_response(error_code::not_coordinator);
+    }
+    // the partition may have been elected again since the copy was made, and
+    // be loading. the owner knows the state of the group
+    if (!leader || leaders.get_leader_term(ntp) != it->second.term) {
+        return std::nullopt;
+    }
+    vlog(klog.trace, "fetching offsets of {} from replica", r.data.group_id);
+    return group::fetch_offsets(it->second.offsets, r);
+}
+
+ss::future<> group_manager::publish_offsets(
+  model::ntp ntp, group_ptr group, std::vector<model::topic_partition> tps) {
+    if (!_conf.group_offset_fetch_replicas() || ss::smp::count == 1) {
+        co_return;
+    }
+    // the partition may have lost its leadership or the group may have been
+    // removed while the offsets were committed
+    if (
+      validate_group_status(ntp, group->id(), offset_fetch_api::key)
+        != error_code::none
+      || get_group(group->id()) != group) {
+        co_return;
+    }
+    // the owner answers fetches of a dead group with no offsets
+    if (group->in_state(group_state::dead)) {
+        co_await retract_offsets(group->id());
+        co_return;
+    }
+    auto term = group->partition()->term();
+
+    auto full = _published_groups.try_emplace(group->id(), ntp).second;
+    group::offset_map offsets;
+    if (full) {
+        offsets = group->offsets();
+    } else {
+        for (auto& tp : tps) {
+            if (auto md = group->offset(tp); md) {
+                offsets.emplace(std::move(tp), std::move(*md));
+            }
+        }
+        if (offsets.empty()) {
+            co_return;
+        }
+    }
+
+    co_await container().invoke_on_others(
+      [ntp = std::move(ntp),
+       term,
+       id = group->id(),
+       offsets = std::move(offsets),
+       full](group_manager& mgr) {
+          mgr.apply_offset_replica(ntp, term, id, offsets, full);
+      });
+}
+
+ss::future<> group_manager::publish_partition_offsets(model::ntp ntp) {
+    std::vector<group_ptr> groups;
+    for (const auto& [id, group] : _groups) {
+        if (group->partition() && group->partition()->ntp() == ntp) {
+            groups.push_back(group);
+        }
+    }
+    for (auto& group : groups) {
+        co_await publish_offsets(ntp, group, {});
+    }
+}
+
+ss::future<> group_manager::retract_offsets(const model::ntp& ntp) {
+    bool retracted = false;
+    for (auto it = _published_groups.begin(); it != _published_groups.end();) {
+        if (it->second == ntp) {
+            _published_groups.erase(it++);
+            retracted = true;
+        } else {
+            ++it;
+        }
+    }
+    if (!retracted) {
+        return ss::now();
+    }
+    return container().invoke_on_others([ntp](group_manager& mgr) {
+        for (auto it = mgr._offset_replicas.begin();
+             it != mgr._offset_replicas.end();) {
+            if (it->second.ntp == ntp) {
+                mgr._offset_replicas.erase(it++);
+            } else {
+                ++it;
+            }
+        }
+    });
+}
+
+ss::future<> group_manager::retract_offsets(const group_id& group) {
+    if (!_published_groups.erase(group)) {
+        return ss::now();
+    }
+    return container().invoke_on_others(
+      [group](group_manager& mgr) { mgr._offset_replicas.erase(group); });
+}
+
+void group_manager::apply_offset_replica(
+  const model::ntp& ntp,
+  model::term_id term,
+  const group_id& group,
+  const group::offset_map& offsets,
+  bool full) {
+    if (full) {
+        _offset_replicas.insert_or_assign(
+          group, offset_replica{ntp, term, offsets});
+        return;
+    }
+    auto it = _offset_replicas.find(group);
+    if (
+      it == _offset_replicas.end() || it->second.ntp != ntp
+      || it->second.term != term) {
+        return;
+    }
+    // commits are applied in log order, as by the owner
+    auto& replica = it->second.offsets;
+    for (const auto& [tp, md] : offsets) {
+        auto o = replica.find(tp);
+        if (o == replica.end() || o->second.log_offset < md.log_offset) {
+            replica.insert_or_assign(tp, md);
+        }
+    }
+}
+
 std::pair<error_code, std::vector<listed_group>>
 group_manager::list_groups() const {
     auto loading = std::any_of(
@@ -711,6 +990,7 @@ ss::future<std::vector<deletable_group_result>> group_manager::delete_groups(
         error = co_await group->remove();
         if (error == error_code::none) {
             _groups.erase(group_info.second);
+            co_await retract_offsets(group_info.second);
         }
         results.push_back(deletable_group_result{
           .group_id = std::move(group_info.second),
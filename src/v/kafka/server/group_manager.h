@@ -26,10 +26,12 @@
 #include "model/namespace.h"
 #include "raft/group_manager.h"
 #include "seastarx.h"
+#include "storage/snapshot.h"
 
 #include <seastar/core/abort_source.hh>
 #include <seastar/core/future.hh>
 #include <seastar/core/sharded.hh>
+#include <seastar/core/timer.hh>
 
 #include <absl/container/node_hash_map.h>
 #include <cluster/partition_manager.h>
@@ -106,13 +108,23 @@ struct recovery_batch_consumer_state;
  * cleared.
  *
  *     - This is not yet implemented.
+ *
+ * Offset replicas
+ * ===============
+ *
+ * The committed offsets of the groups are copied to all the other shards,
+ * so that OffsetFetch requests, which are read-mostly, are answered on the
+ * shard of the connection. The owner updates the copies before it responds
+ * to a commit, and drops them when the partition leadership changes. A shard
+ * without a copy of a group forwards the request to the owner.
  */
-class group_manager {
+class group_manager : public ss::peering_sharded_service<group_manager> {
 public:
     group_manager(
       ss::sharded<raft::group_manager>& gm,
       ss::sharded<cluster::partition_manager>& pm,
       ss::sharded<cluster::topic_table>&,
+      ss::sharded<cluster::partition_leaders_table>&,
       config::configuration& conf);
 
     ss::future<> start();
@@ -145,6 +157,14 @@ public:
 
     described_group describe_group(const model::ntp&, const kafka::group_id&);
 
+    /// \brief Answer an OffsetFetch request for a group owned by another
+    /// shard from this shard's copy of its offsets. The copy is only used
+    /// while this node leads the coordinator ntp in the term the copy was
+    /// made in. Returns not_coordinator when another node leads it, and
+    /// std::nullopt, for the owner to answer, when there is no usable copy.
+    std::optional<offset_fetch_response> offset_fetch_from_replica(
+      const model::ntp&, const offset_fetch_request&) const;
+
     ss::future<std::vector<deletable_group_result>>
       delete_groups(std::vector<std::pair<model::ntp, group_id>>);
 
@@ -172,12 +192,20 @@ private:
         ss::semaphore sem{1};
         ss::abort_source as;
         ss::lw_shared_ptr<cluster::partition> partition;
+        // offset commits of all the groups of the partition
+        ss::lw_shared_ptr<offset_commit_batcher> commits;
+        // snapshots of the group metadata recovered from the partition
+        std::optional<storage::snapshot_manager> snapshots;
+        model::offset snapshot_offset{-1};
 
         explicit attached_partition(ss::lw_shared_ptr<cluster::partition> p)
           : loading(true)
           , partition(std::move(p)) {}
     };
 
+    ss::lw_shared_ptr<offset_commit_batcher>
+    commit_batcher(const model::ntp&) const;
+
     absl::node_hash_map<model::ntp, ss::lw_shared_ptr<attached_partition>>
       _partitions;
 
@@ -199,16 +227,55 @@ private:
     ss::future<> recover_partition(
       ss ::lw_shared_ptr<cluster::partition>, recovery_batch_consumer_state);
 
+    /// \brief rebuilds the group metadata of the partition from its log up
+    /// to max_offset, starting from its last snapshot when there is one
+    ss::future<recovery_batch_consumer_state> replay_partition(
+      ss::lw_shared_ptr<attached_partition>,
+      model::offset max_offset,
+      ss::lowres_clock::time_point timeout);
+
+    /// \brief folds the log appended since the last snapshot of the
+    /// partition into a new snapshot
+    ss::future<> snapshot_partition(ss::lw_shared_ptr<attached_partition>);
+    void snapshot_partitions();
+
     ss::future<> inject_noop(
       ss::lw_shared_ptr<cluster::partition> p,
       ss::lowres_clock::time_point timeout);
 
+    /// \brief copies the committed offsets of the partitions to the other
+    /// shards, or all offsets of the group if they have no copy of it yet
+    ss::future<> publish_offsets(
+      model::ntp, group_ptr, std::vector<model::topic_partition>);
+    ss::future<> publish_partition_offsets(model::ntp);
+    ss::future<> retract_offsets(const model::ntp&);
+    ss::future<> retract_offsets(const group_id&);
+    void apply_offset_replica(
+      const model::ntp&,
+      model::term_id,
+      const group_id&,
+      const group::offset_map&,
+      bool full);
+
+    // copy of the committed offsets of a group owned by another shard, made
+    // while the owner led the coordinator ntp in the given term
+    struct offset_replica {
+        model::ntp ntp;
+        model::term_id term;
+        group::offset_map offsets;
+    };
+
     ss::sharded<raft::group_manager>& _gm;
     ss::sharded<cluster::partition_manager>& _pm;
     ss::sharded<cluster::topic_table>& _topic_table;
+    ss::sharded<cluster::partition_leaders_table>& _leaders;
     config::configuration& _conf;
     absl::node_hash_map<group_id, group_ptr> _groups;
+    // coordinator ntps of the groups whose offsets the other shards copied
+    absl::node_hash_map<group_id, model::ntp> _published_groups;
+    absl::node_hash_map<group_id, offset_replica> _offset_replicas;
     model::broker _self;
+    ss::timer<ss::lowres_clock> _snapshot_timer;
 };
 
 /**
@@ -287,6 +354,9 @@ namespace kafka {
  * deduplicate both group and commit metadata snapshots.
  */
 struct recovery_batch_consumer_state {
+    // last offset of the log the state was built from
+    model::offset last_offset{-1};
+
     absl::node_hash_map<kafka::group_id, group_log_group_metadata>
       loaded_groups;
 
@@ -299,8 +369,10 @@ struct recovery_batch_consumer_state {
 };
 
 struct recovery_batch_consumer {
-    explicit recovery_batch_consumer(ss::abort_source& as)
-      : as(as) {}
+    explicit recovery_batch_consumer(
+      ss::abort_source& as, recovery_batch_consumer_state st = {})
+      : st(std::move(st))
+      , as(as) {}
 
     ss::future<ss::stop_iteration> operator()(model::record_batch batch);
 
@@ -0,0 +1,130 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/server/group_metadata_snapshot.h"
+
+#include "bytes/iobuf.h"
+#include "bytes/iobuf_parser.h"
+#include "kafka/server/logger.h"
+#include "reflection/adl.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+
+#include <vector>
+
+namespace kafka {
+
+namespace {
+
+constexpr int8_t snapshot_version = 1;
+
+struct snapshot_group {
+    kafka::group_id id;
+    group_log_group_metadata metadata;
+};
+
+struct snapshot_offset {
+    group_log_offset_key key;
+    model::offset log_offset;
+    group_log_offset_metadata metadata;
+};
+
+struct snapshot_data {
+    model::offset last_offset;
+    std::vector<snapshot_group> groups;
+    std::vector<kafka::group_id> removed_groups;
+    std::vector<snapshot_offset> offsets;
+};
+
+snapshot_data to_snapshot_data(recovery_batch_consumer_state st) {
+    snapshot_data data{.last_offset = st.last_offset};
+    data.groups.reserve(st.loaded_groups.size());
+    for (auto& [id, md] : st.loaded_groups) {
+        data.groups.push_back(snapshot_group{id, std::move(md)});
+    }
+    data.removed_groups.assign(
+      st.removed_groups.begin(), st.removed_groups.end());
+    data.offsets.reserve(st.loaded_offsets.size());
+    for (auto& [key, o] : st.loaded_offsets) {
+        data.offsets.push_back(
+          snapshot_offset{key, o.first, std::move(o.second)});
+    }
+    return data;
+}
+
+recovery_batch_consumer_state from_snapshot_data(snapshot_data data) {
+    recovery_batch_consumer_state st;
+    st.last_offset = data.last_offset;
+    for (auto& g : data.groups) {
+        st.loaded_groups.emplace(std::move(g.id), std::move(g.metadata));
+    }
+    for (auto& id : data.removed_groups) {
+        st.removed_groups.emplace(std::move(id));
+    }
+    for (auto& o : data.offsets) {
+        st.loaded_offsets.emplace(
+          std::move(o.key),
+          std::make_pair(o.log_offset, std::move(o.metadata)));
+    }
+    return st;
+}
+
+} // namespace
+
+ss::future<std::optional<recovery_batch_consumer_state>>
+read_group_metadata_snapshot(storage::snapshot_manager& snap) {
+    auto reader = co_await snap.open_snapshot();
+    if (!reader) {
+        co_return std::nullopt;
+    }
+    std::exception_ptr ex;
+    std::optional<recovery_batch_consumer_state> ret;
+    try {
+        iobuf metadata = co_await reader->read_metadata();
+        auto version = iobuf_const_parser(metadata).consume_type<int8_t>();
+        if (version == snapshot_version) {
+            auto size = co_await reader->get_snapshot_size();
+            auto buf = co_await read_iobuf_exactly(reader->input(), size);
+            ret = from_snapshot_data(
+              reflection::from_iobuf<snapshot_data>(std::move(buf)));
+        } else {
+            vlog(
+              klog.warn,
+              "Ignoring group metadata snapshot {} of version {}",
+              snap.snapshot_path(),
+              version);
+        }
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    co_await reader->close();
+    if (ex) {
+        // the log is still there to recover from
+        vlog(
+          klog.warn,
+          "Failed to read group metadata snapshot {}: {}",
+          snap.snapshot_path(),
+          ex);
+        co_return std::nullopt;
+    }
+    co_return ret;
+}
+
+ss::future<> write_group_metadata_snapshot(
+  storage::snapshot_manager& snap, recovery_batch_consumer_state st) {
+    auto data = reflection::to_iobuf(to_snapshot_data(std::move(st)));
+    auto writer = co_await snap.start_snapshot();
+    co_await writer.write_metadata(reflection::to_iobuf(snapshot_version));
+    co_await write_iobuf_to_output_stream(std::move(data), writer.output());
+    co_await writer.close();
+    co_await snap.finish_snapshot(writer);
+}
+
+} // namespace kafka
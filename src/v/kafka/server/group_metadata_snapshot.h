@@ -0,0 +1,37 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "kafka/server/group_manager.h"
+#include "seastarx.h"
+#include "storage/snapshot.h"
+
+#include <seastar/core/future.hh>
+
+#include <optional>
+
+namespace kafka {
+
+/**
+ * Snapshots of the group metadata of a partition of the group topic.
+ *
+ * A snapshot holds the deduplicated state the recovery of the partition
+ * builds from its log, up to recovery_batch_consumer_state::last_offset.
+ * Recovery loads it and only replays the log past that offset.
+ */
+ss::future<std::optional<recovery_batch_consumer_state>>
+read_group_metadata_snapshot(storage::snapshot_manager&);
+
+ss::future<> write_group_metadata_snapshot(
+  storage::snapshot_manager&, recovery_batch_consumer_state);
+
+} // namespace kafka
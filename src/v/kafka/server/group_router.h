@@ -103,6 +103,17 @@ public:
     }
 
     auto offset_fetch(offset_fetch_request&& request) {
+        // answered from the local copy of the group offsets if there is one
+        // made from the current coordinator ntp of the group
+        if (auto m = shard_for(request.data.group_id);
+            m && m->second != ss::this_shard_id()) {
+            if (auto resp = _group_manager.local().offset_fetch_from_replica(
+                  m->first, request);
+                resp) {
+                return ss::make_ready_future<offset_fetch_response>(
+                  std::move(*resp));
+            }
+        }
         return route(std::move(request), &group_manager::offset_fetch);
     }
 
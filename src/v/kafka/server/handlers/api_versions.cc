@@ -53,7 +53,9 @@ using request_types = make_request_types<
   describe_acls_handler,
   describe_log_dirs_handler,
   create_acls_handler,
-  delete_acls_handler>;
+  delete_acls_handler,
+  offset_for_leader_epoch_handler,
+  delete_records_handler>;
 
 template<typename RequestType>
 static auto make_api() {
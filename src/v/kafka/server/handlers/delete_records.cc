@@ -0,0 +1,122 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+#include "kafka/server/handlers/delete_records.h"
+
+#include "cluster/partition_manager.h"
+#include "cluster/shard_table.h"
+#include "kafka/protocol/errors.h"
+#include "kafka/server/request_context.h"
+#include "kafka/server/response.h"
+#include "model/fundamental.h"
+#include "model/namespace.h"
+#include "model/timeout_clock.h"
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/when_all.hh>
+
+#include <algorithm>
+#include <vector>
+
+namespace kafka {
+
+/*
+ * Truncated on the shard of the partition, the partition replicates the
+ * truncation and answers once it is applied locally.
+ */
+static ss::future<delete_records_partition_result> truncate_partition(
+  cluster::partition_manager& mgr,
+  const model::ntp& ntp,
+  model::offset offset,
+  model::timeout_clock::time_point deadline) {
+    const auto id = ntp.tp.partition;
+    auto partition = mgr.get(ntp);
+    if (!partition) {
+        co_return delete_records_response::make_partition(
+          id, error_code::unknown_topic_or_partition);
+    }
+    auto r = co_await partition->prefix_truncate(offset, deadline);
+    if (!r) {
+        co_return delete_records_response::make_partition(id, r.error());
+    }
+    auto result = delete_records_response::make_partition(
+      id, error_code::none);
+    result.low_watermark = r.value();
+    co_return result;
+}
+
+static ss::future<delete_records_topic_result> truncate_topic(
+  request_context& ctx,
+  ss::smp_service_group ssg,
+  delete_records_topic topic,
+  model::timeout_clock::time_point deadline) {
+    delete_records_topic_result result{.name = topic.name};
+    result.partitions.resize(topic.partitions.size());
+    if (!ctx.authorized(security::acl_operation::remove, topic.name)) {
+        std::transform(
+          topic.partitions.begin(),
+          topic.partitions.end(),
+          result.partitions.begin(),
+          [](const delete_records_partition& p) {
+              return delete_records_response::make_partition(
+                p.partition_index, error_code::topic_authorization_failed);
+          });
+        co_return result;
+    }
+
+    std::vector<ss::future<>> answers;
+    for (size_t i = 0; i < topic.partitions.size(); ++i) {
+        const auto& p = topic.partitions[i];
+        model::ntp ntp(model::kafka_namespace, topic.name, p.partition_index);
+        auto shard = ctx.shards().shard_for(ntp);
+        if (!shard) {
+            result.partitions[i] = delete_records_response::make_partition(
+              p.partition_index, error_code::unknown_topic_or_partition);
+            continue;
+        }
+        answers.push_back(
+          ctx.partition_manager()
+            .invoke_on(
+              *shard,
+              ssg,
+              [ntp = std::move(ntp), offset = p.offset, deadline](
+                cluster::partition_manager& mgr) {
+                  return truncate_partition(mgr, ntp, offset, deadline);
+              })
+            .then([&result, i](delete_records_partition_result r) {
+                result.partitions[i] = std::move(r);
+            }));
+    }
+    co_await ss::when_all_succeed(answers.begin(), answers.end());
+    co_return result;
+}
+
+template<>
+ss::future<response_ptr> delete_records_handler::handle(
+  request_context ctx, ss::smp_service_group ssg) {
+    delete_records_request request;
+    request.decode(ctx.reader(), ctx.header().version);
+    klog.trace("Handling request {}", request);
+
+    const auto deadline = model::timeout_clock::now()
+                          + request.data.timeout_ms;
+    // the topics are truncated concurrently, their partitions too
+    std::vector<ss::future<delete_records_topic_result>> topics;
+    topics.reserve(request.data.topics.size());
+    for (auto& topic : request.data.topics) {
+        topics.push_back(truncate_topic(ctx, ssg, std::move(topic), deadline));
+    }
+    delete_records_response response;
+    response.data.topics = co_await ss::when_all_succeed(
+      topics.begin(), topics.end());
+    co_return co_await ctx.respond(std::move(response));
+}
+
+} // namespace kafka
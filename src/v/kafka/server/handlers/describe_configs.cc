@@ -352,6 +352,13 @@ ss::future<response_ptr> describe_configs_handler::handle(
               "replication_factor",
               topic_config->replication_factor,
               describe_configs_source::topic);
+
+            add_config(
+              result,
+              topic_property_storage_mode,
+              topic_config->properties.storage_mode.value_or(
+                model::storage_mode::disk),
+              describe_configs_source::topic);
             /**
              * Kafka properties
              */
@@ -82,11 +82,13 @@ static ss::future<partition_dir_set> collect(
           return collect_mapper(pm, filter);
       },
       partition_dir_set{},
-      [](partition_dir_set acc, const partition_dir_set& update) {
-          for (auto& topic : update) {
-              for (auto partition : topic.second) {
-                  acc[topic.first].push_back(partition);
-              }
+      [](partition_dir_set acc, partition_dir_set update) {
+          for (auto& [topic, partitions] : update) {
+              auto& dst = acc[topic];
+              dst.insert(
+                dst.end(),
+                std::make_move_iterator(partitions.begin()),
+                std::make_move_iterator(partitions.end()));
           }
           return acc;
       });
@@ -0,0 +1,40 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+#pragma once
+#include "cluster/partition.h"
+#include "kafka/protocol/errors.h"
+
+#include <cstdint>
+
+namespace kafka::details {
+
+/*
+ * Fences the requests made with another leader epoch than the one of the
+ * partition, which is read from its log. The metadata responses advertise a
+ * leader epoch of 0, the requests carrying it or -1 don't know the epoch and
+ * are not checked.
+ */
+inline error_code
+check_leader_epoch(const cluster::partition& p, int32_t current_leader_epoch) {
+    if (current_leader_epoch <= 0) {
+        return error_code::none;
+    }
+    const auto epoch = p.leader_epoch();
+    if (model::term_id(current_leader_epoch) < epoch) {
+        return error_code::fenced_leader_epoch;
+    }
+    if (model::term_id(current_leader_epoch) > epoch) {
+        return error_code::unknown_leader_epoch;
+    }
+    return error_code::none;
+}
+
+} // namespace kafka::details
@@ -14,14 +14,19 @@
 #include "config/configuration.h"
 #include "kafka/protocol/batch_consumer.h"
 #include "kafka/protocol/errors.h"
+#include "kafka/server/cpu_accounting.h"
+#include "kafka/server/fetch_memory.h"
 #include "kafka/server/fetch_session.h"
+#include "kafka/server/handlers/details/leader_epoch.h"
 #include "likely.h"
 #include "model/fundamental.h"
 #include "model/namespace.h"
 #include "model/record_utils.h"
+#include "model/record_view.h"
 #include "model/timeout_clock.h"
 #include "resource_mgmt/io_priority.h"
 #include "storage/parser_utils.h"
+#include "utils/stage_latency.h"
 #include "utils/to_string.h"
 
 #include <seastar/core/do_with.hh>
@@ -32,7 +37,9 @@
 #include <boost/range/irange.hpp>
 #include <fmt/ostream.h>
 
+#include <algorithm>
 #include <chrono>
+#include <numeric>
 #include <string_view>
 
 namespace kafka {
@@ -84,9 +91,10 @@ void fetch_request::encode(response_writer& writer, api_version version) {
 }
 
 void fetch_request::decode(request_context& ctx) {
-    auto& reader = ctx.reader();
-    auto version = ctx.header().version;
+    decode(ctx.reader(), ctx.header().version);
+}
 
+void fetch_request::decode(request_reader& reader, api_version version) {
     replica_id = model::node_id(reader.read_int32());
     max_wait_time = std::chrono::milliseconds(reader.read_int32());
     min_bytes = reader.read_int32();
@@ -335,7 +343,7 @@ model::record_batch adapt_fetch_batch(model::record_batch&& batch) {
     batch.header().attrs.set_control_type();
     iobuf records;
 
-    batch.for_each_record([&records](model::record r) {
+    model::for_each_record_view(batch, [&records](model::record_view r) {
         auto key = make_control_record_batch_key();
         auto key_size = key.size_bytes();
         auto r_size = control_record_size(
@@ -360,60 +368,244 @@ model::record_batch adapt_fetch_batch(model::record_batch&& batch) {
 }
 
 /**
- * Low-level handler for reading from an ntp. Runs on ntp's home core.
+ * Catch-up reads far from the high watermark mostly miss the batch cache, they
+ * go to the low share class so that the disk keeps serving tailing consumers.
  */
-static ss::future<read_result> read_from_partition(
-  partition_wrapper pw,
-  fetch_config config,
-  bool foreign_read,
-  std::optional<model::timeout_clock::time_point> deadline) {
-    auto hw = pw.high_watermark();
-    auto lso = pw.last_stable_offset();
-    auto start_o = pw.start_offset();
-    // if we have no data read, return fast
-    if (hw < config.start_offset) {
-        return ss::make_ready_future<read_result>(start_o, hw, lso);
+static ss::io_priority_class
+read_priority(const fetch_config& config, model::offset hw) {
+    if (config.low_priority) {
+        return kafka_cold_read_priority();
+    }
+    auto max_lag = config::shard_local_cfg().fetch_cold_read_offset_lag();
+    if (max_lag > 0 && hw() - config.start_offset() > max_lag) {
+        return kafka_cold_read_priority();
     }
+    return kafka_read_priority();
+}
 
+static storage::log_reader_config
+make_reader_config(const fetch_config& config, ss::io_priority_class prio) {
     storage::log_reader_config reader_config(
       config.start_offset,
       model::model_limits<model::offset>::max(),
       0,
       config.max_bytes,
-      kafka_read_priority(),
+      prio,
       std::nullopt,
       std::nullopt,
       std::nullopt);
 
     reader_config.strict_max_bytes = config.strict_max_bytes;
+    return reader_config;
+}
+
+/**
+ * Materializes the batches of the reader into the read result.
+ */
+static ss::future<read_result> read_batches(
+  partition_wrapper pw,
+  model::record_batch_reader rdr,
+  const fetch_config& config,
+  bool foreign_read,
+  std::optional<model::timeout_clock::time_point> deadline) {
+    auto hw = pw.high_watermark();
+    auto lso = pw.last_stable_offset();
+    auto start_o = pw.start_offset();
+    return model::transform_reader_to_memory(
+             std::move(rdr),
+             deadline.value_or(model::no_timeout),
+             adapt_fetch_batch)
+      .then([foreign_read,
+             pw,
+             source = config.request_shard,
+             start_o,
+             hw,
+             lso](ss::circular_buffer<model::record_batch> data) mutable {
+          cpu_accounting::topic_charge charge(pw.ntp().tp.topic);
+          size_t size_bytes = 0;
+          for (const auto& b : data) {
+              size_bytes += b.size_bytes();
+          }
+          pw.probe().add_bytes_fetched(size_bytes);
+          pw.probe().add_request_bytes(source, size_bytes);
+          // if we are on remote core, we MUST use foreign record batch
+          // reader.
+          auto rdr = foreign_read
+                       ? model::make_foreign_memory_record_batch_reader(
+                         std::move(data))
+                       : model::make_memory_record_batch_reader(
+                         std::move(data));
+          read_result res(std::move(rdr), start_o, hw, lso);
+          res.size_bytes = size_bytes;
+          return res;
+      });
+}
+
+/**
+ * Serializes the batches of a passthrough read to the kafka wire format as
+ * the log reader hands them over. The records of data batches are linked
+ * into the response as the slices of the segment read buffers that hold
+ * them. Other batches take the fetch adapter first.
+ */
+class passthrough_serializer final : public storage::passthrough_sink {
+public:
+    passthrough_serializer() noexcept
+      : _wr(_buf) {}
+
+    void append(const model::record_batch_header& h, iobuf records) final {
+        if (likely(h.type == raft::data_batch_type)) {
+            _size_bytes += h.size_bytes;
+            writer_serialize_batch(_wr, h, std::move(records));
+            return;
+        }
+        auto batch = adapt_fetch_batch(model::record_batch(
+          h, std::move(records), model::record_batch::tag_ctor_ng{}));
+        _size_bytes += batch.size_bytes();
+        writer_serialize_batch(_wr, std::move(batch));
+    }
+
+    size_t size_bytes() const { return _size_bytes; }
+
+    iobuf release() && { return std::move(_buf); }
+
+private:
+    iobuf _buf;
+    response_writer _wr;
+    size_t _size_bytes{0};
+};
+
+/**
+ * Appends the batches a reader returns rather than hands over, e.g. those of
+ * a log which does not read in passthrough mode.
+ */
+struct passthrough_consumer {
+    ss::future<ss::stop_iteration> operator()(model::record_batch&& batch) {
+        auto header = batch.header();
+        sink.append(header, std::move(batch).release_data());
+        return ss::make_ready_future<ss::stop_iteration>(
+          ss::stop_iteration::no);
+    }
+
+    void end_of_stream() {}
+
+    passthrough_serializer& sink;
+};
+
+/**
+ * Reads the batches of the partition straight into the kafka wire format,
+ * without creating the batches and the readers to move them to the shard of
+ * the request.
+ */
+static ss::future<read_result> read_passthrough(
+  partition_wrapper pw,
+  storage::log_reader_config reader_config,
+  std::optional<model::timeout_clock::time_point> deadline,
+  ss::shard_id source) {
+    auto sink = std::make_unique<passthrough_serializer>();
+    reader_config.passthrough = sink.get();
+    auto hw = pw.high_watermark();
+    auto lso = pw.last_stable_offset();
+    auto start_o = pw.start_offset();
     return pw.make_reader(reader_config)
-      .then([start_o, hw, lso, foreign_read, deadline](
-              model::record_batch_reader rdr) {
-          return model::transform_reader_to_memory(
-                   std::move(rdr),
-                   deadline.value_or(model::no_timeout),
-                   adapt_fetch_batch)
-            .then([foreign_read](
-                    ss::circular_buffer<model::record_batch> data) {
-                // if we are on remote core, we MUST use foreign record batch
-                // reader.
-                if (foreign_read) {
-                    return model::make_foreign_memory_record_batch_reader(
-                      std::move(data));
-                }
-                return model::make_memory_record_batch_reader(std::move(data));
-            })
-            .then([start_o, hw, lso](model::record_batch_reader rdr) {
-                return read_result(std::move(rdr), start_o, hw, lso);
-            });
+      .then([s = sink.get(), deadline](model::record_batch_reader rdr) {
+          return std::move(rdr).consume(
+            passthrough_consumer{.sink = *s},
+            deadline.value_or(model::no_timeout));
+      })
+      .then([pw, sink = std::move(sink), source, start_o, hw, lso]() mutable {
+          cpu_accounting::topic_charge charge(pw.ntp().tp.topic);
+          auto size_bytes = sink->size_bytes();
+          pw.probe().add_bytes_fetched(size_bytes);
+          pw.probe().add_request_bytes(source, size_bytes);
+          read_result res(std::move(*sink).release(), start_o, hw, lso);
+          res.size_bytes = size_bytes;
+          return res;
+      });
+}
+
+/**
+ * Low-level handler for reading from an ntp. Runs on ntp's home core.
+ */
+static ss::future<read_result> read_from_partition(
+  partition_wrapper pw,
+  fetch_config config,
+  bool foreign_read,
+  std::optional<model::timeout_clock::time_point> deadline) {
+    auto hw = pw.high_watermark();
+    // if we have no data read or no budget left to read it, return fast
+    if (hw < config.start_offset || config.max_bytes == 0) {
+        return ss::make_ready_future<read_result>(
+          pw.start_offset(), hw, pw.last_stable_offset());
+    }
+
+    auto reader_config = make_reader_config(config, read_priority(config, hw));
+    if (config.passthrough) {
+        return read_passthrough(
+          std::move(pw), reader_config, deadline, config.request_shard);
+    }
+    return pw.make_reader(reader_config)
+      .then([pw, config, foreign_read, deadline](
+              model::record_batch_reader rdr) mutable {
+          return read_batches(
+            std::move(pw), std::move(rdr), config, foreign_read, deadline);
       });
 }
 
+/**
+ * The offsets below the local start offset of the partition are read from
+ * the remote reader of the partition manager, e.g. the segments archived to
+ * S3. They are out of range when it has no data there.
+ */
+static ss::future<read_result> read_from_remote(
+  cluster::partition_manager& mgr,
+  partition_wrapper pw,
+  fetch_config config,
+  bool foreign_read,
+  std::optional<model::timeout_clock::time_point> deadline) {
+    if (config.max_bytes == 0) {
+        return ss::make_ready_future<read_result>(
+          pw.start_offset(), pw.high_watermark(), pw.last_stable_offset());
+    }
+    return mgr
+      .make_remote_reader(
+        pw.ntp(), make_reader_config(config, kafka_cold_read_priority()))
+      .then([pw, config, foreign_read, deadline](
+              std::optional<model::record_batch_reader> rdr) mutable {
+          if (!rdr) {
+              return ss::make_ready_future<read_result>(
+                error_code::offset_out_of_range);
+          }
+          return read_batches(
+            std::move(pw), std::move(*rdr), config, foreign_read, deadline);
+      });
+}
+
+/**
+ * A materialized topic is read from the local log next to the partition of its
+ * source topic, unless it was created in the cluster for the replicated
+ * outputs of a coprocessor, then it is read as any other topic.
+ */
+static ss::lw_shared_ptr<cluster::partition> get_fetch_partition(
+  cluster::partition_manager& mgr, const model::materialized_ntp& mntp) {
+    if (mntp.is_materialized()) {
+        if (auto partition = mgr.get(mntp.input_ntp()); partition) {
+            return partition;
+        }
+    }
+    return mgr.get(mntp.source_ntp());
+}
+
+static bool reads_local_log(
+  const model::materialized_ntp& mntp,
+  const cluster::partition& partition) {
+    return mntp.is_materialized() && partition.ntp() != mntp.input_ntp();
+}
+
 std::optional<partition_wrapper> make_partition_wrapper(
   const model::materialized_ntp& mntp,
   ss::lw_shared_ptr<cluster::partition> partition,
   cluster::partition_manager& pm) {
-    if (mntp.is_materialized()) {
+    if (reads_local_log(mntp, *partition)) {
         if (auto log = pm.log(mntp.input_ntp()); log) {
             return partition_wrapper(partition, log);
         }
@@ -432,17 +624,41 @@ ss::future<read_result> read_from_ntp(
   fetch_config config,
   bool foreign_read,
   std::optional<model::timeout_clock::time_point> deadline) {
+    cpu_accounting::topic_charge charge(ntp.source_ntp().tp.topic);
     /*
      * lookup the ntp's partition
      */
-    auto partition = mgr.get(ntp.source_ntp());
+    auto partition = get_fetch_partition(mgr, ntp);
     if (unlikely(!partition)) {
         return ss::make_ready_future<read_result>(
           error_code::unknown_topic_or_partition);
     }
+    if (auto ec = details::check_leader_epoch(
+          *partition, config.current_leader_epoch);
+        unlikely(ec != error_code::none)) {
+        return ss::make_ready_future<read_result>(ec);
+    }
     if (unlikely(!partition->is_leader())) {
-        return ss::make_ready_future<read_result>(
-          error_code::not_leader_for_partition);
+        // followers serve the data they know to be visible on the leader
+        auto& cfg = config::shard_local_cfg();
+        if (
+          !cfg.fetch_from_followers()
+          || !partition->can_serve_follower_reads(
+            cfg.fetch_follower_max_staleness_ms())) {
+            return ss::make_ready_future<read_result>(
+              error_code::not_leader_for_partition);
+        }
+    } else if (config.consumer_rack) {
+        auto replica = partition->preferred_read_replica(*config.consumer_rack);
+        auto self = model::node_id(config::shard_local_cfg().node_id());
+        if (replica && *replica != self) {
+            read_result res(
+              partition->start_offset(),
+              partition->high_watermark(),
+              partition->last_stable_offset());
+            res.preferred_replica = replica;
+            return ss::make_ready_future<read_result>(std::move(res));
+        }
     }
     auto partition_wpr = make_partition_wrapper(ntp, partition, mgr);
     if (!partition_wpr) {
@@ -453,12 +669,18 @@ ss::future<read_result> read_from_ntp(
     auto high_watermark = partition->high_watermark();
     auto max_offset = high_watermark < model::offset(0) ? model::offset(0)
                                                         : high_watermark;
-    if (
-      config.start_offset < partition->start_offset()
-      || config.start_offset > max_offset) {
+    if (config.start_offset > max_offset) {
         return ss::make_ready_future<read_result>(
           error_code::offset_out_of_range);
     }
+    if (config.start_offset < partition->start_offset()) {
+        if (reads_local_log(ntp, *partition)) {
+            return ss::make_ready_future<read_result>(
+              error_code::offset_out_of_range);
+        }
+        return read_from_remote(
+          mgr, *partition_wpr, config, foreign_read, deadline);
+    }
 
     return read_from_partition(*partition_wpr, config, foreign_read, deadline);
 }
@@ -472,9 +694,30 @@ static ss::future<> do_fill_fetch_responses(
         auto& resp_it = responses[idx];
         vlog(klog.trace, "fetch reader {}", res.reader);
         // error case
-        if (!res.reader) {
-            resp_it.set(
-              make_partition_response_error(res.partition, res.error));
+        if (!res.reader && !res.data) {
+            auto resp = make_partition_response_error(res.partition, res.error);
+            if (res.preferred_replica) {
+                resp.preferred_read_replica = *res.preferred_replica;
+            }
+            resp_it.set(std::move(resp));
+            resp_it->partition_response->log_start_offset = res.start_offset;
+            resp_it->partition_response->high_watermark = res.high_watermark;
+            resp_it->partition_response->last_stable_offset
+              = res.last_stable_offset;
+            return ss::now();
+        }
+        if (res.data) {
+            // the serialized batches of a remote core are copied
+            auto& data = *res.data;
+            iobuf records = data.get_owner_shard() == ss::this_shard_id()
+                              ? std::move(*data)
+                              : data->copy();
+            fetch_response::partition_response resp{
+              .id = res.partition,
+              .error = error_code::none,
+              .record_set = batch_reader(std::move(records)),
+            };
+            resp_it.set(std::move(resp));
             resp_it->partition_response->log_start_offset = res.start_offset;
             resp_it->partition_response->high_watermark = res.high_watermark;
             resp_it->partition_response->last_stable_offset
@@ -482,7 +725,7 @@ static ss::future<> do_fill_fetch_responses(
             return ss::now();
         }
         return std::move(*res.reader)
-          .consume(kafka_batch_serializer(), model::no_timeout)
+          .consume_slices(kafka_batch_serializer(), model::no_timeout)
           .then(
             [so = res.start_offset,
              hw = res.high_watermark,
@@ -533,26 +776,136 @@ static ss::future<> fill_fetch_responsens(
       });
 }
 
-static ss::future<std::vector<read_result>> fetch_ntps_in_parallel(
+std::vector<size_t>
+plan_fetch_budgets(const std::vector<size_t>& wanted, size_t budget) {
+    std::vector<size_t> order(wanted.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&wanted](size_t a, size_t b) {
+        return wanted[a] < wanted[b];
+    });
+    std::vector<size_t> budgets(wanted.size(), 0);
+    size_t left = wanted.size();
+    for (auto i : order) {
+        budgets[i] = std::min(wanted[i], budget / left);
+        budget -= budgets[i];
+        --left;
+    }
+    return budgets;
+}
+
+/**
+ * Bounds the reads of the partitions of a shard by the fetch budget, before
+ * any of them is issued. Partitions with no data past their fetch offset keep
+ * their limits, they return without reading.
+ */
+static void plan_shard_reads(
+  cluster::partition_manager& mgr,
+  std::vector<ntp_fetch_config>& configs,
+  size_t budget) {
+    std::vector<size_t> wanted;
+    wanted.reserve(configs.size());
+    for (auto& [ntp, cfg] : configs) {
+        size_t available = 0;
+        if (auto partition = get_fetch_partition(mgr, ntp); partition) {
+            if (auto pw = make_partition_wrapper(ntp, partition, mgr); pw) {
+                available = pw->estimate_bytes_from(cfg.start_offset);
+            }
+        }
+        wanted.push_back(std::min(available, cfg.max_bytes));
+    }
+    auto budgets = plan_fetch_budgets(wanted, budget);
+    for (size_t i = 0; i < configs.size(); ++i) {
+        if (wanted[i] > 0) {
+            configs[i].second.max_bytes = budgets[i];
+        }
+    }
+}
+
+/**
+ * Results of the reads of a shard and the read memory they hold on it, which
+ * is released once they are serialized.
+ */
+struct shard_read_results {
+    std::vector<read_result> results;
+    ss::foreign_ptr<std::unique_ptr<fetch_read_memory::reservation>> memory;
+};
+
+/**
+ * Reserves the shard read memory for the reads of a fetch. When less than
+ * the fetch wants is granted, the partitions read less, each in proportion
+ * of its share of the grant.
+ */
+static fetch_read_memory::reservation reserve_shard_reads(
+  cluster::partition_manager& mgr,
+  std::vector<ntp_fetch_config>& configs,
+  size_t budget) {
+    auto& cfg = config::shard_local_cfg();
+    auto& memory = fetch_memory();
+    memory.set_capacity(cfg.fetch_read_memory_per_shard());
+
+    size_t wanted = 0;
+    for (const auto& c : configs) {
+        wanted += c.second.max_bytes;
+    }
+    wanted = std::min(wanted, budget);
+    auto reservation = memory.reserve(wanted);
+
+    if (cfg.fetch_read_planning() && configs.size() > 1) {
+        plan_shard_reads(mgr, configs, reservation.granted());
+    } else if (reservation.granted() < wanted) {
+        std::vector<size_t> limits;
+        limits.reserve(configs.size());
+        for (const auto& c : configs) {
+            limits.push_back(c.second.max_bytes);
+        }
+        auto budgets = plan_fetch_budgets(limits, reservation.granted());
+        for (size_t i = 0; i < configs.size(); ++i) {
+            configs[i].second.max_bytes = budgets[i];
+        }
+    }
+    return reservation;
+}
+
+static ss::future<shard_read_results> fetch_ntps_in_parallel(
   cluster::partition_manager& mgr,
   std::vector<ntp_fetch_config> ntp_fetch_configs,
   bool foreign_read,
-  std::optional<model::timeout_clock::time_point> deadline) {
+  std::optional<model::timeout_clock::time_point> deadline,
+  size_t budget) {
+    auto memory = std::make_unique<fetch_read_memory::reservation>(
+      reserve_shard_reads(mgr, ntp_fetch_configs, budget));
     return ss::do_with(
-      std::move(ntp_fetch_configs),
-      [&mgr, deadline, foreign_read](
-        std::vector<ntp_fetch_config>& ntp_fetch_configs) {
-          return ssx::async_transform(
-            ntp_fetch_configs,
-            [&mgr, deadline, foreign_read](ntp_fetch_config cfg) {
-                auto p_id = cfg.first.source_ntp().tp.partition;
-                return read_from_ntp(
-                         mgr, cfg.first, cfg.second, foreign_read, deadline)
-                  .then([p_id](read_result res) {
-                      res.partition = p_id;
-                      return res;
-                  });
-            });
+             std::move(ntp_fetch_configs),
+             [&mgr, deadline, foreign_read](
+               std::vector<ntp_fetch_config>& ntp_fetch_configs) {
+                 return ssx::async_transform(
+                   ntp_fetch_configs,
+                   [&mgr, deadline, foreign_read](ntp_fetch_config cfg) {
+                       auto p_id = cfg.first.source_ntp().tp.partition;
+                       return read_from_ntp(
+                                mgr,
+                                cfg.first,
+                                cfg.second,
+                                foreign_read,
+                                deadline)
+                         .then([p_id](read_result res) {
+                             res.partition = p_id;
+                             return res;
+                         });
+                   });
+             })
+      .then([memory = std::move(memory)](
+              std::vector<read_result> results) mutable {
+          // the reads hold what they returned, which may be more than the
+          // grant when a partition returns its first batch past its limit
+          size_t size_bytes = 0;
+          for (const auto& r : results) {
+              size_bytes += r.size_bytes;
+          }
+          memory->resize(size_bytes);
+          return shard_read_results{
+            .results = std::move(results),
+            .memory = ss::make_foreign(std::move(memory))};
       });
 }
 
@@ -583,26 +936,41 @@ handle_shard_fetch(ss::shard_id shard, op_context& octx, shard_fetch fetch) {
         octx.ssg,
         [foreign_read,
          deadline = octx.deadline,
+         budget = octx.bytes_left,
          configs = std::move(fetch.requests)](
           cluster::partition_manager& mgr) mutable {
             return fetch_ntps_in_parallel(
-              mgr, std::move(configs), foreign_read, deadline);
+              mgr, std::move(configs), foreign_read, deadline, budget);
         })
       .then([responses = std::move(fetch.responses)](
-              std::vector<read_result> results) mutable {
+              shard_read_results reads) mutable {
           return fill_fetch_responsens(
-            std::move(results), std::move(responses));
+                   std::move(reads.results), std::move(responses))
+            .finally([memory = std::move(reads.memory)] {});
       });
 }
 
+static bool is_low_priority_principal(request_context& rctx) {
+    auto& sasl = rctx.sasl();
+    if (!sasl.complete() || !sasl.has_mechanism()) {
+        return false;
+    }
+    const auto& principals
+      = config::shard_local_cfg().fetch_low_priority_principals();
+    return std::find(principals.begin(), principals.end(), sasl.principal())
+           != principals.end();
+}
+
 static std::vector<shard_fetch> group_requests_by_shard(op_context& octx) {
     std::vector<shard_fetch> shard_fetches(ss::smp::count);
     auto resp_it = octx.response_begin();
+    const bool low_priority = is_low_priority_principal(octx.rctx);
     /**
      * group fetch requests by shard
      */
     octx.for_each_fetch_partition(
-      [&resp_it, &octx, &shard_fetches](const fetch_partition& fp) {
+      [&resp_it, &octx, &shard_fetches, low_priority](
+        const fetch_partition& fp) {
           // if this is not an initial fetch we are allowed to skip
           // partions that aleready have an error or we have enough data
           if (!octx.initial_fetch) {
@@ -623,11 +991,22 @@ static std::vector<shard_fetch> group_requests_by_shard(op_context& octx) {
               return;
           }
 
+          // nothing was appended since the session read the partition last
+          if (fp.caught_up) {
+              resp_it->partition_response->has_to_be_included = false;
+              ++resp_it;
+              return;
+          }
+
           auto ntp = model::ntp(model::kafka_namespace, fp.topic, fp.partition);
           auto materialized_ntp = model::materialized_ntp(std::move(ntp));
 
           auto shard = octx.rctx.shards().shard_for(
-            materialized_ntp.source_ntp());
+            materialized_ntp.input_ntp());
+          if (!shard && materialized_ntp.is_materialized()) {
+              shard = octx.rctx.shards().shard_for(
+                materialized_ntp.source_ntp());
+          }
           if (!shard) {
               // no shard found, set error
               (resp_it).set(make_partition_response_error(
@@ -638,10 +1017,19 @@ static std::vector<shard_fetch> group_requests_by_shard(op_context& octx) {
 
           fetch_config config{
             .start_offset = fp.fetch_offset,
+            .current_leader_epoch = fp.current_leader_epoch,
             .max_bytes = std::min(octx.bytes_left, size_t(fp.max_bytes)),
             .timeout = octx.deadline.value_or(model::no_timeout),
             .strict_max_bytes = octx.response_size > 0,
+            .passthrough = config::shard_local_cfg().fetch_passthrough_reads(),
+            .low_priority = low_priority,
           };
+          if (
+            config::shard_local_cfg().fetch_from_followers()
+            && octx.rctx.header().version >= api_version(11)
+            && !octx.request.rack_id.empty()) {
+              config.consumer_rack = octx.request.rack_id;
+          }
           shard_fetches[*shard].push_back(
             std::move(materialized_ntp), config, resp_it++);
       });
@@ -649,6 +1037,120 @@ static std::vector<shard_fetch> group_requests_by_shard(op_context& octx) {
     return shard_fetches;
 }
 
+namespace {
+/// partition of a parked fetch and the offset it is waiting to become visible
+struct append_watch {
+    model::ntp ntp;
+    model::offset offset;
+};
+
+/// completes on the first wake up, later ones are ignored
+struct append_waiter {
+    ss::promise<> woken;
+    bool done = false;
+
+    void wake() {
+        if (!done) {
+            done = true;
+            woken.set_value();
+        }
+    }
+};
+} // namespace
+
+/**
+ * Resolves once any of the watched partitions has new data visible to
+ * consumers or the deadline passes. Runs on the partitions home shard.
+ */
+static ss::future<> wait_for_any_append(
+  cluster::partition_manager& mgr,
+  std::vector<append_watch> watches,
+  model::timeout_clock::time_point deadline) {
+    auto waiter = ss::make_lw_shared<append_waiter>();
+    auto f = waiter->woken.get_future();
+    for (auto& w : watches) {
+        auto partition = mgr.get(w.ntp);
+        if (
+          !partition
+          || (!partition->is_leader()
+              && !config::shard_local_cfg().fetch_from_followers())) {
+            // leadership moved, read again to report the error
+            waiter->wake();
+            break;
+        }
+        (void)partition->wait_for_high_watermark_above(w.offset, deadline)
+          .then_wrapped([waiter, partition](ss::future<> f) {
+              // timeouts and aborts wake the fetch as well
+              f.ignore_ready_future();
+              waiter->wake();
+          });
+    }
+    return f;
+}
+
+/**
+ * Parks the fetch until the high watermark of any of its partitions moves or
+ * the deadline passes. Materialized partitions are not backed by raft and are
+ * still polled with the debounce timeout.
+ */
+static ss::future<> wait_for_appends(op_context& octx) {
+    std::vector<std::vector<append_watch>> watches(ss::smp::count);
+    bool poll = false;
+    bool empty = true;
+    auto resp_it = octx.response_begin();
+    octx.for_each_fetch_partition([&](const fetch_partition& fp) {
+        auto& resp = *(resp_it++)->partition_response;
+        if (resp.has_error()) {
+            return;
+        }
+        auto mntp = model::materialized_ntp(
+          model::ntp(model::kafka_namespace, fp.topic, fp.partition));
+        if (mntp.is_materialized()) {
+            poll = true;
+            return;
+        }
+        auto shard = octx.rctx.shards().shard_for(mntp.source_ntp());
+        if (!shard) {
+            return;
+        }
+        watches[*shard].push_back(append_watch{
+          .ntp = mntp.source_ntp(),
+          .offset = std::max(fp.fetch_offset, resp.high_watermark),
+        });
+        empty = false;
+    });
+
+    if (poll || empty) {
+        return ss::sleep(std::min(
+          config::shard_local_cfg().fetch_reads_debounce_timeout(),
+          octx.request.max_wait_time));
+    }
+
+    auto waiter = ss::make_lw_shared<append_waiter>();
+    auto f = waiter->woken.get_future();
+    auto deadline = octx.deadline.value_or(model::no_timeout);
+    for (ss::shard_id shard = 0; shard < watches.size(); ++shard) {
+        if (watches[shard].empty()) {
+            continue;
+        }
+        // waits on the other shards end on their own at the deadline at
+        // the latest, they do not hold any state of the request
+        (void)octx.rctx.partition_manager()
+          .invoke_on(
+            shard,
+            octx.ssg,
+            [deadline, w = std::move(watches[shard])](
+              cluster::partition_manager& mgr) mutable {
+                return wait_for_any_append(mgr, std::move(w), deadline);
+            })
+          .then_wrapped([waiter](ss::future<> f) {
+              f.ignore_ready_future();
+              waiter->wake();
+          });
+    }
+    return f;
+}
+
 /**
  * Process partition fetch requests.
  *
@@ -691,6 +1193,9 @@ static ss::future<> fetch_topic_partitions(op_context& octx) {
                     return ss::now();
                 }
                 octx.reset_context();
+                if (config::shard_local_cfg().enable_fetch_long_poll()) {
+                    return wait_for_appends(octx);
+                }
                 // debounce next read retry
                 return ss::sleep(std::min(
                   config::shard_local_cfg().fetch_reads_debounce_timeout(),
@@ -731,7 +1236,9 @@ op_context::op_context(request_context&& ctx, ss::smp_service_group ssg)
     /*
      * decode request and prepare the inital response
      */
+    auto decode_started = stage_latencies().start();
     request.decode(rctx);
+    stage_latencies().record(request_stage::decode, decode_started);
     if (likely(!request.topics.empty())) {
         response.partitions.reserve(request.topics.size());
     }
@@ -800,6 +1307,61 @@ void op_context::create_response_placeholders() {
     }
 }
 
+/**
+ * Incremental fetches skip reading the partitions of the session that are
+ * caught up. A partition is marked once a read returned no data at the high
+ * watermark, a watch on its home shard clears the mark when new data becomes
+ * visible. The watch also expires after fetch_caught_up_recheck_interval_ms
+ * so that leadership changes and errors are eventually reported.
+ */
+static void maybe_watch_caught_up(
+  op_context& octx,
+  fetch_partition& fp,
+  const fetch_response::partition_response& resp) {
+    if (
+      fp.caught_up || resp.has_error() || resp.high_watermark < model::offset(0)
+      || fp.fetch_offset < resp.high_watermark
+      || (resp.record_set && resp.record_set->size_bytes() > 0)) {
+        return;
+    }
+    auto mntp = model::materialized_ntp(
+      model::ntp(model::kafka_namespace, fp.topic, fp.partition));
+    if (mntp.is_materialized()) {
+        return;
+    }
+    auto shard = octx.rctx.shards().shard_for(mntp.source_ntp());
+    if (!shard) {
+        return;
+    }
+    fp.caught_up = true;
+    auto deadline
+      = model::timeout_clock::now()
+        + config::shard_local_cfg().fetch_caught_up_recheck_interval_ms();
+    (void)octx.rctx.partition_manager()
+      .invoke_on(
+        *shard,
+        octx.ssg,
+        [ntp = mntp.source_ntp(), offset = resp.high_watermark, deadline](
+          cluster::partition_manager& mgr) {
+            auto partition = mgr.get(ntp);
+            if (!partition || !partition->is_leader()) {
+                return ss::now();
+            }
+            return partition->wait_for_high_watermark_above(offset, deadline)
+              .finally([partition] {});
+        })
+      .then_wrapped([session = octx.session_ctx.session(),
+                     topic = fp.topic,
+                     p_id = fp.partition](ss::future<> f) {
+          f.ignore_ready_future();
+          auto it = session->partitions().find(
+            model::topic_partition_view(topic, p_id));
+          if (it != session->partitions().end()) {
+              it->second->partition.caught_up = false;
+          }
+      });
+}
+
 bool update_fetch_partition(
   const fetch_response::partition_response& resp, fetch_partition& partition) {
     bool include = false;
@@ -876,7 +1438,10 @@ void op_context::response_iterator::set(
       _it->partition_response->id,
       response.id);
 
-    if (response.has_error()) {
+    // neither errors nor redirects to another replica wait for more data
+    if (
+      response.has_error()
+      || response.preferred_read_replica != model::node_id(-1)) {
         _ctx->response_error = true;
     }
     auto& current_resp_data = _it->partition_response->record_set;
@@ -905,6 +1470,8 @@ void op_context::response_iterator::set(
               *_it->partition_response, it->second->partition);
 
             _it->partition_response->has_to_be_included = has_to_be_included;
+            maybe_watch_caught_up(
+              *_ctx, it->second->partition, *_it->partition_response);
         }
     }
 }
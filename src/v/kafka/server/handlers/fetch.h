@@ -16,4 +16,8 @@ namespace kafka {
 
 using fetch_handler = handler<fetch_api, 4, 11>;
 
+/// Internal batches as kafka control batches without payload, data batches
+/// are passed through
+model::record_batch adapt_fetch_batch(model::record_batch&&);
+
 }
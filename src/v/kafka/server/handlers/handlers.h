@@ -16,6 +16,7 @@
 #include "kafka/server/handlers/create_topics.h"
 #include "kafka/server/handlers/delete_acls.h"
 #include "kafka/server/handlers/delete_groups.h"
+#include "kafka/server/handlers/delete_records.h"
 #include "kafka/server/handlers/delete_topics.h"
 #include "kafka/server/handlers/describe_acls.h"
 #include "kafka/server/handlers/describe_configs.h"
@@ -33,6 +34,7 @@
 #include "kafka/server/handlers/metadata.h"
 #include "kafka/server/handlers/offset_commit.h"
 #include "kafka/server/handlers/offset_fetch.h"
+#include "kafka/server/handlers/offset_for_leader_epoch.h"
 #include "kafka/server/handlers/produce.h"
 #include "kafka/server/handlers/sasl_authenticate.h"
 #include "kafka/server/handlers/sasl_handshake.h"
@@ -41,11 +41,6 @@ ss::future<response_ptr> join_group_handler::handle(
   request_context ctx, [[maybe_unused]] ss::smp_service_group g) {
     join_group_request request(ctx);
 
-    if (request.data.group_instance_id) {
-        co_return co_await ctx.respond(
-          join_group_response(error_code::unsupported_version));
-    }
-
     if (!ctx.authorized(security::acl_operation::read, request.data.group_id)) {
         co_return co_await ctx.respond(
           join_group_response(error_code::group_authorization_failed));
@@ -14,6 +14,6 @@
 
 namespace kafka {
 
-using list_groups_handler = handler<list_groups_api, 0, 2>;
+using list_groups_handler = handler<list_groups_api, 0, 3>;
 
 }
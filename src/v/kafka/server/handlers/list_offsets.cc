@@ -18,6 +18,15 @@
 #include "model/namespace.h"
 #include "resource_mgmt/io_priority.h"
 
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/loop.hh>
+
+#include <absl/container/flat_hash_map.h>
+
+#include <optional>
+#include <utility>
+#include <vector>
+
 namespace kafka {
 
 void list_offsets_request::compute_duplicate_topics() {
@@ -48,7 +57,10 @@ void list_offsets_response::encode(const request_context& ctx, response& resp) {
             }
         }
     }
-    data.encode(resp.writer(), ctx.header().version);
+    resp.encode_presized([this, version = ctx.header().version](
+                           response_writer& writer) {
+        data.encode(writer, version);
+    });
 }
 
 struct list_offsets_ctx {
@@ -69,132 +81,183 @@ struct list_offsets_ctx {
       , unauthorized_topics(std::move(unauthorized_topics)) {}
 };
 
-static ss::future<list_offset_partition_response> list_offsets_partition(
-  list_offsets_ctx& octx,
-  model::timestamp timestamp,
-  list_offset_topic& topic,
-  list_offset_partition& part) {
-    auto ntp = model::ntp(
-      model::kafka_namespace,
-      model::get_source_topic(topic.name),
-      part.partition_index);
-
-    auto shard = octx.rctx.shards().shard_for(ntp);
-    if (!shard) {
-        return ss::make_ready_future<list_offset_partition_response>(
-          list_offsets_response::make_partition(
-            ntp.tp.partition, error_code::unknown_topic_or_partition));
+/*
+ * A partition of the request, answered on the shard of the partition
+ */
+struct partition_query {
+    model::ntp ntp;
+    model::timestamp timestamp;
+};
+
+/*
+ * The answer to the query if it does not need a timequery
+ */
+static std::optional<list_offset_partition_response> answer_without_timequery(
+  const ss::lw_shared_ptr<cluster::partition>& partition,
+  model::isolation_level isolation_lvl,
+  const partition_query& q) {
+    const auto id = q.ntp.tp.partition;
+    if (!partition) {
+        return list_offsets_response::make_partition(
+          id, error_code::unknown_topic_or_partition);
     }
 
-    return octx.rctx.partition_manager().invoke_on(
-      *shard,
-      octx.ssg,
-      [timestamp,
-       ntp = std::move(ntp),
-       isolation_lvl = model::isolation_level(
-         octx.request.data.isolation_level)](cluster::partition_manager& mgr) {
-          auto partition = mgr.get(ntp);
-          if (!partition) {
-              return ss::make_ready_future<list_offset_partition_response>(
-                list_offsets_response::make_partition(
-                  ntp.tp.partition, error_code::unknown_topic_or_partition));
-          }
+    if (!partition->is_leader()) {
+        return list_offsets_response::make_partition(
+          id, error_code::not_leader_for_partition);
+    }
 
-          if (!partition->is_leader()) {
-              return ss::make_ready_future<list_offset_partition_response>(
-                list_offsets_response::make_partition(
-                  ntp.tp.partition, error_code::not_leader_for_partition));
-          }
+    /*
+     * the responses for earliest/latest timestamp queries do not require
+     * that the actual timestamp be returned. only the offset is required.
+     */
+    if (q.timestamp == list_offsets_request::earliest_timestamp) {
+        return list_offsets_response::make_partition(
+          id, model::timestamp(-1), partition->start_offset());
 
-          /*
-           * the responses for earliest/latest timestamp queries do not require
-           * that the actual timestamp be returned. only the offset is required.
-           */
-          if (timestamp == list_offsets_request::earliest_timestamp) {
-              return ss::make_ready_future<list_offset_partition_response>(
-                list_offsets_response::make_partition(
-                  ntp.tp.partition,
-                  model::timestamp(-1),
-                  partition->start_offset()));
-
-          } else if (timestamp == list_offsets_request::latest_timestamp) {
-              const auto offset = isolation_lvl
-                                      == model::isolation_level::read_committed
-                                    ? partition->last_stable_offset()
-                                    : partition->high_watermark();
-
-              return ss::make_ready_future<list_offset_partition_response>(
-                list_offsets_response::make_partition(
-                  ntp.tp.partition, model::timestamp(-1), offset));
-          }
+    } else if (q.timestamp == list_offsets_request::latest_timestamp) {
+        const auto offset = isolation_lvl
+                                == model::isolation_level::read_committed
+                              ? partition->last_stable_offset()
+                              : partition->high_watermark();
+        return list_offsets_response::make_partition(
+          id, model::timestamp(-1), offset);
+    }
+    return std::nullopt;
+}
 
-          return partition->timequery(timestamp, kafka_read_priority())
-            .then([partition, id = ntp.tp.partition](
-                    std::optional<storage::timequery_result> res) {
-                if (res) {
-                    return ss::make_ready_future<
-                      list_offset_partition_response>(
-                      list_offsets_response::make_partition(
-                        id, res->time, res->offset));
-                }
-                return ss::make_ready_future<list_offset_partition_response>(
-                  list_offsets_response::make_partition(
-                    id, model::timestamp(-1), partition->last_stable_offset()));
-            });
-      });
+static ss::future<list_offset_partition_response>
+timequery(ss::lw_shared_ptr<cluster::partition> partition, partition_query q) {
+    auto res = co_await partition->timequery(
+      q.timestamp, kafka_read_priority());
+    if (res) {
+        co_return list_offsets_response::make_partition(
+          q.ntp.tp.partition, res->time, res->offset);
+    }
+    co_return list_offsets_response::make_partition(
+      q.ntp.tp.partition,
+      model::timestamp(-1),
+      partition->last_stable_offset());
 }
 
-static ss::future<list_offset_topic_response>
-list_offsets_topic(list_offsets_ctx& octx, list_offset_topic& topic) {
-    std::vector<ss::future<list_offset_partition_response>> partitions;
-    partitions.reserve(topic.partitions.size());
-
-    for (auto& part : topic.partitions) {
-        if (octx.request.duplicate_tp(topic.name, part.partition_index)) {
-            partitions.push_back(
-              ss::make_ready_future<list_offset_partition_response>(
-                list_offsets_response::make_partition(
-                  part.partition_index, error_code::invalid_request)));
+/*
+ * Answers all the queries of the request for the partitions of the shard.
+ * Earliest and latest offsets, the common queries, are answered right away.
+ */
+static ss::future<std::vector<list_offset_partition_response>>
+list_offsets_on_shard(
+  cluster::partition_manager& mgr,
+  model::isolation_level isolation_lvl,
+  std::vector<partition_query> queries) {
+    std::vector<list_offset_partition_response> ret(queries.size());
+    std::vector<ss::future<>> timequeries;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        auto partition = mgr.get(queries[i].ntp);
+        auto answer = answer_without_timequery(
+          partition, isolation_lvl, queries[i]);
+        if (answer) {
+            ret[i] = std::move(*answer);
             continue;
         }
+        timequeries.push_back(
+          timequery(std::move(partition), std::move(queries[i]))
+            .then([&ret, i](list_offset_partition_response r) {
+                ret[i] = std::move(r);
+            }));
+    }
+    if (!timequeries.empty()) {
+        co_await ss::when_all_succeed(timequeries.begin(), timequeries.end());
+    }
+    co_return ret;
+}
 
-        if (!octx.rctx.metadata_cache().contains(
-              model::topic_namespace_view(
-                model::kafka_namespace, model::get_source_topic(topic.name)),
-              part.partition_index)) {
-            partitions.push_back(
-              ss::make_ready_future<list_offset_partition_response>(
-                list_offsets_response::make_partition(
-                  part.partition_index,
-                  error_code::unknown_topic_or_partition)));
-            continue;
-        }
+/*
+ * The queries of the request for the partitions of one shard, with where their
+ * answers go in the response
+ */
+struct shard_queries {
+    std::vector<partition_query> queries;
+    std::vector<std::pair<size_t, size_t>> positions;
+};
 
-        auto pr = list_offsets_partition(octx, part.timestamp, topic, part);
-        partitions.push_back(std::move(pr));
-    }
+/*
+ * Builds the response of every topic, the partitions that need their shard
+ * get a placeholder which is filled once the shards answer. Every shard gets
+ * a single request for all of its partitions rather than one per partition.
+ */
+static ss::future<> list_offsets_topics(list_offsets_ctx& octx) {
+    auto& topics = octx.request.data.topics;
+    auto& response = octx.response.data.topics;
+    response.reserve(topics.size());
+    absl::flat_hash_map<ss::shard_id, shard_queries> shards;
 
-    return when_all_succeed(partitions.begin(), partitions.end())
-      .then([name = std::move(topic.name)](
-              std::vector<list_offset_partition_response> parts) mutable {
-          return list_offset_topic_response{
-            .name = std::move(name),
-            .partitions = std::move(parts),
-          };
-      });
-}
+    for (auto& topic : topics) {
+        std::vector<list_offset_partition_response> partitions;
+        partitions.reserve(topic.partitions.size());
 
-static std::vector<ss::future<list_offset_topic_response>>
-list_offsets_topics(list_offsets_ctx& octx) {
-    std::vector<ss::future<list_offset_topic_response>> topics;
-    topics.reserve(octx.request.data.topics.size());
+        auto view = octx.rctx.metadata_cache().find_topic_view(
+          model::topic_namespace_view(
+            model::kafka_namespace, model::get_source_topic(topic.name)));
 
-    for (auto& topic : octx.request.data.topics) {
-        auto tr = list_offsets_topic(octx, topic);
-        topics.push_back(std::move(tr));
+        for (auto& part : topic.partitions) {
+            if (octx.request.duplicate_tp(topic.name, part.partition_index)) {
+                partitions.push_back(list_offsets_response::make_partition(
+                  part.partition_index, error_code::invalid_request));
+                continue;
+            }
+
+            if (!view || !view->partition(part.partition_index)) {
+                partitions.push_back(list_offsets_response::make_partition(
+                  part.partition_index,
+                  error_code::unknown_topic_or_partition));
+                continue;
+            }
+
+            auto ntp = model::ntp(
+              model::kafka_namespace,
+              model::get_source_topic(topic.name),
+              part.partition_index);
+            auto shard = octx.rctx.shards().shard_for(ntp);
+            if (!shard) {
+                partitions.push_back(list_offsets_response::make_partition(
+                  part.partition_index,
+                  error_code::unknown_topic_or_partition));
+                continue;
+            }
+            auto& sq = shards[*shard];
+            sq.queries.push_back(partition_query{
+              .ntp = std::move(ntp), .timestamp = part.timestamp});
+            sq.positions.emplace_back(response.size(), partitions.size());
+            partitions.emplace_back();
+        }
+
+        response.push_back(list_offset_topic_response{
+          .name = std::move(topic.name),
+          .partitions = std::move(partitions),
+        });
     }
 
-    return topics;
+    const auto isolation_lvl = model::isolation_level(
+      octx.request.data.isolation_level);
+    co_await ss::parallel_for_each(
+      shards,
+      [&octx, isolation_lvl](
+        std::pair<const ss::shard_id, shard_queries>& e) -> ss::future<> {
+          auto& [shard, sq] = e;
+          auto answers = co_await octx.rctx.partition_manager().invoke_on(
+            shard,
+            octx.ssg,
+            [isolation_lvl, queries = std::move(sq.queries)](
+              cluster::partition_manager& mgr) mutable {
+                return list_offsets_on_shard(
+                  mgr, isolation_lvl, std::move(queries));
+            });
+          for (size_t i = 0; i < answers.size(); ++i) {
+              auto [t, p] = sq.positions[i];
+              octx.response.data.topics[t].partitions[p] = std::move(
+                answers[i]);
+          }
+      });
 }
 
 /*
@@ -244,13 +307,10 @@ list_offsets_handler::handle(request_context ctx, ss::smp_service_group ssg) {
       std::move(ctx), std::move(request), ssg, std::move(unauthorized_topics));
 
     return ss::do_with(std::move(octx), [](list_offsets_ctx& octx) {
-        auto topics = list_offsets_topics(octx);
-        return when_all_succeed(topics.begin(), topics.end())
-          .then([&octx](std::vector<list_offset_topic_response> topics) {
-              octx.response.data.topics = std::move(topics);
-              handle_unauthorized(octx);
-              return octx.rctx.respond(std::move(octx.response));
-          });
+        return list_offsets_topics(octx).then([&octx] {
+            handle_unauthorized(octx);
+            return octx.rctx.respond(std::move(octx.response));
+        });
     });
 }
 
@@ -29,8 +29,10 @@
 namespace kafka {
 
 void metadata_request::decode(request_context& ctx) {
-    auto version = ctx.header().version;
-    auto& reader = ctx.reader();
+    decode(ctx.reader(), ctx.header().version);
+}
+
+void metadata_request::decode(request_reader& reader, api_version version) {
     // For metadata request version 0 this array will always be present
     topics = reader.read_nullable_array(
       [](request_reader& r) { return model::topic(r.read_string()); });
@@ -43,7 +45,7 @@ void metadata_request::decode(request_context& ctx) {
         include_topic_authorized_operations = reader.read_bool();
     }
 
-    if (ctx.header().version > api_version(0)) {
+    if (version > api_version(0)) {
         list_all_topics = !topics;
     } else {
         // For metadata API version 0, empty array requests all topics
@@ -76,9 +78,15 @@ std::ostream& operator<<(std::ostream& o, const metadata_request& r) {
 }
 
 void metadata_response::encode(const request_context& ctx, response& resp) {
-    auto& writer = resp.writer();
-    auto version = ctx.header().version;
+    // the topics of a large cluster make for a large response
+    resp.encode_presized(
+      [this, version = ctx.header().version](response_writer& writer) {
+          encode(version, writer);
+      });
+}
 
+void metadata_response::encode(
+  api_version version, response_writer& writer) const {
     if (version >= api_version(3)) {
         writer.write(int32_t(throttle_time.count()));
     }
@@ -110,6 +118,10 @@ void metadata_response::encode(const request_context& ctx, response& resp) {
 
 void metadata_response::topic::encode(
   api_version version, response_writer& rw) const {
+    if (encoded) {
+        rw.write_direct(encoded->share(0, encoded->size_bytes()));
+        return;
+    }
     rw.write(err_code);
     rw.write(name);
     if (version >= api_version(1)) {
@@ -369,32 +381,63 @@ static metadata_response::topic make_topic_response(
     return res;
 }
 
+/**
+ * Returns response for a topic of the kafka namespace or nullopt if the topic
+ * does not exist. The encoded topic is reused as long as the metadata epoch
+ * does not change, unless the response depends on the requesting principal.
+ */
+static std::optional<metadata_response::topic> make_cached_topic_response(
+  request_context& ctx, metadata_request& rq, const model::topic& tp) {
+    auto version = ctx.header().version;
+    auto epoch = ctx.metadata_cache().metadata_epoch();
+    auto& cache = ctx.metadata_responses();
+    const bool cacheable = !rq.include_topic_authorized_operations;
+    if (cacheable) {
+        if (auto f = cache.get(tp, version, epoch); f) {
+            return metadata_response::topic{
+              .err_code = error_code::none,
+              .name = tp,
+              .encoded = std::move(f),
+            };
+        }
+    }
+    // the view already has the leaders filled in
+    auto view = ctx.metadata_cache().find_topic_view(
+      model::topic_namespace_view(model::kafka_namespace, tp));
+    if (!view) {
+        return std::nullopt;
+    }
+    auto res = make_topic_response(ctx, rq, view->metadata);
+    if (cacheable) {
+        auto f = ss::make_lw_shared<iobuf>();
+        response_writer rw(*f);
+        res.encode(version, rw);
+        cache.put(tp, version, epoch, f);
+        res.encoded = std::move(f);
+    }
+    return res;
+}
+
 static ss::future<std::vector<metadata_response::topic>>
 get_topic_metadata(request_context& ctx, metadata_request& request) {
     std::vector<metadata_response::topic> res;
 
     // request can be served from whatever happens to be in the cache
     if (request.list_all_topics) {
-        auto topics = ctx.metadata_cache().all_topics_metadata();
-        // only serve topics from the kafka namespace
-        std::erase_if(topics, [](model::topic_metadata& t_md) {
-            return t_md.tp_ns.ns != model::kafka_namespace;
-        });
-
-        auto unauthorized_it = std::partition(
-          topics.begin(),
-          topics.end(),
-          [&ctx](const model::topic_metadata& t_md) {
-              return ctx.authorized(
-                security::acl_operation::describe, t_md.tp_ns.tp);
-          });
-        std::transform(
-          topics.begin(),
-          unauthorized_it,
-          std::back_inserter(res),
-          [&ctx, &request](model::topic_metadata& t_md) {
-              return make_topic_response(ctx, request, std::move(t_md));
-          });
+        auto topics = ctx.metadata_cache().all_topics();
+        res.reserve(topics.size());
+        for (auto& tp_ns : topics) {
+            // only serve topics from the kafka namespace
+            if (
+              tp_ns.ns != model::kafka_namespace
+              || !ctx.authorized(security::acl_operation::describe, tp_ns.tp)) {
+                continue;
+            }
+            auto t = make_cached_topic_response(ctx, request, tp_ns.tp);
+            if (t) {
+                res.push_back(std::move(*t));
+            }
+        }
         return ss::make_ready_future<std::vector<metadata_response::topic>>(
           std::move(res));
     }
@@ -412,13 +455,18 @@ get_topic_metadata(request_context& ctx, metadata_request& request) {
               std::move(topic), error_code::topic_authorization_failed));
             continue;
         }
-        if (auto md = ctx.metadata_cache().get_topic_metadata(
-              model::topic_namespace_view(
-                model::kafka_namespace, source_topic));
-            md) {
-            auto src_topic_response = make_topic_response(
-              ctx, request, std::move(*md));
-            res.push_back(std::move(src_topic_response));
+        /// A materialized topic created in the cluster for the replicated
+        /// outputs of a coprocessor has partitions of its own
+        if (topic != source_topic) {
+            if (auto t = make_cached_topic_response(ctx, request, topic); t) {
+                res.push_back(std::move(*t));
+                continue;
+            }
+        }
+        if (auto t = make_cached_topic_response(
+              ctx, request, model::topic(source_topic));
+            t) {
+            res.push_back(std::move(*t));
             continue;
         }
 
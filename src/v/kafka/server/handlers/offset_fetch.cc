@@ -38,7 +38,11 @@ std::ostream& operator<<(std::ostream& os, const offset_fetch_response& r) {
 }
 
 void offset_fetch_response::encode(const request_context& ctx, response& resp) {
-    data.encode(resp.writer(), ctx.header().version);
+    // an entry per partition, the sizing pass pays for itself
+    resp.encode_presized([this, version = ctx.header().version](
+                           response_writer& writer) {
+        data.encode(writer, version);
+    });
 }
 
 template<>
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+#include "kafka/server/handlers/offset_for_leader_epoch.h"
+
+#include "cluster/metadata_cache.h"
+#include "cluster/partition_manager.h"
+#include "cluster/shard_table.h"
+#include "kafka/protocol/errors.h"
+#include "kafka/server/handlers/details/leader_epoch.h"
+#include "kafka/server/request_context.h"
+#include "kafka/server/response.h"
+#include "model/fundamental.h"
+#include "model/namespace.h"
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/when_all.hh>
+
+#include <algorithm>
+#include <vector>
+
+namespace kafka {
+
+/*
+ * Answered on the shard of the partition. The end offset of the latest term
+ * is the high watermark, data past it isn't visible to the clients.
+ */
+static offset_for_leader_partition_result end_offset_for_epoch(
+  cluster::partition_manager& mgr,
+  const model::ntp& ntp,
+  int32_t current_leader_epoch,
+  int32_t leader_epoch) {
+    const auto id = ntp.tp.partition;
+    auto partition = mgr.get(ntp);
+    if (!partition) {
+        return offset_for_leader_epoch_response::make_partition(
+          id, error_code::unknown_topic_or_partition);
+    }
+    if (!partition->is_leader()) {
+        return offset_for_leader_epoch_response::make_partition(
+          id, error_code::not_leader_for_partition);
+    }
+    auto ec = details::check_leader_epoch(*partition, current_leader_epoch);
+    if (ec != error_code::none) {
+        return offset_for_leader_epoch_response::make_partition(id, ec);
+    }
+    auto result = offset_for_leader_epoch_response::make_partition(
+      id, error_code::none);
+    if (leader_epoch < 0) {
+        return result;
+    }
+    auto end = partition->find_term_end(model::term_id(leader_epoch));
+    if (end) {
+        result.leader_epoch = end->term();
+        result.end_offset = std::min(
+          end->end_offset, partition->high_watermark());
+    }
+    return result;
+}
+
+static ss::future<offset_for_leader_topic_result> offsets_for_topic(
+  request_context& ctx,
+  ss::smp_service_group ssg,
+  offset_for_leader_topic topic) {
+    offset_for_leader_topic_result result{.name = topic.name};
+    result.partitions.resize(topic.partitions.size());
+    if (!ctx.authorized(security::acl_operation::describe, topic.name)) {
+        std::transform(
+          topic.partitions.begin(),
+          topic.partitions.end(),
+          result.partitions.begin(),
+          [](const offset_for_leader_partition& p) {
+              return offset_for_leader_epoch_response::make_partition(
+                p.partition_index, error_code::topic_authorization_failed);
+          });
+        co_return result;
+    }
+
+    std::vector<ss::future<>> answers;
+    for (size_t i = 0; i < topic.partitions.size(); ++i) {
+        const auto& p = topic.partitions[i];
+        model::ntp ntp(model::kafka_namespace, topic.name, p.partition_index);
+        auto shard = ctx.shards().shard_for(ntp);
+        if (!shard) {
+            result.partitions[i]
+              = offset_for_leader_epoch_response::make_partition(
+                p.partition_index, error_code::unknown_topic_or_partition);
+            continue;
+        }
+        answers.push_back(
+          ctx.partition_manager()
+            .invoke_on(
+              *shard,
+              ssg,
+              [ntp = std::move(ntp),
+               current = p.current_leader_epoch,
+               epoch = p.leader_epoch](cluster::partition_manager& mgr) {
+                  return end_offset_for_epoch(mgr, ntp, current, epoch);
+              })
+            .then([&result, i](offset_for_leader_partition_result r) {
+                result.partitions[i] = std::move(r);
+            }));
+    }
+    co_await ss::when_all_succeed(answers.begin(), answers.end());
+    co_return result;
+}
+
+template<>
+ss::future<response_ptr> offset_for_leader_epoch_handler::handle(
+  request_context ctx, ss::smp_service_group ssg) {
+    offset_for_leader_epoch_request request;
+    request.decode(ctx.reader(), ctx.header().version);
+    klog.trace("Handling request {}", request);
+
+    offset_for_leader_epoch_response response;
+    response.data.topics.reserve(request.data.topics.size());
+    for (auto& topic : request.data.topics) {
+        response.data.topics.push_back(
+          co_await offsets_for_topic(ctx, ssg, std::move(topic)));
+    }
+    co_return co_await ctx.respond(std::move(response));
+}
+
+} // namespace kafka
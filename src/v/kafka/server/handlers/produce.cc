@@ -16,6 +16,7 @@
 #include "kafka/protocol/errors.h"
 #include "kafka/protocol/kafka_batch_adapter.h"
 #include "kafka/protocol/response_writer_utils.h"
+#include "kafka/server/cpu_accounting.h"
 #include "likely.h"
 #include "model/fundamental.h"
 #include "model/metadata.h"
@@ -24,7 +25,9 @@
 #include "model/timestamp.h"
 #include "raft/types.h"
 #include "storage/shard_assignment.h"
+#include "utils/gate_guard.h"
 #include "utils/remote.h"
+#include "utils/stage_latency.h"
 #include "utils/to_string.h"
 #include "vlog.h"
 
@@ -57,8 +60,10 @@ void produce_request::encode(response_writer& writer, api_version) {
 }
 
 void produce_request::decode(request_context& ctx) {
-    auto& reader = ctx.reader();
+    decode(ctx.reader(), ctx.header().version);
+}
 
+void produce_request::decode(request_reader& reader, api_version) {
     transactional_id = reader.read_nullable_string();
     acks = reader.read_int16();
     timeout = std::chrono::milliseconds(reader.read_int32());
@@ -74,10 +79,20 @@ void produce_request::decode(request_context& ctx) {
         };
     });
 
+    // the crcs of the batches of all partitions are computed together
+    batch_crc_verifier crcs;
+    for (auto& topic : topics) {
+        for (auto& part : topic.partitions) {
+            if (part.data) {
+                part.adapter.adapt(std::move(part.data.value()), crcs);
+            }
+        }
+    }
+    crcs.verify();
+
     for (auto& topic : topics) {
         for (auto& part : topic.partitions) {
             if (part.data) {
-                part.adapter.adapt(std::move(part.data.value()));
                 if (part.adapter.batch) {
                     const auto& hdr = part.adapter.batch->header();
                     has_transactional = has_transactional
@@ -213,11 +228,31 @@ std::ostream& operator<<(std::ostream& os, const produce_response& r) {
     return os;
 }
 
+/*
+ * Batch of a produce request that is appended on another core.
+ */
+struct remote_append {
+    model::ntp ntp;
+    model::batch_identity bid;
+    model::record_batch batch;
+};
+
+/*
+ * Appends of a produce request collected for a single core, they are handed
+ * off in one cross core call once all the topics were visited.
+ */
+struct shard_appends {
+    std::vector<remote_append> appends;
+    std::vector<ss::promise<produce_response::partition>> replies;
+};
+
 struct produce_ctx {
     request_context rctx;
     produce_request request;
     produce_response response;
     ss::smp_service_group ssg;
+    // indexed by shard
+    std::vector<shard_appends> remote_appends;
 
     produce_ctx(
       request_context&& rctx,
@@ -225,7 +260,8 @@ struct produce_ctx {
       ss::smp_service_group ssg)
       : rctx(std::move(rctx))
       , request(std::move(request))
-      , ssg(ssg) {}
+      , ssg(ssg)
+      , remote_appends(ss::smp::count) {}
 };
 
 static raft::replicate_options acks_to_replicate_options(int16_t acks) {
@@ -298,20 +334,54 @@ static ss::future<produce_response::partition> partition_append(
         });
 }
 
+/**
+ * Appends to the partition, runs on its home core.
+ */
+static ss::future<produce_response::partition> append_on_home_shard(
+  cluster::partition_manager& mgr,
+  const model::ntp& ntp,
+  model::batch_identity bid,
+  model::record_batch_reader reader,
+  int32_t num_records,
+  size_t size_bytes,
+  int16_t acks,
+  ss::shard_id source) {
+    cpu_accounting::topic_charge charge(ntp.tp.topic);
+    auto partition = mgr.get(ntp);
+    if (!partition) {
+        return ss::make_ready_future<produce_response::partition>(
+          produce_response::partition{
+            .id = ntp.tp.partition,
+            .error = error_code::unknown_topic_or_partition});
+    }
+    if (unlikely(!partition->is_leader())) {
+        return ss::make_ready_future<produce_response::partition>(
+          produce_response::partition{
+            .id = ntp.tp.partition,
+            .error = error_code::not_leader_for_partition});
+    }
+    partition->probe().add_bytes_produced(size_bytes);
+    partition->probe().add_request_bytes(source, size_bytes);
+    return partition_append(
+      ntp.tp.partition, partition, bid, std::move(reader), acks, num_records);
+}
+
 /**
  * \brief handle writing to a single topic partition.
  */
 static ss::future<produce_response::partition> produce_topic_partition(
   produce_ctx& octx,
   produce_request::topic& topic,
-  produce_request::partition& part) {
+  produce_request::partition& part,
+  model::timestamp_type timestamp_type,
+  const cluster::shard_table::topic_shards* topic_shards) {
     auto ntp = model::ntp(model::kafka_namespace, topic.name, part.id);
 
     /*
      * A single produce request may contain record batches for many
      * different partitions that are managed different cores.
      */
-    auto shard = octx.rctx.shards().shard_for(ntp);
+    auto shard = cluster::shard_table::shard_for(topic_shards, part.id);
 
     if (!shard) {
         return ss::make_ready_future<produce_response::partition>(
@@ -323,16 +393,8 @@ static ss::future<produce_response::partition> produce_topic_partition(
     // steal the batch from the adapter
     auto batch = std::move(part.adapter.batch.value());
     /*
-     * grab timestamp type topic configuration option out of the
-     * metadata cache. For append time setting we have to recalculate
-     * the CRC.
+     * For append time setting we have to recalculate the CRC.
      */
-    auto timestamp_type
-      = octx.rctx.metadata_cache()
-          .get_topic_timestamp_type(
-            model::topic_namespace_view(model::kafka_namespace, topic.name))
-          .value_or(octx.rctx.metadata_cache().get_default_timestamp_type());
-
     if (timestamp_type == model::timestamp_type::append_time) {
         batch.set_max_timestamp(
           model::timestamp_type::append_time, model::timestamp::now());
@@ -341,37 +403,94 @@ static ss::future<produce_response::partition> produce_topic_partition(
     const auto& hdr = batch.header();
     auto bid = model::batch_identity::from(hdr);
 
+    if (*shard != ss::this_shard_id()) {
+        auto& dest = octx.remote_appends[*shard];
+        dest.appends.push_back(remote_append{
+          .ntp = std::move(ntp),
+          .bid = bid,
+          .batch = std::move(batch),
+        });
+        dest.replies.emplace_back();
+        return dest.replies.back().get_future();
+    }
+
     auto num_records = batch.record_count();
-    auto reader = reader_from_lcore_batch(std::move(batch));
-    return octx.rctx.partition_manager().invoke_on(
-      *shard,
-      octx.ssg,
-      [reader = std::move(reader),
-       ntp = std::move(ntp),
-       num_records,
-       bid,
-       acks = octx.request.acks](cluster::partition_manager& mgr) mutable {
-          auto partition = mgr.get(ntp);
-          if (!partition) {
-              return ss::make_ready_future<produce_response::partition>(
-                produce_response::partition{
-                  .id = ntp.tp.partition,
-                  .error = error_code::unknown_topic_or_partition});
-          }
-          if (unlikely(!partition->is_leader())) {
-              return ss::make_ready_future<produce_response::partition>(
-                produce_response::partition{
-                  .id = ntp.tp.partition,
-                  .error = error_code::not_leader_for_partition});
-          }
-          return partition_append(
-            ntp.tp.partition,
-            partition,
-            bid,
-            std::move(reader),
-            acks,
-            num_records);
-      });
+    auto size_bytes = batch.size_bytes();
+    return ss::futurize_invoke(
+      append_on_home_shard,
+      octx.rctx.partition_manager().local(),
+      ntp,
+      bid,
+      reader_from_lcore_batch(std::move(batch)),
+      num_records,
+      size_bytes,
+      octx.request.acks,
+      ss::this_shard_id());
+}
+
+/**
+ * Hands off the appends collected for each remote core in a single cross
+ * core call. The home core copies the batches into its own memory before
+ * appending them and releases the whole hand off at once, instead of each
+ * partition going through its own call and foreign reader.
+ */
+static void dispatch_remote_appends(produce_ctx& octx) {
+    for (ss::shard_id shard = 0; shard < octx.remote_appends.size(); ++shard) {
+        auto& dest = octx.remote_appends[shard];
+        if (dest.appends.empty()) {
+            continue;
+        }
+        auto appends = ss::make_foreign(
+          std::make_unique<std::vector<remote_append>>(
+            std::move(dest.appends)));
+        (void)octx.rctx.partition_manager()
+          .invoke_on(
+            shard,
+            octx.ssg,
+            [appends = std::move(appends),
+             acks = octx.request.acks,
+             source = ss::this_shard_id(),
+             sent = stage_latencies().start()](
+              cluster::partition_manager& mgr) mutable {
+                stage_latencies().record(request_stage::cross_shard, sent);
+                std::vector<ss::future<produce_response::partition>> replies;
+                replies.reserve(appends->size());
+                for (auto& a : *appends) {
+                    // copy sets the owner shard, the batcher keeps it as is
+                    auto batch = a.batch.copy();
+                    auto num_records = batch.record_count();
+                    auto size_bytes = batch.size_bytes();
+                    replies.push_back(ss::futurize_invoke(
+                      append_on_home_shard,
+                      mgr,
+                      model::ntp(a.ntp),
+                      a.bid,
+                      model::make_memory_record_batch_reader(std::move(batch)),
+                      num_records,
+                      size_bytes,
+                      acks,
+                      source));
+                }
+                // everything was copied, return the batches to their core
+                appends.reset();
+                return ss::when_all_succeed(replies.begin(), replies.end());
+            })
+          .then_wrapped(
+            [replies = std::move(dest.replies)](
+              ss::future<std::vector<produce_response::partition>> f) mutable {
+                if (f.failed()) {
+                    auto e = f.get_exception();
+                    for (auto& p : replies) {
+                        p.set_exception(e);
+                    }
+                    return;
+                }
+                auto results = f.get0();
+                for (size_t i = 0; i < replies.size(); ++i) {
+                    replies[i].set_value(std::move(results[i]));
+                }
+            });
+    }
 }
 
 /**
@@ -382,6 +501,20 @@ produce_topic(produce_ctx& octx, produce_request::topic& topic) {
     std::vector<ss::future<produce_response::partition>> partitions;
     partitions.reserve(topic.partitions.size());
 
+    /*
+     * a single lookup of the topic view serves all of its partitions, the
+     * timestamp type topic configuration option is taken from the view too
+     */
+    auto view = octx.rctx.metadata_cache().find_topic_view(
+      model::topic_namespace_view(model::kafka_namespace, topic.name));
+    auto timestamp_type
+      = view && view->timestamp_type
+          ? *view->timestamp_type
+          : octx.rctx.metadata_cache().get_default_timestamp_type();
+    // the partitions are dispatched without yielding so the handle stays valid
+    const auto* topic_shards = octx.rctx.shards().find_topic(
+      model::topic_namespace_view(model::kafka_namespace, topic.name));
+
     for (auto& part : topic.partitions) {
         if (!octx.rctx.authorized(security::acl_operation::write, topic.name)) {
             partitions.push_back(
@@ -392,9 +525,7 @@ produce_topic(produce_ctx& octx, produce_request::topic& topic) {
             continue;
         }
 
-        if (!octx.rctx.metadata_cache().contains(
-              model::topic_namespace_view(model::kafka_namespace, topic.name),
-              part.id)) {
+        if (!view || !view->partition(part.id)) {
             partitions.push_back(
               ss::make_ready_future<produce_response::partition>(
                 produce_response::partition{
@@ -422,7 +553,8 @@ produce_topic(produce_ctx& octx, produce_request::topic& topic) {
             continue;
         }
 
-        auto pr = produce_topic_partition(octx, topic, part);
+        auto pr = produce_topic_partition(
+          octx, topic, part, timestamp_type, topic_shards);
         partitions.push_back(std::move(pr));
     }
 
@@ -453,10 +585,75 @@ produce_topics(produce_ctx& octx) {
     return topics;
 }
 
+static bool has_error(const std::vector<produce_response::topic>& topics) {
+    for (const auto& topic : topics) {
+        for (const auto& p : topic.partitions) {
+            if (p.error != error_code::none) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * The client of an acks=0 request does not expect a response, the request is
+ * done once its batches are handed to the partitions: the noop response goes
+ * through quota and stats tracking right away and does not hold the responses
+ * of the following requests of the connection behind the appends. The
+ * appends still hold the memory of the request, so a client can't have more
+ * acks=0 data in flight than the memory limit of the connections admits.
+ *
+ * An append that fails closes the connection to signal an issue to the
+ * client, as in kafka.
+ */
+static ss::future<response_ptr> produce_fire_and_forget(produce_ctx octx) {
+    vlog(klog.trace, "handling produce request {}", octx.request);
+    // the connection outlives the appends and the memory of the request stays
+    // reserved until they are done
+    auto conn = octx.rctx.connection();
+    gate_guard guard(conn->conn_gate());
+    auto memory = octx.rctx.memory_units();
+    // the appends only reference the context while they are dispatched
+    auto topics = produce_topics(octx);
+    dispatch_remote_appends(octx);
+
+    (void)when_all_succeed(topics.begin(), topics.end())
+      .then_wrapped([conn = std::move(conn),
+                     guard = std::move(guard),
+                     memory = std::move(memory)](
+                      ss::future<std::vector<produce_response::topic>> f) {
+          std::optional<ss::sstring> error;
+          if (f.failed()) {
+              error = fmt::format("{}", f.get_exception());
+          } else {
+              produce_response r;
+              r.topics = f.get0();
+              if (has_error(r.topics)) {
+                  error = fmt::format("{}", r);
+              }
+          }
+          if (error) {
+              vlog(
+                klog.info,
+                "Closing connection due to error in acks=0 produce: {}",
+                *error);
+              conn->shutdown_input();
+          }
+      });
+
+    return octx.rctx.respond(produce_response{}).then([](response_ptr resp) {
+        resp->mark_noop();
+        return resp;
+    });
+}
+
 template<>
 ss::future<response_ptr>
 produce_handler::handle(request_context ctx, ss::smp_service_group ssg) {
+    auto decode_started = stage_latencies().start();
     produce_request request(ctx);
+    stage_latencies().record(request_stage::decode, decode_started);
 
     /*
      * Authorization
@@ -509,6 +706,11 @@ produce_handler::handle(request_context ctx, ss::smp_service_group ssg) {
           request.make_error_response(error_code::invalid_required_acks));
     }
 
+    if (request.acks == 0) {
+        return produce_fire_and_forget(
+          produce_ctx(std::move(ctx), std::move(request), ssg));
+    }
+
     return ss::do_with(
       produce_ctx(std::move(ctx), std::move(request), ssg),
       [](produce_ctx& octx) {
@@ -516,52 +718,13 @@ produce_handler::handle(request_context ctx, ss::smp_service_group ssg) {
 
           // dispatch produce requests for each topic
           auto topics = produce_topics(octx);
+          dispatch_remote_appends(octx);
 
           // collect topic responses
           return when_all_succeed(topics.begin(), topics.end())
             .then([&octx](std::vector<produce_response::topic> topics) {
                 octx.response.topics = std::move(topics);
-            })
-            .then([&octx] {
-                // send response immediately
-                if (octx.request.acks != 0) {
-                    return octx.rctx.respond(std::move(octx.response));
-                }
-
-                // acks = 0 is handled separately. first, check for
-                // errors
-                bool has_error = false;
-                for (const auto& topic : octx.response.topics) {
-                    for (const auto& p : topic.partitions) {
-                        if (p.error != error_code::none) {
-                            has_error = true;
-                            break;
-                        }
-                    }
-                }
-
-                // in the absense of errors, acks = 0 results in the
-                // response being dropped, as the client does not expect
-                // a response. here we mark the response as noop, but
-                // let it flow back so that it can be accounted for in
-                // quota and stats tracking. it is dropped later during
-                // processing.
-                if (!has_error) {
-                    return octx.rctx.respond(std::move(octx.response))
-                      .then([](response_ptr resp) {
-                          resp->mark_noop();
-                          return resp;
-                      });
-                }
-
-                // errors in a response from an acks=0 produce request
-                // result in the connection being dropped to signal an
-                // issue to the client
-                return ss::make_exception_future<response_ptr>(
-                  std::runtime_error(fmt::format(
-                    "Closing connection due to error in produce "
-                    "response: {}",
-                    octx.response)));
+                return octx.rctx.respond(std::move(octx.response));
             });
       });
 }
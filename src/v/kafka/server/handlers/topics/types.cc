@@ -95,6 +95,8 @@ cluster::topic_configuration to_cluster_type(const creatable_topic& t) {
     cfg.properties.retention_duration
       = get_tristate_value<std::chrono::milliseconds>(
         config_entries, topic_property_retention_duration);
+    cfg.properties.storage_mode = get_config_value<model::storage_mode>(
+      config_entries, topic_property_storage_mode);
 
     return cfg;
 }
@@ -45,6 +45,9 @@ static constexpr std::string_view topic_property_retention_bytes
   = "retention.bytes";
 static constexpr std::string_view topic_property_retention_duration
   = "retention.ms";
+// redpanda extension, disk or memory. only honoured at topic creation
+static constexpr std::string_view topic_property_storage_mode
+  = "redpanda.storage.mode";
 
 /// \brief Type representing Kafka protocol response from
 /// CreateTopics, DeleteTopics and CreatePartitions requests
@@ -0,0 +1,43 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/server/metadata_response_cache.h"
+
+namespace kafka {
+
+void metadata_response_cache::maybe_invalidate(uint64_t epoch) {
+    if (epoch > _epoch) {
+        _fragments.clear();
+        _epoch = epoch;
+    }
+}
+
+metadata_response_cache::fragment_ptr metadata_response_cache::get(
+  const model::topic& tp, api_version version, uint64_t epoch) {
+    maybe_invalidate(epoch);
+    if (epoch < _epoch) {
+        return nullptr;
+    }
+    if (auto it = _fragments.find(key{tp, version}); it != _fragments.end()) {
+        return it->second;
+    }
+    return nullptr;
+}
+
+void metadata_response_cache::put(
+  model::topic tp, api_version version, uint64_t epoch, fragment_ptr f) {
+    maybe_invalidate(epoch);
+    if (epoch < _epoch) {
+        // encoded before the metadata changed
+        return;
+    }
+    _fragments.insert_or_assign(key{std::move(tp), version}, std::move(f));
+}
+
+} // namespace kafka
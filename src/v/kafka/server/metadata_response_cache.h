@@ -0,0 +1,62 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+#pragma once
+
+#include "bytes/iobuf.h"
+#include "kafka/types.h"
+#include "model/fundamental.h"
+#include "seastarx.h"
+
+#include <seastar/core/shared_ptr.hh>
+
+#include <absl/container/flat_hash_map.h>
+
+namespace kafka {
+
+/**
+ * Core local cache of encoded topics of metadata responses. Clients that
+ * periodically ask for the metadata of all topics get the same bytes as long
+ * as nothing changes in the cluster, so the topics are encoded once per api
+ * version and the responses are assembled from the shared fragments.
+ *
+ * Entries are valid for a single metadata epoch of the metadata cache, the
+ * whole cache is dropped once the epoch changes.
+ */
+class metadata_response_cache {
+public:
+    using fragment_ptr = ss::lw_shared_ptr<iobuf>;
+
+    /// Returns the encoded topic if it was cached in the given epoch
+    fragment_ptr get(const model::topic&, api_version, uint64_t epoch);
+
+    void put(model::topic, api_version, uint64_t epoch, fragment_ptr);
+
+    size_t size() const { return _fragments.size(); }
+
+private:
+    struct key {
+        model::topic topic;
+        api_version version;
+
+        template<typename H>
+        friend H AbslHashValue(H h, const key& k) {
+            return H::combine(std::move(h), k.topic, k.version);
+        }
+        bool operator==(const key&) const = default;
+    };
+
+    void maybe_invalidate(uint64_t epoch);
+
+    uint64_t _epoch{0};
+    absl::flat_hash_map<key, fragment_ptr> _fragments;
+};
+
+} // namespace kafka
@@ -0,0 +1,116 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/server/offset_commit_batcher.h"
+
+#include "cluster/partition.h"
+#include "cluster/simple_batch_builder.h"
+#include "kafka/server/logger.h"
+#include "model/record_batch_reader.h"
+#include "raft/errc.h"
+#include "vassert.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+
+namespace kafka {
+
+offset_commit_batcher::offset_commit_batcher(
+  ss::lw_shared_ptr<cluster::partition> p,
+  std::chrono::milliseconds window,
+  size_t max_bytes)
+  : _partition(std::move(p))
+  , _window(window)
+  , _max_bytes(max_bytes) {
+    _timer.set_callback([this] { flush(); });
+}
+
+ss::future<result<raft::replicate_result>>
+offset_commit_batcher::replicate(std::vector<record> records) {
+    vassert(!records.empty(), "offset commits have at least one record");
+    if (_gate.is_closed()) {
+        return ss::make_ready_future<result<raft::replicate_result>>(
+          raft::errc::shutting_down);
+    }
+    for (auto& r : records) {
+        _pending_bytes += r.first.size_bytes() + r.second.size_bytes();
+        _records.push_back(std::move(r));
+    }
+    _commits.push_back(pending_commit{.last_record = _records.size() - 1});
+    auto f = _commits.back().promise.get_future();
+    if (_pending_bytes >= _max_bytes) {
+        _timer.cancel();
+        flush();
+    } else if (!_timer.armed()) {
+        _timer.arm(_window);
+    }
+    return f;
+}
+
+void offset_commit_batcher::flush() {
+    if (_commits.empty()) {
+        return;
+    }
+    _pending_bytes = 0;
+    (void)ss::with_gate(
+      _gate,
+      [this,
+       records = std::exchange(_records, {}),
+       commits = std::exchange(_commits, {})]() mutable {
+          return do_flush(std::move(records), std::move(commits));
+      });
+}
+
+ss::future<> offset_commit_batcher::do_flush(
+  std::vector<record> records, std::vector<pending_commit> commits) {
+    const auto total = records.size();
+    cluster::simple_batch_builder builder(
+      raft::data_batch_type, model::offset(0));
+    for (auto& r : records) {
+        builder.add_raw_kv(std::move(r.first), std::move(r.second));
+    }
+    auto reader = model::make_memory_record_batch_reader(
+      std::move(builder).build());
+    vlog(
+      klog.trace,
+      "replicating {} offset commit requests in one batch to {}",
+      commits.size(),
+      _partition->ntp());
+
+    std::exception_ptr ex;
+    result<raft::replicate_result> res{raft::errc::shutting_down};
+    try {
+        res = co_await _partition->replicate(
+          std::move(reader),
+          raft::replicate_options(raft::consistency_level::quorum_ack));
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    for (auto& c : commits) {
+        if (ex) {
+            c.promise.set_exception(ex);
+        } else if (!res) {
+            c.promise.set_value(res.error());
+        } else {
+            // offset of the last record of the caller in the merged batch
+            auto r = res.value();
+            r.last_offset = r.last_offset
+                            - model::offset(total - 1 - c.last_record);
+            c.promise.set_value(r);
+        }
+    }
+}
+
+ss::future<> offset_commit_batcher::stop() {
+    _timer.cancel();
+    flush();
+    return _gate.close();
+}
+
+} // namespace kafka
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "bytes/iobuf.h"
+#include "cluster/fwd.h"
+#include "outcome.h"
+#include "raft/types.h"
+#include "seastarx.h"
+
+#include <seastar/core/future.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/core/shared_ptr.hh>
+#include <seastar/core/timer.hh>
+
+#include <chrono>
+#include <vector>
+
+namespace kafka {
+
+/**
+ * Merges the offset commits of the groups coordinated by one partition of the
+ * group topic. Commits arriving within the window are written as a single
+ * record batch with a single replicate call, instead of one small batch per
+ * commit request.
+ *
+ * The result of each caller carries the offset of its own last record in the
+ * merged batch, commits to the same partition of a group keep distinct log
+ * offsets to be ordered by.
+ */
+class offset_commit_batcher {
+public:
+    using record = std::pair<iobuf, iobuf>;
+
+    offset_commit_batcher(
+      ss::lw_shared_ptr<cluster::partition>,
+      std::chrono::milliseconds window,
+      size_t max_bytes);
+
+    ss::future<result<raft::replicate_result>>
+      replicate(std::vector<record>);
+
+    /// \brief replicates the pending commits and stops batching
+    ss::future<> stop();
+
+private:
+    struct pending_commit {
+        size_t last_record;
+        ss::promise<result<raft::replicate_result>> promise;
+    };
+
+    void flush();
+    ss::future<>
+      do_flush(std::vector<record>, std::vector<pending_commit>);
+
+    ss::lw_shared_ptr<cluster::partition> _partition;
+    std::chrono::milliseconds _window;
+    size_t _max_bytes;
+    std::vector<record> _records;
+    std::vector<pending_commit> _commits;
+    size_t _pending_bytes{0};
+    ss::timer<ss::lowres_clock> _timer;
+    ss::gate _gate;
+};
+
+} // namespace kafka
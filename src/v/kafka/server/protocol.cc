@@ -88,4 +88,22 @@ ss::future<> protocol::apply(rpc::server::resources rs) {
       .finally([ctx] {});
 }
 
+ss::future<response_ptr> protocol::dispatch_local(
+  ss::sstring listener, request_header hdr, iobuf request) {
+    security::sasl_server sasl(security::sasl_server::sasl_state::complete);
+    auto conn = ss::make_lw_shared<connection_context>(
+      *this,
+      rpc::server::resources(nullptr, nullptr),
+      std::move(sasl),
+      false,
+      std::move(listener));
+    return process_request(
+      request_context(
+        std::move(conn),
+        std::move(hdr),
+        std::move(request),
+        ss::lowres_clock::duration(0)),
+      _smp_group);
+}
+
 } // namespace kafka
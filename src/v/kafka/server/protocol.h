@@ -13,7 +13,10 @@
 
 #include "cluster/fwd.h"
 #include "config/configuration.h"
+#include "kafka/server/fair_admission.h"
 #include "kafka/server/fwd.h"
+#include "kafka/server/metadata_response_cache.h"
+#include "kafka/server/response.h"
 #include "rpc/server.h"
 #include "security/authorizer.h"
 #include "security/credential_store.h"
@@ -51,6 +54,15 @@ public:
     // the lifetime of all references here are guaranteed to live
     // until the end of the server (container/parent)
     ss::future<> apply(rpc::server::resources) final;
+    ss::future<> stop() final { return _produce_admission.stop(); }
+
+    /// \brief Handle a request of a client on this shard without a connection
+    ///
+    /// The request skips the socket and the quotas of the connections. It
+    /// isn't authenticated, callers only use it when sasl is disabled.
+    /// \param listener the addresses of the brokers in the reply belong to it
+    ss::future<response_ptr>
+    dispatch_local(ss::sstring listener, request_header hdr, iobuf request);
 
     ss::smp_service_group smp_group() const { return _smp_group; }
     cluster::topics_frontend& topics_frontend() {
@@ -73,7 +85,11 @@ public:
     fetch_session_cache& fetch_sessions_cache() {
         return _fetch_session_cache.local();
     }
+    metadata_response_cache& metadata_responses() {
+        return _metadata_response_cache;
+    }
     quota_manager& quota_mgr() { return _quota_mgr.local(); }
+    fair_admission& produce_admission() { return _produce_admission; }
     bool is_idempotence_enabled() { return _is_idempotence_enabled; }
 
     security::credential_store& credentials() { return _credentials.local(); }
@@ -99,6 +115,9 @@ private:
     ss::sharded<security::credential_store>& _credentials;
     ss::sharded<security::authorizer>& _authorizer;
     ss::sharded<cluster::security_frontend>& _security_frontend;
+    metadata_response_cache _metadata_response_cache;
+    // produce requests of all the connections of the shard share its memory
+    fair_admission _produce_admission;
 };
 
 } // namespace kafka
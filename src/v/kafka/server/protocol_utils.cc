@@ -91,15 +91,26 @@ ss::future<std::optional<size_t>> parse_size(ss::input_stream<char>& src) {
 
 ss::scattered_message<char> response_as_scattered(response_ptr response) {
     auto correlation = response->correlation();
-    auto header = ss::temporary_buffer<char>(sizeof(raw_response_header));
+    // response header v1 follows the correlation id with its tagged fields,
+    // of which there are none: a single zero count
+    const size_t tags_size = response->is_flexible() ? 1 : 0;
+    auto header = ss::temporary_buffer<char>(
+      sizeof(raw_response_header) + tags_size);
     // NOLINTNEXTLINE
     auto* raw_header = reinterpret_cast<raw_response_header*>(
       header.get_write());
-    auto size = int32_t(sizeof(correlation) + response->buf().size_bytes());
+    if (tags_size) {
+        header.get_write()[sizeof(raw_response_header)] = 0;
+    }
+    auto size = int32_t(
+      sizeof(correlation) + tags_size + response->buf().size_bytes());
     raw_header->size = ss::cpu_to_be(size);
     raw_header->correlation = ss::cpu_to_be(correlation());
     auto& buf = response->buf();
     buf.prepend(std::move(header));
+    // pack the header and the small response fields into one buffer, large
+    // fragments like the fetched batches are sent as they are
+    buf.coalesce();
     ss::scattered_message<char> msg;
     auto in = iobuf::iterator_consumer(buf.cbegin(), buf.cend());
     int32_t chunk_no = 0;
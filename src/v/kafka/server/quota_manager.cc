@@ -13,22 +13,145 @@
 #include "kafka/server/logger.h"
 #include "vlog.h"
 
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/smp.hh>
+
 namespace kafka {
 using clock = quota_manager::clock;
 using throttle_delay = quota_manager::throttle_delay;
 
-quota_manager::~quota_manager() { _gc_timer.cancel(); }
+quota_manager::quota_manager()
+  : _default_num_windows(config::shard_local_cfg().default_num_windows())
+  , _default_window_width(config::shard_local_cfg().default_window_sec())
+  , _target_tp_rate(config::shard_local_cfg().target_quota_byte_rate())
+  , _gc_freq(config::shard_local_cfg().quota_manager_gc_sec())
+  , _max_delay(config::shard_local_cfg().max_kafka_throttle_delay_ms())
+  , _sync_freq(config::shard_local_cfg().quota_manager_sync_ms()) {
+    auto& cfg = config::shard_local_cfg();
+    _rates[static_cast<size_t>(quota_entity::client)] = {
+      cfg.client_produce_quota_byte_rate(),
+      cfg.client_fetch_quota_byte_rate(),
+      cfg.client_request_quota_rate(),
+    };
+    _rates[static_cast<size_t>(quota_entity::user)] = {
+      cfg.user_produce_quota_byte_rate(),
+      cfg.user_fetch_quota_byte_rate(),
+      cfg.user_request_quota_rate(),
+    };
+    auto full_window = _default_num_windows * _default_window_width;
+    _gc_timer.set_callback([this, full_window] { gc(full_window); });
+    _sync_timer.set_callback([this] {
+        (void)ss::with_gate(_gate, [this] {
+            return sync_usage().handle_exception([](std::exception_ptr e) {
+                vlog(klog.debug, "Failed to sync quota usage - {}", e);
+            });
+        }).finally([this] {
+            if (!_gate.is_closed()) {
+                _sync_timer.arm(_sync_freq);
+            }
+        });
+    });
+}
+
+quota_manager::~quota_manager() {
+    _gc_timer.cancel();
+    _sync_timer.cancel();
+}
 
 ss::future<> quota_manager::stop() {
     _gc_timer.cancel();
-    return ss::make_ready_future<>();
+    _sync_timer.cancel();
+    return _gate.close();
 }
 
 ss::future<> quota_manager::start() {
     _gc_timer.arm_periodic(_gc_freq);
+    bool any_bucket = false;
+    for (auto& rates : _rates) {
+        for (auto r : rates) {
+            any_bucket |= r > 0;
+        }
+    }
+    // the buckets of all shards are exchanged by shard 0
+    if (any_bucket && ss::smp::count > 1 && ss::this_shard_id() == 0) {
+        _sync_timer.arm(_sync_freq);
+    }
     return ss::make_ready_future<>();
 }
 
+uint32_t quota_manager::rate_for(quota_type t, quota_entity e) const {
+    return _rates[static_cast<size_t>(e)][static_cast<size_t>(t)];
+}
+
+clock::duration quota_manager::consume(
+  quota_type type,
+  quota_entity entity,
+  std::string_view name,
+  uint64_t amount,
+  clock::time_point now) {
+    auto rate = rate_for(type, entity);
+    if (rate == 0) {
+        return clock::duration(0);
+    }
+    auto [it, _] = _buckets.try_emplace(
+      bucket_key{type, entity, ss::sstring(name)},
+      bucket{.tokens = token_bucket(rate, now), .last_seen = now});
+    auto& b = it->second;
+    b.last_seen = now;
+    b.unsynced += amount;
+    b.tokens.consume(amount, now);
+    return b.tokens.delay(now);
+}
+
+clock::duration quota_manager::record_and_throttle(
+  quota_type type,
+  std::optional<std::string_view> client_id,
+  std::string_view principal,
+  uint64_t amount,
+  clock::time_point now) {
+    // same anonymous group as the throughput tracking
+    auto delay = consume(
+      type, quota_entity::client, client_id.value_or(""), amount, now);
+    if (!principal.empty()) {
+        delay = std::max(
+          delay, consume(type, quota_entity::user, principal, amount, now));
+    }
+    return std::min<clock::duration>(delay, _max_delay);
+}
+
+quota_manager::usage_t quota_manager::take_unsynced_usage() {
+    usage_t ret;
+    for (auto& [key, b] : _buckets) {
+        if (b.unsynced > 0) {
+            ret.emplace_back(key, std::exchange(b.unsynced, 0));
+        }
+    }
+    return ret;
+}
+
+void quota_manager::apply_remote_usage(
+  const std::vector<usage_t>& per_shard, clock::time_point now) {
+    for (ss::shard_id shard = 0; shard < per_shard.size(); ++shard) {
+        if (shard == ss::this_shard_id()) {
+            continue;
+        }
+        for (const auto& [key, amount] : per_shard[shard]) {
+            // nothing to charge where the client is not connected
+            if (auto it = _buckets.find(key); it != _buckets.end()) {
+                it->second.tokens.consume(amount, now);
+            }
+        }
+    }
+}
+
+ss::future<> quota_manager::sync_usage() {
+    auto per_shard = co_await container().map(
+      [](quota_manager& qm) { return qm.take_unsynced_usage(); });
+    co_await container().invoke_on_all([&per_shard](quota_manager& qm) {
+        qm.apply_remote_usage(per_shard, clock::now());
+    });
+}
+
 // record a new observation and return <previous delay, new delay>
 throttle_delay quota_manager::record_tp_and_throttle(
   std::optional<std::string_view> client_id,
@@ -99,6 +222,9 @@ void quota_manager::gc(clock::duration full_window) {
       _quotas, [now, expire_age](const std::pair<ss::sstring, quota>& q) {
           return (now - q.second.last_seen) > expire_age;
       });
+    absl::erase_if(_buckets, [now, expire_age](const auto& b) {
+        return (now - b.second.last_seen) > expire_age;
+    });
 }
 
 } // namespace kafka
@@ -12,39 +12,51 @@
 #pragma once
 #include "config/configuration.h"
 #include "resource_mgmt/rate.h"
+#include "resource_mgmt/token_bucket.h"
 #include "seastarx.h"
 
 #include <seastar/core/future.hh>
+#include <seastar/core/gate.hh>
 #include <seastar/core/lowres_clock.hh>
+#include <seastar/core/sharded.hh>
 #include <seastar/core/sstring.hh>
 #include <seastar/core/timer.hh>
 
 #include <absl/container/flat_hash_map.h>
 
+#include <array>
 #include <chrono>
 #include <optional>
 #include <string_view>
+#include <vector>
 
 namespace kafka {
 
+enum class quota_type : uint8_t {
+    produce_bytes,
+    fetch_bytes,
+    requests,
+};
+
+// who the quota is enforced for, a client id or a sasl principal
+enum class quota_entity : uint8_t {
+    client,
+    user,
+};
+
 // quota_manager tracks quota usage
 //
+// total throughput per client_id is tracked with windowed rates. on top of
+// that produce bytes, fetch bytes and requests are each limited with token
+// buckets per client_id and per sasl principal. every shard keeps its own
+// buckets, the consumption is periodically exchanged between the shards so
+// that a client spread over connections on many shards shares one budget.
+//
 // TODO:
 //   - we will want to eventually add support for configuring the quotas and
 //   quota settings as runtime through the kafka api and other mechanisms.
 //
-//   - currently only total throughput per client_id is tracked. in the future
-//   we will want to support additional quotas and accouting granularities to be
-//   at parity with kafka. for example:
-//
-//      - splitting out rates separately for produce and fetch
-//      - accounting per user vs per client (these are separate in kafka)
-//
-//   - it may eventually be beneficial to periodically reduce stats across
-//   shards or track stats globally to produce a more accurate per-node
-//   representation of a statistic (e.g. bandwidth).
-//
-class quota_manager {
+class quota_manager : public ss::peering_sharded_service<quota_manager> {
 public:
     using clock = ss::lowres_clock;
 
@@ -53,15 +65,7 @@ public:
         clock::duration duration;
     };
 
-    quota_manager()
-      : _default_num_windows(config::shard_local_cfg().default_num_windows())
-      , _default_window_width(config::shard_local_cfg().default_window_sec())
-      , _target_tp_rate(config::shard_local_cfg().target_quota_byte_rate())
-      , _gc_freq(config::shard_local_cfg().quota_manager_gc_sec())
-      , _max_delay(config::shard_local_cfg().max_kafka_throttle_delay_ms()) {
-        auto full_window = _default_num_windows * _default_window_width;
-        _gc_timer.set_callback([this, full_window] { gc(full_window); });
-    }
+    quota_manager();
 
     quota_manager(const quota_manager&) = delete;
     quota_manager& operator=(const quota_manager&) = delete;
@@ -80,11 +84,54 @@ public:
       uint64_t bytes,
       clock::time_point now = clock::now());
 
+    // consume from the buckets of the client and of the principal, returns
+    // how long the connection has to back off to get back into both quotas.
+    // an empty principal is not accounted.
+    clock::duration record_and_throttle(
+      quota_type,
+      std::optional<std::string_view> client_id,
+      std::string_view principal,
+      uint64_t amount,
+      clock::time_point now = clock::now());
+
+    struct bucket_key {
+        quota_type type;
+        quota_entity entity;
+        ss::sstring name;
+
+        template<typename H>
+        friend H AbslHashValue(H h, const bucket_key& k) {
+            return H::combine(std::move(h), k.type, k.entity, k.name);
+        }
+        bool operator==(const bucket_key&) const = default;
+    };
+
+    using usage_t = std::vector<std::pair<bucket_key, uint64_t>>;
+
+    // consumption recorded on this shard since the previous call
+    usage_t take_unsynced_usage();
+
+    // charge the local buckets with the consumption of the other shards,
+    // indexed by shard
+    void apply_remote_usage(const std::vector<usage_t>&, clock::time_point);
+
 private:
     // erase inactive tracked quotas. windows are considered inactive if they
     // have not received any updates in ten window's worth of time.
     void gc(clock::duration full_window);
 
+    // exchange the consumption of all the shards, runs on shard 0
+    ss::future<> sync_usage();
+
+    uint32_t rate_for(quota_type, quota_entity) const;
+
+    clock::duration consume(
+      quota_type,
+      quota_entity,
+      std::string_view,
+      uint64_t,
+      clock::time_point);
+
 private:
     // last_seen: used for gc keepalive
     // delay: last calculated delay
@@ -104,6 +151,20 @@ private:
     ss::timer<> _gc_timer;
     const clock::duration _gc_freq;
     const clock::duration _max_delay;
+
+    // bucket rates indexed by entity and type, zero means unlimited
+    std::array<std::array<uint32_t, 3>, 2> _rates;
+
+    struct bucket {
+        token_bucket tokens;
+        clock::time_point last_seen;
+        uint64_t unsynced{0};
+    };
+    absl::flat_hash_map<bucket_key, bucket> _buckets;
+
+    const clock::duration _sync_freq;
+    ss::timer<> _sync_timer;
+    ss::gate _gate;
 };
 
 } // namespace kafka
@@ -25,6 +25,7 @@
 
 #include <seastar/core/future.hh>
 #include <seastar/core/reactor.hh>
+#include <seastar/core/semaphore.hh>
 #include <seastar/core/sharded.hh>
 #include <seastar/core/shared_ptr.hh>
 #include <seastar/core/unaligned.hh>
@@ -64,11 +65,13 @@ public:
       ss::lw_shared_ptr<connection_context> conn,
       request_header&& header,
       iobuf&& request,
-      ss::lowres_clock::duration throttle_delay) noexcept
+      ss::lowres_clock::duration throttle_delay,
+      ss::lw_shared_ptr<ss::semaphore_units<>> memory_units = {}) noexcept
       : _conn(std::move(conn))
       , _header(std::move(header))
       , _reader(std::move(request))
-      , _throttle_delay(throttle_delay) {}
+      , _throttle_delay(throttle_delay)
+      , _memory_units(std::move(memory_units)) {}
 
     request_context(const request_context&) = delete;
     request_context& operator=(const request_context&) = delete;
@@ -78,6 +81,12 @@ public:
 
     const request_header& header() const { return _header; }
 
+    /// \brief the memory reserved for the request. A handler that keeps
+    /// working on the request after it responded holds on to it until done
+    ss::lw_shared_ptr<ss::semaphore_units<>> memory_units() const {
+        return _memory_units;
+    }
+
     ss::lw_shared_ptr<connection_context> connection() { return _conn; }
 
     request_reader& reader() { return _reader; }
@@ -120,6 +129,10 @@ public:
         return _conn->server().fetch_sessions_cache();
     }
 
+    metadata_response_cache& metadata_responses() {
+        return _conn->server().metadata_responses();
+    }
+
     // clang-format off
     template<typename ResponseType>
     CONCEPT(requires requires (
@@ -165,6 +178,7 @@ private:
     request_header _header;
     request_reader _reader;
     ss::lowres_clock::duration _throttle_delay;
+    ss::lw_shared_ptr<ss::semaphore_units<>> _memory_units;
 };
 
 // Executes the API call identified by the specified request_context.
@@ -19,7 +19,8 @@
 namespace kafka {
 
 /**
- * Dispatch request with version bounds checking.
+ * Dispatch request with version bounds checking. Flexible versions use the
+ * request header v2 and the response header v1.
  */
 template<typename Request>
 CONCEPT(requires(KafkaApiHandler<Request>))
@@ -35,7 +36,15 @@ struct process_dispatch {
                 ctx.header().version,
                 Request::api::name)));
         }
-        return Request::handle(std::move(ctx), g);
+        if (!is_flexible<typename Request::api>(ctx.header().version)) {
+            return Request::handle(std::move(ctx), g);
+        }
+        // request header v2 ends in tagged fields that precede the body
+        ctx.reader().skip_tags();
+        return Request::handle(std::move(ctx), g).then([](response_ptr r) {
+            r->mark_flexible();
+            return r;
+        });
     }
 };
 
@@ -250,6 +259,10 @@ process_request(request_context&& ctx, ss::smp_service_group g) {
         return do_process<create_acls_handler>(std::move(ctx), g);
     case delete_acls_handler::api::key:
         return do_process<delete_acls_handler>(std::move(ctx), g);
+    case offset_for_leader_epoch_handler::api::key:
+        return do_process<offset_for_leader_epoch_handler>(std::move(ctx), g);
+    case delete_records_handler::api::key:
+        return do_process<delete_records_handler>(std::move(ctx), g);
     };
     return ss::make_exception_future<response_ptr>(
       std::runtime_error(fmt::format("Unsupported API {}", ctx.header().key)));
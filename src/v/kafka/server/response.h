@@ -11,13 +11,16 @@
 
 #pragma once
 
+#include "bytes/details/io_allocation_size.h"
 #include "bytes/iobuf.h"
 #include "kafka/protocol/response_writer.h"
 #include "kafka/protocol/types.h"
 #include "seastarx.h"
+#include "utils/concepts-enabled.h"
 
 #include <seastar/core/sharded.hh>
 
+#include <algorithm>
 #include <memory>
 
 namespace kafka {
@@ -29,6 +32,27 @@ public:
 
     response_writer& writer() { return _writer; }
 
+    /**
+     * \brief encodes the response in two passes. The first one only counts
+     * the bytes of the encoding, the second one writes them into a buffer
+     * allocated up front, so that a response of thousands of partitions is
+     * not written into a chain of small and growing fragments. The encoder
+     * is called once with each writer and must write the same bytes both
+     * times.
+     */
+    // clang-format off
+    template<typename Encoder>
+    CONCEPT(requires requires(Encoder e, response_writer& rw) {
+        { e(rw) } -> std::same_as<void>;
+    })
+    // clang-format on
+    void encode_presized(Encoder&& encoder) {
+        response_writer sizer(response_writer::size_only{});
+        encoder(sizer);
+        reserve(sizer.size_bytes());
+        encoder(_writer);
+    }
+
     const iobuf& buf() const { return _buf; }
     iobuf& buf() { return _buf; }
     iobuf release() && { return std::move(_buf); }
@@ -45,8 +69,27 @@ public:
     bool is_noop() const { return _noop; }
     void mark_noop() { _noop = true; }
 
+    /*
+     * Responses of flexible versions are sent with the response header v1,
+     * which ends in the (empty) tagged fields of the header.
+     */
+    bool is_flexible() const { return _flexible; }
+    void mark_flexible() { _flexible = true; }
+
 private:
+    void reserve(size_t size) {
+        if (size == 0) {
+            return;
+        }
+        // past the largest fragment the buffer keeps growing by fragments of
+        // the largest size
+        size = std::min(size, details::io_allocation_size::max_chunk_size);
+        _buf.append_take_ownership(new iobuf::fragment(
+          ss::temporary_buffer<char>(size), iobuf::fragment::empty{}));
+    }
+
     bool _noop{false};
+    bool _flexible{false};
     correlation_id _correlation;
     iobuf _buf;
     response_writer _writer;
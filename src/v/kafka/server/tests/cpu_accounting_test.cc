@@ -0,0 +1,54 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/server/cpu_accounting.h"
+
+#include <boost/test/unit_test.hpp>
+#include <fmt/format.h>
+
+BOOST_AUTO_TEST_CASE(top_k_counter_exact_under_capacity) {
+    kafka::top_k_counter counter(4);
+    counter.add("a", 10);
+    counter.add("b", 30);
+    counter.add("a", 15);
+    counter.add("c", 5);
+
+    auto top = counter.top(2);
+    BOOST_REQUIRE_EQUAL(top.size(), 2);
+    BOOST_REQUIRE_EQUAL(top[0].first, "b");
+    BOOST_REQUIRE_EQUAL(top[0].second, 30);
+    BOOST_REQUIRE_EQUAL(top[1].first, "a");
+    BOOST_REQUIRE_EQUAL(top[1].second, 25);
+    BOOST_REQUIRE_EQUAL(counter.top(10).size(), 3);
+    BOOST_REQUIRE(!counter.count("d"));
+}
+
+BOOST_AUTO_TEST_CASE(top_k_counter_keeps_heavy_hitters) {
+    kafka::top_k_counter counter(4);
+    // many light keys churn through the counter around one heavy key
+    for (int i = 0; i < 1000; ++i) {
+        counter.add("heavy", 10);
+        counter.add(fmt::format("light-{}", i), 1);
+    }
+    BOOST_REQUIRE_EQUAL(counter.size(), 4);
+    auto top = counter.top(1);
+    BOOST_REQUIRE_EQUAL(top[0].first, "heavy");
+    BOOST_REQUIRE_EQUAL(top[0].second, 10000);
+}
+
+BOOST_AUTO_TEST_CASE(top_k_counter_new_key_inherits_minimum) {
+    kafka::top_k_counter counter(2);
+    counter.add("a", 10);
+    counter.add("b", 3);
+    counter.add("c", 1);
+    // c replaced b, its count overestimates by what b had
+    BOOST_REQUIRE(!counter.count("b"));
+    BOOST_REQUIRE_EQUAL(*counter.count("c"), 4);
+    BOOST_REQUIRE_EQUAL(*counter.count("a"), 10);
+}
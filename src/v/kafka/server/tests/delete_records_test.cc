@@ -0,0 +1,82 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/protocol/delete_records.h"
+#include "redpanda/tests/fixture.h"
+#include "test_utils/async.h"
+
+#include <chrono>
+
+using namespace std::chrono_literals;
+
+FIXTURE_TEST(delete_records, redpanda_thread_fixture) {
+    wait_for_controller_leadership().get0();
+    auto ntp = make_data(model::revision_id(2));
+    auto shard = app.shard_table.local().shard_for(ntp);
+    tests::cooperative_spin_wait_with_timeout(10s, [this, shard, ntp = ntp] {
+        return app.partition_manager.invoke_on(
+          *shard, [ntp](cluster::partition_manager& mgr) {
+              auto partition = mgr.get(ntp);
+              return partition
+                     && partition->committed_offset() >= model::offset(1);
+          });
+    }).get();
+    auto offsets = [this, shard, ntp = ntp] {
+        return app.partition_manager
+          .invoke_on(
+            *shard,
+            [ntp](cluster::partition_manager& mgr) {
+                auto partition = mgr.get(ntp);
+                return std::make_pair(
+                  partition->start_offset(), partition->high_watermark());
+            })
+          .get0();
+    };
+    auto [start, high_watermark] = offsets();
+    BOOST_REQUIRE_EQUAL(start, model::offset(0));
+
+    auto client = make_kafka_client().get0();
+    client.connect().get();
+
+    auto make_request = [&ntp](model::offset offset) {
+        kafka::delete_records_request req;
+        req.data.topics = {{
+          .name = ntp.tp.topic,
+          .partitions = {{
+            .partition_index = ntp.tp.partition,
+            .offset = offset,
+          }},
+        }};
+        req.data.timeout_ms = 10s;
+        return req;
+    };
+
+    // past the high watermark there is nothing to delete
+    auto resp = client
+                  .dispatch(
+                    make_request(high_watermark + model::offset(1)),
+                    kafka::api_version(1))
+                  .get0();
+    BOOST_REQUIRE_EQUAL(resp.data.topics.size(), 1);
+    BOOST_REQUIRE_EQUAL(resp.data.topics[0].partitions.size(), 1);
+    BOOST_REQUIRE_EQUAL(
+      resp.data.topics[0].partitions[0].error_code,
+      kafka::error_code::offset_out_of_range);
+
+    // -1 deletes up to the high watermark
+    resp = client
+             .dispatch(make_request(model::offset(-1)), kafka::api_version(1))
+             .get0();
+    auto& partition = resp.data.topics[0].partitions[0];
+    BOOST_REQUIRE_EQUAL(partition.error_code, kafka::error_code::none);
+    BOOST_REQUIRE_EQUAL(partition.low_watermark, high_watermark);
+    BOOST_REQUIRE_EQUAL(offsets().first, high_watermark);
+
+    client.stop().then([&client] { client.shutdown(); }).get();
+}
@@ -0,0 +1,105 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/server/fair_admission.h"
+
+#include <seastar/core/semaphore.hh>
+#include <seastar/testing/thread_test_case.hh>
+
+#include <boost/test/unit_test.hpp>
+
+SEASTAR_THREAD_TEST_CASE(fair_admission_takes_free_units_right_away) {
+    ss::semaphore sem(100);
+    kafka::fair_admission admission;
+    auto f = admission.admit(sem, "a", 40);
+    BOOST_REQUIRE(f.available());
+    auto units = f.get0();
+    BOOST_REQUIRE_EQUAL(units.count(), 40);
+    BOOST_REQUIRE_EQUAL(sem.available_units(), 60);
+    BOOST_REQUIRE_EQUAL(admission.queued(), 0);
+}
+
+SEASTAR_THREAD_TEST_CASE(fair_admission_interleaves_tenants) {
+    ss::semaphore sem(100);
+    kafka::fair_admission admission;
+    auto all = ss::get_units(sem, 100).get0();
+
+    // a bulk loader pipelines large requests, then a small request of
+    // another client arrives
+    auto b1 = admission.admit(sem, "bulk", 50);
+    auto b2 = admission.admit(sem, "bulk", 50);
+    auto b3 = admission.admit(sem, "bulk", 50);
+    auto small = admission.admit(sem, "small", 10);
+    BOOST_REQUIRE_EQUAL(admission.queued(), 4);
+
+    // the first bulk request was already waiting, the small one goes next
+    all.return_all();
+    auto b1_units = b1.get0();
+    auto small_units = small.get0();
+    BOOST_REQUIRE(!b2.available());
+    BOOST_REQUIRE_EQUAL(admission.queued(), 2);
+
+    b1_units.return_all();
+    auto b2_units = b2.get0();
+    BOOST_REQUIRE(!b3.available());
+    small_units.return_all();
+    b2_units.return_all();
+    BOOST_REQUIRE_EQUAL(b3.get0().count(), 50);
+    BOOST_REQUIRE_EQUAL(admission.queued(), 0);
+}
+
+SEASTAR_THREAD_TEST_CASE(fair_admission_weights) {
+    ss::semaphore sem(100);
+    kafka::fair_admission admission;
+    admission.set_weights({"heavy=4", "malformed", "zero=0", "=2"});
+    BOOST_REQUIRE_EQUAL(admission.weight("heavy"), 4);
+    BOOST_REQUIRE_EQUAL(admission.weight("malformed"), 1);
+    BOOST_REQUIRE_EQUAL(admission.weight("zero"), 1);
+    BOOST_REQUIRE_EQUAL(admission.weight("other"), 1);
+
+    auto all = ss::get_units(sem, 100).get0();
+    // the head of the queue waits for the units, the others are ordered
+    auto head = admission.admit(sem, "other", 10);
+    auto light1 = admission.admit(sem, "light", 40);
+    auto light2 = admission.admit(sem, "light", 40);
+    auto heavy1 = admission.admit(sem, "heavy", 40);
+    auto heavy2 = admission.admit(sem, "heavy", 40);
+    all.return_all();
+    auto head_units = head.get0();
+    // the heavy tenant finishes at 10 and 20, the light one at 40 and 80
+    auto heavy1_units = heavy1.get0();
+    auto heavy2_units = heavy2.get0();
+    BOOST_REQUIRE(!light1.available());
+    head_units.return_all();
+    heavy1_units.return_all();
+    heavy2_units.return_all();
+    light1.get0();
+    light2.get0();
+}
+
+SEASTAR_THREAD_TEST_CASE(fair_admission_stop_breaks_waiters) {
+    ss::semaphore sem(100);
+    kafka::fair_admission admission;
+
+    auto all = ss::get_units(sem, 100).get0();
+    auto head = admission.admit(sem, "a", 10);
+    auto queued = admission.admit(sem, "b", 10);
+    auto stopped = admission.stop();
+    BOOST_REQUIRE_THROW(head.get0(), ss::broken_semaphore);
+    BOOST_REQUIRE_THROW(queued.get0(), ss::broken_semaphore);
+    BOOST_REQUIRE_EQUAL(admission.queued(), 0);
+    BOOST_REQUIRE_THROW(
+      admission.admit(sem, "a", 10).get0(), ss::broken_semaphore);
+
+    // the request that was waiting for its units returns them
+    BOOST_REQUIRE(!stopped.available());
+    all.return_all();
+    stopped.get();
+    BOOST_REQUIRE_EQUAL(sem.available_units(), 100);
+}
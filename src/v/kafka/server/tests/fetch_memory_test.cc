@@ -0,0 +1,73 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/server/fetch_memory.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(fetch_read_memory_disabled) {
+    kafka::fetch_read_memory memory(0);
+    auto r = memory.reserve(50_MiB);
+    BOOST_REQUIRE_EQUAL(r.granted(), 50_MiB);
+    BOOST_REQUIRE_EQUAL(r.held(), 0u);
+    BOOST_REQUIRE_EQUAL(memory.active_fetches(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(fetch_read_memory_shares_evenly) {
+    kafka::fetch_read_memory memory(12_MiB);
+    // alone, a fetch gets what it wants up to the capacity
+    {
+        auto r = memory.reserve(50_MiB);
+        BOOST_REQUIRE_EQUAL(r.granted(), 12_MiB);
+    }
+    BOOST_REQUIRE_EQUAL(memory.active_fetches(), 0u);
+
+    auto small = memory.reserve(1_MiB);
+    BOOST_REQUIRE_EQUAL(small.granted(), 1_MiB);
+    // the wide fetch gets its half of the capacity, not all that is left
+    auto wide = memory.reserve(50_MiB);
+    BOOST_REQUIRE_EQUAL(wide.granted(), 6_MiB);
+    auto third = memory.reserve(50_MiB);
+    BOOST_REQUIRE_EQUAL(third.granted(), 4_MiB);
+    BOOST_REQUIRE_EQUAL(memory.active_fetches(), 3u);
+
+    // under pressure fetches still make progress
+    auto starved = memory.reserve(50_MiB);
+    BOOST_REQUIRE_EQUAL(starved.granted(), 1_MiB);
+    auto over = memory.reserve(50_MiB);
+    BOOST_REQUIRE_EQUAL(over.granted(), kafka::fetch_read_memory::min_grant);
+}
+
+BOOST_AUTO_TEST_CASE(fetch_read_memory_resize_returns_unused) {
+    kafka::fetch_read_memory memory(8_MiB);
+    auto first = memory.reserve(8_MiB);
+    BOOST_REQUIRE_EQUAL(first.granted(), 8_MiB);
+    first.resize(1_MiB);
+    BOOST_REQUIRE_EQUAL(first.held(), 1_MiB);
+
+    auto second = memory.reserve(50_MiB);
+    BOOST_REQUIRE_EQUAL(second.granted(), 4_MiB);
+    // a read past its limit holds what it returned
+    second.resize(5_MiB);
+    BOOST_REQUIRE_EQUAL(second.held(), 5_MiB);
+
+    // the capacity follows the configuration, the reservations are kept
+    memory.set_capacity(2_MiB);
+    auto third = memory.reserve(50_MiB);
+    BOOST_REQUIRE_EQUAL(third.granted(), kafka::fetch_read_memory::min_grant);
+
+    std::vector<kafka::fetch_read_memory::reservation> held;
+    held.push_back(std::move(first));
+    held.push_back(std::move(second));
+    BOOST_REQUIRE_EQUAL(memory.active_fetches(), 3u);
+    held.clear();
+    BOOST_REQUIRE_EQUAL(memory.active_fetches(), 1u);
+}
@@ -216,3 +216,49 @@ FIXTURE_TEST(test_session_operations, fixture) {
         BOOST_REQUIRE(cache.size() == 0);
     }
 }
+
+FIXTURE_TEST(test_session_seek_resets_caught_up, fixture) {
+    kafka::fetch_session_cache cache(120s);
+    kafka::fetch_request req;
+    req.session_epoch = kafka::initial_fetch_session_epoch;
+    req.session_id = kafka::invalid_fetch_session_id;
+    req.topics = {make_fetch_request_topic(model::topic("test"), 2)};
+
+    auto ctx = cache.maybe_get_session(req);
+    auto session = ctx.session();
+    for (auto& [_, e] : session->partitions()) {
+        e->partition.caught_up = true;
+    }
+    req.session_id = session->id();
+    req.session_epoch = session->epoch();
+
+    // incremental fetch moving only the first partition
+    req.topics[0].partitions.pop_back();
+    req.topics[0].partitions[0].fetch_offset = model::offset(1000);
+    auto incremental = cache.maybe_get_session(req);
+    BOOST_REQUIRE_EQUAL(incremental.is_full_fetch(), false);
+
+    model::topic topic("test");
+    auto& partitions = incremental.session()->partitions();
+    auto moved = partitions.find(
+      model::topic_partition_view(topic, model::partition_id(0)));
+    auto unchanged = partitions.find(
+      model::topic_partition_view(topic, model::partition_id(1)));
+    BOOST_REQUIRE(!moved->second->partition.caught_up);
+    BOOST_REQUIRE(unchanged->second->partition.caught_up);
+}
+
+FIXTURE_TEST(test_session_cache_memory_budget, fixture) {
+    // the first session alone exceeds the budget
+    kafka::fetch_session_cache cache(120s, 1);
+    kafka::fetch_request req;
+    req.session_epoch = kafka::initial_fetch_session_epoch;
+    req.session_id = kafka::invalid_fetch_session_id;
+    req.topics = {make_fetch_request_topic(model::topic("test"), 10)};
+
+    auto first = cache.maybe_get_session(req);
+    BOOST_REQUIRE(!first.is_sessionless());
+    auto second = cache.maybe_get_session(req);
+    BOOST_REQUIRE(second.is_sessionless());
+    BOOST_REQUIRE_EQUAL(cache.size(), 1);
+}
@@ -15,6 +15,7 @@
 #include "resource_mgmt/io_priority.h"
 #include "test_utils/async.h"
 
+#include <seastar/core/sleep.hh>
 #include <seastar/core/smp.hh>
 
 #include <chrono>
@@ -148,6 +149,21 @@ SEASTAR_THREAD_TEST_CASE(partition_iterator) {
     }
 }
 
+SEASTAR_THREAD_TEST_CASE(plan_fetch_budgets) {
+    using budgets = std::vector<size_t>;
+    // everything fits
+    BOOST_TEST(
+      kafka::plan_fetch_budgets({100, 0, 200}, 1000) == budgets({100, 0, 200}));
+    // even split between partitions with more data than their share
+    BOOST_TEST(
+      kafka::plan_fetch_budgets({1000, 1000}, 1000) == budgets({500, 500}));
+    // small partitions leave their part of the budget to the large ones
+    BOOST_TEST(
+      kafka::plan_fetch_budgets({1000, 100, 1000}, 1000)
+      == budgets({450, 100, 450}));
+    BOOST_TEST(kafka::plan_fetch_budgets({10, 10}, 0) == budgets({0, 0}));
+}
+
 // TODO: when we have a more precise log builder tool we can make these finer
 // grained tests. for now the test is coarse grained based on the random batch
 // builder.
@@ -202,6 +218,42 @@ FIXTURE_TEST(read_from_ntp_max_bytes, redpanda_thread_fixture) {
     BOOST_TEST(one <= maxlimit); // read more
 }
 
+FIXTURE_TEST(read_from_ntp_consumer_rack, redpanda_thread_fixture) {
+    wait_for_controller_leadership().get0();
+    auto ntp = make_data(model::revision_id(2));
+    auto shard = app.shard_table.local().shard_for(ntp);
+    tests::cooperative_spin_wait_with_timeout(10s, [this, shard, ntp = ntp] {
+        return app.partition_manager.invoke_on(
+          *shard, [ntp](cluster::partition_manager& mgr) {
+              auto partition = mgr.get(ntp);
+              return partition
+                     && partition->committed_offset() >= model::offset(1);
+          });
+    }).get();
+
+    // none of the replicas is in the consumer rack, the leader serves it
+    kafka::fetch_config config{
+      .start_offset = model::offset(0),
+      .max_bytes = std::numeric_limits<size_t>::max(),
+      .timeout = model::no_timeout,
+      .consumer_rack = "rack-without-replicas",
+    };
+    auto res = app.partition_manager
+                 .invoke_on(
+                   *shard,
+                   [ntp, config](cluster::partition_manager& pm) {
+                       return kafka::read_from_ntp(
+                         pm,
+                         model::materialized_ntp(ntp),
+                         config,
+                         true,
+                         model::no_timeout);
+                   })
+                 .get0();
+    BOOST_REQUIRE(!res.preferred_replica);
+    BOOST_REQUIRE(res.reader);
+}
+
 FIXTURE_TEST(fetch_one, redpanda_thread_fixture) {
     // create a topic partition with some data
     model::topic topic("foo");
@@ -492,6 +544,67 @@ FIXTURE_TEST(fetch_one_debounce, redpanda_thread_fixture) {
     BOOST_REQUIRE(resp.partitions[0].responses[0].record_set->size_bytes() > 0);
 }
 
+FIXTURE_TEST(fetch_one_long_poll_wakes_on_append, redpanda_thread_fixture) {
+    model::topic topic("foo");
+    model::partition_id pid(0);
+    auto ntp = make_default_ntp(topic, pid);
+
+    wait_for_controller_leadership().get0();
+
+    add_topic(model::topic_namespace_view(ntp)).get();
+    wait_for_partition_offset(ntp, model::offset(0)).get0();
+
+    kafka::fetch_request req;
+    req.max_bytes = std::numeric_limits<int32_t>::max();
+    req.min_bytes = 1;
+    // way longer than the test would take if the fetch was not woken
+    req.max_wait_time = std::chrono::milliseconds(60000);
+    req.session_id = kafka::invalid_fetch_session_id;
+    req.topics = {{
+      .name = topic,
+      .partitions = {{
+        .id = pid,
+        .fetch_offset = model::offset(0),
+      }},
+    }};
+
+    auto client = make_kafka_client().get0();
+    client.connect().get();
+    auto start = ss::lowres_clock::now();
+    auto fresp = client.dispatch(req, kafka::api_version(4));
+    // let the fetch park on the partition
+    ss::sleep(std::chrono::milliseconds(200)).get();
+    BOOST_REQUIRE(!fresp.available());
+
+    auto shard = app.shard_table.local().shard_for(ntp);
+    app.partition_manager
+      .invoke_on(
+        *shard,
+        [ntp](cluster::partition_manager& mgr) {
+            auto partition = mgr.get(ntp);
+            auto rdr = model::make_memory_record_batch_reader(
+              storage::test::make_random_batches(model::offset(0), 1));
+            return partition
+              ->replicate(
+                std::move(rdr),
+                raft::replicate_options(raft::consistency_level::quorum_ack))
+              .discard_result();
+        })
+      .get();
+
+    auto resp = fresp.get0();
+    client.stop().then([&client] { client.shutdown(); }).get();
+
+    BOOST_REQUIRE(
+      ss::lowres_clock::now() - start < std::chrono::milliseconds(30000));
+    BOOST_REQUIRE(resp.partitions.size() == 1);
+    BOOST_REQUIRE(resp.partitions[0].responses.size() == 1);
+    BOOST_REQUIRE(
+      resp.partitions[0].responses[0].error == kafka::error_code::none);
+    BOOST_REQUIRE(resp.partitions[0].responses[0].record_set);
+    BOOST_REQUIRE(resp.partitions[0].responses[0].record_set->size_bytes() > 0);
+}
+
 FIXTURE_TEST(fetch_multi_topics, redpanda_thread_fixture) {
     // create a topic partition with some data
     model::topic topic_1("foo");
@@ -0,0 +1,418 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "config/configuration.h"
+#include "kafka/protocol/find_coordinator.h"
+#include "kafka/protocol/heartbeat.h"
+#include "kafka/protocol/join_group.h"
+#include "kafka/protocol/offset_commit.h"
+#include "kafka/protocol/sync_group.h"
+#include "kafka/server/group_router.h"
+#include "redpanda/tests/fixture.h"
+#include "ssx/sformat.h"
+#include "syschecks/syschecks.h"
+#include "utils/hdr_hist.h"
+#include "vlog.h"
+
+#include <seastar/core/app-template.hh>
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/loop.hh>
+#include <seastar/core/sleep.hh>
+#include <seastar/core/thread.hh>
+#include <seastar/core/when_all.hh>
+
+#include <boost/range/irange.hpp>
+#include <fmt/format.h>
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <vector>
+
+/*
+ * Load harness for the group coordinator. Stands up a single broker and
+ * drives its group_router directly with groups of consumers going through
+ * the join / sync / heartbeat / commit cycle of the kafka consumer protocol,
+ * and reports:
+ *
+ *   - join latency, from a join request to its response, which includes
+ *     waiting for the rest of the group to join
+ *   - rebalance duration, from the first join of a group to the last
+ *     member having synced its assignment
+ *   - heartbeat latency
+ *   - offset commit throughput and latency
+ *   - CPU used by every shard in each phase
+ *
+ * Every round after the first one adds a member to every group, the existing
+ * members learn about the rebalance from their heartbeats and rejoin.
+ *
+ *   group_bench --smp 2 --groups 1000 --members 10 --rounds 3
+ */
+
+using namespace std::chrono_literals; // NOLINT
+
+namespace po = boost::program_options; // NOLINT
+
+static ss::logger benchlog("group_bench");
+
+struct bench_config {
+    int groups;
+    int members;
+    int rounds;
+    int commits;
+    int partitions;
+    std::chrono::milliseconds session_timeout;
+};
+
+static void cli_opts(po::options_description_easy_init o) {
+    o("groups", po::value<int>()->default_value(100), "number of groups");
+    o("members",
+      po::value<int>()->default_value(10),
+      "number of members joining every group in the first round");
+    o("rounds",
+      po::value<int>()->default_value(3),
+      "number of rebalances, every round after the first adds a member");
+    o("commits",
+      po::value<int>()->default_value(10),
+      "number of offset commits of every member");
+    o("partitions",
+      po::value<int>()->default_value(16),
+      "number of partitions in an offset commit");
+    o("session-timeout-ms",
+      po::value<int>()->default_value(30000),
+      "session and rebalance timeout of the members");
+}
+
+static bench_config cfg_from(const po::variables_map& m) {
+    return bench_config{
+      .groups = m["groups"].as<int>(),
+      .members = m["members"].as<int>(),
+      .rounds = m["rounds"].as<int>(),
+      .commits = m["commits"].as<int>(),
+      .partitions = m["partitions"].as<int>(),
+      .session_timeout = std::chrono::milliseconds(
+        m["session-timeout-ms"].as<int>()),
+    };
+}
+
+/// CPU time used by the reactor thread of every shard
+static std::vector<std::chrono::microseconds> shards_cpu_time() {
+    std::vector<std::chrono::microseconds> times(ss::smp::count);
+    ss::parallel_for_each(
+      boost::irange<ss::shard_id>(0, ss::smp::count),
+      [&times](ss::shard_id s) {
+          return ss::smp::submit_to(s, [] {
+                     rusage ru{};
+                     ::getrusage(RUSAGE_THREAD, &ru);
+                     auto to_us = [](timeval tv) {
+                         return std::chrono::seconds(tv.tv_sec)
+                                + std::chrono::microseconds(tv.tv_usec);
+                     };
+                     return std::chrono::duration_cast<
+                       std::chrono::microseconds>(
+                       to_us(ru.ru_utime) + to_us(ru.ru_stime));
+                 })
+            .then([&times, s](std::chrono::microseconds t) { times[s] = t; });
+      })
+      .get();
+    return times;
+}
+
+static bool is_retriable(kafka::error_code ec) {
+    return ec == kafka::error_code::not_coordinator
+           || ec == kafka::error_code::coordinator_not_available
+           || ec == kafka::error_code::coordinator_load_in_progress;
+}
+
+struct bench_group {
+    kafka::group_id id;
+    std::vector<kafka::member_id> members;
+    kafka::member_id leader;
+    kafka::generation_id generation;
+};
+
+class group_bench {
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    explicit group_bench(bench_config cfg)
+      : _cfg(cfg) {}
+
+    void run() {
+        ss::smp::invoke_on_all([] {
+            // members join at once, nothing to wait for
+            config::shard_local_cfg()
+              .get("group_initial_rebalance_delay")
+              .set_value(0ms);
+        }).get();
+        wait_for_coordinator();
+
+        for (auto g : boost::irange(0, _cfg.groups)) {
+            _groups.push_back(bench_group{
+              .id = kafka::group_id(ssx::sformat("group_bench_{}", g))});
+        }
+
+        for (auto round : boost::irange(0, _cfg.rounds)) {
+            auto joining = round == 0 ? _cfg.members : 1;
+            measure(ssx::sformat("rebalance {}", round), [this, joining] {
+                ss::parallel_for_each(_groups, [this, joining](bench_group& g) {
+                    return rebalance(g, joining);
+                }).get();
+            });
+            report_latency("join", _join_latency);
+            report_latency("rebalance", _rebalance_duration);
+            report_latency("heartbeat", _heartbeat_latency);
+            _join_latency = hdr_hist{};
+            _rebalance_duration = hdr_hist{};
+            _heartbeat_latency = hdr_hist{};
+        }
+
+        uint64_t commits = 0;
+        auto seconds = measure("commit", [this, &commits] {
+            ss::parallel_for_each(_groups, [this, &commits](bench_group& g) {
+                return commit_offsets(g, commits);
+            }).get();
+        });
+        fmt::print(
+          "commit: {} requests of {} partitions ({:.0f}/s)\n",
+          commits,
+          _cfg.partitions,
+          commits / seconds);
+        report_latency("commit", _commit_latency);
+        fmt::print("errors: {}\n", _errors);
+    }
+
+private:
+    kafka::group_router& router() { return _rp.app.group_router.local(); }
+
+    void wait_for_coordinator() {
+        _rp.wait_for_controller_leadership().get();
+        auto client = _rp.make_kafka_client().get0();
+        client.connect().get();
+        // creates the group metadata topic
+        while (true) {
+            kafka::find_coordinator_request req("group_bench");
+            auto resp = client.dispatch(req, kafka::api_version(1)).get0();
+            if (resp.data.error_code == kafka::error_code::none) {
+                break;
+            }
+            ss::sleep(100ms).get();
+        }
+        client.stop().then([&client] { client.shutdown(); }).get();
+    }
+
+    /// runs f and prints its duration and the CPU used by the shards
+    template<typename Func>
+    double measure(const ss::sstring& phase, Func f) {
+        auto cpu_before = shards_cpu_time();
+        auto started = clock_type::now();
+        f();
+        double seconds = std::chrono::duration<double>(
+                           clock_type::now() - started)
+                           .count();
+        auto cpu_after = shards_cpu_time();
+        fmt::print("{}: {:.3f}s\n", phase, seconds);
+        for (auto s : boost::irange<ss::shard_id>(0, ss::smp::count)) {
+            auto used = std::chrono::duration<double>(
+                          cpu_after[s] - cpu_before[s])
+                          .count();
+            fmt::print(
+              "{}: shard {} cpu {:.3f}s ({:.0f}%)\n",
+              phase,
+              s,
+              used,
+              100 * used / seconds);
+        }
+        return seconds;
+    }
+
+    static void report_latency(const ss::sstring& name, const hdr_hist& h) {
+        fmt::print(
+          "{}: latency us p50: {}, p90: {}, p99: {}, max: {}\n",
+          name,
+          h.get_value_at(50),
+          h.get_value_at(90),
+          h.get_value_at(99),
+          h.get_value_at(100));
+    }
+
+    static int64_t micros_since(clock_type::time_point t) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                 clock_type::now() - t)
+          .count();
+    }
+
+    ss::future<> rebalance(bench_group& g, int joining) {
+        auto started = clock_type::now();
+        auto existing = g.members.size();
+        g.members.resize(existing + joining);
+        std::vector<ss::future<>> joins;
+        joins.reserve(g.members.size());
+        for (auto i : boost::irange(existing, g.members.size())) {
+            joins.push_back(join_member(g, i));
+        }
+        for (auto i : boost::irange<size_t>(0, existing)) {
+            joins.push_back(
+              heartbeat_until_rebalance(g, i).then([this, &g, i] {
+                  return join_member(g, i);
+              }));
+        }
+        co_await ss::when_all_succeed(joins.begin(), joins.end());
+        co_await ss::parallel_for_each(
+          boost::irange<size_t>(0, g.members.size()),
+          [this, &g](size_t i) { return sync_member(g, i); });
+        _rebalance_duration.record(micros_since(started));
+    }
+
+    ss::future<> join_member(bench_group& g, size_t i) {
+        while (true) {
+            kafka::join_group_request r;
+            r.version = kafka::api_version(5);
+            r.data.group_id = g.id;
+            r.data.session_timeout_ms = _cfg.session_timeout;
+            r.data.rebalance_timeout_ms = _cfg.session_timeout;
+            r.data.member_id = g.members[i];
+            r.data.protocol_type = kafka::protocol_type("consumer");
+            r.data.protocols.push_back(kafka::join_group_request_protocol{
+              .name = kafka::protocol_name("range"), .metadata = bytes()});
+
+            auto started = clock_type::now();
+            auto resp = co_await router().join_group(std::move(r));
+            auto ec = resp.data.error_code;
+            if (ec == kafka::error_code::member_id_required) {
+                g.members[i] = resp.data.member_id;
+                continue;
+            }
+            if (is_retriable(ec)) {
+                co_await ss::sleep(10ms);
+                continue;
+            }
+            if (ec != kafka::error_code::none) {
+                vlog(benchlog.warn, "join of {} failed: {}", g.id, ec);
+                ++_errors;
+                co_return;
+            }
+            _join_latency.record(micros_since(started));
+            g.members[i] = resp.data.member_id;
+            g.leader = resp.data.leader;
+            g.generation = resp.data.generation_id;
+            co_return;
+        }
+    }
+
+    ss::future<> heartbeat_until_rebalance(bench_group& g, size_t i) {
+        while (true) {
+            kafka::heartbeat_request r;
+            r.data.group_id = g.id;
+            r.data.generation_id = g.generation;
+            r.data.member_id = g.members[i];
+
+            auto started = clock_type::now();
+            auto resp = co_await router().heartbeat(std::move(r));
+            _heartbeat_latency.record(micros_since(started));
+            auto ec = resp.data.error_code;
+            if (ec == kafka::error_code::rebalance_in_progress) {
+                co_return;
+            }
+            if (ec != kafka::error_code::none && !is_retriable(ec)) {
+                vlog(benchlog.warn, "heartbeat of {} failed: {}", g.id, ec);
+                ++_errors;
+                co_return;
+            }
+            co_await ss::sleep(10ms);
+        }
+    }
+
+    ss::future<> sync_member(bench_group& g, size_t i) {
+        while (true) {
+            kafka::sync_group_request r;
+            r.data.group_id = g.id;
+            r.data.generation_id = g.generation;
+            r.data.member_id = g.members[i];
+            if (g.members[i] == g.leader) {
+                for (const auto& m : g.members) {
+                    r.data.assignments.push_back(
+                      kafka::sync_group_request_assignment{
+                        .member_id = m, .assignment = bytes()});
+                }
+            }
+
+            auto resp = co_await router().sync_group(std::move(r));
+            auto ec = resp.data.error_code;
+            if (is_retriable(ec)) {
+                co_await ss::sleep(10ms);
+                continue;
+            }
+            if (ec != kafka::error_code::none) {
+                vlog(benchlog.warn, "sync of {} failed: {}", g.id, ec);
+                ++_errors;
+            }
+            co_return;
+        }
+    }
+
+    ss::future<> commit_offsets(bench_group& g, uint64_t& commits) {
+        return ss::parallel_for_each(
+          boost::irange<size_t>(0, g.members.size()),
+          [this, &g, &commits](size_t i) {
+              return commit_member(g, i, commits);
+          });
+    }
+
+    ss::future<> commit_member(bench_group& g, size_t i, uint64_t& commits) {
+        for (auto n : boost::irange(0, _cfg.commits)) {
+            kafka::offset_commit_request r;
+            r.data.group_id = g.id;
+            r.data.generation_id = g.generation();
+            r.data.member_id = g.members[i];
+            r.data.topics.push_back(kafka::offset_commit_request_topic{
+              .name = model::topic("group_bench")});
+            for (auto p : boost::irange(0, _cfg.partitions)) {
+                r.data.topics.back().partitions.push_back(
+                  kafka::offset_commit_request_partition{
+                    .partition_index = model::partition_id(p),
+                    .committed_offset = model::offset(n)});
+            }
+
+            auto started = clock_type::now();
+            auto resp = co_await router().offset_commit(std::move(r));
+            _commit_latency.record(micros_since(started));
+            ++commits;
+            for (const auto& t : resp.data.topics) {
+                for (const auto& p : t.partitions) {
+                    if (p.error_code != kafka::error_code::none) {
+                        ++_errors;
+                    }
+                }
+            }
+        }
+    }
+
+    bench_config _cfg;
+    redpanda_thread_fixture _rp;
+    std::vector<bench_group> _groups;
+    hdr_hist _join_latency;
+    hdr_hist _rebalance_duration;
+    hdr_hist _heartbeat_latency;
+    hdr_hist _commit_latency;
+    uint64_t _errors = 0;
+};
+
+int main(int args, char** argv, char** env) {
+    syschecks::initialize_intrinsics();
+    std::setvbuf(stdout, nullptr, _IOLBF, 1024);
+    ss::app_template app;
+    cli_opts(app.add_options());
+    return app.run(args, argv, [&] {
+        return ss::async([&] {
+            group_bench bench(cfg_from(app.configuration()));
+            bench.run();
+        });
+    });
+}
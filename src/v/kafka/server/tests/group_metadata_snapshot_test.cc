@@ -0,0 +1,67 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/server/group_metadata_snapshot.h"
+#include "random/generators.h"
+#include "ssx/sformat.h"
+#include "storage/snapshot.h"
+
+#include <seastar/core/seastar.hh>
+#include <seastar/testing/thread_test_case.hh>
+
+#include <filesystem>
+
+static std::filesystem::path make_snapshot_dir() {
+    auto dir = std::filesystem::path(ssx::sformat(
+      "group_metadata_snapshot_test.{}",
+      random_generators::gen_alphanum_string(6)));
+    std::filesystem::create_directories(dir);
+    return dir;
+}
+
+SEASTAR_THREAD_TEST_CASE(group_metadata_snapshot_roundtrip) {
+    auto dir = make_snapshot_dir();
+    storage::snapshot_manager snap(
+      dir, "group_metadata.snapshot", ss::default_priority_class());
+
+    BOOST_REQUIRE(!kafka::read_group_metadata_snapshot(snap).get0());
+
+    kafka::recovery_batch_consumer_state st;
+    st.last_offset = model::offset(42);
+    st.loaded_groups[kafka::group_id("g0")] = kafka::group_log_group_metadata{
+      .protocol_type = kafka::protocol_type("consumer"),
+      .generation = kafka::generation_id(3),
+      .protocol = kafka::protocol_name("range"),
+      .state_timestamp = 10,
+    };
+    st.removed_groups.emplace(kafka::group_id("g1"));
+    kafka::group_log_offset_key key{
+      kafka::group_id("g0"), model::topic("t"), model::partition_id(1)};
+    st.loaded_offsets[key] = std::make_pair(
+      model::offset(40),
+      kafka::group_log_offset_metadata{
+        model::offset(1000), 2, ss::sstring("meta")});
+
+    kafka::write_group_metadata_snapshot(snap, std::move(st)).get();
+
+    auto recovered = kafka::read_group_metadata_snapshot(snap).get0();
+    BOOST_REQUIRE(recovered);
+    BOOST_REQUIRE_EQUAL(recovered->last_offset, model::offset(42));
+    BOOST_REQUIRE_EQUAL(recovered->loaded_groups.size(), 1);
+    auto& md = recovered->loaded_groups.at(kafka::group_id("g0"));
+    BOOST_REQUIRE_EQUAL(md.generation, kafka::generation_id(3));
+    BOOST_REQUIRE_EQUAL(*md.protocol, kafka::protocol_name("range"));
+    BOOST_REQUIRE(recovered->removed_groups.contains(kafka::group_id("g1")));
+    auto& o = recovered->loaded_offsets.at(key);
+    BOOST_REQUIRE_EQUAL(o.first, model::offset(40));
+    BOOST_REQUIRE_EQUAL(o.second.offset, model::offset(1000));
+    BOOST_REQUIRE_EQUAL(o.second.metadata, ss::sstring("meta"));
+
+    std::filesystem::remove_all(dir);
+}
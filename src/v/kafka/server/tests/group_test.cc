@@ -8,6 +8,7 @@
 // by the Apache License, Version 2.0
 
 #include "config/configuration.h"
+#include "kafka/protocol/offset_fetch.h"
 #include "kafka/server/group.h"
 #include "utils/to_string.h"
 
@@ -428,6 +429,49 @@ SEASTAR_THREAD_TEST_CASE(leader_rejoined) {
     BOOST_TEST(g.leader() == "n");
 }
 
+SEASTAR_THREAD_TEST_CASE(static_member_fenced_by_new_instance) {
+    auto g = get();
+    auto iid = std::make_optional(kafka::group_instance_id("i"));
+
+    auto m0 = get_group_member("m");
+    (void)g.add_member(m0);
+    BOOST_TEST(!g.is_member_fenced(kafka::member_id("m"), iid));
+
+    // a new instance with the same group instance id takes over
+    auto m1 = get_group_member("n");
+    (void)g.add_member(m1);
+    BOOST_TEST(g.is_member_fenced(kafka::member_id("m"), iid));
+    BOOST_TEST(!g.is_member_fenced(kafka::member_id("n"), iid));
+
+    // dynamic members are never fenced
+    BOOST_TEST(!g.is_member_fenced(kafka::member_id("m"), std::nullopt));
+}
+
+SEASTAR_THREAD_TEST_CASE(fetch_offsets) {
+    group::offset_map offsets;
+    offsets.emplace(
+      model::topic_partition(model::topic("t"), model::partition_id(0)),
+      group::offset_metadata{model::offset(10), model::offset(3), "md"});
+
+    // all committed offsets
+    offset_fetch_request r;
+    auto resp = group::fetch_offsets(offsets, r);
+    BOOST_REQUIRE_EQUAL(resp.data.topics.size(), 1);
+    BOOST_REQUIRE_EQUAL(resp.data.topics[0].partitions.size(), 1);
+    BOOST_TEST(resp.data.topics[0].partitions[0].committed_offset == 3);
+    BOOST_TEST(resp.data.topics[0].partitions[0].metadata == "md");
+
+    // requested partitions, unknown ones have no offset
+    r.data.topics = {{
+      .name = model::topic("t"),
+      .partition_indexes = {model::partition_id(0), model::partition_id(1)},
+    }};
+    resp = group::fetch_offsets(offsets, r);
+    BOOST_REQUIRE_EQUAL(resp.data.topics[0].partitions.size(), 2);
+    BOOST_TEST(resp.data.topics[0].partitions[0].committed_offset == 3);
+    BOOST_TEST(resp.data.topics[0].partitions[1].committed_offset == -1);
+}
+
 SEASTAR_THREAD_TEST_CASE(generate_member_id) {
     join_group_request r;
 
@@ -0,0 +1,46 @@
+// Copyright 2020 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/protocol/list_groups.h"
+#include "kafka/server/handlers/list_groups.h"
+#include "redpanda/tests/fixture.h"
+
+#include <seastar/core/smp.hh>
+
+static_assert(!kafka::is_flexible<kafka::list_groups_api>(
+  kafka::api_version(2)));
+static_assert(kafka::is_flexible<kafka::list_groups_api>(
+  kafka::list_groups_handler::max_supported));
+
+FIXTURE_TEST(list_groups_flexible_roundtrip, redpanda_thread_fixture) {
+    wait_for_controller_leadership().get();
+
+    auto client = make_kafka_client().get0();
+    client.connect().get();
+
+    // the same request through the classic headers and encoding and through
+    // the flexible ones (request header v2, response header v1). a reply that
+    // is framed wrong does not decode, or decodes into garbage
+    auto classic
+      = client.dispatch(kafka::list_groups_request{}, kafka::api_version(2))
+          .get0();
+    auto flexible
+      = client.dispatch(kafka::list_groups_request{}, kafka::api_version(3))
+          .get0();
+    // the connection stays in sync after a flexible exchange
+    auto again
+      = client.dispatch(kafka::list_groups_request{}, kafka::api_version(2))
+          .get0();
+    client.stop().then([&client] { client.shutdown(); }).get();
+
+    BOOST_TEST(classic.data.error_code == kafka::error_code::none);
+    BOOST_TEST(flexible.data.error_code == kafka::error_code::none);
+    BOOST_TEST(again.data.error_code == kafka::error_code::none);
+    BOOST_TEST(flexible.data.groups.size() == classic.data.groups.size());
+}
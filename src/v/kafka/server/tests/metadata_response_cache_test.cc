@@ -0,0 +1,52 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/server/metadata_response_cache.h"
+
+#include <boost/test/unit_test.hpp>
+
+static kafka::metadata_response_cache::fragment_ptr
+make_fragment(std::string_view s) {
+    auto f = ss::make_lw_shared<iobuf>();
+    f->append(s.data(), s.size());
+    return f;
+}
+
+BOOST_AUTO_TEST_CASE(metadata_response_cache_get_put) {
+    kafka::metadata_response_cache cache;
+    model::topic tp("tp");
+    auto v = kafka::api_version(5);
+
+    BOOST_REQUIRE(!cache.get(tp, v, 1));
+    cache.put(tp, v, 1, make_fragment("tp-v5"));
+    auto f = cache.get(tp, v, 1);
+    BOOST_REQUIRE(f);
+    BOOST_REQUIRE_EQUAL(f->size_bytes(), 5);
+    // fragments are cached per api version
+    BOOST_REQUIRE(!cache.get(tp, kafka::api_version(6), 1));
+    BOOST_REQUIRE(!cache.get(model::topic("other"), v, 1));
+}
+
+BOOST_AUTO_TEST_CASE(metadata_response_cache_epoch_invalidation) {
+    kafka::metadata_response_cache cache;
+    auto v = kafka::api_version(5);
+    cache.put(model::topic("a"), v, 1, make_fragment("a"));
+    cache.put(model::topic("b"), v, 1, make_fragment("b"));
+    BOOST_REQUIRE_EQUAL(cache.size(), 2);
+
+    // metadata changed, nothing from the previous epoch is served
+    BOOST_REQUIRE(!cache.get(model::topic("a"), v, 2));
+    BOOST_REQUIRE_EQUAL(cache.size(), 0);
+
+    cache.put(model::topic("a"), v, 2, make_fragment("a"));
+    BOOST_REQUIRE(cache.get(model::topic("a"), v, 2));
+    // a put of a stale epoch is dropped
+    cache.put(model::topic("b"), v, 1, make_fragment("b"));
+    BOOST_REQUIRE(!cache.get(model::topic("b"), v, 2));
+}
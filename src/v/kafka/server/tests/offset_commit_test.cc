@@ -18,7 +18,7 @@
 #include <limits>
 
 FIXTURE_TEST(
-  offset_commit_static_membership_not_supported, redpanda_thread_fixture) {
+  offset_commit_static_membership_supported, redpanda_thread_fixture) {
     auto client = make_kafka_client().get0();
     client.connect().get();
 
@@ -34,5 +34,5 @@ FIXTURE_TEST(
 
     BOOST_TEST(
       resp.data.topics[0].partitions[0].error_code
-      == kafka::error_code::unsupported_version);
+      != kafka::error_code::unsupported_version);
 }
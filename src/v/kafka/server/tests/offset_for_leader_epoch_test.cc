@@ -0,0 +1,70 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/protocol/offset_for_leader_epoch.h"
+#include "redpanda/tests/fixture.h"
+#include "test_utils/async.h"
+
+#include <chrono>
+
+using namespace std::chrono_literals;
+
+FIXTURE_TEST(offset_for_leader_epoch, redpanda_thread_fixture) {
+    wait_for_controller_leadership().get0();
+    auto ntp = make_data(model::revision_id(2));
+    auto shard = app.shard_table.local().shard_for(ntp);
+    tests::cooperative_spin_wait_with_timeout(10s, [this, shard, ntp = ntp] {
+        return app.partition_manager.invoke_on(
+          *shard, [ntp](cluster::partition_manager& mgr) {
+              auto partition = mgr.get(ntp);
+              return partition
+                     && partition->committed_offset() >= model::offset(1);
+          });
+    }).get();
+    auto high_watermark = app.partition_manager
+                            .invoke_on(
+                              *shard,
+                              [ntp](cluster::partition_manager& mgr) {
+                                  return mgr.get(ntp)->high_watermark();
+                              })
+                            .get0();
+
+    auto client = make_kafka_client().get0();
+    client.connect().get();
+
+    auto make_request = [&ntp](int32_t current_leader_epoch) {
+        kafka::offset_for_leader_epoch_request req;
+        req.data.topics = {{
+          .name = ntp.tp.topic,
+          .partitions = {{
+            .partition_index = ntp.tp.partition,
+            .current_leader_epoch = current_leader_epoch,
+            .leader_epoch = 1000,
+          }},
+        }};
+        return req;
+    };
+
+    // past the latest term the epoch ends at the high watermark
+    auto resp = client.dispatch(make_request(-1), kafka::api_version(2)).get0();
+    BOOST_REQUIRE_EQUAL(resp.data.topics.size(), 1);
+    BOOST_REQUIRE_EQUAL(resp.data.topics[0].partitions.size(), 1);
+    auto& partition = resp.data.topics[0].partitions[0];
+    BOOST_REQUIRE_EQUAL(partition.error_code, kafka::error_code::none);
+    BOOST_REQUIRE_GE(partition.leader_epoch, 0);
+    BOOST_REQUIRE_EQUAL(partition.end_offset, high_watermark);
+
+    // a consumer knowing a newer epoch than the partition is rejected
+    resp = client.dispatch(make_request(1000), kafka::api_version(2)).get0();
+    BOOST_REQUIRE_EQUAL(
+      resp.data.topics[0].partitions[0].error_code,
+      kafka::error_code::unknown_leader_epoch);
+
+    client.stop().then([&client] { client.shutdown(); }).get();
+}
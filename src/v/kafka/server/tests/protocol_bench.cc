@@ -0,0 +1,423 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "bytes/bytes.h"
+#include "kafka/protocol/batch_consumer.h"
+#include "kafka/protocol/fetch.h"
+#include "kafka/protocol/kafka_batch_adapter.h"
+#include "kafka/protocol/metadata.h"
+#include "kafka/protocol/produce.h"
+#include "kafka/protocol/request_reader.h"
+#include "kafka/protocol/response_writer.h"
+#include "kafka/protocol/response_writer_utils.h"
+#include "kafka/server/handlers/fetch.h"
+#include "random/generators.h"
+#include "raft/types.h"
+#include "ssx/sformat.h"
+#include "storage/record_batch_builder.h"
+#include "units.h"
+
+#include <seastar/core/memory.hh>
+#include <seastar/testing/perf_tests.hh>
+
+#include <fmt/format.h>
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Cost of the kafka protocol layer of the broker: decoding and encoding the
+ * produce, fetch and metadata requests and responses from 1 to 10k
+ * partitions, validating produced batches and adapting fetched ones.
+ *
+ *   kafka_protocol_bench -c 1
+ *
+ * perf_tests reports the time per op. The allocations per op of the measured
+ * sections are printed at the end of the run.
+ */
+
+namespace {
+
+class allocation_report {
+public:
+    allocation_report() = default;
+    allocation_report(const allocation_report&) = delete;
+    allocation_report& operator=(const allocation_report&) = delete;
+    allocation_report(allocation_report&&) = delete;
+    allocation_report& operator=(allocation_report&&) = delete;
+
+    ~allocation_report() {
+        if (_tests.empty()) {
+            return;
+        }
+        fmt::print("\n{:<48} {:>12}\n", "test", "allocs/op");
+        for (const auto& [name, e] : _tests) {
+            fmt::print(
+              "{:<48} {:>12.1f}\n", name, double(e.allocs) / double(e.ops));
+        }
+    }
+
+    void add(std::string_view test, uint64_t allocs) {
+        auto& e = _tests[std::string(test)];
+        e.allocs += allocs;
+        ++e.ops;
+    }
+
+private:
+    struct entry {
+        uint64_t allocs{0};
+        uint64_t ops{0};
+    };
+    std::map<std::string, entry> _tests;
+};
+
+allocation_report report;
+
+/// measures one op, its result is destroyed out of the measured section
+template<typename Func>
+void measure(std::string_view test, Func&& f) {
+    const auto mallocs = ss::memory::stats().mallocs();
+    perf_tests::start_measuring_time();
+    auto result = f();
+    perf_tests::do_not_optimize(result);
+    perf_tests::stop_measuring_time();
+    report.add(test, ss::memory::stats().mallocs() - mallocs);
+}
+
+constexpr kafka::api_version produce_version(7);
+constexpr kafka::api_version fetch_version(11);
+constexpr kafka::api_version metadata_version(7);
+
+const model::topic bench_topic("bench");
+
+model::record_batch make_batch(
+  int records,
+  size_t value_size,
+  model::record_batch_type type = raft::data_batch_type) {
+    storage::record_batch_builder builder(type, model::offset(0));
+    for (int i = 0; i < records; ++i) {
+        builder.add_raw_kv(
+          bytes_to_iobuf(random_generators::get_bytes(16)),
+          bytes_to_iobuf(random_generators::get_bytes(value_size)));
+    }
+    return std::move(builder).build();
+}
+
+/// a small batch of a single record and a large batch of 100 records of 1KiB
+struct batches {
+    model::record_batch small = make_batch(1, 100);
+    model::record_batch large = make_batch(100, 1_KiB);
+};
+
+/// the kafka wire format of a batch
+iobuf kafka_record_set(model::record_batch& batch) {
+    iobuf out;
+    kafka::response_writer writer(out);
+    kafka::writer_serialize_batch(writer, batch.share());
+    return out;
+}
+
+iobuf share(iobuf& buf) { return buf.share(0, buf.size_bytes()); }
+
+} // namespace
+
+struct produce_bench : batches {
+    kafka::produce_request make_request(model::record_batch& b, int count) {
+        std::vector<kafka::produce_request::partition> partitions;
+        partitions.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            kafka::produce_request::partition p{.id = model::partition_id(i)};
+            p.adapter.batch = b.share();
+            partitions.push_back(std::move(p));
+        }
+        std::vector<kafka::produce_request::topic> topics;
+        topics.push_back(kafka::produce_request::topic{
+          .name = bench_topic, .partitions = std::move(partitions)});
+        return kafka::produce_request(std::nullopt, -1, std::move(topics));
+    }
+
+    iobuf& wire(model::record_batch& b, int count) {
+        auto& buf = _wire[{&b, count}];
+        if (buf.empty()) {
+            auto request = make_request(b, count);
+            kafka::response_writer writer(buf);
+            request.encode(writer, produce_version);
+        }
+        return buf;
+    }
+
+    void encode(std::string_view test, model::record_batch& b, int count) {
+        auto request = make_request(b, count);
+        measure(test, [&request] {
+            iobuf out;
+            kafka::response_writer writer(out);
+            request.encode(writer, produce_version);
+            return out;
+        });
+    }
+
+    void decode(std::string_view test, model::record_batch& b, int count) {
+        kafka::request_reader reader(share(wire(b, count)));
+        measure(test, [&reader] {
+            kafka::produce_request request(std::nullopt, -1, {});
+            request.decode(reader, produce_version);
+            return request;
+        });
+    }
+
+    std::map<std::pair<model::record_batch*, int>, iobuf> _wire;
+};
+
+PERF_TEST_F(produce_bench, encode_small_1) {
+    encode("produce.encode_small_1", small, 1);
+}
+PERF_TEST_F(produce_bench, encode_small_100) {
+    encode("produce.encode_small_100", small, 100);
+}
+PERF_TEST_F(produce_bench, encode_small_10k) {
+    encode("produce.encode_small_10k", small, 10000);
+}
+PERF_TEST_F(produce_bench, encode_large_1) {
+    encode("produce.encode_large_1", large, 1);
+}
+PERF_TEST_F(produce_bench, encode_large_100) {
+    encode("produce.encode_large_100", large, 100);
+}
+PERF_TEST_F(produce_bench, decode_small_1) {
+    decode("produce.decode_small_1", small, 1);
+}
+PERF_TEST_F(produce_bench, decode_small_100) {
+    decode("produce.decode_small_100", small, 100);
+}
+PERF_TEST_F(produce_bench, decode_small_10k) {
+    decode("produce.decode_small_10k", small, 10000);
+}
+PERF_TEST_F(produce_bench, decode_large_1) {
+    decode("produce.decode_large_1", large, 1);
+}
+PERF_TEST_F(produce_bench, decode_large_100) {
+    decode("produce.decode_large_100", large, 100);
+}
+
+/// validation of a single batch, as done for each partition of a produce
+struct batch_adapter_bench : batches {
+    iobuf small_wire = kafka_record_set(small);
+    iobuf large_wire = kafka_record_set(large);
+
+    static void adapt(std::string_view test, iobuf& wire) {
+        auto record_set = share(wire);
+        measure(test, [&record_set] {
+            kafka::kafka_batch_adapter adapter;
+            adapter.adapt(std::move(record_set));
+            return adapter;
+        });
+    }
+};
+
+PERF_TEST_F(batch_adapter_bench, adapt_small) {
+    adapt("batch_adapter.adapt_small", small_wire);
+}
+PERF_TEST_F(batch_adapter_bench, adapt_large) {
+    adapt("batch_adapter.adapt_large", large_wire);
+}
+
+struct fetch_bench : batches {
+    model::record_batch control = make_batch(
+      1, 100, raft::configuration_batch_type);
+
+    static kafka::fetch_request make_request(int count) {
+        kafka::fetch_request request;
+        request.replica_id = model::node_id(-1);
+        request.max_wait_time = std::chrono::milliseconds(500);
+        request.min_bytes = 1;
+        kafka::fetch_request::topic t{.name = bench_topic};
+        t.partitions.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            t.partitions.push_back(kafka::fetch_request::partition{
+              .id = model::partition_id(i),
+              .fetch_offset = model::offset(i),
+              .partition_max_bytes = int32_t(1_MiB)});
+        }
+        request.topics.push_back(std::move(t));
+        return request;
+    }
+
+    void encode(std::string_view test, int count) {
+        auto request = make_request(count);
+        measure(test, [&request] {
+            iobuf out;
+            kafka::response_writer writer(out);
+            request.encode(writer, fetch_version);
+            return out;
+        });
+    }
+
+    void decode(std::string_view test, int count) {
+        auto& buf = _wire[count];
+        if (buf.empty()) {
+            kafka::response_writer writer(buf);
+            make_request(count).encode(writer, fetch_version);
+        }
+        kafka::request_reader reader(share(buf));
+        measure(test, [&reader] {
+            kafka::fetch_request request;
+            request.decode(reader, fetch_version);
+            return request;
+        });
+    }
+
+    /// the record set of a partition read from the log
+    static void serialize(std::string_view test, model::record_batch& b) {
+        ss::circular_buffer<model::record_batch> slice;
+        for (int i = 0; i < 10; ++i) {
+            slice.push_back(b.share());
+        }
+        measure(test, [&slice] {
+            kafka::kafka_batch_serializer serializer;
+            (void)serializer(std::move(slice));
+            return serializer.end_of_stream();
+        });
+    }
+
+    static void adapt(std::string_view test, model::record_batch& b) {
+        auto batch = b.share();
+        measure(test, [&batch] {
+            return kafka::adapt_fetch_batch(std::move(batch));
+        });
+    }
+
+    std::map<int, iobuf> _wire;
+};
+
+PERF_TEST_F(fetch_bench, request_encode_1) {
+    encode("fetch.request_encode_1", 1);
+}
+PERF_TEST_F(fetch_bench, request_encode_100) {
+    encode("fetch.request_encode_100", 100);
+}
+PERF_TEST_F(fetch_bench, request_encode_10k) {
+    encode("fetch.request_encode_10k", 10000);
+}
+PERF_TEST_F(fetch_bench, request_decode_1) {
+    decode("fetch.request_decode_1", 1);
+}
+PERF_TEST_F(fetch_bench, request_decode_100) {
+    decode("fetch.request_decode_100", 100);
+}
+PERF_TEST_F(fetch_bench, request_decode_10k) {
+    decode("fetch.request_decode_10k", 10000);
+}
+PERF_TEST_F(fetch_bench, record_set_small) {
+    serialize("fetch.record_set_small", small);
+}
+PERF_TEST_F(fetch_bench, record_set_large) {
+    serialize("fetch.record_set_large", large);
+}
+PERF_TEST_F(fetch_bench, adapt_data_batch) {
+    adapt("fetch.adapt_data_batch", large);
+}
+PERF_TEST_F(fetch_bench, adapt_control_batch) {
+    adapt("fetch.adapt_control_batch", control);
+}
+
+struct metadata_bench {
+    static kafka::metadata_response make_response(int count) {
+        kafka::metadata_response response;
+        for (int i = 0; i < 3; ++i) {
+            response.brokers.push_back(kafka::metadata_response::broker{
+              .node_id = model::node_id(i),
+              .host = ssx::sformat("broker-{}.local", i),
+              .port = 9092});
+        }
+        response.cluster_id = "bench";
+        response.controller_id = model::node_id(0);
+        kafka::metadata_response::topic t{
+          .err_code = kafka::error_code::none, .name = bench_topic};
+        t.partitions.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            std::vector<model::node_id> replicas{
+              model::node_id(i % 3),
+              model::node_id((i + 1) % 3),
+              model::node_id((i + 2) % 3)};
+            t.partitions.push_back(kafka::metadata_response::partition{
+              .err_code = kafka::error_code::none,
+              .index = model::partition_id(i),
+              .leader = replicas.front(),
+              .leader_epoch = 1,
+              .replica_nodes = replicas,
+              .isr_nodes = replicas});
+        }
+        response.topics.push_back(std::move(t));
+        return response;
+    }
+
+    void encode(std::string_view test, int count) {
+        auto response = make_response(count);
+        measure(test, [&response] {
+            iobuf out;
+            kafka::response_writer writer(out);
+            response.encode(metadata_version, writer);
+            return out;
+        });
+    }
+
+    void decode(std::string_view test, int count) {
+        auto& buf = _wire[count];
+        if (buf.empty()) {
+            kafka::response_writer writer(buf);
+            make_response(count).encode(metadata_version, writer);
+        }
+        auto wire = share(buf);
+        measure(test, [&wire] {
+            kafka::metadata_response response;
+            response.decode(std::move(wire), metadata_version);
+            return response;
+        });
+    }
+
+    static void decode_request(std::string_view test) {
+        kafka::metadata_request encoded{
+          .topics = std::vector<model::topic>{bench_topic}};
+        iobuf buf;
+        kafka::response_writer writer(buf);
+        encoded.encode(writer, metadata_version);
+        kafka::request_reader reader(std::move(buf));
+        measure(test, [&reader] {
+            kafka::metadata_request request;
+            request.decode(reader, metadata_version);
+            return request;
+        });
+    }
+
+    std::map<int, iobuf> _wire;
+};
+
+PERF_TEST_F(metadata_bench, request_decode) {
+    decode_request("metadata.request_decode");
+}
+PERF_TEST_F(metadata_bench, response_encode_1) {
+    encode("metadata.response_encode_1", 1);
+}
+PERF_TEST_F(metadata_bench, response_encode_100) {
+    encode("metadata.response_encode_100", 100);
+}
+PERF_TEST_F(metadata_bench, response_encode_10k) {
+    encode("metadata.response_encode_10k", 10000);
+}
+PERF_TEST_F(metadata_bench, response_decode_1) {
+    decode("metadata.response_decode_1", 1);
+}
+PERF_TEST_F(metadata_bench, response_decode_100) {
+    decode("metadata.response_decode_100", 100);
+}
+PERF_TEST_F(metadata_bench, response_decode_10k) {
+    decode("metadata.response_decode_10k", 10000);
+}
@@ -0,0 +1,107 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#define BOOST_TEST_MODULE quota_manager
+#include "config/configuration.h"
+#include "kafka/server/quota_manager.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+
+using namespace std::chrono_literals;
+using clock = kafka::quota_manager::clock;
+
+static void set_rate(const char* name, uint32_t rate) {
+    config::shard_local_cfg().get(name).set_value(rate);
+}
+
+struct quota_fixture {
+    quota_fixture() {
+        set_rate("client_produce_quota_byte_rate", 1000);
+        set_rate("user_fetch_quota_byte_rate", 1000);
+        set_rate("client_request_quota_rate", 0);
+    }
+    ~quota_fixture() {
+        set_rate("client_produce_quota_byte_rate", 0);
+        set_rate("user_fetch_quota_byte_rate", 0);
+    }
+};
+
+BOOST_FIXTURE_TEST_CASE(test_quota_within_budget, quota_fixture) {
+    kafka::quota_manager qm;
+    auto now = clock::now();
+    auto d = qm.record_and_throttle(
+      kafka::quota_type::produce_bytes, "client", "", 500, now);
+    BOOST_REQUIRE(d == clock::duration(0));
+    // no rate, no quota
+    d = qm.record_and_throttle(
+      kafka::quota_type::requests, "client", "", 1'000'000, now);
+    BOOST_REQUIRE(d == clock::duration(0));
+}
+
+BOOST_FIXTURE_TEST_CASE(test_quota_delay_until_refilled, quota_fixture) {
+    kafka::quota_manager qm;
+    auto now = clock::now();
+    // one second of burst plus half a second of debt
+    auto d = qm.record_and_throttle(
+      kafka::quota_type::produce_bytes, "client", "", 1500, now);
+    BOOST_REQUIRE(d > 400ms);
+    BOOST_REQUIRE(d <= 500ms);
+
+    // other clients have their own bucket
+    d = qm.record_and_throttle(
+      kafka::quota_type::produce_bytes, "other", "", 500, now);
+    BOOST_REQUIRE(d == clock::duration(0));
+
+    d = qm.record_and_throttle(
+      kafka::quota_type::produce_bytes, "client", "", 0, now + 500ms);
+    BOOST_REQUIRE(d == clock::duration(0));
+}
+
+BOOST_FIXTURE_TEST_CASE(test_quota_user_separate_from_client, quota_fixture) {
+    kafka::quota_manager qm;
+    auto now = clock::now();
+    // fetch bytes are only limited per user, whatever the client id
+    auto d = qm.record_and_throttle(
+      kafka::quota_type::fetch_bytes, "a", "alice", 1000, now);
+    BOOST_REQUIRE(d == clock::duration(0));
+    d = qm.record_and_throttle(
+      kafka::quota_type::fetch_bytes, "b", "alice", 500, now);
+    BOOST_REQUIRE(d > clock::duration(0));
+    d = qm.record_and_throttle(
+      kafka::quota_type::fetch_bytes, "b", "bob", 500, now);
+    BOOST_REQUIRE(d == clock::duration(0));
+    // unauthenticated connections have no user quota
+    d = qm.record_and_throttle(
+      kafka::quota_type::fetch_bytes, "b", "", 5000, now);
+    BOOST_REQUIRE(d == clock::duration(0));
+}
+
+BOOST_FIXTURE_TEST_CASE(test_quota_apply_remote_usage, quota_fixture) {
+    kafka::quota_manager qm;
+    auto now = clock::now();
+    qm.record_and_throttle(
+      kafka::quota_type::produce_bytes, "client", "", 500, now);
+    auto local = qm.take_unsynced_usage();
+    BOOST_REQUIRE_EQUAL(local.size(), 1);
+    BOOST_REQUIRE_EQUAL(local[0].second, 500);
+    BOOST_REQUIRE(qm.take_unsynced_usage().empty());
+
+    // usage of the same client on another core
+    std::vector<kafka::quota_manager::usage_t> per_shard(2);
+    per_shard[1] = local;
+    per_shard[1][0].second = 1000;
+    qm.apply_remote_usage(per_shard, now);
+    auto d = qm.record_and_throttle(
+      kafka::quota_type::produce_bytes, "client", "", 0, now);
+    BOOST_REQUIRE(d > 400ms);
+    // remote usage is not synced back
+    BOOST_REQUIRE(qm.take_unsynced_usage().empty());
+}
@@ -9,10 +9,16 @@
 
 #include "model/adl_serde.h"
 
+#include "likely.h"
 #include "model/record.h"
+#include "units.h"
+#include "utils/vint.h"
 
+#include <seastar/core/byteorder.hh>
 #include <seastar/core/smp.hh>
 
+#include <fmt/format.h>
+
 namespace reflection {
 
 void adl<model::topic>::to(iobuf& out, model::topic&& t) {
@@ -238,18 +244,72 @@ void adl<model::record_batch>::to(iobuf& out, model::record_batch&& batch) {
       [&out](model::record r) { reflection::serialize(out, std::move(r)); });
 }
 
+// keys and values at least this large are adopted as shares of the buffers
+// they were received in, they span most of the buffers they keep alive.
+// smaller ones are copied to keep the records of a batch in few fragments
+static constexpr int32_t shared_bytes_threshold = 16_KiB;
+
+static void append_vint(iobuf& out, int64_t v) {
+    auto vb = vint::to_bytes(v);
+    out.append(vb.data(), vb.size());
+}
+
+// the data of an adl<iobuf>
+static void transcode_bytes(iobuf_parser& in, iobuf& out) {
+    auto n = in.consume_type<int32_t>();
+    if (n >= shared_bytes_threshold) {
+        out.append(in.share(n));
+        return;
+    }
+    auto c = in.consume(n, [&out](const char* src, size_t sz) {
+        out.append(src, sz);
+        return ss::stop_iteration::no;
+    });
+    if (unlikely(c != size_t(n))) {
+        throw std::out_of_range(fmt::format(
+          "record bytes out of range, expected:{}, got:{}", n, c));
+    }
+}
+
+// an adl<model::record> in the packed encoding of model::record_batch, see
+// model::append_record_to_buffer
+static void transcode_record(iobuf_parser& in, iobuf& out) {
+    using attr_t = model::record_attributes::type;
+    append_vint(out, adl<int32_t>{}.from(in));
+    auto attrs = ss::cpu_to_be(adl<attr_t>{}.from(in));
+    // NOLINTNEXTLINE
+    out.append(reinterpret_cast<const char*>(&attrs), sizeof(attrs));
+    append_vint(out, adl<int64_t>{}.from(in));
+    append_vint(out, adl<int32_t>{}.from(in));
+    // key and value
+    for (int i = 0; i < 2; ++i) {
+        append_vint(out, adl<int32_t>{}.from(in));
+        transcode_bytes(in, out);
+    }
+    auto headers = adl<int32_t>{}.from(in);
+    append_vint(out, headers);
+    for (int32_t i = 0; i < headers; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            append_vint(out, adl<int32_t>{}.from(in));
+            transcode_bytes(in, out);
+        }
+    }
+}
+
 model::record_batch adl<model::record_batch>::from(iobuf_parser& in) {
     auto hdr = reflection::adl<batch_header>{}.from(in);
     if (hdr.is_compressed == 1) {
         auto io = reflection::adl<iobuf>{}.from(in);
         return model::record_batch(hdr.bhdr, std::move(io));
     }
-    auto recs = std::vector<model::record>{};
-    recs.reserve(hdr.bhdr.record_count);
+    // the records are transcoded straight into the records of the batch,
+    // without building the intermediate model::record
+    iobuf records;
     for (int i = 0; i < hdr.bhdr.record_count; ++i) {
-        recs.push_back(adl<model::record>{}.from(in));
+        transcode_record(in, records);
     }
-    return model::record_batch(hdr.bhdr, std::move(recs));
+    return model::record_batch(
+      hdr.bhdr, std::move(records), model::record_batch::tag_ctor_ng{});
 }
 
 void adl<model::partition_metadata>::to(
@@ -72,6 +72,17 @@ enum class compaction_strategy : int8_t {
 std::ostream& operator<<(std::ostream&, compaction_strategy);
 std::istream& operator>>(std::istream&, compaction_strategy&);
 
+/// \brief where the log of a partition keeps its batches
+enum class storage_mode : int8_t {
+    /// \brief segment files in the data directory
+    disk,
+    /// \brief bounded memory, never written to disk. durability comes from
+    /// the replicas alone, a node restarting recovers the log from them
+    memory,
+};
+std::ostream& operator<<(std::ostream&, storage_mode);
+std::istream& operator>>(std::istream&, storage_mode&);
+
 using term_id = named_type<int64_t, struct model_raft_term_id_type>;
 
 using run_id = named_type<int64_t, struct model_raft_run_id_type>;
@@ -304,6 +304,25 @@ std::istream& operator>>(std::istream& i, compaction_strategy& cs) {
     return i;
 };
 
+std::ostream& operator<<(std::ostream& o, storage_mode m) {
+    switch (m) {
+    case storage_mode::disk:
+        return o << "disk";
+    case storage_mode::memory:
+        return o << "memory";
+    }
+    return o << "{unknown model::storage_mode}";
+}
+
+std::istream& operator>>(std::istream& i, storage_mode& m) {
+    ss::sstring s;
+    i >> s;
+    m = string_switch<storage_mode>(s)
+          .match("disk", storage_mode::disk)
+          .match("memory", storage_mode::memory);
+    return i;
+};
+
 std::istream& operator>>(std::istream& i, timestamp_type& ts_type) {
     ss::sstring s;
     i >> s;
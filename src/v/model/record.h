@@ -594,9 +594,11 @@ public:
           && _header.max_timestamp == ts) {
             return;
         }
+        auto original = _header;
         _header.attrs.set_timestamp_type(ts_type);
         _header.max_timestamp = ts;
-        _header.crc = model::crc_record_batch(*this);
+        _header.crc = model::crc_record_batch_patch(
+          original, _header, _records.size_bytes());
         _header.header_crc = model::internal_header_only_crc(_header);
     }
 
@@ -165,8 +165,15 @@ ss::future<record_batch_reader::data_t> consume_reader_to_memory(
   record_batch_reader reader, timeout_clock::time_point timeout) {
     class memory_batch_consumer {
     public:
-        ss::future<ss::stop_iteration> operator()(model::record_batch b) {
-            _result.push_back(std::move(b));
+        ss::future<ss::stop_iteration> operator()(data_t slice) {
+            if (_result.empty()) {
+                _result = std::move(slice);
+            } else {
+                _result.reserve(_result.size() + slice.size());
+                for (auto& b : slice) {
+                    _result.push_back(std::move(b));
+                }
+            }
             return ss::make_ready_future<ss::stop_iteration>(
               ss::stop_iteration::no);
         }
@@ -175,7 +182,7 @@ ss::future<record_batch_reader::data_t> consume_reader_to_memory(
     private:
         data_t _result;
     };
-    return std::move(reader).consume(memory_batch_consumer{}, timeout);
+    return std::move(reader).consume_slices(memory_batch_consumer{}, timeout);
 }
 
 std::ostream& operator<<(std::ostream& os, const record_batch_reader& r) {
@@ -25,6 +25,7 @@
 #include <seastar/util/optimized_optional.hh>
 
 #include <memory>
+#include <utility>
 #include <variant>
 
 namespace model {
@@ -42,6 +43,13 @@ concept ReferenceBatchReaderConsumer = requires(ReferenceConsumer c, record_batc
     { c(b) } -> std::same_as<ss::future<ss::stop_iteration>>;
     c.end_of_stream();
 };
+
+template<typename SliceConsumer>
+concept SliceBatchReaderConsumer = requires(
+  SliceConsumer c, ss::circular_buffer<record_batch>&& s) {
+    { c(std::move(s)) } -> std::same_as<ss::future<ss::stop_iteration>>;
+    c.end_of_stream();
+};
 )
 // clang-format on
 
@@ -99,6 +107,16 @@ public:
                   return do_consume(consumer, timeout);
               });
         }
+        template<typename SliceConsumer>
+        auto
+        consume_slices(SliceConsumer consumer, timeout_clock::time_point tm) {
+            return ss::do_with(
+              std::move(consumer), [this, tm](SliceConsumer& consumer) {
+                  return do_action(consumer, tm, [this](SliceConsumer& c) {
+                      return c(take_slice());
+                  });
+              });
+        }
 
     private:
         record_batch pop_batch() {
@@ -115,6 +133,20 @@ public:
                   return (*d.buffer)[d.index++].copy();
               });
         }
+        data_t take_slice() {
+            return ss::visit(
+              _slice,
+              [](data_t& d) { return std::exchange(d, {}); },
+              [](foreign_data_t& d) {
+                  // batches of a remote core are copied, as for pop_batch
+                  data_t slice;
+                  slice.reserve(d.buffer->size() - d.index);
+                  for (; d.index < d.buffer->size(); ++d.index) {
+                      slice.push_back((*d.buffer)[d.index].copy());
+                  }
+                  return slice;
+              });
+        }
         ss::future<> load_slice(timeout_clock::time_point timeout) {
             return do_load_slice(timeout).then([this](storage_t s) {
                 // reassign the local cache
@@ -250,6 +282,28 @@ public:
           });
     }
 
+    /// \brief Hands the batches to the consumer a whole slice at a time,
+    /// one call and one continuation per slice rather than per batch.
+    /// Stops when consumer returns stop_iteration::yes or end of stream
+    template<typename SliceConsumer>
+    CONCEPT(requires SliceBatchReaderConsumer<SliceConsumer>)
+    auto consume_slices(
+      SliceConsumer consumer, timeout_clock::time_point timeout) & {
+        return _impl->consume_slices(std::move(consumer), timeout);
+    }
+
+    /// \brief r-value version of consume_slices(), see consume()
+    template<typename SliceConsumer>
+    CONCEPT(requires SliceBatchReaderConsumer<SliceConsumer>)
+    auto consume_slices(
+      SliceConsumer consumer, timeout_clock::time_point timeout) && {
+        auto raw = _impl.get();
+        return raw->consume_slices(std::move(consumer), timeout)
+          .finally([raw, i = std::move(_impl)]() mutable {
+              return raw->finally().finally([i = std::move(i)] {});
+          });
+    }
+
     std::unique_ptr<impl> release() && { return std::move(_impl); }
 
 private:
@@ -294,8 +348,11 @@ ss::future<record_batch_reader::data_t> transform_reader_to_memory(
         explicit consumer(Func f)
           : _func(std::move(f)) {}
 
-        ss::future<ss::stop_iteration> operator()(model::record_batch b) {
-            _result.push_back(_func(std::move(b)));
+        ss::future<ss::stop_iteration> operator()(data_t slice) {
+            _result.reserve(_result.size() + slice.size());
+            for (auto& b : slice) {
+                _result.push_back(_func(std::move(b)));
+            }
             return ss::make_ready_future<ss::stop_iteration>(
               ss::stop_iteration::no);
         }
@@ -307,7 +364,8 @@ ss::future<record_batch_reader::data_t> transform_reader_to_memory(
         data_t _result;
         Func _func;
     };
-    return std::move(reader).consume(consumer(std::forward<Func>(f)), timeout);
+    return std::move(reader).consume_slices(
+      consumer(std::forward<Func>(f)), timeout);
 }
 
 record_batch_reader make_foreign_memory_record_batch_reader(record_batch);
@@ -10,9 +10,18 @@
 #include "model/record_utils.h"
 
 #include "bytes/utils.h"
+#include "hashing/crc32c_shift.h"
 #include "model/record.h"
 #include "reflection/adl.h"
 #include "utils/vint.h"
+#include "vassert.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
 
 namespace model {
 
@@ -52,20 +61,23 @@ uint32_t internal_header_only_crc(const record_batch_header& header) {
     return c.value();
 }
 
-template<typename T, typename = std::enable_if_t<std::is_integral_v<T>, T>>
-void crc_extend_cpu_to_be(crc32& crc, T i) {
-    auto j = ss::cpu_to_be(i);
-    crc.extend(j);
-}
-
 template<typename... T>
-void crc_extend_all_cpu_to_be(crc32& crc, T... t) {
-    ((crc_extend_cpu_to_be(crc, t)), ...);
+auto pack_cpu_to_be(T... t) {
+    std::array<uint8_t, (sizeof(T) + ...)> buf;
+    size_t pos = 0;
+    (
+      [&buf, &pos](auto v) {
+          auto be = ss::cpu_to_be(v);
+          std::memcpy(buf.data() + pos, &be, sizeof(be));
+          pos += sizeof(be);
+      }(t),
+      ...);
+    return buf;
 }
 
-void crc_record_batch_header(crc32& crc, const record_batch_header& header) {
-    crc_extend_all_cpu_to_be(
-      crc,
+/// the fields of the header covered by the kafka crc, as they are hashed
+static auto pack_crc_fields(const record_batch_header& header) {
+    return pack_cpu_to_be(
       header.attrs.value(),
       header.last_offset_delta,
       header.first_timestamp.value(),
@@ -76,6 +88,35 @@ void crc_record_batch_header(crc32& crc, const record_batch_header& header) {
       header.record_count);
 }
 
+void crc_record_batch_header(crc32& crc, const record_batch_header& header) {
+    // one crc call for all the fields, they are too small to be hashed apart
+    auto buf = pack_crc_fields(header);
+    crc.extend(buf.data(), buf.size());
+}
+
+int32_t crc_record_batch_patch(
+  const record_batch_header& original,
+  const record_batch_header& updated,
+  size_t records_size) {
+    auto delta = pack_crc_fields(original);
+    const auto fields = pack_crc_fields(updated);
+    for (size_t i = 0; i < delta.size(); ++i) {
+        delta[i] ^= fields[i];
+    }
+    // only the changed range is hashed, the rest contributes nothing
+    auto first = std::find_if(
+      delta.begin(), delta.end(), [](uint8_t b) { return b != 0; });
+    if (first == delta.end()) {
+        return original.crc;
+    }
+    auto last = std::find_if(delta.rbegin(), delta.rend(), [](uint8_t b) {
+                    return b != 0;
+                }).base();
+    auto tail = size_t(delta.end() - last) + records_size;
+    return int32_t(crc32c_patch(
+      uint32_t(original.crc), &*first, size_t(last - first), tail));
+}
+
 int32_t crc_record_batch(const record_batch_header& hdr, const iobuf& records) {
     auto crc = crc32();
     crc_record_batch_header(crc, hdr);
@@ -172,6 +213,44 @@ model::record parse_one_record_copy_from_buffer(iobuf_const_parser& parser) {
       });
 }
 
+record_batch_keys parse_record_batch_keys(const record_batch& b) {
+    vassert(!b.compressed(), "Can not parse the keys of a compressed batch");
+    record_batch_keys ret;
+    const auto count = static_cast<size_t>(b.record_count());
+    ret.offset_deltas.reserve(count);
+    ret.timestamp_deltas.reserve(count);
+    ret.keys.reserve(count);
+    iobuf_const_parser parser(b.data());
+    for (size_t i = 0; i < count; ++i) {
+        auto [record_size, attr] = parse_record_meta_from_buffer(parser);
+        // the record size does not include its own varint
+        const size_t record_end = parser.bytes_consumed() + record_size
+                                  - sizeof(model::record_attributes::type);
+        auto [timestamp_delta, tv] = parser.read_varlong();
+        auto [offset_delta, ov] = parser.read_varlong();
+        auto [key_length, kv] = parser.read_varlong();
+        iobuf key;
+        if (key_length > 0) {
+            key = parser.copy(key_length);
+        }
+        if (unlikely(parser.bytes_consumed() > record_end)) {
+            throw std::out_of_range(fmt::format(
+              "Record {} is longer than its size {}", i, record_size));
+        }
+        // value and headers
+        parser.skip(record_end - parser.bytes_consumed());
+        ret.timestamp_deltas.push_back(timestamp_delta);
+        ret.offset_deltas.push_back(static_cast<int32_t>(offset_delta));
+        ret.keys.push_back(std::move(key));
+    }
+    if (unlikely(parser.bytes_left())) {
+        throw std::out_of_range(fmt::format(
+          "Record key parsing stopped with {} bytes remaining",
+          parser.bytes_left()));
+    }
+    return ret;
+}
+
 static inline void append_vint_to_iobuf(iobuf& b, int64_t v) {
     auto vb = vint::to_bytes(v);
     b.append(vb.data(), vb.size());
@@ -14,6 +14,8 @@
 #include "bytes/iobuf_parser.h"
 #include "hashing/crc32c.h"
 
+#include <vector>
+
 namespace model {
 
 struct record_batch_header;
@@ -25,6 +27,12 @@ void crc_record_batch_header(crc32&, const record_batch_header&);
 /// \brief int32_t because that's what kafka uses
 int32_t crc_record_batch(const record_batch& b);
 int32_t crc_record_batch(const record_batch_header&, const iobuf&);
+/// \brief the crc of a batch once fields of its header changed, from the crc
+/// of the original header. O(1), the records are not hashed again
+int32_t crc_record_batch_patch(
+  const record_batch_header& original,
+  const record_batch_header& updated,
+  size_t records_size);
 
 /// \brief uint32_t because that's what crc32c uses
 /// it is *only* record_batch_header.header_crc;
@@ -34,4 +42,18 @@ model::record parse_one_record_from_buffer(iobuf_parser& parser);
 model::record parse_one_record_copy_from_buffer(iobuf_const_parser& parser);
 void append_record_to_buffer(iobuf& a, const model::record& r);
 
+/// \brief the offsets, timestamps and keys of the records of a batch in one
+/// array per field. parsed in a single pass that copies only the keys and
+/// skips the values and headers of the records
+struct record_batch_keys {
+    std::vector<int32_t> offset_deltas;
+    std::vector<int64_t> timestamp_deltas;
+    std::vector<iobuf> keys;
+
+    size_t size() const { return offset_deltas.size(); }
+};
+
+/// \brief requires an uncompressed batch
+record_batch_keys parse_record_batch_keys(const record_batch&);
+
 } // namespace model
@@ -0,0 +1,127 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "model/record_view.h"
+
+#include "utils/vint.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace model {
+
+std::optional<bytes_view> record_field_view::contiguous() const {
+    if (_size <= 0) {
+        return bytes_view{};
+    }
+    if (_at.segment_bytes_left() < static_cast<size_t>(_size)) {
+        return std::nullopt;
+    }
+    return bytes_view(
+      // NOLINTNEXTLINE
+      reinterpret_cast<const uint8_t*>(_at.segment_data()),
+      _size);
+}
+
+iobuf record_field_view::copy() const {
+    if (_size <= 0) {
+        return iobuf{};
+    }
+    auto in = _at;
+    return iobuf_copy(in, _size);
+}
+
+bytes record_field_view::to_bytes() const {
+    if (_size <= 0) {
+        return bytes{};
+    }
+    auto b = ss::uninitialized_string<bytes>(_size);
+    auto in = _at;
+    in.consume_to(_size, b.begin());
+    return b;
+}
+
+bool record_field_view::operator==(bytes_view other) const {
+    if (std::max(_size, 0) != static_cast<int64_t>(other.size())) {
+        return false;
+    }
+    auto in = _at;
+    size_t compared = 0;
+    bool equal = true;
+    in.consume(other.size(), [&](const char* src, size_t n) {
+        // NOLINTNEXTLINE
+        equal = std::memcmp(src, other.data() + compared, n) == 0;
+        compared += n;
+        return equal ? ss::stop_iteration::no : ss::stop_iteration::yes;
+    });
+    return equal;
+}
+
+// skips a varlong prefixed field, returns its view
+static record_field_view skip_field(iobuf_const_parser& parser) {
+    auto [size, _] = parser.read_varlong();
+    record_field_view field(parser.position(), static_cast<int32_t>(size));
+    if (size > 0) {
+        parser.skip(size);
+    }
+    return field;
+}
+
+record_view parse_record_view(iobuf_const_parser& parser) {
+    auto start = parser.position();
+    auto start_consumed = parser.bytes_consumed();
+    auto [size_bytes, sv] = parser.read_varlong();
+    auto attr = parser.consume_type<record_attributes::type>();
+    auto [timestamp_delta, tv] = parser.read_varlong();
+    auto [offset_delta, ov] = parser.read_varlong();
+    auto key = skip_field(parser);
+    auto value = skip_field(parser);
+    auto [header_count, hv] = parser.read_varlong();
+    auto headers = parser.position();
+    for (int64_t i = 0; i < header_count; ++i) {
+        skip_field(parser);
+        skip_field(parser);
+    }
+    auto encoded_size = parser.bytes_consumed() - start_consumed;
+    return record_view(
+      static_cast<int32_t>(size_bytes),
+      record_attributes(attr),
+      timestamp_delta,
+      static_cast<int32_t>(offset_delta),
+      key,
+      value,
+      static_cast<int32_t>(header_count),
+      headers,
+      record_field_view(start, static_cast<int32_t>(encoded_size)));
+}
+
+std::vector<record_header> record_view::copy_headers() const {
+    std::vector<record_header> headers;
+    headers.reserve(_header_count);
+    auto in = _headers;
+    for (int32_t i = 0; i < _header_count; ++i) {
+        auto [key_size, kv] = vint::deserialize(in);
+        in.skip(kv);
+        iobuf key;
+        if (key_size > 0) {
+            key = iobuf_copy(in, key_size);
+        }
+        auto [value_size, vv] = vint::deserialize(in);
+        in.skip(vv);
+        iobuf value;
+        if (value_size > 0) {
+            value = iobuf_copy(in, value_size);
+        }
+        headers.emplace_back(
+          key_size, std::move(key), value_size, std::move(value));
+    }
+    return headers;
+}
+
+} // namespace model
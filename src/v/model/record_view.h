@@ -0,0 +1,145 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "bytes/bytes.h"
+#include "bytes/iobuf.h"
+#include "bytes/iobuf_parser.h"
+#include "model/record.h"
+#include "seastarx.h"
+#include "vassert.h"
+
+#include <fmt/format.h>
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace model {
+
+/**
+ * Bytes of a field of an encoded record. The bytes are not owned, the view is
+ * valid as long as the batch it was parsed from is neither modified, moved
+ * nor destroyed.
+ */
+class record_field_view {
+public:
+    record_field_view(iobuf::iterator_consumer at, int32_t size) noexcept
+      : _at(at)
+      , _size(size) {}
+
+    /// \brief -1 for a null field
+    int32_t size() const { return _size; }
+    bool is_null() const { return _size < 0; }
+
+    /// \brief the field if it is contiguous in memory. most fields are,
+    /// records rarely span the fragments of a batch
+    std::optional<bytes_view> contiguous() const;
+
+    iobuf copy() const;
+    bytes to_bytes() const;
+
+    /// \brief compares the bytes of the field without copying them
+    bool operator==(bytes_view) const;
+
+private:
+    iobuf::iterator_consumer _at;
+    int32_t _size;
+};
+
+/**
+ * A record parsed from the records of a batch without copying them. Only the
+ * fixed fields are decoded, the key and the value point into the batch and
+ * the headers are skipped. Nothing is allocated, unlike model::record which
+ * copies every field into an iobuf of its own. Same validity rules as for
+ * record_field_view.
+ */
+class record_view {
+public:
+    /// \brief size of the record, without the size field
+    int32_t size_bytes() const { return _size_bytes; }
+    record_attributes attributes() const { return _attributes; }
+    int64_t timestamp_delta() const { return _timestamp_delta; }
+    int32_t offset_delta() const { return _offset_delta; }
+    const record_field_view& key() const { return _key; }
+    const record_field_view& value() const { return _value; }
+    bool has_value() const { return !_value.is_null(); }
+    int32_t header_count() const { return _header_count; }
+
+    /// \brief the whole encoded record, with its size field. appending it
+    /// to the records of a batch with the same base offset and timestamp
+    /// copies the record without decoding it
+    const record_field_view& encoded() const { return _encoded; }
+
+    /// \brief decodes the headers, they are skipped by the parsing
+    std::vector<record_header> copy_headers() const;
+
+private:
+    record_view(
+      int32_t size_bytes,
+      record_attributes attributes,
+      int64_t timestamp_delta,
+      int32_t offset_delta,
+      record_field_view key,
+      record_field_view value,
+      int32_t header_count,
+      iobuf::iterator_consumer headers,
+      record_field_view encoded) noexcept
+      : _size_bytes(size_bytes)
+      , _attributes(attributes)
+      , _timestamp_delta(timestamp_delta)
+      , _offset_delta(offset_delta)
+      , _key(key)
+      , _value(value)
+      , _header_count(header_count)
+      , _headers(headers)
+      , _encoded(encoded) {}
+
+    int32_t _size_bytes;
+    record_attributes _attributes;
+    int64_t _timestamp_delta;
+    int32_t _offset_delta;
+    record_field_view _key;
+    record_field_view _value;
+    int32_t _header_count;
+    // first header
+    iobuf::iterator_consumer _headers;
+    record_field_view _encoded;
+
+    friend record_view parse_record_view(iobuf_const_parser&);
+};
+
+/// \brief parses the record at the position of the parser and moves past it
+record_view parse_record_view(iobuf_const_parser&);
+
+/**
+ * Iterates over the records of an uncompressed batch without materializing
+ * them, see record_view.
+ */
+template<typename Func>
+void for_each_record_view(const record_batch& batch, Func f) {
+    vassert(
+      !batch.compressed(),
+      "Record iteration is not supported for compressed batches.");
+    iobuf_const_parser parser(batch.data());
+    for (auto i = 0; i < batch.record_count(); i++) {
+        f(parse_record_view(parser));
+    }
+    if (unlikely(parser.bytes_left())) {
+        throw std::out_of_range(fmt::format(
+          "Record iteration stopped with {} bytes remaining",
+          parser.bytes_left()));
+    }
+}
+
+} // namespace model
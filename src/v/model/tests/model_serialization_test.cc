@@ -10,7 +10,11 @@
 #include "model/adl_serde.h"
 #include "model/fundamental.h"
 #include "model/metadata.h"
+#include "random/generators.h"
+#include "storage/record_batch_builder.h"
+#include "storage/tests/utils/random_batch.h"
 #include "test_utils/rpc.h"
+#include "units.h"
 
 #include <seastar/testing/thread_test_case.hh>
 
@@ -69,3 +73,32 @@ SEASTAR_THREAD_TEST_CASE(tristate_rt_test) {
     BOOST_REQUIRE_EQUAL(r_empty.has_value(), false);
     BOOST_REQUIRE_EQUAL(r_present.value(), 1024);
 }
+
+static iobuf make_bytes(size_t n) {
+    iobuf b;
+    auto str = random_generators::gen_alphanum_string(n);
+    b.append(str.data(), str.size());
+    return b;
+}
+
+SEASTAR_THREAD_TEST_CASE(record_batch_rt_test) {
+    storage::record_batch_builder builder(
+      model::record_batch_type(1), model::offset(10));
+    builder.add_raw_kv(make_bytes(10), make_bytes(100));
+    builder.add_raw_kv(iobuf(), std::nullopt);
+    // shared from the parsed buffer rather than copied
+    std::vector<model::record_header> headers;
+    constexpr size_t large = 32_KiB;
+    headers.emplace_back(5, make_bytes(5), int32_t(large), make_bytes(large));
+    builder.add_raw_kw(make_bytes(20), make_bytes(64_KiB), std::move(headers));
+    auto batch = std::move(builder).build();
+
+    auto r = serialize_roundtrip_rpc(batch.copy());
+    BOOST_REQUIRE_EQUAL(r, batch);
+    BOOST_REQUIRE_EQUAL(r.copy_records().size(), 3);
+
+    for (auto& b : storage::test::make_random_batches(model::offset(0), 20)) {
+        auto r = serialize_roundtrip_rpc(b.copy());
+        BOOST_REQUIRE_EQUAL(r, b);
+    }
+}
@@ -14,6 +14,7 @@
 #include <seastar/core/thread.hh>
 #include <seastar/testing/thread_test_case.hh>
 
+#include <utility>
 #include <vector>
 
 using namespace model; // NOLINT
@@ -170,3 +171,79 @@ SEASTAR_THREAD_TEST_CASE(record_batch_sharing) {
         BOOST_CHECK(v1[i] == v2[i]);
     }
 }
+
+class slice_consumer {
+public:
+    explicit slice_consumer(size_t max_slices)
+      : _max_slices(max_slices) {}
+
+    ss::future<ss::stop_iteration>
+    operator()(ss::circular_buffer<record_batch>&& slice) {
+        ++_slices;
+        for (auto& b : slice) {
+            _result.push_back(std::move(b));
+        }
+        return ss::make_ready_future<ss::stop_iteration>(
+          _slices == _max_slices ? ss::stop_iteration::yes
+                                 : ss::stop_iteration::no);
+    }
+
+    std::pair<size_t, ss::circular_buffer<record_batch>> end_of_stream() {
+        return {_slices, std::move(_result)};
+    }
+
+private:
+    size_t _max_slices;
+    size_t _slices{0};
+    ss::circular_buffer<record_batch> _result;
+};
+
+record_batch_reader make_two_slices_reader() {
+    std::vector<record_batch_reader::data_t> slices;
+    slices.push_back(make_batches(offset(1), offset(2), offset(3)));
+    slices.push_back(make_batches(offset(4), offset(5)));
+    return make_generating_record_batch_reader(
+      [slices = std::move(slices), i = size_t(0)]() mutable {
+          record_batch_reader::data_t d;
+          if (i < slices.size()) {
+              d = std::move(slices[i++]);
+          }
+          return ss::make_ready_future<record_batch_reader::data_t>(
+            std::move(d));
+      });
+}
+
+SEASTAR_THREAD_TEST_CASE(test_consume_slices) {
+    auto [slices, batches] = make_two_slices_reader()
+                               .consume_slices(slice_consumer(10), no_timeout)
+                               .get0();
+    BOOST_CHECK_EQUAL(slices, 2);
+    BOOST_REQUIRE_EQUAL(batches.size(), 5);
+    auto o = offset(1);
+    for (auto& batch : batches) {
+        BOOST_CHECK_EQUAL(batch.base_offset(), o);
+        o += 1;
+    }
+}
+
+SEASTAR_THREAD_TEST_CASE(test_interrupt_consume_slices) {
+    auto reader = make_two_slices_reader();
+    auto [slices, batches]
+      = reader.consume_slices(slice_consumer(1), no_timeout).get0();
+    BOOST_CHECK_EQUAL(slices, 1);
+    BOOST_REQUIRE_EQUAL(batches.size(), 3);
+
+    // the next call continues with the next slice
+    auto next = reader.consume(consumer(10), no_timeout).get0();
+    BOOST_REQUIRE_EQUAL(next.size(), 2);
+    BOOST_CHECK_EQUAL(next.front().base_offset(), offset(4));
+}
+
+SEASTAR_THREAD_TEST_CASE(test_consume_foreign_slices) {
+    auto reader = make_foreign_memory_record_batch_reader(
+      make_batches(offset(1), offset(2), offset(3)));
+    auto [slices, batches]
+      = std::move(reader).consume_slices(slice_consumer(10), no_timeout).get0();
+    BOOST_CHECK_EQUAL(slices, 1);
+    BOOST_CHECK_EQUAL(batches.size(), 3);
+}
@@ -70,6 +70,8 @@ SEASTAR_THREAD_TEST_CASE(set_max_timestamp) {
       model::timestamp(batch.header().max_timestamp() + 1));
     BOOST_TEST(crc != batch.header().crc);
     BOOST_TEST(hdr_crc != batch.header().header_crc);
+    // the patched crc is the crc of the whole batch
+    BOOST_TEST(batch.header().crc == model::crc_record_batch(batch));
 
     // same ts produces orig crcs
     batch.set_max_timestamp(
@@ -78,3 +80,17 @@ SEASTAR_THREAD_TEST_CASE(set_max_timestamp) {
     BOOST_TEST(crc == batch.header().crc);
     BOOST_TEST(hdr_crc == batch.header().header_crc);
 }
+
+SEASTAR_THREAD_TEST_CASE(parse_record_batch_keys_matches_records) {
+    auto batch = storage::test::make_random_batch(model::offset(10), 50, false);
+    auto keys = model::parse_record_batch_keys(batch);
+    auto records = batch.copy_records();
+
+    BOOST_REQUIRE_EQUAL(keys.size(), records.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(keys.offset_deltas[i], records[i].offset_delta());
+        BOOST_REQUIRE_EQUAL(
+          keys.timestamp_deltas[i], records[i].timestamp_delta());
+        BOOST_REQUIRE_EQUAL(keys.keys[i], records[i].key());
+    }
+}
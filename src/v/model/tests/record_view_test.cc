@@ -0,0 +1,72 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "bytes/bytes.h"
+#include "model/record.h"
+#include "model/record_view.h"
+#include "storage/tests/utils/random_batch.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+#include <boost/test/tools/old/interface.hpp>
+
+#include <vector>
+
+using namespace storage::test; // NOLINT
+
+SEASTAR_THREAD_TEST_CASE(record_view_matches_record) {
+    for (auto& batch : make_random_batches(model::offset(0), 10, false)) {
+        auto records = batch.copy_records();
+        std::vector<model::record_view> views;
+        model::for_each_record_view(
+          batch, [&views](model::record_view r) { views.push_back(r); });
+        BOOST_REQUIRE_EQUAL(views.size(), records.size());
+        for (size_t i = 0; i < views.size(); ++i) {
+            const auto& r = records[i];
+            const auto& v = views[i];
+            BOOST_REQUIRE_EQUAL(v.size_bytes(), r.size_bytes());
+            BOOST_REQUIRE_EQUAL(v.attributes(), r.attributes());
+            BOOST_REQUIRE_EQUAL(v.timestamp_delta(), r.timestamp_delta());
+            BOOST_REQUIRE_EQUAL(v.offset_delta(), r.offset_delta());
+            BOOST_REQUIRE_EQUAL(v.has_value(), r.has_value());
+            BOOST_REQUIRE_EQUAL(v.key().size(), r.key_size());
+            BOOST_REQUIRE_EQUAL(v.value().size(), r.value_size());
+            BOOST_REQUIRE(v.key() == iobuf_to_bytes(r.key()));
+            BOOST_REQUIRE(v.key().to_bytes() == iobuf_to_bytes(r.key()));
+            BOOST_REQUIRE(v.value().copy() == r.value());
+            BOOST_REQUIRE_EQUAL(
+              v.header_count(), static_cast<int32_t>(r.headers().size()));
+            BOOST_REQUIRE(v.copy_headers() == r.headers());
+        }
+    }
+}
+
+SEASTAR_THREAD_TEST_CASE(record_view_encoded_copy) {
+    auto batch = make_random_batch(model::offset(0), 20, false);
+    iobuf records;
+    model::for_each_record_view(batch, [&records](model::record_view r) {
+        records.append(r.encoded().copy());
+    });
+    BOOST_REQUIRE(records == batch.data());
+}
+
+SEASTAR_THREAD_TEST_CASE(record_field_view_compare) {
+    auto batch = make_random_batch(model::offset(0), 1, false);
+    auto record = batch.copy_records().front();
+    model::for_each_record_view(batch, [&record](model::record_view r) {
+        auto key = iobuf_to_bytes(record.key());
+        BOOST_REQUIRE(r.key() == key);
+        if (!key.empty()) {
+            BOOST_REQUIRE(
+              !(r.key() == bytes_view(key).substr(0, key.size() - 1)));
+            key[key.size() - 1] ^= 0xff;
+            BOOST_REQUIRE(!(r.key() == key));
+        }
+    });
+}
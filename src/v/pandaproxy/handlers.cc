@@ -32,6 +32,7 @@
 #include "pandaproxy/parsing/httpd.h"
 #include "pandaproxy/reply.h"
 #include "raft/types.h"
+#include "random/generators.h"
 #include "ssx/future-util.h"
 #include "ssx/sformat.h"
 #include "storage/record_batch_builder.h"
@@ -112,6 +113,27 @@ get_topics_names(server::request_t rq, server::reply_t rp) {
       });
 }
 
+/// Stream the records of a fetch as chunks, a record batch at a time, rather
+/// than building the whole body before sending it
+static void write_records(
+  ss::httpd::reply& rep,
+  ppj::serialization_format fmt,
+  kafka::fetch_response res) {
+    // the status can't change once the body is streaming
+    ppj::check_fetch_errors(res);
+    rep.write_body(
+      "json",
+      [fmt, res{std::move(res)}](ss::output_stream<char>&& os) mutable {
+          return ss::do_with(
+            std::move(os),
+            std::move(res),
+            [fmt](ss::output_stream<char>& os, kafka::fetch_response& res) {
+                return ppj::rjson_serialize_stream(fmt, std::move(res), os)
+                  .finally([&os] { return os.close(); });
+            });
+      });
+}
+
 ss::future<server::reply_t>
 get_topics_records(server::request_t rq, server::reply_t rp) {
     parse::content_type_header(*rq.req, {json::serialization_format::json_v2});
@@ -130,14 +152,7 @@ get_topics_records(server::request_t rq, server::reply_t rp) {
     return rq.ctx.client
       .fetch_partition(std::move(tp), offset, max_bytes, timeout)
       .then([res_fmt, rp = std::move(rp)](kafka::fetch_response res) mutable {
-          rapidjson::StringBuffer str_buf;
-          rapidjson::Writer<rapidjson::StringBuffer> w(str_buf);
-
-          ppj::rjson_serialize_fmt(res_fmt)(w, std::move(res));
-
-          // TODO Ben: Prevent this linearization
-          ss::sstring json_rslt = str_buf.GetString();
-          rp.rep->write_body("json", json_rslt);
+          write_records(*rp.rep, res_fmt, std::move(res));
           rp.mime_type = res_fmt;
           return std::move(rp);
       });
@@ -151,15 +166,31 @@ post_topics_name(server::request_t rq, server::reply_t rp) {
       *rq.req,
       {json::serialization_format::json_v2, json::serialization_format::none});
 
-    auto raw_records = ppj::rjson_parse(
-      rq.req->content.data(), ppj::produce_request_handler(req_fmt));
+    // The keys and values are decoded straight out of the request body
+    auto raw_records = co_await ppj::rjson_parse_insitu_async(
+      rq.req->content.data(),
+      rq.req->content.size(),
+      ppj::produce_request_handler(req_fmt));
+
+    auto topic = parse::request_param<model::topic>(*rq.req, "topic_name");
+    std::optional<int32_t> partition_count;
+    auto& partitioner = rq.ctx.client.partitioner();
 
     absl::flat_hash_map<model::partition_id, storage::record_batch_builder>
       partition_builders;
 
     for (auto& r : raw_records) {
+        if (!r.id) {
+            if (!partition_count) {
+                partition_count = co_await rq.ctx.client.partition_count(
+                  topic);
+            }
+            const auto size = (r.key ? r.key->size_bytes() : 0)
+                              + (r.value ? r.value->size_bytes() : 0);
+            r.id = partitioner(topic, r.key, *partition_count, size);
+        }
         auto it = partition_builders
-                    .try_emplace(r.id, raft::data_batch_type, model::offset(0))
+                    .try_emplace(*r.id, raft::data_batch_type, model::offset(0))
                     .first;
         it->second.add_raw_kv(
           std::move(r.key).value_or(iobuf{}),
@@ -178,29 +209,25 @@ post_topics_name(server::request_t rq, server::reply_t rp) {
             .batch = std::move(pb.second).build()}});
     }
 
-    auto topic = parse::request_param<model::topic>(*rq.req, "topic_name");
-    return ssx::parallel_transform(
-             std::move(partitions),
-             [topic,
-              rq{std::move(rq)}](kafka::produce_request::partition p) mutable {
-                 return rq.ctx.client.produce_record_batch(
-                   model::topic_partition(topic, p.id),
-                   std::move(*p.adapter.batch));
-             })
-      .then([topic, res_fmt, rp{std::move(rp)}](auto responses) mutable {
-          std::vector<kafka::produce_response::topic> topics;
-          topics.push_back(kafka::produce_response::topic{
-            .name{std::move(topic)}, .partitions{std::move(responses)}});
+    auto responses = co_await ssx::parallel_transform(
+      std::move(partitions),
+      [topic, &rq](kafka::produce_request::partition p) {
+          return rq.ctx.client.produce_record_batch(
+            model::topic_partition(topic, p.id),
+            std::move(*p.adapter.batch));
+      });
 
-          auto res = kafka::produce_response{
-            .topics{std::move(topics)},
-            .throttle{std::chrono::milliseconds{0}}};
+    std::vector<kafka::produce_response::topic> topics;
+    topics.push_back(kafka::produce_response::topic{
+      .name{std::move(topic)}, .partitions{std::move(responses)}});
 
-          auto json_rslt = ppj::rjson_serialize(res.topics[0]);
-          rp.rep->write_body("json", json_rslt);
-          rp.mime_type = res_fmt;
-          return std::move(rp);
-      });
+    auto res = kafka::produce_response{
+      .topics{std::move(topics)}, .throttle{std::chrono::milliseconds{0}}};
+
+    auto json_rslt = ppj::rjson_serialize(res.topics[0]);
+    rp.rep->write_body("json", json_rslt);
+    rp.mime_type = res_fmt;
+    co_return std::move(rp);
 }
 
 static ss::sstring make_consumer_uri(
@@ -230,18 +257,22 @@ create_consumer(server::request_t rq, server::reply_t rp) {
     auto req_data = ppj::rjson_parse(
       rq.req->content.data(), ppj::create_consumer_request_handler());
 
-    return rq.ctx.client.create_consumer(group_id).then(
-      [group_id, res_fmt, rq{std::move(rq)}, rp{std::move(rp)}](
-        kafka::member_id m_id) mutable {
-          auto adv_addr = rq.ctx.config.advertised_pandaproxy_api();
-          json::create_consumer_response res{
-            .instance_id = m_id,
-            .base_uri = make_consumer_uri(rq, m_id, group_id)};
-          auto json_rslt = ppj::rjson_serialize(res);
-          rp.rep->write_body("json", json_rslt);
-          rp.mime_type = res_fmt;
-          return std::move(rp);
+    // instances without a name are spread at random
+    auto name = req_data.name ? *req_data.name
+                              : random_generators::gen_alphanum_string(16);
+    auto shard = consumer_shard(group_id, name);
+    auto m_id = co_await invoke_on_shard(
+      rq.ctx, shard, [group_id](server::context_t& ctx) {
+          return ctx.client.create_consumer(group_id);
       });
+    co_await add_consumer_shard(rq.ctx, group_id, m_id, shard);
+
+    json::create_consumer_response res{
+      .instance_id = m_id, .base_uri = make_consumer_uri(rq, m_id, group_id)};
+    auto json_rslt = ppj::rjson_serialize(res);
+    rp.rep->write_body("json", json_rslt);
+    rp.mime_type = res_fmt;
+    co_return std::move(rp);
 }
 
 ss::future<server::reply_t>
@@ -256,7 +287,16 @@ remove_consumer(server::request_t rq, server::reply_t rp) {
     auto member_id = parse::request_param<kafka::member_id>(
       *rq.req, "instance");
 
-    co_await rq.ctx.client.remove_consumer(group_id, member_id);
+    auto shard = consumer_shard(rq.ctx, group_id, member_id);
+    co_await invoke_on_shard(
+      rq.ctx,
+      shard,
+      [group_id, member_id](server::context_t& ctx) {
+          return ctx.client.remove_consumer(group_id, member_id);
+      })
+      .finally([&rq, group_id, member_id]() {
+          return remove_consumer_shard(rq.ctx, group_id, member_id);
+      });
     rp.rep->set_status(ss::httpd::reply::status_type::no_content);
     co_return rp;
 }
@@ -276,8 +316,15 @@ subscribe_consumer(server::request_t rq, server::reply_t rp) {
     auto req_data = ppj::rjson_parse(
       rq.req->content.data(), ppj::subscribe_consumer_request_handler());
 
-    return rq.ctx.client
-      .subscribe_consumer(group_id, member_id, std::move(req_data.topics))
+    auto shard = consumer_shard(rq.ctx, group_id, member_id);
+    return invoke_on_shard(
+             rq.ctx,
+             shard,
+             [group_id, member_id, topics{std::move(req_data.topics)}](
+               server::context_t& ctx) mutable {
+                 return ctx.client.subscribe_consumer(
+                   group_id, member_id, std::move(topics));
+             })
       .then([res_fmt, rp{std::move(rp)}]() mutable {
           rp.mime_type = res_fmt;
           return std::move(rp);
@@ -300,16 +347,34 @@ consumer_fetch(server::request_t rq, server::reply_t rp) {
     auto group_id = kafka::group_id(rq.req->param["group_name"]);
     auto member_id = kafka::member_id(rq.req->param["instance"]);
 
-    return rq.ctx.client.consumer_fetch(group_id, member_id, timeout, max_bytes)
-      .then([fmt, rp{std::move(rp)}](kafka::fetch_response res) mutable {
-          rapidjson::StringBuffer str_buf;
-          rapidjson::Writer<rapidjson::StringBuffer> w(str_buf);
-
-          ppj::rjson_serialize_fmt(fmt)(w, std::move(res));
+    auto shard = consumer_shard(rq.ctx, group_id, member_id);
+    if (shard == ss::this_shard_id()) {
+        return rq.ctx.client
+          .consumer_fetch(group_id, member_id, timeout, max_bytes)
+          .then([fmt, rp{std::move(rp)}](kafka::fetch_response res) mutable {
+              write_records(*rp.rep, fmt, std::move(res));
+              return std::move(rp);
+          });
+    }
 
-          // TODO Ben: Prevent this linearization
-          ss::sstring json_rslt = str_buf.GetString();
-          rp.rep->write_body("json", json_rslt);
+    // The records of another shard are serialized there, the buffers they
+    // are read into can't be released from this shard
+    return invoke_on_shard(
+             rq.ctx,
+             shard,
+             [fmt, group_id, member_id, timeout, max_bytes](
+               server::context_t& ctx) {
+                 return ctx.client
+                   .consumer_fetch(group_id, member_id, timeout, max_bytes)
+                   .then([fmt](kafka::fetch_response res) {
+                       rapidjson::StringBuffer str_buf;
+                       rapidjson::Writer<rapidjson::StringBuffer> w(str_buf);
+                       ppj::rjson_serialize_fmt(fmt)(w, std::move(res));
+                       return ppj::take_string(str_buf);
+                   });
+             })
+      .then([rp{std::move(rp)}](ss::sstring json_rslt) mutable {
+          rp.rep->write_body("json", std::move(json_rslt));
           return std::move(rp);
       });
 }
@@ -322,8 +387,15 @@ get_consumer_offsets(server::request_t rq, server::reply_t rp) {
     auto req_data = ppj::partitions_request_to_offset_request(ppj::rjson_parse(
       rq.req->content.data(), ppj::partitions_request_handler()));
 
-    auto res = co_await rq.ctx.client.consumer_offset_fetch(
-      group_id, member_id, std::move(req_data));
+    auto shard = consumer_shard(rq.ctx, group_id, member_id);
+    auto res = co_await invoke_on_shard(
+      rq.ctx,
+      shard,
+      [group_id, member_id, req_data{std::move(req_data)}](
+        server::context_t& ctx) mutable {
+          return ctx.client.consumer_offset_fetch(
+            group_id, member_id, std::move(req_data));
+      });
     rapidjson::StringBuffer str_buf;
     rapidjson::Writer<rapidjson::StringBuffer> w(str_buf);
     ppj::rjson_serialize(w, res);
@@ -345,8 +417,15 @@ post_consumer_offsets(server::request_t rq, server::reply_t rp) {
                           rq.req->content.data(),
                           ppj::partition_offsets_request_handler()));
 
-    auto res = co_await rq.ctx.client.consumer_offset_commit(
-      group_id, member_id, std::move(req_data));
+    auto shard = consumer_shard(rq.ctx, group_id, member_id);
+    auto res = co_await invoke_on_shard(
+      rq.ctx,
+      shard,
+      [group_id, member_id, req_data{std::move(req_data)}](
+        server::context_t& ctx) mutable {
+          return ctx.client.consumer_offset_commit(
+            group_id, member_id, std::move(req_data));
+      });
     rp.rep->set_status(ss::httpd::reply::status_type::no_content);
     co_return rp;
 }
@@ -45,8 +45,7 @@ public:
     inline std::pair<bool, std::optional<iobuf>>
     decode_base64(std::string_view v) {
         try {
-            auto decoded = base64_to_bytes(v);
-            return {true, bytes_to_iobuf(decoded)};
+            return {true, base64_to_iobuf(v)};
         } catch (const base64_decoder_exception&) {
             return {false, std::nullopt};
         }
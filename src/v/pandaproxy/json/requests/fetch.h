@@ -26,6 +26,8 @@
 #include "pandaproxy/json/types.h"
 #include "seastarx.h"
 
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/iostream.hh>
 #include <seastar/core/sstring.hh>
 
 #include <rapidjson/reader.h>
@@ -67,6 +69,15 @@ private:
     model::offset _base_offset;
 };
 
+/// \brief Throw the first error of the partitions of a fetch response.
+inline void check_fetch_errors(kafka::fetch_response& res) {
+    for (auto& v : res) {
+        if (v.partition_response->has_error()) {
+            throw serialize_error(v.partition_response->error);
+        }
+    }
+}
+
 template<>
 class rjson_serialize_impl<kafka::fetch_response> {
 public:
@@ -77,11 +88,7 @@ public:
       rapidjson::Writer<rapidjson::StringBuffer>& w,
       kafka::fetch_response&& res) {
         // Eager check for errors
-        for (auto& v : res) {
-            if (v.partition_response->has_error()) {
-                throw serialize_error(v.partition_response->error);
-            }
-        }
+        check_fetch_errors(res);
 
         w.StartArray();
         for (auto& v : res) {
@@ -105,4 +112,37 @@ private:
     serialization_format _fmt;
 };
 
+/// \brief Write the records of a fetch response to \p os, a batch at a time.
+///
+/// The reply has started, so errors have to be checked beforehand with
+/// check_fetch_errors.
+inline ss::future<> rjson_serialize_stream(
+  serialization_format fmt,
+  kafka::fetch_response res,
+  ss::output_stream<char>& os) {
+    rapidjson::StringBuffer str_buf;
+    rapidjson::Writer<rapidjson::StringBuffer> w(str_buf);
+    auto flush = [&str_buf, &os]() {
+        auto f = os.write(str_buf.GetString(), str_buf.GetSize());
+        return f.then([&str_buf] { str_buf.Clear(); });
+    };
+
+    w.StartArray();
+    for (auto& v : res) {
+        auto r = std::move(*v.partition_response);
+        model::topic_partition_view tpv(v.partition->name, r.id);
+        while (r.record_set && !r.record_set->empty()) {
+            auto adapter = r.record_set->consume_batch();
+            auto rjs = rjson_serialize_impl<model::record>(
+              fmt, tpv, adapter.batch->base_offset());
+
+            adapter.batch->for_each_record(
+              [&rjs, &w](model::record record) { rjs(w, std::move(record)); });
+            co_await flush();
+        }
+    }
+    w.EndArray();
+    co_await flush();
+}
+
 } // namespace pandaproxy::json
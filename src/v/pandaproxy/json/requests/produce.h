@@ -24,10 +24,13 @@
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
+#include <optional>
+
 namespace pandaproxy::json {
 
 struct record {
-    model::partition_id id;
+    /// the producer picks the partition when the request does not
+    std::optional<model::partition_id> id;
     std::optional<iobuf> key;
     std::optional<iobuf> value;
 };
@@ -98,3 +98,28 @@ SEASTAR_THREAD_TEST_CASE(test_produce_fetch_one) {
 
     BOOST_REQUIRE_EQUAL(str_buf.GetString(), expected);
 }
+
+SEASTAR_THREAD_TEST_CASE(test_produce_fetch_stream) {
+    std::vector<model::topic_partition> tps = {
+      {model::topic{"topic1"}, model::partition_id{1}},
+      {model::topic{"topic2"}, model::partition_id{2}},
+    };
+    auto fmt = ppj::serialization_format::binary_v2;
+
+    rapidjson::StringBuffer str_buf;
+    rapidjson::Writer<rapidjson::StringBuffer> w(str_buf);
+    ppj::rjson_serialize_fmt(fmt)(
+      w, make_fetch_response(tps, model::offset{42}, 3));
+
+    // the streamed body is the same as the buffered one
+    iobuf body;
+    auto os = make_iobuf_ref_output_stream(body);
+    ppj::rjson_serialize_stream(
+      fmt, make_fetch_response(tps, model::offset{42}, 3), os)
+      .get();
+    os.close().get();
+
+    iobuf_parser p(std::move(body));
+    BOOST_REQUIRE_EQUAL(
+      p.read_string(p.bytes_left()), ss::sstring(str_buf.GetString()));
+}
@@ -45,12 +45,36 @@ SEASTAR_THREAD_TEST_CASE(test_produce_request) {
     auto parser = iobuf_parser(std::move(*records[0].value));
     auto value = parser.read_string(parser.bytes_left());
     BOOST_TEST(value == "vectorized");
-    BOOST_TEST(records[0].id == model::partition_id(0));
+    BOOST_TEST(records[0].id.value() == model::partition_id(0));
 
     parser = iobuf_parser(std::move(*records[1].value));
     value = parser.read_string(parser.bytes_left());
     BOOST_TEST(value == "pandaproxy");
-    BOOST_TEST(records[1].id == model::partition_id(1));
+    BOOST_TEST(records[1].id.value() == model::partition_id(1));
+}
+
+SEASTAR_THREAD_TEST_CASE(test_produce_request_insitu) {
+    ss::sstring input = R"(
+      {
+        "records": [
+          {
+            "key": "a2V5",
+            "value": "dmVjdG9yaXplZA==",
+            "partition": 2
+          }
+        ]
+      })";
+
+    auto records = ppj::rjson_parse_insitu(
+      input.data(), make_binary_v2_handler());
+    BOOST_REQUIRE_EQUAL(records.size(), 1);
+    BOOST_TEST(records[0].id.value() == model::partition_id(2));
+    BOOST_REQUIRE(records[0].key && records[0].value);
+
+    auto parser = iobuf_parser(std::move(*records[0].key));
+    BOOST_TEST(parser.read_string(parser.bytes_left()) == "key");
+    parser = iobuf_parser(std::move(*records[0].value));
+    BOOST_TEST(parser.read_string(parser.bytes_left()) == "vectorized");
 }
 
 SEASTAR_THREAD_TEST_CASE(test_produce_request_empty) {
@@ -195,6 +219,22 @@ SEASTAR_THREAD_TEST_CASE(test_produce_request_error_no_records) {
       });
 }
 
+SEASTAR_THREAD_TEST_CASE(test_produce_request_without_partition) {
+    auto input = R"(
+      {
+        "records": [
+          {
+            "value": "dmVjdG9yaXplZA=="
+          }
+        ]
+      })";
+
+    auto records = ppj::rjson_parse(input, make_binary_v2_handler());
+    BOOST_REQUIRE_EQUAL(records.size(), 1);
+    BOOST_TEST(!records[0].id);
+    BOOST_TEST(!!records[0].value);
+}
+
 SEASTAR_THREAD_TEST_CASE(test_produce_response) {
     auto expected
       = R"({"offsets":[{"partition":0,"offset":42},{"partition":1,"error_code":37,"offset":-1}]})";
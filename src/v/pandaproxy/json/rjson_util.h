@@ -11,10 +11,13 @@
 
 #pragma once
 
+#include "json/parse.h"
 #include "pandaproxy/json/exceptions.h"
 #include "pandaproxy/json/types.h"
 #include "utils/concepts-enabled.h"
 
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/future.hh>
 #include <seastar/core/sstring.hh>
 
 #include <rapidjson/reader.h>
@@ -59,6 +62,11 @@ inline rjson_serialize_fmt_impl rjson_serialize_fmt(serialization_format fmt) {
     return rjson_serialize_fmt_impl{fmt};
 }
 
+/// Copy the serialized document once, without searching for its end
+inline ss::sstring take_string(const rapidjson::StringBuffer& buf) {
+    return ss::sstring(buf.GetString(), buf.GetSize());
+}
+
 template<typename Handler>
 CONCEPT(requires std::is_same_v<
         decltype(std::declval<Handler>().result),
@@ -73,4 +81,36 @@ typename Handler::rjson_parse_result
     return std::move(handler.result);
 }
 
+/// Parse \p s in place, strings are handed to \p handler as views of \p s
+/// rather than copies. \p s is modified and must be null terminated.
+template<typename Handler>
+CONCEPT(requires std::is_same_v<
+        decltype(std::declval<Handler>().result),
+        typename Handler::rjson_parse_result>)
+typename Handler::rjson_parse_result
+  rjson_parse_insitu(char* const s, Handler&& handler) {
+    rapidjson::Reader reader;
+    rapidjson::InsituStringStream ss(s);
+    if (!reader.Parse<rapidjson::kParseInsituFlag>(ss, handler)) {
+        throw parse_error(reader.GetErrorOffset());
+    }
+    return std::move(handler.result);
+}
+
+/// As rjson_parse_insitu, large documents are parsed without stalling the
+/// reactor, see json::parse_insitu. \p s of \p size bytes must outlive the
+/// returned future.
+template<typename Handler>
+CONCEPT(requires std::is_same_v<
+        decltype(std::declval<Handler>().result),
+        typename Handler::rjson_parse_result>)
+ss::future<typename Handler::rjson_parse_result> rjson_parse_insitu_async(
+  char* const s, size_t size, Handler handler) {
+    auto res = co_await ::json::parse_insitu(s, size, handler);
+    if (res.IsError()) {
+        throw parse_error(res.Offset());
+    }
+    co_return std::move(handler.result);
+}
+
 } // namespace pandaproxy::json
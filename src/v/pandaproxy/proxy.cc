@@ -22,6 +22,7 @@
 #include "pandaproxy/handlers.h"
 #include "pandaproxy/logger.h"
 
+#include <seastar/core/coroutine.hh>
 #include <seastar/core/future-util.hh>
 #include <seastar/core/memory.hh>
 #include <seastar/http/api_docs.hh>
@@ -98,18 +99,21 @@ proxy::proxy(const YAML::Node& config, const YAML::Node& client_config)
       make_context(_config, _client)) {}
 
 ss::future<> proxy::start() {
-    return seastar::when_all_succeed(
-             [this]() {
-                 _server.route(get_proxy_routes());
-                 return _server.start();
-             },
-             [this]() {
-                 return _client.connect().handle_exception_type(
-                   [](const kafka::client::broker_error& e) {
-                       vlog(plog.debug, "Failed to connect to broker: {}", e);
-                   });
-             })
-      .discard_result();
+    // the requests for a consumer instance are routed to the shard owning it
+    auto shards = co_await container().map(
+      [](proxy& p) { return &p._server.context(); });
+    _server.set_shards(std::move(shards));
+    co_await seastar::when_all_succeed(
+      [this]() {
+          _server.route(get_proxy_routes());
+          return _server.start();
+      },
+      [this]() {
+          return _client.connect().handle_exception_type(
+            [](const kafka::client::broker_error& e) {
+                vlog(plog.debug, "Failed to connect to broker: {}", e);
+            });
+      });
 }
 
 ss::future<> proxy::stop() {
@@ -122,4 +126,8 @@ kafka::client::configuration& proxy::client_config() {
     return _client.config();
 }
 
+void proxy::set_local_broker(kafka::client::local_broker local) {
+    _client.set_local_broker(std::move(local));
+}
+
 } // namespace pandaproxy
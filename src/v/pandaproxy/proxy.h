@@ -17,13 +17,14 @@
 #include "seastarx.h"
 
 #include <seastar/core/future.hh>
+#include <seastar/core/sharded.hh>
 #include <seastar/net/socket_defs.hh>
 
 #include <vector>
 
 namespace pandaproxy {
 
-class proxy {
+class proxy : public ss::peering_sharded_service<proxy> {
 public:
     proxy(const YAML::Node& config, const YAML::Node& client_config);
 
@@ -33,6 +34,9 @@ public:
     configuration& config();
     kafka::client::configuration& client_config();
 
+    /// Requests to the broker of this process skip the connection
+    void set_local_broker(kafka::client::local_broker local);
+
 private:
     configuration _config;
     kafka::client::client _client;
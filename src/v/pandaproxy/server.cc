@@ -10,6 +10,8 @@
 #include "pandaproxy/server.h"
 
 #include "cluster/cluster_utils.h"
+#include "hashing/jump_consistent_hash.h"
+#include "hashing/xx.h"
 #include "model/metadata.h"
 #include "pandaproxy/configuration.h"
 #include "pandaproxy/json/types.h"
@@ -206,10 +208,61 @@ ss::future<> server::start() {
     co_return;
 }
 
+void server::set_shards(std::vector<context_t*> shards) {
+    _ctx.shards = std::move(shards);
+}
+
 ss::future<> server::stop() {
     return _pending_reqs.close()
       .finally([this]() { return _ctx.as.request_abort(); })
       .finally([this]() mutable { return _server.stop(); });
 }
 
+ss::shard_id
+consumer_shard(const kafka::group_id& g_id, std::string_view name) {
+    incremental_xxhash64 h;
+    h.update(g_id().size());
+    h.update(g_id);
+    h.update(name);
+    return jump_consistent_hash(h.digest(), ss::smp::count);
+}
+
+ss::shard_id consumer_shard(
+  const server::context_t& ctx,
+  const kafka::group_id& g_id,
+  const kafka::member_id& m_id) {
+    auto it = ctx.consumer_shards.find(server::consumer_key{g_id, m_id});
+    return it == ctx.consumer_shards.end() ? ss::this_shard_id() : it->second;
+}
+
+ss::future<> add_consumer_shard(
+  server::context_t& ctx,
+  kafka::group_id g_id,
+  kafka::member_id m_id,
+  ss::shard_id shard) {
+    if (ctx.shards.empty()) {
+        ctx.consumer_shards.emplace(
+          server::consumer_key{std::move(g_id), std::move(m_id)}, shard);
+        return ss::now();
+    }
+    return ss::smp::invoke_on_all(
+      [&ctx, key = server::consumer_key{std::move(g_id), std::move(m_id)},
+       shard]() {
+          ctx.shards[ss::this_shard_id()]->consumer_shards.emplace(key, shard);
+      });
+}
+
+ss::future<> remove_consumer_shard(
+  server::context_t& ctx, kafka::group_id g_id, kafka::member_id m_id) {
+    if (ctx.shards.empty()) {
+        ctx.consumer_shards.erase(
+          server::consumer_key{std::move(g_id), std::move(m_id)});
+        return ss::now();
+    }
+    return ss::smp::invoke_on_all(
+      [&ctx, key = server::consumer_key{std::move(g_id), std::move(m_id)}]() {
+          ctx.shards[ss::this_shard_id()]->consumer_shards.erase(key);
+      });
+}
+
 } // namespace pandaproxy
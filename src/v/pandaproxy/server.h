@@ -11,12 +11,14 @@
 
 #pragma once
 
+#include "kafka/types.h"
 #include "pandaproxy/context.h"
 #include "pandaproxy/json/types.h"
 #include "seastarx.h"
 
 #include <seastar/core/future.hh>
 #include <seastar/core/gate.hh>
+#include <seastar/core/smp.hh>
 #include <seastar/http/api_docs.hh>
 #include <seastar/http/handlers.hh>
 #include <seastar/http/httpd.hh>
@@ -26,7 +28,12 @@
 #include <seastar/net/socket_defs.hh>
 #include <seastar/util/noncopyable_function.hh>
 
+#include <absl/container/flat_hash_map.h>
+
 #include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace pandaproxy {
 
@@ -37,12 +44,18 @@ namespace pandaproxy {
 /// e.g., logging, serialisation, metrics, rate-limiting.
 class server {
 public:
+    using consumer_key = std::pair<kafka::group_id, kafka::member_id>;
+
     struct context_t {
         std::vector<unresolved_address> advertised_listeners;
         ss::semaphore mem_sem;
         ss::abort_source as;
         kafka::client::client& client;
         const configuration& config;
+        // the context of each shard, by shard id
+        std::vector<context_t*> shards;
+        // the shard owning each consumer instance
+        absl::flat_hash_map<consumer_key, ss::shard_id> consumer_shards;
     };
 
     struct request_t {
@@ -84,6 +97,11 @@ public:
     ss::future<> start();
     ss::future<> stop();
 
+    context_t& context() { return _ctx; }
+    /// The contexts of all the shards, for the requests routed to the shard
+    /// owning a consumer instance
+    void set_shards(std::vector<context_t*> shards);
+
 private:
     ss::httpd::http_server _server;
     ss::gate _pending_reqs;
@@ -92,4 +110,45 @@ private:
     context_t _ctx;
 };
 
+/*
+ * Consumer instances are spread across the shards: an instance is created on
+ * the shard its group and name hash to, and the requests for it run on that
+ * shard whichever shard accepted them.
+ */
+
+/// The shard a new consumer instance of the group is created on
+ss::shard_id
+consumer_shard(const kafka::group_id& g_id, std::string_view name);
+
+/// The shard owning the consumer instance, the local shard if it is unknown
+ss::shard_id consumer_shard(
+  const server::context_t& ctx,
+  const kafka::group_id& g_id,
+  const kafka::member_id& m_id);
+
+/// Record the shard owning the consumer instance on all the shards
+ss::future<> add_consumer_shard(
+  server::context_t& ctx,
+  kafka::group_id g_id,
+  kafka::member_id m_id,
+  ss::shard_id shard);
+
+/// Forget the shard owning the consumer instance on all the shards
+ss::future<> remove_consumer_shard(
+  server::context_t& ctx, kafka::group_id g_id, kafka::member_id m_id);
+
+/// Run the function with the context of the shard, the result must be safe
+/// to move across shards
+template<typename Func>
+auto invoke_on_shard(server::context_t& ctx, ss::shard_id shard, Func&& f) {
+    if (shard == ss::this_shard_id() || shard >= ctx.shards.size()) {
+        return ss::futurize_invoke(std::forward<Func>(f), ctx);
+    }
+    return ss::smp::submit_to(
+      shard,
+      [target = ctx.shards[shard], f = std::forward<Func>(f)]() mutable {
+          return ss::futurize_invoke(std::move(f), *target);
+      });
+}
+
 } // namespace pandaproxy
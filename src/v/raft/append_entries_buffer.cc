@@ -15,9 +15,12 @@
 namespace raft {
 
 append_entries_buffer::append_entries_buffer(
-  consensus& c, size_t max_buffered_elements)
+  consensus& c,
+  size_t max_buffered_elements,
+  std::chrono::microseconds max_hold)
   : _consensus(c)
-  , _max_buffered(max_buffered_elements) {}
+  , _max_buffered(max_buffered_elements)
+  , _max_hold(max_hold) {}
 
 ss::future<append_entries_reply>
 append_entries_buffer::enqueue(append_entries_request&& r) {
@@ -51,6 +54,7 @@ void append_entries_buffer::start() {
           [this] { return _gate.is_closed(); },
           [this] {
               return _enqueued.wait([this] { return !_requests.empty(); })
+                .then([this] { return maybe_hold(); })
                 .then([this] { return flush(); })
                 .handle_exception_type(
                   [](const ss::broken_condition_variable&) {
@@ -60,6 +64,31 @@ void append_entries_buffer::start() {
     });
 }
 
+ss::future<> append_entries_buffer::maybe_hold() {
+    _last_hold = hold_clock::duration(0);
+    if (!_disk_busy || _requests.size() >= _max_buffered) {
+        return ss::now();
+    }
+    auto started = hold_clock::now();
+    auto hold = std::min<hold_clock::duration>(_max_hold, _flush_latency / 2);
+    return _enqueued
+      .wait(
+        started + hold,
+        [this] { return _requests.size() >= _max_buffered; })
+      .handle_exception_type([](const ss::condition_variable_timed_out&) {
+          // flush whatever was merged so far
+      })
+      .finally([this, started] { _last_hold = hold_clock::now() - started; });
+}
+
+void append_entries_buffer::update_flush_stats(
+  size_t requests, hold_clock::duration flush_latency) {
+    // same weight as 1/8 in the TCP round trip time estimation
+    _flush_latency = _flush_latency - _flush_latency / 8 + flush_latency / 8;
+    _disk_busy = _max_hold.count() > 0 && requests > 1
+                 && _flush_latency > _max_hold;
+}
+
 ss::future<> append_entries_buffer::flush() {
     auto requests = std::exchange(_requests, {});
     auto response_promises = std::exchange(_responses, {});
@@ -90,7 +119,12 @@ ss::future<> append_entries_buffer::do_flush(
         }
     }
     if (needs_flush) {
+        auto flush_started = hold_clock::now();
         co_await _consensus.flush_log();
+        update_flush_stats(requests.size(), hold_clock::now() - flush_started);
+        _consensus.get_probe().append_entries_buffer_flushed(
+          requests.size(),
+          std::chrono::duration_cast<std::chrono::microseconds>(_last_hold));
     }
 
     propagate_results(std::move(replies), std::move(response_promises));
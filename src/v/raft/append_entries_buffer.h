@@ -5,6 +5,8 @@
 #include <seastar/core/condition-variable.hh>
 #include <seastar/core/gate.hh>
 
+#include <chrono>
+
 namespace raft {
 
 class consensus;
@@ -116,6 +118,15 @@ class consensus;
  * entries to its local log. It can therefore update commit_index as soon as it
  * will receive the first response, still being correct and guaranteeing safety.
  *
+ * Adaptive holding:
+ *
+ * When the follower disk is slow, the flush dominates the latency of the
+ * requests. If the previous flush merged more than one request and took
+ * longer than max_hold, the buffer waits for up to half of the recent flush
+ * latency, bounded by max_hold, for more requests to arrive before it takes
+ * the mutex. The merged requests share the following flush. An idle follower
+ * or a follower with a fast disk flushes right away.
+ *
  * Note on backpressure handling:
  *
  * The backpressure is handled using condition variable. When buffer has free
@@ -123,7 +134,10 @@ class consensus;
  */
 class append_entries_buffer {
 public:
-    explicit append_entries_buffer(consensus&, size_t max_buffered_elements);
+    append_entries_buffer(
+      consensus&,
+      size_t max_buffered_elements,
+      std::chrono::microseconds max_hold);
 
     ss::future<append_entries_reply> enqueue(append_entries_request&& r);
 
@@ -134,8 +148,12 @@ private:
     using request_t = std::vector<append_entries_request>;
     using response_t = std::vector<ss::promise<append_entries_reply>>;
     using reply_t = std::variant<append_entries_reply, std::exception_ptr>;
+    // lowres clock is too coarse for holds of microseconds
+    using hold_clock = std::chrono::steady_clock;
 
     ss::future<> flush();
+    ss::future<> maybe_hold();
+    void update_flush_stats(size_t, hold_clock::duration);
     ss::future<> do_flush(request_t, response_t);
 
     void propagate_results(std::vector<reply_t>, response_t);
@@ -147,6 +165,12 @@ private:
     ss::gate _gate;
     ss::condition_variable _flushed;
     const size_t _max_buffered;
+    const std::chrono::microseconds _max_hold;
+    // moving average of the follower flush latency
+    hold_clock::duration _flush_latency{0};
+    bool _disk_busy = false;
+    // time the requests being flushed were held for
+    hold_clock::duration _last_hold{0};
 };
 
 } // namespace raft
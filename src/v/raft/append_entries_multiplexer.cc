@@ -0,0 +1,182 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "raft/append_entries_multiplexer.h"
+
+#include "raft/errc.h"
+#include "raft/logger.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/future-util.hh>
+#include <seastar/core/gate.hh>
+
+#include <algorithm>
+
+namespace raft {
+
+append_entries_multiplexer::append_entries_multiplexer(
+  consensus_client_protocol next, size_t max_requests)
+  : _next(std::move(next))
+  , _max_requests(std::max<size_t>(max_requests, 1)) {}
+
+ss::future<result<vote_reply>> append_entries_multiplexer::vote(
+  model::node_id n, vote_request&& r, rpc::client_opts opts) {
+    return _next.vote(n, std::move(r), std::move(opts));
+}
+
+ss::future<result<append_entries_reply>>
+append_entries_multiplexer::append_entries(
+  model::node_id n, append_entries_request&& r, rpc::client_opts opts) {
+    if (opts.connection == rpc::connection_class::bulk) {
+        // recovery goes over its own connections, batching it with the
+        // replication requests would put it back on the default one
+        return _next.append_entries(n, std::move(r), std::move(opts));
+    }
+    if (_gate.is_closed()) {
+        return ss::make_ready_future<result<append_entries_reply>>(
+          errc::shutting_down);
+    }
+    auto& q = _queues[n];
+    q.pending.push_back(pending_append{
+      .request = std::move(r),
+      .timeout = opts.timeout,
+    });
+    auto f = q.pending.back().promise.get_future();
+    if (q.pending.size() >= _max_requests) {
+        (void)ss::with_gate(_gate, [this, n] { return dispatch(n); });
+    } else if (!q.dispatch_scheduled) {
+        q.dispatch_scheduled = true;
+        // collect the requests of all groups flushing in this poll
+        (void)ss::with_gate(_gate, [this, n] {
+            return ss::later().then([this, n] { return dispatch(n); });
+        });
+    }
+    return f;
+}
+
+ss::future<result<append_entries_batch_reply>>
+append_entries_multiplexer::append_entries_batch(
+  model::node_id n, append_entries_batch_request&& r, rpc::client_opts opts) {
+    return _next.append_entries_batch(n, std::move(r), std::move(opts));
+}
+
+ss::future<result<heartbeat_reply>> append_entries_multiplexer::heartbeat(
+  model::node_id n, heartbeat_request&& r, rpc::client_opts opts) {
+    return _next.heartbeat(n, std::move(r), std::move(opts));
+}
+
+ss::future<result<install_snapshot_reply>>
+append_entries_multiplexer::install_snapshot(
+  model::node_id n, install_snapshot_request&& r, rpc::client_opts opts) {
+    return _next.install_snapshot(n, std::move(r), std::move(opts));
+}
+
+ss::future<result<install_segment_reply>>
+append_entries_multiplexer::install_segment(
+  model::node_id n, install_segment_request&& r, rpc::client_opts opts) {
+    return _next.install_segment(n, std::move(r), std::move(opts));
+}
+
+ss::future<result<timeout_now_reply>> append_entries_multiplexer::timeout_now(
+  model::node_id n, timeout_now_request&& r, rpc::client_opts opts) {
+    return _next.timeout_now(n, std::move(r), std::move(opts));
+}
+
+ss::future<> append_entries_multiplexer::stop() {
+    // every queued request has a dispatch running in the gate
+    return _gate.close();
+}
+
+ss::future<> append_entries_multiplexer::dispatch(model::node_id n) {
+    auto it = _queues.find(n);
+    if (it == _queues.end()) {
+        return ss::now();
+    }
+    auto pending = std::exchange(it->second.pending, {});
+    _queues.erase(it);
+    if (pending.empty()) {
+        return ss::now();
+    }
+    if (pending.size() == 1) {
+        // nothing to pack, skip the envelope
+        auto& p = pending.front();
+        return _next
+          .append_entries(n, std::move(p.request), rpc::client_opts(p.timeout))
+          .then_wrapped([promise = std::move(p.promise)](
+                          ss::future<result<append_entries_reply>> f) mutable {
+              f.forward_to(std::move(promise));
+          });
+    }
+    return send_batch(n, std::move(pending));
+}
+
+static void
+fail_all(std::vector<ss::promise<result<append_entries_reply>>>& promises) {
+    auto e = std::current_exception();
+    for (auto& p : promises) {
+        p.set_exception(e);
+    }
+}
+
+ss::future<> append_entries_multiplexer::send_batch(
+  model::node_id n, std::vector<pending_append> pending) {
+    append_entries_batch_request req;
+    std::vector<ss::promise<result<append_entries_reply>>> promises;
+    req.requests.reserve(pending.size());
+    promises.reserve(pending.size());
+    auto timeout = pending.front().timeout;
+    for (auto& p : pending) {
+        timeout = std::max(timeout, p.timeout);
+        req.requests.push_back(std::move(p.request));
+        promises.push_back(std::move(p.promise));
+    }
+    vlog(
+      raftlog.trace,
+      "Sending {} append entries requests to node {} in one batch",
+      promises.size(),
+      n);
+    try {
+        auto r = co_await _next.append_entries_batch(
+          n, std::move(req), rpc::client_opts(timeout));
+        if (!r) {
+            for (auto& p : promises) {
+                p.set_value(r.error());
+            }
+            co_return;
+        }
+        auto& replies = r.value().replies;
+        auto& errors = r.value().errors;
+        if (
+          replies.size() != promises.size()
+          || errors.size() != promises.size()) {
+            vlog(
+              raftlog.warn,
+              "Node {} replied with {} replies to {} append entries requests",
+              n,
+              replies.size(),
+              promises.size());
+            for (auto& p : promises) {
+                p.set_value(errc::append_entries_dispatch_error);
+            }
+            co_return;
+        }
+        for (size_t i = 0; i < replies.size(); ++i) {
+            if (errors[i] != errc::success) {
+                promises[i].set_value(errors[i]);
+            } else {
+                promises[i].set_value(std::move(replies[i]));
+            }
+        }
+    } catch (...) {
+        fail_all(promises);
+    }
+}
+
+} // namespace raft
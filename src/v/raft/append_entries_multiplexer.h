@@ -0,0 +1,106 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "model/metadata.h"
+#include "outcome.h"
+#include "raft/consensus_client_protocol.h"
+#include "raft/types.h"
+#include "rpc/types.h"
+#include "seastarx.h"
+
+#include <seastar/core/future.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/shared_ptr.hh>
+
+#include <absl/container/flat_hash_map.h>
+
+#include <vector>
+
+namespace raft {
+
+/**
+ * Client protocol that packs the append_entries requests of many raft groups
+ * addressed to the same node into a single append_entries_batch RPC, in the
+ * same way the heartbeat_manager batches heartbeats into node heartbeats.
+ *
+ * Requests issued for a node are collected until the current task yields,
+ * the replicate batchers of different groups flush in the same reactor poll
+ * so this is enough to coalesce them without adding latency. Replies are
+ * fanned back out to the callers of the individual requests. Recovery
+ * requests, sent over the bulk connections, and all the other requests are
+ * passed through to the underlying protocol. A request that fails on the
+ * receiver fails for its group only, with the error the receiver replied.
+ *
+ * The receiving node has to know the append_entries_batch method.
+ */
+class append_entries_multiplexer final
+  : public consensus_client_protocol::impl {
+public:
+    append_entries_multiplexer(
+      consensus_client_protocol next, size_t max_requests);
+
+    ss::future<result<vote_reply>>
+    vote(model::node_id, vote_request&&, rpc::client_opts) final;
+
+    ss::future<result<append_entries_reply>> append_entries(
+      model::node_id, append_entries_request&&, rpc::client_opts) final;
+
+    ss::future<result<append_entries_batch_reply>> append_entries_batch(
+      model::node_id, append_entries_batch_request&&, rpc::client_opts) final;
+
+    ss::future<result<heartbeat_reply>>
+    heartbeat(model::node_id, heartbeat_request&&, rpc::client_opts) final;
+
+    ss::future<result<install_snapshot_reply>> install_snapshot(
+      model::node_id, install_snapshot_request&&, rpc::client_opts) final;
+
+    ss::future<result<install_segment_reply>> install_segment(
+      model::node_id, install_segment_request&&, rpc::client_opts) final;
+
+    ss::future<result<timeout_now_reply>>
+    timeout_now(model::node_id, timeout_now_request&&, rpc::client_opts) final;
+
+    /// \brief waits for the batches in flight, requests made afterwards fail
+    /// with errc::shutting_down
+    ss::future<> stop() final;
+
+private:
+    struct pending_append {
+        append_entries_request request;
+        clock_type::time_point timeout;
+        ss::promise<result<append_entries_reply>> promise;
+    };
+
+    struct node_queue {
+        std::vector<pending_append> pending;
+        bool dispatch_scheduled = false;
+    };
+
+    /// \brief sends all requests pending for the node in one RPC
+    ss::future<> dispatch(model::node_id);
+
+    ss::future<> send_batch(model::node_id, std::vector<pending_append>);
+
+    consensus_client_protocol _next;
+    size_t _max_requests;
+    absl::flat_hash_map<model::node_id, node_queue> _queues;
+    ss::gate _gate;
+};
+
+inline consensus_client_protocol make_append_entries_multiplexer(
+  consensus_client_protocol next, size_t max_requests) {
+    return make_consensus_client_protocol<append_entries_multiplexer>(
+      std::move(next), max_requests);
+}
+
+} // namespace raft
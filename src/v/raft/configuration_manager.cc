@@ -18,6 +18,9 @@
 #include "storage/kvstore.h"
 #include "vlog.h"
 
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/when_all.hh>
+
 #include <absl/container/btree_map.h>
 #include <boost/range/irange.hpp>
 
@@ -46,11 +49,17 @@ ss::future<> configuration_manager::truncate(model::offset offset) {
 
     return _lock.with([this, offset] {
         auto it = _configurations.lower_bound(offset);
+        std::vector<model::offset> removed;
+        for (auto i = it; i != _configurations.end(); ++i) {
+            removed.push_back(i->first);
+        }
         _configurations.erase(it, _configurations.end());
 
         _highest_known_offset = std::min(offset, _highest_known_offset);
-        return store_highest_known_offset().then(
-          [this] { return store_configurations(); });
+        return ss::when_all_succeed(
+                 store_highest_known_offset(),
+                 store_configurations({}, std::move(removed)))
+          .discard_result();
     });
 }
 
@@ -67,10 +76,16 @@ ss::future<> configuration_manager::prefix_truncate(model::offset offset) {
                 offset,
                 get_latest_offset())));
         }
+        std::vector<model::offset> removed;
+        for (auto i = _configurations.begin(); i != it; ++i) {
+            removed.push_back(i->first);
+        }
         _configurations.erase(_configurations.begin(), it);
         _highest_known_offset = std::max(offset, _highest_known_offset);
-        return store_highest_known_offset().then(
-          [this] { return store_configurations(); });
+        return ss::when_all_succeed(
+                 store_highest_known_offset(),
+                 store_configurations({}, std::move(removed)))
+          .discard_result();
     });
 }
 
@@ -89,6 +104,8 @@ ss::future<>
 configuration_manager::add(std::vector<offset_configuration> configurations) {
     return _lock.with([this,
                        configurations = std::move(configurations)]() mutable {
+        std::vector<model::offset> stored;
+        stored.reserve(configurations.size());
         for (auto& co : configurations) {
             // handling backward compatibility i.e. revisionless configurations
             co.cfg.maybe_set_initial_revision(_initial_revision);
@@ -98,11 +115,14 @@ configuration_manager::add(std::vector<offset_configuration> configurations) {
               co.cfg,
               co.offset);
             add_configuration(co.offset, std::move(co.cfg));
+            stored.push_back(co.offset);
             _highest_known_offset = std::max(_highest_known_offset, co.offset);
         }
         _config_changed.broadcast();
-        return store_configurations().then(
-          [this] { return store_highest_known_offset(); });
+        return ss::when_all_succeed(
+                 store_configurations(std::move(stored), {}),
+                 store_highest_known_offset())
+          .discard_result();
     });
 }
 
@@ -123,8 +143,10 @@ configuration_manager::add(model::offset offset, group_configuration cfg) {
         add_configuration(offset, std::move(cfg));
         _highest_known_offset = std::max(offset, _highest_known_offset);
         _config_changed.broadcast();
-        return store_configurations().then(
-          [this] { return store_highest_known_offset(); });
+        return ss::when_all_succeed(
+                 store_configurations({offset}, {}),
+                 store_highest_known_offset())
+          .discard_result();
     });
 }
 
@@ -157,20 +179,6 @@ configuration_manager::get(model::offset offset) const {
     return std::nullopt;
 }
 
-ss::future<iobuf> serialize_configurations(
-  const absl::btree_map<model::offset, group_configuration>& cfgs) {
-    return ss::do_with(iobuf(), [&cfgs](iobuf& ret) {
-        reflection::adl<uint64_t>{}.to(ret, cfgs.size());
-        return ss::do_for_each(
-                 cfgs.cbegin(),
-                 cfgs.cend(),
-                 [&ret](const auto& p) mutable {
-                     reflection::serialize(ret, p.first, p.second);
-                 })
-          .then([&ret] { return std::move(ret); });
-    });
-}
-
 ss::future<absl::btree_map<model::offset, group_configuration>>
 deserialize_configurations(iobuf&& buf) {
     using ret_t = absl::btree_map<model::offset, group_configuration>;
@@ -214,15 +222,127 @@ bytes configuration_manager::highest_known_offset_key() {
     return iobuf_to_bytes(buf);
 }
 
-ss::future<> configuration_manager::store_configurations() {
-    return serialize_configurations(_configurations).then([this](iobuf buf) {
-        return _storage.kvs().put(
+bytes configuration_manager::configurations_index_key(raft::group_id group) {
+    iobuf buf;
+    reflection::serialize(buf, metadata_key::config_index, group);
+    return iobuf_to_bytes(buf);
+}
+
+bytes configuration_manager::configuration_key(
+  raft::group_id group, model::offset offset) {
+    iobuf buf;
+    reflection::serialize(buf, metadata_key::config_index, group, offset);
+    return iobuf_to_bytes(buf);
+}
+
+std::vector<bytes> configuration_manager::persistent_configuration_keys(
+  storage::kvstore& kvs, raft::group_id group) {
+    std::vector<bytes> keys;
+    auto index = kvs.get(
+      storage::kvstore::key_space::consensus, configurations_index_key(group));
+    if (!index) {
+        return keys;
+    }
+    auto offsets = reflection::from_iobuf<std::vector<model::offset>>(
+      std::move(*index));
+    keys.reserve(offsets.size());
+    for (auto o : offsets) {
+        keys.push_back(configuration_key(group, o));
+    }
+    return keys;
+}
+
+ss::future<> configuration_manager::store_configurations(
+  std::vector<model::offset> stored, std::vector<model::offset> removed) {
+    // the operations are queued up until the next flush of the key value
+    // store, which writes them in a single batch together with the ones of all
+    // the other groups
+    if (!_index_stored) {
+        // first write of the group, e.g. its initial configuration has not
+        // been stored yet
+        stored.clear();
+        for (const auto& p : _configurations) {
+            stored.push_back(p.first);
+        }
+        _index_stored = true;
+    }
+    std::vector<ss::future<>> fs;
+    fs.reserve(stored.size() + removed.size() + 1);
+    for (auto o : removed) {
+        fs.push_back(_storage.kvs().remove(
           storage::kvstore::key_space::consensus,
-          configurations_map_key(),
-          std::move(buf));
+          configuration_key(_group, o)));
+    }
+    for (auto o : stored) {
+        fs.push_back(_storage.kvs().put(
+          storage::kvstore::key_space::consensus,
+          configuration_key(_group, o),
+          reflection::to_iobuf(_configurations.at(o))));
+    }
+
+    std::vector<model::offset> index;
+    index.reserve(_configurations.size());
+    for (const auto& p : _configurations) {
+        index.push_back(p.first);
+    }
+    fs.push_back(_storage.kvs().put(
+      storage::kvstore::key_space::consensus,
+      configurations_index_key(_group),
+      reflection::to_iobuf(std::move(index))));
+
+    return ss::when_all_succeed(fs.begin(), fs.end());
+}
+
+ss::future<> configuration_manager::remove_configurations() {
+    auto keys = persistent_configuration_keys(_storage.kvs(), _group);
+    keys.push_back(configurations_index_key(_group));
+    // map of all the configurations stored by previous versions
+    keys.push_back(configurations_map_key());
+    return ss::do_with(std::move(keys), [this](std::vector<bytes>& keys) {
+        return ss::parallel_for_each(keys, [this](bytes& k) {
+            return _storage.kvs().remove(
+              storage::kvstore::key_space::consensus, k);
+        });
     });
 }
 
+void configuration_manager::load_configurations(iobuf index) {
+    auto offsets = reflection::from_iobuf<std::vector<model::offset>>(
+      std::move(index));
+    underlying_t cfgs;
+    for (auto o : offsets) {
+        auto buf = _storage.kvs().get(
+          storage::kvstore::key_space::consensus, configuration_key(_group, o));
+        vassert(buf, "Missing configuration at offset {} of the index", o);
+        cfgs.emplace(
+          o, reflection::from_iobuf<group_configuration>(std::move(*buf)));
+    }
+    _configurations = std::move(cfgs);
+    if (!_configurations.empty()) {
+        _highest_known_offset = _configurations.rbegin()->first;
+    }
+}
+
+ss::future<> configuration_manager::migrate_configurations_map(iobuf map) {
+    _configurations = co_await deserialize_configurations(std::move(map));
+    if (!_configurations.empty()) {
+        _highest_known_offset = _configurations.rbegin()->first;
+    }
+    vlog(
+      _ctxlog.info,
+      "Migrating {} configurations to per offset keys",
+      _configurations.size());
+    std::vector<model::offset> stored;
+    stored.reserve(_configurations.size());
+    for (const auto& p : _configurations) {
+        stored.push_back(p.first);
+    }
+    co_await ss::when_all_succeed(
+      store_configurations(std::move(stored), {}),
+      _storage.kvs().remove(
+        storage::kvstore::key_space::consensus, configurations_map_key()));
+}
+
 ss::future<> configuration_manager::store_highest_known_offset() {
     return _storage.kvs().put(
       storage::kvstore::key_space::consensus,
@@ -239,30 +359,24 @@ ss::future<>
 configuration_manager::start(bool reset, model::revision_id initial_revision) {
     _initial_revision = initial_revision;
     if (reset) {
-        return _storage.kvs()
-          .remove(
-            storage::kvstore::key_space::consensus, configurations_map_key())
-          .then([this] {
-              return _storage.kvs().remove(
-                storage::kvstore::key_space::consensus,
-                highest_known_offset_key());
-          });
+        return remove_persistent_state();
     }
 
-    auto map_buf = _storage.kvs().get(
-      storage::kvstore::key_space::consensus, configurations_map_key());
-    return _lock.with([this, map_buf = std::move(map_buf)]() mutable {
+    return _lock.with([this] {
         auto f = ss::now();
 
-        if (map_buf) {
-            f = deserialize_configurations(std::move(*map_buf))
-                  .then([this](underlying_t cfgs) {
-                      _configurations = std::move(cfgs);
-                      if (!_configurations.empty()) {
-                          _highest_known_offset
-                            = _configurations.rbegin()->first;
-                      }
-                  });
+        auto index_buf = _storage.kvs().get(
+          storage::kvstore::key_space::consensus,
+          configurations_index_key(_group));
+        if (index_buf) {
+            load_configurations(std::move(*index_buf));
+            _index_stored = true;
+        } else if (auto map_buf = _storage.kvs().get(
+                     storage::kvstore::key_space::consensus,
+                     configurations_map_key());
+                   map_buf) {
+            // configurations stored as a single map by previous versions
+            f = migrate_configurations_map(std::move(*map_buf));
         }
 
         auto offset_buf = _storage.kvs().get(
@@ -331,12 +445,12 @@ ss::future<offset_configuration> configuration_manager::wait_for_change(
 }
 
 ss::future<> configuration_manager::remove_persistent_state() {
-    return _storage.kvs()
-      .remove(storage::kvstore::key_space::consensus, configurations_map_key())
-      .then([this] {
-          return _storage.kvs().remove(
-            storage::kvstore::key_space::consensus, highest_known_offset_key());
-      });
+    return ss::when_all_succeed(
+             remove_configurations(),
+             _storage.kvs().remove(
+               storage::kvstore::key_space::consensus,
+               highest_known_offset_key()))
+      .discard_result();
 }
 
 model::revision_id configuration_manager::get_latest_revision() const {
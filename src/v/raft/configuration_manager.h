@@ -37,13 +37,15 @@ namespace raft {
  * used when creating the snapshots to access the configuration that corresponds
  * the snapshot last included offset. Additionally the configuration manager
  * stores all configuration in storage::kvstore, to speed up raft groups
- * recovery. Manager internal logic updates the last_highest knows offset every
- * 64MB of persisted data and when configuration is added to the manager. Thanks
- * to this when raft group is starting it only has to read up to 64MB of data to
- * find configurations that may not be included in the configuration manager.
- * The highest known offset is not group_configuration offset, it is an offset
- * up to which all configuration are guranted to be present in configuration
- * manager.
+ * recovery. Every configuration is stored under its own key, along with an
+ * index of their offsets, so that a change writes only the configurations it
+ * adds or removes. Manager internal logic updates the last_highest knows
+ * offset every 64MB of persisted data and when configuration is added to the
+ * manager. Thanks to this when raft group is starting it only has to read up
+ * to 64MB of data to find configurations that may not be included in the
+ * configuration manager. The highest known offset is not group_configuration
+ * offset, it is an offset up to which all configuration are guranted to be
+ * present in configuration manager.
  */
 class configuration_manager {
 public:
@@ -134,6 +136,13 @@ public:
      */
     ss::future<> remove_persistent_state();
 
+    /**
+     * Keys of the configurations of the group stored in the key value store,
+     * they are not included in the `details::persistent_state_keys`
+     */
+    static std::vector<bytes>
+    persistent_configuration_keys(storage::kvstore&, raft::group_id);
+
     friend std::ostream&
     operator<<(std::ostream&, const configuration_manager&);
 
@@ -143,10 +152,20 @@ private:
     // requested
     using underlying_t = absl::btree_map<model::offset, group_configuration>;
 
-    ss::future<> store_configurations();
+    /**
+     * Stores the configurations at the given offsets, removes the ones that
+     * were erased from the manager and updates the index
+     */
+    ss::future<> store_configurations(
+      std::vector<model::offset> stored, std::vector<model::offset> removed);
     ss::future<> store_highest_known_offset();
+    ss::future<> remove_configurations();
+    void load_configurations(iobuf index);
+    ss::future<> migrate_configurations_map(iobuf map);
     bytes configurations_map_key();
     bytes highest_known_offset_key();
+    static bytes configurations_index_key(raft::group_id);
+    static bytes configuration_key(raft::group_id, model::offset);
 
     void add_configuration(model::offset, group_configuration);
 
@@ -161,6 +180,8 @@ private:
     storage::api& _storage;
     ss::condition_variable _config_changed;
     mutex _lock;
+    // set when the index and all the configurations are in key value store
+    bool _index_stored = false;
     /**
      * We will persist highest known offset every 64MB, given this during
      * bootstrap redpanda will have to read up to 64MB per raft group.
@@ -46,7 +46,8 @@ consensus::consensus(
   model::timeout_clock::duration disk_timeout,
   consensus_client_protocol client,
   consensus::leader_cb_t cb,
-  storage::api& storage)
+  storage::api& storage,
+  recovery_throttle& recovery_throttle)
   : _self(nid, initial_cfg.revision_id())
   , _group(group)
   , _jit(std::move(jit))
@@ -56,30 +57,47 @@ consensus::consensus(
   , _client_protocol(client)
   , _leader_notification(std::move(cb))
   , _fstats(_self)
-  , _batcher(this, config::shard_local_cfg().raft_replicate_batch_window_size())
+  , _batcher(
+      this,
+      config::shard_local_cfg().raft_replicate_batch_window_size(),
+      std::chrono::microseconds(
+        config::shard_local_cfg().raft_replicate_batch_max_linger_us()))
   , _event_manager(this)
   , _ctxlog(group, _log.config().ntp())
   , _replicate_append_timeout(
       config::shard_local_cfg().replicate_append_timeout_ms())
   , _recovery_append_timeout(
       config::shard_local_cfg().recovery_append_timeout_ms())
+  , _leader_write_behind(config::shard_local_cfg().raft_leader_write_behind())
+  , _relaxed_flush_interval(
+      config::shard_local_cfg().raft_relaxed_flush_interval_ms())
   , _storage(storage)
+  , _recovery_throttle(recovery_throttle)
   , _snapshot_mgr(
       std::filesystem::path(_log.config().work_directory()),
       storage::snapshot_manager::default_snapshot_filename,
       _io_priority)
+  , _segment_shipping(
+      config::shard_local_cfg().raft_recovery_segment_shipping())
   , _configuration_manager(std::move(initial_cfg), _group, _storage, _ctxlog)
-  , _append_requests_buffer(*this, 256) {
+  , _append_requests_buffer(
+      *this,
+      256,
+      std::chrono::microseconds(
+        config::shard_local_cfg().raft_append_entries_max_hold_us())) {
     setup_metrics();
     update_follower_stats(_configuration_manager.get_latest());
     _vote_timeout.set_callback([this] {
         maybe_step_down();
         dispatch_vote(false);
     });
+    _relaxed_flush_timer.set_callback([this] { dispatch_flush_with_lock(); });
 }
 
 void consensus::setup_metrics() {
-    if (config::shard_local_cfg().disable_metrics()) {
+    if (
+      config::shard_local_cfg().disable_metrics()
+      || config::shard_local_cfg().aggregate_partition_metrics()) {
         return;
     }
 
@@ -137,6 +155,7 @@ clock_type::time_point consensus::majority_heartbeat() const {
 void consensus::shutdown_input() {
     if (likely(!_as.abort_requested())) {
         _vote_timeout.cancel();
+        _relaxed_flush_timer.cancel();
         _as.request_abort();
         _commit_index_updated.broken();
         _disk_append.broken();
@@ -145,9 +164,14 @@ void consensus::shutdown_input() {
 
 ss::future<> consensus::stop() {
     vlog(_ctxlog.info, "Stopping");
+    const bool was_leader = is_leader();
     shutdown_input();
 
-    return _event_manager.stop()
+    return write_leadership_hint(was_leader)
+      .handle_exception([this](const std::exception_ptr& e) {
+          vlog(_ctxlog.warn, "Cannot persist the leadership hint: {}", e);
+      })
+      .then([this] { return _event_manager.stop(); })
       .then([this] { return _append_requests_buffer.stop(); })
       .then([this] { return _bg.close(); })
       .then([this] { return _batcher.stop(); })
@@ -158,7 +182,8 @@ ss::future<> consensus::stop() {
           }
           return _snapshot_writer->close().then(
             [this] { _snapshot_writer.reset(); });
-      });
+      })
+      .then([this] { return abort_segment_transfer(); });
 }
 
 consensus::success_reply consensus::update_follower_index(
@@ -584,6 +609,7 @@ ss::future<result<replicate_result>> consensus::do_replicate(
                       _visibility_upper_bound_index, res.last_offset);
                     maybe_update_majority_replicated_index();
                 }
+                maybe_arm_relaxed_flush();
                 return result<replicate_result>(
                   replicate_result{.last_offset = res.last_offset});
             });
@@ -591,6 +617,16 @@ ss::future<result<replicate_result>> consensus::do_replicate(
       .finally([this] { _probe.replicate_done(); });
 }
 
+void consensus::maybe_arm_relaxed_flush() {
+    // the timer is not rearmed by the following appends so that a steady
+    // stream of them is still flushed at the interval
+    if (
+      _relaxed_flush_interval > std::chrono::milliseconds(0)
+      && !_relaxed_flush_timer.armed() && !_as.abort_requested()) {
+        _relaxed_flush_timer.arm(_relaxed_flush_interval);
+    }
+}
+
 void consensus::dispatch_flush_with_lock() {
     if (!_has_pending_flushes) {
         return;
@@ -860,6 +896,7 @@ ss::future<> consensus::start() {
     vlog(_ctxlog.info, "Starting");
     return _op_lock.with([this] {
         read_voted_for();
+        read_leadership_hint();
 
         return _configuration_manager
           .start(is_initial_state(), _self.revision())
@@ -918,7 +955,15 @@ ss::future<> consensus::start() {
               // election
               _hbeat = clock_type::time_point::min();
               auto conf = _configuration_manager.get_latest().brokers();
-              if (!conf.empty() && _self.id() == conf.begin()->id()) {
+              if (
+                conf.size() > 1 && _leadership_hint
+                && *_leadership_hint == _term) {
+                  // this node led the last term it knows of before the
+                  // restart, it claims the leadership back before the others
+                  // time out, which spreads the elections of the groups
+                  // over the nodes which led them
+                  next_election += _jit.next_jitter_duration();
+              } else if (!conf.empty() && _self.id() == conf.begin()->id()) {
                   // for single node scenarios arm immediate election,
                   // use standard election timeout otherwise.
                   if (conf.size() > 1) {
@@ -1085,6 +1130,39 @@ void consensus::read_voted_for() {
     }
 }
 
+bytes consensus::leadership_hint_key() const {
+    iobuf buf;
+    reflection::serialize(buf, metadata_key::leadership_hint, _group);
+    return iobuf_to_bytes(buf);
+}
+
+void consensus::read_leadership_hint() {
+    _leadership_hint = std::nullopt;
+    auto value = _storage.kvs().get(
+      storage::kvstore::key_space::consensus, leadership_hint_key());
+    if (value) {
+        _leadership_hint = reflection::adl<model::term_id>{}.from(
+          std::move(*value));
+    }
+}
+
+ss::future<> consensus::write_leadership_hint(bool was_leader) {
+    if (was_leader) {
+        _leadership_hint = _term;
+        return _storage.kvs().put(
+          storage::kvstore::key_space::consensus,
+          leadership_hint_key(),
+          reflection::to_iobuf(_term));
+    }
+    if (!_leadership_hint) {
+        // nothing to clear, followers don't write at shutdown
+        return ss::now();
+    }
+    _leadership_hint = std::nullopt;
+    return _storage.kvs().remove(
+      storage::kvstore::key_space::consensus, leadership_hint_key());
+}
+
 ss::future<vote_reply> consensus::vote(vote_request&& r) {
     return with_gate(_bg, [this, r = std::move(r)]() mutable {
         auto target_node_id = r.node_id;
@@ -1252,6 +1330,29 @@ consensus::append_entries(append_entries_request&& r) {
     });
 }
 
+ss::future<append_entries_reply>
+consensus::idle_heartbeat(idle_heartbeat_metadata hb) {
+    if (
+      !_last_leader_heartbeat || _last_leader_heartbeat->meta.term != hb.term
+      || _leader_id != _last_leader_heartbeat->node_id) {
+        // leader will follow up with a full heartbeat
+        return ss::make_ready_future<append_entries_reply>(append_entries_reply{
+          .target_node_id = _leader_id.value_or(vnode{}),
+          .node_id = _self,
+          .group = _group,
+          .term = _term,
+          .result = append_entries_reply::status::timeout});
+    }
+    const auto& last = *_last_leader_heartbeat;
+    return append_entries(append_entries_request(
+      last.node_id,
+      last.target_node_id,
+      last.meta,
+      model::make_memory_record_batch_reader(
+        ss::circular_buffer<model::record_batch>{}),
+      append_entries_request::flush_after_append::no));
+}
+
 ss::future<append_entries_reply>
 consensus::do_append_entries(append_entries_request&& r) {
     auto lstats = _log.offsets();
@@ -1363,6 +1464,8 @@ consensus::do_append_entries(append_entries_request&& r) {
           lstats.dirty_offset, r.meta.last_visible_index);
         // on the follower leader control visibility of entries in the log
         maybe_update_last_visible_index(last_visible);
+        _last_leader_heartbeat = heartbeat_metadata{
+          r.meta, r.node_id, r.target_node_id};
         return maybe_update_follower_commit_idx(
                  model::offset(r.meta.commit_index))
           .then([reply = std::move(reply)]() mutable {
@@ -1628,6 +1731,161 @@ ss::future<install_snapshot_reply> consensus::finish_snapshot(
       });
 }
 
+ss::future<install_segment_reply>
+consensus::install_segment(install_segment_request&& r) {
+    return _op_lock.with([this, r = std::move(r)]() mutable {
+        return do_install_segment(std::move(r));
+    });
+}
+
+bool consensus::log_ends_at(model::offset o, model::term_id term) {
+    if (_log.offsets().dirty_offset != o) {
+        return false;
+    }
+    if (o < model::offset(0)) {
+        return true;
+    }
+    if (o == _last_snapshot_index) {
+        return term == _last_snapshot_term;
+    }
+    return _log.get_term(o) == term;
+}
+
+ss::future<> consensus::abort_segment_transfer() {
+    if (!_segment_receiver) {
+        co_return;
+    }
+    auto receiver = std::move(_segment_receiver);
+    co_await receiver->abort();
+}
+
+ss::future<install_segment_reply>
+consensus::do_install_segment(install_segment_request r) {
+    vlog(_ctxlog.trace, "Install segment request: {}", r);
+    auto lstats = _log.offsets();
+    install_segment_reply reply{
+      .term = _term,
+      .bytes_stored = 0,
+      .last_dirty_log_index = lstats.dirty_offset,
+      .last_committed_log_index = lstats.committed_offset,
+      .success = false};
+    reply.target_node_id = r.node_id;
+
+    if (unlikely(is_request_target_node_invalid("install_segment", r))) {
+        co_return reply;
+    }
+    if (r.term < _term) {
+        co_return reply;
+    }
+    // no need to trigger timeout
+    _hbeat = clock_type::now();
+    if (r.term > _term) {
+        _term = r.term;
+        _voted_for = {};
+        do_step_down();
+        reply.term = _term;
+    }
+
+    // first chunk of a segment, it has to follow the last entry of the log
+    if (
+      r.file == install_segment_request::file_type::data
+      && r.file_offset == 0) {
+        co_await abort_segment_transfer();
+        if (!log_ends_at(r.prev_log_index, r.prev_log_term)) {
+            vlog(
+              _ctxlog.debug,
+              "Rejecting segment [{},{}], log does not end at {} in term {}, "
+              "offsets: {}",
+              r.base_offset,
+              r.dirty_offset,
+              r.prev_log_index,
+              r.prev_log_term,
+              lstats);
+            co_return reply;
+        }
+        _segment_receiver = std::make_unique<segment_receiver>(
+          _log.config(), r.base_offset, r.dirty_offset, r.segment_term);
+    }
+    if (!_segment_receiver || !_segment_receiver->is_for(r)) {
+        co_return reply;
+    }
+
+    bool stored = false;
+    try {
+        stored = co_await _segment_receiver->write(
+          r.file, r.file_offset, std::move(r.chunk));
+    } catch (...) {
+        vlog(
+          _ctxlog.warn,
+          "Error writing segment [{},{}] - {}",
+          r.base_offset,
+          r.dirty_offset,
+          std::current_exception());
+    }
+    if (!stored) {
+        co_await abort_segment_transfer();
+        co_return reply;
+    }
+    reply.bytes_stored = _segment_receiver->bytes_stored();
+    if (!r.done) {
+        reply.success = true;
+        co_return reply;
+    }
+    co_return co_await finish_segment(std::move(r), reply);
+}
+
+ss::future<install_segment_reply> consensus::finish_segment(
+  install_segment_request r, install_segment_reply reply) {
+    // log might have changed between the chunks
+    if (!log_ends_at(r.prev_log_index, r.prev_log_term)) {
+        co_await abort_segment_transfer();
+        co_return reply;
+    }
+    std::exception_ptr e;
+    try {
+        co_await _segment_receiver->finish();
+        _segment_receiver.reset();
+        co_await _log.adopt_segment(r.base_offset, r.segment_term);
+    } catch (...) {
+        e = std::current_exception();
+    }
+    if (e) {
+        vlog(
+          _ctxlog.warn,
+          "Error adopting segment [{},{}] - {}",
+          r.base_offset,
+          r.dirty_offset,
+          e);
+        co_await abort_segment_transfer();
+        co_return reply;
+    }
+    // configurations are the only batches raft has to know about
+    auto configurations = co_await details::read_configurations(
+      _log, r.base_offset, r.dirty_offset, _as);
+    if (!configurations.empty()) {
+        update_follower_stats(configurations.back().cfg);
+        co_await _configuration_manager.add(std::move(configurations));
+    }
+    auto lstats = _log.offsets();
+    if (!_bg.is_closed()) {
+        (void)ss::with_gate(_bg, [this, lstats, sz = _log.size_bytes()] {
+            return _configuration_manager.maybe_store_highest_known_offset(
+              lstats.dirty_offset, sz);
+        });
+    }
+    vlog(
+      _ctxlog.info,
+      "Installed segment [{},{}] received from {}, log offsets: {}",
+      r.base_offset,
+      r.dirty_offset,
+      r.node_id,
+      lstats);
+    reply.last_dirty_log_index = lstats.dirty_offset;
+    reply.last_committed_log_index = lstats.committed_offset;
+    reply.success = true;
+    co_return reply;
+}
+
 ss::future<> consensus::write_snapshot(write_snapshot_cfg cfg) {
     return _op_lock.with([this, cfg = std::move(cfg)]() mutable {
         // do nothing, we already have snapshot for this offset
@@ -1745,7 +2003,16 @@ append_entries_reply consensus::make_append_entries_reply(
 
 ss::future<> consensus::flush_log() {
     _probe.log_flushed();
-    return _log.flush().then([this] { _has_pending_flushes = false; });
+    auto flushed = _log.offsets().dirty_offset;
+    auto started = std::chrono::steady_clock::now();
+    return _log.flush().then([this, flushed, started] {
+        _probe.log_flush_done(std::chrono::steady_clock::now() - started);
+        // with leader write behind the log may have been appended to while
+        // it was being flushed
+        if (_log.offsets().dirty_offset <= flushed) {
+            _has_pending_flushes = false;
+        }
+    });
 }
 
 ss::future<storage::append_result> consensus::disk_append(
@@ -1819,6 +2086,18 @@ clock_type::time_point consensus::last_append_timestamp(vnode id) {
     return _fstats.get(id).last_append_timestamp;
 }
 
+int64_t consensus::replication_backlog() const {
+    if (!is_leader()) {
+        return 0;
+    }
+    const auto dirty = _log.offsets().dirty_offset;
+    int64_t backlog = 0;
+    for (const auto& [_, f] : _fstats) {
+        backlog = std::max<int64_t>(backlog, dirty() - f.match_index());
+    }
+    return backlog;
+}
+
 void consensus::update_node_append_timestamp(vnode id) {
     if (auto it = _fstats.find(id); it != _fstats.end()) {
         it->second.last_append_timestamp = clock_type::now();
@@ -2083,6 +2362,8 @@ ss::future<timeout_now_reply> consensus::timeout_now(timeout_now_request&& r) {
 
 ss::future<std::error_code>
 consensus::transfer_leadership(std::optional<model::node_id> target) {
+    // without a requested target any caught up voter can take over
+    const bool any_target = !target;
     if (!is_leader()) {
         vlog(_ctxlog.debug, "Cannot transfer leadership from non-leader");
         return seastar::make_ready_future<std::error_code>(
@@ -2149,7 +2430,7 @@ consensus::transfer_leadership(std::optional<model::node_id> target) {
       *target_rni,
       _term);
 
-    auto f = ss::with_gate(_bg, [this, target_rni = *target_rni] {
+    return ss::with_gate(_bg, [this, target_rni = *target_rni, any_target] {
         if (_transferring_leadership) {
             vlog(
               _ctxlog.info,
@@ -2176,96 +2457,118 @@ consensus::transfer_leadership(std::optional<model::node_id> target) {
          * complete the transfer.
          */
         _transferring_leadership = true;
+        _transfer_target = target_rni;
+        return do_transfer_leadership(target_rni, any_target)
+          .finally([this] {
+              _transferring_leadership = false;
+              _transfer_target = std::nullopt;
+          });
+    });
+}
+
+ss::future<std::error_code>
+consensus::do_transfer_leadership(vnode target_rni, bool any_target) {
+    /*
+     * the follower's log needs to be up-to-date so that it will
+     * receive votes when we ask it to trigger an immediate
+     * election. so check if the followers needs some recovery, and
+     * then wait on that process to complete before sending the
+     * election request. the recovery of the target is not throttled,
+     * see recovery_stm.
+     */
+    if (!_fstats.contains(target_rni)) {
+        return seastar::make_ready_future<std::error_code>(
+          make_error_code(errc::node_does_not_exists));
+    }
+    auto& meta = _fstats.get(target_rni);
+    if (
+      !meta.is_recovering
+      && needs_recovery(meta, _log.offsets().dirty_offset)) {
+        dispatch_recovery(meta); // sets is_recovering flag
+    }
+
+    auto f = ss::now();
+    if (meta.is_recovering) {
+        vlog(
+          _ctxlog.info,
+          "Waiting on node to recover before requesting election");
+        auto timeout = ss::semaphore::clock::duration(
+          config::shard_local_cfg().raft_transfer_leader_recovery_timeout_ms());
+        f = meta.recovery_finished.wait(timeout);
+    }
 
+    return f.then_wrapped([this, target_rni, any_target](ss::future<> f) {
+        // a timed out wait is handled with the follower not caught up below
+        f.ignore_ready_future();
         /*
-         * the follower's log needs to be up-to-date so that it will
-         * receive votes when we ask it to trigger an immediate
-         * election. so check if the followers needs some recovery, and
-         * then wait on that process to complete before sending the
-         * election request.
+         * there are still several scenarios in which we will want
+         * to not complete leadership transfer, all of which might
+         * have occurred during the recovery process.
+         *
+         *   - we might have lost leadership status
+         *   - shutdown may be in progress
+         *   - other: identified by follower not caught-up
          */
-        if (!_fstats.contains(target_rni)) {
+        if (!is_leader()) {
+            vlog(_ctxlog.debug, "Cannot transfer leadership from non-leader");
             return seastar::make_ready_future<std::error_code>(
-              make_error_code(errc::node_does_not_exists));
-        }
-        auto& meta = _fstats.get(target_rni);
-        if (
-          !meta.is_recovering
-          && needs_recovery(meta, _log.offsets().dirty_offset)) {
-            dispatch_recovery(meta); // sets is_recovering flag
+              make_error_code(errc::not_leader));
         }
 
-        auto f = ss::now();
-        if (meta.is_recovering) {
-            vlog(
-              _ctxlog.info,
-              "Waiting on node to recover before requesting election");
-            auto timeout = ss::semaphore::clock::duration(
-              config::shard_local_cfg()
-                .raft_transfer_leader_recovery_timeout_ms());
-            f = meta.recovery_finished.wait(timeout);
+        if (_as.abort_requested()) {
+            return seastar::make_ready_future<std::error_code>(
+              make_error_code(errc::not_leader));
         }
 
-        return f.then([this, target_rni] {
-            /*
-             * there are still several scenarios in which we will want
-             * to not complete leadership transfer, all of which might
-             * have occurred during the recovery process.
-             *
-             *   - we might have lost leadership status
-             *   - shutdown may be in progress
-             *   - other: identified by follower not caught-up
-             */
-            if (!is_leader()) {
-                vlog(
-                  _ctxlog.debug, "Cannot transfer leadership from non-leader");
-                return seastar::make_ready_future<std::error_code>(
-                  make_error_code(errc::not_leader));
-            }
-
-            if (_as.abort_requested()) {
-                return seastar::make_ready_future<std::error_code>(
-                  make_error_code(errc::not_leader));
-            }
-
-            if (!_fstats.contains(target_rni)) {
-                return seastar::make_ready_future<std::error_code>(
-                  make_error_code(errc::node_does_not_exists));
-            }
-
-            auto& meta = _fstats.get(target_rni);
-            if (needs_recovery(meta, _log.offsets().dirty_offset)) {
-                return seastar::make_ready_future<std::error_code>(
-                  make_error_code(errc::timeout));
+        auto target = target_rni;
+        auto dirty_offset = _log.offsets().dirty_offset;
+        auto caught_up = [this, dirty_offset](vnode n) {
+            return _fstats.contains(n)
+                   && !needs_recovery(_fstats.get(n), dirty_offset);
+        };
+        if (!caught_up(target) && any_target) {
+            // no target was requested, any caught up voter will do
+            auto conf = _configuration_manager.get_latest();
+            for (auto& [n, _] : _fstats) {
+                if (conf.is_voter(n) && caught_up(n)) {
+                    vlog(
+                      _ctxlog.info,
+                      "Node {} did not catch up, transferring leadership to "
+                      "{} instead",
+                      target,
+                      n);
+                    target = n;
+                    break;
+                }
             }
+        }
+        if (!caught_up(target)) {
+            return seastar::make_ready_future<std::error_code>(
+              make_error_code(errc::timeout));
+        }
 
-            timeout_now_request req{
-              .target_node_id = target_rni,
-              .node_id = _self,
-              .group = _group,
-              .term = _term,
-            };
-
-            auto timeout
-              = raft::clock_type::now()
-                + config::shard_local_cfg().raft_timeout_now_timeout_ms();
+        timeout_now_request req{
+          .target_node_id = target,
+          .node_id = _self,
+          .group = _group,
+          .term = _term,
+        };
 
-            return _client_protocol
-              .timeout_now(
-                target_rni.id(), std::move(req), rpc::client_opts(timeout))
+        auto timeout
+          = raft::clock_type::now()
+            + config::shard_local_cfg().raft_timeout_now_timeout_ms();
 
-              .then([](result<timeout_now_reply> reply) {
-                  if (!reply) {
-                      return seastar::make_ready_future<std::error_code>(
-                        reply.error());
-                  }
+        return _client_protocol
+          .timeout_now(target.id(), std::move(req), rpc::client_opts(timeout))
+          .then([](result<timeout_now_reply> reply) {
+              if (!reply) {
                   return seastar::make_ready_future<std::error_code>(
-                    make_error_code(errc::success));
-              });
-        });
+                    reply.error());
+              }
+              return seastar::make_ready_future<std::error_code>(
+                make_error_code(errc::success));
+          });
     });
-
-    return f.finally([this] { _transferring_leadership = false; });
 }
 
 ss::future<> consensus::remove_persistent_state() {
@@ -2275,6 +2578,9 @@ ss::future<> consensus::remove_persistent_state() {
     // last applied key
     co_await _storage.kvs().remove(
       storage::kvstore::key_space::consensus, last_applied_key());
+    // leadership hint
+    co_await _storage.kvs().remove(
+      storage::kvstore::key_space::consensus, leadership_hint_key());
     // configuration manager
     co_await _configuration_manager.remove_persistent_state();
     // snapshot
@@ -2324,6 +2630,33 @@ void consensus::update_suppress_heartbeats(
     }
 }
 
+bool consensus::is_caught_up(vnode id) const {
+    if (!is_leader()) {
+        return false;
+    }
+    auto it = _fstats.find(id);
+    return it != _fstats.end() && it->second.match_index >= _commit_index;
+}
+
+bool consensus::is_heartbeat_idle(
+  vnode id, const protocol_metadata& meta) const {
+    auto it = _fstats.find(id);
+    if (it == _fstats.end()) {
+        return false;
+    }
+    const auto& f = it->second;
+    return f.last_heartbeat_meta == meta && !f.is_recovering
+           && f.match_index == meta.prev_log_index
+           && f.last_committed_log_index == meta.prev_log_index;
+}
+
+void consensus::update_last_heartbeat_meta(
+  vnode id, std::optional<protocol_metadata> meta) {
+    if (auto it = _fstats.find(id); it != _fstats.end()) {
+        it->second.last_heartbeat_meta = meta;
+    }
+}
+
 voter_priority consensus::next_target_priority() {
     return voter_priority(std::max<voter_priority::type>(
       (_target_priority / 5) * 4, min_voter_priority));
@@ -24,7 +24,9 @@
 #include "raft/mutex_buffer.h"
 #include "raft/prevote_stm.h"
 #include "raft/probe.h"
+#include "raft/recovery_throttle.h"
 #include "raft/replicate_batcher.h"
+#include "raft/segment_receiver.h"
 #include "raft/timeout_jitter.h"
 #include "raft/types.h"
 #include "rpc/connection_cache.h"
@@ -88,7 +90,8 @@ public:
       model::timeout_clock::duration disk_timeout,
       consensus_client_protocol,
       leader_cb_t,
-      storage::api&);
+      storage::api&,
+      recovery_throttle&);
 
     /// Initial call. Allow for internal state recovery
     ss::future<> start();
@@ -101,8 +104,13 @@ public:
 
     ss::future<vote_reply> vote(vote_request&& r);
     ss::future<append_entries_reply> append_entries(append_entries_request&& r);
+    /// Repeats the last heartbeat received from the leader, replies with
+    /// timeout when it can not be repeated and a full heartbeat is needed
+    ss::future<append_entries_reply> idle_heartbeat(idle_heartbeat_metadata);
     ss::future<install_snapshot_reply>
     install_snapshot(install_snapshot_request&& r);
+    ss::future<install_segment_reply>
+    install_segment(install_segment_request&& r);
 
     ss::future<timeout_now_reply> timeout_now(timeout_now_request&& r);
 
@@ -151,6 +159,10 @@ public:
     clock_type::time_point last_heartbeat() const { return _hbeat; };
 
     clock_type::time_point last_append_timestamp(vnode);
+
+    /// number of offsets the furthest behind follower has yet to replicate,
+    /// zero when this node is not the leader
+    int64_t replication_backlog() const;
     /**
      * \brief Persist snapshot with given data and start offset
      *
@@ -160,6 +172,16 @@ public:
      */
     ss::future<> write_snapshot(write_snapshot_cfg);
 
+    /// last offset included in the latest snapshot, the log starts right
+    /// after it
+    model::offset last_snapshot_index() const { return _last_snapshot_index; }
+
+    /// opens the latest snapshot, either taken locally or installed by the
+    /// leader
+    ss::future<std::optional<storage::snapshot_reader>> open_snapshot() {
+        return _snapshot_mgr.open_snapshot();
+    }
+
     /// Increment and returns next append_entries order tracking sequence for
     /// follower with given node id
     follower_req_seq next_follower_sequence(vnode);
@@ -207,6 +229,12 @@ public:
     model::offset committed_offset() const { return _commit_index; }
     model::offset last_stable_offset() const;
 
+    /**
+     * On the leader, true for a follower that replicated every committed
+     * entry. A learner in that state serves reads as well as a voter.
+     */
+    bool is_caught_up(vnode) const;
+
     /**
      * Last visible index is an offset that is safe to be fetched by the
      * consumers. This is similar to Kafka's HighWatermark. Last visible
@@ -231,6 +259,15 @@ public:
           _majority_replicated_index, _visibility_upper_bound_index);
     };
 
+    /**
+     * Resolves once the last visible index reaches the given offset, fails
+     * with offset_monitor::wait_aborted on timeout or when consensus stops.
+     */
+    ss::future<> wait_for_visible_offset(
+      model::offset o, model::timeout_clock::time_point timeout) {
+        return _consumable_offset_monitor.wait(o, timeout, _as);
+    }
+
     ss::future<offset_configuration>
     wait_for_config_change(model::offset last_seen, ss::abort_source& as) {
         return _configuration_manager.wait_for_change(last_seen, as);
@@ -298,6 +335,16 @@ public:
     void update_suppress_heartbeats(
       vnode, follower_req_seq, heartbeats_suppressed);
 
+    /**
+     * Follower that acknowledged the last full heartbeat, carrying the same
+     * metadata, and that is fully caught up only needs an idle heartbeat.
+     */
+    bool is_heartbeat_idle(vnode, const protocol_metadata&) const;
+
+    /// Records the metadata of a full heartbeat sent to the follower, nullopt
+    /// when it was not acknowledged
+    void update_last_heartbeat_meta(vnode, std::optional<protocol_metadata>);
+
 private:
     friend replicate_entries_stm;
     friend vote_stm;
@@ -329,6 +376,13 @@ private:
     ss::future<install_snapshot_reply>
       finish_snapshot(install_snapshot_request, install_snapshot_reply);
 
+    ss::future<install_segment_reply>
+      do_install_segment(install_segment_request);
+    ss::future<install_segment_reply>
+      finish_segment(install_segment_request, install_segment_reply);
+    ss::future<> abort_segment_transfer();
+    bool log_ends_at(model::offset, model::term_id);
+
     ss::future<> do_write_snapshot(model::offset, iobuf&&);
     append_entries_reply
       make_append_entries_reply(vnode, storage::append_result);
@@ -353,6 +407,8 @@ private:
       follower_index_metadata&, append_entries_reply);
 
     bool needs_recovery(const follower_index_metadata&, model::offset);
+    ss::future<std::error_code>
+    do_transfer_leadership(vnode target, bool any_target);
     void dispatch_recovery(follower_index_metadata&);
     void maybe_update_leader_commit_idx();
     ss::future<> do_maybe_update_leader_commit_idx(ss::semaphore_units<>);
@@ -387,6 +443,7 @@ private:
     /// \brief called by the vote timer, to dispatch a write under
     /// the ops semaphore
     void dispatch_flush_with_lock();
+    void maybe_arm_relaxed_flush();
 
     void maybe_step_down();
 
@@ -397,6 +454,9 @@ private:
     bytes voted_for_key() const;
     void read_voted_for();
     ss::future<> write_voted_for(consensus::voted_for_configuration);
+    bytes leadership_hint_key() const;
+    void read_leadership_hint();
+    ss::future<> write_leadership_hint(bool was_leader);
     model::term_id get_last_entry_term(const storage::offset_stats&) const;
 
     template<typename Func>
@@ -479,8 +539,12 @@ private:
 
     // read at `ss::future<> start()`
     vnode _voted_for;
+    // term this node was the leader of when it was stopped last
+    std::optional<model::term_id> _leadership_hint;
     std::optional<vnode> _leader_id;
     bool _transferring_leadership{false};
+    // the follower the leadership is transferred to, recovered unthrottled
+    std::optional<vnode> _transfer_target;
 
     /// useful for when we are not the leader
     clock_type::time_point _hbeat = clock_type::now();
@@ -495,6 +559,9 @@ private:
 
     replicate_batcher _batcher;
     bool _has_pending_flushes{false};
+    /// last full heartbeat accepted from the leader, repeated on idle
+    /// heartbeats
+    std::optional<heartbeat_metadata> _last_leader_heartbeat;
 
     /// used to wait for background ops before shutting down
     ss::gate _bg;
@@ -510,11 +577,24 @@ private:
 
     std::chrono::milliseconds _replicate_append_timeout;
     std::chrono::milliseconds _recovery_append_timeout;
+    /// leader flush does not hold the op lock, the next batch is appended
+    /// while the previous one is being flushed
+    bool _leader_write_behind;
+    /// batches replicated with relaxed consistency are flushed by a timer
+    /// firing at this interval after the first unflushed one, when set
+    std::chrono::milliseconds _relaxed_flush_interval;
+    timer_type _relaxed_flush_timer;
     ss::metrics::metric_groups _metrics;
     ss::abort_source _as;
     storage::api& _storage;
+    /// shared by the recoveries of all the groups on the shard
+    recovery_throttle& _recovery_throttle;
     storage::snapshot_manager _snapshot_mgr;
     std::optional<storage::snapshot_writer> _snapshot_writer;
+    /// segment shipped by the leader, see recovery_stm
+    std::unique_ptr<segment_receiver> _segment_receiver;
+    /// leader ships sealed segments to followers that are far behind
+    bool _segment_shipping;
     model::offset _last_snapshot_index;
     model::term_id _last_snapshot_term;
     configuration_manager _configuration_manager;
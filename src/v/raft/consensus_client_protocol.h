@@ -34,6 +34,11 @@ public:
           model::node_id, append_entries_request&&, rpc::client_opts)
           = 0;
 
+        virtual ss::future<result<append_entries_batch_reply>>
+        append_entries_batch(
+          model::node_id, append_entries_batch_request&&, rpc::client_opts)
+          = 0;
+
         virtual ss::future<result<heartbeat_reply>>
         heartbeat(model::node_id, heartbeat_request&&, rpc::client_opts) = 0;
 
@@ -41,10 +46,17 @@ public:
           model::node_id, install_snapshot_request&&, rpc::client_opts)
           = 0;
 
+        virtual ss::future<result<install_segment_reply>> install_segment(
+          model::node_id, install_segment_request&&, rpc::client_opts)
+          = 0;
+
         virtual ss::future<result<timeout_now_reply>>
         timeout_now(model::node_id, timeout_now_request&&, rpc::client_opts)
           = 0;
 
+        /// \brief waits for the requests the protocol sends on its own
+        virtual ss::future<> stop() { return ss::now(); }
+
         virtual ~impl() noexcept = default;
     };
 
@@ -64,6 +76,14 @@ public:
           target_node, std::move(r), std::move(opts));
     }
 
+    ss::future<result<append_entries_batch_reply>> append_entries_batch(
+      model::node_id target_node,
+      append_entries_batch_request&& r,
+      rpc::client_opts opts) {
+        return _impl->append_entries_batch(
+          target_node, std::move(r), std::move(opts));
+    }
+
     ss::future<result<heartbeat_reply>> heartbeat(
       model::node_id target_node,
       heartbeat_request&& r,
@@ -79,6 +99,14 @@ public:
           target_node, std::move(r), std::move(opts));
     }
 
+    ss::future<result<install_segment_reply>> install_segment(
+      model::node_id target_node,
+      install_segment_request&& r,
+      rpc::client_opts opts) {
+        return _impl->install_segment(
+          target_node, std::move(r), std::move(opts));
+    }
+
     ss::future<result<timeout_now_reply>> timeout_now(
       model::node_id target_node,
       timeout_now_request&& r,
@@ -86,6 +114,8 @@ public:
         return _impl->timeout_now(target_node, std::move(r), std::move(opts));
     }
 
+    ss::future<> stop() { return _impl->stop(); }
+
 private:
     ss::shared_ptr<impl> _impl;
 };
@@ -12,6 +12,7 @@
 #include "likely.h"
 #include "model/fundamental.h"
 #include "model/record.h"
+#include "model/record_batch_reader.h"
 #include "model/timestamp.h"
 #include "raft/logger.h"
 #include "random/generators.h"
@@ -36,6 +37,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <limits>
 
 namespace raft::details {
 [[gnu::cold]] void throw_out_of_range() {
@@ -141,6 +143,37 @@ ss::future<configuration_bootstrap_state> read_bootstrap_state(
       });
 }
 
+ss::future<std::vector<offset_configuration>> read_configurations(
+  storage::log log,
+  model::offset start_offset,
+  model::offset end_offset,
+  ss::abort_source& as) {
+    auto rcfg = storage::log_reader_config(
+      start_offset,
+      end_offset,
+      0,
+      std::numeric_limits<size_t>::max(),
+      raft_priority(),
+      configuration_batch_type,
+      std::nullopt,
+      as);
+    return log.make_reader(rcfg)
+      .then([](model::record_batch_reader reader) {
+          return model::consume_reader_to_memory(
+            std::move(reader), model::no_timeout);
+      })
+      .then([](ss::circular_buffer<model::record_batch> batches) {
+          std::vector<offset_configuration> configurations;
+          configurations.reserve(batches.size());
+          for (auto& b : batches) {
+              auto cfg = reflection::from_iobuf<group_configuration>(
+                b.copy_records().begin()->value().copy());
+              configurations.emplace_back(b.base_offset(), std::move(cfg));
+          }
+          return configurations;
+      });
+}
+
 ss::circular_buffer<model::record_batch>
 serialize_configuration_as_batches(group_configuration cfg) {
     auto batch = std::move(
@@ -203,6 +236,17 @@ ss::circular_buffer<model::record_batch> make_ghost_batches_in_gaps(
     return res;
 }
 
+std::vector<bytes> persistent_state_keys(raft::group_id group) {
+    std::vector<bytes> keys;
+    keys.reserve(static_cast<size_t>(metadata_key::last));
+    for (int8_t k = 0; k < static_cast<int8_t>(metadata_key::last); ++k) {
+        iobuf buf;
+        reflection::serialize(buf, static_cast<metadata_key>(k), group);
+        keys.push_back(iobuf_to_bytes(buf));
+    }
+    return keys;
+}
+
 ss::future<> persist_snapshot(
   storage::snapshot_manager& snapshot_manager,
   snapshot_metadata md,
@@ -46,6 +46,10 @@ model::record_batch_reader serialize_configuration(group_configuration cfg);
 ss::future<raft::configuration_bootstrap_state>
 read_bootstrap_state(storage::log, model::offset, ss::abort_source&);
 
+/// reads all the configurations stored in the log in the given offset range
+ss::future<std::vector<offset_configuration>> read_configurations(
+  storage::log, model::offset, model::offset, ss::abort_source&);
+
 ss::circular_buffer<model::record_batch> make_ghost_batches_in_gaps(
   model::offset, ss::circular_buffer<model::record_batch>&&);
 
@@ -53,6 +57,10 @@ ss::circular_buffer<model::record_batch> make_ghost_batches_in_gaps(
 ss::future<>
 persist_snapshot(storage::snapshot_manager&, snapshot_metadata, iobuf&&);
 
+/// keys of all the state a group persists in the consensus key space of
+/// the key value store
+std::vector<bytes> persistent_state_keys(raft::group_id);
+
 /// looks up for the broker with request id in a vector of brokers
 template<typename Iterator>
 Iterator find_machine(Iterator begin, Iterator end, model::node_id id) {
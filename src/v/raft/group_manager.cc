@@ -12,10 +12,22 @@
 #include "config/configuration.h"
 #include "model/metadata.h"
 #include "prometheus/prometheus_sanitize.h"
+#include "raft/append_entries_multiplexer.h"
 #include "resource_mgmt/io_priority.h"
 
 namespace raft {
 
+static consensus_client_protocol make_client_protocol(
+  model::node_id self, ss::sharded<rpc::connection_cache>& clients) {
+    auto proto = make_rpc_client_protocol(self, clients);
+    if (!config::shard_local_cfg().raft_append_entries_multiplexing()) {
+        return proto;
+    }
+    return make_append_entries_multiplexer(
+      std::move(proto),
+      config::shard_local_cfg().raft_max_multiplexed_append_entries());
+}
+
 group_manager::group_manager(
   model::node_id self,
   model::timeout_clock::duration disk_timeout,
@@ -25,22 +37,31 @@ group_manager::group_manager(
   ss::sharded<storage::api>& storage)
   : _self(self)
   , _disk_timeout(disk_timeout)
-  , _client(make_rpc_client_protocol(self, clients))
+  , _client(make_client_protocol(self, clients))
   , _heartbeats(heartbeat_interval, _client, _self, heartbeat_timeout)
-  , _storage(storage.local()) {
+  , _storage(storage.local())
+  , _recovery_throttle(
+      config::shard_local_cfg().raft_recovery_throughput_bytes()
+      / ss::smp::count) {
     setup_metrics();
 }
 
-ss::future<> group_manager::start() { return _heartbeats.start(); }
+ss::future<> group_manager::start() {
+    return _recovery_throttle.start().then(
+      [this] { return _heartbeats.start(); });
+}
 
 ss::future<> group_manager::stop() {
     return _gate.close()
       .then([this] { return _heartbeats.stop(); })
+      // wake up recoveries waiting for tokens so that the groups can stop
+      .then([this] { return _recovery_throttle.stop(); })
       .then([this] {
           return ss::parallel_for_each(
             _groups,
             [](ss::lw_shared_ptr<consensus> raft) { return raft->stop(); });
-      });
+      })
+      .then([this] { return _client.stop(); });
 }
 
 ss::future<ss::lw_shared_ptr<raft::consensus>> group_manager::create_group(
@@ -59,7 +80,8 @@ ss::future<ss::lw_shared_ptr<raft::consensus>> group_manager::create_group(
       [this](raft::leadership_status st) {
           trigger_leadership_notification(std::move(st));
       },
-      _storage);
+      _storage,
+      _recovery_throttle);
 
     return ss::with_gate(_gate, [this, raft] {
         return _heartbeats.register_group(raft).then([this, raft] {
@@ -80,6 +102,16 @@ ss::future<> group_manager::remove(ss::lw_shared_ptr<raft::consensus> c) {
       });
 }
 
+ss::future<> group_manager::shutdown(ss::lw_shared_ptr<raft::consensus> c) {
+    return c->stop()
+      .then(
+        [this, id = c->group()] { return _heartbeats.deregister_group(id); })
+      .finally([this, c] {
+          _groups.erase(
+            std::remove(_groups.begin(), _groups.end(), c), _groups.end());
+      });
+}
+
 void group_manager::trigger_leadership_notification(
   raft::leadership_status st) {
     for (auto& cb : _notifications) {
@@ -14,6 +14,7 @@
 #include "model/metadata.h"
 #include "raft/consensus_client_protocol.h"
 #include "raft/heartbeat_manager.h"
+#include "raft/recovery_throttle.h"
 #include "raft/rpc_client_protocol.h"
 #include "raft/types.h"
 #include "storage/fwd.h"
@@ -50,6 +51,10 @@ public:
 
     ss::future<> remove(ss::lw_shared_ptr<raft::consensus>);
 
+    /// \brief stops the group and forgets about it, unlike remove the state
+    /// persisted by the group is kept
+    ss::future<> shutdown(ss::lw_shared_ptr<raft::consensus>);
+
     cluster::notification_id_type
     register_leadership_notification(leader_cb_t cb) {
         auto id = _notification_id++;
@@ -88,6 +93,7 @@ private:
       _notifications;
     ss::metrics::metric_groups _metrics;
     storage::api& _storage;
+    recovery_throttle _recovery_throttle;
 };
 
 } // namespace raft
@@ -35,11 +35,17 @@ ss::logger hbeatlog{"r/heartbeat"};
 using consensus_ptr = heartbeat_manager::consensus_ptr;
 using consensus_set = heartbeat_manager::consensus_set;
 
+struct pending_beat {
+    heartbeat_metadata hb;
+    follower_req_seq seq;
+    bool idle;
+};
+
 static std::vector<heartbeat_manager::node_heartbeat> requests_for_range(
-  const consensus_set& c, clock_type::duration heartbeat_interval) {
-    absl::flat_hash_map<
-      model::node_id,
-      std::vector<std::pair<heartbeat_metadata, follower_req_seq>>>
+  const consensus_set& c,
+  clock_type::duration heartbeat_interval,
+  bool idle_heartbeats) {
+    absl::flat_hash_map<model::node_id, std::vector<pending_beat>>
       pending_beats;
     if (c.empty()) {
         return {};
@@ -52,14 +58,17 @@ static std::vector<heartbeat_manager::node_heartbeat> requests_for_range(
 
         auto maybe_create_follower_request = [ptr,
                                               last_heartbeat,
+                                              idle_heartbeats,
                                               &pending_beats](
                                                const vnode& rni) mutable {
             // special case self beat
             // self beat is used to make sure that the protocol will make
             // progress when there is only on node
             if (rni == ptr->self()) {
-                pending_beats[rni.id()].emplace_back(
-                  heartbeat_metadata{ptr->meta(), rni}, 0);
+                pending_beats[rni.id()].push_back(pending_beat{
+                  .hb = heartbeat_metadata{ptr->meta(), rni},
+                  .seq = follower_req_seq(0),
+                  .idle = false});
                 return;
             }
 
@@ -84,8 +93,17 @@ static std::vector<heartbeat_manager::node_heartbeat> requests_for_range(
             auto seq_id = ptr->next_follower_sequence(rni);
             ptr->update_suppress_heartbeats(
               rni, seq_id, heartbeats_suppressed::yes);
-            pending_beats[rni.id()].emplace_back(
-              heartbeat_metadata{ptr->meta(), ptr->self(), rni}, seq_id);
+            auto meta = ptr->meta();
+            // nothing changed since the last heartbeat the follower
+            // acknowledged, it only has to repeat it
+            bool idle = idle_heartbeats && ptr->is_heartbeat_idle(rni, meta);
+            if (idle_heartbeats && !idle) {
+                ptr->update_last_heartbeat_meta(rni, meta);
+            }
+            pending_beats[rni.id()].push_back(pending_beat{
+              .hb = heartbeat_metadata{meta, ptr->self(), rni},
+              .seq = seq_id,
+              .idle = idle});
         };
 
         auto group = ptr->config();
@@ -103,15 +121,23 @@ static std::vector<heartbeat_manager::node_heartbeat> requests_for_range(
           meta_map;
         requests.reserve(p.second.size());
         meta_map.reserve(p.second.size());
-        for (auto& [hb, seq] : p.second) {
+        std::vector<idle_heartbeat_metadata> idle_requests;
+        for (auto& [hb, seq, idle] : p.second) {
             meta_map.emplace(
               hb.meta.group,
               heartbeat_manager::follower_request_meta{
                 seq, hb.meta.prev_log_index, hb.target_node_id});
+            if (idle) {
+                idle_requests.push_back(
+                  idle_heartbeat_metadata{hb.meta.group, hb.meta.term});
+                continue;
+            }
             requests.push_back(std::move(hb));
         }
         reqs.emplace_back(
-          p.first, heartbeat_request{std::move(requests)}, std::move(meta_map));
+          p.first,
+          heartbeat_request{std::move(requests), std::move(idle_requests)},
+          std::move(meta_map));
     }
 
     return reqs;
@@ -125,7 +151,8 @@ heartbeat_manager::heartbeat_manager(
   : _heartbeat_interval(interval)
   , _heartbeat_timeout(heartbeat_timeout)
   , _client_protocol(std::move(proto))
-  , _self(self) {
+  , _self(self)
+  , _idle_heartbeats(config::shard_local_cfg().raft_idle_heartbeats()) {
     _heartbeat_timer.set_callback([this] { dispatch_heartbeats(); });
 }
 
@@ -149,7 +176,8 @@ heartbeat_manager::send_heartbeats(std::vector<node_heartbeat> reqs) {
 }
 
 ss::future<> heartbeat_manager::do_dispatch_heartbeats() {
-    auto reqs = requests_for_range(_consensus_groups, _heartbeat_interval);
+    auto reqs = requests_for_range(
+      _consensus_groups, _heartbeat_interval, _idle_heartbeats);
     return send_heartbeats(std::move(reqs));
 }
 
@@ -215,6 +243,8 @@ void heartbeat_manager::process_reply(
             }
             (*it)->update_suppress_heartbeats(
               req_meta.follower_vnode, req_meta.seq, heartbeats_suppressed::no);
+            (*it)->update_last_heartbeat_meta(
+              req_meta.follower_vnode, std::nullopt);
             // propagate error
             (*it)->process_append_entries_reply(
               n,
@@ -235,6 +265,11 @@ void heartbeat_manager::process_reply(
         auto meta = groups.find(m.group)->second;
         (*it)->update_suppress_heartbeats(
           meta.follower_vnode, meta.seq, heartbeats_suppressed::no);
+        if (m.result != append_entries_reply::status::success) {
+            // next heartbeat has to carry the full metadata
+            (*it)->update_last_heartbeat_meta(
+              meta.follower_vnode, std::nullopt);
+        }
         (*it)->process_append_entries_reply(
           n,
           result<append_entries_reply>(std::move(m)),
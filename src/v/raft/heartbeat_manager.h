@@ -82,6 +82,11 @@ extern ss::logger hbeatlog;
  *
  *    heartbeat({L0, L1}) -> {F0, F1}(node-b)
  *    heartbeat({L0, L1}) -> {F0, F1}(node-c)
+ *
+ * Groups that sent an append entries request within the heartbeat interval
+ * are skipped. With idle heartbeats enabled, a group whose metadata did not
+ * change since the follower acknowledged its last heartbeat is only sent as
+ * group id and term, the follower repeats the previous heartbeat for it.
  */
 class heartbeat_manager {
 public:
@@ -161,5 +166,8 @@ private:
     consensus_set _consensus_groups;
     consensus_client_protocol _client_protocol;
     model::node_id _self;
+    /// send idle heartbeats for groups that did not change since the last
+    /// acknowledged heartbeat
+    bool _idle_heartbeats;
 };
 } // namespace raft
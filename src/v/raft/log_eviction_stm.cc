@@ -9,34 +9,111 @@
 
 #include "raft/log_eviction_stm.h"
 
+#include "model/record_batch_reader.h"
 #include "raft/consensus.h"
+#include "raft/errc.h"
 #include "raft/types.h"
+#include "reflection/adl.h"
+#include "storage/record_batch_builder.h"
 
 #include <seastar/core/future-util.hh>
 
 namespace raft {
 
+static model::record_batch_reader make_prefix_truncate_batch(
+  model::offset start_offset) {
+    storage::record_batch_builder builder(
+      log_eviction_stm::prefix_truncate_batch_type, model::offset(0));
+    builder.add_raw_kv(iobuf(), reflection::to_iobuf(start_offset));
+    return model::make_memory_record_batch_reader(std::move(builder).build());
+}
+
 log_eviction_stm::log_eviction_stm(
   consensus* raft,
   ss::logger& logger,
   ss::lw_shared_ptr<storage::stm_manager> stm_manager,
   ss::abort_source& as)
-  : _raft(raft)
+  : state_machine(raft, logger, ss::default_priority_class())
+  , _raft(raft)
   , _logger(logger)
   , _stm_manager(std::move(stm_manager))
-  , _as(as) {}
+  , _as(as) {
+    set_batch_type_filter(prefix_truncate_batch_type);
+}
 
 ss::future<> log_eviction_stm::start() {
+    // the markers below the start of the log were applied, the range up to
+    // the last applied offset doesn't have to be read again
+    set_next(std::max(
+      _raft->start_offset(), bootstrap_last_applied() + model::offset(1)));
     monitor_log_eviction();
-    return ss::now();
+    return state_machine::start();
 }
 
-ss::future<> log_eviction_stm::stop() { return _gate.close(); }
+ss::future<> log_eviction_stm::stop() {
+    return _eviction_gate.close()
+      .then([this] { return state_machine::stop(); })
+      .then([this] {
+          auto last_applied = last_applied_offset();
+          if (last_applied <= bootstrap_last_applied()) {
+              return ss::now();
+          }
+          return write_last_applied(last_applied);
+      });
+}
+
+ss::future<result<model::offset>> log_eviction_stm::prefix_truncate(
+  model::offset start_offset, model::timeout_clock::time_point deadline) {
+    using ret_t = result<model::offset>;
+    return _raft
+      ->replicate(
+        make_prefix_truncate_batch(start_offset),
+        replicate_options(consistency_level::quorum_ack))
+      .then([this, deadline](result<replicate_result> r) {
+          if (!r) {
+              return ss::make_ready_future<ret_t>(r.error());
+          }
+          return wait(r.value().last_offset, deadline)
+            .then([this] { return ret_t(_raft->start_offset()); })
+            .handle_exception_type([](const offset_monitor::wait_aborted&) {
+                return ret_t(errc::timeout);
+            });
+      });
+}
+
+ss::future<> log_eviction_stm::apply(model::record_batch b) {
+    auto last_offset = b.last_offset();
+    auto records = b.copy_records();
+    auto start_offset = reflection::adl<model::offset>{}.from(
+      records.begin()->release_value());
+    vlog(
+      _logger.trace,
+      "Applying prefix truncation to offset {} at {}",
+      start_offset,
+      last_offset);
+    // replayed markers were already applied
+    if (start_offset <= _raft->start_offset()) {
+        return ss::now();
+    }
+    auto last_included = start_offset - model::offset(1);
+    auto f = ss::now();
+    if (_stm_manager) {
+        f = _stm_manager->ensure_snapshot_exists(last_included);
+    }
+    return f
+      .then([this, last_included] {
+          return _raft->write_snapshot(write_snapshot_cfg(
+            last_included,
+            iobuf(),
+            write_snapshot_cfg::should_prefix_truncate::yes));
+      })
+      .then([this, last_offset] { return write_last_applied(last_offset); });
+}
 
 void log_eviction_stm::monitor_log_eviction() {
-    (void)ss::with_gate(_gate, [this] {
+    (void)ss::with_gate(_eviction_gate, [this] {
         return ss::do_until(
-          [this] { return _gate.is_closed(); },
+          [this] { return _eviction_gate.is_closed(); },
           [this] {
               return _raft->monitor_log_eviction(_as)
                 .then([this](model::offset last_evicted) {
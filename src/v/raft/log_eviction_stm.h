@@ -12,6 +12,9 @@
 #pragma once
 #include "config/configuration.h"
 #include "model/fundamental.h"
+#include "model/record.h"
+#include "model/timeout_clock.h"
+#include "raft/state_machine.h"
 #include "seastarx.h"
 #include "storage/types.h"
 
@@ -25,21 +28,38 @@ class consensus;
 
 /**
  * Responsible for taking snapshots triggered by underlying log segments
- * eviction
+ * eviction and for the prefix truncations requested by the clients.
+ *
+ * A prefix truncation is replicated as a marker batch carrying the new start
+ * offset of the log. Every replica applies the marker by writing a snapshot
+ * at the offset before the new start, which truncates the prefix of the log.
+ * Only the markers are read by the state machine, the other batches are
+ * skipped.
  */
-class log_eviction_stm {
+class log_eviction_stm final : public state_machine {
 public:
+    static constexpr model::record_batch_type prefix_truncate_batch_type{14};
+
     log_eviction_stm(
       consensus*,
       ss::logger&,
       ss::lw_shared_ptr<storage::stm_manager>,
       ss::abort_source&);
 
-    ss::future<> start();
+    ss::future<> start() final;
 
     ss::future<> stop();
 
+    /**
+     * Replicates a marker moving the start of the log to the given offset and
+     * waits until it is applied locally. Returns the start offset of the log
+     * once the marker is applied.
+     */
+    ss::future<result<model::offset>>
+      prefix_truncate(model::offset, model::timeout_clock::time_point);
+
 private:
+    ss::future<> apply(model::record_batch) final;
     ss::future<> handle_deletion_notification(model::offset);
     void monitor_log_eviction();
 
@@ -47,7 +67,7 @@ private:
     ss::logger& _logger;
     ss::lw_shared_ptr<storage::stm_manager> _stm_manager;
     ss::abort_source& _as;
-    ss::gate _gate;
+    ss::gate _eviction_gate;
     model::offset _previous_eviction_offset;
 };
 
@@ -23,6 +23,7 @@
 #include "utils/mutex.h"
 #include "vassert.h"
 
+#include <seastar/core/coroutine.hh>
 #include <seastar/core/semaphore.hh>
 #include <seastar/core/shared_ptr.hh>
 #include <seastar/util/bool_class.hh>
@@ -32,7 +33,10 @@
 
 #include <optional>
 #include <system_error>
+#include <type_traits>
+#include <utility>
 #include <variant>
+#include <vector>
 
 namespace raft {
 
@@ -48,6 +52,20 @@ CONCEPT(
 )
 // clang-format on
 
+// A state may also apply a run of consecutive batches in one pass, returning
+// the result of each of them:
+//
+//   ss::future<std::vector<std::error_code>>
+//     apply_update(std::vector<model::record_batch>);
+template<typename T, typename = void>
+struct has_batched_apply_update : std::false_type {};
+
+template<typename T>
+struct has_batched_apply_update<
+  T,
+  std::void_t<decltype(std::declval<T&>().apply_update(
+    std::declval<std::vector<model::record_batch>>()))>> : std::true_type {};
+
 using persistent_last_applied
   = ss::bool_class<struct persistent_last_applied_tag>;
 
@@ -63,6 +81,10 @@ using persistent_last_applied
 // state. Thanks to this approach it is easy to implement the optimistic
 // locking concurrency control in state.
 //
+// The batches read from the log are handed to the states a slice at a time,
+// each run of consecutive batches of the same state is applied together and
+// the replicate callers of the whole slice are notified at once.
+//
 // IMPORTANT: is_batch_applicable results have to be mutually exclusive. i.e.
 // when batch is applicable for one state is has to be not applicable for
 // another
@@ -120,15 +142,23 @@ public:
       model::timeout_clock::time_point timeout,
       ss::abort_source& as);
 
+protected:
+    ss::future<> apply(model::record_batch b) final;
+    ss::future<> apply_batches(model::record_batch_reader::data_t) final;
+
 private:
+    using variant_t = std::variant<T*...>;
+    using results_t = std::vector<std::pair<model::offset, std::error_code>>;
+
+    std::optional<variant_t> find_state(const model::record_batch&);
+    ss::future<> notify(results_t);
+
     using promise_t = expiring_promise<std::error_code>;
     // promises used to wait for result of state applies, keyed by offser
     // returned in replication result (i.e. last batch end offset)
     using container_t
       = absl::node_hash_map<model::offset, expiring_promise<std::error_code>>;
 
-    ss::future<> apply(model::record_batch b) final;
-
     container_t _promises;
 
     /*
@@ -247,19 +277,103 @@ is_batch_applicable(State& s, const model::record_batch& batch) {
     return std::nullopt;
 }
 
+template<typename... T>
+CONCEPT(requires(State<T>, ...))
+std::optional<typename mux_state_machine<T...>::variant_t>
+mux_state_machine<T...>::find_state(const model::record_batch& b) {
+    return std::apply(
+      [&b](T&... st) {
+          std::optional<variant_t> res;
+          (void)((res = is_batch_applicable(st, b), res) || ...);
+          return res;
+      },
+      _state);
+}
+
+template<typename State>
+static ss::future<std::vector<std::error_code>>
+apply_updates(State& state, std::vector<model::record_batch> batches) {
+    if constexpr (has_batched_apply_update<State>::value) {
+        auto size = batches.size();
+        auto results = co_await state.apply_update(std::move(batches));
+        vassert(
+          results.size() == size,
+          "State returned {} results for {} batches",
+          results.size(),
+          size);
+        co_return results;
+    } else {
+        std::vector<std::error_code> results;
+        results.reserve(batches.size());
+        for (auto& b : batches) {
+            results.push_back(co_await state.apply_update(std::move(b)));
+        }
+        co_return results;
+    }
+}
+
+template<typename... T>
+CONCEPT(requires(State<T>, ...))
+ss::future<> mux_state_machine<T...>::notify(results_t results) {
+    auto last_offset = results.back().first;
+    co_await _mutex.with([this, &results] {
+        for (auto& [offset, ec] : results) {
+            if (auto it = _promises.find(offset); it != _promises.end()) {
+                it->second.set_value(ec);
+            }
+        }
+    });
+    if (_persist_last_applied) {
+        co_await write_last_applied(last_offset);
+    }
+}
+
+template<typename... T>
+CONCEPT(requires(State<T>, ...))
+ss::future<> mux_state_machine<T...>::apply_batches(
+  model::record_batch_reader::data_t batches) {
+    auto holder = _gate.hold();
+    results_t results;
+    results.reserve(batches.size());
+    while (!batches.empty()) {
+        auto state = find_state(batches.front());
+        // the run of consecutive batches of the same state
+        std::vector<model::record_batch> run;
+        std::vector<model::offset> offsets;
+        do {
+            offsets.push_back(batches.front().last_offset());
+            run.push_back(std::move(batches.front()));
+            batches.pop_front();
+        } while (!batches.empty() && find_state(batches.front()) == state);
+
+        if (!state) {
+            for (const auto& b : run) {
+                vassert(
+                  b.header().type == state_machine::checkpoint_batch_type
+                    || b.header().type == raft::configuration_batch_type,
+                  "State handler for batch of type: {} not found",
+                  b.header().type);
+            }
+            continue;
+        }
+        auto ecs = co_await std::visit(
+          [&run](auto* s) { return apply_updates(*s, std::move(run)); },
+          *state);
+        for (size_t i = 0; i < ecs.size(); ++i) {
+            results.emplace_back(offsets[i], ecs[i]);
+        }
+    }
+    if (!results.empty()) {
+        co_await notify(std::move(results));
+    }
+}
+
 template<typename... T>
 CONCEPT(requires(State<T>, ...))
 ss::future<> mux_state_machine<T...>::apply(model::record_batch b) {
     return ss::with_gate(_gate, [this, b = std::move(b)]() mutable {
         // lookup for the state to apply the update
-        auto state = std::apply(
-          [&b](T&... st) {
-              using variant_t = std::variant<T*...>;
-              std::optional<variant_t> res;
-              (void)((res = is_batch_applicable(st, b), res) || ...);
-              return res;
-          },
-          _state);
+        auto state = find_state(b);
 
         // applicable state not found
         if (!state) {
@@ -280,17 +394,7 @@ ss::future<> mux_state_machine<T...>::apply(model::record_batch b) {
           *state);
 
         return result_f.then([this, last_offset](std::error_code ec) {
-            auto f = _mutex.with([this, last_offset, ec] {
-                if (auto it = _promises.find(last_offset);
-                    it != _promises.end()) {
-                    it->second.set_value(ec);
-                }
-            });
-            if (!_persist_last_applied) {
-                return f;
-            }
-            return f.then(
-              [this, last_offset] { return write_last_applied(last_offset); });
+            return notify(results_t{{last_offset, ec}});
         });
     });
 }
@@ -13,13 +13,29 @@
 
 #include <seastar/core/future-util.hh>
 
+#include <algorithm>
+
 namespace raft {
 
+static constexpr auto later_deadline = [](const auto& a, const auto& b) {
+    return a.at > b.at;
+};
+
+offset_monitor::offset_monitor() {
+    _timer.set_callback([this] { handle_timeouts(); });
+}
+
 void offset_monitor::stop() {
-    for (auto& waiter : _waiters) {
-        waiter.second->done.set_exception(wait_aborted());
+    _timer.cancel();
+    for (auto& e : _waiters) {
+        if (!e.w->completed) {
+            e.w->completed = true;
+            e.w->done.set_exception(wait_aborted());
+        }
     }
     _waiters.clear();
+    _deadlines.clear();
+    _pending = 0;
 }
 
 ss::future<> offset_monitor::wait(
@@ -30,64 +46,119 @@ ss::future<> offset_monitor::wait(
     if (offset <= _last_applied) {
         return ss::now();
     }
-    auto w = std::make_unique<waiter>(this, timeout, as);
+    auto w = ss::make_lw_shared<waiter>();
+    w->deadline = timeout;
+    if (as) {
+        auto opt_sub = as->get().subscribe(
+          [this, w = w.get()]() noexcept { abort(*w); });
+        if (!opt_sub) {
+            // abort has already been requested, skip adding as a waiter
+            return ss::make_exception_future<>(wait_aborted());
+        }
+        w->sub = std::move(*opt_sub);
+    }
     auto f = w->done.get_future();
-    if (!f.available()) {
-        // the future may already be available, for example if an abort had
-        // already be requested. in that case, skip adding as a waiter.
-        _waiters.emplace(offset, std::move(w));
+    if (timeout != model::no_timeout) {
+        _deadlines.push_back(deadline{.at = timeout, .w = w});
+        std::push_heap(_deadlines.begin(), _deadlines.end(), later_deadline);
+        if (_deadlines.front().w == w) {
+            arm_timer();
+        }
     }
+    // offsets are mostly waited for in increasing order
+    if (_waiters.empty() || _waiters.back().offset <= offset) {
+        _waiters.push_back(entry{.offset = offset, .w = std::move(w)});
+    } else {
+        auto it = std::upper_bound(
+          _waiters.begin(),
+          _waiters.end(),
+          offset,
+          [](model::offset o, const entry& e) { return o < e.offset; });
+        _waiters.insert(it, entry{.offset = offset, .w = std::move(w)});
+    }
+    ++_pending;
     return f;
 }
 
 void offset_monitor::notify(model::offset offset) {
     _last_applied = std::max(offset, _last_applied);
 
-    while (true) {
-        auto it = _waiters.begin();
-        if (it == _waiters.end() || offset < it->first) {
-            return;
+    auto end = std::upper_bound(
+      _waiters.begin(),
+      _waiters.end(),
+      offset,
+      [](model::offset o, const entry& e) { return o < e.offset; });
+    if (end == _waiters.begin()) {
+        return;
+    }
+    for (auto it = _waiters.begin(); it != end; ++it) {
+        if (!it->w->completed) {
+            it->w->completed = true;
+            it->w->done.set_value();
+            it->w->sub = {};
+            --_pending;
         }
-        it->second->done.set_value();
-        // when the waiter is destroyed here by erase, then if they are active,
-        // the timer is cancelled and the abort source subscription is removed.
-        _waiters.erase(it);
     }
+    // when the waiters are destroyed here by erase, the abort source
+    // subscriptions are removed. their deadlines are dropped from the heap
+    // once they expire or the heap is compacted.
+    _waiters.erase(_waiters.begin(), end);
+    maybe_compact();
 }
 
-offset_monitor::waiter::waiter(
-  offset_monitor* mon,
-  model::timeout_clock::time_point timeout,
-  std::optional<std::reference_wrapper<ss::abort_source>> as)
-  : mon(mon) {
-    if (as) {
-        auto opt_sub = as->get().subscribe(
-          [this]() noexcept { handle_abort(); });
-        if (opt_sub) {
-            sub = std::move(*opt_sub);
-        } else {
-            done.set_exception(wait_aborted());
-            return;
-        }
+void offset_monitor::abort(waiter& w) {
+    if (w.completed) {
+        return;
     }
-    if (timeout != model::no_timeout) {
-        timer.set_callback([this] { handle_abort(); });
-        timer.arm(timeout);
+    w.completed = true;
+    w.done.set_exception(wait_aborted());
+    --_pending;
+}
+
+void offset_monitor::handle_timeouts() {
+    auto now = model::timeout_clock::now();
+    while (!_deadlines.empty() && _deadlines.front().at <= now) {
+        std::pop_heap(_deadlines.begin(), _deadlines.end(), later_deadline);
+        auto w = std::move(_deadlines.back().w);
+        _deadlines.pop_back();
+        abort(*w);
     }
+    maybe_compact();
+    arm_timer();
 }
 
-void offset_monitor::waiter::handle_abort() {
-    done.set_exception(wait_aborted());
-    auto it = std::find_if(
-      mon->_waiters.begin(),
-      mon->_waiters.end(),
-      [this](const waiters_type::value_type& w) {
-          return w.second.get() == this;
-      });
-    vassert(it != mon->_waiters.end(), "waiter not found");
-    // when the waiter is destroyed here by erase, then if they are active,
-    // the timer is cancelled and the abort source subscription is removed.
-    mon->_waiters.erase(it); // *this is no longer valid after erase
+void offset_monitor::arm_timer() {
+    // skip deadlines of waiters that are already done
+    while (!_deadlines.empty() && _deadlines.front().w->completed) {
+        std::pop_heap(_deadlines.begin(), _deadlines.end(), later_deadline);
+        _deadlines.pop_back();
+    }
+    if (_deadlines.empty()) {
+        _timer.cancel();
+        return;
+    }
+    auto next = _deadlines.front().at;
+    if (!_timer.armed() || _timer.get_timeout() != next) {
+        _timer.rearm(next);
+    }
+}
+
+// must not be called from an abort source callback, it destroys
+// subscriptions of other waiters
+void offset_monitor::maybe_compact() {
+    // keep the memory held by completed waiters proportional to live ones
+    static constexpr size_t min_compaction_size = 64;
+    if (
+      _waiters.size() > min_compaction_size && _waiters.size() > 2 * _pending) {
+        std::erase_if(_waiters, [](const entry& e) { return e.w->completed; });
+    }
+    if (
+      _deadlines.size() > min_compaction_size
+      && _deadlines.size() > 2 * _pending) {
+        std::erase_if(
+          _deadlines, [](const deadline& d) { return d.w->completed; });
+        std::make_heap(_deadlines.begin(), _deadlines.end(), later_deadline);
+    }
 }
 
 } // namespace raft
@@ -16,9 +16,11 @@
 
 #include <seastar/core/abort_source.hh>
 #include <seastar/core/future.hh>
+#include <seastar/core/shared_ptr.hh>
 #include <seastar/core/timer.hh>
 
-#include <absl/container/btree_map.h>
+#include <deque>
+#include <vector>
 
 namespace raft {
 
@@ -28,6 +30,11 @@ namespace raft {
  * Utility for manging waiters based on a threshold offset. Supports multiple
  * waiters on the same offset, as well as timeout and abort source methods of
  * aborting a wait.
+ *
+ * Waiters are kept in an array sorted by offset, a notification completes
+ * the whole prefix of satisfied waiters in one sweep. All the timeouts share
+ * a single timer armed at the earliest deadline. Aborted and timed out
+ * waiters are only marked as completed and dropped from the array lazily.
  */
 class offset_monitor {
 public:
@@ -42,6 +49,8 @@ public:
         }
     };
 
+    offset_monitor();
+
     /**
      * Exisiting waiters receive wait_aborted exception.
      */
@@ -59,7 +68,7 @@ public:
     /**
      * Returns true if there are no waiters.
      */
-    bool empty() const { return _waiters.empty(); }
+    bool empty() const { return _pending == 0; }
 
     /**
      * Notify waiters of an offset.
@@ -68,25 +77,35 @@ public:
 
 private:
     struct waiter {
-        offset_monitor* mon;
         ss::promise<> done;
-        ss::timer<model::timeout_clock> timer;
+        model::timeout_clock::time_point deadline;
         ss::abort_source::subscription sub;
+        bool completed = false;
+    };
 
-        waiter(
-          offset_monitor*,
-          model::timeout_clock::time_point,
-          std::optional<std::reference_wrapper<ss::abort_source>>);
+    using waiter_ptr = ss::lw_shared_ptr<waiter>;
 
-        void handle_abort();
+    struct entry {
+        model::offset offset;
+        waiter_ptr w;
     };
 
-    friend waiter;
-
-    using waiters_type
-      = absl::btree_multimap<model::offset, std::unique_ptr<waiter>>;
+    struct deadline {
+        model::timeout_clock::time_point at;
+        waiter_ptr w;
+    };
 
-    waiters_type _waiters;
+    void abort(waiter&);
+    void handle_timeouts();
+    void arm_timer();
+    void maybe_compact();
+
+    // sorted by offset, entries of the same offset in order of arrival
+    std::deque<entry> _waiters;
+    // min heap of deadlines of waiters
+    std::vector<deadline> _deadlines;
+    ss::timer<model::timeout_clock> _timer;
+    size_t _pending = 0;
     model::offset _last_applied;
 };
 
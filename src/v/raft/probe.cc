@@ -79,6 +79,59 @@ void probe::setup_metrics(const model::ntp& ntp) {
          [this] { return _log_flushes; },
          sm::description("Number of log flushes"),
          labels),
+       sm::make_derive(
+         "log_flush_time_us",
+         [this] {
+             return std::chrono::duration_cast<std::chrono::microseconds>(
+                      _log_flush_time)
+               .count();
+         },
+         sm::description("Total time spent flushing the log"),
+         labels),
+       sm::make_derive(
+         "follower_append_requests",
+         [this] { return _follower_appends; },
+         sm::description(
+           "Number of append requests sent to followers when replicating"),
+         labels),
+       sm::make_derive(
+         "follower_append_time_us",
+         [this] {
+             return std::chrono::duration_cast<std::chrono::microseconds>(
+                      _follower_append_time)
+               .count();
+         },
+         sm::description(
+           "Total round trip time of append requests sent to followers when "
+           "replicating"),
+         labels),
+       sm::make_histogram(
+         "append_entries_merged_per_flush",
+         [this] { return _append_entries_merged.seastar_histogram_logform(); },
+         sm::description(
+           "Number of append entries requests a follower appended with a "
+           "single flush"),
+         labels),
+       sm::make_histogram(
+         "append_entries_hold_us",
+         [this] { return _append_entries_hold.seastar_histogram_logform(); },
+         sm::description(
+           "Delay added by a follower to merge append entries requests"),
+         labels),
+       sm::make_histogram(
+         "replicate_batch_items_per_flush",
+         [this] { return _replicate_batch_items.seastar_histogram_logform(); },
+         sm::description(
+           "Number of replicate requests a leader appended together"),
+         labels),
+       sm::make_histogram(
+         "replicate_batch_linger_us",
+         [this] {
+             return _replicate_batch_linger.seastar_histogram_logform();
+         },
+         sm::description(
+           "Delay added by a leader to merge replicate requests"),
+         labels),
        sm::make_derive(
          "log_truncations",
          [this] { return _log_truncations; },
@@ -11,10 +11,13 @@
 
 #pragma once
 #include "model/fundamental.h"
+#include "utils/hdr_hist.h"
+#include "utils/stage_latency.h"
 
 #include <seastar/core/metrics.hh>
 #include <seastar/core/metrics_registration.hh>
 
+#include <chrono>
 #include <cstdint>
 namespace raft {
 class probe {
@@ -32,7 +35,35 @@ public:
     void log_truncated() { ++_log_truncations; }
     void log_flushed() { ++_log_flushes; }
 
+    void log_flush_done(std::chrono::steady_clock::duration d) {
+        _log_flush_time += d;
+        stage_latencies().record(request_stage::local_flush, d);
+    }
+    /// round trip of an append entries request sent by the leader while
+    /// replicating, the leader flush runs in parallel to it
+    void follower_append_done(std::chrono::steady_clock::duration d) {
+        ++_follower_appends;
+        _follower_append_time += d;
+        stage_latencies().record(request_stage::follower_ack, d);
+    }
+
+    /// follower flushed appends of the given number of append entries
+    /// requests after holding them for the given time
+    void append_entries_buffer_flushed(
+      size_t requests, std::chrono::microseconds hold) {
+        _append_entries_merged.record(requests);
+        _append_entries_hold.record(hold.count());
+    }
+
     void replicate_batch_flushed() { ++_replicate_batch_flushed; }
+
+    /// leader appended the given number of replicate requests together after
+    /// lingering for the given time
+    void
+    replicate_batch_merged(size_t items, std::chrono::microseconds linger) {
+        _replicate_batch_items.record(items);
+        _replicate_batch_linger.record(linger.count());
+    }
     void recovery_append_request() { ++_recovery_requests; }
     void configuration_update() { ++_configuration_updates; }
 
@@ -57,6 +88,14 @@ private:
     uint64_t _replicate_requests_done = 0;
     uint64_t _log_flushes = 0;
     uint64_t _replicate_batch_flushed = 0;
+    uint64_t _follower_appends = 0;
+    std::chrono::steady_clock::duration _log_flush_time{0};
+    std::chrono::steady_clock::duration _follower_append_time{0};
+    // low precision, there is one of each per partition
+    hdr_hist _append_entries_merged{1024, 1, 1};
+    hdr_hist _append_entries_hold{100000, 1, 1};
+    hdr_hist _replicate_batch_items{1024, 1, 1};
+    hdr_hist _replicate_batch_linger{100000, 1, 1};
     uint32_t _log_truncations = 0;
     uint32_t _configuration_updates = 0;
     uint64_t _recovery_requests = 0;
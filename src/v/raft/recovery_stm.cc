@@ -9,6 +9,7 @@
 
 #include "raft/recovery_stm.h"
 
+#include "config/configuration.h"
 #include "model/fundamental.h"
 #include "model/record_batch_reader.h"
 #include "outcome_future_utils.h"
@@ -18,7 +19,10 @@
 #include "raft/logger.h"
 #include "raft/raftgen_service.h"
 
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/fstream.hh>
 #include <seastar/core/future-util.hh>
+#include <seastar/core/seastar.hh>
 
 #include <chrono>
 
@@ -31,7 +35,11 @@ recovery_stm::recovery_stm(
   , _node_id(node_id)
   , _term(_ptr->term())
   , _prio(prio)
-  , _ctxlog(_ptr->_ctxlog) {}
+  , _ctxlog(_ptr->_ctxlog)
+  , _max_inflight_requests(std::max<size_t>(
+      config::shard_local_cfg().raft_recovery_max_inflight_requests(), 1))
+  , _max_inflight_bytes(
+      config::shard_local_cfg().raft_recovery_max_inflight_bytes()) {}
 
 ss::future<> recovery_stm::do_recover() {
     // We have to send all the records that leader have, event those that are
@@ -99,11 +107,17 @@ ss::future<> recovery_stm::do_recover() {
 
     // read & replicate log entries
     return f
-      .then([this, follower_next_offset, follower_committed_match_index] {
-          return read_range_for_recovery(
-            follower_next_offset,
-            _ptr->_log.offsets().dirty_offset,
-            follower_committed_match_index);
+      .then([this, follower_next_offset] {
+          return maybe_ship_segment(follower_next_offset);
+      })
+      .then([this, follower_next_offset, follower_committed_match_index](
+              bool shipped) {
+          if (shipped) {
+              // follower next index moved past the segment
+              return ss::now();
+          }
+          return replicate_window(
+            follower_next_offset, follower_committed_match_index);
       })
       .then([this] {
           auto meta = get_follower_meta();
@@ -160,18 +174,88 @@ recovery_stm::should_flush(model::offset follower_committed_match_index) const {
       && (follower_has_batches_to_commit || last_replicate_with_quorum));
 }
 
-ss::future<> recovery_stm::read_range_for_recovery(
-  model::offset start_offset,
-  model::offset end_offset,
-  model::offset follower_committed_match_index) {
+ss::future<> recovery_stm::throttle(size_t bytes) {
+    // the target of a leadership transfer catches up at full speed, the
+    // writes of the group wait for it
+    if (_ptr->_transfer_target == _node_id) {
+        return ss::now();
+    }
+    return _ptr->_recovery_throttle.throttle(bytes);
+}
+
+bool recovery_stm::is_window_full() const {
+    return _inflight.size() >= _max_inflight_requests
+           || _inflight_bytes >= _max_inflight_bytes;
+}
+
+ss::future<> recovery_stm::replicate_window(
+  model::offset next_offset, model::offset follower_committed_match_index) {
+    _window_failed = false;
+    std::exception_ptr e;
+    try {
+        while (!_stop_requested && !_window_failed && _term == _ptr->term()
+               && _ptr->is_leader()) {
+            auto dirty_offset = _ptr->_log.offsets().dirty_offset;
+            if (next_offset > dirty_offset) {
+                break;
+            }
+            if (is_window_full()) {
+                co_await process_oldest_reply();
+                continue;
+            }
+            auto batches = co_await read_range_for_recovery(
+              next_offset, dirty_offset);
+            if (batches.empty()) {
+                // replies in flight may still move the follower forward
+                _stop_requested = _inflight.empty();
+                break;
+            }
+            auto prev_log_term = get_prev_log_term(
+              details::prev_offset(batches.begin()->base_offset()));
+            if (!prev_log_term) {
+                // no entry for prev_log_idx, fallback to install snapshot
+                co_await drain_window();
+                co_await install_snapshot();
+                co_return;
+            }
+            size_t size_bytes = 0;
+            for (const auto& b : batches) {
+                size_bytes += b.size_bytes();
+            }
+            co_await throttle(size_bytes);
+            if (_term != _ptr->term()) {
+                break;
+            }
+            _base_batch_offset = batches.begin()->base_offset();
+            _last_batch_offset = batches.back().last_offset();
+            next_offset = details::next_offset(_last_batch_offset);
+            replicate(
+              std::move(batches),
+              *prev_log_term,
+              should_flush(follower_committed_match_index),
+              size_bytes);
+        }
+    } catch (...) {
+        e = std::current_exception();
+    }
+    // requests in flight refer to this recovery_stm
+    co_await drain_window();
+    if (e) {
+        std::rethrow_exception(e);
+    }
+}
+
+ss::future<ss::circular_buffer<model::record_batch>>
+recovery_stm::read_range_for_recovery(
+  model::offset start_offset, model::offset end_offset) {
     storage::log_reader_config cfg(
       start_offset,
       end_offset,
       1,
       // 32KB is a modest estimate. It has good batching and it also prevents an
       // OOM situation where we have a lot of raft groups recovering at the same
-      // time and all drawing from memory. If this setting proves difficult,
-      // we'll need to throttle with a core-local semaphore
+      // time and all drawing from memory. Memory used by a recovery is bounded
+      // by the in flight window of the recovery_stm.
       32 * 1024,
       _prio,
       std::nullopt,
@@ -191,7 +275,7 @@ ss::future<> recovery_stm::read_range_for_recovery(
           return model::consume_reader_to_memory(
             std::move(reader), model::no_timeout);
       })
-      .then([this, start_offset, follower_committed_match_index](
+      .then([this, start_offset](
               ss::circular_buffer<model::record_batch> batches) {
           vlog(
             _ctxlog.trace,
@@ -199,20 +283,161 @@ ss::future<> recovery_stm::read_range_for_recovery(
             batches.size(),
             _node_id);
           if (batches.empty()) {
-              _stop_requested = true;
-              return ss::make_ready_future<>();
+              return std::move(batches);
           }
-          auto gap_filled_batches = details::make_ghost_batches_in_gaps(
+          return details::make_ghost_batches_in_gaps(
             start_offset, std::move(batches));
-          _base_batch_offset = gap_filled_batches.begin()->base_offset();
-          _last_batch_offset = gap_filled_batches.back().last_offset();
+      });
+}
+
+ss::future<bool> recovery_stm::maybe_ship_segment(model::offset next) {
+    if (
+      !_ptr->_segment_shipping || _segment_shipping_failed || _stop_requested
+      || _term != _ptr->term() || !_ptr->is_leader()) {
+        co_return false;
+    }
+    auto segment = co_await _ptr->_log.get_sealed_segment(next);
+    if (!segment) {
+        co_return false;
+    }
+    auto prev_log_term = get_prev_log_term(details::prev_offset(next));
+    if (!prev_log_term) {
+        co_return false;
+    }
+    vlog(
+      _ctxlog.debug,
+      "Shipping segment {} to node {}",
+      segment->data_path,
+      _node_id);
+    auto shipped = co_await ship_segment(std::move(*segment), *prev_log_term);
+    if (!shipped && !_stop_requested) {
+        vlog(
+          _ctxlog.info,
+          "Shipping segments to node {} failed, continuing recovery with "
+          "append entries",
+          _node_id);
+        _segment_shipping_failed = true;
+    }
+    co_return shipped;
+}
 
-          auto f_reader = model::make_foreign_memory_record_batch_reader(
-            std::move(gap_filled_batches));
+ss::future<bool> recovery_stm::ship_segment(
+  storage::sealed_segment segment, model::term_id prev_log_term) {
+    using file_type = install_segment_request::file_type;
+    // the index goes last, the follower opens the segment once it has it
+    if (!co_await send_segment_file(
+          segment, prev_log_term, file_type::data, segment.data_path, false)) {
+        co_return false;
+    }
+    if (
+      segment.compacted_index_path
+      && !co_await send_segment_file(
+        segment,
+        prev_log_term,
+        file_type::compacted_index,
+        *segment.compacted_index_path,
+        false)) {
+        co_return false;
+    }
+    co_return co_await send_segment_file(
+      segment, prev_log_term, file_type::index, segment.index_path, true);
+}
 
-          return replicate(
-            std::move(f_reader), should_flush(follower_committed_match_index));
-      });
+ss::future<bool> recovery_stm::send_segment_file(
+  const storage::sealed_segment& segment,
+  model::term_id prev_log_term,
+  install_segment_request::file_type type,
+  const std::filesystem::path& path,
+  bool last_file) {
+    auto size = co_await ss::file_size(path.string());
+    auto f = co_await ss::open_file_dma(path.string(), ss::open_flags::ro);
+    ss::file_input_stream_options opts;
+    opts.io_priority_class = _prio;
+    auto in = ss::make_file_input_stream(std::move(f), opts);
+    bool success = true;
+    std::exception_ptr e;
+    try {
+        uint64_t sent = 0;
+        do {
+            auto chunk = co_await read_iobuf_exactly(in, segment_chunk_size);
+            auto chunk_size = chunk.size_bytes();
+            co_await throttle(chunk_size);
+            if (
+              _stop_requested || _term != _ptr->term() || !_ptr->is_leader()) {
+                _stop_requested = true;
+                success = false;
+                break;
+            }
+            bool done = last_file && sent + chunk_size == size;
+            install_segment_request req{
+              .target_node_id = _node_id,
+              .term = _term,
+              .group = _ptr->group(),
+              .node_id = _ptr->self(),
+              .prev_log_index = details::prev_offset(segment.base_offset),
+              .prev_log_term = prev_log_term,
+              .base_offset = segment.base_offset,
+              .dirty_offset = segment.dirty_offset,
+              .segment_term = segment.term,
+              .file = type,
+              .file_offset = sent,
+              .chunk = std::move(chunk),
+              .done = done};
+            auto dirty = _ptr->_log.offsets().dirty_offset;
+            auto seq = _ptr->next_follower_sequence(_node_id);
+            auto reply = _ptr->validate_reply_target_node(
+              "install_segment",
+              co_await _ptr->_client_protocol.install_segment(
+                _node_id.id(),
+                std::move(req),
+                rpc::client_opts(append_entries_timeout())));
+            if (!reply) {
+                success = false;
+                break;
+            }
+            if (reply.value().term > _ptr->term()) {
+                _stop_requested = true;
+                success = false;
+                co_await _ptr->step_down(reply.value().term);
+                break;
+            }
+            sent += chunk_size;
+            if (!reply.value().success || reply.value().bytes_stored != sent) {
+                success = false;
+                break;
+            }
+            if (done) {
+                // follower adopted the segment, update its state as for a
+                // successful append
+                _ptr->process_append_entries_reply(
+                  _node_id.id(),
+                  append_entries_reply{
+                    .target_node_id = _ptr->self(),
+                    .node_id = _node_id,
+                    .group = _ptr->group(),
+                    .term = reply.value().term,
+                    .last_committed_log_index
+                    = reply.value().last_committed_log_index,
+                    .last_dirty_log_index = reply.value().last_dirty_log_index,
+                    .result = append_entries_reply::status::success},
+                  seq,
+                  dirty);
+            }
+        } while (sent < size);
+    } catch (...) {
+        e = std::current_exception();
+    }
+    co_await in.close();
+    if (e) {
+        vlog(
+          _ctxlog.warn,
+          "Sending segment file {} to node {} failed - {}",
+          path,
+          _node_id,
+          e);
+        co_return false;
+    }
+    co_return success;
 }
 
 ss::future<> recovery_stm::open_snapshot_reader() {
@@ -315,27 +540,30 @@ ss::future<> recovery_stm::install_snapshot() {
     });
 }
 
-ss::future<> recovery_stm::replicate(
-  model::record_batch_reader&& reader,
-  append_entries_request::flush_after_append flush) {
+std::optional<model::term_id>
+recovery_stm::get_prev_log_term(model::offset prev_log_idx) {
+    auto lstats = _ptr->_log.offsets();
+    if (prev_log_idx >= lstats.start_offset) {
+        return *_ptr->_log.get_term(prev_log_idx);
+    }
+    if (prev_log_idx < model::offset(0)) {
+        return model::term_id{};
+    }
+    if (prev_log_idx == _ptr->_last_snapshot_index) {
+        return _ptr->_last_snapshot_term;
+    }
+    return std::nullopt;
+}
+
+void recovery_stm::replicate(
+  ss::circular_buffer<model::record_batch> batches,
+  model::term_id prev_log_term,
+  append_entries_request::flush_after_append flush,
+  size_t size_bytes) {
     // collect metadata for append entries request
     // last persisted offset is last_offset of batch before the first one in the
     // reader
     auto prev_log_idx = details::prev_offset(_base_batch_offset);
-    model::term_id prev_log_term;
-    auto lstats = _ptr->_log.offsets();
-
-    // get term for prev_log_idx batch
-    if (prev_log_idx >= lstats.start_offset) {
-        prev_log_term = *_ptr->_log.get_term(prev_log_idx);
-    } else if (prev_log_idx < model::offset(0)) {
-        prev_log_term = model::term_id{};
-    } else if (prev_log_idx == _ptr->_last_snapshot_index) {
-        prev_log_term = _ptr->_last_snapshot_term;
-    } else {
-        // no entry for prev_log_idx, fallback to install snapshot
-        return install_snapshot();
-    }
 
     // calculate commit index for follower to update immediately
     auto commit_idx = std::min(_last_batch_offset, _committed_offset);
@@ -352,64 +580,97 @@ ss::future<> recovery_stm::replicate(
         .prev_log_index = prev_log_idx,
         .prev_log_term = prev_log_term,
         .last_visible_index = last_visible_idx},
-      std::move(reader),
+      model::make_foreign_memory_record_batch_reader(std::move(batches)),
       flush);
 
     _ptr->update_node_append_timestamp(_node_id);
 
     auto seq = _ptr->next_follower_sequence(_node_id);
     _ptr->update_suppress_heartbeats(_node_id, seq, heartbeats_suppressed::yes);
-    return dispatch_append_entries(std::move(r))
-      .finally([this, seq] {
-          _ptr->update_suppress_heartbeats(
-            _node_id, seq, heartbeats_suppressed::no);
-      })
-      .then([this, seq, dirty_offset = lstats.dirty_offset](auto r) {
-          if (!r) {
-              vlog(
-                _ctxlog.error,
-                "recovery_stm: not replicate entry: {} - {}",
-                r,
-                r.error().message());
-              _stop_requested = true;
-              _ptr->get_probe().recovery_request_error();
-          }
-          _ptr->process_append_entries_reply(
-            _node_id.id(), r.value(), seq, dirty_offset);
-          // If follower stats aren't present we have to stop recovery as
-          // follower was removed from configuration
-          if (!_ptr->_fstats.contains(_node_id)) {
-              _stop_requested = true;
-              return;
-          }
-          // If request was reordered we have to stop recovery as follower state
-          // is not known
-          if (seq < _ptr->_fstats.get(_node_id).last_received_seq) {
-              _stop_requested = true;
-              return;
-          }
-          // move the follower next index backward if recovery were not
-          // successfull
-          //
-          // Raft paper:
-          // If AppendEntries fails because of log inconsistency: decrement
-          // nextIndex and retry(§5.3)
-
-          if (r.value().result == append_entries_reply::status::failure) {
-              auto meta = get_follower_meta();
-              if (!meta) {
-                  _stop_requested = true;
-                  return;
-              }
-              meta.value()->next_index = std::max(
-                model::offset(0), details::prev_offset(_base_batch_offset));
-              vlog(
-                _ctxlog.trace,
-                "Move node {} next index {} backward",
-                _node_id,
-                meta.value()->next_index);
-          }
+    auto reply = dispatch_append_entries(std::move(r)).finally([this, seq] {
+        _ptr->update_suppress_heartbeats(
+          _node_id, seq, heartbeats_suppressed::no);
+    });
+    _inflight_bytes += size_bytes;
+    _inflight.push_back(inflight_request{
+      .reply = std::move(reply),
+      .seq = seq,
+      .base_offset = _base_batch_offset,
+      .dirty_offset = _ptr->_log.offsets().dirty_offset,
+      .size_bytes = size_bytes,
+    });
+}
+
+ss::future<> recovery_stm::drain_window() {
+    while (!_inflight.empty()) {
+        co_await process_oldest_reply();
+    }
+}
+
+ss::future<> recovery_stm::process_oldest_reply() {
+    auto req = std::move(_inflight.front());
+    _inflight.pop_front();
+    _inflight_bytes -= req.size_bytes;
+
+    auto r = co_await std::move(req.reply).handle_exception(
+      [this](const std::exception_ptr& e) -> result<append_entries_reply> {
+          vlog(
+            _ctxlog.warn, "Node {} recovery request failed - {}", _node_id, e);
+          return errc::append_entries_dispatch_error;
       });
+    if (!r) {
+        vlog(
+          _ctxlog.error,
+          "recovery_stm: not replicate entry: {} - {}",
+          r,
+          r.error().message());
+        _stop_requested = true;
+        _window_failed = true;
+        _ptr->get_probe().recovery_request_error();
+    }
+    _ptr->process_append_entries_reply(
+      _node_id.id(), r, req.seq, req.dirty_offset);
+    if (!r) {
+        co_return;
+    }
+    // If follower stats aren't present we have to stop recovery as
+    // follower was removed from configuration
+    if (!_ptr->_fstats.contains(_node_id)) {
+        _stop_requested = true;
+        co_return;
+    }
+    // If request was reordered we have to stop recovery as follower state
+    // is not known
+    if (req.seq < _ptr->_fstats.get(_node_id).last_received_seq) {
+        _stop_requested = true;
+        co_return;
+    }
+    // move the follower next index backward if recovery were not
+    // successfull
+    //
+    // Raft paper:
+    // If AppendEntries fails because of log inconsistency: decrement
+    // nextIndex and retry(§5.3)
+
+    if (r.value().result == append_entries_reply::status::failure) {
+        // the following requests of the window fail as well, only the first
+        // failure tells where the logs diverge
+        if (std::exchange(_window_failed, true)) {
+            co_return;
+        }
+        auto meta = get_follower_meta();
+        if (!meta) {
+            _stop_requested = true;
+            co_return;
+        }
+        meta.value()->next_index = std::max(
+          model::offset(0), details::prev_offset(req.base_offset));
+        vlog(
+          _ctxlog.trace,
+          "Move node {} next index {} backward",
+          _node_id,
+          meta.value()->next_index);
+    }
 }
 
 clock_type::time_point recovery_stm::append_entries_timeout() {
@@ -419,10 +680,12 @@ clock_type::time_point recovery_stm::append_entries_timeout() {
 ss::future<result<append_entries_reply>>
 recovery_stm::dispatch_append_entries(append_entries_request&& r) {
     _ptr->_probe.recovery_append_request();
+    rpc::client_opts opts(append_entries_timeout());
+    // keep recovery off the connection used by the replication of live data
+    opts.connection = rpc::connection_class::bulk;
 
     return _ptr->_client_protocol
-      .append_entries(
-        _node_id.id(), std::move(r), rpc::client_opts(append_entries_timeout()))
+      .append_entries(_node_id.id(), std::move(r), std::move(opts))
       .then([this](result<append_entries_reply> reply) {
           return _ptr->validate_reply_target_node(
             "append_entries_recovery", std::move(reply));
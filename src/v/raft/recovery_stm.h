@@ -15,20 +15,72 @@
 #include "outcome.h"
 #include "raft/logger.h"
 #include "storage/snapshot.h"
+#include "storage/types.h"
+#include "units.h"
+
+#include <deque>
+#include <filesystem>
 
 namespace raft {
 
+/**
+ * Recovery of a follower that fell behind the leader. Recovery keeps a window
+ * of append entries requests in flight instead of waiting for the reply of
+ * each request before reading the next range. The window is bounded by the
+ * number of requests and by the number of bytes, all recoveries on a shard
+ * share the recovery_throttle of the group_manager.
+ *
+ * Requests of the window are processed by the follower in order, every
+ * request starts where the previous one ended. When one of them fails the
+ * remaining replies are processed but they do not move the follower next
+ * index, the window is drained and recovery restarts from the index set by
+ * the first failure.
+ *
+ * When segment shipping is enabled and the follower next index is the base
+ * offset of a sealed segment, the segment files are sent to the follower as
+ * they are, in large chunks, instead of the append entries requests carrying
+ * its batches. The follower adopts the segment in its log without parsing
+ * its batches. If shipping fails the recovery continues with append entries.
+ */
 class recovery_stm {
 public:
     recovery_stm(consensus*, vnode, ss::io_priority_class);
     ss::future<> apply();
 
 private:
+    // size of the install_segment requests
+    static constexpr size_t segment_chunk_size = 1_MiB;
+
+    struct inflight_request {
+        ss::future<result<append_entries_reply>> reply;
+        follower_req_seq seq;
+        model::offset base_offset;
+        model::offset dirty_offset;
+        size_t size_bytes;
+    };
+
     ss::future<> do_recover();
-    ss::future<>
-      read_range_for_recovery(model::offset, model::offset, model::offset);
-    ss::future<> replicate(
-      model::record_batch_reader&&, append_entries_request::flush_after_append);
+    ss::future<> replicate_window(model::offset, model::offset);
+    ss::future<ss::circular_buffer<model::record_batch>>
+      read_range_for_recovery(model::offset, model::offset);
+    void replicate(
+      ss::circular_buffer<model::record_batch>,
+      model::term_id,
+      append_entries_request::flush_after_append,
+      size_t);
+    ss::future<> process_oldest_reply();
+    ss::future<> drain_window();
+
+    ss::future<bool> maybe_ship_segment(model::offset);
+    ss::future<bool> ship_segment(storage::sealed_segment, model::term_id);
+    ss::future<bool> send_segment_file(
+      const storage::sealed_segment&,
+      model::term_id,
+      install_segment_request::file_type,
+      const std::filesystem::path&,
+      bool);
+    bool is_window_full() const;
+    std::optional<model::term_id> get_prev_log_term(model::offset);
     ss::future<result<append_entries_reply>>
     dispatch_append_entries(append_entries_request&&);
     std::optional<follower_index_metadata*> get_follower_meta();
@@ -39,6 +91,7 @@ private:
     ss::future<> handle_install_snapshot_reply(result<install_snapshot_reply>);
     ss::future<> open_snapshot_reader();
     ss::future<> close_snapshot_reader();
+    ss::future<> throttle(size_t bytes);
     bool state_changed();
     bool is_recovery_finished();
     append_entries_request::flush_after_append
@@ -57,6 +110,16 @@ private:
     size_t _snapshot_size = 0;
     // needed to early exit. (node down)
     bool _stop_requested = false;
+    // requests sent to the follower in the order of their offsets
+    std::deque<inflight_request> _inflight;
+    size_t _inflight_bytes = 0;
+    size_t _max_inflight_requests;
+    size_t _max_inflight_bytes;
+    // follower next index was already moved back by one of the replies of the
+    // current window
+    bool _window_failed = false;
+    // do not try shipping segments again after a failure
+    bool _segment_shipping_failed = false;
 };
 
 } // namespace raft
@@ -0,0 +1,53 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "raft/recovery_throttle.h"
+
+#include <algorithm>
+
+namespace raft {
+
+recovery_throttle::recovery_throttle(size_t rate)
+  : _rate(rate) {
+    _refresh_timer.set_callback([this] { refill(); });
+}
+
+ss::future<> recovery_throttle::start() {
+    if (_rate > 0) {
+        _sem.signal(capacity());
+        _refresh_timer.arm_periodic(refresh_interval);
+    }
+    return ss::now();
+}
+
+ss::future<> recovery_throttle::stop() {
+    _refresh_timer.cancel();
+    _sem.broken();
+    return ss::now();
+}
+
+ss::future<> recovery_throttle::throttle(size_t bytes) {
+    if (_rate == 0) {
+        return ss::now();
+    }
+    // a single request bigger than the bucket would never be admitted
+    return _sem.wait(std::min(bytes, capacity()));
+}
+
+void recovery_throttle::refill() {
+    auto per_refresh = std::max<size_t>(
+      _rate * refresh_interval.count() / 1000, 1);
+    auto available = static_cast<size_t>(
+      std::max<ssize_t>(_sem.available_units(), 0));
+    if (available < capacity()) {
+        _sem.signal(std::min(per_refresh, capacity() - available));
+    }
+}
+
+} // namespace raft
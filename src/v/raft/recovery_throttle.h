@@ -0,0 +1,56 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "seastarx.h"
+
+#include <seastar/core/future.hh>
+#include <seastar/core/semaphore.hh>
+#include <seastar/core/timer.hh>
+
+#include <chrono>
+
+namespace raft {
+
+/**
+ * Token bucket shared by all the recovery_stm instances of a shard. Recovery
+ * reads and sends data as fast as the follower acknowledges it, without a
+ * limit a few followers catching up can take all of the disk and network
+ * bandwidth of the node away from the produce requests.
+ *
+ * The bucket is refilled every refresh interval and holds at most one
+ * second worth of tokens so that an idle period does not allow a burst
+ * larger than the configured rate.
+ */
+class recovery_throttle {
+public:
+    static constexpr auto refresh_interval = std::chrono::milliseconds(100);
+
+    /// \param rate is the number of bytes per second, 0 disables the limit
+    explicit recovery_throttle(size_t rate);
+
+    ss::future<> start();
+    ss::future<> stop();
+
+    /// \brief waits until the bytes can be sent
+    ss::future<> throttle(size_t bytes);
+
+private:
+    void refill();
+    size_t capacity() const { return _rate; }
+
+    size_t _rate;
+    ss::semaphore _sem{0};
+    ss::timer<> _refresh_timer;
+};
+
+} // namespace raft
@@ -17,6 +17,7 @@
 #include "raft/errc.h"
 #include "raft/replicate_entries_stm.h"
 #include "raft/types.h"
+#include "utils/stage_latency.h"
 
 #include <seastar/core/circular_buffer.hh>
 #include <seastar/core/semaphore.hh>
@@ -29,20 +30,61 @@
 
 namespace raft {
 using namespace std::chrono_literals; // NOLINT
-replicate_batcher::replicate_batcher(consensus* ptr, size_t cache_size)
+replicate_batcher::replicate_batcher(
+  consensus* ptr, size_t cache_size, std::chrono::microseconds max_linger)
   : _ptr(ptr)
-  , _max_batch_size_sem(cache_size) {}
+  , _max_batch_size_sem(cache_size)
+  , _max_linger(max_linger) {}
 
 ss::future<result<replicate_result>> replicate_batcher::replicate(
   std::optional<model::term_id> expected_term, model::record_batch_reader&& r) {
     return do_cache(expected_term, std::move(r)).then([this](item_ptr i) {
-        return _lock.with([this] { return flush(); }).then([i] {
+        if (_lingering) {
+            // appended by the request lingering for it
+            _cached.signal();
             return i->_promise.get_future();
-        });
+        }
+        return maybe_linger()
+          .then([this] { return _lock.with([this] { return flush(); }); })
+          .then([i] { return i->_promise.get_future(); });
     });
 }
 
+ss::future<> replicate_batcher::maybe_linger() {
+    _last_linger = linger_clock::duration(0);
+    if (!_log_busy || _max_batch_size_sem.waiters() > 0) {
+        return ss::now();
+    }
+    _lingering = true;
+    auto started = linger_clock::now();
+    auto linger = std::min<linger_clock::duration>(
+      _max_linger, _flush_latency / 2);
+    return _cached
+      .wait(
+        started + linger,
+        [this] { return _max_batch_size_sem.waiters() > 0; })
+      .handle_exception_type([](const ss::condition_variable_timed_out&) {
+          // append whatever was cached so far
+      })
+      .handle_exception_type([](const ss::broken_condition_variable&) {
+          // stopping, the cached requests are failed by stop()
+      })
+      .finally([this, started] {
+          _lingering = false;
+          _last_linger = linger_clock::now() - started;
+      });
+}
+
+void replicate_batcher::update_flush_stats(
+  size_t items, linger_clock::duration flush_latency) {
+    // same weight as 1/8 in the TCP round trip time estimation
+    _flush_latency = _flush_latency - _flush_latency / 8 + flush_latency / 8;
+    _log_busy = _max_linger.count() > 0 && items > 1
+                && _flush_latency > _max_linger;
+}
+
 ss::future<> replicate_batcher::stop() {
+    _cached.broken();
     // we keep a lock here to make sure that all inflight requests have finished
     // already
     return _lock.with([this]() {
@@ -78,6 +120,10 @@ replicate_batcher::do_cache_with_backpressure(
   std::optional<model::term_id> expected_term,
   ss::circular_buffer<model::record_batch> batches,
   size_t bytes) {
+    if (_lingering && _max_batch_size_sem.available_units() < ssize_t(bytes)) {
+        // the window is exhausted, lingering would not merge more
+        _cached.signal();
+    }
     return ss::get_units(_max_batch_size_sem, bytes)
       .then([this, expected_term, batches = std::move(batches)](
 
@@ -95,6 +141,7 @@ replicate_batcher::do_cache_with_backpressure(
           i->expected_term = expected_term;
           i->record_count = record_count;
           i->units = std::move(u);
+          i->cached = stage_latencies().start();
           _item_cache.emplace_back(i);
           return i;
       });
@@ -136,6 +183,8 @@ ss::future<> replicate_batcher::flush() {
                             b.set_term(term);
                             data.push_back(std::move(b));
                         }
+                        stage_latencies().record(
+                          request_stage::replicate_batch, n->cached);
                         notifications.push_back(std::move(n));
                     } else {
                         n->_promise.set_value(errc::not_leader);
@@ -151,11 +200,20 @@ ss::future<> replicate_batcher::flush() {
                   _ptr->_self,
                   std::move(meta),
                   model::make_memory_record_batch_reader(std::move(data)));
+                const auto items = notifications.size();
+                _ptr->_probe.replicate_batch_merged(
+                  items,
+                  std::chrono::duration_cast<std::chrono::microseconds>(
+                    _last_linger));
+                const auto started = linger_clock::now();
                 return do_flush(
-                  std::move(notifications),
-                  std::move(req),
-                  std::move(u),
-                  std::move(seqs));
+                         std::move(notifications),
+                         std::move(req),
+                         std::move(u),
+                         std::move(seqs))
+                  .then([this, items, started] {
+                      update_flush_stats(items, linger_clock::now() - started);
+                  });
             });
       });
 }
@@ -16,13 +16,31 @@
 #include "raft/types.h"
 #include "units.h"
 #include "utils/mutex.h"
+#include "utils/stage_latency.h"
 
+#include <seastar/core/condition-variable.hh>
 #include <seastar/core/semaphore.hh>
 
 #include <absl/container/flat_hash_map.h>
+
+#include <chrono>
 namespace raft {
 class consensus;
 
+/**
+ * Replicate requests are cached and appended together by the request which
+ * takes the lock first.
+ *
+ * Adaptive linger:
+ *
+ * When the leader log is slow to append, as when every append waits for a
+ * flush, a request that finds nobody lingering and the previous append
+ * merged more than one request waits for up to half of the recent append
+ * latency, bounded by max_linger, for more requests to arrive before it
+ * takes the lock. The requests arriving meanwhile are appended with it. An
+ * idle leader, or one with a fast log, appends right away. The linger stops
+ * early once the replicate window is exhausted.
+ */
 class replicate_batcher {
 public:
     struct item {
@@ -30,6 +48,8 @@ public:
         size_t record_count;
         std::vector<model::record_batch> data;
         std::optional<model::term_id> expected_term;
+        /// sampled start of the wait for a flush
+        std::optional<stage_latency::clock_type::time_point> cached;
         /**
          * Item keeps semaphore units until replicate batcher is done with
          * processing the request.
@@ -37,7 +57,10 @@ public:
         ss::semaphore_units<> units;
     };
     using item_ptr = ss::lw_shared_ptr<item>;
-    explicit replicate_batcher(consensus* ptr, size_t cache_size);
+    replicate_batcher(
+      consensus* ptr,
+      size_t cache_size,
+      std::chrono::microseconds max_linger = std::chrono::microseconds(0));
 
     replicate_batcher(replicate_batcher&&) noexcept = default;
     replicate_batcher& operator=(replicate_batcher&&) noexcept = delete;
@@ -59,8 +82,13 @@ public:
       absl::flat_hash_map<vnode, follower_req_seq>);
 
 private:
+    // lowres clock is too coarse for lingers of microseconds
+    using linger_clock = std::chrono::steady_clock;
+
     ss::future<item_ptr>
     do_cache(std::optional<model::term_id>, model::record_batch_reader&&);
+    ss::future<> maybe_linger();
+    void update_flush_stats(size_t, linger_clock::duration);
     ss::future<replicate_batcher::item_ptr> do_cache_with_backpressure(
       std::optional<model::term_id>,
       ss::circular_buffer<model::record_batch>,
@@ -71,6 +99,16 @@ private:
 
     std::vector<item_ptr> _item_cache;
     mutex _lock;
+
+    std::chrono::microseconds _max_linger;
+    // signaled as requests are cached or wait for the window
+    ss::condition_variable _cached;
+    bool _lingering{false};
+    // moving average of the leader append latency
+    linger_clock::duration _flush_latency{0};
+    bool _log_busy{false};
+    // time the requests being flushed lingered for
+    linger_clock::duration _last_linger{0};
 };
 
 } // namespace raft
@@ -21,6 +21,7 @@
 #include "raft/raftgen_service.h"
 #include "raft/types.h"
 #include "rpc/types.h"
+#include "utils/stage_latency.h"
 
 #include <chrono>
 
@@ -47,6 +48,12 @@ ss::future<result<append_entries_reply>> replicate_entries_stm::do_dispatch_one(
     using ret_t = result<append_entries_reply>;
 
     if (n == _ptr->_self) {
+        // the op lock is held until the leader flush finishes unless the
+        // flush is written behind, then appends of the following batches
+        // overlap with it and it is only one of the votes for the commit
+        if (_ptr->_leader_write_behind) {
+            units = nullptr;
+        }
         auto f = _ptr->flush_log()
                    .then([this, units]() {
                        auto lstats = _ptr->_log.offsets();
@@ -84,12 +91,15 @@ replicate_entries_stm::send_append_entries_request(
     vlog(_ctxlog.trace, "Sending append entries request {} to {}", req.meta, n);
 
     req.target_node_id = n;
+    auto started = std::chrono::steady_clock::now();
     auto f = _ptr->_client_protocol
                .append_entries(
                  n.id(),
                  std::move(req),
                  rpc::client_opts(append_entries_timeout()))
-               .then([this](result<append_entries_reply> reply) {
+               .then([this, started](result<append_entries_reply> reply) {
+                   _ptr->_probe.follower_append_done(
+                     std::chrono::steady_clock::now() - started);
                    return _ptr->validate_reply_target_node(
                      "append_entries_replicate", std::move(reply));
                });
@@ -138,11 +148,17 @@ replicate_entries_stm::dispatch_single_retry(
 ss::future<result<storage::append_result>>
 replicate_entries_stm::append_to_self() {
     return share_request()
-      .then([this](append_entries_request req) mutable {
+      .then([this, started = stage_latencies().start()](
+              append_entries_request req) mutable {
           vlog(_ctxlog.trace, "Self append entries - {}", req.meta);
           _ptr->_last_write_consistency_level = consistency_level::quorum_ack;
-          return _ptr->disk_append(
-            std::move(req.batches), consensus::update_last_quorum_index::yes);
+          return _ptr
+            ->disk_append(
+              std::move(req.batches), consensus::update_last_quorum_index::yes)
+            .then([started](storage::append_result res) {
+                stage_latencies().record(request_stage::local_append, started);
+                return res;
+            });
       })
       .then([](storage::append_result res) {
           return result<storage::append_result>(std::move(res));
@@ -55,6 +55,10 @@ namespace raft {
 ///       ->(2) or (3) check if entry with given offset and term exists in log
 ///         if entry exists reply with success, reply with false otherwise
 ///
+///  With leader write behind the op lock is released as soon as the requests
+///  are dispatched, the leader flush overlaps with the append of the next
+///  batches and commit index advances when a majority, the leader flush
+///  being one of its votes, has flushed the entry.
 ///
 ///   Wait is realized with condition variable that is only notified when commit
 ///   index change
@@ -9,6 +9,7 @@
 
 #include "raft/rpc_client_protocol.h"
 
+#include "config/configuration.h"
 #include "outcome_future_utils.h"
 #include "raft/raftgen_service.h"
 #include "rpc/connection_cache.h"
@@ -18,6 +19,23 @@
 
 namespace raft {
 
+/// compresses the requests carrying batches, see raft_rpc_compression
+static rpc::client_opts with_compression(rpc::client_opts opts) {
+    switch (config::shard_local_cfg().raft_rpc_compression()) {
+    case model::compression::zstd:
+        opts.compression = rpc::compression_type::zstd;
+        break;
+    case model::compression::lz4:
+        opts.compression = rpc::compression_type::lz4;
+        break;
+    default:
+        return opts;
+    }
+    opts.min_compression_bytes
+      = config::shard_local_cfg().raft_rpc_compression_min_bytes();
+    return opts;
+}
+
 ss::future<result<vote_reply>> rpc_client_protocol::vote(
   model::node_id n, vote_request&& r, rpc::client_opts opts) {
     return _connection_cache.local().with_node_client<raftgen_client_protocol>(
@@ -25,6 +43,8 @@ ss::future<result<vote_reply>> rpc_client_protocol::vote(
       ss::this_shard_id(),
       n,
       opts.timeout,
+      rpc::connection_class::control,
+      0,
       [r = std::move(r),
        opts = std::move(opts)](raftgen_client_protocol client) mutable {
           return client.vote(std::move(r), std::move(opts))
@@ -34,18 +54,40 @@ ss::future<result<vote_reply>> rpc_client_protocol::vote(
 
 ss::future<result<append_entries_reply>> rpc_client_protocol::append_entries(
   model::node_id n, append_entries_request&& r, rpc::client_opts opts) {
+    auto conn_class = opts.connection;
+    auto conn_key = static_cast<size_t>(r.meta.group());
     return _connection_cache.local().with_node_client<raftgen_client_protocol>(
       _self,
       ss::this_shard_id(),
       n,
       opts.timeout,
+      conn_class,
+      conn_key,
       [r = std::move(r),
        opts = std::move(opts)](raftgen_client_protocol client) mutable {
-          return client.append_entries(std::move(r), std::move(opts))
+          return client
+            .append_entries(std::move(r), with_compression(std::move(opts)))
             .then(&rpc::get_ctx_data<append_entries_reply>);
       });
 }
 
+ss::future<result<append_entries_batch_reply>>
+rpc_client_protocol::append_entries_batch(
+  model::node_id n, append_entries_batch_request&& r, rpc::client_opts opts) {
+    return _connection_cache.local().with_node_client<raftgen_client_protocol>(
+      _self,
+      ss::this_shard_id(),
+      n,
+      opts.timeout,
+      [r = std::move(r),
+       opts = std::move(opts)](raftgen_client_protocol client) mutable {
+          return client
+            .append_entries_batch(
+              std::move(r), with_compression(std::move(opts)))
+            .then(&rpc::get_ctx_data<append_entries_batch_reply>);
+      });
+}
+
 ss::future<result<heartbeat_reply>> rpc_client_protocol::heartbeat(
   model::node_id n, heartbeat_request&& r, rpc::client_opts opts) {
     return _connection_cache.local().with_node_client<raftgen_client_protocol>(
@@ -53,6 +95,8 @@ ss::future<result<heartbeat_reply>> rpc_client_protocol::heartbeat(
       ss::this_shard_id(),
       n,
       opts.timeout,
+      rpc::connection_class::control,
+      0,
       [r = std::move(r),
        opts = std::move(opts)](raftgen_client_protocol client) mutable {
           return client.heartbeat(std::move(r), std::move(opts))
@@ -63,18 +107,40 @@ ss::future<result<heartbeat_reply>> rpc_client_protocol::heartbeat(
 ss::future<result<install_snapshot_reply>>
 rpc_client_protocol::install_snapshot(
   model::node_id n, install_snapshot_request&& r, rpc::client_opts opts) {
+    auto conn_key = static_cast<size_t>(r.group());
     return _connection_cache.local().with_node_client<raftgen_client_protocol>(
       _self,
       ss::this_shard_id(),
       n,
       opts.timeout,
+      rpc::connection_class::bulk,
+      conn_key,
       [r = std::move(r),
        opts = std::move(opts)](raftgen_client_protocol client) mutable {
-          return client.install_snapshot(std::move(r), std::move(opts))
+          return client
+            .install_snapshot(std::move(r), with_compression(std::move(opts)))
             .then(&rpc::get_ctx_data<install_snapshot_reply>);
       });
 }
 
+ss::future<result<install_segment_reply>> rpc_client_protocol::install_segment(
+  model::node_id n, install_segment_request&& r, rpc::client_opts opts) {
+    auto conn_key = static_cast<size_t>(r.group());
+    return _connection_cache.local().with_node_client<raftgen_client_protocol>(
+      _self,
+      ss::this_shard_id(),
+      n,
+      opts.timeout,
+      rpc::connection_class::bulk,
+      conn_key,
+      [r = std::move(r),
+       opts = std::move(opts)](raftgen_client_protocol client) mutable {
+          return client
+            .install_segment(std::move(r), with_compression(std::move(opts)))
+            .then(&rpc::get_ctx_data<install_segment_reply>);
+      });
+}
+
 ss::future<result<timeout_now_reply>> rpc_client_protocol::timeout_now(
   model::node_id n, timeout_now_request&& r, rpc::client_opts opts) {
     return _connection_cache.local().with_node_client<raftgen_client_protocol>(
@@ -82,6 +148,8 @@ ss::future<result<timeout_now_reply>> rpc_client_protocol::timeout_now(
       ss::this_shard_id(),
       n,
       opts.timeout,
+      rpc::connection_class::control,
+      0,
       [r = std::move(r),
        opts = std::move(opts)](raftgen_client_protocol client) mutable {
           return client.timeout_now(std::move(r), std::move(opts))
@@ -37,12 +37,18 @@ public:
     ss::future<result<append_entries_reply>> append_entries(
       model::node_id, append_entries_request&&, rpc::client_opts) final;
 
+    ss::future<result<append_entries_batch_reply>> append_entries_batch(
+      model::node_id, append_entries_batch_request&&, rpc::client_opts) final;
+
     ss::future<result<heartbeat_reply>>
     heartbeat(model::node_id, heartbeat_request&&, rpc::client_opts) final;
 
     ss::future<result<install_snapshot_reply>> install_snapshot(
       model::node_id, install_snapshot_request&&, rpc::client_opts) final;
 
+    ss::future<result<install_segment_reply>> install_segment(
+      model::node_id, install_segment_request&&, rpc::client_opts) final;
+
     ss::future<result<timeout_now_reply>>
     timeout_now(model::node_id, timeout_now_request&&, rpc::client_opts) final;
 
@@ -0,0 +1,141 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "raft/segment_receiver.h"
+
+#include "bytes/iobuf.h"
+#include "raft/logger.h"
+#include "resource_mgmt/io_priority.h"
+#include "storage/fs_utils.h"
+#include "storage/segment_utils.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/seastar.hh>
+
+#include <algorithm>
+
+namespace raft {
+
+segment_receiver::segment_receiver(
+  const storage::ntp_config& cfg,
+  model::offset base_offset,
+  model::offset dirty_offset,
+  model::term_id term)
+  : _data_path(storage::segment_path::make_segment_path(
+    cfg, base_offset, term, storage::record_version_type::v1))
+  , _base_offset(base_offset)
+  , _dirty_offset(dirty_offset)
+  , _term(term) {}
+
+bool segment_receiver::is_for(const install_segment_request& r) const {
+    return r.base_offset == _base_offset && r.dirty_offset == _dirty_offset
+           && r.segment_term == _term;
+}
+
+std::filesystem::path segment_receiver::final_path(file_type t) const {
+    switch (t) {
+    case file_type::data:
+        return _data_path;
+    case file_type::index:
+        return std::filesystem::path(_data_path).replace_extension(
+          "base_index");
+    case file_type::compacted_index:
+        return storage::internal::compacted_index_path(_data_path);
+    }
+    __builtin_unreachable();
+}
+
+std::filesystem::path segment_receiver::staging_path(file_type t) const {
+    auto p = final_path(t);
+    p += ".staging";
+    return p;
+}
+
+ss::future<> segment_receiver::open(file_type t) {
+    auto path = staging_path(t);
+    _file = co_await ss::open_file_dma(
+      path.string(),
+      ss::open_flags::create | ss::open_flags::truncate | ss::open_flags::wo);
+    ss::file_output_stream_options opts;
+    opts.io_priority_class = raft_priority();
+    _out = co_await ss::make_file_output_stream(_file, opts);
+    _current = t;
+    _bytes_stored = 0;
+    _received.push_back(t);
+}
+
+ss::future<> segment_receiver::close_current() {
+    if (!_out) {
+        co_return;
+    }
+    auto out = std::move(*_out);
+    _out.reset();
+    _current.reset();
+    co_await out.flush();
+    co_await _file.flush();
+    co_await out.close();
+}
+
+ss::future<bool>
+segment_receiver::write(file_type t, uint64_t file_offset, iobuf chunk) {
+    if (_current != t) {
+        // every file is sent from its beginning, files are never resent
+        if (
+          file_offset != 0
+          || std::find(_received.begin(), _received.end(), t)
+               != _received.end()) {
+            co_return false;
+        }
+        co_await close_current();
+        co_await open(t);
+    }
+    if (file_offset != _bytes_stored) {
+        co_return false;
+    }
+    _bytes_stored += chunk.size_bytes();
+    co_await write_iobuf_to_output_stream(std::move(chunk), *_out);
+    co_return true;
+}
+
+ss::future<> segment_receiver::finish() {
+    co_await close_current();
+    for (auto t : _received) {
+        co_await ss::rename_file(
+          staging_path(t).string(), final_path(t).string());
+    }
+    co_await ss::sync_directory(_data_path.parent_path().string());
+    vlog(
+      raftlog.debug,
+      "Received segment {} with offsets [{},{}]",
+      _data_path,
+      _base_offset,
+      _dirty_offset);
+}
+
+ss::future<> segment_receiver::abort() {
+    try {
+        co_await close_current();
+    } catch (...) {
+        vlog(
+          raftlog.warn,
+          "Error closing received segment {} - {}",
+          _data_path,
+          std::current_exception());
+    }
+    for (auto t : _received) {
+        auto path = staging_path(t).string();
+        if (co_await ss::file_exists(path)) {
+            co_await ss::remove_file(path);
+        }
+    }
+    _received.clear();
+}
+
+} // namespace raft
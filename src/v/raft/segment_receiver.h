@@ -0,0 +1,83 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "model/fundamental.h"
+#include "raft/types.h"
+#include "seastarx.h"
+#include "storage/ntp_config.h"
+
+#include <seastar/core/file.hh>
+#include <seastar/core/fstream.hh>
+#include <seastar/core/future.hh>
+#include <seastar/core/iostream.hh>
+
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace raft {
+
+/**
+ * Follower side of a segment transfer. Files of the segment are written next
+ * to the log files under a staging name, so neither a partially received
+ * segment nor a crash during the transfer leaves a file that the log would
+ * pick up when it is recovered. The files are moved in place only once all of
+ * them were received and flushed, after that the segment can be adopted by
+ * the log.
+ */
+class segment_receiver {
+public:
+    using file_type = install_segment_request::file_type;
+
+    segment_receiver(
+      const storage::ntp_config&,
+      model::offset base_offset,
+      model::offset dirty_offset,
+      model::term_id term);
+
+    /// true if the request is a part of the segment being received
+    bool is_for(const install_segment_request&) const;
+
+    /// \brief writes the chunk to the file
+    ///
+    /// returns false if the chunk does not follow the already received data
+    ss::future<bool> write(file_type, uint64_t file_offset, iobuf chunk);
+
+    /// number of bytes of the current file that were stored
+    uint64_t bytes_stored() const { return _bytes_stored; }
+
+    /// flushes all the files and moves them to their final location
+    ss::future<> finish();
+
+    /// removes all the files that were received so far
+    ss::future<> abort();
+
+private:
+    std::filesystem::path final_path(file_type) const;
+    std::filesystem::path staging_path(file_type) const;
+    ss::future<> open(file_type);
+    ss::future<> close_current();
+
+    std::filesystem::path _data_path;
+    model::offset _base_offset;
+    model::offset _dirty_offset;
+    model::term_id _term;
+
+    std::optional<file_type> _current;
+    ss::file _file;
+    std::optional<ss::output_stream<char>> _out;
+    uint64_t _bytes_stored = 0;
+    std::vector<file_type> _received;
+};
+
+} // namespace raft
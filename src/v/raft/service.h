@@ -82,27 +82,42 @@ public:
             reqs.push_back(std::move(append_req));
         };
 
-        auto req_size = reqs.size();
+        auto req_size = reqs.size() + r.idle_heartbeats.size();
         auto groupped = group_hbeats_by_shard(std::move(reqs));
+        auto idle_groupped = group_hbeats_by_shard(
+          std::move(r.idle_heartbeats));
 
         std::vector<ss::future<std::vector<append_entries_reply>>> futures;
-        futures.reserve(groupped.shard_requests.size());
+        futures.reserve(
+          groupped.shard_requests.size()
+          + idle_groupped.shard_requests.size());
         for (auto& [shard, req] : groupped.shard_requests) {
             // dispatch to each core in parallel
             futures.push_back(dispatch_hbeats_to_core(shard, std::move(req)));
         }
+        for (auto& [shard, req] : idle_groupped.shard_requests) {
+            futures.push_back(dispatch_hbeats_to_core(shard, std::move(req)));
+        }
         // replies for groups that are not yet registered at this node
         std::vector<append_entries_reply> group_missing_replies;
-        group_missing_replies.reserve(groupped.group_missing_requests.size());
+        group_missing_replies.reserve(
+          groupped.group_missing_requests.size()
+          + idle_groupped.group_missing_requests.size());
+        auto missing_reply = [](const auto& r) {
+            return append_entries_reply{
+              .group = r.target_group(),
+              .result = append_entries_reply::status::group_unavailable};
+        };
         std::transform(
           std::begin(groupped.group_missing_requests),
           std::end(groupped.group_missing_requests),
           std::back_inserter(group_missing_replies),
-          [](append_entries_request& r) {
-              return append_entries_reply{
-                .group = r.meta.group,
-                .result = append_entries_reply::status::group_unavailable};
-          });
+          missing_reply);
+        std::transform(
+          std::begin(idle_groupped.group_missing_requests),
+          std::end(idle_groupped.group_missing_requests),
+          std::back_inserter(group_missing_replies),
+          missing_reply);
 
         return ss::when_all_succeed(futures.begin(), futures.end())
           .then([req_size, missing = std::move(group_missing_replies)](
@@ -133,15 +148,45 @@ public:
 
     [[gnu::always_inline]] ss::future<append_entries_reply>
     append_entries(append_entries_request&& r, rpc::streaming_context&) final {
-        return _probe.append_entries().then([this, r = std::move(r)]() mutable {
-            auto gr = r.target_group();
-            return dispatch_request(
-              append_entries_request::make_foreign(std::move(r)),
-              [gr]() { return make_missing_group_reply(gr); },
-              [](append_entries_request&& r, consensus_ptr c) {
-                  return c->append_entries(std::move(r));
-              });
-        });
+        return do_append_entries(std::move(r));
+    }
+
+    [[gnu::always_inline]] ss::future<append_entries_batch_reply>
+    append_entries_batch(
+      append_entries_batch_request&& r, rpc::streaming_context&) final {
+        using entry_t = std::pair<append_entries_reply, errc>;
+        std::vector<ss::future<entry_t>> futures;
+        futures.reserve(r.requests.size());
+        for (auto& req : r.requests) {
+            // a failure of one group must not fail the replies of the others
+            auto to_entry = [group = req.target_group()](
+                              ss::future<append_entries_reply> f) {
+                if (!f.failed()) {
+                    return entry_t(f.get0(), errc::success);
+                }
+                vlog(
+                  raftlog.warn,
+                  "Batched append entries of group {} failed: {}",
+                  group,
+                  f.get_exception());
+                return entry_t(
+                  append_entries_reply{.group = group},
+                  errc::append_entries_dispatch_error);
+            };
+            futures.push_back(
+              do_append_entries(std::move(req)).then_wrapped(to_entry));
+        }
+        return ss::when_all_succeed(futures.begin(), futures.end())
+          .then([](std::vector<entry_t> entries) {
+              append_entries_batch_reply reply;
+              reply.replies.reserve(entries.size());
+              reply.errors.reserve(entries.size());
+              for (auto& [r, e] : entries) {
+                  reply.replies.push_back(std::move(r));
+                  reply.errors.push_back(e);
+              }
+              return reply;
+          });
     }
 
     [[gnu::always_inline]] ss::future<install_snapshot_reply> install_snapshot(
@@ -149,6 +194,7 @@ public:
         return _probe.install_snapshot().then([this,
                                                r = std::move(r)]() mutable {
             return dispatch_request(
+              recovery_scheduling_group(),
               std::move(install_snapshot_request_foreign_wrapper(std::move(r))),
               &service::make_failed_install_snapshot_reply,
               [](
@@ -158,6 +204,20 @@ public:
         });
     }
 
+    [[gnu::always_inline]] ss::future<install_segment_reply> install_segment(
+      install_segment_request&& r, rpc::streaming_context&) final {
+        return _probe.install_segment().then([this,
+                                              r = std::move(r)]() mutable {
+            return dispatch_request(
+              recovery_scheduling_group(),
+              std::move(install_segment_request_foreign_wrapper(std::move(r))),
+              &service::make_failed_install_segment_reply,
+              [](install_segment_request_foreign_wrapper&& r, consensus_ptr c) {
+                  return c->install_segment(r.copy());
+              });
+        });
+    }
+
     [[gnu::always_inline]] ss::future<timeout_now_reply>
     timeout_now(timeout_now_request&& r, rpc::streaming_context&) final {
         return _probe.timeout_now().then([this, r = std::move(r)]() mutable {
@@ -172,13 +232,28 @@ public:
 
 private:
     using consensus_ptr = seastar::lw_shared_ptr<consensus>;
-    using hbeats_t = std::vector<append_entries_request>;
-    using hbeats_ptr = ss::foreign_ptr<std::unique_ptr<hbeats_t>>;
+    /// heartbeats are either append_entries_request or idle heartbeats
+    template<typename Req>
+    using hbeats_ptr = ss::foreign_ptr<std::unique_ptr<std::vector<Req>>>;
+    template<typename Req>
     struct shard_groupped_hbeat_requests {
-        absl::flat_hash_map<ss::shard_id, hbeats_ptr> shard_requests;
-        std::vector<append_entries_request> group_missing_requests;
+        absl::flat_hash_map<ss::shard_id, hbeats_ptr<Req>> shard_requests;
+        std::vector<Req> group_missing_requests;
     };
 
+    ss::future<append_entries_reply>
+    do_append_entries(append_entries_request&& r) {
+        return _probe.append_entries().then([this, r = std::move(r)]() mutable {
+            auto gr = r.target_group();
+            return dispatch_request(
+              append_entries_request::make_foreign(std::move(r)),
+              [gr]() { return make_missing_group_reply(gr); },
+              [](append_entries_request&& r, consensus_ptr c) {
+                  return c->append_entries(std::move(r));
+              });
+        });
+    }
+
     static ss::future<vote_reply> make_failed_vote_reply() {
         return ss::make_ready_future<vote_reply>(vote_reply{
           .term = model::term_id{}, .granted = false, .log_ok = false});
@@ -191,6 +266,13 @@ private:
             .term = model::term_id{}, .bytes_stored = 0, .success = false});
     }
 
+    static ss::future<install_segment_reply>
+    make_failed_install_segment_reply() {
+        return ss::make_ready_future<install_segment_reply>(
+          install_segment_reply{
+            .term = model::term_id{}, .bytes_stored = 0, .success = false});
+    }
+
     static ss::future<append_entries_reply>
     make_missing_group_reply(raft::group_id group) {
         return ss::make_ready_future<append_entries_reply>(append_entries_reply{
@@ -204,13 +286,23 @@ private:
 
     template<typename Req, typename ErrorFactory, typename Func>
     auto dispatch_request(Req&& req, ErrorFactory&& ef, Func&& f) {
+        return dispatch_request(
+          get_scheduling_group(),
+          std::forward<Req>(req),
+          std::forward<ErrorFactory>(ef),
+          std::forward<Func>(f));
+    }
+
+    template<typename Req, typename ErrorFactory, typename Func>
+    auto dispatch_request(
+      ss::scheduling_group sc, Req&& req, ErrorFactory&& ef, Func&& f) {
         auto group = req.target_group();
         if (unlikely(!_shard_table.contains(group))) {
             return ef();
         }
         auto shard = _shard_table.shard_for(group);
         return with_scheduling_group(
-          get_scheduling_group(),
+          sc,
           [this,
            shard,
            r = std::forward<Req>(req),
@@ -232,8 +324,9 @@ private:
           });
     }
 
+    template<typename Req>
     ss::future<std::vector<append_entries_reply>>
-    dispatch_hbeats_to_core(ss::shard_id shard, hbeats_ptr requests) {
+    dispatch_hbeats_to_core(ss::shard_id shard, hbeats_ptr<Req> requests) {
         return with_scheduling_group(
           get_scheduling_group(),
           [this, shard, r = std::move(requests)]() mutable {
@@ -246,8 +339,9 @@ private:
           });
     }
 
+    template<typename Req>
     ss::future<std::vector<append_entries_reply>>
-    dispatch_hbeats_to_groups(ConsensusManager& m, hbeats_ptr reqs) {
+    dispatch_hbeats_to_groups(ConsensusManager& m, hbeats_ptr<Req> reqs) {
         std::vector<ss::future<append_entries_reply>> futures;
         futures.reserve(reqs->size());
         // dispatch requests in parallel
@@ -256,9 +350,9 @@ private:
           reqs->begin(),
           reqs->end(),
           std::back_inserter(futures),
-          [this, &m, timeout](append_entries_request& req) mutable {
+          [this, &m, timeout](Req& req) mutable {
               auto group = req.target_group();
-              auto f = dispatch_append_entries(m, std::move(req));
+              auto f = dispatch_heartbeat(m, std::move(req));
               return ss::with_timeout(timeout, std::move(f))
                 .handle_exception_type([group](const ss::timed_out_error&) {
                     return append_entries_reply{
@@ -270,19 +364,21 @@ private:
         return ss::when_all_succeed(futures.begin(), futures.end());
     }
 
-    shard_groupped_hbeat_requests group_hbeats_by_shard(hbeats_t reqs) {
-        shard_groupped_hbeat_requests ret;
+    template<typename Req>
+    shard_groupped_hbeat_requests<Req>
+    group_hbeats_by_shard(std::vector<Req> reqs) {
+        shard_groupped_hbeat_requests<Req> ret;
 
         for (auto& r : reqs) {
-            if (unlikely(!_shard_table.contains(r.meta.group))) {
+            if (unlikely(!_shard_table.contains(r.target_group()))) {
                 ret.group_missing_requests.push_back(std::move(r));
                 continue;
             }
 
-            auto shard = _shard_table.shard_for(r.meta.group);
+            auto shard = _shard_table.shard_for(r.target_group());
             if (!ret.shard_requests.contains(shard)) {
                 auto hbeats = ss::make_foreign(
-                  std::make_unique<std::vector<append_entries_request>>());
+                  std::make_unique<std::vector<Req>>());
                 hbeats->push_back(std::move(r));
                 ret.shard_requests.emplace(shard, std::move(hbeats));
                 continue;
@@ -294,7 +390,7 @@ private:
     }
 
     ss::future<append_entries_reply>
-    dispatch_append_entries(ConsensusManager& m, append_entries_request&& r) {
+    dispatch_heartbeat(ConsensusManager& m, append_entries_request&& r) {
         auto group = group_id(r.meta.group);
         auto c = m.consensus_for(group);
         if (unlikely(!c)) {
@@ -303,6 +399,15 @@ private:
         return c->append_entries(std::move(r));
     }
 
+    ss::future<append_entries_reply>
+    dispatch_heartbeat(ConsensusManager& m, idle_heartbeat_metadata&& r) {
+        auto c = m.consensus_for(r.group);
+        if (unlikely(!c)) {
+            return make_missing_group_reply(r.group);
+        }
+        return c->idle_heartbeat(r);
+    }
+
     failure_probes _probe;
     ss::sharded<ConsensusManager>& _group_manager;
     ShardLookup& _shard_table;
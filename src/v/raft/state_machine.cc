@@ -56,19 +56,37 @@ model::offset state_machine::bootstrap_last_applied() const {
 state_machine::batch_applicator::batch_applicator(state_machine* machine)
   : _machine(machine) {}
 
-ss::future<ss::stop_iteration>
-state_machine::batch_applicator::operator()(model::record_batch batch) {
+ss::future<ss::stop_iteration> state_machine::batch_applicator::operator()(
+  model::record_batch_reader::data_t batches) {
     if (_machine->stop_batch_applicator()) {
         return ss::make_ready_future<ss::stop_iteration>(
           ss::stop_iteration::yes);
     }
+    if (batches.empty()) {
+        return ss::make_ready_future<ss::stop_iteration>(
+          ss::stop_iteration::no);
+    }
 
-    auto last_offset = batch.last_offset();
-    return _machine->apply(std::move(batch)).then([this, last_offset] {
-        _last_applied = last_offset;
-        _machine->_waiters.notify(_last_applied);
-        return ss::stop_iteration::no;
-    });
+    auto last_offset = batches.back().last_offset();
+    return _machine->apply_batches(std::move(batches))
+      .then([this, last_offset] {
+          _last_applied = last_offset;
+          _machine->_waiters.notify(_last_applied);
+          return ss::stop_iteration::no;
+      });
+}
+
+ss::future<>
+state_machine::apply_batches(model::record_batch_reader::data_t batches) {
+    return ss::do_with(
+      std::move(batches), [this](model::record_batch_reader::data_t& batches) {
+          return ss::do_for_each(batches, [this](model::record_batch& batch) {
+              auto last_offset = batch.last_offset();
+              return apply(std::move(batch)).then([this, last_offset] {
+                  _waiters.notify(last_offset);
+              });
+          });
+      });
 }
 
 bool state_machine::stop_batch_applicator() { return _gate.is_closed(); }
@@ -104,20 +122,45 @@ ss::future<> state_machine::apply() {
     // wait until consensus commit index is >= _next
     return _raft->events()
       .wait(_next, model::no_timeout, _as)
+      .then([this] {
+          if (_raft->last_snapshot_index() >= _next) {
+              return apply_snapshot();
+          }
+          return ss::now();
+      })
       .then([this] {
           // build a reader for log range [_next, +inf).
           storage::log_reader_config config(
             _next, model::model_limits<model::offset>::max(), _io_prio);
-          return _raft->make_reader(config);
+          if (_batch_type_filter) {
+              // the range is bounded for the machine to move past the
+              // skipped batches once it is read
+              config.type_filter = _batch_type_filter;
+              config.max_offset = _raft->committed_offset();
+          }
+          return _raft->make_reader(config).then(
+            [max_offset = config.max_offset](
+              model::record_batch_reader reader) {
+                return std::make_pair(std::move(reader), max_offset);
+            });
       })
-      .then([this](model::record_batch_reader reader) {
+      .then([this](
+              std::pair<model::record_batch_reader, model::offset> read) {
+          auto& [reader, max_offset] = read;
           // apply each batch to the state machine
           return std::move(reader)
-            .consume(batch_applicator(this), model::no_timeout)
-            .then([this](model::offset last_applied) {
+            .consume_slices(batch_applicator(this), model::no_timeout)
+            .then([this, max_offset = max_offset](model::offset last_applied) {
                 if (last_applied >= model::offset(0)) {
                     _next = last_applied + model::offset(1);
                 }
+                // a stopped applicator may have left batches to apply
+                if (
+                  _batch_type_filter && !stop_batch_applicator()
+                  && max_offset >= _next) {
+                    _next = max_offset + model::offset(1);
+                    _waiters.notify(max_offset);
+                }
             });
       })
       .handle_exception([this](const std::exception_ptr& e) {
@@ -125,6 +168,22 @@ ss::future<> state_machine::apply() {
       });
 }
 
+ss::future<> state_machine::apply_snapshot() {
+    auto last_included = _raft->last_snapshot_index();
+    vlog(
+      _log.info,
+      "Applying snapshot with last included offset {}",
+      last_included);
+    return apply_raft_snapshot(last_included).then([this, last_included] {
+        _next = last_included + model::offset(1);
+        _waiters.notify(last_included);
+    });
+}
+
+ss::future<> state_machine::apply_raft_snapshot(model::offset) {
+    return ss::now();
+}
+
 ss::future<> state_machine::write_last_applied(model::offset o) {
     return _raft->write_last_applied(o);
 }
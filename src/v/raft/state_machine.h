@@ -13,6 +13,7 @@
 #include "model/fundamental.h"
 #include "model/metadata.h"
 #include "model/record.h"
+#include "model/record_batch_reader.h"
 #include "outcome.h"
 #include "raft/offset_monitor.h"
 #include "raft/types.h"
@@ -23,6 +24,8 @@
 #include <seastar/core/gate.hh>
 #include <seastar/util/log.hh>
 
+#include <optional>
+
 namespace raft {
 
 class consensus;
@@ -73,6 +76,23 @@ public:
      * is returned an error is logged and the same batch will be applied again.
      */
     virtual ss::future<> apply(model::record_batch) = 0;
+    /**
+     * Applies consecutive batches of the log, a whole slice of the reader at
+     * a time. The default applies them one at a time with apply(batch) and
+     * notifies the waiters after each of them. A state machine which applies
+     * a run of batches in one pass overrides it, the waiters are then
+     * notified once the whole run is applied.
+     */
+    virtual ss::future<> apply_batches(model::record_batch_reader::data_t);
+    /**
+     * Called when the log starts after the next offset to apply as its prefix
+     * was replaced with a snapshot, either taken locally or installed by the
+     * leader. The state machine should restore its state up to and including
+     * the last included offset from the snapshot content, batches are then
+     * applied from the next offset. The default implementation has no state
+     * to restore.
+     */
+    virtual ss::future<> apply_raft_snapshot(model::offset last_included);
     /**
      * Return last applied offset established when STM starts. This can be used
      * to wait for the entries to be applied when STM is starting.
@@ -102,13 +122,22 @@ public:
 
 protected:
     void set_next(model::offset offset);
+    /// only the batches of the type are applied, the reader skips the others
+    /// and the machine moves past them
+    void set_batch_type_filter(model::record_batch_type t) {
+        _batch_type_filter = t;
+    }
+    model::offset last_applied_offset() const {
+        return _next - model::offset(1);
+    }
     ss::gate _gate;
 
 private:
     class batch_applicator {
     public:
         explicit batch_applicator(state_machine*);
-        ss::future<ss::stop_iteration> operator()(model::record_batch);
+        ss::future<ss::stop_iteration>
+          operator()(model::record_batch_reader::data_t);
         model::offset end_of_stream() const { return _last_applied; }
 
     private:
@@ -119,10 +148,12 @@ private:
     friend batch_applicator;
 
     ss::future<> apply();
+    ss::future<> apply_snapshot();
     bool stop_batch_applicator();
 
     consensus* _raft;
     ss::io_priority_class _io_prio;
+    std::optional<model::record_batch_type> _batch_type_filter;
     ss::logger& _log;
     offset_monitor _waiters;
     model::offset _next;
@@ -15,6 +15,7 @@
 #include "raft/logger.h"
 #include "raft/types.h"
 #include "random/generators.h"
+#include "reflection/adl.h"
 #include "storage/api.h"
 #include "storage/kvstore.h"
 #include "storage/log_manager.h"
@@ -265,3 +266,51 @@ FIXTURE_TEST(test_assigning_initial_revision, config_manager_fixture) {
     BOOST_REQUIRE(
       mgr.get_latest().contains(raft::vnode(model::node_id(1), new_revision)));
 }
+
+FIXTURE_TEST(test_truncation_removes_stored_entries, config_manager_fixture) {
+    auto configurations = test_configurations();
+    _cfg_mgr.truncate(model::offset(34)).get0();
+    _cfg_mgr.prefix_truncate(model::offset(20)).get0();
+
+    // only the configurations at 20 and 33 are left
+    auto keys = raft::configuration_manager::persistent_configuration_keys(
+      _storage.kvs(), raft::group_id(1));
+    BOOST_REQUIRE_EQUAL(keys.size(), 2);
+    for (auto& k : keys) {
+        BOOST_REQUIRE(
+          _storage.kvs().get(storage::kvstore::key_space::consensus, k));
+    }
+    validate_recovery();
+
+    _cfg_mgr.remove_persistent_state().get0();
+    BOOST_REQUIRE(raft::configuration_manager::persistent_configuration_keys(
+                    _storage.kvs(), raft::group_id(1))
+                    .empty());
+}
+
+FIXTURE_TEST(test_migrating_configurations_map, config_manager_fixture) {
+    // single map of all configurations, as stored by previous versions
+    auto cfg = random_configuration();
+    iobuf map;
+    reflection::serialize(map, uint64_t(1), model::offset(10), cfg);
+    iobuf key;
+    reflection::serialize(
+      key, raft::metadata_key::config_map, raft::group_id(1));
+    _storage.kvs()
+      .put(
+        storage::kvstore::key_space::consensus,
+        iobuf_to_bytes(key),
+        std::move(map))
+      .get0();
+
+    _cfg_mgr.start(false, model::revision_id(0)).get0();
+    BOOST_REQUIRE_EQUAL(_cfg_mgr.get(model::offset(10)), cfg);
+    BOOST_REQUIRE(!_storage.kvs().get(
+      storage::kvstore::key_space::consensus, iobuf_to_bytes(key)));
+    BOOST_REQUIRE_EQUAL(
+      raft::configuration_manager::persistent_configuration_keys(
+        _storage.kvs(), raft::group_id(1))
+        .size(),
+      1);
+    validate_recovery();
+}
@@ -15,6 +15,7 @@
 #include "raft/types.h"
 #include "random/generators.h"
 #include "reflection/adl.h"
+#include "ssx/sformat.h"
 #include "storage/record_batch_builder.h"
 #include "storage/tests/utils/disk_log_builder.h"
 #include "storage/tests/utils/random_batch.h"
@@ -22,6 +23,7 @@
 #include "test_utils/fixture.h"
 
 #include <seastar/core/abort_source.hh>
+#include <seastar/core/coroutine.hh>
 #include <seastar/core/future.hh>
 #include <seastar/core/sleep.hh>
 #include <seastar/util/defer.hh>
@@ -30,6 +32,7 @@
 #include <boost/range/irange.hpp>
 #include <boost/test/tools/old/interface.hpp>
 
+#include <algorithm>
 #include <thread>
 
 using namespace std::chrono_literals;
@@ -165,6 +168,26 @@ struct simple_kv {
     }
 };
 
+// applies the runs of batches in one pass
+template<int8_t bt>
+struct batched_kv : simple_kv<bt> {
+    size_t runs{0};
+    size_t batches{0};
+
+    using simple_kv<bt>::apply_update;
+
+    ss::future<std::vector<std::error_code>>
+    apply_update(std::vector<model::record_batch> run) {
+        ++runs;
+        batches += run.size();
+        std::vector<std::error_code> results;
+        for (auto& b : run) {
+            results.push_back(co_await this->do_apply_update(std::move(b)));
+        }
+        co_return results;
+    }
+};
+
 ss::logger kvlog{"kv-test"};
 
 template<typename T>
@@ -292,6 +315,41 @@ FIXTURE_TEST(test_concurrent_sets, mux_state_machine_fixture) {
     BOOST_REQUIRE_EQUAL(success_count, 1);
 }
 
+FIXTURE_TEST(test_batched_state, mux_state_machine_fixture) {
+    start_raft();
+    batched_kv<batch_type_1> state;
+    raft::mux_state_machine stm(
+      kvlog, _raft.get(), raft::persistent_last_applied::yes, state);
+    stm.start().get0();
+    wait_for_leader();
+    ss::abort_source as;
+    auto stop = ss::defer([&stm] { stm.stop().get0(); });
+    auto range = boost::irange(0, 50);
+    std::vector<ss::future<std::error_code>> futures;
+    futures.reserve(range.size());
+    std::transform(
+      range.begin(),
+      range.end(),
+      std::back_inserter(futures),
+      [&stm, &as](int i) {
+          return stm.replicate_and_wait(
+            serialize_cmd(
+              set_cmd{ssx::sformat("key-{}", i % 10), i}, batch_type_1),
+            model::timeout_clock::now() + 2s,
+            as);
+      });
+
+    auto results = ss::when_all_succeed(futures.begin(), futures.end()).get0();
+
+    // each of the batches has its own result, whichever run applied it
+    auto success_count = std::count(
+      results.begin(), results.end(), std::error_code(errc::success));
+    BOOST_REQUIRE_EQUAL(success_count, 10);
+    BOOST_REQUIRE_EQUAL(state.kv_map.size(), 10);
+    BOOST_REQUIRE_EQUAL(state.batches, 50);
+    BOOST_REQUIRE_LE(state.runs, state.batches);
+}
+
 FIXTURE_TEST(test_stm_recovery, mux_state_machine_fixture) {
     {
         auto cfg = storage::log_builder_config();
@@ -272,3 +272,53 @@ SEASTAR_THREAD_TEST_CASE(wait_abort_source_with_timeout_abort_before_timeout) {
 
     BOOST_REQUIRE(mon.empty());
 }
+
+SEASTAR_THREAD_TEST_CASE(wait_timeouts_share_timer) {
+    raft::offset_monitor mon;
+    auto now = model::timeout_clock::now();
+
+    // deadlines and offsets out of order
+    auto f_late = mon.wait(
+      model::offset(5), now + std::chrono::milliseconds(200), std::nullopt);
+    auto f_early = mon.wait(
+      model::offset(1), now + std::chrono::milliseconds(20), std::nullopt);
+    auto f_notified = mon.wait(
+      model::offset(3), now + std::chrono::milliseconds(10), std::nullopt);
+    auto f_forever = mon.wait(model::offset(2), model::no_timeout, std::nullopt);
+
+    mon.notify(model::offset(3));
+    BOOST_REQUIRE(f_notified.available());
+    BOOST_REQUIRE_NO_THROW(f_notified.get());
+    BOOST_REQUIRE(f_early.available());
+    BOOST_REQUIRE_NO_THROW(f_early.get());
+    BOOST_REQUIRE(f_forever.available());
+    BOOST_REQUIRE_NO_THROW(f_forever.get());
+    BOOST_REQUIRE(!f_late.available());
+    BOOST_REQUIRE(!mon.empty());
+
+    BOOST_REQUIRE_THROW(f_late.get(), raft::offset_monitor::wait_aborted);
+    BOOST_REQUIRE(mon.empty());
+}
+
+SEASTAR_THREAD_TEST_CASE(many_waiters_notified_in_one_sweep) {
+    raft::offset_monitor mon;
+    ss::abort_source as;
+    std::vector<ss::future<>> fs;
+    for (int i = 0; i < 1000; ++i) {
+        fs.push_back(mon.wait(
+          model::offset(i % 2 ? i : 999 - i),
+          model::timeout_clock::now() + std::chrono::seconds(30),
+          as));
+    }
+    mon.notify(model::offset(499));
+    size_t done = std::count_if(
+      fs.begin(), fs.end(), [](ss::future<>& f) { return f.available(); });
+    BOOST_REQUIRE_EQUAL(done, 500);
+
+    as.request_abort();
+    BOOST_REQUIRE(mon.empty());
+    for (auto& f : fs) {
+        BOOST_REQUIRE(f.available());
+        f.ignore_ready_future();
+    }
+}
@@ -131,7 +131,8 @@ struct raft_node {
           std::chrono::seconds(10),
           raft::make_rpc_client_protocol(self_id, cache),
           [this](raft::leadership_status st) { leader_callback(st); },
-          storage.local());
+          storage.local(),
+          recovery_throttle);
 
         // create connections to initial nodes
         consensus->config().for_each_broker(
@@ -294,6 +295,7 @@ struct raft_node {
     ss::sharded<rpc::server> server;
     ss::sharded<test_raft_manager> raft_manager;
     std::unique_ptr<raft::heartbeat_manager> hbeats;
+    raft::recovery_throttle recovery_throttle{0};
     consensus_ptr consensus;
     std::unique_ptr<raft::log_eviction_stm> _nop_stm;
     leader_clb_t leader_callback;
@@ -0,0 +1,612 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "config/configuration.h"
+#include "model/metadata.h"
+#include "model/record_batch_reader.h"
+#include "raft/consensus.h"
+#include "raft/group_manager.h"
+#include "raft/service.h"
+#include "raft/types.h"
+#include "random/generators.h"
+#include "rpc/connection_cache.h"
+#include "rpc/server.h"
+#include "rpc/simple_protocol.h"
+#include "ssx/sformat.h"
+#include "storage/api.h"
+#include "storage/log_manager.h"
+#include "storage/ntp_config.h"
+#include "storage/record_batch_builder.h"
+#include "syschecks/syschecks.h"
+#include "utils/hdr_hist.h"
+#include "vlog.h"
+
+#include <seastar/core/app-template.hh>
+#include <seastar/core/semaphore.hh>
+#include <seastar/core/sharded.hh>
+#include <seastar/core/sleep.hh>
+#include <seastar/core/thread.hh>
+
+#include <absl/container/flat_hash_map.h>
+#include <boost/range/irange.hpp>
+#include <fmt/format.h>
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <deque>
+
+/*
+ * Scale harness for raft. Stands up in-process nodes that replicate the same
+ * set of raft groups, drives a produce load against the group leaders and
+ * reports:
+ *
+ *   - CPU used by the nodes while all groups are idle, that is the cost of
+ *     heartbeats
+ *   - replicate latency
+ *   - RPC requests and bytes per second while idle and under load
+ *   - time to elect new leaders for the groups of a killed node
+ *
+ * The reactor busy-polls when idle, which shows up as used CPU. Run with
+ * --idle-poll-time-us=0 to make the heartbeat CPU figure meaningful.
+ *
+ *   raft_scale_bench --smp 1 --idle-poll-time-us=0 --nodes 3 --groups 5000
+ */
+
+using namespace std::chrono_literals; // NOLINT
+
+namespace po = boost::program_options; // NOLINT
+
+static ss::logger benchlog("raft_bench");
+
+using consensus_ptr = ss::lw_shared_ptr<raft::consensus>;
+
+struct bench_config {
+    int nodes;
+    int groups;
+    std::chrono::seconds idle_duration;
+    std::chrono::seconds load_duration;
+    double produce_rate;
+    size_t batch_size;
+    size_t max_inflight;
+    std::chrono::milliseconds heartbeat_interval;
+    uint16_t base_port;
+    ss::sstring workdir;
+    bool kill_node;
+};
+
+static void cli_opts(po::options_description_easy_init o) {
+    o("nodes", po::value<int>()->default_value(3), "number of nodes");
+    o("groups",
+      po::value<int>()->default_value(1000),
+      "number of raft groups, every node replicates all of them");
+    o("idle-duration-s",
+      po::value<int>()->default_value(10),
+      "duration of the idle phase measuring heartbeat cost");
+    o("load-duration-s",
+      po::value<int>()->default_value(30),
+      "duration of the produce phase");
+    o("produce-rate",
+      po::value<double>()->default_value(1000),
+      "replicate requests per second, spread over all groups at random");
+    o("batch-size",
+      po::value<size_t>()->default_value(1024),
+      "size of the value of a replicated batch in bytes");
+    o("max-inflight",
+      po::value<size_t>()->default_value(10000),
+      "maximum number of outstanding replicate requests");
+    o("heartbeat-interval-ms",
+      po::value<int>()->default_value(150),
+      "raft heartbeat interval");
+    o("base-port",
+      po::value<uint16_t>()->default_value(35000),
+      "rpc port of the first node, the other nodes use the following ones");
+    o("workdir",
+      po::value<ss::sstring>()->default_value("."),
+      "directory in which the data of all the nodes is created");
+    o("kill-node",
+      po::value<bool>()->default_value(true),
+      "kill a node at the end and measure elections");
+}
+
+static bench_config cfg_from(const po::variables_map& m) {
+    return bench_config{
+      .nodes = m["nodes"].as<int>(),
+      .groups = m["groups"].as<int>(),
+      .idle_duration = std::chrono::seconds(m["idle-duration-s"].as<int>()),
+      .load_duration = std::chrono::seconds(m["load-duration-s"].as<int>()),
+      .produce_rate = m["produce-rate"].as<double>(),
+      .batch_size = m["batch-size"].as<size_t>(),
+      .max_inflight = m["max-inflight"].as<size_t>(),
+      .heartbeat_interval = std::chrono::milliseconds(
+        m["heartbeat-interval-ms"].as<int>()),
+      .base_port = m["base-port"].as<uint16_t>(),
+      .workdir = m["workdir"].as<ss::sstring>(),
+      .kill_node = m["kill-node"].as<bool>(),
+    };
+}
+
+/// all the groups of a node live on shard 0
+struct group_registry {
+    consensus_ptr consensus_for(raft::group_id g) {
+        auto it = groups.find(g);
+        return it == groups.end() ? nullptr : it->second;
+    }
+
+    absl::flat_hash_map<raft::group_id, consensus_ptr> groups;
+};
+
+struct shard_lookup {
+    ss::shard_id shard_for(raft::group_id) { return 0; }
+    bool contains(raft::group_id) { return true; }
+};
+
+struct rpc_stats {
+    uint64_t requests = 0;
+    uint64_t bytes = 0;
+
+    rpc_stats operator+(const rpc_stats& o) const {
+        return {requests + o.requests, bytes + o.bytes};
+    }
+    rpc_stats operator-(const rpc_stats& o) const {
+        return {requests - o.requests, bytes - o.bytes};
+    }
+};
+
+class bench_node {
+public:
+    bench_node(model::broker b, const bench_config& cfg)
+      : _broker(std::move(b))
+      , _cfg(cfg) {}
+
+    bench_node(const bench_node&) = delete;
+    bench_node& operator=(const bench_node&) = delete;
+
+    void start(const std::vector<model::broker>& brokers) {
+        auto dir = ssx::sformat("{}/raft_bench_{}", _cfg.workdir, id()());
+        cache.start().get();
+        storage
+          .start(
+            storage::kvstore_config(
+              1_MiB, 10ms, dir, storage::debug_sanitize_files::no),
+            storage::log_config(
+              storage::log_config::storage_type::disk,
+              dir,
+              100_MiB,
+              storage::debug_sanitize_files::no))
+          .get();
+        storage.invoke_on_all(&storage::api::start).get();
+        group_manager
+          .start(
+            id(),
+            model::timeout_clock::duration(10s),
+            _cfg.heartbeat_interval,
+            _cfg.heartbeat_interval * 20,
+            std::ref(cache),
+            std::ref(storage))
+          .get();
+        group_manager.invoke_on_all(&raft::group_manager::start).get();
+        registry.start().get();
+
+        rpc::server_configuration scfg("raft_bench_rpc");
+        scfg.addrs.emplace_back(
+          ss::socket_address(ss::ipv4_addr("127.0.0.1", port_of(id()))));
+        scfg.max_service_memory_per_core = 1_GiB;
+        scfg.disable_metrics = rpc::metrics_disabled::yes;
+        server.start(std::move(scfg)).get();
+        server
+          .invoke_on_all([this](rpc::server& s) {
+              auto proto = std::make_unique<rpc::simple_protocol>();
+              proto->register_service<
+                raft::service<group_registry, shard_lookup>>(
+                ss::default_scheduling_group(),
+                ss::default_smp_service_group(),
+                registry,
+                _lookup,
+                _cfg.heartbeat_interval);
+              s.set_protocol(std::move(proto));
+          })
+          .get();
+        server.invoke_on_all(&rpc::server::start).get();
+
+        for (const auto& b : brokers) {
+            if (b.id() != id()) {
+                connect_to(b);
+            }
+        }
+        _running = true;
+    }
+
+    void create_groups(const std::vector<model::broker>& brokers) {
+        auto& gm = group_manager.local();
+        auto& reg = registry.local();
+        for (auto g : boost::irange(0, _cfg.groups)) {
+            auto group = raft::group_id(g);
+            auto ntp = model::ntp(
+              model::ns("bench"), model::topic("raft"), model::partition_id(g));
+            auto log = storage.local()
+                         .log_mgr()
+                         .manage(storage::ntp_config(
+                           ntp, storage.local().log_mgr().config().base_dir))
+                         .get0();
+            auto c = gm.create_group(group, brokers, log).get0();
+            c->start().get();
+            reg.groups.emplace(group, std::move(c));
+        }
+    }
+
+    /// stops the raft and rpc layers, the way a crashed node disappears
+    void kill() {
+        if (!_running) {
+            return;
+        }
+        _running = false;
+        server.stop().get();
+        group_manager.stop().get();
+        cache.stop().get();
+    }
+
+    void stop() {
+        kill();
+        registry.stop().get();
+        storage.stop().get();
+    }
+
+    bool running() const { return _running; }
+
+    model::node_id id() const { return _broker.id(); }
+
+    consensus_ptr consensus_for(raft::group_id g) {
+        return registry.local().consensus_for(g);
+    }
+
+    rpc_stats rpc_totals() {
+        return server
+          .map_reduce0(
+            [](const rpc::server& s) {
+                return rpc_stats{
+                  s.probe().requests_completed(),
+                  s.probe().bytes_received() + s.probe().bytes_sent()};
+            },
+            rpc_stats{},
+            std::plus<>())
+          .get0();
+    }
+
+    uint16_t port_of(model::node_id n) const { return _cfg.base_port + n(); }
+
+    ss::sharded<rpc::connection_cache> cache;
+    ss::sharded<storage::api> storage;
+    ss::sharded<raft::group_manager> group_manager;
+    ss::sharded<group_registry> registry;
+    ss::sharded<rpc::server> server;
+
+private:
+    void connect_to(const model::broker& b) {
+        auto addr = ss::socket_address(
+          ss::ipv4_addr("127.0.0.1", port_of(b.id())));
+        for (ss::shard_id i = 0; i < ss::smp::count; ++i) {
+            auto sh = rpc::connection_cache::shard_for(id(), i, b.id());
+            cache
+              .invoke_on(
+                sh,
+                [id = b.id(), addr](rpc::connection_cache& c) {
+                    if (c.contains(id)) {
+                        return ss::now();
+                    }
+                    return c.emplace(
+                      id,
+                      {.server_addr = addr,
+                       .disable_metrics = rpc::metrics_disabled::yes},
+                      rpc::make_exponential_backoff_policy<rpc::clock_type>(
+                        std::chrono::milliseconds(10),
+                        std::chrono::milliseconds(500)));
+                })
+              .get();
+        }
+    }
+
+    model::broker _broker;
+    const bench_config& _cfg;
+    shard_lookup _lookup;
+    bool _running = false;
+};
+
+/// CPU time used by the reactor threads of all shards
+static std::chrono::microseconds reactors_cpu_time() {
+    auto shards = boost::irange<ss::shard_id>(0, ss::smp::count);
+    return ss::map_reduce(
+             shards.begin(),
+             shards.end(),
+             [](ss::shard_id s) {
+                 return ss::smp::submit_to(s, [] {
+                     rusage ru{};
+                     ::getrusage(RUSAGE_THREAD, &ru);
+                     auto to_us = [](timeval tv) {
+                         return std::chrono::seconds(tv.tv_sec)
+                                + std::chrono::microseconds(tv.tv_usec);
+                     };
+                     return std::chrono::duration_cast<
+                       std::chrono::microseconds>(
+                       to_us(ru.ru_utime) + to_us(ru.ru_stime));
+                 });
+             },
+             std::chrono::microseconds(0),
+             std::plus<>())
+      .get0();
+}
+
+class raft_bench {
+public:
+    explicit raft_bench(bench_config cfg)
+      : _cfg(std::move(cfg))
+      , _payload(bytes_to_iobuf(random_generators::get_bytes(_cfg.batch_size)))
+      , _inflight(_cfg.max_inflight) {}
+
+    void run() {
+        start_nodes();
+        wait_for_leaders();
+        idle_phase();
+        load_phase();
+        if (_cfg.kill_node) {
+            kill_phase();
+        }
+        for (auto& n : _nodes) {
+            n.stop();
+        }
+    }
+
+private:
+    void start_nodes() {
+        for (auto i : boost::irange(0, _cfg.nodes)) {
+            auto id = model::node_id(i);
+            _brokers.emplace_back(
+              id,
+              unresolved_address("127.0.0.1", 9092),
+              unresolved_address("127.0.0.1", _cfg.base_port + i),
+              std::nullopt,
+              model::broker_properties{.cores = ss::smp::count});
+        }
+        for (auto& b : _brokers) {
+            _nodes.emplace_back(b, _cfg);
+            _nodes.back().start(_brokers);
+        }
+        for (auto& n : _nodes) {
+            vlog(
+              benchlog.info, "Creating {} groups on {}", _cfg.groups, n.id());
+            n.create_groups(_brokers);
+        }
+    }
+
+    consensus_ptr leader_of(raft::group_id g) {
+        for (auto& n : _nodes) {
+            if (!n.running()) {
+                continue;
+            }
+            if (auto c = n.consensus_for(g); c && c->is_leader()) {
+                return c;
+            }
+        }
+        return nullptr;
+    }
+
+    void wait_for_leaders() {
+        auto started = ss::lowres_clock::now();
+        for (auto g : boost::irange(0, _cfg.groups)) {
+            while (!leader_of(raft::group_id(g))) {
+                ss::sleep(10ms).get();
+            }
+        }
+        vlog(
+          benchlog.info,
+          "All {} groups elected leaders in {}ms",
+          _cfg.groups,
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+            ss::lowres_clock::now() - started)
+            .count());
+    }
+
+    rpc_stats rpc_totals() {
+        rpc_stats total;
+        for (auto& n : _nodes) {
+            if (n.running()) {
+                total = total + n.rpc_totals();
+            }
+        }
+        return total;
+    }
+
+    void report_rpc(std::string_view phase, rpc_stats s, double seconds) {
+        fmt::print(
+          "{}: rpc requests/s: {:.0f}, rpc bytes/s: {:.0f}\n",
+          phase,
+          s.requests / seconds,
+          s.bytes / seconds);
+    }
+
+    void idle_phase() {
+        vlog(benchlog.info, "Idle phase for {}s", _cfg.idle_duration.count());
+        auto rpc_before = rpc_totals();
+        auto cpu_before = reactors_cpu_time();
+        ss::sleep(_cfg.idle_duration).get();
+        auto cpu = reactors_cpu_time() - cpu_before;
+        auto rpc = rpc_totals() - rpc_before;
+        double seconds = _cfg.idle_duration.count();
+        fmt::print(
+          "idle: heartbeat cpu: {:.2f}% of a core for {} nodes with {} "
+          "groups\n",
+          100.0 * cpu.count() / (seconds * 1'000'000),
+          _cfg.nodes,
+          _cfg.groups);
+        report_rpc("idle", rpc, seconds);
+    }
+
+    ss::future<> replicate_one(raft::group_id g) {
+        auto c = leader_of(g);
+        if (!c) {
+            ++_errors;
+            return ss::now();
+        }
+        storage::record_batch_builder builder(
+          raft::data_batch_type, model::offset(0));
+        builder.add_raw_kv(iobuf(), _payload.copy());
+        auto started = std::chrono::steady_clock::now();
+        return c
+          ->replicate(
+            model::make_memory_record_batch_reader(std::move(builder).build()),
+            raft::replicate_options(raft::consistency_level::quorum_ack))
+          .then_wrapped([this, started](
+                          ss::future<result<raft::replicate_result>> f) {
+              if (f.failed()) {
+                  f.ignore_ready_future();
+                  ++_errors;
+                  return;
+              }
+              if (!f.get0()) {
+                  ++_errors;
+                  return;
+              }
+              _latency.record(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                  std::chrono::steady_clock::now() - started)
+                  .count());
+          });
+    }
+
+    void load_phase() {
+        vlog(
+          benchlog.info,
+          "Load phase for {}s at {} replicate requests/s",
+          _cfg.load_duration.count(),
+          _cfg.produce_rate);
+        static constexpr auto tick = 1ms;
+        auto rpc_before = rpc_totals();
+        auto started = std::chrono::steady_clock::now();
+        auto deadline = started + _cfg.load_duration;
+        ss::gate requests;
+        double credit = 0;
+        uint64_t sent = 0;
+        auto last = started;
+        while (std::chrono::steady_clock::now() < deadline) {
+            auto now = std::chrono::steady_clock::now();
+            credit += _cfg.produce_rate
+                      * std::chrono::duration<double>(now - last).count();
+            last = now;
+            for (; credit >= 1; credit -= 1) {
+                auto units = ss::get_units(_inflight, 1).get0();
+                auto g = raft::group_id(
+                  random_generators::get_int(_cfg.groups - 1));
+                ++sent;
+                (void)ss::with_gate(requests, [this, g] {
+                    return replicate_one(g);
+                }).finally([u = std::move(units)] {});
+            }
+            ss::sleep(tick).get();
+        }
+        requests.close().get();
+        double seconds = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - started)
+                           .count();
+        auto rpc = rpc_totals() - rpc_before;
+        fmt::print(
+          "load: replicated {} of {} requests ({:.0f}/s), errors: {}\n",
+          sent - _errors,
+          sent,
+          (sent - _errors) / seconds,
+          _errors);
+        fmt::print(
+          "load: replicate latency us p50: {}, p90: {}, p99: {}, p999: {}, "
+          "max: {}\n",
+          _latency.get_value_at(50),
+          _latency.get_value_at(90),
+          _latency.get_value_at(99),
+          _latency.get_value_at(99.9),
+          _latency.get_value_at(100));
+        report_rpc("load", rpc, seconds);
+    }
+
+    void kill_phase() {
+        // the node leading the most groups
+        absl::flat_hash_map<model::node_id, std::vector<raft::group_id>> led;
+        for (auto g : boost::irange(0, _cfg.groups)) {
+            if (auto c = leader_of(raft::group_id(g)); c) {
+                led[c->self().id()].push_back(raft::group_id(g));
+            }
+        }
+        auto victim = std::max_element(
+          led.begin(), led.end(), [](const auto& a, const auto& b) {
+              return a.second.size() < b.second.size();
+          });
+        if (victim == led.end()) {
+            return;
+        }
+        auto& node = *std::find_if(
+          _nodes.begin(), _nodes.end(), [id = victim->first](bench_node& n) {
+              return n.id() == id;
+          });
+        auto groups = std::move(victim->second);
+        vlog(
+          benchlog.info,
+          "Killing node {} leading {} groups",
+          node.id(),
+          groups.size());
+
+        hdr_hist elections;
+        auto killed = std::chrono::steady_clock::now();
+        node.kill();
+        auto deadline = killed + 60s;
+        while (!groups.empty() && std::chrono::steady_clock::now() < deadline) {
+            auto now = std::chrono::steady_clock::now();
+            std::erase_if(groups, [&](raft::group_id g) {
+                if (!leader_of(g)) {
+                    return false;
+                }
+                elections.record(
+                  std::chrono::duration_cast<std::chrono::milliseconds>(
+                    now - killed)
+                    .count());
+                return true;
+            });
+            ss::sleep(5ms).get();
+        }
+        fmt::print(
+          "kill: leader election ms p50: {}, p99: {}, max: {}, groups "
+          "without leader after 60s: {}\n",
+          elections.get_value_at(50),
+          elections.get_value_at(99),
+          elections.get_value_at(100),
+          groups.size());
+    }
+
+    bench_config _cfg;
+    iobuf _payload;
+    ss::semaphore _inflight;
+    std::vector<model::broker> _brokers;
+    std::deque<bench_node> _nodes;
+    hdr_hist _latency;
+    uint64_t _errors = 0;
+};
+
+int main(int args, char** argv, char** env) {
+    syschecks::initialize_intrinsics();
+    std::setvbuf(stdout, nullptr, _IOLBF, 1024);
+    ss::app_template app;
+    cli_opts(app.add_options());
+    return app.run(args, argv, [&] {
+        return ss::async([&] {
+            // every node registers the same metrics
+            ss::smp::invoke_on_all([] {
+                config::shard_local_cfg().get("disable_metrics").set_value(
+                  true);
+            }).get();
+            raft_bench bench(cfg_from(app.configuration()));
+            bench.run();
+        });
+    });
+}
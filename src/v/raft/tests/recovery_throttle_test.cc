@@ -0,0 +1,54 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "raft/recovery_throttle.h"
+
+#include <seastar/core/sleep.hh>
+#include <seastar/testing/thread_test_case.hh>
+
+using namespace std::chrono_literals;
+
+SEASTAR_THREAD_TEST_CASE(test_disabled_throttle_does_not_wait) {
+    raft::recovery_throttle throttle(0);
+    throttle.start().get();
+    auto f = throttle.throttle(1024 * 1024);
+    BOOST_REQUIRE(f.available());
+    f.get();
+    throttle.stop().get();
+}
+
+SEASTAR_THREAD_TEST_CASE(test_throttle_waits_for_refill) {
+    raft::recovery_throttle throttle(1000);
+    throttle.start().get();
+    // whole bucket is available after start
+    throttle.throttle(1000).get();
+    auto f = throttle.throttle(100);
+    BOOST_REQUIRE(!f.available());
+    // one refresh interval adds 100 bytes
+    ss::sleep(raft::recovery_throttle::refresh_interval * 3).get();
+    BOOST_REQUIRE(f.available());
+    f.get();
+    throttle.stop().get();
+}
+
+SEASTAR_THREAD_TEST_CASE(test_request_bigger_than_bucket) {
+    raft::recovery_throttle throttle(1000);
+    throttle.start().get();
+    throttle.throttle(10 * 1000).get();
+    throttle.stop().get();
+}
+
+SEASTAR_THREAD_TEST_CASE(test_stop_wakes_up_waiters) {
+    raft::recovery_throttle throttle(1000);
+    throttle.start().get();
+    throttle.throttle(1000).get();
+    auto f = throttle.throttle(1000);
+    throttle.stop().get();
+    BOOST_REQUIRE_THROW(f.get(), ss::broken_semaphore);
+}
@@ -101,6 +101,73 @@ SEASTAR_THREAD_TEST_CASE(append_entries_requests) {
       .get0();
 }
 
+SEASTAR_THREAD_TEST_CASE(append_entries_batch_request_roundtrip) {
+    static constexpr int groups = 10;
+    raft::append_entries_batch_request req;
+    std::vector<ss::circular_buffer<model::record_batch>> expected;
+    for (int g = 0; g < groups; ++g) {
+        auto batches = storage::test::make_random_batches(
+          model::offset(g * 100), 1 + g % 3, false);
+        auto readers = raft::details::share_n(
+                         model::make_memory_record_batch_reader(
+                           std::move(batches)),
+                         2)
+                         .get0();
+        expected.push_back(model::consume_reader_to_memory(
+                             std::move(readers.front()), model::no_timeout)
+                             .get0());
+        req.requests.emplace_back(
+          raft::vnode(model::node_id(1), model::revision_id(g)),
+          raft::vnode(model::node_id(2), model::revision_id(g)),
+          raft::protocol_metadata{
+            .group = raft::group_id(g), .term = model::term_id(g)},
+          std::move(readers.back()));
+    }
+
+    auto d = async_serialize_roundtrip_rpc(std::move(req)).get0();
+
+    BOOST_REQUIRE_EQUAL(d.requests.size(), groups);
+    for (int g = 0; g < groups; ++g) {
+        auto& r = d.requests[g];
+        BOOST_REQUIRE_EQUAL(
+          r.node_id, raft::vnode(model::node_id(1), model::revision_id(g)));
+        BOOST_REQUIRE_EQUAL(
+          r.target_node_id,
+          raft::vnode(model::node_id(2), model::revision_id(g)));
+        BOOST_REQUIRE_EQUAL(r.meta.group, raft::group_id(g));
+        BOOST_REQUIRE_EQUAL(r.meta.term, model::term_id(g));
+        r.batches
+          .consume(checking_consumer(std::move(expected[g])), model::no_timeout)
+          .get0();
+    }
+}
+
+SEASTAR_THREAD_TEST_CASE(append_entries_batch_reply_roundtrip) {
+    raft::append_entries_batch_reply reply;
+    for (int g = 0; g < 3; ++g) {
+        reply.replies.push_back(raft::append_entries_reply{
+          .group = raft::group_id(g),
+          .term = model::term_id(g),
+          .result = raft::append_entries_reply::status::success});
+    }
+    reply.errors = {
+      raft::errc::success,
+      raft::errc::append_entries_dispatch_error,
+      raft::errc::success};
+
+    auto d = serialize_roundtrip_rpc(std::move(reply));
+
+    BOOST_REQUIRE_EQUAL(d.replies.size(), 3);
+    BOOST_REQUIRE_EQUAL(d.errors.size(), 3);
+    for (int g = 0; g < 3; ++g) {
+        BOOST_REQUIRE_EQUAL(d.replies[g].group, raft::group_id(g));
+        BOOST_REQUIRE_EQUAL(d.replies[g].term, model::term_id(g));
+    }
+    BOOST_REQUIRE(d.errors[0] == raft::errc::success);
+    BOOST_REQUIRE(d.errors[1] == raft::errc::append_entries_dispatch_error);
+    BOOST_REQUIRE(d.errors[2] == raft::errc::success);
+}
+
 model::broker create_test_broker() {
     return model::broker(
       model::node_id(random_generators::get_int(1000)), // id
@@ -161,6 +228,50 @@ SEASTAR_THREAD_TEST_CASE(heartbeat_request_roundtrip) {
           raft::vnode(model::node_id(one_k), model::revision_id(i)));
     }
 }
+SEASTAR_THREAD_TEST_CASE(heartbeat_request_roundtrip_with_idle) {
+    static constexpr int64_t groups = 100;
+    auto make_request = [](int64_t full) {
+        raft::heartbeat_request req;
+        for (int64_t i = 0; i < groups; ++i) {
+            if (i < full) {
+                raft::heartbeat_metadata hb;
+                hb.node_id = raft::vnode(
+                  model::node_id(1), model::revision_id(i));
+                hb.target_node_id = raft::vnode(
+                  model::node_id(2), model::revision_id(i));
+                hb.meta.group = raft::group_id(i);
+                hb.meta.term = model::term_id(i);
+                req.heartbeats.push_back(hb);
+                continue;
+            }
+            // out of order, the encoder sorts them by group
+            req.idle_heartbeats.push_back(raft::idle_heartbeat_metadata{
+              .group = raft::group_id(groups + full - i),
+              .term = model::term_id(i % 7)});
+        }
+        return req;
+    };
+
+    for (int64_t full : {int64_t(0), groups / 2, groups}) {
+        auto res = async_serialize_roundtrip_rpc(make_request(full)).get0();
+        BOOST_REQUIRE_EQUAL(res.heartbeats.size(), full);
+        BOOST_REQUIRE_EQUAL(res.idle_heartbeats.size(), groups - full);
+        for (int64_t i = 0; i < full; ++i) {
+            BOOST_REQUIRE_EQUAL(
+              res.heartbeats[i].meta.group, raft::group_id(i));
+        }
+        for (size_t i = 0; i < res.idle_heartbeats.size(); ++i) {
+            // sorted by group
+            auto expected = groups - int64_t(res.idle_heartbeats.size()) + 1
+                            + int64_t(i);
+            auto& hb = res.idle_heartbeats[i];
+            BOOST_REQUIRE_EQUAL(hb.group, raft::group_id(expected));
+            BOOST_REQUIRE_EQUAL(
+              hb.term, model::term_id((groups + full - expected) % 7));
+        }
+    }
+}
+
 SEASTAR_THREAD_TEST_CASE(heartbeat_request_roundtrip_with_negative) {
     static constexpr int64_t one_k = 10;
     raft::heartbeat_request req;
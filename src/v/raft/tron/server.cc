@@ -136,7 +136,8 @@ public:
                               st.current_leader.value(),
                               st.group);
                         },
-                        _storage);
+                        _storage,
+                        _recovery_throttle);
                       return _consensus->start().then(
                         [this] { return _hbeats.register_group(_consensus); });
                   });
@@ -154,6 +155,7 @@ private:
     raft::consensus_client_protocol _consensus_client_protocol;
     storage::api _storage;
     raft::heartbeat_manager _hbeats;
+    raft::recovery_throttle _recovery_throttle{0};
     model::ntp _ntp{
       model::ns("master_control_program"),
       model::topic("tron"),
@@ -20,6 +20,7 @@
 
 #include <fmt/ostream.h>
 
+#include <tuple>
 #include <type_traits>
 
 namespace raft {
@@ -62,6 +63,10 @@ std::ostream& operator<<(std::ostream& o, const heartbeat_request& r) {
           << "node_id: " << m.node_id << ","
           << "target_node_id: " << m.target_node_id << ",";
     }
+    o << "], idle:(" << r.idle_heartbeats.size() << ") [";
+    for (auto& m : r.idle_heartbeats) {
+        o << "{group: " << m.group << ", term: " << m.term << "},";
+    }
     return o << "]}";
 }
 std::ostream& operator<<(std::ostream& o, const heartbeat_reply& r) {
@@ -132,6 +137,56 @@ std::ostream& operator<<(std::ostream& o, const install_snapshot_request& r) {
     return o;
 }
 
+std::ostream&
+operator<<(std::ostream& o, install_segment_request::file_type t) {
+    switch (t) {
+    case install_segment_request::file_type::data:
+        return o << "data";
+    case install_segment_request::file_type::index:
+        return o << "index";
+    case install_segment_request::file_type::compacted_index:
+        return o << "compacted_index";
+    }
+    return o << "unknown";
+}
+
+std::ostream& operator<<(std::ostream& o, const install_segment_request& r) {
+    fmt::print(
+      o,
+      "{{term: {}, group: {}, target_node_id: {}, node_id: {}, "
+      "prev_log_index: {}, prev_log_term: {}, base_offset: {}, "
+      "dirty_offset: {}, segment_term: {}, file: {}, file_offset: {}, "
+      "chunk_size: {}, done: {}}}",
+      r.term,
+      r.group,
+      r.target_node_id,
+      r.node_id,
+      r.prev_log_index,
+      r.prev_log_term,
+      r.base_offset,
+      r.dirty_offset,
+      r.segment_term,
+      r.file,
+      r.file_offset,
+      r.chunk.size_bytes(),
+      r.done);
+    return o;
+}
+
+std::ostream& operator<<(std::ostream& o, const install_segment_reply& r) {
+    fmt::print(
+      o,
+      "{{term: {}, target_node_id: {}, bytes_stored: {}, "
+      "last_dirty_log_index: {}, last_committed_log_index: {}, success: {}}}",
+      r.term,
+      r.target_node_id,
+      r.bytes_stored,
+      r.last_dirty_log_index,
+      r.last_committed_log_index,
+      r.success);
+    return o;
+}
+
 std::ostream& operator<<(std::ostream& o, const install_snapshot_reply& r) {
     fmt::print(
       o,
@@ -208,6 +263,20 @@ async_adl<raft::append_entries_request>::from(iobuf_parser& in) {
     return ss::make_ready_future<raft::append_entries_request>(std::move(ret));
 }
 
+ss::future<> async_adl<raft::append_entries_batch_request>::to(
+  iobuf& out, raft::append_entries_batch_request&& request) {
+    return async_adl<std::vector<raft::append_entries_request>>{}.to(
+      out, std::move(request.requests));
+}
+
+ss::future<raft::append_entries_batch_request>
+async_adl<raft::append_entries_batch_request>::from(iobuf_parser& in) {
+    return async_adl<std::vector<raft::append_entries_request>>{}.from(in).then(
+      [](std::vector<raft::append_entries_request> requests) {
+          return raft::append_entries_batch_request{std::move(requests)};
+      });
+}
+
 void adl<raft::protocol_metadata>::to(
   iobuf& out, raft::protocol_metadata request) {
     std::array<bytes::value_type, 6 * vint::max_length> staging{};
@@ -321,6 +390,59 @@ T read_one_varint_delta(iobuf_parser& in, const T& prev) {
 }
 } // namespace internal
 
+/// Idle heartbeats follow the full ones, they are left out altogether when
+/// there are none so that requests without them keep the previous format
+static void encode_idle_heartbeats(
+  iobuf& out, std::vector<raft::idle_heartbeat_metadata> idle) {
+    if (idle.empty()) {
+        return;
+    }
+    std::sort(
+      idle.begin(),
+      idle.end(),
+      [](
+        const raft::idle_heartbeat_metadata& lhs,
+        const raft::idle_heartbeat_metadata& rhs) {
+          return lhs.group < rhs.group;
+      });
+    std::vector<raft::group_id> groups;
+    std::vector<model::term_id> terms;
+    groups.reserve(idle.size());
+    terms.reserve(idle.size());
+    for (const auto& hb : idle) {
+        vassert(
+          hb.group() >= 0, "Negative raft group detected. {}", hb.group);
+        groups.push_back(hb.group);
+        terms.push_back(hb.term);
+    }
+    adl<uint32_t>{}.to(out, idle.size());
+    internal::encode_one_delta_array<raft::group_id>(out, groups);
+    internal::encode_one_delta_array<model::term_id>(out, terms);
+}
+
+static std::vector<raft::idle_heartbeat_metadata>
+decode_idle_heartbeats(iobuf_parser& in) {
+    if (in.bytes_left() == 0) {
+        return {};
+    }
+    std::vector<raft::idle_heartbeat_metadata> idle(adl<uint32_t>{}.from(in));
+    if (idle.empty()) {
+        return idle;
+    }
+    const size_t max = idle.size();
+    idle[0].group = varlong_reader<raft::group_id>(in);
+    for (size_t i = 1; i < max; ++i) {
+        idle[i].group = internal::read_one_varint_delta<raft::group_id>(
+          in, idle[i - 1].group);
+    }
+    idle[0].term = varlong_reader<model::term_id>(in);
+    for (size_t i = 1; i < max; ++i) {
+        idle[i].term = internal::read_one_varint_delta<model::term_id>(
+          in, idle[i - 1].term);
+    }
+    return idle;
+}
+
 ss::future<> async_adl<raft::heartbeat_request>::to(
   iobuf& out, raft::heartbeat_request&& request) {
     struct sorter_fn {
@@ -364,16 +486,26 @@ ss::future<> async_adl<raft::heartbeat_request>::to(
           // important to release this memory after this function
           // request.meta = {}; // release memory
 
-          // physical node ids are the same for all requests
-          adl<model::node_id>{}.to(
-            out, request.heartbeats.front().node_id.id());
-          adl<model::node_id>{}.to(
-            out, request.heartbeats.front().target_node_id.id());
+          // physical node ids are the same for all requests, idle heartbeats
+          // do not need them
+          auto node = request.heartbeats.empty()
+                        ? model::node_id{}
+                        : request.heartbeats.front().node_id.id();
+          auto target_node = request.heartbeats.empty()
+                               ? model::node_id{}
+                               : request.heartbeats.front().target_node_id.id();
+          adl<model::node_id>{}.to(out, node);
+          adl<model::node_id>{}.to(out, target_node);
           adl<uint32_t>{}.to(out, size);
 
-          return encodee;
+          return std::make_tuple(
+            std::move(encodee), std::move(request.idle_heartbeats));
       })
-      .then([&out](internal::hbeat_soa encodee) {
+      .then([&out](
+              std::tuple<
+                internal::hbeat_soa,
+                std::vector<raft::idle_heartbeat_metadata>> t) {
+          auto& [encodee, idle] = t;
           internal::encode_one_delta_array<raft::group_id>(out, encodee.groups);
           internal::encode_one_delta_array<model::offset>(
             out, encodee.commit_indices);
@@ -388,6 +520,7 @@ ss::future<> async_adl<raft::heartbeat_request>::to(
             out, encodee.revisions);
           internal::encode_one_delta_array<model::revision_id>(
             out, encodee.target_revisions);
+          encode_idle_heartbeats(out, std::move(idle));
       });
 }
 
@@ -404,6 +537,7 @@ async_adl<raft::heartbeat_request>::from(iobuf_parser& in) {
     req.heartbeats = std::vector<raft::heartbeat_metadata>(
       adl<uint32_t>{}.from(in));
     if (req.heartbeats.empty()) {
+        req.idle_heartbeats = decode_idle_heartbeats(in);
         return ss::make_ready_future<raft::heartbeat_request>(std::move(req));
     }
     const size_t max = req.heartbeats.size();
@@ -473,6 +607,7 @@ async_adl<raft::heartbeat_request>::from(iobuf_parser& in) {
         hb.target_node_id = raft::vnode(
           hb.target_node_id.id(), decode_signed(hb.target_node_id.revision()));
     }
+    req.idle_heartbeats = decode_idle_heartbeats(in);
     return ss::make_ready_future<raft::heartbeat_request>(std::move(req));
 }
 
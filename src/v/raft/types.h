@@ -17,6 +17,7 @@
 #include "model/record.h"
 #include "model/record_batch_reader.h"
 #include "model/timeout_clock.h"
+#include "raft/errc.h"
 #include "raft/fwd.h"
 #include "raft/group_configuration.h"
 #include "reflection/async_adl.h"
@@ -31,6 +32,7 @@
 
 #include <cstdint>
 #include <exception>
+#include <optional>
 
 namespace raft {
 using clock_type = ss::lowres_clock;
@@ -51,6 +53,8 @@ struct protocol_metadata {
     model::offset prev_log_index;
     model::term_id prev_log_term;
     model::offset last_visible_index;
+
+    bool operator==(const protocol_metadata&) const = default;
 };
 
 // The sequence used to track the order of follower append entries request
@@ -153,6 +157,12 @@ struct follower_index_metadata {
      * `last_sent_seq` value for version control.
      */
     heartbeats_suppressed suppress_heartbeats = heartbeats_suppressed::no;
+    /**
+     * Metadata of the last full heartbeat sent to the follower, reset when
+     * the heartbeat was not acknowledged. As long as the group metadata does
+     * not change the follower only receives idle heartbeats.
+     */
+    std::optional<protocol_metadata> last_heartbeat_meta;
 };
 
 struct append_entries_request {
@@ -231,6 +241,20 @@ struct append_entries_reply {
     status result = status::failure;
 };
 
+/// \brief append_entries requests of many raft groups addressed to the same
+/// node, sent in a single RPC. The receiver dispatches every request on its
+/// own and returns the replies in the order of the requests.
+struct append_entries_batch_request {
+    std::vector<append_entries_request> requests;
+};
+struct append_entries_batch_reply {
+    std::vector<append_entries_reply> replies;
+    /// \brief errc::success for every reply, unless its request failed on the
+    /// receiver. The reply of a failed request carries no state, the error
+    /// goes to the group that sent it, as if its own RPC had failed.
+    std::vector<errc> errors;
+};
+
 struct heartbeat_metadata {
     protocol_metadata meta;
     vnode node_id;
@@ -243,8 +267,19 @@ struct heartbeat_metadata {
 /// at a time, as well as the receiving side will trigger the
 /// individual raft responses one at a time - for example to start replaying the
 /// log at some offset
+/// \brief heartbeat of a group whose metadata did not change since the last
+/// heartbeat acknowledged by the follower. The follower repeats that heartbeat
+/// so only the group and the term, to detect a stale leader, are sent.
+struct idle_heartbeat_metadata {
+    group_id group;
+    model::term_id term;
+
+    raft::group_id target_group() const { return group; }
+};
+
 struct heartbeat_request {
     std::vector<heartbeat_metadata> heartbeats;
+    std::vector<idle_heartbeat_metadata> idle_heartbeats;
 };
 struct heartbeat_reply {
     std::vector<append_entries_reply> meta;
@@ -388,6 +423,101 @@ struct install_snapshot_reply {
     operator<<(std::ostream&, const install_snapshot_reply&);
 };
 
+/**
+ * Chunk of a file of a sealed leader segment. Followers far behind the leader
+ * receive whole segments instead of append entries requests carrying their
+ * batches. Files of a segment are sent one after another starting from the
+ * data file, the follower adopts the segment in its log after the last chunk.
+ */
+struct install_segment_request {
+    enum class file_type : int8_t {
+        data = 0,
+        index = 1,
+        compacted_index = 2,
+    };
+    // node id to validate on receiver
+    vnode target_node_id;
+    // leader’s term
+    model::term_id term;
+    // target group
+    raft::group_id group;
+    // leader id
+    vnode node_id;
+    // last entry preceding the segment, checked like for append entries
+    model::offset prev_log_index;
+    model::term_id prev_log_term;
+    // offsets and term of the segment
+    model::offset base_offset;
+    model::offset dirty_offset;
+    model::term_id segment_term;
+    // file the chunk belongs to
+    file_type file;
+    // byte offset where chunk is positioned in the file
+    uint64_t file_offset;
+    // file chunk, raw bytes
+    iobuf chunk;
+    // true if this is the last chunk of the segment
+    bool done;
+
+    raft::group_id target_group() const { return group; }
+    vnode target_node() const { return target_node_id; }
+    friend std::ostream&
+    operator<<(std::ostream&, const install_segment_request&);
+};
+
+class install_segment_request_foreign_wrapper {
+public:
+    using ptr_t = ss::foreign_ptr<std::unique_ptr<install_segment_request>>;
+
+    explicit install_segment_request_foreign_wrapper(
+      install_segment_request&& req)
+      : _ptr(ss::make_foreign(
+        std::make_unique<install_segment_request>(std::move(req)))) {}
+
+    install_segment_request copy() const {
+        // make copy on target core
+        return install_segment_request{
+          .target_node_id = _ptr->target_node_id,
+          .term = _ptr->term,
+          .group = _ptr->group,
+          .node_id = _ptr->node_id,
+          .prev_log_index = _ptr->prev_log_index,
+          .prev_log_term = _ptr->prev_log_term,
+          .base_offset = _ptr->base_offset,
+          .dirty_offset = _ptr->dirty_offset,
+          .segment_term = _ptr->segment_term,
+          .file = _ptr->file,
+          .file_offset = _ptr->file_offset,
+          .chunk = _ptr->chunk.copy(),
+          .done = _ptr->done};
+    }
+    raft::group_id target_group() const { return _ptr->target_group(); }
+    vnode target_node() const { return _ptr->target_node_id; }
+
+private:
+    ptr_t _ptr;
+};
+
+struct install_segment_reply {
+    // node id to validate on receiver
+    vnode target_node_id;
+    // current term, for leader to update itself
+    model::term_id term;
+    // number of bytes of the current file the follower has stored
+    uint64_t bytes_stored;
+    // follower log offsets, updated after the segment was adopted
+    model::offset last_dirty_log_index;
+    model::offset last_committed_log_index;
+    // false if the follower log does not end right before the segment or it
+    // lost the transfer state, the leader falls back to append entries
+    bool success = false;
+
+    friend std::ostream&
+    operator<<(std::ostream&, const install_segment_reply&);
+};
+
+std::ostream& operator<<(std::ostream&, install_segment_request::file_type);
+
 /**
  * Configuration describing snapshot that is going to be taken at current node.
  */
@@ -443,6 +573,9 @@ enum class metadata_key : int8_t {
     config_latest_known_offset = 2,
     last_applied_offset = 3,
     unique_local_id = 4,
+    leadership_hint = 5,
+    // configurations are stored under this key followed by their offset
+    config_index = 6,
     last
 };
 
@@ -473,6 +606,11 @@ struct async_adl<raft::append_entries_request> {
     ss::future<raft::append_entries_request> from(iobuf_parser& in);
 };
 template<>
+struct async_adl<raft::append_entries_batch_request> {
+    ss::future<> to(iobuf& out, raft::append_entries_batch_request&& request);
+    ss::future<raft::append_entries_batch_request> from(iobuf_parser& in);
+};
+template<>
 struct adl<raft::protocol_metadata> {
     void to(iobuf& out, raft::protocol_metadata request);
     raft::protocol_metadata from(iobuf_parser& in);
@@ -12,29 +12,36 @@
 #include "archival/ntp_archiver_service.h"
 #include "archival/service.h"
 #include "cluster/cluster_utils.h"
+#include "cluster/health_table.h"
 #include "cluster/id_allocator.h"
 #include "cluster/id_allocator_frontend.h"
 #include "cluster/metadata_dissemination_handler.h"
 #include "cluster/metadata_dissemination_service.h"
+#include "cluster/partition_leaders_table.h"
 #include "cluster/partition_manager.h"
 #include "cluster/security_frontend.h"
 #include "cluster/service.h"
+#include "cluster/topic_table.h"
 #include "cluster/topics_frontend.h"
 #include "config/configuration.h"
 #include "config/endpoint_tls_config.h"
 #include "config/seed_server.h"
 #include "kafka/client/configuration.h"
 #include "kafka/server/coordinator_ntp_mapper.h"
+#include "kafka/server/cpu_accounting.h"
 #include "kafka/server/group_manager.h"
 #include "kafka/server/group_router.h"
 #include "kafka/server/protocol.h"
 #include "kafka/server/quota_manager.h"
 #include "model/metadata.h"
+#include "model/timeout_clock.h"
 #include "pandaproxy/configuration.h"
 #include "pandaproxy/proxy.h"
 #include "platform/stop_signal.h"
 #include "raft/service.h"
+#include "redpanda/admin/api-doc/cluster.json.h"
 #include "redpanda/admin/api-doc/config.json.h"
+#include "redpanda/admin/api-doc/debug.json.h"
 #include "redpanda/admin/api-doc/kafka.json.h"
 #include "redpanda/admin/api-doc/partition.json.h"
 #include "redpanda/admin/api-doc/raft.json.h"
@@ -43,18 +50,31 @@
 #include "rpc/simple_protocol.h"
 #include "security/scram_algorithm.h"
 #include "security/scram_authenticator.h"
+#include "ssx/sformat.h"
 #include "storage/chunk_cache.h"
+#include "storage/decompression_stage.h"
 #include "storage/directories.h"
+#include "storage/flush_scheduler.h"
 #include "syschecks/syschecks.h"
 #include "test_utils/logs.h"
+#include "units.h"
+#include "utils/base64.h"
+#include "utils/cpu_profiler.h"
 #include "utils/file_io.h"
+#include "utils/stage_latency.h"
 #include "version.h"
 #include "vlog.h"
 
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/future-util.hh>
 #include <seastar/core/metrics.hh>
+#include <seastar/core/preempt.hh>
 #include <seastar/core/prometheus.hh>
+#include <seastar/core/sleep.hh>
 #include <seastar/core/smp.hh>
 #include <seastar/core/thread.hh>
+#include <seastar/core/when_all.hh>
+#include <seastar/core/with_timeout.hh>
 #include <seastar/http/api_docs.hh>
 #include <seastar/http/exception.hh>
 #include <seastar/http/file_handler.hh>
@@ -69,8 +89,12 @@
 #include <rapidjson/writer.h>
 #include <sys/utsname.h>
 
+#include <algorithm>
 #include <chrono>
 #include <exception>
+#include <functional>
+#include <limits>
+#include <tuple>
 #include <vector>
 
 application::application(ss::sstring logger_name)
@@ -112,6 +136,11 @@ int application::run(int ac, char** av) {
                 wire_up_services();
                 start();
                 app_signal.wait().get();
+                if (
+                  _redpanda_enabled
+                  && config::shard_local_cfg().drain_leadership_on_shutdown()) {
+                    drain_leadership().discard_result().get();
+                }
                 vlog(_log.info, "Stopping...");
             } catch (...) {
                 vlog(
@@ -243,6 +272,24 @@ void application::check_environment() {
         storage::directories::initialize(
           config::shard_local_cfg().data_directory().as_sstring())
           .get();
+        for (const auto& dir :
+             config::shard_local_cfg().data_directories()) {
+            storage::directories::initialize(dir).get();
+        }
+        if (config::shard_local_cfg().storage_disk_calibration()) {
+            syschecks::systemd_message("calibrating the data directory disk")
+              .get();
+            const auto dir
+              = config::shard_local_cfg().data_directory().as_sstring();
+            _disk_profile = syschecks::calibrate_disk(dir).get0();
+            vlog(
+              _log.info,
+              "Data directory disk: {}. Start with --io-properties-file={}/{} "
+              "to size the I/O queues from it",
+              *_disk_profile,
+              dir,
+              syschecks::disk_profile_file);
+        }
     }
 }
 
@@ -337,6 +384,10 @@ void application::configure_admin_server() {
               rb->register_api_file(server._routes, "partition");
               rb->register_function(server._routes, insert_comma);
               rb->register_api_file(server._routes, "security");
+              rb->register_function(server._routes, insert_comma);
+              rb->register_api_file(server._routes, "cluster");
+              rb->register_function(server._routes, insert_comma);
+              rb->register_api_file(server._routes, "debug");
               ss::httpd::config_json::get_config.set(
                 server._routes, []([[maybe_unused]] ss::const_req req) {
                     rapidjson::StringBuffer buf;
@@ -347,6 +398,8 @@ void application::configure_admin_server() {
               admin_register_raft_routes(server);
               admin_register_kafka_routes(server);
               admin_register_security_routes(server);
+              admin_register_cluster_routes(server);
+              admin_register_debug_routes(server);
           })
           .get();
     }
@@ -386,7 +439,7 @@ static storage::kvstore_config kvstore_config_from_global_config() {
 }
 
 static storage::log_config manager_config_from_global_config() {
-    return storage::log_config(
+    auto cfg = storage::log_config(
       storage::log_config::storage_type::disk,
       config::shard_local_cfg().data_directory().as_sstring(),
       config::shard_local_cfg().log_segment_size(),
@@ -403,7 +456,30 @@ static storage::log_config manager_config_from_global_config() {
         .stable_window = config::shard_local_cfg().reclaim_stable_window(),
         .min_size = config::shard_local_cfg().reclaim_min_size(),
         .max_size = config::shard_local_cfg().reclaim_max_size(),
+        .max_retained_size
+        = config::shard_local_cfg().cache_max_retained_size(),
       });
+    cfg.max_concurrent_recoveries
+      = config::shard_local_cfg().storage_max_concurrent_recoveries();
+    cfg.lazy_index = storage::lazy_index_hydration(
+      config::shard_local_cfg().storage_lazy_index_hydration());
+    cfg.segment_pool_size
+      = config::shard_local_cfg().storage_segment_pool_size();
+    cfg.compaction_key_map_memory
+      = config::shard_local_cfg().compaction_key_map_memory();
+    cfg.extra_dirs = config::shard_local_cfg().data_directories();
+    cfg.cache_retained_tail_size
+      = config::shard_local_cfg().cache_retained_tail_size();
+    cfg.segment_target_lifetime
+      = config::shard_local_cfg().log_segment_target_lifetime_ms();
+    cfg.min_adaptive_segment_size
+      = config::shard_local_cfg().log_segment_size_min();
+    cfg.max_adaptive_segment_size
+      = config::shard_local_cfg().log_segment_size_max();
+    cfg.shared_log_enabled = config::shard_local_cfg().storage_shared_log();
+    cfg.shared_log_graduation_rate
+      = config::shard_local_cfg().storage_shared_log_graduation_rate();
+    return cfg;
 }
 
 // add additional services in here
@@ -419,9 +495,31 @@ void application::wire_up_services() {
 }
 
 void application::wire_up_redpanda_services() {
-    ss::smp::invoke_on_all([] {
+    construct_service(
+      _stall_probe, _scheduling_groups.all_scheduling_groups())
+      .get();
+    _stall_probe
+      .invoke_on_all([](stall_probe& p) {
+          p.start(config::shard_local_cfg().disable_metrics());
+      })
+      .get();
+
+    ss::smp::invoke_on_all([sg = _scheduling_groups.compression_sg()] {
+        storage::internal::decompressions().start(sg);
+        storage::internal::chunks().setup_metrics();
+        if (!config::shard_local_cfg().disable_metrics()) {
+            stage_latencies().setup_metrics();
+            kafka::cpu_time().setup_metrics();
+        }
         return storage::internal::chunks().start();
     }).get();
+    _deferred.emplace_back([] {
+        ss::smp::invoke_on_all([] {
+            stage_latencies().stop();
+            kafka::cpu_time().stop();
+            return storage::internal::decompressions().stop();
+        }).get();
+    });
 
     // cluster
     syschecks::systemd_message("Adding raft client cache").get();
@@ -433,6 +531,11 @@ void application::wire_up_redpanda_services() {
     auto log_cfg = manager_config_from_global_config();
     log_cfg.reclaim_opts.background_reclaimer_sg
       = _scheduling_groups.cache_background_reclaim_sg();
+    if (_disk_profile) {
+        using limits = storage::read_ahead_tracker::limits;
+        log_cfg.read_ahead_limits = limits::for_disk(
+          _disk_profile->read_bandwidth, _disk_profile->read_latency);
+    }
     construct_service(storage, kvstore_config_from_global_config(), log_cfg)
       .get();
 
@@ -522,6 +625,7 @@ void application::wire_up_redpanda_services() {
       std::ref(raft_group_manager),
       std::ref(partition_manager),
       std::ref(controller->get_topics_state()),
+      std::ref(controller->get_partition_leaders()),
       std::ref(config::shard_local_cfg()))
       .get();
     syschecks::systemd_message("Creating kafka group shard mapper").get();
@@ -601,6 +705,9 @@ void application::wire_up_redpanda_services() {
           return ss::async([this, &c] {
               c.max_service_memory_per_core
                 = memory_groups::kafka_total_memory();
+              const auto& local_cfg = config::shard_local_cfg();
+              c.connection_read_buffer
+                = local_cfg.kafka_connection_read_buffer_bytes();
               auto& tls_config
                 = config::shard_local_cfg().kafka_api_tls.value();
               for (const auto& ep : config::shard_local_cfg().kafka_api()) {
@@ -650,8 +757,28 @@ void application::wire_up_redpanda_services() {
     kafka_cfg.stop().get();
     construct_service(
       fetch_session_cache,
-      config::shard_local_cfg().fetch_session_eviction_timeout_ms())
+      config::shard_local_cfg().fetch_session_eviction_timeout_ms(),
+      memory_groups::fetch_session_cache_memory())
       .get();
+
+    const auto governor_period
+      = config::shard_local_cfg().memory_governor_interval_ms();
+    if (governor_period.count() > 0) {
+        construct_service(
+          _memory_governor,
+          governor_period,
+          std::function<uint64_t()>([this] {
+              return storage.local().log_mgr().batch_cache_reclaimed_bytes();
+          }))
+          .get();
+        _memory_governor
+          .invoke_on_all([this](rpc::memory_governor& g) {
+              g.add("kafka_rpc", _kafka_server.local());
+              g.add("internal_rpc", _rpc.local());
+              g.start(config::shard_local_cfg().disable_metrics());
+          })
+          .get();
+    }
 }
 
 ss::future<> application::set_proxy_config(ss::sstring name, std::any val) {
@@ -691,21 +818,44 @@ void application::start() {
     syschecks::systemd_notify_ready().get();
 }
 
-void application::start_redpanda() {
-    syschecks::systemd_message("Staring storage services").get();
-    storage.invoke_on_all(&storage::api::start).get();
-
-    syschecks::systemd_message("Starting the partition manager").get();
-    partition_manager.invoke_on_all(&cluster::partition_manager::start).get();
+template<typename... StartFuncs>
+void application::start_phase(const char* name, StartFuncs&&... funcs) {
+    syschecks::systemd_message("Starting {}", name).get();
+    auto started = std::chrono::steady_clock::now();
+    ss::when_all_succeed(
+      ss::futurize_invoke(std::forward<StartFuncs>(funcs))...)
+      .discard_result()
+      .get();
+    vlog(
+      _log.info,
+      "Started {} in {}ms",
+      name,
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - started)
+        .count());
+}
 
-    syschecks::systemd_message("Starting Raft group manager").get();
-    raft_group_manager.invoke_on_all(&raft::group_manager::start).get();
+void application::start_redpanda() {
+    start_phase("storage services", [this] {
+        return storage.invoke_on_all(&storage::api::start);
+    });
 
-    syschecks::systemd_message("Starting Kafka group manager").get();
-    _group_manager.invoke_on_all(&kafka::group_manager::start).get();
+    // they only register with each other, nothing is managed before the
+    // controller replays its log
+    start_phase(
+      "partition managers",
+      [this] {
+          return partition_manager.invoke_on_all(
+            &cluster::partition_manager::start);
+      },
+      [this] {
+          return raft_group_manager.invoke_on_all(&raft::group_manager::start);
+      },
+      [this] {
+          return _group_manager.invoke_on_all(&kafka::group_manager::start);
+      });
 
-    syschecks::systemd_message("Starting controller").get();
-    controller->start().get0();
+    start_phase("controller", [this] { return controller->start(); });
     /**
      * We schedule shutting down controller input and aborting its operation
      * as a first shutdown step. (other services are stopeed in
@@ -718,86 +868,151 @@ void application::start_redpanda() {
     _deferred.emplace_back([this] { controller->shutdown_input().get(); });
     // FIXME: in first patch explain why this is started after the
     // controller so the broker set will be available. Then next patch fix.
-    syschecks::systemd_message("Starting metadata dissination service").get();
-    md_dissemination_service
-      .invoke_on_all(&cluster::metadata_dissemination_service::start)
-      .get();
+    start_phase(
+      "metadata dissemination and quotas",
+      [this] {
+          return md_dissemination_service.invoke_on_all(
+            &cluster::metadata_dissemination_service::start);
+      },
+      [this] { return quota_mgr.invoke_on_all(&kafka::quota_manager::start); },
+      [this] {
+          if (!archival_storage_enabled()) {
+              return ss::now();
+          }
+          return archival_scheduler.invoke_on_all(
+            [](archival::scheduler_service& svc) { return svc.start(); });
+      });
 
-    syschecks::systemd_message("Starting RPC").get();
-    _rpc
-      .invoke_on_all([this](rpc::server& s) {
-          auto proto = std::make_unique<rpc::simple_protocol>();
-          proto->register_service<cluster::id_allocator>(
-            _scheduling_groups.raft_sg(),
-            smp_service_groups.raft_smp_sg(),
-            std::ref(id_allocator_frontend));
-          proto->register_service<
-            raft::service<cluster::partition_manager, cluster::shard_table>>(
-            _scheduling_groups.raft_sg(),
-            smp_service_groups.raft_smp_sg(),
-            partition_manager,
-            shard_table.local(),
-            config::shard_local_cfg().raft_heartbeat_interval_ms());
-          proto->register_service<cluster::service>(
-            _scheduling_groups.cluster_sg(),
-            smp_service_groups.cluster_smp_sg(),
-            std::ref(controller->get_topics_frontend()),
-            std::ref(controller->get_members_manager()),
-            std::ref(metadata_cache),
-            std::ref(controller->get_security_frontend()));
-          proto->register_service<cluster::metadata_dissemination_handler>(
-            _scheduling_groups.cluster_sg(),
-            smp_service_groups.cluster_smp_sg(),
-            std::ref(controller->get_partition_leaders()));
-          s.set_protocol(std::move(proto));
-      })
-      .get();
     auto& conf = config::shard_local_cfg();
-    _rpc.invoke_on_all(&rpc::server::start).get();
+    start_phase("RPC", [this] {
+        return _rpc
+          .invoke_on_all([this](rpc::server& s) {
+              auto proto = std::make_unique<rpc::simple_protocol>();
+              proto->register_service<cluster::id_allocator>(
+                _scheduling_groups.raft_sg(),
+                smp_service_groups.raft_smp_sg(),
+                std::ref(id_allocator_frontend));
+              proto
+                ->register_service<raft::service<
+                  cluster::partition_manager,
+                  cluster::shard_table>>(
+                  _scheduling_groups.raft_sg(),
+                  smp_service_groups.raft_smp_sg(),
+                  partition_manager,
+                  shard_table.local(),
+                  config::shard_local_cfg().raft_heartbeat_interval_ms())
+                .set_recovery_scheduling_group(
+                  _scheduling_groups.raft_recovery_sg());
+              proto->register_service<cluster::service>(
+                _scheduling_groups.cluster_sg(),
+                smp_service_groups.cluster_smp_sg(),
+                std::ref(controller->get_topics_frontend()),
+                std::ref(controller->get_members_manager()),
+                std::ref(metadata_cache),
+                std::ref(controller->get_security_frontend()),
+                std::ref(partition_manager),
+                std::ref(shard_table));
+              proto->register_service<cluster::metadata_dissemination_handler>(
+                _scheduling_groups.cluster_sg(),
+                smp_service_groups.cluster_smp_sg(),
+                std::ref(controller->get_partition_leaders()),
+                std::ref(md_dissemination_service));
+              s.set_protocol(std::move(proto));
+          })
+          .then([this] { return _rpc.invoke_on_all(&rpc::server::start); });
+    });
     vlog(_log.info, "Started RPC server listening at {}", conf.rpc_server());
 
-    if (archival_storage_enabled()) {
-        syschecks::systemd_message("Starting archival storage").get();
-        archival_scheduler
-          .invoke_on_all(
-            [](archival::scheduler_service& svc) { return svc.start(); })
-          .get();
-    }
-
-    quota_mgr.invoke_on_all(&kafka::quota_manager::start).get();
-
-    // Kafka API
-    _kafka_server
-      .invoke_on_all([this](rpc::server& s) {
-          auto proto = std::make_unique<kafka::protocol>(
-            smp_service_groups.kafka_smp_sg(),
-            metadata_cache,
-            controller->get_topics_frontend(),
-            quota_mgr,
-            group_router,
-            shard_table,
-            partition_manager,
-            coordinator_ntp_mapper,
-            fetch_session_cache,
-            std::ref(id_allocator_frontend),
-            controller->get_credential_store(),
-            controller->get_authorizer(),
-            controller->get_security_frontend());
-          s.set_protocol(std::move(proto));
-      })
-      .get();
-    _kafka_server.invoke_on_all(&rpc::server::start).get();
+    // Kafka API. The partitions are created by the controller backend in the
+    // background, a partition which is not recovered yet answers as unknown
+    // or without a leader.
+    start_phase("Kafka API", [this] {
+        return _kafka_server
+          .invoke_on_all([this](rpc::server& s) {
+              auto proto = std::make_unique<kafka::protocol>(
+                smp_service_groups.kafka_smp_sg(),
+                metadata_cache,
+                controller->get_topics_frontend(),
+                quota_mgr,
+                group_router,
+                shard_table,
+                partition_manager,
+                coordinator_ntp_mapper,
+                fetch_session_cache,
+                std::ref(id_allocator_frontend),
+                controller->get_credential_store(),
+                controller->get_authorizer(),
+                controller->get_security_frontend());
+              // without sasl the proxy needs no credentials to reach this
+              // broker
+              if (_proxy_config && !config::shard_local_cfg().enable_sasl()) {
+                  _proxy.local().set_local_broker(kafka::client::local_broker{
+                    .node_id = config::shard_local_cfg().node_id(),
+                    .listeners
+                    = config::shard_local_cfg().advertised_kafka_api(),
+                    .protocol = std::ref(*proto)});
+              }
+              s.set_protocol(std::move(proto));
+          })
+          .then([this] {
+              return _kafka_server.invoke_on_all(&rpc::server::start);
+          });
+    });
     vlog(
       _log.info, "Started Kafka API server listening at {}", conf.kafka_api());
 
     if (coproc_enabled()) {
         construct_single_service(_wasm_event_listener, std::ref(pacemaker));
-        _wasm_event_listener->start().get();
-        pacemaker.invoke_on_all(&coproc::pacemaker::start).get();
+        start_phase("coprocessors", [this] {
+            return _wasm_event_listener->start().then([this] {
+                return pacemaker.invoke_on_all(&coproc::pacemaker::start);
+            });
+        });
     }
 }
 
+ss::future<size_t> application::drain_leadership() {
+    const auto& cfg = config::shard_local_cfg();
+    vlog(_log.info, "Draining leadership");
+    auto drained = partition_manager.map_reduce0(
+      [n = cfg.leadership_drain_max_concurrent()](
+        cluster::partition_manager& pm) { return pm.drain_leadership(n); },
+      size_t(0),
+      std::plus<>());
+    size_t remaining = 0;
+    try {
+        remaining = co_await ss::with_timeout(
+          model::timeout_clock::now() + cfg.leadership_drain_timeout_ms(),
+          std::move(drained));
+    } catch (const ss::timed_out_error&) {
+        vlog(_log.warn, "Timed out draining leadership");
+        co_return co_await partition_manager.map_reduce0(
+          [](cluster::partition_manager& pm) {
+              return size_t(std::count_if(
+                pm.partitions().begin(),
+                pm.partitions().end(),
+                [](const auto& p) { return p.second->is_leader(); }));
+          },
+          size_t(0),
+          std::plus<>());
+    }
+    // the other nodes learn about the new leaders from the metadata
+    // dissemination, give it a round before the node goes away
+    co_await ss::sleep(cfg.metadata_dissemination_interval_ms());
+    vlog(
+      _log.info, "Drained leadership, {} groups still led here", remaining);
+    co_return remaining;
+}
+
 void application::admin_register_raft_routes(ss::http_server& server) {
+    ss::httpd::raft_json::raft_drain_leadership.set(
+      server._routes, [this](std::unique_ptr<ss::httpd::request>) {
+          return drain_leadership().then([](size_t remaining) {
+              return ss::json::json_return_type(remaining);
+          });
+      });
+
+
     ss::httpd::raft_json::raft_transfer_leadership.set(
       server._routes, [this](std::unique_ptr<ss::httpd::request> req) {
           raft::group_id group_id;
@@ -894,7 +1109,7 @@ parse_target_broker_shards(const ss::sstring& param) {
 }
 
 // TODO: factor out generic serialization from seastar http exceptions
-static security::scram_credential
+static ss::future<security::scram_credential>
 parse_scram_credential(const rapidjson::Document& doc) {
     if (!doc.IsObject()) {
         throw ss::httpd::bad_request_exception(fmt::format("Not an object"));
@@ -913,22 +1128,86 @@ parse_scram_credential(const rapidjson::Document& doc) {
     }
     const auto password = doc["password"].GetString();
 
-    security::scram_credential credential;
-
+    // salting the password takes thousands of hmac rounds
     if (algorithm == security::scram_sha256_authenticator::name) {
-        credential = security::scram_sha256::make_credentials(
+        return security::scram_sha256::make_credentials_async(
           password, security::scram_sha256::min_iterations);
 
     } else if (algorithm == security::scram_sha512_authenticator::name) {
-        credential = security::scram_sha512::make_credentials(
+        return security::scram_sha512::make_credentials_async(
           password, security::scram_sha512::min_iterations);
 
     } else {
         throw ss::httpd::bad_request_exception(
           fmt::format("Unknown scram algorithm: {}", algorithm));
     }
+}
+
+/*
+ * Listings of the admin api are returned a page at a time: the entries are
+ * ordered, \p after is the last entry of the previous page and \p limit the
+ * size of the page. The body is written a chunk at a time rather than built
+ * as a single string.
+ */
+static constexpr size_t max_page_limit = 10000;
+
+static size_t page_limit(const ss::httpd::request& req, size_t default_limit) {
+    auto param = req.get_query_param("limit");
+    if (param.empty()) {
+        return default_limit;
+    }
+    int64_t limit = 0;
+    try {
+        limit = std::stoll(param);
+    } catch (...) {
+    }
+    if (limit <= 0) {
+        throw ss::httpd::bad_param_exception(
+          fmt::format("Limit must be a positive integer: {}", param));
+    }
+    return std::min(size_t(limit), max_page_limit);
+}
+
+template<typename T, typename Func>
+static ss::future<> write_json_array(
+  ss::output_stream<char>& os, const std::vector<T>& entries, Func& write) {
+    static constexpr size_t chunk_size = 32_KiB;
+    rapidjson::StringBuffer buf;
+    rapidjson::Writer<rapidjson::StringBuffer> w(buf);
+    w.StartArray();
+    for (const auto& e : entries) {
+        write(w, e);
+        if (buf.GetSize() >= chunk_size) {
+            co_await os.write(buf.GetString(), buf.GetSize());
+            buf.Clear();
+        }
+    }
+    w.EndArray();
+    co_await os.write(buf.GetString(), buf.GetSize());
+}
 
-    return credential;
+/// The entries as a json array, written by \p write a chunk at a time
+template<typename T, typename Func>
+static ss::json::json_return_type
+stream_json_array(std::vector<T> entries, Func write) {
+    using body_writer
+      = std::function<ss::future<>(ss::output_stream<char>&&)>;
+    return ss::json::json_return_type(body_writer(
+      [entries = std::move(entries),
+       write = std::move(write)](ss::output_stream<char>&& os) mutable {
+          return ss::do_with(
+            std::move(os),
+            std::move(entries),
+            std::move(write),
+            [](
+              ss::output_stream<char>& os,
+              const std::vector<T>& entries,
+              Func& write) {
+                return write_json_array(os, entries, write).finally([&os] {
+                    return os.close();
+                });
+            });
+      }));
 }
 
 void application::admin_register_security_routes(ss::http_server& server) {
@@ -937,7 +1216,10 @@ void application::admin_register_security_routes(ss::http_server& server) {
           rapidjson::Document doc;
           doc.Parse(req->content.data());
 
-          auto credential = parse_scram_credential(doc);
+          if (!doc.IsObject()) {
+              throw ss::httpd::bad_request_exception(
+                fmt::format("Not an object"));
+          }
 
           if (!doc.HasMember("username") || !doc["username"].IsString()) {
               throw ss::httpd::bad_request_exception(
@@ -947,9 +1229,12 @@ void application::admin_register_security_routes(ss::http_server& server) {
           auto username = security::credential_user(
             doc["username"].GetString());
 
-          return controller->get_security_frontend()
-            .local()
-            .create_user(username, credential, model::timeout_clock::now() + 5s)
+          return parse_scram_credential(doc)
+            .then([this, username = std::move(username)](
+                    security::scram_credential credential) {
+                return controller->get_security_frontend().local().create_user(
+                  username, credential, model::timeout_clock::now() + 5s);
+            })
             .then([this](std::error_code err) {
                 vlog(_log.debug, "Creating user {}:{}", err, err.message());
                 if (err) {
@@ -988,11 +1273,12 @@ void application::admin_register_security_routes(ss::http_server& server) {
           rapidjson::Document doc;
           doc.Parse(req->content.data());
 
-          auto credential = parse_scram_credential(doc);
-
-          return controller->get_security_frontend()
-            .local()
-            .update_user(user, credential, model::timeout_clock::now() + 5s)
+          return parse_scram_credential(doc)
+            .then([this, user = std::move(user)](
+                    security::scram_credential credential) {
+                return controller->get_security_frontend().local().update_user(
+                  user, credential, model::timeout_clock::now() + 5s);
+            })
             .then([this](std::error_code err) {
                 vlog(_log.debug, "Updating user {}:{}", err, err.message());
                 if (err) {
@@ -1005,18 +1291,154 @@ void application::admin_register_security_routes(ss::http_server& server) {
       });
 
     ss::httpd::security_json::list_users.set(
-      server._routes, [this](std::unique_ptr<ss::httpd::request>) {
+      server._routes, [this](std::unique_ptr<ss::httpd::request> req) {
+          // without a limit all the users are listed
+          auto limit = page_limit(*req, std::numeric_limits<size_t>::max());
+          auto after = req->get_query_param("after");
+
           std::vector<ss::sstring> users;
           for (const auto& [user, _] :
                controller->get_credential_store().local()) {
-              users.push_back(user());
+              if (after.empty() || after < user()) {
+                  users.push_back(user());
+              }
+          }
+          if (users.size() > limit) {
+              std::partial_sort(
+                users.begin(), users.begin() + limit, users.end());
+              users.resize(limit);
+          } else {
+              std::sort(users.begin(), users.end());
           }
           return ss::make_ready_future<ss::json::json_return_type>(
-            std::move(users));
+            stream_json_array(
+              std::move(users),
+              [](
+                rapidjson::Writer<rapidjson::StringBuffer>& w,
+                const ss::sstring& user) {
+                  w.String(user.data(), user.size());
+              }));
       });
 }
 
+namespace {
+struct partition_entry {
+    model::topic_namespace tp_ns;
+    model::partition_id id;
+    std::optional<model::node_id> leader;
+};
+} // namespace
+
+/// The last partition of the previous page, as namespace/topic/partition
+static std::optional<model::ntp>
+partition_cursor(const ss::httpd::request& req) {
+    auto after = req.get_query_param("after");
+    if (after.empty()) {
+        return std::nullopt;
+    }
+    std::vector<ss::sstring> parts;
+    boost::split(parts, after, boost::is_any_of("/"));
+    int64_t id = -1;
+    if (parts.size() == 3) {
+        try {
+            id = std::stoll(parts[2]);
+        } catch (...) {
+        }
+    }
+    if (id < 0 || id > std::numeric_limits<model::partition_id::type>::max()) {
+        throw ss::httpd::bad_param_exception(fmt::format(
+          "Cursor must be namespace/topic/partition: {}", after));
+    }
+    return model::ntp(
+      model::ns(parts[0]), model::topic(parts[1]), model::partition_id(id));
+}
+
+/// The partitions after the cursor in order of namespace, topic and id. It
+/// yields between the topics, which may be deleted meanwhile
+static ss::future<std::vector<partition_entry>> partitions_page(
+  const cluster::topic_table& topics,
+  const cluster::partition_leaders_table& leaders,
+  std::optional<model::ntp> after,
+  size_t limit) {
+    auto tp_ns_less = [](
+                        const model::topic_namespace& a,
+                        const model::topic_namespace& b) {
+        return std::tie(a.ns, a.tp) < std::tie(b.ns, b.tp);
+    };
+    auto all = topics.all_topics();
+    std::sort(all.begin(), all.end(), tp_ns_less);
+    auto it = all.begin();
+    if (after) {
+        it = std::lower_bound(
+          all.begin(),
+          all.end(),
+          model::topic_namespace(after->ns, after->tp.topic),
+          tp_ns_less);
+    }
+
+    std::vector<partition_entry> page;
+    for (; it != all.end() && page.size() < limit; ++it) {
+        auto md = topics.get_topic_metadata(*it);
+        if (!md) {
+            continue;
+        }
+        auto& partitions = md->partitions;
+        std::sort(
+          partitions.begin(),
+          partitions.end(),
+          [](const model::partition_metadata& a,
+             const model::partition_metadata& b) { return a.id < b.id; });
+        const bool resumed = after
+                             && *it == model::topic_namespace_view(*after);
+        for (const auto& p : partitions) {
+            if (resumed && p.id <= after->tp.partition) {
+                continue;
+            }
+            page.push_back(partition_entry{
+              .tp_ns = *it,
+              .id = p.id,
+              .leader = leaders.get_leader(*it, p.id)});
+            if (page.size() == limit) {
+                break;
+            }
+        }
+        if (ss::need_preempt()) {
+            co_await ss::later();
+        }
+    }
+    co_return page;
+}
+
 void application::admin_register_kafka_routes(ss::http_server& server) {
+    ss::httpd::partition_json::list_partitions.set(
+      server._routes, [this](std::unique_ptr<ss::httpd::request> req) {
+          static constexpr size_t default_limit = 1000;
+          auto limit = page_limit(*req, default_limit);
+          return partitions_page(
+                   controller->get_topics_state().local(),
+                   controller->get_partition_leaders().local(),
+                   partition_cursor(*req),
+                   limit)
+            .then([](std::vector<partition_entry> page) {
+                return stream_json_array(
+                  std::move(page),
+                  [](
+                    rapidjson::Writer<rapidjson::StringBuffer>& w,
+                    const partition_entry& e) {
+                      w.StartObject();
+                      w.Key("ns");
+                      w.String(e.tp_ns.ns().c_str());
+                      w.Key("topic");
+                      w.String(e.tp_ns.tp().c_str());
+                      w.Key("partition_id");
+                      w.Int(e.id());
+                      w.Key("leader");
+                      w.Int(e.leader ? (*e.leader)() : -1);
+                      w.EndObject();
+                  });
+            });
+      });
+
     ss::httpd::kafka_json::kafka_transfer_leadership.set(
       server._routes, [this](std::unique_ptr<ss::httpd::request> req) {
           auto topic = model::topic(req->param["topic"]);
@@ -1151,4 +1573,327 @@ void application::admin_register_kafka_routes(ss::http_server& server) {
                   ss::json::json_return_type(ss::json::json_void()));
             });
       });
+
+    ss::httpd::partition_json::kafka_lookup_key.set(
+      server._routes, [this](std::unique_ptr<ss::httpd::request> req) {
+          auto topic = model::topic(req->param["topic"]);
+
+          model::partition_id partition;
+          try {
+              partition = model::partition_id(
+                std::stoll(req->param["partition"]));
+          } catch (...) {
+              throw ss::httpd::bad_param_exception(fmt::format(
+                "Partition id must be an integer: {}",
+                req->param["partition"]));
+          }
+
+          if (partition() < 0) {
+              throw ss::httpd::bad_param_exception(
+                fmt::format("Invalid partition id {}", partition));
+          }
+
+          // keys are binary, they are passed base64 encoded
+          bytes key;
+          try {
+              key = base64_to_bytes(req->get_query_param("key"));
+          } catch (const base64_decoder_exception&) {
+              throw ss::httpd::bad_param_exception(
+                "Key must be base64 encoded");
+          }
+
+          model::ntp ntp(model::kafka_namespace, topic, partition);
+
+          auto shard = shard_table.local().shard_for(ntp);
+          if (!shard) {
+              throw ss::httpd::not_found_exception(fmt::format(
+                "Topic partition {}:{} not found", topic, partition));
+          }
+
+          return partition_manager
+            .invoke_on(
+              *shard,
+              [ntp = std::move(ntp), key = std::move(key)](
+                cluster::partition_manager& pm) mutable {
+                  auto partition = pm.get(ntp);
+                  if (!partition) {
+                      throw ss::httpd::not_found_exception();
+                  }
+                  return partition
+                    ->lookup_key(std::move(key), kafka_read_priority())
+                    .then([](std::optional<storage::key_lookup_result> r) {
+                        if (!r) {
+                            throw ss::httpd::not_found_exception(
+                              "Key not found");
+                        }
+                        // the value is serialized on the shard owning it
+                        rapidjson::StringBuffer buf;
+                        rapidjson::Writer<rapidjson::StringBuffer> w(buf);
+                        w.StartObject();
+                        w.Key("offset");
+                        w.Int64(r->offset());
+                        w.Key("timestamp");
+                        w.Int64(r->timestamp.value());
+                        w.Key("value");
+                        if (r->value) {
+                            auto value = iobuf_to_base64(*r->value);
+                            w.String(value.c_str(), value.size());
+                        } else {
+                            // tombstone, the key was deleted
+                            w.Null();
+                        }
+                        w.EndObject();
+                        return ss::sstring(buf.GetString());
+                    });
+              })
+            .then([](ss::sstring json) {
+                return ss::json::json_return_type(json.c_str());
+            });
+      });
+}
+
+void application::admin_register_cluster_routes(ss::http_server& server) {
+    ss::httpd::cluster_json::get_cluster_health_report.set(
+      server._routes, [this](std::unique_ptr<ss::httpd::request>) {
+          return controller->get_health_table()
+            .invoke_on(
+              cluster::health_table::shard,
+              [](cluster::health_table& ht) { return ht.all_reports(); })
+            .then([](std::vector<cluster::node_load_report> reports) {
+                rapidjson::StringBuffer buf;
+                rapidjson::Writer<rapidjson::StringBuffer> w(buf);
+                w.StartArray();
+                for (const auto& r : reports) {
+                    w.StartObject();
+                    w.Key("node_id");
+                    w.Int(r.node());
+                    w.Key("disk_free_bytes");
+                    w.Uint64(r.disk_free_bytes);
+                    w.Key("disk_total_bytes");
+                    w.Uint64(r.disk_total_bytes);
+                    w.Key("cores");
+                    w.StartArray();
+                    for (const auto& c : r.cores) {
+                        w.StartObject();
+                        w.Key("produce_bytes_rate");
+                        w.Uint64(c.produce_bytes_rate);
+                        w.Key("fetch_bytes_rate");
+                        w.Uint64(c.fetch_bytes_rate);
+                        w.Key("leaders");
+                        w.Uint(c.leaders);
+                        w.EndObject();
+                    }
+                    w.EndArray();
+                    w.Key("topics");
+                    w.StartArray();
+                    for (const auto& t : r.topics) {
+                        w.StartObject();
+                        w.Key("ns");
+                        w.String(t.tp_ns.ns().c_str());
+                        w.Key("topic");
+                        w.String(t.tp_ns.tp().c_str());
+                        w.Key("partitions");
+                        w.StartArray();
+                        for (const auto& p : t.partitions) {
+                            w.StartObject();
+                            w.Key("id");
+                            w.Int(p.id());
+                            w.Key("leader");
+                            w.Bool(p.leader);
+                            w.Key("size_bytes");
+                            w.Uint64(p.size_bytes);
+                            w.Key("produce_bytes_rate");
+                            w.Uint64(p.produce_bytes_rate);
+                            w.Key("fetch_bytes_rate");
+                            w.Uint64(p.fetch_bytes_rate);
+                            w.Key("replication_backlog");
+                            w.Int64(p.replication_backlog);
+                            w.EndObject();
+                        }
+                        w.EndArray();
+                        w.EndObject();
+                    }
+                    w.EndArray();
+                    w.EndObject();
+                }
+                w.EndArray();
+                return ss::json::json_return_type(buf.GetString());
+            });
+      });
+}
+
+namespace {
+struct stage_summary {
+    uint64_t count;
+    int64_t p50;
+    int64_t p99;
+    int64_t p999;
+    int64_t max;
+};
+} // namespace
+
+/// One line per stack and shard: the frames from the outermost, separated by
+/// semicolons, then the sample count, as read by flamegraph.pl
+static ss::sstring
+folded_cpu_profile(const std::vector<cpu_profiler::profile>& shards) {
+    ss::sstring out;
+    for (size_t shard = 0; shard < shards.size(); ++shard) {
+        for (const auto& st : shards[shard].stacks) {
+            out += ssx::sformat("shard_{}", shard);
+            for (auto it = st.frames.rbegin(); it != st.frames.rend(); ++it) {
+                out += ";";
+                out += *it;
+            }
+            out += ssx::sformat(" {}\n", st.count);
+        }
+    }
+    return out;
+}
+
+static ss::sstring
+json_cpu_profile(const std::vector<cpu_profiler::profile>& shards) {
+    rapidjson::StringBuffer buf;
+    rapidjson::Writer<rapidjson::StringBuffer> w(buf);
+    w.StartArray();
+    for (size_t shard = 0; shard < shards.size(); ++shard) {
+        const auto& p = shards[shard];
+        w.StartObject();
+        w.Key("shard");
+        w.Uint(shard);
+        w.Key("samples");
+        w.Uint64(p.samples);
+        w.Key("dropped");
+        w.Uint64(p.dropped);
+        w.Key("stacks");
+        w.StartArray();
+        for (const auto& st : p.stacks) {
+            w.StartObject();
+            w.Key("count");
+            w.Uint64(st.count);
+            w.Key("frames");
+            w.StartArray();
+            for (const auto& f : st.frames) {
+                w.String(f.data(), f.size());
+            }
+            w.EndArray();
+            w.EndObject();
+        }
+        w.EndArray();
+        w.EndObject();
+    }
+    w.EndArray();
+    return ss::sstring(buf.GetString(), buf.GetSize());
+}
+
+void application::admin_register_debug_routes(ss::http_server& server) {
+    ss::httpd::debug_json::get_stage_latency.set(
+      server._routes, [](std::unique_ptr<ss::httpd::request>) {
+          using summary = std::vector<stage_summary>;
+          std::vector<ss::future<summary>> shards;
+          shards.reserve(ss::smp::count);
+          for (ss::shard_id s = 0; s < ss::smp::count; ++s) {
+              shards.push_back(ss::smp::submit_to(s, [] {
+                  summary stages;
+                  stages.reserve(request_stages);
+                  for (size_t i = 0; i < request_stages; ++i) {
+                      const auto& h = stage_latencies().histogram(
+                        static_cast<request_stage>(i));
+                      stages.push_back(stage_summary{
+                        .count = h.sample_count(),
+                        .p50 = h.get_value_at(50),
+                        .p99 = h.get_value_at(99),
+                        .p999 = h.get_value_at(99.9),
+                        .max = h.get_value_at(100)});
+                  }
+                  return stages;
+              }));
+          }
+          return ss::when_all_succeed(shards.begin(), shards.end())
+            .then([](std::vector<summary> shards) {
+                rapidjson::StringBuffer buf;
+                rapidjson::Writer<rapidjson::StringBuffer> w(buf);
+                w.StartArray();
+                for (size_t shard = 0; shard < shards.size(); ++shard) {
+                    w.StartObject();
+                    w.Key("shard");
+                    w.Uint(shard);
+                    w.Key("stages");
+                    w.StartArray();
+                    for (size_t i = 0; i < shards[shard].size(); ++i) {
+                        const auto& s = shards[shard][i];
+                        auto name = to_string(static_cast<request_stage>(i));
+                        w.StartObject();
+                        w.Key("stage");
+                        w.String(name.data(), name.size());
+                        w.Key("samples");
+                        w.Uint64(s.count);
+                        w.Key("p50_us");
+                        w.Int64(s.p50);
+                        w.Key("p99_us");
+                        w.Int64(s.p99);
+                        w.Key("p999_us");
+                        w.Int64(s.p999);
+                        w.Key("max_us");
+                        w.Int64(s.max);
+                        w.EndObject();
+                    }
+                    w.EndArray();
+                    w.EndObject();
+                }
+                w.EndArray();
+                return ss::json::json_return_type(buf.GetString());
+            });
+      });
+
+    ss::httpd::debug_json::start_cpu_profile.set(
+      server._routes, [](std::unique_ptr<ss::httpd::request> req) {
+          auto interval = std::chrono::duration_cast<std::chrono::microseconds>(
+            cpu_profiler::default_interval);
+          if (auto ms = req->get_query_param("interval_ms"); !ms.empty()) {
+              try {
+                  interval = std::chrono::milliseconds(std::stoul(ms));
+              } catch (...) {
+                  throw ss::httpd::bad_param_exception(fmt::format(
+                    "Profiling interval must be an integer: {}", ms));
+              }
+          }
+          return ss::smp::invoke_on_all([interval] {
+                     shard_cpu_profiler().start(interval);
+                 })
+            .then([] {
+                return ss::json::json_return_type(ss::json::json_void());
+            });
+      });
+
+    ss::httpd::debug_json::stop_cpu_profile.set(
+      server._routes, [](std::unique_ptr<ss::httpd::request>) {
+          return ss::smp::invoke_on_all([] { shard_cpu_profiler().stop(); })
+            .then([] {
+                return ss::json::json_return_type(ss::json::json_void());
+            });
+      });
+
+    ss::httpd::debug_json::get_cpu_profile.set(
+      server._routes, [](std::unique_ptr<ss::httpd::request> req) {
+          const auto format = req->get_query_param("format");
+          if (!format.empty() && format != "json" && format != "folded") {
+              throw ss::httpd::bad_param_exception(
+                fmt::format("Unknown profile format: {}", format));
+          }
+          std::vector<ss::future<cpu_profiler::profile>> shards;
+          shards.reserve(ss::smp::count);
+          for (ss::shard_id s = 0; s < ss::smp::count; ++s) {
+              shards.push_back(ss::smp::submit_to(
+                s, [] { return shard_cpu_profiler().results(); }));
+          }
+          return ss::when_all_succeed(shards.begin(), shards.end())
+            .then([folded = format == "folded"](
+                    std::vector<cpu_profiler::profile> shards) {
+                if (folded) {
+                    return ss::json::json_return_type(
+                      folded_cpu_profile(shards));
+                }
+                return ss::json::json_return_type(json_cpu_profile(shards));
+            });
+      });
 }
@@ -22,10 +22,13 @@
 #include "resource_mgmt/cpu_scheduling.h"
 #include "resource_mgmt/memory_groups.h"
 #include "resource_mgmt/smp_groups.h"
+#include "resource_mgmt/stall_probe.h"
+#include "rpc/memory_governor.h"
 #include "rpc/server.h"
 #include "seastarx.h"
 #include "security/credential_store.h"
 #include "storage/fwd.h"
+#include "syschecks/disk_calibration.h"
 
 #include <seastar/core/app-template.hh>
 #include <seastar/core/metrics_registration.hh>
@@ -88,9 +91,20 @@ private:
     void validate_arguments(const po::variables_map&);
     void hydrate_config(const po::variables_map&);
 
+    /// starts the services of a phase of the startup concurrently, the
+    /// phases themselves run in sequence
+    template<typename... StartFuncs>
+    void start_phase(const char* name, StartFuncs&&... funcs);
+
+    /// \brief moves the leadership of the groups led by the node to their
+    /// followers, resolves to the number of groups it still leads
+    ss::future<size_t> drain_leadership();
+
     void admin_register_raft_routes(ss::http_server& server);
     void admin_register_kafka_routes(ss::http_server& server);
     void admin_register_security_routes(ss::http_server& server);
+    void admin_register_cluster_routes(ss::http_server& server);
+    void admin_register_debug_routes(ss::http_server& server);
 
     bool coproc_enabled() {
         const auto& cfg = config::shard_local_cfg();
@@ -114,9 +128,12 @@ private:
     void setup_metrics();
     std::unique_ptr<ss::app_template> _app;
     bool _redpanda_enabled{true};
+    // measured disk of the data directory, see storage_disk_calibration
+    std::optional<syschecks::disk_profile> _disk_profile;
     std::optional<pandaproxy::configuration> _proxy_config;
     std::optional<kafka::client::configuration> _proxy_client_config;
     scheduling_groups _scheduling_groups;
+    ss::sharded<stall_probe> _stall_probe;
     ss::logger _log;
 
     std::unique_ptr<coproc::wasm::event_listener> _wasm_event_listener;
@@ -125,6 +142,7 @@ private:
     ss::sharded<rpc::server> _rpc;
     ss::sharded<ss::http_server> _admin;
     ss::sharded<rpc::server> _kafka_server;
+    ss::sharded<rpc::memory_governor> _memory_governor;
     ss::sharded<pandaproxy::proxy> _proxy;
     ss::metrics::metric_groups _metrics;
     // run these first on destruction
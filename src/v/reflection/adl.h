@@ -15,6 +15,7 @@
 #include "bytes/iobuf_parser.h"
 #include "reflection/for_each_field.h"
 #include "reflection/type_traits.h"
+#include "reflection/wire_layout.h"
 #include "seastarx.h"
 #include "utils/named_type.h"
 
@@ -44,11 +45,19 @@ struct adl {
     static constexpr bool is_ss_bool = is_ss_bool_v<T>;
     static constexpr bool is_chrono_milliseconds
       = std::is_same_v<type, std::chrono::milliseconds>;
+    static constexpr bool is_trivially_serializable
+      = reflection::is_trivially_serializable<type>::value;
+
+    static_assert(
+      !is_trivially_serializable || has_wire_layout<type>(),
+      "rpc: trivially serializable type has padding or fields that can not be "
+      "copied as is");
 
     static_assert(
       is_optional || is_sstring || is_vector || is_named_type || is_iobuf
         || is_standard_layout || is_trivially_copyable || is_not_floating_point
-        || is_enum || is_ss_bool || is_chrono_milliseconds,
+        || is_enum || is_ss_bool || is_chrono_milliseconds
+        || is_trivially_serializable,
       "rpc: no adl registered");
 
     type from(iobuf io) {
@@ -77,6 +86,13 @@ struct adl {
         } else if constexpr (is_vector) {
             using value_type = typename type::value_type;
             int32_t n = in.template consume_type<int32_t>();
+            if constexpr (is_contiguously_serializable_v<value_type>) {
+                std::vector<value_type> ret(n);
+                in.consume_to(
+                  n * sizeof(value_type),
+                  reinterpret_cast<char*>(ret.data())); // NOLINT
+                return ret;
+            }
             std::vector<value_type> ret;
             ret.reserve(n);
             while (n-- > 0) {
@@ -95,6 +111,8 @@ struct adl {
         } else if constexpr (is_chrono_milliseconds) {
             return std::chrono::milliseconds(
               ss::le_to_cpu(in.template consume_type<int64_t>()));
+        } else if constexpr (is_trivially_serializable) {
+            return in.template consume_type<type>();
         } else if constexpr (is_standard_layout) {
             T t;
             reflection::for_each_field(t, [&in](auto& field) mutable {
@@ -129,6 +147,12 @@ struct adl {
         } else if constexpr (is_vector) {
             using value_type = typename type::value_type;
             adl<int32_t>{}.to(out, t.size());
+            if constexpr (is_contiguously_serializable_v<value_type>) {
+                out.append(
+                  reinterpret_cast<const char*>(t.data()), // NOLINT
+                  t.size() * sizeof(value_type));
+                return;
+            }
             for (value_type& i : t) {
                 adl<value_type>{}.to(out, std::move(i));
             }
@@ -149,6 +173,10 @@ struct adl {
         } else if constexpr (is_chrono_milliseconds) {
             adl<int64_t>{}.to(out, t.count());
             return;
+        } else if constexpr (is_trivially_serializable) {
+            // NOLINTNEXTLINE
+            out.append(reinterpret_cast<const char*>(&t), sizeof(type));
+            return;
         } else if constexpr (is_standard_layout) {
             /*
             std::apply(
@@ -65,6 +65,11 @@ struct async_adl<std::vector<T>> {
     using value_type = std::remove_reference_t<std::decay_t<T>>;
 
     ss::future<> to(iobuf& out, std::vector<value_type> t) {
+        if constexpr (is_contiguously_serializable_v<value_type>) {
+            // one block, nothing to yield for
+            adl<std::vector<value_type>>{}.to(out, std::move(t));
+            return ss::now();
+        }
         reflection::serialize<int32_t>(out, t.size());
         return ss::do_with(std::move(t), [&out](auto& t) {
             return ss::do_for_each(t, [&out](value_type& element) {
@@ -74,6 +79,10 @@ struct async_adl<std::vector<T>> {
     }
 
     ss::future<std::vector<value_type>> from(iobuf_parser& in) {
+        if constexpr (is_contiguously_serializable_v<value_type>) {
+            return ss::make_ready_future<std::vector<value_type>>(
+              adl<std::vector<value_type>>{}.from(in));
+        }
         const auto size = adl<int32_t>{}.from(in);
         return ss::do_with(
           boost::irange<size_t>(0, size),
@@ -57,3 +57,59 @@ SEASTAR_THREAD_TEST_CASE(test_async_adl_collection) {
     const auto seconds_hash = std::hash<iobuf>{}(second_out);
     BOOST_REQUIRE_EQUAL(originals_hash, seconds_hash);
 }
+
+struct fixed_layout {
+    model::offset offset;
+    model::term_id term;
+    int32_t a;
+    int16_t b;
+    int8_t c;
+    bool d;
+
+    bool operator==(const fixed_layout&) const = default;
+};
+
+struct padded {
+    int64_t a;
+    int8_t b;
+};
+
+template<>
+struct reflection::is_trivially_serializable<fixed_layout> : std::true_type {};
+
+static_assert(reflection::has_wire_layout<fixed_layout>());
+static_assert(reflection::has_wire_layout<model::offset>());
+static_assert(!reflection::has_wire_layout<model::ntp>());
+static_assert(!reflection::detail::struct_has_wire_layout<padded>());
+
+SEASTAR_THREAD_TEST_CASE(test_trivially_serializable_wire_format) {
+    std::vector<fixed_layout> original;
+    for (int i = 0; i < 10; ++i) {
+        original.push_back(fixed_layout{
+          .offset = model::offset(rand_gen::get_int<int64_t>()),
+          .term = model::term_id(i),
+          .a = rand_gen::get_int<int32_t>(),
+          .b = int16_t(i),
+          .c = int8_t(-i),
+          .d = i % 2 == 0});
+    }
+
+    iobuf copied;
+    reflection::async_adl<std::vector<fixed_layout>>{}
+      .to(copied, original)
+      .get();
+
+    // same bytes as the field by field encoding
+    iobuf expected;
+    reflection::serialize<int32_t>(expected, original.size());
+    for (auto f : original) {
+        reflection::serialize(expected, f.offset, f.term, f.a, f.b, f.c, f.d);
+    }
+    BOOST_REQUIRE_EQUAL(copied, expected);
+
+    iobuf_parser in(std::move(copied));
+    auto result
+      = reflection::async_adl<std::vector<fixed_layout>>{}.from(in).get0();
+    BOOST_REQUIRE(original == result);
+    BOOST_REQUIRE_EQUAL(in.bytes_left(), 0);
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "reflection/to_tuple.h"
+#include "reflection/type_traits.h"
+
+#include <bit>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace reflection {
+
+/// \brief opt-in for structs that adl serializes with a single copy of their
+/// memory instead of field by field. specialize it next to the struct:
+///
+///     template<>
+///     struct reflection::is_trivially_serializable<my_struct>
+///       : std::true_type {};
+///
+/// the wire format does not change, adl checks at compile time that the
+/// memory of the struct is exactly the little endian encoding of its fields
+template<typename T>
+struct is_trivially_serializable : std::false_type {};
+
+template<typename T>
+constexpr bool has_wire_layout();
+
+namespace detail {
+
+template<typename Tuple, std::size_t... Is>
+constexpr bool
+fields_have_wire_layout(std::index_sequence<Is...> /*unused*/) {
+    return (
+      has_wire_layout<std::decay_t<std::tuple_element_t<Is, Tuple>>>()
+      && ...);
+}
+
+template<typename Tuple, std::size_t... Is>
+constexpr std::size_t fields_size(std::index_sequence<Is...> /*unused*/) {
+    return (sizeof(std::decay_t<std::tuple_element_t<Is, Tuple>>) + ... + 0);
+}
+
+template<typename T>
+constexpr bool struct_has_wire_layout() {
+    using fields = decltype(to_tuple(std::declval<T&>()));
+    constexpr auto seq = std::make_index_sequence<std::tuple_size_v<fields>>{};
+    // no padding and every field is itself copied as is
+    return std::is_trivially_copyable_v<T>
+           && fields_size<fields>(seq) == sizeof(T)
+           && fields_have_wire_layout<fields>(seq);
+}
+
+} // namespace detail
+
+/// \brief true when the memory of T is the same as its adl encoding, so
+/// values and contiguous arrays of values can be copied as is
+template<typename T>
+constexpr bool has_wire_layout() {
+    using type = std::decay_t<T>;
+    if constexpr (std::endian::native != std::endian::little) {
+        return false;
+    } else if constexpr (std::is_integral_v<type>) {
+        return true;
+    } else if constexpr (std::is_enum_v<type>) {
+        return has_wire_layout<std::underlying_type_t<type>>();
+    } else if constexpr (is_named_type_v<type>) {
+        using value_type = typename type::type;
+        return std::is_trivially_copyable_v<type>
+               && sizeof(type) == sizeof(value_type)
+               && has_wire_layout<value_type>();
+    } else if constexpr (is_trivially_serializable<type>::value) {
+        return detail::struct_has_wire_layout<type>();
+    } else {
+        return false;
+    }
+}
+
+/// \brief element types of vectors that are copied as one block,
+/// std::vector<bool> has no contiguous storage
+template<typename T>
+inline constexpr bool is_contiguously_serializable_v
+  = has_wire_layout<T>() && !std::is_same_v<std::decay_t<T>, bool>;
+
+} // namespace reflection
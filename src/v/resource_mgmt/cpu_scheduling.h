@@ -17,6 +17,8 @@
 #include <seastar/core/future.hh>
 #include <seastar/core/scheduling.hh>
 
+#include <vector>
+
 // manage cpu scheduling groups. scheduling groups are global, so one instance
 // of this class can be created at the top level and passed down into any server
 // and any shard that needs to schedule continuations into a given group.
@@ -25,37 +27,59 @@ public:
     ss::future<> create_groups() {
         _admin = co_await ss::create_scheduling_group("admin", 100);
         _raft = co_await ss::create_scheduling_group("raft", 1000);
+        _raft_recovery = co_await ss::create_scheduling_group(
+          "raft_recovery", 200);
         _kafka = co_await ss::create_scheduling_group("kafka", 1000);
         _cluster = co_await ss::create_scheduling_group("cluster", 300);
         _coproc = co_await ss::create_scheduling_group("coproc", 100);
         _cache_background_reclaim = co_await ss::create_scheduling_group(
           "cache_background_reclaim", 200);
+        _compression = co_await ss::create_scheduling_group(
+          "compression", 100);
     }
 
     ss::future<> destroy_groups() {
         co_await destroy_scheduling_group(_admin);
         co_await destroy_scheduling_group(_raft);
+        co_await destroy_scheduling_group(_raft_recovery);
         co_await destroy_scheduling_group(_kafka);
         co_await destroy_scheduling_group(_cluster);
         co_await destroy_scheduling_group(_coproc);
         co_await destroy_scheduling_group(_cache_background_reclaim);
+        co_await destroy_scheduling_group(_compression);
         co_return;
     }
 
     ss::scheduling_group admin_sg() { return _admin; }
     ss::scheduling_group raft_sg() { return _raft; }
+    ss::scheduling_group raft_recovery_sg() { return _raft_recovery; }
     ss::scheduling_group kafka_sg() { return _kafka; }
     ss::scheduling_group cluster_sg() { return _cluster; }
     ss::scheduling_group coproc_sg() { return _coproc; }
     ss::scheduling_group cache_background_reclaim_sg() {
         return _cache_background_reclaim;
     }
+    ss::scheduling_group compression_sg() { return _compression; }
+
+    std::vector<ss::scheduling_group> all_scheduling_groups() const {
+        return {
+          _admin,
+          _raft,
+          _raft_recovery,
+          _kafka,
+          _cluster,
+          _coproc,
+          _cache_background_reclaim,
+          _compression};
+    }
 
 private:
     ss::scheduling_group _admin;
     ss::scheduling_group _raft;
+    ss::scheduling_group _raft_recovery;
     ss::scheduling_group _kafka;
     ss::scheduling_group _cluster;
     ss::scheduling_group _coproc;
     ss::scheduling_group _cache_background_reclaim;
+    ss::scheduling_group _compression;
 };
@@ -22,6 +22,9 @@ public:
     ss::io_priority_class raft_priority() { return _raft_priority; }
     ss::io_priority_class controller_priority() { return _controller_priority; }
     ss::io_priority_class kafka_read_priority() { return _kafka_read_priority; }
+    ss::io_priority_class kafka_cold_read_priority() {
+        return _kafka_cold_read_priority;
+    }
     ss::io_priority_class compaction_priority() { return _compaction_priority; }
 
     static priority_manager& local() {
@@ -36,12 +39,16 @@ private:
           ss::engine().register_one_priority_class("controller", 1000))
       , _kafka_read_priority(
           ss::engine().register_one_priority_class("kafka_read", 200))
+      , _kafka_cold_read_priority(
+          ss::engine().register_one_priority_class("kafka_cold_read", 50))
       , _compaction_priority(
           ss::engine().register_one_priority_class("compaction", 200)) {}
 
     ss::io_priority_class _raft_priority;
     ss::io_priority_class _controller_priority;
     ss::io_priority_class _kafka_read_priority;
+    // catch-up reads far behind the tail, they can't starve tailing consumers
+    ss::io_priority_class _kafka_cold_read_priority;
     ss::io_priority_class _compaction_priority;
 };
 
@@ -57,6 +64,10 @@ inline ss::io_priority_class kafka_read_priority() {
     return priority_manager::local().kafka_read_priority();
 }
 
+inline ss::io_priority_class kafka_cold_read_priority() {
+    return priority_manager::local().kafka_cold_read_priority();
+}
+
 inline ss::io_priority_class compaction_priority() {
     return priority_manager::local().compaction_priority();
 }
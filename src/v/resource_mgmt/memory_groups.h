@@ -21,6 +21,11 @@ struct memory_groups {
         // 30%
         return ss::memory::stats().total_memory() * .30;
     }
+    /// \brief upper bound of the memory held by kafka fetch sessions
+    static size_t fetch_session_cache_memory() {
+        // 2%, taken out of the kafka memory
+        return ss::memory::stats().total_memory() * .02; // NOLINT
+    }
     /// \brief includes raft & all services
     static size_t rpc_total_memory() {
         // 30%
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "prometheus/prometheus_sanitize.h"
+#include "seastarx.h"
+#include "vlog.h"
+
+#include <seastar/core/future.hh>
+#include <seastar/core/metrics.hh>
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/core/reactor.hh>
+#include <seastar/core/scheduling.hh>
+#include <seastar/core/sstring.hh>
+#include <seastar/core/timer.hh>
+#include <seastar/util/log.hh>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+inline ss::logger stall_log("stall");
+
+/**
+ * Attribution of reactor stalls to the scheduling groups.
+ *
+ * The seastar stall detector calls back from a signal handler on the stalled
+ * shard once a task runs for longer than blocked-reactor-notify-ms. The probe
+ * counts the stall against the scheduling group of the running task, then
+ * hands over to the report of the detector, which logs a backtrace at its own
+ * rate limit. The duration of a stall is taken from the last tick of a timer
+ * of the probe: the reactor didn't get to run timers since then.
+ *
+ * The handler only touches lock free atomics. The timer logs the stalls seen
+ * since its last log line, once per log_interval at most.
+ */
+class stall_probe {
+public:
+    using clock_type = std::chrono::steady_clock;
+    static constexpr auto tick_interval = std::chrono::milliseconds(10);
+    static constexpr auto log_interval = std::chrono::seconds(10);
+
+    explicit stall_probe(std::vector<ss::scheduling_group> groups)
+      : _groups(std::move(groups))
+      , _stats(_groups.size() + 1)
+      , _timer([this] { tick(); }) {}
+
+    stall_probe(stall_probe&&) = delete;
+    stall_probe& operator=(stall_probe&&) = delete;
+    stall_probe(const stall_probe&) = delete;
+    stall_probe& operator=(const stall_probe&) = delete;
+    ~stall_probe() noexcept = default;
+
+    void start(bool disable_metrics) {
+        _last_tick = now();
+        _last_log = _last_tick.load();
+        _report = ss::engine().get_stall_detector_report_function();
+        ss::engine().set_stall_detector_report_function(
+          [this] { on_stall(); });
+        _timer.arm_periodic(tick_interval);
+        if (!disable_metrics) {
+            setup_metrics();
+        }
+    }
+
+    ss::future<> stop() {
+        ss::engine().set_stall_detector_report_function(std::move(_report));
+        _timer.cancel();
+        return ss::now();
+    }
+
+private:
+    struct group_stats {
+        std::atomic<uint64_t> stalls{0};
+        std::atomic<int64_t> max_stall{0};
+    };
+
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                 clock_type::now().time_since_epoch())
+          .count();
+    }
+
+    size_t group_index(ss::scheduling_group sg) const {
+        for (size_t i = 0; i < _groups.size(); ++i) {
+            if (_groups[i] == sg) {
+                return i;
+            }
+        }
+        return _groups.size();
+    }
+
+    ss::sstring group_name(size_t i) const {
+        return i < _groups.size() ? _groups[i].name() : ss::sstring("other");
+    }
+
+    static void store_max(std::atomic<int64_t>& max, int64_t v) {
+        if (v > max.load(std::memory_order_relaxed)) {
+            max.store(v, std::memory_order_relaxed);
+        }
+    }
+
+    // runs in the signal handler of the stall detector
+    void on_stall() noexcept {
+        const auto tick = _last_tick.load(std::memory_order_relaxed);
+        const auto stalled = now() - tick;
+        const auto i = group_index(ss::current_scheduling_group());
+        auto& stats = _stats[i];
+        // the detector reports again while the same task keeps running
+        if (_reported_tick.exchange(tick, std::memory_order_relaxed) != tick) {
+            stats.stalls.fetch_add(1, std::memory_order_relaxed);
+            _unlogged_stalls.fetch_add(1, std::memory_order_relaxed);
+        }
+        store_max(stats.max_stall, stalled);
+        if (stalled > _unlogged_max.load(std::memory_order_relaxed)) {
+            _unlogged_max.store(stalled, std::memory_order_relaxed);
+            _unlogged_group.store(i, std::memory_order_relaxed);
+        }
+        if (_report) {
+            _report();
+        }
+    }
+
+    void tick() {
+        const auto t = now();
+        _last_tick.store(t, std::memory_order_relaxed);
+        auto since_log = std::chrono::microseconds(t - _last_log);
+        if (
+          _unlogged_stalls.load(std::memory_order_relaxed) == 0
+          || since_log < log_interval) {
+            return;
+        }
+        _last_log = t;
+        const auto stalls = _unlogged_stalls.exchange(0);
+        const auto longest = _unlogged_max.exchange(0);
+        vlog(
+          stall_log.warn,
+          "{} reactor stalls in the last {}s, longest {}ms in scheduling group "
+          "{}",
+          stalls,
+          std::chrono::duration_cast<std::chrono::seconds>(since_log).count(),
+          longest / 1000,
+          group_name(_unlogged_group.load()));
+    }
+
+    void setup_metrics() {
+        namespace sm = ss::metrics;
+        auto group = sm::label("group");
+        std::vector<sm::metric_definition> defs;
+        for (size_t i = 0; i < _stats.size(); ++i) {
+            std::vector<sm::label_instance> labels{group(group_name(i))};
+            defs.push_back(sm::make_derive(
+              "stalls",
+              [this, i] { return _stats[i].stalls.load(); },
+              sm::description(
+                "Number of reactor stalls of tasks of the scheduling group"),
+              labels));
+            defs.push_back(sm::make_gauge(
+              "max_stall_ms",
+              [this, i] { return _stats[i].max_stall.load() / 1000; },
+              sm::description(
+                "Longest reactor stall of a task of the scheduling group"),
+              labels));
+        }
+        _metrics.add_group(
+          prometheus_sanitize::metrics_name("stall_probe"), defs);
+    }
+
+    std::vector<ss::scheduling_group> _groups;
+    // indexed like the groups, the last one counts the tasks of other groups
+    std::vector<group_stats> _stats;
+    std::function<void()> _report;
+    ss::timer<clock_type> _timer;
+    std::atomic<int64_t> _last_tick{0};
+    std::atomic<int64_t> _reported_tick{-1};
+    std::atomic<uint64_t> _unlogged_stalls{0};
+    std::atomic<int64_t> _unlogged_max{0};
+    std::atomic<size_t> _unlogged_group{0};
+    int64_t _last_log{0};
+    ss::metrics::metric_groups _metrics;
+};
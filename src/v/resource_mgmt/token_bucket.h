@@ -0,0 +1,63 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+#include "seastarx.h"
+
+#include <seastar/core/lowres_clock.hh>
+
+#include <algorithm>
+#include <chrono>
+
+// token_bucket enforces a rate of units per second. the bucket holds at most
+// one second worth of tokens, consuming more than is available is allowed and
+// drives the bucket negative: the caller is expected to back off for delay()
+// before it consumes more.
+class token_bucket final {
+public:
+    using clock = ss::lowres_clock;
+
+    token_bucket(double rate, clock::time_point now)
+      : _rate(rate)
+      , _tokens(rate)
+      , _last_refill(now) {}
+
+    void consume(double units, clock::time_point now) {
+        refill(now);
+        _tokens -= units;
+    }
+
+    // time until the bucket is out of debt
+    clock::duration delay(clock::time_point now) {
+        refill(now);
+        if (_tokens >= 0) {
+            return clock::duration(0);
+        }
+        return std::chrono::duration_cast<clock::duration>(
+          std::chrono::duration<double>(-_tokens / _rate));
+    }
+
+    double rate() const { return _rate; }
+
+private:
+    void refill(clock::time_point now) {
+        if (now <= _last_refill) {
+            return;
+        }
+        std::chrono::duration<double> elapsed = now - _last_refill;
+        _tokens = std::min(_rate, _tokens + elapsed.count() * _rate);
+        _last_refill = now;
+    }
+
+    double _rate;
+    double _tokens;
+    clock::time_point _last_refill;
+};
@@ -12,15 +12,20 @@
 #include "likely.h"
 
 #include <seastar/core/future.hh>
+#include <seastar/core/later.hh>
 #include <seastar/core/scattered_message.hh>
 
 #include <fmt/format.h>
 
 namespace rpc {
 batched_output_stream::batched_output_stream(
-  ss::output_stream<char> o, size_t cache)
+  ss::output_stream<char> o,
+  size_t cache,
+  std::chrono::microseconds max_flush_delay)
   : _out(std::move(o))
   , _cache_size(cache)
+  , _max_flush_delay(
+      std::chrono::duration_cast<clock_type::duration>(max_flush_delay))
   , _write_sem(std::make_unique<ss::semaphore>(1)) {}
 
 [[gnu::cold]] static ss::future<>
@@ -41,20 +46,47 @@ ss::future<> batched_output_stream::write(ss::scattered_message<char> msg) {
           }
           const size_t vbytes = v.size();
           return _out.write(std::move(v)).then([this, vbytes] {
-              _unflushed_bytes += vbytes;
-              if (
-                _write_sem->waiters() == 0 || _unflushed_bytes >= _cache_size) {
-                  return do_flush();
+              if (_unflushed_writes == 0) {
+                  _first_unflushed = clock_type::now();
               }
-              return ss::make_ready_future<>();
+              _unflushed_bytes += vbytes;
+              ++_unflushed_writes;
+              return maybe_flush();
           });
       });
 }
+bool batched_output_stream::flush_delay_exceeded() const {
+    return _max_flush_delay > clock_type::duration::zero()
+           && clock_type::now() - _first_unflushed >= _max_flush_delay;
+}
+ss::future<> batched_output_stream::maybe_flush() {
+    if (_unflushed_bytes >= _cache_size || flush_delay_exceeded()) {
+        return do_flush();
+    }
+    if (_write_sem->waiters() > 0) {
+        // the next writer flushes
+        return ss::make_ready_future<>();
+    }
+    if (_max_flush_delay == clock_type::duration::zero()) {
+        return do_flush();
+    }
+    // cork until the writers of this task quota had a chance to queue up
+    return ss::later().then([this] {
+        if (_write_sem->waiters() > 0) {
+            return ss::make_ready_future<>();
+        }
+        return do_flush();
+    });
+}
 ss::future<> batched_output_stream::do_flush() {
     if (_unflushed_bytes == 0) {
         return ss::make_ready_future<>();
     }
+    if (_flush_observer) {
+        _flush_observer(_unflushed_writes, _unflushed_bytes);
+    }
     _unflushed_bytes = 0;
+    _unflushed_writes = 0;
     return _out.flush();
 }
 ss::future<> batched_output_stream::flush() {
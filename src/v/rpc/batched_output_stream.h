@@ -15,26 +15,46 @@
 
 #include <seastar/core/iostream.hh>
 #include <seastar/core/semaphore.hh>
+#include <seastar/util/noncopyable_function.hh>
 
+#include <chrono>
 #include <cstdint>
 
 namespace rpc {
 
 /// \brief batch operations for zero copy interface of an output_stream<char>
+///
+/// a write that would flush first yields once so the writes issued by the
+/// other fibers in the same task quota queue up behind it, the last of them
+/// flushes them all with one syscall. the data is flushed without yielding
+/// once it has been buffered for max_flush_delay or it reaches the cache
+/// size. a zero delay disables corking, the data is flushed as soon as there
+/// is no writer waiting
 class batched_output_stream {
 public:
+    using clock_type = std::chrono::steady_clock;
+    /// \brief called for every flush with the number of writes and bytes
+    using flush_observer = ss::noncopyable_function<void(size_t, size_t)>;
+
     static constexpr size_t default_max_unflushed_bytes = 1024 * 1024;
+    static constexpr std::chrono::microseconds default_max_flush_delay{500};
 
     batched_output_stream() = default;
     explicit batched_output_stream(
-      ss::output_stream<char>, size_t cache = default_max_unflushed_bytes);
+      ss::output_stream<char>,
+      size_t cache = default_max_unflushed_bytes,
+      std::chrono::microseconds max_flush_delay = default_max_flush_delay);
     ~batched_output_stream() noexcept = default;
     // NOTE: explicitly defined for a gcc
     batched_output_stream(batched_output_stream&& o) noexcept
       : _out(std::move(o._out))
       , _cache_size(o._cache_size)
+      , _max_flush_delay(o._max_flush_delay)
       , _write_sem(std::move(o._write_sem))
       , _unflushed_bytes(o._unflushed_bytes)
+      , _unflushed_writes(o._unflushed_writes)
+      , _first_unflushed(o._first_unflushed)
+      , _flush_observer(std::move(o._flush_observer))
       , _closed(o._closed) {}
     batched_output_stream& operator=(batched_output_stream&& o) noexcept {
         if (this != &o) {
@@ -49,17 +69,27 @@ public:
     ss::future<> write(ss::scattered_message<char> msg);
     ss::future<> flush();
 
+    void set_flush_observer(flush_observer o) {
+        _flush_observer = std::move(o);
+    }
+
     /// \brief calls output_stream<char>::close()
     /// do not use `_fd.shutdown_output();` on connected_sockets
     ss::future<> stop();
 
 private:
     ss::future<> do_flush();
+    ss::future<> maybe_flush();
+    bool flush_delay_exceeded() const;
 
     ss::output_stream<char> _out;
     size_t _cache_size{0};
+    clock_type::duration _max_flush_delay{0};
     std::unique_ptr<ss::semaphore> _write_sem;
     size_t _unflushed_bytes{0};
+    size_t _unflushed_writes{0};
+    clock_type::time_point _first_unflushed;
+    flush_observer _flush_observer;
     bool _closed = false;
 };
 } // namespace rpc
@@ -44,11 +44,19 @@ public:
 
     void add_bytes_received(size_t recv) { _in_bytes += recv; }
 
+    /// \brief payload of a request sent compressed, before and after
+    void add_compressed_bytes_sent(size_t uncompressed, size_t compressed) {
+        _out_uncompressed_bytes += uncompressed;
+        _out_compressed_bytes += compressed;
+    }
+
     void connection_established() {
         ++_connects;
         ++_connections;
     }
 
+    void tls_connection_established() { ++_tls_connects; }
+
     void connection_closed() { --_connections; }
 
     void connection_error(const std::exception_ptr& e) {
@@ -82,7 +90,10 @@ private:
     uint64_t _requests_completed = 0;
     uint64_t _in_bytes = 0;
     uint64_t _out_bytes = 0;
+    uint64_t _out_uncompressed_bytes = 0;
+    uint64_t _out_compressed_bytes = 0;
     uint64_t _connects = 0;
+    uint64_t _tls_connects = 0;
     uint32_t _connections = 0;
     uint32_t _connection_errors = 0;
     uint32_t _read_dispatch_errors = 0;
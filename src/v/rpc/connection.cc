@@ -17,18 +17,33 @@ connection::connection(
   ss::sstring name,
   ss::connected_socket f,
   ss::socket_address a,
-  server_probe& p)
+  server_probe& p,
+  ss::connected_socket_input_stream_config in_cfg)
   : addr(std::move(a))
   , _hook(hook)
   , _name(std::move(name))
   , _fd(std::move(f))
-  , _in(_fd.input())
+  , _in(_fd.input(in_cfg))
   , _out(_fd.output())
-  , _probe(p) {
+  , _probe(p)
+  , _read_buffer(in_cfg.min_buffer_size) {
     _hook.push_back(*this);
     _probe.connection_established();
+    _probe.connection_memory_added(memory_footprint());
+    _out.set_flush_observer([&p](size_t writes, size_t bytes) {
+        p.output_flushed(writes, bytes);
+    });
+}
+connection::~connection() noexcept {
+    _probe.connection_memory_removed(memory_footprint());
+    _hook.erase(_hook.iterator_to(*this));
+}
+
+void connection::set_protocol_memory(size_t bytes) {
+    _probe.connection_memory_removed(_protocol_memory);
+    _protocol_memory = bytes;
+    _probe.connection_memory_added(_protocol_memory);
 }
-connection::~connection() noexcept { _hook.erase(_hook.iterator_to(*this)); }
 
 void connection::shutdown_input() {
     try {
@@ -30,7 +30,8 @@ public:
       ss::sstring name,
       ss::connected_socket f,
       ss::socket_address a,
-      server_probe& p);
+      server_probe& p,
+      ss::connected_socket_input_stream_config = {});
     ~connection() noexcept;
     connection(const connection&) = delete;
     connection& operator=(const connection&) = delete;
@@ -43,6 +44,15 @@ public:
     ss::future<> shutdown();
     void shutdown_input();
 
+    /// memory the protocol holds for the connection, e.g. its queued
+    /// replies, accounted to the memory of the connections of the server
+    void set_protocol_memory(size_t);
+    /// estimated memory held by the connection while idle and by the
+    /// protocol for it
+    size_t memory_footprint() const {
+        return sizeof(connection) + _read_buffer + _protocol_memory;
+    }
+
     // NOLINTNEXTLINE
     const ss::socket_address addr;
 
@@ -53,5 +63,8 @@ private:
     ss::input_stream<char> _in;
     batched_output_stream _out;
     server_probe& _probe;
+    // an idle connection holds a read buffer of at least this size
+    size_t _read_buffer;
+    size_t _protocol_memory{0};
 };
 } // namespace rpc
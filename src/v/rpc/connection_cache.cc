@@ -14,9 +14,53 @@
 #include <fmt/format.h>
 
 #include <chrono>
+#include <optional>
+#include <vector>
 
 namespace rpc {
 
+connection_cache::transport_ptr connection_cache::get(
+  model::node_id n, connection_class c, size_t key) const {
+    const auto& t = _cache.find(n)->second;
+    switch (c) {
+    case connection_class::control:
+        if (t.control) {
+            return t.control;
+        }
+        break;
+    case connection_class::bulk:
+        if (!t.bulk.empty()) {
+            return t.bulk[key % t.bulk.size()];
+        }
+        break;
+    case connection_class::normal:
+        break;
+    }
+    return t.normal;
+}
+
+static void append_transports(
+  const connection_cache::node_transports& t,
+  std::vector<connection_cache::transport_ptr>& out) {
+    out.push_back(t.normal);
+    if (t.control) {
+        out.push_back(t.control);
+    }
+    out.insert(out.end(), t.bulk.begin(), t.bulk.end());
+}
+
+static ss::future<>
+stop_transports(std::vector<connection_cache::transport_ptr> transports) {
+    return ss::do_with(
+      std::move(transports),
+      [](std::vector<connection_cache::transport_ptr>& ts) {
+          return ss::parallel_for_each(
+            ts, [](const connection_cache::transport_ptr& p) {
+                return p->stop();
+            });
+      });
+}
+
 /// \brief needs to be a future, because mutations may come from different
 /// fibers and they need to be synchronized
 ss::future<> connection_cache::emplace(
@@ -32,36 +76,70 @@ ss::future<> connection_cache::emplace(
         }
         _cache.emplace(
           n,
-          ss::make_lw_shared<rpc::reconnect_transport>(
-            std::move(c), std::move(backoff_policy)));
+          node_transports{
+            .normal = ss::make_lw_shared<rpc::reconnect_transport>(
+              std::move(c), std::move(backoff_policy))});
     });
 }
+
+ss::future<> connection_cache::emplace(
+  model::node_id n,
+  rpc::transport_configuration c,
+  backoff_policy_factory make_backoff,
+  connection_options opts) {
+    return _mutex.with([this,
+                        n,
+                        c = std::move(c),
+                        make_backoff = std::move(make_backoff),
+                        opts]() mutable {
+        if (_cache.find(n) != _cache.end()) {
+            return;
+        }
+        auto make_transport = [&c, &make_backoff] {
+            return ss::make_lw_shared<rpc::reconnect_transport>(
+              c, make_backoff());
+        };
+        node_transports t{.normal = make_transport()};
+        if (opts.control_connection) {
+            t.control = make_transport();
+        }
+        t.bulk.reserve(opts.bulk_connections);
+        for (size_t i = 0; i < opts.bulk_connections; ++i) {
+            t.bulk.push_back(make_transport());
+        }
+        _cache.emplace(n, std::move(t));
+    });
+}
+
 ss::future<> connection_cache::remove(model::node_id n) {
     return _mutex
-      .with([this, n]() -> transport_ptr {
+      .with([this, n]() -> std::optional<node_transports> {
           auto it = _cache.find(n);
           if (it == _cache.end()) {
-              return nullptr;
+              return std::nullopt;
           }
-          auto ptr = it->second;
+          auto t = std::move(it->second);
           _cache.erase(it);
-          return ptr;
+          return t;
       })
-      .then([](transport_ptr ptr) {
-          if (!ptr) {
+      .then([](std::optional<node_transports> t) {
+          if (!t) {
               return ss::now();
           }
-          return ptr->stop().finally([ptr] {});
+          std::vector<transport_ptr> transports;
+          append_transports(*t, transports);
+          return stop_transports(std::move(transports));
       });
 }
 
 /// \brief closes all client connections
 ss::future<> connection_cache::stop() {
     return _mutex.with([this]() {
-        return parallel_for_each(_cache, [](auto& it) {
-            auto& [_, cli] = it;
-            return cli->stop();
-        });
+        std::vector<transport_ptr> transports;
+        for (const auto& [_, t] : _cache) {
+            append_transports(t, transports);
+        }
+        return stop_transports(std::move(transports));
         _cache.clear();
         // mark mutex as broken to prevent new connections from being created
         // after stop
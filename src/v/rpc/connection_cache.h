@@ -23,17 +23,38 @@
 
 #include <seastar/core/sharded.hh>
 #include <seastar/core/shared_ptr.hh>
+#include <seastar/util/noncopyable_function.hh>
 
 #include <chrono>
 #include <unordered_map>
+#include <vector>
 
 namespace rpc {
+/// \brief connections to other nodes
+///
+/// every node gets a default connection. optionally it gets a dedicated
+/// connection for the control traffic, so heartbeats and votes don't queue
+/// up behind large requests, and connections for the bulk traffic which is
+/// spread over them by a key chosen by the caller.
 class connection_cache final
   : public ss::peering_sharded_service<connection_cache> {
 public:
     using transport_ptr = ss::lw_shared_ptr<rpc::reconnect_transport>;
-    using underlying = std::unordered_map<model::node_id, transport_ptr>;
+
+    struct node_transports {
+        transport_ptr normal;
+        transport_ptr control;
+        std::vector<transport_ptr> bulk;
+    };
+
+    struct connection_options {
+        bool control_connection = false;
+        size_t bulk_connections = 0;
+    };
+
+    using underlying = std::unordered_map<model::node_id, node_transports>;
     using iterator = typename underlying::iterator;
+    using backoff_policy_factory = ss::noncopyable_function<backoff_policy()>;
 
     static inline ss::shard_id shard_for(
       model::node_id self,
@@ -45,13 +66,28 @@ public:
     bool contains(model::node_id n) const {
         return _cache.find(n) != _cache.end();
     }
-    transport_ptr get(model::node_id n) const { return _cache.find(n)->second; }
+    transport_ptr get(model::node_id n) const {
+        return _cache.find(n)->second.normal;
+    }
+
+    /// \brief connection of the class, the key picks one of the bulk
+    /// connections. falls back to the default connection
+    transport_ptr get(model::node_id n, connection_class c, size_t key) const;
 
     /// \brief needs to be a future, because mutations may come from different
-    /// fibers and they need to be synchronized
+    /// fibers and they need to be synchronized. the node gets the default
+    /// connection only
     ss::future<>
     emplace(model::node_id n, rpc::transport_configuration c, backoff_policy);
 
+    /// \brief adds the node with the connections given by the options, every
+    /// connection has its own backoff policy made by the factory
+    ss::future<> emplace(
+      model::node_id n,
+      rpc::transport_configuration c,
+      backoff_policy_factory,
+      connection_options);
+
     /// \brief removes the node *and* closes the connection
     ss::future<> remove(model::node_id n);
 
@@ -69,20 +105,25 @@ public:
         ss::shard_id src_shard,
         model::node_id node_id,
         clock_type::time_point connection_timeout,
+        connection_class conn_class,
+        size_t conn_key,
         Func&& f) {
         using ret_t = result_wrap_t<std::invoke_result_t<Func, Protocol>>;
         auto shard = rpc::connection_cache::shard_for(self, src_shard, node_id);
 
         return container().invoke_on(
           shard,
-          [node_id, f = std::forward<Func>(f), connection_timeout](
-            rpc::connection_cache& cache) mutable {
+          [node_id,
+           f = std::forward<Func>(f),
+           connection_timeout,
+           conn_class,
+           conn_key](rpc::connection_cache& cache) mutable {
               if (!cache.contains(node_id)) {
                   // No client available
                   return ss::futurize<ret_t>::convert(
                     rpc::make_error_code(errc::missing_node_rpc_client));
               }
-              return cache.get(node_id)
+              return cache.get(node_id, conn_class, conn_key)
                 ->get_connected(connection_timeout)
                 .then([f = std::forward<Func>(f)](
                         result<rpc::transport*> transport) mutable {
@@ -96,6 +137,28 @@ public:
           });
     }
 
+    template<typename Protocol, typename Func>
+    // clang-format off
+    CONCEPT(requires requires(Func&& f, Protocol proto) {
+        f(proto);
+    })
+      // clang-format on
+      auto with_node_client(
+        model::node_id self,
+        ss::shard_id src_shard,
+        model::node_id node_id,
+        clock_type::time_point connection_timeout,
+        Func&& f) {
+        return with_node_client<Protocol, Func>(
+          self,
+          src_shard,
+          node_id,
+          connection_timeout,
+          connection_class::normal,
+          0,
+          std::forward<Func>(f));
+    }
+
     template<typename Protocol, typename Func>
     // clang-format off
     CONCEPT(requires requires(Func&& f, Protocol proto) {
@@ -0,0 +1,177 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "rpc/correlation_table.h"
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+namespace rpc::internal {
+
+correlation_table::correlation_table(
+  timeout_action f, size_t capacity, size_t max_capacity)
+  : _on_timeout(std::move(f))
+  , _min_capacity(std::bit_ceil(std::max<size_t>(capacity, 1)))
+  , _max_capacity(std::max(_min_capacity, std::bit_ceil(max_capacity)))
+  , _slots(_min_capacity)
+  , _timer([this] { expire(); }) {}
+
+correlation_table::correlation_table(correlation_table&& o) noexcept
+  : _on_timeout(std::move(o._on_timeout))
+  , _min_capacity(o._min_capacity)
+  , _max_capacity(o._max_capacity)
+  , _slots(std::move(o._slots))
+  , _slotted(std::exchange(o._slotted, 0))
+  , _overflow(std::move(o._overflow))
+  , _deadlines(std::move(o._deadlines))
+  , _timer([this] { expire(); }) {
+    // the timer callback refers to the table it was created by
+    if (o._timer.armed()) {
+        _timer.arm(o._timer.get_timeout());
+        o._timer.cancel();
+    }
+}
+
+ss::future<correlation_table::response_ptr>
+correlation_table::emplace(uint32_t id, clock_type::time_point timeout) {
+    while (should_grow(id)) {
+        // spread the ids over twice as many slots
+        resize(_slots.size() * 2);
+    }
+    entry* e = nullptr;
+    if (auto& s = slot_for(id); !s.used) {
+        s.id = id;
+        s.used = true;
+        s.request = entry{.deadline = timeout, .promise = {}};
+        ++_slotted;
+        e = &s.request;
+    } else {
+        e = &_overflow.insert_or_assign(id, entry{.deadline = timeout})
+               .first->second;
+    }
+    auto f = e->promise.get_future();
+    _deadlines.emplace(timeout, id);
+    maybe_arm();
+    return f;
+}
+
+bool correlation_table::should_grow(uint32_t id) const {
+    // a collision while most slots are free is a straggler, it does not
+    // justify a larger slab
+    return slot_for(id).used && _slots.size() < _max_capacity
+           && _slotted * 2 >= _slots.size();
+}
+
+bool correlation_table::contains(uint32_t id) const {
+    const auto& s = slot_for(id);
+    return (s.used && s.id == id) || _overflow.contains(id);
+}
+
+bool correlation_table::complete(uint32_t id, response_ptr r) {
+    if (!contains(id)) {
+        return false;
+    }
+    // release before setting the value so that the continuations see a
+    // consistent table
+    release(id).set_value(std::move(r));
+    maybe_shrink();
+    return true;
+}
+
+void correlation_table::complete_all(errc e) {
+    _timer.cancel();
+    while (!_deadlines.empty()) {
+        release(_deadlines.begin()->second).set_value(response_ptr(e));
+    }
+    if (_slots.size() > _min_capacity) {
+        resize(_min_capacity);
+    }
+}
+
+ss::promise<correlation_table::response_ptr>
+correlation_table::release(uint32_t id) {
+    entry e;
+    if (auto& s = slot_for(id); s.used && s.id == id) {
+        s.used = false;
+        --_slotted;
+        e = std::move(s.request);
+    } else {
+        auto it = _overflow.find(id);
+        e = std::move(it->second);
+        _overflow.erase(it);
+    }
+    _deadlines.erase({e.deadline, id});
+    return std::move(e.promise);
+}
+
+void correlation_table::maybe_shrink() {
+    if (_slots.size() > _min_capacity && _slotted * 8 <= _slots.size()) {
+        resize(_slots.size() / 2);
+    }
+}
+
+void correlation_table::resize(size_t capacity) {
+    std::vector<slot> slots(capacity);
+    const auto mask = capacity - 1;
+    size_t slotted = 0;
+    auto place = [&slots, &slotted, mask](uint32_t id, entry& e) {
+        auto& s = slots[id & mask];
+        if (s.used) {
+            return false;
+        }
+        s.id = id;
+        s.used = true;
+        s.request = std::move(e);
+        ++slotted;
+        return true;
+    };
+    absl::flat_hash_map<uint32_t, entry> overflow;
+    for (auto& s : _slots) {
+        if (s.used && !place(s.id, s.request)) {
+            // ids sharing a slot of a smaller slab
+            overflow.emplace(s.id, std::move(s.request));
+        }
+    }
+    for (auto& [id, e] : _overflow) {
+        if (!place(id, e)) {
+            overflow.emplace(id, std::move(e));
+        }
+    }
+    _slots = std::move(slots);
+    _slotted = slotted;
+    _overflow = std::move(overflow);
+}
+
+void correlation_table::maybe_arm() {
+    if (_deadlines.empty()) {
+        _timer.cancel();
+        return;
+    }
+    const auto next = _deadlines.begin()->first;
+    if (next == no_timeout) {
+        return;
+    }
+    if (!_timer.armed() || next < _timer.get_timeout()) {
+        _timer.rearm(next);
+    }
+}
+
+void correlation_table::expire() {
+    const auto now = clock_type::now();
+    while (!_deadlines.empty() && _deadlines.begin()->first <= now) {
+        const auto id = _deadlines.begin()->second;
+        release(id).set_value(response_ptr(errc::client_request_timeout));
+        _on_timeout(id);
+    }
+    maybe_shrink();
+    maybe_arm();
+}
+
+} // namespace rpc::internal
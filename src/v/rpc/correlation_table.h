@@ -0,0 +1,119 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+#include "outcome.h"
+#include "rpc/errc.h"
+#include "rpc/types.h"
+#include "seastarx.h"
+
+#include <seastar/core/future.hh>
+#include <seastar/core/timer.hh>
+#include <seastar/util/noncopyable_function.hh>
+
+#include <absl/container/btree_set.h>
+#include <absl/container/flat_hash_map.h>
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace rpc::internal {
+
+/// \brief in-flight requests of a transport indexed by correlation id.
+///
+/// correlation ids are handed out sequentially, so the slot of a request is
+/// its id modulo the capacity of the slab. when the slot of a new id is still
+/// taken by an older request the slab doubles, up to max_capacity, if at
+/// least half of it is in use. otherwise, e.g. for a single long outstanding
+/// request, the new id goes to a small overflow map. the slab halves again
+/// once at most an eighth of it is in use.
+///
+/// all requests share a single timer armed for the earliest deadline. the
+/// requests are also kept ordered by deadline, so that expiring or failing
+/// them only visits the requests that are due or in flight, regardless of
+/// the capacity of the slab
+class correlation_table {
+public:
+    using response_ptr = result<std::unique_ptr<streaming_context>>;
+    /// \brief called with the id of every request that timed out, after its
+    /// future was resolved with errc::client_request_timeout
+    using timeout_action = ss::noncopyable_function<void(uint32_t)>;
+
+    static constexpr size_t default_capacity = 64;
+    static constexpr size_t default_max_capacity = 4096;
+
+    explicit correlation_table(
+      timeout_action,
+      size_t capacity = default_capacity,
+      size_t max_capacity = default_max_capacity);
+    ~correlation_table() noexcept = default;
+    correlation_table(correlation_table&&) noexcept;
+    correlation_table& operator=(correlation_table&&) noexcept = delete;
+    correlation_table(const correlation_table&) = delete;
+    correlation_table& operator=(const correlation_table&) = delete;
+
+    /// \brief the id must not be in flight, see contains()
+    ss::future<response_ptr>
+    emplace(uint32_t id, clock_type::time_point timeout);
+
+    bool contains(uint32_t id) const;
+
+    /// \brief false when the request already completed or timed out
+    bool complete(uint32_t id, response_ptr r);
+
+    /// \brief fails every request in flight with the error
+    void complete_all(errc e);
+
+    size_t size() const { return _deadlines.size(); }
+    size_t capacity() const { return _slots.size(); }
+    /// \brief requests in flight which did not fit in the slab
+    size_t overflow_size() const { return _overflow.size(); }
+
+private:
+    struct entry {
+        clock_type::time_point deadline;
+        ss::promise<response_ptr> promise;
+    };
+    struct slot {
+        uint32_t id{0};
+        bool used{false};
+        entry request;
+    };
+    /// every request in flight, no_timeout sorts last
+    using deadlines_t
+      = absl::btree_set<std::pair<clock_type::time_point, uint32_t>>;
+
+    slot& slot_for(uint32_t id) { return _slots[id & (_slots.size() - 1)]; }
+    const slot& slot_for(uint32_t id) const {
+        return _slots[id & (_slots.size() - 1)];
+    }
+    /// \brief the request must be in flight
+    ss::promise<response_ptr> release(uint32_t id);
+    bool should_grow(uint32_t id) const;
+    void maybe_shrink();
+    void resize(size_t capacity);
+    void maybe_arm();
+    void expire();
+
+    timeout_action _on_timeout;
+    size_t _min_capacity;
+    size_t _max_capacity;
+    std::vector<slot> _slots;
+    /// number of used slots
+    size_t _slotted{0};
+    absl::flat_hash_map<uint32_t, entry> _overflow;
+    deadlines_t _deadlines;
+    timer_type _timer;
+};
+
+} // namespace rpc::internal
@@ -0,0 +1,144 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "rpc/memory_governor.h"
+
+#include "prometheus/prometheus_sanitize.h"
+#include "rpc/logger.h"
+#include "vlog.h"
+
+#include <seastar/core/metrics.hh>
+
+#include <algorithm>
+
+namespace rpc {
+
+memory_governor::memory_governor(
+  clock_type::duration period, std::function<uint64_t()> reclaimed)
+  : _period(period)
+  , _reclaimed(std::move(reclaimed))
+  , _timer([this] { rebalance(); }) {}
+
+void memory_governor::add(ss::sstring name, server& srv) {
+    const auto base = srv.memory_budget();
+    _members.push_back(member{
+      .name = std::move(name),
+      .srv = &srv,
+      .base = base,
+      .floor = static_cast<size_t>(base * floor_fraction),
+      .blocked = srv.probe().requests_blocked_memory()});
+    size_t total = 0;
+    for (const auto& m : _members) {
+        total += m.base;
+    }
+    // a server grows at most by what the others can give up
+    for (auto& m : _members) {
+        m.ceiling = m.base + (total - m.base) * (1 - floor_fraction);
+    }
+    _step = total * step_fraction;
+}
+
+void memory_governor::start(bool disable_metrics) {
+    if (_reclaimed) {
+        _last_reclaimed = _reclaimed();
+    }
+    if (!disable_metrics) {
+        setup_metrics();
+    }
+    _timer.arm_periodic(_period);
+}
+
+ss::future<> memory_governor::stop() {
+    _timer.cancel();
+    return ss::now();
+}
+
+size_t memory_governor::spare(const member& m) {
+    const auto budget = m.srv->memory_budget();
+    const auto used = m.srv->memory_in_use();
+    if (budget <= m.floor || used >= budget) {
+        return 0;
+    }
+    return std::min(budget - m.floor, budget - used);
+}
+
+void memory_governor::rebalance() {
+    for (auto& m : _members) {
+        const auto blocked = m.srv->probe().requests_blocked_memory();
+        m.starved = blocked != m.blocked || m.srv->memory_waiters() > 0;
+        m.blocked = blocked;
+    }
+
+    const auto reclaimed = _reclaimed ? _reclaimed() : 0;
+    const bool reclaiming = reclaimed != _last_reclaimed;
+    _last_reclaimed = reclaimed;
+    if (reclaiming) {
+        for (auto& m : _members) {
+            const auto budget = m.srv->memory_budget();
+            if (budget > m.base) {
+                m.srv->set_memory_budget(std::max(m.base, budget - _step));
+                ++_shrinks;
+            }
+        }
+        return;
+    }
+
+    member* receiver = nullptr;
+    member* donor = nullptr;
+    for (auto& m : _members) {
+        if (m.starved) {
+            // the one with the most waiting requests goes first
+            if (
+              m.srv->memory_budget() < m.ceiling
+              && (!receiver
+                  || m.srv->memory_waiters()
+                       > receiver->srv->memory_waiters())) {
+                receiver = &m;
+            }
+        } else if (spare(m) > 0 && (!donor || spare(m) > spare(*donor))) {
+            donor = &m;
+        }
+    }
+    if (!receiver || !donor) {
+        return;
+    }
+    const auto amount = std::min(
+      {_step,
+       spare(*donor),
+       receiver->ceiling - receiver->srv->memory_budget()});
+    donor->srv->set_memory_budget(donor->srv->memory_budget() - amount);
+    receiver->srv->set_memory_budget(receiver->srv->memory_budget() + amount);
+    ++_transfers;
+    vlog(
+      rpclog.debug,
+      "Moved {} bytes of request memory from {} to {}",
+      amount,
+      donor->name,
+      receiver->name);
+}
+
+void memory_governor::setup_metrics() {
+    namespace sm = ss::metrics;
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("memory_governor"),
+      {
+        sm::make_derive(
+          "transfers",
+          [this] { return _transfers; },
+          sm::description(
+            "Number of times request memory moved between servers")),
+        sm::make_derive(
+          "shrinks",
+          [this] { return _shrinks; },
+          sm::description("Number of times a grown budget shrank while the "
+                          "batch cache was reclaiming")),
+      });
+}
+
+} // namespace rpc
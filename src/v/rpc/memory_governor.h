@@ -0,0 +1,98 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "rpc/server.h"
+#include "seastarx.h"
+
+#include <seastar/core/future.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/core/sstring.hh>
+#include <seastar/core/timer.hh>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace rpc {
+
+/**
+ * Shard-local rebalancing of the request memory of rpc servers.
+ *
+ * The kafka and the internal rpc servers start with a fixed share of the
+ * memory of the shard each. On a fetch heavy node the internal requests leave
+ * theirs idle while kafka requests wait for memory, and the other way around
+ * on a replication heavy node. Every period the governor moves a step of
+ * memory from a server with free units and no waiting requests to one whose
+ * requests waited for memory, within the floors and ceilings of both. The
+ * total stays the sum of the initial budgets.
+ *
+ * The reclaims of the batch cache tell that the shard is short on memory. The
+ * budgets above their initial size shrink back to it while reclaims go on.
+ */
+class memory_governor {
+public:
+    using clock_type = ss::lowres_clock;
+    /// fraction of the initial budget that a server keeps at least
+    static constexpr double floor_fraction = 0.5;
+    /// fraction of the sum of the budgets moved in one period
+    static constexpr double step_fraction = 0.05;
+
+    /// \param reclaimed total bytes reclaimed from the batch cache
+    memory_governor(
+      clock_type::duration period, std::function<uint64_t()> reclaimed);
+
+    memory_governor(memory_governor&&) = delete;
+    memory_governor& operator=(memory_governor&&) = delete;
+    memory_governor(const memory_governor&) = delete;
+    memory_governor& operator=(const memory_governor&) = delete;
+    ~memory_governor() noexcept = default;
+
+    /// \brief manage the budget of \p srv, its current budget is the initial
+    /// one. servers are added before start()
+    void add(ss::sstring name, server& srv);
+
+    void start(bool disable_metrics);
+    ss::future<> stop();
+
+    /// \brief one round of rebalancing, run by the timer every period
+    void rebalance();
+
+private:
+    struct member {
+        ss::sstring name;
+        server* srv;
+        size_t base;
+        size_t floor;
+        size_t ceiling{0};
+        uint64_t blocked{0};
+        bool starved{false};
+    };
+
+    void setup_metrics();
+    /// units a server has over its floor and doesn't use
+    static size_t spare(const member&);
+
+    clock_type::duration _period;
+    std::function<uint64_t()> _reclaimed;
+    uint64_t _last_reclaimed{0};
+    std::vector<member> _members;
+    size_t _step{0};
+    ss::timer<clock_type> _timer;
+    uint64_t _transfers{0};
+    uint64_t _shrinks{0};
+    ss::metrics::metric_groups _metrics;
+};
+
+} // namespace rpc
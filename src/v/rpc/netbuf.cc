@@ -10,7 +10,8 @@
 #include "rpc/netbuf.h"
 
 #include "bytes/iobuf.h"
-#include "compression/stream_zstd.h"
+#include "compression/internal/lz4_frame_compressor.h"
+#include "compression/internal/zstd_compressor.h"
 #include "hashing/xx.h"
 #include "reflection/adl.h"
 #include "rpc/types.h"
@@ -26,6 +27,19 @@ iobuf header_as_iobuf(const header& h) {
       "Header size must be known and exact");
     return b;
 }
+
+static iobuf compress_payload(iobuf payload, rpc::compression_type c) {
+    switch (c) {
+    case rpc::compression_type::zstd:
+        return compression::internal::zstd_compressor::compress(payload);
+    case rpc::compression_type::lz4:
+        return compression::internal::lz4_frame_compressor::compress(payload);
+    case rpc::compression_type::none:
+        return payload;
+    }
+    __builtin_unreachable();
+}
+
 /// \brief used to send the bytes down the wire
 /// we re-compute the header-checksum on every call
 ss::scattered_message<char> netbuf::as_scattered() && {
@@ -36,9 +50,8 @@ ss::scattered_message<char> netbuf::as_scattered() && {
     }
     if (
       _out.size_bytes() >= _min_compression_bytes
-      && rpc::compression_type::zstd == _hdr.compression) {
-        compression::stream_zstd fn;
-        _out = fn.compress(std::move(_out));
+      && rpc::compression_type::none != _hdr.compression) {
+        _out = compress_payload(std::move(_out), _hdr.compression);
     } else {
         // didn't meet min requirements
         _hdr.compression = rpc::compression_type::none;
@@ -53,6 +66,8 @@ ss::scattered_message<char> netbuf::as_scattered() && {
     _hdr.payload_size = _out.size_bytes();
     _hdr.header_checksum = rpc::checksum_header_only(_hdr);
     _out.prepend(header_as_iobuf(_hdr));
+    // the header and the small serialized fields go out as one buffer
+    _out.coalesce();
 
     // prepare for output
     return iobuf_as_scattered(std::move(_out));
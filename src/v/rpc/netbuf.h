@@ -31,6 +31,10 @@ public:
     void set_min_compression_bytes(size_t);
     iobuf& buffer();
 
+    /// \brief compression of the payload, none after as_scattered() if the
+    /// payload was too small to compress
+    rpc::compression_type compression() const { return _hdr.compression; }
+
 private:
     size_t _min_compression_bytes{1024};
     header _hdr;
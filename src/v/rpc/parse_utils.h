@@ -11,7 +11,8 @@
 
 #pragma once
 
-#include "compression/stream_zstd.h"
+#include "compression/internal/lz4_frame_compressor.h"
+#include "compression/internal/zstd_compressor.h"
 #include "hashing/xx.h"
 #include "likely.h"
 #include "reflection/async_adl.h"
@@ -26,6 +27,7 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
 #include <memory>
 #include <optional>
 
@@ -39,14 +41,64 @@ inline void check_out_of_range(size_t got, size_t expected) {
           expected));
     }
 }
+
+inline void check_payload_checksum(uint64_t got, const header& h) {
+    if (unlikely(h.payload_checksum != got)) {
+        throw std::runtime_error(fmt::format(
+          "invalid rpc checksum. got:{}, expected:{}",
+          got,
+          h.payload_checksum));
+    }
+}
+
+/// \brief reads n bytes, hashing the buffers as they arrive from the socket
+/// while they are still in cache. the buffers are kept as the fragments of
+/// the iobuf, without copies. less than n bytes are returned when the
+/// stream ends first
+inline ss::future<iobuf> read_iobuf_hashed(
+  ss::input_stream<char>& in, size_t n, incremental_xxhash64& hasher) {
+    return ss::do_with(iobuf{}, n, [&in, &hasher](iobuf& b, size_t& n) {
+        return ss::do_until(
+                 [&n] { return n == 0; },
+                 [&n, &in, &b, &hasher] {
+                     return in.read_up_to(n).then(
+                       [&n, &b, &hasher](ss::temporary_buffer<char> buf) {
+                           if (buf.empty()) {
+                               n = 0;
+                               return;
+                           }
+                           hasher.update(buf.get(), buf.size());
+                           n -= buf.size();
+                           b.append(std::move(buf));
+                       });
+                 })
+          .then([&b] { return std::move(b); });
+    });
+}
+
+/// \brief the payload of the header, its checksum verified
+inline ss::future<iobuf>
+read_payload(ss::input_stream<char>& in, const header& h) {
+    return ss::do_with(incremental_xxhash64{}, [&in, h](auto& hasher) {
+        return read_iobuf_hashed(in, h.payload_size, hasher)
+          .then([&hasher, h](iobuf io) {
+              check_out_of_range(io.size_bytes(), h.payload_size);
+              check_payload_checksum(hasher.digest(), h);
+              return io;
+          });
+    });
+}
 } // namespace detail
 
 inline ss::future<std::optional<header>>
 parse_header(ss::input_stream<char>& in) {
-    return read_iobuf_exactly(in, size_of_rpc_header).then([](iobuf b) {
-        if (b.size_bytes() != size_of_rpc_header) {
+    // the header is small, a read from the stream buffer is contiguous
+    return in.read_exactly(size_of_rpc_header).then([](auto buf) {
+        if (buf.size() != size_of_rpc_header) {
             return ss::make_ready_future<std::optional<header>>();
         }
+        iobuf b;
+        b.append(std::move(buf));
         iobuf_parser parser(std::move(b));
         auto h = reflection::adl<header>{}.from(parser);
         if (auto got = checksum_header_only(h);
@@ -73,13 +125,7 @@ inline void validate_payload_and_header(const iobuf& io, const header& h) {
           return ss::stop_iteration::no;
       });
     detail::check_out_of_range(consumed, h.payload_size);
-    const auto got_checksum = hasher.digest();
-    if (h.payload_checksum != got_checksum) {
-        throw std::runtime_error(fmt::format(
-          "invalid rpc checksum. got:{}, expected:{}",
-          got_checksum,
-          h.payload_checksum));
-    }
+    detail::check_payload_checksum(hasher.digest(), h);
 }
 
 template<typename T>
@@ -91,14 +137,16 @@ ss::future<T> parse_type_wihout_compression(iobuf io) {
 
 template<typename T>
 ss::future<T> parse_type(ss::input_stream<char>& in, const header& h) {
-    return read_iobuf_exactly(in, h.payload_size).then([h](iobuf io) {
-        validate_payload_and_header(io, h);
+    return detail::read_payload(in, h).then([h](iobuf io) {
         if (h.compression == compression_type::none) {
             return rpc::parse_type_wihout_compression<T>(std::move(io));
         }
         if (h.compression == compression_type::zstd) {
-            compression::stream_zstd fn;
-            io = fn.uncompress(std::move(io));
+            io = compression::internal::zstd_compressor::uncompress(io);
+            return rpc::parse_type_wihout_compression<T>(std::move(io));
+        }
+        if (h.compression == compression_type::lz4) {
+            io = compression::internal::lz4_frame_compressor::uncompress(io);
             return rpc::parse_type_wihout_compression<T>(std::move(io));
         }
         return ss::make_exception_future<T>(std::runtime_error(
@@ -106,4 +154,69 @@ ss::future<T> parse_type(ss::input_stream<char>& in, const header& h) {
     });
 }
 
+/// \brief hands the payload to the consumer in chunks of at most chunk_size
+/// bytes. the next chunk is read from the stream only once the consumer is
+/// done with the previous one, so the memory used stays bounded by the chunk
+/// size and a slow consumer pushes back on the sender through the socket.
+/// the checksum is verified as the chunks go by, a mismatch fails the future
+/// after the last chunk was consumed; consumers must not act on the data
+/// before the returned future succeeds. compressed payloads are uncompressed
+/// as a whole before being handed out
+template<typename Consumer>
+ss::future<> consume_payload(
+  ss::input_stream<char>& in,
+  const header& h,
+  size_t chunk_size,
+  Consumer consumer) {
+    if (h.compression != compression_type::none) {
+        return detail::read_payload(in, h)
+          .then([h, chunk_size, consumer = std::move(consumer)](
+                  iobuf io) mutable {
+              if (h.compression == compression_type::zstd) {
+                  io = compression::internal::zstd_compressor::uncompress(io);
+              } else if (h.compression == compression_type::lz4) {
+                  io = compression::internal::lz4_frame_compressor::uncompress(
+                    io);
+              } else {
+                  return ss::make_exception_future<>(std::runtime_error(
+                    fmt::format("no compression supported. header: {}", h)));
+              }
+              return ss::do_with(
+                std::move(io),
+                [chunk_size, consumer = std::move(consumer)](
+                  iobuf& io) mutable {
+                    return ss::do_until(
+                      [&io] { return io.empty(); },
+                      [&io, chunk_size, &consumer] {
+                          auto n = std::min(chunk_size, io.size_bytes());
+                          auto chunk = io.share(0, n);
+                          io.trim_front(n);
+                          return consumer(std::move(chunk));
+                      });
+                });
+          });
+    }
+    return ss::do_with(
+      incremental_xxhash64{},
+      size_t(h.payload_size),
+      std::move(consumer),
+      [&in, h, chunk_size](
+        incremental_xxhash64& hasher, size_t& remaining, Consumer& consumer) {
+          return ss::do_until(
+                   [&remaining] { return remaining == 0; },
+                   [&in, &hasher, &remaining, &consumer, chunk_size] {
+                       auto n = std::min(chunk_size, remaining);
+                       return detail::read_iobuf_hashed(in, n, hasher)
+                         .then([&remaining, &consumer, n](iobuf chunk) {
+                             detail::check_out_of_range(chunk.size_bytes(), n);
+                             remaining -= n;
+                             return consumer(std::move(chunk));
+                         });
+                   })
+            .then([&hasher, h] {
+                detail::check_payload_checksum(hasher.digest(), h);
+            });
+      });
+}
+
 } // namespace rpc
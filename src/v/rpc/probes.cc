@@ -34,6 +34,12 @@ void server_probe::setup_metrics(
           [this] { return _connects; },
           sm::description(
             ssx::sformat("{}: Number of accepted connections", proto))),
+        sm::make_derive(
+          "tls_handshakes",
+          [this] { return _tls_connects; },
+          sm::description(ssx::sformat(
+            "{}: Number of full TLS handshakes of accepted connections",
+            proto))),
         sm::make_derive(
           "connection_close_errors",
           [this] { return _connection_close_error; },
@@ -79,12 +85,39 @@ void server_probe::setup_metrics(
           [this] { return _requests_received - _requests_completed; },
           sm::description(ssx::sformat(
             "{}: Number of requests being processed by server", proto))),
+        sm::make_derive(
+          "output_flushes",
+          [this] { return _output_flushes; },
+          sm::description(ssx::sformat(
+            "{}: Number of times the replies were flushed to the sockets",
+            proto))),
+        sm::make_gauge(
+          "writes_per_flush",
+          [this] { return per_flush(_flushed_writes); },
+          sm::description(ssx::sformat(
+            "{}: Average number of replies sent with one flush", proto))),
+        sm::make_gauge(
+          "bytes_per_flush",
+          [this] { return per_flush(_flushed_bytes); },
+          sm::description(ssx::sformat(
+            "{}: Average number of bytes sent with one flush", proto))),
+        sm::make_gauge(
+          "connection_memory_bytes",
+          [this] { return _connection_memory; },
+          sm::description(ssx::sformat(
+            "{}: Estimated memory held by the connections", proto))),
+        sm::make_gauge(
+          "memory_per_connection_bytes",
+          [this] { return per_connection(_connection_memory); },
+          sm::description(ssx::sformat(
+            "{}: Average estimated memory held by a connection", proto))),
       });
 }
 
 std::ostream& operator<<(std::ostream& o, const server_probe& p) {
     o << "{"
       << "connects: " << p._connects << ", "
+      << "tls handshakes: " << p._tls_connects << ", "
       << "current connections: " << p._connections << ", "
       << "connection close errors: " << p._connection_close_error << ", "
       << "requests completed: " << p._requests_completed << ", "
@@ -92,7 +125,8 @@ std::ostream& operator<<(std::ostream& o, const server_probe& p) {
       << "sent bytes: " << p._out_bytes << ", "
       << "corrupted headers: " << p._corrupted_headers << ", "
       << "method not found errors: " << p._method_not_found_errors << ", "
-      << "requests blocked by memory: " << p._requests_blocked_memory << "}";
+      << "requests blocked by memory: " << p._requests_blocked_memory << ", "
+      << "output flushes: " << p._output_flushes << "}";
     return o;
 }
 
@@ -120,6 +154,11 @@ void client_probe::setup_metrics(
           [this] { return _connects; },
           sm::description("Connection attempts"),
           labels),
+        sm::make_derive(
+          "tls_handshakes",
+          [this] { return _tls_connects; },
+          sm::description("Number of full TLS handshakes of connections"),
+          labels),
         sm::make_derive(
           "requests",
           [this] { return _requests; },
@@ -150,6 +189,17 @@ void client_probe::setup_metrics(
           [this] { return _in_bytes; },
           sm::description("Total number of bytes received"),
           labels),
+        sm::make_total_bytes(
+          "out_uncompressed_bytes",
+          [this] { return _out_uncompressed_bytes; },
+          sm::description(
+            "Total size of the compressed request payloads before compression"),
+          labels),
+        sm::make_total_bytes(
+          "out_compressed_bytes",
+          [this] { return _out_compressed_bytes; },
+          sm::description("Total size of the compressed request payloads"),
+          labels),
         sm::make_derive(
           "connection_errors",
           [this] { return _connection_errors; },
@@ -192,6 +242,8 @@ std::ostream& operator<<(std::ostream& o, const rpc::client_probe& p) {
       << ", request_errors: " << p._request_errors
       << ", request_timeouts: " << p._request_timeouts
       << ", in_bytes: " << p._in_bytes << ", out_bytes: " << p._out_bytes
+      << ", out_uncompressed_bytes: " << p._out_uncompressed_bytes
+      << ", out_compressed_bytes: " << p._out_compressed_bytes
       << ", connects: " << p._connects << ", connections: " << p._connections
       << ", connection_errors: " << p._connection_errors
       << ", read_dispatch_errors: " << p._read_dispatch_errors
@@ -23,10 +23,13 @@
 #include <seastar/core/reactor.hh>
 #include <seastar/net/api.hh>
 
+#include <algorithm>
+
 namespace rpc {
 
 server::server(server_configuration c)
   : cfg(std::move(c))
+  , _memory_budget(cfg.max_service_memory_per_core)
   , _memory(cfg.max_service_memory_per_core) {}
 
 server::server(ss::sharded<server_configuration>* s)
@@ -61,7 +64,8 @@ void server::start() {
               std::current_exception()));
         }
         auto& b = _listeners.emplace_back(
-          std::make_unique<listener>(endpoint.name, std::move(ss)));
+          std::make_unique<listener>(
+            endpoint.name, std::move(ss), bool(endpoint.credentials)));
         listener& ref = *b;
         // background
         (void)with_gate(_conn_gate, [this, &ref] { return accept(ref); });
@@ -112,7 +116,11 @@ ss::future<> server::accept(listener& s) {
                 s.name,
                 std::move(ar.connection),
                 ar.remote_address,
-                _probe);
+                _probe,
+                input_stream_config());
+              if (s.tls) {
+                  _probe.tls_connection_established();
+              }
               vlog(
                 rpclog.trace,
                 "Incoming connection from {} on \"{}\"",
@@ -151,11 +159,36 @@ ss::future<> server::stop() {
     for (auto& c : _connections) {
         c.shutdown_input();
     }
-    return _conn_gate.close().then([this] {
-        return seastar::do_for_each(
-          _connections, [](connection& c) { return c.shutdown(); });
-    });
+    return _conn_gate.close()
+      .then([this] {
+          return seastar::do_for_each(
+            _connections, [](connection& c) { return c.shutdown(); });
+      })
+      .then([this] { return _proto ? _proto->stop() : ss::now(); });
+}
+ss::connected_socket_input_stream_config
+server::input_stream_config() const {
+    ss::connected_socket_input_stream_config in_cfg;
+    if (cfg.connection_read_buffer > 0) {
+        // the buffer shrinks back to the minimum once the reads are small,
+        // idle connections hold little
+        in_cfg.buffer_size = cfg.connection_read_buffer;
+        in_cfg.min_buffer_size = cfg.connection_read_buffer;
+        in_cfg.max_buffer_size = std::max<unsigned>(
+          in_cfg.max_buffer_size, cfg.connection_read_buffer);
+    }
+    return in_cfg;
 }
+
+void server::set_memory_budget(size_t budget) {
+    if (budget > _memory_budget) {
+        _memory.signal(budget - _memory_budget);
+    } else {
+        _memory.consume(_memory_budget - budget);
+    }
+    _memory_budget = budget;
+}
+
 void server::setup_metrics() {
     namespace sm = ss::metrics;
     if (!_proto) {
@@ -165,12 +198,12 @@ void server::setup_metrics() {
       prometheus_sanitize::metrics_name(cfg.name),
       {sm::make_total_bytes(
          "max_service_mem_bytes",
-         [this] { return cfg.max_service_memory_per_core; },
+         [this] { return _memory_budget; },
          sm::description(
            ssx::sformat("{}: Maximum memory allowed for RPC", cfg.name))),
        sm::make_total_bytes(
          "consumed_mem_bytes",
-         [this] { return cfg.max_service_memory_per_core - _memory.current(); },
+         [this] { return memory_in_use(); },
          sm::description(ssx::sformat(
            "{}: Memory consumed by request processing", cfg.name))),
        sm::make_histogram(
@@ -62,6 +62,8 @@ public:
         // the lifetime of all references here are guaranteed to live
         // until the end of the server (container/parent)
         virtual ss::future<> apply(server::resources) = 0;
+        // called once the connections are closed
+        virtual ss::future<> stop() { return ss::now(); }
     };
 
     explicit server(server_configuration);
@@ -80,22 +82,39 @@ public:
 
     const server_configuration cfg; // NOLINT
     const hdr_hist& histogram() const { return _hist; }
+    const server_probe& probe() const { return _probe; }
+
+    /// \brief memory units for the requests in flight, starts at
+    /// max_service_memory_per_core
+    size_t memory_budget() const { return _memory_budget; }
+    /// \brief grows or shrinks the budget. requests holding more than a
+    /// shrunk budget keep their units, the next ones wait for them
+    void set_memory_budget(size_t);
+    /// \brief units held by requests, may be above a shrunk budget
+    size_t memory_in_use() const {
+        return ssize_t(_memory_budget) - _memory.available_units();
+    }
+    size_t memory_waiters() const { return _memory.waiters(); }
 
 private:
     struct listener {
         ss::sstring name;
         ss::server_socket socket;
+        bool tls;
 
-        listener(ss::sstring name, ss::server_socket socket)
+        listener(ss::sstring name, ss::server_socket socket, bool tls)
           : name(std::move(name))
-          , socket(std::move(socket)) {}
+          , socket(std::move(socket))
+          , tls(tls) {}
     };
 
     friend resources;
     ss::future<> accept(listener&);
+    ss::connected_socket_input_stream_config input_stream_config() const;
     void setup_metrics();
 
     std::unique_ptr<protocol> _proto;
+    size_t _memory_budget;
     ss::semaphore _memory;
     std::vector<std::unique_ptr<listener>> _listeners;
     boost::intrusive::list<connection> _connections;
@@ -26,14 +26,29 @@ public:
         ++_connections;
     }
 
+    /// the connection was accepted on a TLS listener, every one of them
+    /// is a full handshake: the TLS credentials don't resume sessions
+    void tls_connection_established() { ++_tls_connects; }
+
     void connection_closed() { --_connections; }
 
     void connection_close_error() { ++_connection_close_error; }
 
+    void connection_memory_added(size_t bytes) { _connection_memory += bytes; }
+    void connection_memory_removed(size_t bytes) {
+        _connection_memory -= bytes;
+    }
+
     void add_bytes_sent(size_t sent) { _out_bytes += sent; }
 
     void add_bytes_received(size_t recv) { _in_bytes += recv; }
 
+    void output_flushed(size_t writes, size_t bytes) {
+        ++_output_flushes;
+        _flushed_writes += writes;
+        _flushed_bytes += bytes;
+    }
+
     void request_received() { ++_requests_received; }
 
     void request_completed() { ++_requests_completed; }
@@ -48,13 +63,32 @@ public:
 
     void setup_metrics(ss::metrics::metric_groups& mgs, const char* name);
 
+    uint64_t requests_completed() const { return _requests_completed; }
+    uint64_t bytes_received() const { return _in_bytes; }
+    uint64_t bytes_sent() const { return _out_bytes; }
+    uint64_t requests_blocked_memory() const {
+        return _requests_blocked_memory;
+    }
+
 private:
+    double per_flush(uint64_t v) const {
+        return _output_flushes == 0 ? 0 : double(v) / _output_flushes;
+    }
+    double per_connection(uint64_t v) const {
+        return _connections == 0 ? 0 : double(v) / _connections;
+    }
+
     uint64_t _requests_completed = 0;
     uint64_t _in_bytes = 0;
     uint64_t _out_bytes = 0;
     uint64_t _connects = 0;
+    uint64_t _tls_connects = 0;
     uint64_t _requests_received = 0;
     uint64_t _service_errors = 0;
+    uint64_t _output_flushes = 0;
+    uint64_t _flushed_writes = 0;
+    uint64_t _flushed_bytes = 0;
+    uint64_t _connection_memory = 0;
     uint32_t _connections = 0;
     uint32_t _connection_close_error = 0;
     uint32_t _corrupted_headers = 0;
@@ -20,6 +20,7 @@
 
 #include <seastar/core/reactor.hh>
 #include <seastar/core/scheduling.hh>
+#include <seastar/core/semaphore.hh>
 
 #include <cstdint>
 
@@ -36,6 +37,23 @@ struct service {
     virtual ss::smp_service_group& get_smp_service_group() = 0;
     /// \brief return nullptr when method not found
     virtual method* method_from_id(uint32_t) = 0;
+
+protected:
+    /// \brief runs the handler of a method in the scheduling group declared
+    /// for it in the rpcgen json. methods with an in-flight limit wait for a
+    /// unit of it first, the request body is parsed and its memory reserved
+    /// so waiting does not hold up the connection
+    template<typename Func>
+    static auto
+    admit(ss::scheduling_group sc, ss::semaphore* inflight, Func&& f) {
+        return ss::with_scheduling_group(
+          sc, [inflight, f = std::forward<Func>(f)]() mutable {
+              if (!inflight) {
+                  return f();
+              }
+              return ss::with_semaphore(*inflight, 1, std::move(f));
+          });
+    }
 };
 
 class rpc_internal_body_parsing_exception : public std::exception {
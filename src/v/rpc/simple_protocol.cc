@@ -59,7 +59,12 @@ ss::future<> simple_protocol::apply(server::resources rs) {
 ss::future<>
 send_reply(ss::lw_shared_ptr<server_context_impl> ctx, netbuf buf) {
     buf.set_min_compression_bytes(1024);
-    buf.set_compression(rpc::compression_type::zstd);
+    // a client compressing its request reads replies compressed the same way,
+    // everybody else gets zstd which is understood by all versions
+    auto compression = ctx->get_header().compression;
+    buf.set_compression(
+      compression == rpc::compression_type::none ? rpc::compression_type::zstd
+                                                 : compression);
     buf.set_correlation_id(ctx->get_header().correlation_id);
 
     auto view = std::move(buf).as_scattered();
@@ -17,9 +17,12 @@ namespace rpc {
 class simple_protocol final : public server::protocol {
 public:
     template<typename T, typename... Args>
-    void register_service(Args&&... args) {
+    T& register_service(Args&&... args) {
         static_assert(std::is_base_of_v<service, T>, "must extend service.h");
-        _services.push_back(std::make_unique<T>(std::forward<Args>(args)...));
+        auto svc = std::make_unique<T>(std::forward<Args>(args)...);
+        auto& ref = *svc;
+        _services.push_back(std::move(svc));
+        return ref;
     }
 
     const char* name() const final {
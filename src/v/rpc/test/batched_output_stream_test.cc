@@ -0,0 +1,106 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "rpc/batched_output_stream.h"
+
+#include <seastar/core/iostream.hh>
+#include <seastar/core/scattered_message.hh>
+#include <seastar/core/when_all.hh>
+#include <seastar/testing/thread_test_case.hh>
+
+#include <chrono>
+#include <vector>
+
+using namespace std::chrono_literals; // NOLINT
+
+struct sink_stats {
+    size_t flushes = 0;
+    size_t bytes = 0;
+};
+
+class counting_sink final : public ss::data_sink_impl {
+public:
+    explicit counting_sink(sink_stats& s)
+      : _stats(s) {}
+
+    ss::future<> put(ss::net::packet p) final {
+        _stats.bytes += p.len();
+        return ss::make_ready_future<>();
+    }
+    ss::future<> flush() final {
+        ++_stats.flushes;
+        return ss::make_ready_future<>();
+    }
+    ss::future<> close() final { return ss::make_ready_future<>(); }
+
+private:
+    sink_stats& _stats;
+};
+
+static ss::scattered_message<char> make_message(size_t size) {
+    ss::scattered_message<char> msg;
+    msg.append(ss::sstring(size, 'x'));
+    return msg;
+}
+
+struct flush_record {
+    size_t writes;
+    size_t bytes;
+};
+
+static std::vector<flush_record> write_concurrently(
+  rpc::batched_output_stream& out, size_t count, size_t size) {
+    std::vector<flush_record> flushes;
+    out.set_flush_observer([&flushes](size_t writes, size_t bytes) {
+        flushes.push_back(flush_record{writes, bytes});
+    });
+    std::vector<ss::future<>> writes;
+    writes.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        writes.push_back(out.write(make_message(size)));
+    }
+    ss::when_all_succeed(writes.begin(), writes.end()).get();
+    out.stop().get();
+    return flushes;
+}
+
+SEASTAR_THREAD_TEST_CASE(coalesces_writes_of_one_task_quota) {
+    sink_stats stats;
+    rpc::batched_output_stream out(
+      ss::output_stream<char>(
+        ss::data_sink(std::make_unique<counting_sink>(stats)), 4096),
+      rpc::batched_output_stream::default_max_unflushed_bytes,
+      10s);
+
+    auto flushes = write_concurrently(out, 10, 100);
+
+    BOOST_REQUIRE_EQUAL(flushes.size(), 1);
+    BOOST_REQUIRE_EQUAL(flushes[0].writes, 10);
+    BOOST_REQUIRE_EQUAL(flushes[0].bytes, 1000);
+    BOOST_REQUIRE_EQUAL(stats.bytes, 1000);
+}
+
+SEASTAR_THREAD_TEST_CASE(flushes_when_cache_is_full) {
+    sink_stats stats;
+    rpc::batched_output_stream out(
+      ss::output_stream<char>(
+        ss::data_sink(std::make_unique<counting_sink>(stats)), 4096),
+      250,
+      10s);
+
+    auto flushes = write_concurrently(out, 10, 100);
+
+    // every third write fills the cache, the last one is corked
+    BOOST_REQUIRE_EQUAL(flushes.size(), 4);
+    for (size_t i = 0; i < 3; ++i) {
+        BOOST_REQUIRE_EQUAL(flushes[i].writes, 3);
+    }
+    BOOST_REQUIRE_EQUAL(flushes[3].writes, 1);
+    BOOST_REQUIRE_EQUAL(stats.bytes, 1000);
+}
@@ -0,0 +1,142 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "rpc/correlation_table.h"
+#include "rpc/types.h"
+#include "test_utils/fixture.h"
+
+#include <seastar/core/sleep.hh>
+
+#include <vector>
+
+using namespace std::chrono_literals; // NOLINT
+
+struct table_test_ctx final : public rpc::streaming_context {
+    ss::future<ss::semaphore_units<>> reserve_memory(size_t) final {
+        return get_units(s, 1);
+    }
+    const rpc::header& get_header() const final { return hdr; }
+
+    void signal_body_parse() final {}
+
+    rpc::header hdr;
+    ss::semaphore s{1};
+};
+
+struct table_fixture {
+    std::vector<uint32_t> timed_out;
+    rpc::internal::correlation_table table{
+      [this](uint32_t id) { timed_out.push_back(id); }, 4};
+};
+
+FIXTURE_TEST(complete_request, table_fixture) {
+    auto f = table.emplace(1, rpc::no_timeout);
+    BOOST_REQUIRE(table.contains(1));
+    BOOST_REQUIRE(table.complete(1, std::make_unique<table_test_ctx>()));
+    BOOST_REQUIRE(f.get0().has_value());
+    BOOST_REQUIRE(!table.contains(1));
+    BOOST_REQUIRE(!table.complete(1, std::make_unique<table_test_ctx>()));
+    BOOST_REQUIRE_EQUAL(table.size(), 0);
+}
+
+FIXTURE_TEST(grows_when_slot_is_taken, table_fixture) {
+    std::vector<ss::future<rpc::internal::correlation_table::response_ptr>>
+      futures;
+    // ids 1 and 5 share a slot of the initial capacity
+    for (uint32_t id = 1; id <= 6; ++id) {
+        futures.push_back(table.emplace(id, rpc::no_timeout));
+    }
+    BOOST_REQUIRE_EQUAL(table.size(), 6);
+    BOOST_REQUIRE_EQUAL(table.capacity(), 8);
+    for (uint32_t id = 6; id >= 1; --id) {
+        BOOST_REQUIRE(table.complete(id, std::make_unique<table_test_ctx>()));
+    }
+    for (auto& f : futures) {
+        BOOST_REQUIRE(f.get0().has_value());
+    }
+}
+
+FIXTURE_TEST(times_out_with_shared_timer, table_fixture) {
+    auto late = table.emplace(1, rpc::clock_type::now() + 100s);
+    auto early = table.emplace(2, rpc::clock_type::now() + 100ms);
+    auto next = table.emplace(3, rpc::clock_type::now() + 200ms);
+
+    BOOST_REQUIRE_EQUAL(
+      early.get0().error(), rpc::errc::client_request_timeout);
+    BOOST_REQUIRE_EQUAL(
+      next.get0().error(), rpc::errc::client_request_timeout);
+    BOOST_REQUIRE(timed_out == std::vector<uint32_t>({2, 3}));
+
+    BOOST_REQUIRE(table.contains(1));
+    BOOST_REQUIRE(table.complete(1, std::make_unique<table_test_ctx>()));
+    BOOST_REQUIRE(late.get0().has_value());
+}
+
+FIXTURE_TEST(complete_all_fails_requests, table_fixture) {
+    auto a = table.emplace(1, rpc::clock_type::now() + 100ms);
+    auto b = table.emplace(2, rpc::no_timeout);
+    table.complete_all(rpc::errc::disconnected_endpoint);
+
+    BOOST_REQUIRE_EQUAL(a.get0().error(), rpc::errc::disconnected_endpoint);
+    BOOST_REQUIRE_EQUAL(b.get0().error(), rpc::errc::disconnected_endpoint);
+    BOOST_REQUIRE_EQUAL(table.size(), 0);
+    // the timer was cancelled with the requests
+    ss::sleep(200ms).get();
+    BOOST_REQUIRE(timed_out.empty());
+}
+
+FIXTURE_TEST(straggler_goes_to_overflow, table_fixture) {
+    // one request outlives the ids handed out after it
+    auto straggler = table.emplace(1, rpc::no_timeout);
+    for (uint32_t id = 2; id < 100; ++id) {
+        auto f = table.emplace(id, rpc::no_timeout);
+        BOOST_REQUIRE(table.complete(id, std::make_unique<table_test_ctx>()));
+        BOOST_REQUIRE(f.get0().has_value());
+    }
+    BOOST_REQUIRE_EQUAL(table.capacity(), 4);
+    BOOST_REQUIRE_EQUAL(table.size(), 1);
+    BOOST_REQUIRE(table.complete(1, std::make_unique<table_test_ctx>()));
+    BOOST_REQUIRE(straggler.get0().has_value());
+    BOOST_REQUIRE_EQUAL(table.overflow_size(), 0);
+}
+
+FIXTURE_TEST(capacity_is_bounded_and_shrinks, table_fixture) {
+    rpc::internal::correlation_table bounded{[](uint32_t) {}, 4, 8};
+    std::vector<ss::future<rpc::internal::correlation_table::response_ptr>>
+      futures;
+    for (uint32_t id = 1; id <= 20; ++id) {
+        futures.push_back(bounded.emplace(id, rpc::no_timeout));
+    }
+    BOOST_REQUIRE_EQUAL(bounded.capacity(), 8);
+    BOOST_REQUIRE_EQUAL(bounded.size(), 20);
+    BOOST_REQUIRE_EQUAL(bounded.overflow_size(), 12);
+    for (uint32_t id = 1; id <= 20; ++id) {
+        BOOST_REQUIRE(bounded.contains(id));
+        BOOST_REQUIRE(
+          bounded.complete(id, std::make_unique<table_test_ctx>()));
+    }
+    for (auto& f : futures) {
+        BOOST_REQUIRE(f.get0().has_value());
+    }
+    BOOST_REQUIRE_EQUAL(bounded.size(), 0);
+    BOOST_REQUIRE_EQUAL(bounded.overflow_size(), 0);
+    BOOST_REQUIRE_EQUAL(bounded.capacity(), 4);
+}
+
+FIXTURE_TEST(overflow_requests_time_out, table_fixture) {
+    auto straggler = table.emplace(1, rpc::no_timeout);
+    // shares the slot of the straggler
+    auto f = table.emplace(5, rpc::clock_type::now() + 100ms);
+    BOOST_REQUIRE_EQUAL(table.overflow_size(), 1);
+    BOOST_REQUIRE_EQUAL(f.get0().error(), rpc::errc::client_request_timeout);
+    BOOST_REQUIRE(timed_out == std::vector<uint32_t>({5}));
+    table.complete_all(rpc::errc::disconnected_endpoint);
+    BOOST_REQUIRE_EQUAL(
+      straggler.get0().error(), rpc::errc::disconnected_endpoint);
+}
@@ -0,0 +1,81 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "rpc/memory_governor.h"
+#include "rpc/server.h"
+#include "rpc/types.h"
+
+#include <seastar/core/semaphore.hh>
+#include <seastar/testing/thread_test_case.hh>
+
+#include <chrono>
+
+using namespace std::chrono_literals; // NOLINT
+
+static rpc::server_configuration make_config(ss::sstring name) {
+    rpc::server_configuration cfg(std::move(name));
+    cfg.max_service_memory_per_core = 1000;
+    cfg.disable_metrics = rpc::metrics_disabled::yes;
+    return cfg;
+}
+
+SEASTAR_THREAD_TEST_CASE(memory_moves_to_waiting_requests) {
+    rpc::server kafka(make_config("kafka"));
+    rpc::server internal(make_config("internal"));
+    uint64_t reclaimed = 0;
+    rpc::memory_governor governor(1h, [&reclaimed] { return reclaimed; });
+    governor.add("kafka", kafka);
+    governor.add("internal", internal);
+    governor.start(true);
+
+    auto& memory = rpc::server::resources(&kafka, nullptr).memory();
+    auto held = ss::get_units(memory, 1000).get0();
+    auto waiting = ss::get_units(memory, 10);
+    BOOST_REQUIRE_EQUAL(kafka.memory_waiters(), 1);
+
+    // a step is 5% of the total
+    governor.rebalance();
+    BOOST_REQUIRE_EQUAL(kafka.memory_budget(), 1100);
+    BOOST_REQUIRE_EQUAL(internal.memory_budget(), 900);
+    auto more = waiting.get0();
+
+    // nothing waited since, the budgets stay
+    governor.rebalance();
+    BOOST_REQUIRE_EQUAL(kafka.memory_budget(), 1100);
+
+    // the batch cache is evicted, the grown budget goes back
+    reclaimed = 1;
+    governor.rebalance();
+    BOOST_REQUIRE_EQUAL(kafka.memory_budget(), 1000);
+    BOOST_REQUIRE_EQUAL(internal.memory_budget(), 900);
+    governor.stop().get();
+}
+
+SEASTAR_THREAD_TEST_CASE(memory_budgets_keep_their_floor) {
+    rpc::server kafka(make_config("kafka"));
+    rpc::server internal(make_config("internal"));
+    rpc::memory_governor governor(1h, {});
+    governor.add("kafka", kafka);
+    governor.add("internal", internal);
+    governor.start(true);
+
+    auto& memory = rpc::server::resources(&kafka, nullptr).memory();
+    auto held = ss::get_units(memory, 1000).get0();
+    auto waiting = ss::get_units(memory, 2000);
+    for (int i = 0; i < 20; ++i) {
+        governor.rebalance();
+    }
+    BOOST_REQUIRE_EQUAL(internal.memory_budget(), 500);
+    BOOST_REQUIRE_EQUAL(kafka.memory_budget(), 1500);
+    // the internal requests hold their units, nothing is taken from them
+    BOOST_REQUIRE_EQUAL(internal.memory_in_use(), 0);
+    kafka.set_memory_budget(3000);
+    waiting.get();
+    governor.stop().get();
+}
@@ -8,11 +8,15 @@
 // by the Apache License, Version 2.0
 
 #include "reflection/adl.h"
+#include "rpc/correlation_table.h"
+#include "rpc/response_handler.h"
 
 #include <seastar/core/reactor.hh>
 #include <seastar/core/sharded.hh>
 #include <seastar/testing/perf_tests.hh>
 
+#include <absl/container/flat_hash_map.h>
+
 struct small_t {
     int8_t a = 1;
     // char __a_padding;
@@ -85,3 +89,44 @@ PERF_TEST(big_10mb, serialize) {
 PERF_TEST(big_10mb, deserialize) {
     return deserialize_big(10 << 20 /*10MB*/, 1 << 15 /*32KB*/);
 }
+
+// before: a hash map of heap allocated handlers with a timer each
+// after: a slab indexed by correlation id sharing one timer
+static constexpr uint32_t correlations_in_flight = 128;
+
+PERF_TEST(correlation, hash_map_with_timers) {
+    absl::flat_hash_map<
+      uint32_t,
+      std::unique_ptr<rpc::internal::response_handler>>
+      correlations;
+    const auto timeout = rpc::clock_type::now() + std::chrono::seconds(10);
+    perf_tests::start_measuring_time();
+    for (uint32_t id = 0; id < correlations_in_flight; ++id) {
+        auto h = std::make_unique<rpc::internal::response_handler>();
+        h->with_timeout(timeout, [] {});
+        perf_tests::do_not_optimize(h->get_future());
+        correlations.emplace(id, std::move(h));
+    }
+    for (uint32_t id = 0; id < correlations_in_flight; ++id) {
+        auto it = correlations.find(id);
+        auto h = std::move(it->second);
+        correlations.erase(it);
+        h->set_value(rpc::errc::disconnected_endpoint);
+    }
+    perf_tests::stop_measuring_time();
+    return correlations_in_flight;
+}
+
+PERF_TEST(correlation, slab_with_shared_timer) {
+    rpc::internal::correlation_table correlations([](uint32_t) {});
+    const auto timeout = rpc::clock_type::now() + std::chrono::seconds(10);
+    perf_tests::start_measuring_time();
+    for (uint32_t id = 0; id < correlations_in_flight; ++id) {
+        perf_tests::do_not_optimize(correlations.emplace(id, timeout));
+    }
+    for (uint32_t id = 0; id < correlations_in_flight; ++id) {
+        correlations.complete(id, rpc::errc::disconnected_endpoint);
+    }
+    perf_tests::stop_measuring_time();
+    return correlations_in_flight;
+}
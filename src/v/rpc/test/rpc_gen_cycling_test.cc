@@ -270,11 +270,45 @@ FIXTURE_TEST(rpc_mixed_compression, rpc_integration_fixture) {
                       0 /*min bytes compress*/))
                   .get0();
     BOOST_REQUIRE_EQUAL(echo_resp.value().data.str, data);
+    BOOST_TEST_MESSAGE("Calling echo method *WITH* lz4 compression");
+    echo_resp = client
+                  .echo(
+                    echo::echo_req{.str = data},
+                    rpc::client_opts(
+                      rpc::no_timeout,
+                      rpc::compression_type::lz4,
+                      0 /*min bytes compress*/))
+                  .get0();
+    BOOST_REQUIRE_EQUAL(echo_resp.value().data.str, data);
 
     // close resources
     client.stop().get();
 }
 
+FIXTURE_TEST(method_inflight_limit_test, rpc_integration_fixture) {
+    configure_server();
+    register_services();
+    start_server();
+    rpc::client<echo::echo_client_protocol> client(client_config());
+    client.connect(model::no_timeout).get();
+    std::vector<ss::future<>> futures;
+    futures.reserve(5);
+    for (uint64_t i = 0; i < 5; ++i) {
+        futures.push_back(
+          client
+            .bounded_counter(
+              echo::cnt_req{i}, rpc::client_opts(rpc::no_timeout))
+            .then(&rpc::get_ctx_data<echo::cnt_resp>)
+            .then([i](result<echo::cnt_resp> r) {
+                BOOST_REQUIRE_EQUAL(r.value().expected, i);
+                // calls are admitted one at a time
+                BOOST_REQUIRE_EQUAL(r.value().current, 1);
+            }));
+    }
+    ss::when_all_succeed(futures.begin(), futures.end()).get0();
+    client.stop().get();
+}
+
 FIXTURE_TEST(ordering_test, rpc_integration_fixture) {
     configure_server();
     register_services();
@@ -329,6 +363,45 @@ FIXTURE_TEST(missing_method_test, rpc_integration_fixture) {
     t.stop().get();
 }
 
+FIXTURE_TEST(streaming_response_test, rpc_integration_fixture) {
+    configure_server();
+    register_services();
+    start_server();
+    rpc::transport t(client_config());
+    t.connect(model::no_timeout).get();
+    auto client = echo::echo_client_protocol(t);
+    auto stop_action = ss::defer([&t] { t.stop().get(); });
+
+    const auto payload = random_generators::gen_alphanum_string(1024 * 1024);
+    constexpr auto chunk_size = rpc::transport::default_payload_chunk_size;
+    iobuf received;
+    size_t chunks = 0;
+    auto ret = client
+                 .echo_streaming(
+                   echo::echo_req{.str = payload},
+                   rpc::client_opts(rpc::no_timeout),
+                   [&received, &chunks](iobuf chunk) {
+                       BOOST_REQUIRE_LE(chunk.size_bytes(), chunk_size);
+                       ++chunks;
+                       received.append(std::move(chunk));
+                       return ss::now();
+                   })
+                 .get0();
+    BOOST_REQUIRE(ret.has_value());
+    BOOST_REQUIRE_EQUAL(ret.value().data, received.size_bytes());
+    BOOST_REQUIRE_GT(chunks, payload.size() / chunk_size);
+    auto resp = reflection::from_iobuf<echo::echo_resp>(std::move(received));
+    BOOST_REQUIRE_EQUAL(resp.str, payload);
+
+    // the connection is usable after the streamed reply
+    auto echo_resp = client
+                       .echo(
+                         echo::echo_req{.str = "testing..."},
+                         rpc::client_opts(rpc::no_timeout))
+                       .get0();
+    BOOST_REQUIRE_EQUAL(echo_resp.value().data.str, "testing...");
+}
+
 FIXTURE_TEST(corrupted_header_at_client_test, rpc_integration_fixture) {
     configure_server();
     register_services();
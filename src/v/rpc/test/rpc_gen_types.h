@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include "bytes/iobuf.h"
 #include "seastarx.h"
 
 #include <seastar/core/sstring.hh>
@@ -57,3 +58,15 @@ using throw_req = failure_type;
 struct throw_resp {};
 
 } // namespace echo
+
+namespace bench {
+/// \brief request of rpc_transport_bench, replied with reply_size bytes
+struct put_request {
+    uint32_t reply_size;
+    iobuf payload;
+};
+
+struct put_reply {
+    iobuf payload;
+};
+} // namespace bench
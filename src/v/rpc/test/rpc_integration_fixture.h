@@ -27,6 +27,8 @@
 #include <seastar/net/inet_address.hh>
 #include <seastar/net/tls.hh>
 
+#include <algorithm>
+
 // Test services
 struct movistar final : cycling::team_movistar_service {
     movistar(ss::scheduling_group& sc, ss::smp_service_group& ssg)
@@ -75,6 +77,18 @@ struct echo_impl final : echo::echo_service {
           echo::cnt_resp{.expected = req.expected, .current = cnt++});
     }
 
+    /// replies with the most concurrent calls seen, the method is declared
+    /// with a single unit of in-flight limit
+    ss::future<echo::cnt_resp>
+    bounded_counter(echo::cnt_req&& req, rpc::streaming_context&) final {
+        using namespace std::chrono_literals;
+        max_bounded = std::max(max_bounded, ++bounded);
+        return ss::sleep(10ms).then([this, expected = req.expected] {
+            --bounded;
+            return echo::cnt_resp{.expected = expected, .current = max_bounded};
+        });
+    }
+
     ss::future<echo::throw_resp>
     throw_exception(echo::throw_req&& req, rpc::streaming_context&) final {
         switch (req) {
@@ -89,6 +103,8 @@ struct echo_impl final : echo::echo_service {
     }
 
     uint64_t cnt = 0;
+    uint64_t bounded = 0;
+    uint64_t max_bounded = 0;
 };
 
 class rpc_base_integration_fixture {
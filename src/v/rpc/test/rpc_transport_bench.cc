@@ -0,0 +1,552 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "bytes/iobuf.h"
+#include "random/generators.h"
+#include "rpc/server.h"
+#include "rpc/simple_protocol.h"
+#include "rpc/test/bench_service.h"
+#include "rpc/test/rpc_gen_types.h"
+#include "rpc/transport.h"
+#include "rpc/types.h"
+#include "syschecks/syschecks.h"
+#include "utils/hdr_hist.h"
+#include "vlog.h"
+
+#include <seastar/core/app-template.hh>
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/sharded.hh>
+#include <seastar/core/thread.hh>
+#include <seastar/core/when_all.hh>
+#include <seastar/net/tls.hh>
+#include <seastar/util/defer.hh>
+
+#include <boost/algorithm/string.hpp>
+#include <fmt/format.h>
+
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/*
+ * Transport benchmark matrix. Starts an rpc server on every core with a
+ * plain and a TLS listener, then for every combination of
+ *
+ *   - payload size of the requests and of their replies
+ *   - concurrency, requests in flight per connection
+ *   - connections per core
+ *   - TLS on or off
+ *   - compression type
+ *
+ * drives the same number of requests from every core and reports the
+ * throughput and the latency percentiles of the cell, one json line each.
+ *
+ * With --replay the sizes come from captured raft traffic instead of the
+ * payload sizes, one request per line, replayed in order:
+ *
+ *   <append_entries|heartbeat>,<request bytes>,<reply bytes>
+ *
+ * and latencies are reported per kind of request, which shows how
+ * heartbeats fare next to large appends. --replay=raft uses a built in
+ * synthetic mix.
+ *
+ * TLS uses the certificates of the rpc tests, run it from rpc/test or point
+ * --key, --cert and --ca at other ones.
+ *
+ *   rpc_transport_bench --smp 2 --payload-sizes 512,65536 --tls off,on
+ */
+
+using namespace std::chrono_literals; // NOLINT
+
+namespace po = boost::program_options; // NOLINT
+
+static ss::logger benchlog("rpc_bench");
+
+enum class request_kind : uint8_t { payload = 0, append_entries, heartbeat };
+static constexpr size_t request_kinds = 3;
+
+static std::string_view to_string(request_kind k) {
+    switch (k) {
+    case request_kind::payload:
+        return "payload";
+    case request_kind::append_entries:
+        return "append_entries";
+    case request_kind::heartbeat:
+        return "heartbeat";
+    }
+    __builtin_unreachable();
+}
+
+static std::string_view to_string(rpc::compression_type c) {
+    switch (c) {
+    case rpc::compression_type::none:
+        return "none";
+    case rpc::compression_type::zstd:
+        return "zstd";
+    case rpc::compression_type::lz4:
+        return "lz4";
+    }
+    __builtin_unreachable();
+}
+
+struct request_sample {
+    request_kind kind;
+    uint32_t request_size;
+    uint32_t reply_size;
+};
+
+struct matrix_cell {
+    size_t concurrency;
+    size_t connections;
+    bool tls;
+    rpc::compression_type compression;
+    std::vector<request_sample> samples;
+};
+
+struct bench_config {
+    std::vector<size_t> payload_sizes;
+    std::vector<size_t> concurrency;
+    std::vector<size_t> connections;
+    std::vector<bool> tls;
+    std::vector<rpc::compression_type> compression;
+    size_t requests;
+    std::vector<request_sample> replay;
+    uint16_t port;
+    ss::sstring key;
+    ss::sstring cert;
+    ss::sstring ca;
+};
+
+static void cli_opts(po::options_description_easy_init o) {
+    o("payload-sizes",
+      po::value<std::string>()->default_value("128,4096,65536,1048576"),
+      "comma separated sizes of requests and replies in bytes");
+    o("concurrency",
+      po::value<std::string>()->default_value("1,16,128"),
+      "comma separated numbers of requests in flight per connection");
+    o("connections",
+      po::value<std::string>()->default_value("1,4"),
+      "comma separated numbers of connections per core");
+    o("tls",
+      po::value<std::string>()->default_value("off,on"),
+      "comma separated list of off and on");
+    o("compression",
+      po::value<std::string>()->default_value("none,zstd,lz4"),
+      "comma separated list of none, zstd and lz4");
+    o("requests",
+      po::value<size_t>()->default_value(10000),
+      "requests per core and matrix cell");
+    o("replay",
+      po::value<std::string>()->default_value(""),
+      "file of captured raft request sizes replacing the payload sizes, "
+      "'raft' for a built in mix");
+    o("port",
+      po::value<uint16_t>()->default_value(33145),
+      "port of the plain listener, the TLS one uses the next");
+    o("key",
+      po::value<std::string>()->default_value("redpanda.key"),
+      "TLS key of the server");
+    o("cert",
+      po::value<std::string>()->default_value("redpanda.crt"),
+      "TLS certificate of the server");
+    o("ca",
+      po::value<std::string>()->default_value(
+        "root_certificate_authority.chain_cert"),
+      "TLS root certificate the clients trust");
+}
+
+template<typename T, typename Func>
+static std::vector<T> parse_list(const std::string& s, Func f) {
+    std::vector<std::string> parts;
+    boost::split(parts, s, boost::is_any_of(","));
+    std::vector<T> ret;
+    ret.reserve(parts.size());
+    for (auto& p : parts) {
+        boost::trim(p);
+        if (!p.empty()) {
+            ret.push_back(f(p));
+        }
+    }
+    return ret;
+}
+
+static rpc::compression_type parse_compression(const std::string& s) {
+    if (s == "none") {
+        return rpc::compression_type::none;
+    }
+    if (s == "zstd") {
+        return rpc::compression_type::zstd;
+    }
+    if (s == "lz4") {
+        return rpc::compression_type::lz4;
+    }
+    throw std::invalid_argument(fmt::format("unknown compression: {}", s));
+}
+
+static bool parse_tls(const std::string& s) {
+    if (s == "on") {
+        return true;
+    }
+    if (s == "off") {
+        return false;
+    }
+    throw std::invalid_argument(fmt::format("tls must be on or off: {}", s));
+}
+
+/// synthetic raft traffic: heartbeats of a few hundred groups next to
+/// produce sized appends and an occasional large recovery append
+static std::vector<request_sample> raft_mix() {
+    std::vector<request_sample> ret;
+    for (int i = 0; i < 100; ++i) {
+        if (i % 2 == 0) {
+            ret.push_back({request_kind::heartbeat, 12 * 1024, 8 * 1024});
+        } else if (i % 25 == 1) {
+            ret.push_back({request_kind::append_entries, 1024 * 1024, 64});
+        } else {
+            ret.push_back({request_kind::append_entries, 16 * 1024, 64});
+        }
+    }
+    return ret;
+}
+
+static std::vector<request_sample> read_replay(const std::string& path) {
+    if (path.empty()) {
+        return {};
+    }
+    if (path == "raft") {
+        return raft_mix();
+    }
+    std::ifstream in(path);
+    if (!in) {
+        throw std::invalid_argument(
+          fmt::format("cannot open replay file: {}", path));
+    }
+    std::vector<request_sample> ret;
+    std::string line;
+    while (std::getline(in, line)) {
+        boost::trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::vector<std::string> f;
+        boost::split(f, line, boost::is_any_of(","));
+        if (f.size() != 3) {
+            throw std::invalid_argument(
+              fmt::format("bad replay line: {}", line));
+        }
+        request_kind kind;
+        if (f[0] == "append_entries") {
+            kind = request_kind::append_entries;
+        } else if (f[0] == "heartbeat") {
+            kind = request_kind::heartbeat;
+        } else {
+            throw std::invalid_argument(
+              fmt::format("unknown request kind: {}", f[0]));
+        }
+        ret.push_back(
+          {kind,
+           static_cast<uint32_t>(std::stoul(f[1])),
+           static_cast<uint32_t>(std::stoul(f[2]))});
+    }
+    if (ret.empty()) {
+        throw std::invalid_argument(
+          fmt::format("empty replay file: {}", path));
+    }
+    return ret;
+}
+
+static bench_config cfg_from(const po::variables_map& m) {
+    auto to_size = [](const std::string& s) { return size_t(std::stoull(s)); };
+    return bench_config{
+      .payload_sizes = parse_list<size_t>(
+        m["payload-sizes"].as<std::string>(), to_size),
+      .concurrency = parse_list<size_t>(
+        m["concurrency"].as<std::string>(), to_size),
+      .connections = parse_list<size_t>(
+        m["connections"].as<std::string>(), to_size),
+      .tls = parse_list<bool>(m["tls"].as<std::string>(), parse_tls),
+      .compression = parse_list<rpc::compression_type>(
+        m["compression"].as<std::string>(), parse_compression),
+      .requests = m["requests"].as<size_t>(),
+      .replay = read_replay(m["replay"].as<std::string>()),
+      .port = m["port"].as<uint16_t>(),
+      .key = m["key"].as<std::string>(),
+      .cert = m["cert"].as<std::string>(),
+      .ca = m["ca"].as<std::string>(),
+    };
+}
+
+/// alphanumeric so that compression has something to do
+static iobuf make_payload(size_t size) {
+    static constexpr size_t chunk = 128 * 1024;
+    const auto data = random_generators::gen_alphanum_string(chunk);
+    iobuf ret;
+    while (ret.size_bytes() < size) {
+        ret.append(data.data(), std::min(chunk, size - ret.size_bytes()));
+    }
+    return ret;
+}
+
+struct bench_service_impl final : bench::bench_service {
+    using bench::bench_service::bench_service;
+
+    ss::future<bench::put_reply>
+    put(bench::put_request&& r, rpc::streaming_context&) final {
+        if (_payload.size_bytes() < r.reply_size) {
+            _payload = make_payload(r.reply_size);
+        }
+        return ss::make_ready_future<bench::put_reply>(
+          bench::put_reply{.payload = _payload.share(0, r.reply_size)});
+    }
+
+    iobuf _payload;
+};
+
+/// drives the requests of one core for a matrix cell
+class loadgen {
+public:
+    using client_t = rpc::client<bench::bench_client_protocol>;
+
+    loadgen(matrix_cell cell, size_t requests, ss::socket_address addr)
+      : _cell(std::move(cell))
+      , _requests(requests)
+      , _addr(addr) {
+        size_t max_size = 0;
+        for (auto& s : _cell.samples) {
+            max_size = std::max<size_t>(max_size, s.request_size);
+        }
+        _payload = make_payload(max_size);
+    }
+
+    ss::future<> connect(ss::sstring ca) {
+        rpc::transport_configuration cfg;
+        cfg.server_addr = _addr;
+        cfg.disable_metrics = rpc::metrics_disabled::yes;
+        if (_cell.tls) {
+            ss::tls::credentials_builder builder;
+            co_await builder.set_x509_trust_file(
+              ca, ss::tls::x509_crt_format::PEM);
+            cfg.credentials = builder.build_certificate_credentials();
+        }
+        for (size_t i = 0; i < _cell.connections; ++i) {
+            _clients.push_back(std::make_unique<client_t>(cfg));
+            co_await _clients.back()->connect(rpc::clock_type::now() + 10s);
+        }
+    }
+
+    ss::future<> run() {
+        std::vector<ss::future<>> fibers;
+        fibers.reserve(_clients.size() * _cell.concurrency);
+        for (auto& c : _clients) {
+            for (size_t i = 0; i < _cell.concurrency; ++i) {
+                fibers.push_back(issue(*c));
+            }
+        }
+        return ss::when_all_succeed(fibers.begin(), fibers.end());
+    }
+
+    ss::future<> stop() {
+        for (auto& c : _clients) {
+            co_await c->stop();
+        }
+    }
+
+    const hdr_hist& latency(request_kind k) const {
+        return _latency[static_cast<size_t>(k)];
+    }
+    size_t bytes() const { return _bytes; }
+    size_t errors() const { return _errors; }
+
+private:
+    ss::future<> issue(client_t& c) {
+        while (_issued < _requests) {
+            const auto& s = _cell.samples[_issued++ % _cell.samples.size()];
+            auto m = _latency[static_cast<size_t>(s.kind)].auto_measure();
+            auto r = co_await c.put(
+              bench::put_request{
+                .reply_size = s.reply_size,
+                .payload = _payload.share(0, s.request_size)},
+              rpc::client_opts(
+                rpc::clock_type::now() + 30s, _cell.compression, 0));
+            if (!r) {
+                m->set_trace(false);
+                ++_errors;
+                continue;
+            }
+            _bytes += s.request_size + s.reply_size;
+        }
+    }
+
+    matrix_cell _cell;
+    size_t _requests;
+    ss::socket_address _addr;
+    iobuf _payload;
+    std::vector<std::unique_ptr<client_t>> _clients;
+    std::array<hdr_hist, request_kinds> _latency;
+    size_t _issued{0};
+    size_t _bytes{0};
+    size_t _errors{0};
+};
+
+class transport_bench {
+public:
+    explicit transport_bench(bench_config cfg)
+      : _cfg(std::move(cfg)) {}
+
+    void run() {
+        start_server();
+        auto stop = ss::defer([this] { _server.stop().get(); });
+        for (auto& cell : cells()) {
+            run_cell(std::move(cell));
+        }
+    }
+
+private:
+    std::vector<matrix_cell> cells() const {
+        std::vector<std::vector<request_sample>> workloads;
+        if (!_cfg.replay.empty()) {
+            workloads.push_back(_cfg.replay);
+        } else {
+            for (auto size : _cfg.payload_sizes) {
+                auto sz = static_cast<uint32_t>(size);
+                workloads.push_back({{request_kind::payload, sz, sz}});
+            }
+        }
+        std::vector<matrix_cell> ret;
+        for (auto& w : workloads) {
+            for (auto concurrency : _cfg.concurrency) {
+                for (auto connections : _cfg.connections) {
+                    for (auto tls : _cfg.tls) {
+                        for (auto compression : _cfg.compression) {
+                            ret.push_back(matrix_cell{
+                              .concurrency = concurrency,
+                              .connections = connections,
+                              .tls = tls,
+                              .compression = compression,
+                              .samples = w});
+                        }
+                    }
+                }
+            }
+        }
+        return ret;
+    }
+
+    void start_server() {
+        ss::tls::credentials_builder builder;
+        builder
+          .set_x509_key_file(
+            _cfg.cert, _cfg.key, ss::tls::x509_crt_format::PEM)
+          .get();
+        rpc::server_configuration scfg("rpc_transport_bench");
+        scfg.addrs.emplace_back(
+          ss::socket_address(ss::ipv4_addr("127.0.0.1", _cfg.port)));
+        scfg.addrs.emplace_back(
+          ss::socket_address(ss::ipv4_addr("127.0.0.1", _cfg.port + 1)),
+          builder.build_server_credentials());
+        scfg.max_service_memory_per_core = static_cast<int64_t>(
+          ss::memory::stats().total_memory() / 4);
+        scfg.disable_metrics = rpc::metrics_disabled::yes;
+        _server.start(std::move(scfg)).get();
+        _server
+          .invoke_on_all([](rpc::server& s) {
+              auto proto = std::make_unique<rpc::simple_protocol>();
+              proto->register_service<bench_service_impl>(
+                ss::default_scheduling_group(),
+                ss::default_smp_service_group());
+              s.set_protocol(std::move(proto));
+          })
+          .get();
+        _server.invoke_on_all(&rpc::server::start).get();
+    }
+
+    void run_cell(matrix_cell cell) {
+        auto port = cell.tls ? _cfg.port + 1 : _cfg.port;
+        ss::socket_address addr(ss::ipv4_addr("127.0.0.1", port));
+        const auto concurrency = cell.concurrency;
+        const auto connections = cell.connections;
+        const auto tls = cell.tls;
+        const auto compression = cell.compression;
+        const bool replay = cell.samples[0].kind != request_kind::payload;
+        const auto payload_size = cell.samples[0].request_size;
+
+        ss::sharded<loadgen> lg;
+        lg.start(std::move(cell), _cfg.requests, addr).get();
+        auto stop = ss::defer([&lg] { lg.stop().get(); });
+        lg.invoke_on_all(&loadgen::connect, _cfg.ca).get();
+        auto begin = std::chrono::steady_clock::now();
+        lg.invoke_on_all(&loadgen::run).get();
+        std::chrono::duration<double> elapsed
+          = std::chrono::steady_clock::now() - begin;
+
+        size_t bytes = 0;
+        size_t errors = 0;
+        std::array<hdr_hist, request_kinds> latency;
+        for (ss::shard_id i = 0; i < ss::smp::count; ++i) {
+            lg.invoke_on(i, [&](const loadgen& l) {
+                  bytes += l.bytes();
+                  errors += l.errors();
+                  for (size_t k = 0; k < request_kinds; ++k) {
+                      latency[k] += l.latency(request_kind(k));
+                  }
+              })
+              .get();
+        }
+
+        const auto requests = _cfg.requests * ss::smp::count;
+        auto line = fmt::format(
+          "{{'payload_size':{}, 'concurrency':{}, 'connections':{}, "
+          "'tls':{}, 'compression':'{}', 'cores':{}, 'requests':{}, "
+          "'errors':{}, 'qps':{:.0f}, 'mb_per_sec':{:.1f}",
+          replay ? std::string("'replay'") : std::to_string(payload_size),
+          concurrency,
+          connections,
+          tls,
+          to_string(compression),
+          ss::smp::count,
+          requests,
+          errors,
+          requests / elapsed.count(),
+          bytes / elapsed.count() / (1024 * 1024));
+        for (size_t k = 0; k < request_kinds; ++k) {
+            const auto& h = latency[k];
+            if (h.get_value_at(100.0) == 0) {
+                continue;
+            }
+            line += fmt::format(
+              ", '{}_us':{{'p50':{}, 'p99':{}, 'p999':{}, 'max':{}}}",
+              to_string(request_kind(k)),
+              h.get_value_at(50.0),
+              h.get_value_at(99.0),
+              h.get_value_at(99.9),
+              h.get_value_at(100.0));
+        }
+        line += "}";
+        fmt::print("{}\n", line);
+    }
+
+    bench_config _cfg;
+    ss::sharded<rpc::server> _server;
+};
+
+int main(int args, char** argv, char** env) {
+    syschecks::initialize_intrinsics();
+    std::setvbuf(stdout, nullptr, _IOLBF, 1024);
+    ss::app_template app;
+    cli_opts(app.add_options());
+    return app.run(args, argv, [&] {
+        return ss::async([&] {
+            transport_bench bench(cfg_from(app.configuration()));
+            vlog(benchlog.info, "starting transport benchmark matrix");
+            bench.run();
+        });
+    });
+}
@@ -13,7 +13,6 @@
 #include "rpc/logger.h"
 #include "rpc/netbuf.h"
 #include "rpc/parse_utils.h"
-#include "rpc/response_handler.h"
 #include "rpc/types.h"
 #include "vlog.h"
 
@@ -58,7 +57,11 @@ transport::transport(
     .server_addr = std::move(c.server_addr),
     .credentials = std::move(c.credentials),
   })
-  , _memory(c.max_queued_bytes) {
+  , _memory(c.max_queued_bytes)
+  , _correlations([this](uint32_t idx) {
+      vlog(rpclog.info, "Request timeout, correlation id: {}", idx);
+      _probe.request_timeout();
+  }) {
     if (!c.disable_metrics) {
         setup_metrics(service_name);
     }
@@ -101,6 +104,7 @@ ss::future<> base_transport::do_connect(clock_type::time_point timeout) {
               _creds,
               std::move(fd),
               _tls_sni_hostname ? *_tls_sni_hostname : ss::sstring{});
+            _probe.tls_connection_established();
         }
         _fd = std::make_unique<ss::connected_socket>(std::move(fd));
         _probe.connection_established();
@@ -135,13 +139,10 @@ ss::future<> base_transport::stop() {
 void transport::fail_outstanding_futures() noexcept {
     // must close the socket
     shutdown();
-    for (auto& [_, p] : _correlations) {
-        p->set_value(errc::disconnected_endpoint);
-    }
+    _correlations.complete_all(errc::disconnected_endpoint);
     _last_seq = sequence_t{0};
     _seq = sequence_t{0};
     _requests_queue.clear();
-    _correlations.clear();
 }
 void base_transport::shutdown() noexcept {
     try {
@@ -190,34 +191,14 @@ transport::send(netbuf b, rpc::client_opts opts) {
 
 ss::future<result<std::unique_ptr<streaming_context>>>
 transport::make_response_handler(netbuf& b, const rpc::client_opts& opts) {
-    if (_correlations.find(_correlation_idx + 1) != _correlations.end()) {
+    if (_correlations.contains(_correlation_idx + 1)) {
         _probe.client_correlation_error();
         throw std::runtime_error("Invalid transport state. Doubly "
                                  "registered correlation_id");
     }
     const uint32_t idx = ++_correlation_idx;
-    auto item = std::make_unique<internal::response_handler>();
-    auto item_raw_ptr = item.get();
-    // capture the future _before_ inserting promise in the map
-    // in case there is a concurrent error w/ the connection and it
-    // fails the future before we return from this function
-    auto response_future = item_raw_ptr->get_future();
     b.set_correlation_id(idx);
-    auto [_, success] = _correlations.emplace(idx, std::move(item));
-    if (unlikely(!success)) {
-        throw std::logic_error(
-          fmt::format("Tried to reuse correlation id: {}", idx));
-    }
-    item_raw_ptr->with_timeout(opts.timeout, [this, idx] {
-        auto it = _correlations.find(idx);
-        if (likely(it != _correlations.end())) {
-            vlog(rpclog.info, "Request timeout, correlation id: {}", idx);
-            _probe.request_timeout();
-            _correlations.erase(it);
-        }
-    });
-
-    return response_future;
+    return _correlations.emplace(idx, opts.timeout);
 }
 
 ss::future<result<std::unique_ptr<streaming_context>>>
@@ -236,6 +217,16 @@ transport::do_send(sequence_t seq, netbuf b, rpc::client_opts opts) {
 
           // send
           auto sz = b.buffer().size_bytes();
+          if (auto units = ss::try_get_units(_memory, sz); likely(units)) {
+              // the memory is available, enqueue without waiting for it
+              _requests_queue.emplace(
+                seq, std::make_unique<netbuf>(std::move(b)));
+              dispatch_send();
+              return std::move(f).finally(
+                [this, seq, u = std::move(*units)] {
+                    _last_seq = std::max(_last_seq, seq);
+                });
+          }
           return get_units(_memory, sz)
             .then([this, b = std::move(b), f = std::move(f), seq](
                     ss::semaphore_units<> units) mutable {
@@ -265,8 +256,13 @@ void transport::dispatch_send() {
               auto it = _requests_queue.begin();
               _last_seq = it->first;
               auto buffer = std::move(it->second).get();
+              auto payload_size = buffer->buffer().size_bytes();
               auto v = std::move(*buffer).as_scattered();
               auto msg_size = v.size();
+              if (buffer->compression() != compression_type::none) {
+                  _probe.add_compressed_bytes_sent(
+                    payload_size, msg_size - size_of_rpc_header);
+              }
               _requests_queue.erase(it->first);
               return _out.write(std::move(v)).finally([this, msg_size] {
                   _probe.add_bytes_sent(msg_size);
@@ -301,8 +297,7 @@ ss::future<> transport::do_reads() {
 /// - this needs a streaming_context.
 ///
 ss::future<> transport::dispatch(header h) {
-    auto it = _correlations.find(h.correlation_id);
-    if (it == _correlations.end()) {
+    if (!_correlations.contains(h.correlation_id)) {
         // We removed correlation already
         _probe.server_correlation_error();
         vlog(
@@ -315,11 +310,7 @@ ss::future<> transport::dispatch(header h) {
     _probe.add_bytes_received(size_of_rpc_header + h.payload_size);
     auto ctx = std::make_unique<client_context_impl>(*this, h);
     auto fut = ctx->pr.get_future();
-    // delete before setting value so that we don't run into nested exceptions
-    // of broken promises
-    auto pr = std::move(it->second);
-    _correlations.erase(it);
-    pr->set_value(std::move(ctx));
+    _correlations.complete(h.correlation_id, std::move(ctx));
     _probe.request_completed();
     return fut;
 }
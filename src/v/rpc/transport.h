@@ -15,10 +15,10 @@
 #include "reflection/async_adl.h"
 #include "rpc/batched_output_stream.h"
 #include "rpc/client_probe.h"
+#include "rpc/correlation_table.h"
 #include "rpc/errc.h"
 #include "rpc/netbuf.h"
 #include "rpc/parse_utils.h"
-#include "rpc/response_handler.h"
 #include "rpc/types.h"
 #include "seastarx.h"
 #include "utils/named_type.h"
@@ -28,6 +28,7 @@
 #include <seastar/core/metrics_registration.hh>
 #include <seastar/core/semaphore.hh>
 #include <seastar/net/api.hh>
+#include <seastar/util/noncopyable_function.hh>
 #include <seastar/net/tls.hh>
 
 #include <absl/container/btree_map.h>
@@ -106,6 +107,23 @@ public:
     ss::future<result<client_context<Output>>>
       send_typed(Input, uint32_t, rpc::client_opts);
 
+    /// \brief consumes one chunk of a streamed response payload
+    using payload_consumer = ss::noncopyable_function<ss::future<>(iobuf)>;
+    static constexpr size_t default_payload_chunk_size = 128 * 1024;
+
+    /// \brief sends the request and streams the payload of a successful
+    /// reply to the consumer in bounded chunks instead of buffering it, see
+    /// consume_payload. the connection reads no other reply until the
+    /// payload was consumed. the context data is the size of the payload on
+    /// the wire
+    template<typename Input>
+    ss::future<result<client_context<size_t>>> send_streaming(
+      Input,
+      uint32_t,
+      rpc::client_opts,
+      payload_consumer,
+      size_t chunk_size = default_payload_chunk_size);
+
 private:
     using sequence_t = named_type<uint64_t, struct sequence_tag>;
     using requests_queue_t
@@ -124,8 +142,7 @@ private:
     make_response_handler(netbuf&, const rpc::client_opts&);
 
     ss::semaphore _memory;
-    absl::flat_hash_map<uint32_t, std::unique_ptr<internal::response_handler>>
-      _correlations;
+    internal::correlation_table _correlations;
     uint32_t _correlation_idx{0};
     ss::metrics::metric_groups _metrics;
     /**
@@ -199,6 +216,52 @@ transport::send_typed(Input r, uint32_t method_id, rpc::client_opts opts) {
       });
 }
 
+template<typename Input>
+inline ss::future<result<client_context<size_t>>> transport::send_streaming(
+  Input r,
+  uint32_t method_id,
+  rpc::client_opts opts,
+  payload_consumer consumer,
+  size_t chunk_size) {
+    using ret_t = result<client_context<size_t>>;
+    _probe.request();
+
+    auto b = std::make_unique<rpc::netbuf>();
+    b->set_compression(opts.compression);
+    b->set_min_compression_bytes(opts.min_compression_bytes);
+    auto raw_b = b.get();
+    raw_b->set_service_method_id(method_id);
+
+    auto& target_buffer = raw_b->buffer();
+    auto seq = ++_seq;
+    return reflection::async_adl<Input>{}
+      .to(target_buffer, std::move(r))
+      .then([this, b = std::move(b), seq, opts = std::move(opts)]() mutable {
+          return do_send(seq, std::move(*b.get()), std::move(opts));
+      })
+      .then([this, consumer = std::move(consumer), chunk_size](
+              result<std::unique_ptr<streaming_context>> sctx) mutable {
+          if (!sctx) {
+              return ss::make_ready_future<ret_t>(sctx.error());
+          }
+          const auto& h = sctx.value()->get_header();
+          auto f = ss::now();
+          size_t consumed = 0;
+          if (static_cast<status>(h.meta) == status::success) {
+              consumed = h.payload_size;
+              f = consume_payload(_in, h, chunk_size, std::move(consumer));
+          } else {
+              // errors carry no payload worth streaming
+              f = _in.skip(h.payload_size);
+          }
+          return f.then([sctx = std::move(sctx), consumed]() mutable {
+              sctx.value()->signal_body_parse();
+              return internal::map_result<size_t>(
+                sctx.value()->get_header(), consumed);
+          });
+      });
+}
+
 // clang-format off
 CONCEPT(
 template<typename Protocol>
@@ -45,14 +45,27 @@ static constexpr clock_type::time_point no_timeout
 enum class compression_type : uint8_t {
     none = 0,
     zstd,
+    lz4,
     min = none,
-    max = zstd,
+    max = lz4,
+};
+
+/// \brief kind of traffic, connection_cache can give every kind its own
+/// connections to a node
+enum class connection_class : uint8_t {
+    /// everything not marked otherwise
+    normal = 0,
+    /// small latency sensitive requests like votes and heartbeats
+    control,
+    /// large transfers like follower recovery
+    bulk,
 };
 
 struct negotiation_frame {
     int8_t version = 0;
     /// \brief 0 - no compression
     ///        1 - zstd
+    ///        2 - lz4
     compression_type compression = compression_type::none;
 };
 
@@ -120,6 +133,9 @@ struct client_opts {
     clock_type::time_point timeout;
     compression_type compression;
     size_t min_compression_bytes;
+    /// \brief connection the request should go through, a hint to the
+    /// client protocol sending it
+    connection_class connection{connection_class::normal};
 };
 
 /// \brief used to pass environment context to the class
@@ -211,6 +227,9 @@ struct server_configuration {
     // we use the same default as seastar for load balancing algorithm
     ss::server_socket::load_balancing_algorithm load_balancing_algo
       = ss::server_socket::load_balancing_algorithm::connection_distribution;
+    /// initial and minimum read buffer of the connections, the reads filling
+    /// it grow it up to the seastar maximum. 0 keeps the seastar default
+    size_t connection_read_buffer = 0;
 
     explicit server_configuration(ss::sstring n)
       : name(std::move(n)) {}
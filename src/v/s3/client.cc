@@ -10,6 +10,7 @@
 
 #include "s3/client.h"
 
+#include "bytes/bytes.h"
 #include "bytes/iobuf.h"
 #include "bytes/iobuf_istreambuf.h"
 #include "hashing/secure.h"
@@ -32,6 +33,7 @@
 #include <boost/property_tree/xml_parser.hpp>
 #include <gnutls/crypto.h>
 
+#include <deque>
 #include <exception>
 
 namespace s3 {
@@ -43,12 +45,17 @@ struct aws_header_names {
     static constexpr boost::beast::string_view x_amz_content_sha256
       = "x-amz-content-sha256";
     static constexpr boost::beast::string_view x_amz_tagging = "x-amz-tagging";
+    static constexpr boost::beast::string_view x_amz_decoded_content_length
+      = "x-amz-decoded-content-length";
 };
 
 struct aws_header_values {
     static constexpr boost::beast::string_view user_agent
       = "redpanda.vectorized.io";
     static constexpr boost::beast::string_view text_plain = "text/plain";
+    static constexpr boost::beast::string_view application_xml
+      = "application/xml";
+    static constexpr boost::beast::string_view aws_chunked = "aws-chunked";
 };
 
 // configuration //
@@ -117,7 +124,9 @@ request_creator::request_creator(const configuration& conf)
   , _sign(conf.region, conf.access_key, conf.secret_key) {}
 
 result<http::client::request_header> request_creator::make_get_object_request(
-  bucket_name const& name, object_key const& key) {
+  bucket_name const& name,
+  object_key const& key,
+  std::optional<byte_range> range) {
     http::client::request_header header{};
     // GET /{object-id} HTTP/1.1
     // Host: {bucket-name}.s3.amazonaws.com
@@ -135,6 +144,13 @@ result<http::client::request_header> request_creator::make_get_object_request(
     header.insert(boost::beast::http::field::host, host);
     header.insert(boost::beast::http::field::content_length, "0");
     header.insert(aws_header_names::x_amz_content_sha256, emptysig);
+    if (range) {
+        // Range: bytes={first}-{last}
+        header.insert(
+          boost::beast::http::field::range,
+          range->last ? fmt::format("bytes={}-{}", range->first, *range->last)
+                      : fmt::format("bytes={}-", range->first));
+    }
     auto ec = _sign.sign_header(header, emptysig);
     if (ec) {
         return ec;
@@ -142,25 +158,37 @@ result<http::client::request_header> request_creator::make_get_object_request(
     return header;
 }
 
-result<http::client::request_header>
-request_creator::make_unsigned_put_object_request(
+static void add_tagging_header(
+  http::client::request_header& header, const std::vector<object_tag>& tags) {
+    if (tags.empty()) {
+        return;
+    }
+    std::stringstream tstr;
+    for (const auto& [key, val] : tags) {
+        tstr << fmt::format("&{}={}", key, val);
+    }
+    header.insert(aws_header_names::x_amz_tagging, tstr.str().substr(1));
+}
+
+result<request_creator::streaming_put_request>
+request_creator::make_streaming_put_object_request(
   bucket_name const& name,
   object_key const& key,
   size_t payload_size_bytes,
+  size_t chunk_size,
   const std::vector<object_tag>& tags) {
     // PUT /my-image.jpg HTTP/1.1
     // Host: myBucket.s3.<Region>.amazonaws.com
-    // Date: Wed, 12 Oct 2009 17:50:00 GMT
     // Authorization: authorization string
     // Content-Type: text/plain
-    // Content-Length: 11434
-    // x-amz-meta-author: Janet
-    // Expect: 100-continue
-    // [11434 bytes of object data]
+    // Content-Encoding: aws-chunked
+    // Content-Length: <size of the payload in aws-chunked encoding>
+    // x-amz-content-sha256: STREAMING-AWS4-HMAC-SHA256-PAYLOAD
+    // x-amz-decoded-content-length: 11434
+    // [signed chunks of the 11434 bytes of object data]
     http::client::request_header header{};
     auto host = fmt::format("{}.{}", name(), _ap());
     auto target = fmt::format("/{}", key().string());
-    std::string sig = "UNSIGNED-PAYLOAD";
     header.method(boost::beast::http::verb::put);
     header.target(target);
     header.insert(
@@ -168,22 +196,22 @@ request_creator::make_unsigned_put_object_request(
     header.insert(boost::beast::http::field::host, host);
     header.insert(
       boost::beast::http::field::content_type, aws_header_values::text_plain);
+    header.insert(
+      boost::beast::http::field::content_encoding,
+      aws_header_values::aws_chunked);
     header.insert(
       boost::beast::http::field::content_length,
+      std::to_string(aws_chunked_length(payload_size_bytes, chunk_size)));
+    header.insert(
+      aws_header_names::x_amz_decoded_content_length,
       std::to_string(payload_size_bytes));
-    header.insert(aws_header_names::x_amz_content_sha256, sig);
-    if (!tags.empty()) {
-        std::stringstream tstr;
-        for (const auto& [key, val] : tags) {
-            tstr << fmt::format("&{}={}", key, val);
-        }
-        header.insert(aws_header_names::x_amz_tagging, tstr.str().substr(1));
+    add_tagging_header(header, tags);
+    auto signer = _sign.sign_streaming_header(header);
+    if (!signer) {
+        return signer.error();
     }
-    auto ec = _sign.sign_header(header, sig);
-    if (ec) {
-        return ec;
-    }
-    return header;
+    return streaming_put_request{
+      .header = std::move(header), .signer = std::move(signer.value())};
 }
 
 result<http::client::request_header>
@@ -254,6 +282,159 @@ request_creator::make_delete_object_request(
     return header;
 }
 
+result<http::client::request_header>
+request_creator::make_create_multipart_upload_request(
+  bucket_name const& name,
+  object_key const& key,
+  const std::vector<object_tag>& tags) {
+    // POST /{object-id}?uploads HTTP/1.1
+    // Host: {bucket-name}.s3.amazonaws.com
+    // x-amz-date:{req-datetime}
+    // Authorization:{signature}
+    // x-amz-content-sha256:e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855
+    http::client::request_header header{};
+    auto host = fmt::format("{}.{}", name(), _ap());
+    auto target = fmt::format("/{}?uploads", key().string());
+    std::string emptysig
+      = "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855";
+    header.method(boost::beast::http::verb::post);
+    header.target(target);
+    header.insert(
+      boost::beast::http::field::user_agent, aws_header_values::user_agent);
+    header.insert(boost::beast::http::field::host, host);
+    header.insert(
+      boost::beast::http::field::content_type, aws_header_values::text_plain);
+    header.insert(boost::beast::http::field::content_length, "0");
+    header.insert(aws_header_names::x_amz_content_sha256, emptysig);
+    add_tagging_header(header, tags);
+    auto ec = _sign.sign_header(header, emptysig);
+    if (ec) {
+        return ec;
+    }
+    return header;
+}
+
+result<http::client::request_header>
+request_creator::make_unsigned_upload_part_request(
+  bucket_name const& name,
+  object_key const& key,
+  const ss::sstring& upload_id,
+  int part_number,
+  size_t payload_size_bytes) {
+    // PUT /{object-id}?partNumber={n}&uploadId={upload-id} HTTP/1.1
+    // Host: {bucket-name}.s3.amazonaws.com
+    // Content-Length: {size}
+    // Authorization: authorization string
+    // [{size} bytes of part data]
+    http::client::request_header header{};
+    auto host = fmt::format("{}.{}", name(), _ap());
+    auto target = fmt::format(
+      "/{}?partNumber={}&uploadId={}", key().string(), part_number, upload_id);
+    std::string sig = "UNSIGNED-PAYLOAD";
+    header.method(boost::beast::http::verb::put);
+    header.target(target);
+    header.insert(
+      boost::beast::http::field::user_agent, aws_header_values::user_agent);
+    header.insert(boost::beast::http::field::host, host);
+    header.insert(
+      boost::beast::http::field::content_length,
+      std::to_string(payload_size_bytes));
+    header.insert(aws_header_names::x_amz_content_sha256, sig);
+    auto ec = _sign.sign_header(header, sig);
+    if (ec) {
+        return ec;
+    }
+    return header;
+}
+
+result<http::client::request_header>
+request_creator::make_unsigned_complete_multipart_upload_request(
+  bucket_name const& name,
+  object_key const& key,
+  const ss::sstring& upload_id,
+  size_t payload_size_bytes) {
+    // POST /{object-id}?uploadId={upload-id} HTTP/1.1
+    // Host: {bucket-name}.s3.amazonaws.com
+    // Content-Length: {size}
+    // Authorization: authorization string
+    // <CompleteMultipartUpload>...</CompleteMultipartUpload>
+    http::client::request_header header{};
+    auto host = fmt::format("{}.{}", name(), _ap());
+    auto target = fmt::format("/{}?uploadId={}", key().string(), upload_id);
+    std::string sig = "UNSIGNED-PAYLOAD";
+    header.method(boost::beast::http::verb::post);
+    header.target(target);
+    header.insert(
+      boost::beast::http::field::user_agent, aws_header_values::user_agent);
+    header.insert(boost::beast::http::field::host, host);
+    header.insert(
+      boost::beast::http::field::content_type,
+      aws_header_values::application_xml);
+    header.insert(
+      boost::beast::http::field::content_length,
+      std::to_string(payload_size_bytes));
+    header.insert(aws_header_names::x_amz_content_sha256, sig);
+    auto ec = _sign.sign_header(header, sig);
+    if (ec) {
+        return ec;
+    }
+    return header;
+}
+
+/// Header of a request without a body that only names the upload
+static http::client::request_header make_upload_id_request(
+  boost::beast::http::verb verb,
+  const access_point_uri& ap,
+  bucket_name const& name,
+  object_key const& key,
+  const ss::sstring& upload_id) {
+    http::client::request_header header{};
+    auto host = fmt::format("{}.{}", name(), ap());
+    auto target = fmt::format("/{}?uploadId={}", key().string(), upload_id);
+    header.method(verb);
+    header.target(target);
+    header.insert(
+      boost::beast::http::field::user_agent, aws_header_values::user_agent);
+    header.insert(boost::beast::http::field::host, host);
+    header.insert(boost::beast::http::field::content_length, "0");
+    return header;
+}
+
+result<http::client::request_header>
+request_creator::make_abort_multipart_upload_request(
+  bucket_name const& name,
+  object_key const& key,
+  const ss::sstring& upload_id) {
+    // DELETE /{object-id}?uploadId={upload-id} HTTP/1.1
+    std::string emptysig
+      = "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855";
+    auto header = make_upload_id_request(
+      boost::beast::http::verb::delete_, _ap, name, key, upload_id);
+    header.insert(aws_header_names::x_amz_content_sha256, emptysig);
+    auto ec = _sign.sign_header(header, emptysig);
+    if (ec) {
+        return ec;
+    }
+    return header;
+}
+
+result<http::client::request_header> request_creator::make_list_parts_request(
+  bucket_name const& name,
+  object_key const& key,
+  const ss::sstring& upload_id) {
+    // GET /{object-id}?uploadId={upload-id} HTTP/1.1
+    std::string emptysig
+      = "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855";
+    auto header = make_upload_id_request(
+      boost::beast::http::verb::get, _ap, name, key, upload_id);
+    header.insert(aws_header_names::x_amz_content_sha256, emptysig);
+    auto ec = _sign.sign_header(header, emptysig);
+    if (ec) {
+        return ec;
+    }
+    return header;
+}
+
 // client //
 
 /// Convert iobuf that contains xml data to boost::property_tree
@@ -362,8 +543,11 @@ client::client(const configuration& conf, const ss::abort_source& as)
 
 ss::future<> client::shutdown() { return _client.shutdown(); }
 ss::future<http::client::response_stream_ref>
-client::get_object(bucket_name const& name, object_key const& key) {
-    auto header = _requestor.make_get_object_request(name, key);
+client::get_object(
+  bucket_name const& name,
+  object_key const& key,
+  std::optional<byte_range> range) {
+    auto header = _requestor.make_get_object_request(name, key, range);
     if (!header) {
         return ss::make_exception_future<http::client::response_stream_ref>(
           std::system_error(header.error()));
@@ -376,8 +560,10 @@ client::get_object(bucket_name const& name, object_key const& key) {
           // the header first
           return ref->prefetch_headers().then([ref = std::move(ref)]() mutable {
               vassert(ref->is_header_done(), "Header is not received");
+              const auto status = ref->get_headers().result();
               if (
-                ref->get_headers().result() != boost::beast::http::status::ok) {
+                status != boost::beast::http::status::ok
+                && status != boost::beast::http::status::partial_content) {
                   // Got error response, consume the response body and produce
                   // rest api error
                   return drain_response_stream(std::move(ref))
@@ -392,22 +578,81 @@ client::get_object(bucket_name const& name, object_key const& key) {
       });
 }
 
+/// Payload of a streaming upload in aws-chunked encoding. A chunk is hashed
+/// while it is read from the body and sent as its signed header, its
+/// buffers and a line break, so the body is read once and not copied.
+class aws_chunked_source final : public ss::data_source_impl {
+public:
+    aws_chunked_source(
+      ss::input_stream<char>& body, chunk_signer signer, size_t chunk_size)
+      : _body(body)
+      , _signer(std::move(signer))
+      , _chunk_size(chunk_size) {}
+
+    ss::future<ss::temporary_buffer<char>> get() final {
+        if (!_pending.empty()) {
+            auto buf = std::move(_pending.front());
+            _pending.pop_front();
+            co_return buf;
+        }
+        if (_done) {
+            co_return ss::temporary_buffer<char>();
+        }
+        size_t chunk_bytes = 0;
+        while (chunk_bytes < _chunk_size) {
+            auto buf = co_await _body.read_up_to(_chunk_size - chunk_bytes);
+            if (buf.empty()) {
+                break;
+            }
+            _hash.update(std::string_view(buf.get(), buf.size()));
+            chunk_bytes += buf.size();
+            _pending.push_back(std::move(buf));
+        }
+        auto signature = _signer.sign_chunk(to_hex(_hash.reset()));
+        auto header = ssx::sformat(
+          "{:x};chunk-signature={}\r\n", chunk_bytes, signature);
+        // the empty chunk ends the payload
+        _done = chunk_bytes == 0;
+        _pending.emplace_back(crlf.data(), crlf.size());
+        co_return ss::temporary_buffer<char>(header.data(), header.size());
+    }
+
+private:
+    static constexpr std::string_view crlf = "\r\n";
+
+    ss::input_stream<char>& _body;
+    chunk_signer _signer;
+    size_t _chunk_size;
+    hash_sha256 _hash;
+    std::deque<ss::temporary_buffer<char>> _pending;
+    bool _done{false};
+};
+
 ss::future<> client::put_object(
   bucket_name const& name,
   object_key const& id,
   size_t payload_size,
   ss::input_stream<char>&& body,
   const std::vector<object_tag>& tags) {
-    auto header = _requestor.make_unsigned_put_object_request(
-      name, id, payload_size, tags);
-    if (!header) {
-        return ss::make_exception_future<>(std::system_error(header.error()));
+    auto request = _requestor.make_streaming_put_object_request(
+      name, id, payload_size, put_object_chunk_size, tags);
+    if (!request) {
+        return ss::make_exception_future<>(std::system_error(request.error()));
     }
-    vlog(s3_log.trace, "send https request:\n{}", header);
+    vlog(s3_log.trace, "send https request:\n{}", request.value().header);
     return ss::do_with(
       std::move(body),
-      [this, header = std::move(header)](ss::input_stream<char>& body) mutable {
-          return _client.request(std::move(header.value()), body)
+      [this, request = std::move(request.value())](
+        ss::input_stream<char>& body) mutable {
+          auto chunked = ss::input_stream<char>(
+            ss::data_source(std::make_unique<aws_chunked_source>(
+              body, std::move(request.signer), put_object_chunk_size)));
+          return ss::do_with(
+                   std::move(chunked),
+                   [this, header = std::move(request.header)](
+                     ss::input_stream<char>& chunked) mutable {
+                       return _client.request(std::move(header), chunked);
+                   })
             .then([](const http::client::response_stream_ref& ref) {
                 return drain_response_stream(ref).then([ref](iobuf&& res) {
                     auto status = ref->get_headers().result();
@@ -489,4 +734,155 @@ client::delete_object(const bucket_name& bucket, const object_key& key) {
       });
 }
 
+/// S3 reports some errors of multipart requests in the body of a 200
+/// response
+static bool is_error_document(const boost::property_tree::ptree& root) {
+    return root.get_child_optional("Error").has_value();
+}
+
+static std::vector<client::multipart_part>
+iobuf_to_list_parts_result(iobuf&& buf) {
+    std::vector<client::multipart_part> parts;
+    auto root = iobuf_to_ptree(std::move(buf));
+    for (const auto& [tag, value] : root.get_child("ListPartsResult")) {
+        if (tag != "Part") {
+            continue;
+        }
+        parts.push_back(client::multipart_part{
+          .part_number = value.get<int>("PartNumber"),
+          .etag = value.get<ss::sstring>("ETag"),
+          .size_bytes = value.get<size_t>("Size"),
+        });
+    }
+    return parts;
+}
+
+ss::future<ss::sstring> client::create_multipart_upload(
+  bucket_name const& name,
+  object_key const& key,
+  const std::vector<object_tag>& tags) {
+    auto header = _requestor.make_create_multipart_upload_request(
+      name, key, tags);
+    if (!header) {
+        throw std::system_error(header.error());
+    }
+    vlog(s3_log.trace, "send https request:\n{}", header);
+    auto ref = co_await _client.request(std::move(header.value()));
+    auto res = co_await drain_response_stream(ref);
+    if (ref->get_headers().result() != boost::beast::http::status::ok) {
+        co_return co_await parse_rest_error_response<ss::sstring>(
+          std::move(res));
+    }
+    auto root = iobuf_to_ptree(std::move(res));
+    co_return root.get<ss::sstring>("InitiateMultipartUploadResult.UploadId");
+}
+
+ss::future<ss::sstring> client::upload_part(
+  bucket_name const& name,
+  object_key const& key,
+  const ss::sstring& upload_id,
+  int part_number,
+  size_t payload_size,
+  ss::input_stream<char>&& body) {
+    auto header = _requestor.make_unsigned_upload_part_request(
+      name, key, upload_id, part_number, payload_size);
+    if (!header) {
+        co_await body.close();
+        throw std::system_error(header.error());
+    }
+    vlog(s3_log.trace, "send https request:\n{}", header);
+    std::exception_ptr ex;
+    ss::sstring etag;
+    try {
+        auto ref = co_await _client.request(std::move(header.value()), body);
+        auto res = co_await drain_response_stream(ref);
+        const auto& headers = ref->get_headers();
+        if (headers.result() != boost::beast::http::status::ok) {
+            co_await parse_rest_error_response<>(std::move(res));
+        }
+        auto tag = headers[boost::beast::http::field::etag];
+        etag = ss::sstring(tag.data(), tag.size());
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    co_await body.close();
+    if (ex) {
+        std::rethrow_exception(ex);
+    }
+    co_return etag;
+}
+
+ss::future<> client::complete_multipart_upload(
+  bucket_name const& name,
+  object_key const& key,
+  const ss::sstring& upload_id,
+  const std::vector<multipart_part>& parts) {
+    std::stringstream doc;
+    doc << "<CompleteMultipartUpload>";
+    for (const auto& p : parts) {
+        doc << fmt::format(
+          "<Part><PartNumber>{}</PartNumber><ETag>{}</ETag></Part>",
+          p.part_number,
+          p.etag);
+    }
+    doc << "</CompleteMultipartUpload>";
+    iobuf payload;
+    const auto str = doc.str();
+    payload.append(str.data(), str.size());
+    auto header = _requestor.make_unsigned_complete_multipart_upload_request(
+      name, key, upload_id, payload.size_bytes());
+    if (!header) {
+        throw std::system_error(header.error());
+    }
+    vlog(s3_log.trace, "send https request:\n{}", header);
+    auto body = make_iobuf_input_stream(std::move(payload));
+    auto ref = co_await _client.request(std::move(header.value()), body);
+    co_await body.close();
+    auto res = co_await drain_response_stream(ref);
+    if (ref->get_headers().result() != boost::beast::http::status::ok) {
+        co_await parse_rest_error_response<>(std::move(res));
+    }
+    if (is_error_document(iobuf_to_ptree(res.copy()))) {
+        co_await parse_rest_error_response<>(std::move(res));
+    }
+}
+
+ss::future<> client::abort_multipart_upload(
+  bucket_name const& name,
+  object_key const& key,
+  const ss::sstring& upload_id) {
+    auto header = _requestor.make_abort_multipart_upload_request(
+      name, key, upload_id);
+    if (!header) {
+        throw std::system_error(header.error());
+    }
+    vlog(s3_log.trace, "send https request:\n{}", header);
+    auto ref = co_await _client.request(std::move(header.value()));
+    auto res = co_await drain_response_stream(ref);
+    auto status = ref->get_headers().result();
+    if (
+      status != boost::beast::http::status::ok
+      && status != boost::beast::http::status::no_content) {
+        co_await parse_rest_error_response<>(std::move(res));
+    }
+}
+
+ss::future<std::vector<client::multipart_part>> client::list_parts(
+  bucket_name const& name,
+  object_key const& key,
+  const ss::sstring& upload_id) {
+    auto header = _requestor.make_list_parts_request(name, key, upload_id);
+    if (!header) {
+        throw std::system_error(header.error());
+    }
+    vlog(s3_log.trace, "send https request:\n{}", header);
+    auto ref = co_await _client.request(std::move(header.value()));
+    auto res = co_await drain_response_stream(ref);
+    if (ref->get_headers().result() != boost::beast::http::status::ok) {
+        co_return co_await parse_rest_error_response<
+          std::vector<multipart_part>>(std::move(res));
+    }
+    co_return iobuf_to_list_parts_result(std::move(res));
+}
+
 } // namespace s3
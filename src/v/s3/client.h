@@ -35,6 +35,13 @@ struct object_tag {
     ss::sstring value;
 };
 
+/// Range of the bytes of an object, the last byte is included. A range
+/// without the last byte ends with the object
+struct byte_range {
+    size_t first;
+    std::optional<size_t> last;
+};
+
 /// List of default overrides that can be used to workaround issues
 /// that can arise when we want to deal with different S3 API implementations
 /// and different OS issues (like different truststore locations on different
@@ -84,27 +91,40 @@ public:
     /// \param conf is a configuration container
     explicit request_creator(const configuration& conf);
 
-    /// \brief Create unsigned 'PutObject' request header
-    /// The payload is unsigned which means that we don't need to calculate
-    /// hash from it (which don't want to do for large files).
+    /// Streaming 'PutObject' request header and the signer of the chunks
+    /// of its payload
+    struct streaming_put_request {
+        http::client::request_header header;
+        chunk_signer signer;
+    };
+
+    /// \brief Create 'PutObject' request header with a streaming signed
+    /// payload
+    /// The payload is signed chunk by chunk as it is sent so that it is
+    /// only read once and hashed as it is read.
     ///
     /// \param name is a bucket that should be used to store new object
     /// \param key is an object name
     /// \param payload_size_bytes is a size of the object in bytes
+    /// \param chunk_size is a size of the signed chunks of the payload
     /// \return initialized and signed http header or error
-    result<http::client::request_header> make_unsigned_put_object_request(
+    result<streaming_put_request> make_streaming_put_object_request(
       bucket_name const& name,
       object_key const& key,
       size_t payload_size_bytes,
+      size_t chunk_size,
       const std::vector<object_tag>& tags);
 
     /// \brief Create a 'GetObject' request header
     ///
     /// \param name is a bucket that has the object
     /// \param key is an object name
+    /// \param range is a range of the object to get, all of it by default
     /// \return initialized and signed http header or error
-    result<http::client::request_header>
-    make_get_object_request(bucket_name const& name, object_key const& key);
+    result<http::client::request_header> make_get_object_request(
+      bucket_name const& name,
+      object_key const& key,
+      std::optional<byte_range> range = std::nullopt);
 
     /// \brief Create a 'DeleteObject' request header
     ///
@@ -127,6 +147,50 @@ public:
       std::optional<object_key> start_after,
       std::optional<size_t> max_keys);
 
+    /// \brief Create a 'CreateMultipartUpload' request header
+    ///
+    /// \param name is a bucket that should be used to store new object
+    /// \param key is an object name
+    /// \return initialized and signed http header or error
+    result<http::client::request_header> make_create_multipart_upload_request(
+      bucket_name const& name,
+      object_key const& key,
+      const std::vector<object_tag>& tags);
+
+    /// \brief Create unsigned 'UploadPart' request header
+    ///
+    /// \param upload_id is the id returned by 'CreateMultipartUpload'
+    /// \param part_number is a number of the part, starting from 1
+    /// \param payload_size_bytes is a size of the part in bytes
+    /// \return initialized and signed http header or error
+    result<http::client::request_header> make_unsigned_upload_part_request(
+      bucket_name const& name,
+      object_key const& key,
+      const ss::sstring& upload_id,
+      int part_number,
+      size_t payload_size_bytes);
+
+    /// \brief Create unsigned 'CompleteMultipartUpload' request header, the
+    /// body lists the uploaded parts
+    result<http::client::request_header>
+    make_unsigned_complete_multipart_upload_request(
+      bucket_name const& name,
+      object_key const& key,
+      const ss::sstring& upload_id,
+      size_t payload_size_bytes);
+
+    /// \brief Create an 'AbortMultipartUpload' request header
+    result<http::client::request_header> make_abort_multipart_upload_request(
+      bucket_name const& name,
+      object_key const& key,
+      const ss::sstring& upload_id);
+
+    /// \brief Create a 'ListParts' request header
+    result<http::client::request_header> make_list_parts_request(
+      bucket_name const& name,
+      object_key const& key,
+      const ss::sstring& upload_id);
+
 private:
     access_point_uri _ap;
     signature_v4 _sign;
@@ -141,15 +205,28 @@ public:
     /// Stop the client
     ss::future<> shutdown();
 
+    /// Close the connection, the request in flight fails
+    void abort_connection() noexcept { _client.abort_connection(); }
+
+    /// True if the next request can reuse the connection
+    bool is_reusable() const { return _client.is_reusable(); }
+
     /// Download object from S3 bucket
     ///
     /// \param name is a bucket name
     /// \param key is an object key
+    /// \param range is a range of the object to download, all of it by
+    ///        default
     /// \return future that gets ready after request was sent
-    ss::future<http::client::response_stream_ref>
-    get_object(bucket_name const& name, object_key const& key);
+    ss::future<http::client::response_stream_ref> get_object(
+      bucket_name const& name,
+      object_key const& key,
+      std::optional<byte_range> range = std::nullopt);
+
+    /// Size of the signed chunks of the put object payload
+    static constexpr size_t put_object_chunk_size = 64_KiB;
 
-    /// Put object to S3 bucket.
+    /// Put object to S3 bucket, the payload is signed as it is sent.
     /// \param name is a bucket name
     /// \param key is an id of the object
     /// \param payload_size is a size of the object in bytes
@@ -181,6 +258,52 @@ public:
     ss::future<>
     delete_object(const bucket_name& bucket, const object_key& key);
 
+    /// Part of a multipart upload
+    struct multipart_part {
+        /// starts from 1
+        int part_number;
+        ss::sstring etag;
+        size_t size_bytes;
+    };
+
+    /// Start a multipart upload
+    /// \return future that returns the upload id
+    ss::future<ss::sstring> create_multipart_upload(
+      bucket_name const& name,
+      object_key const& key,
+      const std::vector<object_tag>& tags = {});
+
+    /// Upload a part of a multipart upload, a part with the same number
+    /// is replaced.
+    /// \return future that returns the etag of the part
+    ss::future<ss::sstring> upload_part(
+      bucket_name const& name,
+      object_key const& key,
+      const ss::sstring& upload_id,
+      int part_number,
+      size_t payload_size,
+      ss::input_stream<char>&& body);
+
+    /// Assemble the object from the parts, which must be ordered by part
+    /// number
+    ss::future<> complete_multipart_upload(
+      bucket_name const& name,
+      object_key const& key,
+      const ss::sstring& upload_id,
+      const std::vector<multipart_part>& parts);
+
+    /// Drop the upload and its parts
+    ss::future<> abort_multipart_upload(
+      bucket_name const& name,
+      object_key const& key,
+      const ss::sstring& upload_id);
+
+    /// List the parts uploaded so far, used to resume an upload
+    ss::future<std::vector<multipart_part>> list_parts(
+      bucket_name const& name,
+      object_key const& key,
+      const ss::sstring& upload_id);
+
 private:
     request_creator _requestor;
     http::client _client;
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#include "s3/client_pool.h"
+
+#include "prometheus/prometheus_sanitize.h"
+#include "s3/logger.h"
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/loop.hh>
+#include <seastar/core/metrics.hh>
+
+namespace s3 {
+
+client_pool::client_pool(
+  configuration conf,
+  size_t max_connections,
+  clock_type::duration max_idle_time)
+  : _conf(std::move(conf))
+  , _max_connections(std::max<size_t>(max_connections, 1))
+  , _max_idle_time(max_idle_time)
+  , _limit(_max_connections)
+  , _evict_timer([this] { evict_idle(); }) {}
+
+ss::future<> client_pool::stop() {
+    _evict_timer.cancel();
+    _as.request_abort();
+    auto idle = std::exchange(_idle, {});
+    co_await ss::parallel_for_each(
+      idle, [](idle_client& i) { return i.client->shutdown(); });
+    co_await _gate.close();
+}
+
+ss::future<client_pool::client_ptr> client_pool::acquire() {
+    while (!_idle.empty()) {
+        auto c = std::move(_idle.back().client);
+        _idle.pop_back();
+        if (c->is_reusable()) {
+            ++_reused;
+            co_return c;
+        }
+        // closed by the server while idle
+        ++_evicted;
+        co_await c->shutdown();
+    }
+    ++_created;
+    co_return ss::make_lw_shared<client>(_conf, _as);
+}
+
+ss::future<> client_pool::release(client_ptr c, bool succeeded) {
+    if (succeeded && c->is_reusable() && !_as.abort_requested()) {
+        _idle.push_back({.client = std::move(c), .since = clock_type::now()});
+        if (!_evict_timer.armed()) {
+            _evict_timer.arm(_max_idle_time);
+        }
+        return ss::now();
+    }
+    if (!succeeded) {
+        ++_failed;
+    }
+    return c->shutdown();
+}
+
+void client_pool::evict_idle() {
+    if (_gate.is_closed()) {
+        return;
+    }
+    auto now = clock_type::now();
+    while (!_idle.empty() && now - _idle.front().since >= _max_idle_time) {
+        auto c = std::move(_idle.front().client);
+        _idle.pop_front();
+        ++_evicted;
+        vlog(s3_log.trace, "Closing idle connection");
+        (void)ss::with_gate(_gate, [c] { return c->shutdown(); });
+    }
+    if (!_idle.empty()) {
+        _evict_timer.arm(_idle.front().since + _max_idle_time);
+    }
+}
+
+void client_pool::setup_metrics() {
+    if (_conf.disable_metrics) {
+        return;
+    }
+    namespace sm = ss::metrics;
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("s3:client_pool"),
+      {
+        sm::make_derive(
+          "connections_created",
+          [this] { return _created; },
+          sm::description("Number of clients created for new connections")),
+        sm::make_derive(
+          "connections_reused",
+          [this] { return _reused; },
+          sm::description("Number of calls that reused an open connection")),
+        sm::make_derive(
+          "connections_evicted",
+          [this] { return _evicted; },
+          sm::description(
+            "Number of idle connections closed by the pool or the server")),
+        sm::make_derive(
+          "failed_calls",
+          [this] { return _failed; },
+          sm::description(
+            "Number of calls that failed and closed their connection")),
+        sm::make_gauge(
+          "idle_connections",
+          [this] { return _idle.size(); },
+          sm::description("Number of open connections waiting for a call")),
+        sm::make_gauge(
+          "active_connections",
+          [this] { return _max_connections - _limit.available_units(); },
+          sm::description("Number of connections used by calls")),
+      });
+}
+
+} // namespace s3
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#pragma once
+
+#include "s3/client.h"
+#include "seastarx.h"
+
+#include <seastar/core/abort_source.hh>
+#include <seastar/core/future.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/core/semaphore.hh>
+#include <seastar/core/shared_ptr.hh>
+#include <seastar/core/timer.hh>
+
+#include <chrono>
+#include <deque>
+
+namespace s3 {
+
+/// Shard-local pool of persistent connections to the S3 endpoint.
+///
+/// A client goes back to the pool after a successful call if the connection
+/// is still open and the server didn't ask to close it, so the next call
+/// skips the TCP and TLS handshakes. Clients of failed calls are shut down.
+/// Connections idle for longer than max_idle_time are closed before the
+/// server drops them. At most max_connections are open at a time, callers
+/// wait for a free one.
+class client_pool {
+public:
+    using clock_type = ss::lowres_clock;
+    static constexpr clock_type::duration default_max_idle_time
+      = std::chrono::seconds(5);
+
+    client_pool(
+      configuration conf,
+      size_t max_connections,
+      clock_type::duration max_idle_time = default_max_idle_time);
+
+    client_pool(const client_pool&) = delete;
+    client_pool& operator=(const client_pool&) = delete;
+    client_pool(client_pool&&) = delete;
+    client_pool& operator=(client_pool&&) = delete;
+    ~client_pool() = default;
+
+    /// Close all connections, calls in flight are aborted
+    ss::future<> stop();
+
+    /// \brief Run \p f with a client of the pool
+    ///
+    /// The responses have to be consumed when the future returned by \p f
+    /// becomes ready, the connection is reused by the next call.
+    /// \param as aborts the call, the connection is closed
+    template<typename Func>
+    auto with_client(ss::abort_source& as, Func f);
+
+    size_t max_connections() const { return _max_connections; }
+    size_t idle_connections() const { return _idle.size(); }
+
+    /// Register the connection metrics of the pool
+    void setup_metrics();
+
+private:
+    using client_ptr = ss::lw_shared_ptr<client>;
+
+    struct idle_client {
+        client_ptr client;
+        clock_type::time_point since;
+    };
+
+    /// Take the most recently used open connection or create a client
+    ss::future<client_ptr> acquire();
+    ss::future<> release(client_ptr c, bool succeeded);
+    void evict_idle();
+
+    configuration _conf;
+    size_t _max_connections;
+    clock_type::duration _max_idle_time;
+    ss::semaphore _limit;
+    /// Every client of the pool is bound to it
+    ss::abort_source _as;
+    /// Ordered by the time of the last use
+    std::deque<idle_client> _idle;
+    ss::timer<clock_type> _evict_timer;
+    ss::gate _gate;
+    uint64_t _created{0};
+    uint64_t _reused{0};
+    uint64_t _evicted{0};
+    uint64_t _failed{0};
+    ss::metrics::metric_groups _metrics;
+};
+
+template<typename Func>
+auto client_pool::with_client(ss::abort_source& as, Func f) {
+    return ss::with_gate(_gate, [this, &as, f = std::move(f)]() mutable {
+        return ss::get_units(_limit, 1).then(
+          [this, &as, f = std::move(f)](ss::semaphore_units<> units) mutable {
+              // the call can refer to the captures of f until it's done
+              return ss::do_with(
+                std::move(f),
+                std::move(units),
+                [this, &as](Func& f, ss::semaphore_units<>&) {
+                    return acquire().then([this, &as, &f](client_ptr c) {
+                        // closing the connection fails the request in flight
+                        auto sub = as.subscribe(
+                          [c]() noexcept { c->abort_connection(); });
+                        return ss::futurize_invoke([&as, &f, c] {
+                                   // subscribe() doesn't call back if aborted
+                                   as.check();
+                                   return f(*c);
+                               })
+                          .then_wrapped(
+                            [this, c, sub = std::move(sub)](auto fut) mutable {
+                                return release(c, !fut.failed())
+                                  .then([fut = std::move(fut)]() mutable {
+                                      return std::move(fut);
+                                  });
+                            });
+                    });
+                });
+          });
+    });
+}
+
+} // namespace s3
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#include "s3/multipart_upload.h"
+
+#include "s3/logger.h"
+#include "vassert.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/loop.hh>
+#include <seastar/core/sleep.hh>
+
+#include <boost/range/irange.hpp>
+
+#include <algorithm>
+
+namespace s3 {
+
+multipart_upload::multipart_upload(
+  client_pool& pool,
+  ss::abort_source& as,
+  bucket_name bucket,
+  object_key key,
+  size_t content_length,
+  options opts,
+  std::optional<ss::sstring> upload_id)
+  : _pool(pool)
+  , _as(as)
+  , _bucket(std::move(bucket))
+  , _key(std::move(key))
+  , _content_length(content_length)
+  , _opts(opts)
+  , _upload_id(std::move(upload_id)) {
+    vassert(_opts.part_size > 0, "multipart upload of {} without parts", _key);
+    const size_t count = std::max<size_t>(
+      1, (_content_length + _opts.part_size - 1) / _opts.part_size);
+    _parts.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        _parts.push_back(client::multipart_part{
+          .part_number = static_cast<int>(i + 1),
+          .etag = {},
+          .size_bytes = part_size(i),
+        });
+    }
+}
+
+size_t multipart_upload::part_size(size_t index) const {
+    const size_t offset = index * _opts.part_size;
+    return std::min(_opts.part_size, _content_length - offset);
+}
+
+size_t multipart_upload::uploaded_parts() const {
+    return std::count_if(_parts.begin(), _parts.end(), [](const auto& p) {
+        return !p.etag.empty();
+    });
+}
+
+ss::future<>
+multipart_upload::create_or_resume(const std::vector<object_tag>& tags) {
+    if (!_upload_id) {
+        _upload_id = co_await _pool.with_client(_as, [this, &tags](client& c) {
+            return c.create_multipart_upload(_bucket, _key, tags);
+        });
+        vlog(
+          s3_log.debug, "Created multipart upload {} of {}", *_upload_id, _key);
+        co_return;
+    }
+    auto uploaded = co_await _pool.with_client(_as, [this](client& c) {
+        return c.list_parts(_bucket, _key, *_upload_id);
+    });
+    // a part of the wrong size was made for another layout, upload it again
+    for (auto& p : uploaded) {
+        const auto index = static_cast<size_t>(p.part_number - 1);
+        if (
+          p.part_number > 0 && index < _parts.size()
+          && p.size_bytes == _parts[index].size_bytes) {
+            _parts[index].etag = std::move(p.etag);
+        }
+    }
+    vlog(
+      s3_log.debug,
+      "Resuming multipart upload {} of {}, {}/{} parts uploaded",
+      *_upload_id,
+      _key,
+      uploaded_parts(),
+      _parts.size());
+}
+
+ss::future<>
+multipart_upload::upload_part(size_t index, stream_factory& make_stream) {
+    auto& part = _parts[index];
+    auto backoff = _opts.backoff;
+    for (int attempt = 1;; ++attempt) {
+        try {
+            part.etag = co_await _pool.with_client(
+              _as, [this, index, &part, &make_stream](client& c) {
+                  return c.upload_part(
+                    _bucket,
+                    _key,
+                    *_upload_id,
+                    part.part_number,
+                    part.size_bytes,
+                    make_stream(index * _opts.part_size, part.size_bytes));
+              });
+            co_return;
+        } catch (const ss::abort_requested_exception&) {
+            throw;
+        } catch (...) {
+            if (attempt >= _opts.part_attempts) {
+                throw;
+            }
+            vlog(
+              s3_log.warn,
+              "Uploading part {} of {} failed, attempt {}/{}: {}",
+              part.part_number,
+              _key,
+              attempt,
+              _opts.part_attempts,
+              std::current_exception());
+        }
+        co_await ss::sleep_abortable(backoff, _as);
+        backoff *= 2;
+    }
+}
+
+ss::future<> multipart_upload::upload(
+  stream_factory make_stream, const std::vector<object_tag>& tags) {
+    co_await create_or_resume(tags);
+    // every part waits for a connection, so at most as many parts as there
+    // are connections are read and sent at a time
+    co_await ss::parallel_for_each(
+      boost::irange<size_t>(0, _parts.size()),
+      [this, &make_stream](size_t index) {
+          if (!_parts[index].etag.empty()) {
+              return ss::now();
+          }
+          return upload_part(index, make_stream);
+      });
+    co_await _pool.with_client(_as, [this](client& c) {
+        return c.complete_multipart_upload(_bucket, _key, *_upload_id, _parts);
+    });
+    vlog(
+      s3_log.debug,
+      "Completed multipart upload {} of {}, {} parts",
+      *_upload_id,
+      _key,
+      _parts.size());
+}
+
+ss::future<> multipart_upload::abort() {
+    if (!_upload_id) {
+        co_return;
+    }
+    co_await _pool.with_client(_as, [this](client& c) {
+        return c.abort_multipart_upload(_bucket, _key, *_upload_id);
+    });
+    _upload_id = std::nullopt;
+    for (auto& p : _parts) {
+        p.etag = {};
+    }
+}
+
+} // namespace s3
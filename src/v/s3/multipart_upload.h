@@ -0,0 +1,89 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#pragma once
+
+#include "s3/client.h"
+#include "s3/client_pool.h"
+#include "seastarx.h"
+
+#include <seastar/core/abort_source.hh>
+#include <seastar/core/iostream.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/util/noncopyable_function.hh>
+
+#include <chrono>
+#include <optional>
+#include <vector>
+
+namespace s3 {
+
+/// Uploads an object in parts, in parallel over the connections of a pool.
+///
+/// A single PutObject is bound by the throughput of one connection and a
+/// failure restarts it from zero. Here every part is retried on its own and
+/// the upload id outlives a failed upload: uploading again with the same
+/// instance, or with a new one created from upload_id(), only sends the
+/// parts S3 does not have yet.
+class multipart_upload {
+public:
+    /// Returns the stream of the object bytes [offset, offset + length)
+    using stream_factory = ss::noncopyable_function<ss::input_stream<char>(
+      size_t offset, size_t length)>;
+
+    struct options {
+        /// All parts but the last have this size, S3 requires at least 5MiB
+        size_t part_size;
+        /// Attempts per part before the upload fails
+        int part_attempts{4};
+        /// Initial backoff between attempts, doubled by every attempt
+        ss::lowres_clock::duration backoff{std::chrono::milliseconds(100)};
+    };
+
+    /// \param pool bounds the parts in flight, every part takes a connection
+    /// \param upload_id of an upload to resume
+    multipart_upload(
+      client_pool& pool,
+      ss::abort_source& as,
+      bucket_name bucket,
+      object_key key,
+      size_t content_length,
+      options opts,
+      std::optional<ss::sstring> upload_id = std::nullopt);
+
+    /// Upload the parts that are missing and complete the upload
+    ss::future<>
+    upload(stream_factory make_stream, const std::vector<object_tag>& tags);
+
+    /// Drop the upload and the parts uploaded so far
+    ss::future<> abort();
+
+    /// Set once the upload was created
+    const std::optional<ss::sstring>& upload_id() const { return _upload_id; }
+
+    size_t parts_count() const { return _parts.size(); }
+    size_t uploaded_parts() const;
+
+private:
+    size_t part_size(size_t index) const;
+    ss::future<> create_or_resume(const std::vector<object_tag>& tags);
+    ss::future<> upload_part(size_t index, stream_factory& make_stream);
+
+    client_pool& _pool;
+    ss::abort_source& _as;
+    bucket_name _bucket;
+    object_key _key;
+    size_t _content_length;
+    options _opts;
+    std::optional<ss::sstring> _upload_id;
+    std::vector<client::multipart_part> _parts;
+};
+
+} // namespace s3
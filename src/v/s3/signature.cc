@@ -326,9 +326,11 @@ ss::sstring signature_v4::sha256_hexdigest(std::string_view payload) {
     return sha_256(payload);
 }
 
-std::error_code signature_v4::sign_header(
-  http::client::request_header& header, const ss::sstring& sha256) const {
-    auto amz_date = _sig_time.format_datetime();
+result<ss::sstring> signature_v4::sign(
+  http::client::request_header& header,
+  std::string_view sha256,
+  const ss::sstring& amz_date) {
+    refresh_sign_key(amz_date.substr(0, amz_date.find('T')));
     header.set("x-amz-date", {amz_date.data(), amz_date.size()});
     header.set("x-amz-content-sha256", {sha256.data(), sha256.size()});
     auto canonical_headers = get_canonical_headers(header);
@@ -336,38 +338,56 @@ std::error_code signature_v4::sign_header(
         return canonical_headers.error();
     }
     auto canonical_req = create_canonical_request(
-      canonical_headers.value(), header, sha256);
+      canonical_headers.value(), header, ss::sstring(sha256));
     if (!canonical_req) {
         return canonical_req.error();
     }
     vlog(s3_log.trace, "\n[canonical-request]\n{}\n", canonical_req.value());
     auto str_to_sign = get_string_to_sign(
       amz_date, _cred_scope, canonical_req.value());
-    auto digest = hmac(_sign_key, str_to_sign);
+    auto signature = hexdigest(hmac(_sign_key, str_to_sign));
     auto auth_header = fmt::format(
       "{} Credential={}/{},SignedHeaders={},Signature={}",
       algorithm,
       _access_key(),
       _cred_scope,
       canonical_headers.value().signed_headers,
-      hexdigest(digest));
+      signature);
     header.set(boost::beast::http::field::authorization, auth_header);
     vlog(s3_log.trace, "\n[signed-header]\n\n{}", header);
+    return signature;
+}
+
+std::error_code signature_v4::sign_header(
+  http::client::request_header& header, const ss::sstring& sha256) {
+    auto signature = sign(header, sha256, _sig_time.format_datetime());
+    if (!signature) {
+        return signature.error();
+    }
     return {};
 }
 
-signature_v4::signature_v4(
-  aws_region_name region,
-  public_key_str access_key,
-  private_key_str private_key,
-  time_source&& ts)
-  : _sig_time(std::move(ts))
-  , _region(std::move(region))
-  , _access_key(std::move(access_key))
-  , _private_key(std::move(private_key)) {
-    ss::sstring date_str = _sig_time.format_date();
+result<chunk_signer>
+signature_v4::sign_streaming_header(http::client::request_header& header) {
+    auto amz_date = _sig_time.format_datetime();
+    auto signature = sign(header, streaming_payload, amz_date);
+    if (!signature) {
+        return signature.error();
+    }
+    return chunk_signer(
+      _sign_key,
+      _cred_scope,
+      std::move(amz_date),
+      std::move(signature.value()));
+}
+
+void signature_v4::refresh_sign_key(const ss::sstring& date_str) {
+    if (date_str == _sign_date) {
+        return;
+    }
     ss::sstring service = "s3";
     _sign_key = gen_sig_key(_private_key(), date_str, _region(), service);
+    _sign_date = date_str;
     _cred_scope = ssx::sformat(
       "{}/{}/{}/aws4_request", date_str, _region(), service);
     vlog(
@@ -376,4 +396,63 @@ signature_v4::signature_v4(
       hexdigest(_sign_key),
       _cred_scope);
 }
+
+signature_v4::signature_v4(
+  aws_region_name region,
+  public_key_str access_key,
+  private_key_str private_key,
+  time_source&& ts)
+  : _sig_time(std::move(ts))
+  , _region(std::move(region))
+  , _access_key(std::move(access_key))
+  , _private_key(std::move(private_key)) {
+    refresh_sign_key(_sig_time.format_date());
+}
+
+// chunk_signer //
+
+constexpr std::string_view chunk_algorithm = "AWS4-HMAC-SHA256-PAYLOAD";
+
+chunk_signer::chunk_signer(
+  ss::sstring sign_key,
+  ss::sstring cred_scope,
+  ss::sstring amz_date,
+  ss::sstring seed_signature)
+  : _sign_key(std::move(sign_key))
+  , _cred_scope(std::move(cred_scope))
+  , _amz_date(std::move(amz_date))
+  , _prev_signature(std::move(seed_signature)) {}
+
+ss::sstring chunk_signer::sign_chunk(std::string_view sha256) {
+    // the chunks carry no headers, their hash is the hash of the empty string
+    static constexpr std::string_view empty_hash
+      = "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855";
+    auto str_to_sign = ssx::sformat(
+      "{}\n{}\n{}\n{}\n{}\n{}",
+      chunk_algorithm,
+      _amz_date,
+      _cred_scope,
+      _prev_signature,
+      empty_hash,
+      sha256);
+    _prev_signature = hexdigest(hmac(_sign_key, str_to_sign));
+    return _prev_signature;
+}
+
+size_t aws_chunked_length(size_t payload_size, size_t chunk_size) {
+    // <hex size>;chunk-signature=<signature>\r\n<payload>\r\n
+    constexpr std::string_view signature_prefix = ";chunk-signature=";
+    constexpr size_t chunk_overhead = signature_prefix.size()
+                                      + 2 * sha256_digest_length + 4;
+    auto with_header = [](size_t size) {
+        return fmt::format("{:x}", size).size() + chunk_overhead + size;
+    };
+    const size_t full_chunks = payload_size / chunk_size;
+    size_t length = full_chunks * with_header(chunk_size);
+    if (auto rest = payload_size % chunk_size; rest > 0) {
+        length += with_header(rest);
+    }
+    // the payload ends with an empty chunk
+    return length + with_header(0);
+}
 } // namespace s3
@@ -69,6 +69,30 @@ private:
     ss::noncopyable_function<timestamp()> _gettime_fn;
 };
 
+/// Signatures of the chunks of a streaming upload, each chunk signature is
+/// chained to the signature of the previous chunk and the first one to the
+/// seed signature of the request header
+class chunk_signer {
+public:
+    chunk_signer(
+      ss::sstring sign_key,
+      ss::sstring cred_scope,
+      ss::sstring amz_date,
+      ss::sstring seed_signature);
+
+    /// \brief Sign the next chunk
+    ///
+    /// \param sha256 is a hash of the chunk payload in hex format
+    /// \return signature of the chunk in hex format
+    ss::sstring sign_chunk(std::string_view sha256);
+
+private:
+    ss::sstring _sign_key;
+    ss::sstring _cred_scope;
+    ss::sstring _amz_date;
+    ss::sstring _prev_signature;
+};
+
 /// AWS Signature V4 generator
 class signature_v4 {
 public:
@@ -92,7 +116,20 @@ public:
     /// \param sha256 is a hash of the payload if payload is signed or defult
     /// value otherwise
     std::error_code sign_header(
-      http::client::request_header& header, const ss::sstring& sha256) const;
+      http::client::request_header& header, const ss::sstring& sha256);
+
+    /// Value of x-amz-content-sha256 of a streaming upload
+    static constexpr std::string_view streaming_payload
+      = "STREAMING-AWS4-HMAC-SHA256-PAYLOAD";
+
+    /// \brief Sign http header of a streaming upload
+    /// The payload is sent in aws-chunked encoding (see aws_chunked_length),
+    /// every chunk signed by the returned signer as it is read.
+    ///
+    /// \param header is an in/out parameter that contains request headers
+    /// \return signer of the payload chunks or error
+    result<chunk_signer>
+    sign_streaming_header(http::client::request_header& header);
 
     static ss::sstring gen_sig_key(
       std::string_view key,
@@ -101,6 +138,15 @@ public:
       std::string_view service);
 
 private:
+    /// \brief Sign the header, return the signature in hex format
+    result<ss::sstring> sign(
+      http::client::request_header& header,
+      std::string_view sha256,
+      const ss::sstring& amz_date);
+
+    /// Derive the signing key of the date unless it is the cached one
+    void refresh_sign_key(const ss::sstring& date_str);
+
     /// \brief Calculate SHA256 digest
     ///
     /// \param payload is ref to payload of the query
@@ -116,12 +162,19 @@ private:
     public_key_str _access_key;
     /// Secret key
     private_key_str _private_key;
-    /// Service specific signing key
+    /// Service specific signing key, valid for the day of its date
     ss::sstring _sign_key;
+    ss::sstring _sign_date;
     /// Scope of the key (part of the header digest)
     ss::sstring _cred_scope;
 };
 
+/// \brief Size of a payload in aws-chunked encoding
+///
+/// \param payload_size is a size of the payload in bytes
+/// \param chunk_size is a size of the chunks the payload is split into
+size_t aws_chunked_length(size_t payload_size, size_t chunk_size);
+
 template<class Fn>
 time_source::time_source(Fn&& fn, int)
   : _gettime_fn(std::forward<Fn>(fn)) {}
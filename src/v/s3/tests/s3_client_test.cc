@@ -12,7 +12,9 @@
 #include "bytes/iobuf_parser.h"
 #include "rpc/transport.h"
 #include "s3/client.h"
+#include "s3/client_pool.h"
 #include "s3/error.h"
+#include "s3/multipart_upload.h"
 #include "s3/signature.h"
 #include "seastarx.h"
 
@@ -37,6 +39,7 @@
 
 #include <chrono>
 #include <exception>
+#include <map>
 
 static const uint16_t httpd_port_number = 4434;
 static constexpr const char* httpd_host_name = "127.0.0.1";
@@ -79,12 +82,44 @@ static constexpr const char* list_objects_payload = R"xml(
   </CommonPrefixes>
 </ListBucketResult>)xml";
 
+static std::map<int, ss::sstring> multipart_parts;
+static int multipart_failures = 0;
+
+/// Payload of an aws-chunked body, the chunk signatures are checked by the
+/// signature tests
+static ss::sstring decode_aws_chunked(const ss::sstring& body) {
+    ss::sstring payload;
+    size_t pos = 0;
+    while (pos < body.size()) {
+        auto header_end = body.find("\r\n", pos);
+        BOOST_REQUIRE(header_end != ss::sstring::npos);
+        auto header = body.substr(pos, header_end - pos);
+        BOOST_REQUIRE(header.find(";chunk-signature=") != ss::sstring::npos);
+        auto size = std::stoul(
+          std::string(header.substr(0, header.find(';'))), nullptr, 16);
+        payload += body.substr(header_end + 2, size);
+        pos = header_end + 2 + size;
+        BOOST_REQUIRE_EQUAL(body.substr(pos, 2), "\r\n");
+        pos += 2;
+        if (size == 0) {
+            break;
+        }
+    }
+    BOOST_REQUIRE_EQUAL(pos, body.size());
+    return payload;
+}
+
 void set_routes(ss::httpd::routes& r) {
     using namespace ss::httpd;
     auto empty_put_response = new function_handler(
       [](const_req req) {
-          BOOST_REQUIRE(!req.get_header("x-amz-content-sha256").empty());
-          BOOST_REQUIRE(req.content == expected_payload);
+          BOOST_REQUIRE_EQUAL(
+            req.get_header("x-amz-content-sha256"),
+            ss::sstring(s3::signature_v4::streaming_payload));
+          BOOST_REQUIRE_EQUAL(
+            req.get_header("x-amz-decoded-content-length"),
+            ss::to_sstring(expected_payload_size));
+          BOOST_REQUIRE(decode_aws_chunked(req.content) == expected_payload);
           return "";
       },
       "txt");
@@ -100,6 +135,13 @@ void set_routes(ss::httpd::routes& r) {
           return ss::sstring(expected_payload, expected_payload_size);
       },
       "txt");
+    // serves the bytes=10-19 range of the payload
+    auto range_get_response = new function_handler(
+      [](const_req req) {
+          BOOST_REQUIRE_EQUAL(req.get_header("Range"), "bytes=10-19");
+          return ss::sstring(expected_payload + 10, 10);
+      },
+      "txt");
     auto erroneous_get_response = new function_handler(
       []([[maybe_unused]] const_req req, reply& reply) {
           reply.set_status(reply::status_type::internal_server_error);
@@ -134,9 +176,55 @@ void set_routes(ss::httpd::routes& r) {
           return "";
       },
       "txt");
+    // multipart upload of expected_payload, parts are kept by number
+    auto multipart_post_response = new function_handler(
+      [](const_req req) -> ss::sstring {
+          if (req.query_parameters.contains("uploads")) {
+              return R"xml(<InitiateMultipartUploadResult>
+  <Bucket>test-bucket</Bucket>
+  <Key>test-multipart</Key>
+  <UploadId>test-upload-id</UploadId>
+</InitiateMultipartUploadResult>)xml";
+          }
+          BOOST_REQUIRE_EQUAL(
+            req.get_query_param("uploadId"), "test-upload-id");
+          ss::sstring assembled;
+          for (int i = 1; multipart_parts.contains(i); ++i) {
+              BOOST_REQUIRE(req.content.find(fmt::format(
+                              "<PartNumber>{}</PartNumber><ETag>\"etag-{}\"",
+                              i,
+                              i))
+                            != ss::sstring::npos);
+              assembled += multipart_parts[i];
+          }
+          if (assembled != expected_payload) {
+              return error_payload;
+          }
+          return "<CompleteMultipartUploadResult/>";
+      },
+      "txt");
+    auto multipart_put_response = new function_handler(
+      [](const_req req, reply& reply) {
+          BOOST_REQUIRE_EQUAL(
+            req.get_query_param("uploadId"), "test-upload-id");
+          auto n = std::stoi(req.get_query_param("partNumber"));
+          if (multipart_failures > 0) {
+              --multipart_failures;
+              reply.set_status(reply::status_type::internal_server_error);
+              return error_payload;
+          }
+          multipart_parts[n] = req.content;
+          reply.add_header("ETag", fmt::format("\"etag-{}\"", n));
+          return "";
+      },
+      "txt");
+    r.add(
+      operation_type::POST, url("/test-multipart"), multipart_post_response);
+    r.add(operation_type::PUT, url("/test-multipart"), multipart_put_response);
     r.add(operation_type::PUT, url("/test"), empty_put_response);
     r.add(operation_type::PUT, url("/test-error"), erroneous_put_response);
     r.add(operation_type::GET, url("/test"), get_response);
+    r.add(operation_type::GET, url("/test-range"), range_get_response);
     r.add(operation_type::GET, url("/test-error"), erroneous_get_response);
     r.add(operation_type::DELETE, url("/test"), empty_delete_response);
     r.add(
@@ -246,6 +334,28 @@ SEASTAR_TEST_CASE(test_get_object_success) {
     });
 }
 
+SEASTAR_TEST_CASE(test_get_object_range) {
+    return ss::async([] {
+        auto conf = transport_configuration();
+        auto [server, client] = started_client_and_server(conf);
+        iobuf payload;
+        auto payload_stream = make_iobuf_ref_output_stream(payload);
+        auto http_response = client
+                               ->get_object(
+                                 s3::bucket_name("test-bucket"),
+                                 s3::object_key("test-range"),
+                                 s3::byte_range{.first = 10, .last = 19})
+                               .get0();
+        auto input_stream = http_response->as_input_stream();
+        ss::copy(input_stream, payload_stream).get0();
+        iobuf_parser p(std::move(payload));
+        auto actual_payload = p.read_string(p.bytes_left());
+        BOOST_REQUIRE_EQUAL(
+          actual_payload, std::string_view(expected_payload + 10, 10));
+        server->stop().get();
+    });
+}
+
 SEASTAR_TEST_CASE(test_get_object_failure) {
     return ss::async([] {
         bool error_triggered = false;
@@ -359,3 +469,80 @@ SEASTAR_TEST_CASE(test_list_objects_failure) {
         server->stop().get();
     });
 }
+
+SEASTAR_TEST_CASE(test_multipart_upload_with_part_retries) {
+    return ss::async([] {
+        auto conf = transport_configuration();
+        auto [server, client] = started_client_and_server(conf);
+        multipart_parts.clear();
+        // the first attempt of two parts fails
+        multipart_failures = 2;
+        ss::abort_source as;
+        s3::client_pool pool(conf, 2);
+        s3::multipart_upload upload(
+          pool,
+          as,
+          s3::bucket_name("test-bucket"),
+          s3::object_key("test-multipart"),
+          expected_payload_size,
+          s3::multipart_upload::options{
+            .part_size = 64, .backoff = std::chrono::milliseconds(1)});
+        BOOST_REQUIRE_EQUAL(
+          upload.parts_count(), (expected_payload_size + 63) / 64);
+        upload
+          .upload(
+            [](size_t offset, size_t length) {
+                iobuf part;
+                part.append(expected_payload + offset, length); // NOLINT
+                return make_iobuf_input_stream(std::move(part));
+            },
+            {})
+          .get();
+        BOOST_REQUIRE_EQUAL(multipart_failures, 0);
+        BOOST_REQUIRE_EQUAL(upload.uploaded_parts(), upload.parts_count());
+        BOOST_REQUIRE_EQUAL(*upload.upload_id(), "test-upload-id");
+        BOOST_REQUIRE_LE(pool.idle_connections(), 2);
+        pool.stop().get();
+        client->shutdown().get();
+        server->stop().get();
+    });
+}
+
+static ss::future<> put_test_object(s3::client& c, const ss::sstring& key) {
+    iobuf payload;
+    payload.append(expected_payload, expected_payload_size);
+    return c.put_object(
+      s3::bucket_name("test-bucket"),
+      s3::object_key(key),
+      expected_payload_size,
+      make_iobuf_input_stream(std::move(payload)));
+}
+
+SEASTAR_TEST_CASE(test_client_pool_reuses_connections) {
+    return ss::async([] {
+        auto conf = transport_configuration();
+        auto [server, client] = started_client_and_server(conf);
+        ss::abort_source as;
+        s3::client_pool pool(conf, 2);
+        for (int i = 0; i < 3; i++) {
+            pool
+              .with_client(
+                as, [](s3::client& c) { return put_test_object(c, "test"); })
+              .get();
+            // the connection is kept open for the next call
+            BOOST_REQUIRE_EQUAL(pool.idle_connections(), 1);
+        }
+        // a failed call closes its connection
+        BOOST_REQUIRE_THROW(
+          pool
+            .with_client(
+              as,
+              [](s3::client& c) { return put_test_object(c, "test-error"); })
+            .get(),
+          s3::rest_error_response);
+        BOOST_REQUIRE_EQUAL(pool.idle_connections(), 0);
+        pool.stop().get();
+        client->shutdown().get();
+        server->stop().get();
+    });
+}
@@ -12,6 +12,8 @@
 
 #include <absl/container/flat_hash_map.h>
 
+#include <algorithm>
+
 namespace security {
 
 std::optional<std::reference_wrapper<const acl_entry>> acl_entry_set::find(
@@ -78,6 +80,74 @@ bool acl_matches::contains(
     return false;
 }
 
+void prefix_tree::insert(std::string_view prefix) {
+    node* n = &_root;
+    while (!prefix.empty()) {
+        auto it = n->children.find(prefix[0]);
+        if (it == n->children.end()) {
+            auto child = std::make_unique<node>();
+            child->label = ss::sstring(prefix);
+            child->terminal = true;
+            n->children.emplace(prefix[0], std::move(child));
+            return;
+        }
+        auto& label = it->second->label;
+        auto common = std::mismatch(
+                        label.begin(),
+                        label.end(),
+                        prefix.begin(),
+                        prefix.end())
+                        .first
+                      - label.begin();
+        if (static_cast<size_t>(common) < label.size()) {
+            // split the edge where the prefix leaves it
+            auto split = std::make_unique<node>();
+            split->label = label.substr(0, common);
+            label = label.substr(common);
+            auto key = label[0];
+            split->children.emplace(key, std::move(it->second));
+            it->second = std::move(split);
+        }
+        n = it->second.get();
+        prefix.remove_prefix(common);
+    }
+    n->terminal = true;
+}
+
+void prefix_tree::erase(std::string_view prefix) {
+    if (prefix.empty()) {
+        _root.terminal = false;
+        return;
+    }
+    erase(_root, prefix);
+}
+
+void prefix_tree::erase(node& parent, std::string_view prefix) {
+    auto it = parent.children.find(prefix[0]);
+    if (it == parent.children.end() || !prefix.starts_with(it->second->label)) {
+        return;
+    }
+    auto& n = *it->second;
+    prefix.remove_prefix(n.label.size());
+    if (prefix.empty()) {
+        n.terminal = false;
+    } else {
+        erase(n, prefix);
+    }
+
+    if (n.terminal) {
+        return;
+    }
+    if (n.children.empty()) {
+        parent.children.erase(it);
+    } else if (n.children.size() == 1) {
+        // merge the node into its only child
+        auto child = std::move(n.children.begin()->second);
+        child->label = n.label + child->label;
+        it->second = std::move(child);
+    }
+}
+
 acl_matches
 acl_store::find(resource_type resource, const ss::sstring& name) const {
     using opt_entry_set = std::optional<acl_matches::entry_set_ref>;
@@ -98,19 +168,17 @@ acl_store::find(resource_type resource, const ss::sstring& name) const {
         literals = it->second;
     }
 
-    /*
-     * TODO: the prefix search operation can be optimized by bounding the search
-     * range by upper/lower limits, but we need to be careful about which upper
-     * limit is chosen.
-     */
     std::vector<acl_matches::entry_set_ref> prefixes;
-    for (const auto& it : _acls) {
-        if (it.first.pattern() != pattern_type::prefixed) {
-            continue;
-        }
-        if (std::string_view(name).starts_with(it.first.name())) {
-            prefixes.emplace_back(it.second);
-        }
+    if (const auto tree = _prefixes.find(resource); tree != _prefixes.end()) {
+        tree->second.for_each_prefix(
+          name, [this, resource, &name, &prefixes](size_t len) {
+              const resource_pattern prefixed_pattern(
+                resource, name.substr(0, len), pattern_type::prefixed);
+              if (const auto it = _acls.find(prefixed_pattern);
+                  it != _acls.end()) {
+                  prefixes.emplace_back(it->second);
+              }
+          });
     }
 
     return acl_matches(wildcards, literals, std::move(prefixes));
@@ -179,6 +247,21 @@ std::vector<std::vector<acl_binding>> acl_store::remove_bindings(
               }
               return false;
           });
+
+        if (!dry_run && it->second.empty()) {
+            if (resource.pattern() == pattern_type::prefixed) {
+                auto tree = _prefixes.find(resource.resource());
+                tree->second.erase(resource.name());
+                if (tree->second.empty()) {
+                    _prefixes.erase(tree);
+                }
+            }
+            _acls.erase(it);
+        }
+    }
+
+    if (!dry_run && !deleted.empty()) {
+        ++_generation;
     }
 
     std::vector<std::vector<acl_binding>> res;
@@ -12,8 +12,12 @@
 #include "security/acl.h"
 
 #include <absl/container/btree_map.h>
+#include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
 
+#include <memory>
+#include <string_view>
+
 namespace security {
 
 /*
@@ -103,6 +107,56 @@ private:
     std::vector<entry_set_ref> prefixes;
 };
 
+/*
+ * Radix tree of the names of the prefixed patterns of a resource type.
+ *
+ * Looking up the prefixes of a resource name costs O(name length), whatever
+ * the number of patterns. Edges are labeled with strings, nodes with a single
+ * child are merged into it.
+ */
+class prefix_tree {
+public:
+    void insert(std::string_view prefix);
+    void erase(std::string_view prefix);
+    bool empty() const { return !_root.terminal && _root.children.empty(); }
+
+    // invoke f with the length of each prefix of name in the tree, shortest
+    // first
+    template<typename Func>
+    void for_each_prefix(std::string_view name, Func f) const {
+        const node* n = &_root;
+        size_t depth = 0;
+        if (n->terminal) {
+            f(depth);
+        }
+        while (depth < name.size()) {
+            auto it = n->children.find(name[depth]);
+            if (it == n->children.end()) {
+                return;
+            }
+            n = it->second.get();
+            if (!name.substr(depth).starts_with(n->label)) {
+                return;
+            }
+            depth += n->label.size();
+            if (n->terminal) {
+                f(depth);
+            }
+        }
+    }
+
+private:
+    struct node {
+        ss::sstring label;
+        bool terminal{false};
+        absl::flat_hash_map<char, std::unique_ptr<node>> children;
+    };
+
+    static void erase(node& parent, std::string_view prefix);
+
+    node _root;
+};
+
 /*
  * Container for ACLs.
  */
@@ -117,10 +171,15 @@ public:
 
     void add_bindings(const std::vector<acl_binding>& bindings) {
         for (auto& binding : bindings) {
-            auto& entries = _acls[binding.pattern()];
+            const auto& pattern = binding.pattern();
+            auto& entries = _acls[pattern];
             entries.insert(binding.entry());
             entries.rehash();
+            if (pattern.pattern() == pattern_type::prefixed) {
+                _prefixes[pattern.resource()].insert(pattern.name());
+            }
         }
+        ++_generation;
     }
 
     // remove bindings according the input filters and return the bindings that
@@ -132,6 +191,10 @@ public:
     std::vector<acl_binding> acls(const acl_binding_filter&) const;
     acl_matches find(resource_type, const ss::sstring&) const;
 
+    // changes whenever bindings are added or removed, decisions taken at an
+    // older generation may be stale
+    uint64_t generation() const { return _generation; }
+
 private:
     /*
      * resource pattern ordering:
@@ -155,6 +218,9 @@ private:
 
     absl::btree_map<resource_pattern, acl_entry_set, resource_pattern_compare>
       _acls;
+    // names of the prefixed patterns in _acls, by resource type
+    absl::flat_hash_map<resource_type, prefix_tree> _prefixes;
+    uint64_t _generation{0};
 };
 
 } // namespace security
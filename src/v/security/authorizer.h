@@ -20,9 +20,12 @@
 #include <seastar/core/sstring.hh>
 #include <seastar/util/bool_class.hh>
 
+#include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
 #include <fmt/core.h>
 
+#include <optional>
+
 namespace security {
 
 /*
@@ -118,12 +121,80 @@ public:
             vlog(seclog.debug, "Adding superuser: {}", principal);
         }
         _superusers.emplace(std::move(principal));
+        ++_superusers_generation;
+    }
+
+    /*
+     * Changes whenever an authorization decision may change.
+     */
+    uint64_t generation() const {
+        return _store.generation() + _superusers_generation;
     }
 
 private:
     acl_store _store;
     absl::flat_hash_set<acl_principal> _superusers;
+    uint64_t _superusers_generation{0};
     allow_empty_matches _allow_empty_matches;
 };
 
+/*
+ * Authorization decisions of a connection.
+ *
+ * The host of a connection is fixed, the decisions are keyed by resource and
+ * operation. They are dropped when the principal of the connection changes,
+ * e.g. once it authenticates, or when the generation of the authorizer moves
+ * on because ACLs were added or removed.
+ */
+class authorization_cache {
+public:
+    static constexpr size_t max_decisions = 1024;
+
+    template<typename T>
+    bool authorized(
+      const authorizer& auth,
+      const T& resource_name,
+      acl_operation operation,
+      const acl_principal& principal,
+      const acl_host& host) {
+        if (
+          _generation != auth.generation() || !_principal
+          || *_principal != principal || _decisions.size() >= max_decisions) {
+            _decisions.clear();
+            _generation = auth.generation();
+            _principal = principal;
+        }
+
+        key k{
+          .type = get_resource_type<T>(),
+          .name = resource_name(),
+          .operation = operation};
+        if (auto it = _decisions.find(k); it != _decisions.end()) {
+            return it->second;
+        }
+        auto allowed = auth.authorized(
+          resource_name, operation, principal, host);
+        _decisions.emplace(std::move(k), allowed);
+        return allowed;
+    }
+
+private:
+    struct key {
+        resource_type type;
+        ss::sstring name;
+        acl_operation operation;
+
+        friend bool operator==(const key&, const key&) = default;
+
+        template<typename H>
+        friend H AbslHashValue(H h, const key& k) {
+            return H::combine(std::move(h), k.type, k.name, k.operation);
+        }
+    };
+
+    uint64_t _generation{0};
+    std::optional<acl_principal> _principal;
+    absl::flat_hash_map<key, bool> _decisions;
+};
+
 } // namespace security
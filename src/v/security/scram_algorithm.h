@@ -15,6 +15,11 @@
 #include "security/scram_credential.h"
 #include "ssx/sformat.h"
 
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/future.hh>
+#include <seastar/core/later.hh>
+#include <seastar/core/preempt.hh>
+
 #include <absl/container/node_hash_map.h>
 
 /**
@@ -224,7 +229,54 @@ public:
           iterations);
     }
 
+    /**
+     * same as make_credentials but the salted password is computed in chunks
+     * of iterations, yielding the reactor in between. credentials are built
+     * with thousands of iterations, in the time of many tasks.
+     */
+    static ss::future<scram_credential>
+    make_credentials_async(ss::sstring password, int iterations) {
+        bytes salt = random_generators::get_bytes(SaltSize);
+        bytes salted_password = co_await salt_password_async(
+          std::move(password), salt, iterations);
+        auto clientkey = client_key(salted_password);
+        auto storedkey = stored_key(clientkey);
+        auto serverkey = server_key(salted_password);
+        co_return scram_credential(
+          std::move(salt),
+          std::move(serverkey),
+          std::move(storedkey),
+          iterations);
+    }
+
+    static bytes salt_password(
+      const ss::sstring& password, bytes_view salt, int iterations) {
+        bytes password_bytes(password.begin(), password.end());
+        return hi(password_bytes, salt, iterations);
+    }
+
+    static ss::future<bytes>
+    salt_password_async(ss::sstring password, bytes salt, int iterations) {
+        bytes password_bytes(password.begin(), password.end());
+        MacType mac(password_bytes);
+        mac.update(salt);
+        mac.update(std::array<char, 4>{0, 0, 0, 1});
+        auto prev = mac.reset();
+        auto result = prev;
+        for (int i = 2; i <= iterations; i++) {
+            mac.update(prev);
+            prev = mac.reset();
+            result = result ^ prev;
+            if (i % yield_iterations == 0 && ss::need_preempt()) {
+                co_await ss::later();
+            }
+        }
+        co_return bytes(result.begin(), result.end());
+    }
+
 private:
+    static constexpr int yield_iterations = 256;
+
     static bytes hi(bytes_view str, bytes_view salt, int iterations) {
         MacType mac(str);
         mac.update(salt);
@@ -241,12 +293,6 @@ private:
         return bytes(result.begin(), result.end());
     }
 
-    static bytes salt_password(
-      const ss::sstring& password, bytes_view salt, int iterations) {
-        bytes password_bytes(password.begin(), password.end());
-        return hi(password_bytes, salt, iterations);
-    }
-
     static bytes client_key(bytes_view salted_password) {
         MacType mac(salted_password);
         mac.update("Client Key");
@@ -841,4 +841,110 @@ BOOST_AUTO_TEST_CASE(topic_acl) {
       auth.authorized(default_topic, acl_operation::write, user3, host1));
 }
 
+BOOST_AUTO_TEST_CASE(authorization_cache_invalidation) {
+    acl_principal alice(principal_type::user, "alice");
+    acl_principal bob(principal_type::user, "bob");
+    acl_host host("192.168.2.1");
+    resource_pattern resource(
+      resource_type::topic, default_topic(), pattern_type::literal);
+
+    authorizer auth;
+    authorization_cache cache;
+
+    std::vector<acl_binding> bindings;
+    bindings.emplace_back(
+      resource,
+      acl_entry(alice, host, acl_operation::read, acl_permission::allow));
+    auth.add_bindings(bindings);
+
+    BOOST_REQUIRE(
+      cache.authorized(auth, default_topic, acl_operation::read, alice, host));
+    BOOST_REQUIRE(!cache.authorized(
+      auth, default_topic, acl_operation::write, alice, host));
+    // the principal changed, e.g. once the connection authenticated
+    BOOST_REQUIRE(
+      !cache.authorized(auth, default_topic, acl_operation::read, bob, host));
+
+    // removing the binding invalidates the decisions
+    auto generation = auth.generation();
+    std::vector<acl_binding_filter> filters;
+    filters.emplace_back(
+      resource,
+      acl_entry(alice, host, acl_operation::read, acl_permission::allow));
+    auth.remove_bindings(filters, true);
+    BOOST_REQUIRE_EQUAL(auth.generation(), generation);
+    BOOST_REQUIRE(
+      cache.authorized(auth, default_topic, acl_operation::read, alice, host));
+
+    auth.remove_bindings(filters);
+    BOOST_REQUIRE_NE(auth.generation(), generation);
+    BOOST_REQUIRE(
+      !cache.authorized(auth, default_topic, acl_operation::read, alice, host));
+
+    // and so does adding one
+    auth.add_bindings(bindings);
+    BOOST_REQUIRE(
+      cache.authorized(auth, default_topic, acl_operation::read, alice, host));
+}
+
+BOOST_AUTO_TEST_CASE(prefix_tree_lookup) {
+    prefix_tree tree;
+    for (auto p : {"foo", "foobar", "fob", "f", "bar"}) {
+        tree.insert(p);
+    }
+
+    auto prefixes = [&tree](std::string_view name) {
+        std::vector<ss::sstring> res;
+        tree.for_each_prefix(name, [&res, name](size_t len) {
+            res.emplace_back(name.substr(0, len));
+        });
+        return res;
+    };
+
+    using v = std::vector<ss::sstring>;
+    BOOST_REQUIRE(prefixes("foobarbaz") == v({"f", "foo", "foobar"}));
+    BOOST_REQUIRE(prefixes("fob") == v({"f", "fob"}));
+    BOOST_REQUIRE(prefixes("fo") == v({"f"}));
+    BOOST_REQUIRE(prefixes("baz").empty());
+
+    tree.erase("foo");
+    BOOST_REQUIRE(prefixes("foobarbaz") == v({"f", "foobar"}));
+    tree.erase("f");
+    tree.erase("foobar");
+    BOOST_REQUIRE(prefixes("foobarbaz").empty());
+    BOOST_REQUIRE(prefixes("fob") == v({"fob"}));
+    tree.erase("fob");
+    tree.erase("bar");
+    BOOST_REQUIRE(tree.empty());
+}
+
+BOOST_AUTO_TEST_CASE(prefixed_acls_by_resource_type) {
+    acl_principal user(principal_type::user, "alice");
+    acl_host host("192.168.2.1");
+    authorizer auth;
+
+    acl_entry allow(user, host, acl_operation::read, acl_permission::allow);
+    std::vector<acl_binding> bindings;
+    bindings.emplace_back(
+      resource_pattern(resource_type::topic, "top", pattern_type::prefixed),
+      allow);
+    bindings.emplace_back(
+      resource_pattern(resource_type::group, "topic", pattern_type::prefixed),
+      allow);
+    auth.add_bindings(bindings);
+
+    BOOST_REQUIRE(
+      auth.authorized(default_topic, acl_operation::read, user, host));
+    BOOST_REQUIRE(!auth.authorized(
+      kafka::group_id("tenant"), acl_operation::read, user, host));
+    BOOST_REQUIRE(auth.authorized(
+      kafka::group_id("topic-group"), acl_operation::read, user, host));
+
+    std::vector<acl_binding_filter> filters;
+    filters.emplace_back(bindings[0].pattern(), allow);
+    auth.remove_bindings(filters);
+    BOOST_REQUIRE(
+      !auth.authorized(default_topic, acl_operation::read, user, host));
+}
+
 } // namespace security
@@ -0,0 +1,38 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+#include "random/generators.h"
+#include "security/scram_algorithm.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+#include <boost/test/unit_test.hpp>
+
+namespace security {
+
+SEASTAR_THREAD_TEST_CASE(salt_password_async_matches) {
+    auto salt = random_generators::get_bytes(130);
+    // more iterations than a chunk between yields
+    for (int iterations : {1, 255, 4096, 10000}) {
+        BOOST_REQUIRE_EQUAL(
+          scram_sha256::salt_password_async("pencil", salt, iterations).get0(),
+          scram_sha256::salt_password("pencil", salt, iterations));
+        BOOST_REQUIRE_EQUAL(
+          scram_sha512::salt_password_async("pencil", salt, iterations).get0(),
+          scram_sha512::salt_password("pencil", salt, iterations));
+    }
+}
+
+SEASTAR_THREAD_TEST_CASE(make_credentials_async_salts) {
+    auto credential
+      = scram_sha256::make_credentials_async("pencil", 4096).get0();
+    BOOST_REQUIRE_EQUAL(credential.iterations(), 4096);
+    BOOST_REQUIRE_EQUAL(credential.salt().size(), 130);
+}
+
+} // namespace security
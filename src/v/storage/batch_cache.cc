@@ -130,20 +130,42 @@ batch_cache::put(batch_cache_index& index, const model::record_batch& input) {
     // shouldn't--`e` wouldn't be visible to the reclaimer since it
     // isn't on a lru/pool list.
 
+    // only the lru policy admits new ranges directly into the protected
+    // segment, see batch_cache_policy
+    const bool admit_protected = index.policy() == batch_cache_policy::lru;
+    // new ranges of an index retaining its tail are retained
+    const bool admit_retained = index._tail_size > 0
+                                && _reclaim_opts.max_retained_size > 0;
+    auto admit = [this, &index, admit_protected, admit_retained](range& r) {
+        if (admit_retained) {
+            retain(r);
+            index._retained_ranges.push_back(r.weak_from_this());
+        } else {
+            link(r, admit_protected);
+        }
+    };
+
     if (static_cast<size_t>(input.size_bytes()) > range::range_size) {
         auto r = new range(index, input);
-        _lru.push_back(*r);
         _size_bytes += r->memory_size();
+        admit(*r);
+        if (admit_retained) {
+            index.release_tail_overflow();
+            release_retained_overflow();
+        }
+        demote_protected_overflow();
         return entry(0, r->weak_from_this());
     }
 
+    bool new_range = false;
     if (
       !index._small_batches_range || !index._small_batches_range->valid()
       || !index._small_batches_range->fits(input)) {
         auto r = new range(index);
-        _lru.push_back(*r);
         _size_bytes += r->memory_size();
+        admit(*r);
         index._small_batches_range = r->weak_from_this();
+        new_range = true;
     }
 
     auto initial_sz = index._small_batches_range->memory_size();
@@ -152,14 +174,98 @@ batch_cache::put(batch_cache_index& index, const model::record_batch& input) {
     int64_t diff = (int64_t)index._small_batches_range->memory_size()
                    - initial_sz;
     _size_bytes += diff;
+    if (index._small_batches_range->_protected) {
+        _protected_bytes += diff;
+    }
+    if (index._small_batches_range->_retained) {
+        _retained_bytes += diff;
+    }
+    if (new_range && admit_retained) {
+        index.release_tail_overflow();
+        release_retained_overflow();
+    }
+    demote_protected_overflow();
     _background_reclaimer.notify();
     return entry(offset, index._small_batches_range->weak_from_this());
 }
 
+void batch_cache::unlink(range& r) {
+    r._hook.unlink();
+    if (r._protected) {
+        _protected_bytes -= r.memory_size();
+    }
+    if (r._retained) {
+        _retained_bytes -= r.memory_size();
+    }
+    r._protected = false;
+    r._retained = false;
+}
+
+void batch_cache::link(range& r, bool protect) {
+    unlink(r);
+    r._protected = protect;
+    if (protect) {
+        _protected_bytes += r.memory_size();
+        _protected.push_back(r);
+    } else {
+        _probation.push_back(r);
+    }
+}
+
+void batch_cache::retain(range& r) {
+    unlink(r);
+    r._retained = true;
+    _retained_bytes += r.memory_size();
+    _retained.push_back(r);
+}
+
+void batch_cache::release(range& r) {
+    // back in the lru order as if it was just written
+    link(r, r._index.policy() == batch_cache_policy::lru);
+}
+
+void batch_cache::release_retained_overflow() {
+    // the most recently written range is never released
+    while (!_retained.empty()
+           && _retained_bytes > _reclaim_opts.max_retained_size
+           && &_retained.front() != &_retained.back()) {
+        release(_retained.front());
+    }
+}
+
+void batch_cache::demote_protected_overflow() {
+    const auto max_protected = static_cast<size_t>(
+      static_cast<double>(_size_bytes) * max_protected_ratio);
+    // the most recently used range is never demoted
+    while (!_protected.empty() && _protected_bytes > max_protected
+           && &_protected.front() != &_protected.back()) {
+        link(_protected.front(), false);
+    }
+}
+
+void batch_cache::touch(range_ptr& e) {
+    if (!e) {
+        return;
+    }
+    auto& r = *e.get();
+    if (r._retained) {
+        // retained ranges are ordered by writes, not reads
+        return;
+    }
+    /*
+     * probationary ranges of a segmented lru index are promoted on their
+     * first hit. ranges of an lru index that were demoted return to the
+     * protected segment like any other recently used range.
+     */
+    link(r, true);
+    demote_protected_overflow();
+}
+
 batch_cache::~batch_cache() noexcept {
     clear();
     vassert(
-      _size_bytes == 0 && _lru.empty(),
+      _size_bytes == 0 && _protected_bytes == 0 && _retained_bytes == 0
+        && empty(),
       "Detected incorrect batch_cache accounting. {}",
       *this);
 }
@@ -171,8 +277,16 @@ void batch_cache::evict(range_ptr&& e) {
         // r-value reference `e` wouldn't do that.
         auto p = std::exchange(e, {});
         _size_bytes -= p->memory_size();
-        _lru.erase_and_dispose(
-          _lru.iterator_to(*p), [](range* e) { delete e; });
+        if (p->_protected) {
+            _protected_bytes -= p->memory_size();
+        }
+        if (p->_retained) {
+            _retained_bytes -= p->memory_size();
+        }
+        auto& lru = p->_retained    ? _retained
+                    : p->_protected ? _protected
+                                    : _probation;
+        lru.erase_and_dispose(lru.iterator_to(*p), [](range* e) { delete e; });
     }
 }
 
@@ -209,9 +323,47 @@ size_t batch_cache::reclaim(size_t size) {
      * index still exists even though the batch data was removed.
      */
     size_t reclaimed = 0;
-    intrusive_list<range, &range::_hook> reclaimed_ranges;
+    lru_list reclaimed_ranges;
+
+    // probationary ranges are always reclaimed before protected ranges, and
+    // retained tails only once there is nothing else left
+    reclaim_from(_probation, reclaimed, reclaimed_ranges);
+    reclaim_from(_protected, reclaimed, reclaimed_ranges);
+    reclaim_from(_retained, reclaimed, reclaimed_ranges);
+
+    /*
+     * final removal from the index is deferred because there is some chance
+     * that removal allocates, so waiting until the bulk of the reclaims have
+     * occurred reduces the probability of an allocation failure.
+     */
 
-    for (auto it = _lru.begin(); it != _lru.end();) {
+    reclaimed_ranges.clear_and_dispose([](range* e) {
+        auto* index = &e->_index;
+        auto offsets = std::move(e->_offsets);
+        delete e; // NOLINT
+
+        /*
+         * since reclaim may be invoked at any moment and removals may be
+         * deferred if an index is locked, one can imagine races in which a
+         * batch is removed by offset here which is not the same batch that was
+         * reclaimed in a prior pass. at worst this would raise the miss ratio,
+         * but is still generally safe since all batch cache users are prepared
+         * to handle a miss.
+         */
+        for (auto& o : offsets) {
+            index->remove(o);
+        }
+    });
+
+    _last_reclaim = ss::lowres_clock::now();
+    _size_bytes -= reclaimed;
+    _reclaimed_bytes += reclaimed;
+    return reclaimed;
+}
+
+void batch_cache::reclaim_from(
+  lru_list& lru, size_t& reclaimed, lru_list& reclaimed_ranges) {
+    for (auto it = lru.begin(); it != lru.end();) {
         if (reclaimed >= _reclaim_size) {
             break;
         }
@@ -226,7 +378,14 @@ size_t batch_cache::reclaim(size_t size) {
             continue;
         }
         // reclaim the batch's record data
-        reclaimed += it->memory_size();
+        const auto size = it->memory_size();
+        reclaimed += size;
+        if (it->_protected) {
+            _protected_bytes -= size;
+        }
+        if (it->_retained) {
+            _retained_bytes -= size;
+        }
         it->_arena.clear();
 
         /*
@@ -241,38 +400,10 @@ size_t batch_cache::reclaim(size_t size) {
         }
 
         // collect the entries that will be fully removed
-        it = _lru.erase_and_dispose(it, [&reclaimed_ranges](range* e) {
+        it = lru.erase_and_dispose(it, [&reclaimed_ranges](range* e) {
             reclaimed_ranges.push_back(*e);
         });
     }
-
-    /*
-     * final removal from the index is deferred because there is some chance
-     * that removal allocates, so waiting until the bulk of the reclaims have
-     * occurred reduces the probability of an allocation failure.
-     */
-
-    reclaimed_ranges.clear_and_dispose([](range* e) {
-        auto* index = &e->_index;
-        auto offsets = std::move(e->_offsets);
-        delete e; // NOLINT
-
-        /*
-         * since reclaim may be invoked at any moment and removals may be
-         * deferred if an index is locked, one can imagine races in which a
-         * batch is removed by offset here which is not the same batch that was
-         * reclaimed in a prior pass. at worst this would raise the miss ratio,
-         * but is still generally safe since all batch cache users are prepared
-         * to handle a miss.
-         */
-        for (auto& o : offsets) {
-            index->remove(o);
-        }
-    });
-
-    _last_reclaim = ss::lowres_clock::now();
-    _size_bytes -= reclaimed;
-    return reclaimed;
 }
 
 std::optional<model::record_batch>
@@ -307,6 +438,11 @@ batch_cache_index::read_result batch_cache_index::read(
         offset = batch.last_offset() + model::offset(1);
         if (take) {
             batch_cache::range::lock_guard g(*it->second.range());
+            if (it->second.range()->is_protected()) {
+                ++ret.protected_hits;
+            } else {
+                ++ret.probation_hits;
+            }
             ret.memory_usage += batch.memory_usage();
             ret.batches.emplace_back(std::move(batch));
             if (!skip_lru_promote) {
@@ -353,6 +489,33 @@ batch_cache_index::read_result batch_cache_index::read(
     return ret;
 }
 
+void batch_cache_index::retain_tail(size_t size) {
+    lock_guard lk(*this);
+    _tail_size = size;
+    release_tail_overflow();
+}
+
+void batch_cache_index::release_tail_overflow() {
+    auto is_retained = [](const batch_cache::range_ptr& r) {
+        return r && r->valid() && r->is_retained();
+    };
+    // newest first, the ranges past the tail size are released
+    size_t retained = 0;
+    for (auto it = _retained_ranges.rbegin(); it != _retained_ranges.rend();
+         ++it) {
+        if (!is_retained(*it)) {
+            continue;
+        }
+        retained += (*it)->memory_size();
+        if (retained > _tail_size) {
+            _cache->release(**it);
+        }
+    }
+    std::erase_if(_retained_ranges, [&is_retained](const auto& r) {
+        return !is_retained(r);
+    });
+}
+
 void batch_cache_index::truncate(model::offset offset) {
     lock_guard lk(*this);
     if (auto it = find_first(offset); it != _index.end()) {
@@ -407,11 +570,13 @@ std::ostream&
 operator<<(std::ostream& os, const batch_cache::reclaim_options& opts) {
     fmt::print(
       os,
-      "growth window {} stable window {} min_size {} max_size {}",
+      "growth window {} stable window {} min_size {} max_size {} "
+      "max_retained_size {}",
       opts.growth_window,
       opts.stable_window,
       opts.min_size,
-      opts.max_size);
+      opts.max_size,
+      opts.max_retained_size);
     return os;
 }
 
@@ -420,7 +585,9 @@ std::ostream& operator<<(std::ostream& o, const batch_cache& b) {
     // Do _not_ print size of _lru
     return o << "{is_reclaiming:" << b.is_memory_reclaiming()
              << ", size_bytes: " << b._size_bytes
-             << ", lru_empty:" << b._lru.empty() << "}";
+             << ", protected_bytes: " << b._protected_bytes
+             << ", retained_bytes: " << b._retained_bytes
+             << ", lru_empty:" << b.empty() << "}";
 }
 std::ostream&
 operator<<(std::ostream& o, const batch_cache_index::read_result& c) {
@@ -434,7 +601,8 @@ operator<<(std::ostream& o, const batch_cache_index::read_result& c) {
     return o << "}";
 }
 std::ostream& operator<<(std::ostream& o, const batch_cache_index& c) {
-    return o << "{cache_size=" << c._index.size() << "}";
+    return o << "{cache_size=" << c._index.size() << ", policy=" << c._policy
+             << "}";
 }
 
 } // namespace storage
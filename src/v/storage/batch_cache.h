@@ -11,6 +11,7 @@
 
 #pragma once
 #include "model/record.h"
+#include "storage/ntp_config.h"
 #include "units.h"
 #include "utils/intrusive_list_helpers.h"
 #include "vassert.h"
@@ -26,6 +27,7 @@
 #include <absl/container/btree_map.h>
 #include <absl/container/flat_hash_map.h>
 
+#include <deque>
 #include <limits>
 #include <type_traits>
 
@@ -55,6 +57,31 @@ class batch_cache_index;
  * example, a batch cache index is created for each log segment, all of which
  * share the same LRU cache.
  *
+ * Admission
+ * =========
+ *
+ * The LRU order is split into a probationary and a protected segment. Each
+ * index selects how its ranges enter the cache (see batch_cache_policy). With
+ * `lru` ranges are inserted and touched directly into the protected segment.
+ * With `segmented_lru` ranges are inserted into the probationary segment and
+ * promoted to the protected segment on their first hit. The protected segment
+ * is bounded to a fraction of the cache, ranges over that bound (except the
+ * most recently used one) are demoted to the most recently used end of the
+ * probationary segment. Reclaim frees the
+ * probationary segment first, so a single scan of cold data read from disk
+ * cannot push out the hot tail that is read repeatedly.
+ *
+ * Tail retention
+ * ==============
+ *
+ * An index may retain the most recently written ranges of its log (see
+ * batch_cache_index::retain_tail) in a third segment that is reclaimed only
+ * after the other two. This keeps the tail of a follower, which nobody reads,
+ * in memory so that it is warm once the follower becomes the leader. An index
+ * retains up to its tail size, and all indexes of the cache up to
+ * `reclaim_options::max_retained_size`, the oldest ranges over either bound
+ * fall back to the lru order like any other range.
+ *
  * The LRU cache serves as an entry point for the Seastar memory reclaimer.
  * During a low-memory event Seastar may make an upcall to the LRU cache to free
  * memory. When memory is reclaimed cache entries are invalidated. Since this
@@ -104,6 +131,9 @@ class batch_cache {
     using reclaim_scope = ss::memory::reclaimer_scope;
     using reclaim_result = ss::memory::reclaiming_result;
 
+    /// Upper bound of the protected segment as a fraction of the cache size.
+    static constexpr double max_protected_ratio = 0.8;
+
 public:
     struct reclaim_options {
         ss::lowres_clock::duration growth_window;
@@ -113,6 +143,8 @@ public:
         // background reclaimer settings
         ss::scheduling_group background_reclaimer_sg;
         size_t min_free_memory = 64_MiB;
+        // total size of ranges retained as tails of their logs
+        size_t max_retained_size = 0;
     };
 
     /*
@@ -166,6 +198,8 @@ public:
         void pin() { _pinned = true; }
         void unpin() { _pinned = false; }
         bool pinned() const { return _pinned; }
+        bool is_protected() const { return _protected; }
+        bool is_retained() const { return _retained; }
         size_t memory_size() const;
         size_t bytes_left() const;
         double waste() const;
@@ -188,6 +222,9 @@ public:
         std::vector<model::offset> _offsets;
 
         bool _pinned{false};
+        // segment of the lru the range is linked into
+        bool _protected{false};
+        bool _retained{false};
         size_t _size = 0;
         intrusive_list_hook _hook;
         batch_cache_index& _index;
@@ -253,7 +290,9 @@ public:
     ss::future<> stop() { return _background_reclaimer.stop(); }
 
     /// Returns true if the cache is empty, and false otherwise.
-    bool empty() const { return _lru.empty(); }
+    bool empty() const {
+        return _probation.empty() && _protected.empty() && _retained.empty();
+    }
 
     /// Removes all entries from the cache.
     void clear() { reclaim(std::numeric_limits<size_t>::max()); }
@@ -283,15 +322,10 @@ public:
     void evict(range_ptr&& e);
 
     /**
-     * Notify the cache that the specified range was recently used.
+     * Notify the cache that the specified range was recently used. Depending
+     * on the policy of its index this promotes a probationary range.
      */
-    void touch(range_ptr& e) {
-        if (e) {
-            auto p = e.get();
-            p->_hook.unlink();
-            _lru.push_back(*p);
-        }
-    }
+    void touch(range_ptr& e);
 
     /**
      * \brief Evict batches up to the accumulated size specified.
@@ -307,8 +341,14 @@ public:
      */
     bool is_memory_reclaiming() const { return _is_reclaiming; }
 
+    /// total bytes reclaimed since the cache was created
+    uint64_t reclaimed_bytes() const { return _reclaimed_bytes; }
+
 private:
+    using lru_list = intrusive_list<range, &range::_hook>;
+
     friend batch_cache_test_fixture;
+    friend batch_cache_index;
     struct batch_reclaiming_lock {
         explicit batch_reclaiming_lock(batch_cache& b) noexcept
           : ref(b)
@@ -369,13 +409,33 @@ private:
                               : reclaim_result::reclaimed_nothing;
     }
 
-    intrusive_list<range, &range::_hook> _lru;
+    /// unlinks the range from its segment
+    void unlink(range&);
+    /// links the range at the most recently used end of the given segment
+    void link(range&, bool protect);
+    /// links the range at the most recently written end of retained ranges
+    void retain(range&);
+    /// links a retained range back into the lru order of its index
+    void release(range&);
+    /// demotes least recently used protected ranges over the bound
+    void demote_protected_overflow();
+    /// releases the oldest retained ranges over the bound
+    void release_retained_overflow();
+    /// reclaims from the front of the list, see reclaim(size_t)
+    void reclaim_from(lru_list&, size_t& reclaimed, lru_list& reclaimed_ranges);
+
+    lru_list _probation;
+    lru_list _protected;
+    lru_list _retained;
     reclaimer _reclaimer;
     bool _is_reclaiming{false};
     size_t _size_bytes{0};
+    size_t _protected_bytes{0};
+    size_t _retained_bytes{0};
 
     reclaim_options _reclaim_opts;
     ss::lowres_clock::time_point _last_reclaim;
+    uint64_t _reclaimed_bytes{0};
     size_t _reclaim_size;
     background_reclaimer _background_reclaimer;
 
@@ -392,12 +452,18 @@ public:
         size_t memory_usage{0};
         model::offset next_batch;
         std::optional<model::offset> next_cached_batch;
+        // number of returned batches found in each lru segment
+        size_t probation_hits{0};
+        size_t protected_hits{0};
 
         friend std::ostream& operator<<(std::ostream&, const read_result&);
     };
 
-    explicit batch_cache_index(batch_cache& cache)
-      : _cache(&cache) {}
+    explicit batch_cache_index(
+      batch_cache& cache,
+      batch_cache_policy policy = batch_cache_policy::lru)
+      : _cache(&cache)
+      , _policy(policy) {}
     ~batch_cache_index() {
         lock_guard lk(*this);
         std::for_each(
@@ -412,6 +478,14 @@ public:
 
     bool empty() const { return _index.empty(); }
 
+    batch_cache_policy policy() const { return _policy; }
+
+    /**
+     * Retain the most recently written ranges of the index, up to the given
+     * size, see "Tail retention" in batch_cache. A size of 0 releases them.
+     */
+    void retain_tail(size_t);
+
     void put(const model::record_batch& batch) {
         lock_guard lk(*this);
         auto offset = batch.header().base_offset;
@@ -555,10 +629,17 @@ private:
         return _index.end();
     }
 
+    /// releases the oldest retained ranges over the tail size
+    void release_tail_overflow();
+
     bool _locked{false};
     batch_cache* _cache;
+    batch_cache_policy _policy;
     index_type _index;
     batch_cache::range_ptr _small_batches_range = nullptr;
+    size_t _tail_size{0};
+    // retained ranges, oldest first
+    std::deque<batch_cache::range_ptr> _retained_ranges;
 
     friend std::ostream& operator<<(std::ostream&, const batch_cache_index&);
 };
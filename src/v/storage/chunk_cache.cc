@@ -0,0 +1,64 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/chunk_cache.h"
+
+#include "config/configuration.h"
+#include "prometheus/prometheus_sanitize.h"
+
+#include <seastar/core/metrics.hh>
+
+namespace storage::internal {
+
+void chunk_cache::setup_metrics() {
+    if (_metrics_registered || config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+    _metrics_registered = true;
+    namespace sm = ss::metrics;
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("storage:chunk_cache"),
+      {
+        sm::make_gauge(
+          "total_bytes",
+          [this] { return _size_total; },
+          sm::description("Bytes of write-behind chunks allocated, in use "
+                          "by appenders or free in the cache")),
+        sm::make_gauge(
+          "used_bytes",
+          [this] { return _size_total - _size_available; },
+          sm::description("Bytes of write-behind chunks held by appenders")),
+        sm::make_gauge(
+          "limit_bytes",
+          [this] { return _size_limit; },
+          sm::description("Maximum bytes of write-behind chunks per shard")),
+        sm::make_gauge(
+          "holders",
+          [this] { return _holders; },
+          sm::description("Number of appenders holding chunks")),
+        sm::make_gauge(
+          "waiters",
+          [this] { return _sem.waiters(); },
+          sm::description("Number of appenders waiting for a chunk")),
+        sm::make_derive(
+          "waits",
+          [this] { return _waits; },
+          sm::description("Number of times an appender waited for a chunk")),
+        sm::make_derive(
+          "wait_time_us",
+          [this] {
+              return std::chrono::duration_cast<std::chrono::microseconds>(
+                       _wait_time)
+                .count();
+          },
+          sm::description("Total time appenders waited for a chunk")),
+      });
+}
+
+} // namespace storage::internal
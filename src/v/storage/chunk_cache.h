@@ -9,13 +9,29 @@
 #include <seastar/core/chunked_fifo.hh>
 #include <seastar/core/future.hh>
 #include <seastar/core/loop.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/core/metrics_registration.hh>
 #include <seastar/core/semaphore.hh>
 #include <seastar/util/later.hh>
 
 #include <boost/iterator/counting_iterator.hpp>
 
+#include <algorithm>
+#include <chrono>
+
 namespace storage::internal {
 
+/**
+ * Shard wide pool of write-behind chunks shared by all segment appenders.
+ *
+ * The total memory of the chunks handed out is capped at the chunk cache max
+ * memory of the shard; once the cap is reached appenders wait for a chunk to
+ * be returned. Appenders return chunks as soon as their writes land and
+ * reclaim the active chunk of an idle segment, so that low rate partitions do
+ * not pin memory. To keep a few high rate partitions from starving the rest,
+ * every appender that holds chunks is entitled to an equal share of the
+ * limit, see fair_share().
+ */
 class chunk_cache {
     using chunk = segment_appender_chunk;
     using chunk_ptr = ss::lw_shared_ptr<chunk>;
@@ -34,6 +50,10 @@ public:
       : _size_target(memory_groups::chunk_cache_min_memory())
       , _size_limit(memory_groups::chunk_cache_max_memory()) {}
 
+    chunk_cache(size_t size_target, size_t size_limit) noexcept
+      : _size_target(size_target)
+      , _size_limit(size_limit) {}
+
     chunk_cache(chunk_cache&&) = delete;
     chunk_cache& operator=(chunk_cache&&) = delete;
     chunk_cache(const chunk_cache&) = delete;
@@ -41,8 +61,7 @@ public:
     ~chunk_cache() noexcept = default;
 
     ss::future<> start() {
-        const auto num_chunks = memory_groups::chunk_cache_min_memory()
-                                / chunk::chunk_size;
+        const auto num_chunks = _size_target / chunk::chunk_size;
         return ss::do_for_each(
           boost::counting_iterator<size_t>(0),
           boost::counting_iterator<size_t>(num_chunks),
@@ -53,13 +72,16 @@ public:
           });
     }
 
+    void setup_metrics();
+
     void add(const chunk_ptr& chunk) {
         if (_size_available >= _size_target) {
+            // freeing the chunk makes room below the limit for a waiter
             _size_total -= chunk::chunk_size;
-            return;
+        } else {
+            _chunks.push_back(chunk);
+            _size_available += chunk::chunk_size;
         }
-        _chunks.push_back(chunk);
-        _size_available += chunk::chunk_size;
         if (_sem.waiters()) {
             _sem.signal();
         }
@@ -70,17 +92,45 @@ public:
         if (!_sem.waiters()) {
             return do_get();
         }
-        return ss::get_units(_sem, 1).then(
-          [this](ss::semaphore_units<>) { return do_get(); });
+        return wait_and_get();
+    }
+
+    /**
+     * Appenders report when they start and stop holding chunks, the number of
+     * holders determines the fair share of each.
+     */
+    void holder_added() { ++_holders; }
+    void holder_removed() {
+        vassert(_holders > 0, "chunk cache holder count underflow");
+        --_holders;
+    }
+
+    /// \brief number of chunks an appender may hold while others are waiting
+    size_t fair_share() const {
+        const size_t limit = _size_limit / chunk::chunk_size;
+        return std::max<size_t>(1, limit / std::max<size_t>(1, _holders));
     }
 
+    size_t waiters() const { return _sem.waiters(); }
+    size_t size_total() const { return _size_total; }
+    size_t size_available() const { return _size_available; }
+    size_t size_limit() const { return _size_limit; }
+
 private:
     ss::future<chunk_ptr> do_get() {
         if (auto c = pop_or_allocate(); c) {
             return ss::make_ready_future<chunk_ptr>(c);
         }
+        return wait_and_get();
+    }
+
+    ss::future<chunk_ptr> wait_and_get() {
+        ++_waits;
         return ss::get_units(_sem, 1).then(
-          [this](ss::semaphore_units<>) { return do_get(); });
+          [this, start = ss::lowres_clock::now()](ss::semaphore_units<>) {
+              _wait_time += ss::lowres_clock::now() - start;
+              return do_get();
+          });
     }
 
     chunk_ptr pop_or_allocate() {
@@ -109,6 +159,11 @@ private:
     size_t _size_total{0};
     const size_t _size_target;
     const size_t _size_limit;
+    size_t _holders{0};
+    uint64_t _waits{0};
+    ss::lowres_clock::duration _wait_time{0};
+    bool _metrics_registered{false};
+    ss::metrics::metric_groups _metrics;
 };
 
 inline chunk_cache& chunks() {
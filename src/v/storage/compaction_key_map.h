@@ -0,0 +1,203 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+#include "bytes/bytes.h"
+#include "hashing/xx.h"
+#include "seastarx.h"
+#include "storage/compacted_index.h"
+#include "units.h"
+#include "vassert.h"
+
+#include <seastar/core/temporary_buffer.hh>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <vector>
+
+namespace storage::internal {
+
+/**
+ * Map from compaction keys to a small value, built for holding millions of
+ * keys within the memory budget of a single compaction.
+ *
+ * Keys are copied into an arena of large chunks and the map only keeps a
+ * fixed width entry per key: the 64 bit xxhash fingerprint of the key, the
+ * location of the key in the arena and the value. Lookups are resolved on the
+ * fingerprint and fall back to comparing the full key only when fingerprints
+ * match, so collisions never merge different keys. The hash table itself is a
+ * flat, linearly probed array of entry indices.
+ *
+ * There is no per key erase. Once the budget is used up the owner drains the
+ * map and calls clear(), which keeps the arena chunks for the next round so
+ * that a compaction allocates at most once per chunk.
+ */
+template<typename Value>
+class compaction_key_map {
+public:
+    static constexpr size_t max_key_size = compacted_index::max_entry_size;
+    static constexpr size_t max_chunk_size = 128_KiB;
+    static constexpr size_t min_chunk_size = 4_KiB;
+
+    compaction_key_map() noexcept = default;
+    compaction_key_map(compaction_key_map&&) noexcept = default;
+    compaction_key_map& operator=(compaction_key_map&&) noexcept = default;
+    compaction_key_map(const compaction_key_map&) = delete;
+    compaction_key_map& operator=(const compaction_key_map&) = delete;
+    ~compaction_key_map() noexcept = default;
+
+    /// \brief returns the value of \p key or nullptr if it is not in the map
+    Value* find(bytes_view key) {
+        if (_entries.empty()) {
+            return nullptr;
+        }
+        const auto fp = fingerprint(key);
+        for (size_t i = fp & mask();; i = (i + 1) & mask()) {
+            const auto slot = _table[i];
+            if (slot == empty_slot) {
+                return nullptr;
+            }
+            auto& e = _entries[slot - 1];
+            if (e.fingerprint == fp && key_of(e) == key) {
+                return &e.value;
+            }
+        }
+    }
+
+    /// \brief inserts \p key, which must not be in the map
+    void insert(bytes_view key, Value v) {
+        vassert(
+          key.size() <= max_key_size,
+          "compaction key of {} bytes exceeds max of {}",
+          key.size(),
+          max_key_size);
+        if ((_entries.size() + 1) * 4 > _table.size() * 3) {
+            grow();
+        }
+        const auto fp = fingerprint(key);
+        auto [chunk, offset] = allocate(key);
+        _entries.push_back(entry{
+          .fingerprint = fp,
+          .chunk = chunk,
+          .size = static_cast<uint16_t>(key.size()),
+          .offset = offset,
+          .value = std::move(v),
+        });
+        place(_entries.size(), fp);
+    }
+
+    size_t size() const { return _entries.size(); }
+    bool empty() const { return _entries.empty(); }
+
+    bytes_view key_at(size_t i) const { return key_of(_entries[i]); }
+    Value& value_at(size_t i) { return _entries[i].value; }
+    const Value& value_at(size_t i) const { return _entries[i].value; }
+
+    template<typename Func>
+    void for_each(Func&& f) {
+        for (auto& e : _entries) {
+            f(key_of(e), e.value);
+        }
+    }
+
+    /// \brief bytes of keys, entries and table in use. arena chunks that are
+    /// retained for reuse after clear() are not accounted for
+    size_t memory_usage() const {
+        return _arena_used + _entries.size() * sizeof(entry)
+               + _table.size() * sizeof(uint32_t);
+    }
+
+    /// \brief forgets all keys, keeping the arena and the table allocated
+    void clear() {
+        _entries.clear();
+        std::fill(_table.begin(), _table.end(), empty_slot);
+        _chunk = 0;
+        _chunk_offset = 0;
+        _arena_used = 0;
+    }
+
+private:
+    static constexpr uint32_t empty_slot = 0;
+    static constexpr size_t min_table_size = 16;
+
+    struct entry {
+        uint64_t fingerprint;
+        uint16_t chunk;
+        uint16_t size;
+        uint32_t offset;
+        Value value;
+    };
+
+    static uint64_t fingerprint(bytes_view key) {
+        return xxhash_64(key.data(), key.size());
+    }
+
+    size_t mask() const { return _table.size() - 1; }
+
+    bytes_view key_of(const entry& e) const {
+        return bytes_view(_chunks[e.chunk].get() + e.offset, e.size);
+    }
+
+    /// \brief stores \p idx (entry index + 1) in the first free slot
+    void place(uint32_t idx, uint64_t fp) {
+        size_t i = fp & mask();
+        while (_table[i] != empty_slot) {
+            i = (i + 1) & mask();
+        }
+        _table[i] = idx;
+    }
+
+    void grow() {
+        const auto size = std::max(min_table_size, _table.size() * 2);
+        _table.assign(size, empty_slot);
+        for (size_t i = 0; i < _entries.size(); ++i) {
+            place(i + 1, _entries[i].fingerprint);
+        }
+    }
+
+    /// \brief copies the key into the arena, never across chunks
+    std::pair<uint16_t, uint32_t> allocate(bytes_view key) {
+        while (_chunk < _chunks.size()
+               && _chunks[_chunk].size() - _chunk_offset < key.size()) {
+            _arena_used += _chunks[_chunk].size() - _chunk_offset;
+            ++_chunk;
+            _chunk_offset = 0;
+        }
+        if (_chunk == _chunks.size()) {
+            vassert(
+              _chunks.size() < std::numeric_limits<uint16_t>::max(),
+              "compaction key map arena is full");
+            // chunks double in size so that small maps stay small
+            const size_t last = _chunks.empty() ? 0 : _chunks.back().size();
+            const size_t size = std::clamp(
+              std::max(last * 2, key.size()), min_chunk_size, max_chunk_size);
+            _chunks.emplace_back(size);
+        }
+        const auto chunk = static_cast<uint16_t>(_chunk);
+        const auto offset = static_cast<uint32_t>(_chunk_offset);
+        std::memcpy(
+          _chunks[_chunk].get_write() + _chunk_offset, key.data(), key.size());
+        _chunk_offset += key.size();
+        _arena_used += key.size();
+        return {chunk, offset};
+    }
+
+    std::deque<entry> _entries;
+    std::vector<uint32_t> _table;
+    std::vector<ss::temporary_buffer<uint8_t>> _chunks;
+    size_t _chunk{0};
+    size_t _chunk_offset{0};
+    size_t _arena_used{0};
+};
+
+} // namespace storage::internal
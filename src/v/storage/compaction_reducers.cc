@@ -12,6 +12,7 @@
 #include "compression/compression.h"
 #include "model/record.h"
 #include "model/record_utils.h"
+#include "model/record_view.h"
 #include "random/generators.h"
 #include "storage/index_state.h"
 #include "storage/logger.h"
@@ -24,6 +25,7 @@
 
 #include <absl/algorithm/container.h>
 #include <absl/container/flat_hash_map.h>
+#include <boost/iterator/counting_iterator.hpp>
 #include <boost/range/irange.hpp>
 
 #include <algorithm>
@@ -36,37 +38,25 @@ compaction_key_reducer::operator()(compacted_index::entry&& e) {
     using stop_t = ss::stop_iteration;
     const model::offset o = e.offset + model::offset(e.delta);
 
-    auto it = _indices.find(e.key);
-    if (it != _indices.end()) {
-        if (o > it->second.offset) {
+    if (auto v = _indices.find(e.key); v) {
+        if (o > v->offset) {
             // cannot be std::max() because _natural_index must be preserved
-            it->second.offset = o;
-            it->second.natural_index = _natural_index;
+            v->offset = o;
+            v->natural_index = _natural_index;
         }
     } else {
         // not found - insert
-        auto const key_size = e.key.size();
-        auto const expected_size = [this, key_size] {
-            return idx_mem_usage() + _keys_mem_usage + key_size;
-        };
-
-        // if index allocates to much memory remove some entries.
-        while (expected_size() >= _max_mem && !_indices.empty()) {
-            /**
-             * Evict first entry, we use hash function that guarante good
-             * randomness so evicting first entry is actually evicting a
-             * pseudo random elemnent
-             */
-            auto mit = _indices.begin();
-            _keys_mem_usage -= mit->first.size();
-
-            // write the entry again - we ran out of scratch space
-            _inverted.add(mit->second.natural_index);
-            _indices.erase(mit);
+        if (
+          _indices.memory_usage() + e.key.size() >= _max_mem
+          && !_indices.empty()) {
+            // out of scratch space, keep every entry seen so far and start
+            // over with an empty map
+            _indices.for_each([this](bytes_view, const value_type& v) {
+                _inverted.add(v.natural_index);
+            });
+            _indices.clear();
         }
-        _keys_mem_usage += e.key.size();
-        // 2. do the insertion
-        _indices.emplace(std::move(e.key), value_type(o, _natural_index));
+        _indices.insert(e.key, value_type(o, _natural_index));
     }
 
     ++_natural_index; // MOST important
@@ -75,13 +65,62 @@ compaction_key_reducer::operator()(compacted_index::entry&& e) {
 Roaring compaction_key_reducer::end_of_stream() {
     // TODO: optimization - detect if the index does not need compaction
     // by linear scan of natural_index from 0-N with no gaps.
-    for (auto& e : _indices) {
-        _inverted.add(e.second.natural_index);
-    }
+    _indices.for_each([this](bytes_view, const value_type& v) {
+        _inverted.add(v.natural_index);
+    });
     _inverted.shrinkToFit();
     return std::move(_inverted);
 }
 
+ss::future<ss::stop_iteration>
+key_offset_map_builder_reducer::operator()(compacted_index::entry&& e) {
+    using stop_t = ss::stop_iteration;
+    if (e.type != compacted_index::entry_type::key) {
+        return ss::make_ready_future<stop_t>(stop_t::no);
+    }
+    const model::offset o = e.offset + model::offset(e.delta);
+    if (auto v = _map->find(e.key); v) {
+        *v = std::max(*v, o);
+        return ss::make_ready_future<stop_t>(stop_t::no);
+    }
+    if (_map->memory_usage() + e.key.size() >= _max_mem) {
+        _full = true;
+        return ss::make_ready_future<stop_t>(stop_t::yes);
+    }
+    _map->insert(e.key, o);
+    return ss::make_ready_future<stop_t>(stop_t::no);
+}
+
+ss::future<ss::stop_iteration>
+key_offset_map_filter_reducer::operator()(compacted_index::entry&& e) {
+    using stop_t = ss::stop_iteration;
+    const model::offset o = e.offset + model::offset(e.delta);
+    bool keep = true;
+    if (e.type == compacted_index::entry_type::key) {
+        auto v = _map->find(e.key);
+        keep = !v || *v <= o;
+    }
+    if (keep) {
+        _to_keep.add(_natural_index);
+    }
+    if (!_last || o > _last->first) {
+        _last = std::make_pair(o, _natural_index);
+    }
+    ++_natural_index;
+    return ss::make_ready_future<stop_t>(stop_t::no);
+}
+
+std::optional<Roaring> key_offset_map_filter_reducer::end_of_stream() {
+    if (_last) {
+        _to_keep.add(_last->second);
+    }
+    if (_to_keep.cardinality() == _natural_index) {
+        return std::nullopt;
+    }
+    _to_keep.shrinkToFit();
+    return std::move(_to_keep);
+}
+
 ss::future<ss::stop_iteration>
 index_copy_reducer::operator()(compacted_index::entry&& e) {
     using stop_t = ss::stop_iteration;
@@ -113,17 +152,51 @@ compacted_offset_list_reducer::operator()(compacted_index::entry&& e) {
     return ss::make_ready_future<stop_t>(stop_t::no);
 }
 
+bool copy_data_segment_reducer::is_expired_tombstone(
+  const model::record_batch_header& h, const model::record_view& r) const {
+    if (!_tombstones || r.has_value() || h.attrs.is_control()) {
+        return false;
+    }
+    const auto o = h.base_offset + model::offset(r.offset_delta());
+    if (o >= _tombstones->last_offset) {
+        return false;
+    }
+    auto ts = h.max_timestamp;
+    if (h.attrs.timestamp_type() == model::timestamp_type::create_time) {
+        ts = model::timestamp(h.first_timestamp() + r.timestamp_delta());
+    }
+    return ts < _tombstones->eviction_time;
+}
+
 std::optional<model::record_batch>
 copy_data_segment_reducer::filter(model::record_batch&& batch) {
     // 1. compute which records to keep
     const auto base = batch.base_offset();
     std::vector<int32_t> offset_deltas;
     offset_deltas.reserve(batch.record_count());
-    batch.for_each_record([this, base, &offset_deltas](const model::record& r) {
-        if (should_keep(base, r.offset_delta())) {
-            offset_deltas.push_back(r.offset_delta());
-        }
-    });
+    uint64_t tombstones = 0;
+    uint64_t tombstone_bytes = 0;
+    model::for_each_record_view(
+      batch,
+      [this,
+       base,
+       &h = batch.header(),
+       &offset_deltas,
+       &tombstones,
+       &tombstone_bytes](const model::record_view& r) {
+          if (!should_keep(base, r.offset_delta())) {
+              return;
+          }
+          if (is_expired_tombstone(h, r)) {
+              ++tombstones;
+              tombstone_bytes += r.size_bytes();
+              return;
+          }
+          offset_deltas.push_back(r.offset_delta());
+      });
+    if (tombstones > 0) {
+        _tombstones->probe->tombstones_removed(tombstones, tombstone_bytes);
+    }
 
     // 2. no record to keep
     if (offset_deltas.empty()) {
@@ -140,31 +213,25 @@ copy_data_segment_reducer::filter(model::record_batch&& batch) {
     int32_t rec_count = 0;
     std::optional<int64_t> first_timestamp_delta;
     int64_t last_timestamp_delta;
-    batch.for_each_record([&rec_count,
-                           &first_timestamp_delta,
-                           &last_timestamp_delta,
-                           &ret,
-                           &offset_deltas](model::record record) {
-        // contains the key
-        if (std::count(
-              offset_deltas.begin(),
-              offset_deltas.end(),
-              record.offset_delta())) {
-            /*
-             * TODO when we further optimize lazy record materialization ot
-             * make use of views we can avoid this re-encoding by copying or
-             * sharing the view. either way, we were building
-             * record batch with the uncompressed records so they were being
-             * re-encoded.
-             */
-            if (!first_timestamp_delta) {
-                first_timestamp_delta = record.timestamp_delta();
-            }
-            last_timestamp_delta = record.timestamp_delta();
-            model::append_record_to_buffer(ret, record);
-            ++rec_count;
-        }
-    });
+    model::for_each_record_view(
+      batch,
+      [&rec_count,
+       &first_timestamp_delta,
+       &last_timestamp_delta,
+       &ret,
+       &offset_deltas](const model::record_view& r) {
+          // contains the key
+          if (std::count(
+                offset_deltas.begin(), offset_deltas.end(), r.offset_delta())) {
+              if (!first_timestamp_delta) {
+                  first_timestamp_delta = r.timestamp_delta();
+              }
+              last_timestamp_delta = r.timestamp_delta();
+              // the deltas are kept, copy the record as it is encoded
+              ret.append(r.encoded().copy());
+              ++rec_count;
+          }
+      });
     // From: DefaultRecordBatch.java
     // On Compaction: Unlike the older message formats, magic v2 and above
     // preserves the first and last offset/sequence numbers from the
@@ -285,11 +352,16 @@ index_rebuilder_reducer::operator()(model::record_batch&& b) {
 }
 
 ss::future<> index_rebuilder_reducer::do_index(model::record_batch&& b) {
-    return ss::do_with(std::move(b), [this](model::record_batch& b) {
-        return model::for_each_record(
-          b, [this, o = b.base_offset()](model::record& r) {
-              return _w->index(r.key(), o, r.offset_delta());
-          });
-    });
+    // only the keys are indexed, don't materialize the records
+    return ss::do_with(
+      model::parse_record_batch_keys(b),
+      [this, o = b.base_offset()](model::record_batch_keys& k) {
+          return ss::do_for_each(
+            boost::counting_iterator<size_t>(0),
+            boost::counting_iterator<size_t>(k.size()),
+            [this, o, &k](size_t i) {
+                return _w->index(k.keys[i], o, k.offset_deltas[i]);
+            });
+      });
 }
 } // namespace storage::internal
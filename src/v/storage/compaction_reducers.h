@@ -12,18 +12,19 @@
 #pragma once
 
 #include "bytes/bytes.h"
-#include "hashing/xx.h"
 #include "model/record_batch_reader.h"
+#include "model/record_view.h"
 #include "storage/compacted_index.h"
 #include "storage/compacted_index_writer.h"
 #include "storage/compacted_offset_list.h"
+#include "storage/compaction_key_map.h"
 #include "storage/index_state.h"
 #include "storage/logger.h"
+#include "storage/probe.h"
 #include "storage/segment_appender.h"
 #include "units.h"
 
 #include <absl/container/btree_map.h>
-#include <absl/container/node_hash_map.h>
 #include <fmt/core.h>
 #include <roaring/roaring.hh>
 
@@ -41,11 +42,7 @@ public:
         model::offset offset;
         uint32_t natural_index;
     };
-    using underlying_t = absl::node_hash_map<
-      bytes,
-      value_type,
-      bytes_hasher<uint64_t, xxhash_64>,
-      bytes_type_eq>;
+    using underlying_t = compaction_key_map<value_type>;
 
     explicit compaction_key_reducer(size_t max_mem = default_max_memory_usage)
       : _max_mem(max_mem) {}
@@ -54,18 +51,53 @@ public:
     Roaring end_of_stream();
 
 private:
-    size_t idx_mem_usage() {
-        using debug = absl::container_internal::hashtable_debug_internal::
-          HashtableDebugAccess<underlying_t>;
-        return debug::AllocatedByteSize(_indices);
-    }
     Roaring _inverted;
     underlying_t _indices;
-    size_t _keys_mem_usage{0};
     size_t _max_mem{0};
     uint32_t _natural_index{0};
 };
 
+/// Map from every key of a log to the offset of its latest record
+using key_offset_map = compaction_key_map<model::offset>;
+
+/// Adds the keys of a compacted index to a key_offset_map. Stops once the
+/// map would grow past its memory budget, the keys added until then are
+/// still valid.
+class key_offset_map_builder_reducer : public compaction_reducer {
+public:
+    key_offset_map_builder_reducer(key_offset_map& m, size_t max_mem) noexcept
+      : _map(&m)
+      , _max_mem(max_mem) {}
+
+    ss::future<ss::stop_iteration> operator()(compacted_index::entry&&);
+    /// \brief returns true if the map ran out of memory
+    bool end_of_stream() const { return _full; }
+
+private:
+    key_offset_map* _map;
+    size_t _max_mem;
+    bool _full{false};
+};
+
+/// Produces the natural index of the entries of a compacted index that are
+/// not superseded by a newer record of the same key in a key_offset_map, or
+/// nullopt if every entry is kept. The entry with the highest offset is always
+/// kept so that the offset range of the segment does not shrink.
+class key_offset_map_filter_reducer : public compaction_reducer {
+public:
+    explicit key_offset_map_filter_reducer(const key_offset_map& m) noexcept
+      : _map(&m) {}
+
+    ss::future<ss::stop_iteration> operator()(compacted_index::entry&&);
+    std::optional<Roaring> end_of_stream();
+
+private:
+    const key_offset_map* _map;
+    Roaring _to_keep;
+    uint32_t _natural_index{0};
+    std::optional<std::pair<model::offset, uint32_t>> _last;
+};
+
 /// This class copies the input reader into the writer consulting the bitmap of
 /// wether ot keep the entry or not
 class index_filtered_copy_reducer : public compaction_reducer {
@@ -107,11 +139,24 @@ private:
     compacted_offset_list _list;
 };
 
+/// Drops tombstones, records without a value, whose timestamp is older than
+/// eviction_time. The record at last_offset is always kept so that the
+/// segment keeps its offset range.
+struct tombstone_filter {
+    model::timestamp eviction_time;
+    model::offset last_offset;
+    storage::probe* probe;
+};
+
 class copy_data_segment_reducer : public compaction_reducer {
 public:
-    copy_data_segment_reducer(compacted_offset_list l, segment_appender* a)
+    copy_data_segment_reducer(
+      compacted_offset_list l,
+      segment_appender* a,
+      std::optional<tombstone_filter> t = std::nullopt)
       : _list(std::move(l))
-      , _appender(a) {}
+      , _appender(a)
+      , _tombstones(t) {}
 
     ss::future<ss::stop_iteration> operator()(model::record_batch&&);
     storage::index_state end_of_stream() { return std::move(_idx); }
@@ -124,10 +169,13 @@ private:
         const auto o = base + model::offset(delta);
         return _list.contains(o);
     }
+    bool is_expired_tombstone(
+      const model::record_batch_header&, const model::record_view&) const;
     std::optional<model::record_batch> filter(model::record_batch&&);
 
     compacted_offset_list _list;
     segment_appender* _appender;
+    std::optional<tombstone_filter> _tombstones;
     index_state _idx;
     size_t _acc{0};
 };
@@ -0,0 +1,184 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/compaction_scheduler.h"
+
+#include "config/configuration.h"
+#include "prometheus/prometheus_sanitize.h"
+#include "storage/logger.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/loop.hh>
+#include <seastar/core/metrics.hh>
+#include <seastar/core/semaphore.hh>
+#include <seastar/core/sleep.hh>
+
+#include <algorithm>
+#include <numeric>
+
+namespace storage::internal {
+
+void compaction_scheduler::start() { setup_metrics(); }
+
+ss::future<> compaction_scheduler::stop() {
+    return _gate.close().then([this] { _metrics.clear(); });
+}
+
+ss::future<> compaction_scheduler::run(
+  std::vector<log> logs, compaction_config cfg, is_managed_t is_managed) {
+    return ss::with_gate(
+      _gate,
+      [this,
+       logs = std::move(logs),
+       cfg,
+       is_managed = std::move(is_managed)]() mutable {
+          return do_run(std::move(logs), cfg, std::move(is_managed));
+      });
+}
+
+ss::future<> compaction_scheduler::do_run(
+  std::vector<log> logs, compaction_config cfg, is_managed_t is_managed) {
+    std::vector<candidate> candidates;
+    candidates.reserve(logs.size());
+    for (auto& l : logs) {
+        const auto backlog = l.compaction_backlog();
+        const auto size = l.size_bytes();
+        candidates.push_back(candidate{
+          .handle = std::move(l),
+          .backlog = backlog,
+          .dirty_ratio = size == 0 ? 0.0 : double(backlog) / double(size),
+        });
+    }
+    // dirtiest logs first. the sort is stable so that logs with no backlog,
+    // which still need garbage collection, keep their order
+    std::stable_sort(
+      candidates.begin(),
+      candidates.end(),
+      [](const candidate& a, const candidate& b) {
+          return a.dirty_ratio > b.dirty_ratio;
+      });
+    _backlog = std::accumulate(
+      candidates.begin(),
+      candidates.end(),
+      size_t(0),
+      [](size_t acc, const candidate& c) { return acc + c.backlog; });
+
+    // waiters are served in fifo order which preserves the ordering above
+    ss::semaphore concurrency(std::max<size_t>(
+      config::shard_local_cfg().compaction_max_concurrency(), 1));
+    co_await ss::parallel_for_each(
+      candidates,
+      [this, &cfg, &concurrency, &is_managed](
+        candidate& c) -> ss::future<> {
+          auto units = co_await ss::get_units(concurrency, 1);
+          if (cfg.asrc->abort_requested() || !is_managed(c.handle)) {
+              co_return;
+          }
+          if (c.backlog > 0 && !cfg.skip_compaction) {
+              co_await acquire_budget(c.backlog, *cfg.asrc);
+              // the log may have been removed while waiting for budget
+              if (!is_managed(c.handle)) {
+                  co_return;
+              }
+          }
+          co_await compact(c, cfg);
+      });
+}
+
+ss::future<>
+compaction_scheduler::compact(candidate& c, const compaction_config& cfg) {
+    const auto before = c.handle.size_bytes();
+    co_await c.handle.compact(cfg);
+    const auto after = c.handle.size_bytes();
+    const auto reclaimed = before > after ? before - after : 0;
+    ++_compactions;
+    _reclaimed_bytes += reclaimed;
+    _backlog -= std::min(_backlog, c.backlog);
+    vlog(
+      stlog.trace,
+      "Compacted {} dirty_ratio:{} backlog:{} reclaimed:{}",
+      c.handle.config().ntp(),
+      c.dirty_ratio,
+      c.backlog,
+      reclaimed);
+}
+
+void compaction_scheduler::refill_budget(double rate) {
+    const auto now = clock_type::now();
+    const auto elapsed = std::chrono::duration<double>(now - _last_refill);
+    _last_refill = now;
+    // allow bursts of up to one second worth of budget
+    _tokens = std::min(rate, _tokens + elapsed.count() * rate);
+}
+
+ss::future<>
+compaction_scheduler::acquire_budget(size_t bytes, ss::abort_source& as) {
+    const auto rate = double(
+      config::shard_local_cfg().compaction_io_budget_bytes_per_sec());
+    if (rate <= 0) {
+        co_return;
+    }
+    refill_budget(rate);
+    /*
+     * the budget goes into debt by the full cost of a compaction so that
+     * compacting a segment larger than the bucket is still admitted, and the
+     * following compactions wait until the debt is paid back.
+     */
+    while (_tokens < 0) {
+        ++_budget_waits;
+        const auto wait = std::chrono::duration<double>(-_tokens / rate);
+        co_await ss::sleep_abortable(
+          std::chrono::duration_cast<std::chrono::milliseconds>(wait)
+            + std::chrono::milliseconds(1),
+          as);
+        refill_budget(rate);
+    }
+    _tokens -= double(bytes);
+}
+
+void compaction_scheduler::setup_metrics() {
+    if (config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+    namespace sm = ss::metrics;
+    const std::vector<sm::label_instance> labels = {
+      sm::label("directory")(_data_dir),
+    };
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("storage:compaction"),
+      {
+        sm::make_gauge(
+          "backlog_bytes",
+          [this] { return _backlog; },
+          sm::description("Bytes of closed segments waiting to be compacted "
+                          "as of the last housekeeping round"),
+          labels),
+        sm::make_total_bytes(
+          "reclaimed_bytes",
+          [this] { return _reclaimed_bytes; },
+          sm::description("Total number of bytes reclaimed by compaction and "
+                          "garbage collection"),
+          labels),
+        sm::make_derive(
+          "compactions",
+          [this] { return _compactions; },
+          sm::description("Number of log compactions"),
+          labels),
+        sm::make_derive(
+          "budget_waits",
+          [this] { return _budget_waits; },
+          sm::description("Number of times a compaction waited for i/o "
+                          "budget"),
+          labels),
+      });
+}
+
+} // namespace storage::internal
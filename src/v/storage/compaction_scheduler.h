@@ -0,0 +1,97 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+#include "seastarx.h"
+#include "storage/log.h"
+#include "storage/types.h"
+
+#include <seastar/core/abort_source.hh>
+#include <seastar/core/future.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/core/sstring.hh>
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+namespace storage::internal {
+
+/**
+ * Shard wide scheduling of log compaction.
+ *
+ * A housekeeping round hands all of its logs to run(). They are compacted in
+ * descending order of dirtiness, i.e. the ratio of bytes awaiting compaction
+ * to the size of the log, with up to compaction_max_concurrency logs being
+ * compacted at the same time. Every compaction is admitted against a token
+ * bucket that refills at compaction_io_budget_bytes_per_sec and is charged the
+ * backlog of the log being compacted, which bounds the average compaction
+ * bandwidth of the shard on top of the compaction priority class.
+ *
+ * Each log_manager owns the scheduler of its shard and stops it after its
+ * housekeeping is done, the round in progress is awaited. The metrics are
+ * labelled with the data directory of the log_manager, so that more than one
+ * of them may live on a shard.
+ */
+class compaction_scheduler {
+public:
+    using is_managed_t = std::function<bool(const log&)>;
+
+    explicit compaction_scheduler(ss::sstring data_dir) noexcept
+      : _data_dir(std::move(data_dir)) {}
+    compaction_scheduler(compaction_scheduler&&) = delete;
+    compaction_scheduler& operator=(compaction_scheduler&&) = delete;
+    compaction_scheduler(const compaction_scheduler&) = delete;
+    compaction_scheduler& operator=(const compaction_scheduler&) = delete;
+    ~compaction_scheduler() noexcept = default;
+
+    void start();
+    ss::future<> stop();
+
+    /// \brief runs one housekeeping round over \p logs. a log is skipped if
+    /// \p is_managed returns false for it by the time its turn comes. fails
+    /// with ss::gate_closed_exception once the scheduler is stopped.
+    ss::future<>
+    run(std::vector<log> logs, compaction_config cfg, is_managed_t is_managed);
+
+    size_t backlog() const { return _backlog; }
+    uint64_t reclaimed_bytes() const { return _reclaimed_bytes; }
+    uint64_t compactions() const { return _compactions; }
+
+private:
+    using clock_type = ss::lowres_clock;
+
+    struct candidate {
+        log handle;
+        size_t backlog;
+        double dirty_ratio;
+    };
+
+    ss::future<> do_run(std::vector<log>, compaction_config, is_managed_t);
+    ss::future<> compact(candidate&, const compaction_config&);
+    ss::future<> acquire_budget(size_t bytes, ss::abort_source&);
+    void refill_budget(double rate);
+    void setup_metrics();
+
+    ss::sstring _data_dir;
+    size_t _backlog{0};
+    uint64_t _reclaimed_bytes{0};
+    uint64_t _compactions{0};
+    uint64_t _budget_waits{0};
+    double _tokens{0};
+    clock_type::time_point _last_refill{clock_type::now()};
+    ss::gate _gate;
+    ss::metrics::metric_groups _metrics;
+};
+
+} // namespace storage::internal
@@ -0,0 +1,91 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/decompression_stage.h"
+
+#include "compression/compression.h"
+#include "config/configuration.h"
+#include "prometheus/prometheus_sanitize.h"
+#include "storage/parser_utils.h"
+
+#include <seastar/core/gate.hh>
+#include <seastar/core/later.hh>
+#include <seastar/core/metrics.hh>
+#include <seastar/core/with_scheduling_group.hh>
+
+namespace storage::internal {
+
+void decompression_stage::start(std::optional<ss::scheduling_group> sg) {
+    _sg = sg;
+    setup_metrics();
+}
+
+ss::future<> decompression_stage::stop() {
+    return _gate.close().then([this] { _metrics.clear(); });
+}
+
+model::record_batch
+decompression_stage::do_decompress(const model::record_batch& b) {
+    auto m = _latency.auto_measure();
+    iobuf body_buf = compression::compressor::uncompress(
+      b.data(), b.header().attrs.compression());
+    ++_batches;
+    _compressed_bytes += b.data().size_bytes();
+    // must remove compression first!
+    auto h = b.header();
+    h.attrs.remove_compression();
+    reset_size_checksum_metadata(h, body_buf);
+    return model::record_batch(
+      h, std::move(body_buf), model::record_batch::tag_ctor_ng{});
+}
+
+ss::future<model::record_batch>
+decompression_stage::decompress(const model::record_batch& b) {
+    if (b.data().size_bytes() < inline_threshold || _gate.is_closed()) {
+        return ss::make_ready_future<model::record_batch>(do_decompress(b));
+    }
+    ++_deferred;
+    auto sg = _sg.value_or(ss::current_scheduling_group());
+    return ss::with_gate(_gate, [this, sg, &b] {
+        return ss::with_scheduling_group(sg, [this, &b]() {
+            // the codec does not yield until the whole batch is decompressed
+            return ss::later().then([this, &b] { return do_decompress(b); });
+        });
+    });
+}
+
+void decompression_stage::setup_metrics() {
+    if (config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+    namespace sm = ss::metrics;
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("storage:decompression"),
+      {
+        sm::make_derive(
+          "batches",
+          [this] { return _batches; },
+          sm::description("Number of batches decompressed")),
+        sm::make_derive(
+          "deferred_batches",
+          [this] { return _deferred; },
+          sm::description(
+            "Number of batches decompressed in the background group")),
+        sm::make_derive(
+          "compressed_bytes",
+          [this] { return _compressed_bytes; },
+          sm::description("Number of compressed bytes decompressed")),
+        sm::make_histogram(
+          "latency_us",
+          [this] { return _latency.seastar_histogram_logform(); },
+          sm::description("Decompression latency of a batch")),
+      });
+}
+
+} // namespace storage::internal
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+#include "model/record.h"
+#include "seastarx.h"
+#include "units.h"
+#include "utils/hdr_hist.h"
+
+#include <seastar/core/future.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/core/scheduling.hh>
+
+#include <cstdint>
+#include <optional>
+
+namespace storage::internal {
+
+/**
+ * Shard wide stage decompressing the batches of the background consumers,
+ * compaction and coproc, that need their records.
+ *
+ * Codecs run to completion once started, a large zstd batch can hold the
+ * reactor for milliseconds. Batches above the inline threshold are handed to
+ * the stage scheduling group and yield before the codec starts, so tasks
+ * queued behind them run in between large batches and the group shares
+ * bound the cpu they take. Smaller batches are decompressed right away.
+ *
+ * The stage is reached through decompressions() from the parsers of every
+ * layer, the application starts it on each shard and stops it on shutdown.
+ * Once stopped, the deferred decompressions are awaited and any batch is
+ * decompressed inline.
+ */
+class decompression_stage {
+public:
+    /// compressed bytes a batch needs to have to be decompressed in the
+    /// stage scheduling group
+    static constexpr size_t inline_threshold = 32_KiB;
+
+    decompression_stage() noexcept = default;
+    decompression_stage(decompression_stage&&) = delete;
+    decompression_stage& operator=(decompression_stage&&) = delete;
+    decompression_stage(const decompression_stage&) = delete;
+    decompression_stage& operator=(const decompression_stage&) = delete;
+    ~decompression_stage() noexcept = default;
+
+    /// \brief large batches are decompressed in \p sg, in the group of the
+    /// caller if it is not set
+    void start(std::optional<ss::scheduling_group> sg = std::nullopt);
+    ss::future<> stop();
+
+    /// \brief the batch must be compressed and stay alive until the returned
+    /// future resolves
+    ss::future<model::record_batch> decompress(const model::record_batch&);
+
+    const hdr_hist& latency() const { return _latency; }
+    uint64_t decompressed_batches() const { return _batches; }
+    uint64_t deferred_batches() const { return _deferred; }
+
+private:
+    model::record_batch do_decompress(const model::record_batch&);
+    void setup_metrics();
+
+    std::optional<ss::scheduling_group> _sg;
+    hdr_hist _latency;
+    uint64_t _batches{0};
+    uint64_t _deferred{0};
+    uint64_t _compressed_bytes{0};
+    ss::gate _gate;
+    ss::metrics::metric_groups _metrics;
+};
+
+/// \brief the stage of the shard
+inline decompression_stage& decompressions() {
+    static thread_local decompression_stage stage;
+    return stage;
+}
+
+} // namespace storage::internal
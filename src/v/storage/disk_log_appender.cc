@@ -63,39 +63,52 @@ bool disk_log_appender::needs_to_roll_log(model::term_id batch_term) const {
 }
 
 void disk_log_appender::release_lock() {
+    _pending.clear();
+    _pending_bytes = 0;
     _seg = nullptr;
     _seg_lock = std::nullopt;
     _bytes_left_in_segment = 0;
 }
 
+bool disk_log_appender::needs_flush_before(
+  const model::record_batch& batch) const {
+    return !_pending.empty()
+           && (_last_term != batch.term() || needs_to_roll_log(batch.term())
+               || _pending_bytes + batch.size_bytes() > max_coalesced_bytes);
+}
+
 ss::future<ss::stop_iteration>
 disk_log_appender::operator()(model::record_batch& batch) {
     batch.header().base_offset = _idx;
     batch.header().header_crc = model::internal_header_only_crc(batch.header());
-    if (_last_term != batch.term()) {
-        release_lock();
-    }
-    _last_term = batch.term();
-    auto f = ss::make_ready_future<>();
-    if (unlikely(needs_to_roll_log(batch.term()))) {
-        f = ss::do_until(
-          [this, term = batch.term()] {
-              // we might actually have space in the current log, but the terms
-              // do not match for the current append, so we must roll
-              return !needs_to_roll_log(term)
-                     // we might have gotten the lock, but in a concurrency
-                     // situation - say a segment eviction we need to double
-                     // check that _after_ we got the lock, the segment wasn't
-                     // somehow closed before the append
-                     && _bytes_left_in_segment > 0;
-          },
-          [this] {
-              release_lock();
-              return _log.maybe_roll(_last_term, _idx, _config.io_priority)
-                .then([this] { return initialize(); });
-          });
-    }
+    // the pending range must reach its segment before the lock is released
+    auto f = needs_flush_before(batch) ? flush_pending() : ss::now();
     return f
+      .then([this, &batch] {
+          if (_last_term != batch.term()) {
+              release_lock();
+          }
+          _last_term = batch.term();
+          if (likely(!needs_to_roll_log(batch.term()))) {
+              return ss::now();
+          }
+          return ss::do_until(
+            [this, term = batch.term()] {
+                // we might actually have space in the current log, but the
+                // terms do not match for the current append, so we must roll
+                return !needs_to_roll_log(term)
+                       // we might have gotten the lock, but in a concurrency
+                       // situation - say a segment eviction we need to double
+                       // check that _after_ we got the lock, the segment
+                       // wasn't somehow closed before the append
+                       && _bytes_left_in_segment > 0;
+            },
+            [this] {
+                release_lock();
+                return _log.maybe_roll(_last_term, _idx, _config.io_priority)
+                  .then([this] { return initialize(); });
+            });
+      })
       .then([this, &batch]() mutable { return append_batch_to_segment(batch); })
       .handle_exception([this](std::exception_ptr e) {
           release_lock();
@@ -106,7 +119,7 @@ disk_log_appender::operator()(model::record_batch& batch) {
 }
 
 ss::future<ss::stop_iteration>
-disk_log_appender::append_batch_to_segment(const model::record_batch& batch) {
+disk_log_appender::append_batch_to_segment(model::record_batch& batch) {
     // ghost batch handling, it doesn't happen often so we can use unlikely
     if (unlikely(batch.header().type == storage::ghost_record_batch_type)) {
         _idx = batch.last_offset() + model::offset(1); // next base offset
@@ -114,35 +127,63 @@ disk_log_appender::append_batch_to_segment(const model::record_batch& batch) {
         return ss::make_ready_future<ss::stop_iteration>(
           ss::stop_iteration::no);
     }
-    return _seg->append(batch).then([this](append_result r) {
-        _idx = r.last_offset + model::offset(1); // next base offset
-        _byte_size += r.byte_size;
-        // do not track base_offset, only the last one
-        _last_offset = r.last_offset;
-        auto& p = _log.get_probe();
-        p.add_bytes_written(r.byte_size);
-        p.batch_written();
-        // substract the bytes from the append
-        // take the min because _bytes_left_in_segment is optimistic
-        _bytes_left_in_segment -= std::min(_bytes_left_in_segment, r.byte_size);
-        return ss::stop_iteration::no;
-    });
+    // offsets are assigned here, the bytes are accounted for once written
+    _idx = batch.last_offset() + model::offset(1); // next base offset
+    // do not track base_offset, only the last one
+    _last_offset = batch.last_offset();
+    const size_t size = batch.size_bytes();
+    // substract the bytes from the append
+    // take the min because _bytes_left_in_segment is optimistic
+    _bytes_left_in_segment -= std::min(_bytes_left_in_segment, size);
+    _pending_bytes += size;
+    _pending.push_back(batch.share());
+    if (_pending_bytes < max_coalesced_bytes) {
+        return ss::make_ready_future<ss::stop_iteration>(
+          ss::stop_iteration::no);
+    }
+    return flush_pending().then([] { return ss::stop_iteration::no; });
 }
 
-ss::future<append_result> disk_log_appender::end_of_stream() {
-    auto retval = append_result{
-      .append_time = _append_time,
-      .base_offset = _base_offset,
-      .last_offset = _last_offset,
-      .byte_size = _byte_size,
-      .last_term = _last_term};
-    if (_config.should_fsync == storage::log_append_config::fsync::no) {
-        return ss::make_ready_future<append_result>(retval);
+ss::future<> disk_log_appender::flush_pending() {
+    if (_pending.empty()) {
+        return ss::now();
     }
-    return _log.flush().then([this, retval] {
-        release_lock();
-        return retval;
-    });
+    const auto batches = _pending.size();
+    _pending_bytes = 0;
+    return _seg->append(std::exchange(_pending, {}))
+      .then([this, batches](append_result r) {
+          _byte_size += r.byte_size;
+          auto& p = _log.get_probe();
+          p.add_bytes_written(r.byte_size);
+          for (size_t i = 0; i < batches; ++i) {
+              p.batch_written();
+          }
+      });
+}
+
+ss::future<append_result> disk_log_appender::end_of_stream() {
+    return flush_pending()
+      .then([this] {
+          auto retval = append_result{
+            .append_time = _append_time,
+            .base_offset = _base_offset,
+            .last_offset = _last_offset,
+            .byte_size = _byte_size,
+            .last_term = _last_term};
+          if (_config.should_fsync == storage::log_append_config::fsync::no) {
+              return ss::make_ready_future<append_result>(retval);
+          }
+          return _log.flush().then([this, retval] {
+              release_lock();
+              return retval;
+          });
+      })
+      .handle_exception([this](std::exception_ptr e) {
+          release_lock();
+          vlog(stlog.info, "Could not append batch: {} - {}", e, *this);
+          _log.get_probe().batch_write_error(e);
+          return ss::make_exception_future<append_result>(e);
+      });
 }
 
 std::ostream& operator<<(std::ostream& o, const disk_log_appender& a) {
@@ -152,6 +193,8 @@ std::ostream& operator<<(std::ostream& o, const disk_log_appender& a) {
              << ", _base_offset:" << a._base_offset
              << ", _last_offset:" << a._last_offset
              << ", _last_term:" << a._last_term
-             << ", _byte_size:" << a._byte_size << "}";
+             << ", _byte_size:" << a._byte_size
+             << ", _pending_batches:" << a._pending.size()
+             << ", _pending_bytes:" << a._pending_bytes << "}";
 }
 } // namespace storage
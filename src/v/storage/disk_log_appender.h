@@ -13,15 +13,29 @@
 
 #include "storage/log_appender.h"
 #include "storage/segment.h"
+#include "storage/segment_index.h"
 
 #include <seastar/core/rwlock.hh>
 
+#include <vector>
+
 namespace storage {
 
 class disk_log_impl;
 
+/*
+ * Batches of one append are not written one at a time. They are gathered into
+ * a range of contiguous batches that is written to the active segment with a
+ * single append once it reaches the index step, when the segment has to roll
+ * or the term changes, and at the end of the stream. The range is bounded by
+ * the index step so that tracking it as one index entry keeps the index as
+ * dense as tracking every batch.
+ */
 class disk_log_appender final : public log_appender::impl {
 public:
+    static constexpr size_t max_coalesced_bytes
+      = segment_index::default_data_buffer_step;
+
     disk_log_appender(
       disk_log_impl& log,
       log_append_config config,
@@ -40,8 +54,10 @@ public:
 private:
     bool needs_to_roll_log(model::term_id) const;
     void release_lock();
+    bool needs_flush_before(const model::record_batch&) const;
     ss::future<ss::stop_iteration>
-    append_batch_to_segment(const model::record_batch&);
+    append_batch_to_segment(model::record_batch&);
+    ss::future<> flush_pending();
     ss::future<> initialize();
 
     disk_log_impl& _log;
@@ -53,6 +69,10 @@ private:
     std::optional<ss::rwlock::holder> _seg_lock;
     size_t _bytes_left_in_segment{0};
 
+    /// batches waiting to be written to _seg
+    std::vector<model::record_batch> _pending;
+    size_t _pending_bytes{0};
+
     // below are just copied from append
     model::offset _base_offset;
     model::offset _last_offset;
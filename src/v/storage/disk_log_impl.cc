@@ -15,8 +15,10 @@
 #include "model/timeout_clock.h"
 #include "reflection/adl.h"
 #include "storage/disk_log_appender.h"
+#include "storage/fs_utils.h"
 #include "storage/kvstore.h"
 #include "storage/log_manager.h"
+#include "storage/log_replayer.h"
 #include "storage/logger.h"
 #include "storage/offset_assignment.h"
 #include "storage/offset_to_filepos_consumer.h"
@@ -37,6 +39,7 @@
 #include <seastar/core/seastar.hh>
 #include <seastar/core/semaphore.hh>
 #include <seastar/core/shared_ptr.hh>
+#include <seastar/core/thread.hh>
 
 #include <fmt/format.h>
 
@@ -47,13 +50,19 @@ using namespace std::literals::chrono_literals;
 namespace storage {
 
 disk_log_impl::disk_log_impl(
-  ntp_config cfg, log_manager& manager, segment_set segs, kvstore& kvstore)
+  ntp_config cfg,
+  log_manager& manager,
+  segment_set segs,
+  kvstore& kvstore,
+  const recovery_timings& timings)
   : log::impl(std::move(cfg))
   , _manager(manager)
   , _segs(std::move(segs))
   , _kvstore(kvstore)
   , _start_offset(read_start_offset())
   , _lock_mngr(_segs)
+  , _readers_cache(std::make_unique<readers_cache>(
+      config().ntp(), _manager.config().readers_cache_eviction_timeout, _probe))
   , _max_segment_size(internal::jitter_segment_size(max_segment_size())) {
     const bool is_compacted = config().is_compacted();
     for (auto& s : _segs) {
@@ -63,6 +72,7 @@ disk_log_impl::disk_log_impl(
         }
     }
     _probe.initial_segments_count(_segs.size());
+    _probe.set_recovery_timings(timings);
     _probe.setup_metrics(this->config().ntp());
 }
 disk_log_impl::~disk_log_impl() {
@@ -72,18 +82,21 @@ disk_log_impl::~disk_log_impl() {
 ss::future<> disk_log_impl::remove() {
     vassert(!_closed, "Invalid double closing of log - {}", *this);
     _closed = true;
-    // gets all the futures started in the background
-    std::vector<ss::future<>> permanent_delete;
-    permanent_delete.reserve(_segs.size());
-    while (!_segs.empty()) {
-        auto s = _segs.back();
-        _segs.pop_back();
-        permanent_delete.emplace_back(
-          remove_segment_permanently(s, "disk_log_impl::remove()"));
-    }
-    // wait for all futures
-    return ss::when_all_succeed(
-             permanent_delete.begin(), permanent_delete.end())
+    return _readers_cache->stop()
+      .then([this] {
+          // gets all the futures started in the background
+          std::vector<ss::future<>> permanent_delete;
+          permanent_delete.reserve(_segs.size());
+          while (!_segs.empty()) {
+              auto s = _segs.back();
+              _segs.pop_back();
+              permanent_delete.emplace_back(
+                remove_segment_permanently(s, "disk_log_impl::remove()"));
+          }
+          // wait for all futures
+          return ss::when_all_succeed(
+            permanent_delete.begin(), permanent_delete.end());
+      })
       .then([this]() {
           vlog(stlog.info, "Finished removing all segments:{}", config());
       })
@@ -101,9 +114,11 @@ ss::future<> disk_log_impl::close() {
       && !_eviction_monitor->promise.get_future().available()) {
         _eviction_monitor->promise.set_exception(segment_closed_exception());
     }
-    return ss::parallel_for_each(_segs, [](ss::lw_shared_ptr<segment>& h) {
-        return h->close().handle_exception([h](std::exception_ptr e) {
-            vlog(stlog.error, "Error closing segment:{} - {}", e, h);
+    return _readers_cache->stop().then([this] {
+        return ss::parallel_for_each(_segs, [](ss::lw_shared_ptr<segment>& h) {
+            return h->close().handle_exception([h](std::exception_ptr e) {
+                vlog(stlog.error, "Error closing segment:{} - {}", e, h);
+            });
         });
     });
 }
@@ -251,6 +266,19 @@ ss::future<> disk_log_impl::garbage_collect_oldest_segments(
     return garbage_collect_segments(max_offset, as, "gc[time_based_retention]");
 }
 
+compaction_config disk_log_impl::segment_compaction_config(
+  compaction_config cfg, const segment_set::type& seg) const {
+    /*
+     * a tombstone can only be removed once no older record of its key is left
+     * in the log. only the oldest segment guarantees this, since compacting
+     * it already removed the older records of its keys
+     */
+    if (is_front_segment(seg)) {
+        cfg.tombstone_eviction_time = cfg.eviction_time;
+    }
+    return cfg;
+}
+
 ss::future<> disk_log_impl::do_compact(compaction_config cfg) {
     /*
      * single segment compaction
@@ -265,10 +293,22 @@ ss::future<> disk_log_impl::do_compact(compaction_config cfg) {
         auto f = _stm_manager->ensure_snapshot_exists(
           seg->offsets().committed_offset);
 
-        return f.then([this, seg, cfg]() {
-            return storage::internal::self_compact_segment(seg, cfg, _probe)
-              .finally([seg] { seg->mark_as_finished_self_compaction(); });
-        });
+        return f
+          .then([this, seg] {
+              return _readers_cache->evict_range(
+                seg->offsets().base_offset, seg->offsets().dirty_offset);
+          })
+          .then([this, seg, cfg](readers_cache::range_lock_holder h) {
+              return storage::internal::self_compact_segment(
+                       seg, segment_compaction_config(cfg, seg), _probe)
+                .finally([seg, h = std::move(h)] {
+                    seg->mark_as_finished_self_compaction();
+                });
+          });
+    }
+
+    if (auto segments = find_deduplication_range(); !segments.empty()) {
+        return deduplicate_segments(std::move(segments), cfg);
     }
 
     if (auto range = find_compaction_range(); range) {
@@ -278,6 +318,99 @@ ss::future<> disk_log_impl::do_compact(compaction_config cfg) {
     return ss::now();
 }
 
+std::vector<ss::lw_shared_ptr<segment>>
+disk_log_impl::find_deduplication_range() const {
+    /*
+     * cross segment deduplication.
+     *
+     * once every closed segment is self compacted, the keys of all of them are
+     * collected into one key to offset map, newest segment first, and the
+     * older segments are rewritten without the records that the map shows to
+     * be overwritten later in the log. a pass only runs if new segments were
+     * self compacted since the previous one.
+     */
+    std::vector<ss::lw_shared_ptr<segment>> segments;
+    if (_manager.config().compaction_key_map_memory == 0) {
+        return segments;
+    }
+    for (auto it = _segs.rbegin(); it != _segs.rend(); ++it) {
+        auto& seg = *it;
+        if (
+          seg->has_appender() || !seg->is_compacted_segment()
+          || !seg->finished_self_compaction()) {
+            continue;
+        }
+        segments.push_back(seg);
+    }
+    if (
+      segments.size() < 2
+      || segments.front()->offsets().dirty_offset
+           <= _last_deduplicated_offset) {
+        segments.clear();
+    }
+    return segments;
+}
+
+ss::future<> disk_log_impl::deduplicate_segments(
+  std::vector<ss::lw_shared_ptr<segment>> segments, compaction_config cfg) {
+    const auto newest = segments.front()->offsets().dirty_offset;
+    internal::key_offset_map map;
+    const bool full = co_await internal::build_key_offset_map(
+      segments, map, _manager.config().compaction_key_map_memory, cfg);
+    vlog(
+      stlog.debug,
+      "Deduplicating {} segments of {} with {} keys, map full: {}",
+      segments.size(),
+      config().ntp(),
+      map.size(),
+      full);
+
+    // the newest segment cannot have records that are overwritten later
+    size_t rewritten = 0;
+    for (auto it = std::next(segments.begin()); it != segments.end(); ++it) {
+        if (cfg.asrc->abort_requested()) {
+            co_return;
+        }
+        auto seg = *it;
+        if (seg->is_closed()) {
+            continue;
+        }
+        co_await _stm_manager->ensure_snapshot_exists(
+          seg->offsets().committed_offset);
+        auto cache_lock = co_await _readers_cache->evict_range(
+          seg->offsets().base_offset, seg->offsets().dirty_offset);
+        if (co_await internal::deduplicate_segment(
+              seg, map, segment_compaction_config(cfg, seg), _probe)) {
+            ++rewritten;
+        }
+    }
+    _last_deduplicated_offset = newest;
+    vlog(
+      stlog.debug,
+      "Deduplicated {} of {} segments of {}",
+      rewritten,
+      segments.size(),
+      config().ntp());
+}
+
+size_t disk_log_impl::compaction_backlog() const {
+    if (!config().is_compacted()) {
+        return 0;
+    }
+    return std::accumulate(
+      _segs.begin(),
+      _segs.end(),
+      size_t(0),
+      [](size_t acc, const ss::lw_shared_ptr<segment>& s) {
+          if (
+            s->has_appender() || !s->is_compacted_segment()
+            || s->finished_self_compaction()) {
+              return acc;
+          }
+          return acc + s->size_bytes();
+      });
+}
+
 std::optional<std::pair<segment_set::iterator, segment_set::iterator>>
 disk_log_impl::find_compaction_range() {
     /*
@@ -381,7 +514,8 @@ ss::future<> disk_log_impl::compact_adjacent_segments(
     // size is already contained in the partition size probe
     replacement->mark_as_compacted_segment();
     _probe.add_initial_segment(*replacement.get());
-    co_await storage::internal::self_compact_segment(replacement, cfg, _probe);
+    co_await storage::internal::self_compact_segment(
+      replacement, segment_compaction_config(cfg, target), _probe);
     _probe.delete_segment(*replacement.get());
     vlog(stlog.debug, "Final compacted segment {}", replacement);
 
@@ -403,7 +537,11 @@ ss::future<> disk_log_impl::compact_adjacent_segments(
     // these locks held so it is a relatively short duration. all of the data
     // copying and compaction i/o occurred above with no locks held. 5 retries
     // with a max lock timeout of 1 second. if we don't get the locks there is
-    // probably a reader. compaction will revisit.
+    // probably a reader. compaction will revisit. idle cached readers are
+    // evicted first so they don't hold the read locks.
+    auto cache_lock = co_await _readers_cache->evict_range(
+      segments.front()->offsets().base_offset,
+      segments.back()->offsets().dirty_offset);
     auto locks = co_await internal::write_lock_segments(segments, 1s, 5);
 
     // fast check if we should abandon all the expensive i/o work if we happened
@@ -480,12 +618,89 @@ ss::future<> disk_log_impl::compact(compaction_config cfg) {
         // have this set
         f = ss::now();
     }
-    if (config().is_compacted() && !_segs.empty()) {
+    if (config().is_compacted() && !_segs.empty() && !cfg.skip_compaction) {
         f = f.then([this, cfg] { return do_compact(cfg); });
     }
     return f;
 }
 
+model::timestamp disk_log_impl::housekeeping_due(compaction_config cfg) const {
+    // compaction keeps its own progress, compacted logs take part in every
+    // housekeeping round
+    if (config().is_compacted()) {
+        return model::timestamp::min();
+    }
+    // same conditions as compact() and gc()
+    if (
+      !config().is_collectable() || _segs.empty()
+      || config().ntp().ns() == model::redpanda_ns
+      || config().ntp().ns() == model::kafka_internal_namespace
+      || (config().has_overrides()
+          && config().get_overrides().cleanup_policy_bitflags
+               == model::cleanup_policy_bitflags::none)) {
+        return model::timestamp::max();
+    }
+    cfg = apply_overrides(cfg);
+    if (cfg.max_bytes && _probe.partition_size() > *cfg.max_bytes) {
+        return model::timestamp::min();
+    }
+    if (cfg.eviction_time == model::timestamp::min()) {
+        return model::timestamp::max();
+    }
+    // the oldest segment goes first, once all of its batches are older than
+    // the retention time
+    const auto retention = model::timestamp::now().value()
+                           - cfg.eviction_time.value();
+    const auto oldest = _segs.front()->index().max_timestamp().value();
+    if (oldest > model::timestamp::max().value() - retention) {
+        return model::timestamp::max();
+    }
+    return model::timestamp(oldest + retention);
+}
+
+std::optional<model::timestamp>
+disk_log_impl::oldest_reclaimable(bool archived_only) const {
+    // the active segment stays, as for gc()
+    if (
+      _closed || _segs.size() <= 1
+      || config().ntp().ns() == model::redpanda_ns
+      || config().ntp().ns() == model::kafka_internal_namespace
+      || (config().has_overrides()
+          && config().get_overrides().cleanup_policy_bitflags
+               == model::cleanup_policy_bitflags::none)) {
+        return std::nullopt;
+    }
+    const auto& front = _segs.front();
+    const auto committed = front->offsets().committed_offset;
+    if (committed > _max_collectible_offset) {
+        return std::nullopt;
+    }
+    if (archived_only) {
+        if (committed > _archived_offset) {
+            return std::nullopt;
+        }
+    } else if (config().is_compacted() || !config().is_collectable()) {
+        // the state of a compacted log is only trimmed once archived
+        return std::nullopt;
+    }
+    return front->index().max_timestamp();
+}
+
+ss::future<size_t> disk_log_impl::reclaim_oldest_segment(
+  bool archived_only, ss::abort_source& as) {
+    if (!oldest_reclaimable(archived_only)) {
+        return ss::make_ready_future<size_t>(0);
+    }
+    auto front = _segs.front();
+    const auto size = front->size_bytes();
+    return garbage_collect_segments(
+             front->offsets().dirty_offset, &as, "gc[disk_space]")
+      .then([this, front, size] {
+          // nothing was freed if the segment is still there, e.g. on abort
+          return _segs.empty() || _segs.front() != front ? size : size_t(0);
+      });
+}
+
 ss::future<> disk_log_impl::gc(compaction_config cfg) {
     vassert(!_closed, "gc on closed log - {}", *this);
 
@@ -513,7 +728,12 @@ ss::future<> disk_log_impl::remove_empty_segments() {
     return ss::do_until(
       [this] { return _segs.empty() || !_segs.back()->empty(); },
       [this] {
-          return _segs.back()->close().then([this] { _segs.pop_back(); });
+          auto base = _segs.back()->offsets().base_offset;
+          return _readers_cache->evict_range(base, base)
+            .then([this](readers_cache::range_lock_holder h) {
+                return _segs.back()->close().then(
+                  [this, h = std::move(h)] { _segs.pop_back(); });
+            });
       });
 }
 
@@ -597,7 +817,10 @@ ss::future<> disk_log_impl::new_segment(
                     h->mark_as_compacted_segment();
                 }
                 _segs.add(std::move(h));
+                _active_segment_created = ss::lowres_clock::now();
                 _probe.segment_created();
+                // the closed segment may have to go
+                _manager.schedule_housekeeping(config().ntp());
                 return _stm_manager->make_snapshot();
             });
       });
@@ -649,6 +872,39 @@ size_t disk_log_impl::max_segment_size() const {
                                    : _manager.config().max_segment_size;
 }
 
+bool disk_log_impl::has_adaptive_segment_size() const {
+    if (config().has_overrides() && config().get_overrides().segment_size) {
+        return false;
+    }
+    return _manager.config().segment_target_lifetime.has_value();
+}
+
+void disk_log_impl::update_adaptive_segment_size(
+  size_t bytes, ss::lowres_clock::duration age) {
+    auto seconds = std::chrono::duration<double>(age).count();
+    if (seconds < 1) {
+        // too short to measure a rate, e.g. rolled on term change
+        return;
+    }
+    auto rate = static_cast<double>(bytes) / seconds;
+    _ingest_rate = _ingest_rate == 0 ? rate : (_ingest_rate + rate) / 2;
+
+    const auto& cfg = _manager.config();
+    auto lifetime = std::chrono::duration<double>(*cfg.segment_target_lifetime)
+                      .count();
+    auto size = static_cast<size_t>(_ingest_rate * lifetime);
+    size = std::min(
+      std::max(size, cfg.min_adaptive_segment_size),
+      cfg.max_adaptive_segment_size);
+    _max_segment_size = internal::jitter_segment_size(size);
+    vlog(
+      stlog.debug,
+      "{} ingest rate {} bytes/s, next segment size {}",
+      config().ntp(),
+      _ingest_rate,
+      _max_segment_size);
+}
+
 size_t disk_log_impl::bytes_left_before_roll() const {
     if (_segs.empty()) {
         return 0;
@@ -665,6 +921,17 @@ size_t disk_log_impl::bytes_left_before_roll() const {
     return max - fo;
 }
 
+ss::future<>
+disk_log_impl::release_appender(ss::lw_shared_ptr<segment> seg) {
+    // releasing the appender needs the segment write lock. cached readers of
+    // the segment can't serve tailing reads past the roll, so evict them.
+    return _readers_cache
+      ->evict_range(seg->offsets().base_offset, seg->offsets().dirty_offset)
+      .then([seg](readers_cache::range_lock_holder h) {
+          return seg->release_appender().finally([h = std::move(h)] {});
+      });
+}
+
 ss::future<> disk_log_impl::force_roll(ss::io_priority_class iopc) {
     auto t = term();
     auto next_offset = offsets().dirty_offset + model::offset(1);
@@ -675,7 +942,7 @@ ss::future<> disk_log_impl::force_roll(ss::io_priority_class iopc) {
     if (!ptr->has_appender()) {
         return new_segment(next_offset, t, iopc);
     }
-    return ptr->release_appender().then([this, next_offset, t, iopc] {
+    return release_appender(ptr).then([this, next_offset, t, iopc] {
         return new_segment(next_offset, t, iopc);
     });
 }
@@ -691,12 +958,23 @@ ss::future<> disk_log_impl::maybe_roll(
         return new_segment(next_offset, t, iopc);
     }
     bool size_should_roll = false;
+    const bool adaptive = has_adaptive_segment_size();
+    auto size = ptr->appender().file_byte_offset();
+    auto age = ss::lowres_clock::now() - _active_segment_created;
 
-    if (ptr->appender().file_byte_offset() >= _max_segment_size) {
+    if (size >= _max_segment_size) {
+        size_should_roll = true;
+    } else if (
+      adaptive && size >= _manager.config().min_adaptive_segment_size
+      && age >= *_manager.config().segment_target_lifetime) {
+        // the rate dropped since the size was set, do not wait for it to fill
         size_should_roll = true;
     }
     if (t != term() || size_should_roll) {
-        return ptr->release_appender().then([this, next_offset, t, iopc] {
+        if (adaptive) {
+            update_adaptive_segment_size(size, age);
+        }
+        return release_appender(ptr).then([this, next_offset, t, iopc] {
             return new_segment(next_offset, t, iopc);
         });
     }
@@ -723,7 +1001,20 @@ disk_log_impl::make_reader(log_reader_config config) {
             config.start_offset,
             _start_offset)));
     }
-    return make_unchecked_reader(config);
+    if (auto cached = _readers_cache->get_reader(config); cached) {
+        return ss::make_ready_future<model::record_batch_reader>(
+          std::move(*cached));
+    }
+    return _lock_mngr.range_lock(config).then(
+      [this, cfg = config](std::unique_ptr<lock_manager::lease> lease) {
+          return _readers_cache->put(std::make_unique<log_reader>(
+            std::move(lease),
+            cfg,
+            _probe,
+            read_ahead_tracker(
+              bool(config().adaptive_read_ahead()),
+              _manager.config().read_ahead_limits)));
+      });
 }
 
 ss::future<model::record_batch_reader>
@@ -759,6 +1050,43 @@ std::optional<model::term_id> disk_log_impl::get_term(model::offset o) const {
 
     return std::nullopt;
 }
+
+std::optional<term_end>
+disk_log_impl::find_term_end(model::term_id term) const {
+    // a truncation or a roll leaves empty segments at the tail, their term
+    // has no data
+    auto last = _segs.end();
+    while (last != _segs.begin() && (*std::prev(last))->empty()) {
+        --last;
+    }
+    if (last == _segs.begin()) {
+        return std::nullopt;
+    }
+    // a segment holds a single term and the terms grow along the segments,
+    // compaction never merges segments of different terms. the segments are
+    // the index of the term starts, kept across restarts by their names and
+    // updated with them on rolls and truncations
+    auto it = std::upper_bound(
+      _segs.begin(),
+      last,
+      term,
+      [](model::term_id t, const ss::lw_shared_ptr<segment>& s) {
+          return t < s->offsets().term;
+      });
+    if (it == last) {
+        return term_end{
+          .term = (*std::prev(last))->offsets().term,
+          .end_offset = offsets().dirty_offset + model::offset(1)};
+    }
+    const auto end_offset = std::max(
+      (*it)->offsets().base_offset, _start_offset);
+    if (it == _segs.begin()) {
+        return term_end{.term = term, .end_offset = end_offset};
+    }
+    return term_end{
+      .term = (*std::prev(it))->offsets().term, .end_offset = end_offset};
+}
+
 ss::future<std::optional<timequery_result>>
 disk_log_impl::timequery(timequery_config cfg) {
     vassert(!_closed, "timequery on closed log - {}", *this);
@@ -792,13 +1120,17 @@ ss::future<> disk_log_impl::remove_segment_permanently(
     _probe.delete_segment(*s);
     // background close
     s->tombstone();
-    if (s->has_outstanding_locks()) {
-        vlog(
-          stlog.info,
-          "Segment has outstanding locks. Might take a while to close:{}",
-          s->reader().filename());
-    }
-    return s->close()
+    return _readers_cache
+      ->evict_range(s->offsets().base_offset, s->offsets().dirty_offset)
+      .then([s](readers_cache::range_lock_holder h) {
+          if (s->has_outstanding_locks()) {
+              vlog(
+                stlog.info,
+                "Segment has outstanding locks. Might take a while to close:{}",
+                s->reader().filename());
+          }
+          return s->close().finally([h = std::move(h)] {});
+      })
       .handle_exception([s](std::exception_ptr e) {
           vlog(stlog.error, "Cannot close segment: {} - {}", e, s);
       })
@@ -835,8 +1167,11 @@ disk_log_impl::remove_prefix_full_segments(truncate_prefix_config cfg) {
 ss::future<> disk_log_impl::truncate_prefix(truncate_prefix_config cfg) {
     vassert(!_closed, "truncate_prefix() on closed log - {}", *this);
     return _failure_probes.truncate_prefix().then([this, cfg]() mutable {
-        // dispatch the actual truncation
-        return do_truncate_prefix(cfg);
+        return _readers_cache->evict_prefix_truncate(cfg.start_offset)
+          .then([this, cfg](readers_cache::range_lock_holder h) {
+              // dispatch the actual truncation
+              return do_truncate_prefix(cfg).finally([h = std::move(h)] {});
+          });
     });
 }
 
@@ -908,8 +1243,11 @@ ss::future<> disk_log_impl::do_truncate_prefix(truncate_prefix_config cfg) {
 ss::future<> disk_log_impl::truncate(truncate_config cfg) {
     vassert(!_closed, "truncate() on closed log - {}", *this);
     return _failure_probes.truncate().then([this, cfg]() mutable {
-        // dispatch the actual truncation
-        return do_truncate(cfg);
+        return _readers_cache->evict_truncate(cfg.base_offset)
+          .then([this, cfg](readers_cache::range_lock_holder h) {
+              // dispatch the actual truncation
+              return do_truncate(cfg).finally([h = std::move(h)] {});
+          });
     });
 }
 
@@ -936,6 +1274,10 @@ ss::future<> disk_log_impl::do_truncate(truncate_config cfg) {
     if (cfg.base_offset > last.offsets().dirty_offset) {
         return ss::make_ready_future<>();
     }
+    if (!last.index().is_hydrated()) {
+        return last.hydrate_index().then(
+          [this, cfg] { return do_truncate(cfg); });
+    }
     auto pidx = last.index().find_nearest(cfg.base_offset);
     model::offset start = last.index().base_offset();
     size_t initial_size = 0;
@@ -1028,10 +1370,115 @@ disk_log_impl::update_configuration(ntp_config::default_overrides o) {
             }
         }
     }
+    // the retention settings may have changed
+    _manager.schedule_housekeeping(config().ntp());
 
     return ss::now();
 }
 
+ss::future<std::optional<sealed_segment>>
+disk_log_impl::get_sealed_segment(model::offset base_offset) {
+    vassert(!_closed, "get_sealed_segment on closed log - {}", *this);
+    auto it = _segs.lower_bound(base_offset);
+    if (it == _segs.end() || (*it)->offsets().base_offset != base_offset) {
+        co_return std::nullopt;
+    }
+    auto seg = *it;
+    if (seg->has_appender() || !seg->index().is_sealed()) {
+        co_return std::nullopt;
+    }
+    auto lock = co_await seg->read_lock();
+    // segment might have been removed or rewritten while waiting for the lock
+    if (
+      seg->is_closed() || seg->is_tombstone() || !seg->index().is_sealed()
+      || seg->reader().file_size() != seg->index().sealed_size()) {
+        co_return std::nullopt;
+    }
+    auto data_path = std::filesystem::path(seg->reader().filename().c_str());
+    sealed_segment ret{
+      .base_offset = seg->offsets().base_offset,
+      .dirty_offset = seg->offsets().dirty_offset,
+      .term = seg->offsets().term,
+      .data_path = data_path,
+      .index_path = std::filesystem::path(seg->index().filename().c_str()),
+      .lock = std::move(lock),
+    };
+    auto compacted = internal::compacted_index_path(data_path);
+    if (co_await ss::file_exists(compacted.string())) {
+        ret.compacted_index_path = std::move(compacted);
+    }
+    co_return ret;
+}
+
+ss::future<>
+disk_log_impl::adopt_segment(model::offset base_offset, model::term_id term) {
+    vassert(!_closed, "adopt_segment on closed log - {}", *this);
+    auto ofs = offsets();
+    if (!_segs.empty() && base_offset != ofs.dirty_offset + model::offset(1)) {
+        throw std::runtime_error(fmt::format(
+          "Can not adopt segment with base offset {} in log {}, offsets: {}",
+          base_offset,
+          config().ntp(),
+          ofs));
+    }
+    // the adopted segment becomes the tail of the log, appends continue in a
+    // new segment
+    co_await remove_empty_segments();
+    if (!_segs.empty() && _segs.back()->has_appender()) {
+        co_await release_appender(_segs.back());
+    }
+    auto path = segment_path::make_segment_path(
+      config(), base_offset, term, record_version_type::v1);
+    auto seg = co_await _manager.open_log_segment(config(), path);
+    std::exception_ptr e;
+    try {
+        auto sealed = co_await seg->materialize_index()
+                      && seg->index().is_sealed()
+                      && seg->reader().file_size()
+                           == seg->index().sealed_size();
+        if (!sealed || seg->offsets().base_offset != base_offset) {
+            throw std::runtime_error(fmt::format(
+              "Segment {} does not have a sealed index", path.string()));
+        }
+        // the segment was received from another node, check every batch
+        // before it becomes part of the log
+        auto verified = co_await ss::async([&seg] {
+            return log_replayer(*seg).verify_seal_in_thread(
+              ss::default_priority_class(),
+              log_replayer::verify_records::yes);
+        });
+        if (!verified) {
+            throw std::runtime_error(fmt::format(
+              "Segment {} does not match its sealed index", path.string()));
+        }
+    } catch (...) {
+        e = std::current_exception();
+    }
+    if (e) {
+        // the files are not part of the log, recovery must not pick them up
+        co_await seg->close();
+        std::vector<ss::sstring> files{
+          path.string(),
+          seg->index().filename(),
+          internal::compacted_index_path(path).string()};
+        for (const auto& f : files) {
+            if (co_await ss::file_exists(f)) {
+                co_await ss::remove_file(f);
+            }
+        }
+        std::rethrow_exception(e);
+    }
+    vassert(!_closed, "cannot add log segment to closed log");
+    if (config().is_compacted()) {
+        seg->mark_as_compacted_segment();
+    }
+    vlog(stlog.info, "Adopted segment {} in log {}", seg, config().ntp());
+    _probe.add_initial_segment(*seg);
+    _segs.add(std::move(seg));
+    _probe.segment_created();
+    co_await _stm_manager->make_snapshot();
+}
+
 std::ostream& disk_log_impl::print(std::ostream& o) const {
     return o << "{offsets:" << offsets()
              << ", max_collectible_offset: " << _max_collectible_offset
@@ -1044,9 +1491,13 @@ std::ostream& operator<<(std::ostream& o, const disk_log_impl& d) {
 }
 
 log make_disk_backed_log(
-  ntp_config cfg, log_manager& manager, segment_set segs, kvstore& kvstore) {
+  ntp_config cfg,
+  log_manager& manager,
+  segment_set segs,
+  kvstore& kvstore,
+  const recovery_timings& timings) {
     auto ptr = ss::make_shared<disk_log_impl>(
-      std::move(cfg), manager, std::move(segs), kvstore);
+      std::move(cfg), manager, std::move(segs), kvstore, timings);
     return log(ptr);
 }
 
@@ -18,6 +18,7 @@
 #include "storage/log.h"
 #include "storage/log_reader.h"
 #include "storage/probe.h"
+#include "storage/readers_cache.h"
 #include "storage/segment_appender.h"
 #include "storage/segment_reader.h"
 #include "storage/types.h"
@@ -25,6 +26,7 @@
 #include <seastar/core/abort_source.hh>
 #include <seastar/core/future.hh>
 #include <seastar/core/gate.hh>
+#include <seastar/core/lowres_clock.hh>
 
 #include <absl/container/flat_hash_map.h>
 
@@ -34,7 +36,12 @@ class disk_log_impl final : public log::impl {
 public:
     using failure_probes = storage::log_failure_probes;
 
-    disk_log_impl(ntp_config, log_manager&, segment_set, kvstore&);
+    disk_log_impl(
+      ntp_config,
+      log_manager&,
+      segment_set,
+      kvstore&,
+      const recovery_timings& = {});
     ~disk_log_impl() override;
     disk_log_impl(disk_log_impl&&) noexcept = default;
     disk_log_impl& operator=(disk_log_impl&&) noexcept = delete;
@@ -61,6 +68,7 @@ public:
     size_t segment_count() const final { return _segs.size(); }
     offset_stats offsets() const final;
     std::optional<model::term_id> get_term(model::offset) const final;
+    std::optional<term_end> find_term_end(model::term_id) const final;
     std::ostream& print(std::ostream&) const final;
 
     ss::future<> maybe_roll(
@@ -77,7 +85,17 @@ public:
     size_t bytes_left_before_roll() const;
 
     size_t size_bytes() const override { return _probe.partition_size(); }
+    size_t compaction_backlog() const final;
+    model::timestamp housekeeping_due(compaction_config) const final;
+    void set_archived_offset(model::offset o) final { _archived_offset = o; }
+    std::optional<model::timestamp>
+    oldest_reclaimable(bool archived_only) const final;
+    ss::future<size_t>
+    reclaim_oldest_segment(bool archived_only, ss::abort_source&) final;
     ss::future<> update_configuration(ntp_config::default_overrides) final;
+    ss::future<std::optional<sealed_segment>>
+      get_sealed_segment(model::offset) final;
+    ss::future<> adopt_segment(model::offset, model::term_id) final;
 
 private:
     friend class disk_log_appender; // for multi-term appends
@@ -95,9 +113,13 @@ private:
       storage::compaction_config cfg);
     std::optional<std::pair<segment_set::iterator, segment_set::iterator>>
     find_compaction_range();
+    std::vector<ss::lw_shared_ptr<segment>> find_deduplication_range() const;
+    ss::future<> deduplicate_segments(
+      std::vector<ss::lw_shared_ptr<segment>>, compaction_config);
     ss::future<> gc(compaction_config);
 
     ss::future<> remove_empty_segments();
+    ss::future<> release_appender(ss::lw_shared_ptr<segment>);
 
     ss::future<> remove_segment_permanently(
       ss::lw_shared_ptr<segment> segment_to_tombsone,
@@ -126,9 +148,13 @@ private:
     bool is_front_segment(const segment_set::type&) const;
 
     compaction_config apply_overrides(compaction_config) const;
+    compaction_config
+    segment_compaction_config(compaction_config, const segment_set::type&) const;
 
 private:
     size_t max_segment_size() const;
+    bool has_adaptive_segment_size() const;
+    void update_adaptive_segment_size(size_t, ss::lowres_clock::duration);
     struct eviction_monitor {
         ss::promise<model::offset> promise;
         ss::abort_source::subscription subscription;
@@ -140,10 +166,20 @@ private:
     model::offset _start_offset;
     lock_manager _lock_mngr;
     storage::probe _probe;
+    std::unique_ptr<readers_cache> _readers_cache;
     failure_probes _failure_probes;
     std::optional<eviction_monitor> _eviction_monitor;
     model::offset _max_collectible_offset;
     size_t _max_segment_size;
+    // creation time of the active segment and the average ingest rate of the
+    // log in bytes per second, measured at rolls for the adaptive size
+    ss::lowres_clock::time_point _active_segment_created{
+      ss::lowres_clock::now()};
+    double _ingest_rate{0};
+    // dirty offset of the newest segment of the last deduplication pass
+    model::offset _last_deduplicated_offset{model::offset::min()};
+    // the log is archived up to here, see set_archived_offset()
+    model::offset _archived_offset{model::offset::min()};
 };
 
 } // namespace storage
@@ -0,0 +1,273 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/disk_space_manager.h"
+
+#include "config/configuration.h"
+#include "prometheus/prometheus_sanitize.h"
+#include "storage/logger.h"
+#include "syschecks/syschecks.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/metrics.hh>
+#include <seastar/core/smp.hh>
+
+#include <algorithm>
+#include <ostream>
+
+namespace storage {
+
+disk_space_manager::disk_space_manager(
+  const std::vector<ss::sstring>& dirs,
+  const logs_t& logs,
+  ss::abort_source& as) noexcept
+  : _logs(logs)
+  , _as(as) {
+    _dirs.reserve(dirs.size());
+    for (const auto& dir : dirs) {
+        _dirs.push_back(directory{.path = dir});
+    }
+}
+
+void disk_space_manager::start() {
+    setup_metrics();
+    _timer.set_callback([this] {
+        (void)ss::with_gate(_gate, [this] {
+            return check()
+              .handle_exception([](std::exception_ptr e) {
+                  vlog(stlog.warn, "Error checking the disk space: {}", e);
+              })
+              .finally([this] { arm(); });
+        });
+    });
+    arm();
+}
+
+void disk_space_manager::arm() {
+    if (!_gate.is_closed() && !_as.abort_requested()) {
+        _timer.arm(config::shard_local_cfg().disk_space_check_interval_ms());
+    }
+}
+
+ss::future<> disk_space_manager::stop() {
+    _timer.cancel();
+    return _gate.close();
+}
+
+disk_space_manager::pressure disk_space_manager::level_for(
+  uint64_t free_bytes, size_t target, size_t critical) {
+    if (critical > 0 && free_bytes < critical) {
+        return pressure::critical;
+    }
+    if (target > 0 && free_bytes < target) {
+        return pressure::low;
+    }
+    return pressure::none;
+}
+
+disk_space_manager::pressure disk_space_manager::level() const {
+    auto level = pressure::none;
+    for (const auto& d : _dirs) {
+        level = std::max(level, d.level);
+    }
+    return level;
+}
+
+disk_space_manager::pressure
+disk_space_manager::level(std::string_view dir) const {
+    auto it = std::find_if(
+      _dirs.begin(), _dirs.end(), [dir](const directory& d) {
+          return std::string_view(d.path) == dir;
+      });
+    return it == _dirs.end() ? pressure::none : it->level;
+}
+
+uint64_t disk_space_manager::reclaimed_bytes() const {
+    uint64_t reclaimed = 0;
+    for (const auto& d : _dirs) {
+        reclaimed += d.reclaimed_bytes;
+    }
+    return reclaimed;
+}
+
+ss::future<> disk_space_manager::check() {
+    const auto& cfg = config::shard_local_cfg();
+    const auto target = cfg.disk_space_target_free_bytes();
+    const auto critical = cfg.disk_space_critical_free_bytes();
+    for (auto& d : _dirs) {
+        if (_as.abort_requested()) {
+            co_return;
+        }
+        co_await check(d, target, critical);
+    }
+}
+
+ss::future<> disk_space_manager::check(
+  directory& d, size_t target, size_t critical) {
+    if (target == 0 && critical == 0) {
+        d.level = pressure::none;
+        co_return;
+    }
+    auto space = co_await syschecks::disk_space(d.path);
+    d.free_bytes = space.free_bytes;
+    const auto level = level_for(d.free_bytes, target, critical);
+    if (level != d.level) {
+        vlog(
+          stlog.info,
+          "Disk space pressure of {} {} -> {}, {} bytes free of {}",
+          d.path,
+          d.level,
+          level,
+          space.free_bytes,
+          space.total_bytes);
+        d.level = level;
+    }
+    if (d.level == pressure::none) {
+        co_return;
+    }
+    // every core trims its share of the shortfall
+    const auto goal = std::max(target, critical);
+    const auto shortfall = goal - std::min<uint64_t>(goal, d.free_bytes);
+    const auto share = (shortfall + ss::smp::count - 1) / ss::smp::count;
+    const auto reclaimed = co_await reclaim(d, share);
+    vlog(
+      stlog.debug,
+      "Disk space pressure of {} {}, reclaimed {} of {} bytes",
+      d.path,
+      d.level,
+      reclaimed,
+      share);
+}
+
+ss::future<size_t> disk_space_manager::reclaim(directory& d, size_t bytes) {
+    // only the logs of the directory free space on its disk
+    std::vector<log> logs;
+    for (const auto& [_, meta] : _logs) {
+        if (meta.handle.config().base_directory() == d.path) {
+            logs.push_back(meta.handle);
+        }
+    }
+    // what is archived can be read back from the cloud
+    auto reclaimed = co_await reclaim_from(d, logs, bytes, true);
+
+    for (const auto& topic :
+         config::shard_local_cfg().disk_space_reclaim_priority_topics()) {
+        if (reclaimed >= bytes) {
+            co_return reclaimed;
+        }
+        std::vector<log> topic_logs;
+        std::copy_if(
+          logs.begin(),
+          logs.end(),
+          std::back_inserter(topic_logs),
+          [&topic](const log& l) {
+              return l.config().ntp().tp.topic() == topic;
+          });
+        reclaimed += co_await reclaim_from(
+          d, std::move(topic_logs), bytes - reclaimed, false);
+    }
+
+    if (reclaimed < bytes && d.level == pressure::critical) {
+        reclaimed += co_await reclaim_from(
+          d, std::move(logs), bytes - reclaimed, false);
+    }
+    co_return reclaimed;
+}
+
+ss::future<size_t> disk_space_manager::reclaim_from(
+  directory& d, std::vector<log> logs, size_t bytes, bool archived_only) {
+    struct candidate {
+        model::timestamp oldest;
+        log handle;
+    };
+    // oldest segment of all the logs first
+    auto later = [](const candidate& a, const candidate& b) {
+        return a.oldest > b.oldest;
+    };
+    std::vector<candidate> heap;
+    for (auto& l : logs) {
+        if (auto oldest = l.oldest_reclaimable(archived_only); oldest) {
+            heap.push_back(candidate{.oldest = *oldest, .handle = l});
+        }
+    }
+    std::make_heap(heap.begin(), heap.end(), later);
+
+    size_t reclaimed = 0;
+    while (reclaimed < bytes && !heap.empty() && !_as.abort_requested()) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        auto c = std::move(heap.back());
+        heap.pop_back();
+        // the log may have been removed in the meantime
+        if (!_logs.contains(c.handle.config().ntp())) {
+            continue;
+        }
+        const auto freed = co_await c.handle.reclaim_oldest_segment(
+          archived_only, _as);
+        reclaimed += freed;
+        d.reclaimed_bytes += freed;
+        if (auto oldest = c.handle.oldest_reclaimable(archived_only); oldest) {
+            c.oldest = *oldest;
+            heap.push_back(std::move(c));
+            std::push_heap(heap.begin(), heap.end(), later);
+        }
+    }
+    co_return reclaimed;
+}
+
+void disk_space_manager::setup_metrics() {
+    if (config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+    namespace sm = ss::metrics;
+    auto directory_label = sm::label("directory");
+    for (const auto& d : _dirs) {
+        const std::vector<sm::label_instance> labels = {
+          directory_label(d.path),
+        };
+        _metrics.add_group(
+          prometheus_sanitize::metrics_name("storage:disk_space"),
+          {
+            sm::make_gauge(
+              "pressure",
+              [&d] { return static_cast<uint8_t>(d.level); },
+              sm::description("Disk space pressure of the data directory: 0 "
+                              "for none, 1 for low, 2 for critical"),
+              labels),
+            sm::make_gauge(
+              "free_bytes",
+              [&d] { return d.free_bytes; },
+              sm::description("Free space of the data directory as of the "
+                              "last check, only checked with a threshold "
+                              "set"),
+              labels),
+            sm::make_total_bytes(
+              "reclaimed_bytes",
+              [&d] { return d.reclaimed_bytes; },
+              sm::description("Total number of bytes of segments of the data "
+                              "directory trimmed because of disk space "
+                              "pressure"),
+              labels),
+          });
+    }
+}
+
+std::ostream& operator<<(std::ostream& o, disk_space_manager::pressure p) {
+    switch (p) {
+    case disk_space_manager::pressure::none:
+        return o << "none";
+    case disk_space_manager::pressure::low:
+        return o << "low";
+    case disk_space_manager::pressure::critical:
+        return o << "critical";
+    }
+    return o << "unknown";
+}
+
+} // namespace storage
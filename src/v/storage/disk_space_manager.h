@@ -0,0 +1,105 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "model/fundamental.h"
+#include "seastarx.h"
+#include "storage/log.h"
+#include "storage/log_housekeeping_meta.h"
+
+#include <seastar/core/abort_source.hh>
+#include <seastar/core/future.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/core/sstring.hh>
+#include <seastar/core/timer.hh>
+
+#include <absl/container/flat_hash_map.h>
+
+#include <cstdint>
+#include <iosfwd>
+#include <string_view>
+#include <vector>
+
+namespace storage {
+
+/**
+ * Node level management of the free space of the data directories.
+ *
+ * Every core checks the free space of each data directory every
+ * disk_space_check_interval_ms. Below disk_space_target_free_bytes the
+ * pressure of a directory is low and each core trims its share of the
+ * shortfall from the oldest segments of its logs in that directory: archived
+ * segments first, their data is still in the cloud, then the segments of
+ * disk_space_reclaim_priority_topics in the order of the list. Below
+ * disk_space_critical_free_bytes the pressure is critical, compaction of
+ * the shard is paused as it needs room for the segments it rewrites, and the
+ * oldest segments of any deletable log of the directory are trimmed as well.
+ * Logs on other directories are left alone.
+ */
+class disk_space_manager {
+public:
+    enum class pressure : uint8_t { none = 0, low, critical };
+    using logs_t = absl::flat_hash_map<model::ntp, log_housekeeping_meta>;
+
+    /// \brief \p dirs are the data directories, each log lives in the one
+    /// its ntp_config::base_directory() names
+    disk_space_manager(
+      const std::vector<ss::sstring>& dirs,
+      const logs_t& logs,
+      ss::abort_source& as) noexcept;
+
+    void start();
+    ss::future<> stop();
+
+    /// \brief checks the free space and trims the logs of the directories
+    /// under pressure
+    ss::future<> check();
+
+    /// \brief the highest pressure of all the data directories
+    pressure level() const;
+    /// \brief pressure of the data directory \p dir, none for a directory
+    /// which is not managed
+    pressure level(std::string_view dir) const;
+    uint64_t reclaimed_bytes() const;
+
+    /// \brief zero thresholds are disabled
+    static pressure
+    level_for(uint64_t free_bytes, size_t target, size_t critical);
+
+private:
+    struct directory {
+        ss::sstring path;
+        pressure level{pressure::none};
+        uint64_t free_bytes{0};
+        uint64_t reclaimed_bytes{0};
+    };
+
+    ss::future<> check(directory&, size_t target, size_t critical);
+    ss::future<size_t> reclaim(directory&, size_t bytes);
+    ss::future<size_t> reclaim_from(
+      directory&, std::vector<log> logs, size_t bytes, bool archived_only);
+    void arm();
+    void setup_metrics();
+
+    std::vector<directory> _dirs;
+    const logs_t& _logs;
+    ss::abort_source& _as;
+    ss::timer<ss::lowres_clock> _timer;
+    ss::gate _gate;
+    ss::metrics::metric_groups _metrics;
+};
+
+std::ostream& operator<<(std::ostream&, disk_space_manager::pressure);
+
+} // namespace storage
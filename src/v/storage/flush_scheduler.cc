@@ -0,0 +1,124 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/flush_scheduler.h"
+
+#include "config/configuration.h"
+#include "prometheus/prometheus_sanitize.h"
+#include "storage/logger.h"
+#include "vlog.h"
+
+#include <seastar/core/gate.hh>
+#include <seastar/core/loop.hh>
+#include <seastar/core/metrics.hh>
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+#include <vector>
+
+namespace storage::internal {
+
+flush_scheduler::flush_scheduler(ss::sstring data_dir) noexcept
+  : _data_dir(std::move(data_dir))
+  , _timer([this] { dispatch(); }) {}
+
+void flush_scheduler::start() { setup_metrics(); }
+
+ss::future<> flush_scheduler::stop() {
+    _timer.cancel();
+    dispatch();
+    return _gate.close().then([this] { _metrics.clear(); });
+}
+
+ss::future<> flush_scheduler::flush(ss::file f) {
+    if (_gate.is_closed()) {
+        return ss::make_exception_future<>(ss::gate_closed_exception());
+    }
+    _pending.push_back(request{.file = std::move(f), .done = {}});
+    auto ret = _pending.back().done.get_future();
+    if (!_timer.armed()) {
+        _timer.arm(
+          config::shard_local_cfg().segment_appender_flush_coalesce_ms());
+    }
+    return ret;
+}
+
+void flush_scheduler::dispatch() {
+    auto batch = std::exchange(_pending, {});
+    const size_t n = batch.size();
+    if (n == 0) {
+        return;
+    }
+    const size_t bucket = std::min<size_t>(
+      std::bit_width(n - 1), batch_size_buckets - 1);
+    ++_batch_sizes[bucket];
+    ++_batches;
+    _flushes += n;
+    vlog(stlog.trace, "dispatching group commit of {} flushes", n);
+    (void)ss::with_gate(_gate, [batch = std::move(batch)]() mutable {
+        return ss::do_with(
+          std::move(batch), [](ss::chunked_fifo<request>& batch) {
+              return ss::parallel_for_each(batch, [](request& r) {
+                  return r.file.flush().then_wrapped([&r](ss::future<> f) {
+                      if (f.failed()) {
+                          r.done.set_exception(f.get_exception());
+                      } else {
+                          r.done.set_value();
+                      }
+                  });
+              });
+          });
+    });
+}
+
+ss::metrics::histogram flush_scheduler::batch_size_histogram() const {
+    ss::metrics::histogram h;
+    h.buckets.resize(batch_size_buckets);
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < batch_size_buckets; ++i) {
+        cumulative += _batch_sizes[i];
+        h.buckets[i].count = cumulative;
+        h.buckets[i].upper_bound = static_cast<double>(uint64_t(1) << i);
+    }
+    h.sample_count = _batches;
+    h.sample_sum = static_cast<double>(_flushes);
+    return h;
+}
+
+void flush_scheduler::setup_metrics() {
+    if (config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+    namespace sm = ss::metrics;
+    const std::vector<sm::label_instance> labels = {
+      sm::label("directory")(_data_dir),
+    };
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("storage:flush_scheduler"),
+      {
+        sm::make_derive(
+          "flushes",
+          [this] { return _flushes; },
+          sm::description("Number of segment flushes issued"),
+          labels),
+        sm::make_derive(
+          "group_commits",
+          [this] { return _batches; },
+          sm::description("Number of coalesced groups of segment flushes"),
+          labels),
+        sm::make_histogram(
+          "group_commit_size",
+          [this] { return batch_size_histogram(); },
+          sm::description("Number of segment flushes per group commit"),
+          labels),
+      });
+}
+
+} // namespace storage::internal
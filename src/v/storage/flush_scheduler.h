@@ -0,0 +1,89 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+#include "seastarx.h"
+
+#include <seastar/core/chunked_fifo.hh>
+#include <seastar/core/file.hh>
+#include <seastar/core/future.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/core/metrics_types.hh>
+#include <seastar/core/sstring.hh>
+#include <seastar/core/timer.hh>
+
+#include <array>
+#include <cstdint>
+
+namespace storage::internal {
+
+/**
+ * Shard wide group commit for segment files.
+ *
+ * With many low throughput partitions per shard every appender issues its
+ * own fdatasync. Instead, flush requests from all appenders that arrive within
+ * the coalescing window (segment_appender_flush_coalesce_ms) are issued
+ * together, which lets the file system commit them with one journal write
+ * rather than one per file. A zero window groups the requests made within the
+ * same reactor poll.
+ *
+ * Each log_manager owns the scheduler of its shard, the appenders of the
+ * segments it creates flush through it. It is stopped once the logs are
+ * closed: the requests still pending are issued right away and the flushes
+ * in flight are awaited. The metrics are labelled with the data directory of
+ * the log_manager, so that more than one of them may live on a shard.
+ */
+class flush_scheduler {
+public:
+    /// batch sizes are tracked in power of two buckets, up to 8192 requests
+    static constexpr size_t batch_size_buckets = 14;
+
+    explicit flush_scheduler(ss::sstring data_dir) noexcept;
+    flush_scheduler(flush_scheduler&&) = delete;
+    flush_scheduler& operator=(flush_scheduler&&) = delete;
+    flush_scheduler(const flush_scheduler&) = delete;
+    flush_scheduler& operator=(const flush_scheduler&) = delete;
+    ~flush_scheduler() noexcept = default;
+
+    void start();
+    ss::future<> stop();
+
+    /// \brief flushes \p f as part of the next group commit. the caller must
+    /// keep the file open until the returned future resolves. fails with
+    /// ss::gate_closed_exception once the scheduler is stopped.
+    ss::future<> flush(ss::file f);
+
+    size_t pending() const { return _pending.size(); }
+    uint64_t dispatched_batches() const { return _batches; }
+    uint64_t dispatched_flushes() const { return _flushes; }
+
+private:
+    struct request {
+        ss::file file;
+        ss::promise<> done;
+    };
+
+    void dispatch();
+    ss::metrics::histogram batch_size_histogram() const;
+    void setup_metrics();
+
+    ss::sstring _data_dir;
+    ss::chunked_fifo<request> _pending;
+    ss::timer<> _timer;
+    std::array<uint64_t, batch_size_buckets> _batch_sizes{};
+    uint64_t _batches{0};
+    uint64_t _flushes{0};
+    ss::gate _gate;
+    ss::metrics::metric_groups _metrics;
+};
+
+} // namespace storage::internal
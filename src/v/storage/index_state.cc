@@ -20,10 +20,71 @@
 #include <fmt/format.h>
 #include <fmt/ostream.h>
 
+#include <array>
+#include <bit>
+#include <cstring>
 #include <optional>
 
 namespace storage {
 
+namespace {
+// version + size + fixed header fields
+constexpr size_t legacy_header_bytes = index_state::min_header_size;
+static_assert(
+  legacy_header_bytes
+  == sizeof(int8_t) + sizeof(uint32_t) + sizeof(index_state::checksum)
+       + sizeof(index_state::bitflags) + sizeof(index_state::base_offset)
+       + sizeof(index_state::max_offset) + sizeof(index_state::base_timestamp)
+       + sizeof(index_state::max_timestamp) + sizeof(uint32_t));
+// the fixed header fields followed by the segment summary
+constexpr size_t header_bytes = index_state::header_size;
+static_assert(
+  header_bytes == legacy_header_bytes + sizeof(index_state::segment_size)
+                    + sizeof(index_state::segment_checksum));
+static_assert(header_bytes <= index_state::page_alignment);
+
+constexpr size_t header_bytes_for(int8_t version) {
+    return version >= 4 ? header_bytes : legacy_header_bytes;
+}
+
+constexpr size_t padding_for(size_t pos) {
+    const auto rem = pos % index_state::page_alignment;
+    return rem == 0 ? 0 : index_state::page_alignment - rem;
+}
+
+void append_padding(iobuf& out, size_t n) {
+    static constexpr std::array<char, index_state::page_alignment> zeros{};
+    out.append(zeros.data(), n);
+}
+
+void append_array(iobuf& out, const std::vector<uint32_t>& v) {
+    if constexpr (std::endian::native == std::endian::little) {
+        out.append(
+          reinterpret_cast<const char*>(v.data()), v.size() * sizeof(uint32_t));
+    } else {
+        for (auto e : v) {
+            reflection::adl<uint32_t>{}.to(out, e);
+        }
+    }
+}
+
+void consume_array(iobuf_parser& parser, std::vector<uint32_t>& v, size_t n) {
+    v.resize(n);
+    auto* dst = reinterpret_cast<char*>(v.data());
+    parser.consume(
+      n * sizeof(uint32_t), [&dst](const char* src, size_t sz) {
+          std::memcpy(dst, src, sz);
+          dst += sz;
+          return ss::stop_iteration::no;
+      });
+    if constexpr (std::endian::native != std::endian::little) {
+        for (auto& e : v) {
+            e = ss::le_to_cpu(e);
+        }
+    }
+}
+} // namespace
+
 uint64_t index_state::checksum_state(const index_state& r) {
     auto xx = incremental_xxhash64{};
     xx.update_all(
@@ -33,15 +94,19 @@ uint64_t index_state::checksum_state(const index_state& r) {
       r.base_timestamp(),
       r.max_timestamp(),
       uint32_t(r.relative_offset_index.size()));
-    const uint32_t vsize = r.relative_offset_index.size();
-    for (auto i = 0U; i < vsize; ++i) {
-        xx.update(r.relative_offset_index[i]);
-    }
-    for (auto i = 0U; i < vsize; ++i) {
-        xx.update(r.relative_time_index[i]);
+    // equivalent to hashing every entry in turn
+    const size_t vbytes = r.relative_offset_index.size() * sizeof(uint32_t);
+    if (vbytes > 0) {
+        xx.update(
+          reinterpret_cast<const char*>(r.relative_offset_index.data()),
+          vbytes);
+        xx.update(
+          reinterpret_cast<const char*>(r.relative_time_index.data()), vbytes);
+        xx.update(
+          reinterpret_cast<const char*>(r.position_index.data()), vbytes);
     }
-    for (auto i = 0U; i < vsize; ++i) {
-        xx.update(r.position_index[i]);
+    if (r.is_sealed()) {
+        xx.update_all(r.segment_size, r.segment_checksum);
     }
     return xx.digest();
 }
@@ -91,21 +156,49 @@ std::ostream& operator<<(std::ostream& o, const index_state& s) {
              << ", base_offset:" << s.base_offset
              << ", max_offset:" << s.max_offset
              << ", base_timestamp:" << s.base_timestamp
-             << ", max_timestamp:" << s.max_timestamp << ", index("
+             << ", max_timestamp:" << s.max_timestamp
+             << ", segment_size:" << s.segment_size
+             << ", segment_checksum:" << s.segment_checksum << ", index("
              << s.relative_offset_index.size() << ","
              << s.relative_time_index.size() << "," << s.position_index.size()
              << ")}";
 }
 
-std::optional<index_state> index_state::hydrate_from_buffer(iobuf b) {
-    iobuf_parser parser(std::move(b));
-    index_state retval;
+namespace {
+struct decoded_header {
+    index_state state;
+    int8_t version;
+    uint32_t entries;
+};
+
+/**
+ * decodes the fixed size header and validates the version and the sizes
+ * recorded in it against the size of the whole index file.
+ */
+std::optional<decoded_header>
+decode_header(iobuf_parser& parser, size_t file_size) {
+    if (unlikely(parser.bytes_left() < legacy_header_bytes)) {
+        vlog(
+          stlog.debug,
+          "Index is smaller than its header. Got:{}, expected:{}",
+          parser.bytes_left(),
+          legacy_header_bytes);
+        return std::nullopt;
+    }
+    decoded_header h{};
+    auto& retval = h.state;
 
     size_t expected_size_adjustment = 0;
-    auto version = reflection::adl<int8_t>{}.from(parser);
-    switch (version) {
+    h.version = reflection::adl<int8_t>{}.from(parser);
+    switch (h.version) {
     case index_state::ondisk_version:
         break;
+    case 3:
+        // same layout without the segment summary
+        break;
+    case 2:
+        // same layout without padding
+        break;
     case 1:
         /*
          * version 1 code stored an on disk size that was calculated as 4 bytes
@@ -122,17 +215,18 @@ std::optional<index_state> index_state::hydrate_from_buffer(iobuf b) {
         vlog(
           stlog.debug,
           "Forcing index rebuild for unknown or unsupported version {}",
-          version);
+          h.version);
         return std::nullopt;
     }
 
     retval.size = reflection::adl<uint32_t>{}.from(parser);
     const auto expected_size = retval.size + expected_size_adjustment;
-    if (unlikely(parser.bytes_left() != expected_size)) {
+    const auto bytes_left = file_size - sizeof(int8_t) - sizeof(uint32_t);
+    if (unlikely(bytes_left != expected_size)) {
         vlog(
           stlog.debug,
           "Index size does not match header size. Got:{}, expected:{}",
-          parser.bytes_left(),
+          bytes_left,
           expected_size);
         return std::nullopt;
     }
@@ -148,22 +242,57 @@ std::optional<index_state> index_state::hydrate_from_buffer(iobuf b) {
     retval.max_timestamp = model::timestamp(
       reflection::adl<model::timestamp::type>{}.from(parser));
 
-    const uint32_t vsize = ss::le_to_cpu(
-      reflection::adl<uint32_t>{}.from(parser));
-    retval.relative_offset_index.reserve(vsize);
-    retval.relative_time_index.reserve(vsize);
-    retval.position_index.reserve(vsize);
-    for (auto i = 0U; i < vsize; ++i) {
-        retval.relative_offset_index.push_back(
-          reflection::adl<uint32_t>{}.from(parser));
+    h.entries = ss::le_to_cpu(reflection::adl<uint32_t>{}.from(parser));
+    const auto version_header_bytes = header_bytes_for(h.version);
+    if (h.version >= 4) {
+        const auto summary_bytes = version_header_bytes - legacy_header_bytes;
+        if (unlikely(parser.bytes_left() < summary_bytes)) {
+            vlog(stlog.debug, "Index is smaller than its segment summary");
+            return std::nullopt;
+        }
+        retval.segment_size = reflection::adl<uint32_t>{}.from(parser);
+        retval.segment_checksum = reflection::adl<uint32_t>{}.from(parser);
+    }
+    const size_t vbytes = size_t(h.entries) * sizeof(uint32_t);
+    size_t expected_payload = 3 * vbytes;
+    if (h.version >= 3) {
+        expected_payload = padding_for(version_header_bytes)
+                           + 3 * (vbytes + padding_for(vbytes));
+    }
+    if (unlikely(file_size - version_header_bytes != expected_payload)) {
+        vlog(
+          stlog.debug,
+          "Index payload size does not match {} entries. Got:{}, expected:{}",
+          h.entries,
+          file_size - version_header_bytes,
+          expected_payload);
+        return std::nullopt;
+    }
+    return h;
+}
+} // namespace
+
+std::optional<index_state> index_state::hydrate_from_buffer(iobuf b) {
+    const auto file_size = b.size_bytes();
+    iobuf_parser parser(std::move(b));
+    auto h = decode_header(parser, file_size);
+    if (!h) {
+        return std::nullopt;
     }
-    for (auto i = 0U; i < vsize; ++i) {
-        retval.relative_time_index.push_back(
-          reflection::adl<uint32_t>{}.from(parser));
+    auto& retval = h->state;
+    const size_t vbytes = size_t(h->entries) * sizeof(uint32_t);
+    const bool padded = h->version >= 3;
+    if (padded) {
+        parser.skip(padding_for(header_bytes_for(h->version)));
     }
-    for (auto i = 0U; i < vsize; ++i) {
-        retval.position_index.push_back(
-          reflection::adl<uint32_t>{}.from(parser));
+    for (auto* v :
+         {&retval.relative_offset_index,
+          &retval.relative_time_index,
+          &retval.position_index}) {
+        consume_array(parser, *v, h->entries);
+        if (padded) {
+            parser.skip(padding_for(vbytes));
+        }
     }
     const auto computed_checksum = storage::index_state::checksum_state(retval);
     if (unlikely(retval.checksum != computed_checksum)) {
@@ -174,7 +303,17 @@ std::optional<index_state> index_state::hydrate_from_buffer(iobuf b) {
           retval.checksum);
         return std::nullopt;
     }
-    return retval;
+    return std::move(retval);
+}
+
+std::optional<index_state>
+index_state::hydrate_header_from_buffer(iobuf b, size_t file_size) {
+    iobuf_parser parser(std::move(b));
+    auto h = decode_header(parser, file_size);
+    if (!h) {
+        return std::nullopt;
+    }
+    return std::move(h->state);
 }
 
 iobuf index_state::checksum_and_serialize() {
@@ -184,15 +323,10 @@ iobuf index_state::checksum_and_serialize() {
         && relative_offset_index.size() == position_index.size(),
       "ALL indexes must match in size. {}",
       *this);
-    const uint32_t final_size
-      = sizeof(storage::index_state::checksum)
-        + sizeof(storage::index_state::bitflags)
-        + sizeof(storage::index_state::base_offset)
-        + sizeof(storage::index_state::max_offset)
-        + sizeof(storage::index_state::base_timestamp)
-        + sizeof(storage::index_state::max_timestamp)
-        + sizeof(uint32_t) // index size
-        + (relative_offset_index.size() * (sizeof(uint32_t) * 3));
+    const size_t vbytes = relative_offset_index.size() * sizeof(uint32_t);
+    const uint32_t final_size = header_bytes - sizeof(int8_t) - sizeof(uint32_t)
+                                + padding_for(header_bytes)
+                                + 3 * (vbytes + padding_for(vbytes));
     size = final_size;
     checksum = storage::index_state::checksum_state(*this);
     reflection::serialize(
@@ -205,16 +339,14 @@ iobuf index_state::checksum_and_serialize() {
       max_offset(),
       base_timestamp(),
       max_timestamp(),
-      uint32_t(relative_offset_index.size()));
-    const uint32_t vsize = relative_offset_index.size();
-    for (auto i = 0U; i < vsize; ++i) {
-        reflection::adl<uint32_t>{}.to(out, relative_offset_index[i]);
-    }
-    for (auto i = 0U; i < vsize; ++i) {
-        reflection::adl<uint32_t>{}.to(out, relative_time_index[i]);
-    }
-    for (auto i = 0U; i < vsize; ++i) {
-        reflection::adl<uint32_t>{}.to(out, position_index[i]);
+      uint32_t(relative_offset_index.size()),
+      segment_size,
+      segment_checksum);
+    append_padding(out, padding_for(header_bytes));
+    for (const auto* v :
+         {&relative_offset_index, &relative_time_index, &position_index}) {
+        append_array(out, *v);
+        append_padding(out, padding_for(vbytes));
     }
     // add back the version and size field
     const auto expected_size = size + sizeof(int8_t) + sizeof(uint32_t);
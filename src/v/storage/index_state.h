@@ -19,22 +19,45 @@
 #include <optional>
 
 namespace storage {
-/* Fileformat:
+/* Fileformat (v4):
    1 byte  - version
    4 bytes - size - does not include the version or size
-   8 bytes - checksum - xxhash32 -- we checksum everything below the checksum
-   4 bytes - bitflags - unused
+   8 bytes - checksum - xxhash64 -- we checksum everything below the checksum
+   4 bytes - bitflags - sealed_flag
    8 bytes - based_offset
    8 bytes - max_offset
    8 bytes - base_time
    8 bytes - max_time
    4 bytes - index.size()
-   [] relative_offset_index
-   [] relative_time_index
-   [] position_index
+   4 bytes - segment_size
+   4 bytes - segment_checksum
+   [] zero padding up to the next page_alignment boundary
+   [] relative_offset_index, zero padded to page_alignment
+   [] relative_time_index, zero padded to page_alignment
+   [] position_index, zero padded to page_alignment
+
+   Entries are fixed width little endian uint32_t stored as a struct of arrays,
+   and every array starts at a page_alignment (cache line) boundary of the
+   file. The arrays are hydrated with bulk copies (or used in place from a DMA
+   read buffer) without decoding individual entries. Version 3 has no segment
+   summary, versions 1 and 2 also use the layout without padding. They are
+   still readable. The checksum does not cover the padding and is the same for
+   all versions, the summary is covered only if the sealed flag is set.
+
+   The segment summary is written when the appender of the segment is closed,
+   either on roll or on shutdown. It records the final size of the segment
+   file and a rolling crc32c of the header crc of every batch, which lets
+   recovery trust a sealed segment without replaying it.
  */
 struct index_state {
-    static constexpr int8_t ondisk_version = 2;
+    static constexpr int8_t ondisk_version = 4;
+    static constexpr size_t page_alignment = 64;
+    /// \brief size of the fixed header fields, including version and size
+    static constexpr size_t header_size = 61;
+    /// \brief size of the fixed header fields of versions 1 to 3
+    static constexpr size_t min_header_size = 53;
+    /// \brief bitflags: the segment summary is valid
+    static constexpr uint32_t sealed_flag = 1;
 
     index_state() = default;
     index_state(index_state&&) noexcept = default;
@@ -47,7 +70,7 @@ struct index_state {
     uint32_t size{0};
     /// \brief currently xxhash64
     uint64_t checksum{0};
-    /// \brief unused
+    /// \brief sealed_flag
     uint32_t bitflags{0};
     // the batch's base_offset of the first batch
     model::offset base_offset{0};
@@ -57,6 +80,10 @@ struct index_state {
     model::timestamp base_timestamp{0};
     // the batch's max_timestamp of the last batch
     model::timestamp max_timestamp{0};
+    // size of the segment file when it was sealed
+    uint32_t segment_size{0};
+    // rolling crc32c of the header crc of all batches of a sealed segment
+    uint32_t segment_checksum{0};
 
     /// breaking indexes into their own has a 6x latency reduction
     std::vector<uint32_t> relative_offset_index;
@@ -65,6 +92,18 @@ struct index_state {
 
     bool empty() const { return relative_offset_index.empty(); }
 
+    bool is_sealed() const { return (bitflags & sealed_flag) != 0; }
+    void seal(uint32_t size, uint32_t checksum) {
+        bitflags |= sealed_flag;
+        segment_size = size;
+        segment_checksum = checksum;
+    }
+    void unseal() {
+        bitflags &= ~sealed_flag;
+        segment_size = 0;
+        segment_checksum = 0;
+    }
+
     void
     add_entry(uint32_t relative_offset, uint32_t relative_time, uint32_t pos) {
         relative_offset_index.push_back(relative_offset);
@@ -94,6 +133,13 @@ struct index_state {
     friend bool operator==(const index_state&, const index_state&) = default;
 
     static std::optional<index_state> hydrate_from_buffer(iobuf);
+    /**
+     * \brief decodes only the header fields of an index of file_size bytes
+     * from a buffer holding at least header_size bytes. The entries are left
+     * empty and the checksum is not verified.
+     */
+    static std::optional<index_state>
+    hydrate_header_from_buffer(iobuf, size_t file_size);
     static uint64_t checksum_state(const index_state&);
     friend std::ostream& operator<<(std::ostream&, const index_state&);
 };
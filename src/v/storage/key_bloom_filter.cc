@@ -0,0 +1,115 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/key_bloom_filter.h"
+
+#include "hashing/xx.h"
+#include "reflection/adl.h"
+#include "storage/logger.h"
+#include "utils/file_io.h"
+#include "vlog.h"
+
+#include <seastar/core/seastar.hh>
+
+#include <fmt/format.h>
+
+namespace storage {
+
+key_bloom_filter::key_bloom_filter(size_t keys)
+  : _words(std::max<size_t>(1, (keys * bits_per_key + 63) / 64), 0) {}
+
+uint64_t key_bloom_filter::hash(bytes_view key) {
+    // NOLINTNEXTLINE
+    return xxhash_64(reinterpret_cast<const char*>(key.data()), key.size());
+}
+
+void key_bloom_filter::add(uint64_t hash) {
+    const uint64_t delta = (hash >> 32U) | 1U;
+    for (size_t i = 0; i < probes; ++i) {
+        const auto bit = (hash + i * delta) % bits();
+        _words[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+}
+
+bool key_bloom_filter::may_contain(uint64_t hash) const {
+    const uint64_t delta = (hash >> 32U) | 1U;
+    for (size_t i = 0; i < probes; ++i) {
+        const auto bit = (hash + i * delta) % bits();
+        if ((_words[bit / 64] & (uint64_t(1) << (bit % 64))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ss::sstring key_bloom_filter_path(const ss::sstring& index_path) {
+    return fmt::format("{}.bloom", index_path);
+}
+
+ss::future<> write_key_bloom_filter(
+  const ss::sstring& index_path,
+  const key_bloom_filter& filter,
+  uint32_t index_crc) {
+    iobuf buf;
+    reflection::serialize(buf, index_crc, filter.words());
+    return write_fully(
+      key_bloom_filter_path(index_path).c_str(), std::move(buf));
+}
+
+ss::future<std::optional<key_bloom_filter>>
+read_key_bloom_filter(const ss::sstring& index_path, uint32_t index_crc) {
+    auto path = key_bloom_filter_path(index_path);
+    if (!co_await ss::file_exists(path)) {
+        co_return std::nullopt;
+    }
+    try {
+        iobuf_parser parser(co_await read_fully(path.c_str()));
+        auto crc = reflection::adl<uint32_t>{}.from(parser);
+        if (crc != index_crc) {
+            co_return std::nullopt;
+        }
+        auto words = reflection::adl<std::vector<uint64_t>>{}.from(parser);
+        if (words.empty()) {
+            co_return std::nullopt;
+        }
+        co_return key_bloom_filter(std::move(words));
+    } catch (...) {
+        vlog(
+          stlog.warn,
+          "ignoring unreadable key filter {}: {}",
+          path,
+          std::current_exception());
+    }
+    co_return std::nullopt;
+}
+
+ss::future<>
+rename_key_bloom_filter(const ss::sstring& from, const ss::sstring& to) {
+    auto from_path = key_bloom_filter_path(from);
+    if (co_await ss::file_exists(from_path)) {
+        co_await ss::rename_file(from_path, key_bloom_filter_path(to));
+    }
+}
+
+ss::future<> remove_key_bloom_filter(const ss::sstring& index_path) {
+    auto path = key_bloom_filter_path(index_path);
+    try {
+        if (co_await ss::file_exists(path)) {
+            co_await ss::remove_file(path);
+        }
+    } catch (...) {
+        vlog(
+          stlog.warn,
+          "error removing key filter {}: {}",
+          path,
+          std::current_exception());
+    }
+}
+
+} // namespace storage
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+#include "bytes/bytes.h"
+#include "seastarx.h"
+
+#include <seastar/core/future.hh>
+#include <seastar/core/sstring.hh>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace storage {
+
+/// Bloom filter over the keys of a compacted index. The filter is written
+/// next to the index, see key_bloom_filter_path(), and lets point lookups
+/// skip the segments that cannot hold a key without reading their index.
+///
+/// Keys are hashed once with xxhash_64 and the probes are derived with
+/// double hashing. Callers truncate the keys the same way the compacted
+/// index does before hashing them.
+class key_bloom_filter {
+public:
+    static constexpr size_t bits_per_key = 10;
+    static constexpr size_t probes = 7;
+
+    /// filter sized for the given number of distinct keys
+    explicit key_bloom_filter(size_t keys);
+    explicit key_bloom_filter(std::vector<uint64_t> words) noexcept
+      : _words(std::move(words)) {}
+
+    static uint64_t hash(bytes_view);
+
+    void add(uint64_t hash);
+    void add(bytes_view key) { add(hash(key)); }
+
+    bool may_contain(uint64_t hash) const;
+    bool may_contain(bytes_view key) const { return may_contain(hash(key)); }
+
+    const std::vector<uint64_t>& words() const { return _words; }
+
+private:
+    size_t bits() const { return _words.size() * 64; }
+
+    std::vector<uint64_t> _words;
+};
+
+/// the filter of the compacted index at `index_path`
+ss::sstring key_bloom_filter_path(const ss::sstring& index_path);
+
+/// the filter is tagged with the crc of the index footer, so that a filter
+/// left behind by an older version of the index is never used
+ss::future<> write_key_bloom_filter(
+  const ss::sstring& index_path, const key_bloom_filter&, uint32_t index_crc);
+
+/// returns nullopt when there is no valid filter for the index
+ss::future<std::optional<key_bloom_filter>>
+read_key_bloom_filter(const ss::sstring& index_path, uint32_t index_crc);
+
+/// moves the filter along with its index, if any
+ss::future<>
+rename_key_bloom_filter(const ss::sstring& from, const ss::sstring& to);
+
+/// removes the filter of the index, if any. errors are only logged
+ss::future<> remove_key_bloom_filter(const ss::sstring& index_path);
+
+} // namespace storage
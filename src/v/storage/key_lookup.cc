@@ -0,0 +1,281 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/key_lookup.h"
+
+#include "model/record.h"
+#include "model/record_view.h"
+#include "storage/compacted_index.h"
+#include "storage/compacted_index_reader.h"
+#include "storage/disk_log_impl.h"
+#include "storage/key_bloom_filter.h"
+#include "storage/logger.h"
+#include "storage/parser_utils.h"
+#include "storage/segment.h"
+#include "storage/segment_utils.h"
+#include "storage/spill_key_index.h"
+#include "units.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/seastar.hh>
+
+#include <fmt/ostream.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace storage {
+
+namespace {
+
+bool key_equals(const model::record_field_view& k, bytes_view key) {
+    if (k.size() < 0 || static_cast<size_t>(k.size()) != key.size()) {
+        return false;
+    }
+    if (auto c = k.contiguous(); c) {
+        return *c == key;
+    }
+    return k.to_bytes() == key;
+}
+
+/// keeps the latest record of the key in the batches it is fed
+class key_scan_consumer {
+public:
+    key_scan_consumer(
+      bytes_view key, model::offset min_offset, model::offset max_offset)
+      : _key(key)
+      , _min_offset(min_offset)
+      , _max_offset(max_offset) {}
+
+    ss::future<ss::stop_iteration> operator()(model::record_batch b) {
+        if (!b.compressed()) {
+            consume_records(b);
+            return ss::make_ready_future<ss::stop_iteration>(
+              ss::stop_iteration::no);
+        }
+        return internal::decompress_batch(std::move(b))
+          .then([this](model::record_batch b) {
+              consume_records(b);
+              return ss::stop_iteration::no;
+          });
+    }
+
+    std::optional<key_lookup_result> end_of_stream() {
+        return std::move(_result);
+    }
+
+private:
+    void consume_records(const model::record_batch& b) {
+        model::for_each_record_view(b, [this, &b](model::record_view r) {
+            const auto o = b.base_offset() + model::offset(r.offset_delta());
+            if (
+              o < _min_offset || o > _max_offset
+              || !key_equals(r.key(), _key)) {
+                return;
+            }
+            _result = key_lookup_result{
+              .offset = o,
+              .timestamp = model::timestamp(
+                b.header().first_timestamp.value() + r.timestamp_delta())};
+            if (r.has_value()) {
+                _result->value = r.value().copy();
+            }
+        });
+    }
+
+    bytes_view _key;
+    model::offset _min_offset;
+    model::offset _max_offset;
+    std::optional<key_lookup_result> _result;
+};
+
+struct index_probe {
+    /// offset of the latest indexed record of the key
+    std::optional<model::offset> latest;
+    /// the key has records past the max offset, the index entry of an older
+    /// record may have been replaced by them
+    bool past_max_offset{false};
+};
+
+class index_probe_consumer {
+public:
+    index_probe_consumer(bytes_view key, model::offset max_offset)
+      : _key(key.substr(0, internal::spill_key_index::max_key_size))
+      , _max_offset(max_offset) {}
+
+    ss::future<ss::stop_iteration> operator()(compacted_index::entry e) {
+        if (
+          e.type == compacted_index::entry_type::key
+          && bytes_view(e.key) == _key) {
+            const auto o = e.offset + model::offset(e.delta);
+            if (o > _max_offset) {
+                _probe.past_max_offset = true;
+            } else if (!_probe.latest || *_probe.latest < o) {
+                _probe.latest = o;
+            }
+        }
+        return ss::make_ready_future<ss::stop_iteration>(
+          ss::stop_iteration::no);
+    }
+
+    index_probe end_of_stream() { return _probe; }
+
+private:
+    bytes_view _key;
+    model::offset _max_offset;
+    index_probe _probe;
+};
+
+struct segment_range {
+    model::offset base;
+    model::offset last;
+    /// compacted index of sealed compacted segments
+    std::optional<ss::sstring> index_path;
+};
+
+ss::future<std::optional<key_lookup_result>> scan_range(
+  log l,
+  const key_lookup_config& cfg,
+  model::offset base,
+  model::offset last) {
+    log_reader_config reader_cfg(base, last, cfg.prio);
+    reader_cfg.type_filter = cfg.type_filter;
+    // point lookups should not evict the tail of the log from the cache
+    reader_cfg.skip_batch_cache = true;
+    auto reader = co_await l.make_reader(reader_cfg);
+    co_return co_await std::move(reader).consume(
+      key_scan_consumer(cfg.key, base, last), model::no_timeout);
+}
+
+/// nullopt when the index cannot tell, e.g. it is missing or the segment
+/// was truncated after the records were indexed
+ss::future<std::optional<index_probe>>
+probe_index(const ss::sstring& path, const key_lookup_config& cfg) {
+    if (!co_await ss::file_exists(path)) {
+        co_return std::nullopt;
+    }
+    std::optional<compacted_index_reader> reader;
+    std::optional<index_probe> probe;
+    std::exception_ptr ex;
+    try {
+        auto f = co_await ss::open_file_dma(path, ss::open_flags::ro);
+        reader = make_file_backed_compacted_reader(
+          path, std::move(f), cfg.prio, 64_KiB);
+        auto footer = co_await reader->load_footer();
+        if (
+          (footer.flags & compacted_index::footer_flags::truncation)
+          != compacted_index::footer_flags::truncation) {
+            auto filter = co_await read_key_bloom_filter(path, footer.crc);
+            auto key = bytes_view(cfg.key).substr(
+              0, internal::spill_key_index::max_key_size);
+            if (filter && !filter->may_contain(key)) {
+                probe = index_probe{};
+            } else {
+                probe = co_await reader->consume(
+                  index_probe_consumer(cfg.key, cfg.max_offset),
+                  model::no_timeout);
+            }
+        }
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    if (reader) {
+        co_await reader->close();
+    }
+    if (ex) {
+        vlog(
+          stlog.info,
+          "scanning segment of unreadable compacted index {}: {}",
+          path,
+          ex);
+        co_return std::nullopt;
+    }
+    co_return probe;
+}
+
+ss::future<std::optional<key_lookup_result>>
+lookup_in_range(log l, const key_lookup_config& cfg, segment_range r) {
+    if (!r.index_path) {
+        co_return co_await scan_range(l, cfg, r.base, r.last);
+    }
+    auto probe = co_await probe_index(*r.index_path, cfg);
+    if (!probe || probe->past_max_offset) {
+        co_return co_await scan_range(l, cfg, r.base, r.last);
+    }
+    if (!probe->latest) {
+        co_return std::nullopt;
+    }
+    // the index holds truncated keys and deduplication may have removed the
+    // record since it was indexed, so the record is verified
+    auto found = co_await scan_range(l, cfg, *probe->latest, *probe->latest);
+    if (found) {
+        co_return found;
+    }
+    co_return co_await scan_range(l, cfg, r.base, r.last);
+}
+
+std::vector<segment_range>
+segment_ranges(const log& l, model::offset max_offset) {
+    std::vector<segment_range> ranges;
+    auto disk = dynamic_cast<disk_log_impl*>(l.get_impl());
+    if (!disk) {
+        const auto offsets = l.offsets();
+        ranges.push_back(segment_range{
+          .base = offsets.start_offset,
+          .last = std::min(offsets.dirty_offset, max_offset)});
+        return ranges;
+    }
+    for (const auto& seg : disk->segments()) {
+        const auto& offsets = seg->offsets();
+        if (
+          offsets.base_offset > max_offset
+          || offsets.dirty_offset < offsets.base_offset) {
+            continue;
+        }
+        segment_range r{
+          .base = offsets.base_offset,
+          .last = std::min(offsets.dirty_offset, max_offset)};
+        if (seg->is_compacted_segment() && !seg->has_appender()) {
+            r.index_path = internal::compacted_index_path(
+                             seg->reader().filename().c_str())
+                             .string();
+        }
+        ranges.push_back(std::move(r));
+    }
+    return ranges;
+}
+
+} // namespace
+
+ss::future<std::optional<key_lookup_result>>
+lookup_key(log l, key_lookup_config cfg) {
+    // the segments are copied since the set changes while they are probed. a
+    // segment removed in the meantime reads as empty
+    auto ranges = segment_ranges(l, cfg.max_offset);
+    for (auto it = ranges.rbegin(); it != ranges.rend(); ++it) {
+        auto found = co_await lookup_in_range(l, cfg, *it);
+        if (found) {
+            co_return found;
+        }
+    }
+    co_return std::nullopt;
+}
+
+std::ostream& operator<<(std::ostream& o, const key_lookup_result& r) {
+    fmt::print(
+      o,
+      "{{offset:{}, timestamp:{}, value_size:{}}}",
+      r.offset,
+      r.timestamp,
+      r.value ? static_cast<int64_t>(r.value->size_bytes()) : -1);
+    return o;
+}
+
+} // namespace storage
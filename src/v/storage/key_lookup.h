@@ -0,0 +1,52 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+#include "bytes/bytes.h"
+#include "bytes/iobuf.h"
+#include "model/fundamental.h"
+#include "model/record_batch_types.h"
+#include "model/timestamp.h"
+#include "seastarx.h"
+#include "storage/log.h"
+
+#include <seastar/core/future.hh>
+#include <seastar/core/io_priority_class.hh>
+
+#include <optional>
+
+namespace storage {
+
+struct key_lookup_config {
+    bytes key;
+    /// inclusive, records past it are not visible to the lookup
+    model::offset max_offset;
+    ss::io_priority_class prio;
+    std::optional<model::record_batch_type> type_filter;
+};
+
+struct key_lookup_result {
+    model::offset offset;
+    model::timestamp timestamp;
+    /// nullopt when the latest record of the key is a tombstone
+    std::optional<iobuf> value;
+
+    friend std::ostream& operator<<(std::ostream&, const key_lookup_result&);
+};
+
+/// Latest record of a key, the point lookup of compacted topics used as
+/// tables. Segments are probed newest-first: the key filter and compacted
+/// index of a sealed compacted segment locate the latest record of the key
+/// without reading the segment, the other segments are scanned.
+ss::future<std::optional<key_lookup_result>>
+lookup_key(log, key_lookup_config);
+
+} // namespace storage
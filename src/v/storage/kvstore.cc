@@ -20,9 +20,10 @@
 #include "storage/types.h"
 #include "vlog.h"
 
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/loop.hh>
 #include <seastar/core/metrics.hh>
 #include <seastar/core/thread.hh>
-#include <seastar/util/defer.hh>
 #include <seastar/util/log.hh>
 
 static ss::logger lg("kvstore");
@@ -36,7 +37,29 @@ kvstore::kvstore(kvstore_config kv_conf)
       std::filesystem::path(_ntpc.work_directory()),
       snapshot_manager::default_snapshot_filename,
       ss::default_priority_class())
-  , _timer([this] { _sem.signal(); }) {}
+  , _timer([this] { _sem.signal(); }) {
+    _partitions.reserve(key_space_count);
+    for (size_t i = 0; i < key_space_count; ++i) {
+        _partitions.emplace_back(snapshot_manager(
+          std::filesystem::path(_ntpc.work_directory()),
+          fmt::format("{}.{}", snapshot_manager::default_snapshot_filename, i),
+          ss::default_priority_class()));
+    }
+}
+
+kvstore::partition& kvstore::get_partition(key_space ks) {
+    const auto idx = static_cast<size_t>(ks);
+    vassert(idx < _partitions.size(), "Unknown key space {}", idx);
+    return _partitions[idx];
+}
+
+size_t kvstore::key_count() const {
+    size_t count = 0;
+    for (const auto& p : _partitions) {
+        count += p.db.size();
+    }
+    return count;
+}
 
 ss::future<> kvstore::start() {
     vlog(lg.debug, "Starting kvstore: dir {}", _ntpc.work_directory());
@@ -67,8 +90,19 @@ ss::future<> kvstore::start() {
               ss::metrics::description("Size of the database in memory")),
             ss::metrics::make_derive(
               "key_count",
-              [this] { return _db.size(); },
+              [this] { return key_count(); },
               ss::metrics::description("Number of keys in the database")),
+            ss::metrics::make_total_operations(
+              "snapshots_saved",
+              [this] { return _probe.snapshots_saved; },
+              ss::metrics::description(
+                "Number of key space snapshots written")),
+            ss::metrics::make_total_operations(
+              "snapshots_skipped",
+              [this] { return _probe.snapshots_skipped; },
+              ss::metrics::description(
+                "Number of key space snapshots skipped because the key space "
+                "was unchanged")),
           });
     }
 
@@ -143,13 +177,34 @@ static inline bytes make_spaced_key(kvstore::key_space ks, bytes_view key) {
     return spaced_key;
 }
 
+/*
+ * Inverse of make_spaced_key
+ */
+static inline std::pair<kvstore::key_space, bytes>
+split_spaced_key(bytes_view spaced_key) {
+    using ks_type = std::underlying_type<kvstore::key_space>::type;
+    if (spaced_key.size() < sizeof(ks_type)) {
+        throw std::runtime_error(fmt::format(
+          "Key of {} bytes is missing its key space", spaced_key.size()));
+    }
+    ks_type ks_le;
+    std::copy_n(
+      spaced_key.begin(), sizeof(ks_le), reinterpret_cast<char*>(&ks_le));
+    auto ks = ss::le_to_cpu(ks_le);
+    if (ks < 0 || static_cast<size_t>(ks) >= kvstore::key_space_count) {
+        throw std::runtime_error(
+          fmt::format("Unknown key space {}", static_cast<int>(ks)));
+    }
+    auto key = spaced_key.substr(sizeof(ks_le));
+    return {static_cast<kvstore::key_space>(ks), bytes(key.data(), key.size())};
+}
+
 std::optional<iobuf> kvstore::get(key_space ks, bytes_view key) {
     _probe.entry_fetched();
     vassert(_started, "kvstore has not been started");
 
-    // do not re-assign to string_view -> temporary
-    auto kkey = make_spaced_key(ks, key);
-    if (auto it = _db.find(kkey); it != _db.end()) {
+    auto& db = get_partition(ks).db;
+    if (auto it = db.find(key); it != db.end()) {
         return it->second.copy();
     }
     return std::nullopt;
@@ -165,13 +220,22 @@ ss::future<> kvstore::remove(key_space ks, bytes key) {
     return put(ks, std::move(key), std::nullopt);
 }
 
+void kvstore::for_each(
+  key_space ks,
+  ss::noncopyable_function<void(bytes_view, const iobuf&)> f) const {
+    vassert(_started, "kvstore has not been started");
+    for (const auto& [key, value] : _partitions[static_cast<size_t>(ks)].db) {
+        f(key, value);
+    }
+}
+
 ss::future<> kvstore::put(key_space ks, bytes key, std::optional<iobuf> value) {
     vassert(_started, "kvstore has not been started");
 
-    key = make_spaced_key(ks, key);
     return ss::with_gate(
-      _gate, [this, key = std::move(key), value = std::move(value)]() mutable {
-          auto& w = _ops.emplace_back(std::move(key), std::move(value));
+      _gate,
+      [this, ks, key = std::move(key), value = std::move(value)]() mutable {
+          auto& w = _ops.emplace_back(ks, std::move(key), std::move(value));
           if (!_timer.armed()) {
               _timer.arm(_conf.commit_interval);
           }
@@ -179,23 +243,26 @@ ss::future<> kvstore::put(key_space ks, bytes key, std::optional<iobuf> value) {
       });
 }
 
-void kvstore::apply_op(bytes key, std::optional<iobuf> value) {
-    auto it = _db.find(key);
-    bool found = it != _db.end();
+void kvstore::apply_op(key_space ks, bytes key, std::optional<iobuf> value) {
+    auto& p = get_partition(ks);
+    auto it = p.db.find(key);
+    bool found = it != p.db.end();
     if (value) {
         vlog(
           lg.trace,
-          "Apply op: {}: key={} value={}",
+          "Apply op: {}: key_space={} key={} value={}",
           (found ? "update" : "insert"),
+          static_cast<int>(ks),
           key,
           value);
+        p.dirty = true;
         if (found) {
             _probe.dec_cached_bytes(it->second.size_bytes());
             _probe.add_cached_bytes(value->size_bytes());
             it->second = std::move(*value);
         } else {
             _probe.add_cached_bytes(key.size() + value->size_bytes());
-            _db.emplace(std::move(key), std::move(*value));
+            p.db.emplace(std::move(key), std::move(*value));
         }
     } else {
         if (!found) {
@@ -203,7 +270,8 @@ void kvstore::apply_op(bytes key, std::optional<iobuf> value) {
         } else {
             vlog(lg.trace, "Apply op: delete: key={}", key);
             _probe.dec_cached_bytes(it->first.size() + it->second.size_bytes());
-            _db.erase(it);
+            p.db.erase(it);
+            p.dirty = true;
         }
     }
 }
@@ -224,7 +292,8 @@ ss::future<> kvstore::flush_and_apply_ops() {
             value = op.value->share(0, op.value->size_bytes());
         }
         builder.add_raw_kv(
-          bytes_to_iobuf(op.key), reflection::to_iobuf(std::move(value)));
+          bytes_to_iobuf(make_spaced_key(op.ks, op.key)),
+          reflection::to_iobuf(std::move(value)));
     }
     auto batch = std::move(builder).build();
     auto last_offset = batch.last_offset();
@@ -239,7 +308,7 @@ ss::future<> kvstore::flush_and_apply_ops() {
       .then([this](append_result) { return _segment->flush(); })
       .then([this, last_offset, ops = std::move(ops)]() mutable {
           for (auto& op : ops) {
-              apply_op(std::move(op.key), std::move(op.value));
+              apply_op(op.ks, std::move(op.key), std::move(op.value));
               op.done.set_value();
           }
           _next_offset = last_offset + model::offset(1);
@@ -306,108 +375,51 @@ ss::future<> kvstore::roll() {
     return ss::now();
 }
 
-ss::future<> kvstore::save_snapshot() {
-    vassert(
-      _next_offset >= model::offset(0),
-      "Unexpected next offset {}",
-      _next_offset);
-
-    // no operations have been applied to the db
-    if (_next_offset == model::offset(0)) {
-        return ss::now();
-    }
-
-    vlog(
-      lg.debug,
-      "Creating snapshot at offset {}",
-      _next_offset - model::offset(1));
-
-    // package up the db into a batch
-    storage::record_batch_builder builder(kvstore_batch_type, model::offset(0));
-    for (auto& entry : _db) {
-        builder.add_raw_kv(
-          bytes_to_iobuf(entry.first),
-          entry.second.share(0, entry.second.size_bytes()));
-    }
-    auto batch = std::move(builder).build();
+/*
+ * Snapshot files share a format: the metadata holds the last log offset that
+ * is covered and the body, if present, is a size prefixed batch of key-value
+ * records. The manifest has no body.
+ */
+struct kvstore_snapshot_contents {
+    model::offset last_offset;
+    std::optional<model::record_batch> batch;
+};
 
+static iobuf serialize_snapshot_batch(model::record_batch batch) {
     // serialize batch: size_prefix + batch
     iobuf data;
     auto ph = data.reserve(sizeof(int32_t));
     reflection::serialize(data, std::move(batch));
     auto size = ss::cpu_to_le(int32_t(data.size_bytes() - sizeof(int32_t)));
     ph.write((const char*)&size, sizeof(size));
-
-    return _snap.start_snapshot().then(
-      [this, data = std::move(data)](snapshot_writer writer) mutable {
-          return ss::do_with(
-            std::move(writer),
-            [this, data = std::move(data)](snapshot_writer& wr) mutable {
-                // the last log offset represented in the snapshot
-                auto last_offset = _next_offset - model::offset(1);
-
-                iobuf meta;
-                reflection::serialize(meta, last_offset);
-
-                return wr.write_metadata(std::move(meta))
-                  .then([&wr, data = std::move(data)]() mutable {
-                      auto& os = wr.output(); // kept alive by do_with above
-                      return write_iobuf_to_output_stream(std::move(data), os);
-                  })
-                  .then([&wr] { return wr.close(); })
-                  .then([this, &wr]() {
-                      vlog(lg.debug, "Finishing snapshot creation");
-                      return _snap.finish_snapshot(wr);
-                  });
-            });
-      });
+    return data;
 }
 
-ss::future<> kvstore::recover() {
-    return ss::async([this] {
-        /*
-         * after loading _next_offset will be set to either zero if no snapshot
-         * is found, or the offset immediately following the snapshot offset.
-         */
-        load_snapshot_in_thread();
-
-        auto dir = std::filesystem::path(_ntpc.work_directory());
-        auto segments = recover_segments(
-                          std::move(dir),
-                          debug_sanitize_files::yes,
-                          _ntpc.is_compacted(),
-                          [] { return std::nullopt; },
-                          _as)
-                          .get0();
-
-        replay_segments_in_thread(std::move(segments));
-    });
+static ss::future<>
+write_snapshot(snapshot_manager& snap, model::offset last_offset, iobuf data) {
+    auto wr = co_await snap.start_snapshot();
+    iobuf meta;
+    reflection::serialize(meta, last_offset);
+    co_await wr.write_metadata(std::move(meta));
+    co_await write_iobuf_to_output_stream(std::move(data), wr.output());
+    co_await wr.close();
+    co_await snap.finish_snapshot(wr);
 }
 
-void kvstore::load_snapshot_in_thread() {
-    _gate.check(); // early out on shutdown
-
-    // open snapshot reader, if a snapshot exists
-    auto reader = _snap.open_snapshot().get0();
-    if (!reader) {
-        vlog(lg.debug, "Load snapshot: no snapshot found");
-        _next_offset = model::offset(0);
-        return;
-    }
-    auto close_reader = ss::defer([&reader] { return reader->close().get(); });
+static ss::future<kvstore_snapshot_contents>
+read_snapshot_contents(snapshot_reader& reader) {
+    kvstore_snapshot_contents contents;
 
     // the snapshot metadata contains the last offset represented
-    auto snap_meta = reader->read_metadata().get0();
+    auto snap_meta = co_await reader.read_metadata();
     iobuf_parser parser(std::move(snap_meta));
-    auto last_offset = model::offset(
+    contents.last_offset = model::offset(
       reflection::adl<model::offset::type>{}.from(parser));
-    vlog(
-      lg.debug,
-      "Load snapshot: loading snapshot with last offset {}",
-      last_offset);
 
-    // read and restore db from snapshot
-    auto buf = read_iobuf_exactly(reader->input(), sizeof(int32_t)).get0();
+    auto buf = co_await read_iobuf_exactly(reader.input(), sizeof(int32_t));
+    if (buf.empty()) {
+        co_return contents;
+    }
     if (buf.size_bytes() != sizeof(int32_t)) {
         throw std::runtime_error(fmt::format(
           "Failed to read snapshot size. Wanted {} bytes != {}",
@@ -416,7 +428,7 @@ void kvstore::load_snapshot_in_thread() {
     }
     auto size = reflection::from_iobuf<int32_t>(std::move(buf));
 
-    buf = read_iobuf_exactly(reader->input(), size).get0();
+    buf = co_await read_iobuf_exactly(reader.input(), size);
     if ((int32_t)buf.size_bytes() != size) {
         throw std::runtime_error(fmt::format(
           "Failed to read snapshot data. Wanted {} bytes != {}",
@@ -440,10 +452,161 @@ void kvstore::load_snapshot_in_thread() {
           batch.header().header_crc));
     }
 
-    batch.for_each_record([this](model::record r) {
+    contents.batch = std::move(batch);
+    co_return contents;
+}
+
+static ss::future<std::optional<kvstore_snapshot_contents>>
+read_snapshot(snapshot_manager& snap) {
+    // open snapshot reader, if a snapshot exists
+    auto reader = co_await snap.open_snapshot();
+    if (!reader) {
+        co_return std::nullopt;
+    }
+    std::optional<kvstore_snapshot_contents> contents;
+    std::exception_ptr e;
+    try {
+        contents = co_await read_snapshot_contents(*reader);
+    } catch (...) {
+        e = std::current_exception();
+    }
+    co_await reader->close();
+    if (e) {
+        std::rethrow_exception(e);
+    }
+    co_return contents;
+}
+
+ss::future<> kvstore::save_snapshot() {
+    vassert(
+      _next_offset >= model::offset(0),
+      "Unexpected next offset {}",
+      _next_offset);
+
+    // no operations have been applied to the db
+    if (_next_offset == model::offset(0)) {
+        co_return;
+    }
+
+    // the last log offset represented in the snapshot
+    const auto last_offset = _next_offset - model::offset(1);
+    vlog(lg.debug, "Creating snapshot at offset {}", last_offset);
+
+    /*
+     * key space snapshots are written before the manifest. if this is
+     * interrupted recovery replays the log from the previous manifest offset
+     * on top of the newer key space snapshots, which yields the same state.
+     */
+    co_await ss::parallel_for_each(
+      _partitions, [this, last_offset](partition& p) {
+          if (!p.dirty) {
+              _probe.snapshot_skipped();
+              return ss::now();
+          }
+          return save_partition_snapshot(p, last_offset);
+      });
+
+    co_await write_snapshot(_snap, last_offset, iobuf());
+    vlog(lg.debug, "Finishing snapshot creation");
+}
+
+ss::future<>
+kvstore::save_partition_snapshot(partition& p, model::offset last_offset) {
+    // package up the key space into a batch
+    storage::record_batch_builder builder(kvstore_batch_type, model::offset(0));
+    for (auto& entry : p.db) {
+        builder.add_raw_kv(
+          bytes_to_iobuf(entry.first),
+          entry.second.share(0, entry.second.size_bytes()));
+    }
+    auto data = serialize_snapshot_batch(std::move(builder).build());
+
+    p.dirty = false;
+    try {
+        co_await write_snapshot(p.snap, last_offset, std::move(data));
+    } catch (...) {
+        p.dirty = true;
+        throw;
+    }
+    _probe.snapshot_saved();
+}
+
+ss::future<> kvstore::recover() {
+    /*
+     * after loading _next_offset will be set to either zero if no snapshot
+     * is found, or the offset immediately following the snapshot offset.
+     */
+    return load_snapshots().then([this] {
+        return ss::async([this] {
+            auto dir = std::filesystem::path(_ntpc.work_directory());
+            // every segment is replayed, so hydrate the indexes eagerly
+            recovery_timings timings;
+            auto segments = recover_segments(
+                              std::move(dir),
+                              debug_sanitize_files::yes,
+                              _ntpc.is_compacted(),
+                              [] { return std::nullopt; },
+                              _as,
+                              lazy_index_hydration::no,
+                              timings)
+                              .get0();
+
+            replay_segments_in_thread(std::move(segments));
+        });
+    });
+}
+
+ss::future<> kvstore::load_snapshots() {
+    _gate.check(); // early out on shutdown
+
+    co_await ss::parallel_for_each(_partitions, [this](partition& p) {
+        return load_partition_snapshot(p);
+    });
+
+    auto manifest = co_await read_snapshot(_snap);
+    if (!manifest) {
+        vlog(lg.debug, "Load snapshot: no snapshot found");
+        _next_offset = model::offset(0);
+        co_return;
+    }
+    vlog(
+      lg.debug,
+      "Load snapshot: loading snapshot with last offset {}",
+      manifest->last_offset);
+
+    if (manifest->batch) {
+        /*
+         * snapshot written before key spaces were snapshotted separately. it
+         * holds the entire database as of its offset, which takes precedence
+         * over any key space snapshot left behind by an interrupted save, and
+         * marks every key space it restores as dirty so that the snapshot
+         * taken at the end of recovery replaces it.
+         */
+        manifest->batch->for_each_record([this](model::record r) {
+            auto [ks, key] = split_spaced_key(
+              iobuf_to_bytes(r.release_key()));
+            apply_op(ks, std::move(key), r.release_value());
+        });
+    }
+
+    _next_offset = manifest->last_offset + model::offset(1);
+}
+
+ss::future<> kvstore::load_partition_snapshot(partition& p) {
+    auto snap = co_await read_snapshot(p.snap);
+    if (!snap || !snap->batch) {
+        co_return;
+    }
+    vlog(
+      lg.debug,
+      "Load snapshot: loading {} with last offset {}",
+      p.snap.snapshot_path().string(),
+      snap->last_offset);
+
+    snap->batch->for_each_record([this, &p](model::record r) {
         auto key = iobuf_to_bytes(r.release_key());
         _probe.add_cached_bytes(key.size() + r.value().size_bytes());
-        auto res = _db.emplace(std::move(key), r.release_value());
+        auto res = p.db.emplace(std::move(key), r.release_value());
         vassert(
           res.second, "Snapshot contained duplicate key {}", res.first->first);
         vlog(
@@ -452,8 +615,6 @@ void kvstore::load_snapshot_in_thread() {
           res.first->first,
           res.first->second);
     });
-
-    _next_offset = last_offset + model::offset(1);
 }
 
 void kvstore::replay_segments_in_thread(segment_set segs) {
@@ -567,10 +728,10 @@ batch_consumer::stop_parser kvstore::replay_consumer::consume_batch_end() {
       _header, std::move(_records), model::record_batch::tag_ctor_ng{});
 
     batch.for_each_record([this](model::record r) {
-        auto key = iobuf_to_bytes(r.release_key());
+        auto [ks, key] = split_spaced_key(iobuf_to_bytes(r.release_key()));
         auto value = reflection::from_iobuf<std::optional<iobuf>>(
           r.release_value());
-        _store->apply_op(std::move(key), std::move(value));
+        _store->apply_op(ks, std::move(key), std::move(value));
         _store->_next_offset += model::offset(1);
     });
 
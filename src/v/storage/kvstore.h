@@ -24,9 +24,13 @@
 #include <seastar/core/gate.hh>
 #include <seastar/core/semaphore.hh>
 #include <seastar/core/timer.hh>
+#include <seastar/util/noncopyable_function.hh>
 
 #include <absl/container/flat_hash_map.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace storage {
 
 /**
@@ -60,6 +64,18 @@ namespace storage {
  * in which access to the underlying file storing the metadata was already
  * controlled.
  *
+ * Snapshots
+ * =========
+ *
+ * Each key space is held in its own in-memory map and snapshot file. When the
+ * segment is rolled only the key spaces modified since their last snapshot
+ * are written out, followed by a small manifest recording the last log offset
+ * covered by the snapshots. Recovery loads the key space snapshots in parallel
+ * and then replays the log from the manifest offset. Replaying an operation
+ * over a snapshot that already contains it is harmless because the last write
+ * to a key wins, which is what makes the per key space snapshots consistent
+ * without rewriting all of them together.
+ *
  * Limitations
  * ===========
  *
@@ -97,9 +113,13 @@ public:
         consensus = 1,
         storage = 2,
         controller = 3,
+        coproc = 4,
         /* your sub-system here */
     };
 
+    /// number of key spaces. must be updated when adding a key space above
+    static constexpr size_t key_space_count = 5;
+
     explicit kvstore(kvstore_config kv_conf);
 
     ss::future<> start();
@@ -109,9 +129,17 @@ public:
     ss::future<> put(key_space ks, bytes key, iobuf value);
     ss::future<> remove(key_space ks, bytes key);
 
+    /// Visit every key of a key space, \p f must not modify the store
+    void for_each(
+      key_space ks,
+      ss::noncopyable_function<void(bytes_view, const iobuf&)> f) const;
+
     bool empty() const {
         vassert(_started, "kvstore has not been started");
-        return _db.empty();
+        return std::all_of(
+          _partitions.begin(), _partitions.end(), [](const partition& p) {
+              return p.db.empty();
+          });
     }
 
 private:
@@ -119,49 +147,73 @@ private:
     ntp_config _ntpc;
     ss::gate _gate;
     ss::abort_source _as;
+    // manifest holding the last log offset covered by the key space snapshots
     snapshot_manager _snap;
     bool _started{false};
 
+    using db_map
+      = absl::flat_hash_map<bytes, iobuf, bytes_type_hash, bytes_type_eq>;
+
+    /**
+     * The keys of a single key space. `dirty` is set when the map changes and
+     * cleared once its snapshot has been written.
+     */
+    struct partition {
+        explicit partition(snapshot_manager snap)
+          : snap(std::move(snap)) {}
+
+        db_map db;
+        snapshot_manager snap;
+        bool dirty{false};
+    };
+
     /**
      * Database operation. A std::nullopt value is a deletion.
      */
     struct op {
+        key_space ks;
         bytes key;
         std::optional<iobuf> value;
         ss::promise<> done;
 
-        op(bytes&& key, std::optional<iobuf>&& value)
-          : key(std::move(key))
+        op(key_space ks, bytes&& key, std::optional<iobuf>&& value)
+          : ks(ks)
+          , key(std::move(key))
           , value(std::move(value)) {}
     };
 
     /*
      * database operations are cached in `ops` and periodically flushed to the
-     * current `segment` at position `next_offset` and then applied to `db`.
-     * when the segment reaches a threshold size a snapshot is saved a new
-     * segment is created.
+     * current `segment` at position `next_offset` and then applied to the
+     * partition of their key space. when the segment reaches a threshold size
+     * the dirty partitions are snapshotted and a new segment is created.
      */
     std::vector<op> _ops;
     ss::timer<> _timer;
     ss::semaphore _sem{0};
     ss::lw_shared_ptr<segment> _segment;
     model::offset _next_offset;
-    absl::flat_hash_map<bytes, iobuf, bytes_type_hash, bytes_type_eq> _db;
+    std::vector<partition> _partitions;
+
+    partition& get_partition(key_space ks);
+    size_t key_count() const;
 
     ss::future<> put(key_space ks, bytes key, std::optional<iobuf> value);
-    void apply_op(bytes key, std::optional<iobuf> value);
+    void apply_op(key_space ks, bytes key, std::optional<iobuf> value);
     ss::future<> flush_and_apply_ops();
     ss::future<> roll();
     ss::future<> save_snapshot();
+    ss::future<> save_partition_snapshot(partition&, model::offset);
 
     /*
      * Recovery
      *
-     * 1. load snapshot if found
+     * 1. load key space snapshots in parallel, then the manifest
      * 2. then recover from segments
      */
     ss::future<> recover();
-    void load_snapshot_in_thread();
+    ss::future<> load_snapshots();
+    ss::future<> load_partition_snapshot(partition&);
     void replay_segments_in_thread(segment_set);
 
     /**
@@ -197,8 +249,12 @@ private:
         void entry_removed() { ++entries_removed; }
         void add_cached_bytes(size_t count) { cached_bytes += count; }
         void dec_cached_bytes(size_t count) { cached_bytes -= count; }
+        void snapshot_saved() { ++snapshots_saved; }
+        void snapshot_skipped() { ++snapshots_skipped; }
 
         uint64_t segments_rolled{0};
+        uint64_t snapshots_saved{0};
+        uint64_t snapshots_skipped{0};
         uint64_t entries_fetched{0};
         uint64_t entries_written{0};
         uint64_t entries_removed{0};
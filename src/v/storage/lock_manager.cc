@@ -37,14 +37,15 @@ range(segment_set::underlying_t segs) {
 ss::future<std::unique_ptr<lock_manager::lease>>
 lock_manager::range_lock(const timequery_config& cfg) {
     segment_set::underlying_t tmp;
-    std::copy_if(
-      _set.lower_bound(cfg.time),
-      _set.end(),
-      std::back_inserter(tmp),
-      [&cfg](ss::lw_shared_ptr<segment>& s) {
-          // must be base offset
-          return s->offsets().base_offset <= cfg.max_offset;
-      });
+    // segments are ordered by offset, so stop at the first one that starts
+    // past max_offset rather than walking the remainder of the log
+    for (auto it = _set.lower_bound(cfg.time); it != _set.end(); ++it) {
+        // must be base offset
+        if ((*it)->offsets().base_offset > cfg.max_offset) {
+            break;
+        }
+        tmp.push_back(*it);
+    }
     return range(std::move(tmp));
 }
 
@@ -72,6 +72,9 @@ public:
         virtual storage::offset_stats offsets() const = 0;
         virtual std::ostream& print(std::ostream& o) const = 0;
         virtual std::optional<model::term_id> get_term(model::offset) const = 0;
+        /// nullopt when the log has no data
+        virtual std::optional<term_end>
+          find_term_end(model::term_id) const = 0;
 
         virtual ss::future<model::offset>
         monitor_eviction(ss::abort_source&) = 0;
@@ -79,11 +82,42 @@ public:
         ss::lw_shared_ptr<storage::stm_manager> stm_manager() {
             return _stm_manager;
         }
+        /// the log coordinates with the state machines of another log, used
+        /// by a shared log partition that moves to a dedicated log
+        void share_stm_manager(ss::lw_shared_ptr<storage::stm_manager> m) {
+            _stm_manager = std::move(m);
+        }
 
         virtual size_t size_bytes() const = 0;
+        /// bytes of closed segments that are still waiting to be compacted
+        virtual size_t compaction_backlog() const = 0;
+        /// time at which compact() next has work to do with the config.
+        /// model::timestamp::min() when it has work now, max() when only a
+        /// new segment or a configuration update can give it work
+        virtual model::timestamp housekeeping_due(compaction_config) const {
+            return model::timestamp::min();
+        }
+        /// the log is archived up to and including the offset, its segments
+        /// below it can be trimmed under disk pressure
+        virtual void set_archived_offset(model::offset) {}
+        /// max timestamp of the oldest segment that can be trimmed under
+        /// disk pressure, only an archived one with \p archived_only
+        virtual std::optional<model::timestamp>
+        oldest_reclaimable(bool archived_only) const {
+            return std::nullopt;
+        }
+        /// trims the oldest segment, returns the bytes it freed
+        virtual ss::future<size_t>
+        reclaim_oldest_segment(bool archived_only, ss::abort_source&) {
+            return ss::make_ready_future<size_t>(0);
+        }
         virtual ss::future<>
           update_configuration(ntp_config::default_overrides) = 0;
 
+        virtual ss::future<std::optional<sealed_segment>>
+          get_sealed_segment(model::offset) = 0;
+        virtual ss::future<> adopt_segment(model::offset, model::term_id) = 0;
+
     private:
         ntp_config _config;
 
@@ -144,6 +178,11 @@ public:
     std::optional<model::term_id> get_term(model::offset o) const {
         return _impl->get_term(o);
     }
+    /// the end of a term, the answer to a kafka OffsetForLeaderEpoch. the
+    /// lookup is O(log n) over the segments
+    std::optional<term_end> find_term_end(model::term_id t) const {
+        return _impl->find_term_end(t);
+    }
     ss::future<std::optional<timequery_result>>
     timequery(timequery_config cfg) {
         return _impl->timequery(cfg);
@@ -181,6 +220,49 @@ public:
 
     size_t size_bytes() const { return _impl->size_bytes(); }
 
+    size_t compaction_backlog() const { return _impl->compaction_backlog(); }
+
+    model::timestamp housekeeping_due(compaction_config cfg) const {
+        return _impl->housekeeping_due(cfg);
+    }
+
+    void set_archived_offset(model::offset o) { _impl->set_archived_offset(o); }
+
+    std::optional<model::timestamp>
+    oldest_reclaimable(bool archived_only) const {
+        return _impl->oldest_reclaimable(archived_only);
+    }
+
+    ss::future<size_t>
+    reclaim_oldest_segment(bool archived_only, ss::abort_source& as) {
+        return _impl->reclaim_oldest_segment(archived_only, as);
+    }
+
+    /**
+     * \brief Returns the files of the segment starting at the base offset
+     *
+     * Returns nullopt when no segment starts at the offset or when the
+     * segment is still being appended to or its index is not sealed.
+     */
+    ss::future<std::optional<sealed_segment>>
+    get_sealed_segment(model::offset base_offset) {
+        return _impl->get_sealed_segment(base_offset);
+    }
+
+    /**
+     * \brief Appends a segment copied from another replica to the log
+     *
+     * The segment files have to be already in place, at the path of a segment
+     * with given base offset and term. The segment has to start right after
+     * the last offset of the log and its index has to be sealed. Every batch
+     * is checked against its crc and the sealed checksum of the index, a
+     * segment that fails is removed and an exception is thrown. The active
+     * segment of the log is closed.
+     */
+    ss::future<> adopt_segment(model::offset base_offset, model::term_id term) {
+        return _impl->adopt_segment(base_offset, term);
+    }
+
     impl* get_impl() const { return _impl.get(); }
 
 private:
@@ -197,6 +279,7 @@ class log_manager;
 class segment_set;
 class kvstore;
 log make_memory_backed_log(ntp_config);
-log make_disk_backed_log(ntp_config, log_manager&, segment_set, kvstore&);
+log make_disk_backed_log(
+  ntp_config, log_manager&, segment_set, kvstore&, const recovery_timings&);
 
 } // namespace storage
@@ -0,0 +1,278 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/log_deleter.h"
+
+#include "config/configuration.h"
+#include "prometheus/prometheus_sanitize.h"
+#include "storage/logger.h"
+#include "utils/directory_walker.h"
+#include "utils/mutex.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/file.hh>
+#include <seastar/core/metrics.hh>
+#include <seastar/core/seastar.hh>
+#include <seastar/core/sleep.hh>
+#include <seastar/core/smp.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <string_view>
+#include <vector>
+
+namespace storage {
+
+void log_deleter::start() {
+    setup_metrics();
+    (void)ss::with_gate(_gate, [this] {
+        auto f = ss::this_shard_id() == 0 ? recover() : ss::now();
+        return f
+          .handle_exception([](std::exception_ptr e) {
+              vlog(stlog.warn, "Error looking for deleted logs: {}", e);
+          })
+          .then([this] { return run(); });
+    });
+}
+
+ss::future<> log_deleter::stop() {
+    // the directories left are tombstoned, they are released after a restart
+    _as.request_abort();
+    _queued.broken();
+    _idle.broken();
+    return _gate.close();
+}
+
+ss::future<>
+log_deleter::remove(std::filesystem::path dir, uint64_t size_bytes) {
+    if (!co_await ss::file_exists(dir.string())) {
+        co_return;
+    }
+    auto tombstone = dir;
+    tombstone += std::string(tombstone_suffix);
+    try {
+        co_await ss::rename_file(dir.string(), tombstone.string());
+        co_await ss::sync_directory(dir.parent_path().string());
+    } catch (...) {
+        // released in place, it may get in the way of the same ntp
+        vlog(
+          stlog.warn,
+          "Cannot tombstone {}, deleting it in place: {}",
+          dir,
+          std::current_exception());
+        tombstone = dir;
+    }
+    enqueue(std::move(tombstone), size_bytes);
+}
+
+void log_deleter::enqueue(std::filesystem::path dir, uint64_t size_bytes) {
+    vlog(stlog.info, "Queued {} bytes of {} for deletion", size_bytes, dir);
+    _pending_bytes += size_bytes;
+    _queue.push_back(entry{.dir = std::move(dir), .size_bytes = size_bytes});
+    _queued.signal();
+}
+
+ss::future<> log_deleter::drained() {
+    return _idle.wait([this] { return pending_dirs() == 0; });
+}
+
+ss::future<> log_deleter::run() {
+    while (!_as.abort_requested()) {
+        try {
+            co_await _queued.wait([this] { return !_queue.empty(); });
+        } catch (const ss::broken_condition_variable&) {
+            co_return;
+        }
+        auto e = std::move(_queue.front());
+        _queue.pop_front();
+        _busy = true;
+        try {
+            co_await release_dir(e.dir);
+        } catch (...) {
+            vlog(
+              stlog.warn,
+              "Error deleting {}: {}",
+              e.dir,
+              std::current_exception());
+        }
+        _busy = false;
+        // whatever was left of the estimate is gone with the directory
+        _pending_bytes -= std::min(_pending_bytes, e.size_bytes);
+        if (pending_dirs() == 0) {
+            _pending_bytes = 0;
+            _idle.broadcast();
+        }
+    }
+}
+
+ss::future<> log_deleter::release_dir(std::filesystem::path dir) {
+    std::vector<std::filesystem::path> files;
+    co_await directory_walker::walk(
+      dir.string(), [&dir, &files](ss::directory_entry de) {
+          files.push_back(dir / de.name.c_str());
+          return ss::now();
+      });
+    for (auto& f : files) {
+        if (_as.abort_requested()) {
+            co_return;
+        }
+        try {
+            co_await release_file(f);
+        } catch (const ss::sleep_aborted&) {
+            co_return;
+        } catch (...) {
+            vlog(
+              stlog.info,
+              "error removing {}: {}",
+              f,
+              std::current_exception());
+        }
+    }
+    co_await ss::remove_file(dir.string());
+    vlog(stlog.info, "Finished deleting {}", dir);
+    // We always dispatch topic directory deletion to core 0 as the
+    // partitions of a topic live on different cores
+    co_await ss::smp::submit_to(
+      0, [topic_dir = dir.parent_path().string()]() mutable {
+          return remove_topic_dir_if_empty(std::move(topic_dir));
+      });
+}
+
+ss::future<> log_deleter::release_file(std::filesystem::path path) {
+    const auto name = path.string();
+    auto size = co_await ss::file_size(name);
+    const auto step = config::shard_local_cfg()
+                        .log_deletion_truncate_step_bytes();
+    if (step > 0 && size > step) {
+        auto f = co_await ss::open_file_dma(name, ss::open_flags::rw);
+        std::exception_ptr ex;
+        try {
+            // from the tail, the file stays readable as it shrinks
+            while (size > step) {
+                size -= step;
+                co_await f.truncate(size);
+                account(step);
+                co_await throttle(step);
+            }
+        } catch (...) {
+            ex = std::current_exception();
+        }
+        co_await f.close();
+        if (ex) {
+            std::rethrow_exception(ex);
+        }
+    }
+    co_await ss::remove_file(name);
+    account(size);
+    co_await throttle(size);
+}
+
+void log_deleter::account(uint64_t bytes) {
+    _deleted_bytes += bytes;
+    _pending_bytes -= std::min(_pending_bytes, bytes);
+}
+
+ss::future<> log_deleter::throttle(uint64_t bytes) {
+    const auto rate = double(
+      config::shard_local_cfg().log_deletion_rate_bytes_per_sec());
+    if (rate <= 0 || bytes == 0) {
+        return ss::now();
+    }
+    const auto wait = std::chrono::duration<double>(double(bytes) / rate);
+    return ss::sleep_abortable(
+      std::chrono::duration_cast<std::chrono::milliseconds>(wait), _as);
+}
+
+ss::future<> log_deleter::recover() {
+    co_await recover_dir(_base_dir);
+    for (const auto& dir : _extra_dirs) {
+        co_await recover_dir(dir);
+    }
+}
+
+ss::future<> log_deleter::recover_dir(const ss::sstring& base_dir) {
+    // <base_dir>/<namespace>/<topic>/<partition>_<revision>
+    co_await directory_walker::walk(
+      base_dir, [this, &base_dir](ss::directory_entry ns) {
+          if (
+            ns.type != ss::directory_entry_type::directory
+            || std::string_view(ns.name).starts_with(".")) {
+              return ss::now();
+          }
+          auto ns_dir = std::filesystem::path(base_dir) / ns.name.c_str();
+          return directory_walker::walk(
+            ns_dir.string(), [this, ns_dir](ss::directory_entry topic) {
+                if (topic.type != ss::directory_entry_type::directory) {
+                    return ss::now();
+                }
+                auto topic_dir = ns_dir / topic.name.c_str();
+                return directory_walker::walk(
+                  topic_dir.string(),
+                  [this, topic_dir](ss::directory_entry p) {
+                      if (std::string_view(p.name).ends_with(
+                            tombstone_suffix)) {
+                          enqueue(topic_dir / p.name.c_str(), 0);
+                      }
+                      return ss::now();
+                  });
+            });
+      });
+}
+
+ss::future<> log_deleter::remove_topic_dir_if_empty(ss::sstring dir) {
+    static thread_local mutex fs_lock;
+    return fs_lock.with([dir = std::move(dir)] {
+        return ss::file_exists(dir).then([dir](bool exists) {
+            if (!exists) {
+                return ss::now();
+            }
+            return directory_walker::empty(std::filesystem::path(dir))
+              .then([dir](bool empty) {
+                  if (!empty) {
+                      return ss::now();
+                  }
+                  return ss::remove_file(dir);
+              });
+        });
+    });
+}
+
+void log_deleter::setup_metrics() {
+    if (config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+    namespace sm = ss::metrics;
+    // one deleter per log_manager, which is identified by its data directory
+    const std::vector<sm::label_instance> labels = {
+      sm::label("directory")(_base_dir),
+    };
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("storage:log_deletion"),
+      {
+        sm::make_gauge(
+          "pending_partitions",
+          [this] { return pending_dirs(); },
+          sm::description("Removed partitions whose files are not released"),
+          labels),
+        sm::make_gauge(
+          "pending_bytes",
+          [this] { return _pending_bytes; },
+          sm::description(
+            "Estimated bytes of removed partitions still on disk"),
+          labels),
+        sm::make_derive(
+          "deleted_bytes",
+          [this] { return _deleted_bytes; },
+          sm::description("Bytes released from removed partitions"),
+          labels),
+      });
+}
+
+} // namespace storage
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "seastarx.h"
+
+#include <seastar/core/abort_source.hh>
+#include <seastar/core/condition-variable.hh>
+#include <seastar/core/future.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/core/sstring.hh>
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+namespace storage {
+
+/**
+ * Background release of the files of removed logs.
+ *
+ * Unlinking the segments of a large partition keeps the disk busy for a long
+ * time, and so would the removal of the partition if it waited for it. The
+ * directory of a removed log is renamed with the tombstone suffix right away,
+ * an ntp created again gets a fresh directory, and its files are released one
+ * at a time in the background at log_deletion_rate_bytes_per_sec. Files
+ * larger than log_deletion_truncate_step_bytes are truncated step by step
+ * before they are unlinked, so the filesystem frees their extents a little at
+ * a time.
+ *
+ * The tombstoned directories left by a restart are found again, under the base
+ * directory and the extra data directories, by the core 0 deleter when it
+ * starts.
+ */
+class log_deleter {
+public:
+    static constexpr std::string_view tombstone_suffix = ".deleted";
+
+    explicit log_deleter(
+      ss::sstring base_dir, std::vector<ss::sstring> extra_dirs = {}) noexcept
+      : _base_dir(std::move(base_dir))
+      , _extra_dirs(std::move(extra_dirs)) {}
+
+    void start();
+    ss::future<> stop();
+
+    /// \brief tombstones the directory of a closed log and queues its files
+    ss::future<> remove(std::filesystem::path dir, uint64_t size_bytes);
+
+    size_t pending_dirs() const { return _queue.size() + (_busy ? 1 : 0); }
+    uint64_t pending_bytes() const { return _pending_bytes; }
+    uint64_t deleted_bytes() const { return _deleted_bytes; }
+
+    /// \brief resolves once every queued directory is released
+    ss::future<> drained();
+
+private:
+    struct entry {
+        std::filesystem::path dir;
+        uint64_t size_bytes;
+    };
+
+    ss::future<> run();
+    ss::future<> recover();
+    ss::future<> recover_dir(const ss::sstring&);
+    ss::future<> release_dir(std::filesystem::path);
+    ss::future<> release_file(std::filesystem::path);
+    ss::future<> throttle(uint64_t bytes);
+    void account(uint64_t bytes);
+    void enqueue(std::filesystem::path, uint64_t);
+    void setup_metrics();
+
+    static ss::future<> remove_topic_dir_if_empty(ss::sstring dir);
+
+    ss::sstring _base_dir;
+    std::vector<ss::sstring> _extra_dirs;
+    std::deque<entry> _queue;
+    bool _busy{false};
+    uint64_t _pending_bytes{0};
+    uint64_t _deleted_bytes{0};
+    ss::condition_variable _queued;
+    ss::condition_variable _idle;
+    ss::gate _gate;
+    ss::abort_source _as;
+    ss::metrics::metric_groups _metrics;
+};
+
+} // namespace storage
@@ -25,6 +25,9 @@ struct log_housekeeping_meta {
     log handle;
     bitflags flags{bitflags::none};
     ss::lowres_clock::time_point last_compaction;
+    // when the log is next due for housekeeping, max() while it is not
+    // queued. see log_manager::housekeeping()
+    model::timestamp housekeeping_due{model::timestamp::max()};
 };
 
 inline log_housekeeping_meta::bitflags operator|(
@@ -12,6 +12,7 @@
 #include "config/configuration.h"
 #include "likely.h"
 #include "model/fundamental.h"
+#include "model/namespace.h"
 #include "model/timestamp.h"
 #include "resource_mgmt/io_priority.h"
 #include "storage/batch_cache.h"
@@ -26,11 +27,14 @@
 #include "storage/segment_reader.h"
 #include "storage/segment_set.h"
 #include "storage/segment_utils.h"
+#include "storage/shared_log.h"
+#include "syschecks/syschecks.h"
 #include "utils/directory_walker.h"
 #include "utils/file_sanitizer.h"
 #include "vlog.h"
 
 #include <seastar/core/abort_source.hh>
+#include <seastar/core/coroutine.hh>
 #include <seastar/core/file.hh>
 #include <seastar/core/future-util.hh>
 #include <seastar/core/future.hh>
@@ -42,21 +46,52 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
 #include <chrono>
 #include <exception>
 #include <filesystem>
 #include <optional>
+#include <tuple>
+#include <vector>
 
 namespace storage {
 using logs_type = absl::flat_hash_map<model::ntp, log_housekeeping_meta>;
 
+/// data directory of the log manager first, then the extra ones
+static std::vector<ss::sstring> data_directories(const log_config& cfg) {
+    std::vector<ss::sstring> dirs;
+    dirs.reserve(cfg.extra_dirs.size() + 1);
+    dirs.push_back(cfg.base_dir);
+    dirs.insert(dirs.end(), cfg.extra_dirs.begin(), cfg.extra_dirs.end());
+    return dirs;
+}
+
 log_manager::log_manager(log_config config, kvstore& kvstore) noexcept
   : _config(std::move(config))
   , _kvstore(kvstore)
   , _jitter(_config.compaction_interval)
-  , _batch_cache(config.reclaim_opts) {
+  , _batch_cache(config.reclaim_opts)
+  , _disk_space(data_directories(_config), _logs, _abort_source)
+  , _deleter(_config.base_dir, _config.extra_dirs)
+  , _recovery_sem(std::max<size_t>(_config.max_concurrent_recoveries, 1))
+  , _segment_pool(
+      std::filesystem::path(_config.base_dir) / ".segment_pool"
+        / std::to_string(ss::this_shard_id()),
+      _config.segment_pool_size,
+      segment_appender::fallocation_step)
+  , _flusher(_config.base_dir)
+  , _compactions(_config.base_dir)
+  , _shared(
+      _config.base_dir,
+      _config.shared_log_graduation_rate,
+      kvstore,
+      [this](ntp_config cfg) { return make_disk_log(std::move(cfg)); }) {
     _compaction_timer.set_callback([this] { trigger_housekeeping(); });
     _compaction_timer.rearm(_jitter());
+    _disk_space.start();
+    _deleter.start();
+    _flusher.start();
+    _compactions.start();
 }
 void log_manager::trigger_housekeeping() {
     (void)ss::with_gate(_open_gate, [this] {
@@ -77,68 +112,107 @@ void log_manager::trigger_housekeeping() {
 ss::future<> log_manager::stop() {
     _compaction_timer.cancel();
     _abort_source.request_abort();
-    return _open_gate.close()
+    // fail logs still waiting for recovery
+    _recovery_sem.broken();
+    return _disk_space.stop()
+      .then([this] { return _open_gate.close(); })
+      .then([this] { return _compactions.stop(); })
       .then([this] {
           return ss::parallel_for_each(_logs, [](logs_type::value_type& entry) {
               return entry.second.handle.close();
           });
       })
+      .then([this] { return _shared.stop(); })
+      .then([this] { return _flusher.stop(); })
+      .then([this] { return _deleter.stop(); })
+      .then([this] { return _segment_pool.stop(); })
       .then([this] { return _batch_cache.stop(); });
 }
 
-static inline logs_type::iterator find_next_non_compacted_log(logs_type& logs) {
-    using bflags = log_housekeeping_meta::bitflags;
-    return std::find_if(
-      logs.begin(), logs.end(), [](const logs_type::value_type& l) {
-          return bflags::none == (l.second.flags & bflags::compacted);
-      });
+compaction_config log_manager::housekeeping_config() {
+    auto collection_threshold = model::timestamp(
+      model::timestamp::now().value() - _config.delete_retention.count());
+    compaction_config cfg(
+      collection_threshold,
+      // TODO: [ch433] - this configuration needs to be updated
+      _config.retention_bytes,
+      _config.compaction_priority,
+      _abort_source);
+    cfg.skip_compaction = _disk_space.level()
+                          == disk_space_manager::pressure::critical;
+    return cfg;
+}
+
+void log_manager::schedule_housekeeping(const model::ntp& ntp) {
+    if (auto it = _logs.find(ntp); it != _logs.end()) {
+        schedule_housekeeping(it->second, model::timestamp::min());
+    }
+}
+
+void log_manager::schedule_housekeeping(
+  log_housekeeping_meta& meta, model::timestamp due) {
+    // the log is already queued for an earlier time
+    if (due >= meta.housekeeping_due) {
+        return;
+    }
+    meta.housekeeping_due = due;
+    _housekeeping_queue.push(
+      housekeeping_entry{.due = due, .ntp = meta.handle.config().ntp()});
 }
 
 ss::future<> log_manager::housekeeping() {
-    auto collection_threshold = model::timestamp(
-      model::timestamp::now().value() - _config.delete_retention.count());
     /**
-     * Note that this loop does a double find - which is not fast. This solution
-     * is the tradeoff to *not* lock the segment during log_manager::remove(ntp)
-     * and to *not* use an ordered container.
+     * Only the logs which are due take part in the round. A log is due when
+     * its oldest segment passes the retention time, or right away when it
+     * is over its retention size, is compacted, or a new segment or a
+     * configuration update may have given it work. Once the round is over
+     * the logs that took part tell when they are due again.
      *
-     * The issue with keeping an iterator and effectively doing a iterator++
-     * is that during a concurrent log_manager::remove() we invalidate all the
-     * iterators for the absl::flat_hash_map; - an alternative here would be to
-     * use a lock
-     *
-     * Note that we also do not use an ordered container like an absl::tree-set
-     * because finds are frequent on this datastructure and we want to serve
-     * them as fast as we can since the majority of the time they will be in the
-     * hotpath / (request-response)
+     * The round works on a snapshot of the log handles so that a concurrent
+     * log_manager::remove(ntp), which invalidates all the iterators of the
+     * absl::flat_hash_map, does not have to lock anything. The scheduler checks
+     * that a log is still managed right before compacting it.
      */
-    using bflags = log_housekeeping_meta::bitflags;
-    return ss::do_until(
-             [this] {
-                 auto it = find_next_non_compacted_log(_logs);
-                 return it == _logs.end();
-             },
-             [this, collection_threshold] {
-                 auto it = find_next_non_compacted_log(_logs);
-                 if (it == _logs.end()) {
-                     // must check again because between the stop condition
-                     // and this continuation we might have removed the log
-                     return ss::now();
-                 }
-                 it->second.flags |= bflags::compacted;
-                 it->second.last_compaction = ss::lowres_clock::now();
-                 return it->second.handle.compact(compaction_config(
-                   collection_threshold,
-                   // TODO: [ch433] - this configuration needs to be updated
-                   _config.retention_bytes,
-                   _config.compaction_priority,
-                   _abort_source));
-             })
-      .finally([this] {
-          for (auto& h : _logs) {
-              h.second.flags &= ~bflags::compacted;
-          }
-      });
+    auto cfg = housekeeping_config();
+    const auto now = model::timestamp::now();
+    const auto clock_now = ss::lowres_clock::now();
+    std::vector<log> logs;
+    while (!_housekeeping_queue.empty()
+           && _housekeeping_queue.top().due <= now) {
+        auto entry = _housekeeping_queue.top();
+        _housekeeping_queue.pop();
+        auto it = _logs.find(entry.ntp);
+        if (it == _logs.end() || it->second.housekeeping_due != entry.due) {
+            continue;
+        }
+        auto& meta = it->second;
+        // waits for the end of the round, events still reschedule it
+        meta.housekeeping_due = model::timestamp::max();
+        meta.last_compaction = clock_now;
+        logs.push_back(meta.handle);
+    }
+    if (logs.empty()) {
+        co_return;
+    }
+    vlog(
+      stlog.trace,
+      "Housekeeping round over {} of {} logs",
+      logs.size(),
+      _logs.size());
+    co_await _compactions.run(logs, cfg, [this](const log& l) {
+        // a log removed and managed again under the same ntp is another log
+        auto it = _logs.find(l.config().ntp());
+        return it != _logs.end()
+               && it->second.handle.get_impl() == l.get_impl();
+    });
+    co_await _shared.trim(_config.compaction_priority);
+    cfg = housekeeping_config();
+    for (auto& l : logs) {
+        if (auto it = _logs.find(l.config().ntp()); it != _logs.end()) {
+            auto& meta = it->second;
+            schedule_housekeeping(meta, meta.handle.housekeeping_due(cfg));
+        }
+    }
 }
 ss::future<ss::lw_shared_ptr<segment>> log_manager::make_log_segment(
   const ntp_config& ntp,
@@ -149,27 +223,54 @@ ss::future<ss::lw_shared_ptr<segment>> log_manager::make_log_segment(
   size_t buf_size) {
     return ss::with_gate(
       _open_gate, [this, &ntp, base_offset, term, pc, version, buf_size] {
-          return make_segment(
-            ntp,
-            base_offset,
-            term,
-            pc,
-            version,
-            buf_size,
-            _config.sanitize_fileops,
-            create_cache(ntp.cache_enabled()));
+          // hand over a pre-allocated file when one is ready. the spare
+          // files are renamed into place, they only serve the base directory
+          auto take = ntp.base_directory() == _config.base_dir
+                        ? _segment_pool.take(segment_path::make_segment_path(
+                          ntp, base_offset, term, version))
+                        : ss::make_ready_future<bool>(false);
+          return take.then(
+            [this, &ntp, base_offset, term, pc, version, buf_size](bool) {
+                auto cache = create_cache(
+                  ntp.cache_enabled(), ntp.cache_policy());
+                if (cache) {
+                    // the new segment is the tail of the log
+                    cache->retain_tail(_config.cache_retained_tail_size);
+                }
+                return make_segment(
+                  ntp,
+                  base_offset,
+                  term,
+                  pc,
+                  version,
+                  buf_size,
+                  _config.sanitize_fileops,
+                  std::move(cache),
+                  &_flusher);
+            });
       });
 }
 
+ss::future<ss::lw_shared_ptr<segment>> log_manager::open_log_segment(
+  const ntp_config& ntp, const std::filesystem::path& path) {
+    return ss::with_gate(_open_gate, [this, &ntp, path] {
+        return open_segment(
+          path,
+          _config.sanitize_fileops,
+          create_cache(ntp.cache_enabled(), ntp.cache_policy()));
+    });
+}
+
 std::optional<batch_cache_index>
-log_manager::create_cache(with_cache ntp_cache_enabled) {
+log_manager::create_cache(
+  with_cache ntp_cache_enabled, batch_cache_policy policy) {
     if (unlikely(
           _config.cache == with_cache::no
           || ntp_cache_enabled == with_cache::no)) {
         return std::nullopt;
     }
 
-    return batch_cache_index(_batch_cache);
+    return batch_cache_index(_batch_cache, policy);
 }
 
 ss::future<log> log_manager::manage(ntp_config cfg) {
@@ -178,6 +279,75 @@ ss::future<log> log_manager::manage(ntp_config cfg) {
     });
 }
 
+ss::future<ss::sstring>
+log_manager::select_data_directory(const ntp_config& cfg) {
+    if (_config.extra_dirs.empty()) {
+        co_return _config.base_dir;
+    }
+    auto dirs = data_directories(_config);
+
+    // a log recovered after a restart stays where it is
+    for (const auto& dir : dirs) {
+        ntp_config in_dir(cfg.ntp(), dir, nullptr, cfg.get_revision());
+        if (co_await ss::file_exists(in_dir.work_directory())) {
+            co_return dir;
+        }
+    }
+
+    struct candidate {
+        ss::sstring dir;
+        bool has_room;
+        size_t logs;
+        uint64_t free_bytes;
+    };
+    const auto target
+      = config::shard_local_cfg().disk_space_target_free_bytes();
+    std::vector<candidate> candidates;
+    candidates.reserve(dirs.size());
+    for (auto& dir : dirs) {
+        uint64_t free_bytes = 0;
+        try {
+            free_bytes = (co_await syschecks::disk_space(dir)).free_bytes;
+        } catch (...) {
+            vlog(
+              stlog.warn,
+              "Skipping data directory {} for {}: {}",
+              dir,
+              cfg.ntp(),
+              std::current_exception());
+            continue;
+        }
+        auto logs = std::count_if(
+          _logs.begin(), _logs.end(), [&dir](const logs_type::value_type& l) {
+              return l.second.handle.config().base_directory() == dir;
+          });
+        candidates.push_back(candidate{
+          .dir = std::move(dir),
+          .has_room = free_bytes > target,
+          .logs = static_cast<size_t>(logs),
+          .free_bytes = free_bytes,
+        });
+    }
+    if (candidates.empty()) {
+        co_return _config.base_dir;
+    }
+    auto it = std::min_element(
+      candidates.begin(),
+      candidates.end(),
+      [](const candidate& a, const candidate& b) {
+          return std::tuple(!a.has_room, a.logs, b.free_bytes)
+                 < std::tuple(!b.has_room, b.logs, a.free_bytes);
+      });
+    vlog(
+      stlog.info,
+      "Placing {} in {}, {} logs, {} bytes free",
+      cfg.ntp(),
+      it->dir,
+      it->logs,
+      it->free_bytes);
+    co_return it->dir;
+}
+
 ss::future<> log_manager::recover_log_state(const ntp_config& cfg) {
     return ss::file_exists(cfg.work_directory())
       .then(
@@ -193,39 +363,100 @@ ss::future<> log_manager::recover_log_state(const ntp_config& cfg) {
 
 ss::future<log> log_manager::do_manage(ntp_config cfg) {
     if (_config.base_dir.empty()) {
-        return ss::make_exception_future<log>(std::runtime_error(
-          "log_manager:: cannot have empty config.base_dir"));
+        throw std::runtime_error(
+          "log_manager:: cannot have empty config.base_dir");
     }
 
     vassert(
       _logs.find(cfg.ntp()) == _logs.end(), "cannot double register same ntp");
 
-    if (_config.stype == log_config::storage_type::memory) {
+    if (
+      _config.stype == log_config::storage_type::memory
+      || cfg.is_in_memory()) {
         auto path = cfg.work_directory();
         auto l = storage::make_memory_backed_log(std::move(cfg));
         _logs.emplace(l.config().ntp(), l);
+        schedule_housekeeping(l.config().ntp());
         // in-memory needs to write vote_for configuration
-        return ss::recursive_touch_directory(path).then([l] { return l; });
+        co_await ss::recursive_touch_directory(path);
+        co_return l;
     }
 
-    return recover_log_state(cfg).then([this, cfg = std::move(cfg)]() mutable {
-        ss::sstring path = cfg.work_directory();
-        with_cache cache_enabled = cfg.cache_enabled();
-        return recover_segments(
-                 std::filesystem::path(path),
-                 _config.sanitize_fileops,
-                 cfg.is_compacted(),
-                 [this, cache_enabled] { return create_cache(cache_enabled); },
-                 _abort_source)
-          .then([this, cfg = std::move(cfg)](segment_set segments) mutable {
-              auto l = storage::make_disk_backed_log(
-                std::move(cfg), *this, std::move(segments), _kvstore);
-              auto [_, success] = _logs.emplace(l.config().ntp(), l);
-              vassert(
-                success, "Could not keep track of:{} - concurrency issue", l);
-              return l;
-          });
-    });
+    if (use_shared_log(cfg)) {
+        co_return co_await manage_shared(std::move(cfg));
+    }
+    auto l = co_await make_disk_log(std::move(cfg));
+    track(l);
+    co_return l;
+}
+
+void log_manager::track(const log& l) {
+    auto [_, success] = _logs.emplace(l.config().ntp(), l);
+    vassert(success, "Could not keep track of:{} - concurrency issue", l);
+    schedule_housekeeping(l.config().ntp());
+}
+
+ss::future<log> log_manager::make_disk_log(ntp_config cfg) {
+    /*
+     * recovery is bounded per shard, as every log recovering at the same time
+     * opens its files and reads its indexes concurrently
+     */
+    using clock_type = std::chrono::steady_clock;
+    recovery_timings timings;
+    auto queued_start = clock_type::now();
+    auto units = co_await ss::get_units(_recovery_sem, 1);
+    timings.queued = std::chrono::duration_cast<std::chrono::milliseconds>(
+      clock_type::now() - queued_start);
+
+    _segment_pool.maybe_refill();
+    co_await recover_log_state(cfg);
+    ss::sstring path = cfg.work_directory();
+    with_cache cache_enabled = cfg.cache_enabled();
+    batch_cache_policy cache_policy = cfg.cache_policy();
+    auto segments = co_await recover_segments(
+      std::filesystem::path(path),
+      _config.sanitize_fileops,
+      cfg.is_compacted(),
+      [this, cache_enabled, cache_policy] {
+          return create_cache(cache_enabled, cache_policy);
+      },
+      _abort_source,
+      _config.lazy_index,
+      timings);
+    units.return_all();
+    vlog(stlog.debug, "Recovered {} in {}", cfg.ntp(), timings);
+
+    co_return storage::make_disk_backed_log(
+      std::move(cfg), *this, std::move(segments), _kvstore, timings);
+}
+
+bool log_manager::use_shared_log(const ntp_config& cfg) const {
+    // the physical log is in the base directory
+    return _config.shared_log_enabled
+           && cfg.ntp().ns == model::kafka_namespace && !cfg.is_compacted()
+           && cfg.base_directory() == _config.base_dir;
+}
+
+ss::future<log> log_manager::manage_shared(ntp_config cfg) {
+    co_await _shared.start();
+    const bool in_shared = _shared.contains(cfg);
+    {
+        auto dedicated = co_await make_disk_log(cfg.copy());
+        if (dedicated.segment_count() == 0) {
+            co_await dedicated.close();
+        } else if (in_shared) {
+            // the copy of a graduation that did not finish
+            vlog(stlog.info, "Removing partial dedicated log {}", dedicated);
+            co_await dedicated.remove();
+        } else {
+            // graduated
+            track(dedicated);
+            co_return dedicated;
+        }
+    }
+    auto l = _shared.make_log(std::move(cfg));
+    track(l);
+    co_return l;
 }
 
 ss::future<> log_manager::remove(model::ntp ntp) {
@@ -239,40 +470,43 @@ ss::future<> log_manager::remove(model::ntp ntp) {
         storage::log lg = handle.mapped().handle;
         vlog(stlog.info, "Removing: {}", lg);
         // NOTE: it is ok to *not* externally synchronize the log here
-        // because remove, takes a write lock on each individual segments
-        // waiting for all of them to be closed before actually removing the
-        // underlying log. If there is a background operation like
-        // compaction or so, it will block correctly.
-        auto ntp_dir = lg.config().work_directory();
-        ss::sstring topic_dir = lg.config().topic_directory().string();
-        return lg.remove()
-          .then([dir = std::move(ntp_dir)] { return ss::remove_file(dir); })
-          .then([this, dir = std::move(topic_dir)]() mutable {
-              // We always dispatch topic directory deletion to core 0 as
-              // requests may come from different cores
-              return dispatch_topic_dir_deletion(std::move(dir));
+        // because close, takes a write lock on each individual segments
+        // waiting for all of them to be closed before handing the files to
+        // the deleter. If there is a background operation like compaction
+        // or so, it will block correctly.
+        auto size = lg.size_bytes();
+        return lg.close()
+          .then([this, ntp = lg.config().ntp()] {
+              return _kvstore.remove(
+                kvstore::key_space::storage, internal::start_offset_key(ntp));
+          })
+          .then([this, ntp = lg.config().ntp()] {
+              // the partition is not recovered from the shared log anymore
+              return _shared.release(ntp);
+          })
+          .then([this, dir = lg.config().work_directory(), size] {
+              // the files are released in the background
+              return _deleter.remove(std::filesystem::path(dir), size);
           })
           .finally([lg] {});
     });
 }
 
-ss::future<> log_manager::dispatch_topic_dir_deletion(ss::sstring dir) {
-    return ss::smp::submit_to(0, [dir = std::move(dir)]() mutable {
-        static thread_local mutex fs_lock;
-        return fs_lock.with([dir = std::move(dir)] {
-            return ss::file_exists(dir).then([dir](bool exists) {
-                if (!exists) {
-                    return ss::now();
-                }
-                return directory_walker::empty(std::filesystem::path(dir))
-                  .then([dir](bool empty) {
-                      if (!empty) {
-                          return ss::now();
-                      }
-                      return ss::remove_file(dir);
-                  });
-            });
-        });
+ss::future<> log_manager::shutdown(model::ntp ntp) {
+    vlog(stlog.info, "Asked to shutdown: {}", ntp);
+    return ss::with_gate(_open_gate, [this, ntp = std::move(ntp)] {
+        auto handle = _logs.extract(ntp);
+        if (handle.empty()) {
+            return ss::make_ready_future<>();
+        }
+        storage::log lg = handle.mapped().handle;
+        vlog(stlog.info, "Shutting down: {}", lg);
+        auto f = ss::now();
+        if (auto shared = dynamic_cast<shared_log_impl*>(lg.get_impl())) {
+            // the log may be managed next on another shard
+            f = shared->graduate();
+        }
+        return f.then([lg]() mutable { return lg.close(); }).finally([lg] {});
     });
 }
 
@@ -318,7 +552,20 @@ std::ostream& operator<<(std::ostream& o, const log_config& c) {
     return o << ", compaction_interval_ms:" << c.compaction_interval.count()
              << ", delete_reteion_ms:" << c.delete_retention.count()
              << ", with_cache:" << c.cache
-             << ", relcaim_opts:" << c.reclaim_opts << "}";
+             << ", relcaim_opts:" << c.reclaim_opts
+             << ", max_concurrent_recoveries:" << c.max_concurrent_recoveries
+             << ", lazy_index_hydration:" << c.lazy_index
+             << ", segment_pool_size:" << c.segment_pool_size
+             << ", compaction_key_map_memory:" << c.compaction_key_map_memory
+             << ", segment_target_lifetime_ms:"
+             << c.segment_target_lifetime.value_or(std::chrono::milliseconds(0))
+                  .count()
+             << ", cache_retained_tail_size:" << c.cache_retained_tail_size
+             << ", adaptive_segment_size:[" << c.min_adaptive_segment_size
+             << ", " << c.max_adaptive_segment_size << "]"
+             << ", shared_log:" << c.shared_log_enabled
+             << ", shared_log_graduation_rate:"
+             << c.shared_log_graduation_rate << "}";
 }
 std::ostream& operator<<(std::ostream& o, const log_manager& m) {
     return o << "{config:" << m._config << ", logs.size:" << m._logs.size()
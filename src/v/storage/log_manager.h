@@ -15,10 +15,17 @@
 #include "random/simple_time_jitter.h"
 #include "seastarx.h"
 #include "storage/batch_cache.h"
+#include "storage/compaction_scheduler.h"
+#include "storage/disk_space_manager.h"
+#include "storage/flush_scheduler.h"
+#include "storage/log_deleter.h"
 #include "storage/log.h"
 #include "storage/log_housekeeping_meta.h"
 #include "storage/ntp_config.h"
+#include "storage/read_ahead.h"
 #include "storage/segment.h"
+#include "storage/segment_file_pool.h"
+#include "storage/shared_log.h"
 #include "storage/types.h"
 #include "storage/version.h"
 #include "units.h"
@@ -29,6 +36,7 @@
 #include <seastar/core/future.hh>
 #include <seastar/core/gate.hh>
 #include <seastar/core/lowres_clock.hh>
+#include <seastar/core/semaphore.hh>
 #include <seastar/core/sstring.hh>
 
 #include <absl/container/flat_hash_map.h>
@@ -37,6 +45,9 @@
 #include <array>
 #include <chrono>
 #include <optional>
+#include <queue>
+#include <string_view>
+#include <vector>
 
 namespace storage {
 
@@ -118,6 +129,40 @@ struct log_config {
     // same as delete.retention.ms in kafka - default 1 week
     std::chrono::milliseconds delete_retention = std::chrono::minutes(10080);
     with_cache cache = with_cache::yes;
+    // idle log readers kept for reuse by subsequent reads are closed after
+    std::chrono::milliseconds readers_cache_eviction_timeout
+      = std::chrono::seconds(30);
+    // read-ahead limits of sequential readers, see read_ahead_tracker
+    read_ahead_tracker::limits read_ahead_limits{};
+    // number of logs of a shard that may be recovering concurrently
+    size_t max_concurrent_recoveries = 16;
+    // load only the header of indexes of older segments on recovery, the
+    // entries are loaded by the first read of each segment
+    lazy_index_hydration lazy_index = lazy_index_hydration::no;
+    // number of empty pre-allocated segment files kept ready per shard so
+    // that segment rolls do not create files inline. zero disables the pool
+    size_t segment_pool_size = 0;
+    // memory of the key to offset map used to deduplicate keys across all
+    // segments of a compacted log. zero disables cross segment deduplication
+    size_t compaction_key_map_memory = 0;
+    // data directories on other disks where new logs may be placed besides
+    // base_dir, see log_manager::select_data_directory
+    std::vector<ss::sstring> extra_dirs;
+    // when set, the segment size of a log follows its ingest rate so that the
+    // active segment is rolled after about this long, within the bounds
+    // below. logs with a segment size override keep it
+    std::optional<std::chrono::milliseconds> segment_target_lifetime;
+    // most recently written bytes of each log kept in the batch cache, so
+    // that a follower is warm when it becomes the leader, see batch_cache
+    size_t cache_retained_tail_size = 0;
+    size_t min_adaptive_segment_size = 16_MiB;
+    size_t max_adaptive_segment_size = 4_GiB;
+    // partitions of the kafka namespace that are not compacted append into
+    // one physical log per shard until they get hot, see shared_log
+    bool shared_log_enabled = false;
+    // append rate in bytes per second over which a partition of the shared
+    // log moves to a dedicated log
+    size_t shared_log_graduation_rate = 64_KiB;
     batch_cache::reclaim_options reclaim_opts{
       .growth_window = std::chrono::seconds(3),
       .stable_window = std::chrono::seconds(10),
@@ -170,6 +215,9 @@ public:
     /**
      * Remove an ntp and clean-up its storage.
      *
+     * Resolves once the log is closed and its directory tombstoned, the files
+     * are released in the background by the log_deleter.
+     *
      * NOTE: if removal of an ntp causes the parent topic directory to become
      * empty then it is also removed. Currently topic deletion is the only
      * action that drives partition removal, so this makes sense. This must be
@@ -178,6 +226,12 @@ public:
      */
     ss::future<> remove(model::ntp);
 
+    /**
+     * Stop managing an ntp and close its log, the files are left in place so
+     * that the log can be managed again, e.g. by another shard.
+     */
+    ss::future<> shutdown(model::ntp);
+
     ss::future<> stop();
 
     ss::future<ss::lw_shared_ptr<segment>> make_log_segment(
@@ -188,11 +242,28 @@ public:
       record_version_type = record_version_type::v1,
       size_t buffer_size = default_segment_readahead_size);
 
+    /// Opens a segment file of the log that was created outside of the log
+    ss::future<ss::lw_shared_ptr<segment>>
+    open_log_segment(const ntp_config&, const std::filesystem::path&);
+
     const log_config& config() const { return _config; }
 
+    /**
+     * \brief base directory for the log of \p cfg: the data directory that
+     * holds it already or else, among those with more than the target free
+     * space, the one with the fewest logs of the shard. The most free space
+     * breaks ties.
+     */
+    ss::future<ss::sstring> select_data_directory(const ntp_config& cfg);
+
     /// Returns the number of managed logs.
     size_t size() const { return _logs.size(); }
 
+    /// Returns the bytes reclaimed so far from the batch cache of the shard.
+    uint64_t batch_cache_reclaimed_bytes() const {
+        return _batch_cache.reclaimed_bytes();
+    }
+
     /// Returns the log for the specified ntp.
     std::optional<log> get(const model::ntp& ntp) {
         if (auto it = _logs.find(ntp); it != _logs.end()) {
@@ -207,10 +278,56 @@ public:
     /// Returns all ntp's managed by this instance
     absl::flat_hash_set<model::ntp> get_all_ntps() const;
 
+    const log_deleter& deleter() const { return _deleter; }
+    log_deleter& deleter() { return _deleter; }
+
+    /// Returns the compaction scheduler of the shard
+    const internal::compaction_scheduler& compactions() const {
+        return _compactions;
+    }
+
+    /// Returns the highest disk space pressure of the data directories
+    disk_space_manager::pressure disk_space_pressure() const {
+        return _disk_space.level();
+    }
+
+    /// Returns the disk space pressure of the data directory \p dir
+    disk_space_manager::pressure
+    disk_space_pressure(std::string_view dir) const {
+        return _disk_space.level(dir);
+    }
+
+    /// Makes the log due at the next housekeeping round, for the events
+    /// that may give it work: a new segment or a configuration update
+    void schedule_housekeeping(const model::ntp&);
+
 private:
     using logs_type = absl::flat_hash_map<model::ntp, log_housekeeping_meta>;
 
+    struct housekeeping_entry {
+        model::timestamp due;
+        model::ntp ntp;
+    };
+    struct housekeeping_entry_later {
+        bool operator()(
+          const housekeeping_entry& a, const housekeeping_entry& b) const {
+            return a.due > b.due;
+        }
+    };
+    using housekeeping_queue_t = std::priority_queue<
+      housekeeping_entry,
+      std::vector<housekeeping_entry>,
+      housekeeping_entry_later>;
+
+    void schedule_housekeeping(log_housekeeping_meta&, model::timestamp);
+    compaction_config housekeeping_config();
+
     ss::future<log> do_manage(ntp_config);
+    /// opens the disk log of \p cfg, recovering its segments
+    ss::future<log> make_disk_log(ntp_config);
+    bool use_shared_log(const ntp_config&) const;
+    ss::future<log> manage_shared(ntp_config);
+    void track(const log&);
 
     /**
      * \brief delete old segments and trigger compacted segments
@@ -220,9 +337,9 @@ private:
     void arm_housekeeping();
     ss::future<> housekeeping();
 
-    std::optional<batch_cache_index> create_cache(with_cache);
+    std::optional<batch_cache_index>
+    create_cache(with_cache, batch_cache_policy);
 
-    ss::future<> dispatch_topic_dir_deletion(ss::sstring dir);
     ss::future<> recover_log_state(const ntp_config&);
 
     log_config _config;
@@ -230,9 +347,19 @@ private:
     simple_time_jitter<ss::lowres_clock> _jitter;
     ss::timer<ss::lowres_clock> _compaction_timer;
     logs_type _logs;
+    // logs by the time they are due for housekeeping. an entry is stale
+    // once the due time of its log changed, stale entries are skipped
+    housekeeping_queue_t _housekeeping_queue;
     batch_cache _batch_cache;
     ss::gate _open_gate;
     ss::abort_source _abort_source;
+    disk_space_manager _disk_space;
+    log_deleter _deleter;
+    ss::semaphore _recovery_sem;
+    segment_file_pool _segment_pool;
+    internal::flush_scheduler _flusher;
+    internal::compaction_scheduler _compactions;
+    shared_log _shared;
 
     friend std::ostream& operator<<(std::ostream&, const log_manager&);
 };
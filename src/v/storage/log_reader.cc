@@ -80,8 +80,12 @@ void skipping_consumer::consume_records(iobuf&& records) {
 batch_consumer::stop_parser skipping_consumer::consume_batch_end() {
     // Note: This is what keeps the train moving. the `_reader.*` transitively
     // updates the next batch to consume
-    _reader.add_one(model::record_batch(
-      _header, std::move(_records), model::record_batch::tag_ctor_ng{}));
+    if (_reader._config.passthrough) {
+        _reader.pass_one(_header, std::move(_records));
+    } else {
+        _reader.add_one(model::record_batch(
+          _header, std::move(_records), model::record_batch::tag_ctor_ng{}));
+    }
     // We keep the batch in the buffer so that the reader can be cached.
     if (
       _header.last_offset() >= _reader._seg.offsets().stable_offset
@@ -109,18 +113,28 @@ void skipping_consumer::print(std::ostream& os) const {
 }
 
 log_segment_batch_reader::log_segment_batch_reader(
-  segment& seg, log_reader_config& config, probe& p) noexcept
+  segment& seg,
+  log_reader_config& config,
+  probe& p,
+  read_ahead_tracker& read_ahead) noexcept
   : _seg(seg)
   , _config(config)
-  , _probe(p) {}
+  , _probe(p)
+  , _read_ahead(read_ahead) {}
 
 std::unique_ptr<continuous_batch_parser> log_segment_batch_reader::initialize(
   model::timeout_clock::time_point timeout,
   std::optional<model::offset> next_cached_batch) {
-    auto input = _seg.offset_data_stream(_config.start_offset, _config.prio);
+    auto buffering = _read_ahead.buffering();
+    auto input = _seg.offset_data_stream(
+      _config.start_offset, _config.prio, buffering);
+    _read_ahead.stream_opened();
+    _reopen_stream = false;
+    auto consumer = std::make_unique<skipping_consumer>(
+      *this, timeout, next_cached_batch);
+    _consumer = consumer.get();
     return std::make_unique<continuous_batch_parser>(
-      std::make_unique<skipping_consumer>(*this, timeout, next_cached_batch),
-      std::move(input));
+      std::move(consumer), std::move(input));
 }
 
 ss::future<> log_segment_batch_reader::close() {
@@ -130,18 +144,49 @@ ss::future<> log_segment_batch_reader::close() {
     return ss::make_ready_future<>();
 }
 
+void log_segment_batch_reader::account(
+  const model::record_batch_header& header) {
+    _config.start_offset = header.last_offset() + model::offset(1);
+    const auto size_bytes = header.size_bytes;
+    _config.bytes_consumed += size_bytes;
+    _probe.add_bytes_read(size_bytes);
+    if (_read_ahead.is_sequential()) {
+        _probe.add_read_ahead_bytes_read(size_bytes);
+    }
+    if (_seg.has_cache()) {
+        _probe.batch_cache_miss();
+    }
+    if (_read_ahead.record_disk_read(size_bytes)) {
+        _probe.read_ahead_promotion();
+        _reopen_stream = true;
+    }
+}
+
 void log_segment_batch_reader::add_one(model::record_batch&& batch) {
     _state.buffer.emplace_back(std::move(batch));
     const auto& b = _state.buffer.back();
-    _config.start_offset = b.header().last_offset() + model::offset(1);
+    account(b.header());
     const auto size_bytes = b.header().size_bytes;
-    _config.bytes_consumed += size_bytes;
     _state.buffer_size += size_bytes;
-    _probe.add_bytes_read(size_bytes);
-    if (!_config.skip_batch_cache) {
-        _seg.cache_put(b);
+    if (_config.skip_batch_cache) {
+        // the payload still references the read buffers of the input stream
+        _probe.add_uncached_bytes_read(size_bytes);
+        return;
     }
+    _seg.cache_put(b);
+}
+
+/*
+ * the buffered size is not updated, the sink holds the batches and the read
+ * is bounded by its byte budget only
+ */
+void log_segment_batch_reader::pass_one(
+  const model::record_batch_header& header, iobuf&& records) {
+    account(header);
+    _probe.add_passthrough_bytes_read(header.size_bytes);
+    _config.passthrough->append(header, std::move(records));
 }
+
 ss::future<result<records_t>>
 log_segment_batch_reader::read_some(model::timeout_clock::time_point timeout) {
     /*
@@ -159,6 +204,8 @@ log_segment_batch_reader::read_some(model::timeout_clock::time_point timeout) {
     // handles cases where the type filter skipped batches. see
     // batch_cache_index::read for more details.
     _config.start_offset = cache_read.next_batch;
+    _probe.add_batch_cache_hits(
+      cache_read.probation_hits, cache_read.protected_hits);
 
     if (
       !cache_read.batches.empty()
@@ -167,6 +214,14 @@ log_segment_batch_reader::read_some(model::timeout_clock::time_point timeout) {
         _probe.add_bytes_read(cache_read.memory_usage);
         _probe.add_cached_bytes_read(cache_read.memory_usage);
         _probe.add_cached_batches_read(cache_read.batches.size());
+        if (_config.passthrough) {
+            for (auto& b : cache_read.batches) {
+                auto header = b.header();
+                _config.passthrough->append(
+                  header, std::move(b).release_data());
+            }
+            return ss::make_ready_future<result<records_t>>(records_t{});
+        }
         return ss::make_ready_future<result<records_t>>(
           std::move(cache_read.batches));
     }
@@ -181,9 +236,34 @@ log_segment_batch_reader::read_some(model::timeout_clock::time_point timeout) {
         return ss::make_ready_future<result<records_t>>(records_t{});
     }
 
+    /*
+     * a parser that stopped in the middle of a batch or reached the end of its
+     * input stream (the stream is bounded by the file size at creation time)
+     * cannot continue. this is common for reused readers, so open a new
+     * stream from the index at the current start offset. the same is done
+     * when the reader has been promoted to a larger read-ahead.
+     */
+    ss::future<> f = ss::now();
+    if (_iterator && (_iterator->needs_restart() || _reopen_stream)) {
+        auto raw = _iterator.get();
+        f = raw->close().finally([p = std::move(_iterator)] {});
+        _consumer = nullptr;
+    }
     if (!_iterator) {
-        _iterator = initialize(timeout, cache_read.next_cached_batch);
+        // segments recovered lazily load their index on first read
+        f = f.then([this] { return _seg.hydrate_index(); });
     }
+    return f.then([this, timeout, next = cache_read.next_cached_batch] {
+        if (!_iterator) {
+            _iterator = initialize(timeout, next);
+        } else {
+            _consumer->reset(timeout, next);
+        }
+        return do_read_some();
+    });
+}
+
+ss::future<result<records_t>> log_segment_batch_reader::do_read_some() {
     auto ptr = _iterator.get();
     return ptr->consume().then(
       [this](result<size_t> bytes_consumed) -> result<records_t> {
@@ -191,6 +271,9 @@ log_segment_batch_reader::read_some(model::timeout_clock::time_point timeout) {
               return bytes_consumed.error();
           }
           auto tmp = std::exchange(_state, {});
+          // slices are bounded by size, the next one likely holds as many
+          // batches as this one
+          _state.buffer.reserve(tmp.buffer.size());
           return result<records_t>(std::move(tmp.buffer));
       });
 }
@@ -198,29 +281,49 @@ log_segment_batch_reader::read_some(model::timeout_clock::time_point timeout) {
 log_reader::log_reader(
   std::unique_ptr<lock_manager::lease> l,
   log_reader_config config,
-  probe& probe) noexcept
+  probe& probe,
+  read_ahead_tracker read_ahead) noexcept
   : _lease(std::move(l))
   , _iterator(_lease->range.begin())
   , _config(config)
-  , _probe(probe) {
-    if (config.abort_source) {
-        auto op_sub = config.abort_source.value().get().subscribe(
-          [this]() noexcept { set_end_of_stream(); });
-
-        if (op_sub) {
-            _as_sub = std::move(*op_sub);
-        } else {
-            // already aborted
-            set_end_of_stream();
-        }
-    }
+  , _probe(probe)
+  , _read_ahead(read_ahead) {
+    subscribe_abort_source();
 
     if (_iterator.next_seg != _lease->range.end()) {
         _iterator.reader = std::make_unique<log_segment_batch_reader>(
-          **_iterator.next_seg, _config, _probe);
+          **_iterator.next_seg, _config, _probe, _read_ahead);
     }
 }
 
+void log_reader::subscribe_abort_source() {
+    if (!_config.abort_source) {
+        return;
+    }
+    auto op_sub = _config.abort_source.value().get().subscribe(
+      [this]() noexcept { set_end_of_stream(); });
+
+    if (op_sub) {
+        _as_sub = std::move(*op_sub);
+    } else {
+        // already aborted
+        set_end_of_stream();
+    }
+}
+
+void log_reader::reset_config(log_reader_config cfg) {
+    vassert(
+      cfg.start_offset == _config.start_offset,
+      "reused reader must continue from {}, requested {}",
+      _config.start_offset,
+      cfg.start_offset);
+    _as_sub = {};
+    // the segment readers reference the config, so assign in place
+    _config = cfg;
+    _last_base = model::offset{};
+    subscribe_abort_source();
+}
+
 ss::future<> log_reader::find_next_valid_iterator() {
     if (_config.start_offset <= _iterator.offsets().dirty_offset) {
         return ss::make_ready_future<>();
@@ -237,7 +340,7 @@ ss::future<> log_reader::find_next_valid_iterator() {
     }
     if (_iterator.next_seg != _lease->range.end()) {
         _iterator.reader = std::make_unique<log_segment_batch_reader>(
-          **_iterator.next_seg, _config, _probe);
+          **_iterator.next_seg, _config, _probe, _read_ahead);
     }
     if (tmp_reader) {
         auto raw = tmp_reader.get();
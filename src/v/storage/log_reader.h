@@ -17,6 +17,7 @@
 #include "storage/lock_manager.h"
 #include "storage/parser.h"
 #include "storage/probe.h"
+#include "storage/read_ahead.h"
 #include "storage/segment_reader.h"
 #include "storage/segment_set.h"
 #include "storage/types.h"
@@ -70,6 +71,15 @@ public:
     stop_parser consume_batch_end() override;
     void print(std::ostream&) const override;
 
+    /// \brief rebinds the per-read stop conditions when the parser owning
+    /// this consumer is reused by a subsequent read
+    void reset(
+      model::timeout_clock::time_point timeout,
+      std::optional<model::offset> next_cached_batch) {
+        _timeout = timeout;
+        _next_cached_batch = next_cached_batch;
+    }
+
 private:
     log_segment_batch_reader& _reader;
     model::record_batch_header _header;
@@ -84,7 +94,10 @@ public:
     static constexpr size_t max_buffer_size = 32 * 1024; // 32KB
 
     log_segment_batch_reader(
-      segment&, log_reader_config& config, probe& p) noexcept;
+      segment&,
+      log_reader_config& config,
+      probe& p,
+      read_ahead_tracker& read_ahead) noexcept;
     log_segment_batch_reader(log_segment_batch_reader&&) noexcept = default;
     log_segment_batch_reader&
     operator=(log_segment_batch_reader&&) noexcept = delete;
@@ -103,7 +116,11 @@ private:
       model::timeout_clock::time_point,
       std::optional<model::offset> next_cached_batch);
 
+    ss::future<result<ss::circular_buffer<model::record_batch>>> do_read_some();
+
     void add_one(model::record_batch&&);
+    void pass_one(const model::record_batch_header&, iobuf&&);
+    void account(const model::record_batch_header&);
 
 private:
     struct tmp_state {
@@ -116,7 +133,14 @@ private:
     log_reader_config& _config;
     probe& _probe;
 
+    read_ahead_tracker& _read_ahead;
+
     std::unique_ptr<continuous_batch_parser> _iterator;
+    // owned by _iterator
+    skipping_consumer* _consumer{nullptr};
+    // the reader was promoted to a larger read-ahead, replace the stream at
+    // the next batch boundary
+    bool _reopen_stream{false};
     tmp_state _state;
     friend class skipping_consumer;
 };
@@ -128,7 +152,10 @@ public:
     using storage_t = model::record_batch_reader::storage_t;
 
     log_reader(
-      std::unique_ptr<lock_manager::lease>, log_reader_config, probe&) noexcept;
+      std::unique_ptr<lock_manager::lease>,
+      log_reader_config,
+      probe&,
+      read_ahead_tracker = {}) noexcept;
 
     ~log_reader() final {
         vassert(!_iterator.reader, "log reader destroyed with live reader");
@@ -146,9 +173,34 @@ public:
         fmt::print(os, "storage::log_reader. config {}", _config);
     }
 
+    /// \brief true if the read configured by the current config is complete
+    /// even though the segments covered by the lease are not exhausted. a
+    /// reader in this state may be reset and reused (see readers_cache)
+    bool is_done();
+
+    /// \brief rebinds an idle reader to a new read request that starts at
+    /// next_read_lower_bound(). the open segment reader and its input stream
+    /// are retained.
+    void reset_config(log_reader_config);
+
+    /// \brief releases the abort source and the passthrough sink of the last
+    /// read so that an idle reader does not outlive the request that created
+    /// it
+    void release_abort_source() {
+        _as_sub = {};
+        _config.abort_source = std::nullopt;
+        _config.passthrough = nullptr;
+    }
+
+    model::offset next_read_lower_bound() const {
+        return _config.start_offset;
+    }
+
+    const lock_manager::lease& lease() const { return *_lease; }
+
 private:
     void set_end_of_stream() { _iterator.next_seg = _lease->range.end(); }
-    bool is_done();
+    void subscribe_abort_source();
     ss::future<> find_next_valid_iterator();
 
     using reader_available = ss::bool_class<struct create_reader_tag>;
@@ -178,6 +230,7 @@ private:
     log_reader_config _config;
     model::offset _last_base;
     probe& _probe;
+    read_ahead_tracker _read_ahead;
     ss::abort_source::subscription _as_sub;
 };
 
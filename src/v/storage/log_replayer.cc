@@ -86,6 +86,63 @@ private:
     size_t _file_pos_to_end_of_batch{0};
 };
 
+/// Folds the header crcs the same way segment_index does when it tracks
+/// batches, see index_state::segment_checksum. Optionally checks the crc of
+/// the records of every batch too.
+class seal_verifying_consumer final : public batch_consumer {
+public:
+    explicit seal_verifying_consumer(
+      log_replayer::verify_records verify) noexcept
+      : _verify_records(verify) {}
+
+    consume_result consume_batch_start(
+      model::record_batch_header header,
+      size_t physical_base_offset,
+      size_t size_on_disk) override {
+        _crc.extend(header.header_crc);
+        _file_pos = physical_base_offset + size_on_disk;
+        if (!_verify_records) {
+            return skip_batch::yes;
+        }
+        _header = header;
+        _batch_crc = crc32();
+        model::crc_record_batch_header(_batch_crc, header);
+        return skip_batch::no;
+    }
+
+    void consume_records(iobuf&& records) override {
+        crc_extend_iobuf(_batch_crc, records);
+    }
+
+    stop_parser consume_batch_end() override {
+        if ((uint32_t)_header.crc != _batch_crc.value()) {
+            _records_valid = false;
+            return stop_parser::yes;
+        }
+        return stop_parser::no;
+    }
+
+    void print(std::ostream& os) const override {
+        fmt::print(
+          os,
+          "storage::seal_verifying_consumer file_pos {}, crc {}",
+          _file_pos,
+          _crc.value());
+    }
+
+    uint32_t checksum() const { return _crc.value(); }
+    size_t file_pos() const { return _file_pos; }
+    bool records_valid() const { return _records_valid; }
+
+private:
+    log_replayer::verify_records _verify_records;
+    crc32 _crc;
+    size_t _file_pos{0};
+    model::record_batch_header _header;
+    crc32 _batch_crc;
+    bool _records_valid{true};
+};
+
 // Called in the context of a ss::thread
 log_replayer::checkpoint
 log_replayer::recover_in_thread(const ss::io_priority_class& prio) {
@@ -109,6 +166,50 @@ log_replayer::recover_in_thread(const ss::io_priority_class& prio) {
     return _ckpt;
 }
 
+// Called in the context of a ss::thread
+bool log_replayer::verify_seal_in_thread(
+  const ss::io_priority_class& prio, verify_records verify) {
+    auto consumer = std::make_unique<seal_verifying_consumer>(verify);
+    auto& verifier = *consumer;
+    auto parser = continuous_batch_parser(
+      std::move(consumer), _seg->reader().data_stream(0, prio));
+    try {
+        parser.consume().get();
+        parser.close().get();
+    } catch (...) {
+        vlog(
+          stlog.info,
+          "{} failed seal verification with: {}",
+          _seg->reader().filename(),
+          std::current_exception());
+        return false;
+    }
+    if (!verifier.records_valid()) {
+        vlog(
+          stlog.info,
+          "{} failed seal verification, invalid batch crc before {}",
+          _seg->reader().filename(),
+          verifier.file_pos());
+        return false;
+    }
+    auto& idx = _seg->index();
+    if (
+      verifier.file_pos() != idx.sealed_size()
+      || verifier.checksum() != idx.sealed_checksum()) {
+        vlog(
+          stlog.info,
+          "{} does not match its sealed index, parsed {} bytes with checksum "
+          "{}, sealed {} bytes with checksum {}",
+          _seg->reader().filename(),
+          verifier.file_pos(),
+          verifier.checksum(),
+          idx.sealed_size(),
+          idx.sealed_checksum());
+        return false;
+    }
+    return true;
+}
+
 std::ostream& operator<<(std::ostream& o, const log_replayer::checkpoint& c) {
     o << "{ last_offset: ";
     if (c.last_offset) {
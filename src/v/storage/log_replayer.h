@@ -38,6 +38,16 @@ public:
     // Must be called in the context of a ss::thread
     checkpoint recover_in_thread(const ss::io_priority_class&);
 
+    using verify_records = ss::bool_class<struct verify_records_tag>;
+
+    /// \brief checks the data of a segment against its sealed index. The
+    /// batch headers have to parse up to the sealed size and their crcs have
+    /// to match the sealed checksum. Records are not indexed, and are only
+    /// checksummed against their batch crc with verify_records::yes. Must be
+    /// called in the context of a ss::thread
+    bool verify_seal_in_thread(
+      const ss::io_priority_class&, verify_records = verify_records::no);
+
 private:
     checkpoint _ckpt;
     segment* _seg;
@@ -7,6 +7,7 @@
 // the Business Source License, use of this software will be governed
 // by the Apache License, Version 2.0
 
+#include "config/configuration.h"
 #include "likely.h"
 #include "model/fundamental.h"
 #include "model/record.h"
@@ -160,8 +161,56 @@ struct mem_log_impl final : log::impl {
     ss::future<> remove() final { return ss::make_ready_future<>(); }
     ss::future<> flush() final { return ss::make_ready_future<>(); }
     ss::future<> compact(compaction_config cfg) final {
-        return gc(cfg.eviction_time, cfg.max_bytes);
+        return gc(eviction_time(cfg), max_bytes(cfg.max_bytes));
     }
+
+    model::timestamp eviction_time(const compaction_config& cfg) const {
+        if (!config().has_overrides()) {
+            return cfg.eviction_time;
+        }
+        const auto& retention = config().get_overrides().retention_time;
+        if (retention.is_disabled()) {
+            return model::timestamp::min();
+        }
+        if (retention.has_value()) {
+            return model::timestamp(
+              model::timestamp::now().value() - retention.value().count());
+        }
+        return cfg.eviction_time;
+    }
+
+    std::optional<size_t> max_bytes(std::optional<size_t> max) const {
+        if (config().has_overrides()) {
+            const auto& retention = config().get_overrides().retention_bytes;
+            if (retention.is_disabled()) {
+                max = std::nullopt;
+            }
+            if (retention.has_value()) {
+                max = retention.value();
+            }
+        }
+        // a topic in memory has a bound, whatever its retention
+        if (config().is_in_memory()) {
+            max = std::min(
+              max.value_or(std::numeric_limits<size_t>::max()),
+              config::shard_local_cfg().in_memory_log_max_bytes());
+        }
+        return max;
+    }
+
+    /// evicts the oldest batches of a topic in memory over its bound, the
+    /// ones below the collectible offset right away, the others once raft
+    /// took the snapshot the eviction monitor asks for
+    void enforce_bound() {
+        if (!config().is_in_memory()) {
+            return;
+        }
+        auto max = max_bytes(std::nullopt);
+        if (max && _probe.partition_bytes > *max) {
+            (void)gc(model::timestamp::min(), max);
+        }
+    }
+
     std::ostream& print(std::ostream& o) const final {
         fmt::print(o, "{{mem_log_impl:{}}}", offsets());
         return o;
@@ -274,6 +323,10 @@ struct mem_log_impl final : log::impl {
         }
 
         if (it != _data.begin()) {
+            // erasing from the deque invalidates the iterators of readers
+            for (auto& reader : _readers) {
+                reader.invalidate();
+            }
             _data.erase(_data.begin(), it);
             _data.shrink_to_fit();
         }
@@ -349,6 +402,29 @@ struct mem_log_impl final : log::impl {
         return std::nullopt;
     }
 
+    std::optional<term_end> find_term_end(model::term_id term) const final {
+        if (_data.empty()) {
+            return std::nullopt;
+        }
+        auto it = std::upper_bound(
+          std::cbegin(_data),
+          std::cend(_data),
+          term,
+          [](model::term_id t, const model::record_batch& b) {
+              return t < b.term();
+          });
+        if (it == _data.end()) {
+            return term_end{
+              .term = _data.back().term(),
+              .end_offset = _data.back().last_offset() + model::offset(1)};
+        }
+        if (it == _data.begin()) {
+            return term_end{.term = term, .end_offset = it->base_offset()};
+        }
+        return term_end{
+          .term = std::prev(it)->term(), .end_offset = it->base_offset()};
+    }
+
     size_t segment_count() const final { return 1; }
 
     storage::offset_stats offsets() const final {
@@ -381,6 +457,20 @@ struct mem_log_impl final : log::impl {
           });
     }
 
+    size_t compaction_backlog() const final { return 0; }
+
+    ss::future<std::optional<sealed_segment>>
+    get_sealed_segment(model::offset) final {
+        // there are no segment files
+        return ss::make_ready_future<std::optional<sealed_segment>>(
+          std::nullopt);
+    }
+
+    ss::future<> adopt_segment(model::offset, model::term_id) final {
+        return ss::make_exception_future<>(std::runtime_error(
+          "in memory log does not support adopting segments"));
+    }
+
     struct eviction_monitor {
         ss::promise<model::offset> promise;
         ss::abort_source::subscription subscription;
@@ -418,6 +508,7 @@ ss::future<append_result> mem_log_appender::end_of_stream() {
       .last_offset = _cur_offset - model::offset(1),
       .byte_size = _byte_size,
       .last_term = _log._data.back().term()};
+    _log.enforce_bound();
     return ss::make_ready_future<append_result>(ret);
 }
 
@@ -21,6 +21,21 @@
 
 namespace storage {
 using with_cache = ss::bool_class<struct log_cache_tag>;
+using with_adaptive_read_ahead
+  = ss::bool_class<struct log_adaptive_read_ahead_tag>;
+
+/**
+ * Admission policy of a log's batches in the shared batch cache.
+ *
+ * lru: every cached batch competes with the rest of the cache in a single
+ * least recently used order.
+ *
+ * segmented_lru: batches enter a probationary segment and are only promoted
+ * to the protected segment on a cache hit, so a consumer scanning history
+ * evicts other probationary batches before it evicts the hot tail.
+ */
+enum class batch_cache_policy : int8_t { lru, segmented_lru };
+std::ostream& operator<<(std::ostream&, batch_cache_policy);
 
 class ntp_config {
 public:
@@ -38,6 +53,13 @@ public:
         tristate<std::chrono::milliseconds> retention_time{std::nullopt};
         // if set, log will not use batch cache
         with_cache cache_enabled = with_cache::yes;
+        // if set, sequential readers grow their disk read-ahead
+        with_adaptive_read_ahead adaptive_read_ahead
+          = with_adaptive_read_ahead::yes;
+        // if not set, defaults by cleanup policy, see cache_policy()
+        std::optional<batch_cache_policy> cache_policy;
+        // if not set, the log_manager's storage type
+        std::optional<model::storage_mode> storage_mode;
 
         friend std::ostream&
         operator<<(std::ostream&, const default_overrides&);
@@ -112,10 +134,40 @@ public:
         return with_cache(!has_overrides() || _overrides->cache_enabled);
     }
 
+    with_adaptive_read_ahead adaptive_read_ahead() const {
+        return with_adaptive_read_ahead(
+          !has_overrides() || _overrides->adaptive_read_ahead);
+    }
+
+    batch_cache_policy cache_policy() const {
+        if (has_overrides() && _overrides->cache_policy) {
+            return *_overrides->cache_policy;
+        }
+        // compacted topics are typically re-read from the start by consumers
+        // rebuilding state, streaming topics are mostly read at the tail
+        return is_compacted() ? batch_cache_policy::lru
+                              : batch_cache_policy::segmented_lru;
+    }
+
+    bool is_in_memory() const {
+        return has_overrides()
+               && _overrides->storage_mode == model::storage_mode::memory;
+    }
+
     void set_overrides(default_overrides o) {
         _overrides = std::make_unique<default_overrides>(o);
     }
 
+    /// a configuration of the same log with its own copy of the overrides
+    ntp_config copy() const {
+        return ntp_config(
+          _ntp,
+          _base_dir,
+          has_overrides() ? std::make_unique<default_overrides>(*_overrides)
+                          : nullptr,
+          _revision_id);
+    }
+
 private:
     model::ntp _ntp;
     /// \brief currently this is the basedir. In the future
@@ -170,6 +170,7 @@ ss::future<result<stop_parser>> continuous_batch_parser::consume_header() {
           }
           auto s = std::get<stop_parser>(ret);
           if (unlikely(bool(s))) {
+              _stopped_mid_batch = true;
               return ss::make_ready_future<result<stop_parser>>(
                 stop_parser::yes);
           }
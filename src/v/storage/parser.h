@@ -88,6 +88,15 @@ public:
     /// \brief cleans up async resources like the input stream
     ss::future<> close() { return _input.close(); }
 
+    /// \brief true when a subsequent consume() cannot continue from where the
+    /// last one stopped: the consumer stopped the parser after the header of a
+    /// batch was read, or the input stream was exhausted. the owner should
+    /// close the parser and open a new one at the desired offset.
+    bool needs_restart() const {
+        return _err == parser_errc::none
+               && (_stopped_mid_batch || _input.eof());
+    }
+
 private:
     /// \brief consumes _one_ full batch.
     ss::future<result<batch_consumer::stop_parser>> consume_one();
@@ -108,6 +117,7 @@ private:
     parser_errc _err = parser_errc::none;
     size_t _bytes_consumed{0};
     size_t _physical_base_offset{0};
+    bool _stopped_mid_batch{false};
 };
 
 } // namespace storage
@@ -14,6 +14,7 @@
 #include "model/record.h"
 #include "model/record_utils.h"
 #include "reflection/adl.h"
+#include "storage/decompression_stage.h"
 #include "storage/logger.h"
 #include "vlog.h"
 
@@ -25,7 +26,10 @@ ss::future<model::record_batch> decompress_batch(model::record_batch&& b) {
     if (!b.compressed()) {
         return ss::make_ready_future<model::record_batch>(std::move(b));
     }
-    return decompress_batch(b);
+    // large batches are decompressed after a yield
+    return ss::do_with(std::move(b), [](model::record_batch& b) {
+        return decompress_batch(b);
+    });
 }
 
 ss::future<model::record_batch> decompress_batch(const model::record_batch& b) {
@@ -36,15 +40,7 @@ ss::future<model::record_batch> decompress_batch(const model::record_batch& b) {
             "Asked to decompressed a non-compressed batch:{}",
             b.header())));
     }
-    iobuf body_buf = compression::compressor::uncompress(
-      b.data(), b.header().attrs.compression());
-    // must remove compression first!
-    auto h = b.header();
-    h.attrs.remove_compression();
-    reset_size_checksum_metadata(h, body_buf);
-    auto batch = model::record_batch(
-      h, std::move(body_buf), model::record_batch::tag_ctor_ng{});
-    return ss::make_ready_future<model::record_batch>(std::move(batch));
+    return decompressions().decompress(b);
 }
 
 ss::future<model::record_batch>
@@ -18,7 +18,8 @@ namespace storage::internal {
 
 /// \brief batch decompression
 ss::future<model::record_batch> decompress_batch(model::record_batch&&);
-/// \brief batch decompression
+/// \brief batch decompression, see decompression_stage. the batch must stay
+/// alive until the returned future resolves
 ss::future<model::record_batch> decompress_batch(const model::record_batch&);
 
 /// \brief batch compression
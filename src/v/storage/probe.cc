@@ -17,7 +17,9 @@
 
 namespace storage {
 void probe::setup_metrics(const model::ntp& ntp) {
-    if (config::shard_local_cfg().disable_metrics()) {
+    if (
+      config::shard_local_cfg().disable_metrics()
+      || config::shard_local_cfg().aggregate_partition_metrics()) {
         return;
     }
 
@@ -100,6 +102,102 @@ void probe::setup_metrics(const model::ntp& ntp) {
           [this] { return _segment_compacted; },
           sm::description("Number of compacted segments"),
           labels),
+        sm::make_derive(
+          "readers_cache_hits",
+          [this] { return _readers_cache_hits; },
+          sm::description("Number of reads served by a cached log reader"),
+          labels),
+        sm::make_derive(
+          "readers_cache_misses",
+          [this] { return _readers_cache_misses; },
+          sm::description("Number of reads that required a new log reader"),
+          labels),
+        sm::make_derive(
+          "read_ahead_promotions",
+          [this] { return _read_ahead_promotions; },
+          sm::description("Number of times a sequential reader was promoted "
+                          "to a larger read-ahead"),
+          labels),
+        sm::make_total_bytes(
+          "read_ahead_read_bytes",
+          [this] { return _read_ahead_bytes_read; },
+          sm::description("Total number of bytes read from disk by readers "
+                          "with an increased read-ahead"),
+          labels),
+        sm::make_total_bytes(
+          "uncached_read_bytes",
+          [this] { return _uncached_bytes_read; },
+          sm::description("Total number of bytes read from disk by readers "
+                          "which skip the batch cache"),
+          labels),
+        sm::make_total_bytes(
+          "passthrough_read_bytes",
+          [this] { return _passthrough_bytes_read; },
+          sm::description("Total number of bytes read from disk by passthrough "
+                          "readers, without materializing the batches"),
+          labels),
+        sm::make_derive(
+          "compaction_removed_tombstones",
+          [this] { return _tombstones_removed; },
+          sm::description("Number of tombstones removed by compaction after "
+                          "their retention expired"),
+          labels),
+        sm::make_total_bytes(
+          "compaction_removed_tombstone_bytes",
+          [this] { return _tombstone_bytes_removed; },
+          sm::description("Total size of tombstones removed by compaction"),
+          labels),
+        sm::make_derive(
+          "batch_cache_probation_hits",
+          [this] { return _batch_cache_probation_hits; },
+          sm::description("Number of batches read from the probationary "
+                          "segment of the batch cache"),
+          labels),
+        sm::make_derive(
+          "batch_cache_protected_hits",
+          [this] { return _batch_cache_protected_hits; },
+          sm::description("Number of batches read from the protected segment "
+                          "of the batch cache"),
+          labels),
+        sm::make_derive(
+          "batch_cache_misses",
+          [this] { return _batch_cache_misses; },
+          sm::description("Number of reads that missed the batch cache"),
+          labels),
+        sm::make_gauge(
+          "batch_cache_probation_hit_ratio",
+          [this] { return hit_ratio(_batch_cache_probation_hits); },
+          sm::description("Ratio of batch cache lookups served by the "
+                          "probationary segment"),
+          labels),
+        sm::make_gauge(
+          "batch_cache_protected_hit_ratio",
+          [this] { return hit_ratio(_batch_cache_protected_hits); },
+          sm::description("Ratio of batch cache lookups served by the "
+                          "protected segment"),
+          labels),
+        sm::make_gauge(
+          "recovery_queued_ms",
+          [this] { return _recovery_timings.queued.count(); },
+          sm::description("Time the log waited for other logs to recover on "
+                          "startup"),
+          labels),
+        sm::make_gauge(
+          "recovery_open_ms",
+          [this] { return _recovery_timings.open.count(); },
+          sm::description("Time spent opening segments on startup"),
+          labels),
+        sm::make_gauge(
+          "recovery_index_ms",
+          [this] { return _recovery_timings.index.count(); },
+          sm::description("Time spent loading segment indexes on startup"),
+          labels),
+        sm::make_gauge(
+          "recovery_replay_ms",
+          [this] { return _recovery_timings.replay.count(); },
+          sm::description("Time spent replaying segments without a valid "
+                          "index on startup"),
+          labels),
         sm::make_gauge(
           "partition_size",
           [this] { return _partition_bytes; },
@@ -13,6 +13,7 @@
 #include "model/fundamental.h"
 #include "storage/fwd.h"
 #include "storage/logger.h"
+#include "storage/types.h"
 
 #include <seastar/core/metrics_registration.hh>
 #include <seastar/core/shared_ptr.hh>
@@ -47,6 +48,10 @@ public:
     void initial_segments_count(size_t cnt) { _log_segments_active = cnt; }
 
     void segment_compacted() { ++_segment_compacted; }
+    void tombstones_removed(uint64_t count, uint64_t bytes) {
+        _tombstones_removed += count;
+        _tombstone_bytes_removed += bytes;
+    }
 
     void batch_write_error(const std::exception_ptr& e) {
         stlog.error("Error writing record batch {}", e);
@@ -60,15 +65,50 @@ public:
 
     void batch_parse_error() { ++_batch_parse_errors; }
 
+    void readers_cache_hit() { ++_readers_cache_hits; }
+    void read_ahead_promotion() { ++_read_ahead_promotions; }
+    void add_read_ahead_bytes_read(uint64_t read) {
+        _read_ahead_bytes_read += read;
+    }
+    void add_uncached_bytes_read(uint64_t read) {
+        _uncached_bytes_read += read;
+    }
+    void add_passthrough_bytes_read(uint64_t read) {
+        _passthrough_bytes_read += read;
+    }
+    void readers_cache_miss() { ++_readers_cache_misses; }
+    void add_batch_cache_hits(size_t probation, size_t protected_hits) {
+        _batch_cache_probation_hits += probation;
+        _batch_cache_protected_hits += protected_hits;
+    }
+    void batch_cache_miss() { ++_batch_cache_misses; }
+    void set_recovery_timings(const recovery_timings& t) {
+        _recovery_timings = t;
+    }
+
     void setup_metrics(const model::ntp&);
 
     void delete_segment(const segment&);
 
     size_t partition_size() const { return _partition_bytes; }
+    uint64_t readers_cache_hits() const { return _readers_cache_hits; }
+    uint64_t uncached_bytes_read() const { return _uncached_bytes_read; }
+    uint64_t passthrough_bytes_read() const { return _passthrough_bytes_read; }
+    uint64_t tombstones_removed() const { return _tombstones_removed; }
+    uint64_t tombstone_bytes_removed() const {
+        return _tombstone_bytes_removed;
+    }
     void add_initial_segment(const segment&);
     void remove_partition_bytes(size_t remove) { _partition_bytes -= remove; }
 
 private:
+    double hit_ratio(uint64_t hits) const {
+        const auto lookups = _batch_cache_probation_hits
+                             + _batch_cache_protected_hits
+                             + _batch_cache_misses;
+        return lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups;
+    }
+
     uint64_t _partition_bytes = 0;
     uint64_t _bytes_written = 0;
     uint64_t _bytes_read = 0;
@@ -85,6 +125,18 @@ private:
     uint32_t _log_segments_active = 0;
     uint32_t _batch_parse_errors = 0;
     uint32_t _batch_write_errors = 0;
+    uint64_t _readers_cache_hits = 0;
+    uint64_t _readers_cache_misses = 0;
+    uint64_t _read_ahead_promotions = 0;
+    uint64_t _read_ahead_bytes_read = 0;
+    uint64_t _uncached_bytes_read = 0;
+    uint64_t _passthrough_bytes_read = 0;
+    uint64_t _tombstones_removed = 0;
+    uint64_t _tombstone_bytes_removed = 0;
+    recovery_timings _recovery_timings;
+    uint64_t _batch_cache_probation_hits = 0;
+    uint64_t _batch_cache_protected_hits = 0;
+    uint64_t _batch_cache_misses = 0;
     ss::metrics::metric_groups _metrics;
 };
 } // namespace storage
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "seastarx.h"
+#include "storage/segment_reader.h"
+#include "units.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+
+namespace storage {
+
+/**
+ * Adaptive read-ahead for a single log reader.
+ *
+ * Every segment input stream starts with the default buffering of the
+ * segment reader, so random point reads (e.g. a consumer seeking to an
+ * arbitrary offset) never read more than they used to. Once a reader has read
+ * enough consecutive bytes from disk with the current buffering it is
+ * considered a sequential scan and moves up one level, doubling the buffer
+ * size and the number of in-flight reads until the configured limits are
+ * reached. The log reader replaces its open stream at the next batch boundary
+ * when the level changes.
+ */
+class read_ahead_tracker {
+public:
+    struct limits {
+        size_t min_buffer_size = 128_KiB;
+        size_t max_buffer_size = 1_MiB;
+        unsigned min_read_ahead = 4;
+        unsigned max_read_ahead = 16;
+
+        /// Limits sized for a disk of \p read_bandwidth bytes per second and
+        /// \p read_latency: the largest buffer is what the disk streams in a
+        /// millisecond and the reads in flight cover the latency of a read
+        static limits for_disk(
+          size_t read_bandwidth, std::chrono::microseconds read_latency) {
+            limits l;
+            if (read_bandwidth == 0) {
+                return l;
+            }
+            const size_t per_ms = read_bandwidth / 1000;
+            size_t buffer = l.min_buffer_size;
+            while (buffer < per_ms && buffer < max_disk_buffer_size) {
+                buffer *= 2;
+            }
+            l.max_buffer_size = buffer;
+            const size_t in_flight = read_bandwidth * read_latency.count()
+                                     / 1'000'000;
+            l.max_read_ahead = static_cast<unsigned>(std::clamp<size_t>(
+              in_flight / buffer + 1, l.min_read_ahead, max_disk_read_ahead));
+            return l;
+        }
+
+        static constexpr size_t max_disk_buffer_size = 4_MiB;
+        static constexpr unsigned max_disk_read_ahead = 32;
+    };
+
+    read_ahead_tracker() noexcept = default;
+    read_ahead_tracker(bool enabled, limits l) noexcept
+      : _enabled(enabled)
+      , _limits(l) {}
+
+    /// buffering for the next stream, nullopt to use the segment defaults
+    std::optional<stream_buffering> buffering() const {
+        if (!_enabled || _level == 0) {
+            return std::nullopt;
+        }
+        return current();
+    }
+
+    void stream_opened() { _bytes_since_open = 0; }
+
+    /**
+     * Accounts bytes decoded from disk through the open stream. Returns true
+     * if the reader was promoted and the stream should be replaced.
+     */
+    bool record_disk_read(size_t bytes) {
+        if (!_enabled) {
+            return false;
+        }
+        _bytes_since_open += bytes;
+        auto cur = current();
+        if (_bytes_since_open < 2 * cur.buffer_size * cur.read_ahead) {
+            return false;
+        }
+        if (
+          cur.buffer_size >= _limits.max_buffer_size
+          && cur.read_ahead >= _limits.max_read_ahead) {
+            return false;
+        }
+        ++_level;
+        _bytes_since_open = 0;
+        return true;
+    }
+
+    bool is_sequential() const { return _enabled && _level > 0; }
+
+private:
+    stream_buffering current() const {
+        return stream_buffering{
+          .buffer_size = std::min(
+            _limits.min_buffer_size << _level, _limits.max_buffer_size),
+          .read_ahead = std::min(
+            _limits.min_read_ahead << _level, _limits.max_read_ahead),
+        };
+    }
+
+    bool _enabled{false};
+    limits _limits;
+    unsigned _level{0};
+    size_t _bytes_since_open{0};
+};
+
+} // namespace storage
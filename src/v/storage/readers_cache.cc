@@ -0,0 +1,280 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/readers_cache.h"
+
+#include "storage/logger.h"
+#include "storage/segment.h"
+#include "vassert.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/future-util.hh>
+
+#include <algorithm>
+
+namespace storage {
+
+/**
+ * Wraps a log reader owned by the cache. The log reader is left open when the
+ * consumer finishes with it, and handed back to the cache on destruction.
+ */
+class readers_cache::cached_reader_impl final
+  : public model::record_batch_reader::impl {
+public:
+    cached_reader_impl(readers_cache* c, entry* e, gate_guard g) noexcept
+      : _cache(c)
+      , _entry(e)
+      , _guard(std::move(g)) {}
+    cached_reader_impl(const cached_reader_impl&) = delete;
+    cached_reader_impl& operator=(const cached_reader_impl&) = delete;
+    cached_reader_impl(cached_reader_impl&&) = delete;
+    cached_reader_impl& operator=(cached_reader_impl&&) = delete;
+
+    ~cached_reader_impl() final {
+        _cache->return_reader(_entry, std::move(_guard));
+    }
+
+    bool is_end_of_stream() const final {
+        return _limit_reached || _entry->reader->is_end_of_stream();
+    }
+
+    ss::future<storage_t>
+    do_load_slice(model::timeout_clock::time_point timeout) final {
+        /*
+         * the log reader closes itself when the requested range has been
+         * read. intercept that case so that the segment reader and its input
+         * stream stay open for the next read.
+         */
+        if (
+          !_entry->reader->is_end_of_stream() && _entry->reader->is_done()) {
+            _limit_reached = true;
+            return ss::make_ready_future<storage_t>();
+        }
+        return _entry->reader->do_load_slice(timeout);
+    }
+
+    // closing is handled by the cache
+    ss::future<> finally() noexcept final { return ss::now(); }
+
+    void print(std::ostream& os) final {
+        os << "{cached_reader: ";
+        _entry->reader->print(os);
+        os << "}";
+    }
+
+private:
+    readers_cache* _cache;
+    entry* _entry;
+    gate_guard _guard;
+    bool _limit_reached{false};
+};
+
+readers_cache::readers_cache(
+  model::ntp ntp, std::chrono::milliseconds idle_timeout, probe& p)
+  : _ntp(std::move(ntp))
+  , _idle_timeout(idle_timeout)
+  , _probe(p) {
+    _eviction_timer.set_callback([this] { evict_idle(); });
+}
+
+readers_cache::~readers_cache() {
+    vassert(
+      _in_use.empty() && _idle.empty(),
+      "readers cache of {} destroyed with live readers",
+      _ntp);
+}
+
+std::optional<readers_cache::range>
+readers_cache::covered_range(const log_reader& reader) {
+    const auto& segs = reader.lease().range;
+    if (segs.empty()) {
+        return std::nullopt;
+    }
+    const auto& back = segs.back()->offsets();
+    return range{
+      .base = segs.front()->offsets().base_offset,
+      .end = std::max(back.base_offset, back.dirty_offset),
+    };
+}
+
+bool readers_cache::is_locked(const range& r) const {
+    return std::any_of(
+      _locked_ranges.begin(), _locked_ranges.end(), [&r](const range& l) {
+          return l.contains(r);
+      });
+}
+
+model::record_batch_reader
+readers_cache::put(std::unique_ptr<log_reader> reader) {
+    auto covered = covered_range(*reader);
+    if (_gate.is_closed() || !covered || is_locked(*covered)) {
+        return model::record_batch_reader(std::move(reader));
+    }
+    auto e = std::make_unique<entry>();
+    e->reader = std::move(reader);
+    _in_use.push_back(*e);
+    return make_cached_reader(e.release());
+}
+
+model::record_batch_reader readers_cache::make_cached_reader(entry* e) {
+    return model::make_record_batch_reader<cached_reader_impl>(
+      this, e, gate_guard(_gate));
+}
+
+std::optional<model::record_batch_reader>
+readers_cache::get_reader(const log_reader_config& cfg) {
+    if (_gate.is_closed()) {
+        return std::nullopt;
+    }
+    for (auto& e : _idle) {
+        if (e.reader->next_read_lower_bound() != cfg.start_offset) {
+            continue;
+        }
+        const auto& segs = e.reader->lease().range;
+        const auto& last = segs.back();
+        /*
+         * the lease was taken for the max offset of the original read. a
+         * tailing read may ask for data past the last leased segment if the
+         * log rolled in the meantime.
+         */
+        if (
+          cfg.max_offset > last->offsets().dirty_offset
+          && !last->has_appender()) {
+            continue;
+        }
+        if (std::any_of(segs.begin(), segs.end(), [](const auto& s) {
+                return s->is_tombstone() || s->is_closed();
+            })) {
+            continue;
+        }
+        auto covered = covered_range(*e.reader);
+        if (!covered || is_locked(*covered)) {
+            continue;
+        }
+        e.hook.unlink();
+        _in_use.push_back(e);
+        e.reader->reset_config(cfg);
+        _probe.readers_cache_hit();
+        return make_cached_reader(&e);
+    }
+    _probe.readers_cache_miss();
+    return std::nullopt;
+}
+
+void readers_cache::return_reader(entry* e, gate_guard guard) {
+    e->hook.unlink();
+    auto covered = covered_range(*e->reader);
+    if (
+      !e->valid || _gate.is_closed() || e->reader->is_end_of_stream()
+      || !covered || is_locked(*covered)) {
+        dispose_in_background(e, std::move(guard));
+        return;
+    }
+    e->reader->release_abort_source();
+    e->last_used = ss::lowres_clock::now();
+    _idle.push_back(*e);
+    if (!_eviction_timer.armed()) {
+        _eviction_timer.arm(_idle_timeout);
+    }
+}
+
+ss::future<> readers_cache::dispose(entry* e) {
+    e->hook.unlink();
+    auto owned = std::unique_ptr<entry>(e);
+    auto raw = owned->reader.get();
+    return raw->finally().finally([owned = std::move(owned)] {});
+}
+
+void readers_cache::dispose_in_background(entry* e, gate_guard guard) {
+    (void)dispose(e).finally([g = std::move(guard)] {});
+}
+
+void readers_cache::evict_idle() {
+    const auto now = ss::lowres_clock::now();
+    for (auto it = _idle.begin(); it != _idle.end();) {
+        auto& e = *it;
+        ++it;
+        if (now - e.last_used < _idle_timeout || _gate.is_closed()) {
+            continue;
+        }
+        vlog(
+          stlog.trace,
+          "{} evicting idle reader at offset {}",
+          _ntp,
+          e.reader->next_read_lower_bound());
+        dispose_in_background(&e, gate_guard(_gate));
+    }
+    if (!_idle.empty() && !_gate.is_closed()) {
+        _eviction_timer.arm(_idle_timeout);
+    }
+}
+
+ss::future<readers_cache::range_lock_holder>
+readers_cache::evict_if(range r) {
+    // readers in the range may not be cached while the caller holds the lock
+    range_lock_holder holder(
+      _locked_ranges.insert(_locked_ranges.end(), r), this);
+
+    // readers in use are discarded when they are returned
+    for (auto& e : _in_use) {
+        auto covered = covered_range(*e.reader);
+        if (!covered || r.contains(*covered)) {
+            e.valid = false;
+        }
+    }
+
+    std::vector<entry*> to_evict;
+    for (auto& e : _idle) {
+        auto covered = covered_range(*e.reader);
+        if (!covered || r.contains(*covered)) {
+            to_evict.push_back(&e);
+        }
+    }
+    for (auto e : to_evict) {
+        e->hook.unlink();
+    }
+    co_await ss::parallel_for_each(
+      to_evict, [this](entry* e) { return dispose(e); });
+    co_return holder;
+}
+
+ss::future<readers_cache::range_lock_holder>
+readers_cache::evict_truncate(model::offset o) {
+    return evict_if(range{.base = o, .end = model::offset::max()});
+}
+
+ss::future<readers_cache::range_lock_holder>
+readers_cache::evict_prefix_truncate(model::offset o) {
+    return evict_if(
+      range{.base = model::offset::min(), .end = o - model::offset(1)});
+}
+
+ss::future<readers_cache::range_lock_holder>
+readers_cache::evict_range(model::offset base, model::offset end) {
+    return evict_if(range{.base = base, .end = end});
+}
+
+ss::future<> readers_cache::stop() {
+    _eviction_timer.cancel();
+    std::vector<entry*> to_evict;
+    for (auto& e : _idle) {
+        to_evict.push_back(&e);
+    }
+    for (auto e : to_evict) {
+        e->hook.unlink();
+    }
+    auto f = _gate.close();
+    co_await ss::parallel_for_each(
+      to_evict, [this](entry* e) { return dispose(e); });
+    // readers in use are closed as they are returned
+    co_await std::move(f);
+}
+
+} // namespace storage
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "model/fundamental.h"
+#include "model/record_batch_reader.h"
+#include "storage/log_reader.h"
+#include "storage/probe.h"
+#include "storage/types.h"
+#include "utils/gate_guard.h"
+#include "utils/intrusive_list_helpers.h"
+
+#include <seastar/core/gate.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/core/timer.hh>
+
+#include <chrono>
+#include <list>
+#include <memory>
+#include <optional>
+
+namespace storage {
+
+/**
+ * Cache of idle log readers of a single log.
+ *
+ * Creating a log reader requires locking the range of segments, locating the
+ * starting position with the segment index and opening a new input stream.
+ * Tailing consumers fetch the same partition every few milliseconds starting
+ * exactly at the offset where the previous fetch ended, so instead of closing
+ * a reader once a fetch is done it is returned to this cache, indexed by the
+ * offset it would read next. A following read that starts at that offset
+ * reuses the reader along with its lease and open input stream.
+ *
+ * An idle reader holds read locks on the segments in its lease, so operations
+ * that need a write lock on segments (truncation, prefix truncation and
+ * compaction) must first evict the readers covering the affected offset range.
+ * Evicting returns a holder that prevents readers in that range from being
+ * cached until the operation completes. Readers in use during an eviction are
+ * discarded when they are returned. Idle readers are closed after a timeout.
+ */
+class readers_cache {
+public:
+    /// inclusive offset range
+    struct range {
+        model::offset base;
+        model::offset end;
+        bool contains(const range& o) const {
+            return o.base <= end && o.end >= base;
+        }
+    };
+
+    class range_lock_holder {
+    public:
+        range_lock_holder(std::list<range>::iterator it, readers_cache* c)
+          : _it(it)
+          , _cache(c) {}
+        range_lock_holder(const range_lock_holder&) = delete;
+        range_lock_holder& operator=(const range_lock_holder&) = delete;
+        range_lock_holder(range_lock_holder&& o) noexcept
+          : _it(o._it)
+          , _cache(std::exchange(o._cache, nullptr)) {}
+        range_lock_holder& operator=(range_lock_holder&& o) noexcept {
+            if (this != &o) {
+                release();
+                _it = o._it;
+                _cache = std::exchange(o._cache, nullptr);
+            }
+            return *this;
+        }
+        ~range_lock_holder() { release(); }
+
+    private:
+        void release() {
+            if (_cache) {
+                _cache->_locked_ranges.erase(_it);
+                _cache = nullptr;
+            }
+        }
+
+        std::list<range>::iterator _it;
+        readers_cache* _cache;
+    };
+
+    readers_cache(model::ntp, std::chrono::milliseconds idle_timeout, probe&);
+    readers_cache(const readers_cache&) = delete;
+    readers_cache& operator=(const readers_cache&) = delete;
+    readers_cache(readers_cache&&) = delete;
+    readers_cache& operator=(readers_cache&&) = delete;
+    ~readers_cache();
+
+    /**
+     * Takes ownership of a newly created reader. The returned reader returns
+     * the log reader to this cache when it is destroyed.
+     */
+    model::record_batch_reader put(std::unique_ptr<log_reader>);
+
+    /**
+     * Returns an idle reader whose next offset is cfg.start_offset and whose
+     * lease covers the requested range, rebound to the given config.
+     */
+    std::optional<model::record_batch_reader>
+    get_reader(const log_reader_config&);
+
+    /// evicts readers covering offsets >= offset (suffix truncation)
+    ss::future<range_lock_holder> evict_truncate(model::offset);
+    /// evicts readers covering offsets < offset (prefix truncation)
+    ss::future<range_lock_holder> evict_prefix_truncate(model::offset);
+    /// evicts readers covering any offset in [base, end]
+    ss::future<range_lock_holder> evict_range(model::offset, model::offset);
+
+    /// closes idle readers and waits for readers in use to be returned
+    ss::future<> stop();
+
+private:
+    struct entry {
+        std::unique_ptr<log_reader> reader;
+        ss::lowres_clock::time_point last_used = ss::lowres_clock::now();
+        bool valid = true;
+        intrusive_list_hook hook;
+    };
+
+    class cached_reader_impl;
+    friend class cached_reader_impl;
+
+    using entries_t = intrusive_list<entry, &entry::hook>;
+
+    model::record_batch_reader make_cached_reader(entry*);
+    void return_reader(entry*, gate_guard);
+    ss::future<> dispose(entry*);
+    void dispose_in_background(entry*, gate_guard);
+    ss::future<range_lock_holder> evict_if(range);
+    void evict_idle();
+    bool is_locked(const range&) const;
+
+    static std::optional<range> covered_range(const log_reader&);
+
+    model::ntp _ntp;
+    std::chrono::milliseconds _idle_timeout;
+    probe& _probe;
+    entries_t _in_use;
+    entries_t _idle;
+    std::list<range> _locked_ranges;
+    ss::timer<ss::lowres_clock> _eviction_timer;
+    ss::gate _gate;
+};
+
+} // namespace storage
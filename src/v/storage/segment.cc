@@ -11,8 +11,10 @@
 
 #include "compression/compression.h"
 #include "config/configuration.h"
+#include "model/record_view.h"
 #include "storage/compacted_index_writer.h"
 #include "storage/fs_utils.h"
+#include "storage/key_bloom_filter.h"
 #include "storage/logger.h"
 #include "storage/parser_utils.h"
 #include "storage/segment_appender_utils.h"
@@ -20,7 +22,6 @@
 #include "storage/segment_utils.h"
 #include "storage/types.h"
 #include "storage/version.h"
-#include "utils/file_sanitizer.h"
 #include "vassert.h"
 #include "vlog.h"
 
@@ -36,6 +37,7 @@
 #include <optional>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 namespace storage {
 
@@ -100,7 +102,7 @@ ss::future<> segment::remove_persistent_state() {
           internal::compacted_index_path(reader().filename().c_str()));
     }
     vlog(stlog.info, "removing: {}", rm);
-    return ss::do_with(
+    auto f = ss::do_with(
       std::move(rm), [](const std::vector<std::filesystem::path>& to_remove) {
           return ss::do_for_each(
             to_remove, [](const std::filesystem::path& name) {
@@ -110,6 +112,13 @@ ss::future<> segment::remove_persistent_state() {
                   });
             });
       });
+    if (is_compacted_segment()) {
+        f = f.then([path = internal::compacted_index_path(
+                      reader().filename().c_str())] {
+            return remove_key_bloom_filter(path.string());
+        });
+    }
+    return f;
 }
 
 ss::future<> segment::remove_tombstones() {
@@ -122,7 +131,9 @@ ss::future<> segment::remove_tombstones() {
 ss::future<> segment::do_close() {
     auto f = _reader.close();
     if (_appender) {
-        f = f.then([this] { return _appender->close(); });
+        f = f.then([this] { return _appender->close(); }).then([this] {
+            _idx.seal(_appender->file_byte_offset());
+        });
     }
     if (_compaction_index) {
         f = f.then([this] { return _compaction_index->close(); });
@@ -144,7 +155,10 @@ ss::future<> segment::do_release_appender(
         std::optional<segment_appender>& appender,
         std::optional<compacted_index_writer>& compacted_index) {
           return appender->close()
-            .then([this] { return _idx.flush(); })
+            .then([this, &appender] {
+                _idx.seal(appender->file_byte_offset());
+                return _idx.flush();
+            })
             .then([&compacted_index] {
                 if (compacted_index) {
                     return compacted_index->close();
@@ -156,6 +170,10 @@ ss::future<> segment::do_release_appender(
 
 ss::future<> segment::release_appender() {
     vassert(_appender, "cannot release a null appender");
+    if (_cache) {
+        // no longer the tail of the log
+        _cache->retain_tail(0);
+    }
     /*
      * If we are able to get the write lock then proceed with the normal
      * appender release process.  Otherwise, schedule the destructive operations
@@ -242,7 +260,8 @@ ss::future<> remove_compacted_index(const ss::sstring& reader_path) {
     return ss::remove_file(path.c_str())
       .handle_exception([path](const std::exception_ptr& e) {
           vlog(stlog.warn, "error removing compacted index {} - {}", path, e);
-      });
+      })
+      .then([path] { return remove_key_bloom_filter(path.string()); });
 }
 
 ss::future<>
@@ -315,6 +334,21 @@ ss::future<bool> segment::materialize_index() {
     });
 }
 
+ss::future<bool> segment::materialize_index_header() {
+    vassert(
+      _tracker.base_offset == _tracker.dirty_offset,
+      "Materializing the index must happen tracking any data. {}",
+      *this);
+    return _idx.materialize_index_header().then([this](bool yn) {
+        if (yn) {
+            _tracker.committed_offset = _idx.max_offset();
+            _tracker.stable_offset = _idx.max_offset();
+            _tracker.dirty_offset = _idx.max_offset();
+        }
+        return yn;
+    });
+}
+
 void segment::cache_truncate(model::offset offset) {
     check_segment_not_closed("cache_truncate()");
     if (likely(bool(_cache))) {
@@ -324,9 +358,20 @@ void segment::cache_truncate(model::offset offset) {
 ss::future<> segment::do_compaction_index_batch(const model::record_batch& b) {
     vassert(!b.compressed(), "wrong method. Call compact_index_batch. {}", b);
     auto& w = compaction_index();
-    return model::for_each_record(
-      b, [o = b.base_offset(), &w](const model::record& r) {
-          return w.index(r.key(), o, r.offset_delta());
+    // the views point into the batch, which outlives the indexing
+    std::vector<model::record_view> records;
+    records.reserve(b.record_count());
+    model::for_each_record_view(
+      b, [&records](model::record_view r) { records.push_back(r); });
+    return ss::do_with(
+      std::move(records),
+      [o = b.base_offset(), &w](const std::vector<model::record_view>& rs) {
+          return ss::do_for_each(rs, [o, &w](const model::record_view& r) {
+              if (auto key = r.key().contiguous(); key) {
+                  return w.index(*key, o, r.offset_delta());
+              }
+              return w.index(r.key().to_bytes(), o, r.offset_delta());
+          });
       });
 }
 ss::future<> segment::compaction_index_batch(const model::record_batch& b) {
@@ -343,8 +388,34 @@ ss::future<> segment::compaction_index_batch(const model::record_batch& b) {
     });
 }
 
-ss::future<append_result> segment::append(const model::record_batch& b) {
-    check_segment_not_closed("append()");
+static ss::future<append_result>
+join_append_futures(std::tuple<ss::future<append_result>, ss::future<>> p) {
+    auto& [append_fut, index_fut] = p;
+    const bool has_error = append_fut.failed() || index_fut.failed();
+    if (!has_error) {
+        index_fut.get();
+        return std::move(append_fut);
+    }
+    if (append_fut.failed()) {
+        auto append_err = std::move(append_fut).get_exception();
+        vlog(stlog.error, "segment::append failed: {}", append_err);
+        if (index_fut.failed()) {
+            auto index_err = std::move(index_fut).get_exception();
+            vlog(stlog.error, "segment::append index: {}", index_err);
+        }
+        return ss::make_exception_future<append_result>(append_err);
+    }
+    auto ret = append_fut.get0();
+    auto index_err = std::move(index_fut).get_exception();
+    vlog(
+      stlog.error,
+      "segment::append index: {}. ignorning append: {}",
+      index_err,
+      ret);
+    return ss::make_exception_future<append_result>(index_err);
+}
+
+std::exception_ptr segment::validate_append(const model::record_batch& b) {
     vassert(
       b.base_offset() >= _tracker.base_offset,
       "Invalid state. Attempted to append a batch with base_offset:{}, but "
@@ -360,11 +431,18 @@ ss::future<append_result> segment::append(const model::record_batch& b) {
       *this,
       b.header());
     if (unlikely(b.compressed() && !b.header().attrs.is_valid_compression())) {
-        return ss::make_exception_future<
-          append_result>(std::runtime_error(fmt::format(
+        return std::make_exception_ptr(std::runtime_error(fmt::format(
           "record batch marked as compressed, but has no valid compression:{}",
           b.header())));
     }
+    return nullptr;
+}
+
+ss::future<append_result> segment::append(const model::record_batch& b) {
+    check_segment_not_closed("append()");
+    if (auto err = validate_append(b); err) {
+        return ss::make_exception_future<append_result>(err);
+    }
     const auto start_physical_offset = _appender->file_byte_offset();
     // proxy serialization to segment_appender_utils
     auto write_fut
@@ -395,31 +473,7 @@ ss::future<append_result> segment::append(const model::record_batch& b) {
         });
     auto index_fut = compaction_index_batch(b);
     return ss::when_all(std::move(write_fut), std::move(index_fut))
-      .then([](std::tuple<ss::future<append_result>, ss::future<>> p) {
-          auto& [append_fut, index_fut] = p;
-          const bool has_error = append_fut.failed() || index_fut.failed();
-          if (!has_error) {
-              index_fut.get();
-              return std::move(append_fut);
-          }
-          if (append_fut.failed()) {
-              auto append_err = std::move(append_fut).get_exception();
-              vlog(stlog.error, "segment::append failed: {}", append_err);
-              if (index_fut.failed()) {
-                  auto index_err = std::move(index_fut).get_exception();
-                  vlog(stlog.error, "segment::append index: {}", index_err);
-              }
-              return ss::make_exception_future<append_result>(append_err);
-          }
-          auto ret = append_fut.get0();
-          auto index_err = std::move(index_fut).get_exception();
-          vlog(
-            stlog.error,
-            "segment::append index: {}. ignorning append: {}",
-            index_err,
-            ret);
-          return ss::make_exception_future<append_result>(index_err);
-      });
+      .then(&join_append_futures);
 }
 ss::future<append_result> segment::append(model::record_batch&& b) {
     return ss::do_with(std::move(b), [this](model::record_batch& b) mutable {
@@ -427,14 +481,82 @@ ss::future<append_result> segment::append(model::record_batch&& b) {
     });
 }
 
+ss::future<append_result>
+segment::append(std::vector<model::record_batch> batches) {
+    check_segment_not_closed("append()");
+    vassert(!batches.empty(), "cannot append an empty range: {}", *this);
+    for (const auto& b : batches) {
+        if (auto err = validate_append(b); err) {
+            return ss::make_exception_future<append_result>(err);
+        }
+    }
+    return ss::do_with(
+      std::move(batches), [this](std::vector<model::record_batch>& batches) {
+          const auto start_physical_offset = _appender->file_byte_offset();
+          auto write_fut = write(*_appender, batches)
+                             .then([this, &batches, start_physical_offset] {
+                                 return track_appended_range(
+                                   batches, start_physical_offset);
+                             });
+          auto index_fut = ss::do_for_each(
+            batches, [this](const model::record_batch& b) {
+                return compaction_index_batch(b);
+            });
+          return ss::when_all(std::move(write_fut), std::move(index_fut))
+            .then(&join_append_futures);
+      });
+}
+
+append_result segment::track_appended_range(
+  const std::vector<model::record_batch>& batches,
+  size_t start_physical_offset) {
+    const auto& first = batches.front().header();
+    const auto& last = batches.back().header();
+    size_t bytes = 0;
+    for (const auto& b : batches) {
+        bytes += b.size_bytes();
+    }
+    _tracker.dirty_offset = last.last_offset();
+    const auto end_physical_offset = _appender->file_byte_offset();
+    vassert(
+      end_physical_offset == start_physical_offset + bytes,
+      "size must be deterministic: end_offset:{}, expected:{}, batches:[{}, "
+      "{}] - {}",
+      end_physical_offset,
+      start_physical_offset + bytes,
+      first,
+      last,
+      *this);
+    // one inflight entry and at most one index entry for the whole range
+    _inflight.emplace(end_physical_offset, last.last_offset());
+    _idx.maybe_track(batches, start_physical_offset);
+    for (const auto& b : batches) {
+        cache_put(b);
+    }
+    return append_result{
+      .base_offset = first.base_offset,
+      .last_offset = last.last_offset(),
+      .byte_size = bytes};
+}
+
 ss::input_stream<char>
 segment::offset_data_stream(model::offset o, ss::io_priority_class iopc) {
+    return offset_data_stream(o, iopc, std::nullopt);
+}
+
+ss::input_stream<char> segment::offset_data_stream(
+  model::offset o,
+  ss::io_priority_class iopc,
+  std::optional<stream_buffering> buffering) {
     check_segment_not_closed("offset_data_stream()");
     auto nearest = _idx.find_nearest(o);
     size_t position = 0;
     if (nearest) {
         position = nearest->filepos;
     }
+    if (buffering) {
+        return _reader.data_stream(position, iopc, *buffering);
+    }
     return _reader.data_stream(position, iopc);
 }
 
@@ -552,46 +674,21 @@ ss::future<ss::lw_shared_ptr<segment>> open_segment(
       })
       .then([batch_cache = std::move(batch_cache), meta, sanitize_fileops](
               std::unique_ptr<segment_reader> rdr) mutable {
-          auto ptr = rdr.get();
-          auto index_name = std::filesystem::path(ptr->filename().c_str())
+          auto index_name = std::filesystem::path(rdr->filename().c_str())
                               .replace_extension("base_index")
                               .string();
-          return ss::open_file_dma(
-                   index_name, ss::open_flags::create | ss::open_flags::rw)
-            .then_wrapped([batch_cache = std::move(batch_cache),
-                           ptr,
-                           sanitize_fileops,
-                           rdr = std::move(rdr),
-                           index_name,
-                           meta](ss::future<ss::file> f) mutable {
-                ss::file fd;
-                try {
-                    fd = f.get0();
-                } catch (...) {
-                    return ptr->close().then(
-                      [rdr = std::move(rdr), e = std::current_exception()] {
-                          return ss::make_exception_future<
-                            ss::lw_shared_ptr<segment>>(e);
-                      });
-                }
-                if (sanitize_fileops) {
-                    fd = ss::file(
-                      ss::make_shared(file_io_sanitizer(std::move(fd))));
-                }
-                auto idx = segment_index(
-                  index_name,
-                  fd,
-                  meta->base_offset,
-                  segment_index::default_data_buffer_step);
-                return ss::make_ready_future<ss::lw_shared_ptr<segment>>(
-                  ss::make_lw_shared<segment>(
-                    segment::offset_tracker(meta->term, meta->base_offset),
-                    std::move(*rdr),
-                    std::move(idx),
-                    std::nullopt,
-                    std::nullopt,
-                    std::move(batch_cache)));
-            });
+          auto idx = segment_index(
+            index_name,
+            meta->base_offset,
+            segment_index::default_data_buffer_step,
+            sanitize_fileops);
+          return ss::make_lw_shared<segment>(
+            segment::offset_tracker(meta->term, meta->base_offset),
+            std::move(*rdr),
+            std::move(idx),
+            std::nullopt,
+            std::nullopt,
+            std::move(batch_cache));
       });
 }
 
@@ -603,23 +700,25 @@ ss::future<ss::lw_shared_ptr<segment>> make_segment(
   record_version_type version,
   size_t buf_size,
   debug_sanitize_files sanitize_fileops,
-  std::optional<batch_cache_index> batch_cache) {
+  std::optional<batch_cache_index> batch_cache,
+  internal::flush_scheduler* flusher) {
     auto path = segment_path::make_segment_path(
       ntpc, base_offset, term, version);
     vlog(stlog.info, "Creating new segment {}", path.string());
     return open_segment(
              path, sanitize_fileops, std::move(batch_cache), buf_size)
-      .then([path, &ntpc, sanitize_fileops, pc](
+      .then([path, &ntpc, sanitize_fileops, pc, flusher](
               ss::lw_shared_ptr<segment> seg) {
           return with_segment(
             std::move(seg),
-            [path, &ntpc, sanitize_fileops, pc](
+            [path, &ntpc, sanitize_fileops, pc, flusher](
               const ss::lw_shared_ptr<segment>& seg) {
                 return internal::make_segment_appender(
                          path,
                          sanitize_fileops,
                          internal::number_of_chunks_from_config(ntpc),
-                         pc)
+                         pc,
+                         flusher)
                   .then([seg](segment_appender_ptr a) {
                       return ss::make_ready_future<ss::lw_shared_ptr<segment>>(
                         ss::make_lw_shared<segment>(
@@ -25,6 +25,7 @@
 
 #include <exception>
 #include <optional>
+#include <vector>
 
 namespace storage {
 struct segment_closed_exception final : std::exception {
@@ -89,11 +90,21 @@ public:
     /// do not need to take ownership of the batch itself
     ss::future<append_result> append(model::record_batch&&);
     ss::future<append_result> append(const model::record_batch&);
+    /// \brief appends contiguous batches with a single write, tracking the
+    /// index and the inflight offsets once for the whole range
+    ss::future<append_result> append(std::vector<model::record_batch>);
     ss::future<bool> materialize_index();
+    /// \brief recovers the offsets from the index header, see
+    /// segment_index::materialize_index_header
+    ss::future<bool> materialize_index_header();
+    /// \brief loads the index entries if only the header was materialized
+    ss::future<> hydrate_index() { return _idx.hydrate(); }
 
     /// main read interface
     ss::input_stream<char>
       offset_data_stream(model::offset, ss::io_priority_class);
+    ss::input_stream<char> offset_data_stream(
+      model::offset, ss::io_priority_class, std::optional<stream_buffering>);
 
     const offset_tracker& offsets() const { return _tracker; }
     bool empty() const;
@@ -149,6 +160,11 @@ private:
     void set_close();
     void cache_truncate(model::offset offset);
     void check_segment_not_closed(const char* msg);
+    /// \brief asserts the invariants of an append, returns an error for
+    /// batches that cannot be written
+    std::exception_ptr validate_append(const model::record_batch&);
+    append_result track_appended_range(
+      const std::vector<model::record_batch>&, size_t start_physical_offset);
     ss::future<> do_truncate(model::offset prev_last_offset, size_t physical);
     ss::future<> do_close();
     ss::future<> do_flush();
@@ -219,7 +235,8 @@ ss::future<ss::lw_shared_ptr<segment>> make_segment(
   record_version_type version,
   size_t buf_size,
   debug_sanitize_files sanitize_fileops,
-  std::optional<batch_cache_index> batch_cache);
+  std::optional<batch_cache_index> batch_cache,
+  internal::flush_scheduler* flusher = nullptr);
 
 // bitflags operators
 [[gnu::always_inline]] inline segment::bitflags
@@ -23,6 +23,7 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
 #include <ostream>
 
 namespace storage {
@@ -53,7 +54,7 @@ segment_appender::~segment_appender() noexcept {
       "Must flush & close before deleting {}",
       *this);
     if (_head) {
-        internal::chunks().add(std::exchange(_head, nullptr));
+        release_chunk(std::exchange(_head, nullptr));
     }
 }
 
@@ -66,6 +67,8 @@ segment_appender::segment_appender(segment_appender&& o) noexcept
   , _bytes_flush_pending(o._bytes_flush_pending)
   , _concurrent_flushes(std::move(o._concurrent_flushes))
   , _head(std::move(o._head))
+  , _tail(std::move(o._tail))
+  , _chunks_held(std::exchange(o._chunks_held, 0))
   , _inflight(std::move(o._inflight))
   , _callbacks(std::exchange(o._callbacks, nullptr))
   , _inactive_timer([this] { handle_inactive_timer(); })
@@ -123,8 +126,7 @@ ss::future<> segment_appender::do_append(const char* buf, const size_t n) {
      * its chunk was reclaimed into the chunk cache.
      */
     if (unlikely(!_head && _committed_offset > 0)) {
-        return internal::chunks()
-          .get()
+        return get_chunk()
           .then([this](ss::lw_shared_ptr<chunk> chunk) {
               _head = std::move(chunk);
           })
@@ -152,11 +154,21 @@ ss::future<> segment_appender::do_append(const char* buf, const size_t n) {
         return ss::make_ready_future<>();
     }
 
-    return ss::get_units(_concurrent_flushes, 1)
+    /*
+     * an appender above its fair share of the chunk cache while other
+     * appenders are waiting for chunks lets its own writes land and return
+     * their chunks before it takes another one.
+     */
+    const auto units = over_fair_share() ? ss::semaphore::max_counter() : 1;
+    return ss::get_units(_concurrent_flushes, units)
       .then([this, next_buf = buf + written, next_sz = n - written](
               ss::semaphore_units<>) {
           // do not hold the units!
-          return internal::chunks().get().then(
+          if (_head) {
+              // a partial write landed while waiting and restored the head
+              return do_append(next_buf, next_sz);
+          }
+          return get_chunk().then(
             [this, next_buf, next_sz](ss::lw_shared_ptr<chunk> chunk) {
                 vassert(!_head, "cannot overwrite existing chunk");
                 _head = std::move(chunk);
@@ -165,6 +177,29 @@ ss::future<> segment_appender::do_append(const char* buf, const size_t n) {
       });
 }
 
+ss::future<ss::lw_shared_ptr<segment_appender::chunk>>
+segment_appender::get_chunk() {
+    return internal::chunks().get().then([this](ss::lw_shared_ptr<chunk> c) {
+        if (_chunks_held++ == 0) {
+            internal::chunks().holder_added();
+        }
+        return c;
+    });
+}
+
+void segment_appender::release_chunk(ss::lw_shared_ptr<chunk> c) {
+    internal::chunks().add(c);
+    vassert(_chunks_held > 0, "released a chunk not held by {}", *this);
+    if (--_chunks_held == 0) {
+        internal::chunks().holder_removed();
+    }
+}
+
+bool segment_appender::over_fair_share() const {
+    auto& cache = internal::chunks();
+    return cache.waiters() > 0 && _chunks_held >= cache.fair_share();
+}
+
 void segment_appender::handle_inactive_timer() {
     _previously_inactive = true;
 
@@ -188,7 +223,8 @@ void segment_appender::handle_inactive_timer() {
      */
     if (_concurrent_flushes.try_wait(ss::semaphore::max_counter())) {
         if (_head && !_head->bytes_pending()) {
-            internal::chunks().add(std::exchange(_head, nullptr));
+            save_tail();
+            release_chunk(std::exchange(_head, nullptr));
             vlog(
               stlog.debug, "reclaiming inactive chunk from appender {}", *this);
         }
@@ -199,6 +235,18 @@ void segment_appender::handle_inactive_timer() {
     }
 }
 
+void segment_appender::save_tail() {
+    const size_t align = _head->alignment();
+    const size_t n = _committed_offset % align;
+    vassert(
+      n == _head->size() % align,
+      "chunk out of step with the committed offset: {} - {}",
+      *_head,
+      *this);
+    _tail = ss::temporary_buffer<char>(
+      _head->data() + ss::align_down<size_t>(_head->size(), align), n);
+}
+
 ss::future<> segment_appender::hydrate_last_half_page() {
     vassert(_head, "hydrate last half page expects active chunk");
     vassert(
@@ -221,9 +269,15 @@ ss::future<> segment_appender::hydrate_last_half_page() {
     std::memset(buff, 0, read_align);
     const size_t bytes_to_read = _committed_offset % read_align;
     _head->set_position(bytes_to_read);
+    auto tail = std::exchange(_tail, {});
     if (bytes_to_read == 0) {
         return ss::make_ready_future<>();
     }
+    if (tail.size() == bytes_to_read) {
+        // the page is still in memory since the chunk was reclaimed
+        std::copy_n(tail.get(), bytes_to_read, buff);
+        return ss::make_ready_future<>();
+    }
     return _out
       .dma_read(
         sz, buff, read_align /*must be full _write_ alignment*/, _opts.priority)
@@ -266,6 +320,8 @@ ss::future<> segment_appender::truncate(size_t n) {
       file_byte_offset(),
       *this);
     return flush().then([this, n] { return do_truncation(n); }).then([this, n] {
+        // the saved tail belongs to the old end of the file
+        _tail = {};
         _committed_offset = n;
         _fallocation_offset = n;
         auto f = ss::now();
@@ -276,7 +332,7 @@ ss::future<> segment_appender::truncate(size_t n) {
             _head->reset();
         } else {
             // https://github.com/vectorizedio/redpanda/issues/43
-            f = internal::chunks().get().then(
+            f = get_chunk().then(
               [this](ss::lw_shared_ptr<chunk> chunk) {
                   _head = std::move(chunk);
               });
@@ -395,7 +451,7 @@ void segment_appender::dispatch_background_head_write() {
                     h->reset();
                 }
                 if (h->is_empty()) {
-                    internal::chunks().add(h);
+                    release_chunk(h);
                 } else {
                     _head = h;
                 }
@@ -419,7 +475,12 @@ ss::future<> segment_appender::flush() {
     return ss::with_semaphore(
              _concurrent_flushes,
              ss::semaphore::max_counter(),
-             [this]() mutable { return _out.flush(); })
+             [this]() mutable {
+                 if (_opts.flusher) {
+                     return _opts.flusher->flush(_out);
+                 }
+                 return _out.flush();
+             })
       .handle_exception([this](std::exception_ptr e) {
           vassert(false, "Could not flush: {} - {}", e, *this);
       });
@@ -431,7 +492,8 @@ std::ostream& operator<<(std::ostream& o, const segment_appender& a) {
              << ", closed:" << a._closed
              << ", fallocation_offset:" << a._fallocation_offset
              << ", committed_offset:" << a._committed_offset
-             << ", bytes_flush_pending:" << a._bytes_flush_pending << "}";
+             << ", bytes_flush_pending:" << a._bytes_flush_pending
+             << ", chunks_held:" << a._chunks_held << "}";
 }
 
 } // namespace storage
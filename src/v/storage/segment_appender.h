@@ -15,6 +15,7 @@
 #include "bytes/iobuf.h"
 #include "likely.h"
 #include "seastarx.h"
+#include "storage/flush_scheduler.h"
 #include "storage/segment_appender_chunk.h"
 #include "utils/intrusive_list_helpers.h"
 
@@ -22,6 +23,7 @@
 #include <seastar/core/fstream.hh>
 #include <seastar/core/iostream.hh>
 #include <seastar/core/sstring.hh>
+#include <seastar/core/temporary_buffer.hh>
 
 #include <iosfwd>
 
@@ -53,6 +55,8 @@ public:
         ss::io_priority_class priority;
         size_t number_of_chunks{chunks_no_buffer};
         size_t falloc_step{fallocation_step};
+        // group commit of the shard, the file is flushed on its own if null
+        internal::flush_scheduler* flusher{nullptr};
     };
 
     segment_appender(ss::file f, options opts);
@@ -84,6 +88,7 @@ private:
     void dispatch_background_head_write();
     ss::future<> do_next_adaptive_fallocation();
     ss::future<> hydrate_last_half_page();
+    void save_tail();
     ss::future<> do_truncation(size_t);
     ss::future<> do_append(const char* buf, const size_t n);
 
@@ -109,6 +114,17 @@ private:
     size_t _bytes_flush_pending{0};
     ss::semaphore _concurrent_flushes;
     ss::lw_shared_ptr<chunk> _head;
+    /// bytes of the last partially written page, kept when the chunk of an
+    /// inactive appender is reclaimed so that the next append doesn't read
+    /// them back from the file
+    ss::temporary_buffer<char> _tail;
+
+    /// chunks taken from the shard chunk cache, including the head and the
+    /// chunks of in-flight writes
+    size_t _chunks_held{0};
+    ss::future<ss::lw_shared_ptr<chunk>> get_chunk();
+    void release_chunk(ss::lw_shared_ptr<chunk>);
+    bool over_fair_share() const;
 
     struct inflight_write {
         bool done;
@@ -63,4 +63,15 @@ write(segment_appender& appender, const model::record_batch& batch) {
       });
 }
 
+ss::future<>
+write(segment_appender& appender, std::vector<model::record_batch>& batches) {
+    auto buf = std::make_unique<iobuf>();
+    for (auto& b : batches) {
+        buf->append(disk_header_to_iobuf(b.header()));
+        buf->append(b.share().release_data());
+    }
+    auto ptr = buf.get();
+    return appender.append(*ptr).finally([cpy = std::move(buf)] {});
+}
+
 } // namespace storage
@@ -14,9 +14,16 @@
 #include "model/record.h"
 #include "storage/segment_appender.h"
 
+#include <vector>
+
 namespace storage {
 
 ss::future<>
 write(segment_appender& appender, const model::record_batch& batch);
 
+/// \brief writes \p batches back to back with a single append. records are
+/// shared with the batches, not copied
+ss::future<>
+write(segment_appender& appender, std::vector<model::record_batch>& batches);
+
 } // namespace storage
@@ -0,0 +1,150 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/segment_file_pool.h"
+
+#include "storage/logger.h"
+#include "storage/segment_utils.h"
+#include "utils/directory_walker.h"
+#include "utils/gate_guard.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/file.hh>
+#include <seastar/core/seastar.hh>
+
+#include <fmt/format.h>
+
+#include <exception>
+#include <vector>
+
+namespace storage {
+
+segment_file_pool::segment_file_pool(
+  std::filesystem::path dir,
+  size_t target_size,
+  size_t preallocation_size) noexcept
+  : _dir(std::move(dir))
+  , _target_size(target_size)
+  , _preallocation_size(preallocation_size) {}
+
+ss::future<bool> segment_file_pool::take(std::filesystem::path path) {
+    if (!enabled() || _gate.is_closed()) {
+        co_return false;
+    }
+    if (_spares.empty()) {
+        maybe_refill();
+        co_return false;
+    }
+    gate_guard guard{_gate};
+    // never replace an existing segment
+    if (co_await ss::file_exists(path.string())) {
+        co_return false;
+    }
+    if (_spares.empty()) {
+        co_return false;
+    }
+    auto spare = std::move(_spares.front());
+    _spares.pop_front();
+    std::exception_ptr e;
+    try {
+        co_await ss::rename_file(spare.string(), path.string());
+    } catch (...) {
+        e = std::current_exception();
+    }
+    if (e) {
+        vlog(
+          stlog.warn,
+          "Could not use spare segment file {}: {}",
+          spare.string(),
+          e);
+        co_await ss::remove_file(spare.string())
+          .handle_exception([](const std::exception_ptr&) {});
+        co_return false;
+    }
+    vlog(
+      stlog.debug,
+      "Using spare segment file {} for {}",
+      spare.string(),
+      path.string());
+    maybe_refill();
+    co_return true;
+}
+
+void segment_file_pool::maybe_refill() {
+    if (
+      !enabled() || _refilling || _gate.is_closed()
+      || _spares.size() >= _target_size) {
+        return;
+    }
+    _refilling = true;
+    (void)ss::with_gate(_gate, [this] {
+        return refill()
+          .handle_exception([this](const std::exception_ptr& e) {
+              vlog(
+                stlog.warn,
+                "Could not pre-allocate segment file in {}: {}",
+                _dir.string(),
+                e);
+          })
+          .finally([this] { _refilling = false; });
+    });
+}
+
+ss::future<> segment_file_pool::refill() {
+    if (!_initialized) {
+        co_await ss::recursive_touch_directory(_dir.string());
+        co_await remove_stale_files();
+        _initialized = true;
+    }
+    while (_spares.size() < _target_size && !_gate.is_closed()) {
+        co_await create_spare();
+    }
+}
+
+ss::future<> segment_file_pool::remove_stale_files() {
+    std::vector<ss::sstring> stale;
+    co_await directory_walker::walk(
+      _dir.string(), [&stale](ss::directory_entry de) {
+          stale.push_back(de.name);
+          return ss::now();
+      });
+    for (auto& name : stale) {
+        co_await ss::remove_file((_dir / name.c_str()).string());
+    }
+}
+
+ss::future<> segment_file_pool::create_spare() {
+    auto path = _dir / fmt::format("{}.spare", _next_id++);
+    auto f = co_await internal::make_writer_handle(
+      path, debug_sanitize_files::no);
+    std::exception_ptr e;
+    try {
+        co_await f.allocate(0, _preallocation_size);
+    } catch (...) {
+        e = std::current_exception();
+    }
+    co_await f.close();
+    if (e) {
+        co_await ss::remove_file(path.string());
+        std::rethrow_exception(e);
+    }
+    _spares.push_back(std::move(path));
+}
+
+ss::future<> segment_file_pool::stop() {
+    co_await _gate.close();
+    for (auto& p : _spares) {
+        co_await ss::remove_file(p.string())
+          .handle_exception([](const std::exception_ptr&) {});
+    }
+    _spares.clear();
+}
+
+} // namespace storage
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+#include "seastarx.h"
+
+#include <seastar/core/future.hh>
+#include <seastar/core/gate.hh>
+
+#include <deque>
+#include <filesystem>
+
+namespace storage {
+
+/**
+ * Keeps a number of empty, pre-allocated segment data files ready so that
+ * rolling a segment only renames one of them into place instead of creating
+ * and allocating a new file while the produce that triggered the roll waits.
+ *
+ * Spare files live in a per shard directory on the same file system as the
+ * logs and are refilled in the background after every hand over. Files left
+ * behind by a previous run are removed when the pool is first filled.
+ */
+class segment_file_pool {
+public:
+    segment_file_pool(
+      std::filesystem::path dir,
+      size_t target_size,
+      size_t preallocation_size) noexcept;
+
+    segment_file_pool(segment_file_pool&&) = delete;
+    segment_file_pool& operator=(segment_file_pool&&) = delete;
+    segment_file_pool(const segment_file_pool&) = delete;
+    segment_file_pool& operator=(const segment_file_pool&) = delete;
+    ~segment_file_pool() noexcept = default;
+
+    /// \brief moves a spare file to \p path. returns false when no spare is
+    /// available or \p path exists, then the caller creates it as usual.
+    ss::future<bool> take(std::filesystem::path path);
+
+    /// \brief starts filling the pool up to its target size in the background
+    void maybe_refill();
+
+    /// \brief waits for background work and removes unused spare files
+    ss::future<> stop();
+
+    bool enabled() const { return _target_size > 0; }
+    size_t available() const { return _spares.size(); }
+
+private:
+    ss::future<> refill();
+    ss::future<> remove_stale_files();
+    ss::future<> create_spare();
+
+    std::filesystem::path _dir;
+    size_t _target_size;
+    size_t _preallocation_size;
+    std::deque<std::filesystem::path> _spares;
+    uint64_t _next_id{0};
+    bool _initialized{false};
+    bool _refilling{false};
+    ss::gate _gate;
+};
+
+} // namespace storage
@@ -11,10 +11,13 @@
 
 #include "model/timestamp.h"
 #include "storage/logger.h"
+#include "utils/file_sanitizer.h"
 #include "vassert.h"
 
 #include <seastar/core/fstream.hh>
+#include <seastar/core/future-util.hh>
 #include <seastar/core/iostream.hh>
+#include <seastar/core/seastar.hh>
 
 #include <bits/stdint-uintn.h>
 #include <boost/container/container_fwd.hpp>
@@ -34,6 +37,17 @@ static inline segment_index::entry translate_index_entry(
     };
 }
 
+segment_index::segment_index(
+  ss::sstring filename,
+  model::offset base,
+  size_t step,
+  debug_sanitize_files sanitize)
+  : _name(std::move(filename))
+  , _sanitize(sanitize)
+  , _step(step) {
+    _state.base_offset = base;
+}
+
 segment_index::segment_index(
   ss::sstring filename, ss::file f, model::offset base, size_t step)
   : _name(std::move(filename))
@@ -42,30 +56,105 @@ segment_index::segment_index(
     _state.base_offset = base;
 }
 
+ss::future<ss::file> segment_index::open_file() {
+    return ss::open_file_dma(
+             _name, ss::open_flags::create | ss::open_flags::rw)
+      .then([sanitize = _sanitize](ss::file f) {
+          if (sanitize) {
+              return ss::file(ss::make_shared(file_io_sanitizer(std::move(f))));
+          }
+          return f;
+      });
+}
+
+template<typename Func>
+auto segment_index::with_file(Func f) {
+    if (_out) {
+        return ss::futurize_invoke(std::move(f), *_out);
+    }
+    return open_file().then([f = std::move(f)](ss::file fd) mutable {
+        return ss::futurize_invoke(std::move(f), fd).finally(
+          [fd]() mutable { return fd.close(); });
+    });
+}
+
 void segment_index::reset() {
     auto base = _state.base_offset;
+    _needs_hydration = false;
     _state = {};
     _state.base_offset = base;
     _acc = 0;
+    _batch_checksum = crc32();
+    _batch_checksum_valid = true;
 }
 
 void segment_index::swap_index_state(index_state&& o) {
     _needs_persistence = true;
+    _needs_hydration = false;
     _acc = 0;
+    _batch_checksum_valid = false;
     std::swap(_state, o);
+    _state.unseal();
 }
 
 void segment_index::maybe_track(
   const model::record_batch_header& hdr, size_t filepos) {
-    _acc += hdr.size_bytes;
+    _batch_checksum.extend(hdr.header_crc);
+    track(
+      hdr.base_offset,
+      hdr.last_offset(),
+      hdr.first_timestamp,
+      hdr.max_timestamp,
+      filepos,
+      hdr.size_bytes);
+}
+
+void segment_index::maybe_track(
+  const std::vector<model::record_batch>& batches, size_t filepos) {
+    const auto& first = batches.front().header();
+    size_t size_bytes = 0;
+    auto max_timestamp = first.max_timestamp;
+    for (const auto& b : batches) {
+        _batch_checksum.extend(b.header().header_crc);
+        size_bytes += b.size_bytes();
+        max_timestamp = std::max(max_timestamp, b.header().max_timestamp);
+    }
+    track(
+      first.base_offset,
+      batches.back().last_offset(),
+      first.first_timestamp,
+      max_timestamp,
+      filepos,
+      size_bytes);
+}
+
+void segment_index::seal(size_t segment_size) {
+    if (!_batch_checksum_valid || _needs_hydration) {
+        return;
+    }
+    _state.seal(segment_size, _batch_checksum.value());
+    _needs_persistence = true;
+}
+
+void segment_index::track(
+  model::offset base_offset,
+  model::offset last_offset,
+  model::timestamp first_timestamp,
+  model::timestamp max_timestamp,
+  size_t filepos,
+  size_t size_bytes) {
+    vassert(
+      !_needs_hydration, "Cannot append to a partially loaded index: {}", _name);
+    _state.unseal();
+    _acc += size_bytes;
     if (_state.maybe_index(
           _acc,
           _step,
           filepos,
-          hdr.base_offset,
-          hdr.last_offset(),
-          hdr.first_timestamp,
-          hdr.max_timestamp)) {
+          base_offset,
+          last_offset,
+          first_timestamp,
+          max_timestamp)) {
         _acc = 0;
     }
     _needs_persistence = true;
@@ -85,10 +174,10 @@ segment_index::find_nearest(model::timestamp t) {
       std::end(_state.relative_time_index),
       i,
       std::less<uint32_t>{});
-    if (it == _state.relative_offset_index.end()) {
+    if (it == _state.relative_time_index.end()) {
         return std::nullopt;
     }
-    auto dist = std::distance(_state.relative_offset_index.begin(), it);
+    auto dist = std::distance(_state.relative_time_index.begin(), it);
     return translate_index_entry(_state, _state.get_entry(dist));
 }
 
@@ -118,9 +207,21 @@ segment_index::find_nearest(model::offset o) {
 }
 
 ss::future<> segment_index::truncate(model::offset o) {
+    return hydrate().then([this, o] { return do_truncate(o); });
+}
+
+ss::future<> segment_index::do_truncate(model::offset o) {
     if (o < _state.base_offset) {
         return ss::now();
     }
+    if (o < _state.max_offset) {
+        // the checksum covers batches that are being removed
+        _batch_checksum_valid = false;
+        if (_state.is_sealed()) {
+            _state.unseal();
+            _needs_persistence = true;
+        }
+    }
     const uint32_t i = o() - _state.base_offset();
     auto it = std::lower_bound(
       std::begin(_state.relative_offset_index),
@@ -148,10 +249,11 @@ ss::future<> segment_index::truncate(model::offset o) {
 }
 
 ss::future<bool> segment_index::materialize_index() {
-    return _out.size()
-      .then([this](uint64_t size) mutable {
-          return _out.dma_read_bulk<char>(0, size);
-      })
+    return with_file([](ss::file f) {
+               return f.size().then([f](uint64_t size) mutable {
+                   return f.dma_read_bulk<char>(0, size);
+               });
+           })
       .then([this](ss::temporary_buffer<char> buf) {
           if (buf.empty()) {
               return false;
@@ -163,13 +265,85 @@ ss::future<bool> segment_index::materialize_index() {
               return false;
           }
           _state = std::move(hydrated.value());
+          _needs_hydration = false;
+          _batch_checksum_valid = false;
           return true;
       });
 }
 
+ss::future<bool> segment_index::materialize_index_header() {
+    return with_file([this](ss::file f) {
+        return f.size().then([this, f](uint64_t size) mutable {
+            if (size < index_state::min_header_size) {
+                return ss::make_ready_future<bool>(false);
+            }
+            // dma reads are block aligned anyway
+            const auto len = std::min<uint64_t>(size, 4096);
+            return f.dma_read_bulk<char>(0, len).then(
+              [this, size](ss::temporary_buffer<char> buf) {
+                  iobuf b;
+                  b.append(std::move(buf));
+                  auto hydrated = index_state::hydrate_header_from_buffer(
+                    std::move(b), size);
+                  if (!hydrated) {
+                      return false;
+                  }
+                  _state = std::move(hydrated.value());
+                  _needs_hydration = true;
+                  _batch_checksum_valid = false;
+                  return true;
+              });
+        });
+    });
+}
+
+ss::future<> segment_index::hydrate() {
+    if (!_needs_hydration) {
+        return ss::now();
+    }
+    if (!_hydration) {
+        _hydration = ss::shared_future<>(do_hydrate());
+    }
+    return _hydration->get_future();
+}
+
+ss::future<> segment_index::do_hydrate() {
+    return with_file([](ss::file f) {
+               return f.size().then([f](uint64_t size) mutable {
+                   return f.dma_read_bulk<char>(0, size);
+               });
+           })
+      .then([this](ss::temporary_buffer<char> buf) {
+          if (!_needs_hydration) {
+              // the state was replaced in the meantime
+              return;
+          }
+          _needs_hydration = false;
+          iobuf b;
+          b.append(std::move(buf));
+          auto hydrated = index_state::hydrate_from_buffer(std::move(b));
+          if (
+            !hydrated || hydrated->base_offset != _state.base_offset
+            || hydrated->max_offset != _state.max_offset) {
+              /*
+               * the header was already used to recover the segment offsets.
+               * keep it without entries: lookups in this segment fall back to
+               * scanning from the beginning of the segment.
+               */
+              vlog(
+                stlog.warn,
+                "Unable to load index entries of {}, reads will scan the "
+                "segment from its beginning",
+                _name);
+              return;
+          }
+          _state = std::move(hydrated.value());
+      });
+}
+
 ss::future<> segment_index::drop_all_data() {
     reset();
-    return _out.truncate(0);
+    return with_file([](ss::file f) { return f.truncate(0); });
 }
 
 ss::future<> segment_index::flush() {
@@ -177,9 +351,14 @@ ss::future<> segment_index::flush() {
         return ss::make_ready_future<>();
     }
     _needs_persistence = false;
-    return _out.truncate(0)
-      .then(
-        [this] { return ss::make_file_output_stream(ss::file(_out.dup())); })
+    return with_file([this](ss::file f) { return do_flush(f); });
+}
+
+ss::future<> segment_index::do_flush(ss::file f) {
+    return f.truncate(0)
+      .then([f]() mutable {
+          return ss::make_file_output_stream(ss::file(f.dup()));
+      })
       .then([this](ss::output_stream<char> out) {
           auto b = _state.checksum_and_serialize();
           return do_with(
@@ -197,12 +376,13 @@ ss::future<> segment_index::flush() {
       });
 }
 ss::future<> segment_index::close() {
-    return flush().then([this] { return _out.close(); });
+    return flush().then([this] { return _out ? _out->close() : ss::now(); });
 }
 std::ostream& operator<<(std::ostream& o, const segment_index& i) {
     return o << "{file:" << i.filename() << ", offsets:" << i.base_offset()
              << ", index:" << i._state << ", step:" << i._step
-             << ", needs_persistence:" << i._needs_persistence << "}";
+             << ", needs_persistence:" << i._needs_persistence
+             << ", needs_hydration:" << i._needs_hydration << "}";
 }
 std::ostream& operator<<(std::ostream& o, const segment_index_ptr& i) {
     if (i) {
@@ -10,12 +10,15 @@
  */
 
 #pragma once
+#include "hashing/crc32c.h"
 #include "model/fundamental.h"
 #include "model/record.h"
 #include "model/timestamp.h"
 #include "storage/index_state.h"
+#include "storage/types.h"
 
 #include <seastar/core/file.hh>
+#include <seastar/core/shared_future.hh>
 #include <seastar/core/unaligned.hh>
 
 #include <memory>
@@ -34,6 +37,12 @@ namespace storage {
  *
  * The name of this index _must_ be then:
  *     default/test/0/1-1-v1.base_index
+ *
+ * The file is only read at recovery and hydration, and written when the
+ * segment is flushed on a roll or a close, so an index built from a file name
+ * opens a handle for each of these operations instead of keeping one for the
+ * lifetime of the segment. With a long tail of low throughput partitions this
+ * saves a file descriptor for every segment of the shard.
  */
 class segment_index {
 public:
@@ -48,8 +57,15 @@ public:
     // 32KB - a well known number as a sweet spot for fetching data from disk
     static constexpr size_t default_data_buffer_step = 4096 * 8;
 
+    /// \brief index opening \p filename whenever it reads or writes it
+    segment_index(
+      ss::sstring filename,
+      model::offset base,
+      size_t step,
+      debug_sanitize_files);
+    /// \brief index using the handle \p f for its whole lifetime
     segment_index(
-      ss::sstring filename, ss::file, model::offset base, size_t step);
+      ss::sstring filename, ss::file f, model::offset base, size_t step);
     ~segment_index() noexcept = default;
     segment_index(segment_index&&) noexcept = default;
     segment_index& operator=(segment_index&&) noexcept = default;
@@ -57,6 +73,21 @@ public:
     segment_index& operator=(const segment_index&) = delete;
 
     void maybe_track(const model::record_batch_header&, size_t filepos);
+    /// \brief tracks contiguous batches written at \p filepos as a whole,
+    /// the index entry, if any, points at the first batch of the range
+    void maybe_track(const std::vector<model::record_batch>&, size_t filepos);
+
+    /**
+     * \brief records the summary of a segment whose appender is closed, see
+     * index_state. The index is sealed only if every batch of the segment was
+     * tracked by it, an index loaded from disk, swapped or truncated is not.
+     */
+    void seal(size_t segment_size);
+    bool is_sealed() const { return _state.is_sealed(); }
+    /// \brief size of the segment file recorded when the index was sealed
+    size_t sealed_size() const { return _state.segment_size; }
+    /// \brief rolling crc of the batch header crcs recorded with the seal
+    uint32_t sealed_checksum() const { return _state.segment_checksum; }
     std::optional<entry> find_nearest(model::offset);
     std::optional<entry> find_nearest(model::timestamp);
 
@@ -67,6 +98,15 @@ public:
     const ss::sstring& filename() const { return _name; }
 
     ss::future<bool> materialize_index();
+    /**
+     * \brief loads only the header of the index file. The entries are loaded
+     * on demand by hydrate(). Until then find_nearest() finds no entry, so
+     * callers that need an exact file position must hydrate first.
+     */
+    ss::future<bool> materialize_index_header();
+    /// \brief loads the entries of an index materialized with only a header
+    ss::future<> hydrate();
+    bool is_hydrated() const { return !_needs_hydration; }
     ss::future<> close();
     ss::future<> flush();
     ss::future<> truncate(model::offset);
@@ -81,14 +121,37 @@ public:
     void reset();
     void swap_index_state(index_state&&);
     bool needs_persistence() const { return _needs_persistence; }
+    /// \brief entries of the index, they are only loaded once it is hydrated
+    const index_state& state() const { return _state; }
     index_state release_index_state() && { return std::move(_state); }
 
 private:
+    void track(
+      model::offset base_offset,
+      model::offset last_offset,
+      model::timestamp first_timestamp,
+      model::timestamp max_timestamp,
+      size_t filepos,
+      size_t size_bytes);
+    ss::future<> do_hydrate();
+    ss::future<> do_truncate(model::offset);
+    ss::future<> do_flush(ss::file);
+    ss::future<ss::file> open_file();
+    template<typename Func>
+    auto with_file(Func);
+
     ss::sstring _name;
-    ss::file _out;
+    debug_sanitize_files _sanitize{debug_sanitize_files::no};
+    /// only set for an index with a handle of its own
+    std::optional<ss::file> _out;
     size_t _step;
     size_t _acc{0};
     bool _needs_persistence{false};
+    bool _needs_hydration{false};
+    /// rolling checksum of the tracked batches, see index_state
+    crc32 _batch_checksum;
+    bool _batch_checksum_valid{true};
+    std::optional<ss::shared_future<>> _hydration;
     index_state _state;
 
     friend std::ostream& operator<<(std::ostream&, const segment_index&);
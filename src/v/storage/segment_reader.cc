@@ -45,6 +45,37 @@ segment_reader::data_stream(size_t pos, const ss::io_priority_class& pc) {
       _data_file, pos, _file_size - pos, std::move(options));
 }
 
+ss::input_stream<char> segment_reader::data_stream(
+  size_t pos, size_t len, const ss::io_priority_class& pc) {
+    vassert(
+      pos + len <= _file_size,
+      "cannot read past the end. Asked to read {} bytes at position: '{}' - "
+      "{}",
+      len,
+      pos,
+      *this);
+    ss::file_input_stream_options options;
+    options.buffer_size = _buffer_size;
+    options.io_priority_class = pc;
+    options.read_ahead = 4;
+    return make_file_input_stream(_data_file, pos, len, std::move(options));
+}
+
+ss::input_stream<char> segment_reader::data_stream(
+  size_t pos, const ss::io_priority_class& pc, stream_buffering buffering) {
+    vassert(
+      pos <= _file_size,
+      "cannot read negative bytes. Asked to read at position: '{}' - {}",
+      pos,
+      *this);
+    ss::file_input_stream_options options;
+    options.buffer_size = buffering.buffer_size;
+    options.io_priority_class = pc;
+    options.read_ahead = buffering.read_ahead;
+    return make_file_input_stream(
+      _data_file, pos, _file_size - pos, std::move(options));
+}
+
 ss::future<> segment_reader::truncate(size_t n) {
     _file_size = n;
     return ss::open_file_dma(_filename, ss::open_flags::rw)
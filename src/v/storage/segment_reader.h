@@ -26,6 +26,12 @@
 
 namespace storage {
 
+/// buffering of a segment input stream
+struct stream_buffering {
+    size_t buffer_size;
+    unsigned read_ahead;
+};
+
 class segment_reader {
 public:
     segment_reader(
@@ -65,6 +71,17 @@ public:
     ss::input_stream<char>
     data_stream(size_t pos, const ss::io_priority_class&);
 
+    /// create an input stream _sharing_ the underlying file handle of the
+    /// @len bytes starting at position @pos
+    ss::input_stream<char>
+    data_stream(size_t pos, size_t len, const ss::io_priority_class&);
+
+    /// same as above with explicit buffering, used for sequential scans. the
+    /// dynamic adjustments history of the file is not shared with such
+    /// streams so that a scan does not skew buffering for random readers.
+    ss::input_stream<char> data_stream(
+      size_t pos, const ss::io_priority_class&, stream_buffering);
+
 private:
     ss::sstring _filename;
     ss::file _data_file;
@@ -20,10 +20,14 @@
 #include <seastar/core/loop.hh>
 #include <seastar/core/seastar.hh>
 #include <seastar/core/thread.hh>
+#include <seastar/util/defer.hh>
 
 #include <fmt/format.h>
 
+#include <algorithm>
+#include <chrono>
 #include <exception>
+#include <optional>
 
 namespace storage {
 struct segment_ordering {
@@ -34,9 +38,6 @@ struct segment_ordering {
     bool operator()(const type& seg, model::offset value) const {
         return seg->offsets().dirty_offset < value;
     }
-    bool operator()(const type& seg, model::timestamp value) const {
-        return seg->index().max_timestamp() < value;
-    }
 };
 
 segment_set::segment_set(segment_set::underlying_t segs)
@@ -45,6 +46,7 @@ segment_set::segment_set(segment_set::underlying_t segs)
 }
 
 void segment_set::add(ss::lw_shared_ptr<segment> h) {
+    invalidate_time_summary();
     if (!_handles.empty()) {
         vassert(
           h->offsets().base_offset > _handles.back()->offsets().dirty_offset,
@@ -58,9 +60,16 @@ void segment_set::add(ss::lw_shared_ptr<segment> h) {
     _handles.emplace_back(std::move(h));
 }
 
-void segment_set::pop_back() { _handles.pop_back(); }
-void segment_set::pop_front() { _handles.pop_front(); }
+void segment_set::pop_back() {
+    invalidate_time_summary();
+    _handles.pop_back();
+}
+void segment_set::pop_front() {
+    invalidate_time_summary();
+    _handles.pop_front();
+}
 void segment_set::erase(iterator begin, iterator end) {
+    invalidate_time_summary();
     _handles.erase(begin, end);
 }
 
@@ -75,15 +84,6 @@ struct needle_in_range {
         return o <= s.offsets().dirty_offset && o >= s.offsets().base_offset;
     }
 
-    bool operator()(Iterator ptr, model::timestamp t) {
-        auto& s = **ptr;
-        if (s.empty()) {
-            return false;
-        }
-        // must use max_offset
-        return t <= s.index().max_timestamp()
-               && t >= s.index().base_timestamp();
-    }
 };
 
 template<typename Iterator, typename Needle>
@@ -130,15 +130,42 @@ segment_set::lower_bound(model::offset offset) const {
 // entry is greater than the target timestamp, the broker will do binary search
 // on that time index to find the closest index entry and scan the log from
 // there. Otherwise it will move on to the next log segment.
+//
+// Rather than checking the segments one by one, the earliest segment is found
+// by a binary search over the running maximum of the segment timestamps.
+size_t segment_set::timestamp_lower_bound(model::timestamp needle) const {
+    if (_handles.empty()) {
+        return 0;
+    }
+    if (_time_summary_stale) {
+        _max_timestamps.clear();
+        _max_timestamps.reserve(_handles.size() - 1);
+        auto max = model::timestamp::missing();
+        for (size_t i = 0; i + 1 < _handles.size(); ++i) {
+            max = std::max(max, _handles[i]->index().max_timestamp());
+            _max_timestamps.push_back(max);
+        }
+        _time_summary_stale = false;
+    }
+    auto it = std::lower_bound(
+      _max_timestamps.begin(), _max_timestamps.end(), needle);
+    if (it != _max_timestamps.end()) {
+        return std::distance(_max_timestamps.begin(), it);
+    }
+    // only the active segment is left
+    if (_handles.back()->index().max_timestamp() >= needle) {
+        return _handles.size() - 1;
+    }
+    return _handles.size();
+}
+
 segment_set::iterator segment_set::lower_bound(model::timestamp needle) {
-    return std::lower_bound(
-      std::begin(_handles), std::end(_handles), needle, segment_ordering{});
+    return std::next(_handles.begin(), timestamp_lower_bound(needle));
 }
 
 segment_set::const_iterator
 segment_set::lower_bound(model::timestamp needle) const {
-    return segments_lower_bound(
-      std::cbegin(_handles), std::cend(_handles), needle);
+    return std::next(_handles.cbegin(), timestamp_lower_bound(needle));
 }
 
 std::ostream& operator<<(std::ostream& o, const segment_set& s) {
@@ -149,26 +176,82 @@ std::ostream& operator<<(std::ostream& o, const segment_set& s) {
     return o << "]}";
 }
 
-// Recover the last segment. Whenever we close a segment, we will likely
-// open a new one to which we will direct new writes. That new segment
-// might be empty. To optimize log replay, implement #140.
-static ss::future<segment_set>
-unsafe_do_recover(segment_set&& segments, ss::abort_source& as) {
-    return ss::async([segments = std::move(segments), &as]() mutable {
+/// A segment whose appender was closed cleanly has a sealed index that
+/// records the size of the segment file and a checksum of its batch headers.
+/// If the file still has that size and its headers add up to the checksum
+/// the segment does not need to be replayed. Must be called in a seastar
+/// thread.
+static bool is_sealed_segment(segment& s) {
+    try {
+        if (!s.materialize_index().get0() || !s.index().is_sealed()) {
+            return false;
+        }
+        auto stat = s.reader().stat().get0();
+        if (size_t(stat.st_size) != s.index().sealed_size()) {
+            vlog(
+              stlog.info,
+              "Size of sealed segment {} changed from {} to {}, recovering",
+              s.reader().filename(),
+              s.index().sealed_size(),
+              stat.st_size);
+            return false;
+        }
+        return log_replayer(s).verify_seal_in_thread(
+          ss::default_priority_class());
+    } catch (...) {
+        vlog(
+          stlog.info,
+          "Error materializing index:{}. Recovering parent segment:{}. "
+          "Details:{}",
+          s.index().filename(),
+          s.reader().filename(),
+          std::current_exception());
+    }
+    return false;
+}
+
+// Recover the last segment unless it was sealed. Whenever we close a segment,
+// we will likely open a new one to which we will direct new writes. That new
+// segment might be empty. To optimize log replay, implement #140.
+//
+// With lazy index hydration only the header of each index is loaded, which is
+// enough to recover the offsets of a segment. The remaining entries are loaded
+// by the first read of the segment.
+static ss::future<segment_set> unsafe_do_recover(
+  segment_set&& segments,
+  lazy_index_hydration lazy,
+  recovery_timings& timings,
+  ss::abort_source& as) {
+    return ss::async([segments = std::move(segments),
+                      lazy,
+                      &timings,
+                      &as]() mutable {
+        using clock_type = std::chrono::steady_clock;
         if (segments.empty() || as.abort_requested()) {
             return std::move(segments);
         }
+        auto index_start = clock_type::now();
         segment_set::underlying_t good = std::move(segments).release();
         segment_set::underlying_t to_recover;
-        to_recover.push_back(std::move(good.back()));
-        good.pop_back(); // always recover last segment
+        // a sealed last segment was closed cleanly, otherwise recover it
+        std::optional<ss::lw_shared_ptr<segment>> sealed_tail;
+        if (is_sealed_segment(*good.back())) {
+            vlog(stlog.debug, "Skipping recovery of sealed {}", good.back());
+            sealed_tail = std::move(good.back());
+        } else {
+            to_recover.push_back(std::move(good.back()));
+        }
+        good.pop_back();
         // keep segments sorted
         auto good_end = std::stable_partition(
-          good.begin(), good.end(), [](ss::lw_shared_ptr<segment>& ss) {
+          good.begin(), good.end(), [lazy](ss::lw_shared_ptr<segment>& ss) {
               auto& s = *ss;
               try {
                   // use the segment materialize instead of going through
                   // the index directly to hydrate the max_offset state
+                  if (lazy) {
+                      return s.materialize_index_header().get0();
+                  }
                   return s.materialize_index().get0();
               } catch (...) {
                   vlog(
@@ -206,12 +289,22 @@ unsafe_do_recover(segment_set&& segments, ss::abort_source& as) {
           });
         // remove empty from to recover set
         to_recover.erase(non_empty_end, to_recover.end());
-        // we left with nothing to recover, take the last good segment if
-        // available
-        if (to_recover.empty() && !good.empty()) {
+        if (sealed_tail) {
+            good.push_back(std::move(*sealed_tail));
+        } else if (to_recover.empty() && !good.empty()) {
+            // we left with nothing to recover, take the last good segment if
+            // available
             to_recover.push_back(std::move(good.back()));
             good.pop_back();
         }
+        auto replay_start = clock_type::now();
+        timings.index = std::chrono::duration_cast<std::chrono::milliseconds>(
+          replay_start - index_start);
+        auto record_replay = ss::defer([&timings, replay_start] {
+            timings.replay
+              = std::chrono::duration_cast<std::chrono::milliseconds>(
+                clock_type::now() - replay_start);
+        });
 
         for (auto& s : to_recover) {
             // check for abort
@@ -243,8 +336,11 @@ unsafe_do_recover(segment_set&& segments, ss::abort_source& as) {
     });
 }
 
-static ss::future<segment_set>
-do_recover(segment_set&& segments, ss::abort_source& as) {
+static ss::future<segment_set> do_recover(
+  segment_set&& segments,
+  lazy_index_hydration lazy,
+  recovery_timings& timings,
+  ss::abort_source& as) {
     // light-weight copy used for clean-up if recovery fails
     segment_set::underlying_t copy;
     copy.reserve(segments.size());
@@ -256,7 +352,7 @@ do_recover(segment_set&& segments, ss::abort_source& as) {
     // are any pending io operations on a file associated with the segment
     // at the time of destruction seastar will complain about the file handle
     // being destroyed with pending ops.
-    return unsafe_do_recover(std::move(segments), as)
+    return unsafe_do_recover(std::move(segments), lazy, timings, as)
       .handle_exception(
         [copy = std::move(copy)](const std::exception_ptr& ex) mutable {
             return ss::do_with(
@@ -340,13 +436,20 @@ ss::future<segment_set> recover_segments(
   debug_sanitize_files sanitize_fileops,
   bool is_compaction_enabled,
   std::function<std::optional<batch_cache_index>()> cache_factory,
-  ss::abort_source& as) {
+  ss::abort_source& as,
+  lazy_index_hydration lazy,
+  recovery_timings& timings) {
+    using clock_type = std::chrono::steady_clock;
+    auto open_start = clock_type::now();
     return ss::recursive_touch_directory(path.string())
       .then([&as, cache_factory, sanitize_fileops, path = std::move(path)] {
           return open_segments(
             path.string(), sanitize_fileops, cache_factory, as);
       })
-      .then([&as, is_compaction_enabled](segment_set::underlying_t segs) {
+      .then([&as, is_compaction_enabled, lazy, &timings, open_start](
+              segment_set::underlying_t segs) {
+          timings.open = std::chrono::duration_cast<std::chrono::milliseconds>(
+            clock_type::now() - open_start);
           auto segments = segment_set(std::move(segs));
           // we have to mark compacted segments before recovery to allow reading
           // gaps introduced by compaction
@@ -355,7 +458,7 @@ ss::future<segment_set> recover_segments(
                   s->mark_as_compacted_segment();
               }
           }
-          return do_recover(std::move(segments), as);
+          return do_recover(std::move(segments), lazy, timings, as);
       });
 }
 
@@ -11,11 +11,13 @@
 
 #pragma once
 
+#include "model/timestamp.h"
 #include "storage/segment.h"
 
 #include <seastar/core/circular_buffer.hh>
 
 #include <deque>
+#include <vector>
 
 namespace storage {
 /*
@@ -71,6 +73,8 @@ public:
 
     iterator lower_bound(model::offset o);
     const_iterator lower_bound(model::offset o) const;
+    /// first segment holding a batch with a max timestamp of at least \p o,
+    /// or end(). O(log n) over the time summary, see below
     iterator lower_bound(model::timestamp o);
     const_iterator lower_bound(model::timestamp o) const;
 
@@ -82,8 +86,23 @@ public:
     const_iterator end() const { return _handles.end(); }
 
 private:
+    size_t timestamp_lower_bound(model::timestamp) const;
+    void invalidate_time_summary() { _time_summary_stale = true; }
+
     underlying_t _handles;
 
+    /*
+     * Time summary: running maximum of the max timestamp of every segment but
+     * the last, whose maximum still moves with appends. Timestamps are not
+     * guaranteed to increase across segments (e.g. producer create time), but
+     * the running maximum does, which makes it binary searchable. It is
+     * rebuilt lazily after the set of segments changes. Compaction can only
+     * lower the max timestamp of a closed segment, which leaves the summary a
+     * conservative upper bound until the next rebuild.
+     */
+    mutable std::vector<model::timestamp> _max_timestamps;
+    mutable bool _time_summary_stale{true};
+
     friend std::ostream& operator<<(std::ostream&, const segment_set&);
 };
 
@@ -92,7 +111,9 @@ ss::future<segment_set> recover_segments(
   debug_sanitize_files sanitize_fileops,
   bool is_compaction_enabled,
   std::function<std::optional<batch_cache_index>()> batch_cache_factory,
-  ss::abort_source& as);
+  ss::abort_source& as,
+  lazy_index_hydration lazy,
+  recovery_timings& timings);
 
 std::ostream& operator<<(std::ostream&, const segment_set&);
 
@@ -21,6 +21,7 @@
 #include "storage/compacted_index_writer.h"
 #include "storage/compaction_reducers.h"
 #include "storage/index_state.h"
+#include "storage/key_bloom_filter.h"
 #include "storage/lock_manager.h"
 #include "storage/log_reader.h"
 #include "storage/logger.h"
@@ -132,16 +133,18 @@ ss::future<segment_appender_ptr> make_segment_appender(
   const std::filesystem::path& path,
   debug_sanitize_files debug,
   size_t number_of_chunks,
-  ss::io_priority_class iopc) {
+  ss::io_priority_class iopc,
+  flush_scheduler* flusher) {
     return internal::make_writer_handle(path, debug)
-      .then([number_of_chunks, iopc, path](ss::file writer) {
+      .then([number_of_chunks, iopc, flusher, path](ss::file writer) {
           try {
               // NOTE: This try-catch is needed to not uncover the real
               // exception during an OOM condition, since the appender allocates
               // 1MB of memory aligned buffers
+              segment_appender::options opts(iopc, number_of_chunks);
+              opts.flusher = flusher;
               return ss::make_ready_future<segment_appender_ptr>(
-                std::make_unique<segment_appender>(
-                  writer, segment_appender::options(iopc, number_of_chunks)));
+                std::make_unique<segment_appender>(writer, opts));
           } catch (...) {
               auto e = std::current_exception();
               vlog(stlog.error, "could not allocate appender: {}", e);
@@ -191,36 +194,44 @@ ss::future<> copy_filtered_entries(
       });
 }
 
+static ss::future<> do_write_filtered_compacted_index(
+  compacted_index_reader reader, Roaring bitmap, compaction_config cfg) {
+    const auto tmpname = std::filesystem::path(
+      fmt::format("{}.staging", reader.filename()));
+    return make_handle(
+             tmpname,
+             ss::open_flags::rw | ss::open_flags::truncate
+               | ss::open_flags::create,
+             writer_opts(),
+             cfg.sanitize)
+      .then([tmpname, cfg, reader, bm = std::move(bitmap)](ss::file f) mutable {
+          auto writer = make_file_backed_compacted_index(
+            tmpname.string(),
+            std::move(f),
+            cfg.iopc,
+            // TODO: pass this memory from the cfg
+            segment_appender::write_behind_memory / 2);
+          return copy_filtered_entries(
+            reader, std::move(bm), std::move(writer));
+      })
+      .then([old_name = tmpname.string(), new_name = reader.filename()] {
+          // from glibc: If oldname is not a directory, then any
+          // existing file named newname is removed during the
+          // renaming operation
+          return ss::rename_file(old_name, new_name)
+            .then([old_name, new_name] {
+                return rename_key_bloom_filter(old_name, new_name);
+            });
+      });
+}
+
 static ss::future<> do_write_clean_compacted_index(
   compacted_index_reader reader, compaction_config cfg) {
-    return natural_index_of_entries_to_keep(reader).then([reader,
-                                                          cfg](Roaring bitmap) {
-        const auto tmpname = std::filesystem::path(
-          fmt::format("{}.staging", reader.filename()));
-        return make_handle(
-                 tmpname,
-                 ss::open_flags::rw | ss::open_flags::truncate
-                   | ss::open_flags::create,
-                 writer_opts(),
-                 cfg.sanitize)
-          .then(
-            [tmpname, cfg, reader, bm = std::move(bitmap)](ss::file f) mutable {
-                auto writer = make_file_backed_compacted_index(
-                  tmpname.string(),
-                  std::move(f),
-                  cfg.iopc,
-                  // TODO: pass this memory from the cfg
-                  segment_appender::write_behind_memory / 2);
-                return copy_filtered_entries(
-                  reader, std::move(bm), std::move(writer));
-            })
-          .then([old_name = tmpname.string(), new_name = reader.filename()] {
-              // from glibc: If oldname is not a directory, then any
-              // existing file named newname is removed during the
-              // renaming operation
-              return ss::rename_file(old_name, new_name);
-          });
-    });
+    return natural_index_of_entries_to_keep(reader).then(
+      [reader, cfg](Roaring bitmap) {
+          return do_write_filtered_compacted_index(
+            reader, std::move(bitmap), cfg);
+      });
 }
 
 ss::future<> write_clean_compacted_index(
@@ -318,7 +329,16 @@ ss::future<storage::index_state> do_copy_segment_data(
               .then([l = std::move(list), &pb, h = std::move(h), cfg, s](
                       segment_appender_ptr w) mutable {
                   auto raw = w.get();
-                  auto red = copy_data_segment_reducer(std::move(l), raw);
+                  std::optional<tombstone_filter> tombstones;
+                  if (cfg.tombstone_eviction_time) {
+                      tombstones = tombstone_filter{
+                        .eviction_time = *cfg.tombstone_eviction_time,
+                        .last_offset = s->offsets().dirty_offset,
+                        .probe = &pb,
+                      };
+                  }
+                  auto red = copy_data_segment_reducer(
+                    std::move(l), raw, tombstones);
                   auto r = create_segment_full_reader(s, cfg, pb, std::move(h));
                   return std::move(r)
                     .consume(std::move(red), model::no_timeout)
@@ -391,33 +411,22 @@ ss::future<> do_swap_data_file_handles(
       });
 }
 
-ss::future<> do_self_compact_segment(
-  ss::lw_shared_ptr<segment> s, compaction_config cfg, storage::probe& pb) {
-    return s->read_lock()
-      .then([cfg, s, &pb](ss::rwlock::holder h) {
+/// \brief replaces the data file of \p s with the compacted staging file
+/// written by do_copy_segment_data and installs its index
+static ss::future<> install_compacted_segment_data(
+  ss::lw_shared_ptr<segment> s,
+  index_state idx,
+  compaction_config cfg,
+  storage::probe& pb) {
+    return s->write_lock()
+      .then([s, idx = std::move(idx)](ss::rwlock::holder h) mutable {
+          using type = std::tuple<index_state, ss::rwlock::holder>;
           if (s->is_closed()) {
-              return ss::make_exception_future<index_state>(
+              return ss::make_exception_future<type>(
                 segment_closed_exception());
           }
-
-          return do_compact_segment_index(s, cfg)
-            // copy the bytes after segment is good - note that we
-            // need to do it with the READ-lock, not the write lock
-            .then([cfg, s, h = std::move(h), &pb]() mutable {
-                return do_copy_segment_data(s, cfg, pb, std::move(h));
-            });
-      })
-      .then([s](storage::index_state idx) {
-          return s->write_lock().then(
-            [s, idx = std::move(idx)](ss::rwlock::holder h) mutable {
-                using type = std::tuple<index_state, ss::rwlock::holder>;
-                if (s->is_closed()) {
-                    return ss::make_exception_future<type>(
-                      segment_closed_exception());
-                }
-                return ss::make_ready_future<type>(
-                  std::make_tuple(std::move(idx), std::move(h)));
-            });
+          return ss::make_ready_future<type>(
+            std::make_tuple(std::move(idx), std::move(h)));
       })
       .then([cfg, s, &pb](std::tuple<index_state, ss::rwlock::holder> h) {
           return s->index()
@@ -436,6 +445,27 @@ ss::future<> do_self_compact_segment(
       });
 }
 
+ss::future<> do_self_compact_segment(
+  ss::lw_shared_ptr<segment> s, compaction_config cfg, storage::probe& pb) {
+    return s->read_lock()
+      .then([cfg, s, &pb](ss::rwlock::holder h) {
+          if (s->is_closed()) {
+              return ss::make_exception_future<index_state>(
+                segment_closed_exception());
+          }
+
+          return do_compact_segment_index(s, cfg)
+            // copy the bytes after segment is good - note that we
+            // need to do it with the READ-lock, not the write lock
+            .then([cfg, s, h = std::move(h), &pb]() mutable {
+                return do_copy_segment_data(s, cfg, pb, std::move(h));
+            });
+      })
+      .then([s, cfg, &pb](storage::index_state idx) {
+          return install_compacted_segment_data(s, std::move(idx), cfg, pb);
+      });
+}
+
 ss::future<> rebuild_compaction_index(
   model::record_batch_reader rdr,
   std::filesystem::path p,
@@ -510,6 +540,90 @@ ss::future<> self_compact_segment(
       .finally([&pb] { pb.segment_compacted(); });
 }
 
+ss::future<bool> build_key_offset_map(
+  std::vector<ss::lw_shared_ptr<segment>> segments,
+  key_offset_map& map,
+  size_t max_memory,
+  compaction_config cfg) {
+    for (auto& s : segments) {
+        if (cfg.asrc->abort_requested()) {
+            break;
+        }
+        auto h = co_await s->read_lock();
+        if (s->is_closed()) {
+            // removed by a concurrent truncation or retention
+            continue;
+        }
+        auto path = compacted_index_path(s->reader().filename().c_str());
+        auto f = co_await make_reader_handle(path, cfg.sanitize);
+        auto reader = make_file_backed_compacted_reader(
+          path.string(), std::move(f), cfg.iopc, 64_KiB);
+        const bool full
+          = co_await reader
+              .consume(
+                key_offset_map_builder_reducer(map, max_memory),
+                model::no_timeout)
+              .finally([reader]() mutable {
+                  return reader.close().then_wrapped([](ss::future<>) {});
+              });
+        if (full) {
+            vlog(
+              stlog.debug,
+              "key offset map is full with {} keys at segment {}",
+              map.size(),
+              s);
+            co_return true;
+        }
+    }
+    co_return false;
+}
+
+ss::future<bool> deduplicate_segment(
+  ss::lw_shared_ptr<segment> s,
+  const key_offset_map& map,
+  compaction_config cfg,
+  storage::probe& pb) {
+    if (s->has_appender()) {
+        throw std::runtime_error(fmt::format(
+          "Cannot deduplicate an active segment. cfg:{} - segment:{}", cfg, s));
+    }
+    auto h = co_await s->read_lock();
+    if (s->is_closed()) {
+        throw segment_closed_exception();
+    }
+    auto path = compacted_index_path(s->reader().filename().c_str());
+    auto f = co_await make_reader_handle(path, cfg.sanitize);
+    auto reader = make_file_backed_compacted_reader(
+      path.string(), std::move(f), cfg.iopc, 64_KiB);
+    auto to_keep = co_await reader
+                     .consume(
+                       key_offset_map_filter_reducer(map), model::no_timeout)
+                     .handle_exception([reader](std::exception_ptr e) mutable {
+                         return reader.close().then_wrapped(
+                           [e](ss::future<>) {
+                               return ss::make_exception_future<
+                                 std::optional<Roaring>>(e);
+                           });
+                     });
+    if (!to_keep) {
+        co_await reader.close();
+        co_return false;
+    }
+    vlog(
+      stlog.debug,
+      "deduplicating {} keeping {} index entries",
+      s,
+      to_keep->cardinality());
+    // same sequence as self compaction: the index first, then the data
+    co_await do_write_filtered_compacted_index(reader, std::move(*to_keep), cfg)
+      .finally([reader]() mutable {
+          return reader.close().then_wrapped([](ss::future<>) {});
+      });
+    auto idx = co_await do_copy_segment_data(s, cfg, pb, std::move(h));
+    co_await install_compacted_segment_data(s, std::move(idx), cfg, pb);
+    co_return true;
+}
+
 ss::future<ss::lw_shared_ptr<segment>> make_concatenated_segment(
   std::filesystem::path path,
   std::vector<ss::lw_shared_ptr<segment>> segments,
@@ -560,17 +674,11 @@ ss::future<ss::lw_shared_ptr<segment>> make_concatenated_segment(
     // build an empty index for the segment
     auto index_name = path;
     index_name.replace_extension("base_index");
-    auto index_fd = co_await ss::open_file_dma(
-      index_name.string(), ss::open_flags::create | ss::open_flags::rw);
-    if (cfg.sanitize) {
-        index_fd = ss::file(
-          ss::make_shared(file_io_sanitizer(std::move(index_fd))));
-    }
     segment_index index(
       index_name.string(),
-      index_fd,
       offsets.base_offset,
-      segment_index::default_data_buffer_step);
+      segment_index::default_data_buffer_step,
+      cfg.sanitize);
 
     co_return ss::make_lw_shared<segment>(
       offsets,
@@ -714,6 +822,7 @@ ss::future<std::vector<ss::rwlock::holder>> transfer_segment(
     auto to_path = compacted_index_path(
       std::filesystem::path(to->reader().filename()));
     co_await ss::rename_file(from_path.string(), to_path.string());
+    co_await rename_key_bloom_filter(from_path.string(), to_path.string());
 
     // clean up replacement segment
     co_await from->remove_persistent_state();
@@ -15,6 +15,7 @@
 #include "storage/compacted_index_reader.h"
 #include "storage/compacted_index_writer.h"
 #include "storage/compacted_offset_list.h"
+#include "storage/compaction_reducers.h"
 #include "storage/probe.h"
 #include "storage/segment.h"
 #include "storage/segment_appender.h"
@@ -35,6 +36,24 @@ ss::future<> self_compact_segment(
   storage::compaction_config,
   storage::probe&);
 
+/// \brief adds the keys of the compacted indices of \p segments, which must
+/// be ordered from newest to oldest and self compacted, to \p map. returns
+/// true if \p max_memory was reached before all the segments were read
+ss::future<bool> build_key_offset_map(
+  std::vector<ss::lw_shared_ptr<segment>>,
+  key_offset_map&,
+  size_t max_memory,
+  storage::compaction_config);
+
+/// \brief removes the records of a self compacted segment that have a newer
+/// record of the same key in \p map. returns false if there was nothing to
+/// remove. this method will acquire it's own locks on the segment
+ss::future<bool> deduplicate_segment(
+  ss::lw_shared_ptr<storage::segment>,
+  const key_offset_map&,
+  storage::compaction_config,
+  storage::probe&);
+
 /*
  * Concatentate segments into a minimal new segment.
  *
@@ -97,7 +116,8 @@ ss::future<segment_appender_ptr> make_segment_appender(
   const std::filesystem::path& path,
   storage::debug_sanitize_files debug,
   size_t number_of_chunks,
-  ss::io_priority_class iopc);
+  ss::io_priority_class iopc,
+  flush_scheduler* flusher = nullptr);
 
 size_t number_of_chunks_from_config(const storage::ntp_config&);
 
@@ -0,0 +1,1216 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/shared_log.h"
+
+#include "bytes/iobuf_parser.h"
+#include "model/adl_serde.h"
+#include "model/namespace.h"
+#include "model/record_utils.h"
+#include "reflection/adl.h"
+#include "storage/kvstore.h"
+#include "storage/logger.h"
+#include "storage/record_batch_builder.h"
+#include "storage/segment.h"
+#include "storage/segment_utils.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/seastar.hh>
+#include <seastar/core/smp.hh>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+namespace storage {
+
+namespace {
+// consecutive envelopes read at once by a partition reader
+constexpr size_t max_run_entries = 64;
+
+struct envelope_key {
+    model::ntp ntp;
+    model::revision_id revision;
+    shared_log::op op;
+};
+
+iobuf encode_key(const ntp_config& cfg, shared_log::op op) {
+    iobuf key;
+    reflection::serialize(key, model::ntp(cfg.ntp()), cfg.get_revision(), op);
+    return key;
+}
+
+envelope_key decode_key(iobuf key) {
+    iobuf_parser p(std::move(key));
+    auto ntp = reflection::adl<model::ntp>{}.from(p);
+    auto revision = reflection::adl<model::revision_id>{}.from(p);
+    auto op = reflection::adl<shared_log::op>{}.from(p);
+    return envelope_key{
+      .ntp = std::move(ntp), .revision = revision, .op = op};
+}
+
+/// the value of an append: the header and the raw records of every batch
+iobuf encode_batches(std::vector<model::record_batch> batches) {
+    iobuf value;
+    reflection::serialize(value, static_cast<int32_t>(batches.size()));
+    for (auto& b : batches) {
+        model::record_batch_header header = b.header();
+        reflection::serialize(
+          value, std::move(header), std::move(b).release_data());
+    }
+    return value;
+}
+
+std::vector<model::record_batch> decode_batches(iobuf value) {
+    iobuf_parser p(std::move(value));
+    auto count = reflection::adl<int32_t>{}.from(p);
+    std::vector<model::record_batch> batches;
+    batches.reserve(count);
+    for (int32_t i = 0; i < count; ++i) {
+        auto header = reflection::adl<model::record_batch_header>{}.from(p);
+        auto records = reflection::adl<iobuf>{}.from(p);
+        batches.emplace_back(
+          header, std::move(records), model::record_batch::tag_ctor_ng{});
+    }
+    return batches;
+}
+
+/// the single record of an envelope
+model::record envelope_record(const model::record_batch& envelope) {
+    std::optional<model::record> record;
+    envelope.for_each_record(
+      [&record](model::record r) { record = std::move(r); });
+    if (!record) {
+        throw std::runtime_error(fmt::format(
+          "empty shared log envelope at {}", envelope.base_offset()));
+    }
+    return std::move(*record);
+}
+
+shared_log::entry make_entry(const std::vector<model::record_batch>& batches) {
+    const auto& front = batches.front().header();
+    shared_log::entry e{
+      .base_offset = front.base_offset,
+      .last_offset = batches.back().last_offset(),
+      .term = front.ctx.term,
+      .first_timestamp = front.first_timestamp,
+      .max_timestamp = front.max_timestamp,
+    };
+    for (const auto& b : batches) {
+        e.size_bytes += b.size_bytes();
+        e.max_timestamp = std::max(e.max_timestamp, b.header().max_timestamp);
+    }
+    return e;
+}
+
+log_append_config internal_append_config(ss::io_priority_class prio) {
+    return log_append_config{
+      .should_fsync = log_append_config::fsync::no,
+      .io_priority = prio,
+      .timeout = model::no_timeout};
+}
+
+std::vector<iobuf> single_payload(iobuf value) {
+    std::vector<iobuf> payloads;
+    payloads.push_back(std::move(value));
+    return payloads;
+}
+
+/// rebuilds the partition states from the envelopes of the physical log
+struct recovery_consumer {
+    ss::future<ss::stop_iteration> operator()(model::record_batch& b) {
+        if (b.header().type == shared_log_record_batch_type) {
+            shared.apply(b.base_offset(), envelope_record(b));
+        }
+        return ss::make_ready_future<ss::stop_iteration>(
+          ss::stop_iteration::no);
+    }
+    void end_of_stream() {}
+
+    shared_log& shared;
+};
+
+/// copies the batches of a graduating partition to its dedicated log
+struct graduation_consumer {
+    ss::future<ss::stop_iteration> operator()(model::record_batch& b) {
+        // the dedicated log assigns the offsets, they have to line up
+        if (b.base_offset() != next) {
+            throw std::runtime_error(fmt::format(
+              "hole in shared log partition, expected offset {}, got {}",
+              next,
+              b.base_offset()));
+        }
+        next = b.last_offset() + model::offset(1);
+        return appender(b);
+    }
+    ss::future<append_result> end_of_stream() {
+        return appender.end_of_stream();
+    }
+
+    log_appender appender;
+    model::offset next;
+};
+} // namespace
+
+void shared_log::partition_state::truncate(model::offset o) {
+    while (!entries.empty() && entries.back().last_offset >= o) {
+        auto& e = entries.back();
+        if (e.base_offset < o) {
+            // readers skip the batches of the envelope past the entry. its
+            // size stays an estimate
+            e.last_offset = o - model::offset(1);
+            return;
+        }
+        size_bytes -= e.size_bytes;
+        entries.pop_back();
+    }
+}
+
+void shared_log::partition_state::truncate_prefix(
+  model::offset o, model::offset marker) {
+    start_offset = o;
+    start_marker = marker;
+    while (!entries.empty() && entries.front().last_offset < o) {
+        size_bytes -= entries.front().size_bytes;
+        entries.pop_front();
+    }
+}
+
+std::optional<model::offset>
+shared_log::partition_state::physical_floor() const {
+    // the marker is the only record of a start past the first batch
+    const bool past_first = entries.empty()
+                            || start_offset > entries.front().base_offset;
+    const bool needs_marker = start_marker != model::offset{} && past_first;
+    if (entries.empty()) {
+        return needs_marker ? std::optional(start_marker) : std::nullopt;
+    }
+    auto floor = entries.front().physical_offset;
+    return needs_marker ? std::min(floor, start_marker) : floor;
+}
+
+shared_log::shared_log(
+  ss::sstring base_dir,
+  size_t graduation_rate,
+  kvstore& kvstore,
+  log_factory factory) noexcept
+  : _base_dir(std::move(base_dir))
+  , _graduation_rate(graduation_rate)
+  , _kvstore(kvstore)
+  , _factory(std::move(factory)) {}
+
+model::ntp shared_log::physical_ntp() {
+    return model::ntp(
+      model::redpanda_ns,
+      model::topic("shared_log"),
+      model::partition_id(ss::this_shard_id()));
+}
+
+ss::future<> shared_log::start() {
+    if (!_started) {
+        _started.emplace(do_start());
+    }
+    return _started->get_future();
+}
+
+ss::future<> shared_log::do_start() {
+    _physical = co_await _factory(ntp_config(physical_ntp(), _base_dir));
+    co_await recover();
+}
+
+ss::future<> shared_log::stop() {
+    if (_physical) {
+        co_await _physical->close();
+    }
+}
+
+ss::future<> shared_log::recover() {
+    auto ofs = _physical->offsets();
+    if (ofs.dirty_offset < model::offset(0)) {
+        co_return;
+    }
+    auto reader = co_await _physical->make_reader(log_reader_config(
+      std::max(ofs.start_offset, model::offset(0)),
+      ofs.dirty_offset,
+      ss::default_priority_class()));
+    co_await std::move(reader).for_each_ref(
+      recovery_consumer{.shared = *this}, model::no_timeout);
+    vlog(
+      stlog.info,
+      "Recovered {} partitions from shared log {}, offsets {}",
+      _recovered.size(),
+      physical_ntp(),
+      ofs);
+}
+
+void shared_log::apply(model::offset physical, model::record r) {
+    auto key = decode_key(r.release_key());
+    if (key.op == op::release) {
+        _recovered.erase(key.ntp);
+        return;
+    }
+    auto& state = _recovered[key.ntp];
+    if (state.revision != key.revision) {
+        // the topic was created again
+        state = partition_state{.revision = key.revision};
+    }
+    switch (key.op) {
+    case op::append: {
+        auto batches = decode_batches(r.release_value());
+        if (batches.empty()) {
+            return;
+        }
+        // an append over the tail means that it was truncated
+        state.truncate(batches.front().base_offset());
+        auto e = make_entry(batches);
+        e.physical_offset = physical;
+        state.size_bytes += e.size_bytes;
+        state.entries.push_back(e);
+        return;
+    }
+    case op::truncate:
+        state.truncate(
+          reflection::from_iobuf<model::offset>(r.release_value()));
+        return;
+    case op::truncate_prefix:
+        state.truncate_prefix(
+          reflection::from_iobuf<model::offset>(r.release_value()), physical);
+        return;
+    case op::release:
+        return;
+    }
+}
+
+bool shared_log::contains(const ntp_config& cfg) {
+    auto it = _recovered.find(cfg.ntp());
+    if (it == _recovered.end()) {
+        return false;
+    }
+    if (it->second.revision != cfg.get_revision()) {
+        _recovered.erase(it);
+        return false;
+    }
+    return true;
+}
+
+log shared_log::make_log(ntp_config cfg) {
+    partition_state state{.revision = cfg.get_revision()};
+    if (auto it = _recovered.find(cfg.ntp()); it != _recovered.end()) {
+        state = std::move(it->second);
+        _recovered.erase(it);
+    } else if (auto v = _kvstore.get(
+                 kvstore::key_space::storage,
+                 internal::start_offset_key(cfg.ntp()))) {
+        // back from a dedicated log that retention emptied
+        state.start_offset = reflection::adl<model::offset>{}.from(
+          std::move(*v));
+    }
+    return log(ss::make_shared<shared_log_impl>(
+      std::move(cfg), *this, std::move(state)));
+}
+
+ss::future<> shared_log::release(model::ntp ntp) {
+    auto it = _recovered.find(ntp);
+    if (it == _recovered.end()) {
+        co_return;
+    }
+    ntp_config cfg(std::move(ntp), _base_dir, nullptr, it->second.revision);
+    _recovered.erase(it);
+    co_await append(
+      cfg,
+      op::release,
+      single_payload(iobuf()),
+      internal_append_config(ss::default_priority_class()),
+      [](model::offset) {});
+}
+
+ss::future<> shared_log::append(
+  const ntp_config& cfg,
+  op o,
+  std::vector<iobuf> payloads,
+  log_append_config append_cfg,
+  apply_fn apply) {
+    model::record_batch_reader::data_t envelopes;
+    envelopes.reserve(payloads.size());
+    for (auto& p : payloads) {
+        storage::record_batch_builder builder(
+          shared_log_record_batch_type, model::offset(0));
+        builder.add_raw_kv(encode_key(cfg, o), std::move(p));
+        auto b = std::move(builder).build();
+        // the physical log has a single term
+        b.set_term(model::term_id(0));
+        envelopes.push_back(std::move(b));
+    }
+    auto units = co_await _append_lock.get_units();
+    auto res = co_await model::make_memory_record_batch_reader(
+                 std::move(envelopes))
+                 .for_each_ref(
+                   _physical->make_appender(append_cfg), append_cfg.timeout);
+    apply(res.base_offset);
+}
+
+ss::future<> shared_log::flush() { return _physical->flush(); }
+
+model::offset shared_log::physical_committed_offset() const {
+    return _physical->offsets().committed_offset;
+}
+
+ss::future<model::record_batch_reader::data_t> shared_log::read(
+  model::offset first,
+  model::offset last,
+  ss::io_priority_class prio,
+  opt_abort_source_t as) {
+    auto reader = co_await _physical->make_reader(log_reader_config(
+      first,
+      last,
+      0,
+      std::numeric_limits<size_t>::max(),
+      prio,
+      shared_log_record_batch_type,
+      std::nullopt,
+      as));
+    co_return co_await model::consume_reader_to_memory(
+      std::move(reader), model::no_timeout);
+}
+
+ss::future<> shared_log::trim(ss::io_priority_class prio) {
+    if (!_physical) {
+        co_return;
+    }
+    // the partitions removed while they were not managed, e.g. on another
+    // node, are gone with their directory
+    std::vector<std::pair<model::ntp, model::revision_id>> unmanaged;
+    unmanaged.reserve(_recovered.size());
+    for (const auto& [ntp, state] : _recovered) {
+        unmanaged.emplace_back(ntp, state.revision);
+    }
+    for (auto& [ntp, revision] : unmanaged) {
+        ntp_config cfg(ntp, _base_dir, nullptr, revision);
+        if (co_await ss::file_exists(cfg.work_directory())) {
+            continue;
+        }
+        auto it = _recovered.find(ntp);
+        if (it != _recovered.end() && it->second.revision == revision) {
+            _recovered.erase(it);
+        }
+    }
+
+    auto units = co_await _append_lock.get_units();
+    auto ofs = _physical->offsets();
+    if (ofs.dirty_offset < model::offset(0)) {
+        co_return;
+    }
+    auto floor = ofs.dirty_offset + model::offset(1);
+    auto lower = [&floor](const partition_state& s) {
+        if (auto f = s.physical_floor()) {
+            floor = std::min(floor, *f);
+        }
+    };
+    for (const auto& [_, state] : _recovered) {
+        lower(state);
+    }
+    for (const auto& [_, p] : _partitions) {
+        lower(p->_state);
+    }
+    if (floor <= std::max(ofs.start_offset, model::offset(0))) {
+        co_return;
+    }
+    vlog(stlog.debug, "Trimming shared log {} at {}", physical_ntp(), floor);
+    co_await _physical->truncate_prefix(truncate_prefix_config(floor, prio));
+}
+
+std::ostream& operator<<(std::ostream& o, shared_log::op op) {
+    switch (op) {
+    case shared_log::op::append:
+        return o << "append";
+    case shared_log::op::truncate:
+        return o << "truncate";
+    case shared_log::op::truncate_prefix:
+        return o << "truncate_prefix";
+    case shared_log::op::release:
+        return o << "release";
+    }
+    return o << "unknown";
+}
+
+/// reads the envelopes of a partition, a run of consecutive ones at a time
+class shared_log_reader final : public model::record_batch_reader::impl {
+public:
+    using data_t = model::record_batch_reader::data_t;
+    using storage_t = model::record_batch_reader::storage_t;
+
+    shared_log_reader(shared_log_impl& log, log_reader_config cfg) noexcept
+      : _log(log)
+      , _config(cfg)
+      , _next(cfg.start_offset) {}
+
+    bool is_end_of_stream() const final { return _end_of_stream; }
+
+    ss::future<storage_t>
+    do_load_slice(model::timeout_clock::time_point) final;
+
+    void print(std::ostream& os) final {
+        fmt::print(os, "{{shared log reader {}}}", _log.config().ntp());
+    }
+
+private:
+    /// hands out the batches of an envelope, false once the read is done
+    bool consume(const shared_log::entry&, model::record, data_t&);
+
+    shared_log_impl& _log;
+    log_reader_config _config;
+    model::offset _next;
+    model::offset _start;
+    bool _end_of_stream{false};
+};
+
+ss::future<shared_log_reader::storage_t>
+shared_log_reader::do_load_slice(model::timeout_clock::time_point) {
+    data_t ret;
+    auto run = _log.next_run(_next, _config.max_offset);
+    if (run.empty()) {
+        _end_of_stream = true;
+        co_return ret;
+    }
+    _start = std::max(_next, _log._state.start_offset);
+    auto envelopes = co_await _log._shared.read(
+      run.front().physical_offset,
+      run.back().physical_offset,
+      _config.prio,
+      _config.abort_source);
+    auto it = run.begin();
+    for (auto& envelope : envelopes) {
+        while (it != run.end()
+               && it->physical_offset < envelope.base_offset()) {
+            ++it;
+        }
+        if (it == run.end()) {
+            break;
+        }
+        // the envelopes of other partitions in between
+        if (it->physical_offset != envelope.base_offset()) {
+            continue;
+        }
+        if (!consume(*it, envelope_record(envelope), ret)) {
+            _end_of_stream = true;
+            co_return ret;
+        }
+    }
+    _next = run.back().last_offset + model::offset(1);
+    _end_of_stream = _next > _config.max_offset;
+    co_return ret;
+}
+
+bool shared_log_reader::consume(
+  const shared_log::entry& entry, model::record r, data_t& ret) {
+    auto key = decode_key(r.release_key());
+    if (
+      key.op != shared_log::op::append || key.ntp != _log.config().ntp()
+      || key.revision != _log.config().get_revision()) {
+        return true;
+    }
+    for (auto& b : decode_batches(r.release_value())) {
+        // truncated away
+        if (b.last_offset() < _start || b.last_offset() > entry.last_offset) {
+            continue;
+        }
+        if (b.base_offset() > _config.max_offset) {
+            return false;
+        }
+        if (_config.type_filter && _config.type_filter != b.header().type) {
+            continue;
+        }
+        if (_config.first_timestamp > b.header().first_timestamp) {
+            continue;
+        }
+        if (
+          (_config.strict_max_bytes || _config.bytes_consumed)
+          && (_config.bytes_consumed + b.size_bytes()) > _config.max_bytes) {
+            _config.over_budget = true;
+            return false;
+        }
+        _config.bytes_consumed += b.size_bytes();
+        if (_config.passthrough) {
+            model::record_batch_header header = b.header();
+            _config.passthrough->append(header, std::move(b).release_data());
+        } else {
+            ret.push_back(std::move(b));
+        }
+        if (_config.bytes_consumed >= _config.max_bytes) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// assigns the offsets of the batches, they are appended to the shared log
+/// as one envelope per term at the end of the stream
+class shared_log_appender final : public log_appender::impl {
+public:
+    shared_log_appender(
+      shared_log_impl& log, log_append_config cfg, model::offset next) noexcept
+      : _log(log)
+      , _config(cfg)
+      , _base_offset(next)
+      , _next(next) {}
+
+    ss::future<ss::stop_iteration>
+    operator()(model::record_batch& batch) final {
+        batch.header().base_offset = _next;
+        batch.header().header_crc = model::internal_header_only_crc(
+          batch.header());
+        _next = batch.last_offset() + model::offset(1);
+        // ghost batches only fill an offset gap, like in a disk log
+        if (batch.header().type != ghost_record_batch_type) {
+            _byte_size += batch.size_bytes();
+            _last_term = batch.term();
+            _batches.push_back(batch.share());
+        }
+        return ss::make_ready_future<ss::stop_iteration>(
+          ss::stop_iteration::no);
+    }
+
+    ss::future<append_result> end_of_stream() final {
+        append_result ret{
+          .append_time = log_clock::now(),
+          .base_offset = _base_offset,
+          .last_offset = _next - model::offset(1),
+          .byte_size = _byte_size,
+          .last_term = _last_term};
+        co_await _log.append(std::move(_batches), _config);
+        co_return ret;
+    }
+
+private:
+    shared_log_impl& _log;
+    log_append_config _config;
+    model::offset _base_offset;
+    model::offset _next;
+    size_t _byte_size{0};
+    model::term_id _last_term;
+    std::vector<model::record_batch> _batches;
+};
+
+shared_log_impl::shared_log_impl(
+  ntp_config cfg, shared_log& shared, shared_log::partition_state state)
+  : log::impl(std::move(cfg))
+  , _shared(shared)
+  , _state(std::move(state)) {
+    _shared._partitions.emplace(config().ntp(), this);
+}
+
+shared_log_impl::~shared_log_impl() { unregister(); }
+
+void shared_log_impl::unregister() {
+    auto it = _shared._partitions.find(config().ntp());
+    if (it != _shared._partitions.end() && it->second == this) {
+        _shared._partitions.erase(it);
+    }
+}
+
+void shared_log_impl::fail_eviction_monitor() {
+    if (_eviction_monitor) {
+        _eviction_monitor->promise.set_exception(segment_closed_exception());
+        _eviction_monitor.reset();
+    }
+}
+
+shared_log_impl::entries_t::const_iterator
+shared_log_impl::find(model::offset o) const {
+    o = std::max(o, _state.start_offset);
+    return std::lower_bound(
+      _state.entries.cbegin(),
+      _state.entries.cend(),
+      o,
+      [](const shared_log::entry& e, model::offset o) {
+          return e.last_offset < o;
+      });
+}
+
+std::vector<shared_log::entry>
+shared_log_impl::next_run(model::offset o, model::offset max) const {
+    std::vector<shared_log::entry> run;
+    for (auto it = find(o); it != _state.entries.cend(); ++it) {
+        if (it->base_offset > max || run.size() >= max_run_entries) {
+            break;
+        }
+        if (
+          !run.empty()
+          && it->physical_offset
+               != run.back().physical_offset + model::offset(1)) {
+            break;
+        }
+        run.push_back(*it);
+    }
+    return run;
+}
+
+ss::future<> shared_log_impl::append(
+  std::vector<model::record_batch> batches, log_append_config cfg) {
+    if (batches.empty()) {
+        co_return;
+    }
+    auto units = co_await _lock.get_units();
+    if (_dedicated) {
+        // graduated since the appender was made, the offsets line up
+        model::record_batch_reader::data_t data;
+        data.reserve(batches.size());
+        for (auto& b : batches) {
+            data.push_back(std::move(b));
+        }
+        co_await model::make_memory_record_batch_reader(std::move(data))
+          .for_each_ref(_dedicated->make_appender(cfg), cfg.timeout);
+        co_return;
+    }
+    if (_closed) {
+        throw std::runtime_error(fmt::format(
+          "append to closed shared log partition {}", config().ntp()));
+    }
+    // an entry has a single term
+    std::vector<shared_log::entry> entries;
+    std::vector<iobuf> payloads;
+    size_t bytes = 0;
+    for (auto it = batches.begin(); it != batches.end();) {
+        auto end = std::find_if(it, batches.end(), [it](const auto& b) {
+            return b.term() != it->term();
+        });
+        std::vector<model::record_batch> group(
+          std::make_move_iterator(it), std::make_move_iterator(end));
+        entries.push_back(make_entry(group));
+        bytes += entries.back().size_bytes;
+        payloads.push_back(encode_batches(std::move(group)));
+        it = end;
+    }
+    co_await _shared.append(
+      config(),
+      shared_log::op::append,
+      std::move(payloads),
+      cfg,
+      [this, entries = std::move(entries)](model::offset physical) mutable {
+          for (auto& e : entries) {
+              e.physical_offset = physical;
+              physical++;
+              _state.truncate(e.base_offset);
+              _state.size_bytes += e.size_bytes;
+              _state.entries.push_back(e);
+          }
+      });
+    _window_bytes += bytes;
+}
+
+ss::future<> shared_log_impl::compact(compaction_config cfg) {
+    if (_dedicated) {
+        co_await _dedicated->compact(cfg);
+        co_return;
+    }
+    {
+        auto units = co_await _lock.get_units();
+        if (_dedicated || _closed) {
+            co_return;
+        }
+        if (config().is_collectable()) {
+            co_await gc(eviction_time(cfg), max_bytes(cfg.max_bytes));
+        }
+    }
+    if (hot()) {
+        co_await graduate();
+    }
+}
+
+model::timestamp
+shared_log_impl::eviction_time(const compaction_config& cfg) const {
+    if (!config().has_overrides()) {
+        return cfg.eviction_time;
+    }
+    const auto& retention = config().get_overrides().retention_time;
+    if (retention.is_disabled()) {
+        return model::timestamp::min();
+    }
+    if (retention.has_value()) {
+        return model::timestamp(
+          model::timestamp::now().value() - retention.value().count());
+    }
+    return cfg.eviction_time;
+}
+
+std::optional<size_t>
+shared_log_impl::max_bytes(std::optional<size_t> max) const {
+    if (config().has_overrides()) {
+        const auto& retention = config().get_overrides().retention_bytes;
+        if (retention.is_disabled()) {
+            max = std::nullopt;
+        }
+        if (retention.has_value()) {
+            max = retention.value();
+        }
+    }
+    return max;
+}
+
+ss::future<> shared_log_impl::gc(
+  model::timestamp eviction_time, std::optional<size_t> max_retention_size) {
+    const size_t max = max_retention_size.value_or(
+      std::numeric_limits<size_t>::max());
+    size_t reclaimed = 0;
+    model::offset max_offset;
+    for (const auto& e : _state.entries) {
+        if (
+          e.max_timestamp > eviction_time
+          && (_state.size_bytes - reclaimed) <= max) {
+            break;
+        }
+        max_offset = e.last_offset;
+        reclaimed += e.size_bytes;
+    }
+    if (max_offset == model::offset{}) {
+        co_return;
+    }
+    if (_eviction_monitor) {
+        _eviction_monitor->promise.set_value(max_offset);
+        _eviction_monitor.reset();
+    }
+    max_offset = std::min(max_offset, _max_collectible_offset);
+    if (max_offset < offsets().start_offset) {
+        co_return;
+    }
+    co_await stm_manager()->ensure_snapshot_exists(max_offset);
+    co_await do_truncate_prefix(max_offset + model::offset(1));
+}
+
+bool shared_log_impl::hot() {
+    const auto now = ss::lowres_clock::now();
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      now - _window_start);
+    if (elapsed < std::chrono::seconds(1)) {
+        return false;
+    }
+    const auto rate = _window_bytes * 1000
+                      / static_cast<size_t>(elapsed.count());
+    _window_bytes = 0;
+    _window_start = now;
+    return rate > _shared.graduation_rate();
+}
+
+ss::future<> shared_log_impl::graduate() {
+    auto units = co_await _lock.get_units();
+    if (_dedicated || _closed) {
+        co_return;
+    }
+    const auto ofs = offsets();
+    // the dedicated log starts where the partition does
+    if (ofs.start_offset >= model::offset(0)) {
+        co_await _shared._kvstore.put(
+          kvstore::key_space::storage,
+          internal::start_offset_key(config().ntp()),
+          reflection::to_iobuf(ofs.start_offset));
+    }
+    auto dedicated = co_await _shared.make_dedicated_log(config().copy());
+    std::exception_ptr e;
+    try {
+        if (!_state.entries.empty()) {
+            auto reader = co_await make_reader(log_reader_config(
+              ofs.start_offset,
+              ofs.dirty_offset,
+              ss::default_priority_class()));
+            co_await std::move(reader).for_each_ref(
+              graduation_consumer{
+                .appender = dedicated.make_appender(
+                  internal_append_config(ss::default_priority_class())),
+                .next = ofs.start_offset},
+              model::no_timeout);
+            co_await dedicated.flush();
+        }
+        // from here on a restart opens the dedicated log
+        co_await _shared.append(
+          config(),
+          shared_log::op::release,
+          single_payload(iobuf()),
+          internal_append_config(ss::default_priority_class()),
+          [](model::offset) {});
+    } catch (...) {
+        e = std::current_exception();
+    }
+    if (e) {
+        vlog(
+          stlog.warn,
+          "Could not move {} to a dedicated log: {}",
+          config().ntp(),
+          e);
+        co_await dedicated.remove();
+        co_return;
+    }
+    vlog(stlog.info, "Moved {} to a dedicated log at {}", config().ntp(), ofs);
+    dedicated.set_collectible_offset(_max_collectible_offset);
+    dedicated.get_impl()->share_stm_manager(stm_manager());
+    _dedicated = std::move(dedicated);
+    _state = shared_log::partition_state{.revision = config().get_revision()};
+    if (_eviction_monitor) {
+        auto monitor = std::move(*_eviction_monitor);
+        _eviction_monitor.reset();
+        _dedicated->monitor_eviction(*monitor.as)
+          .forward_to(std::move(monitor.promise));
+    }
+    co_await _shared.flush();
+}
+
+ss::future<> shared_log_impl::truncate(truncate_config cfg) {
+    auto units = co_await _lock.get_units();
+    if (_dedicated) {
+        co_await _dedicated->truncate(cfg);
+        co_return;
+    }
+    vlog(stlog.debug, "Truncating {} shared log at {}", config().ntp(), cfg);
+    if (cfg.base_offset < model::offset(0)) {
+        throw std::invalid_argument("cannot truncate at negative offset");
+    }
+    co_await _shared.append(
+      config(),
+      shared_log::op::truncate,
+      single_payload(reflection::to_iobuf(cfg.base_offset)),
+      internal_append_config(cfg.prio),
+      [this, o = cfg.base_offset](model::offset) { _state.truncate(o); });
+    co_await _shared.flush();
+}
+
+ss::future<> shared_log_impl::truncate_prefix(truncate_prefix_config cfg) {
+    auto units = co_await _lock.get_units();
+    if (_dedicated) {
+        co_await _dedicated->truncate_prefix(cfg);
+        co_return;
+    }
+    vlog(
+      stlog.debug,
+      "PREFIX Truncating {} shared log at {}",
+      config().ntp(),
+      cfg);
+    co_await do_truncate_prefix(cfg.start_offset);
+}
+
+ss::future<> shared_log_impl::do_truncate_prefix(model::offset o) {
+    if (o <= _state.start_offset) {
+        co_return;
+    }
+    co_await _shared.append(
+      config(),
+      shared_log::op::truncate_prefix,
+      single_payload(reflection::to_iobuf(o)),
+      internal_append_config(ss::default_priority_class()),
+      [this, o](model::offset physical) {
+          _state.truncate_prefix(o, physical);
+      });
+    co_await _shared.flush();
+}
+
+ss::future<model::record_batch_reader>
+shared_log_impl::make_reader(log_reader_config cfg) {
+    if (_dedicated) {
+        return _dedicated->make_reader(cfg);
+    }
+    return ss::make_ready_future<model::record_batch_reader>(
+      model::make_record_batch_reader<shared_log_reader>(*this, cfg));
+}
+
+log_appender shared_log_impl::make_appender(log_append_config cfg) {
+    if (_dedicated) {
+        return _dedicated->make_appender(cfg);
+    }
+    // see disk_log_impl::make_appender
+    auto ofs = offsets();
+    auto next = ofs.dirty_offset;
+    if (next >= model::offset(0)) {
+        next++;
+    } else {
+        next = std::max(ofs.start_offset, model::offset(0));
+    }
+    return log_appender(
+      std::make_unique<shared_log_appender>(*this, cfg, next));
+}
+
+ss::future<> shared_log_impl::close() {
+    auto units = co_await _lock.get_units();
+    _closed = true;
+    unregister();
+    if (_dedicated) {
+        co_await _dedicated->close();
+        co_return;
+    }
+    fail_eviction_monitor();
+    // kept for the next time the partition is managed on the shard
+    _shared._recovered.insert_or_assign(config().ntp(), std::move(_state));
+}
+
+ss::future<> shared_log_impl::remove() {
+    auto units = co_await _lock.get_units();
+    _closed = true;
+    unregister();
+    if (_dedicated) {
+        co_await _dedicated->remove();
+        co_return;
+    }
+    fail_eviction_monitor();
+    co_await _shared.append(
+      config(),
+      shared_log::op::release,
+      single_payload(iobuf()),
+      internal_append_config(ss::default_priority_class()),
+      [](model::offset) {});
+    co_await _shared._kvstore.remove(
+      kvstore::key_space::storage, internal::start_offset_key(config().ntp()));
+}
+
+ss::future<> shared_log_impl::flush() {
+    if (_dedicated) {
+        return _dedicated->flush();
+    }
+    // one flush of the physical log covers every partition
+    return _shared.flush();
+}
+
+ss::future<std::optional<timequery_result>>
+shared_log_impl::timequery(timequery_config cfg) {
+    if (_dedicated) {
+        co_return co_await _dedicated->timequery(cfg);
+    }
+    auto it = std::lower_bound(
+      _state.entries.cbegin(),
+      _state.entries.cend(),
+      cfg.time,
+      [](const shared_log::entry& e, model::timestamp t) {
+          return e.max_timestamp < t;
+      });
+    if (it == _state.entries.cend() || it->base_offset > cfg.max_offset) {
+        co_return std::nullopt;
+    }
+    auto reader = co_await make_reader(log_reader_config(
+      it->base_offset,
+      cfg.max_offset,
+      0,
+      2048, // one batch is enough
+      cfg.prio,
+      std::nullopt,
+      cfg.time,
+      cfg.abort_source));
+    auto batches = co_await model::consume_reader_to_memory(
+      std::move(reader), model::no_timeout);
+    if (
+      !batches.empty()
+      && batches.front().header().first_timestamp >= cfg.time) {
+        co_return timequery_result(
+          batches.front().base_offset(),
+          batches.front().header().first_timestamp);
+    }
+    co_return std::nullopt;
+}
+
+size_t shared_log_impl::segment_count() const {
+    return _dedicated ? _dedicated->segment_count() : 1;
+}
+
+storage::offset_stats shared_log_impl::offsets() const {
+    if (_dedicated) {
+        return _dedicated->offsets();
+    }
+    const auto& entries = _state.entries;
+    if (entries.empty()) {
+        offset_stats ret;
+        ret.start_offset = _state.start_offset;
+        if (ret.start_offset > model::offset(0)) {
+            ret.dirty_offset = ret.start_offset - model::offset(1);
+            ret.committed_offset = ret.dirty_offset;
+        }
+        return ret;
+    }
+    const auto& front = entries.front();
+    const auto& back = entries.back();
+    auto term_start = std::lower_bound(
+      entries.cbegin(),
+      entries.cend(),
+      back.term,
+      [](const shared_log::entry& e, model::term_id t) { return e.term < t; });
+    // the entries flushed to the physical log
+    auto committed = std::upper_bound(
+      entries.cbegin(),
+      entries.cend(),
+      _shared.physical_committed_offset(),
+      [](model::offset o, const shared_log::entry& e) {
+          return o < e.physical_offset;
+      });
+    offset_stats ret{
+      .start_offset = _state.start_offset >= model::offset(0)
+                        ? _state.start_offset
+                        : front.base_offset,
+      .committed_offset = front.base_offset - model::offset(1),
+      .committed_offset_term = front.term,
+      .dirty_offset = back.last_offset,
+      .dirty_offset_term = back.term,
+      .last_term_start_offset = term_start->base_offset,
+    };
+    if (committed != entries.cbegin()) {
+        ret.committed_offset = std::prev(committed)->last_offset;
+        ret.committed_offset_term = std::prev(committed)->term;
+    }
+    return ret;
+}
+
+std::ostream& shared_log_impl::print(std::ostream& o) const {
+    if (_dedicated) {
+        return _dedicated->print(o);
+    }
+    fmt::print(
+      o,
+      "{{shared_log_impl:{}, entries:{}, size_bytes:{}}}",
+      offsets(),
+      _state.entries.size(),
+      _state.size_bytes);
+    return o;
+}
+
+std::optional<model::term_id>
+shared_log_impl::get_term(model::offset o) const {
+    if (_dedicated) {
+        return _dedicated->get_term(o);
+    }
+    if (o == model::offset{} || o < _state.start_offset) {
+        return std::nullopt;
+    }
+    auto it = find(o);
+    if (it == _state.entries.cend() || it->base_offset > o) {
+        return std::nullopt;
+    }
+    return it->term;
+}
+
+std::optional<term_end>
+shared_log_impl::find_term_end(model::term_id term) const {
+    if (_dedicated) {
+        return _dedicated->find_term_end(term);
+    }
+    const auto& entries = _state.entries;
+    if (entries.empty()) {
+        return std::nullopt;
+    }
+    auto it = std::upper_bound(
+      entries.cbegin(),
+      entries.cend(),
+      term,
+      [](model::term_id t, const shared_log::entry& e) { return t < e.term; });
+    if (it == entries.cend()) {
+        return term_end{
+          .term = entries.back().term,
+          .end_offset = entries.back().last_offset + model::offset(1)};
+    }
+    if (it == entries.cbegin()) {
+        return term_end{.term = term, .end_offset = it->base_offset};
+    }
+    return term_end{
+      .term = std::prev(it)->term, .end_offset = it->base_offset};
+}
+
+ss::future<model::offset>
+shared_log_impl::monitor_eviction(ss::abort_source& as) {
+    if (_dedicated) {
+        return _dedicated->monitor_eviction(as);
+    }
+    if (_eviction_monitor) {
+        throw std::logic_error("Eviction promise already registered. "
+                               "Eviction can not be monitored twice.");
+    }
+    auto opt_sub = as.subscribe([this]() noexcept {
+        _eviction_monitor->promise.set_exception(
+          ss::abort_requested_exception());
+    });
+    if (!opt_sub) {
+        return ss::make_exception_future<model::offset>(
+          ss::abort_requested_exception());
+    }
+    return _eviction_monitor
+      .emplace(eviction_monitor{
+        ss::promise<model::offset>{}, std::move(*opt_sub), &as})
+      .promise.get_future();
+}
+
+void shared_log_impl::set_collectible_offset(model::offset o) {
+    _max_collectible_offset = o;
+    if (_dedicated) {
+        _dedicated->set_collectible_offset(o);
+    }
+}
+
+size_t shared_log_impl::size_bytes() const {
+    return _dedicated ? _dedicated->size_bytes() : _state.size_bytes;
+}
+
+size_t shared_log_impl::compaction_backlog() const {
+    return _dedicated ? _dedicated->compaction_backlog() : 0;
+}
+
+model::timestamp
+shared_log_impl::housekeeping_due(compaction_config cfg) const {
+    // a partition in the shared log checks its rate every round
+    return _dedicated ? _dedicated->housekeeping_due(cfg)
+                      : model::timestamp::min();
+}
+
+void shared_log_impl::set_archived_offset(model::offset o) {
+    if (_dedicated) {
+        _dedicated->set_archived_offset(o);
+    }
+}
+
+std::optional<model::timestamp>
+shared_log_impl::oldest_reclaimable(bool archived_only) const {
+    if (_dedicated) {
+        return _dedicated->oldest_reclaimable(archived_only);
+    }
+    return std::nullopt;
+}
+
+ss::future<size_t> shared_log_impl::reclaim_oldest_segment(
+  bool archived_only, ss::abort_source& as) {
+    if (_dedicated) {
+        return _dedicated->reclaim_oldest_segment(archived_only, as);
+    }
+    return ss::make_ready_future<size_t>(0);
+}
+
+ss::future<>
+shared_log_impl::update_configuration(ntp_config::default_overrides o) {
+    mutable_config().set_overrides(o);
+    if (_dedicated) {
+        co_await _dedicated->update_configuration(o);
+        co_return;
+    }
+    // compaction needs the segments of a dedicated log
+    if (config().is_compacted()) {
+        co_await graduate();
+    }
+}
+
+ss::future<std::optional<sealed_segment>>
+shared_log_impl::get_sealed_segment(model::offset o) {
+    if (_dedicated) {
+        return _dedicated->get_sealed_segment(o);
+    }
+    // there are no segment files of the partition
+    return ss::make_ready_future<std::optional<sealed_segment>>(std::nullopt);
+}
+
+ss::future<>
+shared_log_impl::adopt_segment(model::offset o, model::term_id term) {
+    if (_dedicated) {
+        return _dedicated->adopt_segment(o, term);
+    }
+    return ss::make_exception_future<>(std::runtime_error(
+      "shared log partition does not support adopting segments"));
+}
+
+} // namespace storage
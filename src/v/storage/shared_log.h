@@ -0,0 +1,275 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "model/fundamental.h"
+#include "model/record.h"
+#include "model/record_batch_reader.h"
+#include "model/record_batch_types.h"
+#include "model/timestamp.h"
+#include "seastarx.h"
+#include "storage/log.h"
+#include "storage/ntp_config.h"
+#include "storage/types.h"
+#include "utils/mutex.h"
+
+#include <seastar/core/abort_source.hh>
+#include <seastar/core/future.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/core/shared_future.hh>
+#include <seastar/util/noncopyable_function.hh>
+
+#include <absl/container/flat_hash_map.h>
+
+#include <deque>
+#include <optional>
+#include <vector>
+
+namespace storage {
+
+/// envelope of the batches of a partition in a shared log
+constexpr model::record_batch_type shared_log_record_batch_type
+  = model::well_known_record_batch_types[15];
+
+class kvstore;
+class shared_log_impl;
+
+/**
+ * \brief One physical log of the shard that many low throughput partitions
+ * append into, instead of each keeping its own segments, indexes and fsyncs.
+ *
+ * Each append of a partition is written as one envelope batch of the
+ * physical log. The key of the envelope names the partition, by ntp and
+ * revision, and what it holds: the batches of an append, a suffix or prefix
+ * truncation, or the release of the partition once it is removed or moved
+ * to a dedicated log. A partition keeps an index from its offsets to the
+ * physical offsets of its envelopes. The indexes are rebuilt on startup by
+ * scanning the physical log.
+ *
+ * A read of a partition only reads the envelopes of its index. Retention
+ * works on the index, a prefix truncation is written as a marker, and the
+ * physical log is trimmed below the oldest envelope a partition still needs.
+ *
+ * A partition that gets hot, or compacted, graduates: its batches are copied
+ * to a dedicated disk log, to which it forwards from then on. The release
+ * marker is written once the copy is flushed. Until then a restart recovers
+ * the partition from the shared log and drops the partial copy.
+ *
+ * The physical log is redpanda/shared_log/<shard> in the base directory. A
+ * partition that moves to another shard graduates first. Lowering the number
+ * of cores of a node is not supported.
+ */
+class shared_log {
+public:
+    /// opens the disk log of a configuration, without managing it
+    using log_factory = ss::noncopyable_function<ss::future<log>(ntp_config)>;
+
+    enum class op : int8_t {
+        append = 0,
+        truncate = 1,
+        truncate_prefix = 2,
+        release = 3,
+    };
+
+    /// the batches of one append of a partition
+    struct entry {
+        model::offset base_offset;
+        model::offset last_offset;
+        model::term_id term;
+        model::offset physical_offset;
+        size_t size_bytes{0};
+        model::timestamp first_timestamp;
+        model::timestamp max_timestamp;
+    };
+
+    struct partition_state {
+        model::revision_id revision;
+        std::deque<entry> entries;
+        size_t size_bytes{0};
+        /// set by a prefix truncation, the first batch otherwise
+        model::offset start_offset;
+        /// physical offset of the last prefix truncation marker
+        model::offset start_marker;
+
+        /// drops the batches from \p o on
+        void truncate(model::offset o);
+        /// drops the batches below \p o
+        void truncate_prefix(model::offset o, model::offset marker);
+        /// the oldest physical offset a restart needs to recover the state
+        std::optional<model::offset> physical_floor() const;
+    };
+
+    shared_log(
+      ss::sstring base_dir,
+      size_t graduation_rate,
+      kvstore&,
+      log_factory) noexcept;
+
+    /// opens and scans the physical log, once
+    ss::future<> start();
+    ss::future<> stop();
+
+    /// whether the partition has data or markers in the shared log, a
+    /// state of another revision is dropped
+    bool contains(const ntp_config&);
+
+    /// the log of a partition in the shared log, the shared log has to be
+    /// started and outlive it
+    log make_log(ntp_config);
+
+    /// forgets a partition that is no longer managed
+    ss::future<> release(model::ntp);
+
+    /// trims the physical log below the oldest envelope still needed
+    ss::future<> trim(ss::io_priority_class);
+
+    /// bytes per second over which a partition graduates
+    size_t graduation_rate() const { return _graduation_rate; }
+
+    static model::ntp physical_ntp();
+
+private:
+    friend class shared_log_impl;
+    friend class shared_log_reader;
+
+    ss::future<> do_start();
+    ss::future<> recover();
+    void apply(model::offset physical, model::record);
+
+    /// applies an operation of a partition to its state
+    using apply_fn = ss::noncopyable_function<void(model::offset physical)>;
+
+    /// appends an envelope per payload. \p apply gets the physical offset of
+    /// the first one, it runs before any other append or trim
+    ss::future<> append(
+      const ntp_config&,
+      op,
+      std::vector<iobuf> payloads,
+      log_append_config,
+      apply_fn apply);
+    ss::future<> flush();
+    model::offset physical_committed_offset() const;
+    ss::future<model::record_batch_reader::data_t> read(
+      model::offset first,
+      model::offset last,
+      ss::io_priority_class,
+      opt_abort_source_t);
+
+    ss::future<log> make_dedicated_log(ntp_config cfg) {
+        return _factory(std::move(cfg));
+    }
+
+    ss::sstring _base_dir;
+    size_t _graduation_rate;
+    kvstore& _kvstore;
+    log_factory _factory;
+    std::optional<ss::shared_future<>> _started;
+    std::optional<log> _physical;
+    // serializes the appends of the partitions to the physical log
+    mutex _append_lock;
+    // partitions that are not managed, recovered or closed
+    absl::flat_hash_map<model::ntp, partition_state> _recovered;
+    absl::flat_hash_map<model::ntp, shared_log_impl*> _partitions;
+};
+
+std::ostream& operator<<(std::ostream&, shared_log::op);
+
+/// a partition in the shared log, forwards to its dedicated log once it
+/// graduated
+class shared_log_impl final : public log::impl {
+public:
+    shared_log_impl(ntp_config, shared_log&, shared_log::partition_state);
+    ~shared_log_impl() override;
+    shared_log_impl(const shared_log_impl&) = delete;
+    shared_log_impl& operator=(const shared_log_impl&) = delete;
+    shared_log_impl(shared_log_impl&&) noexcept = delete;
+    shared_log_impl& operator=(shared_log_impl&&) noexcept = delete;
+
+    ss::future<> compact(compaction_config) final;
+    ss::future<> truncate(truncate_config) final;
+    ss::future<> truncate_prefix(truncate_prefix_config) final;
+    ss::future<model::record_batch_reader> make_reader(log_reader_config) final;
+    log_appender make_appender(log_append_config) final;
+    ss::future<> close() final;
+    ss::future<> remove() final;
+    ss::future<> flush() final;
+    ss::future<std::optional<timequery_result>>
+      timequery(timequery_config) final;
+    size_t segment_count() const final;
+    storage::offset_stats offsets() const final;
+    std::ostream& print(std::ostream&) const final;
+    std::optional<model::term_id> get_term(model::offset) const final;
+    std::optional<term_end> find_term_end(model::term_id) const final;
+    ss::future<model::offset> monitor_eviction(ss::abort_source&) final;
+    void set_collectible_offset(model::offset) final;
+    size_t size_bytes() const final;
+    size_t compaction_backlog() const final;
+    model::timestamp housekeeping_due(compaction_config) const final;
+    void set_archived_offset(model::offset) final;
+    std::optional<model::timestamp>
+    oldest_reclaimable(bool archived_only) const final;
+    ss::future<size_t>
+    reclaim_oldest_segment(bool archived_only, ss::abort_source&) final;
+    ss::future<>
+      update_configuration(ntp_config::default_overrides) final;
+    ss::future<std::optional<sealed_segment>>
+      get_sealed_segment(model::offset) final;
+    ss::future<> adopt_segment(model::offset, model::term_id) final;
+
+    /// moves the partition to a dedicated disk log, a no-op once it did
+    ss::future<> graduate();
+
+    bool graduated() const { return _dedicated.has_value(); }
+
+private:
+    friend class shared_log;
+    friend class shared_log_reader;
+    friend class shared_log_appender;
+
+    using entries_t = std::deque<shared_log::entry>;
+
+    /// the first entry with batches at or past \p o
+    entries_t::const_iterator find(model::offset o) const;
+    /// the entries of the next physical read, consecutive envelopes from
+    /// the one holding \p o up to \p max
+    std::vector<shared_log::entry>
+    next_run(model::offset o, model::offset max) const;
+
+    ss::future<>
+      append(std::vector<model::record_batch>, log_append_config);
+    void unregister();
+    void fail_eviction_monitor();
+    ss::future<> do_truncate_prefix(model::offset);
+    ss::future<> gc(model::timestamp eviction_time, std::optional<size_t>);
+    model::timestamp eviction_time(const compaction_config&) const;
+    std::optional<size_t> max_bytes(std::optional<size_t>) const;
+    bool hot();
+
+    struct eviction_monitor {
+        ss::promise<model::offset> promise;
+        ss::abort_source::subscription subscription;
+        ss::abort_source* as;
+    };
+
+    shared_log& _shared;
+    shared_log::partition_state _state;
+    // excludes appends and truncations while the partition graduates
+    mutex _lock;
+    std::optional<log> _dedicated;
+    std::optional<eviction_monitor> _eviction_monitor;
+    model::offset _max_collectible_offset;
+    size_t _window_bytes{0};
+    ss::lowres_clock::time_point _window_start{ss::lowres_clock::now()};
+    bool _closed{false};
+};
+
+} // namespace storage
@@ -13,6 +13,7 @@
 #include "random/generators.h"
 #include "reflection/adl.h"
 #include "storage/compacted_index_writer.h"
+#include "storage/key_bloom_filter.h"
 #include "storage/logger.h"
 #include "utils/vint.h"
 #include "vassert.h"
@@ -20,9 +21,13 @@
 
 #include <seastar/core/file.hh>
 #include <seastar/core/future-util.hh>
+#include <seastar/core/loop.hh>
 
+#include <boost/range/irange.hpp>
 #include <fmt/ostream.h>
 
+#include <algorithm>
+
 namespace storage::internal {
 using namespace storage; // NOLINT
 
@@ -47,71 +52,52 @@ spill_key_index::~spill_key_index() {
 
 ss::future<>
 spill_key_index::index(bytes_view v, model::offset base_offset, int32_t delta) {
-    if (auto it = _midx.find(v); it != _midx.end()) {
-        auto& pair = it->second;
-        if (base_offset > pair.base_offset) {
-            pair.base_offset = base_offset;
-            pair.delta = delta;
+    // keys are truncated to this size when spilled, so they must be equal in
+    // memory as well
+    v = v.substr(0, max_key_size);
+    if (auto pair = _midx.find(v); pair) {
+        // a key may be in a batch more than once, the latest record wins
+        const auto record = base_offset + model::offset(delta);
+        const auto current = pair->base_offset + model::offset(pair->delta);
+        if (record > current) {
+            pair->base_offset = base_offset;
+            pair->delta = delta;
         }
         return ss::now();
     }
     // not found
-    return add_key(bytes(v), value_type{base_offset, delta});
+    return add_key(v, value_type{base_offset, delta});
 }
 
-ss::future<> spill_key_index::add_key(bytes b, value_type v) {
-    auto f = ss::now();
-    auto const key_size = b.size();
-    auto const expected_size = idx_mem_usage() + _keys_mem_usage + key_size;
-
-    if (expected_size >= _max_mem) {
-        f = ss::do_until(
-          [this, key_size] {
-              // stop condition
-              return _midx.empty()
-                     || idx_mem_usage() + _keys_mem_usage + key_size < _max_mem;
-          },
-          [this] {
-              /**
-               * Evict first entry, we use hash function that guarante good
-               * randomness so evicting first entry is actually evicting a
-               * pseudo random elemnent
-               */
-              auto node = _midx.extract(_midx.begin());
-
-              return ss::do_with(
-                node.key(),
-                node.mapped(),
-                [this](const bytes& k, value_type o) {
-                    _keys_mem_usage -= k.size();
-                    return spill(compacted_index::entry_type::key, k, o);
-                });
-          });
+ss::future<> spill_key_index::add_key(bytes_view b, value_type v) {
+    auto const expected_size = _midx.memory_usage() + b.size();
+    if (expected_size >= _max_mem && !_midx.empty()) {
+        // spill everything and start over. the key is copied because the
+        // caller's view may not outlive the drain
+        return drain_all_keys().then(
+          [this, k = bytes(b), v] { _midx.insert(k, v); });
     }
-
-    return f.then([this, b = std::move(b), v]() mutable {
-        // convert iobuf to key
-        _keys_mem_usage += b.size();
-        _midx.insert({std::move(b), v});
-    });
+    // the map copies the key into its arena
+    _midx.insert(b, v);
+    return ss::now();
 }
 
 ss::future<>
 spill_key_index::index(bytes&& b, model::offset base_offset, int32_t delta) {
-    if (auto it = _midx.find(b); it != _midx.end()) {
-        auto& pair = it->second;
+    auto key = bytes_view(b).substr(0, max_key_size);
+    if (auto pair = _midx.find(key); pair) {
         // must use both base+delta, since we only want to keep the latest
         // which might be inserted into the batch multiple times by client
         const auto record = base_offset + model::offset(delta);
-        const auto current = pair.base_offset + model::offset(pair.delta);
+        const auto current = pair->base_offset + model::offset(pair->delta);
         if (record > current) {
-            pair.base_offset = base_offset;
-            pair.delta = delta;
+            pair->base_offset = base_offset;
+            pair->delta = delta;
         }
         return ss::now();
     }
     // not found
-    return add_key(std::move(b), value_type{base_offset, delta});
+    return add_key(key, value_type{base_offset, delta});
 }
 ss::future<> spill_key_index::index(
   const iobuf& key, model::offset base_offset, int32_t delta) {
@@ -148,6 +134,9 @@ ss::future<> spill_key_index::spill(
         size_t key_size = std::min(max_key_size, b.size());
 
         payload.append(b.data(), key_size);
+        if (type == compacted_index::entry_type::key) {
+            track_key_hash(b.substr(0, key_size));
+        }
     }
     const size_t size = payload.size_bytes() - size_reservation;
     const size_t size_le = ss::cpu_to_le(size); // downcast
@@ -168,6 +157,53 @@ ss::future<> spill_key_index::spill(
       std::move(payload), [this](iobuf& buf) { return _appender.append(buf); });
 }
 
+void spill_key_index::track_key_hash(bytes_view key) {
+    if (_key_filter_overflow) {
+        return;
+    }
+    static constexpr size_t min_dedup_size = 1024;
+    _key_hashes.push_back(key_bloom_filter::hash(key));
+    // a key is spilled again by every drain of the memory index, so drop
+    // the duplicates whenever the hashes doubled since the last time
+    const auto dedup_size = 2 * std::max(_unique_key_hashes, min_dedup_size);
+    if (_key_hashes.size() < dedup_size) {
+        return;
+    }
+    std::sort(_key_hashes.begin(), _key_hashes.end());
+    _key_hashes.erase(
+      std::unique(_key_hashes.begin(), _key_hashes.end()), _key_hashes.end());
+    _unique_key_hashes = _key_hashes.size();
+    if (_unique_key_hashes > max_filtered_keys) {
+        _key_filter_overflow = true;
+        _key_hashes = {};
+    }
+}
+
+ss::future<> spill_key_index::write_key_filter() {
+    std::sort(_key_hashes.begin(), _key_hashes.end());
+    _key_hashes.erase(
+      std::unique(_key_hashes.begin(), _key_hashes.end()), _key_hashes.end());
+    if (_key_filter_overflow || _key_hashes.size() > max_filtered_keys) {
+        return ss::now();
+    }
+    key_bloom_filter filter(_key_hashes.size());
+    for (auto h : _key_hashes) {
+        filter.add(h);
+    }
+    _key_hashes = {};
+    // the filter is an optimization, lookups read the index without it
+    return ss::do_with(std::move(filter), [this](key_bloom_filter& f) {
+        return write_key_bloom_filter(filename(), f, _footer.crc)
+          .handle_exception([this](const std::exception_ptr& e) {
+              vlog(
+                stlog.warn,
+                "error writing key filter of {}: {}",
+                filename(),
+                e);
+          });
+    });
+}
+
 ss::future<> spill_key_index::append(compacted_index::entry e) {
     return ss::do_with(std::move(e), [this](compacted_index::entry& e) {
         return spill(e.type, e.key, value_type{e.offset, e.delta});
@@ -175,19 +211,15 @@ ss::future<> spill_key_index::append(compacted_index::entry e) {
 }
 
 ss::future<> spill_key_index::drain_all_keys() {
-    return ss::do_until(
-      [this] {
-          // stop condition
-          return _midx.empty();
-      },
-      [this] {
-          auto node = _midx.extract(_midx.begin());
-          _keys_mem_usage -= node.key().size();
-          return ss::do_with(
-            node.key(), node.mapped(), [this](const bytes& k, value_type o) {
-                return spill(compacted_index::entry_type::key, k, o);
-            });
-      });
+    return ss::do_for_each(
+             boost::irange<size_t>(0, _midx.size()),
+             [this](size_t i) {
+                 return spill(
+                   compacted_index::entry_type::key,
+                   _midx.key_at(i),
+                   _midx.value_at(i));
+             })
+      .then([this] { _midx.clear(); });
 }
 
 void spill_key_index::set_flag(compacted_index::footer_flags f) {
@@ -213,9 +245,9 @@ ss::future<> spill_key_index::truncate(model::offset o) {
 ss::future<> spill_key_index::close() {
     return drain_all_keys().then([this] {
         vassert(
-          _keys_mem_usage == 0,
-          "Failed to drain all keys, {} bytes left",
-          _keys_mem_usage);
+          _midx.empty(),
+          "Failed to drain all keys, {} keys left",
+          _midx.size());
         _footer.crc = _crc.value();
         return ss::do_with(
                  reflection::to_iobuf(_footer),
@@ -226,7 +258,8 @@ ss::future<> spill_key_index::close() {
                        b);
                      return _appender.append(b);
                  })
-          .then([this] { return _appender.close(); });
+          .then([this] { return _appender.close(); })
+          .then([this] { return write_key_filter(); });
     });
 }
 
@@ -235,11 +268,11 @@ void spill_key_index::print(std::ostream& o) const { o << *this; }
 std::ostream& operator<<(std::ostream& o, const spill_key_index& k) {
     fmt::print(
       o,
-      "{{name:{}, max_mem:{}, key_mem_usage:{}, persisted_entries:{}, "
+      "{{name:{}, max_mem:{}, mem_usage:{}, persisted_entries:{}, "
       "in_memory_entries:{}, file_appender:{}}}",
       k.filename(),
       k._max_mem,
-      k._keys_mem_usage,
+      k._midx.memory_usage(),
       k._footer.keys,
       k._midx.size(),
       k._appender);
@@ -12,18 +12,16 @@
 #pragma once
 #include "bytes/bytes.h"
 #include "hashing/crc32c.h"
-#include "hashing/xx.h"
 #include "model/fundamental.h"
 #include "storage/compacted_index.h"
 #include "storage/compacted_index_writer.h"
+#include "storage/compaction_key_map.h"
 #include "storage/segment_appender.h"
 #include "utils/vint.h"
 
 #include <seastar/core/file.hh>
 #include <seastar/core/future.hh>
 
-#include <absl/container/node_hash_map.h>
-#include <absl/hash/hash.h>
 namespace storage::internal {
 using namespace storage; // NOLINT
 class spill_key_index final : public compacted_index_writer::impl {
@@ -35,11 +33,10 @@ public:
     static constexpr auto value_sz = sizeof(value_type);
     static constexpr size_t max_key_size = compacted_index::max_entry_size
                                            - (2 * vint::max_length);
-    using underlying_t = absl::node_hash_map<
-      bytes,
-      value_type,
-      bytes_hasher<uint64_t, xxhash_64>,
-      bytes_type_eq>;
+    /// no key filter is written for indices with more distinct keys, their
+    /// lookups read the index instead
+    static constexpr size_t max_filtered_keys = 1U << 22U;
+    using underlying_t = compaction_key_map<value_type>;
 
     spill_key_index(
       ss::sstring filename,
@@ -64,27 +61,21 @@ public:
     void set_flag(compacted_index::footer_flags) final;
 
 private:
-    /**
-     * returns memory usage of the map structures itself. In order to get total
-     * memory usage of spill key index we have to do:
-     *
-     *    idx_mem_usage() + _keys_mem_usage
-     */
-    size_t idx_mem_usage() {
-        using debug = absl::container_internal::hashtable_debug_internal::
-          HashtableDebugAccess<underlying_t>;
-        return debug::AllocatedByteSize(_midx);
-    }
     ss::future<> drain_all_keys();
-    ss::future<> add_key(bytes b, value_type);
+    ss::future<> add_key(bytes_view, value_type);
     ss::future<> spill(compacted_index::entry_type, bytes_view, value_type);
+    void track_key_hash(bytes_view);
+    ss::future<> write_key_filter();
 
     segment_appender _appender;
     underlying_t _midx;
     size_t _max_mem;
-    size_t _keys_mem_usage{0};
     compacted_index::footer _footer;
     crc32 _crc;
+    // hashes of the spilled keys, for the key filter written on close
+    std::vector<uint64_t> _key_hashes;
+    size_t _unique_key_hashes{0};
+    bool _key_filter_overflow{false};
 
     friend std::ostream& operator<<(std::ostream&, const spill_key_index&);
 };
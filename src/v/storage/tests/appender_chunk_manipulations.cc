@@ -8,6 +8,7 @@
 // by the Apache License, Version 2.0
 
 #include "random/generators.h"
+#include "storage/chunk_cache.h"
 #include "storage/segment_appender.h"
 
 #include <seastar/testing/thread_test_case.hh>
@@ -58,3 +59,34 @@ SEASTAR_THREAD_TEST_CASE(chunk_manipulation) {
         BOOST_REQUIRE_EQUAL(c.dma_size(), 0);
     }
 }
+
+SEASTAR_THREAD_TEST_CASE(chunk_cache_limit_and_fair_share) {
+    // no chunks are kept free, at most two are handed out
+    storage::internal::chunk_cache cache(0, 2 * chunk::chunk_size);
+    cache.start().get();
+
+    BOOST_REQUIRE_EQUAL(cache.fair_share(), 2);
+    cache.holder_added();
+    cache.holder_added();
+    BOOST_REQUIRE_EQUAL(cache.fair_share(), 1);
+
+    auto a = cache.get().get0();
+    auto b = cache.get().get0();
+    BOOST_REQUIRE_EQUAL(cache.size_total(), cache.size_limit());
+
+    auto f = cache.get();
+    BOOST_REQUIRE(!f.available());
+    BOOST_REQUIRE_EQUAL(cache.waiters(), 1);
+
+    cache.add(a);
+    auto c = f.get0();
+    BOOST_REQUIRE(c);
+    BOOST_REQUIRE_EQUAL(cache.waiters(), 0);
+    BOOST_REQUIRE_EQUAL(cache.size_total(), cache.size_limit());
+
+    cache.add(b);
+    cache.add(c);
+    cache.holder_removed();
+    cache.holder_removed();
+    BOOST_REQUIRE_EQUAL(cache.size_total(), 0);
+}
@@ -15,6 +15,7 @@
 #include "test_utils/fixture.h"
 
 #include <seastar/testing/thread_test_case.hh>
+#include <seastar/util/defer.hh>
 
 static storage::batch_cache::reclaim_options opts = {
   .growth_window = std::chrono::milliseconds(3000),
@@ -44,7 +45,8 @@ struct batch_cache_test_fixture {
     batch_cache_test_fixture()
       : cache(opts) {}
 
-    auto& get_lru() { return cache._lru; };
+    auto& get_probation() { return cache._probation; };
+    auto& get_protected() { return cache._protected; };
     ~batch_cache_test_fixture() { cache.stop().get(); }
 
     storage::batch_cache cache;
@@ -301,8 +303,79 @@ FIXTURE_TEST(test_random_batch_sizes, batch_cache_test_fixture) {
                        * 100.0;
 
     // assert waste, we have to skip last range
+    for (auto& r : get_probation()) {
+        BOOST_REQUIRE_LE(r.waste(), max_waste);
+    }
     for (auto& r : boost::make_iterator_range(
-           get_lru().begin(), std::prev(get_lru().end()))) {
+           get_protected().begin(), std::prev(get_protected().end()))) {
         BOOST_REQUIRE_LE(r.waste(), max_waste);
     }
 }
+
+FIXTURE_TEST(segmented_lru_scan_resistance, batch_cache_test_fixture) {
+    storage::batch_cache_index hot(
+      cache, storage::batch_cache_policy::segmented_lru);
+    storage::batch_cache_index cold(
+      cache, storage::batch_cache_policy::segmented_lru);
+
+    // batches larger than a range are cached in their own range
+    hot.put(make_random_batch(40_KiB, model::offset(0)));
+    BOOST_REQUIRE(hot.get(model::offset(0)));
+    BOOST_REQUIRE_EQUAL(get_protected().size(), 1u);
+
+    // a scan of cold data is admitted on probation only
+    for (int i = 0; i < 5; ++i) {
+        cold.put(make_random_batch(40_KiB, model::offset(i)));
+    }
+    BOOST_REQUIRE_EQUAL(get_protected().size(), 1u);
+    BOOST_REQUIRE_EQUAL(get_probation().size(), 5u);
+
+    cache.reclaim(1);
+    BOOST_REQUIRE(hot.get(model::offset(0)));
+    BOOST_REQUIRE(!cold.get(model::offset(0)));
+}
+
+FIXTURE_TEST(lru_policy_evicts_oldest, batch_cache_test_fixture) {
+    storage::batch_cache_index hot(cache, storage::batch_cache_policy::lru);
+    storage::batch_cache_index cold(cache, storage::batch_cache_policy::lru);
+
+    hot.put(make_random_batch(40_KiB, model::offset(0)));
+    BOOST_REQUIRE(hot.get(model::offset(0)));
+    for (int i = 0; i < 5; ++i) {
+        cold.put(make_random_batch(40_KiB, model::offset(i)));
+    }
+
+    // without scan resistance the least recently used range goes first
+    cache.reclaim(1);
+    BOOST_REQUIRE(!hot.get(model::offset(0)));
+}
+
+FIXTURE_TEST(retained_tail_is_reclaimed_last, batch_cache_test_fixture) {
+    auto retaining_opts = opts;
+    retaining_opts.max_retained_size = 1_MiB;
+    storage::batch_cache retaining(retaining_opts);
+    auto stop = ss::defer([&retaining] { retaining.stop().get(); });
+
+    storage::batch_cache_index other(retaining);
+    storage::batch_cache_index tail(retaining);
+    tail.retain_tail(400_KiB);
+
+    other.put(make_random_batch(150_KiB, model::offset(0)));
+    // larger than a range, each batch is in its own range. the oldest one
+    // does not fit in the tail size and is released to the lru order
+    for (int i = 0; i < 3; ++i) {
+        tail.put(make_random_batch(150_KiB, model::offset(i)));
+    }
+
+    // a single range is reclaimed, the least recently used one
+    retaining.reclaim(1);
+    BOOST_REQUIRE(!other.get(model::offset(0)));
+    for (int i = 0; i < 3; ++i) {
+        BOOST_REQUIRE(tail.get(model::offset(i)));
+    }
+
+    // the released range goes before the retained ones
+    retaining.reclaim(1);
+    BOOST_REQUIRE(!tail.get(model::offset(0)));
+    BOOST_REQUIRE(tail.get(model::offset(2)));
+}
@@ -14,7 +14,9 @@
 #include "storage/compacted_index.h"
 #include "storage/compacted_index_reader.h"
 #include "storage/compacted_index_writer.h"
+#include "storage/compaction_key_map.h"
 #include "storage/compaction_reducers.h"
+#include "storage/key_bloom_filter.h"
 #include "storage/segment_utils.h"
 #include "storage/spill_key_index.h"
 #include "test_utils/fixture.h"
@@ -23,6 +25,7 @@
 #include "utils/vint.h"
 
 #include <boost/test/unit_test_suite.hpp>
+#include <fmt/format.h>
 
 struct compacted_topic_fixture {};
 FIXTURE_TEST(format_verification, compacted_topic_fixture) {
@@ -344,3 +347,100 @@ FIXTURE_TEST(index_filtered_copy_tests, compacted_topic_fixture) {
         }
     }
 }
+
+FIXTURE_TEST(compaction_key_map_roundtrip, compacted_topic_fixture) {
+    storage::internal::compaction_key_map<model::offset> map;
+    std::vector<bytes> keys;
+    for (auto i = 0; i < 10000; ++i) {
+        keys.push_back(random_generators::get_bytes(8 + i % 64));
+        if (!map.find(keys.back())) {
+            map.insert(keys.back(), model::offset(i));
+        }
+    }
+    BOOST_REQUIRE_EQUAL(map.size(), keys.size());
+    for (auto i = 0; i < 10000; ++i) {
+        auto v = map.find(keys[i]);
+        BOOST_REQUIRE(v != nullptr);
+        BOOST_REQUIRE_EQUAL(*v, model::offset(i));
+        BOOST_REQUIRE_EQUAL(map.key_at(i), bytes_view(keys[i]));
+    }
+    BOOST_REQUIRE(map.find(random_generators::get_bytes(128)) == nullptr);
+
+    const auto usage = map.memory_usage();
+    map.clear();
+    BOOST_REQUIRE(map.empty());
+    BOOST_REQUIRE_LT(map.memory_usage(), usage);
+    BOOST_REQUIRE(map.find(keys[0]) == nullptr);
+    map.insert(keys[0], model::offset(42));
+    BOOST_REQUIRE_EQUAL(*map.find(keys[0]), model::offset(42));
+}
+
+FIXTURE_TEST(key_reducer_many_small_keys, compacted_topic_fixture) {
+    // every key is written twice and the default budget must hold all of them
+    storage::internal::compaction_key_reducer reducer;
+    const uint32_t keys = 80000;
+    for (uint32_t round = 0; round < 2; ++round) {
+        for (uint32_t i = 0; i < keys; ++i) {
+            const auto str = fmt::format("key-{:08}", i);
+            bytes key(
+              reinterpret_cast<const uint8_t*>(str.data()), str.size());
+            reducer(
+              storage::compacted_index::entry(
+                storage::compacted_index::entry_type::key,
+                std::move(key),
+                model::offset(round * keys + i),
+                0))
+              .get();
+        }
+    }
+    auto bitmap = reducer.end_of_stream();
+    BOOST_REQUIRE_EQUAL(bitmap.cardinality(), keys);
+    BOOST_REQUIRE(!bitmap.contains(0));
+    BOOST_REQUIRE(bitmap.contains(keys));
+}
+
+FIXTURE_TEST(key_bloom_filter_written_on_close, compacted_topic_fixture) {
+    const auto name = fmt::format(
+      "key_bloom_filter_{}.compaction_index",
+      random_generators::get_int<uint64_t>());
+    tmpbuf_file::store_t index_data;
+    auto idx = storage::make_file_backed_compacted_index(
+      name,
+      ss::file(ss::make_shared(tmpbuf_file(index_data))),
+      ss::default_priority_class(),
+      // small enough that the keys are spilled several times
+      4_KiB);
+    auto key = [](std::string_view prefix, uint32_t i) {
+        const auto str = fmt::format("{}-{}", prefix, i);
+        return bytes(reinterpret_cast<const uint8_t*>(str.data()), str.size());
+    };
+    const uint32_t keys = 1000;
+    for (uint32_t round = 0; round < 3; ++round) {
+        for (uint32_t i = 0; i < keys; ++i) {
+            idx.index(key("present", i), model::offset(round * keys + i), 0)
+              .get();
+        }
+    }
+    idx.close().get();
+
+    auto rdr = storage::make_file_backed_compacted_reader(
+      name,
+      ss::file(ss::make_shared(tmpbuf_file(index_data))),
+      ss::default_priority_class(),
+      32_KiB);
+    auto footer = rdr.load_footer().get0();
+    auto filter = storage::read_key_bloom_filter(name, footer.crc).get0();
+    BOOST_REQUIRE(filter);
+    size_t false_positives = 0;
+    for (uint32_t i = 0; i < keys; ++i) {
+        BOOST_REQUIRE(filter->may_contain(key("present", i)));
+        false_positives += filter->may_contain(key("absent", i));
+    }
+    BOOST_REQUIRE_LT(false_positives, keys / 20);
+
+    // a filter of another version of the index is ignored
+    BOOST_REQUIRE(
+      !storage::read_key_bloom_filter(name, footer.crc + 1).get0());
+    storage::remove_key_bloom_filter(name).get();
+    BOOST_REQUIRE(!storage::read_key_bloom_filter(name, footer.crc).get0());
+}
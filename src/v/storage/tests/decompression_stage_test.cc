@@ -0,0 +1,79 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "bytes/iobuf.h"
+#include "random/generators.h"
+#include "storage/decompression_stage.h"
+#include "storage/parser_utils.h"
+#include "storage/record_batch_builder.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+using namespace storage; // NOLINT
+
+// random values barely compress, so the size picks the path of the stage
+static model::record_batch make_compressed_batch(size_t value_size) {
+    storage::record_batch_builder builder(
+      model::record_batch_type::raft_data, model::offset(0));
+    for (int i = 0; i < 4; ++i) {
+        iobuf value;
+        value.append(
+          random_generators::gen_alphanum_string(value_size / 4).data(),
+          value_size / 4);
+        builder.add_raw_kv(iobuf{}, std::move(value));
+    }
+    return internal::compress_batch(
+             model::compression::zstd, std::move(builder).build())
+      .get0();
+}
+
+SEASTAR_THREAD_TEST_CASE(small_batches_are_decompressed_inline) {
+    auto& stage = internal::decompressions();
+    const auto batches = stage.decompressed_batches();
+    const auto deferred = stage.deferred_batches();
+
+    auto b = make_compressed_batch(1_KiB);
+    BOOST_REQUIRE_LT(b.data().size_bytes(), stage.inline_threshold);
+    auto f = internal::decompress_batch(b);
+    BOOST_REQUIRE(f.available());
+    auto d = f.get0();
+    BOOST_REQUIRE(!d.compressed());
+    BOOST_REQUIRE_EQUAL(d.record_count(), 4);
+    BOOST_REQUIRE_EQUAL(stage.decompressed_batches(), batches + 1);
+    BOOST_REQUIRE_EQUAL(stage.deferred_batches(), deferred);
+}
+
+SEASTAR_THREAD_TEST_CASE(large_batches_are_deferred) {
+    auto& stage = internal::decompressions();
+    const auto deferred = stage.deferred_batches();
+
+    auto b = make_compressed_batch(256_KiB);
+    BOOST_REQUIRE_GE(b.data().size_bytes(), stage.inline_threshold);
+    auto f = internal::decompress_batch(std::move(b));
+    BOOST_REQUIRE(!f.available());
+    auto d = f.get0();
+    BOOST_REQUIRE(!d.compressed());
+    BOOST_REQUIRE_EQUAL(d.record_count(), 4);
+    BOOST_REQUIRE_EQUAL(stage.deferred_batches(), deferred + 1);
+    const auto latency = stage.latency().seastar_histogram_logform();
+    BOOST_REQUIRE_GT(latency.sample_count, 0);
+}
+
+SEASTAR_THREAD_TEST_CASE(stopped_stage_decompresses_inline) {
+    internal::decompression_stage stage;
+    stage.start();
+    stage.stop().get();
+
+    auto b = make_compressed_batch(256_KiB);
+    BOOST_REQUIRE_GE(b.data().size_bytes(), stage.inline_threshold);
+    auto f = stage.decompress(b);
+    BOOST_REQUIRE(f.available());
+    BOOST_REQUIRE_EQUAL(f.get0().record_count(), 4);
+    BOOST_REQUIRE_EQUAL(stage.deferred_batches(), 0u);
+}
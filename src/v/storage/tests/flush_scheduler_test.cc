@@ -0,0 +1,85 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "seastarx.h"
+#include "storage/flush_scheduler.h"
+#include "storage/segment_appender.h"
+
+#include <seastar/core/file.hh>
+#include <seastar/core/future-util.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/reactor.hh>
+#include <seastar/testing/thread_test_case.hh>
+
+#include <fmt/format.h>
+
+#include <vector>
+
+using namespace storage; // NOLINT
+
+static ss::file open_test_file(int i) {
+    return ss::open_file_dma(
+             fmt::format("test.flush_scheduler.{}.log", i),
+             ss::open_flags::create | ss::open_flags::rw
+               | ss::open_flags::truncate)
+      .get0();
+}
+
+SEASTAR_THREAD_TEST_CASE(concurrent_flushes_are_coalesced) {
+    internal::flush_scheduler scheduler("test.flush_scheduler");
+    scheduler.start();
+
+    std::vector<ss::file> files;
+    std::vector<ss::future<>> done;
+    for (int i = 0; i < 5; ++i) {
+        files.push_back(open_test_file(i));
+        done.push_back(scheduler.flush(files.back()));
+    }
+    BOOST_REQUIRE_EQUAL(scheduler.pending(), 5u);
+    ss::when_all_succeed(done.begin(), done.end()).get();
+
+    BOOST_REQUIRE_EQUAL(scheduler.pending(), 0u);
+    BOOST_REQUIRE_EQUAL(scheduler.dispatched_batches(), 1u);
+    BOOST_REQUIRE_EQUAL(scheduler.dispatched_flushes(), 5u);
+    scheduler.stop().get();
+    for (auto& f : files) {
+        f.close().get();
+    }
+}
+
+SEASTAR_THREAD_TEST_CASE(stop_dispatches_pending_flushes) {
+    internal::flush_scheduler scheduler("test.flush_scheduler");
+    scheduler.start();
+
+    auto f = open_test_file(7);
+    auto done = scheduler.flush(f);
+    BOOST_REQUIRE_EQUAL(scheduler.pending(), 1u);
+    scheduler.stop().get();
+    BOOST_REQUIRE_EQUAL(scheduler.pending(), 0u);
+    BOOST_REQUIRE(done.available() && !done.failed());
+    done.get();
+    BOOST_REQUIRE_THROW(scheduler.flush(f).get(), ss::gate_closed_exception);
+    f.close().get();
+}
+
+SEASTAR_THREAD_TEST_CASE(appender_flush_goes_through_scheduler) {
+    internal::flush_scheduler scheduler("test.flush_scheduler");
+    scheduler.start();
+
+    auto f = open_test_file(42);
+    segment_appender::options opts(ss::default_priority_class(), 1);
+    opts.flusher = &scheduler;
+    auto appender = segment_appender(f, opts);
+    ss::sstring data = "123456789\n";
+    appender.append(data.data(), data.size()).get();
+    appender.flush().get();
+    BOOST_REQUIRE_EQUAL(scheduler.dispatched_flushes(), 1u);
+    appender.close().get();
+    scheduler.stop().get();
+}
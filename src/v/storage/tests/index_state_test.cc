@@ -1,9 +1,12 @@
 #define BOOST_TEST_MODULE storage
 #include "bytes/bytes.h"
+#include "reflection/adl.h"
 #include "storage/index_state.h"
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+
 static storage::index_state make_random_index_state() {
     storage::index_state st;
     st.size = 33;
@@ -24,13 +27,36 @@ static void set_version(iobuf& buf, int8_t version) {
     buf.append(bytes_to_iobuf(tmp.substr(1)));
 }
 
-static void set_size(iobuf& buf, uint32_t size) {
-    auto tmp = iobuf_to_bytes(buf);
-    buf.clear();
-    buf.append((const char*)tmp.c_str(), 1); // version
-    uint32_t size_le = ss::cpu_to_le(size);
-    buf.append((const char*)&size_le, sizeof(size_le));
-    buf.append(bytes_to_iobuf(tmp.substr(5)));
+// layout of versions 1 and 2: no padding between the header and arrays
+static iobuf
+serialize_unpadded(const storage::index_state& st, int8_t version) {
+    iobuf out;
+    const uint32_t n = st.relative_offset_index.size();
+    uint32_t size = sizeof(uint64_t) + sizeof(uint32_t) + 4 * sizeof(int64_t)
+                    + sizeof(uint32_t) + n * 3 * sizeof(uint32_t);
+    if (version == 1) {
+        size -= 4;
+    }
+    reflection::serialize(
+      out,
+      version,
+      size,
+      storage::index_state::checksum_state(st),
+      st.bitflags,
+      st.base_offset(),
+      st.max_offset(),
+      st.base_timestamp(),
+      st.max_timestamp(),
+      n);
+    for (const auto* v :
+         {&st.relative_offset_index,
+          &st.relative_time_index,
+          &st.position_index}) {
+        for (auto e : *v) {
+            reflection::adl<uint32_t>{}.to(out, e);
+        }
+    }
+    return out;
 }
 
 BOOST_AUTO_TEST_CASE(encode_decode) {
@@ -69,13 +95,48 @@ BOOST_AUTO_TEST_CASE(encode_decode_v0) {
 
 BOOST_AUTO_TEST_CASE(encode_decode_v1) {
     auto src = make_random_index_state();
-    auto src_buf = src.checksum_and_serialize();
-    set_version(src_buf, 1);
-    set_size(src_buf, src.size - 4);
+    auto src_buf = serialize_unpadded(src, 1);
 
     // version 1 is still supported
     auto dst = storage::index_state::hydrate_from_buffer(src_buf.copy());
     BOOST_REQUIRE(dst);
+    BOOST_REQUIRE(dst->relative_offset_index == src.relative_offset_index);
+}
+
+BOOST_AUTO_TEST_CASE(encode_decode_v2) {
+    auto src = make_random_index_state();
+    for (uint32_t i = 0; i < 100; ++i) {
+        src.add_entry(10 + i, 20 + i, 30 + i);
+    }
+    auto src_buf = serialize_unpadded(src, 2);
+
+    // version 2 is still supported and re-encodes to the current version
+    auto dst = storage::index_state::hydrate_from_buffer(src_buf.copy());
+    BOOST_REQUIRE(dst);
+    BOOST_REQUIRE(dst->relative_offset_index == src.relative_offset_index);
+    BOOST_REQUIRE(dst->relative_time_index == src.relative_time_index);
+    BOOST_REQUIRE(dst->position_index == src.position_index);
+    auto current = dst->checksum_and_serialize();
+    BOOST_REQUIRE(
+      storage::index_state::hydrate_from_buffer(std::move(current)));
+}
+
+BOOST_AUTO_TEST_CASE(encode_arrays_are_aligned) {
+    auto src = make_random_index_state();
+    for (uint32_t i = 0; i < 17; ++i) {
+        src.add_entry(10 + i, 20 + i, 30 + i);
+    }
+    auto buf = src.checksum_and_serialize();
+    BOOST_REQUIRE_EQUAL(
+      buf.size_bytes() % storage::index_state::page_alignment, 0);
+    // the offsets array begins at the first aligned position after the header
+    auto bytes = iobuf_to_bytes(buf);
+    uint32_t first = 0;
+    std::memcpy(
+      &first,
+      bytes.data() + storage::index_state::page_alignment,
+      sizeof(first));
+    BOOST_REQUIRE_EQUAL(ss::le_to_cpu(first), src.relative_offset_index[0]);
 }
 
 BOOST_AUTO_TEST_CASE(encode_decode_future_version) {
@@ -87,3 +148,50 @@ BOOST_AUTO_TEST_CASE(encode_decode_future_version) {
     auto dst = storage::index_state::hydrate_from_buffer(src_buf.copy());
     BOOST_REQUIRE(!dst);
 }
+
+BOOST_AUTO_TEST_CASE(encode_decode_sealed_summary) {
+    auto src = make_random_index_state();
+    src.bitflags = 0;
+    src.seal(4096, 12345);
+    auto src_buf = src.checksum_and_serialize();
+
+    auto dst = storage::index_state::hydrate_from_buffer(src_buf.copy());
+    BOOST_REQUIRE(dst);
+    BOOST_REQUIRE(dst->is_sealed());
+    BOOST_REQUIRE_EQUAL(dst->segment_size, 4096);
+    BOOST_REQUIRE_EQUAL(dst->segment_checksum, 12345);
+
+    // the summary is covered by the checksum
+    auto bytes = iobuf_to_bytes(src_buf);
+    bytes[storage::index_state::min_header_size] ^= 1;
+    BOOST_REQUIRE(
+      !storage::index_state::hydrate_from_buffer(bytes_to_iobuf(bytes)));
+}
+
+BOOST_AUTO_TEST_CASE(encode_decode_v3) {
+    auto src = make_random_index_state();
+    src.bitflags = 0;
+    for (uint32_t i = 0; i < 20; ++i) {
+        src.add_entry(10 + i, 20 + i, 30 + i);
+    }
+    // version 3 is the current layout without the segment summary
+    auto current = iobuf_to_bytes(src.checksum_and_serialize());
+    const size_t summary = storage::index_state::header_size
+                           - storage::index_state::min_header_size;
+    // the padding after the header grows by the size of the summary
+    const bytes zeros(bytes::initialized_later{}, summary);
+    bytes v3;
+    v3.append(current.data(), storage::index_state::min_header_size);
+    v3.append(zeros.data(), zeros.size());
+    v3.append(
+      current.data() + storage::index_state::header_size,
+      current.size() - storage::index_state::header_size);
+    std::fill_n(v3.begin() + storage::index_state::min_header_size, summary, 0);
+    v3[0] = 3;
+
+    auto dst = storage::index_state::hydrate_from_buffer(bytes_to_iobuf(v3));
+    BOOST_REQUIRE(dst);
+    BOOST_REQUIRE(!dst->is_sealed());
+    BOOST_REQUIRE(dst->relative_offset_index == src.relative_offset_index);
+    BOOST_REQUIRE(dst->position_index == src.position_index);
+}
@@ -8,10 +8,12 @@
 // by the Apache License, Version 2.0
 
 #include "config/configuration.h"
+#include "model/namespace.h"
 #include "random/generators.h"
 #include "reflection/adl.h"
 #include "storage/kvstore.h"
 
+#include <seastar/core/seastar.hh>
 #include <seastar/testing/thread_test_case.hh>
 
 template<typename T>
@@ -205,3 +207,56 @@ SEASTAR_THREAD_TEST_CASE(kvstore) {
     }
     kvs->stop().get();
 }
+
+SEASTAR_THREAD_TEST_CASE(kvstore_snapshots_dirty_key_spaces) {
+    set_configuration("disable_metrics", true);
+
+    auto dir = ssx::sformat(
+      "kvstore_test_{}", random_generators::get_int(4000));
+
+    auto conf = get_conf(dir);
+    storage::ntp_config ntpc(model::kvstore_ntp(ss::this_shard_id()), dir);
+    auto snapshot_inode = [&ntpc](int key_space) {
+        auto path = std::filesystem::path(ntpc.work_directory())
+                    / ssx::sformat("snapshot.{}", key_space).c_str();
+        return ss::file_stat(path.string()).get0().inode_number;
+    };
+
+    const auto key = random_generators::get_bytes(2);
+    const auto value = bytes_to_iobuf(random_generators::get_bytes(100));
+
+    auto kvs = std::make_unique<storage::kvstore>(conf);
+    kvs->start().get();
+    kvs->put(storage::kvstore::key_space::testing, key, value.copy()).get();
+    kvs->stop().get();
+
+    // recovery replays the put and snapshots the testing key space
+    kvs = std::make_unique<storage::kvstore>(conf);
+    kvs->start().get();
+    const auto testing_inode = snapshot_inode(0);
+
+    // roll several segments worth of writes to another key space
+    std::unordered_map<bytes, iobuf> truth;
+    for (int i = 0; i < 500; i++) {
+        auto k = random_generators::get_bytes(2);
+        auto v = bytes_to_iobuf(random_generators::get_bytes(100));
+        truth[k] = v.copy();
+        kvs->put(storage::kvstore::key_space::consensus, k, std::move(v))
+          .get();
+    }
+    kvs->stop().get();
+
+    kvs = std::make_unique<storage::kvstore>(conf);
+    kvs->start().get();
+
+    // the unchanged key space was never rewritten
+    BOOST_REQUIRE_EQUAL(snapshot_inode(0), testing_inode);
+    BOOST_REQUIRE(
+      kvs->get(storage::kvstore::key_space::testing, key).value() == value);
+    for (auto& e : truth) {
+        BOOST_REQUIRE(
+          kvs->get(storage::kvstore::key_space::consensus, e.first).value()
+          == e.second);
+    }
+    kvs->stop().get();
+}
@@ -7,6 +7,7 @@
 // the Business Source License, use of this software will be governed
 // by the Apache License, Version 2.0
 
+#include "config/configuration.h"
 #include "model/fundamental.h"
 #include "model/record_utils.h"
 #include "random/generators.h"
@@ -19,6 +20,7 @@
 #include "storage/tests/utils/random_batch.h"
 #include "utils/file_sanitizer.h"
 
+#include <seastar/core/sleep.hh>
 #include <seastar/core/thread.hh>
 #include <seastar/testing/thread_test_case.hh>
 #include <seastar/util/defer.hh>
@@ -114,3 +116,194 @@ SEASTAR_THREAD_TEST_CASE(test_can_load_logs) {
     BOOST_CHECK(
       file_exists(seg4->reader().filename() + ".cannotrecover").get0());
 }
+
+SEASTAR_THREAD_TEST_CASE(test_segment_roll_uses_preallocated_file) {
+    auto conf = make_config();
+    conf.segment_pool_size = 1;
+    storage::api store(
+      storage::kvstore_config(
+        1_MiB, 10ms, conf.base_dir, storage::debug_sanitize_files::yes),
+      conf);
+    store.start().get();
+    auto stop_kvstore = ss::defer([&store] { store.stop().get(); });
+    auto& m = store.log_mgr();
+    auto ntp = config_from_ntp(model::ntp("ns-pool", "topic-1", 0));
+    directories::initialize(ntp.work_directory()).get();
+
+    // the first segment is created inline and starts filling the pool
+    auto seg = m.make_log_segment(
+                  ntp,
+                  model::offset(0),
+                  model::term_id(1),
+                  ss::default_priority_class())
+                 .get0();
+    seg->close().get();
+
+    auto spare = ssx::sformat(
+      "{}/.segment_pool/{}/0.spare", conf.base_dir, ss::this_shard_id());
+    for (int i = 0; i < 100 && !file_exists(spare).get0(); ++i) {
+        ss::sleep(10ms).get();
+    }
+    BOOST_REQUIRE(file_exists(spare).get0());
+
+    // the next one is handed over from the pool
+    auto seg2 = m.make_log_segment(
+                   ntp,
+                   model::offset(10),
+                   model::term_id(1),
+                   ss::default_priority_class())
+                  .get0();
+    BOOST_CHECK(!file_exists(spare).get0());
+    BOOST_CHECK_EQUAL(seg2->reader().file_size(), 0);
+    write_batches(seg2);
+    seg2->close().get();
+    BOOST_CHECK(file_exists(seg2->reader().filename()).get0());
+}
+
+SEASTAR_THREAD_TEST_CASE(test_remove_releases_files_in_background) {
+    auto conf = make_config();
+    storage::api store(
+      storage::kvstore_config(
+        1_MiB, 10ms, conf.base_dir, storage::debug_sanitize_files::yes),
+      conf);
+    store.start().get();
+    auto stop_kvstore = ss::defer([&store] { store.stop().get(); });
+    auto& m = store.log_mgr();
+    auto ntp = config_from_ntp(model::ntp("ns-remove", "topic-1", 0));
+    directories::initialize(ntp.work_directory()).get();
+    auto seg = m.make_log_segment(
+                  ntp,
+                  model::offset(0),
+                  model::term_id(1),
+                  ss::default_priority_class())
+                 .get0();
+    write_batches(seg);
+    seg->close().get();
+    m.manage(config_from_ntp(ntp.ntp())).get();
+    BOOST_REQUIRE_EQUAL(m.get(ntp.ntp())->segment_count(), 1);
+
+    // the partition is gone right away, its files follow
+    m.remove(ntp.ntp()).get();
+    BOOST_CHECK(!m.get(ntp.ntp()));
+    BOOST_CHECK(!file_exists(ntp.work_directory()).get0());
+
+    m.deleter().drained().get();
+    BOOST_CHECK_EQUAL(m.deleter().pending_dirs(), 0);
+    BOOST_CHECK_GT(m.deleter().deleted_bytes(), 0);
+    BOOST_CHECK(!file_exists(
+                   ntp.work_directory()
+                   + ss::sstring(log_deleter::tombstone_suffix))
+                   .get0());
+    BOOST_CHECK(!file_exists(ntp.topic_directory().string()).get0());
+}
+
+SEASTAR_THREAD_TEST_CASE(test_in_memory_topic_is_bounded) {
+    config::shard_local_cfg().get("in_memory_log_max_bytes").set_value(
+      size_t(64_KiB));
+    auto reset = ss::defer([] {
+        auto& p = config::shard_local_cfg().in_memory_log_max_bytes;
+        config::shard_local_cfg().get(p.name()).set_value(p.default_value());
+    });
+    auto conf = make_config();
+    storage::api store(
+      storage::kvstore_config(
+        1_MiB, 10ms, conf.base_dir, storage::debug_sanitize_files::yes),
+      conf);
+    store.start().get();
+    auto stop_kvstore = ss::defer([&store] { store.stop().get(); });
+    auto& m = store.log_mgr();
+    auto overrides = std::make_unique<ntp_config::default_overrides>();
+    overrides->storage_mode = model::storage_mode::memory;
+    auto log = m.manage(ntp_config(
+                          model::ntp("ns-memory", "topic-1", 0),
+                          conf.base_dir,
+                          std::move(overrides)))
+                 .get0();
+    // raft snapshots the evicted prefix, stands in for it
+    log.set_collectible_offset(model::offset::max());
+
+    storage::log_append_config append_cfg{
+      storage::log_append_config::fsync::no,
+      ss::default_priority_class(),
+      model::no_timeout};
+    size_t appended = 0;
+    while (appended < 512_KiB) {
+        auto batches = test::make_random_batches(
+          log.offsets().dirty_offset + model::offset(1), 10);
+        for (const auto& b : batches) {
+            appended += b.size_bytes();
+        }
+        model::make_memory_record_batch_reader(std::move(batches))
+          .for_each_ref(log.make_appender(append_cfg), model::no_timeout)
+          .get();
+    }
+    // the oldest batches are gone
+    BOOST_CHECK_LE(log.size_bytes(), 64_KiB);
+    BOOST_CHECK_GT(log.offsets().start_offset, model::offset(0));
+}
+
+SEASTAR_THREAD_TEST_CASE(test_new_logs_are_spread_over_data_directories) {
+    auto conf = make_config();
+    const ss::sstring disk1 = "test.dir.disk1";
+    conf.extra_dirs = {disk1};
+    directories::initialize(disk1).get();
+    storage::api store(
+      storage::kvstore_config(
+        1_MiB, 10ms, conf.base_dir, storage::debug_sanitize_files::yes),
+      conf);
+    store.start().get();
+    auto stop_kvstore = ss::defer([&store] { store.stop().get(); });
+    auto& m = store.log_mgr();
+    auto manage_in = [&m](model::ntp ntp, ss::sstring dir) {
+        m.manage(ntp_config(std::move(ntp), std::move(dir))).get();
+    };
+
+    // the directory with the fewest logs of the shard is selected
+    manage_in(model::ntp("ns-jbod", "topic-1", 0), conf.base_dir);
+    auto second = config_from_ntp(model::ntp("ns-jbod", "topic-1", 1));
+    BOOST_CHECK_EQUAL(m.select_data_directory(second).get0(), disk1);
+    manage_in(second.ntp(), disk1);
+    manage_in(model::ntp("ns-jbod", "topic-1", 2), disk1);
+    auto fourth = config_from_ntp(model::ntp("ns-jbod", "topic-1", 3));
+    BOOST_CHECK_EQUAL(m.select_data_directory(fourth).get0(), conf.base_dir);
+
+    // unless the log is already in one of them
+    ntp_config existing(fourth.ntp(), disk1);
+    directories::initialize(existing.work_directory()).get();
+    BOOST_CHECK_EQUAL(m.select_data_directory(fourth).get0(), disk1);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_two_log_managers_on_one_shard) {
+    // the per manager metrics of one shard must not collide
+    auto conf_a = make_config();
+    auto conf_b = make_config();
+    conf_b.base_dir = "test.dir.second_manager";
+    directories::initialize(conf_b.base_dir).get();
+    storage::kvstore kvs(storage::kvstore_config(
+      1_MiB, 10ms, conf_a.base_dir, storage::debug_sanitize_files::yes));
+    kvs.start().get();
+    auto stop_kvstore = ss::defer([&kvs] { kvs.stop().get(); });
+
+    storage::log_manager a(conf_a, kvs);
+    auto stop_a = ss::defer([&a] { a.stop().get(); });
+    storage::log_manager b(conf_b, kvs);
+    auto stop_b = ss::defer([&b] { b.stop().get(); });
+
+    storage::log_append_config append_cfg{
+      storage::log_append_config::fsync::yes,
+      ss::default_priority_class(),
+      model::no_timeout};
+    auto append = [&append_cfg](storage::log log) {
+        model::make_memory_record_batch_reader(
+          test::make_random_batches(model::offset(0), 3))
+          .for_each_ref(log.make_appender(append_cfg), model::no_timeout)
+          .get();
+        BOOST_CHECK_GE(log.offsets().dirty_offset, model::offset(0));
+    };
+    append(
+      a.manage(ntp_config(model::ntp("ns-two", "topic-a", 0), conf_a.base_dir))
+        .get0());
+    append(
+      b.manage(ntp_config(model::ntp("ns-two", "topic-b", 0), conf_b.base_dir))
+        .get0());
+}
@@ -7,10 +7,17 @@
 // the Business Source License, use of this software will be governed
 // by the Apache License, Version 2.0
 
+#include "config/configuration.h"
+#include "storage/disk_space_manager.h"
+#include "storage/log_housekeeping_meta.h"
 #include "storage/tests/utils/disk_log_builder.h"
 // fixture
 #include "test_utils/fixture.h"
 
+#include <seastar/core/seastar.hh>
+#include <seastar/util/defer.hh>
+
+#include <limits>
 #include <optional>
 
 struct gc_fixture {
@@ -93,3 +100,117 @@ FIXTURE_TEST(retention_test_after_truncation, gc_fixture) {
     BOOST_CHECK_EQUAL(
       builder.get_disk_log_impl().get_probe().partition_size(), 0);
 }
+
+FIXTURE_TEST(retention_housekeeping_due, gc_fixture) {
+    builder | storage::start() | storage::add_segment(0)
+      | storage::add_random_batch(0, 100)
+      | storage::add_segment(100) | storage::add_random_batches(100, 3);
+    ss::abort_source as;
+    auto cfg = [&as](model::timestamp eviction, std::optional<size_t> size) {
+        return storage::compaction_config(
+          eviction, size, ss::default_priority_class(), as);
+    };
+    auto& log = builder.get_log();
+
+    BOOST_TEST_MESSAGE("Should never be due without retention");
+    BOOST_CHECK_EQUAL(
+      log.housekeeping_due(cfg(model::timestamp::min(), std::nullopt)),
+      model::timestamp::max());
+
+    BOOST_TEST_MESSAGE("Should be due now when over the retention size");
+    BOOST_CHECK_EQUAL(
+      log.housekeeping_due(cfg(model::timestamp::min(), 0)),
+      model::timestamp::min());
+
+    BOOST_TEST_MESSAGE("Should be due when the oldest segment expires");
+    const int64_t retention = 3600 * 1000;
+    auto due = log.housekeeping_due(cfg(
+      model::timestamp(model::timestamp::now().value() - retention),
+      std::nullopt));
+    auto oldest = builder.get_segment(0).index().max_timestamp();
+    // the retention is computed from the clock, which moves on
+    BOOST_CHECK_GE(due.value(), oldest.value() + retention);
+    BOOST_CHECK_LE(due.value(), oldest.value() + retention + 60 * 1000);
+    builder | storage::stop();
+}
+
+FIXTURE_TEST(disk_space_reclaim_archived_first, gc_fixture) {
+    builder | storage::start() | storage::add_segment(0)
+      | storage::add_random_batch(0, 100) | storage::add_segment(100)
+      | storage::add_random_batch(100, 2) | storage::add_segment(102)
+      | storage::add_random_batches(102, 3);
+    auto& log = builder.get_log();
+    log.set_collectible_offset(log.offsets().dirty_offset);
+    ss::abort_source as;
+
+    BOOST_TEST_MESSAGE("Should not trim segments that are not archived");
+    BOOST_REQUIRE(!log.oldest_reclaimable(true));
+    BOOST_CHECK_EQUAL(log.reclaim_oldest_segment(true, as).get0(), 0);
+    BOOST_CHECK_EQUAL(log.segment_count(), 3);
+
+    BOOST_TEST_MESSAGE("Should trim the archived segment");
+    log.set_archived_offset(model::offset(99));
+    BOOST_REQUIRE(log.oldest_reclaimable(true));
+    auto size = builder.get_segment(0).size_bytes();
+    BOOST_CHECK_EQUAL(log.reclaim_oldest_segment(true, as).get0(), size);
+    BOOST_CHECK_EQUAL(log.segment_count(), 2);
+    BOOST_REQUIRE(!log.oldest_reclaimable(true));
+
+    BOOST_TEST_MESSAGE("Should keep the active segment");
+    BOOST_CHECK_GT(log.reclaim_oldest_segment(false, as).get0(), 0);
+    BOOST_CHECK_EQUAL(log.segment_count(), 1);
+    BOOST_REQUIRE(!log.oldest_reclaimable(false));
+    builder | storage::stop();
+}
+
+FIXTURE_TEST(disk_space_pressure_levels, gc_fixture) {
+    using storage::disk_space_manager;
+    using pressure = disk_space_manager::pressure;
+    BOOST_CHECK_EQUAL(disk_space_manager::level_for(10, 0, 0), pressure::none);
+    BOOST_CHECK_EQUAL(disk_space_manager::level_for(10, 10, 5), pressure::none);
+    BOOST_CHECK_EQUAL(disk_space_manager::level_for(9, 10, 5), pressure::low);
+    BOOST_CHECK_EQUAL(
+      disk_space_manager::level_for(4, 10, 5), pressure::critical);
+    BOOST_CHECK_EQUAL(
+      disk_space_manager::level_for(4, 0, 5), pressure::critical);
+}
+
+FIXTURE_TEST(disk_space_trims_the_directory_under_pressure, gc_fixture) {
+    using storage::disk_space_manager;
+    using pressure = disk_space_manager::pressure;
+    builder | storage::start() | storage::add_segment(0)
+      | storage::add_random_batch(0, 100) | storage::add_segment(100)
+      | storage::add_random_batches(100, 3);
+    auto& log = builder.get_log();
+    log.set_collectible_offset(log.offsets().dirty_offset);
+    disk_space_manager::logs_t logs;
+    logs.emplace(log.config().ntp(), storage::log_housekeeping_meta(log));
+    ss::abort_source as;
+
+    // every disk is short of space
+    config::shard_local_cfg().get("disk_space_critical_free_bytes").set_value(
+      std::numeric_limits<size_t>::max());
+    auto reset = ss::defer([] {
+        auto& p = config::shard_local_cfg().disk_space_critical_free_bytes;
+        config::shard_local_cfg().get(p.name()).set_value(p.default_value());
+    });
+
+    BOOST_TEST_MESSAGE("Should leave the logs of other directories alone");
+    const auto& dir = builder.get_log_config().base_dir;
+    const ss::sstring other_dir = dir + "_other";
+    ss::recursive_touch_directory(other_dir).get();
+    disk_space_manager other({other_dir}, logs, as);
+    other.check().get();
+    BOOST_CHECK_EQUAL(other.level(other_dir), pressure::critical);
+    BOOST_CHECK_EQUAL(other.level(dir), pressure::none);
+    BOOST_CHECK_EQUAL(other.reclaimed_bytes(), 0u);
+    BOOST_CHECK_EQUAL(log.segment_count(), 2);
+
+    BOOST_TEST_MESSAGE("Should trim the logs of the directory");
+    disk_space_manager own({dir, other_dir}, logs, as);
+    own.check().get();
+    BOOST_CHECK_EQUAL(own.level(), pressure::critical);
+    BOOST_CHECK_GT(own.reclaimed_bytes(), 0u);
+    BOOST_CHECK_EQUAL(log.segment_count(), 1);
+    builder | storage::stop();
+}
@@ -8,19 +8,24 @@
 // by the Apache License, Version 2.0
 
 #include "bytes/iobuf.h"
+#include "config/configuration.h"
 #include "random/generators.h"
 #include "seastarx.h"
 #include "storage/segment_appender.h"
 
 #include <seastar/core/reactor.hh>
+#include <seastar/core/sleep.hh>
 #include <seastar/core/thread.hh>
 #include <seastar/testing/thread_test_case.hh>
+#include <seastar/util/defer.hh>
 
 // test gate
 #include <seastar/core/gate.hh>
 
 #include <fmt/format.h>
 
+#include <cstring>
+
 using namespace storage; // NOLINT
 
 SEASTAR_THREAD_TEST_CASE(test_can_append_multiple_flushes) {
@@ -217,3 +222,50 @@ SEASTAR_THREAD_TEST_CASE(test_can_append_little_data) {
     BOOST_REQUIRE_EQUAL(appender.file_byte_offset(), data.size());
     appender.close().get();
 }
+
+SEASTAR_THREAD_TEST_CASE(test_reclaimed_chunk_keeps_the_tail_page) {
+    using namespace std::chrono_literals;
+    auto& timeout = config::shard_local_cfg().segment_appender_flush_timeout_ms;
+    config::shard_local_cfg().get(timeout.name()).set_value(10ms);
+    auto reset = ss::defer([&timeout] {
+        config::shard_local_cfg().get(timeout.name()).set_value(
+          timeout.default_value());
+    });
+    const ss::sstring name = "test_segment_appender_tail.log";
+    auto f = ss::open_file_dma(
+               name,
+               ss::open_flags::create | ss::open_flags::rw
+                 | ss::open_flags::truncate)
+               .get0();
+    auto appender = segment_appender(
+      f, segment_appender::options(ss::default_priority_class(), 1));
+    const auto alignment = f.disk_write_dma_alignment();
+
+    iobuf expected;
+    const auto head = random_generators::gen_alphanum_string(alignment + 20);
+    expected.append(head.data(), head.size());
+    appender.append(head.data(), head.size()).get();
+    // the inactive appender writes its chunk and returns it to the cache
+    ss::sleep(200ms).get();
+
+    // clobber the partial page on disk: a read back would pick it up
+    auto garbage = ss::allocate_aligned_buffer<char>(alignment, alignment);
+    std::memset(garbage.get(), 'x', alignment);
+    auto other = ss::open_file_dma(name, ss::open_flags::rw).get0();
+    other
+      .dma_write<char>(
+        alignment, garbage.get(), alignment, ss::default_priority_class())
+      .get();
+    other.close().get();
+
+    const auto tail = random_generators::gen_alphanum_string(100);
+    expected.append(tail.data(), tail.size());
+    appender.append(tail.data(), tail.size()).get();
+    appender.flush().get();
+
+    auto in = make_file_input_stream(f, 0);
+    iobuf result = read_iobuf_exactly(in, expected.size_bytes()).get0();
+    in.close().get();
+    BOOST_REQUIRE_EQUAL(result, expected);
+    appender.close().get();
+}
@@ -7,6 +7,7 @@
 // the Business Source License, use of this software will be governed
 // by the Apache License, Version 2.0
 #include "random/generators.h"
+#include "ssx/sformat.h"
 #include "storage/segment_index.h"
 #include "test_utils/fixture.h"
 #include "utils/file_io.h"
@@ -126,3 +127,36 @@ FIXTURE_TEST(bucket_truncate, context) {
         BOOST_REQUIRE_EQUAL(p->filepos, 458048);
     }
 }
+
+FIXTURE_TEST(index_opened_by_name_round_trip, context) {
+    const auto name = ssx::sformat(
+      "offset_index_utils_tests.{}.base_index",
+      random_generators::gen_alphanum_string(7));
+    // the index doesn't hold a handle of its own, the file is only opened
+    // when the index is flushed or loaded
+    storage::segment_index idx(
+      name,
+      _base_offset,
+      storage::segment_index::default_data_buffer_step,
+      storage::debug_sanitize_files::yes);
+    for (uint32_t i = 0; i < 1024; ++i) {
+        model::offset o = _base_offset + model::offset(i);
+        idx.maybe_track(
+          modify_get(o, storage::segment_index::default_data_buffer_step),
+          i * storage::segment_index::default_data_buffer_step);
+    }
+    idx.close().get();
+
+    storage::segment_index loaded(
+      name,
+      _base_offset,
+      storage::segment_index::default_data_buffer_step,
+      storage::debug_sanitize_files::yes);
+    BOOST_REQUIRE(loaded.materialize_index().get0());
+    BOOST_REQUIRE_EQUAL(loaded.max_offset(), model::offset(1023));
+    auto p = loaded.find_nearest(model::offset(512));
+    BOOST_REQUIRE(bool(p));
+    BOOST_REQUIRE_EQUAL(p->offset, model::offset(512));
+    loaded.close().get();
+    ss::remove_file(name).get();
+}
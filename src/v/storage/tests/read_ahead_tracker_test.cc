@@ -0,0 +1,69 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/read_ahead.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+SEASTAR_THREAD_TEST_CASE(test_read_ahead_disabled) {
+    storage::read_ahead_tracker tracker(false, {});
+    BOOST_REQUIRE(!tracker.record_disk_read(1_GiB));
+    BOOST_REQUIRE(!tracker.buffering());
+}
+
+SEASTAR_THREAD_TEST_CASE(test_read_ahead_grows_for_sequential_reads) {
+    storage::read_ahead_tracker::limits limits{
+      .min_buffer_size = 128_KiB,
+      .max_buffer_size = 1_MiB,
+      .min_read_ahead = 4,
+      .max_read_ahead = 16,
+    };
+    storage::read_ahead_tracker tracker(true, limits);
+    // short reads keep the default buffering
+    BOOST_REQUIRE(!tracker.record_disk_read(64_KiB));
+    BOOST_REQUIRE(!tracker.buffering());
+
+    size_t promotions = 0;
+    size_t prev_window = 0;
+    for (int i = 0; i < 1000; ++i) {
+        if (tracker.record_disk_read(64_KiB)) {
+            ++promotions;
+            auto b = tracker.buffering();
+            BOOST_REQUIRE(b);
+            BOOST_REQUIRE_LE(b->buffer_size, limits.max_buffer_size);
+            BOOST_REQUIRE_LE(b->read_ahead, limits.max_read_ahead);
+            BOOST_REQUIRE_GT(b->buffer_size * b->read_ahead, prev_window);
+            prev_window = b->buffer_size * b->read_ahead;
+            tracker.stream_opened();
+        }
+    }
+    // 128K x 4 -> 256K x 8 -> 512K x 16 -> 1M x 16
+    BOOST_REQUIRE_EQUAL(promotions, 3u);
+    BOOST_REQUIRE_EQUAL(tracker.buffering()->buffer_size, 1_MiB);
+    BOOST_REQUIRE_EQUAL(tracker.buffering()->read_ahead, 16u);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_read_ahead_limits_for_disk) {
+    using limits = storage::read_ahead_tracker::limits;
+    // unmeasured disks keep the defaults
+    auto l = limits::for_disk(0, std::chrono::microseconds(0));
+    BOOST_REQUIRE_EQUAL(l.max_buffer_size, limits{}.max_buffer_size);
+    BOOST_REQUIRE_EQUAL(l.max_read_ahead, limits{}.max_read_ahead);
+
+    // fast, low latency disk: large buffers, few in flight
+    l = limits::for_disk(3'000'000'000, std::chrono::microseconds(100));
+    BOOST_REQUIRE_EQUAL(l.max_buffer_size, 4_MiB);
+    BOOST_REQUIRE_EQUAL(l.max_read_ahead, l.min_read_ahead);
+
+    // slow, high latency disk: small buffers, more in flight
+    l = limits::for_disk(200'000'000, std::chrono::microseconds(8000));
+    BOOST_REQUIRE_EQUAL(l.max_buffer_size, 256_KiB);
+    BOOST_REQUIRE_EQUAL(l.max_read_ahead, 7);
+    BOOST_REQUIRE_LE(l.min_buffer_size, l.max_buffer_size);
+}
@@ -0,0 +1,179 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "model/fundamental.h"
+#include "model/namespace.h"
+#include "storage/disk_log_impl.h"
+#include "storage/shared_log.h"
+#include "storage/tests/storage_test_fixture.h"
+
+#include <seastar/util/defer.hh>
+
+namespace {
+
+storage::log_config shared_log_config(ss::sstring dir) {
+    auto cfg = storage::log_config(
+      storage::log_config::storage_type::disk,
+      std::move(dir),
+      200_MiB,
+      storage::debug_sanitize_files::yes);
+    cfg.shared_log_enabled = true;
+    return cfg;
+}
+
+model::ntp kafka_ntp(int32_t partition) {
+    return model::ntp(model::kafka_namespace, "shared", partition);
+}
+
+bool is_shared(const storage::log& log) {
+    auto shared = dynamic_cast<storage::shared_log_impl*>(log.get_impl());
+    return shared && !shared->graduated();
+}
+
+void require_same_batches(
+  const std::vector<model::record_batch_header>& written,
+  const ss::circular_buffer<model::record_batch>& read) {
+    BOOST_REQUIRE_EQUAL(written.size(), read.size());
+    for (size_t i = 0; i < written.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(written[i].crc, read[i].header().crc);
+        BOOST_REQUIRE_EQUAL(
+          written[i].record_count, read[i].header().record_count);
+    }
+}
+
+} // namespace
+
+FIXTURE_TEST(shared_log_interleaves_partitions, storage_test_fixture) {
+    auto mgr = make_log_manager(shared_log_config(test_dir));
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get(); });
+    auto a = mgr.manage(storage::ntp_config(kafka_ntp(0), test_dir)).get();
+    auto b = mgr.manage(storage::ntp_config(kafka_ntp(1), test_dir)).get();
+    // other namespaces keep a log of their own
+    auto own = mgr.manage(storage::ntp_config(
+                            model::ntp("default", "own", 0), test_dir))
+                 .get();
+    BOOST_REQUIRE(is_shared(a));
+    BOOST_REQUIRE(is_shared(b));
+    BOOST_REQUIRE(!is_shared(own));
+
+    std::vector<model::record_batch_header> written_a;
+    std::vector<model::record_batch_header> written_b;
+    for (int i = 0; i < 5; ++i) {
+        auto ha = append_random_batches(a, 1, model::term_id(1));
+        written_a.insert(written_a.end(), ha.begin(), ha.end());
+        auto hb = append_random_batches(b, 2, model::term_id(1));
+        written_b.insert(written_b.end(), hb.begin(), hb.end());
+    }
+    require_same_batches(written_a, read_and_validate_all_batches(a));
+    require_same_batches(written_b, read_and_validate_all_batches(b));
+    BOOST_REQUIRE_EQUAL(a.offsets().committed_offset, a.offsets().dirty_offset);
+    BOOST_REQUIRE_EQUAL(a.offsets().start_offset, model::offset(0));
+}
+
+FIXTURE_TEST(shared_log_recovers_after_restart, storage_test_fixture) {
+    std::vector<model::record_batch_header> written_a;
+    std::vector<model::record_batch_header> written_b;
+    model::offset suffix;
+    model::offset prefix;
+    {
+        auto mgr = make_log_manager(shared_log_config(test_dir));
+        auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get(); });
+        auto a = mgr.manage(storage::ntp_config(kafka_ntp(0), test_dir)).get();
+        auto b = mgr.manage(storage::ntp_config(kafka_ntp(1), test_dir)).get();
+        for (int i = 0; i < 4; ++i) {
+            auto ha = append_random_batches(a, 1, model::term_id(i));
+            written_a.insert(written_a.end(), ha.begin(), ha.end());
+            auto hb = append_random_batches(b, 1, model::term_id(i));
+            written_b.insert(written_b.end(), hb.begin(), hb.end());
+        }
+        // drop the last append of a and the first batch of b
+        auto batches_a = read_and_validate_all_batches(a);
+        suffix = batches_a[batches_a.size() - 1].base_offset();
+        a.truncate(storage::truncate_config(
+                     suffix, ss::default_priority_class()))
+          .get();
+        written_a.pop_back();
+        auto batches_b = read_and_validate_all_batches(b);
+        prefix = batches_b[1].base_offset();
+        b.truncate_prefix(storage::truncate_prefix_config(
+                            prefix, ss::default_priority_class()))
+          .get();
+        written_b.erase(written_b.begin());
+    }
+
+    auto mgr = make_log_manager(shared_log_config(test_dir));
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get(); });
+    auto a = mgr.manage(storage::ntp_config(kafka_ntp(0), test_dir)).get();
+    auto b = mgr.manage(storage::ntp_config(kafka_ntp(1), test_dir)).get();
+    BOOST_REQUIRE(is_shared(a));
+    BOOST_REQUIRE(is_shared(b));
+    BOOST_REQUIRE_EQUAL(
+      a.offsets().dirty_offset, suffix - model::offset(1));
+    BOOST_REQUIRE_EQUAL(b.offsets().start_offset, prefix);
+    require_same_batches(written_a, read_and_validate_all_batches(a));
+    require_same_batches(written_b, read_and_validate_all_batches(b));
+
+    // appends go on after the recovered tail
+    auto ha = append_random_batches(a, 1, model::term_id(5));
+    written_a.insert(written_a.end(), ha.begin(), ha.end());
+    require_same_batches(written_a, read_and_validate_all_batches(a));
+}
+
+FIXTURE_TEST(shared_log_release_on_remove, storage_test_fixture) {
+    {
+        auto mgr = make_log_manager(shared_log_config(test_dir));
+        auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get(); });
+        auto a = mgr.manage(storage::ntp_config(kafka_ntp(0), test_dir)).get();
+        append_random_batches(a, 3);
+        mgr.remove(kafka_ntp(0)).get();
+    }
+    auto mgr = make_log_manager(shared_log_config(test_dir));
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get(); });
+    auto a = mgr.manage(storage::ntp_config(kafka_ntp(0), test_dir)).get();
+    BOOST_REQUIRE(is_shared(a));
+    BOOST_REQUIRE_EQUAL(a.offsets().dirty_offset, model::offset{});
+    BOOST_REQUIRE(read_and_validate_all_batches(a).empty());
+}
+
+FIXTURE_TEST(shared_log_graduates_to_dedicated_log, storage_test_fixture) {
+    std::vector<model::record_batch_header> written;
+    model::offset start;
+    {
+        auto mgr = make_log_manager(shared_log_config(test_dir));
+        auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get(); });
+        auto a = mgr.manage(storage::ntp_config(kafka_ntp(0), test_dir)).get();
+        written = append_random_batches(a, 4, model::term_id(1));
+        auto batches = read_and_validate_all_batches(a);
+        start = batches[1].base_offset();
+        a.truncate_prefix(storage::truncate_prefix_config(
+                            start, ss::default_priority_class()))
+          .get();
+        written.erase(written.begin());
+
+        auto shared = dynamic_cast<storage::shared_log_impl*>(a.get_impl());
+        shared->graduate().get();
+        BOOST_REQUIRE(shared->graduated());
+        BOOST_REQUIRE_EQUAL(a.offsets().start_offset, start);
+        require_same_batches(written, read_and_validate_all_batches(a));
+
+        // appends go to the dedicated log
+        auto more = append_random_batches(a, 2, model::term_id(2));
+        written.insert(written.end(), more.begin(), more.end());
+        require_same_batches(written, read_and_validate_all_batches(a));
+    }
+
+    // the partition is recovered from its dedicated log
+    auto mgr = make_log_manager(shared_log_config(test_dir));
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get(); });
+    auto a = mgr.manage(storage::ntp_config(kafka_ntp(0), test_dir)).get();
+    BOOST_REQUIRE(
+      dynamic_cast<storage::disk_log_impl*>(a.get_impl()) != nullptr);
+    BOOST_REQUIRE_EQUAL(a.offsets().start_offset, start);
+    require_same_batches(written, read_and_validate_all_batches(a));
+}
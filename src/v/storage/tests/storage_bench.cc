@@ -0,0 +1,267 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "bytes/iobuf.h"
+#include "config/configuration.h"
+#include "model/fundamental.h"
+#include "random/generators.h"
+#include "ssx/sformat.h"
+#include "storage/batch_cache.h"
+#include "storage/kvstore.h"
+#include "storage/segment_appender.h"
+#include "storage/segment_index.h"
+#include "storage/tests/utils/disk_log_builder.h"
+#include "storage/tests/utils/random_batch.h"
+#include "units.h"
+
+#include <seastar/core/file.hh>
+#include <seastar/core/loop.hh>
+#include <seastar/core/reactor.hh>
+#include <seastar/core/seastar.hh>
+#include <seastar/testing/perf_tests.hh>
+
+#include <boost/range/irange.hpp>
+
+#include <vector>
+
+/*
+ * Hot paths of the storage engine. Every fixture builds its state once, the
+ * measured sections only cover the operation named by the test.
+ */
+
+static constexpr size_t append_bytes_per_run = 1_MiB;
+
+struct appender_bench {
+    static constexpr size_t max_file_size = 256_MiB;
+
+    appender_bench()
+      : _name(ssx::sformat(
+        "storage_bench.appender_{}.log",
+        random_generators::gen_alphanum_string(7)))
+      , _appender(
+          ss::open_file_dma(
+            _name,
+            ss::open_flags::create | ss::open_flags::rw
+              | ss::open_flags::truncate)
+            .get0(),
+          storage::segment_appender::options(
+            ss::default_priority_class(),
+            storage::segment_appender::chunks_no_buffer)) {}
+
+    ~appender_bench() {
+        _appender.close().get();
+        ss::remove_file(_name).get();
+    }
+
+    ss::future<> append_and_flush(size_t batch_size) {
+        if (_appender.file_byte_offset() >= max_file_size) {
+            co_await _appender.truncate(0);
+        }
+        auto data = bytes_to_iobuf(random_generators::get_bytes(batch_size));
+        perf_tests::start_measuring_time();
+        for (size_t written = 0; written < append_bytes_per_run;
+             written += batch_size) {
+            co_await _appender.append(data);
+        }
+        co_await _appender.flush();
+        perf_tests::stop_measuring_time();
+    }
+
+    ss::sstring _name;
+    storage::segment_appender _appender;
+};
+
+PERF_TEST_F(appender_bench, append_flush_512b) {
+    return append_and_flush(512);
+}
+
+PERF_TEST_F(appender_bench, append_flush_4k) { return append_and_flush(4_KiB); }
+
+PERF_TEST_F(appender_bench, append_flush_64k) {
+    return append_and_flush(64_KiB);
+}
+
+PERF_TEST_F(appender_bench, append_flush_1m) { return append_and_flush(1_MiB); }
+
+struct log_reader_bench {
+    static constexpr int batch_count = 2000;
+
+    log_reader_bench() {
+        _builder.start().get();
+        _builder.add_random_batches(model::offset(0), batch_count).get();
+        _last = _builder.get_log().offsets().dirty_offset;
+    }
+
+    ~log_reader_bench() { _builder.stop().get(); }
+
+    ss::future<> read(storage::log_reader_config cfg) {
+        perf_tests::start_measuring_time();
+        auto batches = co_await _builder.consume(cfg);
+        perf_tests::stop_measuring_time();
+        perf_tests::do_not_optimize(batches);
+    }
+
+    storage::disk_log_builder _builder;
+    model::offset _last;
+};
+
+PERF_TEST_F(log_reader_bench, sequential_read) {
+    return read(storage::log_reader_config(
+      model::offset(0), _last, ss::default_priority_class()));
+}
+
+PERF_TEST_F(log_reader_bench, random_read) {
+    auto start = model::offset(random_generators::get_int<int64_t>(_last()));
+    auto cfg = storage::log_reader_config(
+      start, _last, ss::default_priority_class());
+    // a single batch, as for a consumer seeking to an offset
+    cfg.max_bytes = 1;
+    return read(cfg);
+}
+
+struct batch_cache_bench {
+    static constexpr size_t batch_count = 1000;
+
+    batch_cache_bench()
+      : _cache(storage::batch_cache::reclaim_options{
+        .growth_window = std::chrono::milliseconds(3000),
+        .stable_window = std::chrono::milliseconds(10000),
+        .min_size = 128_KiB,
+        .max_size = 64_MiB,
+      })
+      , _index(_cache) {
+        for (auto& b : storage::test::make_random_batches(
+               model::offset(0), batch_count, false)) {
+            _batches.push_back(std::move(b));
+        }
+    }
+
+    ~batch_cache_bench() { _cache.stop().get(); }
+
+    void put_all(storage::batch_cache_index& index) {
+        for (const auto& b : _batches) {
+            index.put(b);
+        }
+    }
+
+    storage::batch_cache _cache;
+    storage::batch_cache_index _index;
+    std::vector<model::record_batch> _batches;
+};
+
+PERF_TEST_F(batch_cache_bench, put) {
+    storage::batch_cache_index index(_cache);
+    perf_tests::start_measuring_time();
+    put_all(index);
+    perf_tests::stop_measuring_time();
+    _cache.clear();
+}
+
+PERF_TEST_F(batch_cache_bench, get) {
+    if (_index.empty()) {
+        put_all(_index);
+    }
+    perf_tests::start_measuring_time();
+    for (const auto& b : _batches) {
+        perf_tests::do_not_optimize(_index.get(b.base_offset()));
+    }
+    perf_tests::stop_measuring_time();
+}
+
+PERF_TEST_F(batch_cache_bench, reclaim) {
+    storage::batch_cache_index index(_cache);
+    put_all(index);
+    perf_tests::start_measuring_time();
+    _cache.clear();
+    perf_tests::stop_measuring_time();
+}
+
+struct segment_index_bench {
+    static constexpr size_t batch_count = 100'000;
+
+    segment_index_bench()
+      : _name(ssx::sformat(
+        "storage_bench.index_{}.base_index",
+        random_generators::gen_alphanum_string(7)))
+      , _index(
+          _name,
+          ss::open_file_dma(
+            _name,
+            ss::open_flags::create | ss::open_flags::rw
+              | ss::open_flags::truncate)
+            .get0(),
+          model::offset(0),
+          storage::segment_index::default_data_buffer_step) {
+        model::record_batch_header hdr;
+        hdr.size_bytes = 4_KiB;
+        hdr.last_offset_delta = 9;
+        size_t pos = 0;
+        for (size_t i = 0; i < batch_count; ++i) {
+            hdr.base_offset = model::offset(i * 10);
+            hdr.first_timestamp = model::timestamp(i);
+            hdr.max_timestamp = model::timestamp(i);
+            _index.maybe_track(hdr, pos);
+            pos += hdr.size_bytes;
+        }
+    }
+
+    ~segment_index_bench() {
+        _index.close().get();
+        ss::remove_file(_name).get();
+    }
+
+    ss::sstring _name;
+    storage::segment_index _index;
+};
+
+PERF_TEST_F(segment_index_bench, find_nearest_offset) {
+    auto o = model::offset(
+      random_generators::get_int<int64_t>(batch_count * 10 - 1));
+    perf_tests::start_measuring_time();
+    perf_tests::do_not_optimize(_index.find_nearest(o));
+    perf_tests::stop_measuring_time();
+}
+
+PERF_TEST_F(segment_index_bench, find_nearest_timestamp) {
+    auto t = model::timestamp(
+      random_generators::get_int<int64_t>(batch_count - 1));
+    perf_tests::start_measuring_time();
+    perf_tests::do_not_optimize(_index.find_nearest(t));
+    perf_tests::stop_measuring_time();
+}
+
+struct kvstore_bench {
+    kvstore_bench()
+      : _dir(ssx::sformat(
+        "storage_bench.kvstore_{}", random_generators::gen_alphanum_string(7)))
+      , _value(bytes_to_iobuf(random_generators::get_bytes(100))) {
+        config::shard_local_cfg().get("disable_metrics").set_value(true);
+        _kvs = std::make_unique<storage::kvstore>(storage::kvstore_config(
+          8_MiB,
+          std::chrono::milliseconds(10),
+          _dir,
+          storage::debug_sanitize_files::no));
+        _kvs->start().get();
+    }
+
+    ~kvstore_bench() { _kvs->stop().get(); }
+
+    ss::sstring _dir;
+    iobuf _value;
+    std::unique_ptr<storage::kvstore> _kvs;
+};
+
+PERF_TEST_F(kvstore_bench, put) {
+    auto key = random_generators::get_bytes(16);
+    auto value = _value.copy();
+    perf_tests::start_measuring_time();
+    return _kvs
+      ->put(storage::kvstore::key_space::testing, key, std::move(value))
+      .finally([] { perf_tests::stop_measuring_time(); });
+}
@@ -15,6 +15,8 @@
 #include "model/timestamp.h"
 #include "random/generators.h"
 #include "storage/batch_cache.h"
+#include "storage/fs_utils.h"
+#include "storage/key_lookup.h"
 #include "storage/log_manager.h"
 #include "storage/record_batch_builder.h"
 #include "storage/segment_utils.h"
@@ -22,6 +24,7 @@
 #include "storage/tests/utils/disk_log_builder.h"
 #include "storage/tests/utils/random_batch.h"
 #include "storage/types.h"
+#include "test_utils/async.h"
 
 #include <seastar/core/semaphore.hh>
 #include <seastar/core/sleep.hh>
@@ -32,6 +35,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <limits>
 #include <numeric>
 
 void validate_offsets(
@@ -334,6 +338,46 @@ struct custom_ts_batch_generator {
     }
     model::timestamp _start_ts;
 };
+FIXTURE_TEST(coalesced_append_of_many_batches, storage_test_fixture) {
+    storage::log_manager mgr = make_log_manager();
+    info("Configuration: {}", mgr.config());
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+    auto ntp = model::ntp("default", "test", 0);
+    auto log
+      = mgr.manage(storage::ntp_config(ntp, mgr.config().base_dir)).get0();
+    ss::circular_buffer<model::record_batch> batches;
+    size_t expected_bytes = 0;
+    while (batches.size() < 200) {
+        auto more = storage::test::make_random_batches(model::offset(0), 10);
+        for (auto& b : more) {
+            expected_bytes += b.size_bytes();
+            batches.push_back(std::move(b));
+        }
+    }
+    const auto count = batches.size();
+    storage::log_append_config append_cfg{
+      storage::log_append_config::fsync::yes,
+      ss::default_priority_class(),
+      model::no_timeout};
+    auto res = model::make_memory_record_batch_reader(std::move(batches))
+                 .for_each_ref(
+                   log.make_appender(append_cfg), append_cfg.timeout)
+                 .get0();
+    BOOST_REQUIRE_EQUAL(res.byte_size, expected_bytes);
+
+    auto read_batches = read_and_validate_all_batches(log);
+    BOOST_REQUIRE_EQUAL(read_batches.size(), count);
+    BOOST_REQUIRE_EQUAL(res.last_offset, read_batches.back().last_offset());
+    // every batch is found through the index of the coalesced ranges
+    for (size_t i = 0; i < read_batches.size(); i += 17) {
+        auto range = read_range_to_vector(
+          log, read_batches[i].base_offset(), read_batches[i].last_offset());
+        BOOST_REQUIRE_EQUAL(range.size(), 1);
+        BOOST_REQUIRE_EQUAL(
+          range.front().header().crc, read_batches[i].header().crc);
+    }
+}
+
 FIXTURE_TEST(test_time_based_eviction, storage_test_fixture) {
     auto cfg = default_log_config(test_dir);
     cfg.max_segment_size = 10;
@@ -752,6 +796,38 @@ FIXTURE_TEST(test_compation_preserve_state, storage_test_fixture) {
     BOOST_REQUIRE_EQUAL(log.offsets().dirty_offset, model::offset(2));
 }
 
+FIXTURE_TEST(test_compaction_scheduler_drains_backlog, storage_test_fixture) {
+    auto cfg = default_log_config(test_dir);
+    cfg.stype = storage::log_config::storage_type::disk;
+    auto ntp = model::ntp("default", "test", 0);
+    using overrides_t = storage::ntp_config::default_overrides;
+    overrides_t ov;
+    ov.cleanup_policy_bitflags = model::cleanup_policy_bitflags::compaction;
+
+    storage::disk_log_builder builder(cfg);
+    builder | storage::start(ntp) | storage::add_segment(0)
+      | storage::add_random_batch(0, 10);
+    builder.stop().get();
+
+    // the recovered segment is closed and has not been compacted yet. the
+    // housekeeping rounds of the manager hand it to the scheduler of the
+    // manager
+    cfg.compaction_interval = 10ms;
+    storage::log_manager mgr = make_log_manager(cfg);
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+    storage::ntp_config ntp_cfg(
+      ntp, mgr.config().base_dir, std::make_unique<overrides_t>(ov));
+    auto log = mgr.manage(std::move(ntp_cfg)).get0();
+
+    tests::cooperative_spin_wait_with_timeout(10s, [&mgr, log]() mutable {
+        return mgr.compactions().compactions() > 0
+               && log.compaction_backlog() == 0;
+    }).get();
+
+    BOOST_REQUIRE_EQUAL(log.compaction_backlog(), 0u);
+    BOOST_REQUIRE_EQUAL(mgr.compactions().backlog(), 0u);
+}
+
 void append_single_record_batch(
   storage::log log,
   int cnt,
@@ -918,6 +994,226 @@ FIXTURE_TEST(compacted_log_truncation, storage_test_fixture) {
     }
 }
 
+FIXTURE_TEST(compaction_deduplicates_keys_across_segments, storage_test_fixture) {
+    auto cfg = default_log_config(test_dir);
+    cfg.stype = storage::log_config::storage_type::disk;
+    cfg.compaction_key_map_memory = 1_MiB;
+    storage::ntp_config::default_overrides overrides;
+    overrides.cleanup_policy_bitflags
+      = model::cleanup_policy_bitflags::compaction;
+    ss::abort_source as;
+    storage::log_manager mgr = make_log_manager(cfg);
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+    auto ntp = model::ntp("default", "test", 0);
+    auto log = mgr
+                 .manage(storage::ntp_config(
+                   ntp,
+                   mgr.config().base_dir,
+                   std::make_unique<storage::ntp_config::default_overrides>(
+                     overrides)))
+                 .get0();
+    auto append = [&log](int keys, model::term_id term) {
+        for (int i = 0; i < keys; ++i) {
+            storage::record_batch_builder builder(
+              model::record_batch_type(1), model::offset(0));
+            builder.add_raw_kv(
+              bytes_to_iobuf(bytes(ssx::sformat("key-{}", i).c_str())),
+              bytes_to_iobuf(bytes(ssx::sformat("v-{}", term).c_str())));
+            auto batch = std::move(builder).build();
+            batch.set_term(term);
+            storage::log_append_config cfg{
+              .should_fsync = storage::log_append_config::fsync::no,
+              .io_priority = ss::default_priority_class(),
+              .timeout = model::no_timeout,
+            };
+            model::make_memory_record_batch_reader({std::move(batch)})
+              .for_each_ref(log.make_appender(cfg), cfg.timeout)
+              .get0();
+        }
+        log.flush().get0();
+    };
+    // every term rolls a segment and all the segments have the same keys.
+    // segments of different terms are never merged by adjacent compaction
+    for (auto term = 1; term <= 3; ++term) {
+        append(5, model::term_id(term));
+    }
+    append(1, model::term_id(4));
+    BOOST_REQUIRE_EQUAL(log.segment_count(), 4u);
+
+    storage::compaction_config c_cfg(
+      model::timestamp::min(), std::nullopt, ss::default_priority_class(), as);
+    // self compact the three closed segments, then deduplicate them
+    for (auto i = 0; i < 4; ++i) {
+        log.compact(c_cfg).get0();
+    }
+
+    // the newest closed segment is untouched and the older ones only retain
+    // their last record, which keeps their offset range
+    auto batches = read_and_validate_all_batches(log);
+    std::vector<model::offset> offsets;
+    for (auto& b : batches) {
+        offsets.push_back(b.base_offset());
+    }
+    std::vector<model::offset> expected;
+    for (auto o : {4, 9, 10, 11, 12, 13, 14, 15}) {
+        expected.emplace_back(o);
+    }
+    BOOST_REQUIRE_EQUAL_COLLECTIONS(
+      offsets.begin(), offsets.end(), expected.begin(), expected.end());
+}
+
+FIXTURE_TEST(lookup_key_probes_segments_newest_first, storage_test_fixture) {
+    auto cfg = default_log_config(test_dir);
+    cfg.stype = storage::log_config::storage_type::disk;
+    storage::ntp_config::default_overrides overrides;
+    overrides.cleanup_policy_bitflags
+      = model::cleanup_policy_bitflags::compaction;
+    storage::log_manager mgr = make_log_manager(cfg);
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+    auto ntp = model::ntp("default", "test", 0);
+    auto log = mgr
+                 .manage(storage::ntp_config(
+                   ntp,
+                   mgr.config().base_dir,
+                   std::make_unique<storage::ntp_config::default_overrides>(
+                     overrides)))
+                 .get0();
+    auto append = [&log](
+                    ss::sstring key,
+                    std::optional<ss::sstring> value,
+                    model::term_id term) {
+        storage::record_batch_builder builder(
+          model::record_batch_type(1), model::offset(0));
+        std::optional<iobuf> v;
+        if (value) {
+            v = bytes_to_iobuf(bytes(value->c_str()));
+        }
+        builder.add_raw_kv(bytes_to_iobuf(bytes(key.c_str())), std::move(v));
+        auto batch = std::move(builder).build();
+        batch.set_term(term);
+        storage::log_append_config cfg{
+          .should_fsync = storage::log_append_config::fsync::no,
+          .io_priority = ss::default_priority_class(),
+          .timeout = model::no_timeout,
+        };
+        model::make_memory_record_batch_reader({std::move(batch)})
+          .for_each_ref(log.make_appender(cfg), cfg.timeout)
+          .get0();
+    };
+    // every term rolls a segment: [0, 4], [5, 9], [10, 14] are sealed and
+    // the active segment holds offsets 15 and 16
+    for (auto term = 1; term <= 3; ++term) {
+        for (auto i = 0; i < 5; ++i) {
+            append(
+              ssx::sformat("key-{}", i),
+              ssx::sformat("v-{}", term),
+              model::term_id(term));
+        }
+    }
+    append("key-0", "v-4", model::term_id(4));
+    append("key-1", std::nullopt, model::term_id(4));
+    log.flush().get0();
+    BOOST_REQUIRE_EQUAL(log.segment_count(), 4u);
+
+    auto lookup = [&log](ss::sstring key, model::offset max_offset) {
+        return storage::lookup_key(
+                 log,
+                 storage::key_lookup_config{
+                   .key = bytes(key.c_str()),
+                   .max_offset = max_offset,
+                   .prio = ss::default_priority_class()})
+          .get0();
+    };
+    auto value = [](const storage::key_lookup_result& r) {
+        return iobuf_to_bytes(*r.value);
+    };
+    const auto last = log.offsets().dirty_offset;
+
+    // served by the active segment
+    auto r = lookup("key-0", last);
+    BOOST_REQUIRE(r);
+    BOOST_REQUIRE_EQUAL(r->offset, model::offset(15));
+    BOOST_REQUIRE_EQUAL(value(*r), bytes("v-4"));
+    r = lookup("key-1", last);
+    BOOST_REQUIRE(r);
+    BOOST_REQUIRE_EQUAL(r->offset, model::offset(16));
+    BOOST_REQUIRE(!r->value);
+
+    // served by the compacted index of the newest sealed segment
+    r = lookup("key-3", last);
+    BOOST_REQUIRE(r);
+    BOOST_REQUIRE_EQUAL(r->offset, model::offset(13));
+    BOOST_REQUIRE_EQUAL(value(*r), bytes("v-3"));
+
+    // the bound hides the newer segments
+    r = lookup("key-3", model::offset(9));
+    BOOST_REQUIRE(r);
+    BOOST_REQUIRE_EQUAL(r->offset, model::offset(8));
+    BOOST_REQUIRE_EQUAL(value(*r), bytes("v-2"));
+
+    BOOST_REQUIRE(!lookup("key-5", last));
+}
+
+FIXTURE_TEST(compaction_removes_expired_tombstones, storage_test_fixture) {
+    auto cfg = default_log_config(test_dir);
+    cfg.stype = storage::log_config::storage_type::disk;
+    storage::ntp_config::default_overrides overrides;
+    overrides.cleanup_policy_bitflags
+      = model::cleanup_policy_bitflags::compaction;
+    ss::abort_source as;
+    storage::log_manager mgr = make_log_manager(cfg);
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+    auto ntp = model::ntp("default", "test", 0);
+    auto log = mgr
+                 .manage(storage::ntp_config(
+                   ntp,
+                   mgr.config().base_dir,
+                   std::make_unique<storage::ntp_config::default_overrides>(
+                     overrides)))
+                 .get0();
+    auto append = [&log](
+                    ss::sstring key,
+                    std::optional<ss::sstring> value,
+                    model::term_id term) {
+        storage::record_batch_builder builder(
+          model::record_batch_type(1), model::offset(0));
+        std::optional<iobuf> v;
+        if (value) {
+            v = bytes_to_iobuf(bytes(value->c_str()));
+        }
+        builder.add_raw_kv(bytes_to_iobuf(bytes(key.c_str())), std::move(v));
+        auto batch = std::move(builder).build();
+        batch.set_term(term);
+        storage::log_append_config cfg{
+          .should_fsync = storage::log_append_config::fsync::no,
+          .io_priority = ss::default_priority_class(),
+          .timeout = model::no_timeout,
+        };
+        model::make_memory_record_batch_reader({std::move(batch)})
+          .for_each_ref(log.make_appender(cfg), cfg.timeout)
+          .get0();
+    };
+    append("a", "v", model::term_id(1));
+    append("a", std::nullopt, model::term_id(1));
+    append("b", "v", model::term_id(1));
+    log.flush().get0();
+    // rolls the segment
+    append("c", "v", model::term_id(2));
+
+    // every record is older than the eviction time
+    storage::compaction_config c_cfg(
+      model::timestamp(model::timestamp::now().value() + 60000),
+      std::nullopt,
+      ss::default_priority_class(),
+      as);
+    log.compact(c_cfg).get0();
+
+    auto batches = read_and_validate_all_batches(log);
+    BOOST_REQUIRE_EQUAL(batches.size(), 2u);
+    BOOST_REQUIRE_EQUAL(batches[0].base_offset(), model::offset(2));
+    BOOST_REQUIRE_EQUAL(batches[1].base_offset(), model::offset(3));
+}
+
 FIXTURE_TEST(
   check_segment_roll_after_compacted_log_truncate, storage_test_fixture) {
     auto cfg = default_log_config(test_dir);
@@ -1343,3 +1639,486 @@ FIXTURE_TEST(many_segment_locking, storage_test_fixture) {
         BOOST_REQUIRE(locks.size() == segments.size());
     }
 }
+
+FIXTURE_TEST(reuse_cached_reader_for_tailing_reads, storage_test_fixture) {
+    auto cfg = default_log_config(test_dir);
+    // force reads from disk
+    cfg.cache = storage::with_cache::no;
+    storage::log_manager mgr = make_log_manager(cfg);
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+    auto ntp = model::ntp("default", "test", 0);
+    auto log
+      = mgr.manage(storage::ntp_config(ntp, mgr.config().base_dir)).get0();
+    auto disk_log = get_disk_log(log);
+
+    append_random_batches(log, 10);
+    log.flush().get0();
+    auto first = read_and_validate_all_batches(log);
+    BOOST_REQUIRE(!first.empty());
+    auto hits = disk_log->get_probe().readers_cache_hits();
+
+    // the next read starts where the previous one stopped
+    append_random_batches(log, 10);
+    log.flush().get0();
+    auto lstats = log.offsets();
+    storage::log_reader_config rcfg(
+      first.back().last_offset() + model::offset(1),
+      lstats.committed_offset,
+      ss::default_priority_class());
+    auto reader = log.make_reader(rcfg).get0();
+    auto second = model::consume_reader_to_memory(
+                    std::move(reader), model::no_timeout)
+                    .get0();
+    BOOST_REQUIRE_EQUAL(disk_log->get_probe().readers_cache_hits(), hits + 1);
+    BOOST_REQUIRE(!second.empty());
+    BOOST_REQUIRE_EQUAL(
+      second.front().base_offset(),
+      first.back().last_offset() + model::offset(1));
+    BOOST_REQUIRE_EQUAL(second.back().last_offset(), lstats.committed_offset);
+
+    // cached readers must not block truncation
+    log
+      .truncate(storage::truncate_config(
+        second.front().base_offset(), ss::default_priority_class()))
+      .get0();
+    auto all = read_and_validate_all_batches(log);
+    BOOST_REQUIRE_EQUAL(all.size(), first.size());
+}
+
+FIXTURE_TEST(lazy_index_hydration_on_recovery, storage_test_fixture) {
+    auto cfg = default_log_config(test_dir);
+    cfg.stype = storage::log_config::storage_type::disk;
+    cfg.cache = storage::with_cache::no;
+    auto ntp = model::ntp("default", "test", 0);
+    std::vector<model::record_batch_header> written;
+    {
+        storage::log_manager mgr = make_log_manager(cfg);
+        auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+        auto log
+          = mgr.manage(storage::ntp_config(ntp, mgr.config().base_dir)).get0();
+        auto disk_log = get_disk_log(log);
+        for (int i = 0; i < 3; ++i) {
+            append_random_batches(log, 10);
+            log.flush().get0();
+            disk_log->force_roll(ss::default_priority_class()).get0();
+        }
+        append_random_batches(log, 10);
+        log.flush().get0();
+        for (auto& b : read_and_validate_all_batches(log)) {
+            written.push_back(b.header());
+        }
+    }
+
+    cfg.lazy_index = storage::lazy_index_hydration::yes;
+    storage::log_manager mgr = make_log_manager(cfg);
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+    auto log
+      = mgr.manage(storage::ntp_config(ntp, mgr.config().base_dir)).get0();
+    auto disk_log = get_disk_log(log);
+    BOOST_REQUIRE_GT(disk_log->segment_count(), 1);
+
+    // only the index headers of older segments are loaded
+    auto& segs = disk_log->segments();
+    BOOST_REQUIRE(!segs.front()->index().is_hydrated());
+    BOOST_REQUIRE(segs.back()->index().is_hydrated());
+    BOOST_REQUIRE_EQUAL(
+      log.offsets().committed_offset, written.back().last_offset());
+
+    // the first read of a segment loads its index
+    auto read = read_and_validate_all_batches(log);
+    BOOST_REQUIRE_EQUAL(read.size(), written.size());
+    for (size_t i = 0; i < read.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(read[i].header(), written[i]);
+    }
+    for (auto& s : segs) {
+        BOOST_REQUIRE(s->index().is_hydrated());
+    }
+}
+
+FIXTURE_TEST(uncached_reads_bypass_batch_cache, storage_test_fixture) {
+    auto cfg = default_log_config(test_dir);
+    cfg.stype = storage::log_config::storage_type::disk;
+    cfg.cache = storage::with_cache::yes;
+    auto ntp = model::ntp("default", "test", 0);
+    std::vector<model::record_batch_header> written;
+    {
+        storage::log_manager mgr = make_log_manager(cfg);
+        auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+        auto log
+          = mgr.manage(storage::ntp_config(ntp, mgr.config().base_dir)).get0();
+        append_random_batches(log, 10);
+        log.flush().get0();
+        for (auto& b : read_and_validate_all_batches(log)) {
+            written.push_back(b.header());
+        }
+    }
+
+    // a fresh manager starts with an empty batch cache
+    storage::log_manager mgr = make_log_manager(cfg);
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+    auto log
+      = mgr.manage(storage::ntp_config(ntp, mgr.config().base_dir)).get0();
+    auto disk_log = get_disk_log(log);
+
+    auto lstats = log.offsets();
+    storage::log_reader_config rcfg(
+      lstats.start_offset,
+      lstats.committed_offset,
+      ss::default_priority_class());
+    rcfg.skip_batch_cache = true;
+    auto reader = log.make_reader(rcfg).get0();
+    auto read = reader.consume(batch_validating_consumer{}, model::no_timeout)
+                  .get0();
+    BOOST_REQUIRE_EQUAL(read.size(), written.size());
+    size_t bytes = 0;
+    for (size_t i = 0; i < read.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(read[i].header(), written[i]);
+        bytes += read[i].size_bytes();
+    }
+    BOOST_REQUIRE_EQUAL(disk_log->get_probe().uncached_bytes_read(), bytes);
+
+    // nothing was inserted into the cache
+    auto cached = disk_log->segments().front()->cache_get(
+      lstats.start_offset,
+      lstats.committed_offset,
+      std::nullopt,
+      std::nullopt,
+      std::numeric_limits<size_t>::max(),
+      true);
+    BOOST_REQUIRE(cached.batches.empty());
+}
+
+namespace {
+struct collecting_sink final : storage::passthrough_sink {
+    void append(const model::record_batch_header& h, iobuf records) final {
+        headers.push_back(h);
+        records_bytes.push_back(records.size_bytes());
+    }
+    std::vector<model::record_batch_header> headers;
+    std::vector<size_t> records_bytes;
+};
+} // namespace
+
+FIXTURE_TEST(passthrough_reads_hand_batches_to_sink, storage_test_fixture) {
+    auto cfg = default_log_config(test_dir);
+    cfg.stype = storage::log_config::storage_type::disk;
+    cfg.cache = storage::with_cache::yes;
+    auto ntp = model::ntp("default", "test", 0);
+    std::vector<model::record_batch_header> written;
+    {
+        storage::log_manager mgr = make_log_manager(cfg);
+        auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+        auto log
+          = mgr.manage(storage::ntp_config(ntp, mgr.config().base_dir)).get0();
+        append_random_batches(log, 10);
+        log.flush().get0();
+        for (auto& b : read_and_validate_all_batches(log)) {
+            written.push_back(b.header());
+        }
+    }
+
+    // a fresh manager starts with an empty batch cache
+    storage::log_manager mgr = make_log_manager(cfg);
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+    auto log
+      = mgr.manage(storage::ntp_config(ntp, mgr.config().base_dir)).get0();
+    auto disk_log = get_disk_log(log);
+    auto lstats = log.offsets();
+
+    auto read_passthrough = [&log, &lstats](collecting_sink& sink) {
+        storage::log_reader_config rcfg(
+          lstats.start_offset,
+          lstats.committed_offset,
+          ss::default_priority_class());
+        rcfg.passthrough = &sink;
+        auto reader = log.make_reader(rcfg).get0();
+        auto read = model::consume_reader_to_memory(
+                      std::move(reader), model::no_timeout)
+                      .get0();
+        // the batches went to the sink
+        BOOST_REQUIRE(read.empty());
+    };
+    auto require_written = [&written](const collecting_sink& sink) {
+        BOOST_REQUIRE_EQUAL(sink.headers.size(), written.size());
+        for (size_t i = 0; i < written.size(); ++i) {
+            BOOST_REQUIRE_EQUAL(sink.headers[i], written[i]);
+            BOOST_REQUIRE_EQUAL(
+              sink.records_bytes[i],
+              written[i].size_bytes - model::packed_record_batch_header_size);
+        }
+    };
+
+    collecting_sink cold;
+    read_passthrough(cold);
+    require_written(cold);
+    size_t bytes = 0;
+    for (const auto& h : written) {
+        bytes += h.size_bytes;
+    }
+    BOOST_REQUIRE_EQUAL(disk_log->get_probe().passthrough_bytes_read(), bytes);
+
+    // nothing was inserted into the cache
+    auto cached = disk_log->segments().front()->cache_get(
+      lstats.start_offset,
+      lstats.committed_offset,
+      std::nullopt,
+      std::nullopt,
+      std::numeric_limits<size_t>::max(),
+      true);
+    BOOST_REQUIRE(cached.batches.empty());
+
+    // batches in the cache are handed over from it
+    read_and_validate_all_batches(log);
+    collecting_sink warm;
+    read_passthrough(warm);
+    require_written(warm);
+    BOOST_REQUIRE_EQUAL(disk_log->get_probe().passthrough_bytes_read(), bytes);
+}
+
+/// damages the file at \p path without changing its size
+static void flip_byte(const ss::sstring& path, size_t pos) {
+    auto f = ss::open_file_dma(path, ss::open_flags::ro).get0();
+    auto size = f.size().get0();
+    auto in = ss::make_file_input_stream(f, 0);
+    auto data = iobuf_to_bytes(read_iobuf_exactly(in, size).get0());
+    in.close().get();
+    f.close().get();
+    data[pos] ^= 0xff;
+    auto out = ss::make_file_output_stream(
+                 ss::open_file_dma(path, ss::open_flags::wo).get0())
+                 .get0();
+    out.write(reinterpret_cast<const char*>(data.data()), data.size()).get();
+    out.close().get();
+}
+
+FIXTURE_TEST(sealed_segments_skip_recovery, storage_test_fixture) {
+    auto cfg = default_log_config(test_dir);
+    cfg.stype = storage::log_config::storage_type::disk;
+    cfg.cache = storage::with_cache::no;
+    auto ntp = model::ntp("default", "test", 0);
+    std::vector<model::record_batch_header> written;
+    ss::sstring tail_path;
+    {
+        storage::log_manager mgr = make_log_manager(cfg);
+        auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+        auto log
+          = mgr.manage(storage::ntp_config(ntp, mgr.config().base_dir)).get0();
+        auto disk_log = get_disk_log(log);
+        append_random_batches(log, 10);
+        log.flush().get0();
+        disk_log->force_roll(ss::default_priority_class()).get0();
+        append_random_batches(log, 10);
+        log.flush().get0();
+        for (auto& b : read_and_validate_all_batches(log)) {
+            written.push_back(b.header());
+        }
+        tail_path = disk_log->segments().back()->reader().filename();
+    }
+    {
+        // closed cleanly: the tail is trusted as is, replay would reset it
+        storage::log_manager mgr = make_log_manager(cfg);
+        auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+        auto log
+          = mgr.manage(storage::ntp_config(ntp, mgr.config().base_dir)).get0();
+        auto& tail = get_disk_log(log)->segments().back();
+        BOOST_REQUIRE(tail->index().is_sealed());
+        BOOST_REQUIRE_EQUAL(
+          log.offsets().committed_offset, written.back().last_offset());
+        auto read = read_and_validate_all_batches(log);
+        BOOST_REQUIRE_EQUAL(read.size(), written.size());
+    }
+
+    // a sealed tail that no longer has its recorded size is recovered
+    auto f = ss::open_file_dma(tail_path, ss::open_flags::rw).get0();
+    auto size = f.size().get0();
+    f.truncate(size - 1).get();
+    f.close().get();
+
+    storage::log_manager mgr = make_log_manager(cfg);
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+    auto log
+      = mgr.manage(storage::ntp_config(ntp, mgr.config().base_dir)).get0();
+    auto& tail = get_disk_log(log)->segments().back();
+    BOOST_REQUIRE(!tail->index().is_sealed());
+    written.pop_back();
+    BOOST_REQUIRE_EQUAL(
+      log.offsets().committed_offset, written.back().last_offset());
+    auto read = read_and_validate_all_batches(log);
+    BOOST_REQUIRE_EQUAL(read.size(), written.size());
+}
+
+FIXTURE_TEST(adopt_sealed_segment_of_other_log, storage_test_fixture) {
+    auto cfg = default_log_config(test_dir);
+    cfg.max_segment_size = 10 * 1024;
+    storage::log_manager mgr = make_log_manager(std::move(cfg));
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+    auto source = mgr
+                    .manage(storage::ntp_config(
+                      model::ntp("default", "test", 0), mgr.config().base_dir))
+                    .get0();
+    auto target_cfg = storage::ntp_config(
+      model::ntp("default", "test", 1), mgr.config().base_dir);
+    auto target = mgr.manage(target_cfg).get0();
+    append_random_batches(
+      source,
+      50,
+      model::term_id(1),
+      []() {
+          ss::circular_buffer<model::record_batch> batches;
+          batches.push_back(
+            storage::test::make_random_batch(model::offset(0), 1, true));
+          return batches;
+      },
+      storage::log_append_config::fsync::no,
+      false);
+    source.flush().get0();
+    BOOST_REQUIRE_GT(source.segment_count(), 1);
+
+    // only whole segments can be shipped
+    BOOST_REQUIRE(!source.get_sealed_segment(model::offset(1)).get0());
+
+    auto segment = source.get_sealed_segment(model::offset(0)).get0();
+    BOOST_REQUIRE(segment);
+    BOOST_REQUIRE_EQUAL(segment->base_offset, model::offset(0));
+    BOOST_REQUIRE_EQUAL(segment->term, model::term_id(1));
+
+    auto path = storage::segment_path::make_segment_path(
+      target_cfg,
+      segment->base_offset,
+      segment->term,
+      storage::record_version_type::v1);
+    auto index_path = std::filesystem::path(path).replace_extension(
+      "base_index");
+    std::filesystem::copy_file(segment->data_path, path);
+    std::filesystem::copy_file(segment->index_path, index_path);
+
+    // a segment damaged in transfer is not adopted, the last byte belongs to
+    // the records of the last batch so only the batch crc can tell
+    auto size = std::filesystem::file_size(path);
+    flip_byte(ss::sstring(path.string()), size - 1);
+    BOOST_REQUIRE_THROW(
+      target.adopt_segment(segment->base_offset, segment->term).get0(),
+      std::runtime_error);
+    BOOST_REQUIRE_EQUAL(target.segment_count(), 0);
+    BOOST_REQUIRE(!std::filesystem::exists(path));
+    BOOST_REQUIRE(!std::filesystem::exists(index_path));
+
+    std::filesystem::copy_file(segment->data_path, path);
+    std::filesystem::copy_file(segment->index_path, index_path);
+    target.adopt_segment(segment->base_offset, segment->term).get0();
+
+    BOOST_REQUIRE_EQUAL(target.segment_count(), 1);
+    BOOST_REQUIRE_EQUAL(target.offsets().dirty_offset, segment->dirty_offset);
+    auto batches = read_and_validate_all_batches(target);
+    BOOST_REQUIRE_EQUAL(batches.back().last_offset(), segment->dirty_offset);
+
+    // only the segment that follows the log end can be adopted
+    BOOST_REQUIRE_THROW(
+      target.adopt_segment(model::offset(1000), model::term_id(1)).get0(),
+      std::runtime_error);
+}
+
+FIXTURE_TEST(adaptive_segment_size_rolls_idle_segments, storage_test_fixture) {
+    auto cfg = default_log_config(test_dir);
+    cfg.stype = storage::log_config::storage_type::disk;
+    cfg.segment_target_lifetime = 500ms;
+    cfg.min_adaptive_segment_size = 1;
+    storage::log_manager mgr = make_log_manager(cfg);
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+    auto ntp = model::ntp("default", "test", 0);
+    auto log
+      = mgr.manage(storage::ntp_config(ntp, mgr.config().base_dir)).get0();
+    auto disk_log = get_disk_log(log);
+
+    append_random_batches(log, 1);
+    BOOST_REQUIRE_EQUAL(disk_log->segment_count(), 1);
+
+    // far from the configured size, the segment is rolled once it is older
+    // than its target lifetime
+    ss::sleep(600ms).get();
+    append_random_batches(log, 1);
+    BOOST_REQUIRE_EQUAL(disk_log->segment_count(), 2);
+    auto read = read_and_validate_all_batches(log);
+    BOOST_REQUIRE(!read.empty());
+}
+
+FIXTURE_TEST(find_term_end_follows_rolls_and_truncation, storage_test_fixture) {
+    storage::log_manager mgr = make_log_manager();
+    info("Configuration: {}", mgr.config());
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+    auto ntp = model::ntp("default", "test", 0);
+    auto log
+      = mgr.manage(storage::ntp_config(ntp, mgr.config().base_dir)).get0();
+    BOOST_REQUIRE(!log.find_term_end(model::term_id(1)));
+
+    // terms 1, 3 and 5, the terms in between have no data
+    std::vector<model::offset> term_starts;
+    model::offset next_offset{0};
+    for (auto t : {1, 3, 5}) {
+        term_starts.push_back(next_offset);
+        for (auto h : append_random_batches(log, 2, model::term_id(t))) {
+            next_offset += h.last_offset_delta + 1;
+        }
+    }
+    log.flush().get();
+
+    auto check = [&log](int term, int found, model::offset end) {
+        auto r = log.find_term_end(model::term_id(term));
+        BOOST_REQUIRE(r);
+        BOOST_REQUIRE_EQUAL(r->term, model::term_id(found));
+        BOOST_REQUIRE_EQUAL(r->end_offset, end);
+    };
+    check(0, 0, term_starts[0]);
+    check(1, 1, term_starts[1]);
+    check(2, 1, term_starts[1]);
+    check(3, 3, term_starts[2]);
+    check(4, 3, term_starts[2]);
+    check(5, 5, next_offset);
+    check(7, 5, next_offset);
+
+    // the term of the truncated suffix is forgotten
+    log
+      .truncate(
+        storage::truncate_config(term_starts[2], ss::default_priority_class()))
+      .get();
+    check(5, 3, term_starts[2]);
+    check(2, 1, term_starts[1]);
+}
+
+FIXTURE_TEST(sealed_segments_are_verified, storage_test_fixture) {
+    auto cfg = default_log_config(test_dir);
+    cfg.stype = storage::log_config::storage_type::disk;
+    cfg.cache = storage::with_cache::no;
+    auto ntp = model::ntp("default", "test", 0);
+    std::vector<model::record_batch_header> written;
+    ss::sstring tail_path;
+    {
+        storage::log_manager mgr = make_log_manager(cfg);
+        auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+        auto log
+          = mgr.manage(storage::ntp_config(ntp, mgr.config().base_dir)).get0();
+        append_random_batches(log, 10);
+        log.flush().get0();
+        for (auto& b : read_and_validate_all_batches(log)) {
+            written.push_back(b.header());
+        }
+        tail_path = get_disk_log(log)->segments().back()->reader().filename();
+    }
+
+    // the tail keeps its recorded size but the header crc of its last batch
+    // is damaged
+    auto size = std::filesystem::file_size(tail_path.c_str());
+    flip_byte(tail_path, size - written.back().size_bytes);
+
+    storage::log_manager mgr = make_log_manager(cfg);
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+    auto log
+      = mgr.manage(storage::ntp_config(ntp, mgr.config().base_dir)).get0();
+    auto& tail = get_disk_log(log)->segments().back();
+    BOOST_REQUIRE(!tail->index().is_sealed());
+    written.pop_back();
+    BOOST_REQUIRE_EQUAL(
+      log.offsets().committed_offset, written.back().last_offset());
+    auto read = read_and_validate_all_batches(log);
+    BOOST_REQUIRE_EQUAL(read.size(), written.size());
+}
@@ -114,3 +114,49 @@ FIXTURE_TEST(timequery_single_value, log_builder_fixture) {
     BOOST_TEST(res->offset == model::offset(0));
     b | stop();
 }
+
+FIXTURE_TEST(timequery_non_monotonic_segments, log_builder_fixture) {
+    using namespace storage; // NOLINT
+
+    b | start();
+
+    // seg0: [0..9], seg1: [10..19], seg2: [20..29], seg3: [30..39] with
+    // timestamp = offset, except for a single batch in seg1 at offset 15 with
+    // a timestamp far ahead of the following segments, and seg3 which is
+    // shifted to [300..309]
+    for (auto base = 0; base < 40; base += 10) {
+        b | add_segment(base);
+        for (auto offset = base; offset < base + 10; ++offset) {
+            auto ts = offset;
+            if (offset == 15) {
+                ts = 1000;
+            } else if (base == 30) {
+                ts = offset + 270;
+            }
+            auto batch = test::make_random_batch(
+              model::offset(offset), 1, false);
+            batch.header().first_timestamp = model::timestamp(ts);
+            batch.header().max_timestamp = model::timestamp(ts);
+            b | add_batch(std::move(batch));
+        }
+    }
+
+    // the first batch at or past the timestamp is in seg1 even though the max
+    // timestamp of seg2 is lower than the needle
+    auto log = b.get_log();
+    storage::timequery_config config(
+      model::timestamp(100),
+      log.offsets().dirty_offset,
+      ss::default_priority_class());
+
+    auto res = log.timequery(config).get0();
+    BOOST_TEST(res);
+    BOOST_TEST(res->time == model::timestamp(1000));
+    BOOST_TEST(res->offset == model::offset(15));
+
+    // nothing at or past a timestamp newer than every batch
+    config.time = model::timestamp(1001);
+    BOOST_TEST(!log.timequery(config).get0());
+
+    b | stop();
+}
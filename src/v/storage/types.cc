@@ -31,7 +31,8 @@ std::ostream& operator<<(std::ostream& o, const log_reader_config& cfg) {
     } else {
         o << "nullopt";
     }
-    return o << "}";
+    return o << ", skip_batch_cache:" << cfg.skip_batch_cache
+             << ", passthrough:" << (cfg.passthrough != nullptr) << "}";
 }
 
 std::ostream& operator<<(std::ostream& o, const append_result& a) {
@@ -46,21 +47,43 @@ std::ostream& operator<<(std::ostream& o, const append_result& a) {
 std::ostream& operator<<(std::ostream& o, const timequery_result& a) {
     return o << "{offset:" << a.offset << ", time:" << a.time << "}";
 }
+std::ostream& operator<<(std::ostream& o, const term_end& a) {
+    return o << "{term:" << a.term << ", end_offset:" << a.end_offset << "}";
+}
 std::ostream& operator<<(std::ostream& o, const timequery_config& a) {
     return o << "{max_offset:" << a.max_offset << ", time:" << a.time << "}";
 }
+std::ostream& operator<<(std::ostream& o, const recovery_timings& t) {
+    return o << "{queued:" << t.queued.count() << "ms, open:" << t.open.count()
+             << "ms, index:" << t.index.count()
+             << "ms, replay:" << t.replay.count() << "ms}";
+}
+
+std::ostream& operator<<(std::ostream& o, batch_cache_policy p) {
+    switch (p) {
+    case batch_cache_policy::lru:
+        return o << "lru";
+    case batch_cache_policy::segmented_lru:
+        return o << "segmented_lru";
+    }
+    return o << "unknown";
+}
 
 std::ostream&
 operator<<(std::ostream& o, const ntp_config::default_overrides& v) {
     fmt::print(
       o,
       "{{compaction_strategy: {}, cleanup_policy_bitflags: {}, segment_size: "
-      "{}, retention_bytes: {}, retention_time_ms: {}}}",
+      "{}, retention_bytes: {}, retention_time_ms: {}, adaptive_read_ahead: "
+      "{}, cache_policy: {}, storage_mode: {}}}",
       v.compaction_strategy,
       v.cleanup_policy_bitflags,
       v.segment_size,
       v.retention_bytes,
-      v.retention_time);
+      v.retention_time,
+      v.adaptive_read_ahead,
+      v.cache_policy,
+      v.storage_mode);
 
     return o;
 }
@@ -85,6 +108,20 @@ std::ostream& operator<<(std::ostream& o, const truncate_prefix_config& cfg) {
     return o;
 }
 
+std::ostream& operator<<(std::ostream& o, const sealed_segment& s) {
+    fmt::print(
+      o,
+      "{{base_offset:{}, dirty_offset:{}, term:{}, data_path:{}, "
+      "index_path:{}, compacted_index_path:{}}}",
+      s.base_offset,
+      s.dirty_offset,
+      s.term,
+      s.data_path,
+      s.index_path,
+      s.compacted_index_path);
+    return o;
+}
+
 std::ostream& operator<<(std::ostream& o, const offset_stats& s) {
     fmt::print(
       o,
@@ -103,10 +140,13 @@ std::ostream& operator<<(std::ostream& o, const offset_stats& s) {
 std::ostream& operator<<(std::ostream& o, const compaction_config& c) {
     fmt::print(
       o,
-      "{{evicition_time:{}, max_bytes:{}, should_sanitize:{}}}",
+      "{{evicition_time:{}, max_bytes:{}, should_sanitize:{}, "
+      "tombstone_eviction_time:{}, skip_compaction:{}}}",
       c.eviction_time,
       c.max_bytes.value_or(-1),
-      c.sanitize);
+      c.sanitize,
+      c.tombstone_eviction_time.value_or(model::timestamp::missing()),
+      c.skip_compaction);
     return o;
 }
 
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include "bytes/iobuf.h"
 #include "model/fundamental.h"
 #include "model/limits.h"
 #include "model/record.h"
@@ -24,6 +25,8 @@
 #include <seastar/core/rwlock.hh>
 #include <seastar/util/bool_class.hh>
 
+#include <chrono>
+#include <filesystem>
 #include <optional>
 #include <vector>
 
@@ -37,6 +40,21 @@ constexpr model::record_batch_type ghost_record_batch_type
 
 using log_clock = ss::lowres_clock;
 using debug_sanitize_files = ss::bool_class<struct debug_sanitize_files_tag>;
+using lazy_index_hydration = ss::bool_class<struct lazy_index_hydration_tag>;
+
+/// time spent in each phase of recovering a log on startup
+struct recovery_timings {
+    // waiting for other logs of the shard to finish recovery
+    std::chrono::milliseconds queued{0};
+    // opening segment files
+    std::chrono::milliseconds open{0};
+    // loading segment indexes (only headers with lazy index hydration)
+    std::chrono::milliseconds index{0};
+    // replaying segments without a valid index
+    std::chrono::milliseconds replay{0};
+
+    friend std::ostream& operator<<(std::ostream&, const recovery_timings&);
+};
 
 class snapshotable_stm {
 public:
@@ -163,6 +181,18 @@ struct timequery_result {
     friend std::ostream& operator<<(std::ostream& o, const timequery_result&);
 };
 
+/// where a term ends in the log, see log::find_term_end()
+struct term_end {
+    /// the latest term of the log up to the requested one, the requested
+    /// one if the log has no older term
+    model::term_id term;
+    /// the first offset of the following term, the end of the log when the
+    /// term is the latest one
+    model::offset end_offset;
+
+    friend std::ostream& operator<<(std::ostream& o, const term_end&);
+};
+
 struct truncate_config {
     truncate_config(model::offset o, ss::io_priority_class p)
       : base_offset(o)
@@ -192,6 +222,41 @@ struct truncate_prefix_config {
     operator<<(std::ostream&, const truncate_prefix_config&);
 };
 
+/**
+ * Files of a closed segment whose index was sealed. Such a segment can be
+ * copied verbatim to another replica of the log and adopted there without
+ * replaying its batches. The segment can not be truncated, compacted or
+ * removed while the lock is held.
+ */
+struct sealed_segment {
+    model::offset base_offset;
+    model::offset dirty_offset;
+    model::term_id term;
+    std::filesystem::path data_path;
+    std::filesystem::path index_path;
+    std::optional<std::filesystem::path> compacted_index_path;
+    ss::rwlock::holder lock;
+
+    friend std::ostream& operator<<(std::ostream&, const sealed_segment&);
+};
+
+/**
+ * Receives the batches of a passthrough read, see
+ * log_reader_config::passthrough. The records are handed over as the slices
+ * of the segment read buffers that hold them, in offset order.
+ */
+class passthrough_sink {
+public:
+    passthrough_sink() noexcept = default;
+    passthrough_sink(const passthrough_sink&) = delete;
+    passthrough_sink& operator=(const passthrough_sink&) = delete;
+    passthrough_sink(passthrough_sink&&) = delete;
+    passthrough_sink& operator=(passthrough_sink&&) = delete;
+    virtual ~passthrough_sink() noexcept = default;
+
+    virtual void append(const model::record_batch_header&, iobuf records) = 0;
+};
+
 /**
  * Log reader configuration.
  *
@@ -234,9 +299,17 @@ struct log_reader_config {
 
     // allow cache reads, but skip lru promotion and cache insertions on miss.
     // use this option when a reader shouldn't perturb the cache (e.g.
-    // historical read-once workloads like compaction).
+    // historical read-once workloads like compaction, or cold fetches). the
+    // batches read from disk are handed out as slices of the file read
+    // buffers, they are not copied.
     bool skip_batch_cache{false};
 
+    // hand the batches read to the sink instead of returning them. batches
+    // read from disk are validated at the header level only and are neither
+    // materialized nor inserted into the cache, the reader returns no batches.
+    // the sink must outlive the read, it is not kept by a reused reader.
+    passthrough_sink* passthrough{nullptr};
+
     log_reader_config(
       model::offset start_offset,
       model::offset max_offset,
@@ -299,6 +372,11 @@ struct compaction_config {
     debug_sanitize_files sanitize;
     // abort source for compaction task
     ss::abort_source* asrc;
+    // remove tombstones older than this. only set for the oldest segment of
+    // a log, which cannot have an older record that the tombstone shadows
+    std::optional<model::timestamp> tombstone_eviction_time;
+    // only collect, compaction needs room for the segments it rewrites
+    bool skip_compaction{false};
 
     friend std::ostream& operator<<(std::ostream&, const compaction_config&);
 };
@@ -0,0 +1,257 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "syschecks/disk_calibration.h"
+
+#include "bytes/iobuf.h"
+#include "random/generators.h"
+#include "syschecks/syschecks.h"
+#include "units.h"
+#include "utils/file_io.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/file.hh>
+#include <seastar/core/loop.hh>
+#include <seastar/core/seastar.hh>
+
+#include <boost/range/irange.hpp>
+#include <fmt/ostream.h>
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+namespace syschecks {
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr size_t test_file_size = 256_MiB;
+constexpr size_t sequential_block = 1_MiB;
+constexpr size_t random_block = 4_KiB;
+constexpr unsigned sequential_depth = 4;
+constexpr unsigned random_depth = 64;
+constexpr auto phase_duration = std::chrono::seconds(2);
+// bound of the write of the whole file on slow disks
+constexpr auto layout_duration = std::chrono::seconds(30);
+
+struct io_load {
+    size_t block;
+    unsigned depth;
+    bool random;
+    bool write;
+    clock_type::duration duration{phase_duration};
+};
+
+struct io_result {
+    size_t ops{0};
+    size_t bytes{0};
+    clock_type::duration elapsed{0};
+
+    uint64_t bandwidth() const { return per_second(bytes); }
+    uint64_t iops() const { return per_second(ops); }
+
+private:
+    uint64_t per_second(size_t n) const {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    elapsed)
+                    .count();
+        return us > 0 ? n * 1'000'000 / us : 0;
+    }
+};
+
+class disk_benchmark {
+public:
+    disk_benchmark(ss::file f, size_t size)
+      : _file(std::move(f))
+      , _size(size) {}
+
+    ss::future<io_result> run(io_load load) {
+        _next = 0;
+        _result = io_result{};
+        const auto start = clock_type::now();
+        const auto deadline = start + load.duration;
+        co_await ss::parallel_for_each(
+          boost::irange(0u, load.depth),
+          [this, load, deadline](unsigned) { return worker(load, deadline); });
+        _result.elapsed = clock_type::now() - start;
+        co_return _result;
+    }
+
+    ss::future<> close() { return _file.close(); }
+
+private:
+    ss::future<> worker(io_load load, clock_type::time_point deadline) {
+        auto buf = ss::allocate_aligned_buffer<char>(
+          load.block, _file.disk_write_dma_alignment());
+        std::memset(buf.get(), 0x5a, load.block);
+        const uint64_t blocks = _size / load.block;
+        while (clock_type::now() < deadline) {
+            uint64_t pos = 0;
+            if (load.random) {
+                pos = random_generators::get_int<uint64_t>(blocks - 1)
+                      * load.block;
+            } else if (_next + load.block <= _size) {
+                pos = _next;
+                _next += load.block;
+            } else {
+                break;
+            }
+            if (load.write) {
+                co_await _file.dma_write(pos, buf.get(), load.block);
+            } else {
+                co_await _file.dma_read(pos, buf.get(), load.block);
+            }
+            ++_result.ops;
+            _result.bytes += load.block;
+        }
+    }
+
+    ss::file _file;
+    size_t _size;
+    uint64_t _next{0};
+    io_result _result;
+};
+
+ss::future<disk_profile> measure(const ss::sstring& dir, uint64_t device) {
+    auto path = (std::filesystem::path(dir) / ".disk_calibration").string();
+    auto f = co_await ss::open_file_dma(
+      path,
+      ss::open_flags::rw | ss::open_flags::create | ss::open_flags::truncate);
+    disk_benchmark bench(f, test_file_size);
+    disk_profile profile{.device = device};
+    std::exception_ptr ex;
+    try {
+        co_await f.allocate(0, test_file_size);
+        // the sequential write lays out the whole file, the reads of
+        // unwritten extents wouldn't reach the device
+        auto r = co_await bench.run(
+          {.block = sequential_block,
+           .depth = sequential_depth,
+           .write = true,
+           .duration = layout_duration});
+        co_await f.flush();
+        profile.write_bandwidth = r.bandwidth();
+        r = co_await bench.run(
+          {.block = sequential_block, .depth = sequential_depth});
+        profile.read_bandwidth = r.bandwidth();
+        r = co_await bench.run(
+          {.block = random_block, .depth = random_depth, .random = true});
+        profile.read_iops = r.iops();
+        r = co_await bench.run(
+          {.block = random_block,
+           .depth = random_depth,
+           .random = true,
+           .write = true});
+        co_await f.flush();
+        profile.write_iops = r.iops();
+        r = co_await bench.run(
+          {.block = random_block, .depth = 1, .random = true});
+        if (r.ops > 0) {
+            profile.read_latency
+              = std::chrono::duration_cast<std::chrono::microseconds>(
+                r.elapsed / r.ops);
+        }
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    co_await bench.close();
+    co_await ss::remove_file(path);
+    if (ex) {
+        std::rethrow_exception(ex);
+    }
+    co_return profile;
+}
+
+} // namespace
+
+std::ostream& operator<<(std::ostream& o, const disk_profile& p) {
+    fmt::print(
+      o,
+      "{{read_bandwidth: {}, write_bandwidth: {}, read_iops: {}, "
+      "write_iops: {}, read_latency: {}us}}",
+      p.read_bandwidth,
+      p.write_bandwidth,
+      p.read_iops,
+      p.write_iops,
+      p.read_latency.count());
+    return o;
+}
+
+ss::sstring
+to_io_properties(const ss::sstring& mountpoint, const disk_profile& p) {
+    YAML::Emitter out;
+    out << YAML::BeginMap;
+    out << YAML::Key << "disks" << YAML::Value << YAML::BeginSeq;
+    out << YAML::BeginMap;
+    out << YAML::Key << "mountpoint" << YAML::Value << mountpoint.c_str();
+    out << YAML::Key << "read_iops" << YAML::Value << p.read_iops;
+    out << YAML::Key << "read_bandwidth" << YAML::Value << p.read_bandwidth;
+    out << YAML::Key << "write_iops" << YAML::Value << p.write_iops;
+    out << YAML::Key << "write_bandwidth" << YAML::Value << p.write_bandwidth;
+    out << YAML::EndMap;
+    out << YAML::EndSeq;
+    // seastar only reads the disks
+    out << YAML::Key << "redpanda_calibration" << YAML::Value;
+    out << YAML::BeginMap;
+    out << YAML::Key << "device" << YAML::Value << p.device;
+    out << YAML::Key << "read_latency_us" << YAML::Value
+        << static_cast<uint64_t>(p.read_latency.count());
+    out << YAML::EndMap;
+    out << YAML::EndMap;
+    return ss::sstring(out.c_str(), out.size());
+}
+
+std::optional<disk_profile> from_io_properties(std::string_view s) {
+    try {
+        auto doc = YAML::Load(std::string(s));
+        auto disk = doc["disks"][0];
+        auto calibration = doc["redpanda_calibration"];
+        if (!disk || !calibration) {
+            return std::nullopt;
+        }
+        return disk_profile{
+          .device = calibration["device"].as<uint64_t>(),
+          .read_bandwidth = disk["read_bandwidth"].as<uint64_t>(),
+          .write_bandwidth = disk["write_bandwidth"].as<uint64_t>(),
+          .read_iops = disk["read_iops"].as<uint64_t>(),
+          .write_iops = disk["write_iops"].as<uint64_t>(),
+          .read_latency = std::chrono::microseconds(
+            calibration["read_latency_us"].as<uint64_t>()),
+        };
+    } catch (const YAML::Exception&) {
+        return std::nullopt;
+    }
+}
+
+ss::future<disk_profile> calibrate_disk(ss::sstring dir) {
+    const auto path = std::filesystem::path(dir) / disk_profile_file;
+    const auto device = (co_await ss::file_stat(dir)).device_id;
+    if (co_await ss::file_exists(path.string())) {
+        auto buf = co_await read_fully_tmpbuf(path);
+        auto cached = from_io_properties({buf.get(), buf.size()});
+        if (cached && cached->device == device) {
+            co_return *cached;
+        }
+        vlog(checklog.info, "Disk of {} changed, measuring it again", dir);
+    }
+    vlog(checklog.info, "Measuring the disk of {}", dir);
+    auto profile = co_await measure(dir, device);
+    auto yaml = to_io_properties(dir, profile);
+    iobuf out;
+    out.append(yaml.data(), yaml.size());
+    co_await write_fully(path, std::move(out));
+    vlog(checklog.info, "Disk of {}: {}, saved in {}", dir, profile, path);
+    co_return profile;
+}
+
+} // namespace syschecks
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "seastarx.h"
+
+#include <seastar/core/future.hh>
+#include <seastar/core/sstring.hh>
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <string_view>
+
+namespace syschecks {
+
+/// Measured capacity of the disk of a directory
+struct disk_profile {
+    /// device of the directory when it was measured
+    uint64_t device{0};
+    /// sequential, bytes per second
+    uint64_t read_bandwidth{0};
+    uint64_t write_bandwidth{0};
+    /// random 4KiB requests per second, at a deep queue
+    uint64_t read_iops{0};
+    uint64_t write_iops{0};
+    /// random 4KiB read, one request at a time
+    std::chrono::microseconds read_latency{0};
+
+    friend std::ostream& operator<<(std::ostream&, const disk_profile&);
+};
+
+/// Name of the calibration of the disk in its directory
+inline constexpr std::string_view disk_profile_file = "io-properties.yaml";
+
+/**
+ * The profile of the disk of \p dir, measured once per disk.
+ *
+ * The profile is cached in \p dir as a seastar io properties file, which
+ * configures the I/O queues of the reactor when it is passed with
+ * --io-properties-file. A cache written for another device, e.g. the
+ * directory is now a mount of a new disk, is measured again.
+ *
+ * The measure writes and reads a file of up to 256MiB in \p dir for a few
+ * seconds, it is meant to run before the services are started.
+ */
+ss::future<disk_profile> calibrate_disk(ss::sstring dir);
+
+/// \brief the seastar io properties of \p mountpoint
+ss::sstring
+to_io_properties(const ss::sstring& mountpoint, const disk_profile&);
+
+/// \brief profile from its io properties, nullopt when malformed
+std::optional<disk_profile> from_io_properties(std::string_view);
+
+} // namespace syschecks
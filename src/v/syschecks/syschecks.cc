@@ -37,6 +37,14 @@ ss::future<> disk(const ss::sstring& path) {
     });
 }
 
+ss::future<disk_space_info> disk_space(const ss::sstring& path) {
+    auto st = co_await ss::engine().statvfs(path);
+    co_return disk_space_info{
+      .free_bytes = st.f_bavail * st.f_frsize,
+      .total_bytes = st.f_blocks * st.f_frsize,
+    };
+}
+
 void memory(bool ignore) {
     static const uint64_t kMinMemory = 1 << 30;
     const auto shard_mem = ss::memory::stats().total_memory();
@@ -44,6 +44,15 @@ static inline void cpu() {
 
 ss::future<> disk(const ss::sstring& path);
 
+struct disk_space_info {
+    // available to unprivileged users, i.e. without the reserved blocks
+    uint64_t free_bytes{0};
+    uint64_t total_bytes{0};
+};
+
+/// \brief free and total space of the filesystem of \p path
+ss::future<disk_space_info> disk_space(const ss::sstring& path);
+
 void memory(bool ignore);
 
 ss::future<> systemd_raw_message(ss::sstring out);
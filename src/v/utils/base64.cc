@@ -13,6 +13,7 @@
 #include "vassert.h"
 
 #include <seastar/core/sstring.hh>
+#include <seastar/core/temporary_buffer.hh>
 
 #include <libbase64.h>
 
@@ -42,6 +43,28 @@ bytes base64_to_bytes(std::string_view input) {
     return output;
 }
 
+iobuf base64_to_iobuf(std::string_view input) {
+    // decoded into the buffer handed to the iobuf, without an extra copy
+    ss::temporary_buffer<char> output(input.size());
+    size_t output_len; // NOLINT
+    int ret = base64_decode(
+      input.data(), input.size(), output.get_write(), &output_len, 0);
+    if (unlikely(!ret)) {
+        throw base64_decoder_exception();
+    }
+    vassert(
+      output_len <= input.size(),
+      "base64 decode overflow: {} > {}",
+      output_len,
+      input.size());
+    output.trim(output_len);
+    iobuf buf;
+    if (output_len > 0) {
+        buf.append(std::move(output));
+    }
+    return buf;
+}
+
 ss::sstring bytes_to_base64(bytes_view input) {
     const size_t output_capacity = encode_capacity(input.size());
     ss::sstring output(ss::sstring::initialized_later{}, output_capacity);
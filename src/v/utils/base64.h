@@ -27,4 +27,5 @@ bytes base64_to_bytes(std::string_view);
 ss::sstring bytes_to_base64(bytes_view);
 
 // base64 <-> iobuf
+iobuf base64_to_iobuf(std::string_view);
 ss::sstring iobuf_to_base64(const iobuf&);
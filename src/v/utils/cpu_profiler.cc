@@ -0,0 +1,155 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "utils/cpu_profiler.h"
+
+#include <fmt/format.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <system_error>
+#include <utility>
+
+namespace {
+
+// the profiler of the thread the signal is raised on
+thread_local cpu_profiler* active_profiler = nullptr;
+
+[[noreturn]] void throw_errno(const char* what) {
+    throw std::system_error(errno, std::system_category(), what);
+}
+
+ss::sstring format_frame(const ss::frame& f) {
+    if (f.so == nullptr || f.so->name.empty()) {
+        return fmt::format("0x{:x}", f.addr);
+    }
+    return fmt::format("{}+0x{:x}", f.so->name, f.addr);
+}
+
+} // namespace
+
+void cpu_profiler::on_signal(int, siginfo_t*, void*) {
+    if (auto* p = active_profiler; p != nullptr) {
+        p->take_sample();
+    }
+}
+
+void cpu_profiler::take_sample() noexcept {
+    const auto i = _count.load(std::memory_order_relaxed);
+    if (i >= _samples.size()) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    auto& s = _samples[i];
+    s.depth = 0;
+    ss::backtrace([&s](ss::frame f) {
+        if (s.depth < max_frames) {
+            s.frames[s.depth++] = f;
+        }
+    });
+    // the sample is complete before results() can see it
+    std::atomic_signal_fence(std::memory_order_release);
+    _count.store(i + 1, std::memory_order_relaxed);
+}
+
+void cpu_profiler::start(std::chrono::microseconds interval) {
+    stop();
+    static std::once_flag installed;
+    std::call_once(installed, [] {
+        struct sigaction sa {};
+        sa.sa_sigaction = &cpu_profiler::on_signal;
+        sa.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        if (::sigaction(SIGPROF, &sa, nullptr) != 0) {
+            throw_errno("sigaction");
+        }
+    });
+    // the unwinder may allocate on its first use, not in the handler then
+    ss::backtrace([](ss::frame) {});
+
+    _samples.assign(max_samples, sample{});
+    _count.store(0);
+    _dropped.store(0);
+
+    sigevent sev{};
+    sev.sigev_notify = SIGEV_THREAD_ID;
+    sev.sigev_signo = SIGPROF;
+    sev._sigev_un._tid = static_cast<pid_t>(::syscall(SYS_gettid));
+    if (::timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &_timer) != 0) {
+        throw_errno("timer_create");
+    }
+    // the reactor threads block the signals they don't handle
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGPROF);
+    ::pthread_sigmask(SIG_UNBLOCK, &set, nullptr);
+
+    active_profiler = this;
+    _running = true;
+    const auto us = std::max<int64_t>(interval.count(), 1000);
+    itimerspec its{};
+    its.it_interval.tv_sec = us / 1'000'000;
+    its.it_interval.tv_nsec = (us % 1'000'000) * 1000;
+    its.it_value = its.it_interval;
+    if (::timer_settime(_timer, 0, &its, nullptr) != 0) {
+        stop();
+        throw_errno("timer_settime");
+    }
+}
+
+void cpu_profiler::stop() noexcept {
+    if (!_running) {
+        return;
+    }
+    ::timer_delete(_timer);
+    active_profiler = nullptr;
+    _running = false;
+}
+
+cpu_profiler::profile cpu_profiler::results() const {
+    const auto n = std::min(
+      _count.load(std::memory_order_relaxed), _samples.size());
+    std::atomic_signal_fence(std::memory_order_acquire);
+
+    // distinct stacks by the object and the address of their frames
+    using key = std::vector<std::pair<const void*, uintptr_t>>;
+    std::map<key, std::pair<size_t, uint64_t>> stacks;
+    for (size_t i = 0; i < n; ++i) {
+        const auto& s = _samples[i];
+        key k;
+        k.reserve(s.depth);
+        for (size_t f = 0; f < s.depth; ++f) {
+            k.emplace_back(s.frames[f].so, s.frames[f].addr);
+        }
+        auto [it, inserted] = stacks.try_emplace(std::move(k), i, 0);
+        ++it->second.second;
+    }
+
+    profile p{
+      .samples = n, .dropped = _dropped.load(std::memory_order_relaxed)};
+    p.stacks.reserve(stacks.size());
+    for (const auto& [k, first_and_count] : stacks) {
+        const auto& s = _samples[first_and_count.first];
+        stack st{.count = first_and_count.second};
+        st.frames.reserve(s.depth);
+        for (size_t f = 0; f < s.depth; ++f) {
+            st.frames.push_back(format_frame(s.frames[f]));
+        }
+        p.stacks.push_back(std::move(st));
+    }
+    std::sort(
+      p.stacks.begin(), p.stacks.end(), [](const stack& a, const stack& b) {
+          return a.count > b.count;
+      });
+    return p;
+}
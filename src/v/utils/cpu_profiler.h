@@ -0,0 +1,91 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+#include "seastarx.h"
+
+#include <seastar/core/sstring.hh>
+#include <seastar/util/backtrace.hh>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+/**
+ * Sampling CPU profiler of a shard.
+ *
+ * While running, a timer on the CPU time of the shard thread raises SIGPROF
+ * on the thread every interval of CPU time and the handler saves the
+ * backtrace of the interrupted code, the way the seastar stall detector does.
+ * The samples go to a buffer allocated on start, samples past its capacity
+ * are counted as dropped. Nothing is resolved to symbols on the node: the
+ * frames are addresses in their object, for addr2line or seastar-addr2line
+ * with the debug symbols of the build.
+ */
+class cpu_profiler {
+public:
+    static constexpr size_t max_samples = 8192;
+    static constexpr size_t max_frames = 32;
+    static constexpr auto default_interval = std::chrono::milliseconds(10);
+
+    /// A stack sampled count times, frames from the innermost
+    struct stack {
+        std::vector<ss::sstring> frames;
+        uint64_t count{0};
+    };
+
+    struct profile {
+        uint64_t samples{0};
+        uint64_t dropped{0};
+        /// the most sampled first
+        std::vector<stack> stacks;
+    };
+
+    cpu_profiler() noexcept = default;
+    cpu_profiler(cpu_profiler&&) = delete;
+    cpu_profiler& operator=(cpu_profiler&&) = delete;
+    cpu_profiler(const cpu_profiler&) = delete;
+    cpu_profiler& operator=(const cpu_profiler&) = delete;
+    ~cpu_profiler() noexcept { stop(); }
+
+    /// \brief starts sampling the shard every \p interval of CPU time,
+    /// dropping the samples of the previous run. Must run on the shard
+    void start(std::chrono::microseconds interval);
+    void stop() noexcept;
+    bool running() const { return _running; }
+
+    /// \brief the samples since the last start, aggregated by stack
+    profile results() const;
+
+private:
+    struct sample {
+        std::array<ss::frame, max_frames> frames;
+        size_t depth{0};
+    };
+
+    static void on_signal(int, siginfo_t*, void*);
+    void take_sample() noexcept;
+
+    std::vector<sample> _samples;
+    std::atomic<size_t> _count{0};
+    std::atomic<uint64_t> _dropped{0};
+    timer_t _timer{};
+    bool _running{false};
+};
+
+inline cpu_profiler& shard_cpu_profiler() {
+    static thread_local cpu_profiler profiler;
+    return profiler;
+}
@@ -136,6 +136,7 @@ public:
     double stddev() const;
     double mean() const;
     size_t memory_size() const;
+    uint64_t sample_count() const { return _sample_count; }
     ss::metrics::histogram seastar_histogram_logform() const;
 
     std::unique_ptr<measurement> auto_measure();
@@ -0,0 +1,60 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "utils/stage_latency.h"
+
+#include "prometheus/prometheus_sanitize.h"
+
+#include <seastar/core/metrics.hh>
+
+#include <vector>
+
+std::string_view to_string(request_stage s) {
+    switch (s) {
+    case request_stage::decode:
+        return "decode";
+    case request_stage::quota_throttle:
+        return "quota_throttle";
+    case request_stage::cross_shard:
+        return "cross_shard";
+    case request_stage::replicate_batch:
+        return "replicate_batch";
+    case request_stage::local_append:
+        return "local_append";
+    case request_stage::local_flush:
+        return "local_flush";
+    case request_stage::follower_ack:
+        return "follower_ack";
+    case request_stage::response_write:
+        return "response_write";
+    }
+    return "unknown";
+}
+
+void stage_latency::do_record(request_stage s, clock_type::duration d) {
+    _stages[static_cast<size_t>(s)].record(
+      std::chrono::duration_cast<std::chrono::microseconds>(d).count());
+}
+
+void stage_latency::setup_metrics() {
+    namespace sm = ss::metrics;
+    auto stage = sm::label("stage");
+    std::vector<sm::metric_definition> defs;
+    defs.reserve(request_stages);
+    for (size_t i = 0; i < request_stages; ++i) {
+        auto s = static_cast<request_stage>(i);
+        defs.push_back(sm::make_histogram(
+          "latency_us",
+          [this, s] { return histogram(s).seastar_histogram_logform(); },
+          sm::description(
+            "Sampled latency of a stage of produce and fetch requests"),
+          {stage(ss::sstring(to_string(s)))}));
+    }
+    _metrics.add_group(prometheus_sanitize::metrics_name("request_stage"), defs);
+}
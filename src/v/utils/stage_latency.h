@@ -0,0 +1,128 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+#include "seastarx.h"
+#include "utils/hdr_hist.h"
+
+#include <seastar/core/metrics_registration.hh>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+/// Stages a produce or a fetch goes through, from the kafka layer down to
+/// raft and the disk. Listed in the order a produce crosses them.
+enum class request_stage : uint8_t {
+    /// decoding the request from its wire format
+    decode = 0,
+    /// waiting for the client quotas and the connection memory
+    quota_throttle,
+    /// hand off of the batches to the home shard of their partitions
+    cross_shard,
+    /// waiting in the raft replicate batcher for the next flush
+    replicate_batch,
+    /// leader append to its local log
+    local_append,
+    /// leader fdatasync of its local log
+    local_flush,
+    /// round trip of the append entries request to a follower
+    follower_ack,
+    /// writing the response to the connection
+    response_write,
+};
+
+inline constexpr size_t request_stages = 8;
+
+std::string_view to_string(request_stage);
+
+/**
+ * Shard wide latency histograms of the request stages.
+ *
+ * The kafka, raft and storage layers record into the same set, so a p99 of
+ * the produce latency can be broken down into where the time went. Only one
+ * in sample_period measurements of every stage is taken, a stage that is not
+ * sampled costs a counter increment.
+ *
+ * The histograms are recorded into through stage_latencies() from every
+ * layer. The application exports them on each shard with setup_metrics()
+ * and withdraws them with stop() on shutdown, recording keeps working
+ * either way.
+ */
+class stage_latency {
+public:
+    using clock_type = std::chrono::steady_clock;
+    static constexpr uint32_t sample_period = 16;
+
+    stage_latency() noexcept = default;
+    stage_latency(stage_latency&&) = delete;
+    stage_latency& operator=(stage_latency&&) = delete;
+    stage_latency(const stage_latency&) = delete;
+    stage_latency& operator=(const stage_latency&) = delete;
+    ~stage_latency() noexcept = default;
+
+    /// \brief start of a stage, engaged if this measurement is sampled.
+    /// the time point is valid on all shards, a stage may end on another one
+    std::optional<clock_type::time_point> start() {
+        if (!sample()) {
+            return std::nullopt;
+        }
+        return clock_type::now();
+    }
+
+    /// \brief end of a stage started with start(), no-op if not sampled
+    void record(
+      request_stage s, std::optional<clock_type::time_point> started) {
+        if (started) {
+            do_record(s, clock_type::now() - *started);
+        }
+    }
+
+    /// \brief samples a stage timed by the caller
+    void record(request_stage s, clock_type::duration d) {
+        if (sample()) {
+            do_record(s, d);
+        }
+    }
+
+    const hdr_hist& histogram(request_stage s) const {
+        return _stages[static_cast<size_t>(s)];
+    }
+
+    /// \brief exports a request_stage_latency_us histogram per stage
+    void setup_metrics();
+    void stop() { _metrics.clear(); }
+
+private:
+    bool sample() { return _calls++ % sample_period == 0; }
+    void do_record(request_stage s, clock_type::duration d);
+
+    // low precision, a minute at most: there are 8 of them per shard
+    std::array<hdr_hist, request_stages> _stages{
+      hdr_hist{60000000, 1, 2},
+      hdr_hist{60000000, 1, 2},
+      hdr_hist{60000000, 1, 2},
+      hdr_hist{60000000, 1, 2},
+      hdr_hist{60000000, 1, 2},
+      hdr_hist{60000000, 1, 2},
+      hdr_hist{60000000, 1, 2},
+      hdr_hist{60000000, 1, 2}};
+    uint32_t _calls{0};
+    ss::metrics::metric_groups _metrics;
+};
+
+/// \brief the histograms of the shard
+inline stage_latency& stage_latencies() {
+    static thread_local stage_latency latencies;
+    return latencies;
+}
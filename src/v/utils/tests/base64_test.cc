@@ -31,6 +31,7 @@ BOOST_AUTO_TEST_CASE(iobuf_type) {
         BOOST_REQUIRE_EQUAL(encoded, expected);
         auto decoded = base64_to_bytes(encoded);
         BOOST_REQUIRE_EQUAL(decoded, iobuf_to_bytes(input));
+        BOOST_REQUIRE(base64_to_iobuf(encoded) == input);
     };
 
     encdec(bytes_to_iobuf(""), "");
@@ -47,4 +48,7 @@ BOOST_AUTO_TEST_CASE(iobuf_type) {
     auto encoded = iobuf_to_base64(buf);
     auto decoded = base64_to_bytes(encoded);
     BOOST_REQUIRE_EQUAL(decoded, iobuf_to_bytes(buf));
+    BOOST_REQUIRE(base64_to_iobuf(encoded) == buf);
+
+    BOOST_REQUIRE_THROW(base64_to_iobuf("YQ=?"), base64_decoder_exception);
 }
@@ -0,0 +1,59 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "utils/cpu_profiler.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+#include <chrono>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+[[gnu::noinline]] uint64_t spin(std::chrono::milliseconds d) {
+    volatile uint64_t x = 0;
+    auto deadline = std::chrono::steady_clock::now() + d;
+    while (std::chrono::steady_clock::now() < deadline) {
+        x = x + 1;
+    }
+    return x;
+}
+
+} // namespace
+
+SEASTAR_THREAD_TEST_CASE(test_cpu_profiler_samples_busy_shard) {
+    cpu_profiler profiler;
+    BOOST_REQUIRE(profiler.results().stacks.empty());
+
+    profiler.start(1ms);
+    BOOST_REQUIRE(profiler.running());
+    spin(200ms);
+    profiler.stop();
+    BOOST_REQUIRE(!profiler.running());
+
+    auto p = profiler.results();
+    BOOST_REQUIRE_GT(p.samples, 0);
+    BOOST_REQUIRE(!p.stacks.empty());
+    uint64_t total = 0;
+    for (size_t i = 0; i < p.stacks.size(); ++i) {
+        BOOST_REQUIRE(!p.stacks[i].frames.empty());
+        BOOST_REQUIRE_LE(p.stacks[i].frames.size(), cpu_profiler::max_frames);
+        if (i > 0) {
+            BOOST_REQUIRE_LE(p.stacks[i].count, p.stacks[i - 1].count);
+        }
+        total += p.stacks[i].count;
+    }
+    BOOST_REQUIRE_EQUAL(total, p.samples);
+
+    // a restart drops the previous samples
+    profiler.start(1s);
+    profiler.stop();
+    BOOST_REQUIRE_EQUAL(profiler.results().samples, 0);
+}
@@ -0,0 +1,51 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "utils/stage_latency.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+#include <chrono>
+
+using namespace std::chrono_literals;
+
+SEASTAR_THREAD_TEST_CASE(test_stage_latency_sampling) {
+    stage_latency latencies;
+    const auto calls = 10 * stage_latency::sample_period;
+    for (uint32_t i = 0; i < calls; ++i) {
+        latencies.record(request_stage::local_flush, 2ms);
+    }
+    const auto& h = latencies.histogram(request_stage::local_flush);
+    BOOST_REQUIRE_EQUAL(h.sample_count(), 10);
+    BOOST_REQUIRE_GE(h.get_value_at(50), 1950);
+    BOOST_REQUIRE_LE(h.get_value_at(50), 2050);
+    BOOST_REQUIRE_EQUAL(
+      latencies.histogram(request_stage::decode).sample_count(), 0);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_stage_latency_start) {
+    stage_latency latencies;
+    size_t engaged = 0;
+    for (uint32_t i = 0; i < 2 * stage_latency::sample_period; ++i) {
+        auto started = latencies.start();
+        if (started) {
+            ++engaged;
+        }
+        latencies.record(request_stage::decode, started);
+    }
+    BOOST_REQUIRE_EQUAL(engaged, 2);
+    BOOST_REQUIRE_EQUAL(
+      latencies.histogram(request_stage::decode).sample_count(), 2);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_stage_names) {
+    for (size_t i = 0; i < request_stages; ++i) {
+        BOOST_REQUIRE_NE(to_string(static_cast<request_stage>(i)), "unknown");
+    }
+}
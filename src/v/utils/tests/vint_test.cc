@@ -17,7 +17,9 @@
 #include <array>
 #include <cstdint>
 #include <iostream>
+#include <limits>
 #include <random>
+#include <vector>
 
 namespace {
 
@@ -36,3 +38,38 @@ void check_roundtrip_sweep(int64_t count) {
 SEASTAR_THREAD_TEST_CASE(sanity_signed_sweep_64) {
     check_roundtrip_sweep(100000000);
 }
+
+SEASTAR_THREAD_TEST_CASE(contiguous_deserialize_matches_byte_by_byte) {
+    std::vector<int64_t> values = {
+      0,
+      1,
+      -1,
+      63,
+      -64,
+      64,
+      std::numeric_limits<int32_t>::max(),
+      std::numeric_limits<int32_t>::min(),
+      std::numeric_limits<int64_t>::max(),
+      std::numeric_limits<int64_t>::min()};
+    // every encoded length from 1 to max_length
+    for (int shift = 0; shift < 63; shift += 7) {
+        values.push_back(int64_t(1) << shift);
+        values.push_back(-(int64_t(1) << shift));
+    }
+    std::mt19937_64 rng(42);
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back(int64_t(rng()) >> (rng() % 64));
+    }
+    for (auto v : values) {
+        std::array<uint8_t, 2 * vint::max_length> buf{};
+        const auto size = vint::serialize(v, buf.data());
+        // word at a time
+        auto [fast, fast_size] = vint::deserialize(buf.data(), buf.size());
+        BOOST_REQUIRE_EQUAL(fast, v);
+        BOOST_REQUIRE_EQUAL(fast_size, size);
+        // exactly the encoded bytes, shorter than a word for small values
+        auto [exact, exact_size] = vint::deserialize(buf.data(), size);
+        BOOST_REQUIRE_EQUAL(exact, v);
+        BOOST_REQUIRE_EQUAL(exact_size, size);
+    }
+}
@@ -12,7 +12,10 @@
 #pragma once
 #include "bytes/bytes.h"
 
+#include <bit>
 #include <cstdint>
+#include <cstring>
+#include <span>
 
 // class is actually zigzag vint; always signed ints
 // matches exactly the kafka encoding which uses protobuf
@@ -97,4 +100,39 @@ inline std::pair<int64_t, size_t> deserialize(Range&& r) noexcept {
     return {decode_zigzag(result), bytes_read};
 }
 
+namespace detail {
+/// \brief packs the low 7 bits of every byte of a little endian word
+inline constexpr uint64_t gather_7bit_groups(uint64_t w) noexcept {
+    return (w & 0x7fULL) | ((w & 0x7f00ULL) >> 1U)
+           | ((w & 0x7f0000ULL) >> 2U) | ((w & 0x7f000000ULL) >> 3U)
+           | ((w & 0x7f00000000ULL) >> 4U) | ((w & 0x7f0000000000ULL) >> 5U)
+           | ((w & 0x7f000000000000ULL) >> 6U)
+           | ((w & 0x7f00000000000000ULL) >> 7U);
+}
+} // namespace detail
+
+/// \brief decodes a varint from contiguous memory. when 8 bytes can be read
+/// it finds the terminating byte with a single mask over a word and gathers
+/// the 7 bit groups without branching per byte, values longer than 8 bytes
+/// and short buffers take the byte by byte path
+inline std::pair<int64_t, size_t>
+deserialize(const uint8_t* src, size_t len) noexcept {
+    static constexpr uint64_t continuation_bits = 0x8080808080808080ULL;
+    if (std::endian::native == std::endian::little && len >= sizeof(uint64_t)) {
+        uint64_t w = 0;
+        std::memcpy(&w, src, sizeof(w));
+        const uint64_t stops = ~w & continuation_bits;
+        if (likely(stops != 0)) {
+            // index of the high bit of the terminating byte: 8 * bytes - 1
+            const auto last_bit = static_cast<size_t>(std::countr_zero(stops));
+            const size_t bytes = (last_bit + 1) / 8;
+            if (last_bit < 63) {
+                w &= (uint64_t(1) << (last_bit + 1)) - 1;
+            }
+            return {decode_zigzag(detail::gather_7bit_groups(w)), bytes};
+        }
+    }
+    return deserialize(std::span<const uint8_t>(src, len));
+}
+
 } // namespace vint
@@ -143,7 +143,22 @@ sasl.jaas.config=org.apache.kafka.common.security.scram.ScramLoginModule require
             "batch.size=%d" % batch_size,
             "bootstrap.servers=%s" % self._redpanda.brokers()
         ]
-        self._execute(cmd)
+        return self._execute(cmd)
+
+    def consume(self, topic, num_records, group=None, timeout_ms=60000):
+        """
+        Consume records from the start of the topic with the consumer
+        performance tool, returning its report.
+        """
+        self._redpanda.logger.debug("Consuming from topic: %s", topic)
+        cmd = [self._script("kafka-consumer-perf-test.sh")]
+        cmd += ["--bootstrap-server", self._redpanda.brokers()]
+        cmd += ["--topic", topic]
+        cmd += ["--messages", str(num_records)]
+        cmd += ["--timeout", str(timeout_ms)]
+        if group:
+            cmd += ["--group", group]
+        return self._execute(cmd)
 
     def _run(self, script, args):
         cmd = [self._script(script)]
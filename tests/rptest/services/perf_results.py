@@ -0,0 +1,135 @@
+# Copyright 2021 Vectorized, Inc.
+#
+# Use of this software is governed by the Business Source License
+# included in the file licenses/BSL.md
+#
+# As of the Change Date specified in that file, in accordance with
+# the Business Source License, use of this software will be governed
+# by the Apache License, Version 2.0
+
+import json
+import os
+import re
+
+# final summary line of kafka-producer-perf-test.sh
+PRODUCER_SUMMARY = re.compile(
+    r"(?P<records>\d+) records sent, "
+    r"(?P<records_per_sec>[\d.]+) records/sec "
+    r"\((?P<mb_per_sec>[\d.]+) MB/sec\), "
+    r"(?P<latency_avg_ms>[\d.]+) ms avg latency, "
+    r"(?P<latency_max_ms>[\d.]+) ms max latency, "
+    r"(?P<latency_p50_ms>\d+) ms 50th, "
+    r"(?P<latency_p95_ms>\d+) ms 95th, "
+    r"(?P<latency_p99_ms>\d+) ms 99th, "
+    r"(?P<latency_p999_ms>\d+) ms 99.9th")
+
+
+def parse_producer_perf(output):
+    """
+    Metrics of the summary printed by the producer performance tool.
+    """
+    assert output, "producer performance tool failed"
+    for line in reversed(output.splitlines()):
+        m = PRODUCER_SUMMARY.search(line)
+        if m:
+            return {k: float(v) for k, v in m.groupdict().items()}
+    raise AssertionError(f"no producer summary in: {output}")
+
+
+def parse_consumer_perf(output):
+    """
+    Metrics of the report printed by the consumer performance tool, with
+    the columns of its header renamed to metric names.
+    """
+    assert output, "consumer performance tool failed"
+    names = {
+        "data.consumed.in.MB": "mb",
+        "MB.sec": "mb_per_sec",
+        "data.consumed.in.nMsg": "records",
+        "nMsg.sec": "records_per_sec",
+        "fetch.time.ms": "fetch_time_ms",
+    }
+    lines = output.splitlines()
+    for i, line in enumerate(lines):
+        if line.startswith("start.time") and i + 1 < len(lines):
+            header = [h.strip() for h in line.split(",")]
+            values = [v.strip() for v in lines[i + 1].split(",")]
+            return {
+                names[h]: float(v)
+                for h, v in zip(header, values) if h in names
+            }
+    raise AssertionError(f"no consumer report in: {output}")
+
+
+class PerfResults:
+    """
+    Metrics of a performance test, saved as results.json in the results
+    directory of the test and compared against a baseline.
+
+    The baseline is a JSON file of the same shape, the results of a reference
+    run: {scenario: {metric: value}}. Its path is the `perf_baseline` ducktape
+    global, and a metric regresses when it is more than `perf_tolerance`
+    (0.1 by default) worse than its baseline. Throughputs, the `_per_sec`
+    metrics, are better when higher, everything else is a duration and is
+    better when lower. Scenarios and metrics without a baseline are only
+    recorded.
+    """
+    RESULTS_FILE = "results.json"
+    DEFAULT_TOLERANCE = 0.1
+
+    def __init__(self, test_context, logger):
+        self._context = test_context
+        self._logger = logger
+        self._results = {}
+
+    def record(self, scenario, metrics):
+        self._logger.info(f"Performance of {scenario}: {metrics}")
+        self._results.setdefault(scenario, {}).update(metrics)
+
+    def save(self):
+        path = os.path.join(self._context.results_dir,
+                            PerfResults.RESULTS_FILE)
+        with open(path, "w") as f:
+            json.dump(self._results, f, indent=2, sort_keys=True)
+        return path
+
+    def baseline(self):
+        path = self._context.globals.get("perf_baseline", None)
+        if not path:
+            return {}
+        with open(path) as f:
+            return json.load(f)
+
+    @staticmethod
+    def higher_is_better(metric):
+        return metric.endswith("_per_sec")
+
+    def regressions(self):
+        tolerance = float(
+            self._context.globals.get("perf_tolerance",
+                                      PerfResults.DEFAULT_TOLERANCE))
+        baseline = self.baseline()
+        found = []
+        for scenario, metrics in self._results.items():
+            expected = baseline.get(scenario, {})
+            for metric, value in metrics.items():
+                if metric not in expected:
+                    continue
+                base = float(expected[metric])
+                if PerfResults.higher_is_better(metric):
+                    regressed = value < base * (1 - tolerance)
+                else:
+                    regressed = value > base * (1 + tolerance)
+                if regressed:
+                    found.append(f"{scenario}.{metric}: {value} "
+                                 f"(baseline {base})")
+        return found
+
+    def check(self):
+        """
+        Save the results and fail on any regression against the baseline.
+        """
+        path = self.save()
+        self._logger.info(f"Performance results saved to {path}")
+        found = self.regressions()
+        assert not found, f"Performance regressions: {found}"
@@ -0,0 +1,141 @@
+# Copyright 2021 Vectorized, Inc.
+#
+# Use of this software is governed by the Business Source License
+# included in the file licenses/BSL.md
+#
+# As of the Change Date specified in that file, in accordance with
+# the Business Source License, use of this software will be governed
+# by the Apache License, Version 2.0
+
+import threading
+import time
+
+from ducktape.mark.resource import cluster
+from rptest.tests.perf.perf_base_test import PerfTest
+
+
+class BrokerPerfTest(PerfTest):
+    """
+    Throughput, latency and recovery of a three nodes cluster. Each test is
+    one scenario of the results, see PerfResults for the baseline gating.
+    """
+    NUM_RECORDS = 2000000
+    FIXED_LOAD_RECORDS_PER_SEC = 10000
+    FAN_OUT_CONSUMERS = 4
+    SCALE_PARTITIONS = 10000
+
+    def __init__(self, test_context):
+        super(BrokerPerfTest, self).__init__(test_context, num_brokers=3)
+
+    @cluster(num_nodes=3)
+    def test_max_throughput(self):
+        topic = self.create_topic(partition_count=16)
+        m = self.produce(topic, BrokerPerfTest.NUM_RECORDS)
+        self.results.record("max_throughput", {
+            "records_per_sec": m["records_per_sec"],
+            "mb_per_sec": m["mb_per_sec"],
+        })
+        self.check()
+
+    @cluster(num_nodes=3)
+    def test_latency_at_fixed_load(self):
+        topic = self.create_topic(partition_count=16)
+        rate = BrokerPerfTest.FIXED_LOAD_RECORDS_PER_SEC
+        # a minute of traffic at the fixed rate for stable tail percentiles
+        m = self.produce(topic, rate * 60, throughput=rate)
+        self.results.record(
+            "fixed_load_latency", {
+                k: m[k]
+                for k in ("latency_avg_ms", "latency_p50_ms",
+                          "latency_p99_ms", "latency_p999_ms")
+            })
+        self.check()
+
+    @cluster(num_nodes=3)
+    def test_consumer_fan_out(self):
+        topic = self.create_topic(partition_count=16)
+        num_records = BrokerPerfTest.NUM_RECORDS // 4
+        self.produce(topic, num_records)
+
+        # every consumer of its own group reads the whole topic
+        reports = [None] * BrokerPerfTest.FAN_OUT_CONSUMERS
+
+        def consume(i):
+            reports[i] = self.consume(topic, num_records, group=f"fan-{i}")
+
+        start = time.time()
+        threads = [
+            threading.Thread(target=consume, args=(i, ))
+            for i in range(len(reports))
+        ]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        elapsed = time.time() - start
+
+        assert all(reports), "A consumer of the fan out failed"
+        total = sum(r["records"] for r in reports)
+        self.results.record(
+            "consumer_fan_out", {
+                "records_per_sec": total / elapsed,
+                "slowest_consumer_records_per_sec":
+                min(r["records_per_sec"] for r in reports),
+            })
+        self.check()
+
+    @cluster(num_nodes=3)
+    def test_many_partitions(self):
+        start = time.time()
+        topic = self.create_topic(
+            partition_count=BrokerPerfTest.SCALE_PARTITIONS)
+        self.wait_for_leaders(topic, timeout_sec=600)
+        time_to_leaders = time.time() - start
+
+        m = self.produce(topic, BrokerPerfTest.NUM_RECORDS // 4)
+        self.results.record(
+            "many_partitions", {
+                "time_to_leaders_sec": time_to_leaders,
+                "records_per_sec": m["records_per_sec"],
+                "latency_p99_ms": m["latency_p99_ms"],
+            })
+        self.check()
+
+    @cluster(num_nodes=3)
+    def test_catch_up_reads(self):
+        topic = self.create_topic(partition_count=16)
+        self.produce(topic, BrokerPerfTest.NUM_RECORDS)
+
+        # a restart drops the batch cache, the backlog is read from disk
+        self.redpanda.restart_nodes(self.redpanda.nodes)
+        self.wait_for_leaders(topic)
+
+        m = self.consume(topic, BrokerPerfTest.NUM_RECORDS)
+        self.results.record("catch_up_reads", {
+            "records_per_sec": m["records_per_sec"],
+            "mb_per_sec": m["mb_per_sec"],
+        })
+        self.check()
+
+    @cluster(num_nodes=3)
+    def test_failure_recovery(self):
+        topic = self.create_topic(partition_count=64)
+        self.wait_for_leaders(topic)
+
+        # leadership moves while the partitions are busy
+        producer = threading.Thread(target=self.produce,
+                                    args=(topic, BrokerPerfTest.NUM_RECORDS))
+        producer.start()
+        time.sleep(10)
+
+        victim = self.redpanda.partitions(topic)[0].leader
+        start = time.time()
+        self.redpanda.stop_node(victim)
+        self.wait_for_leaders(topic, exclude=victim)
+        recovery_sec = time.time() - start
+
+        self.redpanda.start_node(victim)
+        producer.join()
+        self.results.record("failure_recovery",
+                            {"leaders_recovery_sec": recovery_sec})
+        self.check()
@@ -0,0 +1,72 @@
+# Copyright 2021 Vectorized, Inc.
+#
+# Use of this software is governed by the Business Source License
+# included in the file licenses/BSL.md
+#
+# As of the Change Date specified in that file, in accordance with
+# the Business Source License, use of this software will be governed
+# by the Apache License, Version 2.0
+
+import time
+
+from ducktape.utils.util import wait_until
+from rptest.clients.types import TopicSpec
+from rptest.clients.kafka_cli_tools import KafkaCliTools
+from rptest.services.perf_results import (PerfResults, parse_producer_perf,
+                                          parse_consumer_perf)
+from rptest.tests.redpanda_test import RedpandaTest
+
+
+class PerfTest(RedpandaTest):
+    """
+    Base class of the performance tests. Every test records the metrics of
+    its scenario and calls check() last, which saves them and compares them
+    against the baseline, see PerfResults.
+    """
+    RECORD_SIZE = 1024
+
+    def __init__(self, test_context, **kwargs):
+        super(PerfTest, self).__init__(test_context, **kwargs)
+        self.results = PerfResults(test_context, self.logger)
+
+    def tools(self):
+        return KafkaCliTools(self.redpanda)
+
+    def create_topic(self, partition_count, replication_factor=3):
+        spec = TopicSpec(partition_count=partition_count,
+                         replication_factor=replication_factor)
+        self.tools().create_topic(spec)
+        return spec.name
+
+    def produce(self, topic, num_records, throughput=-1, acks=-1):
+        return parse_producer_perf(self.tools().produce(
+            topic,
+            num_records,
+            PerfTest.RECORD_SIZE,
+            acks=acks,
+            throughput=throughput))
+
+    def consume(self, topic, num_records, group=None):
+        return parse_consumer_perf(self.tools().consume(topic,
+                                                        num_records,
+                                                        group=group))
+
+    def wait_for_leaders(self, topic, exclude=None, timeout_sec=300):
+        """
+        Wait until every partition of the topic has a leader, other than the
+        excluded node, and return how long it took.
+        """
+        def all_led():
+            partitions = self.redpanda.partitions(topic)
+            return all(p.leader is not None and p.leader != exclude
+                       for p in partitions)
+
+        start = time.time()
+        wait_until(all_led,
+                   timeout_sec=timeout_sec,
+                   backoff_sec=0.5,
+                   err_msg=f"Partitions of {topic} without a leader")
+        return time.time() - start
+
+    def check(self):
+        self.results.check()
@@ -44,6 +44,7 @@ RPC_TEMPLATE = """
 #include <seastar/core/reactor.hh>
 #include <seastar/core/sleep.hh>
 #include <seastar/core/scheduling.hh>
+#include <seastar/core/semaphore.hh>
 
 #include <functional>
 #include <chrono>
@@ -79,6 +80,17 @@ public:
     ss::smp_service_group& get_smp_service_group() override {
        return _ssg;
     }
+    {%- for group in scheduling_groups %}
+
+    /// \\brief group of the methods declared with "{{group}}", defaults to
+    /// the group of the service
+    ss::scheduling_group& {{group}}_scheduling_group() {
+       return _{{group}}_sc;
+    }
+    void set_{{group}}_scheduling_group(ss::scheduling_group sc) {
+       _{{group}}_sc = sc;
+    }
+    {%- endfor %}
 
     rpc::method* method_from_id(uint32_t idx) final {
        switch(idx) {
@@ -96,7 +108,16 @@ public:
                               {{method.output_type}}>::exec(in, ctx, {{method.id}},
       [this](
           {{method.input_type}}&& t, rpc::streaming_context& ctx) -> ss::future<{{method.output_type}}> {
+          {%- if method.scheduling_group or method.max_inflight %}
+          return admit(
+            {% if method.scheduling_group %}_{{method.scheduling_group}}_sc{% else %}_sc{% endif %},
+            {% if method.max_inflight %}&_{{method.name}}_inflight{% else %}nullptr{% endif %},
+            [this, t = std::move(t), &ctx]() mutable {
+                return {{method.name}}(std::move(t), ctx);
+            });
+          {%- else %}
           return {{method.name}}(std::move(t), ctx);
+          {%- endif %}
       });
     }
     virtual ss::future<{{method.output_type}}>
@@ -107,6 +128,12 @@ public:
 private:
     ss::scheduling_group _sc;
     ss::smp_service_group _ssg;
+    {%- for group in scheduling_groups %}
+    ss::scheduling_group _{{group}}_sc{_sc};
+    {%- endfor %}
+    {%- for method in methods if method.max_inflight %}
+    ss::semaphore _{{method.name}}_inflight{ {{method.max_inflight}} };
+    {%- endfor %}
     std::array<rpc::method, {{methods|length}}> _methods{%raw %}{{{% endraw %}
       {%- for method in methods %}
       rpc::method([this] (ss::input_stream<char>& in, rpc::streaming_context& ctx) {
@@ -128,6 +155,12 @@ public:
     {{method.name}}({{method.input_type}}&& r, rpc::client_opts opts) {
        return _transport.send_typed<{{method.input_type}}, {{method.output_type}}>(std::move(r), {{method.id}}, std::move(opts));
     }
+
+    /// \\brief streams the serialized reply to the consumer in bounded chunks
+    virtual inline ss::future<result<rpc::client_context<size_t>>>
+    {{method.name}}_streaming({{method.input_type}}&& r, rpc::client_opts opts, rpc::transport::payload_consumer consumer) {
+       return _transport.send_streaming<{{method.input_type}}>(std::move(r), {{method.id}}, std::move(opts), std::move(consumer));
+    }
     {%- endfor %}
 
 private:
@@ -213,6 +246,12 @@ def _enrich_methods(service):
     for m in service["methods"]:
         m["id"] = _xor_id(m)
 
+    # methods may run in their own scheduling group, the service exposes a
+    # setter per group name and defaults it to the group of the service
+    service["scheduling_groups"] = sorted(
+        set(m["scheduling_group"] for m in service["methods"]
+            if "scheduling_group" in m))
+
     return service
 
 